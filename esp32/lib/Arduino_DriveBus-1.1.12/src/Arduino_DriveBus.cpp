@@ -219,13 +219,13 @@ bool Arduino_IIC_DriveBus::IIC_Read_Data(uint8_t device_address, uint8_t *data,
     return true;
 }
 
-bool Arduino_IIC_DriveBus::IIC_ReadCData_Data(uint8_t device_address,const uint8_t *cdata, size_t clength,
-                                              uint8_t *data, size_t length)
+bool Arduino_IIC_DriveBus::WriteRead(uint8_t device_address, const uint8_t *wdata, size_t wlength,
+                                     uint8_t *rdata, size_t rlength)
 {
     BeginTransmission(device_address);
-    if (Write(cdata, clength) == false)
+    if (Write(wdata, wlength) == false)
     {
-        log_e("->Write(cdata, clength) fail");
+        log_e("->Write(wdata, wlength) fail");
         return false;
     }
     if (EndTransmission() == false)
@@ -233,19 +233,25 @@ bool Arduino_IIC_DriveBus::IIC_ReadCData_Data(uint8_t device_address,const uint8
         log_e("->EndTransmission() fail");
         return false;
     }
-    if (RequestFrom(device_address, length) == false)
+    if (RequestFrom(device_address, rlength) == false)
     {
-        log_e("->RequestFrom(device_address, length) fail");
+        log_e("->RequestFrom(device_address, rlength) fail");
         return false;
     }
-    for (size_t i = 0; i < length; i++)
+    for (size_t i = 0; i < rlength; i++)
     {
-        data[i] = Read();
+        rdata[i] = Read();
     }
 
     return true;
 }
 
+bool Arduino_IIC_DriveBus::IIC_ReadCData_Data(uint8_t device_address,const uint8_t *cdata, size_t clength,
+                                              uint8_t *data, size_t length)
+{
+    return WriteRead(device_address, cdata, clength, data, length);
+}
+
 bool Arduino_IIC_DriveBus::IIC_ReadC8_Data(uint8_t device_address, uint8_t c, uint8_t *d, size_t length)
 {
     BeginTransmission(device_address);
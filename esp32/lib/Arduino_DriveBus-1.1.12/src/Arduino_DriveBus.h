@@ -46,6 +46,11 @@ public:
     virtual uint8_t Read(void) = 0;
     virtual bool RequestFrom(uint8_t device_address, size_t length) = 0;
     virtual bool WriteC8D8(uint8_t c, uint8_t d);
+    // Write wdata, then read rlength bytes into rdata. Buses that can run
+    // both as one driver call override this; the default goes through
+    // Write()/RequestFrom()/Read().
+    virtual bool WriteRead(uint8_t device_address, const uint8_t *wdata, size_t wlength,
+                           uint8_t *rdata, size_t rlength);
 
     bool BufferOperation(uint8_t device_address, const uint8_t *operations, size_t length);
 
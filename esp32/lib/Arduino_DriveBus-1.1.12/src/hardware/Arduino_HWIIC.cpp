@@ -12,6 +12,11 @@
 Arduino_HWIIC::Arduino_HWIIC(int8_t sda, int8_t scl, TwoWire *wire)
     : _sda(sda), _scl(scl), _wire(wire)
 {
+#if SOC_I2C_NUM > 1
+    _port = (wire == &Wire1) ? I2C_NUM_1 : I2C_NUM_0;
+#else
+    _port = I2C_NUM_0;
+#endif
 }
 
 bool Arduino_HWIIC::begin(int32_t speed)
@@ -53,4 +58,28 @@ uint8_t Arduino_HWIIC::Read(void)
 bool Arduino_HWIIC::RequestFrom(uint8_t device_address, size_t length)
 {
     return _wire->requestFrom(device_address, length);
+}
+
+/*
+ * Straight to the ESP-IDF master driver that _wire->begin() installed: the
+ * read lands in rdata without Wire's receive buffer and per-byte read().
+ * A STOP still separates the write and the read, as Write()/RequestFrom()
+ * did (the AXS15231B touch controller is only known to work that way).
+ */
+bool Arduino_HWIIC::WriteRead(uint8_t device_address, const uint8_t *wdata, size_t wlength,
+                              uint8_t *rdata, size_t rlength)
+{
+    TickType_t timeout = pdMS_TO_TICKS(IIC_TRANSACTION_TIMEOUT_MS);
+
+    if (i2c_master_write_to_device(_port, device_address, wdata, wlength, timeout) != ESP_OK)
+    {
+        log_e("->i2c_master_write_to_device() fail");
+        return false;
+    }
+    if (i2c_master_read_from_device(_port, device_address, rdata, rlength, timeout) != ESP_OK)
+    {
+        log_e("->i2c_master_read_from_device() fail");
+        return false;
+    }
+    return true;
 }
\ No newline at end of file
@@ -15,9 +15,13 @@
 #pragma once
 
 #include <Wire.h>
+#include <driver/i2c.h>
 #include "../Arduino_DriveBus.h"
 
 #define IIC_DEFAULT_SPEED 100000UL
+#define IIC_FAST_SPEED 400000UL       // Fast-mode
+#define IIC_FAST_PLUS_SPEED 1000000UL // Fast-mode Plus (needs every device on the bus to support it)
+#define IIC_TRANSACTION_TIMEOUT_MS 20
 
 class Arduino_HWIIC : public Arduino_IIC_DriveBus
 {
@@ -32,9 +36,12 @@ public:
     bool Write(const uint8_t *data, size_t length) override;
     uint8_t Read(void) override;
     bool RequestFrom(uint8_t device_address, size_t length) override;
+    bool WriteRead(uint8_t device_address, const uint8_t *wdata, size_t wlength,
+                   uint8_t *rdata, size_t rlength) override;
 
 private:
     int8_t _sda, _scl;
+    i2c_port_t _port;
 
     TwoWire *_wire;
 };
\ No newline at end of file
@@ -1941,6 +1941,374 @@ void Arduino_GFX::u8g2_font_decode_len(uint8_t len, uint8_t is_foreground, uint1
   _u8g2_dx = lx;
   _u8g2_dy = ly;
 }
+
+#if (U8G2_GLYPH_CACHE_SIZE > 0)
+/*
+ * Rasterized glyph cache, shared by all Arduino_GFX instances (a canvas and
+ * its panel use the same fonts). Each entry holds the glyph's metrics and a
+ * 1 bpp bitmap, so a hit skips both the Unicode jump table walk and the
+ * run-length decode. Entries are found through a small chained hash on the
+ * codepoint and replaced least recently used first. Allocated in PSRAM on
+ * first use; without PSRAM glyphs are decoded every time as before.
+ */
+#define U8G2_GLYPH_HASH_SIZE 128 // power of 2
+
+struct U8g2GlyphCacheEntry
+{
+  const uint8_t *font;
+  const uint8_t *glyph_data;
+  uint32_t last_used;
+  uint16_t encoding;
+  int16_t next; // Hash chain, -1 ends it
+  uint8_t width;
+  uint8_t height;
+  int8_t x;
+  int8_t y;
+  int8_t delta_x;
+  uint8_t bitmap[U8G2_GLYPH_CACHE_BITMAP]; // Row after row, MSB first
+};
+
+static U8g2GlyphCacheEntry *_glyph_cache = NULL;
+static bool _glyph_cache_unavailable = false;
+static int16_t _glyph_hash[U8G2_GLYPH_HASH_SIZE];
+static int16_t _glyph_count = 0;
+static uint32_t _glyph_tick = 0;
+
+static U8g2GlyphCacheEntry *u8g2_glyph_cache_find(const uint8_t *font, uint16_t encoding)
+{
+  if (!_glyph_cache)
+  {
+    return NULL;
+  }
+  for (int16_t i = _glyph_hash[encoding & (U8G2_GLYPH_HASH_SIZE - 1)]; i >= 0; i = _glyph_cache[i].next)
+  {
+    U8g2GlyphCacheEntry *g = &_glyph_cache[i];
+    if ((g->encoding == encoding) && (g->font == font))
+    {
+      g->last_used = ++_glyph_tick;
+      return g;
+    }
+  }
+  return NULL;
+}
+
+static U8g2GlyphCacheEntry *u8g2_glyph_cache_add(const uint8_t *font, uint16_t encoding)
+{
+  if (!_glyph_cache)
+  {
+    if (_glyph_cache_unavailable)
+    {
+      return NULL;
+    }
+#if defined(ESP32)
+    if (psramFound())
+    {
+      _glyph_cache = (U8g2GlyphCacheEntry *)ps_malloc(sizeof(U8g2GlyphCacheEntry) * U8G2_GLYPH_CACHE_SIZE);
+    }
+#endif
+    if (!_glyph_cache)
+    {
+      _glyph_cache_unavailable = true;
+      return NULL;
+    }
+    for (int16_t i = 0; i < U8G2_GLYPH_HASH_SIZE; i++)
+    {
+      _glyph_hash[i] = -1;
+    }
+  }
+
+  int16_t slot;
+  if (_glyph_count < U8G2_GLYPH_CACHE_SIZE)
+  {
+    slot = _glyph_count++;
+  }
+  else
+  {
+    slot = 0;
+    for (int16_t i = 1; i < U8G2_GLYPH_CACHE_SIZE; i++)
+    {
+      if (_glyph_cache[i].last_used < _glyph_cache[slot].last_used)
+      {
+        slot = i;
+      }
+    }
+    int16_t *link = &_glyph_hash[_glyph_cache[slot].encoding & (U8G2_GLYPH_HASH_SIZE - 1)];
+    while (*link != slot)
+    {
+      link = &_glyph_cache[*link].next;
+    }
+    *link = _glyph_cache[slot].next;
+  }
+
+  U8g2GlyphCacheEntry *g = &_glyph_cache[slot];
+  int16_t *head = &_glyph_hash[encoding & (U8G2_GLYPH_HASH_SIZE - 1)];
+  g->font = font;
+  g->encoding = encoding;
+  g->last_used = ++_glyph_tick;
+  g->next = *head;
+  *head = slot;
+  return g;
+}
+#endif // (U8G2_GLYPH_CACHE_SIZE > 0)
+
+/*
+ * O(1) glyph lookup in a direct index (see u8g2_font_index_t). Returns the
+ * glyph data (past encoding and size) or NULL if the font lacks it.
+ */
+static const uint8_t *u8g2_font_index_lookup(const u8g2_font_index_t *index, uint16_t encoding)
+{
+  uint8_t page = pgm_read_byte(&index->pages[encoding >> 8]);
+  if (page == 0xFF)
+  {
+    return NULL;
+  }
+  uint16_t word = ((uint16_t)page << 3) | ((encoding >> 5) & 7);
+  uint32_t bits = pgm_read_dword(&index->bits[word]);
+  uint32_t bit = 1UL << (encoding & 31);
+  if (!(bits & bit))
+  {
+    return NULL;
+  }
+  uint16_t glyph = pgm_read_word(&index->rank[word]) + __builtin_popcount(bits & (bit - 1));
+  return index->font + pgm_read_dword(&index->offsets[glyph]);
+}
+
+/*
+ * Locate a glyph's data (past encoding and size) in the current font,
+ * through the direct index when there is one. NULL if the font lacks it.
+ */
+const uint8_t *Arduino_GFX::u8g2_font_find_glyph(uint16_t encoding)
+{
+  const uint8_t *glyph_data = 0;
+
+  if (_u8g2_font_index && (_u8g2_font_index->font == u8g2Font))
+  {
+    glyph_data = u8g2_font_index_lookup(_u8g2_font_index, encoding);
+  }
+  else
+  {
+    uint8_t *font = u8g2Font;
+
+    // extract from u8g2_font_get_glyph_data()
+    font += 23; // U8G2_FONT_DATA_STRUCT_SIZE
+    if (encoding <= 255)
+    {
+      if (encoding >= 'a')
+      {
+        font += _u8g2_start_pos_lower_a;
+      }
+      else if (encoding >= 'A')
+      {
+        font += _u8g2_start_pos_upper_A;
+      }
+
+      for (;;)
+      {
+        if (pgm_read_byte(font + 1) == 0)
+          break;
+        if (pgm_read_byte(font) == encoding)
+        {
+          glyph_data = font + 2; /* skip encoding and glyph size */
+        }
+        font += pgm_read_byte(font + 1);
+      }
+    }
+#ifdef U8G2_WITH_UNICODE
+    else
+    {
+      uint16_t e;
+      font += _u8g2_start_pos_unicode;
+      const uint8_t *unicode_lookup_table = font;
+
+      /* issue 596: search for the glyph start in the unicode lookup table */
+      do
+      {
+        font += u8g2_font_get_word(unicode_lookup_table, 0);
+        e = u8g2_font_get_word(unicode_lookup_table, 2);
+        unicode_lookup_table += 4;
+      } while (e < encoding);
+
+      for (;;)
+      {
+        e = u8g2_font_get_word(font, 0);
+
+        if (e == 0)
+          break;
+
+        if (e == encoding)
+        {
+          glyph_data = font + 3; /* skip encoding and glyph size */
+          break;
+        }
+        font += pgm_read_byte(font + 2);
+      }
+    }
+#endif
+  }
+
+  return glyph_data;
+}
+
+/*
+ * Advance width of a glyph in the current font, without rasterizing or
+ * caching it (text measurement). -1 if the font has no such glyph.
+ */
+int16_t Arduino_GFX::u8g2_font_glyph_advance(uint16_t encoding)
+{
+#if (U8G2_GLYPH_CACHE_SIZE > 0)
+  U8g2GlyphCacheEntry *g = u8g2_glyph_cache_find(u8g2Font, encoding);
+  if (g)
+  {
+    return g->delta_x;
+  }
+#endif // (U8G2_GLYPH_CACHE_SIZE > 0)
+
+  const uint8_t *glyph_data = u8g2_font_find_glyph(encoding);
+  if (!glyph_data)
+  {
+    return -1;
+  }
+  _u8g2_decode_ptr = glyph_data;
+  _u8g2_decode_bit_pos = 0;
+  u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_char_width);
+  u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_char_height);
+  u8g2_font_decode_get_signed_bits(_u8g2_bits_per_char_x);
+  u8g2_font_decode_get_signed_bits(_u8g2_bits_per_char_y);
+  int16_t advance = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_delta_x);
+  _u8g2_decode_ptr = 0;
+  return advance;
+}
+
+/*
+ * Find a glyph and load its metrics (_u8g2_char_*, _u8g2_delta_x).
+ * Leaves _u8g2_decode_ptr at the glyph's run-length data, or sets
+ * _u8g2_glyph_bitmap when the glyph is cached. Returns false if the font
+ * has no such glyph.
+ */
+bool Arduino_GFX::u8g2_font_load_glyph(uint16_t encoding)
+{
+  _u8g2_glyph_bitmap = NULL;
+
+#if (U8G2_GLYPH_CACHE_SIZE > 0)
+  U8g2GlyphCacheEntry *g = u8g2_glyph_cache_find(u8g2Font, encoding);
+  if (g)
+  {
+    _u8g2_decode_ptr = g->glyph_data;
+    _u8g2_char_width = g->width;
+    _u8g2_char_height = g->height;
+    _u8g2_char_x = g->x;
+    _u8g2_char_y = g->y;
+    _u8g2_delta_x = g->delta_x;
+    _u8g2_glyph_bitmap = g->bitmap;
+    return true;
+  }
+#endif // (U8G2_GLYPH_CACHE_SIZE > 0)
+
+  const uint8_t *glyph_data = u8g2_font_find_glyph(encoding);
+  if (!glyph_data)
+  {
+    return false;
+  }
+
+  // u8g2_font_decode_glyph
+  _u8g2_decode_ptr = glyph_data;
+  _u8g2_decode_bit_pos = 0;
+
+  _u8g2_char_width = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_char_width);
+  _u8g2_char_height = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_char_height);
+  _u8g2_char_x = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_char_x);
+  _u8g2_char_y = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_char_y);
+  _u8g2_delta_x = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_delta_x);
+
+#if (U8G2_GLYPH_CACHE_SIZE > 0)
+  uint16_t total = (uint16_t)_u8g2_char_width * _u8g2_char_height;
+  if (total > (U8G2_GLYPH_CACHE_BITMAP * 8))
+  {
+    return true; // Too big to cache, decode it every time
+  }
+  g = u8g2_glyph_cache_add(u8g2Font, encoding);
+  if (!g)
+  {
+    return true;
+  }
+  g->glyph_data = glyph_data;
+  g->width = _u8g2_char_width;
+  g->height = _u8g2_char_height;
+  g->x = _u8g2_char_x;
+  g->y = _u8g2_char_y;
+  g->delta_x = _u8g2_delta_x;
+
+  // Same run-length walk as drawChar(), recording pixels instead of drawing
+  memset(g->bitmap, 0, (total + 7) >> 3);
+  uint16_t pos = 0;
+  if (total > 0)
+  {
+    for (;;)
+    {
+      uint8_t a = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_0);
+      uint8_t b = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_1);
+      do
+      {
+        pos += a;
+        for (uint8_t i = 0; i < b; i++, pos++)
+        {
+          if (pos < total)
+          {
+            g->bitmap[pos >> 3] |= 0x80 >> (pos & 7);
+          }
+        }
+      } while (u8g2_font_decode_get_unsigned_bits(1) != 0);
+
+      if (pos >= total)
+        break;
+    }
+  }
+  _u8g2_glyph_bitmap = g->bitmap;
+#endif // (U8G2_GLYPH_CACHE_SIZE > 0)
+
+  return true;
+}
+
+/*
+ * Draw the cached bitmap of the current glyph at _u8g2_target_x/y, one
+ * horizontal run at a time like u8g2_font_decode_len().
+ */
+void Arduino_GFX::u8g2_font_draw_glyph_bitmap(uint16_t color, uint16_t bg)
+{
+  const uint8_t *bitmap = _u8g2_glyph_bitmap;
+  uint16_t pos = 0;
+
+  for (uint8_t ly = 0; ly < _u8g2_char_height; ly++)
+  {
+    uint8_t lx = 0;
+    while (lx < _u8g2_char_width)
+    {
+      bool is_foreground = bitmap[pos >> 3] & (0x80 >> (pos & 7));
+      uint8_t run = 0;
+      do
+      {
+        run++;
+        pos++;
+      } while (((lx + run) < _u8g2_char_width) &&
+               (((bitmap[pos >> 3] & (0x80 >> (pos & 7))) != 0) == is_foreground));
+
+      if (is_foreground || (bg != color))
+      {
+        uint16_t c = is_foreground ? color : bg;
+        if (textsize_x == 1 && textsize_y == 1)
+        {
+          writeFastHLine(_u8g2_target_x + lx, _u8g2_target_y + ly, run, c);
+        }
+        else
+        {
+          writeFillRect(_u8g2_target_x + (lx * textsize_x), _u8g2_target_y + (ly * textsize_y),
+                        (run * textsize_x) - text_pixel_margin, textsize_y - text_pixel_margin, c);
+        }
+      }
+      lx += run;
+    }
+  }
+}
 #endif // defined(U8G2_FONT_SUPPORT)
 
 // TEXT- AND CHARACTER-HANDLING FUNCTIONS ----------------------------------
@@ -2046,24 +2414,31 @@ void Arduino_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
       _u8g2_target_y = y - ((_u8g2_char_height + _u8g2_char_y) * textsize_y);
       // log_d("_u8g2_target_x: %d, _u8g2_target_y: %d", _u8g2_target_x, _u8g2_target_y);
 
-      /* reset local x/y position */
-      _u8g2_dx = 0;
-      _u8g2_dy = 0;
-      /* decode glyph */
       startWrite();
-      for (;;)
+      if (_u8g2_glyph_bitmap)
+      {
+        u8g2_font_draw_glyph_bitmap(color, bg);
+      }
+      else
       {
-        a = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_0);
-        b = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_1);
-        // log_d("a: %d, b: %d", a, b);
-        do
+        /* reset local x/y position */
+        _u8g2_dx = 0;
+        _u8g2_dy = 0;
+        /* decode glyph */
+        for (;;)
         {
-          u8g2_font_decode_len(a, 0, color, bg);
-          u8g2_font_decode_len(b, 1, color, bg);
-        } while (u8g2_font_decode_get_unsigned_bits(1) != 0);
+          a = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_0);
+          b = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_1);
+          // log_d("a: %d, b: %d", a, b);
+          do
+          {
+            u8g2_font_decode_len(a, 0, color, bg);
+            u8g2_font_decode_len(b, 1, color, bg);
+          } while (u8g2_font_decode_get_unsigned_bits(1) != 0);
 
-        if (_u8g2_dy >= _u8g2_char_height)
-          break;
+          if (_u8g2_dy >= _u8g2_char_height)
+            break;
+        }
       }
       endWrite();
     }
@@ -2234,79 +2609,8 @@ size_t Arduino_GFX::write(uint8_t c)
       }
       else if (_encoding != '\r')
       { // Ignore carriage returns
-        uint8_t *font = u8g2Font;
-        const uint8_t *glyph_data = 0;
-
-        // extract from u8g2_font_get_glyph_data()
-        font += 23; // U8G2_FONT_DATA_STRUCT_SIZE
-        if (_encoding <= 255)
+        if (u8g2_font_load_glyph(_encoding))
         {
-          if (_encoding >= 'a')
-          {
-            font += _u8g2_start_pos_lower_a;
-          }
-          else if (_encoding >= 'A')
-          {
-            font += _u8g2_start_pos_upper_A;
-          }
-
-          for (;;)
-          {
-            if (pgm_read_byte(font + 1) == 0)
-              break;
-            if (pgm_read_byte(font) == _encoding)
-            {
-              glyph_data = font + 2; /* skip encoding and glyph size */
-            }
-            font += pgm_read_byte(font + 1);
-          }
-        }
-#ifdef U8G2_WITH_UNICODE
-        else
-        {
-          uint16_t e;
-          font += _u8g2_start_pos_unicode;
-          const uint8_t *unicode_lookup_table = font;
-
-          /* issue 596: search for the glyph start in the unicode lookup table */
-          do
-          {
-            font += u8g2_font_get_word(unicode_lookup_table, 0);
-            e = u8g2_font_get_word(unicode_lookup_table, 2);
-            unicode_lookup_table += 4;
-          } while (e < _encoding);
-
-          for (;;)
-          {
-            e = u8g2_font_get_word(font, 0);
-
-            if (e == 0)
-              break;
-
-            if (e == _encoding)
-            {
-              glyph_data = font + 3; /* skip encoding and glyph size */
-              break;
-            }
-            font += pgm_read_byte(font + 2);
-          }
-        }
-#endif
-
-        if (glyph_data)
-        {
-          // u8g2_font_decode_glyph
-          _u8g2_decode_ptr = glyph_data;
-          _u8g2_decode_bit_pos = 0;
-
-          _u8g2_char_width = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_char_width);
-          _u8g2_char_height = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_char_height);
-          _u8g2_char_x = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_char_x);
-          _u8g2_char_y = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_char_y);
-          _u8g2_delta_x = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_delta_x);
-          // log_d("c: %c, _encoding: %d, _u8g2_char_width: %d, _u8g2_char_height: %d, _u8g2_char_x: %d, _u8g2_char_y: %d, _u8g2_delta_x: %d",
-          //       c, _encoding, _u8g2_char_width, _u8g2_char_height, _u8g2_char_x, _u8g2_char_y, _u8g2_delta_x);
-
           if (_u8g2_char_width > 0)
           {
             if (wrap && ((cursor_x + (textsize_x * _u8g2_char_width) - 1) > _max_x))
@@ -2492,6 +2796,11 @@ void Arduino_GFX::setFont(const uint8_t *font)
   //       _u8g2_start_pos_upper_A, _u8g2_start_pos_lower_a, _u8g2_start_pos_unicode, _u8g2_first_char);
 }
 
+void Arduino_GFX::setFontIndex(const u8g2_font_index_t *index)
+{
+  _u8g2_font_index = index;
+}
+
 void Arduino_GFX::setUTF8Print(bool isEnable)
 {
   _enableUTF8Print = isEnable;
@@ -2624,79 +2933,8 @@ void Arduino_GFX::charBounds(char c, int16_t *x, int16_t *y,
       }
       else if (_encoding != '\r')
       { // Ignore carriage returns
-        uint8_t *font = u8g2Font;
-        const uint8_t *glyph_data = 0;
-
-        // extract from u8g2_font_get_glyph_data()
-        font += 23; // U8G2_FONT_DATA_STRUCT_SIZE
-        if (_encoding <= 255)
+        if (u8g2_font_load_glyph(_encoding))
         {
-          if (_encoding >= 'a')
-          {
-            font += _u8g2_start_pos_lower_a;
-          }
-          else if (_encoding >= 'A')
-          {
-            font += _u8g2_start_pos_upper_A;
-          }
-
-          for (;;)
-          {
-            if (pgm_read_byte(font + 1) == 0)
-              break;
-            if (pgm_read_byte(font) == _encoding)
-            {
-              glyph_data = font + 2; /* skip encoding and glyph size */
-            }
-            font += pgm_read_byte(font + 1);
-          }
-        }
-#ifdef U8G2_WITH_UNICODE
-        else
-        {
-          uint16_t e;
-          font += _u8g2_start_pos_unicode;
-          const uint8_t *unicode_lookup_table = font;
-
-          /* issue 596: search for the glyph start in the unicode lookup table */
-          do
-          {
-            font += u8g2_font_get_word(unicode_lookup_table, 0);
-            e = u8g2_font_get_word(unicode_lookup_table, 2);
-            unicode_lookup_table += 4;
-          } while (e < _encoding);
-
-          for (;;)
-          {
-            e = u8g2_font_get_word(font, 0);
-
-            if (e == 0)
-              break;
-
-            if (e == _encoding)
-            {
-              glyph_data = font + 3; /* skip encoding and glyph size */
-              break;
-            }
-            font += pgm_read_byte(font + 2);
-          }
-        }
-#endif
-
-        if (glyph_data)
-        {
-          // u8g2_font_decode_glyph
-          _u8g2_decode_ptr = glyph_data;
-          _u8g2_decode_bit_pos = 0;
-
-          _u8g2_char_width = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_char_width);
-          _u8g2_char_height = u8g2_font_decode_get_unsigned_bits(_u8g2_bits_per_char_height);
-          _u8g2_char_x = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_char_x);
-          _u8g2_char_y = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_char_y);
-          _u8g2_delta_x = u8g2_font_decode_get_signed_bits(_u8g2_bits_per_delta_x);
-          // log_d("c: %c, _encoding: %d, _u8g2_char_width: %d, _u8g2_char_height: %d, _u8g2_char_x: %d, _u8g2_char_y: %d, _u8g2_delta_x: %d",
-          //       c, _encoding, _u8g2_char_width, _u8g2_char_height, _u8g2_char_x, _u8g2_char_y, _u8g2_delta_x);
-
           if (_u8g2_char_width > 0)
           {
             if (wrap && ((*x + (textsize_x * _u8g2_char_width) - 1) > _max_x))
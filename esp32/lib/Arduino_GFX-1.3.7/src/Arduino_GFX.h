@@ -23,6 +23,30 @@
 #define U8G2_FONT_SECTION(name) PROGMEM
 #endif
 #include "font/u8g2_font_cubic11_h_cjk.h"
+#ifndef U8G2_GLYPH_CACHE_SIZE
+#define U8G2_GLYPH_CACHE_SIZE 128 // Rasterized glyphs kept in PSRAM, 0 disables
+#endif
+#ifndef U8G2_GLYPH_CACHE_BITMAP
+#define U8G2_GLYPH_CACHE_BITMAP 72 // Bytes per cached glyph (576 px, e.g. 24x24)
+#endif
+#endif
+
+#ifdef U8G2_FONT_SUPPORT
+/*
+ * Direct glyph index for a u8g2 font (generated by tools/subset_font.py).
+ * pages[cp >> 8] is 0xFF or a page number p; bits[p * 8 + w] has one bit per
+ * codepoint of that page's 32-codepoint word w, and rank[p * 8 + w] counts
+ * the glyphs before that word. offsets[] gives each glyph's data offset in
+ * font, past its encoding and size.
+ */
+typedef struct
+{
+  const uint8_t *font;
+  const uint8_t *pages;
+  const uint32_t *bits;
+  const uint16_t *rank;
+  const uint32_t *offsets;
+} u8g2_font_index_t;
 #endif
 
 #define RGB565(r, g, b) ((((r)&0xF8) << 8) | (((g)&0xFC) << 3) | ((b) >> 3))
@@ -205,9 +229,9 @@ public:
   void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
   void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
   void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
-  void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+  virtual void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
   void drawRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t radius, uint16_t color);
-  void fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t radius, uint16_t color);
+  virtual void fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t radius, uint16_t color);
   void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
   void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
   void drawXBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
@@ -227,11 +251,15 @@ public:
   void setFont(const GFXfont *f = NULL);
 #if defined(U8G2_FONT_SUPPORT)
   void setFont(const uint8_t *font);
+  void setFontIndex(const u8g2_font_index_t *index); // Used while its font is set
   void setUTF8Print(bool isEnable);
   uint16_t u8g2_font_get_word(const uint8_t *font, uint8_t offset);
   uint8_t u8g2_font_decode_get_unsigned_bits(uint8_t cnt);
   int8_t u8g2_font_decode_get_signed_bits(uint8_t cnt);
   void u8g2_font_decode_len(uint8_t len, uint8_t is_foreground, uint16_t color, uint16_t bg);
+  bool u8g2_font_load_glyph(uint16_t encoding);
+  int16_t u8g2_font_glyph_advance(uint16_t encoding); // -1 if the font lacks it
+  void u8g2_font_draw_glyph_bitmap(uint16_t color, uint16_t bg);
 #endif // defined(U8G2_FONT_SUPPORT)
   virtual void flush(void);
 #endif // !defined(ATTINY_CORE)
@@ -443,6 +471,9 @@ protected:
 
   const uint8_t *_u8g2_decode_ptr;
   uint8_t _u8g2_decode_bit_pos;
+  const uint8_t *_u8g2_glyph_bitmap = NULL; // Cached 1 bpp glyph, if any
+  const u8g2_font_index_t *_u8g2_font_index = NULL;
+  const uint8_t *u8g2_font_find_glyph(uint16_t encoding);
 #endif // defined(U8G2_FONT_SUPPORT)
 
 #if defined(LITTLE_FOOT_PRINT)
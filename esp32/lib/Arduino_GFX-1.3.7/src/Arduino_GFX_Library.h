@@ -45,6 +45,7 @@
 #endif // !defined(LITTLE_FOOT_PRINT)
 
 #include "display/Arduino_AXS15231.h"
+#include "display/Arduino_AXS15231_Static.h"
 #include "display/Arduino_CO5300.h"
 #include "display/Arduino_GC9106.h"
 #include "display/Arduino_GC9107.h"
@@ -4,6 +4,133 @@
 #include "../Arduino_GFX.h"
 #include "Arduino_Canvas.h"
 
+// Fill n pixels with one colour, two per aligned 32-bit store
+static inline void fill_pixels(uint16_t *dst, uint16_t color, uint32_t n)
+{
+  if (n && ((uintptr_t)dst & 2))
+  {
+    *dst++ = color;
+    n--;
+  }
+  uint32_t pair = ((uint32_t)color << 16) | color;
+  uint32_t *d = (uint32_t *)dst;
+  uint32_t words = n >> 1;
+  for (; words >= 4; words -= 4, d += 4)
+  {
+    d[0] = pair;
+    d[1] = pair;
+    d[2] = pair;
+    d[3] = pair;
+  }
+  while (words--)
+  {
+    *d++ = pair;
+  }
+  if (n & 1)
+  {
+    *(uint16_t *)d = color;
+  }
+}
+
+// Fill columns a..b of a framebuffer row, clipped to 0..max_x
+static inline void fill_span(uint16_t *row, int16_t a, int16_t b, int16_t max_x, uint16_t color)
+{
+  if (a < 0)
+  {
+    a = 0;
+  }
+  if (b > max_x)
+  {
+    b = max_x;
+  }
+  if (a <= b)
+  {
+    fill_pixels(row + a, color, b - a + 1);
+  }
+}
+
+// Corner masks for fillRoundRect: per row of a corner, top row first, how
+// many pixels it is inset from the rectangle's edge. A few radii are kept,
+// UI corners use only a handful.
+#define CORNER_MAX_R 32
+#define CORNER_MASKS 4
+
+struct CornerMask
+{
+  int16_t r; // 0: unused
+  uint8_t inset[CORNER_MAX_R];
+};
+
+static CornerMask _corner_masks[CORNER_MASKS];
+static uint8_t _corner_next = 0;
+
+// Step the circle as Arduino_GFX::fillEllipseHelper does, so the spans
+// match the stock fillRoundRect pixel for pixel
+static void build_corner_mask(CornerMask *m, int16_t r)
+{
+  int32_t half[CORNER_MAX_R + 1] = {0};
+  int32_t r2 = (int32_t)r * r;
+  int32_t xt, yt, i, s;
+
+  i = 0;
+  yt = 0;
+  xt = r;
+  s = (r2 << 1) + r2 * (1 - (r << 1));
+  do
+  {
+    while (s < 0)
+    {
+      s += r2 * ((++yt << 2) + 2);
+    }
+    for (int32_t dy = i + 1; dy <= yt && dy <= r; dy++)
+    {
+      if (xt > half[dy])
+      {
+        half[dy] = xt;
+      }
+    }
+    i = yt;
+    s -= (--xt) * r2 << 2;
+  } while (yt <= xt);
+
+  xt = 0;
+  yt = r;
+  s = (r2 << 1) + r2 * (1 - (r << 1));
+  do
+  {
+    while (s < 0)
+    {
+      s += r2 * ((++xt << 2) + 2);
+    }
+    if (xt > half[yt])
+    {
+      half[yt] = xt;
+    }
+    s -= (--yt) * r2 << 2;
+  } while (xt <= yt);
+
+  for (int16_t k = 0; k < r; k++)
+  {
+    m->inset[k] = r - half[r - k];
+  }
+  m->r = r;
+}
+
+static const uint8_t *corner_mask(int16_t r)
+{
+  for (int i = 0; i < CORNER_MASKS; i++)
+  {
+    if (_corner_masks[i].r == r)
+    {
+      return _corner_masks[i].inset;
+    }
+  }
+  CornerMask *m = &_corner_masks[_corner_next];
+  _corner_next = (_corner_next + 1) % CORNER_MASKS;
+  build_corner_mask(m, r);
+  return m->inset;
+}
+
 Arduino_Canvas::Arduino_Canvas(
     int16_t w, int16_t h, Arduino_G *output, int16_t output_x, int16_t output_y)
     : Arduino_GFX(w, h), _output(output), _output_x(output_x), _output_y(output_y)
@@ -16,6 +143,10 @@ Arduino_Canvas::~Arduino_Canvas()
   {
     free(_framebuffer);
   }
+  if (_rectBuf)
+  {
+    free(_rectBuf);
+  }
 }
 
 bool Arduino_Canvas::begin(int32_t speed)
@@ -121,11 +252,7 @@ void Arduino_Canvas::writeFastHLine(int16_t x, int16_t y,
           w = _max_x - x + 1;
         } // Clip right
 
-        uint16_t *fb = _framebuffer + ((int32_t)y * _width) + x;
-        while (w--)
-        {
-          *(fb++) = color;
-        }
+        fill_pixels(_framebuffer + ((int32_t)y * _width) + x, color, w);
       }
     }
   }
@@ -137,13 +264,158 @@ void Arduino_Canvas::writeFillRectPreclipped(int16_t x, int16_t y,
   uint16_t *row = _framebuffer;
   row += y * _width;
   row += x;
+  if (w == _width)
+  {
+    // Whole rows are contiguous: one fill (fillScreen, full-width clears)
+    fill_pixels(row, color, (uint32_t)w * h);
+    return;
+  }
   for (int j = 0; j < h; j++)
   {
-    for (int i = 0; i < w; i++)
+    fill_pixels(row, color, w);
+    row += _width;
+  }
+}
+
+void Arduino_Canvas::fillRoundRect(int16_t x, int16_t y, int16_t w,
+                                   int16_t h, int16_t r, uint16_t color)
+{
+  int16_t max_radius = ((w < h) ? w : h) / 2; // 1/2 minor axis
+  if (r > max_radius)
+  {
+    r = max_radius;
+  }
+  if (r > CORNER_MAX_R)
+  {
+    Arduino_GFX::fillRoundRect(x, y, w, h, r, color);
+    return;
+  }
+  if ((w <= 0) || (h <= 0))
+  {
+    return;
+  }
+  const uint8_t *inset = (r > 0) ? corner_mask(r) : nullptr;
+
+  // One span per row, clipped once here rather than per corner strip
+  int16_t top = (y < 0) ? 0 : y;
+  int16_t bottom = y + h - 1;
+  if (bottom > _max_y)
+  {
+    bottom = _max_y;
+  }
+  uint16_t *row = _framebuffer + (int32_t)top * _width;
+  for (int16_t j = top; j <= bottom; j++, row += _width)
+  {
+    int16_t k = j - y;
+    int16_t in = 0;
+    if (k < r)
     {
-      row[i] = color;
+      in = inset[k];
+    }
+    else if (k >= h - r)
+    {
+      in = inset[h - 1 - k];
+    }
+    fill_span(row, x + in, x + w - 1 - in, _max_x, color);
+  }
+}
+
+void Arduino_Canvas::fillTriangle(int16_t x0, int16_t y0,
+                                  int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+  int16_t a, b, y, last;
+
+  // Sort coordinates by Y order (y2 >= y1 >= y0)
+  if (y0 > y1)
+  {
+    _swap_int16_t(y0, y1);
+    _swap_int16_t(x0, x1);
+  }
+  if (y1 > y2)
+  {
+    _swap_int16_t(y2, y1);
+    _swap_int16_t(x2, x1);
+  }
+  if (y0 > y1)
+  {
+    _swap_int16_t(y0, y1);
+    _swap_int16_t(x0, x1);
+  }
+  if ((y2 < 0) || (y0 > _max_y))
+  {
+    return;
+  }
+
+  if (y0 == y2)
+  { // Handle awkward all-on-same-line case as its own thing
+    a = b = x0;
+    if (x1 < a)
+      a = x1;
+    else if (x1 > b)
+      b = x1;
+    if (x2 < a)
+      a = x2;
+    else if (x2 > b)
+      b = x2;
+    fill_span(_framebuffer + (int32_t)y0 * _width, a, b, _max_x, color);
+    return;
+  }
+
+  // Same edge stepping as Arduino_GFX::fillTriangle, each scanline
+  // filled straight into the framebuffer
+  int16_t
+      dx01 = x1 - x0,
+      dy01 = y1 - y0,
+      dx02 = x2 - x0,
+      dy02 = y2 - y0,
+      dx12 = x2 - x1,
+      dy12 = y2 - y1;
+  int32_t
+      sa = 0,
+      sb = 0;
+
+  if (y1 == y2)
+  {
+    last = y1; // Include y1 scanline
+  }
+  else
+  {
+    last = y1 - 1; // Skip it
+  }
+
+  for (y = y0; y <= last; y++)
+  {
+    a = x0 + sa / dy01;
+    b = x0 + sb / dy02;
+    sa += dx01;
+    sb += dx02;
+    if (a > b)
+    {
+      _swap_int16_t(a, b);
+    }
+    if (_ordered_in_range(y, 0, _max_y))
+    {
+      fill_span(_framebuffer + (int32_t)y * _width, a, b, _max_x, color);
+    }
+  }
+
+  sa = (int32_t)dx12 * (y - y1);
+  sb = (int32_t)dx02 * (y - y0);
+  int16_t end = (y2 > _max_y) ? _max_y : y2;
+  for (; y <= end; y++)
+  {
+    a = x1 + sa / dy12;
+    b = x0 + sb / dy02;
+    sa += dx12;
+    sb += dx02;
+    if (a > b)
+    {
+      _swap_int16_t(a, b);
+    }
+    if (y >= 0)
+    {
+      fill_span(_framebuffer + (int32_t)y * _width, a, b, _max_x, color);
     }
-    row += _width;
   }
 }
 
@@ -512,6 +784,89 @@ void Arduino_Canvas::flush()
   }
 }
 
+/**
+ * @brief Push one region of the canvas to the output
+ *
+ * Full-width rows are contiguous and go out as one address window. A
+ * narrower region is packed a few rows at a time into _rectBuf, and each
+ * pack is its own window and write: some panels garble pixel writes
+ * continued across calls within one window.
+ */
+void Arduino_Canvas::flush(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  if (!_output)
+  {
+    return;
+  }
+  if (x < 0)
+  {
+    w += x;
+    x = 0;
+  }
+  if (y < 0)
+  {
+    h += y;
+    y = 0;
+  }
+  if (x + w > _width)
+  {
+    w = _width - x;
+  }
+  if (y + h > _height)
+  {
+    h = _height - y;
+  }
+  if ((w <= 0) || (h <= 0))
+  {
+    return;
+  }
+
+  uint16_t *src = _framebuffer + ((int32_t)y * _width) + x;
+  if (w == _width)
+  {
+    _output->draw16bitRGBBitmap(_output_x, _output_y + y, src, w, h);
+    return;
+  }
+
+  if (!_rectBuf)
+  {
+    _rectBuf = (uint16_t *)malloc(CANVAS_RECT_BUF_PIXELS * 2);
+  }
+  int16_t pack = _rectBuf ? (CANVAS_RECT_BUF_PIXELS / w) : 0;
+  if (pack == 0)
+  {
+    // No buffer (or rows too wide for it): a window per row
+    while (h--)
+    {
+      _output->draw16bitRGBBitmap(_output_x + x, _output_y + y++, src, w, 1);
+      src += _width;
+    }
+    return;
+  }
+  while (h > 0)
+  {
+    int16_t rows = (h < pack) ? h : pack;
+    uint16_t *dst = _rectBuf;
+    for (int16_t j = 0; j < rows; j++)
+    {
+      memcpy(dst, src, w * 2);
+      dst += w;
+      src += _width;
+    }
+    _output->draw16bitRGBBitmap(_output_x + x, _output_y + y, _rectBuf, w, rows);
+    y += rows;
+    h -= rows;
+  }
+}
+
+void Arduino_Canvas::flush(const Arduino_Canvas_Rect *rects, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    flush(rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+  }
+}
+
 void Arduino_Canvas::flushQuad(void)
 {
   int16_t y = _output_y;
@@ -6,6 +6,13 @@
 
 #include "../Arduino_GFX.h"
 
+#define CANVAS_RECT_BUF_PIXELS 4096 // Packed rows of a partial-width region flush
+
+struct Arduino_Canvas_Rect
+{
+  int16_t x, y, w, h;
+};
+
 class Arduino_Canvas : public Arduino_GFX
 {
 public:
@@ -17,12 +24,16 @@ public:
   void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
   void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
   void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color) override;
+  void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color) override;
   void drawIndexedBitmap(int16_t x, int16_t y, uint8_t *bitmap, uint16_t *color_index, int16_t w, int16_t h, int16_t x_skip = 0) override;
   void drawIndexedBitmap(int16_t x, int16_t y, uint8_t *bitmap, uint16_t *color_index, uint8_t chroma_key, int16_t w, int16_t h, int16_t x_skip = 0) override;
   void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) override;
   void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, uint16_t transparent_color, int16_t w, int16_t h) override;
   void draw16bitBeRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) override;
   void flush(void) override;
+  void flush(int16_t x, int16_t y, int16_t w, int16_t h);
+  void flush(const Arduino_Canvas_Rect *rects, uint8_t count);
   void flushQuad(void);
 
   uint16_t *getFramebuffer();
@@ -30,6 +41,7 @@ public:
 protected:
   uint16_t *_framebuffer = nullptr;
   uint16_t *_rowBuf = nullptr;
+  uint16_t *_rectBuf = nullptr;
   Arduino_G *_output = nullptr;
   int16_t _output_x, _output_y;
 
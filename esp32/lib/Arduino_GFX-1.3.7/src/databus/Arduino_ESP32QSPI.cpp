@@ -2,6 +2,55 @@
 
 #if defined(ESP32)
 
+// -DHOT_IRAM: the pixel path runs from IRAM, out of the instruction cache
+// that WiFi and TLS share (src/hot_path.h)
+#if defined(HOT_IRAM)
+#define QSPI_HOT IRAM_ATTR
+#else
+#define QSPI_HOT
+#endif
+
+/**
+ * @brief Swap len RGB565 pixels into panel byte order, two per word
+ *
+ * A word-aligned source is read a pixel pair at a time and both pixels are
+ * swapped with one mask-and-shift pair, four words per iteration. Other
+ * sources go pixel by pixel as before.
+ */
+static INLINE void swap_pixels(uint32_t *dst, const uint16_t *src, uint32_t len)
+{
+  uint32_t l2 = len >> 1;
+  uint32_t i = 0;
+  if (((uintptr_t)src & 3) == 0)
+  {
+    const uint32_t *s = (const uint32_t *)src;
+    for (; i + 4 <= l2; i += 4)
+    {
+      uint32_t w0 = s[i], w1 = s[i + 1], w2 = s[i + 2], w3 = s[i + 3];
+      dst[i] = ((w0 & 0x00FF00FF) << 8) | ((w0 >> 8) & 0x00FF00FF);
+      dst[i + 1] = ((w1 & 0x00FF00FF) << 8) | ((w1 >> 8) & 0x00FF00FF);
+      dst[i + 2] = ((w2 & 0x00FF00FF) << 8) | ((w2 >> 8) & 0x00FF00FF);
+      dst[i + 3] = ((w3 & 0x00FF00FF) << 8) | ((w3 >> 8) & 0x00FF00FF);
+    }
+    for (; i < l2; ++i)
+    {
+      uint32_t w = s[i];
+      dst[i] = ((w & 0x00FF00FF) << 8) | ((w >> 8) & 0x00FF00FF);
+    }
+  }
+  else
+  {
+    for (; i < l2; ++i)
+    {
+      MSB_32_16_16_SET(dst[i], src[i * 2], src[i * 2 + 1]);
+    }
+  }
+  if (len & 1)
+  {
+    MSB_16_SET(((uint16_t *)dst)[len - 1], src[len - 1]);
+  }
+}
+
 /**
  * @brief Arduino_ESP32QSPI
  *
@@ -67,7 +116,7 @@ bool Arduino_ESP32QSPI::begin(int32_t speed, int8_t dataMode)
       .clock_speed_hz = _speed,
       .spics_io_num = -1, // avoid use system CS control
       .flags = SPI_DEVICE_HALFDUPLEX,
-      .queue_size = 1,
+      .queue_size = 2, // Ping-pong transactions (writeRepeat, QSPI_ASYNC_DMA)
   };
   ret = spi_bus_add_device(QSPI_SPI_HOST, &devcfg, &_handle);
   if (ret != ESP_OK)
@@ -83,6 +132,27 @@ bool Arduino_ESP32QSPI::begin(int32_t speed, int8_t dataMode)
 
   memset(&_spi_tran_ext, 0, sizeof(_spi_tran_ext));
   _spi_tran = (spi_transaction_t *)&_spi_tran_ext;
+  memset(_rep_tran, 0, sizeof(_rep_tran));
+
+  if (!_dma_buf[0])
+  {
+    _dma_buf[0] = (uint32_t *)heap_caps_malloc(SPI_MAX_PIXELS_AT_ONCE * 2, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    _dma_buf[1] = (uint32_t *)heap_caps_malloc(SPI_MAX_PIXELS_AT_ONCE * 2, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    _bounce = _dma_buf[0] && _dma_buf[1];
+    if (!_bounce)
+    {
+      // One chunk at a time from the member buffer, as before
+      heap_caps_free(_dma_buf[0]);
+      heap_caps_free(_dma_buf[1]);
+      _dma_buf[0] = _buffer32;
+      _dma_buf[1] = NULL;
+    }
+  }
+
+#if defined(QSPI_ASYNC_DMA)
+  memset(_dma_tran, 0, sizeof(_dma_tran));
+  _async = _bounce; // Fall back to polling without both buffers
+#endif
 
   return true;
 }
@@ -107,6 +177,12 @@ void Arduino_ESP32QSPI::endWrite()
 {
   if (_is_shared_interface)
   {
+#if defined(QSPI_ASYNC_DMA)
+    if (_dma_inflight)
+    {
+      QUEUE_WAIT(); // Another device must not see a transfer in flight
+    }
+#endif
     spi_device_acquire_bus(_handle, portMAX_DELAY);
   }
 }
@@ -262,13 +338,83 @@ void Arduino_ESP32QSPI::writeRepeat(uint16_t p, uint32_t len)
   uint32_t c32;
   MSB_32_16_16_SET(c32, p, p);
 
+#if defined(QSPI_ASYNC_DMA)
+  if (_async)
+  {
+    CS_LOW(); // Waits for any previous transfer, so _dma_buf[0] is free
+    l = (bufLen + 1) / 2;
+    for (uint32_t i = 0; i < l; i++)
+    {
+      _dma_buf[0][i] = c32;
+    }
+    // Every chunk sends the same buffer; only the transactions alternate
+    while (len)
+    {
+      xferLen = (bufLen <= len) ? bufLen : len;
+      QUEUE_START(_dma_buf[0], xferLen << 4, first_send);
+      first_send = false;
+      len -= xferLen;
+    }
+    return; // CS stays low until the last chunk is collected
+  }
+#endif
+
+  uint32_t *buf32 = _dma_buf[0];
   l = (bufLen + 1) / 2;
   for (uint32_t i = 0; i < l; i++)
   {
-    _buffer32[i] = c32;
+    buf32[i] = c32;
   }
 
   CS_LOW();
+  if (len > bufLen)
+  {
+    // Several chunks of the same buffer: queue them two at a time, so the
+    // driver starts each from its interrupt as the previous one ends,
+    // without a polling round trip (and a bus gap) between chunks
+    spi_transaction_t *done;
+    uint8_t next = 0;
+    uint8_t inflight = 0;
+    while (len)
+    {
+      xferLen = (bufLen <= len) ? bufLen : len;
+      if (inflight == 2)
+      {
+        spi_device_get_trans_result(_handle, &done, portMAX_DELAY);
+        inflight--;
+      }
+      spi_transaction_ext_t *t = &_rep_tran[next];
+      if (first_send)
+      {
+        t->base.flags = SPI_TRANS_MODE_QIO;
+        t->base.cmd = 0x32;
+        t->base.addr = 0x003C00;
+        first_send = false;
+      }
+      else
+      {
+        t->base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
+                        SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+      }
+      t->base.tx_buffer = buf32;
+      t->base.length = xferLen << 4;
+      if (spi_device_queue_trans(_handle, (spi_transaction_t *)t, portMAX_DELAY) != ESP_OK)
+      {
+        log_e("spi_device_queue_trans error");
+        break;
+      }
+      inflight++;
+      next ^= 1;
+      len -= xferLen;
+    }
+    while (inflight--)
+    {
+      spi_device_get_trans_result(_handle, &done, portMAX_DELAY);
+    }
+    CS_HIGH();
+    return;
+  }
+
   // Issue pixels in blocks from temp buffer
   while (len) // While pixels remain
   {
@@ -286,7 +432,7 @@ void Arduino_ESP32QSPI::writeRepeat(uint16_t p, uint32_t len)
       _spi_tran_ext.base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
                                  SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
     }
-    _spi_tran_ext.base.tx_buffer = _buffer16;
+    _spi_tran_ext.base.tx_buffer = buf32;
     _spi_tran_ext.base.length = xferLen << 4;
 
     POLL_START();
@@ -303,13 +449,87 @@ void Arduino_ESP32QSPI::writeRepeat(uint16_t p, uint32_t len)
  * @param data
  * @param len
  */
-void Arduino_ESP32QSPI::writePixels(uint16_t *data, uint32_t len)
+void QSPI_HOT Arduino_ESP32QSPI::writePixels(uint16_t *data, uint32_t len)
 {
 
   CS_LOW();
-  uint32_t l, l2;
-  uint16_t p1, p2;
+  uint32_t l;
   bool first_send = true;
+#if defined(QSPI_ASYNC_DMA)
+  if (_async)
+  {
+    while (len)
+    {
+      l = (len > SPI_MAX_PIXELS_AT_ONCE) ? SPI_MAX_PIXELS_AT_ONCE : len;
+
+      // Both buffers queued: the oldest one is the buffer to fill next
+      if (_dma_inflight == 2)
+      {
+        QUEUE_WAIT();
+      }
+      uint32_t *buf32 = _dma_buf[_dma_next];
+      swap_pixels(buf32, data, l);
+      data += l;
+
+      QUEUE_START(buf32, l << 4, first_send);
+      first_send = false;
+      len -= l;
+    }
+    return; // CS stays low until the last chunk is collected
+  }
+#endif
+  if (_bounce && len > SPI_MAX_PIXELS_AT_ONCE)
+  {
+    // Both bounce buffers on the bus back to back: chunk N+1 is swapped
+    // out of the source (a PSRAM framebuffer, through the cache) while
+    // chunk N is being sent
+    spi_transaction_t *done;
+    uint8_t next = 0;
+    uint8_t inflight = 0;
+    while (len)
+    {
+      l = (len > SPI_MAX_PIXELS_AT_ONCE) ? SPI_MAX_PIXELS_AT_ONCE : len;
+      if (inflight == 2)
+      {
+        // The oldest transaction is the one that used buffer next
+        spi_device_get_trans_result(_handle, &done, portMAX_DELAY);
+        inflight--;
+      }
+      swap_pixels(_dma_buf[next], data, l);
+      data += l;
+
+      spi_transaction_ext_t *t = &_rep_tran[next];
+      if (first_send)
+      {
+        t->base.flags = SPI_TRANS_MODE_QIO;
+        t->base.cmd = 0x32;
+        t->base.addr = 0x003C00;
+        first_send = false;
+      }
+      else
+      {
+        t->base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
+                        SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+      }
+      t->base.tx_buffer = _dma_buf[next];
+      t->base.length = l << 4;
+      if (spi_device_queue_trans(_handle, (spi_transaction_t *)t, portMAX_DELAY) != ESP_OK)
+      {
+        log_e("spi_device_queue_trans error");
+        break;
+      }
+      inflight++;
+      next ^= 1;
+      len -= l;
+    }
+    while (inflight--)
+    {
+      spi_device_get_trans_result(_handle, &done, portMAX_DELAY);
+    }
+    CS_HIGH();
+    return;
+  }
+
   while (len)
   {
     l = (len > SPI_MAX_PIXELS_AT_ONCE) ? SPI_MAX_PIXELS_AT_ONCE : len;
@@ -326,20 +546,10 @@ void Arduino_ESP32QSPI::writePixels(uint16_t *data, uint32_t len)
       _spi_tran_ext.base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
                                  SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
     }
-    l2 = l >> 1;
-    for (uint32_t i = 0; i < l2; ++i)
-    {
-      p1 = *data++;
-      p2 = *data++;
-      MSB_32_16_16_SET(_buffer32[i], p1, p2);
-    }
-    if (l & 1)
-    {
-      p1 = *data++;
-      MSB_16_SET(_buffer16[l - 1], p1);
-    }
+    swap_pixels(_dma_buf[0], data, l);
+    data += l;
 
-    _spi_tran_ext.base.tx_buffer = _buffer32;
+    _spi_tran_ext.base.tx_buffer = _dma_buf[0];
     _spi_tran_ext.base.length = l << 4;
 
     POLL_START();
@@ -508,6 +718,18 @@ INLINE void Arduino_ESP32QSPI::CS_HIGH(void)
  */
 INLINE void Arduino_ESP32QSPI::CS_LOW(void)
 {
+#if defined(QSPI_ASYNC_DMA)
+  // Collect the tail of the last queued write and end it before anything
+  // else is sent (polling transactions may not overlap queued ones)
+  if (_dma_inflight)
+  {
+    while (_dma_inflight)
+    {
+      QUEUE_WAIT();
+    }
+    CS_HIGH();
+  }
+#endif
   *_csPortClr = _csPinMask;
 }
 
@@ -539,4 +761,63 @@ INLINE void Arduino_ESP32QSPI::POLL_END()
   // }
 }
 
+#if defined(QSPI_ASYNC_DMA)
+/**
+ * @brief QUEUE_START
+ *
+ * Queue a pixel chunk on the next ping-pong transaction. If both
+ * transactions are still queued, waits for the oldest first.
+ *
+ * @param buf
+ * @param bits
+ * @param first_send
+ */
+INLINE void Arduino_ESP32QSPI::QUEUE_START(uint32_t *buf, uint32_t bits, bool first_send)
+{
+  if (_dma_inflight == 2)
+  {
+    QUEUE_WAIT();
+  }
+  spi_transaction_ext_t *t = &_dma_tran[_dma_next];
+  if (first_send)
+  {
+    t->base.flags = SPI_TRANS_MODE_QIO;
+    t->base.cmd = 0x32;
+    t->base.addr = 0x003C00;
+  }
+  else
+  {
+    t->base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
+                    SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+  }
+  t->base.tx_buffer = buf;
+  t->base.length = bits;
+
+  esp_err_t ret = spi_device_queue_trans(_handle, (spi_transaction_t *)t, portMAX_DELAY);
+  if (ret != ESP_OK)
+  {
+    log_e("spi_device_queue_trans error: %d", ret);
+    return;
+  }
+  _dma_inflight++;
+  _dma_next ^= 1;
+}
+
+/**
+ * @brief QUEUE_WAIT
+ *
+ * Collect the oldest queued transaction (results come back in order).
+ */
+INLINE void Arduino_ESP32QSPI::QUEUE_WAIT()
+{
+  spi_transaction_t *done;
+  esp_err_t ret = spi_device_get_trans_result(_handle, &done, portMAX_DELAY);
+  if (ret != ESP_OK)
+  {
+    log_e("spi_device_get_trans_result error: %d", ret);
+  }
+  _dma_inflight--;
+}
+#endif
+
 #endif // #if defined(ESP32)
@@ -12,6 +12,18 @@
 #define QSPI_SPI_HOST SPI2_HOST
 #define QSPI_DMA_CHANNEL SPI_DMA_CH_AUTO
 
+// QSPI_ASYNC_DMA: writePixels / writeRepeat queue their chunks on two
+// ping-pong DMA buffers instead of polling, so the next chunk is converted
+// while the previous one is on the bus. The last chunk is left in flight
+// and waited for by the next bus access (CS_LOW), so a caller can prepare
+// its next band while this one is still being sent.
+//
+// Pixels are swapped into two bounce buffers in internal DMA RAM, whatever
+// the source. A large bus object may itself be placed in PSRAM, and then
+// spi_master would copy every chunk once more. Without QSPI_ASYNC_DMA a
+// writePixels of several chunks still keeps both buffers on the bus back to
+// back, and returns once the last one is sent.
+
 class Arduino_ESP32QSPI : public Arduino_DataBus
 {
 public:
@@ -44,6 +56,10 @@ private:
   INLINE void CS_LOW(void);
   INLINE void POLL_START();
   INLINE void POLL_END();
+#if defined(QSPI_ASYNC_DMA)
+  INLINE void QUEUE_START(uint32_t *buf, uint32_t bits, bool first_send);
+  INLINE void QUEUE_WAIT();
+#endif
 
   int8_t _cs, _sck, _mosi, _miso, _quadwp, _quadhd;
   bool _is_shared_interface;
@@ -61,6 +77,15 @@ private:
     uint16_t _buffer16[SPI_MAX_PIXELS_AT_ONCE];
     uint32_t _buffer32[SPI_MAX_PIXELS_AT_ONCE / 2];
   };
+  uint32_t *_dma_buf[2] = {NULL, NULL}; ///< Ping-pong bounce buffers in internal DMA RAM
+  bool _bounce = false;                 ///< Both allocated (else _dma_buf[0] = _buffer32)
+  spi_transaction_ext_t _rep_tran[2];   ///< Back-to-back chunks of polled writeRepeat / writePixels
+#if defined(QSPI_ASYNC_DMA)
+  bool _async = false;                 ///< Queued mode available (_bounce)
+  spi_transaction_ext_t _dma_tran[2];  ///< One queued transaction per buffer
+  uint8_t _dma_next = 0;               ///< Buffer / transaction to fill next
+  uint8_t _dma_inflight = 0;           ///< Queued, result not yet collected
+#endif
 };
 
 #endif // #if defined(ESP32)
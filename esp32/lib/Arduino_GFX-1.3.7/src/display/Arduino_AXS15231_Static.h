@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Arduino_AXS15231.h"
+
+/**
+ * @brief AXS15231 with its bus type fixed at compile time
+ *
+ * The generic driver reaches the bus through Arduino_DataBus virtuals, and
+ * every line, rectangle and bitmap goes Arduino_TFT -> writeAddrWindow ->
+ * bus, each step a virtual call. Here the bus class is a template
+ * parameter and the class is final: the address window is inlined, bus
+ * calls are direct (qualified, no vtable), and lines, rectangles, pixels
+ * and RGB565 bitmaps each take one virtual call from Arduino_GFX instead
+ * of four or five. Behaviour is that of Arduino_AXS15231.
+ *
+ * Bus must be the concrete class the panel was constructed with.
+ */
+template <class Bus>
+class Arduino_AXS15231_Static final : public Arduino_AXS15231
+{
+public:
+  Arduino_AXS15231_Static(Bus *bus, int8_t rst = GFX_NOT_DEFINED, uint8_t r = 0, bool ips = false,
+                          int16_t w = AXS15231_MAXWIDTH, int16_t h = AXS15231_MAXHEIGHT)
+      : Arduino_AXS15231(bus, rst, r, ips, w, h), _fast_bus(bus)
+  {
+  }
+
+  using Arduino_TFT::draw16bitRGBBitmap;
+
+  void startWrite(void) override
+  {
+    _fast_bus->Bus::beginWrite();
+  }
+
+  void endWrite(void) override
+  {
+    _fast_bus->Bus::endWrite();
+  }
+
+  void writeAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) override
+  {
+    window(x, y, w, h);
+  }
+
+  void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) override
+  {
+    window(x, y, 1, 1);
+    _fast_bus->Bus::writeRepeat(color, 1);
+  }
+
+  void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override
+  {
+    window(x, y, w, h);
+    _fast_bus->Bus::writeRepeat(color, (uint32_t)w * h);
+  }
+
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override
+  {
+    if (w < 0)
+    {
+      x += w + 1;
+      w = -w;
+    }
+    if (!_ordered_in_range(y, 0, _max_y) || w == 0 || x > _max_x || x + w - 1 < 0)
+    {
+      return;
+    }
+    int16_t x2 = x + w - 1;
+    if (x < 0)
+    {
+      x = 0;
+    }
+    if (x2 > _max_x)
+    {
+      x2 = _max_x;
+    }
+    writeFillRectPreclipped(x, y, x2 - x + 1, 1, color);
+  }
+
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override
+  {
+    if (h < 0)
+    {
+      y += h + 1;
+      h = -h;
+    }
+    if (!_ordered_in_range(x, 0, _max_x) || h == 0 || y > _max_y || y + h - 1 < 0)
+    {
+      return;
+    }
+    int16_t y2 = y + h - 1;
+    if (y < 0)
+    {
+      y = 0;
+    }
+    if (y2 > _max_y)
+    {
+      y2 = _max_y;
+    }
+    writeFillRectPreclipped(x, y, 1, y2 - y + 1, color);
+  }
+
+  void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) override
+  {
+    if (x < 0 || y < 0 || x + w - 1 > _max_x || y + h - 1 > _max_y)
+    {
+      Arduino_TFT::draw16bitRGBBitmap(x, y, bitmap, w, h); // Clipped or off screen
+      return;
+    }
+    _fast_bus->Bus::beginWrite();
+    window(x, y, w, h);
+    _fast_bus->Bus::writePixels(bitmap, (uint32_t)w * h);
+    _fast_bus->Bus::endWrite();
+  }
+
+private:
+  // Arduino_AXS15231::writeAddrWindow, with direct bus calls
+  __attribute__((always_inline)) inline void window(int16_t x, int16_t y, uint16_t w, uint16_t h)
+  {
+    if ((x != _currentX) || (w != _currentW))
+    {
+      _currentX = x;
+      _currentW = w;
+      x += _xStart;
+      _fast_bus->Bus::writeC8D16D16(AXS15231_W_CASET, x, x + w - 1);
+    }
+    if ((y != _currentY) || (h != _currentH))
+    {
+      _currentY = y;
+      _currentH = h;
+      y += _yStart;
+      _fast_bus->Bus::writeC8D16D16(AXS15231_W_PASET, y, y + h - 1);
+    }
+    _fast_bus->Bus::writeCommand(AXS15231_W_RAMWR);
+  }
+
+  Bus *_fast_bus;
+};
@@ -0,0 +1,333 @@
+/**
+ * Host benchmarks for places_db and world_map (env:native).
+ *
+ * Runs the real lookup and RLE code against esp32/data (places.bin and
+ * maps/tiles.bin), so it can be profiled with perf or valgrind:
+ *
+ *   pio run -e native
+ *   .pio/build/native/program [--filter=prefix] [--data=dir] [--no-psram]
+ *                             [--min-time=seconds]
+ *
+ * Each benchmark grows its iteration count until one run takes at least
+ * --min-time, then reports time per iteration, Google Benchmark style.
+ * --no-psram runs without PSRAM: world_map draws straight from RLE and the
+ * places array lives in ordinary heap. A dir of compile_places.py
+ * --synthetic output as --data times the places cases on a larger
+ * database; the load time and heap of places.bin are printed first.
+ */
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <Arduino_GFX_Library.h>
+#include "places_db.h"
+#include "world_map.h"
+#include "vector_map.h"
+#include "city_dots.h"
+#include <chrono>
+
+// ------------------------------------------------------------------
+// Harness
+// ------------------------------------------------------------------
+
+class BenchState {
+public:
+    explicit BenchState(uint64_t iterations) : _iterations(iterations) {}
+
+    // while (state.keep_running()) { ... } runs the body iterations() times
+    bool keep_running() { return _done++ < _iterations; }
+
+    uint64_t iterations() const { return _iterations; }
+    void skip(const char* reason) { _skip = reason; }
+    const char* skipped() const { return _skip; }
+
+private:
+    uint64_t _iterations;
+    uint64_t _done = 0;
+    const char* _skip = nullptr;
+};
+
+typedef void (*BenchFn)(BenchState&);
+
+struct Benchmark {
+    const char* name;
+    BenchFn fn;
+};
+
+static const int MAX_BENCHMARKS = 32;
+static Benchmark _benchmarks[MAX_BENCHMARKS];
+static int _benchmark_count = 0;
+
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, BenchFn fn) {
+        if (_benchmark_count < MAX_BENCHMARKS) _benchmarks[_benchmark_count++] = {name, fn};
+    }
+};
+
+#define BENCHMARK(fn) static BenchRegistrar _reg_##fn(#fn, fn)
+
+static double run_seconds(BenchFn fn, BenchState& state) {
+    auto start = std::chrono::steady_clock::now();
+    fn(state);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void run_benchmark(const Benchmark& b, double min_time) {
+    uint64_t iterations = 1;
+    for (;;) {
+        BenchState state(iterations);
+        Serial.set_quiet(true);
+        double secs = run_seconds(b.fn, state);
+        Serial.set_quiet(false);
+        if (state.skipped()) {
+            printf("%-28s %14s   (%s)\n", b.name, "skipped", state.skipped());
+            return;
+        }
+        if (secs >= min_time || iterations >= (1ull << 30)) {
+            double ns = secs * 1e9 / iterations;
+            printf("%-28s %12.0f ns %12llu\n", b.name, ns, (unsigned long long)iterations);
+            return;
+        }
+        // Aim just past min_time from what this run measured
+        double scale = secs > 0 ? min_time * 1.4 / secs : 100;
+        iterations = (uint64_t)(iterations * min(max(scale, 2.0), 100.0));
+    }
+}
+
+// ------------------------------------------------------------------
+// Inputs
+// ------------------------------------------------------------------
+
+static uint32_t _rng = 1;
+
+// xorshift32, reseeded per benchmark run: the same points every time
+static uint32_t next_random() {
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+static void random_point(float* lat, float* lon) {
+    *lat = (next_random() % 13000) / 100.0f - 60.0f;
+    *lon = (next_random() % 36000) / 100.0f - 180.0f;
+}
+
+static uint8_t _packed[MAP_PACKED_BYTES];
+
+static const uint8_t* const SLICES[] = {
+    map_slice_americas, map_slice_europe_africa, map_slice_asia, map_slice_pacific,
+};
+static const size_t* const SLICE_SIZES[] = {
+    &map_slice_americas_size, &map_slice_europe_africa_size,
+    &map_slice_asia_size, &map_slice_pacific_size,
+};
+
+// ------------------------------------------------------------------
+// Benchmarks
+// ------------------------------------------------------------------
+
+static void places_nearest(BenchState& state) {
+    if (!places_db_loaded()) return state.skip("no places.bin");
+    _rng = 0x52574C31;
+    while (state.keep_running()) {
+        float lat, lon;
+        random_point(&lat, &lon);
+        places_db_find_nearest(lat, lon);
+    }
+}
+BENCHMARK(places_nearest);
+
+static void places_knn20(BenchState& state) {
+    if (!places_db_loaded()) return state.skip("no places.bin");
+    _rng = 0x52574C31;
+    PlaceHandle out[20];
+    while (state.keep_running()) {
+        float lat, lon;
+        random_point(&lat, &lon);
+        places_db_find_k_nearest(lat, lon, 20, out);
+    }
+}
+BENCHMARK(places_knn20);
+
+// The nearest lookup by each strategy (places_db.h)
+static void places_nearest_by(BenchState& state, PlacesSearch strategy) {
+    if (!places_db_loaded()) return state.skip("no places.bin");
+    _rng = 0x52574C31;
+    PlaceHandle best;
+    while (state.keep_running()) {
+        float lat, lon;
+        random_point(&lat, &lon);
+        places_db_find_k_nearest_by(strategy, lat, lon, 1, &best);
+    }
+}
+
+static void places_index(BenchState& state) { places_nearest_by(state, PLACES_SEARCH_INDEX); }
+static void places_linear(BenchState& state) { places_nearest_by(state, PLACES_SEARCH_LINEAR); }
+static void places_parallel(BenchState& state) { places_nearest_by(state, PLACES_SEARCH_PARALLEL); }
+BENCHMARK(places_index);
+BENCHMARK(places_linear);
+BENCHMARK(places_parallel);
+
+// Name search for partial and misspelt city names, in turn
+static const char* const SEARCH_QUERIES[] = {
+    "sao", "vien", "new york", "san fr", "muenchen", "viena", "yorkk", "cape town",
+};
+static const int SEARCH_QUERY_COUNT = sizeof(SEARCH_QUERIES) / sizeof(SEARCH_QUERIES[0]);
+
+static void places_search_prefix(BenchState& state) {
+    if (!places_db_has_search()) return state.skip("no search index");
+    PlaceHandle out[10];
+    int i = 0;
+    while (state.keep_running()) {
+        places_db_search_prefix(SEARCH_QUERIES[i++ % SEARCH_QUERY_COUNT], 10, out);
+    }
+}
+BENCHMARK(places_search_prefix);
+
+static void places_search_fuzzy(BenchState& state) {
+    if (!places_db_has_search()) return state.skip("no search index");
+    PlaceHandle out[10];
+    int i = 0;
+    while (state.keep_running()) {
+        places_db_search_fuzzy(SEARCH_QUERIES[i++ % SEARCH_QUERY_COUNT], 10, out);
+    }
+}
+BENCHMARK(places_search_fuzzy);
+
+// Country play: the nearest place's country, then its best 20
+static void places_country_best20(BenchState& state) {
+    if (!places_db_has_countries()) return state.skip("no country index");
+    _rng = 0x52574C31;
+    PlaceHandle out[20];
+    while (state.keep_running()) {
+        float lat, lon;
+        random_point(&lat, &lon);
+        PlaceHandle nearest;
+        if (places_db_find_k_nearest(lat, lon, 1, &nearest) == 1) {
+            places_db_country_best(places_db_country_of(nearest), 20, out);
+        }
+    }
+}
+BENCHMARK(places_country_best20);
+
+static void map_decode_slice(BenchState& state) {
+    int i = 0;
+    while (state.keep_running()) {
+        world_map_decode_slice(SLICES[i % 4], *SLICE_SIZES[i % 4], _packed);
+        i++;
+    }
+}
+BENCHMARK(map_decode_slice);
+
+// Every tile of the zoom level in turn, file read included
+static void map_decode_tile(BenchState& state, int zoom) {
+    int count = world_map_tile_count(zoom);
+    if (count == 0) return state.skip("no tiles.bin");
+    int i = 0;
+    while (state.keep_running()) {
+        world_map_decode_tile(zoom, i++ % count, _packed);
+    }
+}
+
+static void map_decode_tile_z2(BenchState& state) { map_decode_tile(state, 2); }
+static void map_decode_tile_z3(BenchState& state) { map_decode_tile(state, 3); }
+static void map_decode_tile_z4(BenchState& state) { map_decode_tile(state, 4); }
+static void map_decode_tile_z5(BenchState& state) { map_decode_tile(state, 5); }
+BENCHMARK(map_decode_tile_z2);
+BENCHMARK(map_decode_tile_z3);
+BENCHMARK(map_decode_tile_z4);
+BENCHMARK(map_decode_tile_z5);
+
+// draw_map_slice into an offscreen framebuffer: decoded-slice cache and
+// band expansion with PSRAM, straight from RLE without
+static void map_draw_slice(BenchState& state) {
+    static Arduino_Canvas canvas(MAP_WIDTH, MAP_HEIGHT);
+    int i = 0;
+    while (state.keep_running()) {
+        draw_map_slice(&canvas, SLICES[i % 4], *SLICE_SIZES[i % 4], 0, 0);
+        i++;
+    }
+}
+BENCHMARK(map_draw_slice);
+
+// draw_map_view at random 5x pixel offsets: tile composition and band
+// expansion, tiles from the tile cache with PSRAM
+static void map_draw_view(BenchState& state) {
+    if (world_map_tile_count(5) == 0) return state.skip("no tiles.bin");
+    static Arduino_Canvas canvas(MAP_WIDTH, MAP_HEIGHT);
+    while (state.keep_running()) {
+        MapView v = {5, (int8_t)(next_random() % 4),
+                     (int16_t)(next_random() % (MAP_WIDTH * 4 + 1)),
+                     (int16_t)(next_random() % (MAP_HEIGHT * 4 + 1))};
+        draw_map_view(&canvas, v, 0, 0);
+    }
+}
+BENCHMARK(map_draw_view);
+
+// vector_map_render at random zoom levels and offsets
+static void map_render_vector(BenchState& state) {
+    if (!vector_map_ready()) return state.skip("no vector.bin");
+    while (state.keep_running()) {
+        int zoom = 2 + next_random() % (MAP_ZOOM_LIMIT - 1);
+        MapView v = {(int8_t)zoom, (int8_t)(next_random() % 4),
+                     (int16_t)(next_random() % (MAP_WIDTH * (zoom - 1) + 1)),
+                     (int16_t)(next_random() % (MAP_HEIGHT * (zoom - 1) + 1))};
+        vector_map_render(v, _packed);
+    }
+}
+BENCHMARK(map_render_vector);
+
+// city_dots_draw on random views at every zoom level (dot lists built
+// before timing starts)
+static void map_city_dots(BenchState& state) {
+    if (!places_db_loaded()) return state.skip("no places.bin");
+    for (int zoom = 1; zoom <= MAP_ZOOM_LIMIT; zoom++) city_dots_draw({(int8_t)zoom, 0, 0, 0}, _packed);
+    while (state.keep_running()) {
+        int zoom = 1 + next_random() % MAP_ZOOM_LIMIT;
+        MapView v = {(int8_t)zoom, (int8_t)(next_random() % 4),
+                     (int16_t)(next_random() % (MAP_WIDTH * (zoom - 1) + 1)),
+                     (int16_t)(next_random() % (MAP_HEIGHT * (zoom - 1) + 1))};
+        city_dots_draw(v, _packed);
+    }
+}
+BENCHMARK(map_city_dots);
+
+// ------------------------------------------------------------------
+// Main
+// ------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    const char* filter = "";
+    double min_time = 0.5;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--filter=", 9) == 0) {
+            filter = argv[i] + 9;
+        } else if (strncmp(argv[i], "--data=", 7) == 0) {
+            LittleFS.set_root(argv[i] + 7);
+        } else if (strcmp(argv[i], "--no-psram") == 0) {
+            native_set_psram(false);
+        } else if (strncmp(argv[i], "--min-time=", 11) == 0) {
+            min_time = atof(argv[i] + 11);
+        } else {
+            fprintf(stderr, "usage: %s [--filter=prefix] [--data=dir] [--no-psram] "
+                            "[--min-time=seconds]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    places_db_init();
+    PlacesLoadStats load;
+    if (places_db_load_stats(&load)) {
+        printf("places.bin: %u places (%s), read %.1f ms, tables %.1f ms, %u KB kept\n",
+               (unsigned)places_db_count(), load.storage, load.read_us / 1000.0,
+               load.build_us / 1000.0, (unsigned)((load.sram_bytes + load.psram_bytes) / 1024));
+    }
+
+    printf("\n%-28s %15s %12s\n", "Benchmark", "Time", "Iterations");
+    printf("----------------------------------------------------------------\n");
+    for (int i = 0; i < _benchmark_count; i++) {
+        if (strncmp(_benchmarks[i].name, filter, strlen(filter)) != 0) continue;
+        run_benchmark(_benchmarks[i], min_time);
+    }
+    return 0;
+}
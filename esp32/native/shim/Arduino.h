@@ -0,0 +1,57 @@
+/**
+ * Host shim: the part of the Arduino core that places_db, world_map and
+ * serial_cmd use, for the native benchmark build (env:native).
+ */
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <type_traits>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+
+// Arduino's min/max/constrain are macros that accept mixed operand types
+template <typename A, typename B>
+static inline typename std::common_type<A, B>::type min(A a, B b) { return b < a ? b : a; }
+template <typename A, typename B>
+static inline typename std::common_type<A, B>::type max(A a, B b) { return a < b ? b : a; }
+template <typename T, typename L, typename H>
+static inline T constrain(T x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+// PSRAM is plain heap on the host; native_set_psram(false) makes
+// psramFound() fail, as on a board without it
+bool psramFound();
+void* ps_malloc(size_t size);
+void* ps_calloc(size_t n, size_t size);
+void native_set_psram(bool present);
+
+class HardwareSerial {
+public:
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* s);
+    size_t println(const char* s = "");
+    int available() { return 0; }
+    int read() { return -1; }
+
+    // Drop all output (the benchmark loops call code that logs per call)
+    void set_quiet(bool quiet) { _quiet = quiet; }
+
+private:
+    bool _quiet = false;
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_ARDUINO_H
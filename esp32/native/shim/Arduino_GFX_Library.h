@@ -0,0 +1,53 @@
+/**
+ * Host shim: Arduino_GFX reduced to what world_map draws with, plus an
+ * offscreen RGB565 canvas to draw into. Text is positioned but not
+ * rasterized.
+ */
+
+#ifndef NATIVE_ARDUINO_GFX_LIBRARY_H
+#define NATIVE_ARDUINO_GFX_LIBRARY_H
+
+#include <Arduino.h>
+
+#define BLACK 0x0000
+#define WHITE 0xFFFF
+#define CYAN  0x07FF
+
+class Arduino_GFX {
+public:
+    Arduino_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+    virtual ~Arduino_GFX() {}
+
+    virtual void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap,
+                                    int16_t w, int16_t h) = 0;
+
+    void setCursor(int16_t x, int16_t y) { _cursor_x = x; _cursor_y = y; }
+    void setTextColor(uint16_t c) { _text_fg = _text_bg = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { _text_fg = c; _text_bg = bg; }
+    void setTextSize(uint8_t s) { _text_size = s; }
+    size_t print(const char* s) { size_t n = strlen(s); _cursor_x += n * 6 * _text_size; return n; }
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+protected:
+    int16_t _width, _height;
+    int16_t _cursor_x = 0, _cursor_y = 0;
+    uint16_t _text_fg = WHITE, _text_bg = BLACK;
+    uint8_t _text_size = 1;
+};
+
+class Arduino_Canvas : public Arduino_GFX {
+public:
+    Arduino_Canvas(int16_t w, int16_t h);
+    ~Arduino_Canvas() override;
+
+    void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap,
+                            int16_t w, int16_t h) override;
+    uint16_t* getFramebuffer() { return _fb; }
+
+private:
+    uint16_t* _fb;
+};
+
+#endif // NATIVE_ARDUINO_GFX_LIBRARY_H
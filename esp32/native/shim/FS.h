@@ -0,0 +1,27 @@
+/**
+ * Host shim: Arduino fs::File over stdio.
+ */
+
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include <Arduino.h>
+#include <memory>
+
+class File {
+public:
+    File() {}
+    explicit File(FILE* f) : _f(f, fclose) {}
+
+    size_t read(uint8_t* buf, size_t size) { return _f ? fread(buf, 1, size, _f.get()) : 0; }
+    bool seek(uint32_t pos) { return _f && fseek(_f.get(), pos, SEEK_SET) == 0; }
+    size_t size();
+    bool setBufferSize(size_t size) { return _f && setvbuf(_f.get(), nullptr, _IOFBF, size) == 0; }
+    void close() { _f.reset(); }
+    explicit operator bool() const { return _f != nullptr; }
+
+private:
+    std::shared_ptr<FILE> _f;   // Copies share the handle, like the real File
+};
+
+#endif // NATIVE_FS_H
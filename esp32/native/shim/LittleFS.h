@@ -0,0 +1,26 @@
+/**
+ * Host shim: LittleFS paths map onto a host directory (esp32/data by
+ * default, the same tree `pio run -t uploadfs` flashes).
+ */
+
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+#include "FS.h"
+
+class LittleFSFS {
+public:
+    bool begin(bool format_on_fail = false) { (void)format_on_fail; return true; }
+    bool format() { return true; }
+    File open(const char* path, const char* mode = "r");
+    bool exists(const char* path);
+
+    void set_root(const char* dir);
+
+private:
+    char _root[256] = "data";
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // NATIVE_LITTLEFS_H
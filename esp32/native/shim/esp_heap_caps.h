@@ -0,0 +1,33 @@
+/**
+ * Host shim: heap_caps allocations are plain heap allocations. There is
+ * one heap: the free size of MALLOC_CAP_INTERNAL follows what malloc has
+ * handed out (glibc mallinfo2), and MALLOC_CAP_SPIRAM never changes.
+ */
+
+#ifndef NATIVE_ESP_HEAP_CAPS_H
+#define NATIVE_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <malloc.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+static inline void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+    (void)caps;
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static inline void heap_caps_free(void* ptr) { free(ptr); }
+
+static inline size_t heap_caps_get_free_size(uint32_t caps) {
+    static const size_t HEAP_SIZE = (size_t)1 << 30;
+    if (caps & MALLOC_CAP_SPIRAM) return HEAP_SIZE;
+    struct mallinfo2 mi = mallinfo2();
+    size_t used = mi.uordblks + mi.hblkhd;   // hblkhd: large blocks malloc mmaps
+    return used < HEAP_SIZE ? HEAP_SIZE - used : 0;
+}
+
+#endif // NATIVE_ESP_HEAP_CAPS_H
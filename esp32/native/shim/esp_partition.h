@@ -0,0 +1,55 @@
+/**
+ * Host shim: there is no partition table, so places_db falls back to
+ * LittleFS (the host data directory).
+ */
+
+#ifndef NATIVE_ESP_PARTITION_H
+#define NATIVE_ESP_PARTITION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+static inline const char* esp_err_to_name(esp_err_t) { return "ESP_FAIL"; }
+
+typedef enum { ESP_PARTITION_TYPE_DATA = 0x01 } esp_partition_type_t;
+typedef enum {
+    ESP_PARTITION_SUBTYPE_DATA_SPIFFS = 0x82,
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+typedef enum { SPI_FLASH_MMAP_DATA } spi_flash_mmap_memory_t;
+typedef uint32_t spi_flash_mmap_handle_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+typedef const esp_partition_t* esp_partition_iterator_t;
+
+static inline const esp_partition_t* esp_partition_find_first(
+        esp_partition_type_t, esp_partition_subtype_t, const char*) {
+    return nullptr;
+}
+static inline esp_partition_iterator_t esp_partition_find(
+        esp_partition_type_t, esp_partition_subtype_t, const char*) {
+    return nullptr;
+}
+static inline const esp_partition_t* esp_partition_get(esp_partition_iterator_t it) { return it; }
+static inline esp_partition_iterator_t esp_partition_next(esp_partition_iterator_t) { return nullptr; }
+static inline esp_err_t esp_partition_read(const esp_partition_t*, size_t, void*, size_t) {
+    return ESP_FAIL;
+}
+static inline esp_err_t esp_partition_mmap(const esp_partition_t*, size_t, size_t,
+                                           spi_flash_mmap_memory_t, const void**,
+                                           spi_flash_mmap_handle_t*) {
+    return ESP_FAIL;
+}
+static inline void spi_flash_munmap(spi_flash_mmap_handle_t) {}
+
+#endif // NATIVE_ESP_PARTITION_H
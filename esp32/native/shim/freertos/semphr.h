@@ -0,0 +1,12 @@
+#ifndef NATIVE_FREERTOS_SEMPHR_H
+#define NATIVE_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+typedef struct NativeMutex* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t m);
+
+#endif // NATIVE_FREERTOS_SEMPHR_H
@@ -0,0 +1,28 @@
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+typedef void* TaskHandle_t;
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// Runs fn on a detached thread; stack, priority and core are ignored
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+
+// The calling thread's handle (made for it on first use)
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+// Priorities only read back what was set
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority);
+
+// Task notifications as a counting semaphore per task
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t wait);
+
+#endif // NATIVE_FREERTOS_TASK_H
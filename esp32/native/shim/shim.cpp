@@ -0,0 +1,262 @@
+/**
+ * Host shim implementation for the native benchmark build.
+ */
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <Arduino_GFX_Library.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------
+// Arduino core
+// ------------------------------------------------------------------
+
+HardwareSerial Serial;
+
+static const auto _boot = std::chrono::steady_clock::now();
+static bool _psram = true;
+
+unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - _boot).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - _boot).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+bool psramFound() { return _psram; }
+void* ps_malloc(size_t size) { return _psram ? malloc(size) : nullptr; }
+void* ps_calloc(size_t n, size_t size) { return _psram ? calloc(n, size) : nullptr; }
+void native_set_psram(bool present) { _psram = present; }
+
+size_t HardwareSerial::printf(const char* fmt, ...) {
+    if (_quiet) return 0;
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n > 0 ? n : 0;
+}
+
+size_t HardwareSerial::print(const char* s) {
+    if (_quiet) return 0;
+    fputs(s, stdout);
+    return strlen(s);
+}
+
+size_t HardwareSerial::println(const char* s) {
+    if (_quiet) return 0;
+    puts(s);
+    return strlen(s) + 1;
+}
+
+// ------------------------------------------------------------------
+// LittleFS
+// ------------------------------------------------------------------
+
+LittleFSFS LittleFS;
+
+size_t File::size() {
+    struct stat st;
+    return _f && fstat(fileno(_f.get()), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void LittleFSFS::set_root(const char* dir) {
+    snprintf(_root, sizeof(_root), "%s", dir);
+}
+
+File LittleFSFS::open(const char* path, const char* mode) {
+    char full[512];
+    snprintf(full, sizeof(full), "%s%s", _root, path);
+    char host_mode[4];
+    snprintf(host_mode, sizeof(host_mode), "%sb", mode);   // No text translation
+    FILE* f = fopen(full, host_mode);
+    return f ? File(f) : File();
+}
+
+bool LittleFSFS::exists(const char* path) {
+    char full[512];
+    snprintf(full, sizeof(full), "%s%s", _root, path);
+    struct stat st;
+    return stat(full, &st) == 0;
+}
+
+// ------------------------------------------------------------------
+// FreeRTOS
+// ------------------------------------------------------------------
+
+struct NativeQueue {
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length;
+    size_t item_size;
+};
+
+struct NativeMutex {
+    std::timed_mutex lock;
+};
+
+struct NativeTask {
+    std::mutex lock;
+    std::condition_variable notified;
+    uint32_t notifications = 0;
+    UBaseType_t priority = 1;
+};
+
+static thread_local NativeTask* _current_task = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t) {
+    NativeTask* task = new NativeTask;
+    task->priority = priority;
+    std::thread([fn, arg, task] {
+        _current_task = task;
+        fn(arg);
+    }).detach();
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (!_current_task) _current_task = new NativeTask;
+    return _current_task;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+    return ((NativeTask*)(task ? task : xTaskGetCurrentTaskHandle()))->priority;
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority) {
+    ((NativeTask*)(task ? task : xTaskGetCurrentTaskHandle()))->priority = priority;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    NativeTask* t = (NativeTask*)task;
+    std::lock_guard<std::mutex> guard(t->lock);
+    t->notifications++;
+    t->notified.notify_one();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t wait) {
+    NativeTask* t = (NativeTask*)xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> guard(t->lock);
+    auto given = [t] { return t->notifications > 0; };
+    if (wait == portMAX_DELAY) {
+        t->notified.wait(guard, given);
+    } else if (!t->notified.wait_for(guard, std::chrono::milliseconds(wait), given)) {
+        return 0;
+    }
+    uint32_t count = t->notifications;
+    t->notifications = clear_on_exit ? 0 : count - 1;
+    return count;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    NativeQueue* q = new NativeQueue;
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    delete q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t) {
+    std::lock_guard<std::mutex> guard(q->lock);
+    if (q->items.size() >= q->length) return pdFALSE;
+    const uint8_t* p = (const uint8_t*)item;
+    q->items.emplace_back(p, p + q->item_size);
+    q->ready.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void* item) {
+    std::lock_guard<std::mutex> guard(q->lock);
+    q->items.clear();
+    const uint8_t* p = (const uint8_t*)item;
+    q->items.emplace_back(p, p + q->item_size);
+    q->ready.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t wait) {
+    std::unique_lock<std::mutex> guard(q->lock);
+    auto has_item = [q] { return !q->items.empty(); };
+    if (wait == portMAX_DELAY) {
+        q->ready.wait(guard, has_item);
+    } else if (!q->ready.wait_for(guard, std::chrono::milliseconds(wait), has_item)) {
+        return pdFALSE;
+    }
+    memcpy(item, q->items.front().data(), q->item_size);
+    q->items.pop_front();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    std::lock_guard<std::mutex> guard(q->lock);
+    return (UBaseType_t)q->items.size();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new NativeMutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t wait) {
+    if (wait == portMAX_DELAY) {
+        m->lock.lock();
+        return pdTRUE;
+    }
+    return m->lock.try_lock_for(std::chrono::milliseconds(wait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t m) {
+    m->lock.unlock();
+    return pdTRUE;
+}
+
+// ------------------------------------------------------------------
+// Arduino_GFX
+// ------------------------------------------------------------------
+
+Arduino_Canvas::Arduino_Canvas(int16_t w, int16_t h)
+    : Arduino_GFX(w, h), _fb((uint16_t*)calloc((size_t)w * h, sizeof(uint16_t))) {}
+
+Arduino_Canvas::~Arduino_Canvas() {
+    free(_fb);
+}
+
+void Arduino_Canvas::draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap,
+                                        int16_t w, int16_t h) {
+    for (int row = 0; row < h; row++) {
+        int py = y + row;
+        if (py < 0 || py >= _height) continue;
+        int x0 = max(0, -(int)x);
+        int x1 = min((int)w, _width - x);
+        if (x1 <= x0) continue;
+        memcpy(_fb + py * _width + x + x0, bitmap + row * w + x0, (x1 - x0) * sizeof(uint16_t));
+    }
+}
@@ -0,0 +1,596 @@
+/**
+ * Station artwork implementation for RadioWall.
+ *
+ * Both decoders write through the same mapping: every pixel of the
+ * ARTWORK_SIZE square has a source column and row in the decoded image
+ * (nearest neighbour over the centred crop). A band the decoder emits
+ * fills the entry pixels whose source lies in it, so no full-size image is
+ * ever held. TJpgDec hands out blocks of up to 16 x 16 pixels, row by row
+ * of blocks, at 1/1 to 1/8 scale (the largest reduction that still leaves
+ * the square at least ARTWORK_SIZE on a side); PNG rows are unfiltered one
+ * at a time as they come out of the inflater. Both poll the worker's
+ * cancel check at each row of blocks or pixels, so a tap waits for one
+ * row, not the whole image; a stopped decode is fetched again later.
+ *
+ * One mutex covers the cache and what is wanted: the worker takes it to
+ * publish a finished entry (a pointer swap), the loop to blit one.
+ */
+
+#include "artwork.h"
+#include "fnv1a.h"
+#include "config.h"
+#include "https_pool.h"
+#include "upnp_events.h"
+#include "loop_events.h"
+#include "theme.h"
+#include "Arduino_GFX_Library.h"
+#include <esp32s3/rom/tjpgd.h>
+#include <esp32s3/rom/miniz.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static const unsigned long FETCH_TIMEOUT_MS = 8000;
+static const size_t READ_CHUNK = 1024;         // Body bytes per read, then a cancel check
+static const int MAX_REDIRECTS = 2;
+static const size_t JPEG_WORK_SIZE = 3100;     // TJpgDec's work area
+static const uint32_t PNG_MAX_WIDTH = 2048;
+static const size_t ENTRY_BYTES = ARTWORK_SIZE * ARTWORK_SIZE * sizeof(uint16_t);
+
+struct ArtEntry {
+    uint32_t key;           // Hash of the station ID, 0 = empty
+    uint32_t url_hash;      // Image it was decoded from
+    uint32_t used;          // LRU tick
+    uint16_t* pixels;       // ARTWORK_SIZE x ARTWORK_SIZE, PSRAM
+};
+
+static SemaphoreHandle_t _lock = nullptr;
+static ArtEntry _cache[ARTWORK_CACHE_ENTRIES];
+static uint32_t _tick = 0;
+static volatile uint32_t _generation = 0;
+static uint16_t* _spare = nullptr;             // Worker: next entry's buffer
+
+// What is wanted (loop writes, worker reads; under _lock)
+static char _want_id[16];
+static uint32_t _want_key = 0;
+static uint32_t _want_art_seq = 0;             // upnp_events_art_url() count at the start
+
+// Worker: the last URL fetched for a station, so a failure is not retried
+static uint32_t _tried_key = 0;
+static uint32_t _tried_url = 0;
+
+// 0 means none tried
+static uint32_t key_of(const char* s) {
+    uint32_t h = fnv1a_str(s);
+    return h ? h : 1;
+}
+
+static ArtEntry* find_entry(uint32_t key) {
+    for (ArtEntry& e : _cache) {
+        if (e.key == key && e.pixels) return &e;
+    }
+    return nullptr;
+}
+
+// ------------------------------------------------------------------
+// Loop side
+// ------------------------------------------------------------------
+
+void artwork_want(const char* station_id) {
+    if (!psramFound()) return;
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    uint32_t key = key_of(station_id);
+    char url[UPNP_ART_URL_MAX];
+    uint32_t seq = upnp_events_art_url(url, sizeof(url));
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    if (key != _want_key) {
+        strncpy(_want_id, station_id, sizeof(_want_id) - 1);
+        _want_id[sizeof(_want_id) - 1] = '\0';
+        _want_key = key;
+        _want_art_seq = seq;
+        _generation++;
+    }
+    xSemaphoreGive(_lock);
+}
+
+uint32_t artwork_generation() {
+    return _generation;
+}
+
+bool artwork_draw(Arduino_GFX* gfx, int x, int y) {
+    if (!_lock) return false;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    ArtEntry* e = _want_key ? find_entry(_want_key) : nullptr;
+    if (e) {
+        e->used = ++_tick;
+        gfx->draw16bitRGBBitmap(x, y, e->pixels, ARTWORK_SIZE, ARTWORK_SIZE);
+    }
+    xSemaphoreGive(_lock);
+    return e != nullptr;
+}
+
+// ------------------------------------------------------------------
+// Source mapping
+// ------------------------------------------------------------------
+
+struct ArtTarget {
+    uint16_t* px;
+    uint16_t map_x[ARTWORK_SIZE];    // Source column of each entry column
+    uint16_t map_y[ARTWORK_SIZE];
+    bool (*cancelled)();             // Polled once per source row of blocks or pixels
+    bool aborted;                    // A play wanted the worker: decode again later
+};
+
+static bool decode_cancelled(ArtTarget& t) {
+    if (!t.aborted && t.cancelled()) t.aborted = true;
+    return t.aborted;
+}
+
+// Centre square of a w x h image onto the entry
+static void map_source(ArtTarget& t, uint32_t w, uint32_t h) {
+    uint32_t side = min(w, h);
+    uint32_t x0 = (w - side) / 2;
+    uint32_t y0 = (h - side) / 2;
+    for (int i = 0; i < ARTWORK_SIZE; i++) {
+        uint32_t s = (2 * i + 1) * side / (2 * ARTWORK_SIZE);   // Pixel centres
+        t.map_x[i] = x0 + s;
+        t.map_y[i] = y0 + s;
+    }
+}
+
+// First entry index whose source is at least v (maps are non-decreasing)
+static int first_at(const uint16_t* map, uint32_t v) {
+    int lo = 0, hi = ARTWORK_SIZE;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (map[mid] < v) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static inline uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+// ------------------------------------------------------------------
+// JPEG
+// ------------------------------------------------------------------
+
+struct JpegSource {
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+    ArtTarget* target;
+};
+
+static UINT jpeg_input(JDEC* jd, BYTE* buf, UINT n) {
+    JpegSource* src = (JpegSource*)jd->device;
+    n = min((size_t)n, src->len - src->pos);
+    if (buf) memcpy(buf, src->data + src->pos, n);
+    src->pos += n;
+    return n;
+}
+
+// One decoded block (RGB888) into the entry pixels it covers; 0 stops
+// the decode (at the start of an MCU row, if a play is waiting)
+static UINT jpeg_output(JDEC* jd, void* bitmap, JRECT* rect) {
+    ArtTarget& t = *((JpegSource*)jd->device)->target;
+    if (rect->left == 0 && decode_cancelled(t)) return 0;
+    const BYTE* rgb = (const BYTE*)bitmap;
+    int bw = rect->right - rect->left + 1;
+    int x_first = first_at(t.map_x, rect->left);
+    for (int dy = first_at(t.map_y, rect->top);
+         dy < ARTWORK_SIZE && t.map_y[dy] <= rect->bottom; dy++) {
+        const BYTE* row = rgb + (t.map_y[dy] - rect->top) * bw * 3;
+        uint16_t* out = t.px + dy * ARTWORK_SIZE;
+        for (int dx = x_first; dx < ARTWORK_SIZE && t.map_x[dx] <= rect->right; dx++) {
+            const BYTE* p = row + (t.map_x[dx] - rect->left) * 3;
+            out[dx] = rgb565(p[0], p[1], p[2]);
+        }
+    }
+    return 1;
+}
+
+static bool decode_jpeg(const uint8_t* data, size_t len, ArtTarget& t) {
+    void* work = malloc(JPEG_WORK_SIZE);   // Internal RAM: the decoder works in it per block
+    if (!work) return false;
+    JpegSource src = {data, len, 0, &t};
+    JDEC jd;
+    JRESULT r = jd_prepare(&jd, jpeg_input, work, JPEG_WORK_SIZE, &src);
+    if (r == JDR_OK) {
+        uint8_t scale = 0;
+        while (scale < 3 && (min(jd.width, jd.height) >> (scale + 1)) >= (UINT)ARTWORK_SIZE) {
+            scale++;
+        }
+        map_source(t, jd.width >> scale, jd.height >> scale);
+        r = jd_decomp(&jd, jpeg_output, scale);
+    }
+    free(work);
+    if (r != JDR_OK && !t.aborted) Serial.printf("[Artwork] JPEG decode failed (%d)\n", (int)r);
+    return r == JDR_OK;
+}
+
+// ------------------------------------------------------------------
+// PNG
+// ------------------------------------------------------------------
+
+struct PngInflater {
+    tinfl_decompressor decomp;
+    uint8_t dict[TINFL_LZ_DICT_SIZE];
+};
+
+struct PngDecoder {
+    ArtTarget* target;
+    uint32_t width, height;
+    uint8_t color_type;
+    int channels;
+    size_t stride;              // Bytes per row, without the filter byte
+    uint8_t* cur;               // Filter byte + row being filled
+    uint8_t* prev;              // Previous row, unfiltered
+    size_t fill;
+    uint32_t y;
+    uint8_t palette[256 * 3];
+    uint8_t bg[3];              // Alpha is blended onto the card colour
+    PngInflater* inf;
+    size_t dict_pos;
+    bool done;
+};
+
+static inline uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+static void png_unfilter(PngDecoder& d) {
+    uint8_t filter = d.cur[0];
+    uint8_t* x = d.cur + 1;
+    const uint8_t* up = d.prev;
+    int bpp = d.channels;
+    for (size_t i = 0; i < d.stride; i++) {
+        int a = i >= (size_t)bpp ? x[i - bpp] : 0;
+        int b = d.y > 0 ? up[i] : 0;
+        int c = (i >= (size_t)bpp && d.y > 0) ? up[i - bpp] : 0;
+        switch (filter) {
+            case 1: x[i] += a; break;
+            case 2: x[i] += b; break;
+            case 3: x[i] += (a + b) >> 1; break;
+            case 4: x[i] += paeth(a, b, c); break;
+            default: break;
+        }
+    }
+}
+
+static uint16_t png_pixel(const PngDecoder& d, const uint8_t* p) {
+    uint8_t r, g, b, a = 255;
+    switch (d.color_type) {
+        case 0: r = g = b = p[0]; break;
+        case 4: r = g = b = p[0]; a = p[1]; break;
+        case 3: r = d.palette[p[0] * 3]; g = d.palette[p[0] * 3 + 1]; b = d.palette[p[0] * 3 + 2]; break;
+        case 6: r = p[0]; g = p[1]; b = p[2]; a = p[3]; break;
+        default: r = p[0]; g = p[1]; b = p[2]; break;
+    }
+    if (a != 255) {
+        r = (r * a + d.bg[0] * (255 - a)) / 255;
+        g = (g * a + d.bg[1] * (255 - a)) / 255;
+        b = (b * a + d.bg[2] * (255 - a)) / 255;
+    }
+    return rgb565(r, g, b);
+}
+
+// A finished row: unfilter it and fill the entry rows that sample it.
+// Stops the decode instead if a play is waiting.
+static void png_row(PngDecoder& d) {
+    ArtTarget& t = *d.target;
+    if (decode_cancelled(t)) {
+        d.done = true;
+        return;
+    }
+    png_unfilter(d);
+    const uint8_t* row = d.cur + 1;
+    for (int dy = first_at(t.map_y, d.y); dy < ARTWORK_SIZE && t.map_y[dy] == d.y; dy++) {
+        uint16_t* out = t.px + dy * ARTWORK_SIZE;
+        for (int dx = 0; dx < ARTWORK_SIZE; dx++) {
+            out[dx] = png_pixel(d, row + t.map_x[dx] * d.channels);
+        }
+    }
+    memcpy(d.prev, row, d.stride);
+    d.fill = 0;
+    d.y++;
+    if (d.y > t.map_y[ARTWORK_SIZE - 1] || d.y >= d.height) d.done = true;   // Past the crop
+}
+
+static void png_take(PngDecoder& d, const uint8_t* p, size_t n) {
+    while (n > 0 && !d.done) {
+        size_t k = min(n, d.stride + 1 - d.fill);
+        memcpy(d.cur + d.fill, p, k);
+        d.fill += k;
+        p += k;
+        n -= k;
+        if (d.fill == d.stride + 1) png_row(d);
+    }
+}
+
+// Inflate one IDAT chunk's bytes; more: further IDAT chunks follow
+static bool png_inflate(PngDecoder& d, const uint8_t* in, size_t len, bool more) {
+    PngInflater& f = *d.inf;
+    while (!d.done) {
+        size_t in_size = len;
+        size_t out_size = TINFL_LZ_DICT_SIZE - d.dict_pos;
+        mz_uint32 flags = TINFL_FLAG_PARSE_ZLIB_HEADER | (more ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+        tinfl_status status = tinfl_decompress(&f.decomp, in, &in_size, f.dict,
+                                               f.dict + d.dict_pos, &out_size, flags);
+        in += in_size;
+        len -= in_size;
+        png_take(d, f.dict + d.dict_pos, out_size);
+        d.dict_pos = (d.dict_pos + out_size) & (TINFL_LZ_DICT_SIZE - 1);
+        if (status < TINFL_STATUS_DONE) return false;
+        if (status == TINFL_STATUS_DONE) return true;
+        if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) return more;
+    }
+    return true;
+}
+
+static bool decode_png(const uint8_t* data, size_t len, ArtTarget& t) {
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (len < 33 || memcmp(data, SIGNATURE, 8) != 0 || memcmp(data + 12, "IHDR", 4) != 0) {
+        return false;
+    }
+    PngDecoder* d = (PngDecoder*)ps_calloc(1, sizeof(PngDecoder));
+    if (!d) return false;
+    d->target = &t;
+    d->width = be32(data + 16);
+    d->height = be32(data + 20);
+    uint8_t depth = data[24];
+    d->color_type = data[25];
+    uint8_t interlace = data[28];
+    static const int CHANNELS[] = {1, 0, 3, 1, 2, 0, 4};
+    d->channels = d->color_type <= 6 ? CHANNELS[d->color_type] : 0;
+
+    bool ok = depth == 8 && interlace == 0 && d->channels > 0 && d->width > 0 &&
+              d->width <= PNG_MAX_WIDTH && d->height > 0;
+    if (!ok) {
+        Serial.printf("[Artwork] PNG not supported (%lux%lu, depth %u, type %u%s)\n",
+                      (unsigned long)d->width, (unsigned long)d->height, depth, d->color_type,
+                      interlace ? ", interlaced" : "");
+        free(d);
+        return false;
+    }
+    d->stride = d->width * d->channels;
+    d->cur = (uint8_t*)ps_malloc(2 * d->stride + 1);
+    d->prev = d->cur ? d->cur + d->stride + 1 : nullptr;
+    d->inf = (PngInflater*)ps_malloc(sizeof(PngInflater));
+    uint16_t card = TH_CARD;
+    d->bg[0] = (card >> 8) & 0xF8;
+    d->bg[1] = (card >> 3) & 0xFC;
+    d->bg[2] = (card << 3) & 0xF8;
+    ok = d->cur && d->inf;
+    if (ok) {
+        tinfl_init(&d->inf->decomp);
+        map_source(t, d->width, d->height);
+    }
+
+    // Chunks after the signature: length, type, data, CRC
+    size_t pos = 8;
+    bool idat = false;
+    while (ok && !d->done && pos + 12 <= len) {
+        uint32_t n = be32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        const uint8_t* body = data + pos + 8;
+        if (n > len - pos - 12) {
+            ok = false;
+            break;
+        }
+        size_t next = pos + 12 + n;
+        if (memcmp(type, "PLTE", 4) == 0) {
+            memcpy(d->palette, body, min((size_t)n, sizeof(d->palette)));
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            idat = true;
+            bool more = next + 8 <= len && memcmp(data + next + 4, "IDAT", 4) == 0;
+            ok = png_inflate(*d, body, n, more);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        pos = next;
+    }
+    ok = ok && idat && d->done && !t.aborted;
+    if (!ok && !t.aborted) Serial.printf("[Artwork] PNG decode failed at row %lu\n", (unsigned long)d->y);
+    free(d->cur);
+    free(d->inf);
+    free(d);
+    return ok;
+}
+
+// ------------------------------------------------------------------
+// Fetch (network worker)
+// ------------------------------------------------------------------
+
+enum FetchResult : uint8_t {
+    FETCH_OK,
+    FETCH_FAILED,
+    FETCH_CANCELLED,
+};
+
+// The wanted station and its image URL, if there is one to fetch
+static bool wanted(char* url, size_t cap, uint32_t* key, uint32_t* url_hash) {
+    if (!_lock) return false;
+    char id[sizeof(_want_id)];
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    memcpy(id, _want_id, sizeof(id));
+    *key = _want_key;
+    uint32_t start_seq = _want_art_seq;
+    xSemaphoreGive(_lock);
+    if (!id[0]) return false;
+
+#ifdef ARTWORK_URL_FORMAT
+    (void)start_seq;
+    snprintf(url, cap, ARTWORK_URL_FORMAT, id);
+#else
+    // Only artwork that arrived with this station's metadata
+    if (upnp_events_art_url(url, cap) == start_seq || !url[0]) return false;
+#endif
+    *url_hash = key_of(url);
+    if (*key == _tried_key && *url_hash == _tried_url) return false;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    ArtEntry* e = find_entry(*key);
+    bool have = e && e->url_hash == *url_hash;
+    xSemaphoreGive(_lock);
+    return !have;
+}
+
+bool artwork_pending() {
+    char url[UPNP_ART_URL_MAX];
+    uint32_t key, url_hash;
+    return wanted(url, sizeof(url), &key, &url_hash);
+}
+
+// http(s)://host[:80|:443]/path; the pool has no other ports
+static bool split_url(const char* url, bool* secure, char* host, size_t cap, const char** path) {
+    const char* p;
+    if (strncmp(url, "https://", 8) == 0) {
+        *secure = true;
+        p = url + 8;
+    } else if (strncmp(url, "http://", 7) == 0) {
+        *secure = false;
+        p = url + 7;
+    } else {
+        return false;
+    }
+    size_t n = strcspn(p, ":/");
+    if (n == 0 || n >= cap) return false;
+    memcpy(host, p, n);
+    host[n] = '\0';
+    p += n;
+    if (*p == ':') {
+        int port = atoi(p + 1);
+        if (port != (*secure ? 443 : 80)) return false;
+        p += strcspn(p, "/");
+    }
+    *path = *p ? p : "/";
+    return true;
+}
+
+static FetchResult download(const char* url, uint8_t** out, size_t* out_len,
+                            bool (*cancelled)(), int redirects) {
+    bool secure;
+    char host[64];
+    const char* path;
+    if (!split_url(url, &secure, host, sizeof(host), &path)) {
+        Serial.printf("[Artwork] Unsupported URL: %s\n", url);
+        return FETCH_FAILED;
+    }
+
+    HttpResponse resp;
+    HttpsConn* conn = secure ? https_request(host, path, "image/*", resp, FETCH_TIMEOUT_MS)
+                             : http_request(host, path, "image/*", resp, FETCH_TIMEOUT_MS);
+    if (!conn) return cancelled() ? FETCH_CANCELLED : FETCH_FAILED;
+
+    if (resp.status >= 301 && resp.status <= 308 && resp.location.length() && redirects > 0) {
+        String location = resp.location;
+        https_release(conn, https_read_body(conn, resp, nullptr) && resp.keep_alive);
+        return download(location.c_str(), out, out_len, cancelled, redirects - 1);
+    }
+    if (resp.status != 200 || resp.content_length > (long)ARTWORK_MAX_BYTES) {
+        Serial.printf("[Artwork] %s: HTTP %d, %ld bytes\n", host, resp.status, resp.content_length);
+        https_release(conn, false);
+        return FETCH_FAILED;
+    }
+
+    size_t cap = resp.content_length > 0 ? resp.content_length : ARTWORK_MAX_BYTES;
+    uint8_t* buf = (uint8_t*)ps_malloc(cap);
+    if (!buf) {
+        https_release(conn, false);
+        return FETCH_FAILED;
+    }
+    HttpBodyStream body(conn, resp);
+    size_t len = 0;
+    FetchResult result = FETCH_OK;
+    while (len < cap) {
+        if (cancelled()) {
+            result = FETCH_CANCELLED;
+            break;
+        }
+        size_t n = body.read(buf + len, min(READ_CHUNK, cap - len));
+        if (n == 0) break;
+        len += n;
+    }
+    bool complete = result == FETCH_OK && len > 0 && (len < cap || resp.content_length > 0);
+    bool reuse = complete && body.finish() && resp.keep_alive;
+    https_release(conn, reuse);
+    if (!complete) {
+        free(buf);
+        return result == FETCH_CANCELLED ? FETCH_CANCELLED : FETCH_FAILED;
+    }
+    *out = buf;
+    *out_len = len;
+    return FETCH_OK;
+}
+
+static void publish(uint32_t key, uint32_t url_hash, uint16_t* pixels) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    ArtEntry* slot = find_entry(key);
+    for (ArtEntry& e : _cache) {
+        if (!slot && !e.pixels) slot = &e;
+    }
+    if (!slot) {
+        slot = &_cache[0];
+        for (ArtEntry& e : _cache) {
+            if (e.used < slot->used) slot = &e;
+        }
+    }
+    _spare = slot->pixels;
+    slot->pixels = pixels;
+    slot->key = key;
+    slot->url_hash = url_hash;
+    slot->used = ++_tick;
+    _generation++;
+    xSemaphoreGive(_lock);
+    loop_events_notify();
+}
+
+void artwork_fetch_step(bool (*cancelled)()) {
+    char url[UPNP_ART_URL_MAX];
+    uint32_t key, url_hash;
+    if (!wanted(url, sizeof(url), &key, &url_hash)) return;
+
+    unsigned long start = millis();
+    uint8_t* data = nullptr;
+    size_t len = 0;
+    FetchResult r = download(url, &data, &len, cancelled, MAX_REDIRECTS);
+    if (r == FETCH_CANCELLED) return;   // Tried again on a later pass
+    _tried_key = key;
+    _tried_url = url_hash;
+    if (r != FETCH_OK) return;
+
+    unsigned long fetched = millis();
+    ArtTarget* t = (ArtTarget*)malloc(sizeof(ArtTarget));
+    uint16_t* px = _spare ? _spare : (uint16_t*)ps_malloc(ENTRY_BYTES);
+    _spare = nullptr;
+    bool ok = false;
+    bool aborted = false;
+    if (t && px) {
+        memset(px, 0, ENTRY_BYTES);
+        t->px = px;
+        t->cancelled = cancelled;
+        t->aborted = false;
+        ok = len > 3 && data[0] == 0xFF && data[1] == 0xD8 ? decode_jpeg(data, len, *t)
+                                                            : decode_png(data, len, *t);
+        aborted = t->aborted;
+    }
+    free(data);
+    free(t);
+    if (aborted) _tried_key = _tried_url = 0;   // Fetched and decoded again later
+    if (!ok) {
+        _spare = px;
+        return;
+    }
+    publish(key, url_hash, px);
+    Serial.printf("[Artwork] %u KB fetched in %lu ms, decoded in %lu ms\n", (unsigned)(len / 1024),
+                  fetched - start, millis() - fetched);
+}
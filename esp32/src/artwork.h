@@ -0,0 +1,48 @@
+/**
+ * Station artwork for the Now Playing scene (now_playing.h).
+ *
+ * When a station starts, the loop names it with artwork_want(). Its image
+ * URL comes from ARTWORK_URL_FORMAT (config.h, given the station ID) when
+ * that is set, otherwise from the album art the WiiM's track metadata
+ * names in its UPnP events (upnp_events.h), once it has changed since the
+ * station started. The network worker fetches it in the prefetch class
+ * (net_worker.h), so the fetch only starts while no command is waiting
+ * and gives way to one at once, and decodes it on the same task, off the
+ * render path: JPEG (baseline, the ROM's TJpgDec) or PNG (8-bit,
+ * non-interlaced, the ROM's inflater), cropped to a centred square and
+ * scaled to ARTWORK_SIZE, band by band as the decoder emits rows, into an
+ * RGB565 entry. A decode failure leaves the placeholder.
+ *
+ * Entries are kept in PSRAM, least recently used dropped first, keyed by
+ * station; a station whose artwork URL has not changed is not fetched
+ * again. Without PSRAM there is no artwork.
+ */
+
+#ifndef ARTWORK_H
+#define ARTWORK_H
+
+#include <Arduino.h>
+
+class Arduino_GFX;
+
+static const int ARTWORK_SIZE = 140;           // Square, the scene's art box
+static const int ARTWORK_CACHE_ENTRIES = 8;    // 38 KB each
+static const size_t ARTWORK_MAX_BYTES = 256 * 1024;   // Largest image fetched
+
+// The station now playing (loop task)
+void artwork_want(const char* station_id);
+
+// Changes when the playing station's artwork may have (loop task)
+uint32_t artwork_generation();
+
+// Blit the playing station's artwork at x, y with draw16bitRGBBitmap.
+// False if it has none (yet): draw the placeholder.
+bool artwork_draw(Arduino_GFX* gfx, int x, int y);
+
+// One fetch and decode if one is due (network worker, prefetch class).
+// cancelled is polled during the transfer; a cancelled fetch is tried
+// again on a later pass.
+bool artwork_pending();
+void artwork_fetch_step(bool (*cancelled)());
+
+#endif // ARTWORK_H
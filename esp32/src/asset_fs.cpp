@@ -0,0 +1,43 @@
+/**
+ * Asset read implementation for RadioWall.
+ *
+ * setvbuf() only takes effect before the first read, so the buffer is set
+ * right after the open; newlib allocates it on the first refill and frees
+ * it with close(). A refill of a whole block is big enough for littlefs to
+ * skip its cache and read straight from flash.
+ */
+
+#include "asset_fs.h"
+
+static bool _logged = false;
+
+bool asset_fs_mount() {
+    if (!LittleFS.begin(false)) return false;
+    if (!_logged) {
+        _logged = true;
+#if defined(CONFIG_LITTLEFS_READ_SIZE) && defined(CONFIG_LITTLEFS_CACHE_SIZE)
+        Serial.printf("[FS] LittleFS read %d B, prog %d B, cache %d B, lookahead %d B; "
+                      "assets read ahead %u B\n",
+                      CONFIG_LITTLEFS_READ_SIZE, CONFIG_LITTLEFS_WRITE_SIZE,
+                      CONFIG_LITTLEFS_CACHE_SIZE, CONFIG_LITTLEFS_LOOKAHEAD_SIZE,
+                      (unsigned)ASSET_READ_AHEAD);
+#endif
+    }
+    return true;
+}
+
+File asset_fs_open(const char* path, size_t read_ahead) {
+    File f = LittleFS.open(path, "r");
+    if (f && read_ahead && !f.setBufferSize(read_ahead)) {
+        Serial.printf("[FS] No %u B read-ahead for %s\n", (unsigned)read_ahead, path);
+    }
+    return f;
+}
+
+bool asset_fs_load(const char* path, void* dst, size_t bytes) {
+    File f = asset_fs_open(path, ASSET_BULK_READ_AHEAD);
+    if (!f) return false;
+    bool ok = f.read((uint8_t*)dst, bytes) == bytes;
+    f.close();
+    return ok;
+}
@@ -0,0 +1,43 @@
+/**
+ * Asset reads from LittleFS for RadioWall.
+ *
+ * The read-only assets (places.bin, /maps/tiles.bin, stations.bin,
+ * /maps/vector.bin) are read in long sequential runs or loaded whole,
+ * while everything else on the filesystem is small JSON and journal
+ * writes. littlefs's own geometry (read and prog size, cache, lookahead)
+ * is fixed when the framework's esp_littlefs is built, so the tuning is
+ * one level up, in the stdio buffer each File reads through: newlib's
+ * default is 128 bytes, which turns a 2 KB tile into sixteen trips
+ * through the VFS and littlefs's cache. An asset File read in runs reads
+ * ahead a whole 4 KB block instead, which littlefs copies straight from
+ * flash. Files read by seeking to small records (map tiles, the catalogue,
+ * places.bin read on demand) get a small buffer or none: a seek drops the
+ * buffer, so anything read past the record is wasted, and the buffer
+ * comes out of internal RAM (newlib allocates it) for as long as the
+ * file stays open.
+ *
+ * BENCH:fs compares open latency and MB/s against the default buffer.
+ */
+
+#ifndef ASSET_FS_H
+#define ASSET_FS_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+static const size_t ASSET_READ_AHEAD = 4096;           // One littlefs block
+static const size_t ASSET_RANDOM_READ_AHEAD = 512;     // Seek-then-read: a record or two
+static const size_t ASSET_BULK_READ_AHEAD = 32 * 1024; // Whole-file loads (PSRAM buffer)
+
+// Mount LittleFS without formatting (any task; already mounted is fine)
+bool asset_fs_mount();
+
+// Open an asset for reading with read_ahead bytes of buffer per refill
+// (held in internal heap while the file is open; 0 keeps the stdio
+// default of 128 bytes)
+File asset_fs_open(const char* path, size_t read_ahead = ASSET_READ_AHEAD);
+
+// Read the first bytes of a file into dst in large block-aligned refills
+bool asset_fs_load(const char* path, void* dst, size_t bytes);
+
+#endif // ASSET_FS_H
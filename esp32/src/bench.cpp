@@ -0,0 +1,656 @@
+/**
+ * On-device microbenchmark implementation for RadioWall.
+ *
+ * The saved builds are only touched on the loop task; the report of the
+ * last check is copied under _report_mux for the metrics server.
+ */
+
+#include "bench.h"
+#include "config.h"
+#include "serial_cmd.h"
+#include "places_db.h"
+#include "world_map.h"
+#include "vector_map.h"
+#include "city_dots.h"
+#include "display.h"
+#include "asset_fs.h"
+#include "theme.h"
+#include "state_store.h"
+#include "persist.h"
+#include "loop_events.h"
+#include "Arduino_GFX_Library.h"
+#include <ArduinoJson.h>
+#include <esp_timer.h>
+#include <esp_ota_ops.h>
+#include <freertos/FreeRTOS.h>
+
+static const int BENCH_MAX_ITERATIONS = 200;
+static const int BENCH_PAYLOAD_STATIONS = 100;   // A large city's channels page
+static const size_t BENCH_PAYLOAD_BYTES = 24 * 1024;
+static const int BENCH_GLYPH_W = 180;
+static const int BENCH_GLYPH_H = 40;
+static const size_t BENCH_FS_BYTES = 64 * 1024;
+static const size_t BENCH_FS_READ = 256;          // A parser-sized read
+static const uint32_t BENCH_AUTO_AFTER_MS = 60000;  // Boot settles: WiFi, first play
+static const uint32_t BENCH_AUTO_IDLE_MS = 30000;   // No input for this long
+
+static UIState* _state = nullptr;
+static uint32_t _samples[BENCH_MAX_ITERATIONS];   // Cycles per iteration
+static uint32_t _rng = 1;
+
+// Scratch shared by the cases, allocated for one run
+static uint8_t* _packed = nullptr;
+static char* _payload = nullptr;
+static Arduino_Canvas* _canvas = nullptr;
+static const char* _fs_path = nullptr;          // First asset of at least BENCH_FS_BYTES
+static uint8_t* _fs_buf = nullptr;
+
+struct BenchCase {
+    const char* name;
+    int iterations;
+    bool (*ready)();          // nullptr = always; false skips the case
+    void (*run)(int i);
+    uint32_t bytes;           // Moved per iteration: also report MB/s (0: none)
+};
+
+// ------------------------------------------------------------------
+// Inputs
+// ------------------------------------------------------------------
+
+// xorshift32: the same points on every run
+static uint32_t next_random() {
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+static void random_point(float* lat, float* lon) {
+    *lat = (next_random() % 13000) / 100.0f - 60.0f;    // -60..70, where people live
+    *lon = (next_random() % 36000) / 100.0f - 180.0f;
+}
+
+// Same shape as /api/ara/content/page/{id}/channels, including the fields
+// the parse filter throws away
+static void build_payload() {
+    size_t len = snprintf(_payload, BENCH_PAYLOAD_BYTES,
+                          "{\"apiVersion\":1,\"version\":\"bench\",\"data\":{\"type\":\"page\","
+                          "\"title\":\"Vienna\",\"subtitle\":\"Austria\",\"content\":[{"
+                          "\"type\":\"list\",\"title\":\"All Stations\",\"items\":[");
+    for (int i = 0; i < BENCH_PAYLOAD_STATIONS && len < BENCH_PAYLOAD_BYTES; i++) {
+        len += snprintf(_payload + len, BENCH_PAYLOAD_BYTES - len,
+                        "%s{\"page\":{\"type\":\"channel\",\"title\":\"Radio Bench %03d FM\","
+                        "\"url\":\"/listen/radio-bench-%03d/Bx%06d\",\"website\":"
+                        "\"https://example.com/%03d\",\"place\":{\"id\":\"8Wv5Lbx2\","
+                        "\"title\":\"Vienna\"},\"country\":{\"id\":\"X7m2Pq9a\","
+                        "\"title\":\"Austria\"},\"secure\":true},\"href\":"
+                        "\"/listen/radio-bench-%03d/Bx%06d\"}",
+                        i ? "," : "", i, i, i, i, i, i);
+    }
+    if (len < BENCH_PAYLOAD_BYTES) {
+        snprintf(_payload + len, BENCH_PAYLOAD_BYTES - len, "]}]}}");
+    }
+}
+
+// ------------------------------------------------------------------
+// Cases
+// ------------------------------------------------------------------
+
+static bool places_ready() { return places_db_loaded(); }
+static bool packed_ready() { return _packed != nullptr; }
+
+static bool zoom_ready(int zoom) {
+    return _packed && world_map_tile_count(zoom) > 0;
+}
+static bool zoom2_ready() { return zoom_ready(2); }
+static bool zoom3_ready() { return zoom_ready(3); }
+static bool zoom4_ready() { return zoom_ready(4); }
+static bool zoom5_ready() { return zoom_ready(5); }
+static bool vector_ready() { return _packed && vector_map_ready(); }
+static bool dots_ready() { return _packed && places_db_loaded(); }
+static bool payload_ready() { return _payload != nullptr; }
+static bool canvas_ready() { return _canvas != nullptr; }
+static bool status_ready() { return _state && display_get_gfx(); }
+static bool flush_ready() { return display_framebuffer() != nullptr; }
+static bool fs_ready() { return _fs_path && _fs_buf; }
+
+static void run_nearest(int) {
+    float lat, lon;
+    random_point(&lat, &lon);
+    places_db_find_nearest(lat, lon);
+}
+
+// The same queries by the other nearest-place strategies (places_db.h)
+static void run_nearest_by(PlacesSearch strategy) {
+    float lat, lon;
+    PlaceHandle best;
+    random_point(&lat, &lon);
+    places_db_find_k_nearest_by(strategy, lat, lon, 1, &best);
+}
+static void run_nearest_index(int) { run_nearest_by(PLACES_SEARCH_INDEX); }
+static void run_nearest_linear(int) { run_nearest_by(PLACES_SEARCH_LINEAR); }
+static void run_nearest_parallel(int) { run_nearest_by(PLACES_SEARCH_PARALLEL); }
+
+static void run_knn(int) {
+    float lat, lon;
+    PlaceHandle out[20];
+    random_point(&lat, &lon);
+    places_db_find_k_nearest(lat, lon, 20, out);
+}
+
+static void run_slice_decode(int i) {
+    static const uint8_t* const SLICES[] = {
+        map_slice_americas, map_slice_europe_africa, map_slice_asia, map_slice_pacific,
+    };
+    static const size_t* const SIZES[] = {
+        &map_slice_americas_size, &map_slice_europe_africa_size,
+        &map_slice_asia_size, &map_slice_pacific_size,
+    };
+    world_map_decode_slice(SLICES[i % 4], *SIZES[i % 4], _packed);
+}
+
+// Walks every tile of the zoom level, so the file read is part of the cost
+static void run_tile_decode(int zoom, int i) {
+    world_map_decode_tile(zoom, i % world_map_tile_count(zoom), _packed);
+}
+
+static void run_tile2(int i) { run_tile_decode(2, i); }
+static void run_tile3(int i) { run_tile_decode(3, i); }
+static void run_tile4(int i) { run_tile_decode(4, i); }
+static void run_tile5(int i) { run_tile_decode(5, i); }
+
+// A 5x view at a random pixel offset, composed through the tile cache as
+// a pan would draw it (mostly cached tiles once the cache is warm)
+static void run_view5(int) {
+    MapView v = {5, (int8_t)(next_random() % 4), (int16_t)(next_random() % (MAP_WIDTH * 4 + 1)),
+                 (int16_t)(next_random() % (MAP_HEIGHT * 4 + 1))};
+    world_map_compose_view(v, _packed);
+}
+
+// A view at a random zoom (2x..MAP_ZOOM_LIMIT) and offset from the vector map
+static void run_vector(int) {
+    int zoom = 2 + next_random() % (MAP_ZOOM_LIMIT - 1);
+    MapView v = {(int8_t)zoom, (int8_t)(next_random() % 4),
+                 (int16_t)(next_random() % (MAP_WIDTH * (zoom - 1) + 1)),
+                 (int16_t)(next_random() % (MAP_HEIGHT * (zoom - 1) + 1))};
+    vector_map_render(v, _packed);
+}
+
+// The city dots of a view at a random zoom (1x..MAP_ZOOM_LIMIT) and offset.
+// The warm-up run builds every level's dot lists.
+static void run_dots(int i) {
+    if (i == 0) {
+        for (int zoom = 1; zoom <= MAP_ZOOM_LIMIT; zoom++) city_dots_draw({(int8_t)zoom, 0, 0, 0}, _packed);
+    }
+    int zoom = 1 + next_random() % MAP_ZOOM_LIMIT;
+    MapView v = {(int8_t)zoom, (int8_t)(next_random() % 4),
+                 (int16_t)(next_random() % (MAP_WIDTH * (zoom - 1) + 1)),
+                 (int16_t)(next_random() % (MAP_HEIGHT * (zoom - 1) + 1))};
+    city_dots_draw(v, _packed);
+}
+
+static void run_glyphs(int i) {
+    static const char* const LINES[] = {
+        "Wien, AT (2/5)", "São Paulo, BR (12/48)", "東京, JP (1/30)", "Zürich, CH (3/9)",
+    };
+    _canvas->fillScreen(TH_BG);
+    _canvas->setFont(TH_FONT_UNICODE);
+    _canvas->setFontIndex(TH_FONT_UNICODE_INDEX);
+    _canvas->setUTF8Print(true);
+    _canvas->setTextColor(TH_TEXT);
+    _canvas->setCursor(4, 14);
+    _canvas->print(LINES[i % 4]);
+    _canvas->setCursor(4, 34);
+    _canvas->print("Artist Name - A Fairly Long Title");
+    _canvas->setFont((const uint8_t*)nullptr);
+    _canvas->setUTF8Print(false);
+}
+
+static void run_json(int) {
+    StaticJsonDocument<192> filter;
+    filter["data"]["content"][0]["items"][0]["page"]["title"] = true;
+    filter["data"]["content"][0]["items"][0]["page"]["url"] = true;
+
+    DynamicJsonDocument doc(16384);
+    deserializeJson(doc, (const char*)_payload, DeserializationOption::Filter(filter));
+}
+
+static void run_status_bar(int) {
+    display_update_status_bar(_state);
+}
+
+// Push the unchanged frame: the PSRAM framebuffer streamed to the panel
+// through the bus's bounce buffers (plus the V-blank wait with TE sync)
+static void run_flush(int) {
+    display_damage(0, 0, TH_DISPLAY_W, TH_DISPLAY_H);
+    display_flush();
+}
+
+// Open and close an asset: littlefs path walk and the VFS file setup
+static void run_fs_open(int) {
+    File f = asset_fs_open(_fs_path);
+    f.close();
+}
+
+// Open, then 64 KB in parser-sized reads through a read_ahead buffer
+static void read_sequential(size_t read_ahead) {
+    File f = asset_fs_open(_fs_path, read_ahead);
+    for (size_t off = 0; off < BENCH_FS_BYTES; off += BENCH_FS_READ) {
+        f.read(_fs_buf + off, BENCH_FS_READ);
+    }
+    f.close();
+}
+
+static void run_fs_default(int) { read_sequential(0); }
+static void run_fs_ahead(int) { read_sequential(ASSET_READ_AHEAD); }
+
+// Open, then 64 KB as one bulk load (places.bin into PSRAM at boot)
+static void run_fs_bulk(int) {
+    asset_fs_load(_fs_path, _fs_buf, BENCH_FS_BYTES);
+}
+
+static const BenchCase CASES[] = {
+    { "places.nearest", 200, places_ready,  run_nearest },
+    { "places.index",   200, places_ready,  run_nearest_index },
+    { "places.linear",   50, places_ready,  run_nearest_linear },
+    { "places.parallel", 50, places_ready,  run_nearest_parallel },
+    { "places.knn20",   200, places_ready,  run_knn },
+    { "map.slice",       40, packed_ready,  run_slice_decode },
+    { "map.tile2",      128, zoom2_ready,   run_tile2 },
+    { "map.tile3",      288, zoom3_ready,   run_tile3 },
+    { "map.tile4",      512, zoom4_ready,   run_tile4 },
+    { "map.tile5",      800, zoom5_ready,   run_tile5 },
+    { "map.view5",      100, zoom5_ready,   run_view5 },
+    { "map.vector",      50, vector_ready,  run_vector },
+    { "map.dots",       200, dots_ready,    run_dots },
+    { "text.glyphs",    100, canvas_ready,  run_glyphs },
+    { "json.channels",   50, payload_ready, run_json },
+    { "display.status",  30, status_ready,  run_status_bar },
+    { "display.flush",   30, flush_ready,   run_flush,
+      TH_DISPLAY_W * TH_DISPLAY_H * sizeof(uint16_t) },
+    { "fs.open",         50, fs_ready,      run_fs_open },
+    { "fs.seq.default",  20, fs_ready,      run_fs_default, BENCH_FS_BYTES },
+    { "fs.seq.ahead",    20, fs_ready,      run_fs_ahead,   BENCH_FS_BYTES },
+    { "fs.bulk",         20, fs_ready,      run_fs_bulk,    BENCH_FS_BYTES },
+};
+static const int CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+static const int CASES_MAX = 24;   // Results kept per build
+static_assert(CASE_COUNT <= CASES_MAX, "raise CASES_MAX");
+
+// Run after a new build: one case per hot path, about three seconds
+static const char* const QUICK_CASES[] = {
+    "places.knn20", "map.tile3", "map.view5", "map.dots", "text.glyphs",
+    "json.channels", "display.status", "fs.bulk",
+};
+
+static bool is_quick(const char* name) {
+#if !USE_BUILTIN_TOUCH
+    // The now playing display never loads the map: its cases would
+    if (strncmp(name, "map.", 4) == 0) return false;
+#endif
+    for (const char* q : QUICK_CASES) {
+        if (strcmp(q, name) == 0) return true;
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------
+// Saved results
+// ------------------------------------------------------------------
+
+struct BenchResult {
+    char name[BENCH_NAME_LEN];
+    uint32_t med_cycles;
+    uint32_t cold_cycles;     // The first call, after other cases took the caches
+    uint16_t mhz;
+    uint16_t places;          // places_db_count() for places.* cases: a synthetic
+                              // database (compile_places.py --synthetic) is not
+                              // compared with the real one
+};
+
+struct BenchBuild {
+    char id[BENCH_BUILD_ID_LEN + 1];   // Empty: unused slot
+    uint8_t count;
+    uint8_t reserved[2];
+    BenchResult results[CASES_MAX];
+};
+
+// Bump when BenchResult or BenchBuild change: older results are dropped
+// rather than read with the wrong layout (2: cold_cycles, 3: places)
+static const uint16_t BENCH_RECORD_VERSION = 3;
+
+struct BenchRecord {
+    uint16_t version;
+    uint8_t reserved[2];
+    BenchBuild builds[BENCH_BUILDS_KEPT];   // Newest first
+};
+
+static BenchRecord _record;
+static char _build_id[BENCH_BUILD_ID_LEN + 1] = "";
+static bool _loaded = false;
+static bool _auto_pending = false;
+
+static BenchReport _report;
+static bool _has_report = false;
+static portMUX_TYPE _report_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool save_record() {
+    return state_store_put(STATE_KEY_BENCH, &_record, sizeof(_record));
+}
+
+static void load_record() {
+    _loaded = true;
+    if (esp_ota_get_app_elf_sha256(_build_id, sizeof(_build_id)) == 0) {
+        strcpy(_build_id, "unknown");
+    }
+    if (state_store_get(STATE_KEY_BENCH, &_record, sizeof(_record)) != (int)sizeof(_record) ||
+        _record.version != BENCH_RECORD_VERSION) {
+        memset(&_record, 0, sizeof(_record));
+        _record.version = BENCH_RECORD_VERSION;
+    }
+    for (BenchBuild& b : _record.builds) {
+        b.id[BENCH_BUILD_ID_LEN] = '\0';
+        b.count = min<int>(b.count, CASES_MAX);
+    }
+    _auto_pending = strcmp(_record.builds[0].id, _build_id) != 0;
+    if (_auto_pending) {
+        Serial.printf("[Bench] New build %s: quick run once idle\n", _build_id);
+    }
+}
+
+// The running build's slot, moved to the front (or started there)
+static BenchBuild& current_build() {
+    if (strcmp(_record.builds[0].id, _build_id) != 0) {
+        memmove(&_record.builds[1], &_record.builds[0],
+                (BENCH_BUILDS_KEPT - 1) * sizeof(BenchBuild));
+        memset(&_record.builds[0], 0, sizeof(BenchBuild));
+        strcpy(_record.builds[0].id, _build_id);
+    }
+    return _record.builds[0];
+}
+
+static const BenchResult* find_result(const BenchBuild& b, const char* name) {
+    for (int i = 0; i < b.count; i++) {
+        if (strncmp(b.results[i].name, name, BENCH_NAME_LEN) == 0) return &b.results[i];
+    }
+    return nullptr;
+}
+
+static void store_result(const char* name, uint32_t med_cycles, uint32_t cold_cycles,
+                         uint16_t mhz, uint16_t places) {
+    BenchBuild& b = current_build();
+    BenchResult* r = (BenchResult*)find_result(b, name);
+    if (!r) {
+        if (b.count >= CASES_MAX) return;
+        r = &b.results[b.count++];
+        memset(r, 0, sizeof(*r));
+        strncpy(r->name, name, BENCH_NAME_LEN - 1);
+    }
+    r->med_cycles = med_cycles;
+    r->cold_cycles = cold_cycles;
+    r->mhz = mhz;
+    r->places = places;
+}
+
+static bool is_places_case(const char* name) {
+    return strncmp(name, "places.", 7) == 0;
+}
+
+static int change_pct(uint32_t now, uint32_t base) {
+    return base ? (int)(((int64_t)now - base) * 100 / base) : 0;
+}
+
+// Compare the cases just run with the newest older build that has them,
+// one line per case: the before and after of each change
+static void check_regressions(const char* const* names, int count, bool automatic) {
+    BenchReport rep = {};
+    strcpy(rep.build, _build_id);
+    rep.automatic = automatic;
+    rep.at_s = millis() / 1000;
+
+    const BenchBuild& cur = _record.builds[0];
+    int uncounted = 0;   // Places cases whose only baselines predate the place count
+    for (int i = 0; i < count; i++) {
+        const BenchResult* now = find_result(cur, names[i]);
+        if (!now) continue;
+        bool skipped_uncounted = false;
+        bool compared = false;
+        for (int k = 1; k < BENCH_BUILDS_KEPT && !compared; k++) {
+            const BenchBuild& old = _record.builds[k];
+            const BenchResult* base = old.id[0] ? find_result(old, names[i]) : nullptr;
+            if (base && base->places == 0 && now->places != 0 && is_places_case(names[i])) {
+                skipped_uncounted = true;
+            }
+            if (!base || base->mhz != now->mhz || base->places != now->places ||
+                base->med_cycles == 0) {
+                continue;
+            }
+            compared = true;
+            if (!rep.baseline[0]) strcpy(rep.baseline, old.id);
+            rep.compared++;
+            float mhz = now->mhz;
+            int pct = change_pct(now->med_cycles, base->med_cycles);
+            bool regressed = pct > BENCH_REGRESSION_PCT;
+            Serial.printf("[Bench] %-15s med %8.1f -> %8.1f us (%+4d%%)  cold %8.1f -> %8.1f us "
+                          "(%+4d%%) vs %.8s%s\n",
+                          now->name, base->med_cycles / mhz, now->med_cycles / mhz, pct,
+                          base->cold_cycles / mhz, now->cold_cycles / mhz,
+                          change_pct(now->cold_cycles, base->cold_cycles), old.id,
+                          regressed ? "  REGRESSION" : "");
+            if (regressed) {
+                if (rep.regression_count < BENCH_REGRESSIONS_KEPT) {
+                    BenchRegression& reg = rep.regressions[rep.regression_count];
+                    strcpy(reg.name, now->name);
+                    reg.med_us = now->med_cycles / mhz;
+                    reg.base_us = base->med_cycles / mhz;
+                }
+                rep.regression_count++;
+            }
+        }
+        if (!compared && skipped_uncounted) uncounted++;
+    }
+    if (uncounted) {
+        Serial.printf("[Bench] %d places case(s) not compared: the earlier results were saved "
+                      "before the place count was (this run is the new baseline)\n", uncounted);
+    }
+    if (rep.compared) {
+        Serial.printf("[Bench] %u case(s) compared with earlier builds, %u regression(s) over %d%%\n",
+                      rep.compared, rep.regression_count, BENCH_REGRESSION_PCT);
+    } else {
+        Serial.println("[Bench] No earlier build ran these cases at this clock");
+    }
+
+    portENTER_CRITICAL(&_report_mux);
+    _report = rep;
+    _has_report = true;
+    portEXIT_CRITICAL(&_report_mux);
+}
+
+// ------------------------------------------------------------------
+// Runner
+// ------------------------------------------------------------------
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Median cycles per iteration, and those of the first (cold) call; false
+// if skipped
+static bool run_case(const BenchCase& c, uint32_t* med_cycles, uint32_t* cold_cycles) {
+    if (c.ready && !c.ready()) {
+        Serial.printf("[Bench] %-15s skipped (not available)\n", c.name);
+        return false;
+    }
+    int n = min(c.iterations, BENCH_MAX_ITERATIONS);
+    _rng = 0x52574C31;   // Fresh seed per case
+
+    // The first call warms the caches and lazy allocations. Running after
+    // other cases, it shows what instruction and data cache misses cost.
+    uint32_t cold_start = ESP.getCycleCount();
+    c.run(0);
+    *cold_cycles = ESP.getCycleCount() - cold_start;
+    int64_t wall_start = esp_timer_get_time();
+    for (int i = 0; i < n; i++) {
+        uint32_t start = ESP.getCycleCount();
+        c.run(i);
+        _samples[i] = ESP.getCycleCount() - start;
+    }
+    int64_t wall_us = esp_timer_get_time() - wall_start;
+
+    qsort(_samples, n, sizeof(uint32_t), compare_u32);
+    float mhz = ESP.getCpuFreqMHz();
+    int p99 = min(n - 1, (n * 99) / 100);
+    Serial.printf("[Bench] %-15s n=%-3d min %8.1f  med %8.1f  p99 %8.1f  cold %8.1f us  "
+                  "(%lu ms total)\n",
+                  c.name, n, _samples[0] / mhz, _samples[n / 2] / mhz, _samples[p99] / mhz,
+                  *cold_cycles / mhz, (unsigned long)(wall_us / 1000));
+    if (c.bytes) {
+        // bytes per us at the median is MB/s
+        Serial.printf("[Bench] %-15s %.1f MB/s\n", c.name, c.bytes * mhz / _samples[n / 2]);
+    }
+    *med_cycles = _samples[n / 2];
+    delay(1);            // Let the idle task run between cases
+    return true;
+}
+
+static void alloc_scratch() {
+    _packed = (uint8_t*)(psramFound() ? ps_malloc(MAP_PACKED_BYTES) : malloc(MAP_PACKED_BYTES));
+    _payload = (char*)(psramFound() ? ps_malloc(BENCH_PAYLOAD_BYTES) : malloc(BENCH_PAYLOAD_BYTES));
+    if (_payload) build_payload();
+    static const char* const FS_PATHS[] = { "/places.bin", MAP_TILES_PATH, "/stations.bin" };
+    for (const char* path : FS_PATHS) {
+        File f = LittleFS.open(path, "r");
+        bool big = f && f.size() >= BENCH_FS_BYTES;
+        f.close();
+        if (big) {
+            _fs_path = path;
+            break;
+        }
+    }
+    if (_fs_path) _fs_buf = (uint8_t*)(psramFound() ? ps_malloc(BENCH_FS_BYTES) : malloc(BENCH_FS_BYTES));
+    if (psramFound()) {
+        _canvas = new Arduino_Canvas(BENCH_GLYPH_W, BENCH_GLYPH_H, nullptr);
+        if (!_canvas->begin(GFX_SKIP_OUTPUT_BEGIN)) {
+            delete _canvas;
+            _canvas = nullptr;
+        }
+    }
+}
+
+static void free_scratch() {
+    free(_packed);
+    free(_payload);
+    free(_fs_buf);
+    delete _canvas;
+    _packed = nullptr;
+    _payload = nullptr;
+    _canvas = nullptr;
+    _fs_path = nullptr;
+    _fs_buf = nullptr;
+}
+
+// The database the places cases run on, and what loading it cost
+static void print_places_db() {
+    PlacesLoadStats st;
+    if (!places_db_load_stats(&st)) return;
+    Serial.printf("[Bench] places: %lu places (%s), read %.1f ms, tables %.1f ms, "
+                  "%lu KB SRAM, %lu KB PSRAM\n",
+                  (unsigned long)places_db_count(), st.storage, st.read_us / 1000.0f,
+                  st.build_us / 1000.0f, (unsigned long)(st.sram_bytes / 1024),
+                  (unsigned long)(st.psram_bytes / 1024));
+}
+
+// Quick: only the QUICK_CASES, for the check after a new build
+static void bench_run(const char* filter, bool quick) {
+    Serial.printf("[Bench] Running %s at %lu MHz\n",
+                  quick ? "the quick subset" : filter[0] ? filter : "all cases",
+                  (unsigned long)ESP.getCpuFreqMHz());
+    if (!_loaded) load_record();
+    alloc_scratch();
+    int matched = 0;
+    int ran = 0;
+    const char* names[CASE_COUNT];
+    uint16_t mhz = ESP.getCpuFreqMHz();
+    bool places_shown = false;
+    for (int i = 0; i < CASE_COUNT; i++) {
+        if (strncmp(CASES[i].name, filter, strlen(filter)) != 0) continue;
+        if (quick && !is_quick(CASES[i].name)) continue;
+        matched++;
+        bool places = is_places_case(CASES[i].name);
+        if (places && !places_shown) {
+            print_places_db();
+            places_shown = true;
+        }
+        uint32_t med, cold;
+        if (!run_case(CASES[i], &med, &cold)) continue;
+        store_result(CASES[i].name, med, cold, mhz, places ? places_db_count() : 0);
+        names[ran++] = CASES[i].name;
+    }
+    free_scratch();
+    if (matched == 0) Serial.printf("[Bench] No case matches '%s'\n", filter);
+    if (ran == 0) return;
+    check_regressions(names, ran, quick);
+    persist_mark_dirty(save_record);
+}
+
+// BENCH:saved - Saved builds, newest first, and the last check
+static void print_saved() {
+    if (!_loaded) load_record();
+    Serial.printf("[Bench] Running build %s, regression threshold %d%%\n",
+                  _build_id, BENCH_REGRESSION_PCT);
+    for (const BenchBuild& b : _record.builds) {
+        if (!b.id[0]) continue;
+        Serial.printf("[Bench]   %s  %2u case(s)\n", b.id, b.count);
+    }
+    BenchReport rep;
+    if (!bench_get_report(&rep)) return;
+    Serial.printf("[Bench] Last check at %lus%s: %u compared with %s, %u regression(s)\n",
+                  (unsigned long)rep.at_s, rep.automatic ? " (automatic)" : "", rep.compared,
+                  rep.baseline[0] ? rep.baseline : "-", rep.regression_count);
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+static void cmd_bench(const char* args) {
+    if (strcmp(args, "saved") == 0) {
+        print_saved();
+        return;
+    }
+    bench_run(args, false);
+}
+
+void bench_task() {
+    if (!_loaded) load_record();
+    if (!_auto_pending) return;
+    uint32_t up = millis();
+    uint32_t idle = display_idle_ms();
+    uint32_t wait = 0;
+    if (up < BENCH_AUTO_AFTER_MS) wait = BENCH_AUTO_AFTER_MS - up;
+    if (idle < BENCH_AUTO_IDLE_MS) wait = max(wait, BENCH_AUTO_IDLE_MS - idle);
+    if (wait) {
+        loop_events_due_in(wait);
+        return;
+    }
+    _auto_pending = false;
+    bench_run("", true);
+    display_invalidate(DISPLAY_PART_VIEW);   // display.status drew over the view
+}
+
+bool bench_get_report(BenchReport* out) {
+    portENTER_CRITICAL(&_report_mux);
+    bool has = _has_report;
+    if (has) *out = _report;
+    portEXIT_CRITICAL(&_report_mux);
+    return has;
+}
+
+void bench_init(UIState* state) {
+    _state = state;
+    serial_cmd_register("BENCH", cmd_bench);
+    serial_cmd_register("BENCH:", cmd_bench);
+}
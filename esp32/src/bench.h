@@ -0,0 +1,71 @@
+/**
+ * On-device microbenchmarks for RadioWall.
+ *
+ * Serial "BENCH" runs every case; "BENCH:name" runs the cases whose name
+ * starts with name (e.g. "BENCH:map"). Each case is timed per iteration
+ * with the CPU cycle counter and reported as min / median / p99 in
+ * microseconds, plus the wall time from esp_timer; cases that move a
+ * known number of bytes also report MB/s at the median. Inputs are fixed
+ * (seeded random points, a synthetic channels payload) so runs compare
+ * across builds.
+ *
+ * Runs on the loop task: the UI is frozen while it runs, and the network
+ * worker on core 0 keeps going, so expect some noise in the p99.
+ *
+ * Every run saves each case's median (in cycles, with the clock it ran
+ * at) under the firmware's build ID, the first 16 hex digits of its ELF
+ * SHA-256, for the last BENCH_BUILDS_KEPT builds (state store). The run
+ * then compares its medians with the newest older build that ran the same
+ * case at the same clock; one slower by more than BENCH_REGRESSION_PCT is
+ * a regression, logged and served in /metrics (metrics_http.h). On the
+ * first boot of a new build (after an OTA or a flash) the quick subset of
+ * cases runs by itself once the frame has been left alone for a while.
+ * The places cases are preceded by the database's size, load time and
+ * heap, and are only compared with runs on as many places, so a synthetic
+ * places.bin (compile_places.py --synthetic) raises no regressions.
+ * "BENCH:saved" lists the saved builds.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+#include "ui_state.h"
+
+#ifndef BENCH_REGRESSION_PCT
+#define BENCH_REGRESSION_PCT 15
+#endif
+
+static const int BENCH_BUILDS_KEPT = 4;
+static const int BENCH_BUILD_ID_LEN = 16;
+static const int BENCH_NAME_LEN = 16;
+static const int BENCH_REGRESSIONS_KEPT = 8;
+
+struct BenchRegression {
+    char name[BENCH_NAME_LEN];
+    float med_us;
+    float base_us;
+};
+
+// Outcome of the last regression check
+struct BenchReport {
+    char build[BENCH_BUILD_ID_LEN + 1];
+    char baseline[BENCH_BUILD_ID_LEN + 1];   // Empty: nothing to compare with
+    bool automatic;                           // The quick run after a new build
+    uint32_t at_s;                            // Uptime of the check
+    uint16_t compared;
+    uint16_t regression_count;                // May exceed the regressions kept
+    BenchRegression regressions[BENCH_REGRESSIONS_KEPT];
+};
+
+// Register the BENCH commands; state is used for the status bar redraw
+void bench_init(UIState* state);
+
+// Load the saved results and, on a new build, run the quick subset once
+// the frame is idle (loop task, after state_store_init)
+void bench_task();
+
+// Copy of the last check; false if none ran since boot (any task)
+bool bench_get_report(BenchReport* out);
+
+#endif // BENCH_H
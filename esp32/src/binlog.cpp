@@ -0,0 +1,199 @@
+/**
+ * Deferred binary logging implementation for RadioWall.
+ *
+ * Records are written under a spinlock, as trace.cpp does: the caller
+ * builds its record on the stack and the critical section only copies
+ * it into the next slot, overwriting the oldest. Formatting happens in
+ * the LOG command, one conversion at a time: each argument goes to
+ * snprintf with just its own part of the format, so the record's mixed
+ * words, floats and strings need no va_list.
+ *
+ * The record layout is what "LOG:bin" dumps and tools/binlog_decode.py
+ * unpacks; change both together.
+ */
+
+#include "binlog.h"
+
+#if !defined(BINLOG_SERIAL) && defined(ESP32)
+
+#include "serial_cmd.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const int BINLOG_RING = 64;
+static const int BINLOG_TEXT = 24;       // Bytes for all string arguments
+static const size_t BINLOG_LINE = 192;
+
+// 52 bytes, no padding
+struct BinlogRecord {
+    uint32_t time_us;
+    uint32_t fmt;          // Address of the format string, in flash
+    uint8_t level;
+    uint8_t nargs;
+    uint8_t kinds;         // BinlogKind per argument, 2 bits each
+    uint8_t core;
+    uint32_t args[BINLOG_MAX_ARGS];
+    char text[BINLOG_TEXT];
+};
+
+static portMUX_TYPE _log_mux = portMUX_INITIALIZER_UNLOCKED;
+static BinlogRecord _ring[BINLOG_RING];
+static uint32_t _written = 0;            // Records written since the last clear
+
+static const char LEVEL_NAMES[] = "DIW";
+
+// ------------------------------------------------------------------
+// Recording
+// ------------------------------------------------------------------
+
+void binlog_write(uint8_t level, const char* fmt, int nargs, const BinlogArg* args) {
+    BinlogRecord r = {};
+    r.time_us = micros();
+    r.fmt = (uint32_t)(uintptr_t)fmt;
+    r.level = level;
+    r.nargs = nargs;
+    r.core = xPortGetCoreID();
+
+    size_t text = 0;
+    for (int i = 0; i < nargs; i++) {
+        r.kinds |= args[i].kind << (2 * i);
+        r.args[i] = args[i].word;
+        if (args[i].kind != BINLOG_STRING) continue;
+
+        // Copy what fits. Once the text is full, later strings point at
+        // its last byte, which is always '\0'.
+        const char* s = args[i].str ? args[i].str : "(null)";
+        size_t at = min(text, (size_t)BINLOG_TEXT - 1);
+        size_t n = strnlen(s, BINLOG_TEXT - 1 - at);
+        memcpy(r.text + at, s, n);
+        r.args[i] = at;
+        text = at + n + 1;
+    }
+
+    portENTER_CRITICAL(&_log_mux);
+    _ring[_written % BINLOG_RING] = r;
+    _written++;
+    portEXIT_CRITICAL(&_log_mux);
+}
+
+// ------------------------------------------------------------------
+// Formatting
+// ------------------------------------------------------------------
+
+static size_t format_record(const BinlogRecord& r, char* out, size_t cap) {
+    const char* p = (const char*)(uintptr_t)r.fmt;
+    size_t len = 0;
+    int arg = 0;
+    while (*p && len + 1 < cap) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // One conversion: flags, width, precision, length, then the type
+        const char* end = p + 1;
+        while (*end && !strchr("diouxXcsfFeEgGaAp", *end)) end++;
+        if (!*end) break;
+        char spec[16];
+        size_t n = min((size_t)(end - p + 1), sizeof(spec) - 1);
+        memcpy(spec, p, n);
+        spec[n] = '\0';
+        p = end + 1;
+
+        if (arg >= r.nargs) continue;
+        uint32_t word = r.args[arg];
+        int wrote;
+        switch ((r.kinds >> (2 * arg)) & 3) {
+            case BINLOG_FLOAT: {
+                float f;
+                memcpy(&f, &word, sizeof(f));
+                wrote = snprintf(out + len, cap - len, spec, (double)f);
+                break;
+            }
+            case BINLOG_STRING:
+                wrote = snprintf(out + len, cap - len, spec, r.text + min(word, (uint32_t)BINLOG_TEXT - 1));
+                break;
+            default:
+                if (*end == 'p') wrote = snprintf(out + len, cap - len, spec, (void*)(uintptr_t)word);
+                else wrote = snprintf(out + len, cap - len, spec, word);
+                break;
+        }
+        arg++;
+        if (wrote > 0) len = min(len + wrote, cap - 1);
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// Copy out the records still in the ring, oldest first
+static int snapshot(BinlogRecord* out, uint32_t* dropped) {
+    portENTER_CRITICAL(&_log_mux);
+    uint32_t written = _written;
+    int count = min(written, (uint32_t)BINLOG_RING);
+    for (int i = 0; i < count; i++) {
+        out[i] = _ring[(written - count + i) % BINLOG_RING];
+    }
+    portEXIT_CRITICAL(&_log_mux);
+    *dropped = written - count;
+    return count;
+}
+
+// ------------------------------------------------------------------
+// Serial commands
+// ------------------------------------------------------------------
+
+static void print_records(bool binary) {
+    static BinlogRecord records[BINLOG_RING];   // Loop task only
+    uint32_t dropped;
+    int count = snapshot(records, &dropped);
+    Serial.printf("[Log] %d record(s), %lu older overwritten\n", count, (unsigned long)dropped);
+
+    char line[BINLOG_LINE];
+    for (int i = 0; i < count; i++) {
+        const BinlogRecord& r = records[i];
+        if (binary) {
+            const uint8_t* b = (const uint8_t*)&r;
+            for (size_t j = 0; j < sizeof(r); j++) {
+                snprintf(line + 2 * j, 3, "%02x", b[j]);
+            }
+            Serial.printf("[Log] bin %s\n", line);
+            continue;
+        }
+        size_t len = format_record(r, line, sizeof(line));
+        if (len && line[len - 1] == '\n') line[len - 1] = '\0';
+        Serial.printf("[Log] %10lu.%06lu %c%u %s\n",
+                      (unsigned long)(r.time_us / 1000000), (unsigned long)(r.time_us % 1000000),
+                      LEVEL_NAMES[min(r.level, (uint8_t)2)], (unsigned)r.core, line);
+    }
+}
+
+static void cmd_log(const char* args) {
+    if (strcmp(args, "bin") == 0) {
+        print_records(true);
+    } else if (strcmp(args, "clear") == 0) {
+        portENTER_CRITICAL(&_log_mux);
+        _written = 0;
+        portEXIT_CRITICAL(&_log_mux);
+        Serial.println("[Log] Cleared");
+    } else {
+        print_records(false);
+    }
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void binlog_serial_init() {
+    static_assert(sizeof(BinlogRecord) == 52, "binlog_decode.py unpacks 52-byte records");
+    static_assert(BINLOG_LINE > 2 * sizeof(BinlogRecord), "hex dump line");
+    serial_cmd_register("LOG", cmd_log);
+    serial_cmd_register("LOG:", cmd_log);
+}
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * Compile-time filtered, deferred binary logging for RadioWall.
+ *
+ * The hot paths (taps, map draws, HTTP GETs, zoom changes) used to
+ * Serial.printf every time, and formatting plus USB CDC output cost real
+ * time on each of them. BINLOG_D / BINLOG_I / BINLOG_W take printf-style
+ * arguments (checked by the compiler as for printf), but:
+ *
+ * - Levels below BINLOG_LEVEL are compiled out, arguments and all.
+ * - The rest are not formatted. A record in a RAM ring keeps the pointer
+ *   to the format string (which stays in flash), a timestamp, and the
+ *   arguments as 32-bit words; strings are copied, truncated to what fits.
+ *
+ * Serial "LOG" formats and prints the ring on the device when asked;
+ * "LOG:bin" dumps the raw records as hex for tools/binlog_decode.py,
+ * which formats them on the host from the firmware ELF; "LOG:clear"
+ * empties it. Build with -DBINLOG_SERIAL to print each record as it
+ * happens instead, as the old Serial.printf calls did. The native build
+ * always prints.
+ *
+ * At most four arguments per call: integers up to 32 bits, pointers,
+ * floats/doubles (kept as float) and C strings.
+ *
+ * Any task.
+ */
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <Arduino.h>
+
+#define BINLOG_LEVEL_DEBUG 0
+#define BINLOG_LEVEL_INFO  1
+#define BINLOG_LEVEL_WARN  2
+#define BINLOG_LEVEL_NONE  3
+
+#ifndef BINLOG_LEVEL
+#define BINLOG_LEVEL BINLOG_LEVEL_INFO
+#endif
+
+#define BINLOG_MAX_ARGS 4
+
+#define BINLOG_D(fmt, ...) BINLOG_AT(BINLOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define BINLOG_I(fmt, ...) BINLOG_AT(BINLOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define BINLOG_W(fmt, ...) BINLOG_AT(BINLOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+
+#if defined(BINLOG_SERIAL) || !defined(ESP32)
+
+#define BINLOG_AT(level, fmt, ...) do {                                    \
+        if ((level) >= BINLOG_LEVEL) Serial.printf(fmt, ##__VA_ARGS__);    \
+    } while (0)
+
+static inline void binlog_serial_init() {}
+
+#else
+
+enum BinlogKind : uint8_t {
+    BINLOG_WORD,       // Integer, pointer
+    BINLOG_FLOAT,      // float bits
+    BINLOG_STRING,     // Offset into the record's text
+};
+
+struct BinlogArg {
+    uint32_t word;
+    BinlogKind kind;
+    const char* str;
+};
+
+static inline BinlogArg binlog_arg(int v) { return {(uint32_t)v, BINLOG_WORD, nullptr}; }
+static inline BinlogArg binlog_arg(unsigned v) { return {v, BINLOG_WORD, nullptr}; }
+static inline BinlogArg binlog_arg(long v) { return {(uint32_t)v, BINLOG_WORD, nullptr}; }
+static inline BinlogArg binlog_arg(unsigned long v) { return {(uint32_t)v, BINLOG_WORD, nullptr}; }
+static inline BinlogArg binlog_arg(const void* p) { return {(uint32_t)(uintptr_t)p, BINLOG_WORD, nullptr}; }
+static inline BinlogArg binlog_arg(const char* s) { return {0, BINLOG_STRING, s}; }
+static inline BinlogArg binlog_arg(double v) {
+    float f = (float)v;
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return {bits, BINLOG_FLOAT, nullptr};
+}
+static BinlogArg binlog_arg(long long v) = delete;     // Would need two words
+static BinlogArg binlog_arg(unsigned long long v) = delete;
+
+void binlog_write(uint8_t level, const char* fmt, int nargs, const BinlogArg* args);
+
+template <typename... Args>
+static inline void binlog_emit(uint8_t level, const char* fmt, Args... args) {
+    static_assert(sizeof...(Args) <= BINLOG_MAX_ARGS, "binlog: at most 4 arguments");
+    const BinlogArg list[] = {binlog_arg(args)..., {0, BINLOG_WORD, nullptr}};
+    binlog_write(level, fmt, sizeof...(Args), list);
+}
+
+// Never called: lets the compiler check the arguments against the format
+static inline void binlog_check(const char*, ...) __attribute__((format(printf, 1, 2)));
+static inline void binlog_check(const char*, ...) {}
+
+#define BINLOG_AT(level, fmt, ...) do {                                    \
+        if ((level) >= BINLOG_LEVEL) {                                     \
+            if (0) binlog_check(fmt, ##__VA_ARGS__);                       \
+            binlog_emit(level, fmt, ##__VA_ARGS__);                        \
+        }                                                                  \
+    } while (0)
+
+// Register the LOG serial commands
+void binlog_serial_init();
+
+#endif
+
+#endif // BINLOG_H
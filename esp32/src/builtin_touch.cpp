@@ -6,14 +6,57 @@
  *
  * Uses AXS15231B I2C capacitive touch controller (integrated display+touch IC).
  * Based on working LILYGO GFX_AXS15231B_Image example.
+ *
+ * A reader task woken by the INT pin does the I2C reads and pushes
+ * timestamped samples into the touch ring (touch_ring.h). INT is a
+ * level-low interrupt that masks itself and is re-armed by the reader
+ * after each read, so a report left pending keeps asking without a poll,
+ * and with no finger down the reader sleeps until INT goes low (which
+ * also ends a light sleep, power_idle.h).
+ * builtin_touch_task() (loop task) drains the ring into the gesture logic
+ * using the sample times, so touches made while the loop is busy with a
+ * redraw are still seen, in order and with their real timing.
+ *
+ * While a finger is down every controller report is read. Moves feed a
+ * smoothed velocity, so a short fast flick counts as a swipe. Two fingers
+ * on the map start a pinch: the zoom level follows the change in finger
+ * spread, applied at most once per builtin_touch_task() pass.
+ *
+ * Holding a finger still on the map for SCRUB_HOLD_MS starts a scrub. From
+ * then on every moved sample looks up the nearest city in the places
+ * index (a few grid cells, well under the sampling interval; the lift log
+ * reports the times). A different city becomes the candidate only when
+ * the finger is SCRUB_SWITCH_RATIO times closer to it than to the city
+ * playing, and plays only after the finger has stayed on it for
+ * SCRUB_DWELL_MS and SCRUB_MIN_GAP_MS after the last audition, so a fast
+ * drag doesn't thrash the speaker. Candidates, and the city the finger's
+ * velocity points at, are handed out for prefetching first. Each audition
+ * is a play like a tap, so it supersedes the one before it.
  */
 
 #include "builtin_touch.h"
 #include "config.h"
 #include "display.h"
+#include "loop_events.h"
+#include "event_bus.h"
 #include "ui_state.h"
+#include "touch_ring.h"
+#include "touch_calib.h"
+#include "serial_cmd.h"
+#include "trace.h"
+#include "binlog.h"
+#include "replay.h"
+#include "places_db.h"
+#include "power_idle.h"
+#include "energy_stats.h"
+#include "haptic.h"
+#include "hot_path.h"
 #include "Arduino_DriveBus_Library.h"
 #include <Wire.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 // T-Display-S3-Long touch controller pins
 #define TOUCH_SDA 15
@@ -21,28 +64,41 @@
 #define TOUCH_RST 16
 #define TOUCH_INT 11
 #define TOUCH_I2C_ADDR 0x3B
+#define TOUCH_MAX_POINTS 2        // Points per report read (6 bytes each after a 2-byte header)
+
+// Bus clock. The charger IC at 0x6A shares the bus and tops out at 400 kHz,
+// so IIC_FAST_PLUS_SPEED only works with it removed.
+#ifndef TOUCH_I2C_SPEED
+#define TOUCH_I2C_SPEED IIC_FAST_SPEED
+#endif
 
 // Display dimensions
 #define LCD_WIDTH 180
 #define LCD_HEIGHT 640
 
-// Touch read command (from working LILYGO example)
-static const uint8_t read_touchpad_cmd[] = {0xB5, 0xAB, 0xA5, 0x5A, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00};
-
-// Legacy callback
-static TouchCallback _touch_callback = nullptr;
+// Touch read command (from working LILYGO example); bytes 6-7 are the read length
+static const uint8_t TOUCH_REPORT_LEN = 2 + TOUCH_MAX_POINTS * 6;
+static const uint8_t read_touchpad_cmd[] = {0xB5, 0xAB, 0xA5, 0x5A, 0x00, 0x00, 0x00, TOUCH_REPORT_LEN, 0x00, 0x00, 0x00};
 
-// Zone-based callbacks
-static MapTouchCallback _map_touch_callback = nullptr;
-static UIButtonCallback _ui_button_callback = nullptr;
-static MenuTouchCallback _menu_touch_callback = nullptr;
-static SwipeCallback _swipe_callback = nullptr;
-static VolumeChangeCallback _volume_change_callback = nullptr;
 static UIState* _ui_state = nullptr;
 
-static unsigned long _last_touch_ms = 0;
+static unsigned long _last_touch_ms = 0;   // Time of the last sample consumed
 static bool _initialized = false;
-static volatile bool _touch_interrupt = false;
+
+// Reader task: the only I2C user after init
+static const uint32_t READER_STACK = 3072;
+static const UBaseType_t READER_PRIORITY = 3;   // Above the loop task (1)
+static const BaseType_t READER_CORE = 1;        // Loop task's core; WiFi stays on 0
+static const uint32_t READ_INTERVAL_MS = 20;    // Min spacing between reads while idle
+static const uint32_t ACTIVE_READ_MS = 4;       // Min spacing with a finger down (250 Hz)
+static const uint32_t READER_ACTIVE_MS = 50;    // Finger down: wait for INT at most this
+static const uint32_t READER_IDLE_MS = 1000;    // No finger: only to notice a replay start
+static TaskHandle_t _reader_task = nullptr;
+
+static volatile uint32_t _ring_dropped = 0;   // Moves the ring had no room for
+static bool _skip_until_lift = false;         // Rest of a consumed double-tap
+
+static void touch_reader_task(void*);
 
 // Gesture tracking state
 enum TouchZone { ZONE_MAP, ZONE_MENU, ZONE_VOLUME, ZONE_STATUS_BAR };
@@ -50,22 +106,86 @@ static bool _gesture_active = false;
 static uint16_t _touch_start_x, _touch_start_y;
 static uint16_t _touch_current_x, _touch_current_y;
 static unsigned long _touch_start_ms = 0;
+static unsigned long _touch_current_ms = 0;
 static TouchZone _touch_start_zone = ZONE_MAP;
 
+// Smoothed finger velocity (px/ms), for flicks
+static float _vel_x = 0, _vel_y = 0;
+static const float VELOCITY_SMOOTHING = 0.5f;
+static const float FLICK_VELOCITY = 0.6f;      // px/ms (600 px/s)
+static const int FLICK_MIN_DISTANCE = 15;      // px, below the 30 px swipe
+
+// Two-finger pinch on the map
+static bool _pinch_active = false;             // Until every finger lifts
+static float _pinch_start_dist = 0;
+static int _pinch_start_zoom = 1;
+static int _pinch_zoom = 1;                    // Level the spread asks for
+static int _pinch_applied_zoom = 1;            // Level last posted
+static uint16_t _pinch_mid_x = 0, _pinch_mid_y = 0;
+static const float PINCH_MIN_DIST = 20.0f;     // px between the fingers at start
+static const float PINCH_HYSTERESIS = 0.65f;   // Levels past the current one
+static const unsigned long PINCH_SETTLE_MS = 150;  // Leftover finger after a pinch
+static unsigned long _pinch_end_ms = 0;
+
+// Vertical drag on the favorites/history list
+static bool _list_touch = false;               // Gesture started on a list
+static bool _list_dragging = false;            // Moved enough to scroll, not tap
+static uint16_t _list_last_y = 0;
+static const int LIST_DRAG_START = 10;         // px, below the 15 px tap slop
+
+// Vertical drag on the volume slider (y 70..560)
+static bool _volume_dragging = false;          // Moved enough to drag, not tap
+static int _volume_sent = -1;                  // Level last posted
+static const int VOLUME_TOP_Y = 70;
+static const int VOLUME_BOTTOM_Y = 560;
+
+// Press-and-hold drag on the map: audition the cities under the finger
+static bool _touch_wandered = false;           // Left the hold slop this gesture
+static bool _scrub_active = false;
+static PlaceHandle _scrub_city = PLACE_NONE;   // Last auditioned
+static int _scrub_city_lat = 0, _scrub_city_lon = 0;   // ... at (degrees x 100)
+static PlaceHandle _scrub_candidate = PLACE_NONE;      // Waiting out the dwell
+static int _scrub_cand_lat = 0, _scrub_cand_lon = 0;
+static unsigned long _scrub_candidate_ms = 0;
+static unsigned long _scrub_audition_ms = 0;
+static PlaceHandle _scrub_ahead = PLACE_NONE;  // Last handed out for prefetching
+static unsigned long _scrub_ahead_ms = 0;
+static uint16_t _scrub_last_x = 0, _scrub_last_y = 0;  // Where the last lookup ran
+static uint32_t _scrub_lookups = 0;
+static uint32_t _scrub_lookup_us = 0;          // Total, for the average
+static uint32_t _scrub_lookup_max_us = 0;
+static int _scrub_auditions = 0;
+static const unsigned long SCRUB_HOLD_MS = 400;
+static const int SCRUB_HOLD_SLOP = 10;         // px the finger may wander while held
+static const int SCRUB_MOVE_PX = 2;            // Finger moves below this skip the lookup
+static const float SCRUB_SWITCH_RATIO = 1.3f;  // Closer to a new city by this factor
+static const unsigned long SCRUB_DWELL_MS = 250;
+static const unsigned long SCRUB_MIN_GAP_MS = 700;   // Between auditions
+static const unsigned long SCRUB_AHEAD_MS = 150;     // Look-ahead interval
+static const float SCRUB_LOOKAHEAD_MS = 400.0f;      // How far the velocity is followed
+
 // Double-tap detection for map area (deferred single tap)
-static MapDoubleTapCallback _map_double_tap_callback = nullptr;
 static bool _pending_tap = false;
 static uint16_t _pending_tap_x = 0;
 static uint16_t _pending_tap_y = 0;
 static unsigned long _pending_tap_time = 0;
 static const unsigned long DOUBLE_TAP_WINDOW_MS = 500;
+static const unsigned long TOUCH_LOST_MS = 200;   // No data this long = finger up
 
 // I2C bus (using Arduino_DriveBus library like working example)
 static std::shared_ptr<Arduino_IIC_DriveBus> IIC_Bus = nullptr;
 
-// Interrupt handler
+// Charger on the same bus, read by the reader between touches
+static const uint8_t PMU_I2C_ADDR = 0x6A;
+static const uint32_t PMU_SAMPLE_MS = 10000;
+static Arduino_SY6970* _pmu = nullptr;
+
+// Interrupt handler: INT is level-low, masked here until the reader has read
 void IRAM_ATTR AXS15231_Touch_ISR() {
-    _touch_interrupt = true;
+    gpio_ll_intr_disable(&GPIO, (gpio_num_t)TOUCH_INT);
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(_reader_task, &woken);
+    if (woken) portYIELD_FROM_ISR();
 }
 
 // Helper function for I2C write (from working example)
@@ -80,8 +200,20 @@ bool IIC_WriteC8D8(uint8_t device_address, uint8_t c, uint8_t d) {
     return (Wire.endTransmission() == 0);
 }
 
+// Serial simulation (for testing): T:x,y taps map coordinates
+static void cmd_simulate_tap(const char* args) {
+    const char* comma = strchr(args, ',');
+    if (!comma) return;
+    int map_x = atoi(args);
+    int map_y = atoi(comma + 1);
+    Serial.printf("[Touch] Serial simulation: Map (%d, %d)\n", map_x, map_y);
+
+    event_bus_post_point(BUS_MAP_TOUCH, map_x, map_y);
+}
+
 void builtin_touch_init() {
     Serial.println("[Touch] Initializing built-in touchscreen...");
+    serial_cmd_register("T:", cmd_simulate_tap);
 
     // Initialize interrupt pin
     pinMode(TOUCH_INT, INPUT_PULLUP);
@@ -92,17 +224,35 @@ void builtin_touch_init() {
 
     // Initialize I2C bus using Arduino_DriveBus
     IIC_Bus = std::make_shared<Arduino_HWIIC>(TOUCH_SDA, TOUCH_SCL, &Wire);
-    IIC_Bus->begin();
+    IIC_Bus->begin(TOUCH_I2C_SPEED);
 
     // Configure power management chip (from working example)
     // Disable ILIM pin and set input current limit to maximum
-    IIC_WriteC8D8(0x6A, 0x00, 0B00111111);
+    IIC_WriteC8D8(PMU_I2C_ADDR, 0x00, 0B00111111);
     // Enable BATFET for LiPo battery operation
     // Reg 0x09: bit6=1 (delay before BATFET turnoff), bit5=0 (BATFET enabled), bit2=1 (safety timer)
-    IIC_WriteC8D8(0x6A, 0x09, 0B01000100);
+    IIC_WriteC8D8(PMU_I2C_ADDR, 0x09, 0B01000100);
+    // ADC in continuous mode (one conversion a second) for energy_stats
+    _pmu = new Arduino_SY6970(IIC_Bus, PMU_I2C_ADDR, DRIVEBUS_DEFAULT_VALUE, DRIVEBUS_DEFAULT_VALUE);
+    if (!_pmu->IIC_Write_Device_State(Arduino_IIC_Power::POWER_DEVICE_ADC_MEASURE,
+                                      Arduino_IIC_Power::POWER_DEVICE_ON)) {
+        Serial.println("[Touch] Charger ADC not answering, no battery readings");
+        delete _pmu;
+        _pmu = nullptr;
+    }
+    haptic_init(IIC_Bus);   // Optional motor on the same bus
+
+    // Reader task first: the ISR notifies it
+    if (xTaskCreatePinnedToCore(touch_reader_task, "touch_reader", READER_STACK, nullptr,
+                                READER_PRIORITY, &_reader_task, READER_CORE) != pdPASS) {
+        Serial.println("[Touch] Failed to start reader task");
+        return;
+    }
 
-    // Attach interrupt for touch events
-    attachInterrupt(digitalPinToInterrupt(TOUCH_INT), AXS15231_Touch_ISR, FALLING);
+    // Attach interrupt for touch events (low level: a pending report
+    // keeps it asserted, and it can end a light sleep)
+    attachInterrupt(digitalPinToInterrupt(TOUCH_INT), AXS15231_Touch_ISR, ONLOW);
+    power_idle_wake_on_low(TOUCH_INT);
 
     _initialized = true;
     Serial.println("[Touch] AXS15231B touch controller initialized");
@@ -117,75 +267,196 @@ void builtin_touch_init() {
     #endif
 }
 
-void builtin_touch_set_callback(TouchCallback cb) {
-    _touch_callback = cb;
-}
-
-void builtin_touch_set_map_callback(MapTouchCallback cb) {
-    _map_touch_callback = cb;
-}
-
-void builtin_touch_set_ui_button_callback(UIButtonCallback cb) {
-    _ui_button_callback = cb;
-}
-
 void builtin_touch_set_ui_state(UIState* state) {
     _ui_state = state;
 }
 
-void builtin_touch_set_menu_callback(MenuTouchCallback cb) {
-    _menu_touch_callback = cb;
-}
-
-void builtin_touch_set_swipe_callback(SwipeCallback cb) {
-    _swipe_callback = cb;
-}
+// ------------------------------------------------------------------
+// Gesture helper: portrait map coordinates -> lat/lon
+// ------------------------------------------------------------------
 
-void builtin_touch_set_volume_change_callback(VolumeChangeCallback cb) {
-    _volume_change_callback = cb;
+// UIState keeps the view's fixed-point projection, rebuilt only when the
+// view changes. Output is in hundredths of a degree, as Place stores them.
+static void portrait_to_latlon_x100(uint16_t portrait_x, uint16_t portrait_y,
+                                    int* lat_x100, int* lon_x100) {
+    _ui_state->unproject(portrait_x, portrait_y, lat_x100, lon_x100);
 }
 
-void builtin_touch_set_map_double_tap_callback(MapDoubleTapCallback cb) {
-    _map_double_tap_callback = cb;
+// ------------------------------------------------------------------
+// Gesture helper: list scroll event (velocity carried in px/s)
+// ------------------------------------------------------------------
+static void post_list_scroll(ListScrollPhase phase, int dy, float velocity_y) {
+    BusEvent e = {};
+    e.type = BUS_LIST_SCROLL;
+    e.phase = phase;
+    e.y = dy;
+    e.value = lroundf(velocity_y * 1000);   // px/s
+    event_bus_post(e);
 }
 
 // ------------------------------------------------------------------
 // Gesture helper: fire map tap at given portrait coordinates
 // ------------------------------------------------------------------
 static void fire_map_tap(uint16_t portrait_x, uint16_t portrait_y) {
-    if (!_ui_state || !_map_touch_callback) return;
+    if (!_ui_state) return;
 
-    const int MAP_AREA_HEIGHT = 580;
-    const int MAP_W = 180;
+    int lat_x100, lon_x100;
+    portrait_to_latlon_x100(portrait_x, portrait_y, &lat_x100, &lon_x100);
+    BINLOG_I("[Touch] Tap: Portrait(%d,%d) -> (%.2f, %.2f)\n",
+             portrait_x, portrait_y, lat_x100 / 100.0f, lon_x100 / 100.0f);
+
+    event_bus_post_location(BUS_MAP_LOCATION, lat_x100 / 100.0f, lon_x100 / 100.0f);
+}
 
-    float norm_x = portrait_x / (float)(MAP_W - 1);
-    float norm_y = portrait_y / (float)(MAP_AREA_HEIGHT - 1);
+// ------------------------------------------------------------------
+// Gesture helper: scrub along a drag path
+// ------------------------------------------------------------------
+
+// Squared distance in hundredths of a degree, longitude scaled to the
+// latitude: enough to compare two cities near the finger
+static float scrub_dist2(int lat_a, int lon_a, int lat_b, int lon_b) {
+    int dlon = lon_a - lon_b;
+    if (dlon > 18000) dlon -= 36000;
+    if (dlon < -18000) dlon += 36000;
+    float dx = dlon * cosf(lat_a * (float)M_PI / 18000.0f);
+    float dy = (float)(lat_a - lat_b);
+    return dx * dx + dy * dy;
+}
+
+// Nearest city with stations to a portrait point, timed
+static PlaceHandle scrub_nearest(int x, int y, int* lat_x100, int* lon_x100) {
+    const int MAP_AREA_HEIGHT = 580;
+    portrait_to_latlon_x100(constrain(x, 0, LCD_WIDTH - 1), constrain(y, 0, MAP_AREA_HEIGHT - 1),
+                            lat_x100, lon_x100);
+    uint32_t start = micros();
+    PlaceHandle city;
+    int found = places_db_find_k_nearest(*lat_x100 / 100.0f, *lon_x100 / 100.0f, 1, &city);
+    uint32_t us = micros() - start;
+    _scrub_lookups++;
+    _scrub_lookup_us += us;
+    if (us > _scrub_lookup_max_us) _scrub_lookup_max_us = us;
+    return found ? city : PLACE_NONE;
+}
 
-    // Use zoom-aware geographic bounds
-    float lon_min = _ui_state->get_view_lon_min();
-    float lon_max = _ui_state->get_view_lon_max();
-    float lat_max = _ui_state->get_view_lat_max();
-    float lat_min = _ui_state->get_view_lat_min();
+static void scrub_prefetch(PlaceHandle city, const Place& place, unsigned long now) {
+    if (city == _scrub_ahead) return;
+    _scrub_ahead = city;
+    _scrub_ahead_ms = now;
+    event_bus_post_location(BUS_MAP_SCRUB, place.lat_x100 / 100.0f, place.lon_x100 / 100.0f,
+                            MAP_SCRUB_AHEAD);
+}
 
-    float lon_range = lon_max - lon_min;
-    if (lon_range < 0) lon_range += 360.0f;
+static void scrub_audition(unsigned long now) {
+    Place place;
+    if (!places_db_get(_scrub_candidate, &place)) {
+        _scrub_candidate = PLACE_NONE;
+        return;
+    }
+    _scrub_city = _scrub_candidate;
+    _scrub_city_lat = _scrub_cand_lat;
+    _scrub_city_lon = _scrub_cand_lon;
+    _scrub_candidate = PLACE_NONE;
+    _scrub_audition_ms = now;
+    _scrub_auditions++;
+    Serial.printf("[Touch] Scrub -> %s, %s\n", place.name, place.country);
+    event_bus_post_location(BUS_MAP_SCRUB, place.lat_x100 / 100.0f, place.lon_x100 / 100.0f,
+                            MAP_SCRUB_AUDITION);
+}
 
-    float lon = lon_min + norm_x * lon_range;
-    float lat = lat_max - norm_y * (lat_max - lat_min);
+// A candidate that has waited out the dwell and the gap plays
+static void scrub_check_dwell(unsigned long now) {
+    if (_scrub_candidate == PLACE_NONE) return;
+    if (now - _scrub_candidate_ms < SCRUB_DWELL_MS) return;
+    if (_scrub_city != PLACE_NONE && now - _scrub_audition_ms < SCRUB_MIN_GAP_MS) return;
+    scrub_audition(now);
+}
 
-    if (lon > 180.0f) lon -= 360.0f;
-    if (lon < -180.0f) lon += 360.0f;
+// ms until scrub_check_dwell() can next play something, or -1
+static long scrub_due_in(unsigned long now) {
+    if (!_scrub_active || _scrub_candidate == PLACE_NONE) return -1;
+    long dwell = (long)SCRUB_DWELL_MS - (long)(now - _scrub_candidate_ms);
+    long gap = _scrub_city == PLACE_NONE ? 0
+             : (long)SCRUB_MIN_GAP_MS - (long)(now - _scrub_audition_ms);
+    return max(0L, max(dwell, gap));
+}
 
-    int server_x = (int)((lon + 180.0f) / 360.0f * 1024.0f);
-    int server_y = (int)((90.0f - lat) / 180.0f * 600.0f);
+static void scrub_sample(uint16_t x, uint16_t y, unsigned long now) {
+    if (abs((int)x - (int)_scrub_last_x) + abs((int)y - (int)_scrub_last_y) >= SCRUB_MOVE_PX) {
+        _scrub_last_x = x;
+        _scrub_last_y = y;
+
+        int lat, lon;
+        PlaceHandle nearest = scrub_nearest(x, y, &lat, &lon);
+        if (nearest == _scrub_city) {
+            _scrub_candidate = PLACE_NONE;   // Back on the city playing
+        } else if (nearest != PLACE_NONE && nearest != _scrub_candidate) {
+            // Hysteresis: the playing city keeps the finger until the new
+            // one is clearly closer
+            Place place;
+            if (places_db_get(nearest, &place) &&
+                (_scrub_city == PLACE_NONE ||
+                 scrub_dist2(lat, lon, _scrub_city_lat, _scrub_city_lon) >
+                     SCRUB_SWITCH_RATIO * SCRUB_SWITCH_RATIO *
+                     scrub_dist2(lat, lon, place.lat_x100, place.lon_x100))) {
+                _scrub_candidate = nearest;
+                _scrub_cand_lat = place.lat_x100;
+                _scrub_cand_lon = place.lon_x100;
+                _scrub_candidate_ms = now;
+                scrub_prefetch(nearest, place, now);   // Fetch during the dwell
+            }
+        }
 
-    server_x = constrain(server_x, 0, 1023);
-    server_y = constrain(server_y, 0, 599);
+        // Where the finger will be shortly, if it keeps going
+        if (now - _scrub_ahead_ms >= SCRUB_AHEAD_MS) {
+            int ax = x + (int)lroundf(_vel_x * SCRUB_LOOKAHEAD_MS);
+            int ay = y + (int)lroundf(_vel_y * SCRUB_LOOKAHEAD_MS);
+            int alat, alon;
+            PlaceHandle ahead = (ax != x || ay != y) ? scrub_nearest(ax, ay, &alat, &alon)
+                                                     : PLACE_NONE;
+            Place place;
+            if (ahead != PLACE_NONE && ahead != _scrub_city && ahead != _scrub_candidate &&
+                places_db_get(ahead, &place)) {
+                scrub_prefetch(ahead, place, now);
+            }
+        }
+    }
+    scrub_check_dwell(now);
+}
 
-    Serial.printf("[Touch] Tap: Portrait(%d,%d) -> Lat/Lon(%.2f,%.2f) -> Server(%d,%d)\n",
-                 portrait_x, portrait_y, lat, lon, server_x, server_y);
+static void scrub_start(uint16_t x, uint16_t y, unsigned long now) {
+    _scrub_active = true;
+    _scrub_city = _scrub_candidate = _scrub_ahead = PLACE_NONE;
+    _scrub_lookups = _scrub_lookup_us = _scrub_lookup_max_us = 0;
+    _scrub_auditions = 0;
+    _scrub_ahead_ms = now;
+
+    int lat, lon;
+    PlaceHandle city = scrub_nearest(x, y, &lat, &lon);
+    _scrub_last_x = x;
+    _scrub_last_y = y;
+    Serial.printf("[Touch] Scrub start at (%d, %d)\n", x, y);
+    event_bus_post_location(BUS_MAP_SCRUB, lat / 100.0f, lon / 100.0f, MAP_SCRUB_START);
+
+    // The hold was the dwell: the city under the finger plays at once
+    Place place;
+    if (city != PLACE_NONE && places_db_get(city, &place)) {
+        _scrub_candidate = city;
+        _scrub_cand_lat = place.lat_x100;
+        _scrub_cand_lon = place.lon_x100;
+        scrub_audition(now);
+    }
+}
 
-    _map_touch_callback(server_x, server_y);
+// lift: the finger came off (a city it was settling on plays), rather
+// than a pinch taking over
+static void scrub_end(bool lift, unsigned long now) {
+    if (lift && _scrub_candidate != PLACE_NONE) scrub_audition(now);
+    _scrub_active = false;
+    Serial.printf("[Touch] Scrub end: %d audition(s), %lu lookups (avg %lu us, max %lu us)\n",
+                  _scrub_auditions, (unsigned long)_scrub_lookups,
+                  (unsigned long)(_scrub_lookups ? _scrub_lookup_us / _scrub_lookups : 0),
+                  (unsigned long)_scrub_lookup_max_us);
+    event_bus_post_location(BUS_MAP_SCRUB, 0, 0, MAP_SCRUB_END);
 }
 
 // ------------------------------------------------------------------
@@ -196,24 +467,25 @@ static void handle_map_gesture(unsigned long now) {
     int dy = (int)_touch_current_y - (int)_touch_start_y;
     unsigned long duration = now - _touch_start_ms;
 
-    if (abs(dx) > 30 && abs(dx) > abs(dy) && duration < 800) {
+    // A fast flick is a swipe from a shorter distance (not while a tap is
+    // pending: 15-30 px there means a merged double-tap)
+    float speed = max(fabsf(_vel_x), fabsf(_vel_y));
+    int swipe_min = (speed >= FLICK_VELOCITY && !_pending_tap) ? FLICK_MIN_DISTANCE : 30;
+
+    if (abs(dx) > swipe_min && abs(dx) > abs(dy) && duration < 800) {
         // Horizontal swipe: +1 = right, -1 = left
         _pending_tap = false;  // Cancel any pending tap
         int direction = (dx > 0) ? 1 : -1;
-        Serial.printf("[Touch] Swipe %s (dx=%d, duration=%lums)\n",
-                     direction > 0 ? "right" : "left", dx, duration);
-        if (_swipe_callback) {
-            _swipe_callback(direction);
-        }
-    } else if (abs(dy) > 30 && abs(dy) > abs(dx) && duration < 800) {
+        Serial.printf("[Touch] Swipe %s (dx=%d, duration=%lums, %.2f px/ms)\n",
+                     direction > 0 ? "right" : "left", dx, duration, speed);
+        event_bus_post_value(BUS_SWIPE, direction);
+    } else if (abs(dy) > swipe_min && abs(dy) > abs(dx) && duration < 800) {
         // Vertical swipe: +2 = down, -2 = up
         _pending_tap = false;  // Cancel any pending tap
         int direction = (dy > 0) ? 2 : -2;
-        Serial.printf("[Touch] Swipe %s (dy=%d, duration=%lums)\n",
-                     direction > 0 ? "down" : "up", dy, duration);
-        if (_swipe_callback) {
-            _swipe_callback(direction);
-        }
+        Serial.printf("[Touch] Swipe %s (dy=%d, duration=%lums, %.2f px/ms)\n",
+                     direction > 0 ? "down" : "up", dy, duration, speed);
+        event_bus_post_value(BUS_SWIPE, direction);
     } else if (abs(dx) < 15 && abs(dy) < 15) {
         // Small movement = tap
         if (_pending_tap && (now - _pending_tap_time < DOUBLE_TAP_WINDOW_MS)) {
@@ -221,23 +493,22 @@ static void handle_map_gesture(unsigned long now) {
             _pending_tap = false;
             Serial.printf("[Touch] Double-tap (on UP) at (%d, %d)\n",
                          _touch_start_x, _touch_start_y);
-            if (_map_double_tap_callback) {
-                _map_double_tap_callback(_touch_start_x, _touch_start_y);
-            }
-            // Flush touch controller after blocking callback (INT pin fix)
-            uint8_t flush_buf[8] = {0};
-            IIC_Bus->IIC_ReadCData_Data(TOUCH_I2C_ADDR,
-                read_touchpad_cmd, sizeof(read_touchpad_cmd),
-                flush_buf, sizeof(flush_buf));
-            _touch_interrupt = false;
+            event_bus_post_point(BUS_MAP_DOUBLE_TAP, _touch_start_x, _touch_start_y);
         } else {
             // First tap → defer, wait for possible second tap
+            trace_tap_start(_touch_start_ms);
             _pending_tap = true;
             _pending_tap_x = _touch_start_x;
             _pending_tap_y = _touch_start_y;
             _pending_tap_time = now;
             Serial.printf("[Touch] Tap pending at (%d, %d) - waiting for double-tap\n",
                          _touch_start_x, _touch_start_y);
+            // Let the lookup and fetches run during the double-tap window
+            if (_ui_state) {
+                int lat_x100, lon_x100;
+                portrait_to_latlon_x100(_touch_start_x, _touch_start_y, &lat_x100, &lon_x100);
+                event_bus_post_location(BUS_MAP_TAP_PENDING, lat_x100 / 100.0f, lon_x100 / 100.0f);
+            }
         }
     } else if (_pending_tap && (now - _pending_tap_time < DOUBLE_TAP_WINDOW_MS)) {
         // Merged double-tap: fast taps merged into one gesture because the
@@ -246,14 +517,7 @@ static void handle_map_gesture(unsigned long now) {
         _pending_tap = false;
         Serial.printf("[Touch] Double-tap (merged) at (%d, %d)\n",
                      _touch_current_x, _touch_current_y);
-        if (_map_double_tap_callback) {
-            _map_double_tap_callback(_touch_current_x, _touch_current_y);
-        }
-        uint8_t flush_buf[8] = {0};
-        IIC_Bus->IIC_ReadCData_Data(TOUCH_I2C_ADDR,
-            read_touchpad_cmd, sizeof(read_touchpad_cmd),
-            flush_buf, sizeof(flush_buf));
-        _touch_interrupt = false;
+        event_bus_post_point(BUS_MAP_DOUBLE_TAP, _touch_current_x, _touch_current_y);
     }
     // else: ambiguous gesture, ignore
 }
@@ -264,8 +528,14 @@ static void handle_map_gesture(unsigned long now) {
 static void handle_touch_down(uint16_t x, uint16_t y, unsigned long now) {
     const int MAP_AREA_HEIGHT = 580;
 
+    // The second finger of a pinch that ended on the first one's UP
+    if (now - _pinch_end_ms < PINCH_SETTLE_MS) {
+        _skip_until_lift = true;
+        return;
+    }
+
     // Check for double-tap BEFORE starting the new gesture.
-    // Detect on second DOWN (not UP) so it fires before any blocking callback.
+    // Detect on second DOWN (not UP) so the zoom starts before the finger lifts.
     if (_pending_tap && (now - _pending_tap_time < DOUBLE_TAP_WINDOW_MS)) {
         // Only if this DOWN is also in the map zone
         bool in_map_zone = (y < MAP_AREA_HEIGHT) && _ui_state &&
@@ -274,18 +544,10 @@ static void handle_touch_down(uint16_t x, uint16_t y, unsigned long now) {
             _pending_tap = false;
             _gesture_active = false;
             Serial.printf("[Touch] Double-tap at (%d, %d)\n", x, y);
-            if (_map_double_tap_callback) {
-                _map_double_tap_callback(x, y);
-            }
-            // The callback likely blocked for seconds (map redraw).
-            // The touch controller may have fired events (UP) during the block
-            // that we never read, leaving the INT pin stuck LOW permanently.
-            // Flush with a dummy read to release INT and restore interrupts.
-            uint8_t flush_buf[8] = {0};
-            IIC_Bus->IIC_ReadCData_Data(TOUCH_I2C_ADDR,
-                read_touchpad_cmd, sizeof(read_touchpad_cmd),
-                flush_buf, sizeof(flush_buf));
-            _touch_interrupt = false;
+            event_bus_post_point(BUS_MAP_DOUBLE_TAP, x, y);
+            // The reader keeps sampling while the handler redraws the map;
+            // the rest of this second tap must not start a gesture.
+            _skip_until_lift = true;
             return;  // Don't start a new gesture
         }
     }
@@ -296,6 +558,9 @@ static void handle_touch_down(uint16_t x, uint16_t y, unsigned long now) {
     _touch_current_x = x;
     _touch_current_y = y;
     _touch_start_ms = now;
+    _touch_current_ms = now;
+    _vel_x = _vel_y = 0;
+    _touch_wandered = false;
 
     // Determine zone based on position and current view
     if (y >= MAP_AREA_HEIGHT) {
@@ -310,18 +575,82 @@ static void handle_touch_down(uint16_t x, uint16_t y, unsigned long now) {
         _touch_start_zone = ZONE_MAP;
     }
 
-    // No immediate action for volume - wait for tap (UP event)
+    // A list takes hold at once, so a finger stops a flick
+    _list_dragging = false;
+    _list_touch = _touch_start_zone == ZONE_MENU &&
+                  (_ui_state->get_view_mode() == VIEW_FAVORITES ||
+                   _ui_state->get_view_mode() == VIEW_HISTORY);
+    if (_list_touch) post_list_scroll(LIST_SCROLL_GRAB, 0, 0);
+
+    // Volume waits for a tap (UP event) or a drag
+    _volume_dragging = false;
+    _volume_sent = -1;
+}
+
+// Slider level under y
+static int volume_at(int y) {
+    return constrain(map(y, VOLUME_BOTTOM_Y, VOLUME_TOP_Y, 0, 100), 0, 100);
 }
 
 // ------------------------------------------------------------------
 // Gesture helper: handle finger CONTACT (held/moving)
 // ------------------------------------------------------------------
-static void handle_touch_contact(uint16_t x, uint16_t y) {
+static void handle_touch_contact(uint16_t x, uint16_t y, unsigned long now) {
     if (!_gesture_active) return;
+
+    unsigned long dt = now - _touch_current_ms;
+    if (dt > 0) {
+        float vx = ((int)x - (int)_touch_current_x) / (float)dt;
+        float vy = ((int)y - (int)_touch_current_y) / (float)dt;
+        _vel_x += VELOCITY_SMOOTHING * (vx - _vel_x);
+        _vel_y += VELOCITY_SMOOTHING * (vy - _vel_y);
+    }
     _touch_current_x = x;
     _touch_current_y = y;
+    _touch_current_ms = now;
+
+    // Lists follow the finger once it has moved further than a tap would
+    if (_list_touch) {
+        if (!_list_dragging && abs((int)y - (int)_touch_start_y) > LIST_DRAG_START) {
+            _list_dragging = true;
+            _list_last_y = _touch_start_y;
+        }
+        if (_list_dragging && y != _list_last_y) {
+            post_list_scroll(LIST_SCROLL_DRAG, (int)y - (int)_list_last_y, 0);
+            _list_last_y = y;
+        }
+    }
 
-    // Volume is tap-based, no live drag updates
+    // A finger held still on the map starts a scrub
+    if (_touch_start_zone == ZONE_MAP && !_scrub_active) {
+        if (abs((int)x - (int)_touch_start_x) > SCRUB_HOLD_SLOP ||
+            abs((int)y - (int)_touch_start_y) > SCRUB_HOLD_SLOP) {
+            _touch_wandered = true;
+        }
+        if (!_touch_wandered && !_pending_tap && _ui_state &&
+            _ui_state->get_view_mode() == VIEW_MAP && places_db_loaded() &&
+            now - _touch_start_ms >= SCRUB_HOLD_MS) {
+            scrub_start(x, y, now);
+            return;
+        }
+    }
+    if (_scrub_active) scrub_sample(x, y, now);
+
+    // The slider follows a drag that started on it. Each new level is
+    // posted; the display draws at most one frame per refresh and the
+    // network worker sends only the latest level.
+    if (_touch_start_zone == ZONE_VOLUME) {
+        if (!_volume_dragging && _touch_start_y >= VOLUME_TOP_Y &&
+            _touch_start_y <= VOLUME_BOTTOM_Y &&
+            abs((int)y - (int)_touch_start_y) > LIST_DRAG_START) {
+            _volume_dragging = true;
+        }
+        int vol = volume_at(y);
+        if (_volume_dragging && vol != _volume_sent) {
+            _volume_sent = vol;
+            event_bus_post_value(BUS_VOLUME, vol);
+        }
+    }
 }
 
 // ------------------------------------------------------------------
@@ -333,145 +662,286 @@ static void handle_touch_up(unsigned long now) {
 
     switch (_touch_start_zone) {
         case ZONE_MAP:
-            handle_map_gesture(now);
+            if (_scrub_active) {
+                scrub_end(true, now);
+            } else {
+                handle_map_gesture(now);
+            }
             break;
 
         case ZONE_MENU:
-            if (_menu_touch_callback) {
+            if (_list_dragging) {
+                Serial.printf("[Touch] List released: %.2f px/ms\n", _vel_y);
+                post_list_scroll(LIST_SCROLL_RELEASE, 0, _vel_y);
+            } else {
                 Serial.printf("[Touch] Menu tap: (%d, %d)\n", _touch_start_x, _touch_start_y);
-                _menu_touch_callback(_touch_start_x, _touch_start_y);
+                event_bus_post_point(BUS_MENU_TOUCH, _touch_start_x, _touch_start_y);
             }
             break;
 
         case ZONE_VOLUME:
-            // Tap-based volume: use DOWN position (more reliable than UP coordinates)
-            if (_volume_change_callback && _touch_start_y >= 70 && _touch_start_y <= 560) {
-                int vol = map(_touch_start_y, 560, 70, 0, 100);
-                vol = constrain(vol, 0, 100);
+            if (_volume_dragging) {
+                Serial.printf("[Touch] Volume drag: y=%d -> %d%%\n", _touch_current_y, _volume_sent);
+                break;
+            }
+            // Tap: use DOWN position (more reliable than UP coordinates)
+            if (_touch_start_y >= VOLUME_TOP_Y && _touch_start_y <= VOLUME_BOTTOM_Y) {
+                int vol = volume_at(_touch_start_y);
                 Serial.printf("[Touch] Volume tap: y=%d -> %d%%\n", _touch_start_y, vol);
-                _volume_change_callback(vol);
+                event_bus_post_value(BUS_VOLUME, vol);
             }
             break;
 
         case ZONE_STATUS_BAR:
-            if (_ui_button_callback) {
-                if (_touch_start_x < 90) {
-                    Serial.println("[Touch] Status bar: LEFT button");
-                    _ui_button_callback(0);
-                } else {
-                    Serial.println("[Touch] Status bar: RIGHT button");
-                    _ui_button_callback(1);
-                }
+            if (_touch_start_x < 90) {
+                Serial.println("[Touch] Status bar: LEFT button");
+                event_bus_post_value(BUS_UI_BUTTON, 0);
+            } else {
+                Serial.println("[Touch] Status bar: RIGHT button");
+                event_bus_post_value(BUS_UI_BUTTON, 1);
             }
             break;
     }
 }
 
 // ------------------------------------------------------------------
-// Main touch task
+// Gesture helper: two-finger sample (pinch zoom on the map)
 // ------------------------------------------------------------------
-void builtin_touch_task() {
-    if (!_initialized) return;
+static void handle_pinch(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    const int MAP_AREA_HEIGHT = 580;
 
-    unsigned long now = millis();
+    float dx = (float)x2 - (float)x1;
+    float dy = (float)y2 - (float)y1;
+    float dist = sqrtf(dx * dx + dy * dy);
+    uint16_t mid_x = (x1 + x2) / 2;
+    uint16_t mid_y = (y1 + y2) / 2;
+
+    if (!_pinch_active) {
+        bool on_map = _ui_state && _ui_state->get_view_mode() == VIEW_MAP &&
+                      mid_y < MAP_AREA_HEIGHT;
+        if (!on_map || dist < PINCH_MIN_DIST) return;
+
+        // No longer a tap, a swipe or a scrub
+        if (_scrub_active) scrub_end(false, millis());
+        _pinch_active = true;
+        _gesture_active = false;
+        _pending_tap = false;
+        _pinch_start_dist = dist;
+        _pinch_start_zoom = _ui_state->get_zoom_level();
+        _pinch_zoom = _pinch_applied_zoom = _pinch_start_zoom;
+        Serial.printf("[Touch] Pinch start at %dx (spread %.0f px)\n", _pinch_start_zoom, dist);
+    }
+
+    _pinch_mid_x = mid_x;
+    _pinch_mid_y = mid_y;
+
+    // Magnification follows the spread; map tiles exist at whole levels only
+    float target = _pinch_start_zoom * dist / _pinch_start_dist;
+    if (fabsf(target - _pinch_zoom) > PINCH_HYSTERESIS) {
+        _pinch_zoom = constrain((int)lroundf(target), 1, world_map_zoom_max());
+    }
+}
+
+// ------------------------------------------------------------------
+// Reader task (producer)
+// ------------------------------------------------------------------
+
+// Parse a touch report (AXS15231B protocol)
+static HOT_PATH void parse_report(const uint8_t* buf, uint32_t ms, TouchSample* sample) {
+    sample->ms = ms;
+    sample->source = 0;
+    sample->fingers = buf[1];
+    sample->event = buf[2] >> 6;  // Upper 2 bits: 0=DOWN, 1=UP, 2=CONTACT
+    // Raw touch coordinates (byte mapping matches hardware orientation)
+    sample->x = ((uint16_t)(buf[4] & 0x0F) << 8) | (uint16_t)buf[5];
+    sample->y = LCD_HEIGHT - (((uint16_t)(buf[2] & 0x0F) << 8) | (uint16_t)buf[3]);
+    sample->x2 = ((uint16_t)(buf[10] & 0x0F) << 8) | (uint16_t)buf[11];
+    sample->y2 = LCD_HEIGHT - (((uint16_t)(buf[8] & 0x0F) << 8) | (uint16_t)buf[9]);
+}
+
+static void push_sample(const TouchSample& sample, bool& finger_down) {
+    bool lift = touch_sample_is_lift(sample);
+    if (touch_ring_push(sample, finger_down && !lift)) {
+        finger_down = !lift;
+    } else if (finger_down && !lift) {
+        _ring_dropped++;
+    } else {
+        Serial.printf("[Touch] Sample ring full, %s lost\n", lift ? "lift" : "press");
+    }
+}
+
+// Battery, system and VBUS rails and the charge current (reader task)
+static void sample_pmu() {
+    using V = Arduino_IIC_Power::Value_Information;
+    double battery = _pmu->IIC_Read_Device_Value(V::POWER_BATTERY_VOLTAGE);
+    double system = _pmu->IIC_Read_Device_Value(V::POWER_SYSTEM_VOLTAGE);
+    double vbus = _pmu->IIC_Read_Device_Value(V::POWER_INPUT_VOLTAGE);
+    double charge = _pmu->IIC_Read_Device_Value(V::POWER_CHARGING_CURRENT);
+    if (battery < 0 || system < 0 || vbus < 0 || charge < 0) return;   // Read failed (-1)
+    energy_stats_record_pmu((uint16_t)battery, (uint16_t)system, (uint16_t)vbus, (uint16_t)charge);
+}
+
+static void touch_reader_task(void*) {
+    bool finger_down = false;   // As of the last sample pushed
+    uint32_t last_read = 0;
+    uint32_t last_pmu = 0;
+
+    for (;;) {
+        // A replayed trace stands in for the panel (replay.h)
+        TouchSample replayed;
+        int32_t replay_wait = replay_touch_take(&replayed);
+        if (replay_wait == 0) {
+            push_sample(replayed, finger_down);
+            continue;
+        }
+        if (replay_wait > 0) {
+            vTaskDelay(pdMS_TO_TICKS(replay_wait));
+            continue;
+        }
+
+        // Between touches only: a finger gets the bus to itself
+        if (_pmu && !finger_down && (!last_pmu || millis() - last_pmu >= PMU_SAMPLE_MS)) {
+            last_pmu = millis();
+            sample_pmu();
+        }
+
+        // Re-arm INT (masked by the ISR) and wait for it. With no finger
+        // down nothing else wakes the reader, so the chip may sleep.
+        gpio_intr_enable((gpio_num_t)TOUCH_INT);
+        uint32_t wait_ms = finger_down ? READER_ACTIVE_MS : READER_IDLE_MS;
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms)) == 0) continue;
+
+        // A read takes under 1 ms at 400 kHz: follow every report while a
+        // finger is down, debounce only the first one
+        uint32_t since = millis() - last_read;
+        uint32_t spacing = finger_down ? ACTIVE_READ_MS : READ_INTERVAL_MS;
+        if (since < spacing) {
+            vTaskDelay(pdMS_TO_TICKS(spacing - since));
+        }
+        ulTaskNotifyTake(pdTRUE, 0);   // Edges so far are covered by this read
+        last_read = millis();
+
+        // Read touch data using Arduino_DriveBus
+        uint8_t temp_buf[TOUCH_REPORT_LEN] = {0};
+        bool read_success = IIC_Bus->IIC_ReadCData_Data(
+            TOUCH_I2C_ADDR,
+            read_touchpad_cmd, sizeof(read_touchpad_cmd),
+            temp_buf, sizeof(temp_buf)
+        );
+
+        if (!read_success) {
+            static bool first_error = true;
+            if (first_error) {
+                Serial.println("[Touch] I2C read error");
+                first_error = false;
+            }
+            continue;
+        }
+
+        TouchSample sample;
+        parse_report(temp_buf, last_read, &sample);
+
+        bool lift = touch_sample_is_lift(sample);
+        if (lift && !finger_down) continue;   // Idle read, nothing to report
+        if (!finger_down) haptic_tap();       // Touch-down: acknowledge before the loop sees it
+
+        replay_record_touch(sample);
+        push_sample(sample, finger_down);
+        power_idle_hold(POWER_HOLD_TOUCH, finger_down);   // Full rate until the lift
+    }
+}
 
+// ------------------------------------------------------------------
+// Sample consumer (loop task)
+// ------------------------------------------------------------------
+
+// Deferred tap and lost-UP timeouts, evaluated at a sample's time while
+// draining and at millis() once the ring is empty
+static void check_timeouts(unsigned long now) {
     // Deferred tap timeout: fire single tap if no second tap arrived
     if (_pending_tap && (now - _pending_tap_time >= DOUBLE_TAP_WINDOW_MS)) {
         _pending_tap = false;
-        Serial.printf("[Touch] Deferred tap fired at (%d, %d)\n",
-                     _pending_tap_x, _pending_tap_y);
+        BINLOG_D("[Touch] Deferred tap fired at (%d, %d)\n", _pending_tap_x, _pending_tap_y);
+        trace_span(TRACE_TAP_DEFER, _pending_tap_time * 1000UL, micros());
         fire_map_tap(_pending_tap_x, _pending_tap_y);
     }
 
+    // A scrub candidate the finger stopped on
+    if (_scrub_active) scrub_check_dwell(now);
+
     // Timeout: if gesture active but no touch data for 200ms, treat as UP
-    if (_gesture_active && (now - _last_touch_ms > 200)) {
+    if (_gesture_active && (now - _last_touch_ms > TOUCH_LOST_MS)) {
         handle_touch_up(now);
     }
-
-    // Check for touch interrupt
-    if (!_touch_interrupt) {
-        // Serial simulation (for testing)
-        if (Serial.available() && Serial.peek() == 'T') {
-            String line = Serial.readStringUntil('\n');
-            line.trim();
-
-            if (line.startsWith("T:")) {
-                int comma = line.indexOf(',', 2);
-                if (comma > 0) {
-                    int map_x = line.substring(2, comma).toInt();
-                    int map_y = line.substring(comma + 1).toInt();
-                    Serial.printf("[Touch] Serial simulation: Map (%d, %d)\n", map_x, map_y);
-
-                    if (_map_touch_callback) {
-                        _map_touch_callback(map_x, map_y);
-                    }
-                }
-            }
-        }
-        return;
+    if (_pinch_active && (now - _last_touch_ms > TOUCH_LOST_MS)) {
+        _pinch_active = false;
     }
+}
 
-    // Debounce: don't clear _touch_interrupt yet — if debounce blocks the
-    // read, the flag stays set so we retry on the next iteration instead of
-    // silently dropping the event.
-    if (now - _last_touch_ms < 20) {
-        return;
+// Wake the loop again when check_timeouts() next has something to do
+static void schedule_timeouts(unsigned long now) {
+    if (_pending_tap) {
+        unsigned long age = now - _pending_tap_time;
+        loop_events_due_in(age < DOUBLE_TAP_WINDOW_MS ? DOUBLE_TAP_WINDOW_MS - age : 0);
+    }
+    long scrub_due = scrub_due_in(now);
+    if (scrub_due >= 0) loop_events_due_in(scrub_due);
+    if (_gesture_active || _pinch_active) {
+        unsigned long idle = now - _last_touch_ms;
+        loop_events_due_in(idle <= TOUCH_LOST_MS ? TOUCH_LOST_MS - idle + 1 : 0);
     }
-    _touch_interrupt = false;
+}
+
+static void handle_sample(const TouchSample& sample) {
+    unsigned long now = sample.ms;
+    check_timeouts(now);
     _last_touch_ms = now;
 
-    // Read touch data using Arduino_DriveBus
-    uint8_t temp_buf[8] = {0};
-    bool read_success = IIC_Bus->IIC_ReadCData_Data(
-        TOUCH_I2C_ADDR,
-        read_touchpad_cmd, sizeof(read_touchpad_cmd),
-        temp_buf, sizeof(temp_buf)
-    );
-
-    if (!read_success) {
-        static bool first_error = true;
-        if (first_error) {
-            Serial.println("[Touch] I2C read error");
-            first_error = false;
-        }
+    if (_skip_until_lift) {
+        if (touch_sample_is_lift(sample)) _skip_until_lift = false;
         return;
     }
 
-    // Parse touch data (AXS15231B protocol)
-    uint8_t fingers_number = temp_buf[1];
-    uint8_t touch_event = temp_buf[2] >> 6;  // Upper 2 bits: 0=DOWN, 1=UP, 2=CONTACT
-
     // No fingers = finger lifted
-    if (fingers_number == 0) {
+    if (sample.fingers == 0) {
+        _pinch_active = false;
         if (_gesture_active) {
             handle_touch_up(now);
         }
         return;
     }
 
-    if (fingers_number != 1) return;
+    if (sample.fingers >= 2) {
+        handle_pinch(sample.x, sample.y, sample.x2, sample.y2);
+        return;
+    }
 
-    // Extract raw touch coordinates (unchanged - byte mapping matches hardware orientation)
-    uint16_t touch_x = ((uint16_t)(temp_buf[4] & 0x0F) << 8) | (uint16_t)temp_buf[5];
-    uint16_t touch_y = LCD_HEIGHT - (((uint16_t)(temp_buf[2] & 0x0F) << 8) | (uint16_t)temp_buf[3]);
+    // A pinch stays a pinch while the last finger comes off
+    if (_pinch_active) {
+        if (sample.event == 1) {
+            _pinch_active = false;
+            _pinch_end_ms = now;   // The other finger may still be down
+        }
+        return;
+    }
 
     // Handle based on event type
     // Note: Some AXS15231B firmware repeats DOWN (0) instead of sending
     // CONTACT (2) while finger is held. If already tracking, treat as CONTACT.
-    switch (touch_event) {
+    switch (sample.event) {
         case 0: // DOWN - finger placed (or repeated while held)
             if (_gesture_active) {
-                handle_touch_contact(touch_x, touch_y);
+                handle_touch_contact(sample.x, sample.y, now);
             } else {
-                handle_touch_down(touch_x, touch_y, now);
+                handle_touch_down(sample.x, sample.y, now);
             }
             break;
 
         case 2: // CONTACT - finger held/moving
             if (!_gesture_active) {
-                handle_touch_down(touch_x, touch_y, now);
+                handle_touch_down(sample.x, sample.y, now);
             } else {
-                handle_touch_contact(touch_x, touch_y);
+                handle_touch_contact(sample.x, sample.y, now);
             }
             break;
 
@@ -480,3 +950,32 @@ void builtin_touch_task() {
             break;
     }
 }
+
+// ------------------------------------------------------------------
+// Main touch task
+// ------------------------------------------------------------------
+void builtin_touch_task() {
+    if (!_initialized) return;
+
+    TouchSample sample;
+    while (touch_ring_pop(&sample)) {
+        handle_sample(sample);
+    }
+    unsigned long now = millis();
+    check_timeouts(now);
+    schedule_timeouts(now);
+
+    // One zoom change per pass, however many samples moved the spread
+    if (_pinch_active && _pinch_zoom != _pinch_applied_zoom) {
+        _pinch_applied_zoom = _pinch_zoom;
+        Serial.printf("[Touch] Pinch zoom %dx at (%d, %d)\n",
+                      _pinch_zoom, _pinch_mid_x, _pinch_mid_y);
+        event_bus_post_point(BUS_MAP_PINCH_ZOOM, _pinch_mid_x, _pinch_mid_y, _pinch_zoom);
+    }
+
+    if (_ring_dropped) {
+        Serial.printf("[Touch] Dropped %lu move samples during a stall\n",
+                      (unsigned long)_ring_dropped);
+        _ring_dropped = 0;
+    }
+}
@@ -3,8 +3,13 @@
  *
  * Reads touch coordinates from the built-in AMOLED capacitive touchscreen
  * (640×180) with zone-based handling:
- * - Map area (y < 150): Coordinates translated based on current latitude band
+ * - Map area (y < 150): Coordinates translated based on current latitude band,
+ *   two-finger pinch changes the zoom level; press and hold, then drag, to
+ *   scrub: the city under the finger plays once it has settled on it
  * - Status bar (y >= 150): Button detection (stop/next)
+ * - Favorites/history lists: a vertical drag scrolls the list, and the
+ *   finger's velocity on lift becomes a flick; a touch that doesn't move
+ *   is a tap
  */
 
 #ifndef BUILTIN_TOUCH_H
@@ -15,30 +20,26 @@
 // Forward declaration
 class UIState;
 
-// Legacy callback (deprecated - use zone-based callbacks instead)
-typedef void (*TouchCallback)(int x, int y);
+// Gestures are posted to the event bus (event_bus.h): BUS_MAP_LOCATION for
+// a map tap, BUS_MAP_TAP_PENDING for a first tap that may become a
+// double-tap, BUS_MAP_DOUBLE_TAP, BUS_MAP_PINCH_ZOOM (level 1-5 around the
+// pinch midpoint), BUS_MAP_SCRUB, BUS_UI_BUTTON (0=stop, 1=next),
+// BUS_MENU_TOUCH (raw display coords), BUS_SWIPE (-1=left, +1=right,
+// -2=up, +2=down), BUS_VOLUME (0-100) and BUS_LIST_SCROLL. Serial T:x,y
+// posts BUS_MAP_TOUCH on the 1024x600 map grid.
 
-// Zone-based callbacks
-typedef void (*MapTouchCallback)(int map_x, int map_y);          // Map coordinates (1024×600)
-typedef void (*UIButtonCallback)(int button_id);                  // 0=stop, 1=next
-typedef void (*MenuTouchCallback)(int portrait_x, int portrait_y); // Raw display coords
-typedef void (*SwipeCallback)(int direction);                      // -1=left, +1=right, -2=up, +2=down
-typedef void (*VolumeChangeCallback)(int volume);                  // 0-100
-typedef void (*MapDoubleTapCallback)(int portrait_x, int portrait_y); // Double-tap on map area
+// Finger on a scrolling list: GRAB on touch down, DRAG with the px moved
+// since the last event, RELEASE with the finger's y velocity
+enum ListScrollPhase : uint8_t { LIST_SCROLL_GRAB, LIST_SCROLL_DRAG, LIST_SCROLL_RELEASE };
+
+// Press and hold on the map, then drag: START once the hold is recognised,
+// AHEAD with a city the finger is heading for (warm its caches), AUDITION
+// with the city the finger settled on (play it), END on lift
+enum MapScrubPhase : uint8_t { MAP_SCRUB_START, MAP_SCRUB_AHEAD, MAP_SCRUB_AUDITION, MAP_SCRUB_END };
 
 void builtin_touch_init();
 void builtin_touch_task();
 
-// Legacy callback (deprecated)
-void builtin_touch_set_callback(TouchCallback cb);
-
-// Zone-based callbacks
-void builtin_touch_set_map_callback(MapTouchCallback cb);
-void builtin_touch_set_ui_button_callback(UIButtonCallback cb);
 void builtin_touch_set_ui_state(UIState* state);  // For coordinate translation
-void builtin_touch_set_menu_callback(MenuTouchCallback cb);
-void builtin_touch_set_swipe_callback(SwipeCallback cb);
-void builtin_touch_set_volume_change_callback(VolumeChangeCallback cb);
-void builtin_touch_set_map_double_tap_callback(MapDoubleTapCallback cb);
 
 #endif // BUILTIN_TOUCH_H
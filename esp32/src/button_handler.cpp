@@ -5,23 +5,41 @@
  * - Short press (<800ms): Cycle map region
  * - Long press (>800ms): STOP playback
  * - Double-tap (<400ms between presses): NEXT station
+ *
+ * The edge interrupt stamps each level change with esp_timer time and
+ * queues it for the loop task. button_task() replays the queued edges in
+ * order, so a press is timed from when it happened rather than from when
+ * the loop got to it: a long flush or network stall can delay an action
+ * but not turn a tap into a long press or drop a double-tap.
+ *
+ * Debounce: a burst of edges settles DEBOUNCE_MS after its last edge, and
+ * counts from its first. Between edges nothing polls; the loop is asked
+ * back only for the next deadline (settle, long press, end of the
+ * double-tap window), and not at all while the button is idle.
+ *
+ * Light sleep (power_idle.h) stops the edge interrupt, so a change made
+ * while asleep is picked up from the pin on the next pass, and the chip
+ * is held awake from the first edge until the state machine is idle.
  */
 
 #include "button_handler.h"
 #include "pins_config.h"
+#include "loop_events.h"
+#include "event_bus.h"
+#include "power_idle.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
 
 // Button pin
 #define BUTTON_PIN PIN_BUTTON_1  // GPIO 0
 
 // Timing thresholds (milliseconds)
-#define DEBOUNCE_MS       50    // Minimum press time to register
+#define DEBOUNCE_MS       50    // Quiet time before a level change counts
 #define LONG_PRESS_MS     800   // Hold time for long press
 #define DOUBLE_TAP_MS     400   // Max gap between taps for double-tap
 
-// Callbacks
-static ButtonCallback _region_cycle_callback = nullptr;  // Short press
-static ButtonCallback _stop_callback = nullptr;          // Long press
-static ButtonCallback _next_callback = nullptr;          // Double-tap
+static const uint32_t EDGE_RING_LEN = 32;   // Power of two
+static const int64_t NO_DEADLINE = INT64_MAX;
 
 // Button state machine
 enum ButtonState {
@@ -32,75 +50,94 @@ enum ButtonState {
 };
 
 static ButtonState _state = BTN_IDLE;
-static unsigned long _press_start = 0;      // When button was pressed
-static unsigned long _release_time = 0;     // When button was released (for double-tap)
-static bool _last_reading = HIGH;           // Previous digitalRead
-static unsigned long _last_change = 0;      // For debouncing
+static int64_t _press_start = 0;       // us, when the button went down
+static int64_t _release_time = 0;      // us, when it came up (for double-tap)
+
+// Edge queue, written by the ISR only and read by the loop task only
+struct ButtonEdge {
+    int64_t us;
+    bool level;
+};
+
+static ButtonEdge _edges[EDGE_RING_LEN];
+static volatile uint32_t _edge_head = 0;
+static volatile uint32_t _edge_tail = 0;
+static volatile bool _edges_lost = false;
+
+// Debounce, in edge time
+static bool _stable_level = HIGH;
+static bool _raw_level = HIGH;
+static bool _bouncing = false;
+static int64_t _burst_start = 0;       // First edge of the unsettled burst
+static int64_t _last_edge = 0;
+
+static void IRAM_ATTR button_isr() {
+    uint32_t head = _edge_head;
+    if (head - _edge_tail < EDGE_RING_LEN) {
+        ButtonEdge& e = _edges[head & (EDGE_RING_LEN - 1)];
+        e.us = esp_timer_get_time();
+        e.level = gpio_get_level((gpio_num_t)BUTTON_PIN);
+        _edge_head = head + 1;
+    } else {
+        _edges_lost = true;
+    }
+    loop_events_notify_from_isr();
+}
 
 void button_init() {
     Serial.println("[Button] Initializing...");
     pinMode(BUTTON_PIN, INPUT_PULLUP);
+    _stable_level = _raw_level = digitalRead(BUTTON_PIN);
+    attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), button_isr, CHANGE);
     Serial.printf("[Button] GPIO %d: Short=Region, Long=STOP, Double=NEXT\n", BUTTON_PIN);
 }
 
-void button_set_band_cycle_callback(ButtonCallback cb) {
-    _region_cycle_callback = cb;
-}
+// ------------------------------------------------------------------
+// State machine (times in us)
+// ------------------------------------------------------------------
 
-void button_set_stop_callback(ButtonCallback cb) {
-    _stop_callback = cb;
-}
-
-void button_set_next_callback(ButtonCallback cb) {
-    _next_callback = cb;
-}
-
-void button_task() {
-    unsigned long now = millis();
-    bool reading = digitalRead(BUTTON_PIN);
-
-    // Debounce: ignore changes within DEBOUNCE_MS
-    if (reading != _last_reading) {
-        _last_change = now;
-        _last_reading = reading;
-        return;  // Wait for stable reading
+// When the current state times out on its own
+static int64_t state_deadline() {
+    switch (_state) {
+        case BTN_PRESSED:     return _press_start + LONG_PRESS_MS * 1000LL;
+        case BTN_WAIT_DOUBLE: return _release_time + DOUBLE_TAP_MS * 1000LL;
+        default:              return NO_DEADLINE;
     }
+}
 
-    if (now - _last_change < DEBOUNCE_MS) {
-        return;  // Still bouncing
+// Fire whatever timed out up to t
+static void advance_to(int64_t t) {
+    if (state_deadline() > t) return;
+
+    if (_state == BTN_PRESSED) {
+        Serial.println("[Button] Long press -> STOP");
+        event_bus_post_value(BUS_BUTTON_LONG, 0);
+        _state = BTN_LONG_FIRED;
+    } else if (_state == BTN_WAIT_DOUBLE) {
+        // Timeout - it was just a single short press
+        Serial.println("[Button] Short press -> Region cycle");
+        event_bus_post_value(BUS_BUTTON_SHORT, 0);
+        _state = BTN_IDLE;
     }
+}
 
-    bool pressed = (reading == LOW);  // Active low with pullup
+// A debounced level change at t
+static void on_change(bool pressed, int64_t t) {
+    advance_to(t);
 
     switch (_state) {
         case BTN_IDLE:
             if (pressed) {
-                _press_start = now;
+                _press_start = t;
                 _state = BTN_PRESSED;
             }
             break;
 
         case BTN_PRESSED:
             if (!pressed) {
-                // Button released - check if it was a short press
-                unsigned long hold_time = now - _press_start;
-                if (hold_time < LONG_PRESS_MS) {
-                    // Short press - wait for possible double-tap
-                    _release_time = now;
-                    _state = BTN_WAIT_DOUBLE;
-                } else {
-                    // Long press already fired, just go idle
-                    _state = BTN_IDLE;
-                }
-            } else {
-                // Still held - check for long press
-                unsigned long hold_time = now - _press_start;
-                if (hold_time >= LONG_PRESS_MS && _state != BTN_LONG_FIRED) {
-                    // Long press detected!
-                    Serial.println("[Button] Long press -> STOP");
-                    if (_stop_callback) _stop_callback();
-                    _state = BTN_LONG_FIRED;
-                }
+                // Released before the long press deadline: maybe a double-tap
+                _release_time = t;
+                _state = BTN_WAIT_DOUBLE;
             }
             break;
 
@@ -108,14 +145,9 @@ void button_task() {
             if (pressed) {
                 // Second press within window - it's a double-tap!
                 Serial.println("[Button] Double-tap -> NEXT");
-                if (_next_callback) _next_callback();
+                event_bus_post_value(BUS_BUTTON_DOUBLE, 0);
                 _state = BTN_PRESSED;  // Track this press too
-                _press_start = now;
-            } else if (now - _release_time >= DOUBLE_TAP_MS) {
-                // Timeout - it was just a single short press
-                Serial.println("[Button] Short press -> Region cycle");
-                if (_region_cycle_callback) _region_cycle_callback();
-                _state = BTN_IDLE;
+                _press_start = t;
             }
             break;
 
@@ -127,3 +159,50 @@ void button_task() {
             break;
     }
 }
+
+// ------------------------------------------------------------------
+// Debounce
+// ------------------------------------------------------------------
+
+static void settle() {
+    _bouncing = false;
+    if (_raw_level == _stable_level) return;   // Bounced back: a glitch
+    _stable_level = _raw_level;
+    on_change(_stable_level == LOW, _burst_start);  // Active low with pullup
+}
+
+static void feed_edge(const ButtonEdge& e) {
+    if (_bouncing && e.us - _last_edge >= DEBOUNCE_MS * 1000LL) settle();
+    if (!_bouncing) {
+        _bouncing = true;
+        _burst_start = e.us;
+    }
+    _last_edge = e.us;
+    _raw_level = e.level;
+}
+
+void button_task() {
+    while (_edge_tail != _edge_head) {
+        feed_edge(_edges[_edge_tail & (EDGE_RING_LEN - 1)]);
+        _edge_tail = _edge_tail + 1;
+    }
+    if (_edges_lost || (!_bouncing && (bool)digitalRead(BUTTON_PIN) != _raw_level)) {
+        // The ring overflowed (a very long stall), or the level changed
+        // with no edge seen (light sleep): resync from the pin
+        _edges_lost = false;
+        ButtonEdge e = {esp_timer_get_time(), (bool)digitalRead(BUTTON_PIN)};
+        feed_edge(e);
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (_bouncing && now - _last_edge >= DEBOUNCE_MS * 1000LL) settle();
+    // An unsettled burst may yet be a change at its first edge
+    advance_to(_bouncing ? _burst_start : now);
+
+    power_idle_hold(POWER_HOLD_BUTTON, _bouncing || _state != BTN_IDLE);
+
+    int64_t due = _bouncing ? _last_edge + DEBOUNCE_MS * 1000LL : state_deadline();
+    if (due != NO_DEADLINE) {
+        loop_events_due_in((uint32_t)((max(due - now, (int64_t)0) + 999) / 1000));
+    }
+}
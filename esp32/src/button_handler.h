@@ -14,18 +14,12 @@
 
 #include <Arduino.h>
 
-// Button callback types
-typedef void (*ButtonCallback)();
-
 // Initialize button GPIO
 void button_init();
 
-// Set callbacks for each action
-void button_set_band_cycle_callback(ButtonCallback cb);  // Short press
-void button_set_stop_callback(ButtonCallback cb);         // Long press
-void button_set_next_callback(ButtonCallback cb);         // Double-tap
-
-// Call in main loop
+// Call in main loop: handles the queued edges and timeouts. Each action is
+// posted to the event bus (event_bus.h): BUS_BUTTON_SHORT, BUS_BUTTON_LONG
+// or BUS_BUTTON_DOUBLE.
 void button_task();
 
 #endif // BUTTON_HANDLER_H
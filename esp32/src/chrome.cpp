@@ -0,0 +1,32 @@
+/**
+ * Baked UI chrome implementation for RadioWall.
+ *
+ * Rows are expanded from palette indices into a small RGB565 band and sent
+ * with one draw16bitRGBBitmap per band, like the map's band expansion.
+ */
+
+#include "chrome.h"
+#include "Arduino_GFX_Library.h"
+
+static const int BAND_PIXELS = 180 * 8;   // Eight display-wide rows, 2.8 KB
+static uint16_t _band[BAND_PIXELS];
+
+void chrome_draw(Arduino_GFX* gfx, const ChromeSprite& sprite, int x, int y) {
+    if (!gfx || sprite.w == 0 || sprite.w > BAND_PIXELS) return;
+    int w = sprite.w;
+    int stride = (w + 1) / 2;
+    int band_rows = BAND_PIXELS / w;
+
+    for (int band_y = 0; band_y < sprite.h; band_y += band_rows) {
+        int rows = min(band_rows, sprite.h - band_y);
+        uint16_t* out = _band;
+        for (int row = band_y; row < band_y + rows; row++) {
+            const uint8_t* src = sprite.pixels + row * stride;
+            for (int i = 0; i < w; i++) {
+                uint8_t b = pgm_read_byte(src + i / 2);
+                *out++ = pgm_read_word(sprite.palette + ((i & 1) ? b >> 4 : b & 0x0F));
+            }
+        }
+        gfx->draw16bitRGBBitmap(x, y + band_y, _band, w, rows);
+    }
+}
@@ -0,0 +1,38 @@
+/**
+ * Baked UI chrome for RadioWall.
+ *
+ * The status bar icon buttons, the menu title and the menu cards never
+ * change, so tools/bake_chrome.py renders them ahead of time into 4-bit
+ * indexed sprites in flash (chrome_sprites.cpp, built with -DCHROME_SPRITES).
+ * Drawing one is a palette lookup and a bitmap copy per band of rows
+ * instead of a round rect, triangles and font glyphs. Without the flag
+ * CHROME_SPRITE() is nullptr and callers draw with the primitives as before.
+ */
+
+#ifndef CHROME_H
+#define CHROME_H
+
+#include <Arduino.h>
+
+class Arduino_GFX;
+
+// w x h pixels, 4 bits each (left pixel of a pair in the low nibble),
+// rows padded to whole bytes; indices into up to 16 RGB565 colours
+struct ChromeSprite {
+    uint16_t w;
+    uint16_t h;
+    const uint16_t* palette;
+    const uint8_t* pixels;
+};
+
+#if defined(CHROME_SPRITES)
+#include "chrome_sprites.h"
+#define CHROME_SPRITE(name)  (&CHROME_##name)
+#else
+#define CHROME_SPRITE(name)  ((const ChromeSprite*)nullptr)
+#endif
+
+// Draw a sprite with its top-left at (x, y)
+void chrome_draw(Arduino_GFX* gfx, const ChromeSprite& sprite, int x, int y);
+
+#endif // CHROME_H
@@ -0,0 +1,199 @@
+/**
+ * City dot overlay implementation for RadioWall.
+ *
+ * The first view at a zoom level buckets every place with stations into
+ * the DOT_TILE_W x DOT_TILE_H tiles of its zoomed slice: two passes over
+ * the places.bin coordinates (count, then fill), keeping each dot's
+ * position inside its tile. A view then visits only the tiles it overlaps
+ * (3 x 5 or so) and stamps their dots, so panning never scans the whole
+ * place list. A level takes 2 bytes per place plus 2 per tile.
+ *
+ * A places.bin with a view partition (places_db_for_view()) has those
+ * tiles already: the view's places are stamped straight from it, and no
+ * level is built.
+ */
+
+#include "city_dots.h"
+#include "places_db.h"
+
+static const int DOT_TILE_W = MAP_WIDTH / 2;    // 90, fits a uint8_t
+static const int DOT_TILE_H = MAP_HEIGHT / 4;   // 145
+static const int DOT_BIG_ZOOM = 4;              // 2x2 dots from here on
+static const uint8_t DOT = 3;                   // Packed palette index
+static const int READ_CHUNK = 64;               // Coordinates per places_db read
+
+struct DotLevel {
+    uint16_t* first;   // Per tile (slice, row, col) its first dot; tiles + 1 entries
+    uint8_t* xy;       // Per dot x, y inside its tile
+    int cols;          // Tiles per slice row
+    int rows;
+};
+static DotLevel _levels[MAP_ZOOM_LIMIT];   // By zoom - 1
+static bool _failed = false;               // Stop trying once PSRAM ran out
+
+// Pixel of a place in its zoomed slice (products stay under 84M)
+static void place_pixel(int16_t lat_x100, int16_t lon_x100, int zoom,
+                        int* slice, int* px, int* py) {
+    int s = MAP_SLICE_COUNT - 1;   // Whatever the others miss wraps into the last
+    for (int i = 0; i < MAP_SLICE_COUNT - 1; i++) {
+        int lo = MAP_SLICE_LAYOUT[i].lon_min * 100;
+        if (lon_x100 >= lo && lon_x100 < lo + MAP_SLICE_LAYOUT[i].lon_span * 100) {
+            s = i;
+            break;
+        }
+    }
+    int dx = lon_x100 - MAP_SLICE_LAYOUT[s].lon_min * 100;
+    if (dx < 0) dx += 36000;
+    int w = MAP_WIDTH * zoom;
+    int h = MAP_HEIGHT * zoom;
+    *slice = s;
+    *px = min(dx * w / (MAP_SLICE_LAYOUT[s].lon_span * 100), w - 1);
+    *py = min((9000 - lat_x100) * h / 18000, h - 1);
+}
+
+// Visit every place with stations: fn(slice, px, py) at the given zoom
+template <typename Fn>
+static bool for_dots(int zoom, Fn fn) {
+    int16_t lat[READ_CHUNK];
+    int16_t lon[READ_CHUNK];
+    uint32_t count = places_db_count();
+    for (uint32_t first = 0; first < count; first += READ_CHUNK) {
+        int n = places_db_read_coords(first, READ_CHUNK, lat, lon);
+        if (n == 0) return false;
+        for (int i = 0; i < n; i++) {
+            if (!places_db_has_stations(first + i)) continue;
+            int slice, px, py;
+            place_pixel(lat[i], lon[i], zoom, &slice, &px, &py);
+            fn(slice, px, py);
+        }
+    }
+    return true;
+}
+
+static void free_level(DotLevel& l) {
+    free(l.first);
+    free(l.xy);
+    l.first = nullptr;
+    l.xy = nullptr;
+}
+
+static DotLevel* dot_level(int zoom) {
+    DotLevel& l = _levels[zoom - 1];
+    if (l.first) return &l;
+    if (_failed || !psramFound() || !places_db_loaded()) return nullptr;
+
+    unsigned long start = millis();
+    l.cols = 2 * zoom;
+    l.rows = 4 * zoom;
+    int tiles = 4 * l.rows * l.cols;
+    auto tile_of = [&](int slice, int px, int py) {
+        return (slice * l.rows + py / DOT_TILE_H) * l.cols + px / DOT_TILE_W;
+    };
+
+    // Pass 1: dots per tile, then each tile's first dot
+    l.first = (uint16_t*)ps_calloc(tiles + 1, sizeof(uint16_t));
+    uint16_t* fill = (uint16_t*)ps_malloc(tiles * sizeof(uint16_t));
+    bool ok = l.first && fill &&
+              for_dots(zoom, [&](int slice, int px, int py) { l.first[tile_of(slice, px, py) + 1]++; });
+    for (int t = 0; ok && t < tiles; t++) l.first[t + 1] += l.first[t];
+
+    // Pass 2: positions inside the tiles
+    if (ok) {
+        l.xy = (uint8_t*)ps_malloc(l.first[tiles] * 2 + 1);
+        memcpy(fill, l.first, tiles * sizeof(uint16_t));
+        ok = l.xy && for_dots(zoom, [&](int slice, int px, int py) {
+            uint16_t d = fill[tile_of(slice, px, py)]++;
+            l.xy[d * 2] = px % DOT_TILE_W;
+            l.xy[d * 2 + 1] = py % DOT_TILE_H;
+        });
+    }
+    free(fill);
+
+    if (!ok) {
+        Serial.printf("[CityDots] Cannot build the %dx dots, map drawn without them\n", zoom);
+        free_level(l);
+        _failed = true;
+        return nullptr;
+    }
+    Serial.printf("[CityDots] %dx: %u dots in %d tiles, built in %lu ms\n",
+                  zoom, l.first[tiles], tiles, millis() - start);
+    return &l;
+}
+
+// Rows [y0, y1) of the view are stamped, the others left alone
+struct DotRows {
+    int y0, y1;
+};
+
+static inline void set_dot(uint8_t* packed, int x, int y, const DotRows& rows) {
+    if (x < 0 || x >= MAP_WIDTH || y < rows.y0 || y >= rows.y1) return;
+    size_t p = (size_t)y * MAP_WIDTH + x;
+    int shift = (p & 3) * 2;
+    packed[p >> 2] = (packed[p >> 2] & ~(3 << shift)) | (DOT << shift);
+}
+
+static void stamp_dot(uint8_t* packed, int x, int y, bool big, const DotRows& rows) {
+    set_dot(packed, x, y, rows);
+    if (big) {
+        set_dot(packed, x + 1, y, rows);
+        set_dot(packed, x, y + 1, rows);
+        set_dot(packed, x + 1, y + 1, rows);
+    }
+}
+
+struct ViewStamp {
+    const MapView* view;
+    uint8_t* packed;
+    bool big;
+    DotRows rows;
+};
+
+static void stamp_place(PlaceHandle handle, int16_t lat_x100, int16_t lon_x100, void* ctx) {
+    const ViewStamp& s = *(const ViewStamp*)ctx;
+    if (!places_db_has_stations(handle)) return;
+    int slice, px, py;
+    place_pixel(lat_x100, lon_x100, s.view->zoom, &slice, &px, &py);
+    if (slice == s.view->slice) stamp_dot(s.packed, px - s.view->x, py - s.view->y, s.big, s.rows);
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void city_dots_draw(const MapView& view, uint8_t* packed) {
+    city_dots_draw_rows(view, packed, 0, MAP_HEIGHT);
+}
+
+void city_dots_draw_rows(const MapView& view, uint8_t* packed, int y0, int y1) {
+    if (view.zoom < 1 || view.zoom > MAP_ZOOM_LIMIT || view.slice < 0 || view.slice > 3) return;
+    if (y0 >= y1) return;
+    bool big = view.zoom >= DOT_BIG_ZOOM;
+    DotRows rows = { y0, y1 };
+
+    // A 2x2 dot just outside reaches in
+    ViewStamp stamp = { &view, packed, big, rows };
+    if (psramFound() && places_db_has_view() &&
+        places_db_for_view(view.slice, view.zoom, view.x - 1, view.y + y0 - 1,
+                           MAP_WIDTH + 1, y1 - y0 + 1, stamp_place, &stamp)) {
+        return;
+    }
+
+    DotLevel* l = dot_level(view.zoom);
+    if (!l) return;
+
+    int col0 = max(0, (view.x - 1) / DOT_TILE_W);   // A 2x2 dot just outside reaches in
+    int row0 = max(0, (view.y + y0 - 1) / DOT_TILE_H);
+    int col1 = min(l->cols - 1, (view.x + MAP_WIDTH - 1) / DOT_TILE_W);
+    int row1 = min(l->rows - 1, (view.y + y1 - 1) / DOT_TILE_H);
+
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            int t = (view.slice * l->rows + row) * l->cols + col;
+            int ox = col * DOT_TILE_W - view.x;
+            int oy = row * DOT_TILE_H - view.y;
+            for (int d = l->first[t]; d < l->first[t + 1]; d++) {
+                stamp_dot(packed, ox + l->xy[d * 2], oy + l->xy[d * 2 + 1], big, rows);
+            }
+        }
+    }
+}
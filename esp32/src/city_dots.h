@@ -0,0 +1,26 @@
+/**
+ * City dot overlay for RadioWall.
+ *
+ * Marks every place with stations on the map with a dot, drawn into the
+ * packed map view before it goes to the display, so the base layer (and
+ * every overlay restored from it) keeps the dots.
+ */
+
+#ifndef CITY_DOTS_H
+#define CITY_DOTS_H
+
+#include <Arduino.h>
+#include "world_map.h"
+
+// Stamp the dots of the places inside a view onto its packed bitmap
+// (MAP_PACKED_BYTES, 2 bits per pixel). A 1x slice is the view
+// {1, slice, 0, 0}. The zoom level's dot lists are built on first use, in
+// PSRAM; without PSRAM or places the bitmap is left as it is. Loop task only.
+void city_dots_draw(const MapView& view, uint8_t* packed);
+
+// The same for view rows [y0, y1) only, for a view composed a band at a
+// time: dots reaching in from the rows around are stamped too, and no
+// pixel outside the rows is touched
+void city_dots_draw_rows(const MapView& view, uint8_t* packed, int y0, int y1);
+
+#endif // CITY_DOTS_H
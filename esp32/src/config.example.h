@@ -19,6 +19,10 @@
 // WiFi connection timeout (milliseconds)
 #define WIFI_CONNECT_TIMEOUT 10000
 
+// Reuse the last DHCP lease as a static IP on boot (skips DHCP, ~1 s faster).
+// Only if the router reserves this address for RadioWall.
+// #define WIFI_REUSE_LEASE
+
 // =============================================================================
 // MQTT Settings
 // =============================================================================
@@ -36,6 +40,12 @@
 // Client ID (should be unique)
 #define MQTT_CLIENT_ID "radiowall-esp32"
 
+// Server-assisted mode: stay standalone, but ask server/assist.py (through
+// the broker above) for station lists and stream URLs before Radio.garden.
+// Falls back to standalone whenever the broker or server is unreachable.
+// Leave undefined to disable.
+// #define SERVER_ASSIST
+
 // =============================================================================
 // Touch Panel Settings
 // =============================================================================
@@ -51,9 +61,15 @@
 // =============================================================================
 // Touch Mode Settings
 // =============================================================================
-// Use built-in touchscreen (1) or external USB touch panel (0)
+// Use built-in touchscreen (1) or external USB touch panel (0). With the
+// USB panel the map is on the wall and the display shows now playing only.
 #define USE_BUILTIN_TOUCH 1
 
+// USB overlay made of several panels, each covering one tile of a grid
+// over the map (up to 4 panels; needs a USB hub). CAL binds them to tiles.
+// #define USB_TOUCH_TILES_X 2
+// #define USB_TOUCH_TILES_Y 1
+
 // Touch mapping mode (only used for legacy stretch/fit mapping)
 #define TOUCH_MAP_MODE_FIT 1
 #define TOUCH_MAP_MODE_STRETCH 0
@@ -68,11 +84,64 @@
 // WiiM device IP address (find in WiiM app or router)
 #define WIIM_IP "192.168.1.50"
 
+// =============================================================================
+// Data Updates (optional)
+// =============================================================================
+// HTTPS host and path of a directory published by tools/make_update.py.
+// The device checks it 2 minutes after boot and then daily, downloads only
+// the changed 4 KB chunks of places.bin / stations.bin and applies them at
+// the next boot. Leave undefined to disable.
+// #define DATA_UPDATE_HOST "example.github.io"
+// #define DATA_UPDATE_PATH "/radiowall-data"
+
+// =============================================================================
+// Station Queue (optional)
+// =============================================================================
+// Hand the WiiM a playlist of up to this many stations (max 8) so NEXT runs
+// on the speaker. The playlist is served from the metrics port
+// (:8080/queue.m3u). Leave undefined (or 0) to send stations one at a time.
+// #define STATION_QUEUE_LENGTH 5
+
+// =============================================================================
+// UPnP Events (optional)
+// =============================================================================
+// Port the WiiM's AVTransport / RenderingControl NOTIFYs are sent to, and
+// the port of the WiiM's own UPnP server (defaults shown).
+// #define UPNP_EVENT_PORT 49494
+// #define UPNP_DESCRIPTION_PORT 49152
+
+// =============================================================================
+// Peer Cache (optional)
+// =============================================================================
+// Share station lists and resolved stream URLs with other RadioWalls on the
+// LAN (advertised as _radiowall._tcp): a frame asks its peers before
+// Radio.garden. Set the same port on every frame; leave undefined to
+// disable.
+// #define PEER_CACHE_PORT 49500
+
+// =============================================================================
+// Place Search (optional)
+// =============================================================================
+// How taps find their nearest places: PLACES_SEARCH_INDEX (cell index, the
+// default), PLACES_SEARCH_LINEAR or PLACES_SEARCH_PARALLEL (a scan of every
+// place, on one core or both). BENCH times all three on this board.
+// #define PLACES_SEARCH PLACES_SEARCH_PARALLEL
+
+// =============================================================================
+// Artwork (optional)
+// =============================================================================
+// Where the Now Playing scene fetches station artwork (JPEG or PNG), the %s
+// given the Radio.garden station ID; http or https on the default port.
+// Without it, the album art the WiiM reports for the stream is used.
+// #define ARTWORK_URL_FORMAT "http://192.168.1.10/art/%s.jpg"
+
 // =============================================================================
 // Display Settings
 // =============================================================================
 // Display timeout - dim after this many seconds of inactivity
 #define DISPLAY_TIMEOUT_SECONDS 60
+// Then backlight off, panel idle mode and a slower CPU this much later
+#define DISPLAY_OFF_SECONDS 240
 
 // Brightness levels (0-255)
 #define DISPLAY_BRIGHTNESS_NORMAL 200
@@ -0,0 +1,801 @@
+/**
+ * Delta update implementation for RadioWall.
+ *
+ * Staging file /upd/<name> (little-endian): a header ("RGUP", u16 version,
+ * u16 reserved, u32 chunk size, u32 new file size, u32 record count,
+ * SHA-256 of the new file), then per changed chunk a u32 index and the
+ * chunk's bytes (a full chunk, or the tail of the file). Downloads are
+ * written to /upd/<name>.tmp and renamed once every file is complete, so
+ * the boot pass only sees whole updates; a .tmp left by a reset is
+ * deleted and the next check starts over.
+ *
+ * Applying is idempotent. The header chunk (always staged) goes first
+ * with its magic cleared and the magic is written last, so a power cut in
+ * between leaves a file that places_db and station_catalog reject, and
+ * the next boot applies the same records again. The staging file is
+ * removed once the result matches the manifest's SHA-256. Files never
+ * shrink: bytes past a shorter new version stay unused.
+ *
+ * tiles.bin only lives in the raw "maps" partition, so its chunks are
+ * patched straight into it at boot, header sector last. The firmware is
+ * not staged at all: it streams into the idle OTA app slot while it
+ * downloads, chunks it shares with the running image at the same offset
+ * copied from flash instead, and is made the boot image only when the
+ * SHA-256 over all of it matches. The running image carries on until the
+ * next restart.
+ */
+
+#include "data_update.h"
+#include "places_db.h"
+#include "https_pool.h"
+#include "serial_cmd.h"
+#include "asset_fs.h"
+#include "config.h"
+#include "json_arena.h"
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include "world_map.h"
+#include <esp_partition.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+#include <atomic>
+
+#ifndef DATA_UPDATE_PATH
+#define DATA_UPDATE_PATH ""
+#endif
+
+static const uint32_t CHUNK_SIZE = 4096;     // One flash sector
+static const uint32_t MAX_CHUNKS = 1024;     // 4 MB per file
+static const int HASH_BYTES = 8;             // Chunk name: SHA-256 prefix
+static const unsigned long CHECK_DELAY_MS = 2UL * 60 * 1000;       // After boot
+static const unsigned long CHECK_INTERVAL_MS = 24UL * 3600 * 1000;
+static const unsigned long RETRY_MS = 60UL * 60 * 1000;            // After a failure
+static const unsigned long REQUEST_TIMEOUT_MS = 10000;
+static const char* STAGE_DIR = "/upd";
+static const uint16_t STAGE_VERSION = 1;
+
+struct StageHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t chunk_size;
+    uint32_t size;
+    uint32_t records;
+    uint8_t sha256[32];
+};
+
+enum TargetKind {
+    TARGET_FILE,        // LittleFS file, patched at boot
+    TARGET_PARTITION,   // Raw data partition, patched at boot
+    TARGET_FIRMWARE,    // Idle OTA app slot, written while downloading
+};
+
+// What an update may replace; other manifest entries are ignored
+struct UpdateTarget {
+    const char* name;
+    TargetKind kind;
+    const char* path;        // LittleFS file
+    const char* partition;   // Data partition: the file's mirror, or the target
+};
+static const UpdateTarget TARGETS[] = {
+    { "places.bin", TARGET_FILE, "/places.bin", PLACES_PARTITION_LABEL },
+    { "stations.bin", TARGET_FILE, "/stations.bin", nullptr },
+    { "tiles.bin", TARGET_PARTITION, nullptr, MAP_TILES_PARTITION_LABEL },
+    { "firmware.bin", TARGET_FIRMWARE, nullptr, nullptr },
+};
+static const int TARGET_COUNT = sizeof(TARGETS) / sizeof(TARGETS[0]);
+
+static uint8_t _buf[CHUNK_SIZE];   // One chunk (boot pass, or the net worker)
+
+static void sha256(const uint8_t* data, size_t len, uint8_t out[32]) {
+    mbedtls_sha256_ret(data, len, out, 0);
+}
+
+// Bytes of chunk index in a file of size bytes
+static uint32_t chunk_len(uint32_t size, uint32_t index) {
+    uint32_t left = size - index * CHUNK_SIZE;
+    return left < CHUNK_SIZE ? left : CHUNK_SIZE;
+}
+
+static const esp_partition_t* data_partition(const char* label) {
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+}
+
+static String stage_path(const UpdateTarget& t, bool tmp) {
+    String path = String(STAGE_DIR) + "/" + t.name;
+    if (tmp) path += ".tmp";
+    return path;
+}
+
+// ------------------------------------------------------------------
+// Boot pass: apply staged chunks
+// ------------------------------------------------------------------
+
+// SHA-256 of the first size bytes of an open file
+static bool file_sha256(File& f, uint32_t size, uint8_t out[32]) {
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts_ret(&ctx, 0);
+    bool ok = f.seek(0);
+    for (uint32_t i = 0; ok && i * CHUNK_SIZE < size; i++) {
+        uint32_t n = chunk_len(size, i);
+        ok = f.read(_buf, n) == n;
+        if (ok) mbedtls_sha256_update_ret(&ctx, _buf, n);
+    }
+    mbedtls_sha256_finish_ret(&ctx, out);
+    mbedtls_sha256_free(&ctx);
+    return ok;
+}
+
+// SHA-256 of the first size bytes of a partition
+static bool partition_sha256(const esp_partition_t* part, uint32_t size, uint8_t out[32]) {
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts_ret(&ctx, 0);
+    bool ok = true;
+    for (uint32_t i = 0; ok && i * CHUNK_SIZE < size; i++) {
+        uint32_t n = chunk_len(size, i);
+        ok = esp_partition_read(part, i * CHUNK_SIZE, _buf, n) == ESP_OK;
+        if (ok) mbedtls_sha256_update_ret(&ctx, _buf, n);
+    }
+    mbedtls_sha256_finish_ret(&ctx, out);
+    mbedtls_sha256_free(&ctx);
+    return ok;
+}
+
+// Walk the records of a staging file. Returns the offset of the header
+// chunk's record, or 0 if the file does not match its header.
+static uint32_t check_stage(File& stage, const StageHeader& h) {
+    uint32_t pos = sizeof(StageHeader);
+    uint32_t header_record = 0;
+    for (uint32_t r = 0; r < h.records; r++) {
+        uint32_t index;
+        if (!stage.seek(pos) || stage.read((uint8_t*)&index, 4) != 4) return 0;
+        if (index >= MAX_CHUNKS || index * CHUNK_SIZE >= h.size) return 0;
+        if (index == 0) header_record = pos;
+        pos += 4 + chunk_len(h.size, index);
+    }
+    return pos == stage.size() ? header_record : 0;
+}
+
+// Read the record at pos into _buf; returns its length (0 on error)
+static uint32_t read_record(File& stage, uint32_t pos, const StageHeader& h, uint32_t* index) {
+    if (!stage.seek(pos) || stage.read((uint8_t*)index, 4) != 4) return 0;
+    uint32_t n = chunk_len(h.size, *index);
+    return stage.read(_buf, n) == n ? n : 0;
+}
+
+// Open a staging file and check its header and records. Returns the
+// offset of the header chunk's record, or 0 if it is unusable.
+static uint32_t open_stage(const UpdateTarget& t, File& stage, StageHeader& h) {
+    stage = LittleFS.open(stage_path(t, false), "r");
+    bool ok = stage && stage.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+              memcmp(h.magic, "RGUP", 4) == 0 && h.version == STAGE_VERSION &&
+              h.chunk_size == CHUNK_SIZE && h.records > 0;
+    return ok ? check_stage(stage, h) : 0;
+}
+
+// Bring the raw places partition in line with the patched file. Only
+// sectors that differ are rewritten; sector 0 (the header) is erased
+// first and written last.
+static void sync_partition(const char* path, uint32_t size) {
+    const esp_partition_t* part = data_partition(PLACES_PARTITION_LABEL);
+    if (!part) return;
+    if (size > part->size) {
+        // The old copy would still win over the new file: drop its header
+        esp_partition_erase_range(part, 0, CHUNK_SIZE);
+        Serial.println("[Update] places.bin no longer fits the partition, using LittleFS");
+        return;
+    }
+
+    uint8_t* flash = (uint8_t*)malloc(CHUNK_SIZE);
+    File f = LittleFS.open(path, "r");
+    if (!flash || !f) {
+        free(flash);
+        return;
+    }
+    esp_partition_erase_range(part, 0, CHUNK_SIZE);
+    int rewritten = 1;
+    for (uint32_t i = 1; i * CHUNK_SIZE < size; i++) {
+        uint32_t n = chunk_len(size, i);
+        uint32_t off = i * CHUNK_SIZE;
+        if (!f.seek(off) || f.read(_buf, n) != n) break;
+        if (esp_partition_read(part, off, flash, n) == ESP_OK && memcmp(flash, _buf, n) == 0) {
+            continue;
+        }
+        esp_partition_erase_range(part, off, CHUNK_SIZE);
+        esp_partition_write(part, off, _buf, n);
+        rewritten++;
+    }
+    uint32_t n = chunk_len(size, 0);
+    if (f.seek(0) && f.read(_buf, n) == n) esp_partition_write(part, 0, _buf, n);
+    f.close();
+    free(flash);
+    Serial.printf("[Update] places partition: %d sectors rewritten\n", rewritten);
+}
+
+static bool apply_file(const UpdateTarget& t) {
+    String spath = stage_path(t, false);
+    File stage;
+    StageHeader h;
+    uint32_t header_record = open_stage(t, stage, h);
+    File out;
+    if (header_record) {
+        out = LittleFS.open(t.path, LittleFS.exists(t.path) ? "r+" : "w");
+    }
+    if (!out) {
+        Serial.printf("[Update] ERROR: Cannot apply staged %s, discarding it\n", t.name);
+        stage.close();
+        LittleFS.remove(spath);
+        return false;
+    }
+
+    // Header chunk with its magic cleared, the other chunks, then the magic
+    uint32_t index;
+    uint8_t magic[4];
+    uint32_t n = read_record(stage, header_record, h, &index);
+    memcpy(magic, _buf, sizeof(magic));
+    memset(_buf, 0, sizeof(magic));
+    bool ok = n > 0 && out.seek(0) && out.write(_buf, n) == n;
+    uint32_t pos = sizeof(StageHeader);
+    for (uint32_t r = 0; ok && r < h.records; r++) {
+        uint32_t len = read_record(stage, pos, h, &index);
+        ok = len > 0;
+        if (ok && pos != header_record) {
+            ok = out.seek(index * CHUNK_SIZE) && out.write(_buf, len) == len;
+        }
+        pos += 4 + len;
+    }
+    ok = ok && out.seek(0) && out.write(magic, sizeof(magic)) == sizeof(magic);
+    out.close();
+    stage.close();
+
+    uint8_t digest[32];
+    File check = LittleFS.open(t.path, "r");
+    ok = ok && check && file_sha256(check, h.size, digest) &&
+         memcmp(digest, h.sha256, sizeof(digest)) == 0;
+    check.close();
+    if (!ok) {
+        // Keep the file unreadable; the next check restages it whole
+        File broken = LittleFS.open(t.path, "r+");
+        if (broken) {
+            memset(magic, 0, sizeof(magic));
+            broken.write(magic, sizeof(magic));
+            broken.close();
+        }
+        Serial.printf("[Update] ERROR: %s does not match the update after patching\n", t.name);
+        LittleFS.remove(spath);
+        return false;
+    }
+
+    Serial.printf("[Update] %s: %lu chunks patched\n", t.name, (unsigned long)h.records);
+    if (t.partition) sync_partition(t.path, h.size);
+    LittleFS.remove(spath);
+    return true;
+}
+
+// Patch staged chunks straight into a raw data partition, in the same
+// order as a file: header sector erased first, written last
+static bool apply_partition(const UpdateTarget& t) {
+    String spath = stage_path(t, false);
+    File stage;
+    StageHeader h;
+    uint32_t header_record = open_stage(t, stage, h);
+    const esp_partition_t* part = data_partition(t.partition);
+    if (!header_record || !part || h.size > part->size) {
+        Serial.printf("[Update] ERROR: Cannot apply staged %s, discarding it\n", t.name);
+        stage.close();
+        LittleFS.remove(spath);
+        return false;
+    }
+
+    bool ok = esp_partition_erase_range(part, 0, CHUNK_SIZE) == ESP_OK;
+    uint32_t index;
+    uint32_t pos = sizeof(StageHeader);
+    for (uint32_t r = 0; ok && r < h.records; r++) {
+        uint32_t len = read_record(stage, pos, h, &index);
+        ok = len > 0;
+        if (ok && pos != header_record) {
+            ok = esp_partition_erase_range(part, index * CHUNK_SIZE, CHUNK_SIZE) == ESP_OK &&
+                 esp_partition_write(part, index * CHUNK_SIZE, _buf, len) == ESP_OK;
+        }
+        pos += 4 + len;
+    }
+    uint32_t n = ok ? read_record(stage, header_record, h, &index) : 0;
+    ok = n > 0 && esp_partition_write(part, 0, _buf, n) == ESP_OK;
+    stage.close();
+
+    uint8_t digest[32];
+    ok = ok && partition_sha256(part, h.size, digest) &&
+         memcmp(digest, h.sha256, sizeof(digest)) == 0;
+    LittleFS.remove(spath);
+    if (!ok) {
+        // No header: readers fall back to LittleFS, the next check restages it
+        esp_partition_erase_range(part, 0, CHUNK_SIZE);
+        Serial.printf("[Update] ERROR: '%s' partition does not match %s after patching\n",
+                      t.partition, t.name);
+        return false;
+    }
+    Serial.printf("[Update] %s: %lu chunks patched into '%s'\n", t.name,
+                  (unsigned long)h.records, t.partition);
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Update check (net worker)
+// ------------------------------------------------------------------
+
+#ifdef DATA_UPDATE_HOST
+
+// What the manifest says about one target, and which chunks differ locally
+struct FilePlan {
+    bool listed;
+    uint32_t size;
+    uint32_t chunks;
+    uint8_t sha256[32];
+    uint8_t (*hashes)[HASH_BYTES];   // Per chunk, from the manifest
+    uint32_t* changed;               // Bitmap of chunks to download
+    uint32_t changed_count;
+};
+
+enum UpdatePhase { PHASE_IDLE, PHASE_HASHING, PHASE_DOWNLOADING, PHASE_STAGED };
+static const char* const PHASE_NAMES[] = { "idle", "hashing", "downloading", "staged" };
+
+static UpdatePhase _phase = PHASE_IDLE;
+static FilePlan _plan[TARGET_COUNT];
+static uint32_t _manifest_version = 0;
+static int _file = 0;           // Target being hashed or downloaded
+static uint32_t _chunk = 0;     // Its next chunk
+static File _local;             // Local copy being hashed (files)
+static const esp_partition_t* _local_part = nullptr;   // Or partition / running image
+static File _stage;             // Staging file being written
+static unsigned long _next_check_ms = CHECK_DELAY_MS;
+
+// Firmware being streamed into the idle app slot
+static const esp_partition_t* _ota_part = nullptr;
+static esp_ota_handle_t _ota = 0;
+static bool _ota_open = false;
+static mbedtls_sha256_context _ota_sha;
+static bool _firmware_staged = false;
+
+static bool parse_hex(const char* hex, uint8_t* out, size_t bytes) {
+    for (size_t i = 0; i < bytes * 2; i++) {
+        char c = hex[i];
+        int v = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+        if (v < 0) return false;
+        out[i / 2] = (i & 1) ? (out[i / 2] | v) : (v << 4);
+    }
+    return true;
+}
+
+static inline bool is_changed(const FilePlan& p, uint32_t i) {
+    return p.changed[i >> 5] & (1UL << (i & 31));
+}
+
+static void mark_changed(FilePlan& p, uint32_t i) {
+    if (is_changed(p, i)) return;
+    p.changed[i >> 5] |= 1UL << (i & 31);
+    p.changed_count++;
+}
+
+static void free_plan() {
+    for (int i = 0; i < TARGET_COUNT; i++) {
+        free(_plan[i].hashes);
+        free(_plan[i].changed);
+        memset(&_plan[i], 0, sizeof(FilePlan));
+    }
+}
+
+static void abort_firmware() {
+    if (!_ota_open) return;
+    esp_ota_abort(_ota);
+    mbedtls_sha256_free(&_ota_sha);
+    _ota_open = false;
+}
+
+static void end_check(unsigned long next_ms) {
+    _local.close();
+    _stage.close();
+    abort_firmware();
+    for (int i = 0; i < TARGET_COUNT; i++) LittleFS.remove(stage_path(TARGETS[i], true));
+    free_plan();
+    _phase = PHASE_IDLE;
+    _next_check_ms = millis() + next_ms;
+}
+
+// Where a target's current copy is, if it is not a LittleFS file
+static const esp_partition_t* local_partition(const UpdateTarget& t) {
+    if (t.kind == TARGET_FIRMWARE) return esp_ota_get_running_partition();
+    return t.kind == TARGET_PARTITION ? data_partition(t.partition) : nullptr;
+}
+
+// Whether an update of size bytes can go where the target lives
+static bool target_fits(const UpdateTarget& t, uint32_t size) {
+    const esp_partition_t* part = nullptr;
+    if (t.kind == TARGET_FIRMWARE) {
+        part = esp_ota_get_next_update_partition(nullptr);
+        if (!part) {
+            Serial.println("[Update] No second app slot (old partition table), skipping firmware");
+            return false;
+        }
+    } else if (t.kind == TARGET_PARTITION) {
+        part = data_partition(t.partition);
+        char magic[4];
+        // Not flashed: the copy in use is in LittleFS, which this leaves alone
+        if (!part || esp_partition_read(part, 0, magic, sizeof(magic)) != ESP_OK ||
+            memcmp(magic, "RGTP", 4) != 0) {
+            return false;
+        }
+    }
+    if (part && size > part->size) {
+        Serial.printf("[Update] %s (%lu KB) does not fit its partition, skipping it\n", t.name,
+                      (unsigned long)(size / 1024));
+        return false;
+    }
+    return true;
+}
+
+static bool fetch_manifest() {
+    String path = String(DATA_UPDATE_PATH) + "/manifest.json";
+    HttpResponse resp;
+    HttpsConn* conn = https_request(DATA_UPDATE_HOST, path.c_str(), "application/json",
+                                    resp, REQUEST_TIMEOUT_MS);
+    if (!conn) {
+        Serial.println("[Update] Manifest request failed");
+        return false;
+    }
+    if (resp.status != 200) {
+        Serial.printf("[Update] Manifest: HTTP %d\n", resp.status);
+        bool drained = https_read_body(conn, resp, nullptr);
+        https_release(conn, drained && resp.keep_alive);
+        return false;
+    }
+
+    JsonArenaDoc doc(JSON_ARENA_MANIFEST);
+    HttpBodyStream body(conn, resp);
+    DeserializationError error = deserializeJson(doc, body);
+    bool complete = body.finish();
+    https_release(conn, complete && resp.keep_alive);
+    if (error) {
+        Serial.printf("[Update] Manifest parse error: %s\n", error.c_str());
+        return false;
+    }
+    if (doc["chunk_size"].as<uint32_t>() != CHUNK_SIZE) {
+        Serial.println("[Update] Manifest uses another chunk size, ignoring it");
+        return false;
+    }
+
+    _manifest_version = doc["version"].as<uint32_t>();
+    for (JsonObject f : doc["files"].as<JsonArray>()) {
+        const char* name = f["name"] | "";
+        int t = 0;
+        while (t < TARGET_COUNT && strcmp(TARGETS[t].name, name) != 0) t++;
+        if (t == TARGET_COUNT) continue;
+
+        uint32_t size = f["size"] | 0;
+        if (!target_fits(TARGETS[t], size)) continue;
+        const char* sha = f["sha256"] | "";
+        const char* chunks = f["chunks"] | "";
+        uint32_t n = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        FilePlan& p = _plan[t];
+        if (p.listed || n == 0 || n > MAX_CHUNKS || strlen(sha) != 64 ||
+            strlen(chunks) != n * 2 * HASH_BYTES) {
+            Serial.printf("[Update] Skipping bad manifest entry for %s\n", name);
+            continue;
+        }
+        p.hashes = (uint8_t(*)[HASH_BYTES])malloc(n * HASH_BYTES);
+        p.changed = (uint32_t*)calloc((n + 31) / 32, sizeof(uint32_t));
+        if (!p.hashes || !p.changed || !parse_hex(sha, p.sha256, sizeof(p.sha256)) ||
+            !parse_hex(chunks, p.hashes[0], n * HASH_BYTES)) {
+            free(p.hashes);
+            free(p.changed);
+            memset(&p, 0, sizeof(p));
+            continue;
+        }
+        p.listed = true;
+        p.size = size;
+        p.chunks = n;
+    }
+    return true;
+}
+
+// Hash the next local chunk against the manifest; false when all are done
+static bool hash_step() {
+    while (_file < TARGET_COUNT && !_plan[_file].listed) _file++;
+    if (_file >= TARGET_COUNT) return false;
+
+    FilePlan& p = _plan[_file];
+    const UpdateTarget& t = TARGETS[_file];
+    if (_chunk == 0) {
+        if (t.kind == TARGET_FILE) _local = LittleFS.open(t.path, "r");
+        else _local_part = local_partition(t);
+    }
+    uint32_t n = chunk_len(p.size, _chunk);
+    bool same;
+    if (t.kind == TARGET_FILE) {
+        same = _local && _local.seek(_chunk * CHUNK_SIZE) && _local.read(_buf, n) == n;
+    } else {
+        same = _local_part && _chunk * CHUNK_SIZE + n <= _local_part->size &&
+               esp_partition_read(_local_part, _chunk * CHUNK_SIZE, _buf, n) == ESP_OK;
+    }
+    if (same) {
+        uint8_t digest[32];
+        sha256(_buf, n, digest);
+        same = memcmp(digest, p.hashes[_chunk], HASH_BYTES) == 0;
+    }
+    if (!same) mark_changed(p, _chunk);
+
+    if (++_chunk == p.chunks) {
+        _local.close();
+        _local_part = nullptr;
+        // The header chunk is in every staged update (see apply_file)
+        if (p.changed_count > 0) mark_changed(p, 0);
+        _file++;
+        _chunk = 0;
+    }
+    return true;
+}
+
+static void start_download() {
+    uint32_t chunks = 0;
+    uint32_t bytes = 0;
+    for (int i = 0; i < TARGET_COUNT; i++) {
+        const FilePlan& p = _plan[i];
+        if (!p.listed) continue;
+        chunks += p.changed_count;
+        for (uint32_t c = 0; c < p.chunks; c++) {
+            if (is_changed(p, c)) bytes += chunk_len(p.size, c);
+        }
+    }
+    if (chunks == 0) {
+        Serial.printf("[Update] Data is up to date (manifest %lu)\n",
+                      (unsigned long)_manifest_version);
+        end_check(CHECK_INTERVAL_MS);
+        return;
+    }
+    Serial.printf("[Update] Manifest %lu: %lu chunks changed (%lu KB)\n",
+                  (unsigned long)_manifest_version, (unsigned long)chunks,
+                  (unsigned long)(bytes / 1024));
+    LittleFS.mkdir(STAGE_DIR);
+    _phase = PHASE_DOWNLOADING;
+    _file = 0;
+    _chunk = 0;
+}
+
+// Download chunk index of a plan into _buf and check its hash
+static bool fetch_chunk(const FilePlan& p, uint32_t index) {
+    char path[96];
+    int len = snprintf(path, sizeof(path), "%s/chunks/", DATA_UPDATE_PATH);
+    for (int i = 0; i < HASH_BYTES && len + 2 < (int)sizeof(path); i++) {
+        len += snprintf(path + len, sizeof(path) - len, "%02x", p.hashes[index][i]);
+    }
+
+    HttpResponse resp;
+    HttpsConn* conn = https_request(DATA_UPDATE_HOST, path, "application/octet-stream",
+                                    resp, REQUEST_TIMEOUT_MS);
+    if (!conn) return false;
+    uint32_t n = chunk_len(p.size, index);
+    uint32_t got = 0;
+    HttpBodyStream body(conn, resp);
+    if (resp.status == 200) {
+        while (got < n) {
+            size_t r = body.read(_buf + got, n - got);
+            if (r == 0) break;
+            got += r;
+        }
+    }
+    bool complete = body.finish();
+    https_release(conn, complete && resp.keep_alive);
+    if (resp.status != 200 || got != n || !complete) {
+        Serial.printf("[Update] Chunk %s: HTTP %d, %lu of %lu bytes\n", path, resp.status,
+                      (unsigned long)got, (unsigned long)n);
+        return false;
+    }
+
+    uint8_t digest[32];
+    sha256(_buf, n, digest);
+    if (memcmp(digest, p.hashes[index], HASH_BYTES) != 0) {
+        Serial.printf("[Update] Chunk %s: content does not match its hash\n", path);
+        return false;
+    }
+    return true;
+}
+
+// Write the next chunk of the new image into the idle app slot: fetched
+// if it changed, else copied from the running image (it matched its
+// hash). True until the image is complete and set to boot.
+static bool firmware_step(bool* failed) {
+    FilePlan& p = _plan[_file];
+    if (!_ota_open) {
+        _ota_part = esp_ota_get_next_update_partition(nullptr);
+        // Sequential: each sector is erased as it is reached, not all upfront
+        if (!_ota_part || esp_ota_begin(_ota_part, OTA_WITH_SEQUENTIAL_WRITES, &_ota) != ESP_OK) {
+            Serial.println("[Update] Cannot open the idle app slot");
+            *failed = true;
+            return false;
+        }
+        mbedtls_sha256_init(&_ota_sha);
+        mbedtls_sha256_starts_ret(&_ota_sha, 0);
+        _ota_open = true;
+    }
+
+    if (_chunk < p.chunks) {
+        uint32_t n = chunk_len(p.size, _chunk);
+        const esp_partition_t* running = esp_ota_get_running_partition();
+        bool ok = is_changed(p, _chunk)
+                      ? fetch_chunk(p, _chunk)
+                      : esp_partition_read(running, _chunk * CHUNK_SIZE, _buf, n) == ESP_OK;
+        if (!ok || esp_ota_write(_ota, _buf, n) != ESP_OK) {
+            abort_firmware();
+            *failed = true;
+            return false;
+        }
+        mbedtls_sha256_update_ret(&_ota_sha, _buf, n);
+        _chunk++;
+        return true;
+    }
+
+    // esp_ota_end() checks the image itself (header, segments, its own hash)
+    uint8_t digest[32];
+    mbedtls_sha256_finish_ret(&_ota_sha, digest);
+    mbedtls_sha256_free(&_ota_sha);
+    _ota_open = false;
+    if (memcmp(digest, p.sha256, sizeof(digest)) != 0) {
+        Serial.println("[Update] Firmware does not match the manifest's SHA-256");
+        esp_ota_abort(_ota);
+        *failed = true;
+        return false;
+    }
+    esp_err_t err = esp_ota_end(_ota);
+    if (err == ESP_OK) err = esp_ota_set_boot_partition(_ota_part);
+    if (err != ESP_OK) {
+        Serial.printf("[Update] Firmware rejected: %s\n", esp_err_to_name(err));
+        *failed = true;
+        return false;
+    }
+    Serial.printf("[Update] Firmware written to '%s' (%lu of %lu chunks fetched)\n",
+                  _ota_part->label, (unsigned long)p.changed_count, (unsigned long)p.chunks);
+    _firmware_staged = true;
+    _file++;
+    _chunk = 0;
+    return true;
+}
+
+// Download the next changed chunk into its staging file. Returns false
+// when there is nothing left (failed reports why it stopped).
+static bool download_step(bool* failed) {
+    while (_file < TARGET_COUNT && _plan[_file].changed_count == 0) _file++;
+    if (_file >= TARGET_COUNT) return false;
+    if (TARGETS[_file].kind == TARGET_FIRMWARE) return firmware_step(failed);
+
+    FilePlan& p = _plan[_file];
+    if (!_stage) {
+        StageHeader h = { { 'R', 'G', 'U', 'P' }, STAGE_VERSION, 0, CHUNK_SIZE, p.size,
+                          p.changed_count, {} };
+        memcpy(h.sha256, p.sha256, sizeof(h.sha256));
+        _stage = LittleFS.open(stage_path(TARGETS[_file], true), "w");
+        if (!_stage || _stage.write((const uint8_t*)&h, sizeof(h)) != sizeof(h)) {
+            *failed = true;
+            return false;
+        }
+    }
+
+    while (_chunk < p.chunks && !is_changed(p, _chunk)) _chunk++;
+    if (_chunk == p.chunks) {
+        _stage.close();
+        _file++;
+        _chunk = 0;
+        return true;
+    }
+
+    uint32_t n = chunk_len(p.size, _chunk);
+    if (!fetch_chunk(p, _chunk) || _stage.write((const uint8_t*)&_chunk, 4) != 4 ||
+        _stage.write(_buf, n) != n) {
+        *failed = true;
+        return false;
+    }
+    _chunk++;
+    return true;
+}
+
+static void finish_staging() {
+    for (int i = 0; i < TARGET_COUNT; i++) {
+        if (_plan[i].changed_count == 0 || TARGETS[i].kind == TARGET_FIRMWARE) continue;
+        String tmp = stage_path(TARGETS[i], true);
+        LittleFS.rename(tmp, stage_path(TARGETS[i], false));
+    }
+    Serial.printf("[Update] Staged; %s at the next boot\n",
+                  _firmware_staged ? "new firmware runs" : "applied");
+    free_plan();
+    _phase = PHASE_STAGED;
+}
+
+#endif // DATA_UPDATE_HOST
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+static std::atomic<bool> _check_requested{false};
+
+void data_update_apply_staged() {
+    if (!asset_fs_mount() || !LittleFS.exists(STAGE_DIR)) return;
+    for (int i = 0; i < TARGET_COUNT; i++) {
+        const UpdateTarget& t = TARGETS[i];
+        if (t.kind == TARGET_FIRMWARE) continue;   // Never staged
+        LittleFS.remove(stage_path(t, true));      // Unfinished download
+        if (!LittleFS.exists(stage_path(t, false))) continue;
+        if (t.kind == TARGET_PARTITION) apply_partition(t);
+        else apply_file(t);
+    }
+}
+
+void data_update_task() {
+#ifdef DATA_UPDATE_HOST
+    switch (_phase) {
+        case PHASE_IDLE: {
+            bool requested = _check_requested.exchange(false);
+            if (!requested && (long)(millis() - _next_check_ms) < 0) return;
+            if (!WiFi.isConnected()) return;
+            if (fetch_manifest()) {
+                _phase = PHASE_HASHING;
+                _file = 0;
+                _chunk = 0;
+            } else {
+                end_check(RETRY_MS);
+            }
+            break;
+        }
+        case PHASE_HASHING:
+            if (!hash_step()) start_download();
+            break;
+        case PHASE_DOWNLOADING: {
+            bool failed = false;
+            if (download_step(&failed)) break;
+            if (failed) {
+                Serial.println("[Update] Download failed, retrying later");
+                end_check(RETRY_MS);
+            } else {
+                finish_staging();
+            }
+            break;
+        }
+        case PHASE_STAGED:
+            break;
+    }
+#endif
+}
+
+void data_update_check_now() {
+    _check_requested = true;
+}
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+static void cmd_update(const char*) {
+#ifdef DATA_UPDATE_HOST
+    Serial.printf("[Update] %s%s, manifest %lu\n", DATA_UPDATE_HOST, DATA_UPDATE_PATH,
+                  (unsigned long)_manifest_version);
+    Serial.printf("[Update] State: %s", PHASE_NAMES[_phase]);
+    if (_phase == PHASE_HASHING || _phase == PHASE_DOWNLOADING) {
+        if (_file < TARGET_COUNT) {
+            Serial.printf(", %s chunk %lu of %lu", TARGETS[_file].name, (unsigned long)_chunk,
+                          (unsigned long)_plan[_file].chunks);
+        }
+    }
+    Serial.println(_firmware_staged ? ", firmware waiting for a restart" : "");
+    if (_phase == PHASE_IDLE) {
+        data_update_check_now();
+        Serial.println("[Update] Checking now");
+    }
+#else
+    Serial.println("[Update] Not configured (set DATA_UPDATE_HOST in config.h)");
+#endif
+}
+
+void data_update_serial_init() {
+    serial_cmd_register("UPDATE", cmd_update);
+}
@@ -0,0 +1,39 @@
+/**
+ * Delta updates of the data files and firmware for RadioWall.
+ *
+ * Reads a manifest published by tools/make_update.py from DATA_UPDATE_HOST
+ * (config.h; disabled if unset): per file its size, SHA-256 and one hash
+ * per 4 KB chunk. The net worker hashes the local /places.bin,
+ * /stations.bin, the "maps" partition and the running app the same way, a
+ * chunk per idle pass, and downloads only the chunks that differ. Data
+ * files are staged under /upd and patched into place at the next boot,
+ * before the places database loads; places.bin changes are then copied
+ * into the raw "places" partition.
+ *
+ * Firmware is streamed straight into the app slot that is not running,
+ * unchanged chunks copied from the running image, and is only marked for
+ * boot once its SHA-256 matches. Nothing restarts the frame: the old image
+ * keeps playing until the next power cycle or Power Off.
+ */
+
+#ifndef DATA_UPDATE_H
+#define DATA_UPDATE_H
+
+#include <Arduino.h>
+
+// Patch staged chunks into their files (call at boot, before places_db_init;
+// mounts LittleFS). Does nothing if no complete update is staged.
+void data_update_apply_staged();
+
+// One step of the update check (net worker, when the command queue is idle):
+// a manifest request, one chunk hashed or one chunk downloaded
+void data_update_task();
+
+// Check for an update at the next idle pass instead of waiting for the
+// daily check (any task)
+void data_update_check_now();
+
+// Register serial commands (UPDATE - show status and check now)
+void data_update_serial_init();
+
+#endif // DATA_UPDATE_H
@@ -3,6 +3,32 @@
  *
  * Uses Arduino_GFX library with AXS15231B QSPI display controller (640x180).
  * Based on working LILYGO GFX_AXS15231B_Image example.
+ *
+ * Built with DISPLAY_FRAMEBUFFER, everything is drawn into a 180x640
+ * Arduino_Canvas in PSRAM and each public display_* call ends with one
+ * flush() of the whole frame, so view changes arrive in a single transfer
+ * instead of hundreds of small address-window writes. Without it (or if
+ * the framebuffer can't be allocated) gfx is the panel itself.
+ *
+ * Partial updates (status bar, volume slider, marker) declare the region
+ * they touch; the frame then pushes only those regions, through the
+ * canvas's region flush, instead of the whole 225 KB frame.
+ *
+ * If the panel's TE (tearing effect) output is wired and TFT_TE is set in
+ * pins_config.h, each flush first waits for the vertical blank.
+ *
+ * Changing the 1x slice slides the new map in over a few frames, pushed
+ * from display_loop() so touches are still handled between them.
+ * A title too wide for the status bar scrolls the same way: it is
+ * rendered once into a strip and display_loop() blits a moving window.
+ *
+ * Most updates are not drawn where they happen: display_invalidate() only
+ * records which parts of the current view are stale, and display_render()
+ * redraws each once at the end of the loop pass, inside one frame.
+ *
+ * The performance HUD (perf_hud.h) is drawn last in the map view's frames,
+ * over the map, and each frame reports its time to it with the HUD's own
+ * share taken out.
  */
 
 #include "display.h"
@@ -16,7 +42,18 @@
 #include "favorites.h"
 #include "history.h"
 #include "settings.h"
+#include "metrics.h"
+#include "chrome.h"
+#include "text_layout.h"
+#include "loop_events.h"
+#include "power_idle.h"
+#include "energy_stats.h"
+#include "perf_hud.h"
+#include "now_playing.h"
 #include "radio_client.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <driver/ledc.h>
 
 #define LCD_CS TFT_QSPI_CS
 #define LCD_SCLK TFT_QSPI_SCK
@@ -29,12 +66,328 @@
 #define LCD_WIDTH 180
 #define LCD_HEIGHT 640
 
+static const int BACKLIGHT_FADE_MS = 768;   // Same ramp as the old 256 x 3 ms loop
+
 // Global GFX instance (using Arduino_GFX library)
 static Arduino_DataBus *bus = nullptr;
-static Arduino_GFX *gfx = nullptr;
+static Arduino_GFX *gfx = nullptr;       // Drawing target: canvas or panel
+static Arduino_TFT *_panel = nullptr;     // The AXS15231 itself
+static Arduino_Canvas *_canvas = nullptr; // Framebuffer, if in use
+static int _frame_depth = 0;
+static uint32_t _frame_start_us = 0;      // Outermost frame opened
+static uint32_t _frame_hud_us = 0;        // Spent on the HUD inside it
+static bool _frame_hud_only = false;      // Nothing but the HUD redrawn
+static uint8_t _invalid = 0;              // DisplayPart bits awaiting display_render()
+
+// ------------------------------------------------------------------
+// Dirty regions (framebuffer builds)
+// ------------------------------------------------------------------
+
+static const int MAX_DIRTY_RECTS = 4;
+static const int32_t DIRTY_FULL_AREA = LCD_WIDTH * LCD_HEIGHT / 2;  // Beyond this, flush it all
+
+typedef Arduino_Canvas_Rect DirtyRect;
+static DirtyRect _dirty[MAX_DIRTY_RECTS];
+static int _dirty_count = 0;
+static bool _dirty_full = false;
+
+static int32_t rect_area(const DirtyRect& r) {
+    return (int32_t)r.w * r.h;
+}
+
+static DirtyRect rect_union(const DirtyRect& a, const DirtyRect& b) {
+    int16_t x0 = min(a.x, b.x);
+    int16_t y0 = min(a.y, b.y);
+    int16_t x1 = max(a.x + a.w, b.x + b.w);
+    int16_t y1 = max(a.y + a.h, b.y + b.h);
+    return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+}
+
+static bool rects_touch(const DirtyRect& a, const DirtyRect& b) {
+    return a.x <= b.x + b.w && b.x <= a.x + a.w &&
+           a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+static void mark_dirty_full() {
+    _dirty_full = true;
+    _dirty_count = 0;
+}
+
+/**
+ * Add a damaged rectangle. Touching rectangles are merged; when the list
+ * is full the new one joins whichever existing one grows the least.
+ * Wide rectangles are widened to whole rows: a contiguous band goes out
+ * without packing and costs little more on the bus. Narrow ones (slider,
+ * marker) are pushed as they are.
+ */
+static void mark_dirty(int x, int y, int w, int h) {
+    if (!_canvas || _dirty_full) return;
+
+    // Clip to the screen
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > LCD_WIDTH) w = LCD_WIDTH - x;
+    if (y + h > LCD_HEIGHT) h = LCD_HEIGHT - y;
+    if (w <= 0 || h <= 0) return;
+    if (w > LCD_WIDTH / 2) {
+        x = 0;
+        w = LCD_WIDTH;
+    }
+
+    DirtyRect r = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+
+    // Absorb every rectangle the new one touches (repeat: it grows)
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < _dirty_count; i++) {
+            if (rects_touch(r, _dirty[i])) {
+                r = rect_union(r, _dirty[i]);
+                _dirty[i] = _dirty[--_dirty_count];
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (_dirty_count == MAX_DIRTY_RECTS) {
+        int best = 0;
+        int32_t best_growth = INT32_MAX;
+        for (int i = 0; i < _dirty_count; i++) {
+            int32_t growth = rect_area(rect_union(r, _dirty[i])) - rect_area(_dirty[i]);
+            if (growth < best_growth) {
+                best_growth = growth;
+                best = i;
+            }
+        }
+        r = rect_union(r, _dirty[best]);
+        _dirty[best] = _dirty[--_dirty_count];
+    }
+    _dirty[_dirty_count++] = r;
+
+    int32_t total = 0;
+    for (int i = 0; i < _dirty_count; i++) total += rect_area(_dirty[i]);
+    if (total > DIRTY_FULL_AREA) mark_dirty_full();
+}
 
+// ------------------------------------------------------------------
+// Tearing effect sync (framebuffer builds with TFT_TE)
+// ------------------------------------------------------------------
+
+#if defined(DISPLAY_FRAMEBUFFER) && defined(TFT_TE)
+static const TickType_t TE_TIMEOUT = pdMS_TO_TICKS(25);  // > one 60 Hz refresh
+static SemaphoreHandle_t _te_sem = nullptr;
+
+static void IRAM_ATTR te_isr() {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(_te_sem, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+// Turn on the panel's TE output (V-blank only) and count its pulses
+static void te_init() {
+    _te_sem = xSemaphoreCreateBinary();
+    if (!_te_sem) return;
+    pinMode(TFT_TE, INPUT);
+    attachInterrupt(digitalPinToInterrupt(TFT_TE), te_isr, RISING);
+    bus->beginWrite();
+    bus->writeC8D8(AXS15231_WC_TEARON, 0x00);
+    bus->endWrite();
+    Serial.printf("[Display] TE sync on GPIO %d\n", TFT_TE);
+}
+
+// Block (without spinning) until the next V-blank, so the transfer starts
+// just behind the scan. A missed pulse means TE isn't wired after all:
+// stop waiting rather than cost every later frame the timeout.
+static void wait_for_vblank() {
+    if (!_te_sem) return;
+    xSemaphoreTake(_te_sem, 0);   // Drop a pulse from an earlier frame
+    if (xSemaphoreTake(_te_sem, TE_TIMEOUT) != pdTRUE) {
+        Serial.println("[Display] No TE pulse, flushing unsynchronised");
+        detachInterrupt(digitalPinToInterrupt(TFT_TE));
+        vSemaphoreDelete(_te_sem);
+        _te_sem = nullptr;
+    }
+}
+#else
+static inline void te_init() {}
+static inline void wait_for_vblank() {}
+#endif
+
+/**
+ * Scope of one display update. Nested display_* calls share the outer
+ * frame; the framebuffer is flushed once, when the outermost one ends.
+ * The default frame covers the whole screen; partial updates pass the
+ * region they redraw (and may add more with mark_dirty()).
+ */
+static void frame_begin() {
+    if (_frame_depth++ > 0) return;
+    _frame_start_us = micros();
+    _frame_hud_us = 0;
+}
+
+// After the flush: the frame's time goes to the HUD, less its own part
+static void frame_end() {
+    uint32_t us = micros() - _frame_start_us;
+    if (_frame_hud_only) {
+        perf_hud_own_time(us);
+        _frame_hud_only = false;
+        return;
+    }
+    perf_hud_own_time(_frame_hud_us);
+    perf_hud_frame(us - _frame_hud_us);
+}
+
+struct DisplayFrame {
+    DisplayFrame() {
+        frame_begin();
+        mark_dirty_full();
+    }
+    DisplayFrame(int x, int y, int w, int h) {
+        frame_begin();
+        mark_dirty(x, y, w, h);
+    }
+    ~DisplayFrame() {
+        if (--_frame_depth > 0) return;
+        display_flush();
+        frame_end();
+    }
+};
+
+// ------------------------------------------------------------------
+// Map slide (framebuffer builds): the new map is drawn into the
+// framebuffer as usual, but instead of one flush it goes out as a series
+// of frames in which it pushes the old map (kept in a copy) aside. Each
+// frame is put together a band of rows at a time from the two and written
+// straight to the panel. The panel's scroll registers move along the long
+// axis only, so they can't do a sideways slide.
+// ------------------------------------------------------------------
+
+static const uint32_t SLIDE_MS = 240;
+static const uint32_t SLIDE_FRAME_MS = 16;   // One refresh at 60 Hz
+static const int SLIDE_BAND_ROWS = 20;       // 29 bands for the map area
+
+struct MapSlide {
+    bool active;
+    int8_t step;          // +1: the new map comes in from the right, -1: from the left
+    uint32_t start_ms;
+    int shown;            // Columns of the new map on the panel
+    int frames;
+};
+static MapSlide _slide = {};
+static uint16_t* _slide_old = nullptr;   // Map area as it was, PSRAM
+static uint16_t _slide_band[SLIDE_BAND_ROWS * LCD_WIDTH];   // 7 KB
+
+// Push a frame showing k columns of the new map next to the old one
+static void push_slide_frame(int k) {
+    const uint16_t* fb = _canvas->getFramebuffer();
+    wait_for_vblank();
+    for (int y = 0; y < MAP_HEIGHT; y += SLIDE_BAND_ROWS) {
+        int rows = min(SLIDE_BAND_ROWS, MAP_HEIGHT - y);
+        for (int r = 0; r < rows; r++) {
+            const uint16_t* old_row = _slide_old + (int32_t)(y + r) * LCD_WIDTH;
+            const uint16_t* new_row = fb + (int32_t)(y + r) * LCD_WIDTH;
+            uint16_t* out = _slide_band + r * LCD_WIDTH;
+            if (_slide.step > 0) {
+                memcpy(out, old_row + k, (LCD_WIDTH - k) * sizeof(uint16_t));
+                memcpy(out + LCD_WIDTH - k, new_row, k * sizeof(uint16_t));
+            } else {
+                memcpy(out, new_row + LCD_WIDTH - k, k * sizeof(uint16_t));
+                memcpy(out + k, old_row, (LCD_WIDTH - k) * sizeof(uint16_t));
+            }
+        }
+        _panel->draw16bitRGBBitmap(0, y, _slide_band, LCD_WIDTH, rows);
+    }
+}
+
+// Stop a running slide and show the new map as it is
+static void end_slide() {
+    if (!_slide.active) return;
+    _slide.active = false;
+    wait_for_vblank();
+    _canvas->flush(0, 0, LCD_WIDTH, MAP_HEIGHT);
+    if (perf_hud_enabled()) _invalid |= DISPLAY_PART_HUD;   // Not drawn while sliding
+    Serial.printf("[Display] Slide: %d frames in %lu ms\n",
+                  _slide.frames + 1, (unsigned long)(millis() - _slide.start_ms));
+}
+
+// A flush that would write map rows while a slide runs ends the slide first
+static bool map_rows_dirty() {
+    if (_dirty_full || _dirty_count == 0) return true;
+    for (int i = 0; i < _dirty_count; i++) {
+        if (_dirty[i].y < MAP_HEIGHT) return true;
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------
+// Idle power
+// ------------------------------------------------------------------
+
+// No input for DISPLAY_TIMEOUT_SECONDS dims the backlight. DISPLAY_OFF_SECONDS
+// later it goes dark, the panel drops to idle mode (8 colours, less panel
+// current; GRAM keeps every bit) and the CPU clock comes down.
+// display_wake() undoes all of it in one pass, well inside a frame.
+#ifndef DISPLAY_TIMEOUT_SECONDS
+#define DISPLAY_TIMEOUT_SECONDS 60
+#endif
+#ifndef DISPLAY_OFF_SECONDS
+#define DISPLAY_OFF_SECONDS 240
+#endif
+#ifndef DISPLAY_BRIGHTNESS_NORMAL
+#define DISPLAY_BRIGHTNESS_NORMAL 255
+#endif
+#ifndef DISPLAY_BRIGHTNESS_DIM
+#define DISPLAY_BRIGHTNESS_DIM 50
+#endif
+
+static const uint32_t IDLE_CPU_MHZ = 80;   // Lowest clock WiFi keeps working at
+
+enum PowerState {
+    POWER_ACTIVE,
+    POWER_DIM,    // Backlight at DISPLAY_BRIGHTNESS_DIM
+    POWER_OFF,    // Backlight off, panel idle mode, CPU at IDLE_CPU_MHZ
+};
+
+static PowerState _power = POWER_ACTIVE;
 static unsigned long _last_activity = 0;
-static bool _dimmed = false;
+static uint32_t _active_cpu_mhz = 0;   // Clock before POWER_OFF
+
+static void set_panel_idle(bool idle) {
+    if (bus) bus->sendCommand(idle ? AXS15231_C_IDLEON : AXS15231_C_IDLEOFF);
+}
+
+// Step down once the idle time passes a threshold (display_loop)
+static void update_power() {
+    if (_power == POWER_OFF) return;
+    uint32_t idle_ms = millis() - _last_activity;
+    uint32_t dim_ms = DISPLAY_TIMEOUT_SECONDS * 1000UL;
+    uint32_t off_ms = dim_ms + DISPLAY_OFF_SECONDS * 1000UL;
+
+    if (_power == POWER_ACTIVE && idle_ms >= dim_ms) {
+        ledcWrite(1, DISPLAY_BRIGHTNESS_DIM);
+        _power = POWER_DIM;
+        energy_stats_set(ENERGY_DISPLAY_DIM, true);
+        Serial.println("[Display] Idle: dimmed");
+    }
+    if (_power == POWER_DIM && idle_ms >= off_ms) {
+        ledcWrite(1, 0);
+        set_panel_idle(true);
+        _active_cpu_mhz = getCpuFrequencyMhz();
+        if (power_idle_enabled()) {
+            power_idle_hold(POWER_HOLD_DISPLAY, false);   // DFS and light sleep take over
+        } else if (_active_cpu_mhz > IDLE_CPU_MHZ) {
+            setCpuFrequencyMhz(IDLE_CPU_MHZ);
+        }
+        _power = POWER_OFF;
+        energy_stats_set(ENERGY_DISPLAY_DIM, false);
+        energy_stats_set(ENERGY_DISPLAY_LIT, false);
+        Serial.printf("[Display] Idle: backlight off, panel idle, CPU %lu MHz\n",
+                      (unsigned long)getCpuFrequencyMhz());
+        return;
+    }
+    loop_events_due_in((_power == POWER_ACTIVE ? dim_ms : off_ms) - idle_ms);
+}
 
 // Current display state
 static char _station[128] = "";
@@ -42,20 +395,10 @@ static char _location[128] = "";
 static char _country[8] = "";
 static char _status[32] = "idle";
 
-// Helper: truncate UTF-8 string to max N bytes with "..." without splitting multi-byte chars
-static void utf8_truncate(char* buf, size_t max_bytes) {
-    if (strlen(buf) <= max_bytes) return;
-    int i = max_bytes - 3;
-    while (i > 0 && (buf[i] & 0xC0) == 0x80) i--; // back up past continuation bytes
-    buf[i++] = '.';
-    buf[i++] = '.';
-    buf[i++] = '.';
-    buf[i] = '\0';
-}
-
 // Helper: set u8g2 Unicode font for status bar text
 static void set_unicode_font() {
-    gfx->setFont(u8g2_font_cubic11_h_cjk);
+    gfx->setFont(TH_FONT_UNICODE);
+    gfx->setFontIndex(TH_FONT_UNICODE_INDEX);
     gfx->setUTF8Print(true);
 }
 
@@ -65,9 +408,15 @@ static void clear_unicode_font() {
     gfx->setUTF8Print(false);
 }
 
-// Helper: draw a status bar icon button (icon-only, centered)
+// Helper: draw a status bar icon button (icon-only, centered). A baked
+// sprite of the same size replaces the primitives when there is one.
 static void draw_status_icon_btn(int x, int y, int w, int h, uint16_t color,
-                                  void (*draw_icon)(Arduino_GFX*, int, int, uint16_t)) {
+                                  void (*draw_icon)(Arduino_GFX*, int, int, uint16_t),
+                                  const ChromeSprite* baked) {
+    if (baked && baked->w == w && baked->h == h) {
+        chrome_draw(gfx, *baked, x, y);
+        return;
+    }
     gfx->fillRoundRect(x, y, w, h, TH_CORNER_R, TH_BTN);
     draw_icon(gfx, x + w / 2, y + h / 2, color);
 }
@@ -107,6 +456,204 @@ static void icon_mute(Arduino_GFX* g, int cx, int cy, uint16_t c) {
     g->drawLine(cx + 7, cy - 3, cx + 4, cy + 3, c);
 }
 
+// ------------------------------------------------------------------
+// Marquee: a status bar title wider than the bar is rendered once into
+// a strip canvas in PSRAM and scrolled by copying a moving window of it
+// into the bar. A step is one 172x16 blit (and a region flush of just
+// those rows), with no text drawn.
+// ------------------------------------------------------------------
+
+static const int MARQUEE_X = 4;
+static const int MARQUEE_W = TH_DISPLAY_W - 8;
+static const int MARQUEE_Y = MAP_HEIGHT + 16;       // Status bar line 2
+static const int MARQUEE_H = 16;
+static const int MARQUEE_BASELINE = 11;             // STATUS_Y + 27, as drawn text
+static const int MARQUEE_STRIP_W = 1024;            // Widest title scrolled (32 KB strip)
+static const int MARQUEE_GAP = 40;                  // Blank before the text comes round
+static const uint32_t MARQUEE_PAUSE_MS = 2000;      // Held at the start of each pass
+static const uint32_t MARQUEE_PX_PER_S = 30;
+
+struct Marquee {
+    bool active;
+    char text[132];
+    int period;           // Text width + gap: one pass, in pixels
+    uint32_t start_ms;
+    int shown;            // Offset on the panel, -1 = not drawn
+};
+static Marquee _marquee = {};
+static Arduino_Canvas* _marquee_strip = nullptr;
+static bool _marquee_unavailable = false;
+static uint16_t _marquee_band[MARQUEE_W * MARQUEE_H];   // 5.5 KB
+
+static bool ensure_marquee_strip() {
+    if (_marquee_strip) return true;
+    if (_marquee_unavailable) return false;
+    if (psramFound()) {
+        _marquee_strip = new Arduino_Canvas(MARQUEE_STRIP_W, MARQUEE_H, nullptr);
+        if (!_marquee_strip->begin(GFX_SKIP_OUTPUT_BEGIN)) {
+            delete _marquee_strip;
+            _marquee_strip = nullptr;
+        }
+    }
+    if (!_marquee_strip) {
+        Serial.println("[Display] No PSRAM for the marquee, long titles are cut");
+        _marquee_unavailable = true;
+        return false;
+    }
+    _marquee_strip->setTextWrap(false);
+    return true;
+}
+
+// Offset of the window for now; *wait_ms receives the time to the next step
+static int marquee_offset(uint32_t* wait_ms) {
+    uint32_t pass_ms = MARQUEE_PAUSE_MS + (uint32_t)_marquee.period * 1000 / MARQUEE_PX_PER_S;
+    uint32_t t = (millis() - _marquee.start_ms) % pass_ms;
+    if (t < MARQUEE_PAUSE_MS) {
+        *wait_ms = MARQUEE_PAUSE_MS - t;
+        return 0;
+    }
+    *wait_ms = 1000 / MARQUEE_PX_PER_S;
+    return (t - MARQUEE_PAUSE_MS) * MARQUEE_PX_PER_S / 1000;
+}
+
+// Copy the window at offset into the bar, wrapping round the strip's end
+static void marquee_push(int offset) {
+    const uint16_t* strip = _marquee_strip->getFramebuffer();
+    int first = min(MARQUEE_W, _marquee.period - offset);
+    for (int r = 0; r < MARQUEE_H; r++) {
+        const uint16_t* src = strip + r * MARQUEE_STRIP_W;
+        uint16_t* out = _marquee_band + r * MARQUEE_W;
+        memcpy(out, src + offset, first * sizeof(uint16_t));
+        if (first < MARQUEE_W) memcpy(out + first, src, (MARQUEE_W - first) * sizeof(uint16_t));
+    }
+    DisplayFrame frame(MARQUEE_X, MARQUEE_Y, MARQUEE_W, MARQUEE_H);
+    gfx->draw16bitRGBBitmap(MARQUEE_X, MARQUEE_Y, _marquee_band, MARQUEE_W, MARQUEE_H);
+    _marquee.shown = offset;
+}
+
+static void marquee_stop() {
+    _marquee.active = false;
+}
+
+// Show text on line 2 as a marquee if it is too wide for the bar. False if
+// it fits (or can't scroll): the caller draws it as usual.
+static bool marquee_show(const char* text) {
+    int w = text_layout_width(text);
+    if (w <= MARQUEE_W || w + MARQUEE_GAP > MARQUEE_STRIP_W || !ensure_marquee_strip()) {
+        marquee_stop();
+        return false;
+    }
+
+    // Same title (a status bar repaint): carry on where it was
+    if (!_marquee.active || strcmp(_marquee.text, text) != 0) {
+        _marquee_strip->fillScreen(TH_BG);
+        _marquee_strip->setFont(TH_FONT_UNICODE);
+        _marquee_strip->setFontIndex(TH_FONT_UNICODE_INDEX);
+        _marquee_strip->setUTF8Print(true);
+        _marquee_strip->setTextColor(TH_TEXT);
+        _marquee_strip->setCursor(0, MARQUEE_BASELINE);
+        _marquee_strip->print(text);
+
+        strncpy(_marquee.text, text, sizeof(_marquee.text) - 1);
+        _marquee.text[sizeof(_marquee.text) - 1] = '\0';
+        _marquee.period = w + MARQUEE_GAP;
+        _marquee.start_ms = millis();
+        _marquee.active = true;
+    }
+    uint32_t wait_ms;
+    marquee_push(marquee_offset(&wait_ms));
+    return true;
+}
+
+// Advance the window (display_loop); nothing while the panel is off
+static void marquee_step() {
+    if (!_marquee.active || _power == POWER_OFF) return;
+    uint32_t wait_ms;
+    int offset = marquee_offset(&wait_ms);
+    if (offset != _marquee.shown) marquee_push(offset);
+    loop_events_due_in(wait_ms);
+}
+
+// ------------------------------------------------------------------
+// Text runs: a status bar line, background and every glyph, is
+// rasterised into a 180x14 line buffer and sent as one block. Drawing
+// direct, print() would open an address window per glyph span; here the
+// panel gets one writeAddrWindow and one writePixels per line.
+// ------------------------------------------------------------------
+
+static const int TEXT_RUN_H = 14;
+static const int TEXT_RUN_BASELINE = 10;   // From the band's top
+static Arduino_Canvas* _text_run = nullptr;
+static bool _text_run_unavailable = false;
+static int _text_run_y = 0;
+
+static bool ensure_text_run() {
+    if (_text_run) return true;
+    if (_text_run_unavailable) return false;
+    _text_run = new Arduino_Canvas(TH_DISPLAY_W, TEXT_RUN_H, nullptr);
+    if (!_text_run->begin(GFX_SKIP_OUTPUT_BEGIN)) {
+        delete _text_run;
+        _text_run = nullptr;
+        _text_run_unavailable = true;
+        Serial.println("[Display] No memory for the text run buffer, drawing glyphs direct");
+        return false;
+    }
+    _text_run->setTextWrap(false);
+    _text_run->setFont(TH_FONT_UNICODE);
+    _text_run->setFontIndex(TH_FONT_UNICODE_INDEX);
+    _text_run->setUTF8Print(true);
+    return true;
+}
+
+// Start a line whose band begins at y, filled with bg
+static void text_run_begin(int y, uint16_t bg) {
+    _text_run_y = y;
+    if (ensure_text_run()) {
+        _text_run->fillScreen(bg);
+    } else {
+        gfx->fillRect(0, y, TH_DISPLAY_W, TEXT_RUN_H, bg);
+    }
+}
+
+// Text at x on the line's baseline (the unicode font is set on gfx for
+// the fallback)
+static void text_run_print(int x, const char* text, uint16_t color) {
+    Arduino_GFX* g = _text_run ? (Arduino_GFX*)_text_run : gfx;
+    g->setTextColor(color);
+    g->setCursor(x, (_text_run ? 0 : _text_run_y) + TEXT_RUN_BASELINE);
+    g->print(text);
+}
+
+static void text_run_end() {
+    if (!_text_run) return;
+    uint16_t* px = _text_run->getFramebuffer();
+    if (_canvas) {
+        gfx->draw16bitRGBBitmap(0, _text_run_y, px, TH_DISPLAY_W, TEXT_RUN_H);
+        return;
+    }
+    _panel->startWrite();
+    _panel->writeAddrWindow(0, _text_run_y, TH_DISPLAY_W, TEXT_RUN_H);
+    _panel->writePixels(px, (uint32_t)TH_DISPLAY_W * TEXT_RUN_H);
+    _panel->endWrite();
+}
+
+// A whole line of one colour
+static void text_run_line(int y, const char* text, uint16_t color) {
+    text_run_begin(y, TH_BG);
+    text_run_print(4, text, color);
+    text_run_end();
+}
+
+// LEDC channel 1 is low-speed channel 1 on the S3 (Arduino maps 0-7 there)
+static void start_backlight_fade() {
+    if (ledc_fade_func_install(0) != ESP_OK ||
+        ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, DISPLAY_BRIGHTNESS_NORMAL,
+                                BACKLIGHT_FADE_MS) != ESP_OK ||
+        ledc_fade_start(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, LEDC_FADE_NO_WAIT) != ESP_OK) {
+        ledcWrite(1, DISPLAY_BRIGHTNESS_NORMAL);
+    }
+}
+
 void display_init() {
     Serial.println("[Display] Initializing Arduino_GFX AXS15231B display...");
 
@@ -117,27 +664,50 @@ void display_init() {
     ledcWrite(1, 0);  // Start dim
 
     // Create QSPI bus
-    bus = new Arduino_ESP32QSPI(
+    Arduino_ESP32QSPI* qspi = new Arduino_ESP32QSPI(
         LCD_CS /* CS */, LCD_SCLK /* SCK */, LCD_SDIO0 /* SDIO0 */,
         LCD_SDIO1 /* SDIO1 */, LCD_SDIO2 /* SDIO2 */, LCD_SDIO3 /* SDIO3 */);
+    bus = qspi;
 
     // Create AXS15231 display driver
     // Rotation 0 = Portrait (180x640) - STABLE WORKING CONFIGURATION
     // NOTE: Rotations 1 and 3 cause fading/crashing issues
-    gfx = new Arduino_AXS15231(bus, LCD_RST /* RST */, 0 /* rotation */,
-                               false /* IPS */, LCD_WIDTH, LCD_HEIGHT);
+#ifdef DISPLAY_STATIC_DISPATCH
+    // Same driver with the QSPI bus bound at compile time (no bus virtuals)
+    Arduino_TFT *panel = new Arduino_AXS15231_Static<Arduino_ESP32QSPI>(
+        qspi, LCD_RST /* RST */, 0 /* rotation */, false /* IPS */, LCD_WIDTH, LCD_HEIGHT);
+#else
+    Arduino_TFT *panel = new Arduino_AXS15231(bus, LCD_RST /* RST */, 0 /* rotation */,
+                                              false /* IPS */, LCD_WIDTH, LCD_HEIGHT);
+#endif
+    _panel = panel;
 
     // Initialize display
-    gfx->begin();
+#ifdef DISPLAY_FRAMEBUFFER
+    // Canvas begin() also starts the panel, then allocates 225 KB (PSRAM)
+    _canvas = new Arduino_Canvas(LCD_WIDTH, LCD_HEIGHT, panel);
+    if (_canvas->begin()) {
+        gfx = _canvas;
+        Serial.println("[Display] Rendering to PSRAM framebuffer");
+        te_init();
+    } else {
+        Serial.println("[Display] Framebuffer allocation failed, drawing direct");
+        delete _canvas;
+        _canvas = nullptr;
+        gfx = panel;
+    }
+#else
+    panel->begin();
+    gfx = panel;
+#endif
     gfx->fillScreen(BLACK);
+    display_flush();
 
-    // Fade in backlight smoothly
-    for (int i = 0; i <= 255; i++) {
-        ledcWrite(1, i);
-        delay(3);
-    }
+    // Fade in backlight in hardware so setup() keeps loading meanwhile
+    start_backlight_fade();
 
     // Show RadioWall splash (landscape coordinates: 640 wide x 180 tall)
+    DisplayFrame frame;
     gfx->setFont(&FreeSerifBoldItalic12pt7b);
     gfx->setTextSize(1);
     gfx->setTextColor(TH_ACCENT);
@@ -151,13 +721,168 @@ void display_init() {
     gfx->println("Touch the world map to play radio");
 
     _last_activity = millis();
-    _dimmed = false;
+    _power = POWER_ACTIVE;
+    energy_stats_set(ENERGY_DISPLAY_LIT, true);
 
     Serial.println("[Display] Arduino_GFX display initialized successfully!");
 }
 
 void display_loop() {
-    // No-op for now (auto-dimming could go here)
+    update_power();
+    marquee_step();
+#if !USE_BUILTIN_TOUCH
+    now_playing_step(_power == POWER_ACTIVE);
+#endif
+    if (!_slide.active) return;
+
+    uint32_t elapsed = millis() - _slide.start_ms;
+    if (elapsed >= SLIDE_MS) {
+        end_slide();
+        return;
+    }
+    // Ease out: fast at first, settling onto the new map
+    float t = 1.0f - (float)elapsed / SLIDE_MS;
+    int k = LCD_WIDTH - (int)(LCD_WIDTH * t * t * t);
+    if (k > _slide.shown && k < LCD_WIDTH) {
+        push_slide_frame(k);
+        _slide.shown = k;
+        _slide.frames++;
+    }
+    loop_events_due_in(SLIDE_FRAME_MS);
+}
+
+// ------------------------------------------------------------------
+// Frame scheduler
+// ------------------------------------------------------------------
+
+void display_invalidate(uint8_t parts) {
+    _invalid |= parts;
+}
+
+static bool marker_over_hud();
+static void display_update_play_progress(UIState* state);
+static bool volume_frame_due();
+
+// Draw the HUD box over the map; erase it (from the map's base layer, or
+// by redrawing the map) when it has just been turned off
+static void render_hud(UIState* state, uint8_t parts) {
+    if (_slide.active) return;
+    uint32_t start = micros();
+    if (!perf_hud_enabled()) {
+        if (parts & DISPLAY_PART_HUD) {
+            mark_dirty(PERF_HUD_BOX_X, PERF_HUD_BOX_Y, PERF_HUD_BOX_W, PERF_HUD_BOX_H);
+            if (!world_map_restore(gfx, PERF_HUD_BOX_X, PERF_HUD_BOX_Y, PERF_HUD_BOX_W, PERF_HUD_BOX_H)) {
+                display_refresh_map_only(state);
+                if (state->has_marker()) {
+                    display_draw_marker_at_latlon(state->get_marker_lat(),
+                                                  state->get_marker_lon(), state);
+                }
+            }
+        }
+        _frame_hud_us += micros() - start;
+        return;
+    }
+    if (!(parts & (DISPLAY_PART_HUD | DISPLAY_PART_MAP | DISPLAY_PART_VIEW))) return;
+
+    char lines[PERF_HUD_LINES][PERF_HUD_LINE_LEN];
+    int n = perf_hud_lines(lines);
+    mark_dirty(PERF_HUD_BOX_X, PERF_HUD_BOX_Y, PERF_HUD_BOX_W, PERF_HUD_BOX_H);
+    gfx->fillRect(PERF_HUD_BOX_X, PERF_HUD_BOX_Y, PERF_HUD_BOX_W, PERF_HUD_BOX_H, BLACK);
+    gfx->setFont((const uint8_t*)nullptr);
+    gfx->setTextSize(1);
+    gfx->setTextColor(GREEN);
+    for (int i = 0; i < n; i++) {
+        gfx->setCursor(PERF_HUD_BOX_X + 2, PERF_HUD_BOX_Y + 2 + i * 9);
+        gfx->print(lines[i]);
+    }
+    _frame_hud_us += micros() - start;
+}
+
+static void show_view(UIState* state) {
+    marquee_stop();   // The map view starts it again with its status bar
+#if !USE_BUILTIN_TOUCH
+    now_playing_hide();
+#endif
+    switch (state->get_view_mode()) {
+        case VIEW_MAP:              display_show_map_view(state); break;
+        case VIEW_MENU:             display_show_menu_view(state); break;
+        case VIEW_VOLUME:           display_show_volume_view(state); break;
+        case VIEW_FAVORITES:        display_show_favorites_view(state); break;
+        case VIEW_HISTORY:          display_show_history_view(state); break;
+        case VIEW_SETTINGS:         display_show_settings_view(state); break;
+        case VIEW_SETTINGS_WIFI:    display_show_settings_wifi_view(state); break;
+        case VIEW_SETTINGS_DEVICES: display_show_settings_devices_view(state); break;
+    }
+}
+
+void display_render(UIState* state) {
+    uint8_t parts = _invalid;
+    _invalid = 0;
+    // The HUD is only on the map, and never mid-slide (end_slide() asks again)
+    bool map_view = state && state->get_view_mode() == VIEW_MAP;
+    if (!map_view || _slide.active || _power == POWER_OFF) parts &= ~DISPLAY_PART_HUD;
+    if (!parts || !gfx || !state) return;
+    if (parts == DISPLAY_PART_VOLUME && state->get_view_mode() == VIEW_VOLUME &&
+        !volume_frame_due()) {
+        _invalid |= DISPLAY_PART_VOLUME;
+        return;
+    }
+
+    _frame_hud_only = parts == DISPLAY_PART_HUD;
+    DisplayFrame frame(0, 0, 0, 0);   // The parts below declare their regions
+    if (parts & DISPLAY_PART_VIEW) {
+        show_view(state);
+        if (map_view) render_hud(state, parts);
+        return;
+    }
+
+    switch (state->get_view_mode()) {
+        case VIEW_MAP:
+#if !USE_BUILTIN_TOUCH
+            // Now playing scene: the volume arc is part of it, and the
+            // state line and artwork lie under the HUD box. With the HUD
+            // off, only its own part erases it: that redraws the scene.
+            if (parts & DISPLAY_PART_MAP) {
+                now_playing_show(state);
+                if (perf_hud_enabled()) parts |= DISPLAY_PART_HUD;
+            } else if (parts & (DISPLAY_PART_STATUS | DISPLAY_PART_VOLUME)) {
+                now_playing_update(state);
+                if (perf_hud_enabled()) parts |= DISPLAY_PART_HUD;
+            }
+            render_hud(state, parts);
+            break;
+#endif
+            if (parts & DISPLAY_PART_MAP) {
+                display_refresh_map_only(state);
+                parts |= DISPLAY_PART_MARKER;
+            }
+            if ((parts & DISPLAY_PART_MARKER) && state->has_marker()) {
+                // Erasing or drawing the marker under the box damages it
+                if (marker_over_hud()) parts |= DISPLAY_PART_HUD;
+                display_draw_marker_at_latlon(state->get_marker_lat(), state->get_marker_lon(), state);
+                if (marker_over_hud()) parts |= DISPLAY_PART_HUD;
+            }
+            if (parts & DISPLAY_PART_STATUS) {
+                display_update_status_bar(state);
+            } else if (parts & DISPLAY_PART_PROGRESS) {
+                display_update_play_progress(state);
+            }
+            render_hud(state, parts);
+            break;
+        case VIEW_MENU:
+            if (parts & DISPLAY_PART_STATUS) display_update_status_bar_menu(state);
+            break;
+        case VIEW_VOLUME:
+            if (parts & DISPLAY_PART_VOLUME) display_update_volume_bar(state);
+            break;
+        case VIEW_SETTINGS:
+        case VIEW_SETTINGS_WIFI:
+        case VIEW_SETTINGS_DEVICES:
+            if (parts & DISPLAY_PART_STATUS) display_update_status_bar_settings(state);
+            break;
+        default:
+            break;
+    }
 }
 
 void display_show_nowplaying(const char* station, const char* location, const char* country) {
@@ -179,6 +904,8 @@ void display_show_nowplaying(const char* station, const char* location, const ch
 
     // Update display
     if (gfx) {
+        DisplayFrame frame;
+        marquee_stop();
         gfx->fillScreen(BLACK);
 
         // Title
@@ -214,6 +941,7 @@ void display_show_status(const char* status) {
     Serial.printf("[Display] Status: %s\n", status);
 
     if (gfx) {
+        DisplayFrame frame(0, 550, LCD_WIDTH, 8);
         gfx->setCursor(10, 550);
         gfx->setTextSize(1);
         gfx->setTextColor(MAGENTA);
@@ -230,6 +958,8 @@ void display_show_connecting() {
     Serial.println("[Display] Connecting to WiFi and MQTT...");
 
     if (gfx) {
+        DisplayFrame frame;
+        marquee_stop();
         gfx->fillScreen(BLACK);
         // Landscape coordinates: 640 wide x 180 tall
         gfx->setFont(&FreeSansBold10pt7b);
@@ -241,79 +971,55 @@ void display_show_connecting() {
     }
 }
 
-void display_show_wifi_portal(bool show_cancel) {
-    Serial.println("[Display] Showing WiFi portal instructions...");
-
-    if (gfx) {
-        gfx->fillScreen(BLACK);
-
-        // Title
-        gfx->setFont(&FreeSansBold10pt7b);
-        gfx->setTextSize(1);
-        gfx->setTextColor(TH_ACCENT);
-        gfx->setCursor(20, 60);
-        gfx->print("WiFi Setup");
-        gfx->setFont((const GFXfont*)nullptr);
-
-        gfx->setTextSize(1);
-
-        // Step 1
-        gfx->setTextColor(TH_TEXT);
-        gfx->setCursor(10, 100);
-        gfx->print("1. Connect to");
-        gfx->setTextColor(TH_WARNING);
-        gfx->setCursor(10, 118);
-        gfx->print("  \"RadioWall\"");
-        gfx->setTextColor(TH_TEXT);
-        gfx->setCursor(10, 136);
-        gfx->print("  WiFi network");
-
-        // Step 2
-        gfx->setCursor(10, 170);
-        gfx->print("2. Open browser");
-
-        // IP address
-        gfx->setTextColor(TH_ACCENT);
-        gfx->setFont(&FreeSansBold10pt7b);
-        gfx->setCursor(10, 220);
-        gfx->print("192.168.4.1");
-        gfx->setFont((const GFXfont*)nullptr);
-
-        // Cancel hint (only when opened from settings)
-        if (show_cancel) {
-            gfx->setTextColor(TH_TEXT_SEC);
-            gfx->setCursor(10, 270);
-            gfx->print("Press button to cancel");
-        }
-    }
+uint32_t display_idle_ms() {
+    return millis() - _last_activity;
 }
 
 void display_wake() {
     _last_activity = millis();
-    if (_dimmed) {
-        _dimmed = false;
-        if (gfx) {
-            // Restore brightness
-            ledcWrite(1, 255);
+    if (_power == POWER_ACTIVE || !gfx) return;
+
+    // Clock first: the panel command and whatever the caller draws next
+    // run at full speed
+    if (_power == POWER_OFF) {
+        if (power_idle_enabled()) {
+            power_idle_hold(POWER_HOLD_DISPLAY, true);
+        } else if (_active_cpu_mhz > IDLE_CPU_MHZ) {
+            setCpuFrequencyMhz(_active_cpu_mhz);
         }
+        set_panel_idle(false);
     }
+    ledcWrite(1, DISPLAY_BRIGHTNESS_NORMAL);
+    _power = POWER_ACTIVE;
+    energy_stats_set(ENERGY_DISPLAY_DIM, false);
+    energy_stats_set(ENERGY_DISPLAY_LIT, true);
 }
 
 // Store previous marker position for efficient clearing
 static int _prev_marker_x = -1;
 static int _prev_marker_y = -1;
+static const int MARK_SIZE = 4;   // Half-size of the X
 
 void display_draw_touch_feedback(int x, int y, UIState* state) {
     if (!gfx || !state) return;
-
-    const int mark_size = 4;  // Half-size of the X
-
-    // Clear previous marker by drawing over it with black
+#if !USE_BUILTIN_TOUCH
+    return;   // No map on the panel: the touch was on the wall map
+#endif
+    const int mark_size = MARK_SIZE;
+    DisplayFrame frame(x - mark_size, y - mark_size, 2 * mark_size + 1, 2 * mark_size + 1);
+
+    // Clear previous marker: restore the map under it from the base layer,
+    // or draw over it with black if there is none
     if (_prev_marker_x >= 0 && _prev_marker_y >= 0) {
-        gfx->drawLine(_prev_marker_x - mark_size, _prev_marker_y - mark_size,
-                      _prev_marker_x + mark_size, _prev_marker_y + mark_size, BLACK);
-        gfx->drawLine(_prev_marker_x - mark_size, _prev_marker_y + mark_size,
-                      _prev_marker_x + mark_size, _prev_marker_y - mark_size, BLACK);
+        mark_dirty(_prev_marker_x - mark_size, _prev_marker_y - mark_size,
+                   2 * mark_size + 1, 2 * mark_size + 1);
+        if (!world_map_restore(gfx, _prev_marker_x - mark_size, _prev_marker_y - mark_size,
+                               2 * mark_size + 1, 2 * mark_size + 1)) {
+            gfx->drawLine(_prev_marker_x - mark_size, _prev_marker_y - mark_size,
+                          _prev_marker_x + mark_size, _prev_marker_y + mark_size, BLACK);
+            gfx->drawLine(_prev_marker_x - mark_size, _prev_marker_y + mark_size,
+                          _prev_marker_x + mark_size, _prev_marker_y - mark_size, BLACK);
+        }
     }
 
     // Draw new X marker at touch location
@@ -325,14 +1031,88 @@ void display_draw_touch_feedback(int x, int y, UIState* state) {
     }
 }
 
+// The last marker drawn reaches into the HUD box
+static bool marker_over_hud() {
+    return _prev_marker_x >= 0 && _prev_marker_y >= 0 &&
+           _prev_marker_x - MARK_SIZE < PERF_HUD_BOX_X + PERF_HUD_BOX_W &&
+           _prev_marker_y - MARK_SIZE < PERF_HUD_BOX_Y + PERF_HUD_BOX_H;
+}
+
 Arduino_GFX* display_get_gfx() {
     return gfx;
 }
 
+void display_flush() {
+    if (!_canvas || _frame_depth > 0) return;
+    if (_slide.active && map_rows_dirty()) end_slide();
+
+    wait_for_vblank();
+
+    // Nothing declared: whoever drew did it through display_get_gfx()
+    if (_dirty_full || _dirty_count == 0) {
+        _canvas->flush();
+    } else {
+        _canvas->flush(_dirty, _dirty_count);
+    }
+    _dirty_full = false;
+    _dirty_count = 0;
+}
+
+void display_damage(int x, int y, int w, int h) {
+    mark_dirty(x, y, w, h);
+}
+
+uint16_t* display_framebuffer() {
+    return _canvas ? _canvas->getFramebuffer() : nullptr;
+}
+
+// Push the map area mid-frame: a stand-in the rest of the frame replaces
+static void flush_map_now() {
+    if (!_canvas || _slide.active) return;
+    wait_for_vblank();
+    _canvas->flush(0, 0, MAP_WIDTH, MAP_HEIGHT);
+}
+
+// Map rows a streamed draw_map_view() has pushed in this frame
+static int _map_rows_pushed = 0;
+
+// Band sink for draw_map_view(): each band goes out as soon as it is done
+static void push_map_band(int y, int rows) {
+    if (!_canvas || _slide.active) return;
+    if (_map_rows_pushed == 0) wait_for_vblank();
+    _canvas->flush(0, y, MAP_WIDTH, rows);
+    _map_rows_pushed += rows;
+}
+
+// The whole map area is on the panel already: take it off the frame's
+// damage, so the flush ending the frame sends only what is drawn over it
+// (marker, HUD) and what lies below it
+static void map_area_pushed() {
+    if (_dirty_full) {
+        _dirty_full = false;
+        _dirty_count = 0;
+        mark_dirty(0, MAP_HEIGHT, LCD_WIDTH, LCD_HEIGHT - MAP_HEIGHT);
+        return;
+    }
+    int kept = 0;
+    for (int i = 0; i < _dirty_count; i++) {
+        DirtyRect r = _dirty[i];
+        int bottom = r.y + r.h;
+        if (bottom <= MAP_HEIGHT) continue;
+        if (r.y < MAP_HEIGHT) {
+            r.h = bottom - MAP_HEIGHT;
+            r.y = MAP_HEIGHT;
+        }
+        _dirty[kept++] = r;
+    }
+    _dirty_count = kept;
+}
+
 // Map view functions
 
-// Draw map area using current zoom level
-static void draw_current_map(UIState* state) {
+// Draw map area using current zoom level. stream: a cold zoomed view may
+// go to the panel band by band as it decodes (not for a slide's new map)
+static void draw_current_map(UIState* state, bool stream = true) {
     int zoom = state->get_zoom_level();
     if (zoom <= 1) {
         MapSlice& slice = state->get_current_slice();
@@ -340,13 +1120,15 @@ static void draw_current_map(UIState* state) {
             draw_map_slice(gfx, slice.bitmap, slice.bitmap_size, 0, 0);
         }
     } else {
-        char path[24];
-        snprintf(path, sizeof(path), "/maps/zoom%d.bin", zoom);
-        if (!draw_map_from_file(gfx, path, zoom,
-                                state->get_current_slice_index(),
-                                state->get_zoom_col(),
-                                state->get_zoom_row(), 0, 0)) {
-            // Fallback: draw 1x if zoom file missing
+        // Cold zoom: the old view scaled up goes out first, while the
+        // tiles decode
+        if (world_map_draw_preview(gfx, state->get_map_view(), 0, 0)) flush_map_now();
+        _map_rows_pushed = 0;
+        bool drawn = draw_map_view(gfx, state->get_map_view(), 0, 0,
+                                   stream && _canvas ? push_map_band : nullptr);
+        if (drawn && _map_rows_pushed >= MAP_HEIGHT) map_area_pushed();
+        if (!drawn) {
+            // Fallback: draw 1x if the tile pyramid is missing
             MapSlice& slice = state->get_current_slice();
             if (slice.bitmap && slice.bitmap_size > 0) {
                 draw_map_slice(gfx, slice.bitmap, slice.bitmap_size, 0, 0);
@@ -360,7 +1142,14 @@ void display_show_map_view(UIState* state) {
         Serial.println("[Display] ERROR: gfx is null!");
         return;
     }
-
+    MetricTimer timer(METRIC_RENDER_MAP);   // Declared first: includes the flush
+    DisplayFrame frame;
+
+#if !USE_BUILTIN_TOUCH
+    // Prototype 2: the map is on the wall, the panel shows what is playing
+    now_playing_show(state);
+    return;
+#endif
     Serial.println("[Display] Showing portrait map view (180x640)...");
 
     // Clear screen with black
@@ -380,89 +1169,161 @@ void display_show_map_view(UIState* state) {
     Serial.println("[Display] Portrait view complete!");
 }
 
+// ------------------------------------------------------------------
+// Play pipeline (map view status bar)
+// ------------------------------------------------------------------
+
+// A running play's stages along the bar's top edge, a segment each. While
+// the loading text is up, line 2 names them: the time each stage reached
+// took, the one being waited for in TH_TEXT, those ahead dimmed and the
+// skipped ones (a NEXT has its list already) as "-". A new stage repaints
+// these two strips only.
+static const int PIPE_CELL_W = TH_DISPLAY_W / UI_PLAY_STAGES;   // 45 px
+static const int PIPE_EDGE_H = 2;
+static const int PIPE_LINE_Y = 17;   // Line 2's band, from the bar's top
+static const int PIPE_LINE_H = 14;
+static_assert(PIPE_LINE_H == TEXT_RUN_H, "Line 2 is drawn as a text run");
+static_assert(UI_PLAY_STAGES == RADIO_STAGE_COUNT, "A pipeline cell per play stage");
+
+// Returns true if line 2 was drawn
+static bool draw_play_progress(UIState* state, int status_y) {
+    int stages = state->get_play_progress();
+    gfx->fillRect(0, status_y, TH_DISPLAY_W, PIPE_EDGE_H, TH_BG);
+    for (int i = 0; i < stages; i++) {
+        gfx->fillRect(i * PIPE_CELL_W, status_y, PIPE_CELL_W - 1, PIPE_EDGE_H, TH_ACCENT);
+    }
+    if (!state->is_play_running() || state->get_status_text()[0] == '\0') return false;
+
+    static const char* const labels[UI_PLAY_STAGES] = { "Place", "List", "URL", "WiiM" };
+    set_unicode_font();
+    text_run_begin(status_y + PIPE_LINE_Y, TH_BG);
+    uint32_t prev = 0;
+    for (int i = 0; i < UI_PLAY_STAGES; i++) {
+        uint32_t ms = state->get_play_stage_ms(i);
+        char cell[12];
+        uint16_t color = TH_TEXT_DIM;
+        if (ms) {
+            uint32_t took = ms - prev;
+            snprintf(cell, sizeof(cell), "%lu.%lus", (unsigned long)(took / 1000),
+                     (unsigned long)(took % 1000 / 100));
+            color = TH_ACCENT;
+            prev = ms;
+        } else if (i < stages) {
+            snprintf(cell, sizeof(cell), "-");
+        } else {
+            snprintf(cell, sizeof(cell), "%s", labels[i]);
+            if (i == stages) color = TH_TEXT;
+        }
+        text_run_print(i * PIPE_CELL_W + 4, cell, color);
+    }
+    text_run_end();
+    clear_unicode_font();
+    return true;
+}
+
+static void display_update_play_progress(UIState* state) {
+    const int STATUS_Y = 580;
+    DisplayFrame frame(0, STATUS_Y, TH_DISPLAY_W, PIPE_EDGE_H);
+    if (draw_play_progress(state, STATUS_Y)) {
+        display_damage(0, STATUS_Y + PIPE_LINE_Y, TH_DISPLAY_W, PIPE_LINE_H);
+    }
+}
+
 /**
  * Update status bar only (bottom 60px in portrait mode)
  */
 void display_update_status_bar(UIState* state) {
     if (!gfx) return;
-
     // Portrait mode: 180 wide x 640 tall
     const int STATUS_Y = 580;  // Status bar starts at y=580
     const int STATUS_H = 60;    // Status bar height
-
-    // Clear status bar area
-    gfx->fillRect(0, STATUS_Y, TH_DISPLAY_W, STATUS_H, TH_BG);
+    const int STATUS_TEXT_W = TH_DISPLAY_W - 8;   // 4 px margin each side
+    MetricTimer timer(METRIC_RENDER_STATUS_BAR);
+#if !USE_BUILTIN_TOUCH
+    DisplayFrame np_frame(0, 0, 0, 0);   // The scene declares what it redraws
+    now_playing_update(state);
+    return;
+#endif
+    DisplayFrame frame(0, STATUS_Y, TH_DISPLAY_W, STATUS_H);
+    const int LINE1_Y = STATUS_Y + 3;              // Text run bands (baseline +10)
+    const int LINE2_Y = STATUS_Y + PIPE_LINE_Y;
+
+    // Top edge and, while loading, line 2: how far a running play has got.
+    // The text lines bring their own background; clear only around them.
+    bool line2_drawn = draw_play_progress(state, STATUS_Y);
+    gfx->fillRect(0, STATUS_Y + PIPE_EDGE_H, TH_DISPLAY_W, LINE1_Y - STATUS_Y - PIPE_EDGE_H, TH_BG);
+    gfx->fillRect(0, LINE2_Y + TEXT_RUN_H, TH_DISPLAY_W,
+                  STATUS_H - (LINE2_Y + TEXT_RUN_H - STATUS_Y), TH_BG);
 
     gfx->setTextSize(1);
     set_unicode_font();
 
     // Line 1: City, CC (idx/total) when playing, else region name
-    // u8g2 font uses baseline coords: y=STATUS_Y+13 gives ~ascent(8)+5px padding
     const char* status_text = state->get_status_text();
     if (status_text[0] != '\0') {
-        gfx->setTextColor(MAGENTA);
-        gfx->setCursor(4, STATUS_Y + 13);
-        gfx->print(status_text);
+        text_run_line(LINE1_Y, status_text, MAGENTA);
     } else if (state->get_is_playing()) {
         // Show: "City, CC (2/5)"
-        const StationInfo* station = radio_get_current();
-        int idx = radio_get_station_index();
-        int total = radio_get_total_stations();
-        char line1[48];
-        if (station && total > 0) {
-            snprintf(line1, sizeof(line1), "%s, %s (%d/%d)",
-                     station->place, station->country, idx, total);
+        int total = state->get_station_total();
+        char line1[160];
+        if (total > 0) {
+            snprintf(line1, sizeof(line1), "%s, %s (%d/%d)", state->get_location(),
+                     state->get_country(), state->get_station_index(), total);
         } else {
             snprintf(line1, sizeof(line1), "%s", state->get_location());
         }
-        utf8_truncate(line1, 26);
-        gfx->setTextColor(TH_PLAYING);
-        gfx->setCursor(4, STATUS_Y + 13);
-        gfx->print(line1);
+        char fitted[sizeof(line1)];
+        text_layout_fit(line1, STATUS_TEXT_W, fitted, sizeof(fitted));
+        text_run_line(LINE1_Y, fitted, TH_PLAYING);
     } else {
         MapSlice& slice = state->get_current_slice();
-        gfx->setTextColor(TH_ACCENT);
-        gfx->setCursor(4, STATUS_Y + 13);
         int zoom = state->get_zoom_level();
         if (zoom > 1) {
             char zoom_label[28];
-            // Compact position labels
-            static const char* pos2x[] = {"NW", "NE", "SW", "SE"};
-            int col = state->get_zoom_col();
-            int row = state->get_zoom_row();
-            if (zoom == 2) {
-                snprintf(zoom_label, sizeof(zoom_label), "%s 2x %s",
-                         slice.name, pos2x[col * 2 + row]);
-            } else {
-                snprintf(zoom_label, sizeof(zoom_label), "%s 3x [%d,%d]",
-                         slice.name, col, row);
-            }
-            gfx->print(zoom_label);
+            snprintf(zoom_label, sizeof(zoom_label), "%s %dx", slice.name, zoom);
+            text_run_line(LINE1_Y, zoom_label, TH_ACCENT);
         } else {
-            gfx->print(slice.name);
+            text_run_line(LINE1_Y, slice.name, TH_ACCENT);
         }
     }
 
-    // Line 2: Station name or idle text
+    // Line 2: WiiM track title ("Artist - Title"), station name or idle text.
+    // A title too wide for the bar scrolls (marquee) instead of being cut.
+    bool marquee = false;
     if (state->get_is_playing() && status_text[0] == '\0') {
-        char line2[48];
-        strncpy(line2, state->get_station_name(), 47);
-        line2[47] = '\0';
-        utf8_truncate(line2, 26);
-        gfx->setTextColor(TH_TEXT);
-        gfx->setCursor(4, STATUS_Y + 27);
-        gfx->print(line2);
+        char line2[132];
+        const char* title = state->get_wiim_title();
+        const char* artist = state->get_wiim_artist();
+        if (title[0] && artist[0]) {
+            snprintf(line2, sizeof(line2), "%s - %s", artist, title);
+        } else {
+            snprintf(line2, sizeof(line2), "%s", title[0] ? title : state->get_station_name());
+        }
+        marquee = marquee_show(line2);
+        if (marquee) {
+            // The marquee band covers the line but for its margins
+            gfx->fillRect(0, LINE2_Y, MARQUEE_X, TEXT_RUN_H, TH_BG);
+            gfx->fillRect(MARQUEE_X + MARQUEE_W, LINE2_Y, TH_DISPLAY_W - MARQUEE_X - MARQUEE_W,
+                          TEXT_RUN_H, TH_BG);
+        } else {
+            char fitted[sizeof(line2)];
+            text_layout_fit(line2, STATUS_TEXT_W, fitted, sizeof(fitted));
+            text_run_line(LINE2_Y, fitted, TH_TEXT);
+        }
     } else if (!state->get_is_playing() && status_text[0] == '\0') {
-        gfx->setTextColor(TH_TEXT_SEC);
-        gfx->setCursor(4, STATUS_Y + 27);
-        gfx->print("Tap map to play");
+        text_run_line(LINE2_Y, "Tap map to play", TH_TEXT_SEC);
+    } else if (!line2_drawn) {
+        gfx->fillRect(0, LINE2_Y, TH_DISPLAY_W, TEXT_RUN_H, TH_BG);
     }
+    if (!marquee) marquee_stop();
 
     clear_unicode_font();
 
     // Line 3: MENU and NEXT icon buttons (90px each)
-    draw_status_icon_btn(0, STATUS_Y + 35, 88, 25, TH_ACCENT, icon_hamburger);
-    draw_status_icon_btn(90, STATUS_Y + 35, 90, 25, TH_ACCENT, icon_next_arrow);
+    draw_status_icon_btn(0, STATUS_Y + 35, 88, 25, TH_ACCENT, icon_hamburger,
+                         CHROME_SPRITE(BTN_MENU));
+    draw_status_icon_btn(90, STATUS_Y + 35, 90, 25, TH_ACCENT, icon_next_arrow,
+                         CHROME_SPRITE(BTN_NEXT));
 }
 
 /**
@@ -470,6 +1331,12 @@ void display_update_status_bar(UIState* state) {
  */
 void display_refresh_map_only(UIState* state) {
     if (!gfx || !state) return;
+#if !USE_BUILTIN_TOUCH
+    DisplayFrame np_frame;
+    now_playing_show(state);
+    return;
+#endif
+    DisplayFrame frame(0, 0, 180, 580);
 
     Serial.println("[Display] Refreshing map area...");
 
@@ -482,11 +1349,42 @@ void display_refresh_map_only(UIState* state) {
     Serial.println("[Display] Map refresh complete");
 }
 
+void display_slide_map(UIState* state, int step) {
+    if (!gfx || !state) return;
+#if !USE_BUILTIN_TOUCH
+    return;   // Nothing of the region is shown
+#endif
+    if (_canvas && !_slide_old) {
+        _slide_old = (uint16_t*)ps_malloc((size_t)LCD_WIDTH * MAP_HEIGHT * sizeof(uint16_t));
+    }
+    if (!_canvas || !_slide_old || _power != POWER_ACTIVE) {
+        display_refresh_map_only(state);
+        return;
+    }
+    MetricTimer timer(METRIC_RENDER_MAP);
+
+    // A slide still running jumps to its end: that is the map to push aside
+    end_slide();
+    memcpy(_slide_old, _canvas->getFramebuffer(), (size_t)LCD_WIDTH * MAP_HEIGHT * sizeof(uint16_t));
+
+    gfx->fillRect(0, 0, LCD_WIDTH, MAP_HEIGHT, BLACK);
+    draw_current_map(state, false);
+
+    _slide.active = true;
+    _slide.step = step > 0 ? 1 : -1;
+    _slide.start_ms = millis();
+    _slide.shown = 0;
+    _slide.frames = 0;
+    loop_events_due_in(0);
+}
+
 /**
  * Show full menu view (menu items + status bar)
  */
 void display_show_menu_view(UIState* state) {
     if (!gfx) return;
+    MetricTimer timer(METRIC_RENDER_MENU);
+    DisplayFrame frame;
 
     Serial.println("[Display] Showing menu view...");
 
@@ -501,14 +1399,15 @@ void display_show_menu_view(UIState* state) {
  */
 void display_update_status_bar_menu(UIState* state) {
     if (!gfx) return;
-
     const int STATUS_Y = 580;
     const int STATUS_H = 60;
+    DisplayFrame frame(0, STATUS_Y, TH_DISPLAY_W, STATUS_H);
 
     gfx->fillRect(0, STATUS_Y, TH_DISPLAY_W, STATUS_H, TH_BG);
 
     // Full-width BACK button
-    draw_status_icon_btn(0, STATUS_Y + 18, TH_DISPLAY_W, 28, TH_ACCENT, icon_back_arrow);
+    draw_status_icon_btn(0, STATUS_Y + 18, TH_DISPLAY_W, 28, TH_ACCENT, icon_back_arrow,
+                         CHROME_SPRITE(BTN_BACK_WIDE));
 }
 
 // ------------------------------------------------------------------
@@ -521,14 +1420,36 @@ static const int VOL_SLIDER_W = 100;
 static const int VOL_SLIDER_TOP = 70;
 static const int VOL_SLIDER_BOTTOM = 560;
 static const int VOL_SLIDER_H = VOL_SLIDER_BOTTOM - VOL_SLIDER_TOP;  // 490
+// Percentage text above the slider, cleared and redrawn with it
+static const int VOL_TEXT_X = 30;
+static const int VOL_TEXT_Y = 38;
+static const int VOL_TEXT_W = 120;
+static const int VOL_TEXT_H = 26;
+static int _vol_fill_y = -1;   // Fill edge last drawn, -1 = slider not on screen
+static int _vol_drawn = -1;    // Level last drawn
+static uint32_t _vol_frame_ms = 0;
+static const uint32_t VOLUME_FRAME_MS = 16;   // 60 Hz while the slider is dragged
+
+// A drag moves the slider every touch sample, faster than the panel
+// refreshes. Its frames go out at a fixed cadence instead, each drawn from
+// the latest level; until the next one is due the redraw waits.
+static bool volume_frame_due() {
+    uint32_t since = millis() - _vol_frame_ms;
+    if (since >= VOLUME_FRAME_MS) return true;
+    loop_events_due_in(VOLUME_FRAME_MS - since);
+    return false;
+}
 
 /**
  * Show full volume control view
  */
 void display_show_volume_view(UIState* state) {
     if (!gfx) return;
+    MetricTimer timer(METRIC_RENDER_VOLUME);
+    DisplayFrame frame;
 
     Serial.println("[Display] Showing volume view...");
+    _vol_fill_y = -1;
 
     gfx->fillScreen(BLACK);
 
@@ -547,8 +1468,10 @@ void display_show_volume_view(UIState* state) {
     const int STATUS_Y = 580;
     gfx->fillRect(0, STATUS_Y, TH_DISPLAY_W, 60, TH_BG);
 
-    draw_status_icon_btn(0, STATUS_Y + 18, 88, 28, TH_ACCENT, icon_back_arrow);
-    draw_status_icon_btn(90, STATUS_Y + 18, 90, 28, TH_ACCENT, icon_mute);
+    draw_status_icon_btn(0, STATUS_Y + 18, 88, 28, TH_ACCENT, icon_back_arrow,
+                         CHROME_SPRITE(BTN_BACK));
+    draw_status_icon_btn(90, STATUS_Y + 18, 90, 28, TH_ACCENT, icon_mute,
+                         CHROME_SPRITE(BTN_MUTE));
 
     Serial.println("[Display] Volume view complete!");
 }
@@ -560,11 +1483,26 @@ void display_update_volume_bar(UIState* state) {
     if (!gfx) return;
 
     int vol = state->get_volume();
+    if (vol == _vol_drawn && _vol_fill_y >= 0) return;
+    _vol_drawn = vol;
+    _vol_frame_ms = millis();
 
     // Calculate fill height (bottom-up)
     int fill_h = (int)((vol / 100.0f) * VOL_SLIDER_H);
     int fill_y = VOL_SLIDER_BOTTOM - fill_h;
 
+    // Only the band between the old and new fill edge changes, plus the
+    // rounded corners around it (2r: a part shorter than that shrinks its radius)
+    int band_top = VOL_SLIDER_TOP;
+    int band_bottom = VOL_SLIDER_BOTTOM;
+    if (_vol_fill_y >= 0) {
+        band_top = max(VOL_SLIDER_TOP, min(_vol_fill_y, fill_y) - 2 * TH_CORNER_R);
+        band_bottom = min(VOL_SLIDER_BOTTOM, max(_vol_fill_y, fill_y) + 2 * TH_CORNER_R);
+    }
+    _vol_fill_y = fill_y;
+    DisplayFrame frame(VOL_SLIDER_X, band_top, VOL_SLIDER_W, band_bottom - band_top);
+    mark_dirty(VOL_TEXT_X, VOL_TEXT_Y, VOL_TEXT_W, VOL_TEXT_H);
+
     // Empty part (dark card color)
     if (fill_y > VOL_SLIDER_TOP) {
         gfx->fillRoundRect(VOL_SLIDER_X, VOL_SLIDER_TOP, VOL_SLIDER_W,
@@ -578,7 +1516,7 @@ void display_update_volume_bar(UIState* state) {
     }
 
     // Update percentage text (FreeSansBold)
-    gfx->fillRect(30, 38, 120, 26, TH_BG);
+    gfx->fillRect(VOL_TEXT_X, VOL_TEXT_Y, VOL_TEXT_W, VOL_TEXT_H, TH_BG);
     gfx->setFont(&FreeSansBold10pt7b);
     gfx->setTextSize(1);
     gfx->setTextColor(TH_TEXT);
@@ -600,17 +1538,21 @@ void display_update_volume_bar(UIState* state) {
 
 void display_show_favorites_view(UIState* state) {
     if (!gfx) return;
+    MetricTimer timer(METRIC_RENDER_FAVORITES);
+    DisplayFrame frame;
 
     Serial.println("[Display] Showing favorites view...");
 
-    favorites_render(gfx, favorites_get_page());
+    favorites_render(gfx);
 
     // Status bar: BACK + ADD icons
     const int STATUS_Y = 580;
     gfx->fillRect(0, STATUS_Y, TH_DISPLAY_W, 60, TH_BG);
 
-    draw_status_icon_btn(0, STATUS_Y + 18, 88, 28, TH_ACCENT, icon_back_arrow);
-    draw_status_icon_btn(90, STATUS_Y + 18, 90, 28, TH_ACCENT, icon_plus);
+    draw_status_icon_btn(0, STATUS_Y + 18, 88, 28, TH_ACCENT, icon_back_arrow,
+                         CHROME_SPRITE(BTN_BACK));
+    draw_status_icon_btn(90, STATUS_Y + 18, 90, 28, TH_ACCENT, icon_plus,
+                         CHROME_SPRITE(BTN_PLUS));
 }
 
 // ------------------------------------------------------------------
@@ -619,17 +1561,21 @@ void display_show_favorites_view(UIState* state) {
 
 void display_show_history_view(UIState* state) {
     if (!gfx) return;
+    MetricTimer timer(METRIC_RENDER_HISTORY);
+    DisplayFrame frame;
 
     Serial.println("[Display] Showing history view...");
 
-    history_render(gfx, history_get_page());
+    history_render(gfx);
 
     // Status bar: BACK + CLEAR icons
     const int STATUS_Y = 580;
     gfx->fillRect(0, STATUS_Y, TH_DISPLAY_W, 60, TH_BG);
 
-    draw_status_icon_btn(0, STATUS_Y + 18, 88, 28, TH_ACCENT, icon_back_arrow);
-    draw_status_icon_btn(90, STATUS_Y + 18, 90, 28, TH_DANGER, icon_x_mark);
+    draw_status_icon_btn(0, STATUS_Y + 18, 88, 28, TH_ACCENT, icon_back_arrow,
+                         CHROME_SPRITE(BTN_BACK));
+    draw_status_icon_btn(90, STATUS_Y + 18, 90, 28, TH_DANGER, icon_x_mark,
+                         CHROME_SPRITE(BTN_CLEAR));
 }
 
 // ------------------------------------------------------------------
@@ -638,6 +1584,8 @@ void display_show_history_view(UIState* state) {
 
 void display_show_settings_view(UIState* state) {
     if (!gfx) return;
+    MetricTimer timer(METRIC_RENDER_SETTINGS);
+    DisplayFrame frame;
 
     Serial.println("[Display] Showing settings view...");
 
@@ -649,22 +1597,27 @@ void display_show_settings_view(UIState* state) {
 
 void display_update_status_bar_settings(UIState* state) {
     if (!gfx) return;
-
     const int STATUS_Y = 580;
+    DisplayFrame frame(0, STATUS_Y, TH_DISPLAY_W, 60);
     gfx->fillRect(0, STATUS_Y, TH_DISPLAY_W, 60, TH_BG);
 
     // Full-width BACK button
-    draw_status_icon_btn(0, STATUS_Y + 18, TH_DISPLAY_W, 28, TH_ACCENT, icon_back_arrow);
+    draw_status_icon_btn(0, STATUS_Y + 18, TH_DISPLAY_W, 28, TH_ACCENT, icon_back_arrow,
+                         CHROME_SPRITE(BTN_BACK_WIDE));
 }
 
 void display_show_settings_wifi_view(UIState* state) {
     if (!gfx) return;
+    MetricTimer timer(METRIC_RENDER_SETTINGS);
+    DisplayFrame frame;
     settings_wifi_render(gfx);
     display_update_status_bar_settings(state);
 }
 
 void display_show_settings_devices_view(UIState* state) {
     if (!gfx) return;
+    MetricTimer timer(METRIC_RENDER_SETTINGS);
+    DisplayFrame frame;
     settings_devices_render(gfx);
     display_update_status_bar_settings(state);
 }
@@ -676,25 +1629,11 @@ void display_show_settings_devices_view(UIState* state) {
 void display_draw_marker_at_latlon(float lat, float lon, UIState* state) {
     if (!gfx || !state) return;
 
-    // Use zoom-aware geographic bounds
-    float lon_min = state->get_view_lon_min();
-    float lon_max = state->get_view_lon_max();
-    float lat_max = state->get_view_lat_max();
-    float lat_min = state->get_view_lat_min();
-
-    float lon_range = lon_max - lon_min;
-    if (lon_range < 0) lon_range += 360.0f;
-
-    float norm_lon = lon - lon_min;
-    if (norm_lon < 0) norm_lon += 360.0f;
-    float norm_x = norm_lon / lon_range;
-    float norm_y = (lat_max - lat) / (lat_max - lat_min);
-
     // Only draw if marker is within current view
-    if (norm_x < 0.0f || norm_x > 1.0f || norm_y < 0.0f || norm_y > 1.0f) return;
-
-    int portrait_x = constrain((int)(norm_x * 179), 0, 179);
-    int portrait_y = constrain((int)(norm_y * 579), 0, 579);
+    int portrait_x, portrait_y;
+    if (!state->project(lroundf(lat * 100.0f), lroundf(lon * 100.0f), &portrait_x, &portrait_y)) {
+        return;
+    }
 
     display_draw_touch_feedback(portrait_x, portrait_y, state);
 }
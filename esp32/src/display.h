@@ -19,12 +19,15 @@ void display_loop();
 void display_show_nowplaying(const char* station, const char* location, const char* country);
 void display_show_status(const char* status);
 void display_show_connecting();
-void display_show_wifi_portal(bool show_cancel = false);
 
 // Map view functions
 void display_show_map_view(UIState* state);         // Full redraw
 void display_update_status_bar(UIState* state);     // Status bar only
 void display_refresh_map_only(UIState* state);      // Map area only
+// Map area only, sliding the new map in from the right (step > 0) or the
+// left (step < 0) over the next loop passes. Without a framebuffer it
+// redraws like display_refresh_map_only.
+void display_slide_map(UIState* state, int step);
 
 // Menu view functions
 void display_show_menu_view(UIState* state);
@@ -48,13 +51,45 @@ void display_update_status_bar_settings(UIState* state);
 void display_show_settings_wifi_view(UIState* state);
 void display_show_settings_devices_view(UIState* state);
 
+// Frame scheduler: callers mark what changed with display_invalidate() and
+// display_render() draws the final state once per loop pass, so a press and
+// the events it causes in one pass cost one draw and one flush. Parts are
+// relative to the current view; VIEW covers them all.
+enum DisplayPart : uint8_t {
+    DISPLAY_PART_STATUS = 0x01,   // Status bar (map, menu and settings views)
+    DISPLAY_PART_MARKER = 0x02,   // Station marker (map view)
+    DISPLAY_PART_MAP    = 0x04,   // Map area, marker included (map view)
+    DISPLAY_PART_VOLUME = 0x08,   // Slider (volume view), arc (now playing scene)
+    DISPLAY_PART_VIEW   = 0x10,   // Whole current view
+    DISPLAY_PART_HUD    = 0x20,   // Performance overlay (map view, perf_hud.h)
+    DISPLAY_PART_PROGRESS = 0x40  // Play pipeline strips of the status bar (map view)
+};
+void display_invalidate(uint8_t parts);
+void display_render(UIState* state);   // End of loop(), before sleeping
+
 // Map marker at lat/lon (converts to portrait coords using current slice)
 void display_draw_marker_at_latlon(float lat, float lon, UIState* state);
 
+// Input happened: restart the idle timer, and undo any dimming, panel idle
+// mode and reduced CPU clock at once (loop task)
 void display_wake();
+// Milliseconds since the last display_wake()
+uint32_t display_idle_ms();
 void display_draw_touch_feedback(int x, int y, UIState* state);
 
 // Get GFX instance
 Arduino_GFX* display_get_gfx();
 
+// Push the framebuffer to the panel after drawing through display_get_gfx()
+// (no-op unless built with DISPLAY_FRAMEBUFFER)
+void display_flush();
+
+// Declare a region drawn through display_get_gfx(): the next display_flush()
+// then pushes only the declared regions, so declare everything drawn
+void display_damage(int x, int y, int w, int h);
+
+// The 180x640 RGB565 framebuffer, rows contiguous, or nullptr without one.
+// For moving pixels already drawn; declare what changes with display_damage().
+uint16_t* display_framebuffer();
+
 #endif // DISPLAY_H
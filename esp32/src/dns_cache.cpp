@@ -0,0 +1,149 @@
+/**
+ * Hostname cache implementation for RadioWall.
+ *
+ * lwIP keeps its own answers only for their DNS TTL, and once one lapses
+ * the next connect() waits for a new query. Here an entry stays usable
+ * for DNS_STALE_MS: after DNS_FRESH_MS the caller still gets the old
+ * address, and a lookup started through tcpip_callback() replaces it when
+ * the answer arrives (the lwIP callback runs on the tcpip thread, hence
+ * _lock). A connect failure drops the entry so the next try asks again.
+ */
+
+#include "dns_cache.h"
+#include "metrics.h"
+#include "wifi_link.h"
+#include <WiFi.h>
+#include <lwip/dns.h>
+#include <lwip/tcpip.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static const int DNS_CACHE_SIZE = 8;   // radio.garden, WiiM, probed stream hosts
+static const unsigned long DNS_FRESH_MS = 5UL * 60 * 1000;   // Refresh after this
+static const unsigned long DNS_STALE_MS = 60UL * 60 * 1000;  // Unusable after this
+
+struct DnsEntry {
+    char host[40];            // Empty: unused
+    uint32_t addr;            // 0 until the first answer
+    unsigned long resolved_at;
+    bool pending;             // Background lookup in flight (slot is pinned)
+};
+static DnsEntry _entries[DNS_CACHE_SIZE];
+static SemaphoreHandle_t _lock = xSemaphoreCreateMutex();
+
+// Entry for host, or nullptr (caller holds _lock)
+static DnsEntry* find_entry(const char* host) {
+    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+        if (strcmp(_entries[i].host, host) == 0) return &_entries[i];
+    }
+    return nullptr;
+}
+
+// Entry for host, taking an unused or the oldest idle slot (caller holds _lock)
+static DnsEntry* claim_entry(const char* host) {
+    DnsEntry* e = find_entry(host);
+    if (e) return e;
+    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+        DnsEntry& c = _entries[i];
+        if (c.pending) continue;
+        if (!e || !c.host[0] || (e->host[0] && c.resolved_at < e->resolved_at)) e = &c;
+    }
+    if (!e || strlen(host) >= sizeof(e->host)) return nullptr;
+    strcpy(e->host, host);
+    e->addr = 0;
+    e->resolved_at = 0;
+    return e;
+}
+
+static void store(const char* host, uint32_t addr) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    DnsEntry* e = claim_entry(host);
+    if (e) {
+        e->addr = addr;
+        e->resolved_at = millis();
+    }
+    xSemaphoreGive(_lock);
+}
+
+// ------------------------------------------------------------------
+// Background lookups (tcpip thread)
+// ------------------------------------------------------------------
+
+static void lookup_done(DnsEntry* e, const ip_addr_t* addr) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    if (addr && IP_IS_V4(addr)) {
+        e->addr = ip4_addr_get_u32(ip_2_ip4(addr));
+        e->resolved_at = millis();
+    }
+    e->pending = false;
+    xSemaphoreGive(_lock);
+    if (!addr) Serial.printf("[DNS] Lookup of %s failed\n", e->host);
+}
+
+static void on_found(const char* name, const ip_addr_t* addr, void* arg) {
+    lookup_done((DnsEntry*)arg, addr);
+}
+
+static void start_lookup(void* arg) {
+    DnsEntry* e = (DnsEntry*)arg;
+    ip_addr_t addr;
+    err_t err = dns_gethostbyname(e->host, &addr, on_found, e);
+    if (err == ERR_OK) {
+        lookup_done(e, &addr);        // lwIP still had it
+    } else if (err != ERR_INPROGRESS) {
+        lookup_done(e, nullptr);
+    }
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void dns_cache_prefetch(const char* host) {
+    IPAddress ip;
+    if (!host || !host[0] || ip.fromString(host)) return;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    DnsEntry* e = claim_entry(host);
+    bool start = e && !e->pending && (!e->addr || millis() - e->resolved_at >= DNS_FRESH_MS);
+    if (start) e->pending = true;
+    xSemaphoreGive(_lock);
+
+    if (start && tcpip_callback(start_lookup, e) != ERR_OK) lookup_done(e, nullptr);
+}
+
+bool dns_cache_resolve(const char* host, IPAddress* out) {
+    if (!host || !host[0]) return false;
+    if (out->fromString(host)) return true;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    DnsEntry* e = find_entry(host);
+    uint32_t addr = e ? e->addr : 0;
+    unsigned long age = e ? millis() - e->resolved_at : 0;
+    xSemaphoreGive(_lock);
+
+    if (addr && age < DNS_STALE_MS) {
+        metrics_inc(METRIC_DNS_CACHE_HIT);
+        if (age >= DNS_FRESH_MS) dns_cache_prefetch(host);
+        *out = IPAddress(addr);
+        return true;
+    }
+
+    metrics_inc(METRIC_DNS_CACHE_MISS);
+    if (!wifi_link_up()) return false;
+    unsigned long start = millis();
+    if (!WiFi.hostByName(host, *out) || (uint32_t)*out == 0) {
+        Serial.printf("[DNS] Cannot resolve %s\n", host);
+        return false;
+    }
+    store(host, (uint32_t)*out);
+    Serial.printf("[DNS] %s -> %s in %lu ms\n", host, out->toString().c_str(), millis() - start);
+    return true;
+}
+
+void dns_cache_invalidate(const char* host) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    DnsEntry* e = find_entry(host);
+    if (e) e->addr = 0;
+    xSemaphoreGive(_lock);
+}
@@ -0,0 +1,28 @@
+/**
+ * Hostname cache for RadioWall's outbound HTTPS hosts.
+ *
+ * Keeps the address of each host the clients connect to (radio.garden,
+ * the data update host, any later provider), so a tap never waits on a
+ * DNS round trip: a fresh entry is used as is, an old one is used while a
+ * background lookup refreshes it, and only an unknown host blocks.
+ */
+
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <Arduino.h>
+
+class IPAddress;
+
+// Address of host (a name or a dotted IP). Blocks on a lookup only when
+// the host has no usable entry. False if it cannot be resolved.
+bool dns_cache_resolve(const char* host, IPAddress* out);
+
+// Start resolving host in the background (any task; needs the network up).
+// Does nothing if a fresh entry or a lookup is already there.
+void dns_cache_prefetch(const char* host);
+
+// Forget host's address, e.g. after connecting to it failed
+void dns_cache_invalidate(const char* host);
+
+#endif // DNS_CACHE_H
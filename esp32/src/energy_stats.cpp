@@ -0,0 +1,262 @@
+/**
+ * Energy and CPU accounting implementation for RadioWall.
+ *
+ * On-times are kept as a total plus the start of the current stretch, on
+ * the 64-bit esp_timer clock so a frame left running for months does not
+ * wrap. Display edges come from the loop task, WiFi edges from the event
+ * task, charger samples from the touch reader and reads from the metrics
+ * task, so everything shared is under _mux.
+ */
+
+#include "energy_stats.h"
+#include "serial_cmd.h"
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/timers.h>
+
+static const uint32_t FOLD_MS = 10UL * 60 * 1000;   // Well inside a 32-bit counter's wrap
+static const char* const PART_NAMES[ENERGY_PART_COUNT] = {
+    "display_lit", "display_dim", "wifi_on", "wifi_connected"};
+
+static uint64_t _on_total_ms[ENERGY_PART_COUNT] = {};
+static uint64_t _on_since_ms[ENERGY_PART_COUNT] = {};   // 0 = off
+static EnergyPmu _pmu = {};
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static bool _initialized = false;
+
+static uint64_t now_ms() {
+    return (uint64_t)esp_timer_get_time() / 1000 + 1;   // Never 0: that means off
+}
+
+static void start_fold_timer();
+
+// ------------------------------------------------------------------
+// On-time
+// ------------------------------------------------------------------
+
+void energy_stats_set(EnergyPart part, bool on) {
+    uint64_t now = now_ms();
+    portENTER_CRITICAL(&_mux);
+    if (on && !_on_since_ms[part]) {
+        _on_since_ms[part] = now;
+    } else if (!on && _on_since_ms[part]) {
+        _on_total_ms[part] += now - _on_since_ms[part];
+        _on_since_ms[part] = 0;
+    }
+    portEXIT_CRITICAL(&_mux);
+}
+
+uint64_t energy_stats_on_ms(EnergyPart part) {
+    uint64_t now = now_ms();
+    portENTER_CRITICAL(&_mux);
+    uint64_t total = _on_total_ms[part];
+    if (_on_since_ms[part]) total += now - _on_since_ms[part];
+    portEXIT_CRITICAL(&_mux);
+    return total;
+}
+
+// Arduino event task
+static void on_wifi_event(arduino_event_id_t event) {
+    switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_START:
+        energy_stats_set(ENERGY_WIFI_ON, true);
+        break;
+    case ARDUINO_EVENT_WIFI_STA_STOP:
+        energy_stats_set(ENERGY_WIFI_CONNECTED, false);
+        energy_stats_set(ENERGY_WIFI_ON, false);
+        break;
+    case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+        energy_stats_set(ENERGY_WIFI_CONNECTED, true);
+        break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        energy_stats_set(ENERGY_WIFI_CONNECTED, false);
+        break;
+    default:
+        break;
+    }
+}
+
+void energy_stats_init() {
+    if (_initialized) return;
+    _initialized = true;
+    WiFi.onEvent(on_wifi_event, ARDUINO_EVENT_WIFI_STA_START);
+    WiFi.onEvent(on_wifi_event, ARDUINO_EVENT_WIFI_STA_STOP);
+    WiFi.onEvent(on_wifi_event, ARDUINO_EVENT_WIFI_STA_CONNECTED);
+    WiFi.onEvent(on_wifi_event, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    start_fold_timer();
+}
+
+// ------------------------------------------------------------------
+// Charger
+// ------------------------------------------------------------------
+
+void energy_stats_record_pmu(uint16_t battery_mv, uint16_t system_mv,
+                             uint16_t vbus_mv, uint16_t charge_ma) {
+    uint32_t now_s = millis() / 1000;
+    portENTER_CRITICAL(&_mux);
+    // Rectangle rule: the previous reading held until this one
+    if (_pmu.valid) _pmu.charged_mah += _pmu.charge_ma * (now_s - _pmu.at_s) / 3600.0f;
+    _pmu.valid = true;
+    _pmu.battery_mv = battery_mv;
+    _pmu.system_mv = system_mv;
+    _pmu.vbus_mv = vbus_mv;
+    _pmu.charge_ma = charge_ma;
+    _pmu.samples++;
+    _pmu.at_s = now_s;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void energy_stats_get_pmu(EnergyPmu* out) {
+    portENTER_CRITICAL(&_mux);
+    *out = _pmu;
+    portEXIT_CRITICAL(&_mux);
+}
+
+// ------------------------------------------------------------------
+// CPU time per task
+// ------------------------------------------------------------------
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+
+#ifdef configRUN_TIME_COUNTER_TYPE
+typedef configRUN_TIME_COUNTER_TYPE RunTime;
+#else
+typedef uint32_t RunTime;   // IDF 4.4: wraps after 71 min of esp_timer us
+#endif
+
+struct TaskClock {
+    TaskHandle_t handle;       // nullptr = free slot
+    char name[16];
+    RunTime last;              // Counter at the last fold
+    uint64_t total_us;
+};
+
+static TaskClock _clocks[ENERGY_MAX_TASKS];
+static RunTime _last_total = 0;
+static uint64_t _total_us = 0;
+static TimerHandle_t _fold_timer = nullptr;
+
+// Fold the counters into 64-bit totals; called more often than they wrap.
+// Callers on different tasks may interleave, so a snapshot older than the
+// last one folded is dropped.
+static void fold_run_times() {
+    TaskStatus_t* status = (TaskStatus_t*)malloc(sizeof(TaskStatus_t) * ENERGY_MAX_TASKS);
+    if (!status) return;
+    RunTime total = 0;
+    UBaseType_t n = uxTaskGetSystemState(status, ENERGY_MAX_TASKS, &total);
+
+    portENTER_CRITICAL(&_mux);
+    if (n > 0 && (int32_t)(total - _last_total) > 0) {
+        _total_us += (RunTime)(total - _last_total);
+        _last_total = total;
+        bool seen[ENERGY_MAX_TASKS] = {};
+        for (UBaseType_t i = 0; i < n; i++) {
+            int slot = -1, free_slot = -1;
+            for (int j = 0; j < ENERGY_MAX_TASKS && slot < 0; j++) {
+                if (_clocks[j].handle == status[i].xHandle) slot = j;
+                else if (!_clocks[j].handle && free_slot < 0) free_slot = j;
+            }
+            if (slot < 0) {
+                if (free_slot < 0) continue;
+                slot = free_slot;
+                TaskClock& c = _clocks[slot];
+                c.handle = status[i].xHandle;
+                strncpy(c.name, status[i].pcTaskName, sizeof(c.name) - 1);
+                c.name[sizeof(c.name) - 1] = '\0';
+                c.last = 0;   // Created since the last fold: all of it is new
+                c.total_us = 0;
+            }
+            TaskClock& c = _clocks[slot];
+            c.total_us += (RunTime)(status[i].ulRunTimeCounter - c.last);
+            c.last = status[i].ulRunTimeCounter;
+            seen[slot] = true;
+        }
+        // Deleted tasks: their time stays in the total only
+        for (int j = 0; j < ENERGY_MAX_TASKS; j++) {
+            if (!seen[j]) _clocks[j].handle = nullptr;
+        }
+    }
+    portEXIT_CRITICAL(&_mux);
+    free(status);
+}
+
+static void on_fold_timer(TimerHandle_t) {
+    fold_run_times();
+}
+
+static void start_fold_timer() {
+    _fold_timer = xTimerCreate("energy", pdMS_TO_TICKS(FOLD_MS), pdTRUE, nullptr, on_fold_timer);
+    if (!_fold_timer || xTimerStart(_fold_timer, 0) != pdPASS) {
+        Serial.println("[Energy] Failed to start run-time timer; CPU times wrap after 71 min");
+    }
+}
+
+int energy_stats_get_tasks(EnergyTask* out, int max) {
+    fold_run_times();
+    int count = 0;
+    portENTER_CRITICAL(&_mux);
+    for (int j = 0; j < ENERGY_MAX_TASKS && count < max; j++) {
+        const TaskClock& c = _clocks[j];
+        if (!c.handle) continue;
+        EnergyTask& t = out[count++];
+        memcpy(t.name, c.name, sizeof(t.name));
+        t.runtime_us = c.total_us;
+        // The total is wall time, so each core's tasks add up to 100%
+        t.percent = _total_us ? (uint8_t)min<uint64_t>(100, c.total_us * 100 / _total_us) : 0;
+    }
+    portEXIT_CRITICAL(&_mux);
+    return count;
+}
+
+#else
+
+static void start_fold_timer() {}
+
+int energy_stats_get_tasks(EnergyTask*, int) {
+    return -1;
+}
+
+#endif
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+// ENERGY - On-times, charger readings and CPU time per task since boot
+static void cmd_energy(const char*) {
+    uint32_t up_s = millis() / 1000;
+    Serial.printf("[Energy] Up %lu s\n", (unsigned long)up_s);
+    for (int i = 0; i < ENERGY_PART_COUNT; i++) {
+        uint64_t on_s = energy_stats_on_ms((EnergyPart)i) / 1000;
+        Serial.printf("[Energy] %-14s %8lu s (%lu%%)\n", PART_NAMES[i], (unsigned long)on_s,
+                      up_s ? (unsigned long)(on_s * 100 / up_s) : 0UL);
+    }
+
+    EnergyPmu pmu;
+    energy_stats_get_pmu(&pmu);
+    if (pmu.valid) {
+        Serial.printf("[Energy] Battery %u mV, system %u mV, VBUS %u mV, charging %u mA "
+                      "(%.1f mAh since boot, %lu s ago)\n",
+                      pmu.battery_mv, pmu.system_mv, pmu.vbus_mv, pmu.charge_ma,
+                      pmu.charged_mah, (unsigned long)(up_s - pmu.at_s));
+    } else {
+        Serial.println("[Energy] No charger readings (built-in touch backend only)");
+    }
+
+    static EnergyTask tasks[ENERGY_MAX_TASKS];
+    int n = energy_stats_get_tasks(tasks, ENERGY_MAX_TASKS);
+    if (n < 0) {
+        Serial.println("[Energy] No CPU time per task (needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)");
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        Serial.printf("[Energy] %-16s %10llu us %3u%%\n", tasks[i].name,
+                      (unsigned long long)tasks[i].runtime_us, tasks[i].percent);
+    }
+}
+
+void energy_stats_serial_init() {
+    serial_cmd_register("ENERGY", cmd_energy);
+}
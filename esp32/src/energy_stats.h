@@ -0,0 +1,76 @@
+/**
+ * Energy and CPU accounting for RadioWall.
+ *
+ * Where the battery goes, from boot: CPU time per FreeRTOS task (each
+ * subsystem runs in its own: loopTask is the UI, touch_reader, net_worker,
+ * wifi and tiT the network stack, IDLE0/1 the headroom), how long the
+ * backlight and the WiFi radio have been on, and the charger's own
+ * readings of the battery, system and VBUS rails.
+ *
+ * The SY6970 measures only the current into the battery, never out of it,
+ * so a frame on battery shows 0 mA; its discharge has to be judged from
+ * the battery voltage over time and the on-times here.
+ *
+ * Figures run from boot, for the metrics endpoint and the ENERGY serial
+ * command; a scraper diffs successive reads.
+ */
+
+#ifndef ENERGY_STATS_H
+#define ENERGY_STATS_H
+
+#include <Arduino.h>
+
+static const int ENERGY_MAX_TASKS = 32;   // Tasks tracked (about 20 run)
+
+// Parts whose on-time is accumulated
+enum EnergyPart {
+    ENERGY_DISPLAY_LIT,        // Backlight on (full or dimmed)
+    ENERGY_DISPLAY_DIM,        // Backlight at DISPLAY_BRIGHTNESS_DIM
+    ENERGY_WIFI_ON,            // STA started: radio on, dozing between beacons in modem sleep
+    ENERGY_WIFI_CONNECTED,     // Associated with the AP
+    ENERGY_PART_COUNT
+};
+
+// Charger readings (SY6970 ADC)
+struct EnergyPmu {
+    bool valid;                // False until the first sample (or no PMU)
+    uint16_t battery_mv;
+    uint16_t system_mv;
+    uint16_t vbus_mv;          // Reads the ADC floor (2600) with no USB power
+    uint16_t charge_ma;        // Into the battery; 0 when not charging
+    float charged_mah;         // Charge current integrated over the samples
+    uint32_t samples;
+    uint32_t at_s;             // Uptime of the last sample
+};
+
+// One task's CPU time since boot
+struct EnergyTask {
+    char name[16];
+    uint64_t runtime_us;
+    uint8_t percent;           // Of one core's time since boot
+};
+
+// Start the WiFi radio accounting (setup(), before WiFi starts)
+void energy_stats_init();
+
+// A part turned on or off (repeats of the same state do nothing)
+void energy_stats_set(EnergyPart part, bool on);
+
+// Time a part has been on since boot, the current stretch included
+uint64_t energy_stats_on_ms(EnergyPart part);
+
+// Store a charger sample (touch reader task, the I2C bus owner)
+void energy_stats_record_pmu(uint16_t battery_mv, uint16_t system_mv,
+                             uint16_t vbus_mv, uint16_t charge_ma);
+
+// Copy of the last charger sample
+void energy_stats_get_pmu(EnergyPmu* out);
+
+// Up to max tasks with their CPU time; -1 if this build keeps no FreeRTOS
+// run-time stats (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+int energy_stats_get_tasks(EnergyTask* out, int max);
+
+// Register the ENERGY serial command
+void energy_stats_serial_init();
+
+#endif // ENERGY_STATS_H
@@ -0,0 +1,216 @@
+/**
+ * Input event bus implementation for RadioWall.
+ *
+ * The ring is Vyukov's bounded queue with the sequence numbers kept
+ * relative to the lap: a slot is free for position p when its sequence is
+ * p's lap start (p & ~mask), full once it is the lap start + 1, and the
+ * consumer frees it for the next lap by adding BUS_CAPACITY. All zeros is
+ * the empty ring, so there is nothing to initialise. A producer that finds
+ * its slot still full from the previous lap drops the event.
+ *
+ * Only the loop task drains, so the stats are plain fields; the drop
+ * counts are bumped by producers and are atomic.
+ */
+
+#include "event_bus.h"
+#include "loop_events.h"
+#include "serial_cmd.h"
+#include <atomic>
+
+static const uint32_t MASK = BUS_CAPACITY - 1;
+static const int LATENCY_BUCKETS = 12;    // Powers of two from 1 us; the last is open
+
+struct BusSlot {
+    std::atomic<uint32_t> seq;
+    BusEvent event;
+};
+
+static BusSlot _slots[BUS_CAPACITY];
+static std::atomic<uint32_t> _head{0};    // Next position to claim (producers)
+static uint32_t _tail = 0;                // Next position to run (loop task)
+
+struct BusTypeStats {
+    uint32_t count;
+    uint32_t wait_total_us;
+    uint32_t wait_max_us;
+    uint32_t run_max_us;
+};
+
+static BusTypeStats _stats[BUS_EVENT_COUNT];
+static std::atomic<uint32_t> _dropped[BUS_EVENT_COUNT];
+static uint32_t _wait_buckets[LATENCY_BUCKETS];   // All types
+static uint32_t _batches = 0;
+static uint32_t _depth_max = 0;
+
+static const char* const TYPE_NAMES[BUS_EVENT_COUNT] = {
+    "map_touch", "map_location", "tap_pending", "double_tap", "pinch_zoom", "scrub",
+    "ui_button", "menu_touch", "swipe", "volume", "list_scroll", "button_short",
+    "button_long", "button_double", "menu_item", "favorite_play", "favorite_delete",
+    "history_play", "web_command",
+};
+
+// ------------------------------------------------------------------
+// Producers
+// ------------------------------------------------------------------
+
+bool event_bus_post(BusEvent event) {
+    event.posted_us = micros();
+    uint32_t pos = _head.load(std::memory_order_relaxed);
+    BusSlot* slot;
+    for (;;) {
+        slot = &_slots[pos & MASK];
+        uint32_t seq = slot->seq.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - (pos & ~MASK));
+        if (diff == 0) {
+            // Free for this lap: claim it (pos is reloaded on failure)
+            if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // Still holds the event from the lap before: full
+            if (event.type < BUS_EVENT_COUNT) {
+                _dropped[event.type].fetch_add(1, std::memory_order_relaxed);
+            }
+            return false;
+        } else {
+            pos = _head.load(std::memory_order_relaxed);   // Another producer took it
+        }
+    }
+    slot->event = event;
+    slot->seq.store((pos & ~MASK) + 1, std::memory_order_release);
+    loop_events_notify();
+    return true;
+}
+
+bool event_bus_post_value(BusEventType type, int32_t value, uint8_t phase) {
+    BusEvent e = {};
+    e.type = type;
+    e.phase = phase;
+    e.value = value;
+    return event_bus_post(e);
+}
+
+bool event_bus_post_point(BusEventType type, int x, int y, int32_t value) {
+    BusEvent e = {};
+    e.type = type;
+    e.x = x;
+    e.y = y;
+    e.value = value;
+    return event_bus_post(e);
+}
+
+bool event_bus_post_location(BusEventType type, float lat, float lon, uint8_t phase) {
+    BusEvent e = {};
+    e.type = type;
+    e.phase = phase;
+    e.lat = lat;
+    e.lon = lon;
+    return event_bus_post(e);
+}
+
+// ------------------------------------------------------------------
+// Consumer (loop task)
+// ------------------------------------------------------------------
+
+// Up to max events off the ring, oldest first
+static int take_batch(BusEvent* out, int max) {
+    int n = 0;
+    while (n < max) {
+        BusSlot& slot = _slots[_tail & MASK];
+        uint32_t lap = _tail & ~MASK;
+        if (slot.seq.load(std::memory_order_acquire) != lap + 1) break;   // Empty, or not yet written
+        out[n++] = slot.event;
+        slot.seq.store(lap + BUS_CAPACITY, std::memory_order_release);
+        _tail++;
+    }
+    return n;
+}
+
+static void record(const BusEvent& e, uint32_t start_us, uint32_t end_us) {
+    if (e.type >= BUS_EVENT_COUNT) return;
+    uint32_t wait = start_us - e.posted_us;
+    uint32_t run = end_us - start_us;
+    BusTypeStats& st = _stats[e.type];
+    st.count++;
+    st.wait_total_us += wait;
+    if (wait > st.wait_max_us) st.wait_max_us = wait;
+    if (run > st.run_max_us) st.run_max_us = run;
+    int b = 0;
+    while (b < LATENCY_BUCKETS - 1 && wait >= (1UL << b)) b++;
+    _wait_buckets[b]++;
+}
+
+int event_bus_drain(BusHandler handler) {
+    uint32_t depth = _head.load(std::memory_order_relaxed) - _tail;
+    if (depth > _depth_max) _depth_max = depth;
+
+    BusEvent batch[BUS_BATCH];
+    int total = 0;
+    while (total < (int)BUS_CAPACITY) {
+        int n = take_batch(batch, BUS_BATCH);
+        if (n == 0) break;
+        _batches++;
+        for (int i = 0; i < n; i++) {
+            uint32_t start = micros();
+            handler(batch[i]);
+            record(batch[i], start, micros());
+        }
+        total += n;
+    }
+    return total;
+}
+
+const char* event_bus_type_name(BusEventType type) {
+    return type < BUS_EVENT_COUNT ? TYPE_NAMES[type] : "?";
+}
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+// Upper edge of the bucket the p-th percentile falls in (us)
+static uint32_t wait_percentile(uint32_t total, int p) {
+    uint32_t want = (total * p + 99) / 100;
+    uint32_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += _wait_buckets[b];
+        if (seen >= want) return 1UL << b;
+    }
+    return 1UL << (LATENCY_BUCKETS - 1);
+}
+
+static void cmd_bus(const char* args) {
+    if (strcmp(args, "reset") == 0) {
+        memset(_stats, 0, sizeof(_stats));
+        memset(_wait_buckets, 0, sizeof(_wait_buckets));
+        for (auto& d : _dropped) d.store(0, std::memory_order_relaxed);
+        _batches = 0;
+        _depth_max = 0;
+        Serial.println("[Bus] Stats cleared");
+        return;
+    }
+
+    uint32_t total = 0;
+    for (const BusTypeStats& st : _stats) total += st.count;
+    Serial.printf("[Bus] %lu events in %lu batches, deepest %lu of %lu\n",
+                  (unsigned long)total, (unsigned long)_batches,
+                  (unsigned long)_depth_max, (unsigned long)BUS_CAPACITY);
+    if (total > 0) {
+        Serial.printf("[Bus] Wait p50 <%lu us, p99 <%lu us\n",
+                      (unsigned long)wait_percentile(total, 50),
+                      (unsigned long)wait_percentile(total, 99));
+    }
+    Serial.println("[Bus]   type             count  dropped  wait avg/max us  run max us");
+    for (int t = 0; t < BUS_EVENT_COUNT; t++) {
+        const BusTypeStats& st = _stats[t];
+        uint32_t dropped = _dropped[t].load(std::memory_order_relaxed);
+        if (!st.count && !dropped) continue;
+        Serial.printf("[Bus]   %-15s %6lu  %7lu  %7lu/%-7lu  %10lu\n", TYPE_NAMES[t],
+                      (unsigned long)st.count, (unsigned long)dropped,
+                      (unsigned long)(st.count ? st.wait_total_us / st.count : 0),
+                      (unsigned long)st.wait_max_us, (unsigned long)st.run_max_us);
+    }
+}
+
+void event_bus_serial_init() {
+    serial_cmd_register("BUS", cmd_bus);
+    serial_cmd_register("BUS:", cmd_bus);
+}
@@ -0,0 +1,82 @@
+/**
+ * Input event bus for RadioWall.
+ *
+ * Everything the user does reaches main.cpp here: touch gestures (built-in
+ * panel or USB overlay), the button, taps in the menu, favorites and
+ * history lists, web remote commands and storm taps (net_fault.h). A
+ * producer fills a fixed-size BusEvent and posts it; the loop task drains
+ * the bus in batches and hands each event to one handler. Producers never
+ * block and never run the handler themselves, so a touch reader or the
+ * AsyncTCP task on the other core only pays for a few stores.
+ *
+ * The queue is a bounded lock-free multi-producer / single-consumer ring
+ * (every slot has a sequence number; producers claim slots with a
+ * compare-and-swap on the head). When it is full the event is dropped and
+ * counted, never waited for. A post wakes the loop task (loop_events.h).
+ *
+ * Each event is stamped when posted; the drain records, per type, how
+ * long events waited and how long their handler ran. Serial "BUS" prints
+ * them, "BUS:reset" clears them.
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+
+static const uint32_t BUS_CAPACITY = 64;   // Power of two
+static const int BUS_BATCH = 16;           // Events taken off the ring at a time
+
+enum BusEventType : uint8_t {
+    BUS_MAP_TOUCH,           // x, y on the 1024x600 server grid (USB overlay, T:x,y)
+    BUS_MAP_LOCATION,        // lat, lon: a tap on the map
+    BUS_MAP_TAP_PENDING,     // lat, lon: first tap, may become a double-tap
+    BUS_MAP_DOUBLE_TAP,      // x, y in portrait panel coordinates
+    BUS_MAP_PINCH_ZOOM,      // value = zoom level, x, y = pinch midpoint
+    BUS_MAP_SCRUB,           // phase = MapScrubPhase, lat, lon
+    BUS_UI_BUTTON,           // value: 0 = stop, 1 = next
+    BUS_MENU_TOUCH,          // x, y in portrait panel coordinates
+    BUS_SWIPE,               // value: -1 left, +1 right, -2 up, +2 down
+    BUS_VOLUME,              // value 0..100
+    BUS_LIST_SCROLL,         // phase = ListScrollPhase, y = dy, value = velocity (px/s)
+    BUS_BUTTON_SHORT,        // Physical button: cycle region
+    BUS_BUTTON_LONG,         //   stop
+    BUS_BUTTON_DOUBLE,       //   next
+    BUS_MENU_ITEM,           // value = MenuItemId
+    BUS_FAVORITE_PLAY,       // value = favorites index
+    BUS_FAVORITE_DELETE,     // value = favorites index
+    BUS_HISTORY_PLAY,        // value = history index
+    BUS_WEB_COMMAND,         // phase = WebCommandType, value, lat, lon
+    BUS_EVENT_COUNT
+};
+
+struct BusEvent {
+    BusEventType type;
+    uint8_t phase;
+    int16_t x, y;
+    int32_t value;
+    float lat, lon;
+    uint32_t posted_us;      // micros() at the post, set by event_bus_post()
+};
+
+typedef void (*BusHandler)(const BusEvent& event);
+
+// Any task; false if the ring was full (the event is dropped)
+bool event_bus_post(BusEvent event);
+
+// Shorthands for the usual payloads
+bool event_bus_post_value(BusEventType type, int32_t value, uint8_t phase = 0);
+bool event_bus_post_point(BusEventType type, int x, int y, int32_t value = 0);
+bool event_bus_post_location(BusEventType type, float lat, float lon, uint8_t phase = 0);
+
+// Loop task: hand every queued event to handler, BUS_BATCH at a time.
+// Events the handler posts are run in the same call, up to BUS_CAPACITY
+// in all. Returns the number run.
+int event_bus_drain(BusHandler handler);
+
+const char* event_bus_type_name(BusEventType type);
+
+// Register the BUS command
+void event_bus_serial_init();
+
+#endif // EVENT_BUS_H
@@ -1,28 +1,29 @@
 /**
  * Favorites system implementation for RadioWall.
  *
- * Stores favorites as JSON on LittleFS. Renders the favorites list
- * screen and handles touch input (play zone + delete zone per item).
+ * Keeps handles into the station table (station_table.h), pinned and
+ * flagged as favorites, so favorites_contains() is one hash lookup. The
+ * list is stored as one array value in the state store (state_store.h),
+ * written behind through persist.h. A favorites.json
+ * from older firmware is imported on first boot.
+ * Renders the favorites list screen as a scrolling list (scroll_list.h)
+ * and handles touch input (play zone + delete zone per item).
  */
 
 #include "favorites.h"
 #include "theme.h"
+#include "text_sprites.h"
+#include "scroll_list.h"
+#include "event_bus.h"
+#include "state_store.h"
+#include "station_table.h"
+#include "persist.h"
+#include "json_arena.h"
 #include "Arduino_GFX_Library.h"
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 
-static const char* FAVORITES_FILE = "/favorites.json";
-
-// Helper: truncate UTF-8 string to max N bytes with "..." without splitting multi-byte chars
-static void utf8_truncate(char* buf, size_t max_bytes) {
-    if (strlen(buf) <= max_bytes) return;
-    int i = max_bytes - 3;
-    while (i > 0 && (buf[i] & 0xC0) == 0x80) i--;
-    buf[i++] = '.';
-    buf[i++] = '.';
-    buf[i++] = '.';
-    buf[i] = '\0';
-}
+static const char* LEGACY_FAVORITES_FILE = "/favorites.json";
 
 // Layout constants
 static const int TITLE_HEIGHT   = 40;
@@ -31,61 +32,55 @@ static const int ITEMS_START_Y  = TITLE_HEIGHT;
 static const int PLAY_ZONE_W    = 120;  // Left side: tap to play
 // Delete zone: 120-179 (60px wide)
 
-static const int PAGE_INDICATOR_Y = 530;
 static const int FAV_AREA_BOTTOM  = 520;
+static const uint8_t FAV_LIST_ID = 1;
 
-// In-memory storage
-static FavoriteStation _favs[MAX_FAVORITES];
+// In-memory storage: pinned station table handles
+static StationHandle _favs[MAX_FAVORITES];
 static int _fav_count = 0;
-static int _current_page = 0;
 
-// Callbacks
-static FavoritePlayCallback _play_cb = nullptr;
-static FavoriteDeleteCallback _delete_cb = nullptr;
+// One row per favorite; x >= PLAY_ZONE_W is the delete zone (1)
+static ScrollList _list;
 
 // ------------------------------------------------------------------
-// LittleFS persistence
+// Persistence
 // ------------------------------------------------------------------
 
-static bool save_to_file() {
-    File f = LittleFS.open(FAVORITES_FILE, "w");
-    if (!f) {
-        Serial.println("[Favs] Failed to open file for writing");
-        return false;
-    }
+// Pin a loaded or added station and flag it
+static bool append_favorite(const FavoriteStation& fav) {
+    StationHandle h = station_table_acquire(fav);
+    if (h == STATION_NONE) return false;
+    station_table_set_flag(h, STATION_FLAG_FAVORITE, true);
+    _favs[_fav_count++] = h;
+    return true;
+}
 
-    DynamicJsonDocument doc(4096);
-    JsonArray arr = doc.to<JsonArray>();
-
-    for (int i = 0; i < _fav_count; i++) {
-        JsonObject obj = arr.createNestedObject();
-        obj["i"] = _favs[i].station_id;
-        obj["t"] = _favs[i].title;
-        obj["p"] = _favs[i].place;
-        obj["c"] = _favs[i].country;
-        obj["a"] = _favs[i].lat;
-        obj["o"] = _favs[i].lon;
+// persist.h flush: the whole array (at most 20 records) as one value
+static bool flush_favorites() {
+    size_t bytes = _fav_count * sizeof(FavoriteStation);
+    FavoriteStation* records = (FavoriteStation*)malloc(bytes ? bytes : 1);
+    if (!records) return false;
+    for (int i = 0; i < _fav_count; i++) records[i] = *station_table_get(_favs[i]);
+
+    bool ok = state_store_put(STATE_KEY_FAVORITES, records, bytes);
+    free(records);
+    if (!ok) {
+        Serial.println("[Favs] Failed to save favorites");
+        return false;
     }
-
-    serializeJson(doc, f);
-    f.close();
     Serial.printf("[Favs] Saved %d favorites\n", _fav_count);
     return true;
 }
 
-static bool load_from_file() {
-    if (!LittleFS.exists(FAVORITES_FILE)) {
-        Serial.println("[Favs] No favorites file found");
-        return true;  // Not an error, just empty
-    }
-
-    File f = LittleFS.open(FAVORITES_FILE, "r");
+// Older firmware kept favorites as JSON
+static bool load_legacy_json() {
+    File f = LittleFS.open(LEGACY_FAVORITES_FILE, "r");
     if (!f) {
         Serial.println("[Favs] Failed to open favorites file");
         return false;
     }
 
-    DynamicJsonDocument doc(4096);
+    JsonArenaDoc doc(JSON_ARENA_FILE);
     DeserializationError error = deserializeJson(doc, f);
     f.close();
 
@@ -99,7 +94,7 @@ static bool load_from_file() {
     for (JsonObject obj : arr) {
         if (_fav_count >= MAX_FAVORITES) break;
 
-        FavoriteStation& fav = _favs[_fav_count];
+        FavoriteStation fav = {};
         strncpy(fav.station_id, obj["i"] | "", sizeof(fav.station_id) - 1);
         fav.station_id[sizeof(fav.station_id) - 1] = '\0';
         strncpy(fav.title, obj["t"] | "", sizeof(fav.title) - 1);
@@ -110,11 +105,32 @@ static bool load_from_file() {
         fav.country[sizeof(fav.country) - 1] = '\0';
         fav.lat = obj["a"] | 0.0f;
         fav.lon = obj["o"] | 0.0f;
+        append_favorite(fav);
+    }
+
+    Serial.printf("[Favs] Converted %d favorites from JSON\n", _fav_count);
+    return true;
+}
 
-        _fav_count++;
+static bool load_from_store() {
+    static FavoriteStation records[MAX_FAVORITES];   // Boot only
+    int len = state_store_get(STATE_KEY_FAVORITES, records, sizeof(records));
+    if (len >= 0 && len <= (int)sizeof(records) && len % sizeof(FavoriteStation) == 0) {
+        for (int i = 0; i < len / (int)sizeof(FavoriteStation); i++) append_favorite(records[i]);
+        Serial.printf("[Favs] Loaded %d favorites\n", _fav_count);
+        return true;
+    }
+    if (len >= 0) {
+        Serial.println("[Favs] Saved favorites have another layout, starting empty");
+        return false;
     }
 
-    Serial.printf("[Favs] Loaded %d favorites\n", _fav_count);
+    if (!LittleFS.exists(LEGACY_FAVORITES_FILE)) {
+        Serial.println("[Favs] No saved favorites");
+        return true;  // Not an error, just empty
+    }
+    if (!load_legacy_json()) return false;
+    if (flush_favorites()) LittleFS.remove(LEGACY_FAVORITES_FILE);
     return true;
 }
 
@@ -122,10 +138,14 @@ static bool load_from_file() {
 // Public API
 // ------------------------------------------------------------------
 
+static void draw_item(Arduino_GFX* gfx, int index, int y, int pressed);
+
 void favorites_init() {
     _fav_count = 0;
-    _current_page = 0;
-    load_from_file();
+    load_from_store();
+    scroll_list_init(_list, FAV_LIST_ID, ITEMS_START_Y, FAV_AREA_BOTTOM - ITEMS_START_Y,
+                     ITEM_HEIGHT, draw_item);
+    scroll_list_set_count(_list, _fav_count);
 }
 
 int favorites_count() {
@@ -134,16 +154,16 @@ int favorites_count() {
 
 const FavoriteStation* favorites_get(int index) {
     if (index < 0 || index >= _fav_count) return nullptr;
-    return &_favs[index];
+    return station_table_get(_favs[index]);
 }
 
 bool favorites_add(const FavoriteStation& fav) {
     if (_fav_count >= MAX_FAVORITES) return false;
     if (favorites_contains(fav.station_id)) return false;
 
-    _favs[_fav_count] = fav;
-    _fav_count++;
-    save_to_file();
+    if (!append_favorite(fav)) return false;
+    scroll_list_set_count(_list, _fav_count);
+    persist_mark_dirty(flush_favorites);
     Serial.printf("[Favs] Added: %s (%s)\n", fav.title, fav.place);
     return true;
 }
@@ -151,91 +171,84 @@ bool favorites_add(const FavoriteStation& fav) {
 bool favorites_remove(int index) {
     if (index < 0 || index >= _fav_count) return false;
 
-    Serial.printf("[Favs] Removed: %s\n", _favs[index].title);
+    Serial.printf("[Favs] Removed: %s\n", favorites_get(index)->title);
+    station_table_set_flag(_favs[index], STATION_FLAG_FAVORITE, false);
+    station_table_release(_favs[index]);
 
     // Shift remaining items down
     for (int i = index; i < _fav_count - 1; i++) {
         _favs[i] = _favs[i + 1];
     }
     _fav_count--;
+    scroll_list_set_count(_list, _fav_count);
 
-    // Adjust page if needed
-    if (_current_page >= favorites_total_pages() && _current_page > 0) {
-        _current_page--;
-    }
-
-    save_to_file();
+    persist_mark_dirty(flush_favorites);
     return true;
 }
 
 bool favorites_contains(const char* station_id) {
-    for (int i = 0; i < _fav_count; i++) {
-        if (strcmp(_favs[i].station_id, station_id) == 0) return true;
-    }
-    return false;
+    return station_table_has_flag(station_table_find(station_id), STATION_FLAG_FAVORITE);
 }
 
 // ------------------------------------------------------------------
-// Pagination
+// Scrolling
 // ------------------------------------------------------------------
 
-int favorites_get_page() {
-    return _current_page;
+void favorites_scroll_to_top() {
+    scroll_list_scroll_to_top(_list);
 }
 
-int favorites_total_pages() {
-    if (_fav_count == 0) return 1;
-    return (_fav_count + FAVORITES_PER_PAGE - 1) / FAVORITES_PER_PAGE;
-}
-
-void favorites_set_page(int page) {
-    int total = favorites_total_pages();
-    _current_page = constrain(page, 0, total - 1);
-}
-
-void favorites_next_page() {
-    int total = favorites_total_pages();
-    _current_page = (_current_page + 1) % total;
-    Serial.printf("[Favs] Page %d/%d\n", _current_page + 1, total);
+void favorites_page_down() {
+    scroll_list_page_down(_list);
 }
 
 // ------------------------------------------------------------------
 // Rendering
 // ------------------------------------------------------------------
 
-static void draw_item(Arduino_GFX* gfx, int slot, const FavoriteStation& fav) {
-    int y_top = ITEMS_START_Y + slot * ITEM_HEIGHT;
-    int card_y = y_top + 3;
+static void draw_item(Arduino_GFX* gfx, int index, int y, int pressed) {
+    const FavoriteStation* entry = favorites_get(index);
+    if (!entry) return;
+    const FavoriteStation& fav = *entry;
+    int card_y = y + 3;
     int card_h = ITEM_HEIGHT - 6;
 
+    if (pressed == 1) {
+        // Delete zone — red
+        gfx->fillRoundRect(PLAY_ZONE_W + 1, card_y, TH_CARD_W - PLAY_ZONE_W + TH_CARD_MARGIN,
+                            card_h, TH_CORNER_R, TH_DANGER);
+        gfx->setFont(&FreeSansBold10pt7b);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TH_TEXT);
+        gfx->setCursor(132, card_y + card_h / 2 + 5);
+        gfx->print("DEL");
+        gfx->setFont((const GFXfont*)nullptr);
+        return;
+    }
+    if (pressed == 0) {
+        gfx->fillRoundRect(TH_CARD_MARGIN, card_y, PLAY_ZONE_W - TH_CARD_MARGIN,
+                            card_h, TH_CORNER_R, TH_CARD_HI);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TH_TEXT);
+        gfx->setCursor(10, card_y + 16);
+        char trunc_title[19];
+        strncpy(trunc_title, fav.title, 18);
+        trunc_title[18] = '\0';
+        gfx->print(trunc_title);
+        return;
+    }
+
     // Card background
     gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
                         TH_CORNER_R, TH_CARD);
 
-    // Station title (Unicode font for CJK/Cyrillic support)
-    gfx->setFont(u8g2_font_cubic11_h_cjk);
-    gfx->setUTF8Print(true);
-    gfx->setTextSize(1);
-    gfx->setTextColor(TH_TEXT);
-    gfx->setCursor(10, card_y + 18);
-
-    char trunc_title[32];
-    strncpy(trunc_title, fav.title, 31);
-    trunc_title[31] = '\0';
-    utf8_truncate(trunc_title, 18);
-    gfx->print(trunc_title);
-
-    // Place + country below title
-    gfx->setTextColor(TH_TEXT_SEC);
-    gfx->setCursor(10, card_y + 38);
-    char place_str[32];
+    // Station title + place (Unicode font for CJK/Cyrillic support),
+    // blitted from a cached sprite once rendered
+    char place_str[96];
     snprintf(place_str, sizeof(place_str), "%s, %s", fav.place, fav.country);
-    utf8_truncate(place_str, 18);
-    gfx->print(place_str);
 
-    // Clear Unicode font
-    gfx->setFont((const uint8_t*)nullptr);
-    gfx->setUTF8Print(false);
+    text_sprite_draw_card(gfx, 10, card_y + 4, PLAY_ZONE_W - 10,
+                          fav.title, place_str);
 
     // Delete "x" on right side
     gfx->setFont(&FreeSansBold10pt7b);
@@ -249,7 +262,7 @@ static void draw_item(Arduino_GFX* gfx, int slot, const FavoriteStation& fav) {
     gfx->drawFastVLine(PLAY_ZONE_W, card_y + 6, card_h - 12, TH_DIVIDER);
 }
 
-void favorites_render(Arduino_GFX* gfx, int page) {
+void favorites_render(Arduino_GFX* gfx) {
     if (!gfx) return;
 
     // Clear main area
@@ -270,6 +283,9 @@ void favorites_render(Arduino_GFX* gfx, int page) {
     // Divider under title
     gfx->drawFastHLine(5, TITLE_HEIGHT - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
 
+    // Rendered even when empty, so drags go to this list
+    scroll_list_render(gfx, _list);
+
     if (_fav_count == 0) {
         gfx->setTextSize(1);
         gfx->setTextColor(TH_TEXT_DIM);
@@ -279,24 +295,6 @@ void favorites_render(Arduino_GFX* gfx, int page) {
         gfx->print("Play a station, then");
         gfx->setCursor(25, 250);
         gfx->print("tap ADD to save it");
-        return;
-    }
-
-    // Draw items for current page
-    int start_idx = page * FAVORITES_PER_PAGE;
-    int end_idx = min(start_idx + FAVORITES_PER_PAGE, _fav_count);
-
-    for (int i = start_idx; i < end_idx; i++) {
-        draw_item(gfx, i - start_idx, _favs[i]);
-    }
-
-    // Page indicator (only if multiple pages)
-    int total_pages = favorites_total_pages();
-    if (total_pages > 1) {
-        gfx->setTextSize(1);
-        gfx->setTextColor(TH_TEXT_SEC);
-        gfx->setCursor(55, PAGE_INDICATOR_Y);
-        gfx->printf("< %d / %d >", page + 1, total_pages);
     }
 }
 
@@ -304,70 +302,19 @@ void favorites_render(Arduino_GFX* gfx, int page) {
 // Touch handling
 // ------------------------------------------------------------------
 
-void favorites_set_play_callback(FavoritePlayCallback cb) {
-    _play_cb = cb;
-}
-
-void favorites_set_delete_callback(FavoriteDeleteCallback cb) {
-    _delete_cb = cb;
-}
-
 bool favorites_handle_touch(int x, int y, Arduino_GFX* gfx) {
-    // Ignore touches in title area
-    if (y < ITEMS_START_Y) return false;
-
-    // Ignore touches below item area
-    if (y >= ITEMS_START_Y + FAVORITES_PER_PAGE * ITEM_HEIGHT) return false;
-
-    int slot = (y - ITEMS_START_Y) / ITEM_HEIGHT;
-    int global_idx = _current_page * FAVORITES_PER_PAGE + slot;
-
-    if (global_idx < 0 || global_idx >= _fav_count) return false;
-
-    // Determine play vs delete zone
-    bool is_delete = (x >= PLAY_ZONE_W);
-
-    if (is_delete) {
-        // Delete zone — brief red highlight
-        Serial.printf("[Favs] Delete tap: %s\n", _favs[global_idx].title);
-        if (gfx) {
-            int y_top = ITEMS_START_Y + slot * ITEM_HEIGHT;
-            int card_y = y_top + 3;
-            int card_h = ITEM_HEIGHT - 6;
-            gfx->fillRoundRect(PLAY_ZONE_W + 1, card_y, TH_CARD_W - PLAY_ZONE_W + TH_CARD_MARGIN,
-                                card_h, TH_CORNER_R, TH_DANGER);
-            gfx->setFont(&FreeSansBold10pt7b);
-            gfx->setTextSize(1);
-            gfx->setTextColor(TH_TEXT);
-            gfx->setCursor(132, card_y + card_h / 2 + 5);
-            gfx->print("DEL");
-            gfx->setFont((const GFXfont*)nullptr);
-            delay(150);
-        }
-        if (_delete_cb) {
-            _delete_cb(global_idx);
-        }
+    int index = scroll_list_hit(_list, y);
+    if (index < 0) return false;
+
+    // Brief highlight; the bus handlers redraw the view
+    if (x >= PLAY_ZONE_W) {
+        Serial.printf("[Favs] Delete tap: %s\n", favorites_get(index)->title);
+        scroll_list_press(gfx, _list, index, 1, 150);
+        event_bus_post_value(BUS_FAVORITE_DELETE, index);
     } else {
-        // Play zone — brief highlight
-        Serial.printf("[Favs] Play tap: %s\n", _favs[global_idx].title);
-        if (gfx) {
-            int y_top = ITEMS_START_Y + slot * ITEM_HEIGHT;
-            int card_y = y_top + 3;
-            int card_h = ITEM_HEIGHT - 6;
-            gfx->fillRoundRect(TH_CARD_MARGIN, card_y, PLAY_ZONE_W - TH_CARD_MARGIN,
-                                card_h, TH_CORNER_R, TH_CARD_HI);
-            gfx->setTextSize(1);
-            gfx->setTextColor(TH_TEXT);
-            gfx->setCursor(10, card_y + 16);
-            char trunc_title[19];
-            strncpy(trunc_title, _favs[global_idx].title, 18);
-            trunc_title[18] = '\0';
-            gfx->print(trunc_title);
-            delay(80);
-        }
-        if (_play_cb) {
-            _play_cb(global_idx);
-        }
+        Serial.printf("[Favs] Play tap: %s\n", favorites_get(index)->title);
+        scroll_list_press(gfx, _list, index, 0, 80);
+        event_bus_post_value(BUS_FAVORITE_PLAY, index);
     }
 
     return true;
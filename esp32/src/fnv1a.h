@@ -0,0 +1,34 @@
+/**
+ * FNV-1a hashing for RadioWall.
+ *
+ * The 32-bit FNV-1a every module keys its tables with: station IDs, URLs,
+ * page contents, the places.bin fingerprint. Several of these values are
+ * saved (history ring, state store records), so the function must not
+ * change. Continue a hash by passing the last value back in as h.
+ */
+
+#ifndef FNV1A_H
+#define FNV1A_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint32_t FNV1A_SEED = 2166136261u;
+
+inline uint32_t fnv1a_byte(uint32_t h, uint8_t b) {
+    return (h ^ b) * 16777619u;
+}
+
+inline uint32_t fnv1a_bytes(const void* data, size_t len, uint32_t h = FNV1A_SEED) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) h = fnv1a_byte(h, p[i]);
+    return h;
+}
+
+// A NUL-terminated string, without the terminator
+inline uint32_t fnv1a_str(const char* s, uint32_t h = FNV1A_SEED) {
+    for (; *s; s++) h = fnv1a_byte(h, (uint8_t)*s);
+    return h;
+}
+
+#endif // FNV1A_H
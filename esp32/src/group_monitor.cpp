@@ -0,0 +1,325 @@
+/**
+ * Multiroom group monitor implementation for RadioWall.
+ *
+ * One task on core 0 (next to the network worker) owns the checks. The
+ * device table is shared with the tasks that ask about it (loop, worker)
+ * under _mux; a check copies the IPs out, runs without the lock, and
+ * writes the results back by IP, so a set change mid-round is harmless.
+ *
+ * A check is a bare TCP connect to the LinkPlay HTTPS port: it proves the
+ * device's API is listening without a TLS handshake. A device is only
+ * marked down after DOWN_AFTER failed rounds (one lost SYN is not a dead
+ * speaker), and up again on the first answer.
+ */
+
+#include "group_monitor.h"
+#include "settings.h"
+#include "net_worker.h"
+#include "loop_events.h"
+#include "wiim_identity.h"
+#include "serial_cmd.h"
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const int MAX_WATCHED = MAX_GROUP_DEVICES + 1;      // Members + primary
+static const uint16_t CHECK_PORT = 443;                    // LinkPlay httpapi
+static const uint32_t TASK_STACK = 3072;
+static const UBaseType_t TASK_PRIORITY = 1;
+static const BaseType_t TASK_CORE = 0;
+static const unsigned long CHECK_MS = 30UL * 1000;         // All devices answering
+static const unsigned long CHECK_DOWN_MS = 10UL * 1000;    // While one is down
+static const unsigned long CONNECT_TIMEOUT_MS = 1500;
+static const uint8_t DOWN_AFTER = 2;                       // Failed rounds
+
+struct Watched {
+    char ip[16];
+    bool member;              // Group member (rejoined when it comes back)
+    GroupHealth health;
+    uint8_t fails;            // Consecutive failed rounds
+    uint16_t rtt_ms;          // Last successful connect
+    unsigned long last_up;    // millis() of the last answer, 0 = never
+};
+
+static Watched _watched[MAX_WATCHED];
+static int _watched_count = 0;
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t _revision = 0;
+
+static TaskHandle_t _task = nullptr;
+static char _master_ip[16] = "";                 // Guarded by _mux
+static char _member_ips[MAX_GROUP_DEVICES][16];  // Guarded by _mux
+static int _member_count = 0;
+static uint32_t _rounds = 0;
+
+// ------------------------------------------------------------------
+// Device table
+// ------------------------------------------------------------------
+
+// Call with _mux held
+static Watched* find(const char* ip) {
+    for (int i = 0; i < _watched_count; i++) {
+        if (strcmp(_watched[i].ip, ip) == 0) return &_watched[i];
+    }
+    return nullptr;
+}
+
+// Rebuild the table from the master and members, keeping known states
+// (call with _mux held)
+static void rebuild() {
+    Watched next[MAX_WATCHED];
+    int count = 0;
+    for (int i = -1; i < _member_count && count < MAX_WATCHED; i++) {
+        const char* ip = i < 0 ? _master_ip : _member_ips[i];
+        if (!ip[0]) continue;
+        bool dup = false;
+        for (int j = 0; j < count; j++) dup |= strcmp(next[j].ip, ip) == 0;
+        if (dup) continue;
+
+        Watched* old = find(ip);
+        if (old) {
+            next[count] = *old;
+        } else {
+            memset(&next[count], 0, sizeof(next[count]));
+            strncpy(next[count].ip, ip, sizeof(next[count].ip) - 1);
+        }
+        next[count].member = i >= 0;
+        count++;
+    }
+    memcpy(_watched, next, sizeof(Watched) * count);
+    _watched_count = count;
+    _revision = _revision + 1;
+}
+
+static void set_changed() {
+    portENTER_CRITICAL(&_mux);
+    rebuild();
+    portEXIT_CRITICAL(&_mux);
+    if (_task) xTaskNotifyGive(_task);
+}
+
+// ------------------------------------------------------------------
+// Check round (monitor task)
+// ------------------------------------------------------------------
+
+struct Check {
+    char ip[16];
+    int fd;                   // -1 once finished
+    bool up;
+    uint16_t rtt_ms;
+};
+
+static bool start_connect(Check& c) {
+    c.fd = -1;   // Every failure leaves nothing for run_checks to close
+    IPAddress ip;
+    if (!ip.fromString(c.ip)) return false;
+    c.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (c.fd < 0) return false;
+    fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(CHECK_PORT);
+    addr.sin_addr.s_addr = (uint32_t)ip;
+    if (connect(c.fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        close(c.fd);
+        c.fd = -1;
+        return false;
+    }
+    return true;
+}
+
+// Connect to every device at once; returns when all have answered or
+// CONNECT_TIMEOUT_MS has passed
+static void run_checks(Check* checks, int count) {
+    unsigned long start = millis();
+    int open = 0;
+    for (int i = 0; i < count; i++) {
+        checks[i].up = false;
+        checks[i].rtt_ms = 0;
+        if (start_connect(checks[i])) open++;
+    }
+
+    while (open > 0 && millis() - start < CONNECT_TIMEOUT_MS) {
+        fd_set wr;
+        FD_ZERO(&wr);
+        int max_fd = -1;
+        for (int i = 0; i < count; i++) {
+            if (checks[i].fd < 0) continue;
+            FD_SET(checks[i].fd, &wr);
+            max_fd = max(max_fd, checks[i].fd);
+        }
+        unsigned long left = CONNECT_TIMEOUT_MS - (millis() - start);
+        struct timeval tv = {(time_t)(left / 1000), (suseconds_t)(left % 1000) * 1000};
+        if (select(max_fd + 1, nullptr, &wr, nullptr, &tv) <= 0) break;
+
+        for (int i = 0; i < count; i++) {
+            Check& c = checks[i];
+            if (c.fd < 0 || !FD_ISSET(c.fd, &wr)) continue;
+            int err = 0;
+            socklen_t len = sizeof(err);
+            c.up = getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0;
+            c.rtt_ms = (uint16_t)min(millis() - start, 65535UL);
+            close(c.fd);
+            c.fd = -1;
+            open--;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (checks[i].fd >= 0) close(checks[i].fd);
+        checks[i].fd = -1;
+    }
+}
+
+// Write a round's results back; returns true if any device is down
+static bool apply_checks(const Check* checks, int count) {
+    char rejoin[MAX_WATCHED][16];
+    char gone[MAX_WATCHED][16];
+    int rejoin_count = 0, gone_count = 0;
+    bool any_down = false;
+    unsigned long now = millis();
+
+    portENTER_CRITICAL(&_mux);
+    uint32_t rev = _revision;
+    for (int i = 0; i < count; i++) {
+        Watched* w = find(checks[i].ip);
+        if (!w) continue;   // Removed during the round
+        GroupHealth was = w->health;
+        if (checks[i].up) {
+            w->health = GROUP_HEALTH_UP;
+            w->fails = 0;
+            w->rtt_ms = checks[i].rtt_ms;
+            w->last_up = now;
+            if (was == GROUP_HEALTH_DOWN && w->member) {
+                memcpy(rejoin[rejoin_count++], w->ip, sizeof(w->ip));
+            }
+        } else if (w->fails < 255 && ++w->fails == DOWN_AFTER) {
+            w->health = GROUP_HEALTH_DOWN;
+            memcpy(gone[gone_count++], w->ip, sizeof(w->ip));
+        }
+        if (w->health != was) _revision = _revision + 1;
+        any_down |= w->health == GROUP_HEALTH_DOWN;
+    }
+    bool changed = _revision != rev;
+    portEXIT_CRITICAL(&_mux);
+
+    if (changed) loop_events_notify();   // Devices page dots
+    for (int i = 0; i < gone_count; i++) {
+        Serial.printf("[Group] %s is not answering\n", gone[i]);
+        wiim_identity_suspect(gone[i]);   // The primary may have a new lease
+    }
+    // Back after being down: its group membership was lost with it
+    for (int i = 0; i < rejoin_count; i++) {
+        Serial.printf("[Group] %s is back, rejoining\n", rejoin[i]);
+        net_worker_group_member(rejoin[i], true);
+    }
+    return any_down;
+}
+
+static void monitor_task(void*) {
+    Check checks[MAX_WATCHED];
+    unsigned long interval = 0;   // First round at once
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(interval));
+        interval = CHECK_MS;
+        if (WiFi.status() != WL_CONNECTED) continue;
+
+        portENTER_CRITICAL(&_mux);
+        int count = _watched_count;
+        for (int i = 0; i < count; i++) memcpy(checks[i].ip, _watched[i].ip, sizeof(checks[i].ip));
+        portEXIT_CRITICAL(&_mux);
+        if (count == 0) continue;
+
+        run_checks(checks, count);
+        _rounds++;
+        if (apply_checks(checks, count)) interval = CHECK_DOWN_MS;
+    }
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void group_monitor_start() {
+    if (_task) return;
+    if (xTaskCreatePinnedToCore(monitor_task, "group_monitor", TASK_STACK, nullptr,
+                                TASK_PRIORITY, &_task, TASK_CORE) != pdPASS) {
+        Serial.println("[Group] Failed to start monitor task");
+        _task = nullptr;
+        return;
+    }
+    Serial.println("[Group] Monitor started");
+}
+
+void group_monitor_set_master(const char* ip) {
+    portENTER_CRITICAL(&_mux);
+    strncpy(_master_ip, ip ? ip : "", sizeof(_master_ip) - 1);
+    _master_ip[sizeof(_master_ip) - 1] = '\0';
+    portEXIT_CRITICAL(&_mux);
+    set_changed();
+}
+
+void group_monitor_set_members(const char (*ips)[16], int count) {
+    count = constrain(count, 0, MAX_GROUP_DEVICES);
+    portENTER_CRITICAL(&_mux);
+    _member_count = count;
+    for (int i = 0; i < count; i++) {
+        memcpy(_member_ips[i], ips[i], sizeof(_member_ips[i]));
+        _member_ips[i][sizeof(_member_ips[i]) - 1] = '\0';
+    }
+    portEXIT_CRITICAL(&_mux);
+    set_changed();
+}
+
+GroupHealth group_monitor_health(const char* ip, uint16_t* rtt_ms) {
+    if (!ip || !ip[0]) return GROUP_HEALTH_UNKNOWN;
+    portENTER_CRITICAL(&_mux);
+    Watched* w = find(ip);
+    GroupHealth health = w ? w->health : GROUP_HEALTH_UNKNOWN;
+    if (rtt_ms) *rtt_ms = w ? w->rtt_ms : 0;
+    portEXIT_CRITICAL(&_mux);
+    return health;
+}
+
+bool group_monitor_reachable(const char* ip) {
+    return group_monitor_health(ip) != GROUP_HEALTH_DOWN;
+}
+
+uint32_t group_monitor_revision() {
+    return _revision;
+}
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+static const char* const HEALTH_NAMES[] = {"unchecked", "up", "DOWN"};
+
+// GROUP - Watched devices: state, connect RTT, last answer (and check now)
+static void cmd_group(const char*) {
+    Watched watched[MAX_WATCHED];
+    portENTER_CRITICAL(&_mux);
+    int count = _watched_count;
+    memcpy(watched, _watched, sizeof(Watched) * count);
+    portEXIT_CRITICAL(&_mux);
+
+    unsigned long now = millis();
+    for (int i = 0; i < count; i++) {
+        const Watched& w = watched[i];
+        Serial.printf("[Group] %-15s %-7s %-9s", w.ip, w.member ? "member" : "primary",
+                      HEALTH_NAMES[w.health]);
+        if (w.last_up) {
+            Serial.printf(" %u ms, seen %lu s ago", w.rtt_ms, (now - w.last_up) / 1000);
+        }
+        Serial.println();
+    }
+    Serial.printf("[Group] %d device(s), %lu round(s)%s\n", count, (unsigned long)_rounds,
+                  _task ? "" : ", monitor not started (no WiFi yet)");
+    if (_task) xTaskNotifyGive(_task);
+}
+
+void group_monitor_serial_init() {
+    serial_cmd_register("GROUP", cmd_group);
+}
@@ -0,0 +1,48 @@
+/**
+ * Multiroom group monitor for RadioWall.
+ *
+ * A low-rate background check of the primary WiiM and the saved group
+ * members. Every round opens a non-blocking TCP connection to each
+ * device's LinkPlay port at once and waits for all of them in one
+ * select(), so a round costs one connect timeout however many members are
+ * dead. The result (reachable or not, connect RTT) is cached per device.
+ *
+ * Joins, kicks, rejoins and the device switch's ungroup ask the cache
+ * first and skip a device known to be down instead of retrying it; a
+ * member that comes back is joined again by the monitor. The Devices page
+ * shows the cached state on each card.
+ */
+
+#ifndef GROUP_MONITOR_H
+#define GROUP_MONITOR_H
+
+#include <Arduino.h>
+
+enum GroupHealth : uint8_t {
+    GROUP_HEALTH_UNKNOWN,   // Not checked yet (treated as reachable)
+    GROUP_HEALTH_UP,
+    GROUP_HEALTH_DOWN,
+};
+
+// Start the monitor task (once WiFi is up; later calls do nothing)
+void group_monitor_start();
+
+// Devices to watch: the primary WiiM and the group members. Either call
+// checks the new set at once; devices still in it keep their state.
+void group_monitor_set_master(const char* ip);
+void group_monitor_set_members(const char (*ips)[16], int count);
+
+// Cached state of a device (UNKNOWN if not watched); rtt_ms (optional)
+// receives the last connect time
+GroupHealth group_monitor_health(const char* ip, uint16_t* rtt_ms = nullptr);
+
+// False only for a device known to be down
+bool group_monitor_reachable(const char* ip);
+
+// Bumped whenever a cached state changes (Devices page refresh)
+uint32_t group_monitor_revision();
+
+// Register the GROUP serial command (per-device state, RTT, last seen)
+void group_monitor_serial_init();
+
+#endif // GROUP_MONITOR_H
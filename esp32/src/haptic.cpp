@@ -0,0 +1,126 @@
+/**
+ * Haptic tap acknowledgement implementation for RadioWall.
+ *
+ * RAM playback: waveform 1 of the vendor library (100 full-scale samples,
+ * about 8 ms at 12 kHz) is the only sequence, followed by an end marker,
+ * with the three brake stages stopping the motor short. The motor driver
+ * prefers a faster bus than the charger on it allows; at 400 kHz a pulse
+ * still takes well under a millisecond to start.
+ */
+
+#include "haptic.h"
+#include "serial_cmd.h"
+
+#ifdef HAPTIC_AW8624
+
+#include "Arduino_DriveBus_Library.h"
+
+#ifndef HAPTIC_GAIN
+#define HAPTIC_GAIN 128           // Global waveform gain, 0-255
+#endif
+
+static const int32_t AW8624_ID = 0x24;
+static const uint8_t TAP_REPEATS = 1;   // Extra plays of the waveform
+static const uint32_t RESET_MS = 20;    // Software reset to first access
+
+static Arduino_AW8624* _haptic = nullptr;
+static volatile bool _enabled = true;
+static uint32_t _pulses = 0;              // Reader task only
+static uint32_t _failed = 0;
+
+typedef Arduino_IIC_HAPTIC H;
+
+// Load the tap sequence into the chip (init)
+static bool load_tap() {
+    uint16_t start = (uint16_t)haptic_waveform_header[1] << 8 | haptic_waveform_header[2];
+    return _haptic->IIC_Write_Device_State(H::HAPTIC_MOTOR_TYPE, H::HAPTIC_ERM_MOTOR_MODE) &&
+           _haptic->IIC_Write_Device_State(H::HAPTIC_INITIALIZATION_SRAM, H::HAPTIC_DEVICE_ON) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_SET_SRAM_BASE_ADDRESS, 0x0000) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_SET_SRAM_ADDRESS, 0x0000) &&
+           _haptic->IIC_Write_Device_Data(H::HAPTIC_SRAM_DATA, haptic_waveform_header,
+                                          sizeof(haptic_waveform_header)) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_SET_SRAM_ADDRESS, start) &&
+           _haptic->IIC_Write_Device_Data(H::HAPTIC_SRAM_DATA, haptic_waveform_ordinary,
+                                          sizeof(haptic_waveform_ordinary)) &&
+           // Sequence: waveform 1, then 0 (end)
+           _haptic->IIC_Write_Device_State(H::HAPTIC_WAVEFORM_FILLER_1_MODE, H::HAPTIC_WAVEFORM_FILLER_OUTPUT_MODE) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_WAVEFORM_FILLER_1_OUTPUT_NUMBER_DELAY, 1) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_WAVEFORM_FILLER_1_OUTPUT_PLAYBACK_TIMES, TAP_REPEATS) &&
+           _haptic->IIC_Write_Device_State(H::HAPTIC_WAVEFORM_FILLER_2_MODE, H::HAPTIC_WAVEFORM_FILLER_OUTPUT_MODE) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_WAVEFORM_FILLER_2_OUTPUT_NUMBER_DELAY, 0) &&
+           _haptic->IIC_Write_Device_State(H::HAPTIC_PWM_SAMPLE_RATE_MODE, H::HAPTIC_PWM_SAMPLE_RATE_12KB) &&
+           _haptic->IIC_Write_Device_State(H::HAPTIC_PLAY_MODE, H::HAPTIC_RAM_MODE) &&
+           // Brakes as in the vendor example: a crisp tick, no ring-down
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_SET_BRAKE0_LEVEL, 127) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_SET_BRAKE0_P_NUM, 3) &&
+           _haptic->IIC_Write_Device_State(H::HAPTIC_BRAKE1_MODE, H::HAPTIC_DEVICE_ON) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_SET_BRAKE1_LEVEL, 31) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_SET_BRAKE1_P_NUM, 3) &&
+           _haptic->IIC_Write_Device_State(H::HAPTIC_BRAKE2_MODE, H::HAPTIC_DEVICE_ON) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_SET_BRAKE2_LEVEL, 8) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_SET_BRAKE2_P_NUM, 1) &&
+           _haptic->IIC_Write_Device_Value(H::HAPTIC_GAIN_VALUE, HAPTIC_GAIN);
+}
+
+bool haptic_init(std::shared_ptr<Arduino_IIC_DriveBus> bus) {
+    if (_haptic) return true;
+    _haptic = new Arduino_AW8624(bus, AW8624_DEVICE_ADDRESS);
+    // Not begin(): the bus is up already, only the chip needs its reset
+    bool reset = _haptic->IIC_Device_Reset() == 1;
+    delay(RESET_MS);
+    if (!reset || _haptic->IIC_Device_ID() != AW8624_ID) {
+        Serial.printf("[Haptic] No AW8624 at 0x%02X\n", AW8624_DEVICE_ADDRESS);
+        delete _haptic;
+        _haptic = nullptr;
+        return false;
+    }
+    if (!load_tap()) {
+        Serial.println("[Haptic] Loading the tap waveform failed");
+        delete _haptic;
+        _haptic = nullptr;
+        return false;
+    }
+    Serial.printf("[Haptic] AW8624 ready, gain %d\n", HAPTIC_GAIN);
+    return true;
+}
+
+void haptic_tap() {
+    if (!_haptic || !_enabled) return;
+    if (_haptic->IIC_Write_Device_State(H::HAPTIC_CHIP_MODE, H::HAPTIC_ACTIVE_MODE) &&
+        _haptic->IIC_Write_Device_State(H::HAPTIC_PLAYBACK_GO_MODE, H::HAPTIC_DEVICE_ON)) {
+        _pulses++;
+    } else {
+        _failed++;
+    }
+}
+
+// HAPTIC - Driver found, pulses so far; HAPTIC:on / HAPTIC:off
+static void cmd_haptic(const char* args) {
+    if (args && strcmp(args, "on") == 0) _enabled = true;
+    if (args && strcmp(args, "off") == 0) _enabled = false;
+    if (!_haptic) {
+        Serial.println("[Haptic] No AW8624 found on the touch bus");
+        return;
+    }
+    Serial.printf("[Haptic] %s, gain %d, %lu pulse(s), %lu failed\n", _enabled ? "On" : "Off",
+                  HAPTIC_GAIN, (unsigned long)_pulses, (unsigned long)_failed);
+}
+
+#else
+
+bool haptic_init(std::shared_ptr<Arduino_IIC_DriveBus>) {
+    return false;
+}
+
+void haptic_tap() {}
+
+static void cmd_haptic(const char*) {
+    Serial.println("[Haptic] Off (build with -DHAPTIC_AW8624)");
+}
+
+#endif // HAPTIC_AW8624
+
+void haptic_serial_init() {
+    serial_cmd_register("HAPTIC", cmd_haptic);
+    serial_cmd_register("HAPTIC:", cmd_haptic);
+}
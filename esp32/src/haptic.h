@@ -0,0 +1,32 @@
+/**
+ * Haptic tap acknowledgement for RadioWall (opt-in, -DHAPTIC_AW8624).
+ *
+ * An AW8624 haptic driver with a small ERM motor on the touch I2C bus
+ * gives every touch-down a short buzz, straight from the touch reader
+ * task: a couple of milliseconds after the finger lands, however long the
+ * loop, the network worker or the WiiM then take to act on it. The board
+ * has no motor of its own, so this is for frames that add one.
+ *
+ * The tap waveform sits in the driver's SRAM from init; a pulse is two
+ * register writes.
+ */
+
+#ifndef HAPTIC_H
+#define HAPTIC_H
+
+#include <Arduino.h>
+#include <memory>
+
+class Arduino_IIC_DriveBus;
+
+// Find the AW8624 on the touch bus and load the tap waveform
+// (builtin_touch_init(), before the reader task starts)
+bool haptic_init(std::shared_ptr<Arduino_IIC_DriveBus> bus);
+
+// One tap pulse (touch reader task only: it owns the bus)
+void haptic_tap();
+
+// Register the HAPTIC serial command (status, HAPTIC:on / HAPTIC:off)
+void haptic_serial_init();
+
+#endif // HAPTIC_H
@@ -0,0 +1,194 @@
+/**
+ * Heap and PSRAM diagnostics implementation for RadioWall.
+ *
+ * The failure hook runs on whichever task's allocation failed (the net
+ * worker's TLS handshakes, mostly), so it only bumps counters under a
+ * spinlock; the loop task logs them on its next pass.
+ */
+
+#include "heap_diag.h"
+#include "serial_cmd.h"
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+
+static const unsigned long HEAP_SAMPLE_MS = 1000;
+static const unsigned long HEAP_DIAG_LOG_MS = 10 * 60 * 1000UL;
+static const size_t HEAP_TLS_MIN_BLOCK = 32 * 1024;   // Handshake buffers + cert chain
+static const int MAX_MARKS = 16;
+
+struct HeapRegion {
+    const char* name;
+    uint32_t caps;
+    size_t min_largest;      // Smallest largest-free-block seen
+};
+
+static HeapRegion _regions[] = {
+    { "internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, SIZE_MAX },
+    { "psram",    MALLOC_CAP_SPIRAM,                     SIZE_MAX },
+};
+static const int REGION_COUNT = sizeof(_regions) / sizeof(_regions[0]);
+
+struct HeapMark {
+    const char* subsystem;
+    int32_t internal;        // Bytes taken since the previous mark
+    int32_t psram;
+};
+
+static HeapMark _marks[MAX_MARKS];
+static int _mark_count = 0;
+static size_t _last_internal = 0;
+static size_t _last_psram = 0;
+
+static portMUX_TYPE _fail_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t _fail_count = 0;
+static uint32_t _fail_logged = 0;
+static size_t _fail_last_size = 0;
+static uint32_t _fail_last_caps = 0;
+
+static unsigned long _last_sample_ms = 0;
+static unsigned long _last_log_ms = 0;
+static bool _tls_warned = false;
+
+// ------------------------------------------------------------------
+// Sampling
+// ------------------------------------------------------------------
+
+static void on_alloc_failed(size_t size, uint32_t caps, const char* function_name) {
+    (void)function_name;
+    portENTER_CRITICAL_SAFE(&_fail_mux);
+    _fail_count++;
+    _fail_last_size = size;
+    _fail_last_caps = caps;
+    portEXIT_CRITICAL_SAFE(&_fail_mux);
+}
+
+static void sample() {
+    for (int i = 0; i < REGION_COUNT; i++) {
+        HeapRegion& r = _regions[i];
+        if (heap_caps_get_total_size(r.caps) == 0) continue;
+        size_t largest = heap_caps_get_largest_free_block(r.caps);
+        if (largest < r.min_largest) r.min_largest = largest;
+    }
+}
+
+static void log_summary() {
+    size_t free_int = heap_caps_get_free_size(_regions[0].caps);
+    size_t largest_int = heap_caps_get_largest_free_block(_regions[0].caps);
+    Serial.printf("[Heap] internal %u free (min %u), largest %u (min %u), psram %u free, %lu failed\n",
+                  (unsigned)free_int,
+                  (unsigned)heap_caps_get_minimum_free_size(_regions[0].caps),
+                  (unsigned)largest_int, (unsigned)_regions[0].min_largest,
+                  (unsigned)heap_caps_get_free_size(_regions[1].caps),
+                  (unsigned long)_fail_count);
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void heap_diag_init() {
+    heap_caps_register_failed_alloc_callback(on_alloc_failed);
+    _last_internal = heap_caps_get_free_size(_regions[0].caps);
+    _last_psram = heap_caps_get_free_size(_regions[1].caps);
+    sample();
+    _last_sample_ms = _last_log_ms = millis();
+}
+
+void heap_diag_mark(const char* subsystem) {
+    size_t free_int = heap_caps_get_free_size(_regions[0].caps);
+    size_t free_ps = heap_caps_get_free_size(_regions[1].caps);
+    if (_mark_count < MAX_MARKS) {
+        HeapMark& m = _marks[_mark_count++];
+        m.subsystem = subsystem;
+        m.internal = (int32_t)_last_internal - (int32_t)free_int;
+        m.psram = (int32_t)_last_psram - (int32_t)free_ps;
+    }
+    _last_internal = free_int;
+    _last_psram = free_ps;
+}
+
+void heap_diag_task() {
+    unsigned long now = millis();
+
+    portENTER_CRITICAL(&_fail_mux);
+    uint32_t fails = _fail_count;
+    size_t fail_size = _fail_last_size;
+    uint32_t fail_caps = _fail_last_caps;
+    portEXIT_CRITICAL(&_fail_mux);
+    if (fails != _fail_logged) {
+        Serial.printf("[Heap] %lu allocation(s) failed, last %u bytes (caps 0x%lx), largest internal block %u\n",
+                      (unsigned long)(fails - _fail_logged), (unsigned)fail_size,
+                      (unsigned long)fail_caps,
+                      (unsigned)heap_caps_get_largest_free_block(_regions[0].caps));
+        _fail_logged = fails;
+    }
+
+    if (now - _last_sample_ms >= HEAP_SAMPLE_MS) {
+        _last_sample_ms = now;
+        sample();
+        // Warn once per dip: the next handshake may not find its buffers
+        bool low = _regions[0].min_largest < HEAP_TLS_MIN_BLOCK &&
+                   heap_caps_get_largest_free_block(_regions[0].caps) < HEAP_TLS_MIN_BLOCK;
+        if (low && !_tls_warned) {
+            Serial.printf("[Heap] WARNING: largest internal block below %u, TLS may fail\n",
+                          (unsigned)HEAP_TLS_MIN_BLOCK);
+            log_summary();
+        }
+        _tls_warned = low;
+    }
+
+    if (now - _last_log_ms >= HEAP_DIAG_LOG_MS) {
+        _last_log_ms = now;
+        log_summary();
+    }
+}
+
+void heap_diag_get_stats(HeapDiagStats* out) {
+    uint32_t internal = _regions[0].caps;
+    out->internal_free = heap_caps_get_free_size(internal);
+    out->internal_min_free = heap_caps_get_minimum_free_size(internal);
+    out->internal_largest = heap_caps_get_largest_free_block(internal);
+    out->internal_min_largest = _regions[0].min_largest;
+    out->psram_free = heap_caps_get_free_size(_regions[1].caps);
+    out->psram_total = heap_caps_get_total_size(_regions[1].caps);
+
+    portENTER_CRITICAL(&_fail_mux);
+    out->failed_allocs = _fail_count;
+    portEXIT_CRITICAL(&_fail_mux);
+}
+
+void heap_diag_print() {
+    sample();
+    Serial.println("[Heap] Regions:");
+    for (int i = 0; i < REGION_COUNT; i++) {
+        const HeapRegion& r = _regions[i];
+        size_t total = heap_caps_get_total_size(r.caps);
+        if (total == 0) {
+            Serial.printf("[Heap]   %-8s (none)\n", r.name);
+            continue;
+        }
+        size_t free_bytes = heap_caps_get_free_size(r.caps);
+        size_t largest = heap_caps_get_largest_free_block(r.caps);
+        // Share of free memory outside the largest block
+        unsigned frag = free_bytes ? (unsigned)(100 - largest * 100 / free_bytes) : 0;
+        Serial.printf("[Heap]   %-8s %u/%u free, min %u, largest %u (min %u), %u%% fragmented\n",
+                      r.name, (unsigned)free_bytes, (unsigned)total,
+                      (unsigned)heap_caps_get_minimum_free_size(r.caps),
+                      (unsigned)largest, (unsigned)r.min_largest, frag);
+    }
+    Serial.printf("[Heap] Failed allocations: %lu\n", (unsigned long)_fail_count);
+
+    Serial.println("[Heap] Boot footprint (internal / psram):");
+    for (int i = 0; i < _mark_count; i++) {
+        Serial.printf("[Heap]   %-12s %7ld / %7ld\n", _marks[i].subsystem,
+                      (long)_marks[i].internal, (long)_marks[i].psram);
+    }
+}
+
+static void cmd_report(const char*) {
+    heap_diag_print();
+}
+
+void heap_diag_serial_init() {
+    serial_cmd_register("M", cmd_report);
+}
@@ -0,0 +1,49 @@
+/**
+ * Heap and PSRAM diagnostics for RadioWall.
+ *
+ * The device runs for weeks, so what matters is whether the internal heap
+ * is fragmenting: an mbedTLS handshake needs one large contiguous internal
+ * block, and it fails long before free memory runs out. This module keeps
+ * low-water marks for free memory and the largest free block per region,
+ * counts failed allocations through the heap_caps failure hook, and records
+ * each subsystem's footprint at boot (heap_diag_mark() after its init).
+ *
+ * heap_diag_task() (loop) samples the heap once a second and logs a one-line
+ * summary every HEAP_DIAG_LOG_MS. Serial "M" prints the full report.
+ */
+
+#ifndef HEAP_DIAG_H
+#define HEAP_DIAG_H
+
+#include <Arduino.h>
+
+// Install the failed-allocation hook and take the baseline (first in setup)
+void heap_diag_init();
+
+// Attribute everything allocated since the previous mark to subsystem
+// (setup, after each init; name must be a string literal)
+void heap_diag_mark(const char* subsystem);
+
+// Sample watermarks and log periodically (call from loop)
+void heap_diag_task();
+
+struct HeapDiagStats {
+    size_t internal_free;
+    size_t internal_min_free;
+    size_t internal_largest;
+    size_t internal_min_largest;   // Since boot, sampled once a second
+    size_t psram_free;
+    size_t psram_total;
+    uint32_t failed_allocs;
+};
+
+// Current figures for the metrics endpoint (any task)
+void heap_diag_get_stats(HeapDiagStats* out);
+
+// Full report: regions, watermarks, failures, boot footprint
+void heap_diag_print();
+
+// Register the "M" serial command
+void heap_diag_serial_init();
+
+#endif // HEAP_DIAG_H
@@ -1,87 +1,395 @@
 /**
  * Playback history implementation for RadioWall.
  *
- * Ring buffer of last 20 stations played. Auto-records on play,
- * deduplicates (moves repeated station to top). Persists to LittleFS.
+ * The last MAX_HISTORY plays live in a ring file on LittleFS, so the
+ * history holds far more entries than RAM. A repeated station moves to
+ * the top. The file has a header, a key table ({seq, station hash} per
+ * slot) and the entries. Play number seq goes to slot (seq - 1) %
+ * MAX_HISTORY, overwriting the oldest play once the ring is full.
+ *
+ * Only the key table is read at boot. It yields a hash index on station
+ * ID, chained per bucket, so recording a play takes O(1) lookups and
+ * writes however long the history is. Entries load on demand when a row
+ * is shown, through a small cache of pinned station table handles
+ * (station_table.h), so a station that is also a favorite or on screen
+ * elsewhere is held once. Each slot holds a packed record (station_pack.h)
+ * with the place as its places.bin handle; the header names the places.bin
+ * the handles belong to, and after a rebuilt one the entries keep their
+ * stations but lose their places. New entries wait in that cache. The
+ * persist.h flush writes them and the changed keys, and then syncs the
+ * file, which LittleFS commits atomically.
+ *
+ * The screen shows the entries as a scrolling list (scroll_list.h).
+ * Older firmware kept history in a ring of fixed records, before that in
+ * state store slots, and before that in history.json. All of them are
+ * imported on first boot.
  */
 
 #include "history.h"
+#include "fnv1a.h"
 #include "theme.h"
+#include "text_sprites.h"
+#include "scroll_list.h"
+#include "event_bus.h"
+#include "station_table.h"
+#include "station_pack.h"
+#include "places_db.h"
+#include "state_store.h"
+#include "persist.h"
+#include "json_arena.h"
 #include "Arduino_GFX_Library.h"
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 
-static const char* HISTORY_FILE = "/history.json";
-
-// Helper: truncate UTF-8 string to max N bytes with "..." without splitting multi-byte chars
-static void utf8_truncate(char* buf, size_t max_bytes) {
-    if (strlen(buf) <= max_bytes) return;
-    int i = max_bytes - 3;
-    while (i > 0 && (buf[i] & 0xC0) == 0x80) i--;
-    buf[i++] = '.';
-    buf[i++] = '.';
-    buf[i++] = '.';
-    buf[i] = '\0';
-}
+static const char* HISTORY_FILE = "/history.ring";
+static const char* LEGACY_HISTORY_FILE = "/history.json";
+static const char* LEGACY_RING_FILE = "/history.ring1";
+static const uint32_t RING_MAGIC = 0x32485752;          // "RWH2"
+static const uint32_t LEGACY_RING_MAGIC = 0x31485752;   // "RWH1": StationMeta entries
+static const size_t ENTRY_BYTES = STATION_PACK_META_MAX;
+static const int LEGACY_SLOTS = 20;              // State store slots of older firmware
+static const int INDEX_BUCKETS = 1024;
+static const int ENTRY_CACHE_SLOTS = 16;         // A screen of rows plus new plays
+static const uint16_t NO_SLOT = 0xFFFF;
+
+struct RingHeader {
+    uint32_t magic;
+    uint16_t capacity;
+    uint16_t entry_size;
+    uint32_t places;         // places_db_fingerprint() of the entries' place handles
+};
+
+// Header of the fixed-record ring of older firmware
+struct LegacyRingHeader {
+    uint32_t magic;
+    uint16_t capacity;
+    uint16_t entry_size;
+};
+
+struct HistoryKey {
+    uint32_t seq;            // Play number, 0 for an empty or superseded slot
+    uint32_t hash;           // station_id hash
+};
+
+// State store slot of older firmware
+struct LegacyRecord {
+    uint32_t seq;
+    HistoryEntry entry;
+};
+
+struct CachedEntry {
+    uint32_t seq;            // Key seq when loaded, 0 unused
+    uint16_t slot;
+    bool dirty;              // Not yet written to the file
+    uint32_t last_used;
+    StationHandle station;   // Pinned while cached
+};
+
+static const size_t KEYS_OFFSET = sizeof(RingHeader);
+static const size_t ENTRIES_OFFSET = KEYS_OFFSET + MAX_HISTORY * sizeof(HistoryKey);
+static const size_t LEGACY_KEYS_OFFSET = sizeof(LegacyRingHeader);
+static const size_t LEGACY_ENTRIES_OFFSET = LEGACY_KEYS_OFFSET + MAX_HISTORY * sizeof(HistoryKey);
 
 // Layout constants
 static const int TITLE_HEIGHT   = 40;
 static const int ITEM_HEIGHT    = 80;
 static const int ITEMS_START_Y  = TITLE_HEIGHT;
-static const int PAGE_INDICATOR_Y = 530;
 static const int HIST_AREA_BOTTOM = 520;
+static const uint8_t HISTORY_LIST_ID = 2;
+
+// Ring state (PSRAM when present): keys, hash chains, display order
+static File _file;
+static HistoryKey* _keys = nullptr;
+static uint16_t* _next = nullptr;           // Next slot in the same bucket
+static uint16_t* _order = nullptr;          // Live slots, newest first
+static uint16_t _buckets[INDEX_BUCKETS];
+static uint32_t _dirty_keys[(MAX_HISTORY + 31) / 32];
+static bool _order_valid = false;
+static int _count = 0;                      // Live entries
+static uint32_t _seq = 0;                   // Highest seq in use
 
-// In-memory storage (newest at index 0)
-static HistoryEntry _entries[MAX_HISTORY];
-static int _count = 0;
-static int _current_page = 0;
+static CachedEntry _cache[ENTRY_CACHE_SLOTS];
+static uint32_t _tick = 0;
 
-// Callbacks
-static HistoryPlayCallback _play_cb = nullptr;
+// One row per entry, newest first
+static ScrollList _list;
 
 // ------------------------------------------------------------------
-// LittleFS persistence
+// Index
 // ------------------------------------------------------------------
 
-static bool save_to_file() {
-    File f = LittleFS.open(HISTORY_FILE, "w");
-    if (!f) {
-        Serial.println("[History] Failed to open file for writing");
-        return false;
+static uint32_t station_hash(const char* id) {
+    uint32_t h = fnv1a_str(id);
+    return h ? h : 1;
+}
+
+static uint16_t slot_of(uint32_t seq) {
+    return (seq - 1) % MAX_HISTORY;
+}
+
+static void index_add(uint16_t slot) {
+    uint16_t& head = _buckets[_keys[slot].hash % INDEX_BUCKETS];
+    _next[slot] = head;
+    head = slot;
+}
+
+static void index_remove(uint16_t slot) {
+    uint16_t* link = &_buckets[_keys[slot].hash % INDEX_BUCKETS];
+    while (*link != NO_SLOT) {
+        if (*link == slot) {
+            *link = _next[slot];
+            return;
+        }
+        link = &_next[*link];
     }
+}
 
-    DynamicJsonDocument doc(4096);
-    JsonArray arr = doc.to<JsonArray>();
-
-    for (int i = 0; i < _count; i++) {
-        JsonObject obj = arr.createNestedObject();
-        obj["i"] = _entries[i].station_id;
-        obj["t"] = _entries[i].title;
-        obj["p"] = _entries[i].place;
-        obj["c"] = _entries[i].country;
-        obj["a"] = _entries[i].lat;
-        obj["o"] = _entries[i].lon;
+static void clear_index() {
+    for (int i = 0; i < INDEX_BUCKETS; i++) _buckets[i] = NO_SLOT;
+}
+
+static void mark_key_dirty(uint16_t slot) {
+    _dirty_keys[slot / 32] |= 1UL << (slot % 32);
+}
+
+// ------------------------------------------------------------------
+// Entry cache
+// ------------------------------------------------------------------
+
+static bool flush_dirty();
+
+// Forget a cached entry and unpin its station
+static void cache_drop(CachedEntry& c) {
+    if (c.seq) station_table_release(c.station);
+    c.seq = 0;
+    c.dirty = false;
+}
+
+static CachedEntry* cache_find(uint16_t slot) {
+    for (int i = 0; i < ENTRY_CACHE_SLOTS; i++) {
+        CachedEntry& c = _cache[i];
+        if (c.seq && c.slot == slot && c.seq == _keys[slot].seq) return &c;
     }
+    return nullptr;
+}
 
-    serializeJson(doc, f);
+// Least recently used clean slot; with every slot waiting to be written,
+// write them now
+static CachedEntry* cache_victim() {
+    for (int pass = 0; pass < 2; pass++) {
+        CachedEntry* victim = nullptr;
+        for (int i = 0; i < ENTRY_CACHE_SLOTS; i++) {
+            CachedEntry& c = _cache[i];
+            if (c.dirty) continue;
+            if (!victim || c.last_used < victim->last_used) victim = &c;
+        }
+        if (victim) {
+            cache_drop(*victim);
+            return victim;
+        }
+        flush_dirty();
+    }
+    Serial.println("[History] Cache full of unwritten entries, dropping one");
+    cache_drop(_cache[0]);
+    return &_cache[0];
+}
+
+// Entry in slot, from the cache or read from the file
+static const HistoryEntry* entry_at(uint16_t slot) {
+    CachedEntry* c = cache_find(slot);
+    if (!c) {
+        if (!_file) return nullptr;
+        c = cache_victim();
+        uint8_t rec[ENTRY_BYTES];
+        HistoryEntry e;
+        if (!_file.seek(ENTRIES_OFFSET + (size_t)slot * ENTRY_BYTES) ||
+            _file.read(rec, ENTRY_BYTES) != ENTRY_BYTES ||
+            !station_unpack_meta(rec, ENTRY_BYTES, &e)) {
+            Serial.printf("[History] Failed to read slot %u\n", slot);
+            return nullptr;
+        }
+        c->station = station_table_acquire(e);
+        if (c->station == STATION_NONE) return nullptr;
+        c->seq = _keys[slot].seq;
+        c->slot = slot;
+    }
+    c->last_used = ++_tick;
+    return station_table_get(c->station);
+}
+
+// Live slot holding station_id, or NO_SLOT
+static uint16_t index_find(const char* station_id, uint32_t hash) {
+    for (uint16_t s = _buckets[hash % INDEX_BUCKETS]; s != NO_SLOT; s = _next[s]) {
+        if (_keys[s].hash != hash) continue;
+        const HistoryEntry* e = entry_at(s);
+        if (e && strcmp(e->station_id, station_id) == 0) return s;
+    }
+    return NO_SLOT;
+}
+
+// Take a live slot out of the history (superseded or overwritten)
+static void drop_slot(uint16_t slot) {
+    CachedEntry* c = cache_find(slot);
+    if (c) cache_drop(*c);
+    index_remove(slot);
+    _keys[slot].seq = 0;
+    mark_key_dirty(slot);
+    _count--;
+    _order_valid = false;
+}
+
+// Newest first: walk back from the newest seq, a ring's worth
+static void rebuild_order() {
+    int n = 0;
+    for (uint32_t seq = _seq; seq > 0 && _seq - seq < MAX_HISTORY; seq--) {
+        uint16_t slot = slot_of(seq);
+        if (_keys[slot].seq == seq) _order[n++] = slot;
+    }
+    _count = n;
+    _order_valid = true;
+}
+
+// ------------------------------------------------------------------
+// Persistence
+// ------------------------------------------------------------------
+
+// persist.h flush: waiting entries, then changed keys, then one sync
+static bool flush_dirty() {
+    if (!_file) return false;
+
+    for (int i = 0; i < ENTRY_CACHE_SLOTS; i++) {
+        CachedEntry& c = _cache[i];
+        if (!c.dirty) continue;
+        uint8_t rec[ENTRY_BYTES] = {};
+        station_pack_meta(*station_table_get(c.station), rec);
+        if (!_file.seek(ENTRIES_OFFSET + (size_t)c.slot * ENTRY_BYTES) ||
+            _file.write(rec, ENTRY_BYTES) != ENTRY_BYTES) {
+            Serial.println("[History] Failed to save history");
+            return false;
+        }
+    }
+    for (int w = 0; w < (MAX_HISTORY + 31) / 32; w++) {
+        for (uint32_t bits = _dirty_keys[w]; bits; bits &= bits - 1) {
+            uint16_t slot = w * 32 + __builtin_ctz(bits);
+            if (!_file.seek(KEYS_OFFSET + (size_t)slot * sizeof(HistoryKey)) ||
+                _file.write((const uint8_t*)&_keys[slot], sizeof(HistoryKey)) != sizeof(HistoryKey)) {
+                Serial.println("[History] Failed to save history");
+                return false;
+            }
+        }
+    }
+    _file.flush();
+
+    for (int i = 0; i < ENTRY_CACHE_SLOTS; i++) _cache[i].dirty = false;
+    memset(_dirty_keys, 0, sizeof(_dirty_keys));
+    return true;
+}
+
+// A new, empty ring: header and a zeroed key table
+static bool create_ring() {
+    File f = LittleFS.open(HISTORY_FILE, "w");
+    if (!f) return false;
+    RingHeader h = {RING_MAGIC, MAX_HISTORY, ENTRY_BYTES, places_db_fingerprint()};
+    bool ok = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h);
+    HistoryKey zero[32] = {};
+    for (int i = 0; ok && i < MAX_HISTORY; i += 32) {
+        size_t n = min(32, MAX_HISTORY - i) * sizeof(HistoryKey);
+        ok = f.write((const uint8_t*)zero, n) == n;
+    }
     f.close();
-    Serial.printf("[History] Saved %d entries\n", _count);
+    return ok;
+}
+
+// Entries written against another places.bin: rewrite each one with its
+// place left empty, so no handle is read against the new file
+static bool forget_places() {
+    HistoryKey key;
+    for (int slot = 0; slot < MAX_HISTORY; slot++) {
+        if (!_file.seek(KEYS_OFFSET + (size_t)slot * sizeof(HistoryKey)) ||
+            _file.read((uint8_t*)&key, sizeof(key)) != sizeof(key)) {
+            return false;
+        }
+        if (!key.seq) continue;
+        uint8_t rec[ENTRY_BYTES];
+        HistoryEntry e;
+        size_t at = ENTRIES_OFFSET + (size_t)slot * ENTRY_BYTES;
+        if (!_file.seek(at) || _file.read(rec, ENTRY_BYTES) != ENTRY_BYTES) return false;
+        if (!station_unpack_meta(rec, ENTRY_BYTES, &e, false)) continue;
+        memset(rec, 0, sizeof(rec));
+        station_pack_meta(e, rec);
+        if (!_file.seek(at) || _file.write(rec, ENTRY_BYTES) != ENTRY_BYTES) return false;
+    }
+    uint32_t places = places_db_fingerprint();
+    if (!_file.seek(offsetof(RingHeader, places)) ||
+        _file.write((const uint8_t*)&places, sizeof(places)) != sizeof(places)) {
+        return false;
+    }
+    _file.flush();
     return true;
 }
 
-static bool load_from_file() {
-    if (!LittleFS.exists(HISTORY_FILE)) {
-        Serial.println("[History] No history file found");
-        return true;
+static bool open_ring() {
+    _file = LittleFS.open(HISTORY_FILE, "r+");
+    if (_file) {
+        RingHeader h;
+        bool read = _file.read((uint8_t*)&h, sizeof(h)) == sizeof(h);
+        bool ok = read && h.magic == RING_MAGIC && h.capacity == MAX_HISTORY &&
+                  h.entry_size == ENTRY_BYTES;
+        // Without places.bin this boot there is nothing to compare with:
+        // keep the places for a boot that loads it
+        if (ok && places_db_loaded() && h.places != places_db_fingerprint()) {
+            Serial.println("[History] places.bin changed, older entries lose their places");
+            ok = forget_places();
+        }
+        if (ok) return true;
+        _file.close();
+        if (read && h.magic == LEGACY_RING_MAGIC) {
+            // Kept aside for import_legacy()
+            LittleFS.remove(LEGACY_RING_FILE);
+            LittleFS.rename(HISTORY_FILE, LEGACY_RING_FILE);
+        } else {
+            Serial.println("[History] Ring file has another layout, starting empty");
+        }
     }
+    if (!create_ring()) return false;
+    _file = LittleFS.open(HISTORY_FILE, "r+");
+    return (bool)_file;
+}
 
-    File f = LittleFS.open(HISTORY_FILE, "r");
+// Key table into RAM, then the index
+static bool load_keys() {
+    if (!_file.seek(KEYS_OFFSET)) return false;
+    size_t bytes = MAX_HISTORY * sizeof(HistoryKey);
+    if (_file.read((uint8_t*)_keys, bytes) != bytes) return false;
+
+    _seq = 0;
+    for (int slot = 0; slot < MAX_HISTORY; slot++) _seq = max(_seq, _keys[slot].seq);
+    clear_index();
+    for (int slot = 0; slot < MAX_HISTORY; slot++) {
+        // A slot whose seq is outside the ring's window was never committed
+        uint32_t seq = _keys[slot].seq;
+        if (!seq) continue;
+        if (_seq - seq >= MAX_HISTORY || slot_of(seq) != slot) {
+            _keys[slot].seq = 0;
+            continue;
+        }
+        index_add(slot);
+    }
+    rebuild_order();
+    return true;
+}
+
+static bool record_entry(const HistoryEntry& entry);
+
+// Older firmware kept history as JSON, newest first
+static bool load_legacy_json() {
+    File f = LittleFS.open(LEGACY_HISTORY_FILE, "r");
     if (!f) {
         Serial.println("[History] Failed to open history file");
         return false;
     }
 
-    DynamicJsonDocument doc(4096);
+    JsonArenaDoc doc(JSON_ARENA_FILE);
     DeserializationError error = deserializeJson(doc, f);
     f.close();
 
@@ -90,67 +398,179 @@ static bool load_from_file() {
         return false;
     }
 
-    _count = 0;
+    // Oldest first, so the newest ends up on top
     JsonArray arr = doc.as<JsonArray>();
-    for (JsonObject obj : arr) {
-        if (_count >= MAX_HISTORY) break;
-
-        HistoryEntry& e = _entries[_count];
+    for (int i = (int)arr.size() - 1; i >= 0; i--) {
+        JsonObject obj = arr[i];
+        HistoryEntry e = {};
         strncpy(e.station_id, obj["i"] | "", sizeof(e.station_id) - 1);
-        e.station_id[sizeof(e.station_id) - 1] = '\0';
         strncpy(e.title, obj["t"] | "", sizeof(e.title) - 1);
-        e.title[sizeof(e.title) - 1] = '\0';
         strncpy(e.place, obj["p"] | "", sizeof(e.place) - 1);
-        e.place[sizeof(e.place) - 1] = '\0';
         strncpy(e.country, obj["c"] | "", sizeof(e.country) - 1);
-        e.country[sizeof(e.country) - 1] = '\0';
         e.lat = obj["a"] | 0.0f;
         e.lon = obj["o"] | 0.0f;
+        record_entry(e);
+    }
+
+    Serial.printf("[History] Converted %d entries from JSON\n", _count);
+    return true;
+}
+
+// Older firmware kept up to 20 state store slots stamped with a seq
+static int load_legacy_slots() {
+    static LegacyRecord records[LEGACY_SLOTS];
+    int n = 0;
+    while (n < LEGACY_SLOTS &&
+           state_store_get(STATE_KEY_HISTORY + n, &records[n], sizeof(LegacyRecord)) ==
+               (int)sizeof(LegacyRecord)) {
+        n++;
+    }
+    if (n == 0) return 0;
+
+    // Oldest first
+    for (int done = 0; done < n; done++) {
+        int oldest = -1;
+        for (int i = 0; i < n; i++) {
+            if (records[i].seq && (oldest < 0 || records[i].seq < records[oldest].seq)) oldest = i;
+        }
+        record_entry(records[oldest].entry);
+        records[oldest].seq = 0;
+    }
+    Serial.printf("[History] Imported %d entries from the state store\n", n);
+    return n;
+}
+
+// Older firmware kept the ring with whole StationMeta entries: re-record
+// its plays oldest first
+static bool load_legacy_ring() {
+    File f = LittleFS.open(LEGACY_RING_FILE, "r");
+    if (!f) return false;
+    LegacyRingHeader h;
+    size_t bytes = MAX_HISTORY * sizeof(HistoryKey);
+    HistoryKey* keys = (HistoryKey*)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+    bool ok = keys && f.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+              h.magic == LEGACY_RING_MAGIC && h.capacity == MAX_HISTORY &&
+              h.entry_size == sizeof(HistoryEntry) && f.seek(LEGACY_KEYS_OFFSET) &&
+              f.read((uint8_t*)keys, bytes) == bytes;
+
+    uint32_t newest = 0;
+    for (int slot = 0; ok && slot < MAX_HISTORY; slot++) newest = max(newest, keys[slot].seq);
+    uint32_t oldest = newest >= MAX_HISTORY ? newest - MAX_HISTORY + 1 : 1;
+    for (uint32_t seq = oldest; ok && newest && seq <= newest; seq++) {
+        uint16_t slot = slot_of(seq);
+        if (keys[slot].seq != seq) continue;
+        HistoryEntry e;
+        if (!f.seek(LEGACY_ENTRIES_OFFSET + (size_t)slot * sizeof(HistoryEntry)) ||
+            f.read((uint8_t*)&e, sizeof(e)) != sizeof(e)) {
+            break;
+        }
+        e.station_id[sizeof(e.station_id) - 1] = '\0';
+        if (e.station_id[0]) record_entry(e);
+    }
+    free(keys);
+    f.close();
+    if (ok) Serial.printf("[History] Converted %d entries to packed records\n", _count);
+    return ok;
+}
+
+static void import_legacy() {
+    bool from_ring = LittleFS.exists(LEGACY_RING_FILE) && load_legacy_ring();
+    bool from_slots = !from_ring && load_legacy_slots() > 0;
+    bool from_json = !from_ring && !from_slots && LittleFS.exists(LEGACY_HISTORY_FILE) &&
+                     load_legacy_json();
+    if (LittleFS.exists(LEGACY_RING_FILE) && (!from_ring || flush_dirty())) {
+        LittleFS.remove(LEGACY_RING_FILE);
+    }
+    if (from_ring || (!from_slots && !from_json)) return;
+    if (!flush_dirty()) return;
+
+    // Highest slot first: an import cut short still leaves a filled prefix
+    if (from_slots) {
+        for (int slot = LEGACY_SLOTS - 1; slot >= 0; slot--) {
+            state_store_remove(STATE_KEY_HISTORY + slot);
+        }
+    }
+    if (from_json) LittleFS.remove(LEGACY_HISTORY_FILE);
+}
+
+static bool load_ring() {
+    size_t bytes = MAX_HISTORY * (sizeof(HistoryKey) + 2 * sizeof(uint16_t));
+    uint8_t* mem = (uint8_t*)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+    if (!mem) {
+        Serial.println("[History] No memory for the history index");
+        return false;
+    }
+    _keys = (HistoryKey*)mem;
+    _next = (uint16_t*)(mem + MAX_HISTORY * sizeof(HistoryKey));
+    _order = _next + MAX_HISTORY;
 
-        _count++;
+    if (!open_ring() || !load_keys()) {
+        Serial.println("[History] Failed to open history file");
+        if (_file) _file.close();
+        return false;
     }
+    if (_count == 0) import_legacy();
 
-    Serial.printf("[History] Loaded %d entries\n", _count);
+    if (_count == 0) Serial.println("[History] No saved history");
+    else Serial.printf("[History] Loaded %d entries\n", _count);
     return true;
 }
 
+// Add a play on top: O(1) index lookups, one cache entry, one or two
+// keys. True if it replaced an older play of the same station.
+static bool record_entry(const HistoryEntry& entry) {
+    uint32_t hash = station_hash(entry.station_id);
+    uint16_t old = index_find(entry.station_id, hash);
+    if (old != NO_SLOT) drop_slot(old);
+
+    CachedEntry* c = cache_victim();
+    StationHandle station = station_table_acquire(entry);
+    if (station == STATION_NONE) return false;
+
+    uint32_t seq = ++_seq;
+    uint16_t slot = slot_of(seq);
+    if (_keys[slot].seq) drop_slot(slot);   // The oldest play leaves the ring
+
+    _keys[slot].seq = seq;
+    _keys[slot].hash = hash;
+    index_add(slot);
+    mark_key_dirty(slot);
+
+    c->station = station;
+    c->seq = seq;
+    c->slot = slot;
+    c->dirty = true;
+    c->last_used = ++_tick;
+
+    _count++;
+    _order_valid = false;
+    return old != NO_SLOT;
+}
+
 // ------------------------------------------------------------------
 // Public API
 // ------------------------------------------------------------------
 
+static void draw_item(Arduino_GFX* gfx, int index, int y, int pressed);
+
 void history_init() {
     _count = 0;
-    _current_page = 0;
-    load_from_file();
+    clear_index();
+    load_ring();
+    scroll_list_init(_list, HISTORY_LIST_ID, ITEMS_START_Y, HIST_AREA_BOTTOM - ITEMS_START_Y,
+                     ITEM_HEIGHT, draw_item);
+    scroll_list_set_count(_list, _count);
 }
 
 void history_record(const HistoryEntry& entry) {
-    if (entry.station_id[0] == '\0') return;
-
-    // Deduplicate: remove existing entry with same station_id
-    for (int i = 0; i < _count; i++) {
-        if (strcmp(_entries[i].station_id, entry.station_id) == 0) {
-            // Shift everything from 0..i-1 down by one
-            for (int j = i; j > 0; j--) {
-                _entries[j] = _entries[j - 1];
-            }
-            _entries[0] = entry;
-            save_to_file();
-            Serial.printf("[History] Moved to top: %s\n", entry.title);
-            return;
-        }
-    }
+    if (!_file || entry.station_id[0] == '\0') return;
 
-    // New entry: shift everything down, insert at front
-    int new_count = (_count < MAX_HISTORY) ? _count + 1 : MAX_HISTORY;
-    for (int i = new_count - 1; i > 0; i--) {
-        _entries[i] = _entries[i - 1];
-    }
-    _entries[0] = entry;
-    _count = new_count;
+    bool moved = record_entry(entry);
+    scroll_list_set_count(_list, _count);
+    persist_mark_dirty(flush_dirty);
 
-    save_to_file();
-    Serial.printf("[History] Recorded: %s (%s)\n", entry.title, entry.place);
+    if (moved) Serial.printf("[History] Moved to top: %s\n", entry.title);
+    else Serial.printf("[History] Recorded: %s (%s)\n", entry.title, entry.place);
 }
 
 int history_count() {
@@ -158,83 +578,79 @@ int history_count() {
 }
 
 const HistoryEntry* history_get(int index) {
-    if (index < 0 || index >= _count) return nullptr;
-    return &_entries[index];
+    if (!_file || index < 0 || index >= _count) return nullptr;
+    if (!_order_valid) rebuild_order();
+    return entry_at(_order[index]);
 }
 
 void history_clear() {
+    if (!_file) return;
+    _file.close();
+    LittleFS.remove(HISTORY_FILE);
+    memset(_keys, 0, MAX_HISTORY * sizeof(HistoryKey));
+    memset(_dirty_keys, 0, sizeof(_dirty_keys));
+    for (int i = 0; i < ENTRY_CACHE_SLOTS; i++) cache_drop(_cache[i]);
+    clear_index();
     _count = 0;
-    _current_page = 0;
-    if (LittleFS.exists(HISTORY_FILE)) {
-        LittleFS.remove(HISTORY_FILE);
-    }
+    _seq = 0;
+    _order_valid = true;
+    if (!open_ring()) Serial.println("[History] Failed to recreate history file");
+
+    scroll_list_set_count(_list, 0);
+    scroll_list_scroll_to_top(_list);
     Serial.println("[History] Cleared");
 }
 
 // ------------------------------------------------------------------
-// Pagination
+// Scrolling
 // ------------------------------------------------------------------
 
-int history_get_page() {
-    return _current_page;
-}
-
-int history_total_pages() {
-    if (_count == 0) return 1;
-    return (_count + HISTORY_PER_PAGE - 1) / HISTORY_PER_PAGE;
-}
-
-void history_set_page(int page) {
-    int total = history_total_pages();
-    _current_page = constrain(page, 0, total - 1);
+void history_scroll_to_top() {
+    scroll_list_scroll_to_top(_list);
 }
 
-void history_next_page() {
-    int total = history_total_pages();
-    _current_page = (_current_page + 1) % total;
-    Serial.printf("[History] Page %d/%d\n", _current_page + 1, total);
+void history_page_down() {
+    scroll_list_page_down(_list);
 }
 
 // ------------------------------------------------------------------
 // Rendering
 // ------------------------------------------------------------------
 
-static void draw_item(Arduino_GFX* gfx, int slot, const HistoryEntry& e) {
-    int y_top = ITEMS_START_Y + slot * ITEM_HEIGHT;
-    int card_y = y_top + 3;
+static void draw_item(Arduino_GFX* gfx, int index, int y, int pressed) {
+    const HistoryEntry* entry = history_get(index);
+    if (!entry) return;
+    const HistoryEntry& e = *entry;
+    int card_y = y + 3;
     int card_h = ITEM_HEIGHT - 6;
 
+    if (pressed != SCROLL_NOT_PRESSED) {
+        gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
+                            TH_CORNER_R, TH_CARD_HI);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TH_TEXT);
+        gfx->setCursor(10, card_y + 16);
+        char trunc_title[28];
+        strncpy(trunc_title, e.title, 27);
+        trunc_title[27] = '\0';
+        gfx->print(trunc_title);
+        return;
+    }
+
     // Card background
     gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
                         TH_CORNER_R, TH_CARD);
 
-    // Station title (Unicode font for CJK/Cyrillic support)
-    gfx->setFont(u8g2_font_cubic11_h_cjk);
-    gfx->setUTF8Print(true);
-    gfx->setTextSize(1);
-    gfx->setTextColor(TH_TEXT);
-    gfx->setCursor(10, card_y + 18);
-
-    char trunc_title[48];
-    strncpy(trunc_title, e.title, 47);
-    trunc_title[47] = '\0';
-    utf8_truncate(trunc_title, 26);
-    gfx->print(trunc_title);
-
-    // Place + country below title
-    gfx->setTextColor(TH_TEXT_SEC);
-    gfx->setCursor(10, card_y + 38);
-    char place_str[48];
+    // Station title + place (Unicode font for CJK/Cyrillic support),
+    // blitted from a cached sprite once rendered
+    char place_str[96];
     snprintf(place_str, sizeof(place_str), "%s, %s", e.place, e.country);
-    utf8_truncate(place_str, 26);
-    gfx->print(place_str);
 
-    // Clear Unicode font
-    gfx->setFont((const uint8_t*)nullptr);
-    gfx->setUTF8Print(false);
+    text_sprite_draw_card(gfx, 10, card_y + 4, TH_CARD_MARGIN + TH_CARD_W - TH_CORNER_R - 10,
+                          e.title, place_str);
 }
 
-void history_render(Arduino_GFX* gfx, int page) {
+void history_render(Arduino_GFX* gfx) {
     if (!gfx) return;
 
     // Clear main area
@@ -255,6 +671,9 @@ void history_render(Arduino_GFX* gfx, int page) {
     // Divider under title
     gfx->drawFastHLine(5, TITLE_HEIGHT - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
 
+    // Rendered even when empty, so drags go to this list
+    scroll_list_render(gfx, _list);
+
     if (_count == 0) {
         gfx->setTextSize(1);
         gfx->setTextColor(TH_TEXT_DIM);
@@ -264,24 +683,6 @@ void history_render(Arduino_GFX* gfx, int page) {
         gfx->print("Play a station and");
         gfx->setCursor(15, 250);
         gfx->print("it will appear here");
-        return;
-    }
-
-    // Draw items for current page
-    int start_idx = page * HISTORY_PER_PAGE;
-    int end_idx = min(start_idx + HISTORY_PER_PAGE, _count);
-
-    for (int i = start_idx; i < end_idx; i++) {
-        draw_item(gfx, i - start_idx, _entries[i]);
-    }
-
-    // Page indicator (only if multiple pages)
-    int total_pages = history_total_pages();
-    if (total_pages > 1) {
-        gfx->setTextSize(1);
-        gfx->setTextColor(TH_TEXT_SEC);
-        gfx->setCursor(55, PAGE_INDICATOR_Y);
-        gfx->printf("< %d / %d >", page + 1, total_pages);
     }
 }
 
@@ -289,39 +690,15 @@ void history_render(Arduino_GFX* gfx, int page) {
 // Touch handling
 // ------------------------------------------------------------------
 
-void history_set_play_callback(HistoryPlayCallback cb) {
-    _play_cb = cb;
-}
-
 bool history_handle_touch(int x, int y, Arduino_GFX* gfx) {
-    if (y < ITEMS_START_Y) return false;
-    if (y >= ITEMS_START_Y + HISTORY_PER_PAGE * ITEM_HEIGHT) return false;
-
-    int slot = (y - ITEMS_START_Y) / ITEM_HEIGHT;
-    int global_idx = _current_page * HISTORY_PER_PAGE + slot;
-
-    if (global_idx < 0 || global_idx >= _count) return false;
-
-    // Play — brief highlight
-    Serial.printf("[History] Play tap: %s\n", _entries[global_idx].title);
-    if (gfx) {
-        int y_top = ITEMS_START_Y + slot * ITEM_HEIGHT;
-        int card_y = y_top + 3;
-        int card_h = ITEM_HEIGHT - 6;
-        gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
-                            TH_CORNER_R, TH_CARD_HI);
-        gfx->setTextSize(1);
-        gfx->setTextColor(TH_TEXT);
-        gfx->setCursor(10, card_y + 16);
-        char trunc_title[28];
-        strncpy(trunc_title, _entries[global_idx].title, 27);
-        trunc_title[27] = '\0';
-        gfx->print(trunc_title);
-        delay(80);
-    }
-    if (_play_cb) {
-        _play_cb(global_idx);
-    }
+    int index = scroll_list_hit(_list, y);
+    const HistoryEntry* e = history_get(index);
+    if (!e) return false;
+
+    // Play — brief highlight; the bus handler redraws the view
+    Serial.printf("[History] Play tap: %s\n", e->title);
+    scroll_list_press(gfx, _list, index, 0, 80);
+    event_bus_post_value(BUS_HISTORY_PLAY, index);
 
     return true;
 }
@@ -1,32 +1,23 @@
 /**
  * Playback history for RadioWall.
  *
- * Automatically records the last 20 stations played.
- * Stored as JSON on LittleFS, newest first.
+ * Automatically records the last MAX_HISTORY plays, one entry per
+ * station. Stored in a ring file on LittleFS, shown newest first; only the
+ * entries on screen are read into RAM.
  */
 
 #ifndef HISTORY_H
 #define HISTORY_H
 
 #include <Arduino.h>
+#include "station_table.h"
 
 // Forward declaration
 class Arduino_GFX;
 
-#define MAX_HISTORY 20
-#define HISTORY_PER_PAGE 6
+#define MAX_HISTORY 2000
 
-struct HistoryEntry {
-    char station_id[16];
-    char title[64];
-    char place[32];
-    char country[4];
-    float lat;
-    float lon;
-};
-
-// Callback when a history entry is tapped to replay
-typedef void (*HistoryPlayCallback)(int index);
+typedef StationMeta HistoryEntry;
 
 // Initialize (load from LittleFS)
 void history_init();
@@ -39,17 +30,13 @@ int history_count();
 const HistoryEntry* history_get(int index);
 void history_clear();
 
-// Pagination
-int history_get_page();
-int history_total_pages();
-void history_set_page(int page);
-void history_next_page();
+// Scrolling: back to the newest entry, or one screen on (wraps to the top)
+void history_scroll_to_top();
+void history_page_down();
 
 // Rendering + touch
-void history_render(Arduino_GFX* gfx, int page);
+void history_render(Arduino_GFX* gfx);
+// A hit posts BUS_HISTORY_PLAY (event_bus.h)
 bool history_handle_touch(int x, int y, Arduino_GFX* gfx);
 
-// Callbacks
-void history_set_play_callback(HistoryPlayCallback cb);
-
 #endif // HISTORY_H
@@ -0,0 +1,39 @@
+/**
+ * Hot path placement for RadioWall.
+ *
+ * Code runs from flash through the instruction cache, which the WiFi and
+ * mbedTLS code on core 0 shares. A map redraw or a lookup right after a
+ * TLS handshake starts with its loops evicted. HOT_PATH marks the few
+ * functions that the BENCH cases and the span tracer show to be the
+ * inner loops of a tap or a redraw:
+ *
+ *   map.slice, map.tile*, map.view5     RLE/LZ4 decode, run packing, tile blits
+ *   places.knn20, places.lookup span    the distance scan over a cell's places
+ *   display.flush                       QSPI pixel swap (Arduino_ESP32QSPI.cpp)
+ *   touch reader                        report parse, every 4 ms with a finger down
+ *
+ * Built with -DHOT_IRAM, HOT_PATH is IRAM_ATTR: the function goes to IRAM
+ * and never misses the cache. Everything else, init code included, stays
+ * in flash. The Arduino framework links against prebuilt IDF libraries
+ * with a fixed linker script, so IDF linker fragments (.lf) are not
+ * processed; the .iram1 section that IRAM_ATTR places functions in is
+ * the placement the script does offer. Functions they call (libm,
+ * newlib) are not moved.
+ *
+ * BENCH reports each case's first (cold) call beside the median, and the
+ * check after a new build prints both before and after (bench.h): flash a
+ * build with -DHOT_IRAM over one without to get the comparison.
+ */
+
+#ifndef HOT_PATH_H
+#define HOT_PATH_H
+
+#include <Arduino.h>
+
+#ifdef HOT_IRAM
+#define HOT_PATH IRAM_ATTR
+#else
+#define HOT_PATH
+#endif
+
+#endif // HOT_PATH_H
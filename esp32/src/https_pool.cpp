@@ -0,0 +1,824 @@
+/**
+ * Shared HTTPS connection pool for RadioWall.
+ *
+ * Each slot holds one WiFiClientSecure bound to a host; a request reuses an
+ * idle slot for the same host if it is still fresh, otherwise it takes a
+ * free slot (or evicts the least recently used idle one) and does a full
+ * handshake. Requests come from the network worker and, for settings and
+ * serial commands, the loop task, so slot bookkeeping is done under
+ * _pool_lock. A slot marked in_use belongs to one caller until released.
+ *
+ * TLS handshakes are admitted one pair at a time (_handshake_sem), and only
+ * once the internal heap has a block that fits one. While it does not,
+ * idle sessions are closed, least recently used first (each holds its
+ * mbedTLS record buffers); then the request waits for others to finish,
+ * up to TLS_ADMIT_WAIT_MS, instead of failing halfway through a handshake.
+ */
+
+#include "https_pool.h"
+#include "serial_cmd.h"
+#include "trace.h"
+#include "dns_cache.h"
+#include "tls_trust.h"
+#include "wifi_link.h"
+#include "net_fault.h"
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static const int POOL_SIZE = 9;                      // radio.garden + master + 7 slaves (fan-out)
+static const unsigned long IDLE_TIMEOUT_MS = 20000;  // Close before the server does
+static const int MAX_HOSTS = POOL_SIZE;              // Hosts tracked in stats
+static const size_t RX_BUF_SIZE = 1024;              // Per-slot socket read buffer
+static const size_t LINE_MAX = 256;                  // Longest header line kept
+
+// Handshake admission. The framework's mbedTLS has fixed record buffers
+// (16 KB in, 4 KB out); the handshake adds its own state and the peer's
+// certificate chain on top.
+static const size_t TLS_HANDSHAKE_BLOCK = 32 * 1024;
+static const int MAX_HANDSHAKES = 2;                  // In flight at once
+// Open sessions keep their record buffers (~20 KB internal each) while
+// idle, so the pool holds fewer TLS sessions than slots; plain-HTTP slots
+// are not limited
+static const int MAX_TLS_SESSIONS = HTTPS_TLS_SESSIONS_MAX;
+static const unsigned long TLS_ADMIT_WAIT_MS = 3000;  // Capped by the request timeout
+static const unsigned long TLS_ADMIT_POLL_MS = 20;
+
+// Hedged requests: the second copy goes out after the p95 of the host's
+// last LATENCY_SAMPLES request times, kept within these bounds
+static const int LATENCY_SAMPLES = 32;
+static const int HEDGE_MIN_SAMPLES = 8;              // Fewer: HEDGE_DEFAULT_MS
+static const unsigned long HEDGE_DEFAULT_MS = 1500;
+static const unsigned long HEDGE_MIN_MS = 250;       // Below this a hedge rarely wins
+static const unsigned long HEDGE_MAX_MS = 3000;
+
+// The framework's WiFiClientSecure takes a connect timeout only on the
+// overloads without an SNI name; the one with a name reuses the last value
+// set, which is otherwise its 30 s default
+struct PoolTlsClient : WiFiClientSecure {
+    void set_connect_timeout(unsigned long ms) { _timeout = (int)ms; }
+};
+
+struct HttpsConn {
+    PoolTlsClient client;
+    WiFiClient plain;           // Port 80, for LAN devices that serve HTTP
+    bool secure;                // Which of the two carries this connection
+    char host[40];
+    unsigned long last_used;
+    unsigned long timeout_ms;   // Per-request read timeout
+    bool in_use;
+    uint8_t rx[RX_BUF_SIZE];    // Bytes read from the socket, not yet consumed
+    uint16_t rx_pos;
+    uint16_t rx_len;
+};
+static HttpsConn _pool[POOL_SIZE];
+
+static Client& io(HttpsConn* conn) {
+    return conn->secure ? (Client&)conn->client : (Client&)conn->plain;
+}
+static SemaphoreHandle_t _pool_lock = xSemaphoreCreateMutex();
+static SemaphoreHandle_t _handshake_sem = xSemaphoreCreateCounting(MAX_HANDSHAKES, MAX_HANDSHAKES);
+
+// Per-host counters for the H command and the metrics endpoint
+static HttpsHostStats _stats[MAX_HOSTS];
+static int _stats_count = 0;
+
+// Recent request -> response head times, per _stats entry (ring buffer)
+struct HostLatency {
+    uint16_t ms[LATENCY_SAMPLES];
+    uint8_t count;
+    uint8_t next;
+};
+static HostLatency _latency[MAX_HOSTS];
+
+static HttpsHostStats* stats_for(const char* host) {
+    for (int i = 0; i < _stats_count; i++) {
+        if (strcmp(_stats[i].host, host) == 0) return &_stats[i];
+    }
+    if (_stats_count >= MAX_HOSTS) return nullptr;
+    memset(&_latency[_stats_count], 0, sizeof(HostLatency));
+    HttpsHostStats* s = &_stats[_stats_count++];
+    memset(s, 0, sizeof(*s));
+    strncpy(s->host, host, sizeof(s->host) - 1);
+    return s;
+}
+
+// A response head arrived elapsed ms after its request went out
+static void record_request(const char* host, uint32_t elapsed) {
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    HttpsHostStats* s = stats_for(host);
+    if (s) {
+        s->requests++;
+        s->request_ms += elapsed;
+        if (elapsed > s->max_request_ms) s->max_request_ms = elapsed;
+        HostLatency& l = _latency[s - _stats];
+        l.ms[l.next] = (uint16_t)min(elapsed, (uint32_t)UINT16_MAX);
+        l.next = (l.next + 1) % LATENCY_SAMPLES;
+        if (l.count < LATENCY_SAMPLES) l.count++;
+    }
+    xSemaphoreGive(_pool_lock);
+}
+
+// How long a hedged request waits before sending its second copy
+static unsigned long hedge_delay_ms(const char* host) {
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    unsigned long delay_ms = HEDGE_DEFAULT_MS;
+    HttpsHostStats* s = stats_for(host);
+    if (s && _latency[s - _stats].count >= HEDGE_MIN_SAMPLES) {
+        // Insertion sort of a copy: 32 entries
+        const HostLatency& l = _latency[s - _stats];
+        uint16_t sorted[LATENCY_SAMPLES];
+        for (int i = 0; i < l.count; i++) {
+            uint16_t v = l.ms[i];
+            int j = i;
+            for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+            sorted[j] = v;
+        }
+        delay_ms = constrain((unsigned long)sorted[l.count * 95 / 100], HEDGE_MIN_MS, HEDGE_MAX_MS);
+    }
+    if (s) s->hedge_ms = delay_ms;
+    xSemaphoreGive(_pool_lock);
+    return delay_ms;
+}
+
+// ------------------------------------------------------------------
+// Handshake admission
+// ------------------------------------------------------------------
+
+static size_t largest_internal_block() {
+    return heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+// Secure sessions open or being opened, other than self
+static int tls_sessions(HttpsConn* self) {
+    int n = 0;
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        const HttpsConn& c = _pool[i];
+        if (&c != self && c.secure && (c.in_use || c.host[0])) n++;
+    }
+    xSemaphoreGive(_pool_lock);
+    return n;
+}
+
+// Close the least recently used idle session other than self. False if
+// there is none.
+static bool close_idle_session(HttpsConn* self) {
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    HttpsConn* oldest = nullptr;
+    for (int i = 0; i < POOL_SIZE; i++) {
+        HttpsConn& c = _pool[i];
+        if (&c == self || c.in_use || !c.host[0] || !c.secure) continue;
+        if (!oldest || c.last_used < oldest->last_used) oldest = &c;
+    }
+    if (oldest) {
+        oldest->client.stop();
+        oldest->host[0] = '\0';
+    }
+    xSemaphoreGive(_pool_lock);
+    return oldest != nullptr;
+}
+
+// Wait for a handshake turn, a free session and a heap block that fits
+// it. On true, call tls_done() once the handshake is over.
+static bool tls_admit(HttpsConn* self, const char* host, unsigned long wait_ms) {
+    unsigned long start = millis();
+    wait_ms = min(wait_ms, TLS_ADMIT_WAIT_MS);
+    bool waited = false;
+    bool ok = false;
+
+    if (xSemaphoreTake(_handshake_sem, 0) != pdTRUE) {
+        waited = true;
+        ok = xSemaphoreTake(_handshake_sem, pdMS_TO_TICKS(wait_ms)) == pdTRUE;
+    } else {
+        ok = true;
+    }
+    while (ok && (tls_sessions(self) >= MAX_TLS_SESSIONS ||
+                  largest_internal_block() < TLS_HANDSHAKE_BLOCK)) {
+        if (close_idle_session(self)) continue;
+        if (millis() - start >= wait_ms) {
+            xSemaphoreGive(_handshake_sem);
+            ok = false;
+            break;
+        }
+        waited = true;
+        delay(TLS_ADMIT_POLL_MS);
+    }
+
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    HttpsHostStats* s = stats_for(host);
+    if (s && waited) s->admit_waits++;
+    if (s && !ok) s->admit_refused++;
+    xSemaphoreGive(_pool_lock);
+    if (!ok) {
+        Serial.printf("[HTTPS] %s: no room for a handshake after %lu ms "
+                      "(%d/%d sessions, largest block %u KB)\n",
+                      host, millis() - start, tls_sessions(self), MAX_TLS_SESSIONS,
+                      (unsigned)(largest_internal_block() / 1024));
+    }
+    return ok;
+}
+
+static void tls_done() {
+    xSemaphoreGive(_handshake_sem);
+}
+
+// Handshake plus the certificate check (tls_trust.h). A pinned name whose
+// certificate changed gets one more try with the full chain check.
+static bool connect_tls(HttpsConn* conn, IPAddress ip, const char* host, bool by_name,
+                        unsigned long timeout_ms) {
+    // TCP connect, then the handshake, each within the request's timeout
+    conn->client.set_connect_timeout(timeout_ms);
+    conn->client.setHandshakeTimeout(max(1UL, timeout_ms / 1000));
+    for (int attempt = 0; attempt < 2; attempt++) {
+        TlsCheck check = tls_trust_prepare(conn->client, host);
+        bool ok = by_name ? conn->client.connect(ip, 443, host, nullptr, nullptr, nullptr)
+                          : conn->client.connect(ip, 443);
+        if (!ok) return false;
+        if (tls_trust_accept(conn->client, host, check)) return true;
+        conn->client.stop();
+        if (check != TLS_CHECK_PIN || !by_name) return false;
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------
+// Pool
+// ------------------------------------------------------------------
+
+static HttpsConn* pool_acquire(const char* host, bool secure, unsigned long timeout_ms,
+                               bool* reused) {
+    // Test mode (net_fault.h): injected latency, drops and timeouts
+    if (!net_fault_admit(host, timeout_ms)) return nullptr;
+
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    unsigned long now = millis();
+    HttpsConn* spare = nullptr;
+
+    for (int i = 0; i < POOL_SIZE; i++) {
+        HttpsConn& c = _pool[i];
+        if (c.in_use) continue;
+        bool fresh = c.host[0] && io(&c).connected() && now - c.last_used < IDLE_TIMEOUT_MS;
+        if (fresh && c.secure == secure && strcmp(c.host, host) == 0) {
+            c.in_use = true;
+            *reused = true;
+            HttpsHostStats* s = stats_for(host);
+            if (s) s->reused++;
+            xSemaphoreGive(_pool_lock);
+            return &c;
+        }
+        // Prefer an empty slot, else the least recently used idle one
+        if (!spare || (spare->host[0] && (!c.host[0] || c.last_used < spare->last_used))) {
+            spare = &c;
+        }
+    }
+
+    if (!spare) {
+        xSemaphoreGive(_pool_lock);
+        Serial.println("[HTTPS] Connection pool exhausted");
+        return nullptr;
+    }
+
+    // Claim the slot, then handshake without holding the lock. It counts
+    // against MAX_TLS_SESSIONS from here.
+    spare->in_use = true;
+    spare->host[0] = '\0';
+    spare->secure = secure;
+    xSemaphoreGive(_pool_lock);
+
+    spare->client.stop();
+    spare->plain.stop();
+    spare->rx_pos = spare->rx_len = 0;
+
+    if (secure && !tls_admit(spare, host, timeout_ms)) {
+        xSemaphoreTake(_pool_lock, portMAX_DELAY);
+        spare->in_use = false;
+        xSemaphoreGive(_pool_lock);
+        return nullptr;
+    }
+
+    unsigned long start = millis();
+    uint32_t span = secure ? trace_begin(TRACE_TLS_CONNECT) : 0;
+    // Names connect by their cached address, with the name kept for SNI
+    IPAddress ip;
+    bool ok = false;
+    if (!secure) {
+        ok = (ip.fromString(host) || dns_cache_resolve(host, &ip)) &&
+             spare->plain.connect(ip, 80, (int32_t)timeout_ms);
+    } else if (ip.fromString(host)) {
+        ok = connect_tls(spare, ip, host, false, timeout_ms);
+    } else if (dns_cache_resolve(host, &ip)) {
+        ok = connect_tls(spare, ip, host, true, timeout_ms);
+        if (!ok) dns_cache_invalidate(host);
+    }
+    if (secure) {
+        trace_end(span);
+        tls_done();
+    }
+    if (!ok) {
+        Serial.printf("[HTTPS] Connection to %s failed\n", host);
+        xSemaphoreTake(_pool_lock, portMAX_DELAY);
+        spare->in_use = false;
+        xSemaphoreGive(_pool_lock);
+        return nullptr;
+    }
+
+    unsigned long elapsed = millis() - start;
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    HttpsHostStats* s = stats_for(host);
+    if (s) {
+        s->handshakes++;
+        s->handshake_ms += elapsed;
+    }
+    strncpy(spare->host, host, sizeof(spare->host) - 1);
+    spare->host[sizeof(spare->host) - 1] = '\0';
+    xSemaphoreGive(_pool_lock);
+    Serial.printf("[HTTPS] %s %s: %lu ms\n", secure ? "Handshake with" : "Plain HTTP to",
+                  host, elapsed);
+
+    *reused = false;
+    return spare;
+}
+
+void https_release(HttpsConn* conn, bool keep_alive) {
+    if (!conn) return;
+    if (!keep_alive) io(conn).stop();
+
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    if (!keep_alive) conn->host[0] = '\0';
+    conn->last_used = millis();
+    conn->in_use = false;
+    xSemaphoreGive(_pool_lock);
+}
+
+int https_pool_free_slots() {
+    int free_slots = 0;
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        if (!_pool[i].in_use) free_slots++;
+    }
+    xSemaphoreGive(_pool_lock);
+    return free_slots;
+}
+
+void https_pool_close_all() {
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        if (_pool[i].in_use) continue;
+        io(&_pool[i]).stop();
+        _pool[i].host[0] = '\0';
+    }
+    xSemaphoreGive(_pool_lock);
+}
+
+// ------------------------------------------------------------------
+// Buffered socket reader: the socket is read in blocks of up to
+// RX_BUF_SIZE; headers, chunk framing and body are all parsed from rx[].
+// ------------------------------------------------------------------
+
+// Make sure rx[] holds at least one unread byte. Waits up to the request
+// timeout; returns false on timeout or once the server has closed.
+static bool rx_fill(HttpsConn* conn) {
+    if (conn->rx_pos < conn->rx_len) return true;
+
+    Client& client = io(conn);
+    unsigned long timeout = millis() + conn->timeout_ms;
+    int avail;
+    while ((avail = client.available()) <= 0) {
+        if (!client.connected() || millis() > timeout) return false;
+        delay(1);
+    }
+
+    int n = client.read(conn->rx, min((size_t)avail, RX_BUF_SIZE));
+    if (n <= 0) return false;
+    conn->rx_pos = 0;
+    conn->rx_len = n;
+    return true;
+}
+
+static int rx_read(HttpsConn* conn) {
+    if (!rx_fill(conn)) return -1;
+    return conn->rx[conn->rx_pos++];
+}
+
+// Read one line (without CR/LF) into out; overlong lines are cut at cap-1.
+// Returns false if the connection ended before any newline.
+static bool rx_read_line(HttpsConn* conn, char* out, size_t cap) {
+    size_t len = 0;
+    while (true) {
+        if (!rx_fill(conn)) {
+            out[len] = '\0';
+            return false;
+        }
+        // Scan the buffered bytes for the newline in one go
+        uint8_t* start = conn->rx + conn->rx_pos;
+        size_t n = conn->rx_len - conn->rx_pos;
+        uint8_t* nl = (uint8_t*)memchr(start, '\n', n);
+        size_t take = nl ? (size_t)(nl - start) : n;
+        size_t copy = min(take, cap - 1 - len);
+        memcpy(out + len, start, copy);
+        len += copy;
+        conn->rx_pos += take + (nl ? 1 : 0);
+        if (nl) break;
+    }
+    if (len > 0 && out[len - 1] == '\r') len--;
+    out[len] = '\0';
+    return true;
+}
+
+// Copy up to n buffered/socket bytes into dst (nullptr = discard)
+static size_t rx_read_bytes(HttpsConn* conn, uint8_t* dst, size_t n) {
+    if (!rx_fill(conn)) return 0;
+    size_t take = min(n, (size_t)(conn->rx_len - conn->rx_pos));
+    if (dst) memcpy(dst, conn->rx + conn->rx_pos, take);
+    conn->rx_pos += take;
+    return take;
+}
+
+// ------------------------------------------------------------------
+// HTTP/1.1 framing
+// ------------------------------------------------------------------
+
+// Send the whole request in one write (one TLS record)
+static bool send_request(HttpsConn* conn, const char* path, const char* accept,
+                         const char* accept_encoding = nullptr) {
+    char req[768];
+    int len = snprintf(req, sizeof(req),
+                       "GET %s HTTP/1.1\r\n"
+                       "Host: %s\r\n"
+                       "User-Agent: RadioWall/1.0\r\n"
+                       "%s%s%s"
+                       "%s%s%s"
+                       "Connection: keep-alive\r\n\r\n",
+                       path, conn->host,
+                       accept ? "Accept: " : "", accept ? accept : "", accept ? "\r\n" : "",
+                       accept_encoding ? "Accept-Encoding: " : "",
+                       accept_encoding ? accept_encoding : "", accept_encoding ? "\r\n" : "");
+    if (len <= 0 || len >= (int)sizeof(req)) {
+        Serial.println("[HTTPS] Request too long");
+        return false;
+    }
+    return io(conn).write((const uint8_t*)req, len) == (size_t)len;
+}
+
+// Read the status line and headers. Returns false if nothing came back.
+static bool read_response_head(HttpsConn* conn, HttpResponse& resp) {
+    resp.status = 0;
+    resp.content_length = -1;
+    resp.chunked = false;
+    resp.keep_alive = true;
+    resp.encoding = ENCODING_IDENTITY;
+    resp.location = "";
+
+    // "HTTP/1.1 302 Found"
+    char line[LINE_MAX];
+    if (!rx_read_line(conn, line, sizeof(line)) || strncmp(line, "HTTP/1.", 7) != 0) {
+        return false;
+    }
+    resp.keep_alive = (line[7] == '1');
+    resp.status = atoi(line + 9);
+
+    while (rx_read_line(conn, line, sizeof(line)) && line[0]) {
+        char* colon = strchr(line, ':');
+        if (!colon) continue;
+        *colon = '\0';
+        char* value = colon + 1;
+        while (*value == ' ' || *value == '\t') value++;
+
+        if (strcasecmp(line, "content-length") == 0) {
+            resp.content_length = atol(value);
+        } else if (strcasecmp(line, "transfer-encoding") == 0) {
+            resp.chunked = strcasestr(value, "chunked") != nullptr;
+        } else if (strcasecmp(line, "connection") == 0) {
+            if (strcasecmp(value, "close") == 0) resp.keep_alive = false;
+        } else if (strcasecmp(line, "content-encoding") == 0) {
+            if (strcasecmp(value, "gzip") == 0) resp.encoding = ENCODING_GZIP;
+            else if (strcasecmp(value, "deflate") == 0) resp.encoding = ENCODING_DEFLATE;
+        } else if (strcasecmp(line, "location") == 0) {
+            resp.location = value;
+        }
+    }
+
+    if (resp.status == 204 || resp.status == 304) {
+        resp.content_length = 0;  // No body
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Body stream
+// ------------------------------------------------------------------
+
+HttpBodyStream::HttpBodyStream(HttpsConn* conn, HttpResponse& resp)
+    : _conn(conn), _resp(resp), _remaining(0), _until_close(false),
+      _first_chunk(true), _done(false), _failed(false) {
+    if (resp.chunked) {
+        _remaining = 0;             // Next chunk header still to be read
+    } else if (resp.content_length >= 0) {
+        _remaining = resp.content_length;
+        _done = (_remaining == 0);
+    } else {
+        _until_close = true;
+        resp.keep_alive = false;    // Can't tell where the body ends otherwise
+    }
+}
+
+bool HttpBodyStream::fill() {
+    if (_done) return false;
+
+    if (_resp.chunked && _remaining == 0) {
+        char line[LINE_MAX];
+        if (!_first_chunk) {
+            rx_read_line(_conn, line, sizeof(line));   // \r\n after previous chunk
+        }
+        _first_chunk = false;
+
+        // Chunk size (hex), possibly followed by extensions
+        if (!rx_read_line(_conn, line, sizeof(line)) || !isxdigit((unsigned char)line[0])) {
+            _done = _failed = true;
+            return false;
+        }
+        _remaining = strtol(line, NULL, 16);
+        if (_remaining == 0) {
+            // Last chunk: skip trailers up to the final empty line
+            while (rx_read_line(_conn, line, sizeof(line)) && line[0]) {}
+            _done = true;
+            return false;
+        }
+    }
+
+    if (!rx_fill(_conn)) {
+        _done = true;
+        _failed = !_until_close;
+        return false;
+    }
+    return true;
+}
+
+int HttpBodyStream::available() {
+    if (_done) return 0;
+    int avail = (_conn->rx_len - _conn->rx_pos) + io(_conn).available();
+    if (_until_close || _remaining == 0) return avail;
+    return (int)min((long)avail, _remaining);
+}
+
+// Account for n body bytes just consumed
+void HttpBodyStream::consumed(size_t n) {
+    if (_until_close) return;
+    _remaining -= n;
+    if (_remaining == 0 && !_resp.chunked) _done = true;
+}
+
+int HttpBodyStream::read() {
+    if (!fill()) return -1;
+    int c = _conn->rx[_conn->rx_pos++];
+    consumed(1);
+    return c;
+}
+
+size_t HttpBodyStream::read(uint8_t* buf, size_t len) {
+    if (!fill()) return 0;
+    if (!_until_close) len = min(len, (size_t)_remaining);
+    size_t n = rx_read_bytes(_conn, buf, len);
+    consumed(n);
+    return n;
+}
+
+int HttpBodyStream::peek() {
+    if (!fill()) return -1;
+    return _conn->rx[_conn->rx_pos];
+}
+
+bool HttpBodyStream::finish() {
+    while (read(nullptr, RX_BUF_SIZE) > 0) {}
+    return !_failed;
+}
+
+bool https_read_body(HttpsConn* conn, HttpResponse& resp, String* body) {
+    if (body && !resp.chunked && resp.content_length > 0) {
+        body->reserve(resp.content_length);
+    }
+
+    HttpBodyStream stream(conn, resp);
+    uint8_t buf[256];
+    size_t n;
+    while ((n = stream.read(body ? buf : nullptr, sizeof(buf))) > 0) {
+        if (body) body->concat((const char*)buf, n);
+    }
+    return stream.finish();
+}
+
+static HttpsConn* pooled_request(const char* host, bool secure, const char* path,
+                                 const char* accept, HttpResponse& resp,
+                                 unsigned long timeout_ms, const char* accept_encoding) {
+    if (!host || !host[0] || !wifi_link_up()) return nullptr;
+
+    // A reused connection the server already closed gets one fresh retry
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = false;
+        HttpsConn* conn = pool_acquire(host, secure, timeout_ms, &reused);
+        if (!conn) return nullptr;
+        conn->timeout_ms = timeout_ms;
+
+        unsigned long sent = millis();
+        if (send_request(conn, path, accept, accept_encoding) && read_response_head(conn, resp)) {
+            resp.reused = reused;
+            record_request(host, millis() - sent);
+            return conn;
+        }
+
+        https_release(conn, false);
+        if (!reused) {
+            Serial.printf("[HTTPS] %s: response timeout\n", host);
+            return nullptr;
+        }
+        xSemaphoreTake(_pool_lock, portMAX_DELAY);
+        HttpsHostStats* s = stats_for(host);
+        if (s) s->stale++;
+        xSemaphoreGive(_pool_lock);
+        Serial.printf("[HTTPS] %s: stale keep-alive connection, reconnecting\n", host);
+    }
+    return nullptr;
+}
+
+HttpsConn* https_request(const char* host, const char* path, const char* accept,
+                         HttpResponse& resp, unsigned long timeout_ms,
+                         const char* accept_encoding) {
+    return pooled_request(host, true, path, accept, resp, timeout_ms, accept_encoding);
+}
+
+HttpsConn* http_request(const char* host, const char* path, const char* accept,
+                        HttpResponse& resp, unsigned long timeout_ms) {
+    return pooled_request(host, false, path, accept, resp, timeout_ms, nullptr);
+}
+
+bool https_pipeline(HttpsConn* conn, const char* path, const char* accept) {
+    return send_request(conn, path, accept);
+}
+
+bool https_read_next(HttpsConn* conn, HttpResponse& resp) {
+    // Not a request time: the head may have been waiting in the buffer
+    if (!read_response_head(conn, resp)) return false;
+    resp.reused = true;
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Hedged requests
+// ------------------------------------------------------------------
+
+struct HedgeAttempt {
+    HttpsConn* conn;        // nullptr: not started, failed or closed
+    bool reused;
+    unsigned long sent;
+};
+
+static void count_stale(const char* host) {
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    HttpsHostStats* s = stats_for(host);
+    if (s) s->stale++;
+    xSemaphoreGive(_pool_lock);
+}
+
+static bool rx_ready(HttpsConn* conn) {
+    return conn->rx_pos < conn->rx_len || io(conn).available() > 0;
+}
+
+HttpsConn* https_request_hedged(const char* host, const char* path, const char* accept,
+                                HttpResponse& resp, unsigned long timeout_ms) {
+    if (!host || !host[0] || !wifi_link_up()) return nullptr;
+
+    unsigned long hedge_ms = hedge_delay_ms(host);
+    unsigned long start = millis();
+    HedgeAttempt tries[2] = {};
+    int started = 0;
+    int winner = -1;
+    bool hedged = false;
+
+    while (winner < 0 && millis() - start < timeout_ms) {
+        bool live = (started > 0 && tries[0].conn) || (started > 1 && tries[1].conn);
+
+        // The second copy goes out once the first is late, or at once as
+        // the retry if the first could not be sent or its connection died
+        if (started < 2 && (!live || millis() - start >= hedge_ms)) {
+            if (live) {
+                hedged = true;
+                Serial.printf("[HTTPS] %s: no response in %lu ms, hedging\n", host, hedge_ms);
+            }
+            HedgeAttempt& t = tries[started++];
+            t.conn = pool_acquire(host, true, timeout_ms - (millis() - start), &t.reused);
+            t.sent = millis();
+            if (t.conn && live && rx_ready(tries[0].conn)) {
+                // The first answered during the handshake: keep the new
+                // connection as a warm spare instead of sending
+                https_release(t.conn, true);
+                t.conn = nullptr;
+                hedged = false;
+            } else if (t.conn && !send_request(t.conn, path, accept)) {
+                https_release(t.conn, false);
+                t.conn = nullptr;
+            }
+            continue;
+        }
+        if (!live) break;
+
+        for (int i = 0; i < started && winner < 0; i++) {
+            HedgeAttempt& t = tries[i];
+            if (!t.conn) continue;
+            if (rx_ready(t.conn)) {
+                t.conn->timeout_ms = max(1UL, timeout_ms - (millis() - start));
+                if (read_response_head(t.conn, resp)) {
+                    winner = i;
+                    break;
+                }
+            } else if (io(t.conn).connected()) {
+                continue;
+            }
+            // Closed before a full response head: a stale keep-alive
+            // connection, or the server gave up
+            if (t.reused) {
+                count_stale(host);
+                Serial.printf("[HTTPS] %s: stale keep-alive connection, reconnecting\n", host);
+            }
+            https_release(t.conn, false);
+            t.conn = nullptr;
+        }
+        if (winner < 0) delay(1);
+    }
+
+    // The loser's response is still on its way: that connection can't be reused
+    for (int i = 0; i < started; i++) {
+        if (i != winner && tries[i].conn) https_release(tries[i].conn, false);
+    }
+    if (hedged) {
+        xSemaphoreTake(_pool_lock, portMAX_DELAY);
+        HttpsHostStats* s = stats_for(host);
+        if (s) {
+            s->hedged++;
+            if (winner == 1) s->hedge_wins++;
+        }
+        xSemaphoreGive(_pool_lock);
+    }
+    if (winner < 0) {
+        Serial.printf("[HTTPS] %s: response timeout\n", host);
+        return nullptr;
+    }
+
+    // Hedged: time since the first copy went out, so hedging doesn't pull
+    // the p95 (and with it the hedge delay) down
+    record_request(host, millis() - tries[hedged ? 0 : winner].sent);
+    resp.reused = tries[winner].reused;
+    return tries[winner].conn;
+}
+
+// ------------------------------------------------------------------
+// Stats / serial commands
+// ------------------------------------------------------------------
+
+bool https_pool_get_stats(int index, HttpsHostStats* out) {
+    xSemaphoreTake(_pool_lock, portMAX_DELAY);
+    bool found = index >= 0 && index < _stats_count;
+    if (found) *out = _stats[index];
+    xSemaphoreGive(_pool_lock);
+    return found;
+}
+
+void https_pool_print_stats() {
+    Serial.println("[HTTPS] Connection stats:");
+    for (int i = 0; i < _stats_count; i++) {
+        const HttpsHostStats& s = _stats[i];
+        Serial.printf("[HTTPS]   %s: %lu requests (avg %lu ms, max %lu ms)\n",
+                      s.host, s.requests,
+                      s.requests ? s.request_ms / s.requests : 0, s.max_request_ms);
+        Serial.printf("[HTTPS]   %s: %lu handshakes (avg %lu ms), %lu reused, %lu stale\n",
+                      s.host, s.handshakes,
+                      s.handshakes ? s.handshake_ms / s.handshakes : 0,
+                      s.reused, s.stale);
+        if (s.admit_waits || s.admit_refused) {
+            Serial.printf("[HTTPS]   %s: %lu handshakes waited for heap or a turn, %lu refused\n",
+                          s.host, s.admit_waits, s.admit_refused);
+        }
+        if (s.hedged) {
+            Serial.printf("[HTTPS]   %s: %lu hedged (%lu won by the second copy), delay %lu ms\n",
+                          s.host, s.hedged, s.hedge_wins, s.hedge_ms);
+        }
+    }
+    for (int i = 0; i < POOL_SIZE; i++) {
+        const HttpsConn& c = _pool[i];
+        if (c.host[0]) {
+            Serial.printf("[HTTPS]   slot %d: %s, idle %lu ms\n",
+                          i, c.host, millis() - c.last_used);
+        }
+    }
+}
+
+static void cmd_stats(const char*) {
+    https_pool_print_stats();
+}
+
+void https_pool_serial_init() {
+    serial_cmd_register("H", cmd_stats);
+    tls_trust_serial_init();
+}
@@ -0,0 +1,151 @@
+/**
+ * Shared HTTPS connection pool for RadioWall.
+ *
+ * Keeps TLS sessions to radio.garden and the WiiM devices open between
+ * requests (HTTP/1.1 keep-alive), so most requests skip the mbedTLS
+ * handshake entirely. Responses are read from the socket in blocks and
+ * parsed from a per-connection buffer. Connections are keyed by host; idle ones expire
+ * and stale ones are retried once on a fresh connection. Plain-HTTP connections
+ * (http_request()) share the pool and the same framing code. A new TLS
+ * session opens only when fewer than HTTPS_TLS_SESSIONS_MAX are open and
+ * the internal heap can hold its handshake; otherwise the request queues
+ * briefly (closing idle sessions first).
+ */
+
+#ifndef HTTPS_POOL_H
+#define HTTPS_POOL_H
+
+#include <Arduino.h>
+
+// TLS sessions the pool keeps open at once (each holds its mbedTLS record
+// buffers in internal RAM). Fan-outs over HTTPS need not run wider.
+#define HTTPS_TLS_SESSIONS_MAX 4
+
+enum ContentEncoding : uint8_t {
+    ENCODING_IDENTITY,
+    ENCODING_GZIP,
+    ENCODING_DEFLATE,      // zlib-wrapped, as servers actually send it
+};
+
+// Parsed status line and the headers we care about
+struct HttpResponse {
+    int status;
+    long content_length;   // -1 if not sent
+    bool chunked;
+    bool keep_alive;
+    bool reused;           // Sent on an already-open connection (no handshake)
+    ContentEncoding encoding;
+    String location;
+};
+
+// Pooled connection handle (opaque)
+struct HttpsConn;
+
+// Send a GET to https://host:443/path on a pooled connection and read the
+// response head. host may be a name or a dotted IP. accept may be nullptr.
+// accept_encoding (e.g. inflate_accept_encoding()) is sent as
+// Accept-Encoding; the body is then read through an InflateStream.
+// Returns nullptr on failure; otherwise read the body with https_read_body()
+// and hand the connection back with https_release().
+HttpsConn* https_request(const char* host, const char* path, const char* accept,
+                         HttpResponse& resp, unsigned long timeout_ms,
+                         const char* accept_encoding = nullptr);
+
+// https_request() in plain HTTP on port 80, pooled alongside the TLS
+// connections (a host can have both). For LAN devices only: nothing is
+// encrypted or authenticated.
+HttpsConn* http_request(const char* host, const char* path, const char* accept,
+                        HttpResponse& resp, unsigned long timeout_ms);
+
+// https_request() for small idempotent GETs on a host with a slow tail:
+// if no response head has come back within the host's recent p95 request
+// time, the same request goes out on a second connection and whichever
+// answers first wins (the other is closed). timeout_ms covers both.
+HttpsConn* https_request_hedged(const char* host, const char* path, const char* accept,
+                                HttpResponse& resp, unsigned long timeout_ms);
+
+// Read the response body (appended to body unless it is nullptr), as sent:
+// not inflated. Consumes exactly the framed length so the connection can be
+// reused.
+bool https_read_body(HttpsConn* conn, HttpResponse& resp, String* body);
+
+/**
+ * Stream view of a response body that decodes chunked / Content-Length
+ * framing on the fly, so parsers (ArduinoJson) can read straight from the
+ * socket without buffering the whole body in a String.
+ */
+class HttpBodyStream : public Stream {
+public:
+    HttpBodyStream(HttpsConn* conn, HttpResponse& resp);
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t) override { return 0; }
+
+    // Bulk read of up to len body bytes (buf may be nullptr to discard).
+    // Returns 0 at end of body.
+    size_t read(uint8_t* buf, size_t len);
+
+    // Drain whatever is left of the body. Returns true if the body was
+    // read completely (connection may be reused if resp.keep_alive).
+    bool finish();
+
+private:
+    bool fill();   // Make sure a body byte is ready; false at end or on error
+    void consumed(size_t n);
+
+    HttpsConn* _conn;
+    HttpResponse& _resp;
+    long _remaining;    // Bytes left in the current chunk / body
+    bool _until_close;  // No framing: body ends when the server closes
+    bool _first_chunk;
+    bool _done;
+    bool _failed;
+};
+
+// HTTP/1.1 pipelining: send another GET on conn while the current response
+// body is still being read. Once that body has been consumed completely,
+// https_read_next() reads the head of the pipelined response. Only worth it
+// if the current response is keep-alive; otherwise the server drops the
+// second request and https_read_next() fails.
+bool https_pipeline(HttpsConn* conn, const char* path, const char* accept);
+bool https_read_next(HttpsConn* conn, HttpResponse& resp);
+
+// Return a connection to the pool; closes it unless keep_alive is set
+void https_release(HttpsConn* conn, bool keep_alive);
+
+// Close all idle connections (e.g. before WiFi goes down)
+void https_pool_close_all();
+
+// Slots not held by a request right now (idle keep-alive ones count: a
+// new connection may replace them)
+int https_pool_free_slots();
+
+// Per-host counters since boot
+struct HttpsHostStats {
+    char host[40];
+    uint32_t requests;       // Responses received
+    uint32_t request_ms;     // Total request sent -> response head
+    uint32_t max_request_ms;
+    uint32_t handshakes;
+    uint32_t reused;
+    uint32_t stale;
+    uint32_t handshake_ms;   // Total time spent in connect()
+    uint32_t hedged;         // Hedged requests that sent a second copy
+    uint32_t hedge_wins;     // ... and got their answer from it
+    uint32_t hedge_ms;       // Current hedge delay (p95 of recent requests)
+    uint32_t admit_waits;    // Handshakes that queued for heap or a turn
+    uint32_t admit_refused;  // ... and gave up (request failed)
+};
+
+// Copy the stats of the index'th host seen; false past the last one
+bool https_pool_get_stats(int index, HttpsHostStats* out);
+
+// Print per-host handshake vs. reused counts
+void https_pool_print_stats();
+
+// Register serial commands (H - connection stats)
+void https_pool_serial_init();
+
+#endif // HTTPS_POOL_H
@@ -0,0 +1,172 @@
+/**
+ * Idle refresh implementation for RadioWall.
+ *
+ * Played places are told apart by a hash of their name and country; their
+ * heat is how many of the last HEAT_HISTORY plays they had, ties going to
+ * the one played last. Station lists are refreshed once per cell of the
+ * places grid, whichever entry reaches the cell first.
+ */
+
+#include "idle_refresh.h"
+#include "fnv1a.h"
+#include "net_worker.h"
+#include "display.h"
+#include "wifi_link.h"
+#include "favorites.h"
+#include "history.h"
+#include "station_stats.h"
+#include "tap_heat.h"
+#include "places_db.h"
+#include "loop_events.h"
+
+static const int RECENT_HISTORY = 4;    // Newest plays, ahead of the favorites
+static const int HOT_CELLS = 4;         // Most tapped cells, after them
+static const int HEAT_HISTORY = 100;    // Plays the heat is counted over
+static const int REFRESH_PLACES = 4;    // Station lists per list (half the cache)
+
+static bool _running = false;           // A list is out and no input since
+static bool _ran = false;
+static unsigned long _last_round = 0;
+
+struct PlaceHeat {
+    uint32_t key;
+    int16_t newest;     // History index of its newest play
+    uint16_t count;
+};
+
+struct RefreshList {
+    NetRefreshEntry entries[NET_REFRESH_MAX];
+    int count;
+    uint16_t places[REFRESH_PLACES];   // Grid cells with a list to refresh
+    int place_count;
+};
+
+static uint32_t place_key(const StationMeta& m) {
+    return fnv1a_str(m.country, fnv1a_byte(fnv1a_str(m.place), '|'));
+}
+
+// Claim a list refresh for the cell under lat/lon, once per cell
+static bool claim_place(RefreshList& list, float lat, float lon) {
+    if (list.place_count >= REFRESH_PLACES) return false;
+    uint16_t cell = places_db_cell(lat, lon);
+    if (cell == PLACES_CELL_NONE) return false;
+    for (int i = 0; i < list.place_count; i++) {
+        if (list.places[i] == cell) return false;
+    }
+    list.places[list.place_count++] = cell;
+    return true;
+}
+
+// Append a station unless it is listed already, failing or the list is full
+static void add(RefreshList& list, const StationMeta& m) {
+    if (list.count >= NET_REFRESH_MAX || !m.station_id[0]) return;
+    for (int i = 0; i < list.count; i++) {
+        if (strcmp(list.entries[i].station_id, m.station_id) == 0) return;
+    }
+    int score;
+    if (station_stats_score(m.station_id, &score) && score < 0) return;
+
+    NetRefreshEntry& e = list.entries[list.count++];
+    strncpy(e.station_id, m.station_id, sizeof(e.station_id) - 1);
+    e.station_id[sizeof(e.station_id) - 1] = '\0';
+    e.lat = m.lat;
+    e.lon = m.lon;
+    e.place = m.place[0] && claim_place(list, m.lat, m.lon);
+}
+
+// Append the station list of a tapped cell (no station of its own)
+static void add_cell(RefreshList& list, float lat, float lon) {
+    if (list.count >= NET_REFRESH_MAX || !claim_place(list, lat, lon)) return;
+    NetRefreshEntry& e = list.entries[list.count++];
+    e.station_id[0] = '\0';
+    e.lat = lat;
+    e.lon = lon;
+    e.place = true;
+}
+
+// Places among the newest plays, hottest first
+static int rank_heat(PlaceHeat* heat) {
+    int n = 0;
+    int plays = min(history_count(), HEAT_HISTORY);
+    for (int i = 0; i < plays; i++) {
+        const HistoryEntry* h = history_get(i);
+        if (!h) continue;
+        uint32_t key = place_key(*h);
+        int at = 0;
+        while (at < n && heat[at].key != key) at++;
+        if (at == n) heat[n++] = {key, (int16_t)i, 0};
+        heat[at].count++;
+    }
+    // Insertion sort: newest index breaks ties, as it was inserted first
+    for (int i = 1; i < n; i++) {
+        PlaceHeat h = heat[i];
+        int j = i - 1;
+        while (j >= 0 && heat[j].count < h.count) {
+            heat[j + 1] = heat[j];
+            j--;
+        }
+        heat[j + 1] = h;
+    }
+    return n;
+}
+
+static void start_round() {
+    RefreshList list;
+    list.count = 0;
+    list.place_count = 0;
+
+    // history_get() may hand out a cache slot: copy before the next read
+    StationMeta m;
+    for (int i = 0; i < min(history_count(), RECENT_HISTORY); i++) {
+        const HistoryEntry* h = history_get(i);
+        if (!h) continue;
+        m = *h;
+        add(list, m);
+    }
+    float lat[HOT_CELLS], lon[HOT_CELLS];
+    int cells = tap_heat_hottest(HOT_CELLS, lat, lon);
+    for (int i = 0; i < cells; i++) add_cell(list, lat[i], lon[i]);
+    for (int i = 0; i < favorites_count(); i++) {
+        const FavoriteStation* f = favorites_get(i);
+        if (f) add(list, *f);
+    }
+    PlaceHeat heat[HEAT_HISTORY];
+    int places = rank_heat(heat);
+    for (int i = 0; i < places && list.count < NET_REFRESH_MAX; i++) {
+        const HistoryEntry* h = history_get(heat[i].newest);
+        if (!h) continue;
+        m = *h;
+        add(list, m);
+    }
+
+    _ran = true;
+    _last_round = millis();
+    if (list.count == 0) return;
+    Serial.printf("[Refresh] Idle %lu min: %d station(s), %d place(s)\n",
+                  (unsigned long)(display_idle_ms() / 60000), list.count, list.place_count);
+    net_worker_refresh(list.entries, list.count);
+    _running = true;
+}
+
+void idle_refresh_task() {
+    uint32_t idle = display_idle_ms();
+    if (idle < IDLE_REFRESH_AFTER_MS) {
+        if (_running) {
+            // Input: leave the network to the user
+            net_worker_refresh_stop();
+            _running = false;
+        }
+        loop_events_due_in(IDLE_REFRESH_AFTER_MS - idle);
+        return;
+    }
+
+    if (_ran) {
+        unsigned long since = millis() - _last_round;
+        if (since < IDLE_REFRESH_ROUND_MS) {
+            loop_events_due_in(IDLE_REFRESH_ROUND_MS - since);
+            return;
+        }
+    }
+    if (!wifi_link_up()) return;
+    start_round();
+}
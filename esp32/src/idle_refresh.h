@@ -0,0 +1,34 @@
+/**
+ * Idle refresh for RadioWall.
+ *
+ * Cached station lists expire after 30 minutes and resolved stream URLs
+ * after a day, so the first tap after a quiet spell usually pays for both
+ * again. Once nobody has touched the wall for IDLE_REFRESH_AFTER_MS, this
+ * builds a list of what is most likely to be tapped next and hands it to
+ * the network worker, which works through it at maintenance priority, one
+ * entry every few seconds (net_worker_refresh). The newest history comes
+ * first, then the most tapped cells of the map (tap_heat), then the
+ * favorites, then the places played most often among the last hundred
+ * plays. The first few distinct grid cells get the live station list of
+ * their city cached; every station gets its stream URL re-resolved once
+ * it is 12 hours old. Stations that keep failing are left out.
+ *
+ * Any input stops the refresh, and a command posted meanwhile preempts
+ * the entry being worked on. A list runs at most once per
+ * IDLE_REFRESH_ROUND_MS.
+ *
+ * Loop task.
+ */
+
+#ifndef IDLE_REFRESH_H
+#define IDLE_REFRESH_H
+
+#include <Arduino.h>
+
+static const uint32_t IDLE_REFRESH_AFTER_MS = 10UL * 60 * 1000;
+static const uint32_t IDLE_REFRESH_ROUND_MS = 30UL * 60 * 1000;
+
+// Start a refresh once idle, stop it on input (call from loop)
+void idle_refresh_task();
+
+#endif // IDLE_REFRESH_H
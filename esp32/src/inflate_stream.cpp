@@ -0,0 +1,166 @@
+/**
+ * Streaming gzip / deflate decoder implementation for RadioWall.
+ *
+ * tinfl writes into a circular 32 KB dictionary; each call inflates up to
+ * the end of it and read() hands those bytes out before the next call, so
+ * the dictionary doubles as the output buffer.
+ */
+
+#include "inflate_stream.h"
+#include <esp32s3/rom/miniz.h>
+
+static const size_t INFLATE_IN_SIZE = 1024;   // Compressed bytes per body read
+
+struct Inflater {
+    tinfl_decompressor decomp;
+    uint8_t in[INFLATE_IN_SIZE];
+    size_t in_pos;
+    size_t in_len;
+    bool in_eof;              // Body has no more compressed bytes
+    size_t dict_pos;          // Where tinfl writes next
+    size_t out_pos;           // Next inflated byte to hand out
+    size_t out_end;
+    uint8_t dict[TINFL_LZ_DICT_SIZE];
+};
+
+// One decoder at a time (all fetches run on the network worker); the
+// buffer is allocated on first use and kept
+static Inflater* _shared = nullptr;
+static bool _shared_busy = false;
+
+const char* inflate_accept_encoding() {
+    return psramFound() ? "gzip, deflate" : nullptr;
+}
+
+InflateStream::InflateStream(HttpBodyStream& body, ContentEncoding encoding)
+    : _body(body), _encoding(encoding), _inf(nullptr), _started(false),
+      _done(false), _failed(false), _wire(0), _out(0) {
+    if (encoding == ENCODING_IDENTITY) return;
+    if (!_shared && psramFound()) _shared = (Inflater*)ps_malloc(sizeof(Inflater));
+    if (!_shared || _shared_busy) {
+        Serial.println("[Inflate] No decoder available");
+        _done = _failed = true;
+        return;
+    }
+    _shared_busy = true;
+    _inf = _shared;
+    tinfl_init(&_inf->decomp);
+    _inf->in_pos = _inf->in_len = 0;
+    _inf->in_eof = false;
+    _inf->dict_pos = _inf->out_pos = _inf->out_end = 0;
+}
+
+InflateStream::~InflateStream() {
+    if (_inf) _shared_busy = false;
+}
+
+// RFC 1952 member header: magic, method, flags, then optional fields
+bool InflateStream::skip_gzip_header() {
+    uint8_t head[10];
+    for (int i = 0; i < 10; i++) {
+        int c = _body.read();
+        if (c < 0) return false;
+        head[i] = c;
+    }
+    _wire += 10;
+    if (head[0] != 0x1f || head[1] != 0x8b || head[2] != 8) return false;
+
+    uint8_t flags = head[3];
+    if (flags & 0x04) {                      // FEXTRA
+        int lo = _body.read(), hi = _body.read();
+        if (lo < 0 || hi < 0) return false;
+        for (int n = lo | (hi << 8); n > 0; n--) {
+            if (_body.read() < 0) return false;
+        }
+    }
+    for (uint8_t field = 0x08; field <= 0x10; field <<= 1) {   // FNAME, FCOMMENT
+        if (!(flags & field)) continue;
+        int c;
+        while ((c = _body.read()) > 0) {}
+        if (c < 0) return false;
+    }
+    if (flags & 0x02) {                      // FHCRC
+        if (_body.read() < 0 || _body.read() < 0) return false;
+    }
+    return true;
+}
+
+bool InflateStream::fill() {
+    if (_done) return false;
+    Inflater& f = *_inf;
+    if (f.out_pos < f.out_end) return true;
+
+    if (!_started) {
+        _started = true;
+        if (_encoding == ENCODING_GZIP && !skip_gzip_header()) {
+            Serial.println("[Inflate] Bad gzip header");
+            _done = _failed = true;
+            return false;
+        }
+    }
+
+    while (true) {
+        if (f.in_pos == f.in_len && !f.in_eof) {
+            f.in_len = _body.read(f.in, sizeof(f.in));
+            f.in_pos = 0;
+            f.in_eof = (f.in_len == 0);
+            _wire += f.in_len;
+        }
+
+        size_t in_size = f.in_len - f.in_pos;
+        size_t out_size = TINFL_LZ_DICT_SIZE - f.dict_pos;
+        mz_uint32 flags = (_encoding == ENCODING_DEFLATE ? TINFL_FLAG_PARSE_ZLIB_HEADER : 0) |
+                          (f.in_eof ? 0 : TINFL_FLAG_HAS_MORE_INPUT);
+        tinfl_status status = tinfl_decompress(&f.decomp, f.in + f.in_pos, &in_size, f.dict,
+                                               f.dict + f.dict_pos, &out_size, flags);
+        f.in_pos += in_size;
+        f.out_pos = f.dict_pos;
+        f.out_end = f.dict_pos + out_size;
+        f.dict_pos = (f.dict_pos + out_size) & (TINFL_LZ_DICT_SIZE - 1);
+
+        if (status < TINFL_STATUS_DONE ||
+            (status == TINFL_STATUS_NEEDS_MORE_INPUT && f.in_eof)) {
+            Serial.printf("[Inflate] Stream error (%d)\n", (int)status);
+            _done = _failed = true;
+            return false;
+        }
+        if (out_size > 0) return true;
+        if (status == TINFL_STATUS_DONE) {
+            _done = true;
+            return false;
+        }
+    }
+}
+
+int InflateStream::available() {
+    if (!_inf) return _done ? 0 : _body.available();
+    if (_inf->out_pos < _inf->out_end) return _inf->out_end - _inf->out_pos;
+    return (!_done && _body.available() > 0) ? 1 : 0;
+}
+
+int InflateStream::read() {
+    if (!_inf) {
+        if (_done) return -1;
+        int c = _body.read();
+        if (c >= 0) _wire++, _out++;
+        return c;
+    }
+    if (!fill()) return -1;
+    _out++;
+    return _inf->dict[_inf->out_pos++];
+}
+
+int InflateStream::peek() {
+    if (!_inf) return _done ? -1 : _body.peek();
+    if (!fill()) return -1;
+    return _inf->dict[_inf->out_pos];
+}
+
+bool InflateStream::finish() {
+    if (_inf) {
+        while (fill()) _inf->out_pos = _inf->out_end;
+    }
+    // gzip trailer (CRC32 + size) and anything after it. TLS already
+    // guards integrity, so the CRC isn't checked.
+    return _body.finish() && !_failed;
+}
@@ -0,0 +1,51 @@
+/**
+ * Streaming gzip / deflate decoder for RadioWall HTTP bodies.
+ *
+ * Wraps an HttpBodyStream and hands out inflated bytes, so ArduinoJson
+ * can parse a compressed response straight from the socket. Uses the
+ * tinfl inflater in the ESP32-S3 ROM with one 32 KB window (the deflate
+ * maximum) in PSRAM; the whole body is never held anywhere.
+ */
+
+#ifndef INFLATE_STREAM_H
+#define INFLATE_STREAM_H
+
+#include <Arduino.h>
+#include "https_pool.h"
+
+// Accept-Encoding to offer, or nullptr if responses can't be inflated here
+// (no PSRAM for the window)
+const char* inflate_accept_encoding();
+
+class InflateStream : public Stream {
+public:
+    // encoding is resp.encoding; ENCODING_IDENTITY passes bytes through
+    InflateStream(HttpBodyStream& body, ContentEncoding encoding);
+    ~InflateStream();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t) override { return 0; }
+
+    // Drain the rest of the body. True if it inflated without error.
+    bool finish();
+
+    uint32_t wire_bytes() const { return _wire; }   // Compressed bytes read
+    uint32_t out_bytes() const { return _out; }     // Inflated bytes handed out
+
+private:
+    bool fill();             // Make sure an output byte is ready
+    bool skip_gzip_header();
+
+    HttpBodyStream& _body;
+    ContentEncoding _encoding;
+    struct Inflater* _inf;   // nullptr: identity, or allocation failed
+    bool _started;
+    bool _done;
+    bool _failed;
+    uint32_t _wire;
+    uint32_t _out;
+};
+
+#endif // INFLATE_STREAM_H
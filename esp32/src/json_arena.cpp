@@ -0,0 +1,121 @@
+/**
+ * Reusable JSON parse arena implementation for RadioWall.
+ *
+ * Checkouts come from the net worker, the loop task (persist flushes) and
+ * setup, so the busy flags and counters are under _mux. The arena buffers
+ * themselves are only touched by whoever holds the checkout.
+ */
+
+#include "json_arena.h"
+#include "serial_cmd.h"
+#include <freertos/FreeRTOS.h>
+
+struct Arena {
+    const char* name;
+    size_t capacity;
+    char* buf;             // nullptr: not allocated (no PSRAM)
+    bool busy;
+    JsonArenaStats stats;
+};
+
+static Arena _arenas[JSON_ARENA_COUNT] = {
+    { "station",  1024 },    // One filtered item
+    { "file",     8192 },    // The stream cache, the largest state file
+    { "manifest", 49152 },   // Chunk lists for ~10 MB: data, tiles, a 3 MB image
+};
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+void json_arena_init() {
+    if (!psramFound()) {
+        Serial.println("[JSON] No PSRAM: parse documents stay on the heap");
+        return;
+    }
+    size_t total = 0;
+    for (Arena& a : _arenas) {
+        if (a.buf) continue;
+        a.buf = (char*)ps_malloc(a.capacity);
+        if (a.buf) total += a.capacity;
+    }
+    Serial.printf("[JSON] %d parse arenas, %u bytes of PSRAM\n", JSON_ARENA_COUNT, (unsigned)total);
+}
+
+void json_arena_get_stats(JsonArenaId id, JsonArenaStats* out) {
+    portENTER_CRITICAL(&_mux);
+    *out = _arenas[id].stats;
+    portEXIT_CRITICAL(&_mux);
+    out->name = _arenas[id].name;
+    out->capacity = _arenas[id].capacity;
+}
+
+// ------------------------------------------------------------------
+// Documents
+// ------------------------------------------------------------------
+
+JsonArenaDoc::Checkout JsonArenaDoc::checkout(JsonArenaId id) {
+    Arena& a = _arenas[id];
+    bool got = false;
+    portENTER_CRITICAL(&_mux);
+    a.stats.uses++;
+    if (a.buf && !a.busy) {
+        a.busy = true;
+        got = true;
+    } else {
+        a.stats.fallbacks++;
+    }
+    portEXIT_CRITICAL(&_mux);
+    if (got) return { a.buf, a.capacity, false };
+    char* heap = (char*)malloc(a.capacity);
+    return { heap, heap ? a.capacity : 0, true };
+}
+
+JsonArenaDoc::JsonArenaDoc(JsonArenaId id) : JsonArenaDoc(id, checkout(id)) {}
+
+JsonArenaDoc::JsonArenaDoc(JsonArenaId id, Checkout c)
+    : JsonDocument(c.buf, c.capacity), _id(id), _buf(c.buf), _heap(c.heap) {}
+
+JsonArenaDoc::~JsonArenaDoc() {
+    note();
+    if (_heap) {
+        free(_buf);
+        return;
+    }
+    portENTER_CRITICAL(&_mux);
+    _arenas[_id].busy = false;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void JsonArenaDoc::clear() {
+    note();
+    JsonDocument::clear();
+}
+
+void JsonArenaDoc::note() {
+    size_t used = memoryUsage();
+    bool overflowed = JsonDocument::overflowed();
+    portENTER_CRITICAL(&_mux);
+    JsonArenaStats& s = _arenas[_id].stats;
+    if (used > s.high_water) s.high_water = used;
+    if (overflowed) s.overflows++;
+    portEXIT_CRITICAL(&_mux);
+}
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+// JSON - Per arena: size, high-water mark, checkouts, heap fallbacks
+static void cmd_json(const char*) {
+    for (int i = 0; i < JSON_ARENA_COUNT; i++) {
+        JsonArenaStats s;
+        json_arena_get_stats((JsonArenaId)i, &s);
+        Serial.printf("[JSON] %-8s %5u B%s, high water %5u B, %lu use(s), %lu on the heap, "
+                      "%lu overflow(s)\n",
+                      s.name, (unsigned)s.capacity, _arenas[i].buf ? "" : " (heap)",
+                      (unsigned)s.high_water, (unsigned long)s.uses,
+                      (unsigned long)s.fallbacks, (unsigned long)s.overflows);
+    }
+}
+
+void json_arena_serial_init() {
+    serial_cmd_register("JSON", cmd_json);
+}
@@ -0,0 +1,76 @@
+/**
+ * Reusable JSON parse arenas for RadioWall.
+ *
+ * An ArduinoJson document takes its pool from the heap when it is created
+ * and frees it when it goes, so every channels fetch and state file load
+ * used to cost a malloc/free pair. Instead each kind of parse has one fixed
+ * arena, allocated in PSRAM at boot, and checks it out with a JsonArenaDoc
+ * on its stack: a JsonDocument over the arena's buffer that hands it back
+ * when it goes out of scope.
+ *
+ * If the arena is already checked out (another task, or a nested parse) or
+ * there is no PSRAM, the document gets a heap pool of the same size as
+ * before and the fallback is counted. Each arena keeps the largest
+ * memoryUsage() seen and how often it overflowed; serial "JSON" prints
+ * them for tuning the sizes.
+ */
+
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+enum JsonArenaId {
+    JSON_ARENA_STATION,    // One filtered channels item (net worker, every fetch)
+    JSON_ARENA_FILE,       // State files: stream cache, legacy JSON migration
+    JSON_ARENA_MANIFEST,   // Data update manifest (net worker, daily)
+    JSON_ARENA_COUNT
+};
+
+struct JsonArenaStats {
+    const char* name;
+    size_t capacity;
+    size_t high_water;     // Largest memoryUsage() at a clear() or release
+    uint32_t uses;
+    uint32_t fallbacks;    // Arena busy or not allocated: heap pool instead
+    uint32_t overflows;    // Parses that ran out of room
+};
+
+// Allocate the arenas (setup, early; PSRAM only)
+void json_arena_init();
+
+// Copy of one arena's counters (any task)
+void json_arena_get_stats(JsonArenaId id, JsonArenaStats* out);
+
+// Register the JSON serial command
+void json_arena_serial_init();
+
+// A JsonDocument parsed into an arena for as long as it is in scope
+class JsonArenaDoc : public JsonDocument {
+public:
+    explicit JsonArenaDoc(JsonArenaId id);
+    ~JsonArenaDoc();
+
+    // Records the usage so far before emptying the pool (reused documents)
+    void clear();
+
+    JsonArenaDoc(const JsonArenaDoc&) = delete;
+    JsonArenaDoc& operator=(const JsonArenaDoc&) = delete;
+
+private:
+    struct Checkout {
+        char* buf;
+        size_t capacity;
+        bool heap;
+    };
+    JsonArenaDoc(JsonArenaId id, Checkout c);
+    static Checkout checkout(JsonArenaId id);
+    void note();
+
+    JsonArenaId _id;
+    char* _buf;
+    bool _heap;
+};
+
+#endif // JSON_ARENA_H
@@ -7,143 +7,798 @@
 
 #include "linkplay_client.h"
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
-
-static String _wiim_ip = "";
+#include "https_pool.h"
+#include "trace.h"
+#include "replay.h"
+#include "persist.h"
+#include "state_store.h"
+#include "loop_events.h"
+#include "wiim_identity.h"
+#include "wifi_link.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+static char _wiim_ip[16] = "";
 static bool _initialized = false;
 
+// Per-device round-trip estimate (RFC 6298 style smoothing) that sets the
+// response timeout. Samples come only from requests on an already-open
+// connection, so TLS handshakes don't inflate the estimate.
+static const int MAX_RTT_DEVICES = 8;                  // Master + group members
+static const unsigned long RTO_INITIAL_MS = 5000;      // Until the first sample
+static const unsigned long RTO_MIN_MS = 500;
+static const unsigned long RTO_MAX_MS = 5000;
+static const unsigned long RETRY_BACKOFF_MS = 20;      // Doubles per retry
+static const unsigned long RELOCATE_WAIT_MS = 1200;    // For wiim_identity's re-resolve
+
+struct DeviceRtt {
+    char ip[16];
+    long srtt_ms;        // Smoothed RTT, 0 = no sample yet
+    long rttvar_ms;
+    unsigned long rto_ms;
+};
+static DeviceRtt _rtt[MAX_RTT_DEVICES];
+static int _rtt_count = 0;
+static portMUX_TYPE _rtt_mux = portMUX_INITIALIZER_UNLOCKED;  // Fan-out tasks share it
+
+// Call with _rtt_mux held
+static DeviceRtt* rtt_for(const char* ip) {
+    for (int i = 0; i < _rtt_count; i++) {
+        if (strcmp(_rtt[i].ip, ip) == 0) return &_rtt[i];
+    }
+    if (_rtt_count == MAX_RTT_DEVICES) {
+        // Full: drop the oldest device
+        memmove(&_rtt[0], &_rtt[1], sizeof(DeviceRtt) * (MAX_RTT_DEVICES - 1));
+        _rtt_count--;
+    }
+    DeviceRtt* d = &_rtt[_rtt_count++];
+    strncpy(d->ip, ip, sizeof(d->ip) - 1);
+    d->ip[sizeof(d->ip) - 1] = '\0';
+    d->srtt_ms = 0;
+    d->rttvar_ms = 0;
+    d->rto_ms = RTO_INITIAL_MS;
+    return d;
+}
+
+// Current response timeout for a device
+static unsigned long rtt_timeout(const char* ip) {
+    portENTER_CRITICAL(&_rtt_mux);
+    unsigned long rto = rtt_for(ip)->rto_ms;
+    portEXIT_CRITICAL(&_rtt_mux);
+    return rto;
+}
+
+static void rtt_backoff(const char* ip) {
+    portENTER_CRITICAL(&_rtt_mux);
+    DeviceRtt* d = rtt_for(ip);
+    d->rto_ms = min(d->rto_ms * 2, RTO_MAX_MS);
+    portEXIT_CRITICAL(&_rtt_mux);
+}
+
+static void rtt_sample(const char* ip, long rtt_ms) {
+    portENTER_CRITICAL(&_rtt_mux);
+    DeviceRtt* d = rtt_for(ip);
+    if (d->srtt_ms == 0) {
+        d->srtt_ms = rtt_ms;
+        d->rttvar_ms = rtt_ms / 2;
+    } else {
+        long err = rtt_ms - d->srtt_ms;
+        d->srtt_ms += err / 8;
+        d->rttvar_ms += ((err < 0 ? -err : err) - d->rttvar_ms) / 4;
+    }
+    unsigned long rto = d->srtt_ms + 4 * d->rttvar_ms;
+    d->rto_ms = constrain(rto, RTO_MIN_MS, RTO_MAX_MS);
+    portEXIT_CRITICAL(&_rtt_mux);
+}
+
+// ------------------------------------------------------------------
+// Transport: many LinkPlay firmwares also serve httpapi.asp in plain HTTP
+// on port 80, which skips the TLS session for every command. Probed on the
+// first request to a device and remembered in the state store.
+// ------------------------------------------------------------------
+
+enum Transport : uint8_t {
+    TRANSPORT_UNKNOWN,
+    TRANSPORT_HTTPS,
+    TRANSPORT_HTTP,
+};
+
+static const unsigned long TRANSPORT_PROBE_MS = 1500;
+
+struct TransportRecord {
+    uint8_t count;
+    uint8_t reserved[3];
+    struct {
+        char ip[16];
+        uint8_t transport;
+        uint8_t reserved[3];
+    } devices[MAX_RTT_DEVICES];
+};
+static TransportRecord _transports;
+static portMUX_TYPE _transport_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool _transports_dirty = false;   // Changed off the loop task
+
+static Transport transport_get(const char* ip) {
+    Transport t = TRANSPORT_UNKNOWN;
+    portENTER_CRITICAL(&_transport_mux);
+    for (int i = 0; i < _transports.count; i++) {
+        if (strcmp(_transports.devices[i].ip, ip) == 0) {
+            t = (Transport)_transports.devices[i].transport;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&_transport_mux);
+    return t;
+}
+
+static void transport_set(const char* ip, Transport t) {
+    bool changed = true;
+    portENTER_CRITICAL(&_transport_mux);
+    int i = 0;
+    while (i < _transports.count && strcmp(_transports.devices[i].ip, ip) != 0) i++;
+    if (i == _transports.count) {
+        if (i == MAX_RTT_DEVICES) {
+            // Full: drop the oldest device
+            memmove(&_transports.devices[0], &_transports.devices[1],
+                    sizeof(_transports.devices[0]) * (MAX_RTT_DEVICES - 1));
+            i--;
+        } else {
+            _transports.count++;
+        }
+        memset(&_transports.devices[i], 0, sizeof(_transports.devices[i]));
+        strncpy(_transports.devices[i].ip, ip, sizeof(_transports.devices[i].ip) - 1);
+    } else {
+        changed = _transports.devices[i].transport != t;
+    }
+    _transports.devices[i].transport = t;
+    portEXIT_CRITICAL(&_transport_mux);
+
+    if (changed) {
+        _transports_dirty = true;
+        loop_events_notify();
+    }
+}
+
+// Devices whose transport a probe just settled (linkplay_probe_devices):
+// picking one as primary keeps it instead of probing again
+static const unsigned long PROBE_FRESH_MS = 5UL * 60 * 1000;
+static struct {
+    char ip[16];
+    unsigned long at;
+} _probed[MAX_RTT_DEVICES];
+static int _probed_next = 0;
+
+static void transport_mark_probed(const char* ip) {
+    portENTER_CRITICAL(&_transport_mux);
+    int i = 0;
+    while (i < MAX_RTT_DEVICES && strcmp(_probed[i].ip, ip) != 0) i++;
+    if (i == MAX_RTT_DEVICES) {
+        i = _probed_next;
+        _probed_next = (_probed_next + 1) % MAX_RTT_DEVICES;
+        strncpy(_probed[i].ip, ip, sizeof(_probed[i].ip) - 1);
+        _probed[i].ip[sizeof(_probed[i].ip) - 1] = '\0';
+    }
+    _probed[i].at = millis();
+    portEXIT_CRITICAL(&_transport_mux);
+}
+
+static bool transport_fresh(const char* ip) {
+    bool fresh = false;
+    portENTER_CRITICAL(&_transport_mux);
+    for (int i = 0; i < MAX_RTT_DEVICES && !fresh; i++) {
+        fresh = _probed[i].ip[0] && strcmp(_probed[i].ip, ip) == 0 &&
+                millis() - _probed[i].at < PROBE_FRESH_MS;
+    }
+    portEXIT_CRITICAL(&_transport_mux);
+    return fresh;
+}
+
+static bool save_transports() {
+    TransportRecord rec;
+    portENTER_CRITICAL(&_transport_mux);
+    rec = _transports;
+    portEXIT_CRITICAL(&_transport_mux);
+    return state_store_put(STATE_KEY_LINKPLAY, &rec, sizeof(rec));
+}
+
+void linkplay_transport_init() {
+    TransportRecord rec;
+    if (state_store_get(STATE_KEY_LINKPLAY, &rec, sizeof(rec)) != (int)sizeof(rec)) return;
+    rec.count = min<int>(rec.count, MAX_RTT_DEVICES);
+    for (int i = 0; i < rec.count; i++) rec.devices[i].ip[15] = '\0';
+    portENTER_CRITICAL(&_transport_mux);
+    _transports = rec;
+    portEXIT_CRITICAL(&_transport_mux);
+    Serial.printf("[LinkPlay] %d device transport(s) loaded\n", rec.count);
+}
+
+void linkplay_client_task() {
+    if (!_transports_dirty) return;
+    _transports_dirty = false;
+    persist_mark_dirty(save_transports);
+}
+
+static void set_master_ip(const char* wiim_ip) {
+    strncpy(_wiim_ip, wiim_ip, sizeof(_wiim_ip) - 1);
+    _wiim_ip[sizeof(_wiim_ip) - 1] = '\0';
+}
+
 void linkplay_init(const char* wiim_ip) {
     if (wiim_ip && strlen(wiim_ip) > 0) {
-        _wiim_ip = String(wiim_ip);
+        set_master_ip(wiim_ip);
         _initialized = true;
     }
 }
 
 void linkplay_set_ip(const char* wiim_ip) {
-    _wiim_ip = String(wiim_ip);
+    set_master_ip(wiim_ip ? wiim_ip : "");
+    // A newly picked device gets probed again (firmware may have changed),
+    // unless the Devices page probe just did
+    if (_wiim_ip[0] && transport_get(_wiim_ip) != TRANSPORT_UNKNOWN && !transport_fresh(_wiim_ip)) {
+        transport_set(_wiim_ip, TRANSPORT_UNKNOWN);
+    }
     _initialized = true;
-    Serial.printf("[LinkPlay] IP: %s\n", wiim_ip);
+    Serial.printf("[LinkPlay] IP: %s\n", _wiim_ip);
 }
 
-// Internal: send command to an explicit IP
-static String make_request_impl(const String& target_ip, const char* command, int retries) {
-    if (target_ip.length() == 0) return "";
+const char* linkplay_get_ip() {
+    return _wiim_ip;
+}
 
-    String path = "/httpapi.asp?command=" + String(command);
-    IPAddress ip;
-    if (!ip.fromString(target_ip)) return "";
+// ------------------------------------------------------------------
+// Flat JSON objects (getPlayerStatus, getStatusEx): a push parser fed the
+// body as it comes off the connection. Only the values of the fields
+// asked for are copied, into a fixed buffer (long values are truncated),
+// and feeding stops once they are all in.
+// ------------------------------------------------------------------
 
-    for (int attempt = 0; attempt <= retries; attempt++) {
-        if (attempt > 0) delay(1000);
+static const size_t STATUS_KEY_MAX = 16;
+static const size_t STATUS_VALUE_MAX = 160;   // Hex titles: 2 chars per byte
+static const size_t STATUS_CHUNK = 64;        // Body bytes read per feed
+
+struct ScanKey {
+    const char* key;
+    uint8_t field;
+};
+
+static const ScanKey STATUS_KEYS[] = {
+    {"status", LINKPLAY_FIELD_STATE},
+    {"Title", LINKPLAY_FIELD_TITLE},
+    {"Artist", LINKPLAY_FIELD_ARTIST},
+    {"vol", LINKPLAY_FIELD_VOLUME},
+    {"mute", LINKPLAY_FIELD_MUTE},
+    {"plicurr", LINKPLAY_FIELD_PLAYLIST},
+};
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
 
-        WiFiClientSecure client;
-        client.setInsecure();
+// LinkPlay sends Title / Artist as hex-encoded UTF-8; plain text is copied.
+// "unknow(n)" placeholders become empty strings.
+static void decode_text(const char* val, char* out, size_t cap) {
+    // An odd tail means the value was cut by STATUS_VALUE_MAX
+    size_t len = strlen(val);
+    bool is_hex = len > 1;
+    for (size_t i = 0; is_hex && i < len; i++) {
+        if (hex_nibble(val[i]) < 0) is_hex = false;
+    }
 
-        if (!client.connect(ip, 443)) {
-            delay(100);
-            continue;
+    size_t n = 0;
+    bool truncated = false;
+    if (is_hex) {
+        for (size_t i = 0; i + 1 < len; i += 2) {
+            if (n + 1 >= cap) { truncated = true; break; }
+            out[n++] = (char)(hex_nibble(val[i]) << 4 | hex_nibble(val[i + 1]));
         }
+    } else {
+        for (; val[n] && n + 1 < cap; n++) out[n] = val[n];
+        truncated = val[n] != '\0';
+    }
+    // Don't leave half a UTF-8 sequence at the cut
+    if (truncated) {
+        while (n > 0 && ((uint8_t)out[n - 1] & 0xC0) == 0x80) n--;
+        if (n > 0 && ((uint8_t)out[n - 1] & 0x80)) n--;
+    }
+    out[n] = '\0';
 
-        String request = "GET " + path + " HTTP/1.1\r\n";
-        request += "Host: " + target_ip + "\r\n";
-        request += "Connection: close\r\n\r\n";
-        client.print(request);
+    if (strcasecmp(out, "unknow") == 0 || strcasecmp(out, "unknown") == 0) out[0] = '\0';
+}
 
-        unsigned long timeout = millis() + 5000;
-        while (client.connected() && !client.available()) {
-            if (millis() > timeout) {
-                client.stop();
-                continue;
+class FlatScanner {
+public:
+    FlatScanner(const ScanKey* keys, size_t key_count, uint8_t fields)
+        : _keys(keys), _key_count(key_count), _want(fields) {}
+    virtual ~FlatScanner() {}
+
+    // Start over (a retried request)
+    void reset() {
+        clear();
+        _state = START;
+        _seen = 0;
+        _values = 0;
+    }
+
+    // Feed body bytes. False once nothing more is wanted: the fields asked
+    // for are in, or the object ended (or was malformed).
+    bool feed(const char* p, size_t len) {
+        for (size_t i = 0; i < len && _state != END; i++) step(p[i]);
+        return _state != END;
+    }
+
+    // Any field came through
+    bool found() const { return _values > 0; }
+
+private:
+    enum State : uint8_t { START, KEY_WAIT, KEY, COLON, VALUE_WAIT, STRING, BARE, NESTED, NEXT, END };
+
+    static bool is_ws(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    void step(char c) {
+        switch (_state) {
+        case START:
+            if (c == '{') _state = KEY_WAIT;
+            break;
+        case KEY_WAIT:
+            if (is_ws(c)) break;
+            if (c == '"') {
+                _len = 0;
+                _escape = false;
+                _state = KEY;
+            } else {
+                _state = END;   // End of object (or malformed)
             }
-            delay(10);
+            break;
+        case KEY:
+            if (_escape || (c != '\\' && c != '"')) {
+                if (_len + 1 < sizeof(_key)) _key[_len++] = c;
+                _escape = false;
+            } else if (c == '\\') {
+                _escape = true;
+            } else {
+                _key[_len] = '\0';
+                _field = 0;
+                for (size_t k = 0; k < _key_count; k++) {
+                    if (strcmp(_key, _keys[k].key) == 0) _field = _keys[k].field & _want;
+                }
+                _state = COLON;
+            }
+            break;
+        case COLON:
+            if (is_ws(c)) break;
+            _state = c == ':' ? VALUE_WAIT : END;
+            break;
+        case VALUE_WAIT:
+            if (is_ws(c)) break;
+            _len = 0;
+            _escape = false;
+            if (c == '"') {
+                _state = STRING;
+            } else if (c == '{' || c == '[') {
+                _depth = 1;
+                _in_string = false;
+                _state = NESTED;
+            } else {
+                append(c);
+                _state = BARE;
+            }
+            break;
+        case STRING:
+            if (_escape || (c != '\\' && c != '"')) {
+                append(c);   // An escaped char is kept as is
+                _escape = false;
+            } else if (c == '\\') {
+                _escape = true;
+            } else {
+                deliver(NEXT);
+            }
+            break;
+        case BARE:
+            if (c == ',') deliver(KEY_WAIT);
+            else if (c == '}') deliver(END);
+            else if (is_ws(c)) deliver(NEXT);
+            else append(c);
+            break;
+        case NESTED:
+            if (_escape) {
+                _escape = false;
+            } else if (_in_string) {
+                if (c == '\\') _escape = true;
+                else if (c == '"') _in_string = false;
+            } else if (c == '"') {
+                _in_string = true;
+            } else if (c == '{' || c == '[') {
+                _depth++;
+            } else if ((c == '}' || c == ']') && --_depth == 0) {
+                _state = NEXT;
+            }
+            break;
+        case NEXT:
+            if (is_ws(c)) break;
+            _state = c == ',' ? KEY_WAIT : END;
+            break;
+        case END:
+            break;
         }
+    }
 
-        String response = "";
-        bool headers_done = false;
-        while (client.available()) {
-            String line = client.readStringUntil('\n');
-            if (!headers_done) {
-                if (line == "\r" || line.length() == 0) headers_done = true;
-            } else {
-                response += line;
+    void append(char c) {
+        if (_field && _len + 1 < sizeof(_value)) _value[_len++] = c;
+    }
+
+    // A scalar value ended: hand it on if asked for, then go on in next
+    void deliver(State next) {
+        _values++;
+        _state = next;
+        if (!_field) return;
+        _value[_len] = '\0';
+        _seen |= _field;
+        value(_field, _value);
+        if ((_seen & _want) == _want) _state = END;
+    }
+
+protected:
+    virtual void clear() {}
+    virtual void value(uint8_t field, const char* text) = 0;
+
+private:
+    const ScanKey* _keys;
+    size_t _key_count;
+    uint8_t _want;
+    uint8_t _seen;
+    uint8_t _field;       // Field of the value being read, 0 if not wanted
+    State _state;
+    bool _escape;
+    bool _in_string;      // Nested value: inside a string
+    int _depth;
+    int _values;
+    size_t _len;
+    char _key[STATUS_KEY_MAX];
+    char _value[STATUS_VALUE_MAX];
+};
+
+class StatusScanner : public FlatScanner {
+public:
+    StatusScanner(LinkPlayStatus* out, uint8_t fields)
+        : FlatScanner(STATUS_KEYS, sizeof(STATUS_KEYS) / sizeof(STATUS_KEYS[0]), fields),
+          _out(out) { reset(); }
+
+protected:
+    void clear() override {
+        memset(_out, 0, sizeof(*_out));
+        _out->volume = -1;
+    }
+
+    void value(uint8_t field, const char* text) override {
+        switch (field) {
+        case LINKPLAY_FIELD_STATE:
+            strncpy(_out->state, text, sizeof(_out->state) - 1);
+            break;
+        case LINKPLAY_FIELD_TITLE:
+            decode_text(text, _out->title, sizeof(_out->title));
+            break;
+        case LINKPLAY_FIELD_ARTIST:
+            decode_text(text, _out->artist, sizeof(_out->artist));
+            break;
+        case LINKPLAY_FIELD_VOLUME:
+            _out->volume = constrain(atoi(text), 0, 100);
+            break;
+        case LINKPLAY_FIELD_MUTE:
+            _out->mute = atoi(text) != 0;
+            break;
+        case LINKPLAY_FIELD_PLAYLIST:
+            _out->playlist_index = atoi(text);
+            break;
+        }
+    }
+
+private:
+    LinkPlayStatus* _out;
+};
+
+// Feed a response body to the scanner, reading only as far as it wants.
+// Returns true if the body was read completely (the rest is drained).
+static bool scan_reply(HttpsConn* conn, HttpResponse& resp, FlatScanner* scan) {
+    HttpBodyStream stream(conn, resp);
+    char buf[STATUS_CHUNK];
+    size_t n;
+    while ((n = stream.read((uint8_t*)buf, sizeof(buf))) > 0 && scan->feed(buf, n)) {}
+    return stream.finish();
+}
+
+// ------------------------------------------------------------------
+// Request building: fixed buffers only, so a device that runs for weeks
+// doesn't fragment the heap with per-request Strings.
+// ------------------------------------------------------------------
+
+static const size_t PATH_MAX_LEN = 640;      // https_pool's request buffer is 768
+static const size_t COMMAND_MAX_LEN = 96;    // Commands without a URL argument
+static const size_t REPLY_MAX_LEN = 32;      // "OK", "Failed", "unknown command"
+static const char* API_PREFIX = "/httpapi.asp?command=";
+
+// Percent-encode src onto dst+len in one pass (reserved characters, space,
+// controls and non-ASCII; '%' passes through so pre-encoded URLs keep
+// their escapes). Returns the new length, or 0 if it doesn't fit.
+static size_t url_encode_append(char* dst, size_t len, size_t cap, const char* src) {
+    static const char HEX[] = "0123456789ABCDEF";
+    for (const unsigned char* p = (const unsigned char*)src; *p; p++) {
+        unsigned char c = *p;
+        bool plain = isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' || c == '%';
+        size_t need = plain ? 1 : 3;
+        if (len + need >= cap) return 0;
+        if (plain) {
+            dst[len++] = c;
+        } else {
+            dst[len++] = '%';
+            dst[len++] = HEX[c >> 4];
+            dst[len++] = HEX[c & 0x0F];
+        }
+    }
+    dst[len] = '\0';
+    return len;
+}
+
+// "/httpapi.asp?command=<command><encoded url_arg>" into path.
+// url_arg may be nullptr. Returns false if the path doesn't fit.
+static bool build_path(char* path, size_t cap, const char* command, const char* url_arg) {
+    int len = snprintf(path, cap, "%s%s", API_PREFIX, command);
+    if (len <= 0 || (size_t)len >= cap) return false;
+    if (url_arg && url_arg[0]) {
+        return url_encode_append(path, len, cap, url_arg) > 0;
+    }
+    return true;
+}
+
+// Read the body into reply (truncated to cap - 1, whitespace-trimmed).
+// Returns true if the body was read completely.
+static bool read_reply(HttpsConn* conn, HttpResponse& resp, char* reply, size_t cap) {
+    HttpBodyStream stream(conn, resp);
+    size_t len = 0;
+    size_t n;
+    while (len < cap - 1 && (n = stream.read((uint8_t*)reply + len, cap - 1 - len)) > 0) {
+        len += n;
+    }
+    bool complete = stream.finish();
+
+    // Trim
+    while (len > 0 && isspace((unsigned char)reply[len - 1])) len--;
+    reply[len] = '\0';
+    size_t lead = 0;
+    while (lead < len && isspace((unsigned char)reply[lead])) lead++;
+    if (lead > 0) memmove(reply, reply + lead, len - lead + 1);
+    return complete;
+}
+
+// Try getStatusEx on port 80 (harmless if it reaches something else)
+static bool probe_plain_http(const char* target_ip) {
+    char path[48];
+    snprintf(path, sizeof(path), "%sgetStatusEx", API_PREFIX);
+    char reply[REPLY_MAX_LEN];
+    reply[0] = '\0';
+    HttpResponse resp;
+    HttpsConn* conn = http_request(target_ip, path, nullptr, resp, TRANSPORT_PROBE_MS);
+    if (!conn) return false;
+    bool complete = read_reply(conn, resp, reply, sizeof(reply));
+    https_release(conn, complete && resp.keep_alive);
+    return resp.status == 200 && reply[0] == '{';
+}
+
+static HttpsConn* open_request(const char* target_ip, const char* path, HttpResponse& resp,
+                               unsigned long timeout) {
+    Transport t = transport_get(target_ip);
+    if (t == TRANSPORT_UNKNOWN && probe_plain_http(target_ip)) {
+        Serial.printf("[LinkPlay] %s: plain HTTP available\n", target_ip);
+        transport_set(target_ip, TRANSPORT_HTTP);
+        t = TRANSPORT_HTTP;
+    }
+    if (t == TRANSPORT_HTTP) {
+        HttpsConn* conn = http_request(target_ip, path, nullptr, resp, timeout);
+        if (conn) return conn;
+        // Port 80 went away: probe again next time, HTTPS for this one
+        transport_set(target_ip, TRANSPORT_UNKNOWN);
+    }
+
+    HttpsConn* conn = https_request(target_ip, path, nullptr, resp, timeout);
+    // Only an answering device is known to be HTTPS-only (one that is off
+    // fails the probe as well)
+    if (conn && t == TRANSPORT_UNKNOWN) {
+        Serial.printf("[LinkPlay] %s: HTTPS only\n", target_ip);
+        transport_set(target_ip, TRANSPORT_HTTPS);
+    }
+    return conn;
+}
+
+// Internal: send a prebuilt path to an explicit IP (pooled keep-alive
+// connection, plain HTTP where the device allows it). The reply goes into the fixed buffer, into body when it
+// is set (status JSON can be longer than any buffer worth keeping), or
+// through scan as it is read.
+// The response timeout follows the device's RTT estimate; a timeout doubles
+// it, and retries back off 20, 40, 80... ms. Returns false if no non-empty
+// reply came back.
+static bool send_path(const char* target_ip, const char* path, int retries,
+                      char* reply, size_t cap, String* body = nullptr,
+                      FlatScanner* scan = nullptr) {
+    if (reply) reply[0] = '\0';
+    if (!target_ip || !target_ip[0]) return false;
+    if (!wifi_link_up()) return false;   // No retries, backoff or relocation
+
+    IPAddress ip;
+    if (!ip.fromString(target_ip)) return false;
+
+    char moved[16];
+    bool relocated = false;
+    for (int attempt = 0; attempt <= retries; attempt++) {
+        unsigned long timeout = rtt_timeout(target_ip);
+        if (attempt > 0) {
+            unsigned long backoff = RETRY_BACKOFF_MS << (attempt - 1);
+            Serial.printf("[LinkPlay] %s: retry %d in %lu ms (timeout %lu ms)\n",
+                          target_ip, attempt, backoff, timeout);
+            delay(backoff);
+        }
+
+        unsigned long start = millis();
+        HttpResponse resp;
+        HttpsConn* conn = open_request(target_ip, path, resp, timeout);
+        if (!conn) {
+            rtt_backoff(target_ip);
+            // The master may have a new DHCP lease: send this same command
+            // to where it went instead of retrying the old address
+            if (!relocated && strcmp(target_ip, _wiim_ip) == 0 &&
+                wiim_identity_relocate(target_ip, moved, sizeof(moved), RELOCATE_WAIT_MS)) {
+                Serial.printf("[LinkPlay] Master moved to %s, retargeting\n", moved);
+                set_master_ip(moved);
+                target_ip = moved;
+                relocated = true;
+                attempt = -1;   // Full retries, no backoff, at the new address
             }
+            continue;
+        }
+
+        bool complete;
+        if (scan) {
+            scan->reset();
+            complete = scan_reply(conn, resp, scan);
+        } else if (body) {
+            *body = "";
+            complete = https_read_body(conn, resp, body);
+            body->trim();
+        } else {
+            complete = read_reply(conn, resp, reply, cap);
+        }
+        https_release(conn, complete && resp.keep_alive);
+        if (complete && resp.reused) {
+            rtt_sample(target_ip, millis() - start);
         }
-        client.stop();
 
-        response.trim();
-        if (response.length() > 0) return response;
+        if (scan ? scan->found() : body ? body->length() > 0 : reply[0] != '\0') return true;
+    }
+
+    return false;
+}
+
+// Send a command to an IP and check for an "OK" reply
+static bool command_ok_to(const char* target_ip, const char* command,
+                          const char* url_arg = nullptr, int retries = 2) {
+    char path[PATH_MAX_LEN];
+    if (!build_path(path, sizeof(path), command, url_arg)) {
+        Serial.println("[LinkPlay] Command too long");
+        return false;
     }
+    char reply[REPLY_MAX_LEN];
+    return send_path(target_ip, path, retries, reply, sizeof(reply)) &&
+           strcmp(reply, "OK") == 0;
+}
+
+// Same, to the global master IP
+static bool command_ok(const char* command, const char* url_arg = nullptr,
+                       int retries = 2) {
+    if (!_initialized || !_wiim_ip[0]) return false;
+    return command_ok_to(_wiim_ip, command, url_arg, retries);
+}
 
-    return "";
+// Full response as a String (status JSON, serial debugging)
+static String make_request_impl(const char* target_ip, const char* command, int retries) {
+    char path[PATH_MAX_LEN];
+    String body;
+    if (!build_path(path, sizeof(path), command, nullptr)) return "";
+
+    String key = String(target_ip) + path;
+    if (replay_response(REPLAY_LINKPLAY, key.c_str(), &body)) return body;
+
+    unsigned long start = millis();
+    if (!send_path(target_ip, path, retries, nullptr, 0, &body)) body = "";
+    replay_record_response(REPLAY_LINKPLAY, key.c_str(), body, millis() - start);
+    return body;
 }
 
 // Send command to the global master IP
 static String make_request(const char* command, int retries = 2) {
-    if (!_initialized || _wiim_ip.length() == 0) return "";
+    if (!_initialized || !_wiim_ip[0]) return "";
     return make_request_impl(_wiim_ip, command, retries);
 }
 
 bool linkplay_play(const char* stream_url) {
-    // URL encode the stream URL for the setPlayerCmd parameter
-    String encoded_url = stream_url;
-    encoded_url.replace(":", "%3A");
-    encoded_url.replace("/", "%2F");
-    encoded_url.replace("?", "%3F");
-    encoded_url.replace("&", "%26");
-    encoded_url.replace("=", "%3D");
+    TraceScope span(TRACE_LINKPLAY_PLAY);
+    // The stream URL is percent-encoded straight into the request path
+    return command_ok("setPlayerCmd:play:", stream_url);
+}
 
-    String command = "setPlayerCmd:play:" + encoded_url;
-    String response = make_request(command.c_str());
-    return response == "OK";
+bool linkplay_play_playlist(const char* m3u_url, int index) {
+    TraceScope span(TRACE_LINKPLAY_PLAY);
+    if (!_initialized || !_wiim_ip[0]) return false;
+    // setPlayerCmd:playlist:<encoded url>:<index>
+    char path[PATH_MAX_LEN];
+    size_t len = 0;
+    if (!build_path(path, sizeof(path), "setPlayerCmd:playlist:", m3u_url) ||
+        (len = strlen(path)) + 12 >= sizeof(path)) {
+        Serial.println("[LinkPlay] Command too long");
+        return false;
+    }
+    snprintf(path + len, sizeof(path) - len, ":%d", index);
+    char reply[REPLY_MAX_LEN];
+    return send_path(_wiim_ip, path, 2, reply, sizeof(reply)) && strcmp(reply, "OK") == 0;
+}
+
+bool linkplay_next() {
+    return command_ok("setPlayerCmd:next");
 }
 
 bool linkplay_stop() {
-    String response = make_request("setPlayerCmd:stop");
-    return response == "OK";
+    return command_ok("setPlayerCmd:stop");
 }
 
 bool linkplay_pause() {
-    String response = make_request("setPlayerCmd:pause");
-    return response == "OK";
+    return command_ok("setPlayerCmd:pause");
 }
 
 bool linkplay_resume() {
-    String response = make_request("setPlayerCmd:resume");
-    return response == "OK";
+    return command_ok("setPlayerCmd:resume");
 }
 
 bool linkplay_set_sleep_timer(int minutes) {
-    String command = "setSleepTimer:" + String(minutes * 60);
-    String response = make_request(command.c_str());
-    return response == "OK";
+    char command[COMMAND_MAX_LEN];
+    snprintf(command, sizeof(command), "setSleepTimer:%d", minutes * 60);
+    return command_ok(command);
 }
 
-int linkplay_get_volume() {
-    String status = make_request("getPlayerStatus", 1);
-    if (status.length() == 0) return -1;
-
-    // Parse "vol" from JSON response: {"vol":"50",...} or {"vol":50,...}
-    int idx = status.indexOf("\"vol\"");
-    if (idx < 0) return -1;
+bool linkplay_parse_status(const char* json, LinkPlayStatus* out) {
+    StatusScanner scan(out, LINKPLAY_FIELD_ALL);
+    if (json) scan.feed(json, strlen(json));
+    return scan.found();
+}
 
-    idx = status.indexOf(':', idx);
-    if (idx < 0) return -1;
-    idx++;
+bool linkplay_get_player_status(LinkPlayStatus* out, int retries, uint8_t fields) {
+    if (!_initialized || !_wiim_ip[0]) return false;
+    StatusScanner scan(out, fields);
 
-    // Skip whitespace and quotes
-    while (idx < (int)status.length() && (status[idx] == ' ' || status[idx] == '"')) idx++;
+    // Captures and replays deal in whole bodies
+    if (replay_recording() || replay_playing()) {
+        String status = make_request("getPlayerStatus", retries);
+        scan.feed(status.c_str(), status.length());
+        return scan.found();
+    }
+    char path[PATH_MAX_LEN];
+    build_path(path, sizeof(path), "getPlayerStatus", nullptr);
+    return send_path(_wiim_ip, path, retries, nullptr, 0, nullptr, &scan);
+}
 
-    int vol = status.substring(idx).toInt();
-    return constrain(vol, 0, 100);
+int linkplay_get_volume() {
+    LinkPlayStatus status;
+    if (!linkplay_get_player_status(&status, 1, LINKPLAY_FIELD_VOLUME)) return -1;
+    return status.volume;
 }
 
 bool linkplay_set_volume(int volume) {
     if (volume < 0) volume = 0;
     if (volume > 100) volume = 100;
 
-    String command = "setPlayerCmd:vol:" + String(volume);
-    String response = make_request(command.c_str());
-    return response == "OK";
+    char command[COMMAND_MAX_LEN];
+    snprintf(command, sizeof(command), "setPlayerCmd:vol:%d", volume);
+    return command_ok(command);
 }
 
 String linkplay_get_status(int retries) {
@@ -156,100 +811,201 @@ String linkplay_get_status(int retries) {
 
 String linkplay_request_to(const char* ip, const char* command, int retries) {
     if (!ip || strlen(ip) == 0) return "";
-    return make_request_impl(String(ip), command, retries);
+    return make_request_impl(ip, command, retries);
 }
 
 bool linkplay_multiroom_join(const char* slave_ip) {
-    if (!_initialized || _wiim_ip.length() == 0) {
+    if (!_initialized || !_wiim_ip[0]) {
         Serial.println("[LinkPlay] Cannot join: no master IP set");
         return false;
     }
 
-    String command = "ConnectMasterAp:JoinGroupMaster:eth" + _wiim_ip + ":wifi0.0.0.0";
-    Serial.printf("[LinkPlay] Joining slave %s to master %s\n", slave_ip, _wiim_ip.c_str());
-    String response = make_request_impl(String(slave_ip), command.c_str(), 2);
-    bool ok = (response == "OK");
+    char command[COMMAND_MAX_LEN];
+    snprintf(command, sizeof(command), "ConnectMasterAp:JoinGroupMaster:eth%s:wifi0.0.0.0",
+             _wiim_ip);
+    Serial.printf("[LinkPlay] Joining slave %s to master %s\n", slave_ip, _wiim_ip);
+    bool ok = command_ok_to(slave_ip, command);
     Serial.printf("[LinkPlay] Join %s: %s\n", slave_ip, ok ? "OK" : "FAILED");
     return ok;
 }
 
 bool linkplay_multiroom_kick(const char* slave_ip) {
-    String command = "multiroom:SlaveKickout:" + String(slave_ip);
+    char command[COMMAND_MAX_LEN];
+    snprintf(command, sizeof(command), "multiroom:SlaveKickout:%s", slave_ip);
     Serial.printf("[LinkPlay] Kicking slave %s\n", slave_ip);
-    String response = make_request(command.c_str());
-    bool ok = (response == "OK");
+    bool ok = command_ok(command);
     Serial.printf("[LinkPlay] Kick %s: %s\n", slave_ip, ok ? "OK" : "FAILED");
     return ok;
 }
 
 bool linkplay_multiroom_ungroup() {
     Serial.println("[LinkPlay] Ungrouping all slaves");
-    String response = make_request("multiroom:Ungroup");
-    bool ok = (response == "OK");
+    bool ok = command_ok("multiroom:Ungroup");
     Serial.printf("[LinkPlay] Ungroup: %s\n", ok ? "OK" : "FAILED");
     return ok;
 }
 
 // ------------------------------------------------------------------
-// Serial commands
+// Fan-out: one task (and pooled connection) per device
 // ------------------------------------------------------------------
 
-void linkplay_serial_task() {
-    // Check for LinkPlay serial commands
-    // W:ip - Set WiiM IP
-    // P:url - Play URL
-    // S - Stop
-    // V:vol - Set volume
-    // ? - Get status
+// As many as the pool keeps TLS sessions for; the rest queue here rather
+// than in the handshake admission
+static const int FANOUT_MAX_PARALLEL = HTTPS_TLS_SESSIONS_MAX;
+static const uint32_t FANOUT_STACK = 8192;     // TLS handshake per task
+
+typedef bool (*FanoutFn)(const char* ip, void* out);
+
+struct FanoutJob {
+    const char* ip;
+    FanoutFn run;
+    void* out;             // The job's result record, or nullptr
+    int index;
+    QueueHandle_t done;
+};
+
+struct FanoutResult {
+    int index;
+    bool ok;
+};
+
+static void fanout_task(void* arg) {
+    FanoutJob* job = (FanoutJob*)arg;
+    FanoutResult result;
+    result.index = job->index;
+    result.ok = job->run(job->ip, job->out);
+    xQueueSend(job->done, &result, portMAX_DELAY);
+    vTaskDelete(nullptr);
+}
 
-    if (!Serial.available()) return;
+/**
+ * Run one job per device concurrently and collect results as they arrive.
+ * Waits for all of them (each request has bounded timeouts), so the jobs
+ * and queue outlive every task. out (optional) is an array of out_size
+ * records, one per device. A job whose task can't be created runs inline
+ * if inline_ok (the caller's stack can take a TLS handshake), else fails.
+ */
+static int fanout(const char (*ips)[16], int count, FanoutFn run, void* out, size_t out_size,
+                  bool inline_ok, bool* ok, const char* what) {
+    if (count <= 0) return 0;
+
+    FanoutJob* jobs = (FanoutJob*)calloc(count, sizeof(FanoutJob));
+    QueueHandle_t done = xQueueCreate(FANOUT_MAX_PARALLEL, sizeof(FanoutResult));
+    if (!jobs || !done) {
+        free(jobs);
+        if (done) vQueueDelete(done);
+        return 0;
+    }
 
-    char cmd = Serial.peek();
+    unsigned long start = millis();
+    int next = 0, running = 0, finished = 0, succeeded = 0;
+
+    while (finished < count) {
+        // Keep up to FANOUT_MAX_PARALLEL requests in flight
+        while (next < count && running < FANOUT_MAX_PARALLEL) {
+            FanoutJob& job = jobs[next];
+            job.ip = ips[next];
+            job.run = run;
+            job.out = out ? (uint8_t*)out + next * out_size : nullptr;
+            job.index = next;
+            job.done = done;
+            if (xTaskCreate(fanout_task, "lp_fanout", FANOUT_STACK, &job, 1, nullptr) != pdPASS) {
+                FanoutResult result = { next, inline_ok && run(job.ip, job.out) };
+                xQueueSend(done, &result, portMAX_DELAY);
+            }
+            running++;
+            next++;
+        }
 
-    // Only handle our commands
-    if (cmd != 'W' && cmd != 'P' && cmd != 'S' && cmd != 'V' && cmd != '?') {
-        return;
+        FanoutResult result;
+        xQueueReceive(done, &result, portMAX_DELAY);
+        running--;
+        finished++;
+        if (result.ok) succeeded++;
+        if (ok) ok[result.index] = result.ok;
     }
 
-    String line = Serial.readStringUntil('\n');
-    line.trim();
+    vQueueDelete(done);
+    free(jobs);
+    Serial.printf("[LinkPlay] %s %d/%d device(s) in %lu ms\n", what,
+                  succeeded, count, millis() - start);
+    return succeeded;
+}
 
-    if (line.startsWith("W:")) {
-        // Set WiiM IP
-        String ip = line.substring(2);
-        linkplay_set_ip(ip.c_str());
-    }
-    else if (line.startsWith("P:")) {
-        // Play URL
-        String url = line.substring(2);
-        if (linkplay_play(url.c_str())) {
-            Serial.println("[LinkPlay] Play command sent");
-        } else {
-            Serial.println("[LinkPlay] Play command failed");
-        }
-    }
-    else if (line == "S") {
-        // Stop
-        if (linkplay_stop()) {
-            Serial.println("[LinkPlay] Stop command sent");
-        } else {
-            Serial.println("[LinkPlay] Stop command failed");
-        }
-    }
-    else if (line.startsWith("V:")) {
-        // Set volume
-        int vol = line.substring(2).toInt();
-        if (linkplay_set_volume(vol)) {
-            Serial.printf("[LinkPlay] Volume set to %d\n", vol);
-        } else {
-            Serial.println("[LinkPlay] Volume command failed");
-        }
+static bool join_one(const char* ip, void*) {
+    return linkplay_multiroom_join(ip);
+}
+
+static bool kick_one(const char* ip, void*) {
+    return linkplay_multiroom_kick(ip);
+}
+
+int linkplay_multiroom_join_all(const char (*slave_ips)[16], int count, bool* ok) {
+    if (!_initialized || !_wiim_ip[0]) {
+        Serial.println("[LinkPlay] Cannot join: no master IP set");
+        return 0;
     }
-    else if (line == "?") {
-        // Get status
-        String status = linkplay_get_status();
-        if (status.length() > 0) {
-            Serial.println("[LinkPlay] Status: " + status);
+    return fanout(slave_ips, count, join_one, nullptr, 0, true, ok, "Joined");
+}
+
+int linkplay_multiroom_kick_all(const char (*slave_ips)[16], int count, bool* ok) {
+    return fanout(slave_ips, count, kick_one, nullptr, 0, true, ok, "Kicked");
+}
+
+// ------------------------------------------------------------------
+// Device probe: getStatusEx on every device found, at once
+// ------------------------------------------------------------------
+
+static const uint8_t INFO_NAME     = 0x01;
+static const uint8_t INFO_FIRMWARE = 0x02;
+static const uint8_t INFO_GROUP    = 0x04;
+
+static const ScanKey INFO_KEYS[] = {
+    {"DeviceName", INFO_NAME},
+    {"firmware", INFO_FIRMWARE},
+    {"group", INFO_GROUP},   // "1": slave in someone's group
+};
+
+class InfoScanner : public FlatScanner {
+public:
+    explicit InfoScanner(LinkPlayDeviceInfo* out)
+        : FlatScanner(INFO_KEYS, sizeof(INFO_KEYS) / sizeof(INFO_KEYS[0]),
+                      INFO_NAME | INFO_FIRMWARE | INFO_GROUP),
+          _out(out) { reset(); }
+
+protected:
+    void clear() override { memset(_out, 0, sizeof(*_out)); }
+
+    void value(uint8_t field, const char* text) override {
+        if (field == INFO_NAME) {
+            strncpy(_out->name, text, sizeof(_out->name) - 1);
+        } else if (field == INFO_FIRMWARE) {
+            strncpy(_out->firmware, text, sizeof(_out->firmware) - 1);
+        } else if (field == INFO_GROUP) {
+            _out->slave = atoi(text) != 0;
         }
     }
+
+private:
+    LinkPlayDeviceInfo* _out;
+};
+
+static bool probe_one(const char* ip, void* out) {
+    LinkPlayDeviceInfo* info = (LinkPlayDeviceInfo*)out;
+    InfoScanner scan(info);
+    char path[48];
+    build_path(path, sizeof(path), "getStatusEx", nullptr);
+    unsigned long start = millis();
+    bool ok = send_path(ip, path, 0, nullptr, 0, nullptr, &scan);
+    info->ok = ok;
+    info->rtt_ms = (uint16_t)min(millis() - start, (unsigned long)UINT16_MAX);
+    info->plain_http = transport_get(ip) == TRANSPORT_HTTP;
+    if (ok) transport_mark_probed(ip);
+    return ok;
+}
+
+int linkplay_probe_devices(const char (*ips)[16], int count, LinkPlayDeviceInfo* out) {
+    if (!out) return 0;
+    return fanout(ips, count, probe_one, out, sizeof(LinkPlayDeviceInfo), false, nullptr,
+                  "Probed");
 }
@@ -10,15 +10,53 @@
 
 #include <Arduino.h>
 
+// Player status fields RadioWall uses (from getPlayerStatus)
+struct LinkPlayStatus {
+    char state[12];     // "play", "pause", "stop", "load", ...
+    char title[64];     // Track title (hex-decoded, empty if unknown)
+    char artist[64];    // Artist (hex-decoded, empty if unknown)
+    int volume;         // 0-100, -1 if missing
+    bool mute;
+    int playlist_index; // plicurr: 1-based playlist entry, 0 if none
+};
+
+// LinkPlayStatus fields a status read asks for (the rest stay unset)
+enum LinkPlayField : uint8_t {
+    LINKPLAY_FIELD_STATE    = 0x01,
+    LINKPLAY_FIELD_TITLE    = 0x02,
+    LINKPLAY_FIELD_ARTIST   = 0x04,
+    LINKPLAY_FIELD_VOLUME   = 0x08,
+    LINKPLAY_FIELD_MUTE     = 0x10,
+    LINKPLAY_FIELD_PLAYLIST = 0x20,
+    LINKPLAY_FIELD_ALL      = 0x3F,
+};
+
 // Initialize LinkPlay client with WiiM IP address
 void linkplay_init(const char* wiim_ip);
 
 // Set/change WiiM IP address at runtime
 void linkplay_set_ip(const char* wiim_ip);
 
+// Current master IP ("" if none)
+const char* linkplay_get_ip();
+
+// Load the per-device transport (plain HTTP or HTTPS) found by earlier
+// probes (call after state_store_init())
+void linkplay_transport_init();
+
+// Schedule saving transports probed since the last pass (call from loop)
+void linkplay_client_task();
+
 // Play a stream URL
 bool linkplay_play(const char* stream_url);
 
+// Play an M3U playlist from entry index (0-based); the WiiM then steps
+// through it itself
+bool linkplay_play_playlist(const char* m3u_url, int index);
+
+// Skip to the next playlist entry on the WiiM
+bool linkplay_next();
+
 // Stop playback
 bool linkplay_stop();
 
@@ -37,12 +75,18 @@ int linkplay_get_volume();
 // Set sleep timer (0 = cancel, >0 = minutes)
 bool linkplay_set_sleep_timer(int minutes);
 
+// Get and parse the player status as it is read off the connection, with
+// no heap use; the read stops once the fields asked for are in.
+// retries=0 for background polling.
+bool linkplay_get_player_status(LinkPlayStatus* out, int retries = 0,
+                                uint8_t fields = LINKPLAY_FIELD_ALL);
+
+// Parse a getPlayerStatus response held in memory (same parser)
+bool linkplay_parse_status(const char* json, LinkPlayStatus* out);
+
 // Get current status (returns JSON string). retries=0 for background polling.
 String linkplay_get_status(int retries = 1);
 
-// Process serial commands for testing (W:ip, P:url, S, V:vol, ?)
-void linkplay_serial_task();
-
 // Send a command to an arbitrary device IP (for multiroom slave commands)
 String linkplay_request_to(const char* ip, const char* command, int retries = 2);
 
@@ -55,4 +99,26 @@ bool linkplay_multiroom_kick(const char* slave_ip);
 // Multiroom: ungroup all slaves from the current master
 bool linkplay_multiroom_ungroup();
 
+// Multiroom: join / kick several slaves concurrently (one connection each),
+// so a whole group takes about one round trip. ok (optional, count entries)
+// receives per-slave results. Returns the number of slaves that succeeded.
+int linkplay_multiroom_join_all(const char (*slave_ips)[16], int count, bool* ok = nullptr);
+int linkplay_multiroom_kick_all(const char (*slave_ips)[16], int count, bool* ok = nullptr);
+
+// What getStatusEx says about a device (Devices page)
+struct LinkPlayDeviceInfo {
+    bool ok;             // It answered
+    char name[32];       // DeviceName
+    char firmware[24];
+    bool plain_http;     // Takes commands on port 80 (no TLS)
+    bool slave;          // Member of another device's group
+    uint16_t rtt_ms;     // getStatusEx round trip, connection set-up included
+};
+
+// Ask every device for getStatusEx at once, one task and pooled connection
+// each, so the first command after a switch finds the connection open and
+// the transport known. out[i] is for ips[i]. Returns how many answered.
+// Net worker only (net_worker_probe_devices).
+int linkplay_probe_devices(const char (*ips)[16], int count, LinkPlayDeviceInfo* out);
+
 #endif // LINKPLAY_CLIENT_H
@@ -0,0 +1,44 @@
+/**
+ * Event-driven loop scheduling implementation for RadioWall.
+ *
+ * The notification is a counter taken with ulTaskNotifyTake(pdTRUE), so a
+ * notify that lands while the loop is still busy with a pass is not lost:
+ * the next wait returns at once.
+ */
+
+#include "loop_events.h"
+#include "stall_mon.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static TaskHandle_t _loop_task = nullptr;
+static uint32_t _wait_ms = LOOP_IDLE_MS;   // Loop task only
+
+void loop_events_init() {
+    _loop_task = xTaskGetCurrentTaskHandle();
+}
+
+void loop_events_notify() {
+    if (_loop_task) xTaskNotifyGive(_loop_task);
+}
+
+void IRAM_ATTR loop_events_notify_from_isr() {
+    if (!_loop_task) return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(_loop_task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+void loop_events_due_in(uint32_t ms) {
+    if (ms < _wait_ms) _wait_ms = ms;
+}
+
+void loop_events_wait() {
+    // A pass bounds how long a new event waits before the loop sees it
+    stall_mon_end(STALL_LOOP);
+
+    uint32_t ms = _wait_ms;
+    _wait_ms = LOOP_IDLE_MS;
+    if (ms != 0) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+    stall_mon_begin(STALL_LOOP);
+}
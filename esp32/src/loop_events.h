@@ -0,0 +1,34 @@
+/**
+ * Event-driven loop scheduling for RadioWall.
+ *
+ * loop() ends in loop_events_wait(), which blocks the loop task on its
+ * FreeRTOS notification instead of spinning. Anything that gives the loop
+ * work wakes it: the touch ring (touch samples), the button GPIO edge,
+ * event bus posts (event_bus.h), network worker events and the mDNS scan.
+ * Modules with time-based work (double-tap windows, debounce, write-behind
+ * flushes) call loop_events_due_in() during their pass, and the wait ends
+ * at the earliest such deadline. With nothing pending the loop still runs
+ * every LOOP_IDLE_MS for the serial command parsers.
+ */
+
+#ifndef LOOP_EVENTS_H
+#define LOOP_EVENTS_H
+
+#include <Arduino.h>
+
+static const uint32_t LOOP_IDLE_MS = 100;
+
+// Register the calling task as the loop task (call from setup)
+void loop_events_init();
+
+// Wake the loop task (any task / an ISR)
+void loop_events_notify();
+void loop_events_notify_from_isr();
+
+// The caller has work due within ms (loop task, during a pass)
+void loop_events_due_in(uint32_t ms);
+
+// Block until notified or the earliest deadline (end of loop())
+void loop_events_wait();
+
+#endif // LOOP_EVENTS_H
@@ -21,16 +21,52 @@
 #endif
 
 #include "display.h"
+#include "artwork.h"
 #include "ui_state.h"
 #include "menu.h"
 #include "button_handler.h"
 #include "places_db.h"
+#include "station_catalog.h"
+#include "data_update.h"
 #include "linkplay_client.h"
 #include "radio_client.h"
+#include "https_pool.h"
+#include "net_worker.h"
 #include "favorites.h"
 #include "history.h"
+#include "station_table.h"
+#include "station_stats.h"
+#include "idle_refresh.h"
+#include "tap_heat.h"
+#include "net_fault.h"
+#include "perf_hud.h"
+#include "scroll_list.h"
 #include "settings.h"
-#include <ESPmDNS.h>
+#include "persist.h"
+#include "state_store.h"
+#include "wifi_fast.h"
+#include "wifi_link.h"
+#include "wake_snapshot.h"
+#include "loop_events.h"
+#include "serial_cmd.h"
+#include "heap_diag.h"
+#include "bench.h"
+#include "trace.h"
+#include "binlog.h"
+#include "replay.h"
+#include "stall_mon.h"
+#include "metrics_http.h"
+#include "web_remote.h"
+#include "peer_cache.h"
+#include "group_monitor.h"
+#include "wiim_identity.h"
+#include "power_idle.h"
+#include "energy_stats.h"
+#include "haptic.h"
+#include "json_arena.h"
+#include "upnp_events.h"
+#include "event_bus.h"
+#include "mqtt_client.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
 
@@ -41,6 +77,82 @@
 static UIState ui_state;
 WiFiManager wm;  // Global so settings.cpp can access it via extern
 
+// Zoom for the map view. The now playing display (USE_BUILTIN_TOUCH 0)
+// has no map, and the zoom limit would load the vector map to find it.
+static void set_map_zoom(int level) {
+#if USE_BUILTIN_TOUCH
+    ui_state.set_zoom_level(level);
+#else
+    (void)level;
+#endif
+}
+
+// What is playing, as last reported by the network worker. The radio
+// client's own state belongs to the worker task once it is running.
+static StationInfo _now_playing = {};
+
+// Now-playing UI as it was before the first preview of the play still
+// running: a failed play puts it back
+struct PreviewRollback {
+    bool active;
+    bool playing;
+    bool paused;
+    char station[64];
+    char location[64];
+    char country[32];
+    int index;
+    int total;
+    char wiim_title[64];
+    char wiim_artist[64];
+    bool marker;
+    float marker_lat;
+    float marker_lon;
+};
+static PreviewRollback _rollback = {};
+
+static const unsigned long WIFI_CONNECT_TIMEOUT_MS = 20000;
+static bool _network_up = false;     // Worker reported NET_EVT_NETWORK_UP
+static bool _portal_shown = false;   // Main opened the portal and its page
+
+// Tags for play-by-id requests, so the result lands in the right view
+enum PlayTag { PLAY_TAG_FAVORITE = 1, PLAY_TAG_HISTORY = 2, PLAY_TAG_RESUME = 3 };
+
+static const StationInfo* now_playing() {
+    return _now_playing.valid ? &_now_playing : nullptr;
+}
+
+// The latest play request: its progress events fill the status bar's
+// progress edge, and those of requests it replaced are dropped
+static NetRequest _play_request = 0;
+
+static uint32_t _play_requested_ms = 0;
+
+static bool track_play(NetRequest request) {
+    _play_request = request;
+    _play_requested_ms = millis();
+    ui_state.set_play_progress(0);
+    ui_state.set_play_running(request != 0);
+    return request != 0;
+}
+
+// The tracked play is done: log what each stage took, the field view of
+// the pipeline the status bar showed
+static void play_progress_end(bool ok) {
+    static const char* const names[UI_PLAY_STAGES] = { "place", "list", "url", "wiim" };
+    Serial.printf("[Play] %s after %lu ms:", ok ? "Playing" : "Failed",
+                  (unsigned long)(millis() - _play_requested_ms));
+    uint32_t prev = 0;
+    for (int i = 0; i < UI_PLAY_STAGES; i++) {
+        uint32_t ms = ui_state.get_play_stage_ms(i);
+        if (!ms) continue;
+        Serial.printf(" %s %lu", names[i], (unsigned long)(ms - prev));
+        prev = ms;
+    }
+    Serial.println();
+    ui_state.set_play_progress(0);
+    ui_state.set_play_running(false);
+}
+
 // Forward declarations
 static void record_to_history(const StationInfo* station);
 
@@ -48,133 +160,192 @@ static void record_to_history(const StationInfo* station);
 // Playback persistence (resume after reboot)
 // ------------------------------------------------------------------
 
-static const char* PLAYBACK_FILE = "/playback.json";
+static const char* LEGACY_PLAYBACK_FILE = "/playback.json";
+
+// Written behind (persist.h): only the station playing when it flushes,
+// with the stream URL it resolved to, so a resume goes straight to the
+// WiiM without the Radio.garden redirect. Firmware before the URL kept
+// the station alone, which still resumes (by lookup).
+struct PlaybackRecord {
+    StationInfo station;
+    char stream_url[sizeof(WakeSnapshot::stream_url)];   // "" if unknown
+};
+static PlaybackRecord _saved_playback;
+
+// City of the station resumed at boot, warmed once the network is up
+static bool _resume_city = false;
+static float _resume_lat = 0;
+static float _resume_lon = 0;
+static const int WARM_HISTORY = 4;   // Most recent history entries to warm
+
+static bool flush_playback_state() {
+    if (!_saved_playback.station.valid) {
+        return state_store_remove(STATE_KEY_PLAYBACK);
+    }
+    if (!state_store_put(STATE_KEY_PLAYBACK, &_saved_playback, sizeof(_saved_playback))) {
+        return false;
+    }
+    Serial.printf("[Main] Saved playback: %s%s\n", _saved_playback.station.title,
+                  _saved_playback.stream_url[0] ? " (with URL)" : "");
+    return true;
+}
 
-static void save_playback_state() {
-    const StationInfo* station = radio_get_current();
+static void save_playback_state(const StationInfo* station) {
     if (!station || !station->valid) return;
-
-    File f = LittleFS.open(PLAYBACK_FILE, "w");
-    if (!f) return;
-
-    DynamicJsonDocument doc(256);
-    doc["id"] = station->id;
-    doc["t"] = station->title;
-    doc["p"] = station->place;
-    doc["c"] = station->country;
-    doc["lat"] = station->lat;
-    doc["lon"] = station->lon;
-    serializeJson(doc, f);
-    f.close();
-    Serial.printf("[Main] Saved playback: %s\n", station->title);
+    memset(&_saved_playback, 0, sizeof(_saved_playback));   // Same play, same bytes
+    // The worker sets the wake snapshot's station before it reports the play
+    StationInfo playing;
+    wake_snapshot_get_station(&playing, _saved_playback.stream_url,
+                              sizeof(_saved_playback.stream_url));
+    if (!playing.valid || strcmp(playing.id, station->id) != 0) {
+        _saved_playback.stream_url[0] = '\0';
+    }
+    _saved_playback.station = *station;
+    persist_mark_dirty(flush_playback_state);
 }
 
 static void clear_playback_state() {
-    if (LittleFS.exists(PLAYBACK_FILE)) {
-        LittleFS.remove(PLAYBACK_FILE);
-        Serial.println("[Main] Cleared saved playback");
-    }
+    _saved_playback.station.valid = false;
+    persist_mark_dirty(flush_playback_state);
 }
 
-static bool resume_playback() {
-    if (!LittleFS.exists(PLAYBACK_FILE)) return false;
-
-    File f = LittleFS.open(PLAYBACK_FILE, "r");
+// Older firmware kept the last station in /playback.json
+static bool load_legacy_playback(StationInfo* out) {
+    File f = LittleFS.open(LEGACY_PLAYBACK_FILE, "r");
     if (!f) return false;
 
-    DynamicJsonDocument doc(256);
-    if (deserializeJson(doc, f)) { f.close(); return false; }
+    JsonArenaDoc doc(JSON_ARENA_FILE);
+    bool ok = !deserializeJson(doc, f);
     f.close();
+    LittleFS.remove(LEGACY_PLAYBACK_FILE);
+    if (!ok) return false;
+
+    memset(out, 0, sizeof(*out));
+    strncpy(out->id, doc["id"] | "", sizeof(out->id) - 1);
+    strncpy(out->title, doc["t"] | "", sizeof(out->title) - 1);
+    strncpy(out->place, doc["p"] | "", sizeof(out->place) - 1);
+    strncpy(out->country, doc["c"] | "", sizeof(out->country) - 1);
+    out->lat = doc["lat"] | 0.0f;
+    out->lon = doc["lon"] | 0.0f;
+    out->valid = true;
+    return true;
+}
 
-    const char* id = doc["id"] | "";
-    const char* title = doc["t"] | "";
-    const char* place = doc["p"] | "";
-    const char* country = doc["c"] | "";
-    float lat = doc["lat"] | 0.0f;
-    float lon = doc["lon"] | 0.0f;
-
-    if (strlen(id) == 0) return false;
-
-    Serial.printf("[Main] Resuming: %s (%s, %s)\n", title, place, country);
-
-    if (radio_play_by_id(id, title, place, country, lat, lon)) {
-        ui_state.set_playing(title, place);
-        ui_state.set_marker(lat, lon);
+// Woken from Power Off: everything comes from RTC memory, and a known
+// stream URL makes the resume a single LinkPlay request
+static bool resume_from_snapshot(const WakeSnapshot& wake) {
+    const StationInfo& st = wake.station;
+    Serial.printf("[Main] Resuming after wake: %s (%s, %s)\n", st.title, st.place, st.country);
+
+    if (wake.stream_url[0] != '\0') radio_seed_stream_url(st.id, wake.stream_url);
+    set_map_zoom(wake.zoom);
+    ui_state.set_slice_index(wake.slice);
+    _resume_city = true;
+    _resume_lat = st.lat;
+    _resume_lon = st.lon;
+    return track_play(net_worker_play_by_id(st.id, st.title, st.place, st.country,
+                                            st.lat, st.lon, PLAY_TAG_RESUME));
+}
 
-        int slice_idx = ui_state.slice_index_for_lon(lon);
-        ui_state.set_slice_index(slice_idx);
-        return true;
+static bool resume_playback() {
+    PlaybackRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    int len = state_store_get(STATE_KEY_PLAYBACK, &rec, sizeof(rec));
+    bool found = len == (int)sizeof(rec) || len == (int)sizeof(StationInfo);
+    if (!found && LittleFS.exists(LEGACY_PLAYBACK_FILE)) {
+        found = load_legacy_playback(&rec.station);
+        if (found) save_playback_state(&rec.station);
     }
-
-    Serial.println("[Main] Resume failed - clearing saved state");
-    clear_playback_state();
-    return false;
+    const StationInfo& saved = rec.station;
+    if (!found || !saved.valid || strlen(saved.id) == 0) return false;
+    rec.stream_url[sizeof(rec.stream_url) - 1] = '\0';
+
+    Serial.printf("[Main] Resuming: %s (%s, %s)%s\n", saved.title, saved.place, saved.country,
+                  rec.stream_url[0] ? ", known URL" : "");
+    if (rec.stream_url[0] != '\0') radio_seed_stream_url(saved.id, rec.stream_url);
+
+    // Open on the station's slice; the marker follows once it plays
+    ui_state.set_slice_index(ui_state.slice_index_for_lon(saved.lon));
+    _resume_city = true;
+    _resume_lat = saved.lat;
+    _resume_lon = saved.lon;
+    return track_play(net_worker_play_by_id(saved.id, saved.title, saved.place, saved.country,
+                                            saved.lat, saved.lon, PLAY_TAG_RESUME));
 }
 
 // ------------------------------------------------------------------
-// Callbacks
+// Input handlers (run by on_bus_event)
 // ------------------------------------------------------------------
 
-static void on_map_touch(int server_x, int server_y) {
+static void on_map_location(float lat, float lon) {
     display_wake();
 
     // Show loading feedback in status bar
     ui_state.set_status_text("Loading...");
-    display_update_status_bar(&ui_state);
+    display_invalidate(DISPLAY_PART_STATUS);
 
-    // Convert server coordinates (1024x600 equirectangular) to lat/lon
+    Serial.printf("[Main] Touch -> lat=%.2f, lon=%.2f\n", lat, lon);
+    tap_heat_record(lat, lon);
+
+    // Result arrives as a worker event (see handle_net_event)
+    track_play(net_worker_play_at_location(lat, lon, settings_get_country_mode()));
+}
+
+// Server coordinates (1024x600 equirectangular): USB panel, serial simulation
+static void on_map_touch(int server_x, int server_y) {
+    trace_tap_start(millis());
     float lon = (server_x / 1024.0f) * 360.0f - 180.0f;
     float lat = 90.0f - (server_y / 600.0f) * 180.0f;
+    on_map_location(lat, lon);
+}
 
-    Serial.printf("[Main] Touch -> lat=%.2f, lon=%.2f\n", lat, lon);
+// First map tap, still waiting out the double-tap window: start the
+// place lookup and fetches now so the tap's play finds them cached
+static void on_map_tap_pending(float lat, float lon) {
+    net_worker_prefetch_location(lat, lon);
+}
 
-    if (radio_play_at_location(lat, lon)) {
-        const StationInfo* station = radio_get_current();
-        if (station) {
-            ui_state.set_playing(station->title, station->place);
-            ui_state.set_marker(station->lat, station->lon);
-            save_playback_state();
-            record_to_history(station);
-            display_draw_marker_at_latlon(station->lat, station->lon, &ui_state);
-            display_update_status_bar(&ui_state);
-        }
-    } else {
-        ui_state.set_status_text("No stations found");
-        display_update_status_bar(&ui_state);
+#if USE_BUILTIN_TOUCH
+// Scrub along a drag (builtin_touch.h): each audition is a play like a
+// tap and supersedes the last; cities ahead are only warmed
+static void on_map_scrub(MapScrubPhase phase, float lat, float lon) {
+    switch (phase) {
+        case MAP_SCRUB_START:
+            display_wake();
+            break;
+        case MAP_SCRUB_AHEAD:
+            net_worker_prefetch_location(lat, lon);
+            break;
+        case MAP_SCRUB_AUDITION:
+            on_map_location(lat, lon);
+            break;
+        case MAP_SCRUB_END:
+            break;
     }
 }
+#endif
 
 // ------------------------------------------------------------------
-// Double-tap zoom callback
+// Double-tap zoom
 // ------------------------------------------------------------------
 
+// Portrait map coordinates -> lat/lon in the current (zoomed) view
+static void portrait_to_latlon(int portrait_x, int portrait_y, float* out_lat, float* out_lon) {
+    int lat_x100, lon_x100;
+    ui_state.unproject(portrait_x, portrait_y, &lat_x100, &lon_x100);
+    *out_lat = lat_x100 / 100.0f;
+    *out_lon = lon_x100 / 100.0f;
+}
+
 static void on_map_double_tap(int portrait_x, int portrait_y) {
     display_wake();
 
-    const int MAP_AREA_HEIGHT = 580;
-    const int MAP_W = 180;
-
-    // Convert portrait coords to lat/lon (same math as fire_map_tap)
-    float norm_x = portrait_x / (float)(MAP_W - 1);
-    float norm_y = portrait_y / (float)(MAP_AREA_HEIGHT - 1);
-
-    float lon_min = ui_state.get_view_lon_min();
-    float lon_max = ui_state.get_view_lon_max();
-    float lat_max = ui_state.get_view_lat_max();
-    float lat_min = ui_state.get_view_lat_min();
+    float lat, lon;
+    portrait_to_latlon(portrait_x, portrait_y, &lat, &lon);
 
-    float lon_range = lon_max - lon_min;
-    if (lon_range < 0) lon_range += 360.0f;
-
-    float lon = lon_min + norm_x * lon_range;
-    float lat = lat_max - norm_y * (lat_max - lat_min);
-
-    if (lon > 180.0f) lon -= 360.0f;
-    if (lon < -180.0f) lon += 360.0f;
-
-    // Cycle zoom: 1 -> 2 -> 3 -> 4 -> 5 -> 1
+    // Cycle zoom: 1 -> 2 -> ... -> highest level the map data has -> 1
     int current_zoom = ui_state.get_zoom_level();
-    int new_zoom = (current_zoom >= 5) ? 1 : current_zoom + 1;
+    int new_zoom = (current_zoom >= world_map_zoom_max()) ? 1 : current_zoom + 1;
 
     Serial.printf("[Main] Double-tap zoom: %dx -> %dx at (%.1f, %.1f)\n",
                   current_zoom, new_zoom, lat, lon);
@@ -182,11 +353,27 @@ static void on_map_double_tap(int portrait_x, int portrait_y) {
     ui_state.set_zoom_centered(new_zoom, lat, lon);
     settings_set_zoom_no_render(new_zoom);
 
-    display_show_map_view(&ui_state);
+    display_invalidate(DISPLAY_PART_VIEW);
+}
+
+// Pinch on the map: the touch layer picks the level from the finger spread
+static void on_map_pinch_zoom(int zoom_level, int portrait_x, int portrait_y) {
+    display_wake();
+
+    float lat, lon;
+    portrait_to_latlon(portrait_x, portrait_y, &lat, &lon);
+
+    Serial.printf("[Main] Pinch zoom: %dx -> %dx at (%.1f, %.1f)\n",
+                  ui_state.get_zoom_level(), zoom_level, lat, lon);
+
+    ui_state.set_zoom_centered(zoom_level, lat, lon);
+    settings_set_zoom_no_render(zoom_level);
+
+    display_invalidate(DISPLAY_PART_VIEW);
 }
 
 // ------------------------------------------------------------------
-// Favorites callbacks
+// Favorites
 // ------------------------------------------------------------------
 
 static void on_favorite_play(int index) {
@@ -194,31 +381,15 @@ static void on_favorite_play(int index) {
     if (!fav) return;
 
     ui_state.set_status_text("Loading...");
-    display_show_favorites_view(&ui_state);
+    display_invalidate(DISPLAY_PART_VIEW);
 
-    if (radio_play_by_id(fav->station_id, fav->title, fav->place, fav->country,
-                         fav->lat, fav->lon)) {
-        ui_state.set_playing(fav->title, fav->place);
-        ui_state.set_marker(fav->lat, fav->lon);
-        save_playback_state();
-        record_to_history(radio_get_current());
-
-        // Auto-switch to correct map slice
-        int slice_idx = ui_state.slice_index_for_lon(fav->lon);
-        ui_state.set_slice_index(slice_idx);
-
-        // Go to map view with marker
-        ui_state.set_view_mode(VIEW_MAP);
-        display_show_map_view(&ui_state);
-    } else {
-        ui_state.set_status_text("Failed to play");
-        display_show_favorites_view(&ui_state);
-    }
+    track_play(net_worker_play_by_id(fav->station_id, fav->title, fav->place, fav->country,
+                                     fav->lat, fav->lon, PLAY_TAG_FAVORITE));
 }
 
 static void on_favorite_delete(int index) {
     favorites_remove(index);
-    display_show_favorites_view(&ui_state);
+    display_invalidate(DISPLAY_PART_VIEW);
 }
 
 // ------------------------------------------------------------------
@@ -246,68 +417,51 @@ static void on_history_play(int index) {
     if (!entry) return;
 
     ui_state.set_status_text("Loading...");
-    display_show_history_view(&ui_state);
-
-    if (radio_play_by_id(entry->station_id, entry->title, entry->place, entry->country,
-                         entry->lat, entry->lon)) {
-        ui_state.set_playing(entry->title, entry->place);
-        ui_state.set_marker(entry->lat, entry->lon);
-        save_playback_state();
-
-        int slice_idx = ui_state.slice_index_for_lon(entry->lon);
-        ui_state.set_slice_index(slice_idx);
+    display_invalidate(DISPLAY_PART_VIEW);
 
-        ui_state.set_view_mode(VIEW_MAP);
-        display_show_map_view(&ui_state);
-    } else {
-        ui_state.set_status_text("Failed to play");
-        display_show_history_view(&ui_state);
-    }
+    track_play(net_worker_play_by_id(entry->station_id, entry->title, entry->place, entry->country,
+                                     entry->lat, entry->lon, PLAY_TAG_HISTORY));
 }
 
 // ------------------------------------------------------------------
-// Settings callback
+// Settings
 // ------------------------------------------------------------------
 
 static void on_device_selected(const char* ip, const char* name) {
     Serial.printf("[Main] WiiM device selected: %s (%s)\n", name, ip);
 
-    // Stop playback on the old device before switching
-    if (ui_state.get_is_playing()) {
-        linkplay_stop();
-        radio_stop();
-        ui_state.set_stopped();
-        clear_playback_state();
-    }
-
-    // Ungroup all slaves from the OLD master before switching
-    linkplay_multiroom_ungroup();
+    // Stop playback on the old device before switching (queued ahead of
+    // the switch; the UI updates on NET_EVT_STOPPED)
+    if (ui_state.get_is_playing()) net_worker_stop();
 
-    // Switch to new primary
-    linkplay_set_ip(ip);
+    // Ungroup the old master, switch, then re-join saved members to the new one
+    net_worker_set_device(ip);
 
-    // Re-join saved group members to the NEW master
     char grp_ips[MAX_GROUP_DEVICES][16];
     int grp_count = settings_get_group_ips(grp_ips, MAX_GROUP_DEVICES);
+    int rejoin_count = 0;
     for (int i = 0; i < grp_count; i++) {
         if (strcmp(grp_ips[i], ip) == 0) continue;  // Skip self
-        Serial.printf("[Main] Re-joining %s to new master\n", grp_ips[i]);
-        linkplay_multiroom_join(grp_ips[i]);
-        delay(500);
+        if (rejoin_count != i) memcpy(grp_ips[rejoin_count], grp_ips[i], sizeof(grp_ips[i]));
+        rejoin_count++;
+    }
+    if (rejoin_count > 0) {
+        Serial.printf("[Main] Re-joining %d member(s) to new master\n", rejoin_count);
+        net_worker_rejoin_group(grp_ips, rejoin_count);
     }
-
-    ui_state.set_status_text("Device set!");
-    display_update_status_bar_settings(&ui_state);
 }
 
 static void on_group_changed(const char* slave_ip, bool joined) {
-    if (joined) {
-        Serial.printf("[Main] Joining %s to multiroom group\n", slave_ip);
-        linkplay_multiroom_join(slave_ip);
-    } else {
-        Serial.printf("[Main] Removing %s from multiroom group\n", slave_ip);
-        linkplay_multiroom_kick(slave_ip);
-    }
+    net_worker_group_member(slave_ip, joined);
+}
+
+// The primary answered at a new address. A failed linkplay command has
+// already retargeted; a move found by a background resolve has not.
+static void on_device_moved(const char* old_ip, const char* new_ip) {
+    net_worker_device_moved(old_ip, new_ip);
+    settings_device_moved(old_ip, new_ip);
+    upnp_events_set_device(new_ip);
+    group_monitor_set_master(new_ip);
 }
 
 // Helper: toggle between map and menu views
@@ -323,10 +477,10 @@ static void on_ui_button(int button_id) {
         if (button_id == 0) {
             Serial.println("[Main] BACK (to menu)");
             ui_state.set_view_mode(VIEW_MENU);
-            display_show_menu_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
         } else if (button_id == 1) {
-            const StationInfo* station = radio_get_current();
-            if (station && station->valid) {
+            const StationInfo* station = now_playing();
+            if (station) {
                 if (favorites_contains(station->id)) {
                     ui_state.set_status_text("Already saved");
                 } else {
@@ -350,39 +504,39 @@ static void on_ui_button(int button_id) {
             } else {
                 ui_state.set_status_text("Nothing playing");
             }
-            display_show_favorites_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
         }
     } else if (mode == VIEW_HISTORY) {
         // History mode: left = BACK (to menu), right = CLEAR
         if (button_id == 0) {
             Serial.println("[Main] BACK (to menu)");
             ui_state.set_view_mode(VIEW_MENU);
-            display_show_menu_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
         } else if (button_id == 1) {
             Serial.println("[Main] CLEAR history");
             history_clear();
-            display_show_history_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
         }
     } else if (mode == VIEW_SETTINGS) {
         // Settings sub-menu: left = BACK (to main menu)
         if (button_id == 0) {
             Serial.println("[Main] BACK (to menu)");
             ui_state.set_view_mode(VIEW_MENU);
-            display_show_menu_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
         }
     } else if (mode == VIEW_SETTINGS_WIFI || mode == VIEW_SETTINGS_DEVICES) {
         // Settings sub-pages: left = BACK (to settings menu)
         if (button_id == 0) {
             Serial.println("[Main] BACK (to settings)");
             ui_state.set_view_mode(VIEW_SETTINGS);
-            display_show_settings_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
         }
     } else if (mode == VIEW_VOLUME) {
         // Volume mode: left = BACK (to menu), right = MUTE
         if (button_id == 0) {
             Serial.println("[Main] BACK (to menu)");
             ui_state.set_view_mode(VIEW_MENU);
-            display_show_menu_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
         } else if (button_id == 1) {
             Serial.println("[Main] MUTE (TODO)");
         }
@@ -400,35 +554,28 @@ static void on_ui_button(int button_id) {
         } else if (button_id == 1) {
             Serial.println("[Main] NEXT");
             ui_state.set_status_text("Loading...");
-            display_update_status_bar(&ui_state);
-            if (radio_play_next()) {
-                const StationInfo* station = radio_get_current();
-                if (station) {
-                    ui_state.set_playing(station->title, station->place);
-                    ui_state.set_marker(station->lat, station->lon);
-                    save_playback_state();
-                    record_to_history(station);
-                    display_draw_marker_at_latlon(station->lat, station->lon, &ui_state);
-                    display_update_status_bar(&ui_state);
-                }
-            } else {
-                ui_state.set_status_text("No more stations");
-                display_update_status_bar(&ui_state);
-            }
+            display_invalidate(DISPLAY_PART_STATUS);
+            track_play(net_worker_play_next());
         }
     }
 }
 
 static void on_slice_cycle() {
+    // The button cancels the WiFi portal wherever it was opened
+    if (wifi_link_portal_active()) {
+        display_wake();
+        wifi_link_portal_cancel();
+        return;
+    }
     if (ui_state.get_view_mode() == VIEW_FAVORITES) {
-        favorites_next_page();
-        display_show_favorites_view(&ui_state);
+        favorites_page_down();
+        display_invalidate(DISPLAY_PART_VIEW);
         display_wake();
         return;
     }
     if (ui_state.get_view_mode() == VIEW_HISTORY) {
-        history_next_page();
-        display_show_history_view(&ui_state);
+        history_page_down();
+        display_invalidate(DISPLAY_PART_VIEW);
         display_wake();
         return;
     }
@@ -436,8 +583,8 @@ static void on_slice_cycle() {
     ui_state.cycle_slice();
     MapSlice& slice = ui_state.get_current_slice();
     Serial.printf("[Main] Region: %s\n", slice.name);
-    display_refresh_map_only(&ui_state);
-    display_update_status_bar(&ui_state);
+    display_slide_map(&ui_state, 1);
+    display_invalidate(DISPLAY_PART_STATUS);
     display_wake();
 }
 
@@ -453,26 +600,12 @@ static void on_next_button() {
     display_wake();
 
     ui_state.set_status_text("Loading...");
-    display_update_status_bar(&ui_state);
-
-    if (radio_play_next()) {
-        const StationInfo* station = radio_get_current();
-        if (station) {
-            ui_state.set_playing(station->title, station->place);
-            ui_state.set_marker(station->lat, station->lon);
-            save_playback_state();
-            record_to_history(station);
-            display_draw_marker_at_latlon(station->lat, station->lon, &ui_state);
-            display_update_status_bar(&ui_state);
-        }
-    } else {
-        ui_state.set_status_text("No more stations");
-        display_update_status_bar(&ui_state);
-    }
+    display_invalidate(DISPLAY_PART_STATUS);
+    track_play(net_worker_play_next());
 }
 
 // ------------------------------------------------------------------
-// Swipe callback
+// Swipe
 // ------------------------------------------------------------------
 
 static void on_swipe(int direction) {
@@ -502,46 +635,45 @@ static void on_swipe(int direction) {
 
     if (changed) {
         MapSlice& slice = ui_state.get_current_slice();
-        Serial.printf("[Main] Swipe dir=%d -> %s (zoom=%d col=%d row=%d)\n",
+        Serial.printf("[Main] Swipe dir=%d -> %s (zoom=%d view=%d,%d)\n",
                       direction, slice.name, zoom,
-                      ui_state.get_zoom_col(), ui_state.get_zoom_row());
-        display_refresh_map_only(&ui_state);
-        display_update_status_bar(&ui_state);
+                      ui_state.get_view_x(), ui_state.get_view_y());
+        // A new 1x slice slides in from the side it lies on
+        if (zoom > 1) display_invalidate(DISPLAY_PART_MAP);
+        else display_slide_map(&ui_state, direction);
+        display_invalidate(DISPLAY_PART_STATUS);
     }
 }
 
 // ------------------------------------------------------------------
-// Volume callback
+// Volume
 // ------------------------------------------------------------------
 
-static unsigned long _last_vol_update = 0;
+static unsigned long _last_volume_touch = 0;   // millis() of the last slider move
+static const unsigned long VOLUME_TOUCH_HOLD_MS = 2000;  // Ignore polled volume this long
 
 static void on_volume_change(int volume) {
+    _last_volume_touch = millis();
     ui_state.set_volume(volume);
-    display_update_volume_bar(&ui_state);
+    display_invalidate(DISPLAY_PART_VOLUME);
 
-    // Debounce LinkPlay calls to every 200ms
-    unsigned long now = millis();
-    if (now - _last_vol_update > 200) {
-        linkplay_set_volume(volume);
-        _last_vol_update = now;
-        Serial.printf("[Main] Volume: %d%%\n", volume);
-    }
+    // Coalesced by the worker: it sends the latest value once per round trip
+    net_worker_set_volume(volume);
 }
 
 // ------------------------------------------------------------------
-// Menu callbacks
+// Menu
 // ------------------------------------------------------------------
 
 static void toggle_menu() {
     if (ui_state.get_view_mode() == VIEW_MAP) {
         ui_state.set_view_mode(VIEW_MENU);
-        display_show_menu_view(&ui_state);
+        display_invalidate(DISPLAY_PART_VIEW);
     } else {
         // From menu or volume -> back to map
-        ui_state.set_zoom_level(settings_get_zoom());  // Sync zoom from settings
+        set_map_zoom(settings_get_zoom());  // Sync zoom from settings
         ui_state.set_view_mode(VIEW_MAP);
-        display_show_map_view(&ui_state);
+        display_invalidate(DISPLAY_PART_VIEW);
     }
 }
 
@@ -549,37 +681,34 @@ static void on_menu_item(MenuItemId item_id) {
     Serial.printf("[Main] Menu item selected: %d\n", item_id);
 
     switch (item_id) {
-        case MENU_VOLUME: {
-            // Fetch actual volume from WiiM before showing slider
-            int current_vol = linkplay_get_volume();
-            if (current_vol >= 0) {
-                ui_state.set_volume(current_vol);
-            }
+        case MENU_VOLUME:
+            // Show the last known volume; the WiiM's actual volume follows
+            // as a NET_EVT_VOLUME event
+            net_worker_get_volume();
             ui_state.set_view_mode(VIEW_VOLUME);
-            display_show_volume_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
             break;
-        }
         case MENU_PAUSE_RESUME:
             if (ui_state.get_is_playing() && !ui_state.is_paused()) {
-                linkplay_pause();
+                net_worker_pause();
                 ui_state.set_paused(true);
                 ui_state.set_status_text("Paused");
             } else if (ui_state.is_paused()) {
-                linkplay_resume();
+                net_worker_resume();
                 ui_state.set_paused(false);
                 ui_state.set_status_text("Resumed");
             }
-            display_update_status_bar_menu(&ui_state);
+            display_invalidate(DISPLAY_PART_STATUS);
             break;
         case MENU_FAVORITES:
-            favorites_set_page(0);
+            favorites_scroll_to_top();
             ui_state.set_view_mode(VIEW_FAVORITES);
-            display_show_favorites_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
             break;
         case MENU_HISTORY:
-            history_set_page(0);
+            history_scroll_to_top();
             ui_state.set_view_mode(VIEW_HISTORY);
-            display_show_history_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
             break;
         case MENU_SLEEP_TIMER: {
             // Cycle through presets: Off -> 15 -> 30 -> 60 -> 90 -> Off
@@ -594,7 +723,7 @@ static void on_menu_item(MenuItemId item_id) {
                 }
             }
             int next_min = presets[next_idx];
-            linkplay_set_sleep_timer(next_min);
+            net_worker_set_sleep_timer(next_min);
             ui_state.set_sleep_timer(next_min);
             if (next_min > 0) {
                 char buf[24];
@@ -603,28 +732,38 @@ static void on_menu_item(MenuItemId item_id) {
             } else {
                 ui_state.set_status_text("Sleep: off");
             }
-            display_update_status_bar_menu(&ui_state);
+            display_invalidate(DISPLAY_PART_STATUS);
             break;
         }
         case MENU_SETTINGS:
             ui_state.set_view_mode(VIEW_SETTINGS);
-            display_show_settings_view(&ui_state);
+            display_invalidate(DISPLAY_PART_VIEW);
             break;
         case MENU_STOP:
             Serial.println("[Main] Stop from menu");
-            radio_stop();
-            ui_state.set_stopped();
-            clear_playback_state();
-            display_update_status_bar_menu(&ui_state);
+            net_worker_stop();   // UI updates on NET_EVT_STOPPED
             break;
         case MENU_POWER_OFF:
             Serial.println("[Main] Power Off from menu");
+            wake_snapshot_save(settings_get_wiim_ip(), settings_get_zoom(),
+                               ui_state.get_current_slice_index());
             settings_power_off();
             break;
         default: break;
     }
 }
 
+#if USE_BUILTIN_TOUCH
+static void on_list_scroll(ListScrollPhase phase, int dy, float velocity_y) {
+    display_wake();
+    switch (phase) {
+        case LIST_SCROLL_GRAB:    scroll_list_grab(); break;
+        case LIST_SCROLL_DRAG:    scroll_list_drag(display_get_gfx(), dy); break;
+        case LIST_SCROLL_RELEASE: scroll_list_fling(velocity_y); break;
+    }
+}
+#endif
+
 static void on_menu_touch(int portrait_x, int portrait_y) {
     display_wake();
     ViewMode mode = ui_state.get_view_mode();
@@ -633,18 +772,14 @@ static void on_menu_touch(int portrait_x, int portrait_y) {
     } else if (mode == VIEW_HISTORY) {
         history_handle_touch(portrait_x, portrait_y, display_get_gfx());
     } else if (mode == VIEW_SETTINGS) {
-        // Settings sub-menu: detect which item was tapped
-        if (settings_handle_touch(portrait_x, portrait_y, display_get_gfx())) {
-            // Determine which item: y < TITLE(40)+ITEM(80) = WiFi, else Devices
-            int idx = (portrait_y - 40) / 80;
-            if (idx == 0) {
-                ui_state.set_view_mode(VIEW_SETTINGS_WIFI);
-                display_show_settings_wifi_view(&ui_state);
-            } else if (idx == 1) {
-                ui_state.set_view_mode(VIEW_SETTINGS_DEVICES);
-                settings_start_scan();
-                display_show_settings_devices_view(&ui_state);
-            }
+        int item = settings_handle_touch(portrait_x, portrait_y, display_get_gfx());
+        if (item == SETTINGS_ITEM_WIFI) {
+            ui_state.set_view_mode(VIEW_SETTINGS_WIFI);
+            display_invalidate(DISPLAY_PART_VIEW);
+        } else if (item == SETTINGS_ITEM_DEVICES) {
+            ui_state.set_view_mode(VIEW_SETTINGS_DEVICES);
+            settings_start_scan();
+            display_invalidate(DISPLAY_PART_VIEW);
         }
     } else if (mode == VIEW_SETTINGS_WIFI) {
         settings_wifi_handle_touch(portrait_x, portrait_y, display_get_gfx());
@@ -653,8 +788,408 @@ static void on_menu_touch(int portrait_x, int portrait_y) {
     } else {
         menu_handle_touch(portrait_x, portrait_y, display_get_gfx());
     }
+    // Handlers draw their own feedback straight to the gfx
+    display_flush();
+}
+
+// ------------------------------------------------------------------
+// Network worker events
+// ------------------------------------------------------------------
+
+static void copy_str(char* dst, const char* src, size_t cap) {
+    strncpy(dst, src, cap - 1);
+    dst[cap - 1] = '\0';
+}
+
+static void preview_save() {
+    PreviewRollback& r = _rollback;
+    r.active = true;
+    r.playing = ui_state.get_is_playing();
+    r.paused = ui_state.is_paused();
+    copy_str(r.station, ui_state.get_station_name(), sizeof(r.station));
+    copy_str(r.location, ui_state.get_location(), sizeof(r.location));
+    copy_str(r.country, ui_state.get_country(), sizeof(r.country));
+    r.index = ui_state.get_station_index();
+    r.total = ui_state.get_station_total();
+    copy_str(r.wiim_title, ui_state.get_wiim_title(), sizeof(r.wiim_title));
+    copy_str(r.wiim_artist, ui_state.get_wiim_artist(), sizeof(r.wiim_artist));
+    r.marker = ui_state.has_marker();
+    r.marker_lat = ui_state.get_marker_lat();
+    r.marker_lon = ui_state.get_marker_lon();
+}
+
+// Returns true if the marker moved back (the map needs a redraw)
+static bool preview_restore() {
+    PreviewRollback& r = _rollback;
+    r.active = false;
+    if (r.playing) {
+        ui_state.set_playing(r.station, r.location);
+        ui_state.set_paused(r.paused);
+        ui_state.set_wiim_metadata(r.wiim_title, r.wiim_artist);
+    } else {
+        ui_state.set_stopped();
+    }
+    ui_state.set_station_position(r.country, r.index, r.total);
+
+    bool moved = r.marker != ui_state.has_marker() ||
+                 (r.marker && (r.marker_lat != ui_state.get_marker_lat() ||
+                               r.marker_lon != ui_state.get_marker_lon()));
+    if (r.marker) {
+        ui_state.set_marker(r.marker_lat, r.marker_lon);
+    } else {
+        ui_state.clear_marker();
+    }
+    return moved;
+}
+
+/**
+ * Optimistic update for a play still running: the marker and city as soon
+ * as the worker has looked the place up, then the station as if it were
+ * already playing. NET_EVT_PLAYING confirms it (with the same values);
+ * NET_EVT_PLAY_FAILED rolls back to the saved state.
+ */
+static void on_play_preview(const NetEvent& evt) {
+    const StationInfo* station = &evt.station;
+    if (!_rollback.active) preview_save();
+
+    if (!ui_state.has_marker() || ui_state.get_marker_lat() != station->lat ||
+        ui_state.get_marker_lon() != station->lon) {
+        ui_state.set_marker(station->lat, station->lon);
+        display_invalidate(DISPLAY_PART_MARKER);
+    }
+
+    if (station->title[0] == '\0') {
+        char text[32];
+        snprintf(text, sizeof(text), "%s...", station->place);
+        ui_state.set_status_text(text);
+    } else {
+        ui_state.set_playing(station->title, station->place);
+        ui_state.set_station_position(station->country, evt.station_index, evt.station_total);
+    }
+    display_invalidate(DISPLAY_PART_STATUS);
+}
+
+static void on_play_started(const NetEvent& evt) {
+    const StationInfo* station = &evt.station;
+    _rollback.active = false;
+    if (evt.request == _play_request) play_progress_end(true);
+    if (!station->valid) return;
+
+    _now_playing = *station;
+    ui_state.set_playing(station->title, station->place);
+    ui_state.set_station_position(station->country, evt.station_index, evt.station_total);
+    ui_state.set_marker(station->lat, station->lon);
+    save_playback_state(station);
+    if (evt.tag != PLAY_TAG_HISTORY && evt.tag != PLAY_TAG_RESUME) record_to_history(station);
+#if !USE_BUILTIN_TOUCH
+    artwork_want(station->id);
+#endif
+
+    ViewMode mode = ui_state.get_view_mode();
+    bool from_list = (evt.tag == PLAY_TAG_FAVORITE && mode == VIEW_FAVORITES) ||
+                     (evt.tag == PLAY_TAG_HISTORY && mode == VIEW_HISTORY);
+    if (from_list) {
+        // Auto-switch to the station's map slice and show the marker
+        ui_state.set_slice_index(ui_state.slice_index_for_lon(station->lon));
+        ui_state.set_view_mode(VIEW_MAP);
+        display_invalidate(DISPLAY_PART_VIEW);
+    } else {
+        display_invalidate(DISPLAY_PART_MARKER | DISPLAY_PART_STATUS);
+    }
+}
+
+static void on_play_failed(const NetEvent& evt) {
+    bool redraw_map = _rollback.active && preview_restore();
+    if (evt.request == _play_request) play_progress_end(false);
+
+    if (evt.cmd == NET_CMD_PLAY_LOCATION) {
+        ui_state.set_status_text("No stations found");
+    } else if (evt.cmd == NET_CMD_PLAY_NEXT) {
+        ui_state.set_status_text("No more stations");
+    } else {
+        ui_state.set_status_text("Failed to play");
+    }
+
+    // The station may be gone; without a network it may just be unreachable
+    if (evt.tag == PLAY_TAG_RESUME && _network_up) {
+        Serial.println("[Main] Resume failed - clearing saved state");
+        clear_playback_state();
+    }
+
+    // The list views show the status text in full; the map needs a redraw
+    // to take the preview's marker off
+    ViewMode mode = ui_state.get_view_mode();
+    if ((evt.tag == PLAY_TAG_FAVORITE && mode == VIEW_FAVORITES) ||
+        (evt.tag == PLAY_TAG_HISTORY && mode == VIEW_HISTORY)) {
+        display_invalidate(DISPLAY_PART_VIEW);
+    } else if (redraw_map) {
+        display_invalidate(DISPLAY_PART_MAP | DISPLAY_PART_STATUS);
+    } else {
+        display_invalidate(DISPLAY_PART_STATUS);
+    }
+}
+
+static bool warm_list_add(char (*ids)[16], int count, const StationMeta* station) {
+    if (!station || !station->station_id[0]) return false;
+    const char* station_id = station->station_id;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(ids[i], station_id) == 0) return false;
+    }
+    strncpy(ids[count], station_id, sizeof(ids[count]) - 1);
+    ids[count][sizeof(ids[count]) - 1] = '\0';
+    return true;
 }
 
+// Favorites (those in the most tapped cells first), then the newest
+// history entries, then the resumed city or else the most tapped one:
+// resolved in the background so the first play of any of them is a
+// single LinkPlay request
+static void warm_caches() {
+    int order[MAX_FAVORITES];
+    uint16_t heat[MAX_FAVORITES];
+    int favs = min(favorites_count(), MAX_FAVORITES);
+    for (int i = 0; i < favs; i++) {
+        const FavoriteStation* f = favorites_get(i);
+        heat[i] = f ? tap_heat_at(f->lat, f->lon) : 0;
+        int j = i;
+        for (; j > 0 && heat[order[j - 1]] < heat[i]; j--) order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    char ids[NET_WARM_MAX][16];
+    int count = 0;
+    for (int i = 0; i < favs && count < NET_WARM_MAX; i++) {
+        if (warm_list_add(ids, count, favorites_get(order[i]))) count++;
+    }
+    for (int i = 0; i < history_count() && i < WARM_HISTORY && count < NET_WARM_MAX; i++) {
+        if (warm_list_add(ids, count, history_get(i))) count++;
+    }
+    float lat = _resume_lat, lon = _resume_lon;
+    bool city = _resume_city || tap_heat_hottest(1, &lat, &lon) == 1;
+    net_worker_warm(ids, count, city, lat, lon);
+}
+
+static void on_network_up() {
+    _network_up = true;
+    wifi_fast_save();
+    if (strcmp(ui_state.get_status_text(), "Connecting...") == 0) {
+        ui_state.set_status_text("");
+        display_invalidate(DISPLAY_PART_STATUS);
+    }
+
+    // Warm the device table so the Devices page opens with results
+    settings_start_scan();
+    warm_caches();
+}
+
+// Show the open portal's instructions (the WiFi settings page)
+static void show_portal() {
+    _portal_shown = true;
+    ui_state.set_status_text("WiFi setup");
+    ui_state.set_view_mode(VIEW_SETTINGS_WIFI);
+    display_invalidate(DISPLAY_PART_VIEW);
+    display_wake();
+}
+
+// Saved network unreachable: offer the portal for a while. The UI stays
+// live; the button cancels it, and connecting is retried when it closes.
+static void on_network_failed() {
+    wifi_link_portal_start(WIFI_LINK_PORTAL_TIMEOUT_MS);
+    show_portal();
+}
+
+// Portal closed (used, cancelled or timed out): connect with whatever
+// credentials are saved now
+static void on_portal_closed(bool connected) {
+    if (_portal_shown && ui_state.get_view_mode() == VIEW_SETTINGS_WIFI) {
+        ui_state.set_view_mode(VIEW_MAP);
+    }
+    _portal_shown = false;
+    display_invalidate(DISPLAY_PART_VIEW);
+
+    if (!connected && wifi_link_up()) return;   // Opened and closed from settings
+    if (!connected && !wm.getWiFiIsSaved()) {
+        ui_state.set_status_text("No WiFi");
+        display_invalidate(DISPLAY_PART_STATUS);
+        return;
+    }
+    char grp_ips[MAX_GROUP_DEVICES][16];
+    int grp_count = settings_get_group_ips(grp_ips, MAX_GROUP_DEVICES);
+    net_worker_connect(WIFI_CONNECT_TIMEOUT_MS);
+    net_worker_rejoin_group(grp_ips, grp_count);
+    ui_state.set_status_text("Connecting...");
+    display_invalidate(DISPLAY_PART_STATUS);
+}
+
+// A link that was up dropped or came back (wifi_link rejoins it)
+static void on_link_changed(bool up) {
+    if (!up) {
+        ui_state.set_status_text("WiFi lost");
+    } else {
+        wifi_fast_save();
+        if (strcmp(ui_state.get_status_text(), "WiFi lost") == 0) ui_state.set_status_text("");
+    }
+    display_invalidate(DISPLAY_PART_STATUS);
+}
+
+static void on_player_status(const NetEvent& evt) {
+    const LinkPlayStatus& st = evt.status;
+    if (!ui_state.get_is_playing()) return;
+
+    bool changed = strcmp(st.title, ui_state.get_wiim_title()) != 0 ||
+                   strcmp(st.artist, ui_state.get_wiim_artist()) != 0;
+    if (changed) ui_state.set_wiim_metadata(st.title, st.artist);
+
+    // Paused from the WiiM app or remote
+    if (strcmp(st.state, "pause") == 0 && !ui_state.is_paused()) {
+        ui_state.set_paused(true);
+        changed = true;
+    } else if (strcmp(st.state, "play") == 0 && ui_state.is_paused()) {
+        ui_state.set_paused(false);
+        changed = true;
+    }
+
+    // A poll can race the slider; the local value wins for a moment
+    if (st.volume >= 0 && millis() - _last_volume_touch > VOLUME_TOUCH_HOLD_MS &&
+        st.volume != ui_state.get_volume()) {
+        ui_state.set_volume(st.volume);
+        display_invalidate(DISPLAY_PART_VOLUME);
+    }
+
+    if (changed) display_invalidate(DISPLAY_PART_STATUS);
+}
+
+static void net_event_task() {
+    NetEvent evt;
+    while (net_worker_poll_event(&evt)) {
+        switch (evt.type) {
+            case NET_EVT_PLAYING:
+                on_play_started(evt);
+                break;
+            case NET_EVT_PREVIEW:
+                on_play_preview(evt);
+                break;
+            case NET_EVT_PROGRESS:
+                if (evt.request == _play_request) {
+                    ui_state.set_play_progress(evt.value + 1);
+                    ui_state.set_play_stage_ms(evt.value, millis() - _play_requested_ms);
+                    display_invalidate(DISPLAY_PART_PROGRESS);
+                }
+                break;
+            case NET_EVT_PLAY_FAILED:
+                on_play_failed(evt);
+                break;
+            case NET_EVT_STOPPED:
+                _rollback.active = false;
+                _now_playing.valid = false;
+                ui_state.set_stopped();
+                clear_playback_state();
+                display_invalidate(DISPLAY_PART_STATUS);
+                break;
+            case NET_EVT_VOLUME:
+                if (evt.value >= 0) {
+                    ui_state.set_volume(evt.value);
+                    display_invalidate(DISPLAY_PART_VOLUME);
+                }
+                break;
+            case NET_EVT_STATUS:
+                on_player_status(evt);
+                break;
+            case NET_EVT_NETWORK_UP:
+                on_network_up();
+                break;
+            case NET_EVT_NETWORK_FAILED:
+                on_network_failed();
+                break;
+            case NET_EVT_DEVICE_SET:
+                ui_state.set_status_text("Device set!");
+                display_invalidate(DISPLAY_PART_STATUS);
+                break;
+        }
+    }
+}
+
+// ------------------------------------------------------------------
+// Web remote (web_remote.h): the same handlers as touch
+// ------------------------------------------------------------------
+
+static void on_web_command(const BusEvent& cmd) {
+    switch ((WebCommandType)cmd.phase) {
+        case WEB_CMD_PLAY_AT:
+            trace_tap_start(millis());
+            on_map_location(cmd.lat, cmd.lon);
+            break;
+        case WEB_CMD_NEXT:
+            // Unlike the button, also with the menu open on the frame
+            display_wake();
+            ui_state.set_status_text("Loading...");
+            display_invalidate(DISPLAY_PART_STATUS);
+            track_play(net_worker_play_next());
+            break;
+        case WEB_CMD_PAUSE:
+            on_menu_item(MENU_PAUSE_RESUME);
+            break;
+        case WEB_CMD_STOP:
+            on_menu_item(MENU_STOP);
+            break;
+        case WEB_CMD_VOLUME:
+            on_volume_change(constrain(cmd.value, 0, 100));
+            break;
+        case WEB_CMD_FAVORITE:
+            on_favorite_play(cmd.value);
+            break;
+        case WEB_CMD_HISTORY:
+            on_history_play(cmd.value);
+            break;
+        default:
+            break;
+    }
+}
+
+// ------------------------------------------------------------------
+// Event bus (event_bus.h): every input, drained on the loop task
+// ------------------------------------------------------------------
+
+static void on_bus_event(const BusEvent& e) {
+    switch (e.type) {
+        case BUS_MAP_TOUCH:       on_map_touch(e.x, e.y); break;
+        case BUS_MAP_LOCATION:    on_map_location(e.lat, e.lon); break;
+        case BUS_MAP_TAP_PENDING: on_map_tap_pending(e.lat, e.lon); break;
+        case BUS_MAP_DOUBLE_TAP:  on_map_double_tap(e.x, e.y); break;
+        case BUS_MAP_PINCH_ZOOM:  on_map_pinch_zoom(e.value, e.x, e.y); break;
+#if USE_BUILTIN_TOUCH
+        case BUS_MAP_SCRUB:       on_map_scrub((MapScrubPhase)e.phase, e.lat, e.lon); break;
+        case BUS_LIST_SCROLL:
+            on_list_scroll((ListScrollPhase)e.phase, e.y, e.value / 1000.0f);
+            break;
+#endif
+        case BUS_UI_BUTTON:       on_ui_button(e.value); break;
+        case BUS_MENU_TOUCH:      on_menu_touch(e.x, e.y); break;
+        case BUS_SWIPE:           on_swipe(e.value); break;
+        case BUS_VOLUME:          on_volume_change(e.value); break;
+        case BUS_BUTTON_SHORT:    on_slice_cycle(); break;
+        case BUS_BUTTON_LONG:     on_stop_button(); break;
+        case BUS_BUTTON_DOUBLE:   on_next_button(); break;
+        case BUS_MENU_ITEM:       on_menu_item((MenuItemId)e.value); break;
+        case BUS_FAVORITE_PLAY:   on_favorite_play(e.value); break;
+        case BUS_FAVORITE_DELETE: on_favorite_delete(e.value); break;
+        case BUS_HISTORY_PLAY:    on_history_play(e.value); break;
+        case BUS_WEB_COMMAND:     on_web_command(e); break;
+        default: break;
+    }
+}
+
+// ------------------------------------------------------------------
+// WiFi serial commands
+// ------------------------------------------------------------------
+
+static void cmd_reset_wifi(const char*) {
+    Serial.println("[WiFi] Clearing saved credentials and restarting...");
+    persist_flush_all();
+    wm.resetSettings();
+    delay(500);
+    ESP.restart();
+}
 
 // ------------------------------------------------------------------
 // Arduino setup & loop
@@ -664,140 +1199,210 @@ void setup() {
     Serial.begin(115200);
     delay(500);
     Serial.println("\n=== RadioWall Standalone ===");
+    heap_diag_init();
+    json_arena_init();
+    loop_events_init();
+    power_idle_init();
+    energy_stats_init();   // Before WiFi.mode(): counts the radio from its start
+
+    serial_cmd_register("RESET_WIFI", cmd_reset_wifi);
+    places_db_serial_init();
+    https_pool_serial_init();
+    heap_diag_serial_init();
+    bench_init(&ui_state);
+    trace_serial_init();
+    binlog_serial_init();
+    replay_serial_init();
+    net_worker_serial_init();
+    stall_mon_serial_init();
+    data_update_serial_init();
+    web_remote_serial_init();
+    peer_cache_serial_init();
+    mqtt_serial_init();
+    group_monitor_serial_init();
+    wiim_identity_serial_init();
+    power_idle_serial_init();
+    energy_stats_serial_init();
+    haptic_serial_init();
+    json_arena_serial_init();
+    station_stats_serial_init();
+    tap_heat_serial_init();
+    net_fault_serial_init();
+    event_bus_serial_init();
+    perf_hud_serial_init();
+
+    // Woken from Power Off: rejoin the AP from the RTC snapshot before
+    // anything else loads; its station resumes first once the worker runs
+    WiFi.mode(WIFI_STA);
+    wifi_link_init();
+    wifi_link_set_change_callback(on_link_changed);
+    wifi_link_set_portal_callback(on_portal_closed);
+    bool have_creds = wm.getWiFiIsSaved();
+    WakeSnapshot wake;
+    bool woke = wake_snapshot_take(&wake);
+    bool wifi_started = false;
+    if (woke) {
+        if (have_creds) wifi_started = wifi_fast_begin_ap(wake.bssid, wake.channel);
+        linkplay_init(wake.wiim_ip);
+    }
 
-    // Initialize display
+    // Initialize display (backlight fades in while the rest loads)
     display_init();
+    heap_diag_mark("display");
 
-    // Load places database
+    // Patch in a downloaded data update, then load the places database
+    data_update_apply_staged();
     if (!places_db_init()) {
         Serial.println("[Main] WARNING: No places.bin - run 'pio run -t uploadfs'");
     }
+    station_catalog_init();   // Optional, keyed to the places just loaded
+    heap_diag_mark("places");
 
-    // Connect to WiFi
-    // First try saved credentials (STA mode only, no AP).
-    // Only open captive portal if no creds or connection fails.
-    WiFi.mode(WIFI_STA);
-    display_show_connecting();
-    Serial.println("[WiFi] Connecting with saved credentials...");
-
-    wm.setConnectTimeout(20);
-    wm.setEnableConfigPortal(false);  // Don't auto-open portal
-    bool connected = wm.autoConnect("RadioWall");
-
-    if (!connected) {
-        // No saved creds or connection failed — open captive portal
-        Serial.println("[WiFi] No saved creds or failed — opening portal");
-        display_show_wifi_portal(false);
-        wm.setConfigPortalTimeout(0);  // Wait forever until configured
-        wm.setEnableConfigPortal(true);
-        wm.startConfigPortal("RadioWall");
-    }
+    // Settings, favorites, history and playback state (LittleFS is mounted now)
+    state_store_init();
+    heap_diag_mark("state");
 
-    Serial.printf("[WiFi] Connected: %s\n", WiFi.localIP().toString().c_str());
-
-    // Initialize mDNS (for device discovery)
-    if (MDNS.begin("radiowall")) {
-        Serial.println("[mDNS] Started as radiowall.local");
-    }
+    // Start associating with saved credentials (straight to the last AP if
+    // known). The WiFi driver runs on core 0, so it overlaps with everything
+    // below on core 1; the network worker waits for the result. Only open
+    // the captive portal if there are no saved credentials (or, later, if
+    // association fails).
+    if (have_creds && !wifi_started) wifi_fast_begin();
 
     // Initialize settings (load saved WiiM IP and zoom level from LittleFS)
+    wiim_identity_init();
     settings_init();
+    linkplay_transport_init();
+    station_stats_init();
+    tap_heat_init();
     settings_set_device_callback(on_device_selected);
     settings_set_group_callback(on_group_changed);
-    ui_state.set_zoom_level(settings_get_zoom());
+    wiim_identity_set_moved_callback(on_device_moved);
+    set_map_zoom(settings_get_zoom());
+    heap_diag_mark("wifi+settings");
 
     // Initialize LinkPlay client with saved IP (falls back to WIIM_IP from config.h)
     const char* wiim_ip = settings_get_wiim_ip();
+    char grp_ips[MAX_GROUP_DEVICES][16];
+    int grp_count = 0;
+    if (woke && wake.wiim_ip[0] != '\0') wiim_ip = wake.wiim_ip;
     if (wiim_ip[0] != '\0') {
         linkplay_init(wiim_ip);
         Serial.printf("[LinkPlay] WiiM: %s\n", wiim_ip);
-
-        // Rejoin saved multiroom group members (best effort, single attempt)
-        char grp_ips[MAX_GROUP_DEVICES][16];
-        int grp_count = settings_get_group_ips(grp_ips, MAX_GROUP_DEVICES);
-        if (grp_count > 0) {
-            Serial.printf("[Main] Rejoining %d group member(s)...\n", grp_count);
-            for (int i = 0; i < grp_count; i++) {
-                Serial.printf("[Main]   Joining %s\n", grp_ips[i]);
-                linkplay_multiroom_join(grp_ips[i]);
-                delay(500);
-            }
-        }
+        grp_count = settings_get_group_ips(grp_ips, MAX_GROUP_DEVICES);
     } else {
         Serial.println("[LinkPlay] No WiiM IP configured - use Settings to scan");
     }
 
     // Initialize radio client
     radio_client_init();
+    heap_diag_mark("radio");
 
     // Initialize menu
     menu_init();
-    menu_set_item_callback(on_menu_item);
 
-    // Initialize favorites
+    // Initialize favorites (after the station table both lists hold handles into)
+    station_table_init();
     favorites_init();
-    favorites_set_play_callback(on_favorite_play);
-    favorites_set_delete_callback(on_favorite_delete);
 
     // Initialize history
     history_init();
-    history_set_play_callback(on_history_play);
+    heap_diag_mark("ui");
 
     // Initialize buttons (GPIO 0 only - GPIO 21 conflicts with display)
     // Short press: cycle region, Long press: toggle menu, Double-tap: NEXT
     button_init();
-    button_set_band_cycle_callback(on_slice_cycle);
-    button_set_stop_callback(on_stop_button);
-    button_set_next_callback(on_next_button);
 
     // Initialize touch
     touch_init();
     #if USE_BUILTIN_TOUCH
-        builtin_touch_set_map_callback(on_map_touch);
-        builtin_touch_set_ui_button_callback(on_ui_button);
-        builtin_touch_set_menu_callback(on_menu_touch);
-        builtin_touch_set_swipe_callback(on_swipe);
-        builtin_touch_set_volume_change_callback(on_volume_change);
-        builtin_touch_set_map_double_tap_callback(on_map_double_tap);
         builtin_touch_set_ui_state(&ui_state);
     #endif
+    heap_diag_mark("touch");
 
-    // Resume previous playback or stop stale WiiM playback
-    if (!resume_playback()) {
-        // No saved state - stop WiiM in case it's still playing from last session
-        linkplay_stop();
+    if (!have_creds) {
+        // First boot: nothing to associate with until the portal is done.
+        // It stays open until used; closing it starts the connect.
+        Serial.println("[WiFi] No saved creds — opening portal");
+        wifi_link_portal_start(0);
     }
 
-    // Show map (will show playing state if resumed)
-    display_show_map_view(&ui_state);
+    // The metrics server and the web remote (started by the worker)
+    // report the UI snapshot
+    metrics_http_set_ui_state(&ui_state);
+    web_remote_set_ui_state(&ui_state);
+
+    // From here on, network requests run on the worker task. CONNECT goes
+    // first; a tap on the map before it finishes queues behind it.
+    net_worker_start();
+    heap_diag_mark("net");
+    if (have_creds) {
+        net_worker_connect(WIFI_CONNECT_TIMEOUT_MS);
+        ui_state.set_status_text("Connecting...");
+    }
 
-    Serial.printf("[Main] Ready - Region: %s\n", ui_state.get_current_slice().name);
-}
+    // Resume previous playback, or stop stale WiiM playback
+    bool resumed = woke && wake.station.valid ? resume_from_snapshot(wake)
+                                              : resume_playback();
+    if (!resumed) {
+        net_worker_stop();
+    }
 
-// ------------------------------------------------------------------
-// WiFi serial commands
-// ------------------------------------------------------------------
+    // Group members after the audio is going
+    net_worker_rejoin_group(grp_ips, grp_count);
 
-static void wifi_serial_task() {
-    if (!Serial.available()) return;
-    char cmd = Serial.peek();
-    if (cmd != 'R') return;
+    // Show the map (or the now playing scene) now; the network comes up behind it
+    display_show_map_view(&ui_state);
+    if (!have_creds) show_portal();
+    heap_diag_mark("map");
 
-    String line = Serial.readStringUntil('\n');
-    line.trim();
-    if (line == "RESET_WIFI") {
-        Serial.println("[WiFi] Clearing saved credentials and restarting...");
-        wm.resetSettings();
-        delay(500);
-        ESP.restart();
-    }
+    Serial.printf("[Main] Ready - Region: %s\n", ui_state.get_current_slice().name);
 }
 
 void loop() {
+    perf_hud_pass_begin();
+    stall_mon_activity(STALL_LOOP, "touch");
     touch_task();
+    stall_mon_activity(STALL_LOOP, "button");
     button_task();
+    stall_mon_activity(STALL_LOOP, "input");
+    event_bus_drain(on_bus_event);   // Touch, button, web remote and storm taps
+    stall_mon_activity(STALL_LOOP, "display");
     display_loop();
-    wifi_serial_task();
-    places_db_serial_task();
-    linkplay_serial_task();
+    stall_mon_activity(STALL_LOOP, "net_events");
+    net_event_task();
+    stall_mon_activity(STALL_LOOP, "wifi");
+    wifi_link_task();
+    stall_mon_activity(STALL_LOOP, "persist");
+    linkplay_client_task();
+    station_stats_task();
+    wiim_identity_task();
+    idle_refresh_task();
+    tap_heat_task();
+    persist_task();
+    heap_diag_task();
+    if (ui_state.get_view_mode() == VIEW_FAVORITES || ui_state.get_view_mode() == VIEW_HISTORY) {
+        stall_mon_activity(STALL_LOOP, "scroll");
+        scroll_list_loop(display_get_gfx());
+    }
+    if (ui_state.get_view_mode() == VIEW_SETTINGS_DEVICES) {
+        stall_mon_activity(STALL_LOOP, "devices");
+        if (settings_devices_refresh(display_get_gfx())) display_flush();
+    }
+    stall_mon_activity(STALL_LOOP, "bench");
+    bench_task();
+    net_fault_task();
+    stall_mon_activity(STALL_LOOP, "serial");
+    serial_cmd_task();
+    stall_mon_activity(STALL_LOOP, "render");
+    ui_state.publish_snapshot();   // This pass's state, for other tasks
+    stall_mon_activity(STALL_LOOP, "web");
+    web_remote_task();
+    stall_mon_activity(STALL_LOOP, "render");
+    display_render(&ui_state);
+    perf_hud_pass_end();
+    stall_mon_check();
+
+    // Sleep until input, a network event or the next timer
+    loop_events_wait();
 }
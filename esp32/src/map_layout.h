@@ -0,0 +1,48 @@
+/**
+ * Map layout for RadioWall: longitude slices and tile pyramid geometry
+ *
+ * Auto-generated by generate_map_bitmaps.py
+ * Do not edit manually!
+ */
+
+#ifndef MAP_LAYOUT_H
+#define MAP_LAYOUT_H
+
+#include <stdint.h>
+
+#define MAP_LAYOUT_WIDTH  180
+#define MAP_LAYOUT_HEIGHT 580
+
+// Longitude slices, west to east. At zoom z a slice is a
+// (MAP_LAYOUT_WIDTH*z) x (MAP_LAYOUT_HEIGHT*z) equirectangular image
+// from lon_min to lon_min + lon_span and from 90 to -90 latitude.
+#define MAP_SLICE_COUNT 4
+
+struct MapSliceLayout {
+    const char* name;   // "Americas"
+    const char* label;  // "-150° to -30°"
+    int16_t lon_min;    // Western edge (degrees)
+    int16_t lon_span;   // Width (degrees; the last slice runs on past 180)
+};
+
+static constexpr MapSliceLayout MAP_SLICE_LAYOUT[MAP_SLICE_COUNT] = {
+    {"Americas", "-150° to -30°", -150, 120},
+    {"Europe/Africa", "-30° to 60°", -30, 90},
+    {"Asia", "60° to 150°", 60, 90},
+    {"Pacific", "150° to -150°", 150, 60},
+};
+
+// Tile pyramid (tiles.bin, tools/pack_map_tiles.py)
+#define MAP_TILE_ZOOM_MIN 2
+#define MAP_TILE_ZOOM_MAX 5
+#define MAP_TILE_W 90
+#define MAP_TILE_H 145
+#define MAP_TILE_COUNT 1728
+
+// Grid columns and rows of a slice, and the number of its zoom level's
+// first tile, by zoom level (0 below MAP_TILE_ZOOM_MIN)
+static constexpr uint8_t MAP_TILE_COLS[MAP_TILE_ZOOM_MAX + 1] = {0, 0, 4, 6, 8, 10};
+static constexpr uint8_t MAP_TILE_ROWS[MAP_TILE_ZOOM_MAX + 1] = {0, 0, 8, 12, 16, 20};
+static constexpr uint32_t MAP_TILE_FIRST[MAP_TILE_ZOOM_MAX + 1] = {0, 0, 0, 128, 416, 928};
+
+#endif // MAP_LAYOUT_H
@@ -4,6 +4,10 @@
 
 #include "menu.h"
 #include "theme.h"
+#include "chrome.h"
+#include "widgets.h"
+#include "page_cache.h"
+#include "event_bus.h"
 #include "Arduino_GFX_Library.h"
 
 // Layout constants
@@ -35,32 +39,51 @@ static const uint8_t* const _icons[] = {
 
 static const int SPLIT_ROW_INDEX = 5;  // Last item = split row
 
-static MenuItemCallback _item_callback = nullptr;
+// Baked enabled cards (same display order as _items); nullptr without
+// -DCHROME_SPRITES
+static const ChromeSprite* const _baked_cards[MENU_ITEM_COUNT] = {
+    CHROME_SPRITE(MENU_CARD_0), CHROME_SPRITE(MENU_CARD_1), CHROME_SPRITE(MENU_CARD_2),
+    CHROME_SPRITE(MENU_CARD_3), CHROME_SPRITE(MENU_CARD_4), CHROME_SPRITE(MENU_CARD_5),
+};
+
+static WidgetPage _page;
 
 void menu_init() {
     Serial.println("[Menu] Initialized (6 items)");
 }
 
-void menu_set_item_callback(MenuItemCallback cb) {
-    _item_callback = cb;
-}
-
-// Draw a single menu item card
-static void draw_item(Arduino_GFX* gfx, int index) {
-    int y_top = ITEMS_START_Y + index * ITEM_HEIGHT;
-    int card_y = y_top + 4;          // 4px top gap
+// Draw a single menu item card; pressed highlights the tapped zone (the
+// split row's thirds are zones 0-2)
+static void draw_item(Arduino_GFX* gfx, const Widget& w, int pressed) {
+    int index = w.id;
+    int card_y = w.y + 4;            // 4px top gap
     int card_h = ITEM_HEIGHT - 8;    // 8px total vertical gap
 
+    if (pressed == WIDGET_NOT_PRESSED && _items[index].enabled && _baked_cards[index]) {
+        chrome_draw(gfx, *_baked_cards[index], TH_CARD_MARGIN, card_y);
+        return;
+    }
+
     uint16_t text_color = _items[index].enabled ? TH_TEXT : TH_TEXT_DIM;
     uint16_t icon_color = _items[index].enabled ? TH_ACCENT : TH_TEXT_DIM;
-
-    // Card background
-    gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
-                        TH_CORNER_R, TH_CARD);
+    int icon_y = card_y + (card_h - ICON_SIZE) / 2;
 
     if (index == SPLIT_ROW_INDEX) {
         // --- 3-way split: Play/Pause | Stop | Power Off — icons only ---
-        int icon_y = card_y + (card_h - ICON_SIZE) / 2;
+        gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
+                            TH_CORNER_R, TH_CARD);
+
+        // Only the tapped third lights up
+        if (pressed == 0) {
+            gfx->fillRoundRect(TH_CARD_MARGIN, card_y, SPLIT_X1 - TH_CARD_MARGIN,
+                                card_h, TH_CORNER_R, TH_CARD_HI);
+        } else if (pressed == 1) {
+            gfx->fillRoundRect(SPLIT_X1, card_y, SPLIT_X2 - SPLIT_X1,
+                                card_h, TH_CORNER_R, TH_CARD_HI);
+        } else if (pressed == 2) {
+            gfx->fillRoundRect(SPLIT_X2, card_y, TH_CARD_W + TH_CARD_MARGIN - SPLIT_X2,
+                                card_h, TH_CORNER_R, TH_CARD_HI);
+        }
 
         // Zone centers for icon placement
         int cx1 = (TH_CARD_MARGIN + SPLIT_X1) / 2;   // Center of left zone
@@ -70,20 +93,20 @@ static void draw_item(Arduino_GFX* gfx, int index) {
         // Left: Play/Pause icon
         gfx->drawBitmap(cx1 - ICON_SIZE / 2, icon_y, ICON_PLAY_PAUSE, ICON_SIZE, ICON_SIZE, icon_color);
 
-        // First divider
-        gfx->drawFastVLine(SPLIT_X1, card_y + 6, card_h - 12, TH_DIVIDER);
-
         // Middle: Stop icon
         gfx->drawBitmap(cx2 - ICON_SIZE / 2, icon_y, ICON_STOP, ICON_SIZE, ICON_SIZE, icon_color);
 
-        // Second divider
-        gfx->drawFastVLine(SPLIT_X2, card_y + 6, card_h - 12, TH_DIVIDER);
-
         // Right: Power Off icon
         gfx->drawBitmap(cx3 - ICON_SIZE / 2, icon_y, ICON_POWER, ICON_SIZE, ICON_SIZE, TH_DANGER);
+
+        if (pressed == WIDGET_NOT_PRESSED) {
+            gfx->drawFastVLine(SPLIT_X1, card_y + 6, card_h - 12, TH_DIVIDER);
+            gfx->drawFastVLine(SPLIT_X2, card_y + 6, card_h - 12, TH_DIVIDER);
+        }
     } else {
         // --- Normal full-width row ---
-        int icon_y = card_y + (card_h - ICON_SIZE) / 2;
+        gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h, TH_CORNER_R,
+                            pressed == WIDGET_NOT_PRESSED ? TH_CARD : TH_CARD_HI);
         if (index < 5) {
             gfx->drawBitmap(14, icon_y, _icons[index], ICON_SIZE, ICON_SIZE, icon_color);
         }
@@ -97,109 +120,86 @@ static void draw_item(Arduino_GFX* gfx, int index) {
     }
 }
 
+// One full-width slot per item, so the gaps between cards still hit
+static void layout() {
+    widget_page_clear(_page);
+    for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+        int y_top = ITEMS_START_Y + i * ITEM_HEIGHT;
+        if (i == SPLIT_ROW_INDEX) {
+            widget_add(_page, i, 0, y_top, TH_DISPLAY_W, ITEM_HEIGHT, draw_item, SPLIT_X1, SPLIT_X2);
+        } else {
+            widget_add(_page, i, 0, y_top, TH_DISPLAY_W, ITEM_HEIGHT, draw_item);
+        }
+    }
+}
+
 void menu_render(Arduino_GFX* gfx) {
     if (!gfx) return;
 
+    if (_page.count == 0) layout();
+    widget_page_show(_page);
+
+    // The page only changes with the items' enabled flags
+    uint32_t key = PAGE_CACHE_KEY_SEED;
+    for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+        key = page_cache_key(key, &_items[i].enabled, sizeof(_items[i].enabled));
+    }
+    if (page_cache_draw(PAGE_CACHE_MENU, key)) {
+        widget_page_mark_drawn(_page);
+        return;
+    }
+
     // Clear menu area
     gfx->fillRect(0, 0, TH_DISPLAY_W, MENU_AREA_BOTTOM, TH_BG);
 
-    // Title (FreeSansBold, centered)
-    gfx->setFont(&FreeSansBold10pt7b);
-    gfx->setTextSize(1);
-    gfx->setTextColor(TH_ACCENT);
-    gfx->setCursor(56, FONT_SANS_ASCENT + 8);
-    gfx->print("MENU");
-    gfx->setFont((const GFXfont*)nullptr);
-
-    // Divider under title
-    gfx->drawFastHLine(5, TITLE_HEIGHT - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
+    const ChromeSprite* title = CHROME_SPRITE(MENU_TITLE);
+    if (title) {
+        chrome_draw(gfx, *title, 0, 0);
+    } else {
+        // Title (FreeSansBold, centered)
+        gfx->setFont(&FreeSansBold10pt7b);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TH_ACCENT);
+        gfx->setCursor(56, FONT_SANS_ASCENT + 8);
+        gfx->print("MENU");
+        gfx->setFont((const GFXfont*)nullptr);
 
-    // Draw each item
-    for (int i = 0; i < MENU_ITEM_COUNT; i++) {
-        draw_item(gfx, i);
+        // Divider under title
+        gfx->drawFastHLine(5, TITLE_HEIGHT - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
     }
+
+    widget_page_render(gfx, _page);
+    page_cache_store(PAGE_CACHE_MENU, key, 0, MENU_AREA_BOTTOM);
 }
 
 bool menu_handle_touch(int portrait_x, int portrait_y, Arduino_GFX* gfx) {
-    // Ignore touches in the title bar
-    if (portrait_y < ITEMS_START_Y) return false;
-
-    int idx = (portrait_y - ITEMS_START_Y) / ITEM_HEIGHT;
-    if (idx < 0 || idx >= MENU_ITEM_COUNT) return false;
-    if (!_items[idx].enabled) return false;
+    int zone = 0;
+    Widget* w = widget_hit(_page, portrait_x, portrait_y, &zone);
+    if (!w || !_items[w->id].enabled) return false;
 
     // 3-way split row: left = Play/Pause, middle = Stop, right = Power Off
-    MenuItemId action_id = _items[idx].id;
-    if (idx == SPLIT_ROW_INDEX) {
-        if (portrait_x >= SPLIT_X2) {
+    MenuItemId action_id = _items[w->id].id;
+    if (w->id == SPLIT_ROW_INDEX) {
+        if (zone == 2) {
             action_id = MENU_POWER_OFF;
             Serial.println("[Menu] Tapped: Power Off");
-        } else if (portrait_x >= SPLIT_X1) {
+        } else if (zone == 1) {
             action_id = MENU_STOP;
             Serial.println("[Menu] Tapped: Stop");
         } else {
             Serial.println("[Menu] Tapped: Play/Pause");
         }
     } else {
-        Serial.printf("[Menu] Tapped: %s\n", _items[idx].label);
+        Serial.printf("[Menu] Tapped: %s\n", _items[w->id].label);
     }
 
-    // Brief highlight feedback
+    // Brief highlight feedback, then only this card is drawn again
     if (gfx) {
-        int y_top = ITEMS_START_Y + idx * ITEM_HEIGHT;
-        int card_y = y_top + 4;
-        int card_h = ITEM_HEIGHT - 8;
-
-        if (idx == SPLIT_ROW_INDEX) {
-            // Highlight only the tapped third
-            int icon_y = card_y + (card_h - ICON_SIZE) / 2;
-            int cx1 = (TH_CARD_MARGIN + SPLIT_X1) / 2;
-            int cx2 = (SPLIT_X1 + SPLIT_X2) / 2;
-            int cx3 = (SPLIT_X2 + TH_CARD_MARGIN + TH_CARD_W) / 2;
-
-            if (portrait_x < SPLIT_X1) {
-                gfx->fillRoundRect(TH_CARD_MARGIN, card_y, SPLIT_X1 - TH_CARD_MARGIN,
-                                    card_h, TH_CORNER_R, TH_CARD_HI);
-                gfx->drawBitmap(cx1 - ICON_SIZE / 2, icon_y, ICON_PLAY_PAUSE, ICON_SIZE, ICON_SIZE, TH_ACCENT);
-            } else if (portrait_x < SPLIT_X2) {
-                gfx->fillRoundRect(SPLIT_X1, card_y, SPLIT_X2 - SPLIT_X1,
-                                    card_h, TH_CORNER_R, TH_CARD_HI);
-                gfx->drawBitmap(cx2 - ICON_SIZE / 2, icon_y, ICON_STOP, ICON_SIZE, ICON_SIZE, TH_ACCENT);
-            } else {
-                gfx->fillRoundRect(SPLIT_X2, card_y, TH_CARD_W + TH_CARD_MARGIN - SPLIT_X2,
-                                    card_h, TH_CORNER_R, TH_CARD_HI);
-                gfx->drawBitmap(cx3 - ICON_SIZE / 2, icon_y, ICON_POWER, ICON_SIZE, ICON_SIZE, TH_DANGER);
-            }
-            delay(80);
-            draw_item(gfx, idx);
-        } else {
-            // Normal full-width highlight
-            gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
-                                TH_CORNER_R, TH_CARD_HI);
-
-            int icon_y = card_y + (card_h - ICON_SIZE) / 2;
-            if (idx < 5) {
-                gfx->drawBitmap(14, icon_y, _icons[idx], ICON_SIZE, ICON_SIZE, TH_ACCENT);
-            }
-
-            gfx->setFont(&FreeSansBold10pt7b);
-            gfx->setTextSize(1);
-            gfx->setTextColor(TH_TEXT);
-            gfx->setCursor(38, card_y + card_h / 2 + FONT_SANS_ASCENT / 2 - 1);
-            gfx->print(_items[idx].label);
-            gfx->setFont((const GFXfont*)nullptr);
-
-            delay(80);
-
-            gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
-                                TH_CORNER_R, TH_BG);
-            draw_item(gfx, idx);
-        }
+        widget_press(gfx, w, zone, 80);
+        widget_page_render_dirty(gfx, _page);
     }
 
-    if (_item_callback) {
-        _item_callback(action_id);
-    }
+    event_bus_post_value(BUS_MENU_ITEM, action_id);
 
     return true;
 }
@@ -33,16 +33,13 @@ struct MenuItem {
     bool enabled;
 };
 
-// Callback for when a menu item is tapped
-typedef void (*MenuItemCallback)(MenuItemId item_id);
-
 void menu_init();
-void menu_set_item_callback(MenuItemCallback cb);
 
 // Render the full menu into the map area (y 0-579)
 void menu_render(Arduino_GFX* gfx);
 
-// Handle a touch in the menu area. Returns true if an item was hit.
+// Handle a touch in the menu area. Returns true if an item was hit; the
+// item is posted to the event bus (BUS_MENU_ITEM, event_bus.h).
 bool menu_handle_touch(int portrait_x, int portrait_y, Arduino_GFX* gfx);
 
 #endif // MENU_H
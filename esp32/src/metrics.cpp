@@ -0,0 +1,74 @@
+/**
+ * Runtime performance counters implementation for RadioWall.
+ *
+ * Counters are relaxed atomics: the touch reader, the net worker and the
+ * loop task all write them, and a reader only needs each one whole. A
+ * timing has a 64-bit total (2^32 microseconds of redraws is only a few
+ * weeks of uptime), so its three fields are updated under a spinlock.
+ */
+
+#include "metrics.h"
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+
+static std::atomic<uint32_t> _counters[METRIC_COUNTER_COUNT];
+
+static portMUX_TYPE _timing_mux = portMUX_INITIALIZER_UNLOCKED;
+static MetricTimingStats _timings[METRIC_TIMING_COUNT];
+
+static const char* const COUNTER_NAMES[METRIC_COUNTER_COUNT] = {
+    "cache.station.hit", "cache.station.miss", "cache.station.catalog",
+    "cache.stream.hit", "cache.stream.miss",
+    "touch.dropped",
+    "cache.dns.hit", "cache.dns.miss",
+    "cache.peer.hit", "cache.peer.miss",
+    "cache.assist.hit", "cache.assist.miss",
+    "cache.tap.hit", "cache.tap.miss",
+};
+
+static const char* const TIMING_NAMES[METRIC_TIMING_COUNT] = {
+    "render.map", "render.menu", "render.volume", "render.favorites",
+    "render.history", "render.settings", "render.status_bar",
+};
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void metrics_inc(MetricCounter counter) {
+    if (counter >= METRIC_COUNTER_COUNT) return;
+    _counters[counter].fetch_add(1, std::memory_order_relaxed);
+}
+
+void metrics_time(MetricTiming timing, uint32_t us) {
+    if (timing >= METRIC_TIMING_COUNT) return;
+    portENTER_CRITICAL(&_timing_mux);
+    MetricTimingStats& t = _timings[timing];
+    t.count++;
+    t.total_us += us;
+    if (us > t.max_us) t.max_us = us;
+    portEXIT_CRITICAL(&_timing_mux);
+}
+
+uint32_t metrics_get_counter(MetricCounter counter) {
+    if (counter >= METRIC_COUNTER_COUNT) return 0;
+    return _counters[counter].load(std::memory_order_relaxed);
+}
+
+void metrics_get_timing(MetricTiming timing, MetricTimingStats* out) {
+    if (timing >= METRIC_TIMING_COUNT) {
+        *out = MetricTimingStats{0, 0, 0};
+        return;
+    }
+    portENTER_CRITICAL(&_timing_mux);
+    *out = _timings[timing];
+    portEXIT_CRITICAL(&_timing_mux);
+}
+
+const char* metrics_counter_name(MetricCounter counter) {
+    return counter < METRIC_COUNTER_COUNT ? COUNTER_NAMES[counter] : "?";
+}
+
+const char* metrics_timing_name(MetricTiming timing) {
+    return timing < METRIC_TIMING_COUNT ? TIMING_NAMES[timing] : "?";
+}
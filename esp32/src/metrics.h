@@ -0,0 +1,70 @@
+/**
+ * Runtime performance counters for RadioWall.
+ *
+ * Cheap counters and timing aggregates (count, total, max) that any task
+ * may bump: cache hits and misses, dropped touch samples and render time
+ * per view. Other figures stay with their owners: per-host HTTPS stats in
+ * https_pool, map tile cache counts in world_map (it also builds for the
+ * host), heap figures in heap_diag, iteration times in stall_mon.
+ * metrics_http.cpp gathers all of them into one JSON document.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+enum MetricCounter : uint8_t {
+    METRIC_STATION_CACHE_HIT,   // Tap served from the station list cache
+    METRIC_STATION_CACHE_MISS,
+    METRIC_STATION_CATALOG_HIT, // Missed list read from stations.bin
+    METRIC_STREAM_CACHE_HIT,    // Resolved stream URL found
+    METRIC_STREAM_CACHE_MISS,
+    METRIC_TOUCH_DROPPED,       // Touch sample that did not fit the ring
+    METRIC_DNS_CACHE_HIT,       // Host address from dns_cache, no lookup
+    METRIC_DNS_CACHE_MISS,      // Blocking lookup before a connect
+    METRIC_PEER_CACHE_HIT,      // List or stream URL from another frame (peer_cache.h)
+    METRIC_PEER_CACHE_MISS,     // Peers asked, none had it
+    METRIC_ASSIST_HIT,          // List or stream URL from the assist server (mqtt_client.h)
+    METRIC_ASSIST_MISS,         // Server asked: miss or no reply
+    METRIC_TAP_MEMO_HIT,        // Tap cell's nearest places remembered (radio_client)
+    METRIC_TAP_MEMO_MISS,
+    METRIC_COUNTER_COUNT
+};
+
+enum MetricTiming : uint8_t {
+    METRIC_RENDER_MAP,          // Full view redraw including the flush
+    METRIC_RENDER_MENU,
+    METRIC_RENDER_VOLUME,
+    METRIC_RENDER_FAVORITES,
+    METRIC_RENDER_HISTORY,
+    METRIC_RENDER_SETTINGS,     // Settings, WiFi and device pages
+    METRIC_RENDER_STATUS_BAR,   // Map view status bar update
+    METRIC_TIMING_COUNT
+};
+
+struct MetricTimingStats {
+    uint32_t count;
+    uint64_t total_us;
+    uint32_t max_us;
+};
+
+void metrics_inc(MetricCounter counter);
+void metrics_time(MetricTiming timing, uint32_t us);
+
+uint32_t metrics_get_counter(MetricCounter counter);
+void metrics_get_timing(MetricTiming timing, MetricTimingStats* out);
+
+// Dotted names for reports ("cache.station.hit", "render.map", ...)
+const char* metrics_counter_name(MetricCounter counter);
+const char* metrics_timing_name(MetricTiming timing);
+
+// Time the enclosing scope
+struct MetricTimer {
+    explicit MetricTimer(MetricTiming timing) : _timing(timing), _start(micros()) {}
+    ~MetricTimer() { metrics_time(_timing, micros() - _start); }
+    MetricTiming _timing;
+    uint32_t _start;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,289 @@
+/**
+ * Metrics HTTP endpoint implementation for RadioWall.
+ *
+ * The Arduino WebServer is synchronous, so it gets its own small task on
+ * core 0 next to the network worker; a slow scraper only delays the next
+ * scrape. Every figure is read through its module's thread-safe getter;
+ * the UI through its published snapshot (ui_state.h).
+ */
+
+#include "metrics_http.h"
+#include "metrics.h"
+#include "https_pool.h"
+#include "heap_diag.h"
+#include "world_map.h"
+#include "stall_mon.h"
+#include "radio_client.h"
+#include "ui_state.h"
+#include "energy_stats.h"
+#include "bench.h"
+#include <WebServer.h>
+#include <ESPmDNS.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const uint32_t SERVER_STACK = 6144;
+static const UBaseType_t SERVER_PRIORITY = 1;
+static const BaseType_t SERVER_CORE = 0;
+static const unsigned long SERVER_POLL_MS = 20;
+// Room for 6 pool hosts with hedge counters, the UI, 32 tasks and the bench check
+static const size_t METRICS_JSON_SIZE = 9216;
+static const int MAX_HOSTS = 8;
+
+static WebServer* _server = nullptr;
+static const UIState* _ui_state = nullptr;
+
+// ------------------------------------------------------------------
+// Document
+// ------------------------------------------------------------------
+
+static float avg_ms(uint64_t total_us, uint32_t count) {
+    return count ? total_us / 1000.0f / count : 0.0f;
+}
+
+static void add_hosts(JsonObject root) {
+    JsonArray hosts = root.createNestedArray("hosts");
+    HttpsHostStats s;
+    for (int i = 0; i < MAX_HOSTS && https_pool_get_stats(i, &s); i++) {
+        JsonObject h = hosts.createNestedObject();
+        h["host"] = s.host;   // char[]: copied into the document
+        h["requests"] = s.requests;
+        h["request_avg_ms"] = s.requests ? s.request_ms / s.requests : 0;
+        h["request_max_ms"] = s.max_request_ms;
+        h["handshakes"] = s.handshakes;
+        h["handshake_avg_ms"] = s.handshakes ? s.handshake_ms / s.handshakes : 0;
+        h["reused"] = s.reused;
+        h["stale"] = s.stale;
+        h["hedged"] = s.hedged;
+        h["hedge_wins"] = s.hedge_wins;
+        h["hedge_ms"] = s.hedge_ms;
+        h["tls_admit_waits"] = s.admit_waits;
+        h["tls_admit_refused"] = s.admit_refused;
+    }
+}
+
+static void add_heap(JsonObject root) {
+    HeapDiagStats hs;
+    heap_diag_get_stats(&hs);
+    JsonObject heap = root.createNestedObject("heap");
+    heap["internal_free"] = hs.internal_free;
+    heap["internal_min_free"] = hs.internal_min_free;
+    heap["internal_largest"] = hs.internal_largest;
+    heap["internal_min_largest"] = hs.internal_min_largest;
+    heap["psram_free"] = hs.psram_free;
+    heap["psram_total"] = hs.psram_total;
+    heap["failed_allocs"] = hs.failed_allocs;
+}
+
+static void add_counters(JsonObject root) {
+    JsonObject counters = root.createNestedObject("counters");
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        MetricCounter c = (MetricCounter)i;
+        counters[metrics_counter_name(c)] = metrics_get_counter(c);
+    }
+    uint32_t hits, misses;
+    world_map_tile_cache_stats(&hits, &misses);
+    counters["cache.tile.hit"] = hits;
+    counters["cache.tile.miss"] = misses;
+}
+
+static void add_timings(JsonObject root) {
+    JsonObject timings = root.createNestedObject("timings");
+    for (int i = 0; i < METRIC_TIMING_COUNT; i++) {
+        MetricTiming t = (MetricTiming)i;
+        MetricTimingStats st;
+        metrics_get_timing(t, &st);
+        JsonObject o = timings.createNestedObject(metrics_timing_name(t));
+        o["count"] = st.count;
+        o["avg_ms"] = avg_ms(st.total_us, st.count);
+        o["max_ms"] = st.max_us / 1000.0f;
+    }
+}
+
+static void add_stalls(JsonObject root) {
+    JsonObject stalls = root.createNestedObject("stalls");
+    for (int i = 0; i < STALL_TASK_COUNT; i++) {
+        StallTask t = (StallTask)i;
+        StallTaskStats st;
+        stall_mon_get_task_stats(t, &st);
+        JsonObject o = stalls.createNestedObject(stall_mon_task_name(t));
+        o["count"] = st.count;
+        o["max_ms"] = st.max_ms;
+        JsonArray buckets = o.createNestedArray("buckets_log2_ms");
+        for (int b = 0; b < STALL_BUCKETS; b++) buckets.add(st.buckets[b]);
+    }
+
+    StallRecord worst[STALL_WORST_KEPT];
+    int n = stall_mon_get_worst(worst, STALL_WORST_KEPT);
+    JsonArray list = stalls.createNestedArray("worst");
+    for (int i = 0; i < n; i++) {
+        JsonObject w = list.createNestedObject();
+        w["task"] = stall_mon_task_name(worst[i].task);
+        w["activity"] = worst[i].activity;
+        if (worst[i].has_span) w["span"] = trace_phase_name(worst[i].span);
+        w["ms"] = worst[i].ms;
+        w["at_s"] = worst[i].at_s;
+    }
+}
+
+// On-times, charger readings and CPU time per task (energy_stats.h)
+static void add_energy(JsonObject root) {
+    JsonObject energy = root.createNestedObject("energy");
+    energy["display_lit_s"] = energy_stats_on_ms(ENERGY_DISPLAY_LIT) / 1000;
+    energy["display_dim_s"] = energy_stats_on_ms(ENERGY_DISPLAY_DIM) / 1000;
+    energy["wifi_on_s"] = energy_stats_on_ms(ENERGY_WIFI_ON) / 1000;
+    energy["wifi_connected_s"] = energy_stats_on_ms(ENERGY_WIFI_CONNECTED) / 1000;
+
+    EnergyPmu pmu;
+    energy_stats_get_pmu(&pmu);
+    if (pmu.valid) {
+        JsonObject p = energy.createNestedObject("pmu");
+        p["battery_mv"] = pmu.battery_mv;
+        p["system_mv"] = pmu.system_mv;
+        p["vbus_mv"] = pmu.vbus_mv;
+        p["charge_ma"] = pmu.charge_ma;
+        p["charged_mah"] = pmu.charged_mah;
+        p["samples"] = pmu.samples;
+        p["at_s"] = pmu.at_s;
+    }
+
+    static EnergyTask tasks[ENERGY_MAX_TASKS];   // Server task only
+    int n = energy_stats_get_tasks(tasks, ENERGY_MAX_TASKS);
+    if (n < 0) return;
+    JsonArray cpu = energy.createNestedArray("cpu");
+    for (int i = 0; i < n; i++) {
+        JsonObject t = cpu.createNestedObject();
+        t["task"] = tasks[i].name;   // char[]: copied
+        t["runtime_us"] = tasks[i].runtime_us;
+        t["percent"] = tasks[i].percent;
+    }
+}
+
+// The last benchmark regression check (bench.h)
+static void add_bench(JsonObject root) {
+    BenchReport rep;
+    if (!bench_get_report(&rep)) return;
+    JsonObject bench = root.createNestedObject("bench");
+    bench["build"] = rep.build;   // char[]: copied
+    if (rep.baseline[0]) bench["baseline"] = rep.baseline;
+    bench["automatic"] = rep.automatic;
+    bench["at_s"] = rep.at_s;
+    bench["compared"] = rep.compared;
+    bench["regression_count"] = rep.regression_count;
+    bench["threshold_pct"] = BENCH_REGRESSION_PCT;
+    JsonArray list = bench.createNestedArray("regressions");
+    for (int i = 0; i < min<int>(rep.regression_count, BENCH_REGRESSIONS_KEPT); i++) {
+        JsonObject r = list.createNestedObject();
+        r["case"] = rep.regressions[i].name;
+        r["med_us"] = rep.regressions[i].med_us;
+        r["base_us"] = rep.regressions[i].base_us;
+    }
+}
+
+// What the frame shows, as of the loop's last pass
+static void add_ui(JsonObject root) {
+    if (!_ui_state) return;
+    UISnapshot snap;
+    _ui_state->read_snapshot(&snap);
+
+    JsonObject ui = root.createNestedObject("ui");
+    ui["view"] = (int)snap.view_mode;
+    ui["slice"] = snap.slice_index;
+    ui["zoom"] = snap.zoom_level;
+    ui["volume"] = snap.volume;
+    ui["playing"] = snap.is_playing;
+    ui["paused"] = snap.paused;
+    if (snap.is_playing) {
+        ui["station"] = snap.station_name;
+        ui["location"] = snap.location;
+        ui["country"] = snap.country;
+        ui["station_index"] = snap.station_index;
+        ui["station_total"] = snap.station_total;
+        if (snap.wiim_title[0]) ui["track"] = snap.wiim_title;
+        if (snap.wiim_artist[0]) ui["artist"] = snap.wiim_artist;
+    }
+    if (snap.has_marker) {
+        ui["marker_lat"] = snap.marker_lat;
+        ui["marker_lon"] = snap.marker_lon;
+    }
+}
+
+static void handle_metrics() {
+    DynamicJsonDocument doc(METRICS_JSON_SIZE);
+    JsonObject root = doc.to<JsonObject>();
+    root["uptime_s"] = millis() / 1000;
+    add_hosts(root);
+    add_heap(root);
+    add_counters(root);
+    add_timings(root);
+    add_stalls(root);
+    add_ui(root);
+    add_energy(root);
+    add_bench(root);
+    if (doc.overflowed()) {
+        Serial.println("[Metrics] JSON document overflowed");
+    }
+
+    String out;
+    serializeJson(doc, out);
+    _server->send(200, "application/json", out);
+}
+
+// The station queue the WiiM was handed (radio_client.h)
+static void handle_queue() {
+    static char m3u[RADIO_QUEUE_M3U_MAX];
+    if (!radio_queue_m3u(m3u, sizeof(m3u))) {
+        _server->send(404, "text/plain", "No queue\n");
+        return;
+    }
+    _server->send(200, "audio/x-mpegurl", m3u);
+}
+
+static void handle_not_found() {
+    _server->send(404, "text/plain", "Not found\n");
+}
+
+// ------------------------------------------------------------------
+// Server task
+// ------------------------------------------------------------------
+
+static void server_task(void*) {
+    _server->begin();
+    Serial.printf("[Metrics] Serving http://radiowall.local:%u/metrics\n",
+                  METRICS_HTTP_PORT);
+    for (;;) {
+        _server->handleClient();
+        vTaskDelay(pdMS_TO_TICKS(SERVER_POLL_MS));
+    }
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void metrics_http_set_ui_state(const UIState* state) {
+    _ui_state = state;
+}
+
+bool metrics_http_running() {
+    return _server != nullptr;
+}
+
+void metrics_http_start() {
+    if (_server) return;
+
+    _server = new WebServer(METRICS_HTTP_PORT);
+    _server->on("/metrics", HTTP_GET, handle_metrics);
+    _server->on("/queue.m3u", HTTP_GET, handle_queue);
+    _server->onNotFound(handle_not_found);
+
+    if (xTaskCreatePinnedToCore(server_task, "metrics_http", SERVER_STACK, nullptr,
+                                SERVER_PRIORITY, nullptr, SERVER_CORE) != pdPASS) {
+        Serial.println("[Metrics] Failed to start server task");
+        delete _server;
+        _server = nullptr;
+        return;
+    }
+    MDNS.addService("http", "tcp", METRICS_HTTP_PORT);
+}
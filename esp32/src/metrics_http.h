@@ -0,0 +1,39 @@
+/**
+ * Metrics HTTP endpoint for RadioWall.
+ *
+ * GET http://radiowall.local:8080/metrics returns one JSON document so
+ * installed frames can be scraped over WiFi: per-host request counts and
+ * latencies, TLS handshakes vs. reused connections, cache hit counts,
+ * heap figures, render time per view, dropped touch samples and the
+ * loop/worker stall histograms, plus what the UI shows (view, station,
+ * volume), where the energy goes (energy_stats.h) and the last benchmark
+ * regression check (bench.h). Counters run from boot; a scraper diffs
+ * successive reads.
+ *
+ * The same server hands the WiiM its station queue (/queue.m3u, see
+ * radio_client.h).
+ *
+ * Port 80 belongs to the web remote (web_remote.h), and to the
+ * WiFiManager portal while settings has it open.
+ */
+
+#ifndef METRICS_HTTP_H
+#define METRICS_HTTP_H
+
+#include <Arduino.h>
+
+class UIState;
+
+static const uint16_t METRICS_HTTP_PORT = 8080;
+
+// Start the server task and advertise it over mDNS (once WiFi and mDNS
+// are up; later calls do nothing)
+void metrics_http_start();
+
+// True once the server task runs
+bool metrics_http_running();
+
+// UI state to report (read through its snapshot, from the server task)
+void metrics_http_set_ui_state(const UIState* state);
+
+#endif // METRICS_HTTP_H
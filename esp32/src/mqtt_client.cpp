@@ -1,15 +1,87 @@
 /**
  * MQTT client for RadioWall ESP32.
  *
- * Handles WiFi connection, MQTT pub/sub for touch events and now-playing updates.
+ * Everything that touches the socket runs on the network worker, as a
+ * state machine stepped from its idle pass (mqtt_network_task()):
+ *
+ *   OFF --WiFi up--> BACKOFF --attempt due--> connect --ok--> CONNECTED
+ *                       ^------- failed, or connection lost -------'
+ *
+ * A connect attempt is bounded: CONNECT_TIMEOUT_MS for the TCP
+ * socket (opened here, PubSubClient reuses it), then the 1 s socket
+ * timeout for the CONNACK. Each failure doubles the delay to the next
+ * attempt, 5 s up to 60 s. WiFi belongs to the worker's connect command;
+ * nothing here waits for it or calls delay().
+ *
+ * No other task calls PubSubClient. Touches and commands (server mode)
+ * are serialized on the caller's side into a fixed-size outbox the worker
+ * drains in one batch per pass. Inbound server-mode messages are parsed on
+ * the worker with one reused StaticJsonDocument into fixed records, queued
+ * in a bounded inbox, and handed to the callbacks on the loop task by
+ * mqtt_loop(). Both queues drop (and count) what does not fit.
+ *
+ * An assist lookup publishes its request and runs the client loop until
+ * the reply with its sequence number arrives; the callback decodes the
+ * binary reply in place into the waiting caller's buffers.
  */
 
 #include "mqtt_client.h"
 #include "config.h"
+#include "stream_cache.h"
+#include "metrics.h"
+#include "loop_events.h"
+#include "net_worker.h"
+#include "serial_cmd.h"
 
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+#ifndef MQTT_TOPIC_ASSIST
+#define MQTT_TOPIC_ASSIST "radiowall/assist"
+#endif
+
+static const unsigned long CONNECT_TIMEOUT_MS = 250;   // LAN broker
+static const uint16_t SOCKET_TIMEOUT_S = 1;            // CONNACK and partial packets
+static const unsigned long RETRY_MIN_MS = 5000;
+static const unsigned long RETRY_MAX_MS = 60000;
+static const int OUTBOX_LEN = 8;
+static const int INBOX_LEN = 4;
+static const size_t OUT_PAYLOAD_MAX = 96;
+
+enum MqttState : uint8_t {
+    MQTT_OFF,         // Disabled or no WiFi
+    MQTT_BACKOFF,     // Waiting for the next connect attempt
+    MQTT_CONNECTED,
+};
+
+static const char* const STATE_NAMES[] = {"off", "backoff", "connected"};
+
+enum OutTopic : uint8_t {
+    OUT_TOUCH,
+    OUT_COMMAND,
+};
+
+struct OutMessage {
+    OutTopic topic;
+    uint8_t len;
+    char payload[OUT_PAYLOAD_MAX];
+};
+
+enum InType : uint8_t {
+    IN_NOWPLAYING,    // a = station, b = location, c = country
+    IN_STATUS,        // a = state, b = msg
+};
+
+struct InMessage {
+    InType type;
+    char a[64];
+    char b[48];
+    char c[32];
+};
 
 static WiFiClient _wifi_client;
 static PubSubClient _mqtt(MQTT_SERVER, MQTT_PORT, _wifi_client);
@@ -17,149 +89,330 @@ static PubSubClient _mqtt(MQTT_SERVER, MQTT_PORT, _wifi_client);
 static NowPlayingCallback _nowplaying_cb = nullptr;
 static StatusCallback _status_cb = nullptr;
 
-static unsigned long _last_reconnect_attempt = 0;
-static const unsigned long RECONNECT_INTERVAL_MS = 5000;
+// Worker-owned state (_state is read by other tasks)
+static volatile MqttState _state = MQTT_OFF;
+static bool _server_mode = false;          // mqtt_init() called
+static bool _configured = false;
+static unsigned long _retry_at = 0;
+static unsigned long _retry_ms = RETRY_MIN_MS;
+static StaticJsonDocument<512> _in_doc;    // Reused for every inbound message
+
+static QueueHandle_t _outbox = nullptr;
+static QueueHandle_t _inbox = nullptr;
+
+// Counters (diagnostics only, so not locked)
+static uint32_t _connects = 0;
+static uint32_t _failures = 0;
+static uint32_t _sent = 0;
+static uint32_t _out_dropped = 0;
+static uint32_t _received = 0;
+static uint32_t _in_dropped = 0;
+
+#ifdef SERVER_ASSIST
+static const bool ASSIST_ENABLED = true;
+#else
+static const bool ASSIST_ENABLED = false;
+#endif
+
+static void set_state(MqttState state) {
+    if (_state == state) return;
+    _state = state;
+    Serial.printf("[MQTT] %s\n", STATE_NAMES[state]);
+}
 
 // ------------------------------------------------------------------
-// WiFi
+// Assist replies
 // ------------------------------------------------------------------
 
-static void wifi_connect() {
-    if (WiFi.status() == WL_CONNECTED) return;
+#ifdef SERVER_ASSIST
 
-#if defined(WIFI_SSID) && defined(WIFI_PASSWORD)
-    Serial.printf("[WiFi] Connecting to %s", WIFI_SSID);
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+static const unsigned long ASSIST_STATIONS_TIMEOUT_MS = 2500;  // Server may fetch upstream first
+static const unsigned long ASSIST_URL_TIMEOUT_MS = 1500;
+static const unsigned long ASSIST_BACKOFF_MS = 60000;          // After a lookup timed out
+static const uint16_t ASSIST_BUFFER_SIZE = ASSIST_MAX_PAYLOAD + sizeof(AssistReplyHeader) + 128;
 
-    unsigned long start = millis();
-    while (WiFi.status() != WL_CONNECTED) {
-        if (millis() - start > WIFI_CONNECT_TIMEOUT) {
-            Serial.println("\n[WiFi] Connection timeout!");
-            return;
-        }
-        delay(500);
-        Serial.print(".");
+static char _assist_req_topic[64] = "";
+static char _assist_reply_topic[64] = "";
+static unsigned long _assist_skip_until = 0;   // millis(); 0 = ask
+static uint8_t _assist_seq = 0;
+
+static uint32_t _assist_lookups = 0;
+static uint32_t _assist_hits = 0;
+static uint32_t _assist_timeouts = 0;
+
+// The lookup waiting for its reply
+struct AssistWait {
+    uint8_t type;
+    uint8_t seq;
+    bool done;               // Reply arrived (hit or miss)
+    bool hit;
+    StationRecord* records;  // ASSIST_STATIONS
+    int cap;
+    int count;
+    int total;
+    String* url;             // ASSIST_URL
+    uint32_t age_s;
+};
+
+static AssistWait* _wait = nullptr;
+
+// Unpack a reply into the waiting lookup; late replies to an abandoned
+// one are ignored, a malformed one counts as a miss
+static void assist_reply(const uint8_t* payload, unsigned int length) {
+    AssistReplyHeader hdr;
+    if (!_wait || length < sizeof(hdr)) return;
+    memcpy(&hdr, payload, sizeof(hdr));
+    if (memcmp(hdr.magic, ASSIST_MAGIC, sizeof(ASSIST_MAGIC)) != 0 ||
+        hdr.type != _wait->type || hdr.seq != _wait->seq) {
+        return;
     }
 
-    Serial.printf("\n[WiFi] Connected, IP: %s\n", WiFi.localIP().toString().c_str());
-#else
-    Serial.println("[WiFi] No hardcoded credentials - use WiFiManager");
-#endif
+    AssistWait* w = _wait;
+    w->done = true;
+    w->age_s = hdr.age_s;
+    if (hdr.status != 1) return;
+
+    const uint8_t* p = payload + sizeof(hdr);
+    const uint8_t* end = payload + length;
+    if (w->type == ASSIST_URL) {
+        if (hdr.count == 0 || hdr.count >= STREAM_URL_MAX || p + hdr.count > end) return;
+        char url[STREAM_URL_MAX];
+        memcpy(url, p, hdr.count);
+        url[hdr.count] = '\0';
+        *w->url = url;
+        w->hit = true;
+        return;
+    }
+
+    int n = 0;
+    for (int i = 0; i < hdr.count && n < w->cap; i++) {
+        StationRecord& rec = w->records[n];
+        if (p >= end) return;
+        uint8_t id_len = *p++;
+        if (id_len == 0 || id_len >= sizeof(rec.id) || p + id_len >= end) return;
+        memcpy(rec.id, p, id_len);
+        rec.id[id_len] = '\0';
+        p += id_len;
+        uint8_t title_len = *p++;
+        if (title_len >= sizeof(rec.title) || p + title_len > end) return;
+        memcpy(rec.title, p, title_len);
+        rec.title[title_len] = '\0';
+        p += title_len;
+        n++;
+    }
+    w->count = n;
+    w->total = max((int)hdr.total, n);
+    w->hit = true;
 }
 
+#endif // SERVER_ASSIST
+
 // ------------------------------------------------------------------
-// MQTT callback
+// MQTT callback (network worker, inside _mqtt.loop())
 // ------------------------------------------------------------------
 
+static void copy_field(char* dst, size_t size, const char* src) {
+    strncpy(dst, src, size - 1);
+    dst[size - 1] = '\0';
+}
+
 static void mqtt_callback(char* topic, byte* payload, unsigned int length) {
-    // Parse JSON payload
-    StaticJsonDocument<512> doc;
-    DeserializationError err = deserializeJson(doc, payload, length);
+#ifdef SERVER_ASSIST
+    if (strcmp(topic, _assist_reply_topic) == 0) {
+        assist_reply(payload, length);
+        return;
+    }
+#endif
+    if (!_inbox) return;
+
+    DeserializationError err = deserializeJson(_in_doc, payload, length);
     if (err) {
         Serial.printf("[MQTT] JSON parse error: %s\n", err.c_str());
         return;
     }
 
+    InMessage msg = {};
     if (strcmp(topic, MQTT_TOPIC_NOWPLAYING) == 0) {
-        const char* station = doc["station"] | "Unknown";
-        const char* location = doc["location"] | "Unknown";
-        const char* country = doc["country"] | "";
-        Serial.printf("[MQTT] Now playing: %s (%s, %s)\n", station, location, country);
-        if (_nowplaying_cb) {
-            _nowplaying_cb(station, location, country);
-        }
+        msg.type = IN_NOWPLAYING;
+        copy_field(msg.a, sizeof(msg.a), _in_doc["station"] | "Unknown");
+        copy_field(msg.b, sizeof(msg.b), _in_doc["location"] | "Unknown");
+        copy_field(msg.c, sizeof(msg.c), _in_doc["country"] | "");
     } else if (strcmp(topic, MQTT_TOPIC_STATUS) == 0) {
-        const char* state = doc["state"] | "unknown";
-        const char* msg = doc["msg"] | "";
-        Serial.printf("[MQTT] Status: %s %s\n", state, msg);
-        if (_status_cb) {
-            _status_cb(state, msg);
-        }
+        msg.type = IN_STATUS;
+        copy_field(msg.a, sizeof(msg.a), _in_doc["state"] | "unknown");
+        copy_field(msg.b, sizeof(msg.b), _in_doc["msg"] | "");
+    } else {
+        return;
     }
+
+    _received++;
+    if (xQueueSend(_inbox, &msg, 0) != pdTRUE) {
+        _in_dropped++;   // The loop is behind; the next update supersedes it
+        return;
+    }
+    loop_events_notify();
 }
 
 // ------------------------------------------------------------------
-// MQTT connect/reconnect
+// Connection state machine (network worker)
 // ------------------------------------------------------------------
 
-static bool mqtt_reconnect() {
-    Serial.println("[MQTT] Connecting...");
+static void configure() {
+    if (_configured) return;
+    _configured = true;
+    _mqtt.setCallback(mqtt_callback);
+    _mqtt.setSocketTimeout(SOCKET_TIMEOUT_S);
+#ifdef SERVER_ASSIST
+    snprintf(_assist_req_topic, sizeof(_assist_req_topic), "%s/%s/req",
+             MQTT_TOPIC_ASSIST, MQTT_CLIENT_ID);
+    snprintf(_assist_reply_topic, sizeof(_assist_reply_topic), "%s/%s/reply",
+             MQTT_TOPIC_ASSIST, MQTT_CLIENT_ID);
+    _mqtt.setBufferSize(ASSIST_BUFFER_SIZE);
+#else
+    _mqtt.setBufferSize(1024);
+#endif
+}
 
+// One bounded connect attempt: the socket with a short timeout first, so
+// a broker that is down costs CONNECT_TIMEOUT_MS, not the default seconds
+static bool attempt_connect() {
+    configure();
+    if (!_wifi_client.connect(MQTT_SERVER, MQTT_PORT, CONNECT_TIMEOUT_MS)) return false;
 #if defined(MQTT_USER) && defined(MQTT_PASSWORD)
     bool ok = _mqtt.connect(MQTT_CLIENT_ID, MQTT_USER, MQTT_PASSWORD);
 #else
     bool ok = _mqtt.connect(MQTT_CLIENT_ID);
 #endif
+    if (!ok) {
+        Serial.printf("[MQTT] Connect refused, rc=%d\n", _mqtt.state());
+        _wifi_client.stop();
+        return false;
+    }
 
-    if (ok) {
-        Serial.println("[MQTT] Connected");
+    if (_server_mode) {
         _mqtt.subscribe(MQTT_TOPIC_NOWPLAYING);
         _mqtt.subscribe(MQTT_TOPIC_STATUS);
-    } else {
-        Serial.printf("[MQTT] Failed, rc=%d\n", _mqtt.state());
     }
-    return ok;
+#ifdef SERVER_ASSIST
+    _mqtt.subscribe(_assist_reply_topic);
+    _assist_skip_until = 0;
+#endif
+    return true;
+}
+
+// Publish everything queued since the last pass, back to back
+static void flush_outbox() {
+    OutMessage msg;
+    while (_outbox && xQueueReceive(_outbox, &msg, 0) == pdTRUE) {
+        const char* topic = msg.topic == OUT_TOUCH ? MQTT_TOPIC_TOUCH : MQTT_TOPIC_COMMAND;
+        if (!_mqtt.publish(topic, (const uint8_t*)msg.payload, msg.len)) {
+            _out_dropped++;
+            continue;
+        }
+        _sent++;
+    }
+}
+
+void mqtt_network_task() {
+    if (!_server_mode && !ASSIST_ENABLED) return;
+    if (WiFi.status() != WL_CONNECTED) {
+        if (_state == MQTT_CONNECTED) _wifi_client.stop();
+        set_state(MQTT_OFF);
+        return;
+    }
+
+    switch (_state) {
+        case MQTT_OFF:
+            _retry_at = millis();
+            _retry_ms = RETRY_MIN_MS;
+            set_state(MQTT_BACKOFF);
+            break;
+
+        case MQTT_BACKOFF:
+            if ((long)(millis() - _retry_at) < 0) break;
+            if (attempt_connect()) {
+                _connects++;
+                _retry_ms = RETRY_MIN_MS;
+                set_state(MQTT_CONNECTED);
+            } else {
+                _failures++;
+                _retry_at = millis() + _retry_ms;
+                _retry_ms = min(_retry_ms * 2, RETRY_MAX_MS);
+            }
+            break;
+
+        case MQTT_CONNECTED:
+            if (!_mqtt.connected()) {
+                Serial.printf("[MQTT] Connection lost, rc=%d\n", _mqtt.state());
+                _retry_at = millis() + _retry_ms;
+                set_state(MQTT_BACKOFF);
+                break;
+            }
+            flush_outbox();
+            _mqtt.loop();
+            break;
+    }
 }
 
 // ------------------------------------------------------------------
-// Public API
+// Server mode (loop task)
 // ------------------------------------------------------------------
 
 void mqtt_init() {
-    wifi_connect();
-    _mqtt.setCallback(mqtt_callback);
-    _mqtt.setBufferSize(1024);
-    mqtt_reconnect();
+    if (_server_mode) return;
+    _outbox = xQueueCreate(OUTBOX_LEN, sizeof(OutMessage));
+    _inbox = xQueueCreate(INBOX_LEN, sizeof(InMessage));
+    _server_mode = _outbox && _inbox;
+    if (!_server_mode) Serial.println("[MQTT] No memory for the message queues");
 }
 
 void mqtt_loop() {
-    // Ensure WiFi is connected
-    if (WiFi.status() != WL_CONNECTED) {
-        wifi_connect();
-    }
-
-    // Ensure MQTT is connected
-    if (!_mqtt.connected()) {
-        unsigned long now = millis();
-        if (now - _last_reconnect_attempt > RECONNECT_INTERVAL_MS) {
-            _last_reconnect_attempt = now;
-            mqtt_reconnect();
+    InMessage msg;
+    while (_inbox && xQueueReceive(_inbox, &msg, 0) == pdTRUE) {
+        if (msg.type == IN_NOWPLAYING) {
+            Serial.printf("[MQTT] Now playing: %s (%s, %s)\n", msg.a, msg.b, msg.c);
+            if (_nowplaying_cb) _nowplaying_cb(msg.a, msg.b, msg.c);
+        } else {
+            Serial.printf("[MQTT] Status: %s %s\n", msg.a, msg.b);
+            if (_status_cb) _status_cb(msg.a, msg.b);
         }
-        return;
     }
-
-    _mqtt.loop();
 }
 
 bool mqtt_is_connected() {
-    return _mqtt.connected();
+    return _state == MQTT_CONNECTED;
 }
 
-void mqtt_publish_touch(int x, int y) {
-    if (!_mqtt.connected()) return;
+// Queue a message for the worker's next pass (dropped while disconnected,
+// as before: a touch from a minute ago is no use to the server)
+static void post(OutTopic topic, JsonDocument& doc) {
+    if (!_outbox || _state != MQTT_CONNECTED) return;
+    OutMessage msg;
+    msg.topic = topic;
+    msg.len = serializeJson(doc, msg.payload, sizeof(msg.payload));
+    if (xQueueSend(_outbox, &msg, 0) != pdTRUE) {
+        _out_dropped++;
+        return;
+    }
+    net_worker_wake();
+}
 
-    StaticJsonDocument<128> doc;
+void mqtt_publish_touch(int x, int y) {
+    static StaticJsonDocument<96> doc;   // Loop task only
+    doc.clear();
     doc["x"] = x;
     doc["y"] = y;
     doc["ts"] = millis();
-
-    char buf[128];
-    serializeJson(doc, buf, sizeof(buf));
-    _mqtt.publish(MQTT_TOPIC_TOUCH, buf);
-    Serial.printf("[MQTT] Published touch: (%d, %d)\n", x, y);
+    post(OUT_TOUCH, doc);
+    Serial.printf("[MQTT] Queued touch: (%d, %d)\n", x, y);
 }
 
 void mqtt_publish_command(const char* cmd) {
-    if (!_mqtt.connected()) return;
-
-    StaticJsonDocument<64> doc;
+    static StaticJsonDocument<64> doc;   // Loop task only
+    doc.clear();
     doc["cmd"] = cmd;
-
-    char buf[64];
-    serializeJson(doc, buf, sizeof(buf));
-    _mqtt.publish(MQTT_TOPIC_COMMAND, buf);
-    Serial.printf("[MQTT] Published command: %s\n", cmd);
+    post(OUT_COMMAND, doc);
+    Serial.printf("[MQTT] Queued command: %s\n", cmd);
 }
 
 void mqtt_set_nowplaying_callback(NowPlayingCallback cb) {
@@ -169,3 +422,119 @@ void mqtt_set_nowplaying_callback(NowPlayingCallback cb) {
 void mqtt_set_status_callback(StatusCallback cb) {
     _status_cb = cb;
 }
+
+// ------------------------------------------------------------------
+// Server-assisted mode (network worker)
+// ------------------------------------------------------------------
+
+#ifdef SERVER_ASSIST
+
+bool mqtt_assist_ready() {
+    if (_state != MQTT_CONNECTED) return false;
+    return !_assist_skip_until || (long)(millis() - _assist_skip_until) >= 0;
+}
+
+// Publish a request and service the connection until its reply or the
+// timeout. A timeout means the server is gone or stuck: skip it for a while.
+static bool assist_exchange(AssistWait* w, const char* key, unsigned long timeout_ms) {
+    if (!mqtt_assist_ready()) return false;
+
+    AssistRequest req = {};
+    memcpy(req.magic, ASSIST_MAGIC, sizeof(ASSIST_MAGIC));
+    req.type = w->type;
+    req.seq = w->seq = ++_assist_seq;
+    strncpy(req.key, key, sizeof(req.key) - 1);
+    _assist_lookups++;
+    if (!_mqtt.publish(_assist_req_topic, (const uint8_t*)&req, sizeof(req))) return false;
+
+    _wait = w;
+    unsigned long start = millis();
+    while (!w->done && _mqtt.connected() && millis() - start < timeout_ms) {
+        _mqtt.loop();
+        if (!w->done) vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    _wait = nullptr;
+
+    if (!w->done) {
+        _assist_timeouts++;
+        _assist_skip_until = (millis() + ASSIST_BACKOFF_MS) | 1;
+        Serial.printf("[Assist] No reply in %lu ms, standalone for a minute\n", timeout_ms);
+        metrics_inc(METRIC_ASSIST_MISS);
+        return false;
+    }
+    if (w->hit) _assist_hits++;
+    metrics_inc(w->hit ? METRIC_ASSIST_HIT : METRIC_ASSIST_MISS);
+    return w->hit;
+}
+
+bool mqtt_assist_get_stations(const char* place_id, StationRecord* out, int cap,
+                              int* count, int* total, uint32_t* age_ms) {
+    AssistWait w = {};
+    w.type = ASSIST_STATIONS;
+    w.records = out;
+    w.cap = cap;
+    unsigned long start = millis();
+    if (!assist_exchange(&w, place_id, ASSIST_STATIONS_TIMEOUT_MS)) return false;
+
+    *count = w.count;
+    *total = w.total;
+    *age_ms = w.age_s * 1000;
+    Serial.printf("[Assist] %d/%d stations from the server (%lu ms)\n",
+                  w.count, w.total, millis() - start);
+    return true;
+}
+
+bool mqtt_assist_get_url(const char* station_id, String* url) {
+    AssistWait w = {};
+    w.type = ASSIST_URL;
+    w.url = url;
+    if (!assist_exchange(&w, station_id, ASSIST_URL_TIMEOUT_MS)) return false;
+    Serial.println("[Assist] Stream URL from the server");
+    return true;
+}
+
+#else
+
+bool mqtt_assist_ready() {
+    return false;
+}
+
+bool mqtt_assist_get_stations(const char*, StationRecord*, int, int*, int*, uint32_t*) {
+    return false;
+}
+
+bool mqtt_assist_get_url(const char*, String*) {
+    return false;
+}
+
+#endif // SERVER_ASSIST
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+// MQTT - Connection state, queues and assist lookup counts
+static void cmd_mqtt(const char*) {
+    if (!_server_mode && !ASSIST_ENABLED) {
+        Serial.println("[MQTT] Not in use (server mode off, SERVER_ASSIST not set)");
+        return;
+    }
+    Serial.printf("[MQTT] Broker %s:%d %s, %lu connect(s), %lu failed attempt(s)\n",
+                  MQTT_SERVER, MQTT_PORT, STATE_NAMES[_state], (unsigned long)_connects,
+                  (unsigned long)_failures);
+    if (_server_mode) {
+        Serial.printf("[MQTT] Sent %lu (%lu dropped), received %lu (%lu dropped)\n",
+                      (unsigned long)_sent, (unsigned long)_out_dropped,
+                      (unsigned long)_received, (unsigned long)_in_dropped);
+    }
+#ifdef SERVER_ASSIST
+    Serial.printf("[Assist] %lu lookup(s), %lu hit(s), %lu timeout(s)%s\n",
+                  (unsigned long)_assist_lookups, (unsigned long)_assist_hits,
+                  (unsigned long)_assist_timeouts,
+                  _state == MQTT_CONNECTED && !mqtt_assist_ready() ? ", server not answering" : "");
+#endif
+}
+
+void mqtt_serial_init() {
+    serial_cmd_register("MQTT", cmd_mqtt);
+}
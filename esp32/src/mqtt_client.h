@@ -1,7 +1,40 @@
+/**
+ * MQTT client for RadioWall.
+ *
+ * Two uses, both optional:
+ *
+ * Server mode (legacy): touches go to the Python server in server/, which
+ * plays them on a UPnP speaker and reports back (mqtt_init/mqtt_loop).
+ * Publishes only queue the message; it is sent from the network worker.
+ *
+ * Server-assisted mode (SERVER_ASSIST in config.h): the frame runs
+ * standalone, but a LAN server (server/assist.py) keeps station list and
+ * stream redirect caches for it. radio_client asks it after the peer
+ * cache and before Radio.garden; the server answers from its cache or
+ * fetches upstream itself. While the broker or server is unreachable
+ * every lookup returns false at once, so the frame carries on alone.
+ *
+ * Either way the network worker owns the connection: mqtt_network_task()
+ * steps a non-blocking connect/backoff state machine from its idle pass,
+ * and no other task touches the socket (see mqtt_client.cpp).
+ *
+ * Assist wire format, little-endian (server/assist.py mirrors it):
+ *
+ *   request  radiowall/assist/<MQTT_CLIENT_ID>/req    AssistRequest
+ *   reply    radiowall/assist/<MQTT_CLIENT_ID>/reply  AssistReplyHeader +
+ *     stations: count x (u8 id_len, id, u8 title_len, title), UTF-8,
+ *               id < 16 and title < 64 bytes
+ *     url:      count bytes, no terminator
+ *
+ * Replies are capped at ASSIST_MAX_PAYLOAD; a longer list is cut (total >
+ * count) and kept partial, so the prefetcher fetches it in full.
+ */
+
 #ifndef MQTT_CLIENT_H
 #define MQTT_CLIENT_H
 
 #include <Arduino.h>
+#include "station_catalog.h"
 
 // Callback for now-playing updates from server
 typedef void (*NowPlayingCallback)(const char* station, const char* location, const char* country);
@@ -9,12 +42,76 @@ typedef void (*NowPlayingCallback)(const char* station, const char* location, co
 // Callback for status updates from server
 typedef void (*StatusCallback)(const char* state, const char* msg);
 
+// Enable server mode: the worker connects and subscribes to now-playing
+// and status. Returns at once; nothing here waits for WiFi or the broker.
 void mqtt_init();
+
+// Hand queued server messages to the callbacks (loop task)
 void mqtt_loop();
+
 bool mqtt_is_connected();
+
+// Queue for the worker (dropped while disconnected or if the queue is full)
 void mqtt_publish_touch(int x, int y);
 void mqtt_publish_command(const char* cmd);
 void mqtt_set_nowplaying_callback(NowPlayingCallback cb);
 void mqtt_set_status_callback(StatusCallback cb);
 
+// ------------------------------------------------------------------
+// Server-assisted mode
+// ------------------------------------------------------------------
+
+static const size_t ASSIST_MAX_PAYLOAD = 3584;   // Reply bytes after the header
+static const char ASSIST_MAGIC[4] = {'R', 'W', 'A', '1'};
+
+enum AssistType : uint8_t {
+    ASSIST_STATIONS = 1,     // key = Radio.garden place ID
+    ASSIST_URL = 2,          // key = station ID
+};
+
+struct AssistRequest {
+    char magic[4];           // ASSIST_MAGIC
+    uint8_t type;            // AssistType
+    uint8_t seq;             // Echoed in the reply
+    uint16_t reserved;
+    char key[16];
+};
+
+struct AssistReplyHeader {
+    char magic[4];
+    uint8_t type;
+    uint8_t seq;
+    uint8_t status;          // 1 = hit, 0 = miss (the device fetches itself)
+    uint8_t reserved;
+    uint16_t count;          // Records or URL bytes that follow
+    uint16_t total;          // Stations the server has for the place
+    uint32_t age_s;          // Since the server fetched it
+};
+
+static_assert(sizeof(AssistRequest) == 24, "AssistRequest is the wire format");
+static_assert(sizeof(AssistReplyHeader) == 16, "AssistReplyHeader is the wire format");
+
+// True while the assist server can be asked
+bool mqtt_assist_ready();
+
+// Ask the server for a place's station list (network worker). On a hit,
+// fills out (up to cap), count, the server's total and the list's age.
+bool mqtt_assist_get_stations(const char* place_id, StationRecord* out, int cap,
+                              int* count, int* total, uint32_t* age_ms);
+
+// Ask the server for a station's resolved stream URL (network worker)
+bool mqtt_assist_get_url(const char* station_id, String* url);
+
+// ------------------------------------------------------------------
+// Network worker
+// ------------------------------------------------------------------
+
+// Idle pass: connect (bounded, backing off while the broker is down), send
+// the queued messages and service the connection. Does nothing in
+// standalone mode without SERVER_ASSIST, or without WiFi.
+void mqtt_network_task();
+
+// Register the MQTT serial command (state, queue drops, assist lookups)
+void mqtt_serial_init();
+
 #endif // MQTT_CLIENT_H
@@ -0,0 +1,329 @@
+/**
+ * Network fault injection and tap storm implementation for RadioWall.
+ *
+ * The settings, the request generator and the fault counts are shared by
+ * every task that sends requests, under one spinlock; the waits happen
+ * outside it. The storm itself runs on the loop task. Requests and storm
+ * places draw from separate generators, so the taps of a storm are the
+ * same places whatever the faults do to the requests.
+ */
+
+#include "net_fault.h"
+#include "serial_cmd.h"
+#include "loop_events.h"
+#include "places_db.h"
+#include "trace.h"
+#include "event_bus.h"
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <algorithm>
+
+static const uint32_t STORM_POLL_MS = 50;      // Checking for a tap's audio
+static const int STORM_PLACE_TRIES = 8;        // Draws for a place with stations
+
+enum FaultKind : uint8_t {
+    FAULT_PASS,
+    FAULT_DROP,
+    FAULT_TIMEOUT,
+};
+
+struct FaultConfig {
+    uint32_t latency_ms;
+    uint32_t jitter_ms;     // Up to this much more, uniform
+    uint8_t drop_pct;
+    uint8_t timeout_pct;
+    uint32_t seed;
+};
+
+struct FaultCounts {
+    uint32_t requests;
+    uint32_t dropped;
+    uint32_t timed_out;
+    uint64_t delay_ms;      // Latency added, over all requests
+};
+
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool _active = false;
+static FaultConfig _cfg = {0, 0, 0, 0, 1};
+static FaultCounts _counts = {};
+static uint32_t _rng = 1;
+
+// xorshift32: never 0 from a non-zero state
+static uint32_t next_random(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+bool net_fault_admit(const char* host, unsigned long timeout_ms) {
+    if (!_active) return true;
+
+    portENTER_CRITICAL(&_mux);
+    uint32_t wait = _cfg.latency_ms;
+    if (_cfg.jitter_ms) wait += next_random(&_rng) % (_cfg.jitter_ms + 1);
+    uint32_t roll = next_random(&_rng) % 100;
+    FaultKind kind = FAULT_PASS;
+    if (roll < _cfg.drop_pct) kind = FAULT_DROP;
+    else if (roll < (uint32_t)_cfg.drop_pct + _cfg.timeout_pct) kind = FAULT_TIMEOUT;
+    if (kind == FAULT_TIMEOUT) wait = timeout_ms;
+    _counts.requests++;
+    if (kind == FAULT_DROP) _counts.dropped++;
+    if (kind == FAULT_TIMEOUT) _counts.timed_out++;
+    else _counts.delay_ms += wait;
+    portEXIT_CRITICAL(&_mux);
+
+    if (wait) delay(wait);
+    if (kind == FAULT_PASS) return true;
+    Serial.printf("[Fault] %s: %s\n", host, kind == FAULT_DROP ? "dropped" : "timed out");
+    return false;
+}
+
+static FaultCounts counts_now() {
+    portENTER_CRITICAL(&_mux);
+    FaultCounts c = _counts;
+    portEXIT_CRITICAL(&_mux);
+    return c;
+}
+
+// ------------------------------------------------------------------
+// Tap storm
+// ------------------------------------------------------------------
+
+struct Storm {
+    bool active;
+    int taps;
+    int issued;
+    uint32_t interval_ms;
+    uint32_t next_ms;           // millis() of the next tap
+    uint32_t last_tap_ms;
+    uint16_t trace_tap;         // Tracer's number for the latest storm tap
+    bool tap_done;              // ... its audio has started
+    int lost;                   // Replaced before their audio started
+    uint32_t rng;
+    FaultCounts counts_at_start;
+    size_t min_internal;
+    size_t min_largest;
+    size_t min_psram;
+    int played;
+    uint32_t audio_ms[NET_FAULT_STORM_MAX];
+};
+
+static Storm _storm = {};
+
+static void sample_heap() {
+    _storm.min_internal = min(_storm.min_internal, heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    _storm.min_largest = min(_storm.min_largest,
+                             heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    if (psramFound()) {
+        _storm.min_psram = min(_storm.min_psram, heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    }
+}
+
+// A place to tap, preferring ones with stations
+static bool storm_place(float* lat, float* lon) {
+    uint32_t count = places_db_count();
+    if (count == 0) return false;
+    Place p;
+    PlaceHandle h = PLACE_NONE;
+    for (int i = 0; i < STORM_PLACE_TRIES; i++) {
+        h = next_random(&_storm.rng) % count;
+        if (places_db_has_stations(h)) break;
+    }
+    if (!places_db_get(h, &p)) return false;
+    *lat = p.lat_x100 / 100.0f;
+    *lon = p.lon_x100 / 100.0f;
+    return true;
+}
+
+static void storm_tap() {
+    float lat, lon;
+    if (!storm_place(&lat, &lon)) return;
+    uint32_t totals[TRACE_PHASE_COUNT];
+    uint32_t audio_us;
+    trace_tap_start(millis());
+    _storm.trace_tap = trace_last_tap(totals, &audio_us);
+    _storm.tap_done = false;
+    _storm.last_tap_ms = millis();
+    Serial.printf("[Storm] Tap %d/%d at (%.2f, %.2f)\n", _storm.issued + 1, _storm.taps, lat, lon);
+    event_bus_post_location(BUS_MAP_LOCATION, lat, lon);
+}
+
+// Record the latest tap's touch-to-audio time once the tracer has it
+static void check_audio() {
+    if (_storm.tap_done || _storm.issued == 0) return;
+    uint32_t totals[TRACE_PHASE_COUNT];
+    uint32_t audio_us = 0;
+    if (trace_last_tap(totals, &audio_us) != _storm.trace_tap || !audio_us) return;
+    _storm.tap_done = true;
+    _storm.audio_ms[_storm.played++] = audio_us / 1000;
+}
+
+// Nearest-rank percentile of sorted samples
+static uint32_t percentile(const uint32_t* sorted, int n, int pct) {
+    int rank = (pct * n + 99) / 100;
+    return sorted[max(rank, 1) - 1];
+}
+
+static void storm_report() {
+    FaultCounts c = counts_now();
+    uint32_t requests = c.requests - _storm.counts_at_start.requests;
+    uint32_t dropped = c.dropped - _storm.counts_at_start.dropped;
+    uint32_t timed_out = c.timed_out - _storm.counts_at_start.timed_out;
+    uint64_t delay_ms = c.delay_ms - _storm.counts_at_start.delay_ms;
+
+    Serial.printf("[Storm] %d taps: %d played, %d lost\n", _storm.issued, _storm.played,
+                  _storm.lost);
+    int n = _storm.played;
+    if (n > 0) {
+        std::sort(_storm.audio_ms, _storm.audio_ms + n);
+        Serial.printf("[Storm] Tap to audio: p50 %lu ms, p95 %lu ms, p99 %lu ms, max %lu ms\n",
+                      (unsigned long)percentile(_storm.audio_ms, n, 50),
+                      (unsigned long)percentile(_storm.audio_ms, n, 95),
+                      (unsigned long)percentile(_storm.audio_ms, n, 99),
+                      (unsigned long)_storm.audio_ms[n - 1]);
+    }
+    if (_active) {
+        Serial.printf("[Storm] Faults: %lu requests, %lu dropped, %lu timed out, "
+                      "%lu ms mean added latency\n",
+                      (unsigned long)requests, (unsigned long)dropped, (unsigned long)timed_out,
+                      (unsigned long)(requests > timed_out ? delay_ms / (requests - timed_out) : 0));
+    }
+    Serial.printf("[Storm] Headroom: internal %u KB free at least (largest block %u KB), "
+                  "PSRAM %u KB\n",
+                  (unsigned)(_storm.min_internal / 1024), (unsigned)(_storm.min_largest / 1024),
+                  (unsigned)(_storm.min_psram / 1024));
+}
+
+static void storm_end() {
+    if (!_storm.tap_done) _storm.lost++;
+    _storm.active = false;
+    storm_report();
+}
+
+void net_fault_task() {
+    if (!_storm.active) return;
+    sample_heap();
+    check_audio();
+
+    uint32_t now = millis();
+    if (_storm.issued < _storm.taps) {
+        int32_t due = (int32_t)(_storm.next_ms - now);
+        if (due <= 0) {
+            if (_storm.issued > 0 && !_storm.tap_done) _storm.lost++;
+            storm_tap();
+            _storm.issued++;
+            _storm.next_ms += _storm.interval_ms;
+            due = _storm.interval_ms;
+        }
+        loop_events_due_in(min((uint32_t)due, STORM_POLL_MS));
+        return;
+    }
+    if (_storm.tap_done || now - _storm.last_tap_ms >= STORM_SETTLE_MS) {
+        storm_end();
+        return;
+    }
+    loop_events_due_in(STORM_POLL_MS);
+}
+
+// ------------------------------------------------------------------
+// Serial commands
+// ------------------------------------------------------------------
+
+static void print_faults() {
+    FaultCounts c = counts_now();
+    if (!_active) {
+        Serial.println("[Fault] Off");
+    } else {
+        Serial.printf("[Fault] Latency %lu ms + up to %lu ms, drop %u%%, timeout %u%%, seed %lu\n",
+                      (unsigned long)_cfg.latency_ms, (unsigned long)_cfg.jitter_ms,
+                      _cfg.drop_pct, _cfg.timeout_pct, (unsigned long)_cfg.seed);
+    }
+    Serial.printf("[Fault] %lu requests seen, %lu dropped, %lu timed out\n",
+                  (unsigned long)c.requests, (unsigned long)c.dropped, (unsigned long)c.timed_out);
+}
+
+static void cmd_fault(const char* args) {
+    if (strcmp(args, "off") == 0) {
+        _active = false;
+        Serial.println("[Fault] Off");
+        return;
+    }
+
+    FaultConfig cfg = {0, 0, 0, 0, 1};
+    char buf[96];
+    strncpy(buf, args, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    char* save = nullptr;
+    for (char* tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(nullptr, ",", &save)) {
+        char* eq = strchr(tok, '=');
+        if (!eq) {
+            Serial.printf("[Fault] Expected key=value, got \"%s\"\n", tok);
+            return;
+        }
+        *eq = '\0';
+        unsigned long v = strtoul(eq + 1, nullptr, 10);
+        if (strcmp(tok, "lat") == 0) cfg.latency_ms = v;
+        else if (strcmp(tok, "jit") == 0) cfg.jitter_ms = v;
+        else if (strcmp(tok, "drop") == 0) cfg.drop_pct = min(v, 100UL);
+        else if (strcmp(tok, "tmo") == 0) cfg.timeout_pct = min(v, 100UL);
+        else if (strcmp(tok, "seed") == 0) cfg.seed = v ? v : 1;
+        else {
+            Serial.printf("[Fault] Unknown key \"%s\" (lat, jit, drop, tmo, seed)\n", tok);
+            return;
+        }
+    }
+    if (!args[0]) {
+        print_faults();
+        return;
+    }
+    cfg.timeout_pct = min<int>(cfg.timeout_pct, 100 - cfg.drop_pct);
+
+    portENTER_CRITICAL(&_mux);
+    _cfg = cfg;
+    _rng = cfg.seed;
+    _counts = {};
+    portEXIT_CRITICAL(&_mux);
+    _active = true;
+    print_faults();
+}
+
+static void cmd_storm(const char* args) {
+    if (strcmp(args, "stop") == 0) {
+        if (_storm.active) storm_end();
+        else Serial.println("[Storm] Not running");
+        return;
+    }
+    int taps = 0;
+    unsigned long interval_ms = 0;
+    if (sscanf(args, "%d,%lu", &taps, &interval_ms) != 2 || taps < 1 || interval_ms < 1) {
+        Serial.println("[Storm] Usage: STORM:n,interval_ms");
+        return;
+    }
+    if (!places_db_loaded()) {
+        Serial.println("[Storm] No places loaded");
+        return;
+    }
+
+    _storm = {};
+    _storm.active = true;
+    _storm.taps = min(taps, NET_FAULT_STORM_MAX);
+    _storm.interval_ms = interval_ms;
+    _storm.next_ms = millis();
+    _storm.tap_done = true;
+    _storm.rng = _cfg.seed;
+    _storm.counts_at_start = counts_now();
+    _storm.min_internal = SIZE_MAX;
+    _storm.min_largest = SIZE_MAX;
+    _storm.min_psram = psramFound() ? SIZE_MAX : 0;
+    Serial.printf("[Storm] %d taps, %lu ms apart%s\n", _storm.taps, interval_ms,
+                  _active ? ", faults on" : "");
+    loop_events_due_in(0);
+}
+
+void net_fault_serial_init() {
+    serial_cmd_register("FAULT", cmd_fault);
+    serial_cmd_register("FAULT:", cmd_fault);
+    serial_cmd_register("STORM:", cmd_storm);
+}
@@ -0,0 +1,48 @@
+/**
+ * Network fault injection and tap storms for RadioWall.
+ *
+ * A test mode for how the frame copes with lossy WiFi and slow upstreams.
+ * While faults are on, every request the HTTPS pool (https_pool.h) sends,
+ * TLS or plain, hedged or not, first waits a set latency plus a random
+ * jitter, and a set share of requests is dropped (fails at once, as a
+ * reset connection would) or times out (fails after its full timeout).
+ * The draws come from a seeded generator, so a run can be repeated.
+ *
+ * A tap storm plays n taps, interval ms apart, on places drawn from
+ * places.bin with the same generator, posted to the event bus as a map
+ * tap (BUS_MAP_LOCATION, event_bus.h) so they take the same path. Each
+ * tap's touch-to-audio time comes from the tracer (trace.h); a tap
+ * replaced by the next before its audio started counts as lost. At the
+ * end (after the last tap has played or STORM_SETTLE_MS) it reports
+ * p50 / p95 / p99 tap-to-audio, the faults injected, and the lowest
+ * internal heap, largest internal block and PSRAM seen during the storm.
+ *
+ * Serial:
+ *   FAULT                          current settings and counts
+ *   FAULT:off
+ *   FAULT:lat=300,jit=200,drop=5,tmo=2,seed=1   (ms, ms, %, %)
+ *   STORM:n,interval_ms            e.g. STORM:30,4000
+ *   STORM:stop
+ *
+ * Off by default; with faults off the pool's check is one load.
+ */
+
+#ifndef NET_FAULT_H
+#define NET_FAULT_H
+
+#include <Arduino.h>
+
+static const int NET_FAULT_STORM_MAX = 200;           // Taps per storm
+static const uint32_t STORM_SETTLE_MS = 30000;        // Wait for the last tap's audio
+
+// Before a request to host goes out (any task): false if it is to fail.
+// May block for the injected latency, or for timeout_ms on a timeout.
+bool net_fault_admit(const char* host, unsigned long timeout_ms);
+
+// Storm taps and heap samples (call from loop)
+void net_fault_task();
+
+// Register the FAULT and STORM commands
+void net_fault_serial_init();
+
+#endif // NET_FAULT_H
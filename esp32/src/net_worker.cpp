@@ -0,0 +1,1098 @@
+/**
+ * Network worker implementation for RadioWall.
+ *
+ * Commands are posted from the loop task (the device probe also from the
+ * settings scan task). Every absolute play request (tap, play-by-id) bumps
+ * _play_seq; a play command whose seq is older than that when the worker
+ * dequeues it has been superseded and is dropped. One already running is
+ * abandoned at the radio client's next await point via the cancel
+ * callback. While the command queue is idle the worker runs the radio
+ * client's prefetch step and, while a station is playing, polls the WiiM's
+ * player status every STATUS_POLL_MS (FIRST_PLAY_POLL_MS right after a
+ * play, until the WiiM reports "play", so the trace can timestamp when
+ * audio actually started). With a UPnP event subscription up, changes are
+ * pushed instead and the poll drops to EVENTED_POLL_MS as a safety net.
+ *
+ * Volume is a mailbox rather than a stream of commands: the slider only
+ * overwrites _pending_volume, and at most one SET_VOLUME command is queued.
+ * The worker sends the latest value, then any value that arrived while it
+ * was sending, so a drag costs one request per round trip and the final
+ * value is always delivered.
+ *
+ * Work runs in priority classes (NetClass): commands the user is waiting
+ * for, then prefetch (speculative taps, the radio client's prefetch step),
+ * then the status poll, then maintenance (idle refresh, data updates). User commands
+ * have their own queue and always go first. A prefetch location has a
+ * one-deep queue of its own (only the latest guess is worth warming), and
+ * the idle steps run only while no command waits. The boot warm list is
+ * one of them: the loop task posts it under _warm_mux, and each idle pass
+ * takes one entry, putting it back if a command preempted it. Before a lower class
+ * starts, it must find the internal heap a TLS handshake needs and a few
+ * pool slots spare for a tap; otherwise it is held back this pass. Once a
+ * command is posted, prefetch work already running gives up at its next
+ * await point (the radio client's cancel callback), like a superseded play.
+ */
+
+#include "net_worker.h"
+#include "linkplay_client.h"
+#include "wifi_fast.h"
+#include "wake_snapshot.h"
+#include "loop_events.h"
+#include "trace.h"
+#include "metrics_http.h"
+#include "web_remote.h"
+#include "peer_cache.h"
+#include "mqtt_client.h"
+#include "stall_mon.h"
+#include "data_update.h"
+#include "upnp_events.h"
+#include "group_monitor.h"
+#include "wiim_identity.h"
+#include "https_pool.h"
+#include "station_stats.h"
+#include "artwork.h"
+#include "serial_cmd.h"
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+static const int CMD_QUEUE_LEN = 8;
+static const int EVT_QUEUE_LEN = 8;
+static const uint32_t WORKER_STACK = 12288;     // mbedTLS handshake needs ~8 KB
+static const UBaseType_t WORKER_PRIORITY = 1;   // Same as the loop task
+static const BaseType_t WORKER_CORE = 0;        // Loop task runs on core 1
+static const unsigned long IDLE_POLL_MS = 100;  // Prefetch step interval when idle
+static const unsigned long STATUS_POLL_MS = 5000;  // getPlayerStatus interval
+static const unsigned long EVENTED_POLL_MS = 60000; // ... while UPnP events arrive
+static const unsigned long FIRST_PLAY_POLL_MS = 500;   // Until "play" after a start
+static const unsigned long FIRST_PLAY_WAIT_MS = 10000; // Give up timing after this
+static const int REJOIN_MAX = 8;                // Multiroom slaves to rejoin
+
+// What a class needs free before it may start: the largest internal block
+// (a handshake needs ~32 KB contiguous) and pool slots left for a tap
+// (radio.garden and the WiiM). User commands are never held back.
+struct NetClassPolicy {
+    const char* name;
+    size_t min_block;
+    int spare_slots;
+};
+static const NetClassPolicy CLASS_POLICY[NET_CLASS_COUNT] = {
+    {"interactive", 0, 0},
+    {"prefetch", 40 * 1024, 2},
+    {"poll", 32 * 1024, 2},        // Usually reuses the WiiM connection
+    {"maintenance", 48 * 1024, 3}, // Manifest, then chunked downloads
+};
+
+struct NetClassStats {
+    uint32_t admitted;
+    uint32_t held;           // Times it went from admitted to held back
+    uint32_t preempted;      // Gave up for a command posted meanwhile
+    bool holding;
+};
+
+// Stall monitor activity per NetCommandType
+static const char* const COMMAND_NAMES[] = {
+    "connect", "rejoin_group", "set_device", "device_moved", "group_join",
+    "group_kick", "play_location", "play_next", "play_by_id",
+    "prefetch_location", "stop", "pause", "resume", "set_volume",
+    "get_volume", "sleep_timer", "probe_devices", "serial",
+};
+static_assert(sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]) == NET_CMD_COUNT,
+              "one name per NetCommandType");
+
+struct NetCommand {
+    NetCommandType type;
+    uint32_t seq;          // _play_seq when posted (play commands)
+    NetRequest request;    // Play commands: handle returned to the caller
+    int tag;
+    int value;
+    float lat;
+    float lon;
+    char id[16];
+    char title[64];
+    char place[32];
+    char country[32];
+};
+
+static QueueHandle_t _cmd_queue = nullptr;
+static QueueHandle_t _prefetch_queue = nullptr;   // One deep, latest wins
+static QueueHandle_t _evt_queue = nullptr;
+static TaskHandle_t _worker = nullptr;
+static volatile uint32_t _play_seq = 0;
+static NetRequest _last_request = 0;   // Loop task
+static volatile bool _play_running = false;
+static uint32_t _running_seq = 0;      // seq of the play command being run
+static NetCommand _running_cmd;        // ... and the command itself (previews)
+
+static portMUX_TYPE _volume_mux = portMUX_INITIALIZER_UNLOCKED;
+static int _pending_volume = -1;       // Latest slider value not yet sent
+static bool _volume_queued = false;    // SET_VOLUME queued or being handled
+
+// Group to rejoin: the latest list posted wins (a queued REJOIN reads it
+// when it runs)
+static portMUX_TYPE _rejoin_mux = portMUX_INITIALIZER_UNLOCKED;
+static char _rejoin_ips[REJOIN_MAX][16];
+static int _rejoin_count = 0;
+
+// Devices to probe: likewise (net_worker_probe_devices)
+static portMUX_TYPE _probe_mux = portMUX_INITIALIZER_UNLOCKED;
+static char _probe_ips[NET_PROBE_MAX][16];
+static int _probe_count = 0;
+static NetProbeDone _probe_done = nullptr;
+
+// LinkPlay serial command waiting for the worker: one at a time
+static portMUX_TYPE _serial_mux = portMUX_INITIALIZER_UNLOCKED;
+static char _serial_args[256];
+static bool _serial_queued = false;
+
+// Boot warm list (see net_worker_warm): the latest list posted wins
+static portMUX_TYPE _warm_mux = portMUX_INITIALIZER_UNLOCKED;
+static char _warm_ids[NET_WARM_MAX][16];
+static int _warm_count = 0;
+static int _warm_pos = 0;              // Next entry to resolve
+static bool _warm_city = false;        // Resumed city's list still to load
+static float _warm_lat = 0;
+static float _warm_lon = 0;
+static uint32_t _warm_gen = 0;         // Bumped per list posted
+static int _warm_failed = 0;
+static unsigned long _warm_start = 0;
+
+// Idle refresh list (see net_worker_refresh): likewise, but paced
+static const unsigned long REFRESH_STEP_MS = 10000;
+static portMUX_TYPE _refresh_mux = portMUX_INITIALIZER_UNLOCKED;
+static NetRefreshEntry _refresh[NET_REFRESH_MAX];
+static int _refresh_count = 0;
+static int _refresh_pos = 0;
+static uint32_t _refresh_gen = 0;
+static unsigned long _refresh_next = 0;   // Worker: millis() of the next step
+static int _refresh_failed = 0;           // Worker
+
+static LinkPlayStatus _last_status;    // Last status posted to the UI
+static bool _have_status = false;
+static unsigned long _last_status_poll = 0;
+static bool _first_play_pending = false;  // Waiting to time the first "play"
+static uint32_t _play_ok_us = 0;          // micros() when the play call returned
+
+static volatile NetClass _running_class = NET_CLASS_INTERACTIVE;
+static bool _preempting = false;          // Counted the current preemption
+static NetClassStats _class_stats[NET_CLASS_COUNT];
+
+// ------------------------------------------------------------------
+// Scheduling
+// ------------------------------------------------------------------
+
+static bool command_waiting() {
+    return uxQueueMessagesWaiting(_cmd_queue) > 0;
+}
+
+// May work of this class start now? Logs when a class starts or stops
+// being held back.
+static bool admit(NetClass cls) {
+    const NetClassPolicy& policy = CLASS_POLICY[cls];
+    NetClassStats& st = _class_stats[cls];
+    size_t block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    int slots = https_pool_free_slots();
+    bool ok = cls == NET_CLASS_INTERACTIVE ||
+              (!command_waiting() && block >= policy.min_block && slots > policy.spare_slots);
+
+    if (!ok && !st.holding && !command_waiting()) {
+        st.held++;
+        st.holding = true;
+        Serial.printf("[Net] Holding back %s: %u KB largest block, %d slot(s) free\n",
+                      policy.name, (unsigned)(block / 1024), slots);
+    } else if (ok && st.holding) {
+        st.holding = false;
+        Serial.printf("[Net] %s admitted again\n", policy.name);
+    }
+    if (ok) st.admitted++;
+    return ok;
+}
+
+// Lower class work yields to a command posted while it runs
+static bool preempted() {
+    if (_running_class == NET_CLASS_INTERACTIVE || !command_waiting()) return false;
+    if (!_preempting) {
+        _preempting = true;
+        _class_stats[_running_class].preempted++;
+    }
+    return true;
+}
+
+static void run_as(NetClass cls) {
+    _running_class = cls;
+    _preempting = false;
+}
+
+// ------------------------------------------------------------------
+// Worker task
+// ------------------------------------------------------------------
+
+static void post_event(NetEventType type, const NetCommand& cmd, int value = 0) {
+    NetEvent evt;
+    memset(&evt, 0, sizeof(evt));
+    evt.type = type;
+    evt.cmd = cmd.type;
+    evt.request = cmd.request;
+    evt.tag = cmd.tag;
+    evt.value = value;
+    if (type == NET_EVT_PLAYING) {
+        const StationInfo* station = radio_get_current();
+        if (station) evt.station = *station;
+        evt.station_index = radio_get_station_index();
+        evt.station_total = radio_get_total_stations();
+    }
+    if (xQueueSend(_evt_queue, &evt, 0) != pdTRUE) {
+        Serial.println("[Net] Event queue full, dropping event");
+        return;
+    }
+    loop_events_notify();
+}
+
+static bool is_play_command(NetCommandType type) {
+    return type == NET_CMD_PLAY_LOCATION || type == NET_CMD_PLAY_NEXT ||
+           type == NET_CMD_PLAY_BY_ID;
+}
+
+static bool play_superseded() {
+    return _play_running && _running_seq != _play_seq;
+}
+
+// Radio client cancel callback: a newer tap / play-by-id was posted, or
+// prefetch work is holding up a command
+static bool work_cancelled() {
+    return play_superseded() || preempted();
+}
+
+// Radio client preview callback: tell the UI what is about to play
+static void play_preview(const StationInfo* station, int index, int total) {
+    if (!_play_running || play_superseded()) return;
+
+    NetEvent evt;
+    memset(&evt, 0, sizeof(evt));
+    evt.type = NET_EVT_PREVIEW;
+    evt.cmd = _running_cmd.type;
+    evt.request = _running_cmd.request;
+    evt.tag = _running_cmd.tag;
+    evt.station = *station;
+    evt.station_index = index;
+    evt.station_total = total;
+    if (xQueueSend(_evt_queue, &evt, 0) != pdTRUE) return;   // Only a preview
+    loop_events_notify();
+}
+
+// Radio client progress callback: the running play reached a stage
+static void play_progress(RadioStage stage) {
+    if (!_play_running || play_superseded()) return;
+
+    NetEvent evt;
+    memset(&evt, 0, sizeof(evt));
+    evt.type = NET_EVT_PROGRESS;
+    evt.cmd = _running_cmd.type;
+    evt.request = _running_cmd.request;
+    evt.tag = _running_cmd.tag;
+    evt.value = stage;
+    if (xQueueSend(_evt_queue, &evt, 0) != pdTRUE) return;   // The result follows
+    loop_events_notify();
+}
+
+static void run_play(const NetCommand& cmd) {
+    _running_seq = cmd.seq;
+    _running_cmd = cmd;
+    _play_running = true;
+    station_stats_playing(nullptr);   // Whatever played is being replaced
+
+    bool ok = false;
+    if (cmd.type == NET_CMD_PLAY_LOCATION) {
+        ok = cmd.value ? radio_play_country(cmd.lat, cmd.lon)
+                       : radio_play_at_location(cmd.lat, cmd.lon);
+    } else if (cmd.type == NET_CMD_PLAY_NEXT) {
+        ok = radio_play_next();
+    } else {
+        ok = radio_play_by_id(cmd.id, cmd.title, cmd.place, cmd.country,
+                              cmd.lat, cmd.lon);
+    }
+
+    bool superseded = play_superseded();
+    _play_running = false;
+
+    // A superseded request reports nothing; the newer one will
+    if (superseded) {
+        Serial.printf("[Net] Play command %d superseded\n", cmd.type);
+        return;
+    }
+    if (ok) {
+        // New stream: report the next status even if it looks the same
+        _have_status = false;
+        _last_status_poll = millis();
+        _first_play_pending = true;
+        _play_ok_us = micros();
+        wake_snapshot_set_station(radio_get_current(), radio_get_current_url());
+    }
+    post_event(ok ? NET_EVT_PLAYING : NET_EVT_PLAY_FAILED, cmd);
+}
+
+static void run_connect(const NetCommand& cmd) {
+    unsigned long start = millis();
+    if (wifi_fast_attempted() &&
+        WiFi.waitForConnectResult(WIFI_FAST_CONNECT_MS) != WL_CONNECTED) {
+        wifi_fast_fallback();
+    }
+    if (WiFi.waitForConnectResult(cmd.value) != WL_CONNECTED) {
+        Serial.printf("[WiFi] Not connected after %lu ms\n", millis() - start);
+        post_event(NET_EVT_NETWORK_FAILED, cmd);
+        return;
+    }
+    Serial.printf("[WiFi] Connected in %lu ms: %s\n", millis() - start,
+                  WiFi.localIP().toString().c_str());
+
+    // Wall clock (UTC) for cache expiry; syncs in the background
+    configTime(0, 0, "pool.ntp.org");
+    radio_client_network_up();
+
+    upnp_events_start();
+    upnp_events_set_device(linkplay_get_ip());
+    group_monitor_set_master(linkplay_get_ip());
+    group_monitor_start();
+
+    // mDNS (for device discovery)
+    if (MDNS.begin("radiowall")) {
+        Serial.println("[mDNS] Started as radiowall.local");
+        metrics_http_start();
+        web_remote_start();
+        peer_cache_start();
+        wiim_identity_start();
+    }
+    post_event(NET_EVT_NETWORK_UP, cmd);
+}
+
+// Rejoin saved multiroom group members (best effort, single attempt)
+static void run_rejoin() {
+    char ips[REJOIN_MAX][16];
+    portENTER_CRITICAL(&_rejoin_mux);
+    int count = _rejoin_count;
+    memcpy(ips, _rejoin_ips, sizeof(ips));
+    portEXIT_CRITICAL(&_rejoin_mux);
+
+    if (count <= 0 || !WiFi.isConnected()) return;
+
+    // Members known to be down are joined by the monitor when they return
+    int live = 0;
+    for (int i = 0; i < count; i++) {
+        if (!group_monitor_reachable(ips[i])) {
+            Serial.printf("[Net] Skipping %s (not answering)\n", ips[i]);
+            continue;
+        }
+        if (live != i) memcpy(ips[live], ips[i], sizeof(ips[i]));
+        live++;
+    }
+    if (live == 0) return;
+    Serial.printf("[Net] Rejoining %d group member(s)...\n", live);
+    linkplay_multiroom_join_all(ips, live);
+}
+
+// New primary WiiM: release the old master's group, then switch
+static void run_probe() {
+    char ips[NET_PROBE_MAX][16];
+    portENTER_CRITICAL(&_probe_mux);
+    int count = _probe_count;
+    NetProbeDone done = _probe_done;
+    memcpy(ips, _probe_ips, sizeof(ips[0]) * count);
+    _probe_count = 0;
+    portEXIT_CRITICAL(&_probe_mux);
+    if (count == 0) return;   // An earlier command took this list
+
+    LinkPlayDeviceInfo* info = (LinkPlayDeviceInfo*)calloc(count, sizeof(LinkPlayDeviceInfo));
+    if (!info) return;
+    linkplay_probe_devices(ips, count, info);
+    if (done) done(ips, info, count);
+    free(info);
+}
+
+// LinkPlay test command from the serial port; cmd.value is its letter
+static void run_serial(const NetCommand& cmd) {
+    char args[sizeof(_serial_args)];
+    portENTER_CRITICAL(&_serial_mux);
+    memcpy(args, _serial_args, sizeof(args));
+    _serial_queued = false;
+    portEXIT_CRITICAL(&_serial_mux);
+
+    switch (cmd.value) {
+        case 'W':
+            linkplay_set_ip(args);
+            break;
+        case 'P':
+            Serial.println(linkplay_play(args) ? "[LinkPlay] Play command sent"
+                                               : "[LinkPlay] Play command failed");
+            break;
+        case 'S':
+            Serial.println(linkplay_stop() ? "[LinkPlay] Stop command sent"
+                                           : "[LinkPlay] Stop command failed");
+            break;
+        case 'V': {
+            int vol = atoi(args);
+            if (linkplay_set_volume(vol)) {
+                Serial.printf("[LinkPlay] Volume set to %d\n", vol);
+            } else {
+                Serial.println("[LinkPlay] Volume command failed");
+            }
+            break;
+        }
+        case '?': {
+            String status = linkplay_get_status();
+            if (status.length() > 0) Serial.println("[LinkPlay] Status: " + status);
+            break;
+        }
+    }
+}
+
+static void run_set_device(const NetCommand& cmd) {
+    // A dead old master has no group to release: don't wait on it
+    if (group_monitor_reachable(linkplay_get_ip())) {
+        linkplay_multiroom_ungroup();
+    } else {
+        Serial.printf("[Net] Old device %s not answering, skipping ungroup\n", linkplay_get_ip());
+    }
+    linkplay_set_ip(cmd.id);
+    upnp_events_set_device(cmd.id);
+    group_monitor_set_master(cmd.id);
+    post_event(NET_EVT_DEVICE_SET, cmd);
+}
+
+// cmd.place holds the old address, cmd.id the new one
+static void run_device_moved(const NetCommand& cmd) {
+    if (strcmp(linkplay_get_ip(), cmd.place) != 0) return;
+    Serial.printf("[Net] Primary moved %s -> %s\n", cmd.place, cmd.id);
+    linkplay_set_ip(cmd.id);
+}
+
+static bool status_changed(const LinkPlayStatus& a, const LinkPlayStatus& b) {
+    return strcmp(a.state, b.state) != 0 || strcmp(a.title, b.title) != 0 ||
+           strcmp(a.artist, b.artist) != 0 || a.volume != b.volume ||
+           a.mute != b.mute || a.playlist_index != b.playlist_index;
+}
+
+// Post a new status to the UI if anything the UI shows changed
+static void publish_status(const LinkPlayStatus& st) {
+    // The WiiM went on to another entry of its station queue by itself
+    if (st.playlist_index != _last_status.playlist_index &&
+        radio_queue_sync(st.playlist_index)) {
+        NetCommand next;
+        memset(&next, 0, sizeof(next));
+        next.type = NET_CMD_PLAY_NEXT;
+        post_event(NET_EVT_PLAYING, next);
+    }
+
+    const StationInfo* current = radio_get_current();
+    bool playing = strcmp(st.state, "play") == 0;
+    if (_first_play_pending && playing) {
+        uint32_t now = micros();
+        trace_span(TRACE_FIRST_PLAY, _play_ok_us, now);
+        Serial.printf("[Trace] Audio confirmed %lu ms after play\n",
+                      (unsigned long)((now - _play_ok_us) / 1000));
+        _first_play_pending = false;
+        if (current) station_stats_started(current->id, (now - _play_ok_us) / 1000);
+    }
+    station_stats_playing(playing && current ? current->id : nullptr);
+    if (_have_status && !status_changed(st, _last_status)) return;
+
+    _last_status = st;
+    _have_status = true;
+
+    NetEvent evt;
+    memset(&evt, 0, sizeof(evt));
+    evt.type = NET_EVT_STATUS;
+    evt.status = st;
+    if (xQueueSend(_evt_queue, &evt, 0) != pdTRUE) {
+        Serial.println("[Net] Event queue full, dropping event");
+        _have_status = false;   // Post again on the next poll
+        return;
+    }
+    loop_events_notify();
+}
+
+static void poll_player_status() {
+    if (!radio_get_current()) return;
+
+    // Pushed by the renderer (UPnP NOTIFY) since the last pass
+    LinkPlayStatus pushed = _last_status;
+    if (_have_status && upnp_events_apply(&pushed)) publish_status(pushed);
+
+    if (_first_play_pending &&
+        micros() - _play_ok_us > FIRST_PLAY_WAIT_MS * 1000UL) {
+        // Handed over but never heard: counts against the station
+        _first_play_pending = false;
+        const StationInfo* current = radio_get_current();
+        if (current) station_stats_failed(current->id);
+    }
+    unsigned long interval = _first_play_pending ? FIRST_PLAY_POLL_MS
+                           : upnp_events_active() ? EVENTED_POLL_MS : STATUS_POLL_MS;
+    if (_have_status && millis() - _last_status_poll < interval) return;
+    _last_status_poll = millis();
+
+    // Held back: try again on the next pass
+    if (!admit(NET_CLASS_POLL)) return;
+    run_as(NET_CLASS_POLL);
+
+    // No retries: the next poll is only STATUS_POLL_MS away
+    LinkPlayStatus st;
+    if (!linkplay_get_player_status(&st)) return;
+    publish_status(st);
+}
+
+static void send_pending_volume() {
+    for (;;) {
+        portENTER_CRITICAL(&_volume_mux);
+        int volume = _pending_volume;
+        _pending_volume = -1;
+        if (volume < 0) _volume_queued = false;
+        portEXIT_CRITICAL(&_volume_mux);
+
+        if (volume < 0) return;
+        Serial.printf("[Net] Volume: %d%%\n", volume);
+        linkplay_set_volume(volume);
+    }
+}
+
+static void run_command(const NetCommand& cmd) {
+    if (is_play_command(cmd.type)) {
+        if (cmd.seq != _play_seq) {
+            Serial.printf("[Net] Dropping superseded play command %d\n", cmd.type);
+            return;
+        }
+        run_play(cmd);
+        return;
+    }
+
+    switch (cmd.type) {
+        case NET_CMD_CONNECT:
+            run_connect(cmd);
+            break;
+        case NET_CMD_REJOIN_GROUP:
+            run_rejoin();
+            break;
+        case NET_CMD_SET_DEVICE:
+            run_set_device(cmd);
+            break;
+        case NET_CMD_DEVICE_MOVED:
+            run_device_moved(cmd);
+            break;
+        case NET_CMD_GROUP_JOIN:
+            if (!group_monitor_reachable(cmd.id)) {
+                Serial.printf("[Net] %s not answering, joins when it is back\n", cmd.id);
+                break;
+            }
+            Serial.printf("[Net] Joining %s to multiroom group\n", cmd.id);
+            linkplay_multiroom_join(cmd.id);
+            break;
+        case NET_CMD_GROUP_KICK:
+            // Sent to the master: a dead slave can still be kicked
+            if (!group_monitor_reachable(linkplay_get_ip())) {
+                Serial.printf("[Net] Master not answering, not kicking %s\n", cmd.id);
+                break;
+            }
+            Serial.printf("[Net] Removing %s from multiroom group\n", cmd.id);
+            linkplay_multiroom_kick(cmd.id);
+            break;
+        case NET_CMD_PREFETCH_LOCATION:
+            radio_prefetch_location(cmd.lat, cmd.lon);
+            break;
+        case NET_CMD_STOP:
+            _first_play_pending = false;   // Nothing left to time
+            radio_stop();
+            wake_snapshot_set_station(nullptr, nullptr);
+            post_event(NET_EVT_STOPPED, cmd);
+            break;
+        case NET_CMD_PAUSE:
+            _first_play_pending = false;   // Silence now is not the station's fault
+            linkplay_pause();
+            break;
+        case NET_CMD_RESUME:
+            linkplay_resume();
+            break;
+        case NET_CMD_SET_VOLUME:
+            send_pending_volume();
+            break;
+        case NET_CMD_GET_VOLUME:
+            post_event(NET_EVT_VOLUME, cmd, linkplay_get_volume());
+            break;
+        case NET_CMD_SLEEP_TIMER:
+            linkplay_set_sleep_timer(cmd.value);
+            break;
+        case NET_CMD_PROBE_DEVICES:
+            run_probe();
+            break;
+        case NET_CMD_SERIAL:
+            run_serial(cmd);
+            break;
+        default:
+            break;
+    }
+}
+
+static bool warm_pending() {
+    portENTER_CRITICAL(&_warm_mux);
+    bool pending = _warm_city || _warm_pos < _warm_count;
+    portEXIT_CRITICAL(&_warm_mux);
+    return pending;
+}
+
+// One entry of the warm list: the resumed city first, then the stations
+static void warm_step() {
+    if (!WiFi.isConnected()) return;
+
+    char id[16] = "";
+    bool city = false;
+    float lat = 0, lon = 0;
+    portENTER_CRITICAL(&_warm_mux);
+    uint32_t gen = _warm_gen;
+    if (_warm_city) {
+        city = true;
+        lat = _warm_lat;
+        lon = _warm_lon;
+        _warm_city = false;
+    } else if (_warm_pos < _warm_count) {
+        memcpy(id, _warm_ids[_warm_pos++], sizeof(id));
+    }
+    bool last = !_warm_city && _warm_pos >= _warm_count;
+    portEXIT_CRITICAL(&_warm_mux);
+
+    bool ok = city ? radio_prefetch_location(lat, lon) : radio_warm_station(id);
+    if (!ok && work_cancelled()) {
+        // Preempted: try it again on a later pass
+        portENTER_CRITICAL(&_warm_mux);
+        if (gen == _warm_gen) {
+            if (city) _warm_city = true;
+            else _warm_pos--;
+        }
+        portEXIT_CRITICAL(&_warm_mux);
+        return;
+    }
+    portENTER_CRITICAL(&_warm_mux);
+    bool current = gen == _warm_gen;
+    if (!ok && current) _warm_failed++;
+    int failed = _warm_failed;
+    portEXIT_CRITICAL(&_warm_mux);
+    if (last && current) {
+        Serial.printf("[Net] Warm list done in %lu ms (%d failed)\n",
+                      millis() - _warm_start, failed);
+    }
+}
+
+// Refresh entries left and the pace allows one now
+static bool refresh_due() {
+    if ((long)(millis() - _refresh_next) < 0) return false;
+    portENTER_CRITICAL(&_refresh_mux);
+    bool pending = _refresh_pos < _refresh_count;
+    portEXIT_CRITICAL(&_refresh_mux);
+    return pending;
+}
+
+// One entry of the idle refresh list: its city's stations, then its URL
+static void refresh_step() {
+    if (!WiFi.isConnected()) return;
+
+    NetRefreshEntry e;
+    portENTER_CRITICAL(&_refresh_mux);
+    uint32_t gen = _refresh_gen;
+    bool have = _refresh_pos < _refresh_count;
+    if (have) e = _refresh[_refresh_pos++];
+    bool first = _refresh_pos == 1;
+    bool last = _refresh_pos >= _refresh_count;
+    portEXIT_CRITICAL(&_refresh_mux);
+    if (!have) return;
+    if (first) _refresh_failed = 0;
+
+    bool ok = (!e.place || radio_refresh_place(e.lat, e.lon)) &&
+              (!e.station_id[0] || radio_refresh_station(e.station_id));
+    if (!ok && work_cancelled()) {
+        portENTER_CRITICAL(&_refresh_mux);
+        if (gen == _refresh_gen) _refresh_pos--;
+        portEXIT_CRITICAL(&_refresh_mux);
+        return;
+    }
+    _refresh_next = millis() + REFRESH_STEP_MS;
+    if (!ok) _refresh_failed++;
+    if (last) {
+        Serial.printf("[Net] Idle refresh done (%d failed)\n", _refresh_failed);
+    }
+}
+
+// Idle steps, highest class first; each one stops the pass if a command
+// has come in meanwhile
+static void run_idle_pass() {
+    if (admit(NET_CLASS_PREFETCH)) {
+        stall_mon_activity(STALL_NET_WORKER, "prefetch");
+        run_as(NET_CLASS_PREFETCH);
+        radio_client_task();
+    }
+    if (warm_pending() && admit(NET_CLASS_PREFETCH)) {
+        stall_mon_activity(STALL_NET_WORKER, "warm");
+        run_as(NET_CLASS_PREFETCH);
+        warm_step();
+    }
+    if (artwork_pending() && admit(NET_CLASS_PREFETCH)) {
+        stall_mon_activity(STALL_NET_WORKER, "artwork");
+        run_as(NET_CLASS_PREFETCH);
+        artwork_fetch_step(work_cancelled);
+    }
+    if (command_waiting()) return;
+    stall_mon_activity(STALL_NET_WORKER, "player_status");
+    poll_player_status();
+    if (command_waiting()) return;
+    stall_mon_activity(STALL_NET_WORKER, "mqtt");
+    mqtt_network_task();
+    if (command_waiting()) return;
+    if (refresh_due() && admit(NET_CLASS_MAINTENANCE)) {
+        stall_mon_activity(STALL_NET_WORKER, "refresh");
+        run_as(NET_CLASS_MAINTENANCE);
+        refresh_step();
+        if (command_waiting()) return;
+    }
+    if (admit(NET_CLASS_MAINTENANCE)) {
+        stall_mon_activity(STALL_NET_WORKER, "data_update");
+        run_as(NET_CLASS_MAINTENANCE);
+        data_update_task();
+    }
+}
+
+static void worker_task(void*) {
+    NetCommand cmd;
+    for (;;) {
+        if (!command_waiting() && uxQueueMessagesWaiting(_prefetch_queue) == 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IDLE_POLL_MS));
+        }
+        stall_mon_begin(STALL_NET_WORKER);
+        if (xQueueReceive(_cmd_queue, &cmd, 0) == pdTRUE) {
+            stall_mon_activity(STALL_NET_WORKER, COMMAND_NAMES[cmd.type]);
+            run_as(NET_CLASS_INTERACTIVE);
+            _class_stats[NET_CLASS_INTERACTIVE].admitted++;
+            run_command(cmd);
+        } else if (xQueueReceive(_prefetch_queue, &cmd, 0) == pdTRUE) {
+            // Dropped if a play was posted since (it fetches for itself) or
+            // if held back: it is only a guess
+            if (cmd.seq == _play_seq && admit(NET_CLASS_PREFETCH)) {
+                stall_mon_activity(STALL_NET_WORKER, COMMAND_NAMES[cmd.type]);
+                run_as(NET_CLASS_PREFETCH);
+                run_command(cmd);
+            }
+        } else {
+            run_idle_pass();
+            stall_mon_check();
+        }
+        run_as(NET_CLASS_INTERACTIVE);
+        stall_mon_end(STALL_NET_WORKER);
+    }
+}
+
+// ------------------------------------------------------------------
+// Command posting (loop task)
+// ------------------------------------------------------------------
+
+static bool post_command(NetCommand& cmd) {
+    if (!_cmd_queue) return false;
+    if (cmd.type == NET_CMD_PLAY_LOCATION || cmd.type == NET_CMD_PLAY_BY_ID) {
+        _play_seq = _play_seq + 1;
+    }
+    cmd.seq = _play_seq;
+    if (cmd.type == NET_CMD_PREFETCH_LOCATION) {
+        xQueueOverwrite(_prefetch_queue, &cmd);
+    } else if (xQueueSend(_cmd_queue, &cmd, 0) != pdTRUE) {
+        Serial.printf("[Net] Command queue full, dropping command %d\n", cmd.type);
+        return false;
+    }
+    if (_worker) xTaskNotifyGive(_worker);
+    return true;
+}
+
+void net_worker_wake() {
+    if (_worker) xTaskNotifyGive(_worker);
+}
+
+static NetCommand make_command(NetCommandType type) {
+    NetCommand cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.type = type;
+    return cmd;
+}
+
+// Post a play command under a new request handle
+static NetRequest post_play(NetCommand& cmd) {
+    cmd.request = ++_last_request;
+    if (cmd.request == 0) cmd.request = ++_last_request;   // 0 means not queued
+    return post_command(cmd) ? cmd.request : 0;
+}
+
+static void copy_field(char* dst, const char* src, size_t cap) {
+    strncpy(dst, src ? src : "", cap - 1);
+    dst[cap - 1] = '\0';
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void net_worker_start() {
+    if (_cmd_queue) return;
+
+    _cmd_queue = xQueueCreate(CMD_QUEUE_LEN, sizeof(NetCommand));
+    _prefetch_queue = xQueueCreate(1, sizeof(NetCommand));
+    _evt_queue = xQueueCreate(EVT_QUEUE_LEN, sizeof(NetEvent));
+    if (!_cmd_queue || !_prefetch_queue || !_evt_queue) {
+        Serial.println("[Net] Failed to create queues");
+        return;
+    }
+    radio_set_cancel_callback(work_cancelled);
+    radio_set_preview_callback(play_preview);
+    radio_set_progress_callback(play_progress);
+
+    if (xTaskCreatePinnedToCore(worker_task, "net_worker", WORKER_STACK, nullptr,
+                                WORKER_PRIORITY, &_worker, WORKER_CORE) != pdPASS) {
+        Serial.println("[Net] Failed to start worker task");
+        return;
+    }
+    Serial.printf("[Net] Worker started on core %d\n", WORKER_CORE);
+}
+
+bool net_worker_connect(unsigned long timeout_ms) {
+    NetCommand cmd = make_command(NET_CMD_CONNECT);
+    cmd.value = (int)timeout_ms;
+    return post_command(cmd);
+}
+
+bool net_worker_rejoin_group(const char (*group_ips)[16], int group_count) {
+    int count = constrain(group_count, 0, REJOIN_MAX);
+    portENTER_CRITICAL(&_rejoin_mux);
+    _rejoin_count = count;
+    for (int i = 0; i < count; i++) {
+        memcpy(_rejoin_ips[i], group_ips[i], sizeof(_rejoin_ips[i]));
+        _rejoin_ips[i][sizeof(_rejoin_ips[i]) - 1] = '\0';
+    }
+    portEXIT_CRITICAL(&_rejoin_mux);
+
+    NetCommand cmd = make_command(NET_CMD_REJOIN_GROUP);
+    return post_command(cmd);
+}
+
+bool net_worker_set_device(const char* ip) {
+    NetCommand cmd = make_command(NET_CMD_SET_DEVICE);
+    copy_field(cmd.id, ip, sizeof(cmd.id));
+    return post_command(cmd);
+}
+
+bool net_worker_device_moved(const char* old_ip, const char* new_ip) {
+    NetCommand cmd = make_command(NET_CMD_DEVICE_MOVED);
+    copy_field(cmd.id, new_ip, sizeof(cmd.id));
+    copy_field(cmd.place, old_ip, sizeof(cmd.place));
+    return post_command(cmd);
+}
+
+bool net_worker_group_member(const char* slave_ip, bool join) {
+    NetCommand cmd = make_command(join ? NET_CMD_GROUP_JOIN : NET_CMD_GROUP_KICK);
+    copy_field(cmd.id, slave_ip, sizeof(cmd.id));
+    return post_command(cmd);
+}
+
+NetRequest net_worker_play_at_location(float lat, float lon, bool country) {
+    NetCommand cmd = make_command(NET_CMD_PLAY_LOCATION);
+    cmd.lat = lat;
+    cmd.lon = lon;
+    cmd.value = country;
+    return post_play(cmd);
+}
+
+NetRequest net_worker_play_next() {
+    NetCommand cmd = make_command(NET_CMD_PLAY_NEXT);
+    return post_play(cmd);
+}
+
+bool net_worker_prefetch_location(float lat, float lon) {
+    NetCommand cmd = make_command(NET_CMD_PREFETCH_LOCATION);
+    cmd.lat = lat;
+    cmd.lon = lon;
+    return post_command(cmd);
+}
+
+bool net_worker_warm(const char (*station_ids)[16], int count,
+                     bool city, float lat, float lon) {
+    if (!_cmd_queue) return false;
+    count = constrain(count, 0, NET_WARM_MAX);
+    portENTER_CRITICAL(&_warm_mux);
+    for (int i = 0; i < count; i++) {
+        memcpy(_warm_ids[i], station_ids[i], sizeof(_warm_ids[i]));
+        _warm_ids[i][sizeof(_warm_ids[i]) - 1] = '\0';
+    }
+    _warm_count = count;
+    _warm_pos = 0;
+    _warm_city = city;
+    _warm_lat = lat;
+    _warm_lon = lon;
+    _warm_gen++;
+    _warm_failed = 0;
+    _warm_start = millis();
+    portEXIT_CRITICAL(&_warm_mux);
+
+    Serial.printf("[Net] Warming %d station(s)%s\n", count, city ? " and the resumed city" : "");
+    if (_worker) xTaskNotifyGive(_worker);
+    return true;
+}
+
+void net_worker_refresh(const NetRefreshEntry* entries, int count) {
+    count = constrain(count, 0, NET_REFRESH_MAX);
+    portENTER_CRITICAL(&_refresh_mux);
+    memcpy(_refresh, entries, count * sizeof(NetRefreshEntry));
+    _refresh_count = count;
+    _refresh_pos = 0;
+    _refresh_gen++;
+    portEXIT_CRITICAL(&_refresh_mux);
+    Serial.printf("[Net] Idle refresh: %d station(s)\n", count);
+}
+
+void net_worker_refresh_stop() {
+    portENTER_CRITICAL(&_refresh_mux);
+    bool running = _refresh_pos < _refresh_count;
+    _refresh_count = 0;
+    _refresh_pos = 0;
+    _refresh_gen++;
+    portEXIT_CRITICAL(&_refresh_mux);
+    if (running) Serial.println("[Net] Idle refresh stopped");
+}
+
+NetRequest net_worker_play_by_id(const char* station_id, const char* title,
+                                 const char* place, const char* country,
+                                 float lat, float lon, int tag) {
+    NetCommand cmd = make_command(NET_CMD_PLAY_BY_ID);
+    copy_field(cmd.id, station_id, sizeof(cmd.id));
+    copy_field(cmd.title, title, sizeof(cmd.title));
+    copy_field(cmd.place, place, sizeof(cmd.place));
+    copy_field(cmd.country, country, sizeof(cmd.country));
+    cmd.lat = lat;
+    cmd.lon = lon;
+    cmd.tag = tag;
+    return post_play(cmd);
+}
+
+bool net_worker_stop() {
+    NetCommand cmd = make_command(NET_CMD_STOP);
+    return post_command(cmd);
+}
+
+bool net_worker_pause() {
+    NetCommand cmd = make_command(NET_CMD_PAUSE);
+    return post_command(cmd);
+}
+
+bool net_worker_resume() {
+    NetCommand cmd = make_command(NET_CMD_RESUME);
+    return post_command(cmd);
+}
+
+bool net_worker_set_volume(int volume) {
+    portENTER_CRITICAL(&_volume_mux);
+    bool queued = _volume_queued;
+    _pending_volume = constrain(volume, 0, 100);
+    _volume_queued = true;
+    portEXIT_CRITICAL(&_volume_mux);
+
+    // The queued command (or the send in progress) picks up the new value
+    if (queued) return true;
+
+    NetCommand cmd = make_command(NET_CMD_SET_VOLUME);
+    if (!post_command(cmd)) {
+        portENTER_CRITICAL(&_volume_mux);
+        _volume_queued = false;
+        portEXIT_CRITICAL(&_volume_mux);
+        return false;
+    }
+    return true;
+}
+
+bool net_worker_get_volume() {
+    NetCommand cmd = make_command(NET_CMD_GET_VOLUME);
+    return post_command(cmd);
+}
+
+bool net_worker_set_sleep_timer(int minutes) {
+    NetCommand cmd = make_command(NET_CMD_SLEEP_TIMER);
+    cmd.value = minutes;
+    return post_command(cmd);
+}
+
+bool net_worker_probe_devices(const char (*ips)[16], int count, NetProbeDone done) {
+    count = constrain(count, 0, NET_PROBE_MAX);
+    portENTER_CRITICAL(&_probe_mux);
+    _probe_count = count;
+    _probe_done = done;
+    for (int i = 0; i < count; i++) {
+        memcpy(_probe_ips[i], ips[i], sizeof(_probe_ips[i]));
+        _probe_ips[i][sizeof(_probe_ips[i]) - 1] = '\0';
+    }
+    portEXIT_CRITICAL(&_probe_mux);
+
+    NetCommand cmd = make_command(NET_CMD_PROBE_DEVICES);
+    return post_command(cmd);
+}
+
+bool net_worker_poll_event(NetEvent* evt) {
+    if (!_evt_queue) return false;
+    return xQueueReceive(_evt_queue, evt, 0) == pdTRUE;
+}
+
+static void cmd_sched(const char*) {
+    size_t block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    Serial.printf("[Net] Largest internal block %u KB, %d pool slot(s) free\n",
+                  (unsigned)(block / 1024), https_pool_free_slots());
+    for (int i = 0; i < NET_CLASS_COUNT; i++) {
+        const NetClassStats& st = _class_stats[i];
+        Serial.printf("[Net] %-11s admitted %6lu, held back %lu time(s)%s, preempted %lu\n",
+                      CLASS_POLICY[i].name, (unsigned long)st.admitted, (unsigned long)st.held,
+                      st.holding ? " (now)" : "", (unsigned long)st.preempted);
+    }
+    portENTER_CRITICAL(&_warm_mux);
+    int pos = _warm_pos, count = _warm_count, failed = _warm_failed;
+    bool city = _warm_city;
+    portEXIT_CRITICAL(&_warm_mux);
+    Serial.printf("[Net] Warm list %d/%d station(s)%s, %d failed\n", pos, count,
+                  city ? ", city pending" : "", failed);
+}
+
+// LinkPlay test commands: the worker owns LinkPlay, so the loop task only
+// queues them
+static void post_serial(char op, const char* args) {
+    portENTER_CRITICAL(&_serial_mux);
+    bool busy = _serial_queued;
+    if (!busy) {
+        copy_field(_serial_args, args, sizeof(_serial_args));
+        _serial_queued = true;
+    }
+    portEXIT_CRITICAL(&_serial_mux);
+    if (busy) {
+        Serial.println("[LinkPlay] Previous command still queued");
+        return;
+    }
+
+    NetCommand cmd = make_command(NET_CMD_SERIAL);
+    cmd.value = op;
+    if (!post_command(cmd)) {
+        portENTER_CRITICAL(&_serial_mux);
+        _serial_queued = false;
+        portEXIT_CRITICAL(&_serial_mux);
+    }
+}
+
+static void cmd_set_ip(const char* args) { post_serial('W', args); }
+static void cmd_play(const char* args) { post_serial('P', args); }
+static void cmd_stop(const char*) { post_serial('S', ""); }
+static void cmd_volume(const char* args) { post_serial('V', args); }
+static void cmd_status(const char*) { post_serial('?', ""); }
+
+void net_worker_serial_init() {
+    serial_cmd_register("NETQ", cmd_sched);
+    serial_cmd_register("W:", cmd_set_ip);
+    serial_cmd_register("P:", cmd_play);
+    serial_cmd_register("S", cmd_stop);
+    serial_cmd_register("V:", cmd_volume);
+    serial_cmd_register("?", cmd_status);
+}
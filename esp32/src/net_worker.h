@@ -0,0 +1,176 @@
+/**
+ * Network worker for RadioWall.
+ *
+ * Runs Radio.garden and LinkPlay requests on a FreeRTOS task pinned to
+ * core 0, so touch, buttons and the display on the loop task never block
+ * on the network. The UI posts commands; results come back as events
+ * that loop() drains with net_worker_poll_event().
+ *
+ * A newer tap or play-by-id supersedes any play command still waiting in
+ * the queue (last request wins). NEXT is relative to what is playing, so
+ * it does not supersede anything.
+ *
+ * While a play runs, NET_EVT_PREVIEW events report the city and then the
+ * station as soon as the radio client knows them, ahead of the result, and
+ * NET_EVT_PROGRESS events each stage it reaches (place, stations, stream
+ * URL, WiiM). The posting call returns a request handle that these events
+ * and the result carry.
+ *
+ * A prefetch only warms the radio client's caches for a tap that may
+ * still become a double-tap; it posts no event and supersedes nothing.
+ * It runs below every other command, and only while the heap and the
+ * connection pool have room to spare (see NetClass).
+ *
+ * Once the network is up, a warm list (favorites, recent history, the
+ * resumed city) is worked through at prefetch priority, one request per
+ * idle pass, so the first tap on any of them skips the redirect lookup.
+ * The idle refresh list (idle_refresh.h) is worked through the same way
+ * at maintenance priority, one entry every few seconds, while nobody is
+ * touching the wall.
+ *
+ * While a station is playing and the queue is idle, the worker polls the
+ * WiiM's getPlayerStatus and posts NET_EVT_STATUS only when something the
+ * UI shows (state, title, artist, volume, mute) has changed.
+ *
+ * The first command at boot is CONNECT: it waits for the association that
+ * setup() started, then brings up NTP and mDNS. The resume play and the
+ * multiroom rejoin queue behind it, so audio starts first. Commands posted
+ * meanwhile (a tap on the map that is already on screen) queue as well.
+ */
+
+#ifndef NET_WORKER_H
+#define NET_WORKER_H
+
+#include <Arduino.h>
+#include "radio_client.h"
+#include "linkplay_client.h"
+
+enum NetCommandType {
+    NET_CMD_CONNECT,
+    NET_CMD_REJOIN_GROUP,
+    NET_CMD_SET_DEVICE,
+    NET_CMD_DEVICE_MOVED,  // Same speaker, new address: no ungroup
+    NET_CMD_GROUP_JOIN,
+    NET_CMD_GROUP_KICK,
+    NET_CMD_PLAY_LOCATION,
+    NET_CMD_PLAY_NEXT,
+    NET_CMD_PLAY_BY_ID,
+    NET_CMD_PREFETCH_LOCATION,
+    NET_CMD_STOP,
+    NET_CMD_PAUSE,
+    NET_CMD_RESUME,
+    NET_CMD_SET_VOLUME,
+    NET_CMD_GET_VOLUME,
+    NET_CMD_SLEEP_TIMER,
+    NET_CMD_PROBE_DEVICES,
+    NET_CMD_SERIAL,        // LinkPlay test commands typed on the serial port
+    NET_CMD_COUNT
+};
+
+// Stations one warm list holds (the stream cache keeps a few more)
+#define NET_WARM_MAX 20
+#define NET_REFRESH_MAX 16
+#define NET_PROBE_MAX 8        // Devices one probe covers (the scan's table)
+
+// Priority classes, highest first (see net_worker.cpp)
+enum NetClass : uint8_t {
+    NET_CLASS_INTERACTIVE,   // Commands the user is waiting for
+    NET_CLASS_PREFETCH,      // Speculative taps, next station / city, artwork
+    NET_CLASS_POLL,          // WiiM player status
+    NET_CLASS_MAINTENANCE,   // Data updates, idle refresh
+    NET_CLASS_COUNT
+};
+
+enum NetEventType {
+    NET_EVT_PLAYING,       // station holds what is now playing
+    NET_EVT_PREVIEW,       // station holds what a running play is about to
+                           //   play (title empty: only the city is known yet)
+    NET_EVT_PROGRESS,      // value holds the RadioStage a running play reached
+    NET_EVT_PLAY_FAILED,
+    NET_EVT_STOPPED,
+    NET_EVT_VOLUME,        // value holds the device volume (-1 if unknown)
+    NET_EVT_STATUS,        // status changed since the last poll
+    NET_EVT_NETWORK_UP,    // WiFi associated, NTP and mDNS started
+    NET_EVT_NETWORK_FAILED, // WiFi did not associate within the timeout
+    NET_EVT_DEVICE_SET     // Switched to a new primary WiiM
+};
+
+// Handle of a posted play command; its PREVIEW, PROGRESS, PLAYING and
+// PLAY_FAILED events carry it. 0: not queued.
+typedef uint32_t NetRequest;
+
+struct NetEvent {
+    NetEventType type;
+    NetCommandType cmd;    // Command that produced the event
+    NetRequest request;    // Play events: the request they belong to
+    int tag;               // Caller's tag, passed through unchanged
+    int value;
+    StationInfo station;   // NET_EVT_PLAYING/PREVIEW: the station, and where it sits
+    int station_index;     //   in its city's list (1-based; total 0 = unknown)
+    int station_total;
+    LinkPlayStatus status;
+};
+
+// Create the queues and start the worker task (call at the end of setup)
+void net_worker_start();
+
+// Post commands (return false if the queue is full)
+bool net_worker_connect(unsigned long timeout_ms);
+bool net_worker_rejoin_group(const char (*group_ips)[16], int group_count);
+bool net_worker_set_device(const char* ip);                // Ungroups the old one
+// The primary answered at new_ip (wiim_identity.h): linkplay sends there
+// from now on, unless it already moved or another device was picked
+bool net_worker_device_moved(const char* old_ip, const char* new_ip);
+bool net_worker_group_member(const char* slave_ip, bool join);
+// country: radio_play_country() instead of the nearest city
+NetRequest net_worker_play_at_location(float lat, float lon, bool country = false);
+NetRequest net_worker_play_next();
+bool net_worker_prefetch_location(float lat, float lon);
+// Warm the stream URL cache for station_ids and, if city, the station list
+// of the city nearest lat/lon (prefetch class, while idle). Replaces a list
+// not worked through yet; stations already cached cost nothing.
+bool net_worker_warm(const char (*station_ids)[16], int count,
+                     bool city, float lat, float lon);
+// Idle refresh entry: a station whose stream URL is re-resolved once it
+// is old and, if place, the station list of the city nearest lat/lon
+// (station_id empty: the list only)
+struct NetRefreshEntry {
+    char station_id[16];
+    float lat;
+    float lon;
+    bool place;
+};
+
+// Refresh entries in order (maintenance class, one per few seconds while
+// idle). Replaces a list not worked through yet; stop drops it.
+void net_worker_refresh(const NetRefreshEntry* entries, int count);
+void net_worker_refresh_stop();
+
+NetRequest net_worker_play_by_id(const char* station_id, const char* title,
+                                 const char* place, const char* country,
+                                 float lat, float lon, int tag);
+bool net_worker_stop();
+bool net_worker_pause();
+bool net_worker_resume();
+bool net_worker_set_volume(int volume);   // Latest value wins; never blocks
+bool net_worker_get_volume();
+bool net_worker_set_sleep_timer(int minutes);
+
+// getStatusEx on every device in ips (linkplay_probe_devices), run by the
+// worker; done is then called on the worker task with one record per ip.
+// Replaces a list not probed yet. Safe to call from any task.
+typedef void (*NetProbeDone)(const char (*ips)[16], const LinkPlayDeviceInfo* info, int count);
+bool net_worker_probe_devices(const char (*ips)[16], int count, NetProbeDone done);
+
+// Run an idle pass soon (e.g. after queueing MQTT messages for it)
+void net_worker_wake();
+
+// Next event from the worker, if any (call from loop)
+bool net_worker_poll_event(NetEvent* evt);
+
+// Register the NETQ serial command (per-class runs, holds, preemptions)
+// and the LinkPlay test commands (W:ip, P:url, S, V:vol, ?), which the
+// worker runs
+void net_worker_serial_init();
+
+#endif // NET_WORKER_H
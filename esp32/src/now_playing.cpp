@@ -0,0 +1,407 @@
+/**
+ * Now Playing display implementation for RadioWall.
+ *
+ * The scene is a column of layers, top to bottom: the player state, the
+ * artwork (or its placeholder), the station name, its place, the track
+ * title and the volume arc. Each keeps the text or value it was last drawn
+ * with; the artwork also keeps the artwork generation it was drawn at.
+ */
+
+#include "now_playing.h"
+#include "fnv1a.h"
+#include "display.h"
+#include "theme.h"
+#include "ui_state.h"
+#include "text_layout.h"
+#include "loop_events.h"
+#include "artwork.h"
+
+// Layout (portrait 180x640)
+static const int TEXT_X = 4;
+static const int TEXT_W = TH_DISPLAY_W - 8;
+static const int STATE_Y = 0;
+static const int STATE_H = 28;
+static const int ART_SIZE = ARTWORK_SIZE;
+static const int ART_X = (TH_DISPLAY_W - ART_SIZE) / 2;
+static const int ART_Y = 40;
+static const int NAME_Y = 196;          // Line tops; text baseline 13 px below
+static const int PLACE_Y = 216;
+static const int LINE_H = 18;
+static const int TITLE_Y = 246;
+static const int TITLE_H = 16;
+static const int TITLE_BASELINE = 11;
+static const int ARC_CX = TH_DISPLAY_W / 2;
+static const int ARC_CY = 380;
+static const int ARC_R = 62;
+static const int ARC_THICK = 10;
+static const float ARC_START = 135.0f;  // Degrees clockwise from 3 o'clock
+static const float ARC_SWEEP = 270.0f;  // Open at the bottom
+
+// Same pace as the status bar marquee
+static const int STRIP_W = 1024;        // Widest title scrolled (32 KB strip)
+static const int MARQUEE_GAP = 40;
+static const uint32_t MARQUEE_PAUSE_MS = 2000;
+static const uint32_t MARQUEE_PX_PER_S = 30;
+
+// Artwork colours, picked by a hash of the station name
+static const uint16_t ART_COLORS[] = {
+    0x030E, 0x4190, 0x714B, 0x9204, 0x6344, 0x2348, 0x3A4D, 0x8106,
+};
+
+struct Drawn {
+    bool valid;                 // False: draw every layer
+    char state[40];
+    char station[128];          // Art and name line ("" when stopped)
+    uint32_t art_gen;           // artwork_generation() the art was drawn at
+    char place[160];
+    char title[132];
+    int volume;                 // -1: not drawn
+};
+static Drawn _drawn = {};
+
+struct Marquee {
+    bool active;
+    int period;                 // Text width + gap: one pass, in pixels
+    uint32_t start_ms;
+    int shown;                  // Offset on the panel, -1 = not drawn
+};
+static Marquee _marquee = {};
+static Arduino_Canvas* _strip = nullptr;
+static bool _strip_unavailable = false;
+
+static void set_unicode_font(Arduino_GFX* gfx) {
+    gfx->setFont(TH_FONT_UNICODE);
+    gfx->setFontIndex(TH_FONT_UNICODE_INDEX);
+    gfx->setUTF8Print(true);
+    gfx->setTextSize(1);
+}
+
+static void clear_unicode_font(Arduino_GFX* gfx) {
+    gfx->setFont((const uint8_t*)nullptr);
+    gfx->setUTF8Print(false);
+}
+
+// Copy src into a layer's record; false if it already held it
+static bool changed(char* drawn, size_t cap, const char* src) {
+    if (_drawn.valid && strcmp(drawn, src) == 0) return false;
+    strncpy(drawn, src, cap - 1);
+    drawn[cap - 1] = '\0';
+    return true;
+}
+
+// One line of Unicode text, fitted and centred, on a cleared band
+static void draw_line(Arduino_GFX* gfx, int y, const char* text, uint16_t color) {
+    display_damage(0, y, TH_DISPLAY_W, LINE_H);
+    gfx->fillRect(0, y, TH_DISPLAY_W, LINE_H, TH_BG);
+    if (!text[0]) return;
+    char fitted[160];
+    set_unicode_font(gfx);
+    int w = text_layout_fit(text, TEXT_W, fitted, sizeof(fitted));
+    gfx->setTextColor(color);
+    gfx->setCursor((TH_DISPLAY_W - w) / 2, y + 13);
+    gfx->print(fitted);
+    clear_unicode_font(gfx);
+}
+
+// ------------------------------------------------------------------
+// Layers
+// ------------------------------------------------------------------
+
+static void draw_state(Arduino_GFX* gfx, UIState* state) {
+    const char* status = state->get_status_text();
+    const char* text;
+    uint16_t color;
+    if (status[0]) {
+        text = status;
+        color = MAGENTA;
+    } else if (!state->get_is_playing()) {
+        text = "Not playing";
+        color = TH_TEXT_DIM;
+    } else if (state->is_paused()) {
+        text = "Paused";
+        color = TH_WARNING;
+    } else {
+        text = "Now playing";
+        color = TH_PLAYING;
+    }
+    if (!changed(_drawn.state, sizeof(_drawn.state), text)) return;
+
+    display_damage(0, STATE_Y, TH_DISPLAY_W, STATE_H);
+    gfx->fillRect(0, STATE_Y, TH_DISPLAY_W, STATE_H, TH_BG);
+    set_unicode_font(gfx);
+    gfx->setTextColor(color);
+    gfx->setCursor(TEXT_X, STATE_Y + 18);
+    gfx->print(text);
+    clear_unicode_font(gfx);
+}
+
+// Up to two initials, from the words of an ASCII name; "" for other scripts
+static void initials_of(const char* name, char out[3]) {
+    int n = 0;
+    bool word_start = true;
+    for (const char* p = name; *p && n < 2; p++) {
+        bool alnum = isascii((unsigned char)*p) && isalnum((unsigned char)*p);
+        if (alnum && word_start) out[n++] = toupper((unsigned char)*p);
+        word_start = !alnum && *p != '\'';
+    }
+    out[n] = '\0';
+}
+
+static void draw_note(Arduino_GFX* gfx, int cx, int cy, uint16_t c) {
+    gfx->fillCircle(cx - 8, cy + 22, 14, c);
+    gfx->fillRect(cx + 2, cy - 34, 5, 56, c);
+    gfx->fillTriangle(cx + 7, cy - 34, cx + 7, cy - 14, cx + 26, cy - 20, c);
+}
+
+static void draw_art(Arduino_GFX* gfx, const char* station) {
+    display_damage(ART_X, ART_Y, ART_SIZE, ART_SIZE);
+    gfx->fillRect(ART_X, ART_Y, ART_SIZE, ART_SIZE, TH_BG);
+    int cx = ART_X + ART_SIZE / 2;
+    int cy = ART_Y + ART_SIZE / 2;
+    if (!station[0]) {
+        gfx->fillRoundRect(ART_X, ART_Y, ART_SIZE, ART_SIZE, 2 * TH_CORNER_R, TH_CARD);
+        draw_note(gfx, cx, cy, TH_TEXT_DIM);
+        return;
+    }
+    if (artwork_draw(gfx, ART_X, ART_Y)) return;
+
+    uint32_t h = fnv1a_str(station);
+    uint16_t bg = ART_COLORS[h % (sizeof(ART_COLORS) / sizeof(ART_COLORS[0]))];
+    gfx->fillRoundRect(ART_X, ART_Y, ART_SIZE, ART_SIZE, 2 * TH_CORNER_R, bg);
+
+    char initials[3];
+    initials_of(station, initials);
+    if (!initials[0]) {
+        draw_note(gfx, cx, cy, TH_TEXT);
+        return;
+    }
+    int16_t x1, y1;
+    uint16_t w, th;
+    gfx->setFont(&FreeSansBold10pt7b);
+    gfx->setTextSize(3);
+    gfx->getTextBounds(initials, 0, 0, &x1, &y1, &w, &th);
+    gfx->setTextColor(TH_TEXT);
+    gfx->setCursor(cx - w / 2 - x1, cy - th / 2 - y1);
+    gfx->print(initials);
+    gfx->setTextSize(1);
+    gfx->setFont((const GFXfont*)nullptr);
+}
+
+static void draw_station(Arduino_GFX* gfx, UIState* state) {
+    const char* station = state->get_is_playing() ? state->get_station_name() : "";
+    uint32_t art_gen = artwork_generation();
+    bool art_changed = !_drawn.valid || art_gen != _drawn.art_gen;
+    _drawn.art_gen = art_gen;
+    if (changed(_drawn.station, sizeof(_drawn.station), station)) {
+        draw_art(gfx, station);
+        draw_line(gfx, NAME_Y, station, TH_TEXT);
+    } else if (art_changed) {
+        draw_art(gfx, station);   // Artwork arrived for the same station
+    }
+}
+
+static void draw_place(Arduino_GFX* gfx, UIState* state) {
+    char place[sizeof(_drawn.place)] = "";
+    if (state->get_is_playing()) {
+        int total = state->get_station_total();
+        if (total > 0) {
+            snprintf(place, sizeof(place), "%s, %s  %d/%d", state->get_location(),
+                     state->get_country(), state->get_station_index(), total);
+        } else {
+            snprintf(place, sizeof(place), "%s", state->get_location());
+        }
+    }
+    if (!changed(_drawn.place, sizeof(_drawn.place), place)) return;
+    draw_line(gfx, PLACE_Y, place, TH_TEXT_SEC);
+}
+
+// ------------------------------------------------------------------
+// Title marquee
+// ------------------------------------------------------------------
+
+static bool ensure_strip() {
+    if (_strip) return true;
+    if (_strip_unavailable) return false;
+    if (psramFound()) {
+        _strip = new Arduino_Canvas(STRIP_W, TITLE_H, nullptr);
+        if (!_strip->begin(GFX_SKIP_OUTPUT_BEGIN)) {
+            delete _strip;
+            _strip = nullptr;
+        }
+    }
+    if (!_strip) {
+        Serial.println("[NowPlaying] No PSRAM for the marquee, long titles are cut");
+        _strip_unavailable = true;
+        return false;
+    }
+    _strip->setTextWrap(false);
+    return true;
+}
+
+// Offset of the window for now; *wait_ms receives the time to the next step
+static int marquee_offset(uint32_t* wait_ms) {
+    uint32_t pass_ms = MARQUEE_PAUSE_MS + (uint32_t)_marquee.period * 1000 / MARQUEE_PX_PER_S;
+    uint32_t t = (millis() - _marquee.start_ms) % pass_ms;
+    if (t < MARQUEE_PAUSE_MS) {
+        *wait_ms = MARQUEE_PAUSE_MS - t;
+        return 0;
+    }
+    *wait_ms = 1000 / MARQUEE_PX_PER_S;
+    return (t - MARQUEE_PAUSE_MS) * MARQUEE_PX_PER_S / 1000;
+}
+
+// Copy the window at offset into the title rows, wrapping round the
+// strip's end: straight into the framebuffer, or row by row to the panel
+static void marquee_push(int offset) {
+    const uint16_t* strip = _strip->getFramebuffer();
+    uint16_t* fb = display_framebuffer();
+    Arduino_GFX* gfx = display_get_gfx();
+    int first = min(TEXT_W, _marquee.period - offset);
+    for (int r = 0; r < TITLE_H; r++) {
+        const uint16_t* src = strip + r * STRIP_W;
+        if (fb) {
+            uint16_t* out = fb + (TITLE_Y + r) * TH_DISPLAY_W + TEXT_X;
+            memcpy(out, src + offset, first * sizeof(uint16_t));
+            if (first < TEXT_W) memcpy(out + first, src, (TEXT_W - first) * sizeof(uint16_t));
+        } else {
+            gfx->draw16bitRGBBitmap(TEXT_X, TITLE_Y + r, (uint16_t*)src + offset, first, 1);
+            if (first < TEXT_W) {
+                gfx->draw16bitRGBBitmap(TEXT_X + first, TITLE_Y + r, (uint16_t*)src,
+                                        TEXT_W - first, 1);
+            }
+        }
+    }
+    _marquee.shown = offset;
+    display_damage(TEXT_X, TITLE_Y, TEXT_W, TITLE_H);
+}
+
+// The title on its line: scrolling if it is too wide (and can scroll),
+// else fitted and centred
+static void draw_title(Arduino_GFX* gfx, UIState* state) {
+    char title[sizeof(_drawn.title)] = "";
+    uint16_t color = TH_TEXT;
+    if (state->get_is_playing()) {
+        const char* t = state->get_wiim_title();
+        const char* artist = state->get_wiim_artist();
+        if (t[0] && artist[0]) snprintf(title, sizeof(title), "%s - %s", artist, t);
+        else snprintf(title, sizeof(title), "%s", t);
+    } else {
+        snprintf(title, sizeof(title), "Touch the wall map to play");
+        color = TH_TEXT_SEC;
+    }
+    if (!changed(_drawn.title, sizeof(_drawn.title), title)) return;
+
+    int w = text_layout_width(title);
+    _marquee.active = false;
+    if (w <= TEXT_W || w + MARQUEE_GAP > STRIP_W || !ensure_strip()) {
+        draw_line(gfx, TITLE_Y, title, color);
+        return;
+    }
+    _strip->fillScreen(TH_BG);
+    _strip->setFont(TH_FONT_UNICODE);
+    _strip->setFontIndex(TH_FONT_UNICODE_INDEX);
+    _strip->setUTF8Print(true);
+    _strip->setTextColor(color);
+    _strip->setCursor(0, TITLE_BASELINE);
+    _strip->print(title);
+
+    _marquee.period = w + MARQUEE_GAP;
+    _marquee.start_ms = millis();
+    _marquee.active = true;
+    gfx->fillRect(0, TITLE_Y, TH_DISPLAY_W, LINE_H, TH_BG);
+    marquee_push(0);
+    loop_events_due_in(MARQUEE_PAUSE_MS);
+}
+
+// ------------------------------------------------------------------
+// Volume arc
+// ------------------------------------------------------------------
+
+static float arc_angle(int volume) {
+    return ARC_START + ARC_SWEEP * volume / 100.0f;
+}
+
+// Only the part of the ring between the old and new level is filled again
+static void draw_volume(Arduino_GFX* gfx, UIState* state) {
+    int vol = constrain(state->get_volume(), 0, 100);
+    if (_drawn.valid && _drawn.volume == vol) return;
+    int old = _drawn.valid ? _drawn.volume : -1;
+    _drawn.volume = vol;
+    display_damage(ARC_CX - ARC_R, ARC_CY - ARC_R, 2 * ARC_R + 1, 2 * ARC_R + 1);
+
+    int r_in = ARC_R - ARC_THICK;
+    if (old < 0) {
+        gfx->fillArc(ARC_CX, ARC_CY, ARC_R, r_in, ARC_START, ARC_START + ARC_SWEEP, TH_CARD);
+        old = 0;
+    }
+    if (vol > old) {
+        gfx->fillArc(ARC_CX, ARC_CY, ARC_R, r_in, arc_angle(old), arc_angle(vol), TH_ACCENT);
+    } else if (vol < old) {
+        gfx->fillArc(ARC_CX, ARC_CY, ARC_R, r_in, arc_angle(vol), arc_angle(old), TH_CARD);
+    }
+
+    // Level in the middle, "VOL" under it
+    char text[8];
+    snprintf(text, sizeof(text), "%d%%", vol);
+    int16_t x1, y1;
+    uint16_t w, th;
+    int box = 2 * r_in - 16;
+    gfx->fillRect(ARC_CX - box / 2, ARC_CY - box / 2, box, box, TH_BG);
+    gfx->setFont(&FreeSansBold10pt7b);
+    gfx->setTextSize(1);
+    gfx->getTextBounds(text, 0, 0, &x1, &y1, &w, &th);
+    gfx->setTextColor(TH_TEXT);
+    gfx->setCursor(ARC_CX - w / 2 - x1, ARC_CY - th / 2 - y1);
+    gfx->print(text);
+    gfx->setFont((const GFXfont*)nullptr);
+    gfx->setTextColor(TH_TEXT_DIM);
+    gfx->setCursor(ARC_CX - 9, ARC_CY + 16);
+    gfx->print("VOL");
+}
+
+// ------------------------------------------------------------------
+// Scene
+// ------------------------------------------------------------------
+
+void now_playing_show(UIState* state) {
+    Arduino_GFX* gfx = display_get_gfx();
+    if (!gfx || !state) return;
+    _drawn.valid = false;
+    now_playing_update(state);
+}
+
+void now_playing_update(UIState* state) {
+    Arduino_GFX* gfx = display_get_gfx();
+    if (!gfx || !state) return;
+    if (!_drawn.valid) {
+        // Every layer below draws, over a cleared screen
+        gfx->fillScreen(TH_BG);
+        display_damage(0, 0, TH_DISPLAY_W, TH_DISPLAY_H);
+        _marquee.active = false;
+    }
+    draw_state(gfx, state);
+    draw_station(gfx, state);
+    draw_place(gfx, state);
+    draw_title(gfx, state);
+    draw_volume(gfx, state);
+    _drawn.valid = true;
+}
+
+void now_playing_hide() {
+    _drawn.valid = false;
+    _marquee.active = false;
+}
+
+void now_playing_step(bool lit) {
+    if (_drawn.valid && _drawn.art_gen != artwork_generation()) {
+        display_invalidate(DISPLAY_PART_STATUS);
+    }
+    if (!_marquee.active || !lit) return;
+    uint32_t wait_ms;
+    int offset = marquee_offset(&wait_ms);
+    if (offset != _marquee.shown) {
+        marquee_push(offset);
+        display_flush();
+    }
+    loop_events_due_in(wait_ms);
+}
@@ -0,0 +1,45 @@
+/**
+ * Now Playing display for RadioWall (Prototype 2, USE_BUILTIN_TOUCH 0).
+ *
+ * With the USB touch overlay on the printed wall map, the map is on the
+ * wall and the panel only needs to say what is playing. This scene takes
+ * the map view's place: the station's artwork (artwork.h), or until it
+ * has some a placeholder (its initials on a colour of its own), the
+ * station and its place, the WiiM track title and a volume arc. It never
+ * draws the map, so the slice cache, the tile pyramid, the vector map and
+ * the city dots are never loaded into PSRAM, and boot skips the first map
+ * decode.
+ *
+ * Each layer remembers what it last drew and is drawn again, and declared
+ * to the display, only when that changes. A title wider than its line is
+ * rendered once into a strip in PSRAM, and each marquee step copies a
+ * window of it into the framebuffer rows with no text drawn. The marquee
+ * only moves while the panel is fully lit, so a dimmed panel leaves the
+ * loop asleep.
+ *
+ * Called by the display module in place of the map view (display.cpp);
+ * loop task only.
+ */
+
+#ifndef NOW_PLAYING_H
+#define NOW_PLAYING_H
+
+#include <Arduino.h>
+
+class UIState;
+
+// Draw the whole scene
+void now_playing_show(UIState* state);
+
+// Draw the layers that changed since the last call
+void now_playing_update(UIState* state);
+
+// Another view replaced the scene: stop the marquee, and draw it all on
+// the next show or update
+void now_playing_hide();
+
+// Advance the title marquee and pick up new artwork (display_loop); lit
+// is false while dimmed or off
+void now_playing_step(bool lit);
+
+#endif // NOW_PLAYING_H
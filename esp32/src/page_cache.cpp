@@ -0,0 +1,91 @@
+/**
+ * Cached page renders implementation for RadioWall.
+ */
+
+#include "page_cache.h"
+#include "display.h"
+#include "theme.h"
+
+// Runs are (length, colour) pairs over the page's rows taken as one span:
+// the pages are full width, so the rows are contiguous in the framebuffer
+struct PageCopy {
+    uint16_t* runs;
+    uint32_t run_count;
+    uint32_t key;
+    int16_t y, h;
+};
+
+static const uint32_t MIN_RATIO = 4;   // Pixels per 16-bit word kept, at least
+
+static PageCopy _copies[PAGE_CACHE_COUNT];
+
+uint32_t page_cache_key(uint32_t key, const void* data, size_t len) {
+    return fnv1a_bytes(data, len, key);
+}
+
+uint32_t page_cache_key(uint32_t key, const char* text) {
+    return page_cache_key(key, text, strlen(text) + 1);
+}
+
+bool page_cache_draw(PageCacheId id, uint32_t key) {
+    PageCopy& c = _copies[id];
+    uint16_t* fb = display_framebuffer();
+    if (!fb || !c.runs || c.key != key) return false;
+
+    uint16_t* out = fb + (int32_t)c.y * TH_DISPLAY_W;
+    const uint16_t* run = c.runs;
+    for (uint32_t i = 0; i < c.run_count; i++, run += 2) {
+        uint16_t color = run[1];
+        for (uint16_t n = run[0]; n; n--) *out++ = color;
+    }
+    display_damage(0, c.y, TH_DISPLAY_W, c.h);
+    return true;
+}
+
+// Runs needed for pixels, or 0 once past max
+static uint32_t count_runs(const uint16_t* px, uint32_t pixels, uint32_t max) {
+    uint32_t runs = 0;
+    uint32_t i = 0;
+    while (i < pixels) {
+        if (++runs > max) return 0;
+        uint16_t color = px[i];
+        uint32_t end = min(pixels, i + 0xFFFF);
+        while (++i < end && px[i] == color) {}
+    }
+    return runs;
+}
+
+void page_cache_store(PageCacheId id, uint32_t key, int y, int h) {
+    PageCopy& c = _copies[id];
+    uint16_t* fb = display_framebuffer();
+    if (!fb || !psramFound()) return;
+
+    const uint16_t* px = fb + (int32_t)y * TH_DISPLAY_W;
+    uint32_t pixels = (uint32_t)TH_DISPLAY_W * h;
+
+    // Each run is two words
+    uint32_t runs = count_runs(px, pixels, pixels / MIN_RATIO / 2);
+    free(c.runs);
+    c.runs = nullptr;
+    if (!runs) {
+        Serial.printf("[PageCache] Page %d does not compress, not kept\n", id);
+        return;
+    }
+    c.runs = (uint16_t*)ps_malloc(runs * 2 * sizeof(uint16_t));
+    if (!c.runs) return;
+
+    uint16_t* run = c.runs;
+    uint32_t i = 0;
+    while (i < pixels) {
+        uint16_t color = px[i];
+        uint32_t start = i;
+        uint32_t end = min(pixels, i + 0xFFFF);
+        while (++i < end && px[i] == color) {}
+        *run++ = (uint16_t)(i - start);
+        *run++ = color;
+    }
+    c.run_count = runs;
+    c.key = key;
+    c.y = y;
+    c.h = h;
+}
@@ -0,0 +1,43 @@
+/**
+ * Cached renders of the static pages for RadioWall.
+ *
+ * The menu, the settings list and the WiFi info page draw the same round
+ * rects, icons and font glyphs every time they are opened. After a page
+ * is drawn into the framebuffer its rows are kept run-length encoded in
+ * PSRAM, under a key made from everything the page shows; opening it
+ * again with the same key writes the runs back into the framebuffer with
+ * no drawing at all. A different key (a toggled setting, another IP) draws
+ * the page as before and replaces its copy.
+ *
+ * Pages that would not compress at least 4:1 are not kept. Without a
+ * framebuffer or PSRAM nothing is cached and every page is drawn.
+ *
+ * Loop task only.
+ */
+
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <Arduino.h>
+#include "fnv1a.h"
+
+enum PageCacheId {
+    PAGE_CACHE_MENU,
+    PAGE_CACHE_SETTINGS,
+    PAGE_CACHE_WIFI,
+    PAGE_CACHE_COUNT
+};
+
+// Fold len bytes into a key (FNV-1a); start from PAGE_CACHE_KEY_SEED
+static const uint32_t PAGE_CACHE_KEY_SEED = FNV1A_SEED;
+uint32_t page_cache_key(uint32_t key, const void* data, size_t len);
+uint32_t page_cache_key(uint32_t key, const char* text);
+
+// Put page id's rows back if its copy has this key, and declare them to
+// the display. False: nothing cached for the key, draw the page.
+bool page_cache_draw(PageCacheId id, uint32_t key);
+
+// Keep framebuffer rows y..y+h-1 (full width) as page id's copy for key
+void page_cache_store(PageCacheId id, uint32_t key, int y, int h);
+
+#endif // PAGE_CACHE_H
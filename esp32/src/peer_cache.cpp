@@ -0,0 +1,382 @@
+/**
+ * Peer station cache implementation for RadioWall.
+ *
+ * One task on core 0 (next to the network worker) listens on
+ * PEER_CACHE_PORT and browses mDNS for the other frames every few minutes.
+ * Replies are copied out of radio_client's and stream_cache's tables
+ * through their any-task getters, so the server never waits on the worker.
+ * Lookups are one-shot WiFiClient connections from the worker with short
+ * timeouts; a peer that does not answer is skipped for a minute.
+ */
+
+#include "peer_cache.h"
+#include "config.h"
+#include "serial_cmd.h"
+
+#ifdef PEER_CACHE_PORT
+
+#include "radio_client.h"
+#include "stream_cache.h"
+#include "metrics.h"
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const char PEER_MAGIC[4] = {'R', 'W', 'P', '1'};
+static const uint32_t TASK_STACK = 4096;
+static const UBaseType_t TASK_PRIORITY = 1;
+static const BaseType_t TASK_CORE = 0;
+static const unsigned long TASK_POLL_MS = 20;
+static const unsigned long BROWSE_MS = 5UL * 60 * 1000;    // Peers come and go rarely
+static const unsigned long BROWSE_EMPTY_MS = 60UL * 1000;  // Until one is found
+static const unsigned long CONNECT_TIMEOUT_MS = 150;       // LAN: a live peer answers in ms
+static const unsigned long REPLY_TIMEOUT_MS = 300;
+static const unsigned long PEER_BACKOFF_MS = 60UL * 1000;  // After a peer failed to answer
+
+struct Peer {
+    uint32_t ip;
+    uint16_t port;
+    unsigned long skip_until;   // millis(); 0 = ask
+    uint32_t hits;
+};
+
+static TaskHandle_t _task = nullptr;
+static WiFiServer* _server = nullptr;
+static StationRecord* _records = nullptr;   // Server reply buffer (PEER_MAX_STATIONS)
+
+// Found by the browse (task), used and backed off by the worker
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static Peer _peers[PEER_MAX_PEERS];
+static int _peer_count = 0;
+static volatile bool _browse_now = true;
+
+// Counters (each written by one task)
+static uint32_t _lookups = 0;
+static uint32_t _lookup_hits = 0;
+static uint32_t _served = 0;
+static uint32_t _served_hits = 0;
+
+// Read exactly len bytes before the deadline
+static bool read_exact(WiFiClient& client, void* buf, size_t len, unsigned long timeout_ms) {
+    uint8_t* p = (uint8_t*)buf;
+    size_t got = 0;
+    unsigned long start = millis();
+    while (got < len) {
+        if (millis() - start > timeout_ms) return false;
+        int avail = client.available();
+        if (avail > 0) {
+            got += client.read(p + got, min((size_t)avail, len - got));
+        } else if (!client.connected()) {
+            return false;
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(2));
+        }
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Server
+// ------------------------------------------------------------------
+
+static void serve(WiFiClient& client) {
+    PeerRequest req;
+    if (!read_exact(client, &req, sizeof(req), REPLY_TIMEOUT_MS) ||
+        memcmp(req.magic, PEER_MAGIC, sizeof(PEER_MAGIC)) != 0) {
+        client.stop();
+        return;
+    }
+    _served++;
+
+    PeerReplyHeader hdr = {};
+    const uint8_t* payload = nullptr;
+    size_t payload_len = 0;
+    char url[STREAM_URL_MAX];
+
+    if (req.type == PEER_REQ_STATIONS && req.fingerprint == places_db_fingerprint()) {
+        int count, total;
+        if (radio_copy_station_list((PlaceHandle)req.place, _records, PEER_MAX_STATIONS,
+                                    &count, &total, &hdr.age_ms)) {
+            hdr.status = PEER_HIT;
+            hdr.count = count;
+            hdr.total = total;
+            payload = (const uint8_t*)_records;
+            payload_len = count * sizeof(StationRecord);
+        }
+    } else if (req.type == PEER_REQ_URL) {
+        req.station_id[sizeof(req.station_id) - 1] = '\0';
+        if (stream_cache_copy(req.station_id, url, sizeof(url))) {
+            hdr.status = PEER_HIT;
+            hdr.count = strlen(url);
+            payload = (const uint8_t*)url;
+            payload_len = hdr.count;
+        }
+    }
+
+    if (hdr.status == PEER_HIT) _served_hits++;
+    client.write((const uint8_t*)&hdr, sizeof(hdr));
+    if (payload_len) client.write(payload, payload_len);
+    client.stop();
+}
+
+// ------------------------------------------------------------------
+// Discovery
+// ------------------------------------------------------------------
+
+static void browse() {
+    int found = MDNS.queryService("radiowall", "tcp");
+    uint32_t self = (uint32_t)WiFi.localIP();
+
+    Peer peers[PEER_MAX_PEERS];
+    int count = 0;
+    for (int i = 0; i < found && count < PEER_MAX_PEERS; i++) {
+        uint32_t ip = (uint32_t)MDNS.IP(i);
+        if (ip == 0 || ip == self) continue;
+        peers[count].ip = ip;
+        peers[count].port = MDNS.port(i);
+        peers[count].skip_until = 0;
+        peers[count].hits = 0;
+        count++;
+    }
+
+    portENTER_CRITICAL(&_mux);
+    // Known peers keep their backoff and hit count
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < _peer_count; j++) {
+            if (_peers[j].ip == peers[i].ip && _peers[j].port == peers[i].port) {
+                peers[i].skip_until = _peers[j].skip_until;
+                peers[i].hits = _peers[j].hits;
+            }
+        }
+    }
+    bool changed = count != _peer_count;
+    memcpy(_peers, peers, sizeof(peers));
+    _peer_count = count;
+    portEXIT_CRITICAL(&_mux);
+
+    if (changed) Serial.printf("[Peer] %d peer(s) on the LAN\n", count);
+}
+
+static void peer_task(void*) {
+    unsigned long last_browse = 0;
+    for (;;) {
+        WiFiClient client = _server->available();
+        if (client) serve(client);
+
+        unsigned long interval = _peer_count ? BROWSE_MS : BROWSE_EMPTY_MS;
+        if (_browse_now || millis() - last_browse > interval) {
+            _browse_now = false;
+            browse();   // Blocks for the query; askers time out meanwhile
+            last_browse = millis();
+        }
+        vTaskDelay(pdMS_TO_TICKS(TASK_POLL_MS));
+    }
+}
+
+// ------------------------------------------------------------------
+// Lookups (network worker)
+// ------------------------------------------------------------------
+
+static int peers_to_ask(Peer* out) {
+    unsigned long now = millis();
+    int count = 0;
+    portENTER_CRITICAL(&_mux);
+    for (int i = 0; i < _peer_count; i++) {
+        if (_peers[i].skip_until && (long)(now - _peers[i].skip_until) < 0) continue;
+        out[count++] = _peers[i];
+    }
+    portEXIT_CRITICAL(&_mux);
+    return count;
+}
+
+// Back a silent peer off, or count a hit
+static void peer_answered(const Peer& peer, bool ok, bool hit) {
+    portENTER_CRITICAL(&_mux);
+    for (int i = 0; i < _peer_count; i++) {
+        if (_peers[i].ip != peer.ip || _peers[i].port != peer.port) continue;
+        _peers[i].skip_until = ok ? 0 : (millis() + PEER_BACKOFF_MS) | 1;
+        if (hit) _peers[i].hits++;
+    }
+    portEXIT_CRITICAL(&_mux);
+}
+
+// Send a request and read the reply header; the payload is left to read
+static bool exchange(WiFiClient& client, const Peer& peer, const PeerRequest& req,
+                     PeerReplyHeader* hdr) {
+    if (!client.connect(IPAddress(peer.ip), peer.port, CONNECT_TIMEOUT_MS)) return false;
+    client.setNoDelay(true);
+    if (client.write((const uint8_t*)&req, sizeof(req)) != sizeof(req)) return false;
+    return read_exact(client, hdr, sizeof(*hdr), REPLY_TIMEOUT_MS);
+}
+
+static void init_request(PeerRequest* req, PeerRequestType type) {
+    memset(req, 0, sizeof(*req));
+    memcpy(req->magic, PEER_MAGIC, sizeof(PEER_MAGIC));
+    req->type = type;
+    req->fingerprint = places_db_fingerprint();
+}
+
+static void count_lookup(bool hit) {
+    _lookups++;
+    if (hit) _lookup_hits++;
+    metrics_inc(hit ? METRIC_PEER_CACHE_HIT : METRIC_PEER_CACHE_MISS);
+}
+
+bool peer_cache_get_stations(PlaceHandle place, StationRecord* out, int cap,
+                             int* count, int* total, uint32_t* age_ms) {
+    Peer peers[PEER_MAX_PEERS];
+    int n = _task ? peers_to_ask(peers) : 0;
+    if (n == 0) return false;
+
+    PeerRequest req;
+    init_request(&req, PEER_REQ_STATIONS);
+    req.place = place;
+
+    for (int i = 0; i < n; i++) {
+        WiFiClient client;
+        PeerReplyHeader hdr;
+        unsigned long start = millis();
+        if (!exchange(client, peers[i], req, &hdr)) {
+            client.stop();
+            peer_answered(peers[i], false, false);
+            continue;
+        }
+        int records = min((int)hdr.count, min(cap, PEER_MAX_STATIONS));
+        bool hit = hdr.status == PEER_HIT &&
+                   read_exact(client, out, records * sizeof(StationRecord), REPLY_TIMEOUT_MS);
+        client.stop();
+        peer_answered(peers[i], true, hit);
+        if (!hit) continue;
+
+        for (int r = 0; r < records; r++) {
+            out[r].id[sizeof(out[r].id) - 1] = '\0';
+            out[r].title[sizeof(out[r].title) - 1] = '\0';
+        }
+        *count = records;
+        *total = max((int)hdr.total, records);
+        *age_ms = hdr.age_ms;
+        Serial.printf("[Peer] %d/%d stations from %s (%lu ms)\n", records, *total,
+                      IPAddress(peers[i].ip).toString().c_str(), millis() - start);
+        count_lookup(true);
+        return true;
+    }
+    count_lookup(false);
+    return false;
+}
+
+bool peer_cache_get_url(const char* station_id, String* url) {
+    Peer peers[PEER_MAX_PEERS];
+    int n = _task ? peers_to_ask(peers) : 0;
+    if (n == 0) return false;
+
+    PeerRequest req;
+    init_request(&req, PEER_REQ_URL);
+    strncpy(req.station_id, station_id, sizeof(req.station_id) - 1);
+
+    char buf[STREAM_URL_MAX];
+    for (int i = 0; i < n; i++) {
+        WiFiClient client;
+        PeerReplyHeader hdr;
+        if (!exchange(client, peers[i], req, &hdr)) {
+            client.stop();
+            peer_answered(peers[i], false, false);
+            continue;
+        }
+        bool hit = hdr.status == PEER_HIT && hdr.count > 0 && hdr.count < sizeof(buf) &&
+                   read_exact(client, buf, hdr.count, REPLY_TIMEOUT_MS);
+        client.stop();
+        peer_answered(peers[i], true, hit);
+        if (!hit) continue;
+
+        buf[hdr.count] = '\0';
+        *url = buf;
+        Serial.printf("[Peer] Stream URL from %s\n", IPAddress(peers[i].ip).toString().c_str());
+        count_lookup(true);
+        return true;
+    }
+    count_lookup(false);
+    return false;
+}
+
+// ------------------------------------------------------------------
+// Start
+// ------------------------------------------------------------------
+
+void peer_cache_start() {
+    if (_task) return;
+
+    size_t size = PEER_MAX_STATIONS * sizeof(StationRecord);
+    _records = (StationRecord*)(psramFound() ? ps_malloc(size) : malloc(size));
+    if (!_records) {
+        Serial.println("[Peer] No memory for the reply buffer");
+        return;
+    }
+    _server = new WiFiServer(PEER_CACHE_PORT);
+    _server->begin();
+
+    if (xTaskCreatePinnedToCore(peer_task, "peer_cache", TASK_STACK, nullptr,
+                                TASK_PRIORITY, &_task, TASK_CORE) != pdPASS) {
+        Serial.println("[Peer] Failed to start peer task");
+        delete _server;
+        _server = nullptr;
+        free(_records);
+        _records = nullptr;
+        _task = nullptr;
+        return;
+    }
+    MDNS.addService("radiowall", "tcp", PEER_CACHE_PORT);
+    Serial.printf("[Peer] Sharing caches on port %d\n", PEER_CACHE_PORT);
+}
+
+#else
+
+void peer_cache_start() {}
+
+bool peer_cache_get_stations(PlaceHandle, StationRecord*, int, int*, int*, uint32_t*) {
+    return false;
+}
+
+bool peer_cache_get_url(const char*, String*) {
+    return false;
+}
+
+#endif // PEER_CACHE_PORT
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+// PEERS - Peers found, lookups, requests served (and browse again)
+static void cmd_peers(const char*) {
+#ifdef PEER_CACHE_PORT
+    if (!_task) {
+        Serial.println("[Peer] Not started (no WiFi yet)");
+        return;
+    }
+    Peer peers[PEER_MAX_PEERS];
+    portENTER_CRITICAL(&_mux);
+    int count = _peer_count;
+    memcpy(peers, _peers, sizeof(peers));
+    portEXIT_CRITICAL(&_mux);
+
+    unsigned long now = millis();
+    for (int i = 0; i < count; i++) {
+        bool skipped = peers[i].skip_until && (long)(now - peers[i].skip_until) < 0;
+        Serial.printf("[Peer] %s:%u  %lu hit(s)%s\n", IPAddress(peers[i].ip).toString().c_str(),
+                      peers[i].port, (unsigned long)peers[i].hits,
+                      skipped ? ", not answering" : "");
+    }
+    Serial.printf("[Peer] %d peer(s); asked %lu time(s), %lu hit(s); served %lu, %lu hit(s)\n",
+                  count, (unsigned long)_lookups, (unsigned long)_lookup_hits,
+                  (unsigned long)_served, (unsigned long)_served_hits);
+    _browse_now = true;
+    Serial.println("[Peer] Browsing again");
+#else
+    Serial.println("[Peer] Not configured (set PEER_CACHE_PORT in config.h)");
+#endif
+}
+
+void peer_cache_serial_init() {
+    serial_cmd_register("PEERS", cmd_peers);
+}
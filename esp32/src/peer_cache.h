@@ -0,0 +1,86 @@
+/**
+ * Peer station cache for RadioWall (opt-in: PEER_CACHE_PORT in config.h).
+ *
+ * Frames on the same LAN share what they already fetched from
+ * Radio.garden. Each one advertises _radiowall._tcp over mDNS and answers
+ * small binary requests on PEER_CACHE_PORT from its own caches: a place's
+ * station list (radio_client's LRU) and a station's resolved stream URL
+ * (stream_cache). Before going upstream, radio_client asks the peers found
+ * by the last mDNS browse; a miss or a silent peer costs a few LAN round
+ * trips at most, then the request goes to Radio.garden as before.
+ *
+ * Protocol: one request per TCP connection, fixed little-endian structs
+ * (both ends are ESP32s built from this header).
+ *
+ *   PeerRequest      32 bytes, magic "RWP1"
+ *   PeerReplyHeader  12 bytes, then count StationRecords (stations) or
+ *                    count URL bytes (no terminator)
+ *
+ * Station lists are keyed by PlaceHandle, which is only meaningful with
+ * the same places.bin: requests carry places_db_fingerprint() and a peer
+ * with other data answers a miss. Lists come with their age so the asker
+ * keeps the original fetch time (and TTL); lists longer than
+ * PEER_MAX_STATIONS are cut and marked partial, so the prefetcher fetches
+ * the rest upstream while the first stations play.
+ *
+ * The server and the mDNS browse run on their own task; the lookups run
+ * on the network worker, inside the play request that needs them.
+ */
+
+#ifndef PEER_CACHE_H
+#define PEER_CACHE_H
+
+#include <Arduino.h>
+#include "places_db.h"
+#include "station_catalog.h"
+
+static const int PEER_MAX_STATIONS = 100;   // Records per reply
+static const int PEER_MAX_PEERS = 4;
+
+enum PeerRequestType : uint8_t {
+    PEER_REQ_STATIONS = 1,   // PeerRequest.place
+    PEER_REQ_URL = 2,        // PeerRequest.station_id
+};
+
+enum PeerReplyStatus : uint8_t {
+    PEER_MISS = 0,
+    PEER_HIT = 1,
+};
+
+struct PeerRequest {
+    char magic[4];           // "RWP1"
+    uint8_t type;            // PeerRequestType
+    uint8_t reserved[3];
+    uint32_t fingerprint;    // places_db_fingerprint() of the asker
+    uint32_t place;          // PEER_REQ_STATIONS
+    char station_id[16];     // PEER_REQ_URL
+};
+
+struct PeerReplyHeader {
+    uint8_t status;          // PeerReplyStatus
+    uint8_t reserved;
+    uint16_t count;          // Records or URL bytes that follow
+    uint16_t total;          // Stations the peer has for the place
+    uint16_t reserved2;
+    uint32_t age_ms;         // Since the peer fetched the list
+};
+
+static_assert(sizeof(PeerRequest) == 32, "PeerRequest is the wire format");
+static_assert(sizeof(PeerReplyHeader) == 12, "PeerReplyHeader is the wire format");
+
+// Start the server task and advertise _radiowall._tcp (once WiFi and mDNS
+// are up; later calls do nothing). Without PEER_CACHE_PORT it does nothing.
+void peer_cache_start();
+
+// Ask the peers for a place's station list (network worker). On a hit,
+// fills out (up to cap), count, the peer's total and the list's age in ms.
+bool peer_cache_get_stations(PlaceHandle place, StationRecord* out, int cap,
+                             int* count, int* total, uint32_t* age_ms);
+
+// Ask the peers for a station's resolved stream URL (network worker)
+bool peer_cache_get_url(const char* station_id, String* url);
+
+// Register the PEERS serial command (peers found, hits, requests served)
+void peer_cache_serial_init();
+
+#endif // PEER_CACHE_H
@@ -0,0 +1,148 @@
+/**
+ * Performance HUD implementation for RadioWall.
+ *
+ * Everything here runs on the loop task: the frame hooks come from the
+ * display's frames, the pass bounds from loop(). Figures are collected over
+ * one-second windows and the box shows the last complete one.
+ */
+
+#include "perf_hud.h"
+#include "display.h"
+#include "loop_events.h"
+#include "serial_cmd.h"
+#include "trace.h"
+#include <esp_heap_caps.h>
+
+static const uint32_t WINDOW_MS = 1000;
+static const int PHASES_SHOWN = 4;
+
+// Two letters per phase, to fit two to a line
+static const char* const PHASE_ABBR[TRACE_PHASE_COUNT] = {
+    "tp", "lk", "tl", "ch", "js", "rd", "pr", "pl", "fp",
+};
+
+#ifdef PERF_HUD
+static bool _enabled = true;
+#else
+static bool _enabled = false;
+#endif
+
+// Current window
+static unsigned long _window_start = 0;
+static uint32_t _frames = 0;
+static uint32_t _max_pass_us = 0;
+static uint32_t _pass_start_us = 0;
+static uint32_t _pass_own_us = 0;   // The box's own cost in this pass
+
+// Last complete window
+static uint32_t _fps = 0;
+static uint32_t _lag_us = 0;
+static uint32_t _frame_us = 0;      // Last frame, whichever window
+
+bool perf_hud_enabled() {
+    return _enabled;
+}
+
+void perf_hud_set_enabled(bool on) {
+    if (on == _enabled) return;
+    _enabled = on;
+    _window_start = millis();
+    _frames = 0;
+    _max_pass_us = 0;
+    _fps = _lag_us = _frame_us = 0;
+    display_invalidate(DISPLAY_PART_HUD);   // Draws it, or erases it
+}
+
+void perf_hud_pass_begin() {
+    if (!_enabled) return;
+    _pass_start_us = micros();
+    _pass_own_us = 0;
+}
+
+void perf_hud_pass_end() {
+    if (!_enabled) return;
+    uint32_t pass_us = micros() - _pass_start_us;
+    pass_us = pass_us > _pass_own_us ? pass_us - _pass_own_us : 0;
+    if (pass_us > _max_pass_us) _max_pass_us = pass_us;
+
+    unsigned long elapsed = millis() - _window_start;
+    if (elapsed < WINDOW_MS) {
+        loop_events_due_in(WINDOW_MS - elapsed);
+        return;
+    }
+    _fps = (_frames * 1000 + elapsed / 2) / elapsed;
+    _lag_us = _max_pass_us;
+    _frames = 0;
+    _max_pass_us = 0;
+    _window_start = millis();
+    display_invalidate(DISPLAY_PART_HUD);
+    loop_events_due_in(WINDOW_MS);
+}
+
+void perf_hud_frame(uint32_t frame_us) {
+    if (!_enabled) return;
+    _frames++;
+    _frame_us = frame_us;
+}
+
+void perf_hud_own_time(uint32_t us) {
+    _pass_own_us += us;
+}
+
+// ------------------------------------------------------------------
+// Text
+// ------------------------------------------------------------------
+
+int perf_hud_lines(char lines[PERF_HUD_LINES][PERF_HUD_LINE_LEN]) {
+    int n = 0;
+    snprintf(lines[n++], PERF_HUD_LINE_LEN, "%2lufps %5.1fms",
+             (unsigned long)_fps, _frame_us / 1000.0f);
+    snprintf(lines[n++], PERF_HUD_LINE_LEN, "lag %5.1fms", _lag_us / 1000.0f);
+    snprintf(lines[n++], PERF_HUD_LINE_LEN, "h%3uK b%3uK",
+             (unsigned)(heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024),
+             (unsigned)(heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) / 1024));
+
+    uint32_t totals[TRACE_PHASE_COUNT];
+    uint32_t audio_us;
+    if (trace_last_tap(totals, &audio_us) == 0) {
+        snprintf(lines[n++], PERF_HUD_LINE_LEN, "tap -");
+        return n;
+    }
+    if (audio_us) {
+        snprintf(lines[n++], PERF_HUD_LINE_LEN, "tap %lums", (unsigned long)(audio_us / 1000));
+    } else {
+        snprintf(lines[n++], PERF_HUD_LINE_LEN, "tap ...");
+    }
+
+    // Longest phases, two to a line
+    char cell[PHASES_SHOWN][8];
+    int cells = 0;
+    for (; cells < PHASES_SHOWN; cells++) {
+        int best = -1;
+        for (int p = 0; p < TRACE_PHASE_COUNT; p++) {
+            if (totals[p] && (best < 0 || totals[p] > totals[best])) best = p;
+        }
+        if (best < 0) break;
+        snprintf(cell[cells], sizeof(cell[0]), "%s%lu", PHASE_ABBR[best],
+                 (unsigned long)min(totals[best] / 1000, (uint32_t)9999));
+        totals[best] = 0;
+    }
+    for (int i = 0; i < cells; i += 2) {
+        snprintf(lines[n++], PERF_HUD_LINE_LEN, "%-7s%s", cell[i], i + 1 < cells ? cell[i + 1] : "");
+    }
+    return n;
+}
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+// HUD - Show or hide the performance overlay
+static void cmd_hud(const char*) {
+    perf_hud_set_enabled(!_enabled);
+    Serial.printf("[HUD] %s\n", _enabled ? "On" : "Off");
+}
+
+void perf_hud_serial_init() {
+    serial_cmd_register("HUD", cmd_hud);
+}
@@ -0,0 +1,52 @@
+/**
+ * Performance HUD for RadioWall.
+ *
+ * A small box in the top-left corner of the map view with the figures
+ * that otherwise need a serial console: frames per second and the time
+ * the last one took, loop lag (the longest loop pass of the last second),
+ * free internal heap and its largest block, and the last tap's touch to
+ * audio time with its longest phases from the span tracer (trace.h).
+ *
+ * The display draws the box as a dirty region of its own: inside the
+ * frame that redraws the map under it, or alone once a second. That
+ * drawing and its flush are timed and taken out of the loop lag and the
+ * frame time it shows, and frames that only redraw the box are not
+ * counted, so turning it on leaves the numbers as they were.
+ *
+ * Off at boot unless built with -DPERF_HUD; serial "HUD" toggles it.
+ */
+
+#ifndef PERF_HUD_H
+#define PERF_HUD_H
+
+#include <Arduino.h>
+
+// The box, in screen coordinates (narrow enough to flush as drawn)
+static const int PERF_HUD_BOX_X = 0;
+static const int PERF_HUD_BOX_Y = 0;
+static const int PERF_HUD_BOX_W = 88;
+static const int PERF_HUD_BOX_H = 58;
+static const int PERF_HUD_LINES = 6;
+static const int PERF_HUD_LINE_LEN = 15;   // 14 characters of the 6 px font
+
+bool perf_hud_enabled();
+void perf_hud_set_enabled(bool on);
+
+// Loop pass bounds: first thing in loop() and after display_render(). The
+// end of a pass asks for a redraw of the box once a second.
+void perf_hud_pass_begin();
+void perf_hud_pass_end();
+
+// A frame was flushed; frame_us is its time without the box
+void perf_hud_frame(uint32_t frame_us);
+
+// Time spent drawing and flushing the box (loop task)
+void perf_hud_own_time(uint32_t us);
+
+// The box's text; returns the number of lines filled
+int perf_hud_lines(char lines[PERF_HUD_LINES][PERF_HUD_LINE_LEN]);
+
+// Register the HUD serial command
+void perf_hud_serial_init();
+
+#endif // PERF_HUD_H
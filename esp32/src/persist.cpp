@@ -0,0 +1,66 @@
+/**
+ * Write-behind persistence implementation for RadioWall.
+ *
+ * Loop task only: marks and flushes both happen there, so the table needs
+ * no locking.
+ */
+
+#include "persist.h"
+#include "loop_events.h"
+
+static const int MAX_PENDING = 8;
+static const unsigned long PERSIST_QUIET_MS = 2000;       // No marks for this long
+static const unsigned long PERSIST_MAX_DELAY_MS = 10000;  // Since the first mark
+
+static PersistFlushFn _pending[MAX_PENDING];
+static int _pending_count = 0;
+static unsigned long _first_mark_ms = 0;
+static unsigned long _last_mark_ms = 0;
+
+void persist_mark_dirty(PersistFlushFn fn) {
+    if (!fn) return;
+    unsigned long now = millis();
+    _last_mark_ms = now;
+    for (int i = 0; i < _pending_count; i++) {
+        if (_pending[i] == fn) return;
+    }
+    if (_pending_count == 0) _first_mark_ms = now;
+    if (_pending_count >= MAX_PENDING) {
+        // Table full: write synchronously rather than lose the change
+        Serial.println("[Persist] Pending table full, flushing inline");
+        fn();
+        return;
+    }
+    _pending[_pending_count++] = fn;
+}
+
+static void flush_pending() {
+    int kept = 0;
+    for (int i = 0; i < _pending_count; i++) {
+        if (!_pending[i]()) _pending[kept++] = _pending[i];
+    }
+    _pending_count = kept;
+    if (kept > 0) {
+        // Due again after another quiet period
+        Serial.printf("[Persist] %d write(s) failed, retrying\n", kept);
+        _first_mark_ms = _last_mark_ms = millis();
+    }
+}
+
+void persist_task() {
+    if (_pending_count == 0) return;
+    unsigned long now = millis();
+    unsigned long quiet = now - _last_mark_ms;
+    unsigned long waited = now - _first_mark_ms;
+    if (quiet < PERSIST_QUIET_MS && waited < PERSIST_MAX_DELAY_MS) {
+        loop_events_due_in(min(PERSIST_QUIET_MS - quiet, PERSIST_MAX_DELAY_MS - waited));
+        return;
+    }
+    flush_pending();
+    if (_pending_count > 0) loop_events_due_in(PERSIST_QUIET_MS);
+}
+
+void persist_flush_all() {
+    if (_pending_count == 0) return;
+    flush_pending();
+}
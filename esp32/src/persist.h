@@ -0,0 +1,29 @@
+/**
+ * Write-behind persistence for RadioWall.
+ *
+ * Modules keep their state in RAM and call persist_mark_dirty() with their
+ * flush function instead of writing LittleFS directly. persist_task()
+ * (from loop) runs the flush functions once things have been quiet for
+ * PERSIST_QUIET_MS, or at the latest PERSIST_MAX_DELAY_MS after the first
+ * change, so NEXT-spamming costs one write per file rather than one per
+ * station. Call persist_flush_all() before a restart or deep sleep.
+ */
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <Arduino.h>
+
+// Write the module's state to flash. Return false to retry on a later pass.
+typedef bool (*PersistFlushFn)();
+
+// Schedule fn (dedup: marking twice before a flush runs it once)
+void persist_mark_dirty(PersistFlushFn fn);
+
+// Flush due writes (call from loop)
+void persist_task();
+
+// Flush everything now
+void persist_flush_all();
+
+#endif // PERSIST_H
@@ -34,6 +34,8 @@
 #define TFT_QSPI_D3           14
 #define TFT_QSPI_RST          16
 #define TFT_BL                1
+// Panel TE output, if wired: define to sync framebuffer flushes to V-blank
+// #define TFT_TE                <gpio>
 
 #define PIN_BAT_VOLT          2
 
@@ -1,106 +1,1314 @@
 /**
  * Radio.garden places database for RadioWall.
  *
- * Loads pre-compiled places.bin from LittleFS and provides
- * nearest-place lookup for touch coordinates.
+ * Maps pre-compiled places.bin from its own flash partition (or loads it
+ * from LittleFS as a fallback) and provides nearest-place lookup for
+ * touch coordinates.
+ *
+ * places.bin v3 (see compile_places.py) is a set of tagged sections: lat
+ * and lon arrays, packed place IDs, name/country references into a shared
+ * string table, and a CELL spatial index. Places are sorted along a
+ * Hilbert curve, so every index cell is one contiguous run of places,
+ * neighbouring cells mostly sit next to each other, and a search reads a
+ * few short stretches of the coordinate arrays. Only a 1.3 KB cell
+ * occupancy bitmap is built at load time; records are decoded into a
+ * Place when asked for.
+ *
+ * Name search uses the optional FOLD, NAME, TRIX and TRIP sections: a
+ * prefix search is a binary search over the places sorted by folded name,
+ * and a fuzzy search merges the posting lists of the query's trigrams,
+ * counting how many each name shares.
+ *
+ * Country queries use the optional CPLC and CBOX sections: every
+ * country's places as one run, best first, and its bounding box.
+ *
+ * The optional VIEW section partitions the places by map slice and a
+ * fixed grid of tiles over each slice, so whatever a map view shows (the
+ * city dots) is the places of the few tiles it overlaps. Nearest-place
+ * searches keep to the CELL index: its ring walk already reads only the
+ * cells round the tap, and unlike a view it finds the nearest place when
+ * that lies off screen.
  */
 
 #include "places_db.h"
+#include "fnv1a.h"
+#include "config.h"
+#include "serial_cmd.h"
+#include "asset_fs.h"
+#include "hot_path.h"
+#include "map_layout.h"
 #include <LittleFS.h>
 #include <Arduino.h>
 #include <esp_partition.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
 
 // Database state
-static Place* _places = nullptr;      // In-memory array (PSRAM if available)
+static const uint8_t* _db = nullptr;  // Whole file (mapped or in RAM), nullptr on demand
 static uint32_t _place_count = 0;
 static bool _loaded = false;
 static File _db_file;                 // For on-demand reading if no PSRAM
 
-// For on-demand mode: temp buffer for current place
+// Record returned by places_db_find_nearest()
 static Place _current_place;
 
+// Section offsets from the start of the file
+struct DbSections {
+    uint32_t lat, lon, pid, ref, ctry, str, cell;
+    uint32_t scnt;          // Optional station counts, 0 if absent
+    uint32_t fold, name, trix, trip;    // Optional search index, 0 if absent
+    uint32_t cplc, cbox;                // Optional country runs, 0 if absent
+    uint32_t view, view_size;           // Optional view partition, 0 if absent
+    uint32_t ctry_size, str_size, cell_size;
+    uint32_t trix_size, trip_size;
+    uint32_t file_size;     // End of the last section
+};
+static DbSections _sec;
+
+// Section pointers. With the file in memory they point into _db; in
+// on-demand mode only the CELL index and the country table are held in
+// RAM, and coordinates are read per cell through the chunk buffers.
+static const int16_t* _lat = nullptr;
+static const int16_t* _lon = nullptr;
+static const uint8_t* _pid = nullptr;
+static const uint32_t* _ref = nullptr;
+static const char* _str = nullptr;
+static const uint32_t* _ctry = nullptr;
+static const PlacesCell* _cells = nullptr;   // _cell_count entries + sentinel
+static uint32_t _cell_count = 0;
+static uint32_t _ctry_count = 0;
+
+static const int FILE_CHUNK = 64;            // Coordinates per on-demand read
+static int16_t* _chunk_lat = nullptr;
+static int16_t* _chunk_lon = nullptr;
+
 // Use PSRAM if available (ESP32-S3 typically has 8MB)
 static bool _use_psram = false;
 
-bool places_db_init() {
-    Serial.println("[PlacesDB] Initializing...");
+// Cost of places_db_init(), for places_db_load_stats()
+static PlacesLoadStats _load_stats = {};
 
-    // Debug: Print partition info
-    const esp_partition_t* partition = esp_partition_find_first(
-        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, "spiffs");
+// Raw "places" partition mapped into the data address space (no copy)
+static bool _use_mmap = false;
+static spi_flash_mmap_handle_t _mmap_handle;
 
-    if (partition) {
-        Serial.printf("[PlacesDB] Found partition: offset=0x%x, size=%d KB\n",
-                      partition->address, partition->size / 1024);
-    } else {
-        Serial.println("[PlacesDB] WARNING: 'spiffs' partition not found in partition table!");
-        Serial.println("[PlacesDB] Available partitions:");
-        esp_partition_iterator_t it = esp_partition_find(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, NULL);
-        while (it) {
-            const esp_partition_t* p = esp_partition_get(it);
-            Serial.printf("[PlacesDB]   - %s: type=%d, subtype=%d, offset=0x%x, size=%dKB\n",
-                          p->label, p->type, p->subtype, p->address, p->size/1024);
-            it = esp_partition_next(it);
+// Index cell geometry, from the header's cell shift. Coordinates are
+// x = lon_x100 + 18000 (mod 36000) and y = lat_x100 + 9000; a cell's ID is
+// the Hilbert index of (x >> shift, y >> shift) on a 2^(16 - shift) grid.
+// 36000 is not a multiple of the cell size, so the last column is narrower
+// by _wrap_short.
+static int _cell_shift = 8;
+static int32_t _cell_size = 256;
+static int _grid_cols = 0;
+static int _grid_rows = 0;
+static int32_t _wrap_short = 0;
+
+// One bit per (col, row) index cell: set if the cell has places. Built at
+// load so the ring walk skips empty cells (most of the map is sea) without
+// a CELL lookup.
+static uint32_t* _occupied = nullptr;
+
+// One bit per place: set if places.bin's SCNT section lists no stations
+// for it. Searches skip those; nullptr if the file has no counts.
+static uint32_t* _no_stations = nullptr;
+static uint32_t _no_stations_count = 0;
+
+// FNV-1a over the PID section: identifies this places.bin to files keyed
+// by place handle (stations.bin)
+static uint32_t _fingerprint = 0;
+
+// Name search: FOLD table copied at load; false without the sections
+static const int FOLD_COUNT = PLACES_FOLD_LAST - PLACES_FOLD_FIRST + 1;
+static uint8_t _fold[FOLD_COUNT];
+static bool _search = false;
+static bool _fuzzy = false;            // TRIX and TRIP present too
+static uint32_t _gram_count = 0;       // TRIX entries less the sentinel
+
+// Country queries: false without CPLC and CBOX
+static bool _countries = false;
+
+// View partition (VIEW): tiles per slice across and down, 0 without it
+static PlacesView _view = {0, 0, 0, 0};
+static uint32_t _view_tiles = 0;
+
+static const char BASE64URL[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// ------------------------------------------------------------------
+// Geometry
+// ------------------------------------------------------------------
+
+static inline int cell_col(int16_t lon_x100) {
+    int x = ((lon_x100 + 18000) % 36000 + 36000) % 36000;
+    return x >> _cell_shift;
+}
+
+static inline int cell_row(int16_t lat_x100) {
+    int y = constrain(lat_x100 + 9000, 0, 18000);
+    return y >> _cell_shift;
+}
+
+// Hilbert curve step: [state << 2 | col bit << 1 | row bit] gives the next
+// two index bits << 2 | next state. A state records whether the current
+// quadrant is mirrored (bit 0) and transposed (bit 1).
+static const uint8_t HILBERT_STEP[16] = {
+    2, 4, 15, 8, 9, 14, 5, 3, 0, 13, 6, 10, 11, 7, 12, 1
+};
+
+// Position of the cell along the Hilbert curve (hilbert_index() in
+// compile_places.py). The coarse grid is at most 256 cells a side, and
+// (255, 0), whose index is the 0xFFFF sentinel, lies outside the map.
+static uint16_t cell_id(int col, int row) {
+    uint32_t d = 0;
+    uint8_t state = 0;
+    for (int bit = 15 - _cell_shift; bit >= 0; bit--) {
+        uint8_t e = HILBERT_STEP[state << 2 | ((col >> bit) & 1) << 1 | ((row >> bit) & 1)];
+        d = d << 2 | e >> 2;
+        state = e & 3;
+    }
+    return (uint16_t)d;
+}
+
+// Place range of a cell; false if the cell is empty
+static bool cell_range(uint16_t id, uint32_t* first, uint32_t* end) {
+    uint32_t lo = 0, hi = _cell_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (_cells[mid].cell < id) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo >= _cell_count || _cells[lo].cell != id) return false;
+    *first = _cells[lo].first;
+    *end = _cells[lo + 1].first;
+    return true;
+}
+
+static inline bool place_skipped(uint32_t i) {
+    return _no_stations && ((_no_stations[i >> 5] >> (i & 31)) & 1);
+}
+
+static inline bool cell_occupied(int col, int row) {
+    if (!_occupied) return true;
+    uint32_t bit = (uint32_t)row * _grid_cols + col;
+    return (_occupied[bit >> 5] >> (bit & 31)) & 1;
+}
+
+static void build_occupancy() {
+    uint32_t bits = (uint32_t)_grid_cols * _grid_rows;
+    _occupied = (uint32_t*)calloc((bits + 31) / 32, sizeof(uint32_t));
+    if (!_occupied) return;
+    uint32_t first, end;
+    for (int row = 0; row < _grid_rows; row++) {
+        for (int col = 0; col < _grid_cols; col++) {
+            if (cell_range(cell_id(col, row), &first, &end)) {
+                uint32_t bit = (uint32_t)row * _grid_cols + col;
+                _occupied[bit >> 5] |= 1UL << (bit & 31);
+            }
         }
     }
+}
 
-    // Mount LittleFS
-    if (!LittleFS.begin(false)) {
-        Serial.println("[PlacesDB] ERROR: Failed to mount LittleFS");
-        Serial.println("[PlacesDB] Trying to format...");
-        if (LittleFS.format() && LittleFS.begin(false)) {
-            Serial.println("[PlacesDB] Formatted successfully, but places.bin is now gone!");
-            Serial.println("[PlacesDB] Run 'pio run -t uploadfs' to re-upload places.bin");
-        } else {
-            Serial.println("[PlacesDB] Format failed - partition table may be wrong");
+static const float RAD_PER_X100 = (float)M_PI / 18000.0f;
+static const float EARTH_RADIUS_KM = 6371.0f;
+
+// sin() in Q15 per 2^SIN_SHIFT hundredths of a degree (0.08 deg) over
+// 0..90 deg, filled by places_db_init(). Values are rounded down and taken
+// at the low end of a bucket, so sin_floor() and cos_floor() never exceed
+// the true value.
+static const int SIN_SHIFT = 3;
+static const int SIN_STEPS = 9000 >> SIN_SHIFT;
+static uint16_t _sin_q15[SIN_STEPS + 1];
+
+static void init_sin_table() {
+    for (int i = 0; i <= SIN_STEPS; i++) {
+        _sin_q15[i] = (uint16_t)(sinf((i << SIN_SHIFT) * RAD_PER_X100) * 32767.0f);
+    }
+}
+
+// Lower bounds of sin and cos, angle in hundredths of a degree (0..9000)
+static inline uint32_t sin_floor(int32_t x100) { return _sin_q15[x100 >> SIN_SHIFT]; }
+static inline uint32_t cos_floor(int32_t x100) { return _sin_q15[(9000 - x100) >> SIN_SHIFT]; }
+
+// Query point with its precomputed distance terms
+struct SearchTarget {
+    int16_t lat, lon;       // Degrees * 100
+    int32_t abs_lat;
+    uint32_t cos_q15;       // cos_floor(|lat|)
+    int col_stretch;        // Index columns per row at this latitude (>= 1/cos)
+    float lat_rad, lon_rad, cos_lat;
+};
+
+static SearchTarget make_target(float lat, float lon) {
+    SearchTarget t;
+    t.lat = (int16_t)(lat * 100);
+    t.lon = (int16_t)(lon * 100);
+    t.abs_lat = min(abs(t.lat), 9000);
+    t.cos_q15 = cos_floor(t.abs_lat);
+    t.lat_rad = t.lat * RAD_PER_X100;
+    t.lon_rad = t.lon * RAD_PER_X100;
+    t.cos_lat = cosf(t.lat_rad);
+    // Capped at 64 (cos 89.1 deg) so the rings stay bounded at the poles
+    uint32_t w = max(t.cos_q15, (uint32_t)512);
+    t.col_stretch = (32768 + w - 1) / w;
+    return t;
+}
+
+/**
+ * Pre-filter: the haversine term (see hav_dist()) in Q30, computed from
+ * the rounded-down tables, so it never exceeds the exact value. Integer
+ * only; the search runs hav_dist() just for places this lets through.
+ */
+static inline uint32_t place_lower_bound(int16_t lat, int16_t lon, const SearchTarget& t) {
+    int32_t dlat = abs(lat - t.lat);
+    int32_t dlon = abs(lon - t.lon);
+    if (dlon > 18000) dlon = 36000 - dlon;
+    uint32_t sl = sin_floor(dlat >> 1);
+    uint32_t so = sin_floor(dlon >> 1);
+    uint32_t cc = (cos_floor(min(abs((int32_t)lat), (int32_t)9000)) * t.cos_q15) >> 15;
+    return sl * sl + (((cc * so) >> 15) * so);
+}
+
+static const float Q30 = 1073741824.0f;
+
+// Haversine term: grows with great-circle distance, 0 (same point) to 1
+// (antipode). Used only for ranking; hav_km() converts it.
+static HOT_PATH float hav_dist(int16_t lat, int16_t lon, const SearchTarget& t) {
+    float lat_r = lat * RAD_PER_X100;
+    float sdlat = sinf((lat_r - t.lat_rad) * 0.5f);
+    float sdlon = sinf((lon * RAD_PER_X100 - t.lon_rad) * 0.5f);
+    return sdlat * sdlat + t.cos_lat * cosf(lat_r) * sdlon * sdlon;
+}
+
+static float hav_km(float h) {
+    return 2.0f * EARTH_RADIUS_KM * asinf(sqrtf(min(h, 1.0f)));
+}
+
+// Haversine term of an angle in hundredths of a degree
+static float hav_of(float x100) {
+    float s = sinf(x100 * RAD_PER_X100 * 0.5f);
+    return s * s;
+}
+
+/**
+ * Lower bound on the haversine term to any place dlon or more away in
+ * longitude. Such a place lies past a meridian, and the distance d to that
+ * great circle has sin(d) = cos(lat) * sin(dlon); past 90 degrees the
+ * closest point of the far side is the pole.
+ */
+static float lon_lower_bound(int32_t dlon, const SearchTarget& t) {
+    if (dlon >= 9000) return hav_of(9000 - t.abs_lat);
+    float x = t.cos_lat * sinf(dlon * RAD_PER_X100);
+    return (1.0f - sqrtf(1.0f - x * x)) * 0.5f;
+}
+
+// ------------------------------------------------------------------
+// Reading
+// ------------------------------------------------------------------
+
+static bool read_at(File& file, uint32_t offset, void* dst, size_t bytes) {
+    if (!file.seek(offset)) return false;
+    return file.read((uint8_t*)dst, bytes) == bytes;
+}
+
+static bool read_at(uint32_t offset, void* dst, size_t bytes) {
+    return read_at(_db_file, offset, dst, bytes);
+}
+
+// Where on-demand coordinate reads go: a file handle and its chunk buffers
+struct CoordReader {
+    File* file;
+    int16_t* lat;
+    int16_t* lon;
+};
+
+/**
+ * Coordinates of places [first, end): fn(lat, lon, first, n) per run.
+ * One call with the file in memory; chunks of FILE_CHUNK read through
+ * reader in on-demand mode (the search's own handle and buffers unless
+ * given others).
+ */
+template <typename Fn>
+static void for_coords(uint32_t first, uint32_t end, Fn fn, const CoordReader* reader = nullptr) {
+    if (_lat) {
+        fn(_lat + first, _lon + first, first, (int)(end - first));
+        return;
+    }
+    CoordReader own = { &_db_file, _chunk_lat, _chunk_lon };
+    const CoordReader& r = reader ? *reader : own;
+    while (first < end) {
+        int n = (int)min(end - first, (uint32_t)FILE_CHUNK);
+        if (!read_at(*r.file, _sec.lat + first * 2, r.lat, n * 2) ||
+            !read_at(*r.file, _sec.lon + first * 2, r.lon, n * 2)) {
+            return;
         }
+        fn(r.lat, r.lon, first, n);
+        first += n;
+    }
+}
+
+// Copy a NUL-terminated string of at most cap - 1 bytes, cut at a UTF-8
+// character boundary
+static void copy_utf8(char* dst, const char* src, size_t avail, size_t cap) {
+    size_t len = 0;
+    while (len < avail && len < cap && src[len]) len++;
+    if (len >= cap) {
+        len = cap - 1;
+        while (len > 0 && ((uint8_t)src[len] & 0xC0) == 0x80) len--;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+static void decode_id(const uint8_t* packed, char* out) {
+    uint64_t v = 0;
+    for (int i = 0; i < PLACES_ID_BYTES; i++) v = (v << 8) | packed[i];
+    for (int i = 7; i >= 0; i--) {
+        out[i] = BASE64URL[v & 0x3F];
+        v >>= 6;
+    }
+    out[8] = '\0';
+}
+
+static bool decode_place(uint32_t i, Place* out) {
+    memset(out, 0, sizeof(Place));
+    if (_db) {
+        out->lat_x100 = _lat[i];
+        out->lon_x100 = _lon[i];
+        decode_id(_pid + i * PLACES_ID_BYTES, out->id);
+        uint32_t ref = _ref[i];
+        uint32_t name_off = ref >> 8;
+        uint32_t ci = ref & 0xFF;
+        if (name_off < _sec.str_size) {
+            copy_utf8(out->name, _str + name_off, _sec.str_size - name_off, sizeof(out->name));
+        }
+        if (ci < _ctry_count && _ctry[ci] < _sec.str_size) {
+            copy_utf8(out->country, _str + _ctry[ci], _sec.str_size - _ctry[ci], sizeof(out->country));
+        }
+        return true;
+    }
+
+    // On demand: one small read per field
+    uint8_t pid[PLACES_ID_BYTES];
+    uint32_t ref;
+    char buf[sizeof(out->name)];
+    if (!read_at(_sec.lat + i * 2, &out->lat_x100, 2) ||
+        !read_at(_sec.lon + i * 2, &out->lon_x100, 2) ||
+        !read_at(_sec.pid + i * PLACES_ID_BYTES, pid, sizeof(pid)) ||
+        !read_at(_sec.ref + i * 4, &ref, 4)) {
         return false;
     }
+    decode_id(pid, out->id);
 
-    // Open database file
-    _db_file = LittleFS.open("/places.bin", "r");
-    if (!_db_file) {
-        Serial.println("[PlacesDB] ERROR: places.bin not found");
+    uint32_t name_off = ref >> 8;
+    uint32_t ci = ref & 0xFF;
+    if (name_off < _sec.str_size) {
+        size_t n = min((size_t)(_sec.str_size - name_off), sizeof(buf));
+        if (!read_at(_sec.str + name_off, buf, n)) return false;
+        copy_utf8(out->name, buf, n, sizeof(out->name));
+    }
+    if (ci < _ctry_count && _ctry[ci] < _sec.str_size) {
+        size_t n = min((size_t)(_sec.str_size - _ctry[ci]), sizeof(out->country));
+        if (!read_at(_sec.str + _ctry[ci], buf, n)) return false;
+        copy_utf8(out->country, buf, n, sizeof(out->country));
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Search
+// ------------------------------------------------------------------
+
+/**
+ * Walk index cells in expanding rings around the target cell. A ring is
+ * col_stretch times wider than it is tall, so it spans about the same
+ * distance on both axes at the target's latitude. Columns wrap at the
+ * antimeridian; rows clamp at the poles. visit(first, end) is called with
+ * each non-empty cell's place range. After each ring, done(bound) gets a
+ * lower bound on the haversine term (Q30) of every unvisited place, so
+ * the caller can stop once its result can't improve.
+ */
+template <typename VisitFn, typename DoneFn>
+static void grid_walk(const SearchTarget& t, VisitFn visit, DoneFn done) {
+    const int trow = cell_row(t.lat);
+    const int tcol = cell_col(t.lon);
+    // Column offsets that reach every column exactly once
+    const int col_lo = -(_grid_cols / 2);
+    const int col_hi = _grid_cols - _grid_cols / 2 - 1;
+    int prev_lo = 1, prev_hi = 0;      // Columns covered by the previous ring
+
+    for (int ring = 0; ; ring++) {
+        int lo = max(-ring * t.col_stretch, col_lo);
+        int hi = min(ring * t.col_stretch, col_hi);
+
+        for (int dr = -ring; dr <= ring; dr++) {
+            int row = trow + dr;
+            if (row < 0 || row >= _grid_rows) continue;
+
+            // New rows are walked whole; older rows only get the new columns
+            bool new_row = (dr == -ring || dr == ring);
+            for (int dc = lo; dc <= hi; dc++) {
+                if (!new_row && dc == prev_lo) dc = prev_hi + 1;
+                if (dc > hi) break;
+                int col = ((tcol + dc) % _grid_cols + _grid_cols) % _grid_cols;
+
+                if (!cell_occupied(col, row)) continue;
+                uint32_t first, end;
+                if (cell_range(cell_id(col, row), &first, &end)) visit(first, end);
+            }
+        }
+        prev_lo = lo;
+        prev_hi = hi;
+
+        bool rows_done = trow - ring <= 0 && trow + ring >= _grid_rows - 1;
+        bool cols_done = lo == col_lo && hi == col_hi;
+        if (rows_done && cols_done) break;
+
+        // Unvisited places are a full ring of rows away, or past the
+        // columns walked (less the short column when the ring wraps)
+        float bound = INFINITY;
+        if (!rows_done) bound = hav_of(min(ring * _cell_size, (int32_t)18000));
+        if (!cols_done) {
+            int32_t span = max((int32_t)0, min(hi, -lo) * _cell_size - _wrap_short);
+            bound = min(bound, lon_lower_bound(span, t));
+        }
+        // Float rounding margin on the way to Q30
+        if (done((uint32_t)min(bound * 0.9999f * Q30, 4294967040.0f))) break;
+    }
+}
+
+/**
+ * Insert a place into a distance-sorted result list of capacity k.
+ * Returns the new count. Ties keep the earlier-inserted place first.
+ */
+static HOT_PATH int kbest_insert(PlaceHandle* out, float* dist, int count, int k,
+                                 PlaceHandle p, float d) {
+    if (count == k && d >= dist[k - 1]) return count;
+
+    int pos = (count < k) ? count : k - 1;
+    while (pos > 0 && dist[pos - 1] > d) {
+        dist[pos] = dist[pos - 1];
+        out[pos] = out[pos - 1];
+        pos--;
+    }
+    dist[pos] = d;
+    out[pos] = p;
+    return (count < k) ? count + 1 : k;
+}
+
+/**
+ * The k places nearest the target by great-circle distance, nearest
+ * first. Each place in the cells walked is first checked with the integer
+ * lower bound; hav_dist() runs only for those that could still beat the
+ * current k-th place.
+ */
+struct KBest {
+    PlaceHandle* out;
+    float dist[PLACES_MAX_K];
+    int count;
+    int k;
+    uint32_t limit;    // Q30 k-th distance (rounded up), once full
+    const uint32_t* except;   // Bitset of places to leave out, or nullptr
+};
+
+static void kbest_init(KBest& kb, PlaceHandle* out, int k, const uint32_t* except) {
+    kb.out = out;
+    kb.count = 0;
+    kb.k = k;
+    kb.limit = UINT32_MAX;
+    kb.except = except;
+}
+
+// The distance scan over n places from base (the search's inner loop)
+static HOT_PATH void kbest_scan(KBest& kb, const SearchTarget& t, const int16_t* plat,
+                                const int16_t* plon, uint32_t base, int n) {
+    for (int i = 0; i < n; i++) {
+        if (place_lower_bound(plat[i], plon[i], t) >= kb.limit) continue;
+        if (place_skipped(base + i)) continue;
+        if (kb.except && (kb.except[(base + i) >> 5] >> ((base + i) & 31) & 1)) continue;
+        float h = hav_dist(plat[i], plon[i], t);
+        if (kb.count == kb.k && h >= kb.dist[kb.k - 1]) continue;
+        kb.count = kbest_insert(kb.out, kb.dist, kb.count, kb.k, (PlaceHandle)(base + i), h);
+        if (kb.count == kb.k) {
+            kb.limit = (uint32_t)min(kb.dist[kb.k - 1] * 1.0001f * Q30 + 2.0f, 4294967040.0f);
+        }
+    }
+}
+
+static int grid_search(const SearchTarget& t, int k, PlaceHandle* out,
+                       const uint32_t* except = nullptr) {
+    KBest kb;
+    kbest_init(kb, out, k, except);
+    grid_walk(t,
+        [&](uint32_t first, uint32_t end) {
+            for_coords(first, end, [&](const int16_t* plat, const int16_t* plon, uint32_t base, int n) {
+                kbest_scan(kb, t, plat, plon, base, n);
+            });
+        },
+        [&](uint32_t bound) { return kb.count == kb.k && bound >= kb.limit; });
+    return kb.count;
+}
+
+// ------------------------------------------------------------------
+// Scan strategies: the same k-best scan over every place instead of the
+// cells round the target, on the calling task (LINEAR) or split with a
+// helper task (PARALLEL). The helper scans the upper half of the places
+// into a KBest of its own while the caller scans the lower half, and the
+// two sorted lists are merged. It has no core affinity and runs at the
+// caller's priority, so it takes whichever core the caller is not on. In
+// on-demand mode it reads through a second handle of places.bin; LittleFS
+// serializes the two readers, so expect little gain there. There is one
+// helper and one job: a search that finds it taken by another task scans
+// on its own.
+// ------------------------------------------------------------------
+
+static PlacesSearch _strategy = PLACES_SEARCH;
+
+static void linear_scan(KBest& kb, const SearchTarget& t, uint32_t first, uint32_t end,
+                        const CoordReader* reader = nullptr) {
+    for_coords(first, end, [&](const int16_t* plat, const int16_t* plon, uint32_t base, int n) {
+        kbest_scan(kb, t, plat, plon, base, n);
+    }, reader);
+}
+
+static const uint32_t SCAN_STACK = 3072;
+
+struct ScanJob {
+    SearchTarget target;
+    uint32_t first, end;
+    KBest kb;
+    PlaceHandle out[PLACES_MAX_K];
+    TaskHandle_t waiter;
+};
+static ScanJob _scan_job;              // Handed over by task notification
+static SemaphoreHandle_t _scan_lock = nullptr;   // Held for the job and the helper's start
+static TaskHandle_t _scan_task = nullptr;
+static bool _scan_failed = false;
+static File _scan_file;                // The helper's handle in on-demand mode
+static int16_t _scan_lat[FILE_CHUNK];
+static int16_t _scan_lon[FILE_CHUNK];
+
+static void scan_helper_task(void*) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        CoordReader reader = { &_scan_file, _scan_lat, _scan_lon };
+        linear_scan(_scan_job.kb, _scan_job.target, _scan_job.first, _scan_job.end, &reader);
+        xTaskNotifyGive(_scan_job.waiter);
+    }
+}
+
+static bool start_scan_helper() {
+    if (_scan_task) return true;
+    if (_scan_failed) return false;
+    if (!_lat && !_scan_file) _scan_file = asset_fs_open("/places.bin", 0);
+    if ((!_lat && !_scan_file) ||
+        xTaskCreatePinnedToCore(scan_helper_task, "places_scan", SCAN_STACK, nullptr,
+                                1, &_scan_task, tskNO_AFFINITY) != pdPASS) {
+        Serial.println("[PlacesDB] Failed to start the scan helper, scanning on one core");
+        _scan_task = nullptr;
+        _scan_failed = true;
         return false;
     }
+    return true;
+}
 
-    // Read and validate header
-    uint8_t header[PLACES_HEADER_SIZE];
-    if (_db_file.read(header, PLACES_HEADER_SIZE) != PLACES_HEADER_SIZE) {
-        Serial.println("[PlacesDB] ERROR: Failed to read header");
-        _db_file.close();
+static int parallel_search(const SearchTarget& t, int k, PlaceHandle* out,
+                           const uint32_t* except) {
+    KBest mine;
+    bool locked = _scan_lock && xSemaphoreTake(_scan_lock, 0) == pdTRUE;
+    if (!locked || !start_scan_helper()) {
+        if (locked) xSemaphoreGive(_scan_lock);
+        kbest_init(mine, out, k, except);
+        linear_scan(mine, t, 0, _place_count);
+        return mine.count;
+    }
+    uint32_t half = _place_count / 2;
+
+    ScanJob& job = _scan_job;
+    job.target = t;
+    job.first = half;
+    job.end = _place_count;
+    kbest_init(job.kb, job.out, k, except);
+    job.waiter = xTaskGetCurrentTaskHandle();
+    vTaskPrioritySet(_scan_task, uxTaskPriorityGet(nullptr));
+    xTaskNotifyGive(_scan_task);
+
+    PlaceHandle low[PLACES_MAX_K];
+    kbest_init(mine, low, k, except);
+    linear_scan(mine, t, 0, half);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    // Merge: the lower half first on ties, as one scan would have it
+    int a = 0, b = 0, n = 0;
+    while (n < k && (a < mine.count || b < job.kb.count)) {
+        bool take_low = b >= job.kb.count ||
+                        (a < mine.count && mine.dist[a] <= job.kb.dist[b]);
+        out[n++] = take_low ? low[a++] : job.out[b++];
+    }
+    xSemaphoreGive(_scan_lock);
+    return n;
+}
+
+// The k nearest places by strategy
+static int search_by(PlacesSearch strategy, const SearchTarget& t, int k, PlaceHandle* out,
+                     const uint32_t* except = nullptr) {
+    if (strategy == PLACES_SEARCH_LINEAR) {
+        KBest kb;
+        kbest_init(kb, out, k, except);
+        linear_scan(kb, t, 0, _place_count);
+        return kb.count;
+    }
+    if (strategy == PLACES_SEARCH_PARALLEL) return parallel_search(t, k, out, except);
+    return grid_search(t, k, out, except);
+}
+
+// The k nearest places by the selected strategy
+static int search(const SearchTarget& t, int k, PlaceHandle* out,
+                  const uint32_t* except = nullptr) {
+    return search_by(_strategy, t, k, out, except);
+}
+
+// Reference linear scan by great-circle distance over every place, used
+// for timing and correctness comparison. Returns the best hav_dist().
+static float linear_find_nearest(const SearchTarget& t, uint32_t* best) {
+    float best_h = INFINITY;
+    for_coords(0, _place_count, [&](const int16_t* lat, const int16_t* lon, uint32_t base, int n) {
+        for (int i = 0; i < n; i++) {
+            if (place_skipped(base + i)) continue;
+            float h = hav_dist(lat[i], lon[i], t);
+            if (h < best_h) {
+                best_h = h;
+                *best = base + i;
+            }
+        }
+    });
+    return best_h;
+}
+
+// ------------------------------------------------------------------
+// Name search
+// ------------------------------------------------------------------
+
+// Bytes of a section, from the file image or read in on-demand mode
+static bool section_read(uint32_t offset, void* dst, size_t bytes) {
+    if (_db) {
+        memcpy(dst, _db + offset, bytes);
+        return true;
+    }
+    return read_at(offset, dst, bytes);
+}
+
+/**
+ * Search key of UTF-8 text, as fold_name() in compile_places.py makes it:
+ * ASCII letters and digits lowercased, FOLD applied to accented Latin
+ * letters, other characters kept, runs of ASCII punctuation and spaces
+ * made one space. out holds PLACES_KEY_MAX + 1 bytes. Returns the length.
+ */
+static size_t fold_text(const char* text, size_t avail, char* out) {
+    const uint8_t* src = (const uint8_t*)text;
+    size_t len = 0;
+    bool space = false;
+    size_t i = 0;
+    while (i < avail && src[i]) {
+        uint8_t b = src[i];
+        char unit[5];
+        size_t n = 0;
+        size_t used = 1;
+        if (b < 0x80) {
+            if (!isalnum(b)) {
+                space = len > 0;
+                i++;
+                continue;
+            }
+            unit[n++] = (char)tolower(b);
+        } else {
+            used = (b & 0xE0) == 0xC0 ? 2 : (b & 0xF0) == 0xE0 ? 3 : (b & 0xF8) == 0xF0 ? 4 : 1;
+            if (i + used > avail) used = avail - i;
+            for (size_t k = 1; k < used; k++) {
+                if ((src[i + k] & 0xC0) != 0x80) used = k;   // Broken sequence: stop there
+            }
+            uint32_t cp = used == 2 ? ((b & 0x1F) << 6 | (src[i + 1] & 0x3F)) : 0;
+            if (cp >= PLACES_FOLD_FIRST && cp <= PLACES_FOLD_LAST && _fold[cp - PLACES_FOLD_FIRST]) {
+                unit[n++] = (char)_fold[cp - PLACES_FOLD_FIRST];
+            } else {
+                memcpy(unit, src + i, used);
+                n = used;
+            }
+        }
+        if (len + (space ? 1 : 0) + n > PLACES_KEY_MAX) break;
+        if (space) out[len++] = ' ';
+        space = false;
+        memcpy(out + len, unit, n);
+        len += n;
+        i += used;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// Search key of a place's name. On demand, names are read up to
+// KEY_READ bytes, which is the whole name for all but odd ones.
+static const size_t KEY_READ = 64;
+
+static size_t place_key(uint32_t i, char* out) {
+    out[0] = '\0';
+    uint32_t ref;
+    if (!section_read(_sec.ref + i * 4, &ref, 4)) return 0;
+    uint32_t name_off = ref >> 8;
+    if (name_off >= _sec.str_size) return 0;
+    size_t avail = _sec.str_size - name_off;
+    if (_db) return fold_text(_str + name_off, avail, out);
+
+    char buf[KEY_READ];
+    size_t n = min(avail, sizeof(buf));
+    if (!read_at(_sec.str + name_off, buf, n)) return 0;
+    return fold_text(buf, n, out);
+}
+
+static uint16_t read_u16(uint32_t offset) {
+    uint16_t v = PLACE_NONE;
+    section_read(offset, &v, 2);
+    return v;
+}
+
+// Name-order position of the first name >= key (compared over its first
+// len bytes, so every name starting with key follows)
+static uint32_t name_lower_bound(const char* key, size_t len) {
+    char name[PLACES_KEY_MAX + 1];
+    uint32_t lo = 0, hi = _place_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        place_key(read_u16(_sec.name + mid * 2), name);
+        if (strncmp(name, key, len) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int search_prefix(const char* key, size_t len, int cap, PlaceHandle* out) {
+    char name[PLACES_KEY_MAX + 1];
+    int count = 0;
+    for (uint32_t pos = name_lower_bound(key, len); pos < _place_count && count < cap; pos++) {
+        uint16_t p = read_u16(_sec.name + pos * 2);
+        place_key(p, name);
+        if (strncmp(name, key, len) != 0) break;
+        if (!place_skipped(p)) out[count++] = p;
+    }
+    return count;
+}
+
+// Posting range of a trigram in TRIP; false if no name has it
+static bool gram_range(uint32_t gram, uint32_t* first, uint32_t* end) {
+    uint32_t lo = 0, hi = _gram_count;
+    PlacesGram g;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (!section_read(_sec.trix + mid * sizeof(g), &g, sizeof(g))) return false;
+        if (g.gram < gram) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo >= _gram_count) return false;
+    PlacesGram next;
+    if (!section_read(_sec.trix + lo * sizeof(g), &g, sizeof(g)) ||
+        !section_read(_sec.trix + (lo + 1) * sizeof(g), &next, sizeof(next)) ||
+        g.gram != gram) {
         return false;
     }
+    *first = g.first;
+    *end = min(next.first, _sec.trip_size / 2);
+    return *first < *end;
+}
+
+/**
+ * Places sharing the most trigrams with key, ranked by shared / (query
+ * trigrams + name trigrams - shared). The query's posting lists are
+ * merged a place at a time; names sharing under a third of the query's
+ * trigrams are not ranked.
+ */
+static int search_fuzzy(const char* key, size_t len, int cap, PlaceHandle* out) {
+    // Distinct trigrams of " " + key + " "
+    char padded[PLACES_KEY_MAX + 3];
+    padded[0] = ' ';
+    memcpy(padded + 1, key, len);
+    padded[len + 1] = ' ';
+    uint32_t grams[PLACES_KEY_MAX];
+    int gram_count = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint32_t g = (uint8_t)padded[i] << 16 | (uint8_t)padded[i + 1] << 8 | (uint8_t)padded[i + 2];
+        bool seen = false;
+        for (int k = 0; k < gram_count && !seen; k++) seen = grams[k] == g;
+        if (!seen) grams[gram_count++] = g;
+    }
+
+    struct Postings { uint32_t pos, end; uint16_t head; };
+    Postings lists[PLACES_KEY_MAX];
+    int list_count = 0;
+    for (int k = 0; k < gram_count; k++) {
+        Postings& l = lists[list_count];
+        if (!gram_range(grams[k], &l.pos, &l.end)) continue;
+        l.head = read_u16(_sec.trip + l.pos * 2);
+        list_count++;
+    }
+    const int need = max(1, (gram_count + 2) / 3);
+    if (list_count < need) return 0;
+
+    float dist[PLACES_MAX_K];
+    int count = 0;
+    char name[PLACES_KEY_MAX + 1];
+    while (true) {
+        uint32_t p = PLACE_NONE;
+        for (int k = 0; k < list_count; k++) {
+            if (lists[k].pos < lists[k].end && lists[k].head < p) p = lists[k].head;
+        }
+        if (p == PLACE_NONE) break;
+
+        int shared = 0;
+        for (int k = 0; k < list_count; k++) {
+            Postings& l = lists[k];
+            if (l.pos >= l.end || l.head != p) continue;
+            shared++;
+            if (++l.pos < l.end) l.head = read_u16(_sec.trip + l.pos * 2);
+        }
+        if (shared < need || place_skipped(p)) continue;
+
+        // A name of n bytes has n trigrams (counting repeats)
+        int name_grams = max((int)place_key(p, name), shared);
+        float d = 1.0f - (float)shared / (gram_count + name_grams - shared);
+        count = kbest_insert(out, dist, count, cap, (PlaceHandle)p, d);
+    }
+    return count;
+}
+
+// Copy the FOLD table and check the TRIX sentinel
+static void init_search() {
+    _search = _sec.fold && _sec.name && section_read(_sec.fold, _fold, FOLD_COUNT);
+    if (!_search) {
+        Serial.println("[PlacesDB] No search index in places.bin, name search off");
+        return;
+    }
+    PlacesGram sentinel;
+    _gram_count = _sec.trix_size / sizeof(PlacesGram) - (_sec.trix ? 1 : 0);
+    _fuzzy = _sec.trix && _sec.trip &&
+             section_read(_sec.trix + _gram_count * sizeof(sentinel), &sentinel, sizeof(sentinel)) &&
+             sentinel.gram == 0xFFFFFFFF && sentinel.first == _sec.trip_size / 2;
+    Serial.printf("[PlacesDB] Name search: prefix%s\n",
+                  _fuzzy ? ", fuzzy" : " only (no trigram index)");
+}
+
+// ------------------------------------------------------------------
+// Countries
+// ------------------------------------------------------------------
+
+// Taps this close outside a country's box (degrees * 100) still count as
+// inside: boxes are drawn round the places, not the borders
+static const int16_t COUNTRY_BOX_MARGIN = 100;
+
+// A country's CBOX entry; false for a bad index or a read error
+static bool country_entry(int country, PlacesCountry* out) {
+    if (!_countries || country < 0 || (uint32_t)country >= _ctry_count) return false;
+    return section_read(_sec.cbox + country * sizeof(PlacesCountry), out, sizeof(*out));
+}
+
+// Country index of a place, from the low byte of its REF entry
+static int place_country(uint32_t i) {
+    uint32_t ref;
+    if (!section_read(_sec.ref + i * 4, &ref, 4)) return -1;
+    uint32_t ci = ref & 0xFF;
+    return ci < _ctry_count ? (int)ci : -1;
+}
+
+static bool box_contains(const PlacesCountry& c, int16_t lat, int16_t lon) {
+    if (lat < c.lat_min - COUNTRY_BOX_MARGIN || lat > c.lat_max + COUNTRY_BOX_MARGIN) return false;
+    int32_t lo = c.lon_min - COUNTRY_BOX_MARGIN;
+    int32_t hi = c.lon_max + COUNTRY_BOX_MARGIN;
+    if (c.lon_min <= c.lon_max) return lon >= lo && lon <= hi;
+    return lon >= lo || lon <= hi;      // Box crosses the antimeridian
+}
+
+// Check that the runs tile CPLC: CTRY order, back to back, ending at the
+// last place
+static void init_countries() {
+    _countries = _sec.cplc && _sec.cbox && _ctry_count > 0;
+    if (!_countries) {
+        Serial.println("[PlacesDB] No country index in places.bin, country play off");
+        return;
+    }
+    uint32_t next = 0;
+    PlacesCountry c;
+    for (uint32_t i = 0; i < _ctry_count && _countries; i++) {
+        _countries = country_entry(i, &c) && c.first == next;
+        next += c.count;
+    }
+    if (!_countries || next != _place_count) {
+        Serial.println("[PlacesDB] WARNING: Country runs do not cover the places, country play off");
+        _countries = false;
+        return;
+    }
+    Serial.printf("[PlacesDB] Country index: %lu countries\n", _ctry_count);
+}
+
+// ------------------------------------------------------------------
+// View partition
+// ------------------------------------------------------------------
+
+// Tile t's run of the VIEW place list
+static bool view_run(uint32_t t, uint16_t* first, uint16_t* end) {
+    uint32_t base = _sec.view + sizeof(PlacesView);
+    return section_read(base + t * 2, first, 2) && section_read(base + (t + 1) * 2, end, 2);
+}
+
+// The section holds its header, a start per tile and a sentinel, and
+// every place once; the starts must rise to the place count
+static void init_view() {
+    _view_tiles = 0;
+    if (!_sec.view || _sec.view_size < sizeof(_view) ||
+        !section_read(_sec.view, &_view, sizeof(_view)) || _view.slices != MAP_SLICE_COUNT) {
+        Serial.println("[PlacesDB] No view partition in places.bin for this map");
+        return;
+    }
+    uint32_t tiles = (uint32_t)_view.slices * _view.rows * _view.cols;
+    if (!tiles || _sec.view_size != sizeof(_view) + (tiles + 1) * 2 + _place_count * 2) {
+        Serial.println("[PlacesDB] WARNING: VIEW size mismatch, no view partition");
+        return;
+    }
+    uint16_t first, end = 0, prev = 0;
+    for (uint32_t t = 0; t < tiles; t++) {
+        if (!view_run(t, &first, &end) || first != prev || end < first) {
+            Serial.println("[PlacesDB] WARNING: VIEW runs out of order, no view partition");
+            return;
+        }
+        prev = end;
+    }
+    if (end != _place_count) {
+        Serial.println("[PlacesDB] WARNING: VIEW runs do not cover the places, no view partition");
+        return;
+    }
+    _view_tiles = tiles;
+    Serial.printf("[PlacesDB] View partition: %d x %d tiles per slice\n", _view.cols, _view.rows);
+}
+
+// ------------------------------------------------------------------
+// Loading
+// ------------------------------------------------------------------
+
+// Validate a places.bin header and set _place_count and the cell geometry
+static bool parse_header(const uint8_t* header) {
+    PlacesHeader h;
+    memcpy(&h, header, sizeof(h));
 
     // Check magic
-    if (memcmp(header, PLACES_DB_MAGIC, 4) != 0) {
+    if (memcmp(h.magic, PLACES_DB_MAGIC, 4) != 0) {
         Serial.println("[PlacesDB] ERROR: Invalid magic (not a places database)");
-        _db_file.close();
         return false;
     }
 
     // Check version
-    uint16_t version = header[4] | (header[5] << 8);
-    if (version != PLACES_DB_VERSION) {
+    if (h.version != PLACES_DB_VERSION) {
         Serial.printf("[PlacesDB] ERROR: Version mismatch (file=%d, expected=%d)\n",
-                      version, PLACES_DB_VERSION);
-        _db_file.close();
+                      h.version, PLACES_DB_VERSION);
+        return false;
+    }
+
+    if (h.cell_shift < 8 || h.cell_shift > 12) {
+        Serial.printf("[PlacesDB] ERROR: Bad cell shift %d\n", h.cell_shift);
         return false;
     }
+    _cell_shift = h.cell_shift;
+    _cell_size = 1 << _cell_shift;
+    _grid_cols = (36000 + _cell_size - 1) >> _cell_shift;
+    _grid_rows = (18000 >> _cell_shift) + 1;
+    _wrap_short = _grid_cols * _cell_size - 36000;
 
     // Get place count
-    _place_count = header[6] | (header[7] << 8) | (header[8] << 16) | (header[9] << 24);
+    _place_count = h.count;
     Serial.printf("[PlacesDB] Found %lu places in database\n", _place_count);
+    if (_place_count >= PLACE_NONE) {
+        Serial.println("[PlacesDB] ERROR: Too many places for 16-bit handles");
+        return false;
+    }
+    return h.section_count > 0;
+}
+
+/**
+ * Resolve the section table into _sec. Checks that every section the
+ * reader needs is present, sized for _place_count and inside limit bytes.
+ */
+static bool parse_sections(const uint8_t* table, uint16_t count, uint32_t limit) {
+    memset(&_sec, 0, sizeof(_sec));
+    // The first REQUIRED_SECTIONS tags must be present
+    static const int REQUIRED_SECTIONS = 7;
+    static const int TAG_COUNT = 15;
+    static const char* const TAGS[TAG_COUNT] = { "LAT ", "LON ", "PID ", "REF ", "CTRY", "STR ",
+                                                 "CELL", "SCNT", "FOLD", "NAME", "TRIX", "TRIP",
+                                                 "CPLC", "CBOX", "VIEW" };
+    uint32_t* offsets[TAG_COUNT] = { &_sec.lat, &_sec.lon, &_sec.pid, &_sec.ref,
+                                     &_sec.ctry, &_sec.str, &_sec.cell, &_sec.scnt,
+                                     &_sec.fold, &_sec.name, &_sec.trix, &_sec.trip,
+                                     &_sec.cplc, &_sec.cbox, &_sec.view };
+    uint32_t sizes[TAG_COUNT] = {0};
+    bool found[TAG_COUNT] = {false};
+
+    for (uint16_t i = 0; i < count; i++) {
+        PlacesSection s;
+        memcpy(&s, table + i * PLACES_SECTION_SIZE, sizeof(s));
+        if (s.offset > limit || s.size > limit - s.offset) {
+            Serial.printf("[PlacesDB] ERROR: Section %.4s outside the file\n", s.tag);
+            return false;
+        }
+        if (s.offset + s.size > _sec.file_size) _sec.file_size = s.offset + s.size;
+        for (int t = 0; t < TAG_COUNT; t++) {
+            if (memcmp(s.tag, TAGS[t], 4) == 0) {
+                *offsets[t] = s.offset;
+                sizes[t] = s.size;
+                found[t] = true;
+            }
+        }
+    }
+
+    const uint32_t n = _place_count;
+    const uint32_t expected[4] = { n * 2, n * 2, n * PLACES_ID_BYTES, n * 4 };
+    for (int t = 0; t < REQUIRED_SECTIONS; t++) {
+        bool ok = found[t] && (t >= 4 || sizes[t] == expected[t]);
+        if (!ok) {
+            Serial.printf("[PlacesDB] ERROR: Section %s missing or wrong size\n", TAGS[t]);
+            return false;
+        }
+    }
+    if (found[7] && sizes[7] != n) {
+        Serial.println("[PlacesDB] WARNING: SCNT size mismatch, ignoring station counts");
+        _sec.scnt = 0;
+    }
+    // Search index: all or nothing for prefix search, TRIX/TRIP for fuzzy
+    if (found[8] || found[9]) {
+        if (sizes[8] != FOLD_COUNT || sizes[9] != n * 2) {
+            Serial.println("[PlacesDB] WARNING: FOLD/NAME size mismatch, no name search");
+            _sec.fold = _sec.name = 0;
+        }
+        bool grams = found[10] && found[11] && sizes[10] >= sizeof(PlacesGram) &&
+                     sizes[10] % sizeof(PlacesGram) == 0 && sizes[11] % 2 == 0;
+        if (!grams) _sec.trix = _sec.trip = 0;
+    }
+    // Country runs: both or neither, one CBOX entry per CTRY entry
+    if ((found[12] || found[13]) &&
+        (sizes[12] != n * 2 || sizes[13] != sizes[4] / 4 * sizeof(PlacesCountry))) {
+        Serial.println("[PlacesDB] WARNING: CPLC/CBOX size mismatch, no country queries");
+        _sec.cplc = _sec.cbox = 0;
+    }
+    _sec.view_size = _sec.view ? sizes[14] : 0;
+    _sec.trix_size = _sec.trix ? sizes[10] : 0;
+    _sec.trip_size = _sec.trip ? sizes[11] : 0;
+    _sec.ctry_size = sizes[4];
+    _sec.str_size = sizes[5];
+    _sec.cell_size = sizes[6];
+    if (_sec.cell_size < sizeof(PlacesCell) || _sec.cell_size % sizeof(PlacesCell) != 0) {
+        Serial.println("[PlacesDB] ERROR: Bad CELL index");
+        return false;
+    }
+    _cell_count = _sec.cell_size / sizeof(PlacesCell) - 1;
+    _ctry_count = _sec.ctry_size / 4;
+    return true;
+}
+
+// Point the section pointers into a file image in memory
+static void bind_sections(const uint8_t* base) {
+    _db = base;
+    _lat = (const int16_t*)(base + _sec.lat);
+    _lon = (const int16_t*)(base + _sec.lon);
+    _pid = base + _sec.pid;
+    _ref = (const uint32_t*)(base + _sec.ref);
+    _str = (const char*)(base + _sec.str);
+    _ctry = (const uint32_t*)(base + _sec.ctry);
+    _cells = (const PlacesCell*)(base + _sec.cell);
+}
+
+// Index sanity: ascending cells, non-decreasing starts, sentinel at the end
+static bool check_cells() {
+    for (uint32_t i = 0; i < _cell_count; i++) {
+        if (_cells[i].first > _cells[i + 1].first ||
+            (i + 1 < _cell_count && _cells[i].cell >= _cells[i + 1].cell)) {
+            Serial.printf("[PlacesDB] ERROR: CELL index out of order at %lu\n", i);
+            return false;
+        }
+    }
+    if (_cells[_cell_count].first != _place_count) {
+        Serial.println("[PlacesDB] ERROR: CELL index does not cover every place");
+        return false;
+    }
+    return true;
+}
+
+// Mark places with no stations from the optional SCNT section (in the
+// file image, or read in chunks in on-demand mode)
+static void build_station_filter() {
+    if (!_sec.scnt) {
+        Serial.println("[PlacesDB] No station counts in places.bin, searching all places");
+        return;
+    }
+    _no_stations = (uint32_t*)calloc((_place_count + 31) / 32, sizeof(uint32_t));
+    if (!_no_stations) return;
+
+    uint8_t chunk[FILE_CHUNK];
+    for (uint32_t first = 0; first < _place_count; first += FILE_CHUNK) {
+        uint32_t n = min(_place_count - first, (uint32_t)FILE_CHUNK);
+        const uint8_t* counts = _db ? _db + _sec.scnt + first : chunk;
+        if (!_db && !read_at(_sec.scnt + first, chunk, n)) {
+            free(_no_stations);
+            _no_stations = nullptr;
+            _no_stations_count = 0;
+            return;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (counts[i] == 0) {
+                _no_stations[(first + i) >> 5] |= 1UL << ((first + i) & 31);
+                _no_stations_count++;
+            }
+        }
+    }
+    Serial.printf("[PlacesDB] Skipping %lu places without stations\n", _no_stations_count);
+}
+
+static void compute_fingerprint() {
+    uint32_t h = FNV1A_SEED;
+    uint8_t chunk[FILE_CHUNK * PLACES_ID_BYTES];
+    uint32_t total = _place_count * PLACES_ID_BYTES;
+    for (uint32_t pos = 0; pos < total; pos += sizeof(chunk)) {
+        uint32_t n = min(total - pos, (uint32_t)sizeof(chunk));
+        const uint8_t* bytes = _db ? _pid + pos : chunk;
+        if (!_db && !read_at(_sec.pid + pos, chunk, n)) {
+            _fingerprint = 0;
+            return;
+        }
+        h = fnv1a_bytes(bytes, n, h);
+    }
+    _fingerprint = h;
+}
+
+// Read and validate the places.bin header and section table through
+// read(offset, dst, bytes); limit is the size of the file or partition
+template <typename ReadFn>
+static bool read_directory(ReadFn read, uint32_t limit) {
+    uint8_t header[PLACES_HEADER_SIZE];
+    if (!read(0, header, PLACES_HEADER_SIZE)) {
+        Serial.println("[PlacesDB] ERROR: Failed to read header");
+        return false;
+    }
+    if (!parse_header(header)) return false;
+
+    uint16_t count = ((const PlacesHeader*)header)->section_count;
+    size_t bytes = count * PLACES_SECTION_SIZE;
+    uint8_t* table = (uint8_t*)malloc(bytes);
+    if (!table) return false;
+    bool ok = read(PLACES_HEADER_SIZE, table, bytes) && parse_sections(table, count, limit);
+    free(table);
+    return ok;
+}
+
+// Map places.bin in place from the raw "places" partition (no copy).
+// Flash it with: esptool.py write_flash 0x710000 data/places.bin
+static bool map_partition() {
+    const esp_partition_t* part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, PLACES_PARTITION_LABEL);
+    if (!part) {
+        Serial.println("[PlacesDB] No 'places' partition, using LittleFS");
+        return false;
+    }
+
+    bool valid = read_directory([&](uint32_t off, void* dst, size_t n) {
+        return esp_partition_read(part, off, dst, n) == ESP_OK;
+    }, part->size);
+    if (!valid) {
+        Serial.println("[PlacesDB] 'places' partition not flashed, using LittleFS");
+        _place_count = 0;
+        return false;
+    }
+
+    size_t map_size = _sec.file_size;
+    const void* mapped = nullptr;
+    esp_err_t err = esp_partition_mmap(part, 0, map_size, SPI_FLASH_MMAP_DATA,
+                                       &mapped, &_mmap_handle);
+    if (err != ESP_OK) {
+        Serial.printf("[PlacesDB] ERROR: mmap failed (%s)\n", esp_err_to_name(err));
+        _place_count = 0;
+        return false;
+    }
+
+    // Read-only flash mapping; nothing writes through the section pointers
+    bind_sections((const uint8_t*)mapped);
+    if (!check_cells()) {
+        spi_flash_munmap(_mmap_handle);
+        _db = nullptr;
+        _place_count = 0;
+        return false;
+    }
+    _use_mmap = true;
+    Serial.printf("[PlacesDB] Mapped %.1f KB from flash at 0x%x (no copy)\n",
+                  map_size / 1024.0f, part->address);
+    return true;
+}
+
+// No RAM for the file: keep it open and hold only the index and the
+// country table
+static bool setup_on_demand() {
+    PlacesCell* cells = (PlacesCell*)malloc(_sec.cell_size);
+    uint32_t* ctry = (uint32_t*)malloc(_sec.ctry_size ? _sec.ctry_size : 4);
+    _chunk_lat = (int16_t*)malloc(FILE_CHUNK * sizeof(int16_t));
+    _chunk_lon = (int16_t*)malloc(FILE_CHUNK * sizeof(int16_t));
+    bool ok = cells && ctry && _chunk_lat && _chunk_lon;
+    if (!ok) {
+        Serial.println("[PlacesDB] ERROR: No memory for the on-demand index");
+    } else if (!read_at(_sec.cell, cells, _sec.cell_size) ||
+               !read_at(_sec.ctry, ctry, _sec.ctry_size)) {
+        Serial.println("[PlacesDB] ERROR: Failed to read the index");
+        ok = false;
+    } else {
+        _cells = cells;
+        _ctry = ctry;
+        ok = check_cells();
+    }
+    if (!ok) {
+        free(cells);
+        free(ctry);
+        free(_chunk_lat);
+        free(_chunk_lon);
+        _cells = nullptr;
+        _ctry = nullptr;
+        _chunk_lat = _chunk_lon = nullptr;
+        return false;
+    }
+    Serial.printf("[PlacesDB] On-demand index: %lu cells, %.1f KB\n",
+                  _cell_count, (_sec.cell_size + _sec.ctry_size) / 1024.0f);
+    return true;
+}
+
+// Open places.bin on LittleFS and load it into RAM (or keep it open
+// for on-demand reading if allocation fails)
+static bool load_from_file() {
+    // Open database file. Kept open in on-demand mode, where every read
+    // is a seek to one cell or coordinate chunk: no read-ahead
+    _db_file = asset_fs_open("/places.bin", 0);
+    if (!_db_file) {
+        Serial.println("[PlacesDB] ERROR: places.bin not found");
+        return false;
+    }
 
-    // Calculate required memory
-    size_t db_size = _place_count * sizeof(Place);
+    bool valid = read_directory([&](uint32_t off, void* dst, size_t n) {
+        return read_at(off, dst, n);
+    }, _db_file.size());
+    if (!valid) {
+        _db_file.close();
+        return false;
+    }
+
+    size_t db_size = _sec.file_size;
     Serial.printf("[PlacesDB] Database size: %.1f KB\n", db_size / 1024.0f);
 
-    // Try to allocate in PSRAM first
+    // Try PSRAM first; 16-byte alignment keeps the coordinate arrays aligned
+    uint8_t* image = nullptr;
     #ifdef BOARD_HAS_PSRAM
     if (psramFound()) {
-        _places = (Place*)ps_malloc(db_size);
-        if (_places) {
+        image = (uint8_t*)heap_caps_aligned_alloc(16, db_size, MALLOC_CAP_SPIRAM);
+        if (image) {
             _use_psram = true;
             Serial.println("[PlacesDB] Allocated in PSRAM");
         }
@@ -108,31 +1316,122 @@ bool places_db_init() {
     #endif
 
     // Fall back to regular malloc if no PSRAM
-    if (!_places) {
-        _places = (Place*)malloc(db_size);
-        if (_places) {
+    if (!image) {
+        image = (uint8_t*)heap_caps_aligned_alloc(16, db_size, MALLOC_CAP_8BIT);
+        if (image) {
             Serial.println("[PlacesDB] Allocated in SRAM (no PSRAM)");
         }
     }
 
-    // Load into memory if allocation succeeded
-    if (_places) {
-        size_t bytes_read = _db_file.read((uint8_t*)_places, db_size);
-        if (bytes_read != db_size) {
-            Serial.printf("[PlacesDB] ERROR: Read %zu bytes, expected %zu\n", bytes_read, db_size);
-            free(_places);
-            _places = nullptr;
+    if (!image) {
+        Serial.println("[PlacesDB] WARNING: No RAM for database, reading cells from file");
+        if (!setup_on_demand()) {
             _db_file.close();
             return false;
         }
-        _db_file.close();
-        Serial.println("[PlacesDB] Loaded full database into memory");
+        return true;
+    }
+
+    _db_file.close();
+    if (!asset_fs_load("/places.bin", image, db_size)) {
+        Serial.println("[PlacesDB] ERROR: Short read loading database");
+        heap_caps_free(image);
+        return false;
+    }
+    bind_sections(image);
+    if (!check_cells()) {
+        heap_caps_free(image);
+        _db = nullptr;
+        return false;
+    }
+    Serial.println("[PlacesDB] Loaded full database into memory");
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+bool places_db_init() {
+    Serial.println("[PlacesDB] Initializing...");
+
+    // Debug: Print partition info
+    const esp_partition_t* partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, "spiffs");
+
+    if (partition) {
+        Serial.printf("[PlacesDB] Found partition: offset=0x%x, size=%d KB\n",
+                      partition->address, partition->size / 1024);
     } else {
-        // Keep file open for on-demand reading
-        Serial.println("[PlacesDB] WARNING: Using on-demand file reading (slow)");
+        Serial.println("[PlacesDB] WARNING: 'spiffs' partition not found in partition table!");
+        Serial.println("[PlacesDB] Available partitions:");
+        esp_partition_iterator_t it = esp_partition_find(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, NULL);
+        while (it) {
+            const esp_partition_t* p = esp_partition_get(it);
+            Serial.printf("[PlacesDB]   - %s: type=%d, subtype=%d, offset=0x%x, size=%dKB\n",
+                          p->label, p->type, p->subtype, p->address, p->size/1024);
+            it = esp_partition_next(it);
+        }
     }
 
+    init_sin_table();
+    if (!_scan_lock) _scan_lock = xSemaphoreCreateMutex();
+
+    // Heap the load keeps, not counting the LittleFS mount in between
+    uint32_t sram_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    uint32_t psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    uint32_t kept_sram = 0, kept_psram = 0;
+    auto take_heap = [&]() {
+        kept_sram += max<int32_t>(0, sram_free - heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+        kept_psram += max<int32_t>(0, psram_free - heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    };
+
+    // Prefer the raw flash partition; LittleFS remains the fallback
+    uint32_t start = micros();
+    bool mapped = map_partition();
+    uint32_t read_us = micros() - start;
+    take_heap();
+
+    // Mount LittleFS (also used by settings, favorites and history)
+    if (!asset_fs_mount()) {
+        Serial.println("[PlacesDB] ERROR: Failed to mount LittleFS");
+        Serial.println("[PlacesDB] Trying to format...");
+        if (LittleFS.format() && asset_fs_mount()) {
+            Serial.println("[PlacesDB] Formatted successfully, but places.bin is now gone!");
+            Serial.println("[PlacesDB] Run 'pio run -t uploadfs' to re-upload places.bin");
+        } else {
+            Serial.println("[PlacesDB] Format failed - partition table may be wrong");
+        }
+        if (!mapped) return false;
+    }
+
+    sram_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    start = micros();
+    if (!mapped && !load_from_file()) {
+        return false;
+    }
+    read_us += micros() - start;
+
+    start = micros();
+    build_occupancy();
+    build_station_filter();
+    compute_fingerprint();
+    init_search();
+    init_countries();
+    init_view();
+    take_heap();
+    _load_stats.read_us = read_us;
+    _load_stats.build_us = micros() - start;
+    _load_stats.sram_bytes = kept_sram;
+    _load_stats.psram_bytes = kept_psram;
+    _load_stats.storage = _use_mmap ? "mapped" : !_db ? "file cells" : _use_psram ? "PSRAM" : "SRAM";
     _loaded = true;
+    Serial.printf("[PlacesDB] Loaded %lu places (%s) in %lu + %lu ms, keeping %lu KB SRAM, "
+                  "%lu KB PSRAM\n", (unsigned long)_place_count, _load_stats.storage,
+                  (unsigned long)(read_us / 1000), (unsigned long)(_load_stats.build_us / 1000),
+                  (unsigned long)(kept_sram / 1024), (unsigned long)(kept_psram / 1024));
+    Serial.printf("[PlacesDB] Index: %lu cells of %.2f°\n", _cell_count, _cell_size / 100.0f);
 
     // Print a sample place for verification
     if (_place_count > 0) {
@@ -152,215 +1451,358 @@ const Place* places_db_find_nearest(float lat, float lon) {
         return nullptr;
     }
 
-    // Convert target to scaled integers for faster comparison
-    int16_t target_lat = (int16_t)(lat * 100);
-    int16_t target_lon = (int16_t)(lon * 100);
+    PlaceHandle best;
+    if (search(make_target(lat, lon), 1, &best) == 0) return nullptr;
+    if (!decode_place(best, &_current_place)) return nullptr;
+    return &_current_place;
+}
 
-    const Place* nearest = nullptr;
-    int32_t min_dist_sq = INT32_MAX;
+int places_db_find_k_nearest(float lat, float lon, int k, PlaceHandle* out) {
+    if (!_loaded || _place_count == 0 || !out || k <= 0) {
+        return 0;
+    }
+    if (k > PLACES_MAX_K) k = PLACES_MAX_K;
 
-    if (_places) {
-        // Fast path: in-memory search
-        for (uint32_t i = 0; i < _place_count; i++) {
-            int32_t dlat = _places[i].lat_x100 - target_lat;
-            int32_t dlon = _places[i].lon_x100 - target_lon;
+    return search(make_target(lat, lon), k, out);
+}
 
-            // Handle longitude wraparound (-180 to 180)
-            if (dlon > 18000) dlon -= 36000;
-            if (dlon < -18000) dlon += 36000;
+int places_db_find_k_nearest_except(float lat, float lon, int k, const uint32_t* except,
+                                    PlaceHandle* out) {
+    if (!_loaded || _place_count == 0 || !out || k <= 0) {
+        return 0;
+    }
+    if (k > PLACES_MAX_K) k = PLACES_MAX_K;
 
-            // Squared distance (no sqrt needed for comparison)
-            int32_t dist_sq = dlat * dlat + dlon * dlon;
+    return search(make_target(lat, lon), k, out, except);
+}
 
-            if (dist_sq < min_dist_sq) {
-                min_dist_sq = dist_sq;
-                nearest = &_places[i];
-            }
-        }
-    } else {
-        // Slow path: read from file
-        _db_file.seek(PLACES_HEADER_SIZE);
-        uint32_t nearest_idx = 0;
-
-        for (uint32_t i = 0; i < _place_count; i++) {
-            Place temp;
-            if (_db_file.read((uint8_t*)&temp, sizeof(Place)) != sizeof(Place)) {
-                break;
-            }
+int places_db_find_k_nearest_by(PlacesSearch strategy, float lat, float lon, int k,
+                                PlaceHandle* out) {
+    if (!_loaded || _place_count == 0 || !out || k <= 0) {
+        return 0;
+    }
+    if (k > PLACES_MAX_K) k = PLACES_MAX_K;
 
-            int32_t dlat = temp.lat_x100 - target_lat;
-            int32_t dlon = temp.lon_x100 - target_lon;
+    return search_by(strategy, make_target(lat, lon), k, out);
+}
 
-            if (dlon > 18000) dlon -= 36000;
-            if (dlon < -18000) dlon += 36000;
+void places_db_set_search(PlacesSearch strategy) {
+    _strategy = strategy;
+}
 
-            int32_t dist_sq = dlat * dlat + dlon * dlon;
+PlacesSearch places_db_get_search() {
+    return _strategy;
+}
 
-            if (dist_sq < min_dist_sq) {
-                min_dist_sq = dist_sq;
-                nearest_idx = i;
-                memcpy(&_current_place, &temp, sizeof(Place));
-            }
-        }
-        nearest = &_current_place;
-    }
+bool places_db_get(PlaceHandle handle, Place* out) {
+    if (!_loaded || !out || handle >= _place_count) return false;
+    return decode_place(handle, out);
+}
 
-    return nearest;
+int places_db_read_coords(PlaceHandle first, int max, int16_t* lat_x100, int16_t* lon_x100) {
+    if (!_loaded || first >= _place_count || max <= 0) return 0;
+    uint32_t end = min(_place_count, (uint32_t)first + (uint32_t)max);
+    int copied = 0;
+    for_coords(first, end, [&](const int16_t* lat, const int16_t* lon, uint32_t, int n) {
+        memcpy(lat_x100 + copied, lat, n * sizeof(int16_t));
+        memcpy(lon_x100 + copied, lon, n * sizeof(int16_t));
+        copied += n;
+    });
+    return copied == (int)(end - first) ? copied : 0;
 }
 
-// Second temp buffer for excluding search (can't reuse _current_place)
-static Place _exclude_result;
+bool places_db_has_view() {
+    return _loaded && _view_tiles > 0;
+}
 
-const Place* places_db_find_nearest_excluding(float lat, float lon,
-    const String* exclude_ids, int num_exclude) {
-    if (!_loaded || _place_count == 0) {
-        return nullptr;
+bool places_db_for_view(int slice, int zoom, int x, int y, int w, int h,
+                        PlaceVisitFn fn, void* ctx) {
+    if (!places_db_has_view() || !fn || slice < 0 || slice >= _view.slices || zoom < 1) {
+        return false;
     }
+    // Read from the file, each place would cost two flash reads per draw;
+    // the caller's own tiles read the coordinates once
+    if (!_lat) return false;
+    // The rectangle's tiles: first and last column and row it touches
+    int slice_w = MAP_LAYOUT_WIDTH * zoom;
+    int slice_h = MAP_LAYOUT_HEIGHT * zoom;
+    int x0 = max(0, x), x1 = min(slice_w, x + w);
+    int y0 = max(0, y), y1 = min(slice_h, y + h);
+    if (x0 >= x1 || y0 >= y1) return true;
+    int col0 = x0 * _view.cols / slice_w, col1 = (x1 * _view.cols - 1) / slice_w;
+    int row0 = y0 * _view.rows / slice_h, row1 = (y1 * _view.rows - 1) / slice_h;
 
-    int16_t target_lat = (int16_t)(lat * 100);
-    int16_t target_lon = (int16_t)(lon * 100);
+    // A row's tiles are neighbours in VIEW, so their places are one run
+    uint32_t list = _sec.view + sizeof(PlacesView) + (_view_tiles + 1) * 2;
+    uint16_t handles[FILE_CHUNK];
+    for (int row = row0; row <= row1; row++) {
+        uint32_t t = ((uint32_t)slice * _view.rows + row) * _view.cols;
+        uint16_t first, end, unused;
+        if (!view_run(t + col0, &first, &unused) || !view_run(t + col1, &unused, &end)) {
+            return false;
+        }
+        while (first < end) {
+            int n = min((int)(end - first), FILE_CHUNK);
+            if (!section_read(list + first * 2, handles, n * 2)) return false;
+            for (int i = 0; i < n; i++) {
+                if (handles[i] >= _place_count) continue;
+                fn(handles[i], _lat[handles[i]], _lon[handles[i]], ctx);
+            }
+            first += n;
+        }
+    }
+    return true;
+}
 
-    const Place* nearest = nullptr;
-    int32_t min_dist_sq = INT32_MAX;
+bool places_db_has_stations(PlaceHandle handle) {
+    return _loaded && handle < _place_count && !place_skipped(handle);
+}
 
-    if (_places) {
-        // Fast path: in-memory search
-        for (uint32_t i = 0; i < _place_count; i++) {
-            bool excluded = false;
-            for (int e = 0; e < num_exclude; e++) {
-                if (strncmp(_places[i].id, exclude_ids[e].c_str(), 15) == 0) {
-                    excluded = true;
-                    break;
-                }
-            }
-            if (excluded) continue;
+uint32_t places_db_count() {
+    return _place_count;
+}
 
-            int32_t dlat = _places[i].lat_x100 - target_lat;
-            int32_t dlon = _places[i].lon_x100 - target_lon;
+bool places_db_loaded() {
+    return _loaded;
+}
 
-            if (dlon > 18000) dlon -= 36000;
-            if (dlon < -18000) dlon += 36000;
+bool places_db_load_stats(PlacesLoadStats* out) {
+    if (!_loaded) return false;
+    *out = _load_stats;
+    return true;
+}
 
-            int32_t dist_sq = dlat * dlat + dlon * dlon;
+uint32_t places_db_fingerprint() {
+    return _loaded ? _fingerprint : 0;
+}
 
-            if (dist_sq < min_dist_sq) {
-                min_dist_sq = dist_sq;
-                nearest = &_places[i];
-            }
-        }
-    } else {
-        // Slow path: read from file
-        _db_file.seek(PLACES_HEADER_SIZE);
+uint16_t places_db_cell(float lat, float lon) {
+    if (!_loaded) return PLACES_CELL_NONE;
+    return cell_id(cell_col((int16_t)(lon * 100)), cell_row((int16_t)(lat * 100)));
+}
 
-        for (uint32_t i = 0; i < _place_count; i++) {
-            Place temp;
-            if (_db_file.read((uint8_t*)&temp, sizeof(Place)) != sizeof(Place)) {
-                break;
-            }
+int places_db_cell_shift() {
+    return _loaded ? _cell_shift : 0;
+}
 
-            bool excluded = false;
-            for (int e = 0; e < num_exclude; e++) {
-                if (strncmp(temp.id, exclude_ids[e].c_str(), 15) == 0) {
-                    excluded = true;
-                    break;
-                }
-            }
-            if (excluded) continue;
+bool places_db_has_search() {
+    return _loaded && _search;
+}
 
-            int32_t dlat = temp.lat_x100 - target_lat;
-            int32_t dlon = temp.lon_x100 - target_lon;
+int places_db_search_prefix(const char* text, int max, PlaceHandle* out) {
+    if (!_loaded || !_search || !text || !out || max <= 0) return 0;
+    char key[PLACES_KEY_MAX + 1];
+    size_t len = fold_text(text, strlen(text), key);
+    return len ? search_prefix(key, len, max, out) : 0;
+}
 
-            if (dlon > 18000) dlon -= 36000;
-            if (dlon < -18000) dlon += 36000;
+int places_db_search_fuzzy(const char* text, int max, PlaceHandle* out) {
+    if (!_loaded || !_fuzzy || !text || !out || max <= 0) return 0;
+    if (max > PLACES_MAX_K) max = PLACES_MAX_K;
+    char key[PLACES_KEY_MAX + 1];
+    size_t len = fold_text(text, strlen(text), key);
+    return len ? search_fuzzy(key, len, max, out) : 0;
+}
 
-            int32_t dist_sq = dlat * dlat + dlon * dlon;
+int places_db_search(const char* text, int max, PlaceHandle* out) {
+    if (max > PLACES_MAX_K) max = PLACES_MAX_K;
+    int count = places_db_search_prefix(text, max, out);
+    if (count == max) return count;
 
-            if (dist_sq < min_dist_sq) {
-                min_dist_sq = dist_sq;
-                memcpy(&_exclude_result, &temp, sizeof(Place));
-                nearest = &_exclude_result;
-            }
-        }
+    PlaceHandle fuzzy[PLACES_MAX_K];
+    int n = places_db_search_fuzzy(text, max, fuzzy);
+    for (int i = 0; i < n && count < max; i++) {
+        bool listed = false;
+        for (int k = 0; k < count && !listed; k++) listed = out[k] == fuzzy[i];
+        if (!listed) out[count++] = fuzzy[i];
     }
+    return count;
+}
 
-    return nearest;
+bool places_db_has_countries() {
+    return _loaded && _countries;
 }
 
-uint32_t places_db_count() {
-    return _place_count;
+int places_db_country_of(PlaceHandle handle) {
+    if (!_loaded || !_countries || handle >= _place_count) return -1;
+    return place_country(handle);
 }
 
-bool places_db_loaded() {
-    return _loaded;
+bool places_db_country_name(int country, char* out, size_t cap) {
+    if (!_loaded || !out || cap == 0 || country < 0 || (uint32_t)country >= _ctry_count) {
+        return false;
+    }
+    uint32_t off = _ctry[country];
+    if (off >= _sec.str_size) return false;
+    if (_db) {
+        copy_utf8(out, _str + off, _sec.str_size - off, cap);
+        return true;
+    }
+    char buf[48];
+    size_t n = min((size_t)(_sec.str_size - off), min(cap, sizeof(buf)));
+    if (!read_at(_sec.str + off, buf, n)) return false;
+    copy_utf8(out, buf, n, min(cap, sizeof(buf)));
+    return true;
 }
 
-void places_db_serial_task() {
-    if (!Serial.available()) return;
+bool places_db_country_contains(int country, float lat, float lon) {
+    PlacesCountry c;
+    if (!_loaded || !country_entry(country, &c)) return false;
+    return box_contains(c, (int16_t)(lat * 100), (int16_t)(lon * 100));
+}
 
-    // Only handle our commands (L for lookup, D for debug/dump)
-    char cmd = Serial.peek();
-    if (cmd != 'L' && cmd != 'D') {
-        return;  // Let other handlers process it
+int places_db_country_best(int country, int k, PlaceHandle* out) {
+    PlacesCountry c;
+    if (!_loaded || !out || k <= 0 || !country_entry(country, &c)) return 0;
+    if (k > PLACES_MAX_K) k = PLACES_MAX_K;
+    // Without station counts the run is in file order, which follows the
+    // Hilbert curve: striding through it spreads the picks over the country
+    uint32_t step = _sec.scnt ? 1 : max((uint32_t)1, (uint32_t)c.count / k);
+    int count = 0;
+    for (uint32_t pos = c.first; pos < (uint32_t)c.first + c.count && count < k; pos += step) {
+        uint16_t p = read_u16(_sec.cplc + pos * 2);
+        if (p < _place_count && !place_skipped(p)) out[count++] = p;
     }
+    return count;
+}
 
-    String line = Serial.readStringUntil('\n');
-    line.trim();
+// ------------------------------------------------------------------
+// Serial commands
+// ------------------------------------------------------------------
 
-    // L:lat,lon - Find nearest place
-    if (line.startsWith("L:")) {
-        int comma = line.indexOf(',', 2);
-        if (comma > 0) {
-            float lat = line.substring(2, comma).toFloat();
-            float lon = line.substring(comma + 1).toFloat();
+// L:lat,lon - Find nearest place
+static void cmd_lookup(const char* args) {
+    const char* comma = strchr(args, ',');
+    if (comma) {
+        float lat = atof(args);
+        float lon = atof(comma + 1);
 
-            Serial.printf("[PlacesDB] Looking up (%.2f, %.2f)...\n", lat, lon);
+        Serial.printf("[PlacesDB] Looking up (%.2f, %.2f)...\n", lat, lon);
 
-            unsigned long start = micros();
-            const Place* place = places_db_find_nearest(lat, lon);
-            unsigned long elapsed = micros() - start;
+        unsigned long start = micros();
+        const Place* place = places_db_find_nearest(lat, lon);
+        unsigned long elapsed = micros() - start;
 
-            if (place) {
-                float place_lat = place->lat_x100 / 100.0f;
-                float place_lon = place->lon_x100 / 100.0f;
+        if (place) {
+            float place_lat = place->lat_x100 / 100.0f;
+            float place_lon = place->lon_x100 / 100.0f;
 
-                // Calculate approximate distance in km
-                float dlat = lat - place_lat;
-                float dlon = lon - place_lon;
-                if (dlon > 180) dlon -= 360;
-                if (dlon < -180) dlon += 360;
-                float dist_km = sqrtf(dlat * dlat + dlon * dlon) * 111.0f;  // ~111km per degree
+            SearchTarget t = make_target(lat, lon);
+            float found_h = hav_dist(place->lat_x100, place->lon_x100, t);
 
-                Serial.printf("[PlacesDB] Found: %s, %s\n", place->name, place->country);
-                Serial.printf("[PlacesDB]   ID: %s\n", place->id);
-                Serial.printf("[PlacesDB]   Location: (%.2f, %.2f)\n", place_lat, place_lon);
-                Serial.printf("[PlacesDB]   Distance: ~%.0f km\n", dist_km);
-                Serial.printf("[PlacesDB]   Search time: %lu us\n", elapsed);
-            } else {
-                Serial.println("[PlacesDB] No place found");
+            Serial.printf("[PlacesDB] Found: %s, %s\n", place->name, place->country);
+            Serial.printf("[PlacesDB]   ID: %s\n", place->id);
+            Serial.printf("[PlacesDB]   Location: (%.2f, %.2f)\n", place_lat, place_lon);
+            Serial.printf("[PlacesDB]   Distance: %.0f km\n", hav_km(found_h));
+            Serial.printf("[PlacesDB]   Search time: %lu us (%s)\n", elapsed,
+                          _use_mmap ? "mapped" : (_db ? "in memory" : "file cells"));
+
+            // Compare against the exact linear scan on the same query
+            if (_db) {
+                uint32_t lin = 0;
+                unsigned long lin_start = micros();
+                float lin_h = linear_find_nearest(t, &lin);
+                unsigned long lin_elapsed = micros() - lin_start;
+                Serial.printf("[PlacesDB]   Linear scan: %lu us%s\n", lin_elapsed,
+                              lin_h < found_h ? " (MISMATCH)" : "");
             }
         } else {
-            Serial.println("[PlacesDB] Usage: L:lat,lon (e.g., L:48.21,16.37)");
+            Serial.println("[PlacesDB] No place found");
         }
+    } else {
+        Serial.println("[PlacesDB] Usage: L:lat,lon (e.g., L:48.21,16.37)");
     }
-    // D:count - Dump/print first N places (D for debug)
-    else if (line.startsWith("D:")) {
-        int count = line.substring(2).toInt();
-        if (count <= 0) count = 5;
-        if (count > 20) count = 20;
-
-        Serial.printf("[PlacesDB] First %d places:\n", count);
-        if (_places) {
-            for (int i = 0; i < count && i < (int)_place_count; i++) {
-                Serial.printf("  %d. %s, %s (%.2f, %.2f) [%s]\n",
-                              i + 1,
-                              _places[i].name,
-                              _places[i].country,
-                              _places[i].lat_x100 / 100.0f,
-                              _places[i].lon_x100 / 100.0f,
-                              _places[i].id);
-            }
-        } else {
-            Serial.println("  (on-demand mode - not available)");
-        }
+}
+
+// D:count - Dump/print first N places (D for debug)
+static void cmd_dump(const char* args) {
+    int count = atoi(args);
+    if (count <= 0) count = 5;
+    if (count > 20) count = 20;
+
+    Serial.printf("[PlacesDB] First %d places:\n", count);
+    Place p;
+    for (int i = 0; i < count && i < (int)_place_count; i++) {
+        if (!places_db_get((PlaceHandle)i, &p)) break;
+        Serial.printf("  %d. %s, %s (%.2f, %.2f) [%s]\n",
+                      i + 1, p.name, p.country,
+                      p.lat_x100 / 100.0f, p.lon_x100 / 100.0f, p.id);
+    }
+}
+
+static void print_matches(const char* label, const PlaceHandle* found, int count,
+                          unsigned long elapsed) {
+    Serial.printf("[PlacesDB] %s: %d match(es) in %lu us\n", label, count, elapsed);
+    Place p;
+    for (int i = 0; i < count; i++) {
+        if (!places_db_get(found[i], &p)) break;
+        Serial.printf("  %d. %s, %s (%.2f, %.2f) [%s]\n", i + 1, p.name, p.country,
+                      p.lat_x100 / 100.0f, p.lon_x100 / 100.0f, p.id);
     }
 }
+
+// F:text - Find places by name, prefix then fuzzy matches
+static void cmd_find(const char* args) {
+    if (!args[0]) {
+        Serial.println("[PlacesDB] Usage: F:name (e.g., F:sao paulo, F:viena)");
+        return;
+    }
+    if (!places_db_has_search()) {
+        Serial.println("[PlacesDB] No search index (rebuild places.bin with compile_places.py)");
+        return;
+    }
+    char key[PLACES_KEY_MAX + 1];
+    fold_text(args, strlen(args), key);
+    Serial.printf("[PlacesDB] Searching \"%s\" (%s)\n", key,
+                  _use_mmap ? "mapped" : (_db ? "in memory" : "file reads"));
+
+    PlaceHandle found[10];
+    unsigned long start = micros();
+    int count = places_db_search_prefix(args, 10, found);
+    print_matches("Prefix", found, count, micros() - start);
+
+    start = micros();
+    count = places_db_search_fuzzy(args, 10, found);
+    print_matches("Fuzzy", found, count, micros() - start);
+}
+
+// C:lat,lon - Country of the nearest place and its best places
+static void cmd_country(const char* args) {
+    const char* comma = strchr(args, ',');
+    if (!comma) {
+        Serial.println("[PlacesDB] Usage: C:lat,lon (e.g., C:39.0,-98.0)");
+        return;
+    }
+    if (!places_db_has_countries()) {
+        Serial.println("[PlacesDB] No country index (rebuild places.bin with compile_places.py)");
+        return;
+    }
+    float lat = atof(args);
+    float lon = atof(comma + 1);
+    PlaceHandle nearest;
+    if (places_db_find_k_nearest(lat, lon, 1, &nearest) == 0) {
+        Serial.println("[PlacesDB] No place found");
+        return;
+    }
+    int country = places_db_country_of(nearest);
+    char name[48] = "?";
+    places_db_country_name(country, name, sizeof(name));
+    PlacesCountry c = {};
+    country_entry(country, &c);
+    Serial.printf("[PlacesDB] %s: %u place(s), box (%.2f..%.2f, %.2f..%.2f), tap %s\n",
+                  name, c.count, c.lat_min / 100.0f, c.lat_max / 100.0f,
+                  c.lon_min / 100.0f, c.lon_max / 100.0f,
+                  places_db_country_contains(country, lat, lon) ? "inside" : "outside");
+
+    PlaceHandle best[10];
+    unsigned long start = micros();
+    int count = places_db_country_best(country, 10, best);
+    print_matches("Best", best, count, micros() - start);
+}
+
+void places_db_serial_init() {
+    serial_cmd_register("L:", cmd_lookup);
+    serial_cmd_register("D:", cmd_dump);
+    serial_cmd_register("F:", cmd_find);
+    serial_cmd_register("C:", cmd_country);
+}
@@ -1,8 +1,9 @@
 /**
  * Radio.garden places database for RadioWall.
  *
- * Loads pre-compiled places.bin from LittleFS and provides
- * nearest-place lookup for touch coordinates.
+ * Maps pre-compiled places.bin from its own flash partition (or loads it
+ * from LittleFS as a fallback) and provides nearest-place lookup for
+ * touch coordinates.
  */
 
 #ifndef PLACES_DB_H
@@ -11,17 +12,85 @@
 #include <Arduino.h>
 #include "places_info.h"
 
-// Initialize the places database (loads from LittleFS)
+// Raw flash partition places.bin may be written to (see partitions.csv)
+#define PLACES_PARTITION_LABEL "places"
+
+// Initialize the places database (maps the "places" partition if flashed,
+// otherwise loads places.bin from LittleFS). Always mounts LittleFS.
 // Returns true on success, false if file not found or corrupt
 bool places_db_init();
 
-// Find the nearest place to given coordinates
+// Find the nearest place to given coordinates (great-circle distance).
+// Both searches skip places that places.bin lists with no stations.
 // Returns pointer to Place struct (valid until next call), or nullptr if DB not loaded
 const Place* places_db_find_nearest(float lat, float lon);
 
-// Find the nearest place excluding a list of place IDs (for next-city hopping)
-const Place* places_db_find_nearest_excluding(float lat, float lon,
-    const String* exclude_ids, int num_exclude);
+// How the nearest-place searches below find their places: the CELL
+// index's ring walk (the default), or a scan of every place on the
+// calling task or split over both cores. All three give the same result;
+// BENCH times them ("places.") so a board can keep the fastest, with
+// PLACES_SEARCH in config.h or places_db_set_search().
+enum PlacesSearch : uint8_t {
+    PLACES_SEARCH_INDEX,
+    PLACES_SEARCH_LINEAR,
+    PLACES_SEARCH_PARALLEL
+};
+#ifndef PLACES_SEARCH
+#define PLACES_SEARCH PLACES_SEARCH_INDEX
+#endif
+void places_db_set_search(PlacesSearch strategy);
+PlacesSearch places_db_get_search();
+
+// A place's record index in places.bin. Stable for a given database, so it
+// stands in for the 16-byte place ID wherever places are compared or kept.
+typedef uint16_t PlaceHandle;
+#define PLACE_NONE ((PlaceHandle)0xFFFF)
+
+// Maximum k accepted by places_db_find_k_nearest
+#define PLACES_MAX_K 32
+
+// Find the k nearest places, sorted by great-circle distance (nearest first).
+// Writes up to k handles (capped at PLACES_MAX_K) into out[] and returns the
+// count. Used as a next-city cursor: one query per touch, then step through.
+int places_db_find_k_nearest(float lat, float lon, int k, PlaceHandle* out);
+
+// The same, leaving out the places set in except, a bitset over handles
+// (bit h % 32 of word h / 32; places_db_count() bits). Lets a cursor go on
+// outward a batch at a time past the places it already holds. Set places
+// are still scanned, so a batch costs more the further out the cursor is.
+int places_db_find_k_nearest_except(float lat, float lon, int k, const uint32_t* except,
+                                    PlaceHandle* out);
+
+// The same by a given strategy rather than the selected one, for timing
+// them side by side (BENCH) without changing it under other tasks
+int places_db_find_k_nearest_by(PlacesSearch strategy, float lat, float lon, int k,
+                                PlaceHandle* out);
+
+// Copy a place's record (one record read in on-demand mode)
+// Returns false for PLACE_NONE or an out-of-range handle
+bool places_db_get(PlaceHandle handle, Place* out);
+
+// Copy the coordinates (degrees x 100) of up to max places from first on,
+// for overlays that walk every place. Returns the count copied, 0 past the
+// end or on a read error.
+int places_db_read_coords(PlaceHandle first, int max, int16_t* lat_x100, int16_t* lon_x100);
+
+// Places in a rectangle of a map slice, from places.bin's VIEW partition
+// (compile_places.py cuts each slice into a grid of tiles): fn gets every
+// place of each tile the rectangle overlaps with its coordinates (degrees
+// x 100), so some lie just outside it, and places without stations are
+// included. The rectangle is in pixels of the slice drawn at zoom, a
+// (MAP_LAYOUT_WIDTH * zoom) x (MAP_LAYOUT_HEIGHT * zoom) image. False
+// without the partition, when the places are read from the file on demand
+// (the caller's own tiles are cheaper then), or on a read error.
+typedef void (*PlaceVisitFn)(PlaceHandle handle, int16_t lat_x100, int16_t lon_x100, void* ctx);
+bool places_db_has_view();
+bool places_db_for_view(int slice, int zoom, int x, int y, int w, int h,
+                        PlaceVisitFn fn, void* ctx);
+
+// False for places places.bin lists with no stations (the ones the
+// searches skip); true for all places if it has no station counts
+bool places_db_has_stations(PlaceHandle handle);
 
 // Get place count (0 if not loaded)
 uint32_t places_db_count();
@@ -29,8 +98,74 @@ uint32_t places_db_count();
 // Check if database is loaded
 bool places_db_loaded();
 
-// Process serial commands for testing (call from loop)
-// Supports: L:lat,lon - find nearest place
-void places_db_serial_task();
+// What places_db_init() took: the time to map or read places.bin, the
+// time to build the load-time tables (occupancy, station filter, search
+// and view setup) and the heap it kept, internal and PSRAM. storage is
+// "mapped", "PSRAM", "SRAM" or "file cells" (on demand). BENCH prints it
+// with the places cases. False if not loaded.
+struct PlacesLoadStats {
+    uint32_t read_us;
+    uint32_t build_us;
+    uint32_t sram_bytes;
+    uint32_t psram_bytes;
+    const char* storage;
+};
+bool places_db_load_stats(PlacesLoadStats* out);
+
+// Hash of the place IDs in handle order (0 if not loaded). Files that store
+// data by PlaceHandle record it to detect a rebuilt places.bin.
+uint32_t places_db_fingerprint();
+
+// Index grid cell (its Hilbert index) under a point, for counters kept on
+// the search grid; PLACES_CELL_NONE if not loaded. Cell IDs change with
+// places_db_cell_shift(), the log2 of a cell's side in degrees x 100.
+#define PLACES_CELL_NONE 0xFFFF
+uint16_t places_db_cell(float lat, float lon);
+int places_db_cell_shift();
+
+// Name search, with places.bin's search index (compile_places.py). Case,
+// accents and punctuation are ignored: "sao paulo" finds São Paulo.
+// Places without stations are left out, as in the nearest-place searches.
+// False if the file has no index (all searches then return 0).
+bool places_db_has_search();
+
+// Places whose names start with text, in name order. Up to max handles
+// into out[]; returns the count.
+int places_db_search_prefix(const char* text, int max, PlaceHandle* out);
+
+// Places whose names share the most trigrams with text, best first:
+// catches misspellings and words inside names ("viena", "york"). max is
+// capped at PLACES_MAX_K.
+int places_db_search_fuzzy(const char* text, int max, PlaceHandle* out);
+
+// Prefix matches, then fuzzy ones not already listed (a search box's
+// result list). max is capped at PLACES_MAX_K.
+int places_db_search(const char* text, int max, PlaceHandle* out);
+
+// Country queries, with places.bin's country runs (compile_places.py).
+// False if the file has none (the other country calls then return -1,
+// false or 0).
+bool places_db_has_countries();
+
+// Country index of a place (its CTRY entry), -1 if unknown
+int places_db_country_of(PlaceHandle handle);
+
+// A country's full name, cut to fit cap bytes; false for a bad index
+bool places_db_country_name(int country, char* out, size_t cap);
+
+// True if (lat, lon) is inside the bounding box of the country's places,
+// with a degree to spare
+bool places_db_country_contains(int country, float lat, float lon);
+
+// The country's k best places, most stations first, skipping places
+// without stations; without station counts, k places spread over the
+// country. Reads only the country's run, never the whole file. k is
+// capped at PLACES_MAX_K.
+int places_db_country_best(int country, int k, PlaceHandle* out);
+
+// Register serial commands for testing
+// L:lat,lon - find nearest place, D:count - dump the first places,
+// F:text - search by name, C:lat,lon - country at a point
+void places_db_serial_init();
 
 #endif // PLACES_DB_H
@@ -12,12 +12,69 @@
 
 // Database info
 #define PLACES_DB_MAGIC     "RGPL"
-#define PLACES_DB_VERSION   1
+#define PLACES_DB_VERSION   3
 #define PLACES_COUNT        12486
 #define PLACES_STRUCT_SIZE  52
 #define PLACES_HEADER_SIZE  16
+#define PLACES_SECTION_SIZE 12
+#define PLACES_ID_BYTES     6
+#define PLACES_FOLD_FIRST   0x00C0   // FOLD table range (name search)
+#define PLACES_FOLD_LAST    0x024F
+#define PLACES_KEY_MAX      47       // Folded name bytes
 
-// Place structure (packed, 52 bytes)
+// File header (packed, 16 bytes), followed by section_count
+// PlacesSection entries
+typedef struct __attribute__((packed)) {
+    char magic[4];          // "RGPL"
+    uint16_t version;
+    uint16_t section_count;
+    uint32_t count;         // Places
+    uint8_t cell_shift;     // CELL index cell = 2^cell_shift hundredths of a degree
+    uint8_t reserved[3];
+} PlacesHeader;
+
+typedef struct __attribute__((packed)) {
+    char tag[4];            // "LAT ", "LON ", "PID ", "REF ", "CTRY", "STR ", "CELL", "SCNT",
+                            // "FOLD", "NAME", "TRIX", "TRIP", "CPLC", "CBOX", "VIEW"
+    uint32_t offset;        // From the start of the file, 16-byte aligned
+    uint32_t size;
+} PlacesSection;
+
+// CELL entry: first place of a non-empty index cell (Hilbert order)
+typedef struct __attribute__((packed)) {
+    uint16_t cell;
+    uint16_t first;
+} PlacesCell;
+
+// TRIX entry: postings of one trigram start at TRIP[first]
+typedef struct __attribute__((packed)) {
+    uint32_t gram;          // b0 << 16 | b1 << 8 | b2
+    uint32_t first;
+} PlacesGram;
+
+// CBOX entry: a country's run of CPLC and its bounding box (x100;
+// lon_min > lon_max when it crosses the antimeridian)
+typedef struct __attribute__((packed)) {
+    uint16_t first;
+    uint16_t count;
+    int16_t lat_min;
+    int16_t lat_max;
+    int16_t lon_min;
+    int16_t lon_max;
+} PlacesCountry;
+
+// VIEW header: each map slice cut into cols x rows equal tiles (tile of a
+// place: col = lon offset into the slice * cols / its span, row = (90 -
+// lat) * rows / 180), then a uint16 first entry per tile (slice, row,
+// col order) and a sentinel, then a uint16 place list in tile order
+typedef struct __attribute__((packed)) {
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t slices;         // MAP_SLICE_COUNT of the map it was built for
+    uint8_t reserved;
+} PlacesView;
+
+// Decoded place record (packed, 52 bytes)
 typedef struct __attribute__((packed)) {
     char id[16];        // Radio.garden place ID
     int16_t lat_x100;   // Latitude * 100
@@ -27,6 +84,8 @@ typedef struct __attribute__((packed)) {
 } Place;
 
 // Verify struct packing
+static_assert(sizeof(PlacesHeader) == PLACES_HEADER_SIZE, "PlacesHeader size mismatch");
+static_assert(sizeof(PlacesSection) == PLACES_SECTION_SIZE, "PlacesSection size mismatch");
 static_assert(sizeof(Place) == PLACES_STRUCT_SIZE, "Place struct size mismatch");
 
 #endif // PLACES_INFO_H
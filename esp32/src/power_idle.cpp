@@ -0,0 +1,137 @@
+/**
+ * Idle light sleep implementation for RadioWall.
+ *
+ * Each holder has its own pair of PM locks (no light sleep, CPU at max),
+ * so holders on different tasks never share a count: a hold is one
+ * acquire of each, a release one release of each.
+ */
+
+#include "power_idle.h"
+#include "serial_cmd.h"
+#include <freertos/FreeRTOS.h>
+
+#ifdef PM_LIGHT_SLEEP
+
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+static const int MIN_CPU_MHZ = 80;   // DFS floor: lowest clock WiFi keeps working at
+static const int HOLDERS = 3;
+static const char* const HOLD_NAMES[HOLDERS] = {"display", "touch", "button"};
+
+static bool _enabled = false;
+static int _max_mhz = 0;
+static esp_pm_lock_handle_t _no_sleep[HOLDERS];
+static esp_pm_lock_handle_t _cpu_max[HOLDERS];
+static uint8_t _held = 0;                 // PowerHold bits, guarded by _mux
+static uint32_t _holds[HOLDERS] = {};     // Times each was taken
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+static int holder_index(PowerHold who) {
+    return who == POWER_HOLD_DISPLAY ? 0 : who == POWER_HOLD_TOUCH ? 1 : 2;
+}
+
+static void take(int i) {
+    esp_pm_lock_acquire(_cpu_max[i]);
+    esp_pm_lock_acquire(_no_sleep[i]);
+    _holds[i]++;
+}
+
+static void give(int i) {
+    esp_pm_lock_release(_no_sleep[i]);
+    esp_pm_lock_release(_cpu_max[i]);
+}
+
+void power_idle_init() {
+    if (_enabled) return;
+    for (int i = 0; i < HOLDERS; i++) {
+        if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, HOLD_NAMES[i], &_no_sleep[i]) != ESP_OK ||
+            esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, HOLD_NAMES[i], &_cpu_max[i]) != ESP_OK) {
+            Serial.println("[PM] No power management in this build (CONFIG_PM_ENABLE)");
+            return;
+        }
+    }
+
+    // The display is lit from boot: hold it before the clock may drop
+    take(0);
+    _held = POWER_HOLD_DISPLAY;
+
+    _max_mhz = getCpuFrequencyMhz();
+    esp_pm_config_esp32s3_t cfg = {};
+    cfg.max_freq_mhz = _max_mhz;
+    cfg.min_freq_mhz = MIN_CPU_MHZ;
+    cfg.light_sleep_enable = true;
+    esp_err_t err = esp_pm_configure(&cfg);
+    if (err != ESP_OK) {
+        Serial.printf("[PM] Light sleep not available (%s, needs CONFIG_FREERTOS_USE_TICKLESS_IDLE)\n",
+                      esp_err_to_name(err));
+        give(0);
+        _held = 0;
+        return;
+    }
+    esp_sleep_enable_gpio_wakeup();
+    _enabled = true;
+    Serial.printf("[PM] Light sleep when idle, %d-%d MHz\n", MIN_CPU_MHZ, _max_mhz);
+}
+
+bool power_idle_enabled() {
+    return _enabled;
+}
+
+void power_idle_hold(PowerHold who, bool held) {
+    if (!_enabled) return;
+    bool was = (_held & who) != 0;   // Only this holder's task changes its bit
+    if (was == held) return;
+
+    int i = holder_index(who);
+    if (held) take(i);
+    else give(i);
+
+    portENTER_CRITICAL(&_mux);
+    _held = held ? (_held | who) : (_held & ~who);
+    portEXIT_CRITICAL(&_mux);
+}
+
+void power_idle_wake_on_low(int gpio) {
+    if (!_enabled) return;
+    gpio_wakeup_enable((gpio_num_t)gpio, GPIO_INTR_LOW_LEVEL);
+}
+
+// PM - Mode, clock range and who holds the chip awake
+static void cmd_pm(const char*) {
+    if (!_enabled) {
+        Serial.println("[PM] Off: no light sleep support in this build");
+        return;
+    }
+    Serial.printf("[PM] Light sleep when idle, %d-%d MHz\n", MIN_CPU_MHZ, _max_mhz);
+    for (int i = 0; i < HOLDERS; i++) {
+        Serial.printf("[PM] %-7s %-8s taken %lu time(s)\n", HOLD_NAMES[i],
+                      (_held & (1 << i)) ? "holding" : "released", (unsigned long)_holds[i]);
+    }
+#ifdef CONFIG_PM_PROFILING
+    esp_pm_dump_locks(stdout);
+#endif
+}
+
+#else
+
+void power_idle_init() {}
+
+bool power_idle_enabled() {
+    return false;
+}
+
+void power_idle_hold(PowerHold, bool) {}
+
+void power_idle_wake_on_low(int) {}
+
+static void cmd_pm(const char*) {
+    Serial.println("[PM] Off (build with -DPM_LIGHT_SLEEP)");
+}
+
+#endif // PM_LIGHT_SLEEP
+
+void power_idle_serial_init() {
+    serial_cmd_register("PM", cmd_pm);
+}
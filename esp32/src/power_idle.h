@@ -0,0 +1,45 @@
+/**
+ * Idle light sleep for RadioWall (opt-in, -DPM_LIGHT_SLEEP).
+ *
+ * With nothing to do, the loop task and the touch reader block on their
+ * notifications, so FreeRTOS tickless idle can light-sleep the chip
+ * between events while WiFi keeps its association in modem sleep. Parts
+ * that need the full clock or must not sleep hold the chip awake: the lit
+ * display (the backlight PWM stops in light sleep), a finger on the panel
+ * and the button state machine. With no holder it sleeps at the DFS
+ * minimum clock, and the touch INT line going low wakes it within a
+ * millisecond.
+ *
+ * Needs CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE in the
+ * IDF config; without them power_idle_init() says so and nothing changes.
+ */
+
+#ifndef POWER_IDLE_H
+#define POWER_IDLE_H
+
+#include <Arduino.h>
+
+enum PowerHold : uint8_t {
+    POWER_HOLD_DISPLAY = 0x01,   // Backlight on (held from boot)
+    POWER_HOLD_TOUCH   = 0x02,   // Finger down
+    POWER_HOLD_BUTTON  = 0x04,   // Press being timed
+};
+
+// Configure DFS and light sleep (setup(), before the touch and button init)
+void power_idle_init();
+
+// True when the clock is managed here: callers leave setCpuFrequencyMhz() alone
+bool power_idle_enabled();
+
+// Hold the chip awake at full clock, or let go. Each holder calls it from
+// one task only; a repeated call with the same state does nothing.
+void power_idle_hold(PowerHold who, bool held);
+
+// A pin whose low level should end a light sleep. This sets its GPIO
+// interrupt to level-low too, so its ISR must mask itself until serviced.
+void power_idle_wake_on_low(int gpio);
+
+// Register the PM serial command (mode, clock range, holders)
+void power_idle_serial_init();
+
+#endif // POWER_IDLE_H
@@ -3,305 +3,1349 @@
  */
 
 #include "radio_client.h"
+#include "config.h"
 #include "places_db.h"
 #include "linkplay_client.h"
-#include <WiFiClientSecure.h>
+#include "https_pool.h"
+#include "dns_cache.h"
+#include "stream_cache.h"
+#include "peer_cache.h"
+#include "mqtt_client.h"
+#include "stream_probe.h"
+#include "inflate_stream.h"
+#include "metrics_http.h"
+#include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include "station_catalog.h"
+#include "trace.h"
+#include "binlog.h"
+#include "replay.h"
+#include "metrics.h"
+#include "json_arena.h"
+#include "station_stats.h"
+#include "tap_heat.h"
 #include <ArduinoJson.h>
+#include <StreamString.h>
 
 // Radio.garden API host
 static const char* RADIO_GARDEN_HOST = "radio.garden";
 
 // Current state
 static StationInfo _current_station;
-static String _current_place_id;
 static int _current_station_index = 0;   // Next station to play (0-based)
 static int _playing_station_index = -1;  // Currently playing station (0-based, -1 = none)
 static int _total_stations = 0;
 
-// Cache of station IDs for current place (for "next" functionality)
-static const int MAX_CACHED_STATIONS = 100;
-static String _cached_station_ids[MAX_CACHED_STATIONS];
-static String _cached_station_titles[MAX_CACHED_STATIONS];
+// LRU cache of parsed station lists, keyed by place handle. Each list is
+// its stations' packed records (station_pack.h), grown as the channels
+// body is parsed: about 30 bytes a station where a fixed record took 80,
+// so four times the places fit in what eight used to reserve. One entry
+// in SRAM, of at most MAX_CACHED_STATIONS, if PSRAM is unavailable.
+// The current place's list (for "next" functionality) is one of the entries.
+// The peer cache server reads entries from its own task
+// (radio_copy_station_list): lists are filled while unpublished (place
+// PLACE_NONE) and published or retired under _cache_mux.
+static const int MAX_CACHED_STATIONS = 100;   // Without PSRAM; LAN and catalogue lists
+static const int MAX_LIST_STATIONS = 500;
+static const int STATION_CACHE_PLACES = 32;
+static const uint16_t HOT_CELL_TAPS = 3;    // Lists from cells tapped this often are kept
+static const unsigned long STATION_CACHE_TTL_MS = 30UL * 60 * 1000;  // 30 min
+
+struct PlaceStations {
+    PlaceHandle place;          // PLACE_NONE = unused entry
+    uint16_t cell;              // places_db_cell of the place, for its tap heat
+    unsigned long fetched_at;   // millis() of the channels fetch
+    unsigned long last_used;    // millis() of the last lookup (LRU)
+    bool from_catalog;          // Read from stations.bin, not fetched yet
+    bool partial;               // Body cut short: refetch like a catalogue list
+    PackedList stations;
+};
+
+static PlaceStations* _station_cache = nullptr;
+static int _station_cache_size = 0;
+static PlaceStations* _current_list = nullptr;   // Stations of the current place
+static portMUX_TYPE _cache_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Next-city hopping state: distance-sorted cursor from the touch point,
+// filled a batch at a time. Entry 0 is the touched city itself. Every city
+// the cursor takes is set in a bitset over place handles, and the next
+// batch is the nearest cities not set in it, so NEXT keeps hopping
+// outward at the cost of one search per batch.
+static const int CITY_BATCH = 20;
+static PlaceHandle _city_cursor[CITY_BATCH + 1];   // A refill keeps the current city first
+static int _city_count = 0;
+static int _city_pos = 0;   // Cursor index of the current city
+static uint32_t* _city_seen = nullptr;   // places_db_count() bits
+static uint32_t _city_seen_words = 0;
+static bool _city_more = false;          // Refill from _city_lat/_city_lon
+static float _city_lat = 0, _city_lon = 0;
+
+// Country play (radio_play_country): the cursor holds the country's best
+// cities instead, and each plays at most this many stations before NEXT
+// hops on, so a rotation covers the country rather than one big city
+static const int COUNTRY_CITY_STATIONS = 3;
+static int _city_budget = 0;   // Stations per city, 0: all of them
+
+// Speculative prefetch while a station plays (see radio_client_task)
+static const unsigned long PREFETCH_DELAY_MS = 3000;  // Let playback settle first
+static const int PREFETCH_CITY_THRESHOLD = 2;         // Stations left before next city
+static const uint32_t REFRESH_URL_AGE_S = 12UL * 60 * 60;  // Idle refresh re-resolves after
+static unsigned long _last_play_ms = 0;
+static bool _prefetch_pending = false;
+static char _prefetch_id[16] = "";     // Station the prefetched URL belongs to
+static String _prefetch_url;           // Empty if the prefetch failed
+static bool _prefetch_seeded = false;  // URL came from radio_seed_stream_url()
+
+static String _playing_url;            // Stream the WiiM was last handed
+
+// A tap's first station can play while its list is still being parsed
+// (see play_first_early)
+static bool _list_loading = false;     // Stations still arriving behind the play
+static int _early_play = 0;            // 1 played early, -1 tried and failed
+
+// Station queue handed to the WiiM (see radio_client.h); 0 disables it
+#ifndef STATION_QUEUE_LENGTH
+#define STATION_QUEUE_LENGTH 0
+#endif
+static const int QUEUE_MAX = 8;
+static const int QUEUE_LENGTH = STATION_QUEUE_LENGTH < QUEUE_MAX ? STATION_QUEUE_LENGTH : QUEUE_MAX;
+static PlaceStations* _queue_list = nullptr;   // List the queue was built from
+static int _queue_first = 0;    // Station index of entry 0
+static int _queue_len = 0;      // 0: no queue
+static int _queue_pos = 0;      // Entry playing
+static uint16_t _queue_seq = 0; // Bumped per queue (defeats playlist caching)
+static char _queue_m3u[RADIO_QUEUE_M3U_MAX];   // Served by metrics_http
+static portMUX_TYPE _queue_mux = portMUX_INITIALIZER_UNLOCKED;
+// Stations resolved ahead, tried or not: a queue's worth, so failures in
+// the window are not retried in turn
+static char _refill_ids[QUEUE_MAX][16];
+static int _refill_next = 0;
+
+// Liveness probe before playing (see pick_live_station)
+static const unsigned long STREAM_PROBE_TIMEOUT_MS = 2000;
+static const int STREAM_PROBE_ROUNDS = 2;   // Dead batches skipped per NEXT
+
+// Request timeout for radio.garden
+static const unsigned long RG_TIMEOUT_MS = 10000;
+
+// Polled between requests; true means a newer play request superseded this one
+static bool (*_cancel_cb)() = nullptr;
+
+// Early looks at a play request still running (see radio_set_preview_callback)
+static void (*_preview_cb)(const StationInfo*, int, int) = nullptr;
+
+// Stages reached by a play request (see radio_set_progress_callback)
+static void (*_progress_cb)(RadioStage) = nullptr;
+
+static void progress(RadioStage stage) {
+    if (_progress_cb) _progress_cb(stage);
+}
+
+static bool cancelled() {
+    if (_cancel_cb && _cancel_cb()) {
+        Serial.println("[Radio] Superseded, abandoning request");
+        return true;
+    }
+    return false;
+}
+
+// Stream URL there without a request: prefetched, seeded or cached
+static bool stream_url_known(const char* station_id) {
+    return (_prefetch_url.length() > 0 && strcmp(_prefetch_id, station_id) == 0) ||
+           stream_cache_get(station_id) != nullptr;
+}
 
-// Next-city hopping state
-static float _touch_origin_lat = 0;
-static float _touch_origin_lon = 0;
-static const int MAX_VISITED_CITIES = 20;
-static String _visited_place_ids[MAX_VISITED_CITIES];
-static int _num_visited = 0;
+static String listen_path(const char* station_id) {
+    return "/api/ara/content/listen/" + String(station_id) + "/channel.mp3";
+}
 
-// Make HTTPS request to radio.garden
-static String https_get(const char* path) {
-    WiFiClientSecure client;
-    client.setInsecure();  // Radio.garden uses valid cert, but skip verification for simplicity
+// Peers and the assist server are left out while a session is recorded
+// or replayed, so replays see the same answers as the recording
+static bool lan_allowed() {
+    return !replay_recording() && !replay_playing();
+}
 
-    Serial.printf("[Radio] GET https://%s%s\n", RADIO_GARDEN_HOST, path);
+// Stream URL behind a station's channel.mp3 redirect (follows the Location
+// header): from another frame's cache or the assist server if one has
+// it, else from radio.garden. Hedged: a slow radio.garden edge gets a second copy of the
+// request instead of the full timeout.
+static String get_redirect_url(const char* station_id) {
+    TraceScope span(TRACE_REDIRECT);
+    String path_str = listen_path(station_id);
+    const char* path = path_str.c_str();
+    String replayed;
+    if (replay_response(REPLAY_REDIRECT, path, &replayed)) return replayed;
+    String shared;
+    if (lan_allowed() && (peer_cache_get_url(station_id, &shared) ||
+                          mqtt_assist_get_url(station_id, &shared))) {
+        return shared;
+    }
 
-    if (!client.connect(RADIO_GARDEN_HOST, 443, 10000)) {
-        Serial.println("[Radio] Connection failed");
+    unsigned long start = millis();
+    HttpResponse resp;
+    HttpsConn* conn = https_request_hedged(RADIO_GARDEN_HOST, path, nullptr, resp, RG_TIMEOUT_MS);
+    if (!conn) {
+        replay_record_response(REPLAY_REDIRECT, path, "", millis() - start);
         return "";
     }
 
-    // Send request - use HTTP/1.0 to avoid chunked encoding
-    client.printf("GET %s HTTP/1.0\r\n", path);
-    client.printf("Host: %s\r\n", RADIO_GARDEN_HOST);
-    client.println("User-Agent: RadioWall/1.0");
-    client.println("Accept: application/json");
-    client.println("Connection: close");
-    client.println();
-
-    // Wait for response
-    unsigned long timeout = millis() + 10000;
-    while (client.connected() && !client.available()) {
-        if (millis() > timeout) {
-            Serial.println("[Radio] Response timeout");
-            client.stop();
-            return "";
+    // Drain the (small) redirect body so the connection can be reused
+    bool complete = https_read_body(conn, resp, nullptr);
+    https_release(conn, complete && resp.keep_alive);
+    replay_record_response(REPLAY_REDIRECT, path, resp.location, millis() - start);
+    return resp.location;
+}
+
+// Forward declarations
+static bool fetch_and_play_place(PlaceHandle handle);
+static void queue_clear();
+static bool radio_play_next_city();
+
+// ------------------------------------------------------------------
+// Station list cache
+// ------------------------------------------------------------------
+
+static void station_cache_init() {
+    if (_station_cache) return;
+
+    #ifdef BOARD_HAS_PSRAM
+    if (psramFound()) {
+        _station_cache = (PlaceStations*)ps_calloc(STATION_CACHE_PLACES, sizeof(PlaceStations));
+        if (_station_cache) _station_cache_size = STATION_CACHE_PLACES;
+    }
+    #endif
+    if (!_station_cache) {
+        // No PSRAM: only the current place's list, no caching across places
+        _station_cache = (PlaceStations*)calloc(1, sizeof(PlaceStations));
+        _station_cache_size = _station_cache ? 1 : 0;
+    }
+    for (int i = 0; i < _station_cache_size; i++) {
+        _station_cache[i].place = PLACE_NONE;
+    }
+    Serial.printf("[Radio] Station cache: %d places\n", _station_cache_size);
+}
+
+static int station_count(const PlaceStations* list) {
+    return list->stations.count;
+}
+
+static StationRecord station_at(const PlaceStations* list, int index) {
+    return packed_list_get(list->stations, index);
+}
+
+// Make a list visible to radio_copy_station_list() under a place, or
+// (PLACE_NONE) hide it before it is rewritten
+static void station_cache_publish(PlaceStations* list, PlaceHandle place) {
+    Place p;
+    uint16_t cell = place != PLACE_NONE && places_db_get(place, &p)
+                        ? places_db_cell(p.lat_x100 / 100.0f, p.lon_x100 / 100.0f)
+                        : PLACES_CELL_NONE;
+    portENTER_CRITICAL(&_cache_mux);
+    list->place = place;
+    list->cell = cell;
+    portEXIT_CRITICAL(&_cache_mux);
+}
+
+// Empty a list, giving back its records
+static void station_list_reset(PlaceStations* list) {
+    packed_list_clear(list->stations);
+}
+
+// Store the next station of a list. False when the list is full.
+static bool station_append(PlaceStations* list, const StationRecord& rec) {
+    int max = psramFound() ? MAX_LIST_STATIONS : MAX_CACHED_STATIONS;
+    if (station_count(list) >= max) return false;
+    return packed_list_add(list->stations, rec.id, rec.title);
+}
+
+// Fresh cached list for a place, or nullptr
+static PlaceStations* station_cache_find(PlaceHandle place) {
+    unsigned long now = millis();
+    for (int i = 0; i < _station_cache_size; i++) {
+        PlaceStations& e = _station_cache[i];
+        if (e.place == place && place != PLACE_NONE) {
+            if (now - e.fetched_at > STATION_CACHE_TTL_MS) {
+                return nullptr;   // Expired: refetch into the same slot
+            }
+            e.last_used = now;
+            return &e;
         }
-        delay(10);
     }
+    return nullptr;
+}
 
-    // Skip HTTP headers, check for chunked encoding
-    bool chunked = false;
-    while (client.available()) {
-        String line = client.readStringUntil('\n');
-        if (line.indexOf("Transfer-Encoding: chunked") >= 0) {
-            chunked = true;
+// Taps in the grid cell of a place not cached yet (tap_heat)
+static uint16_t place_heat(PlaceHandle place) {
+    Place p;
+    if (place == PLACE_NONE || !places_db_get(place, &p)) return 0;
+    return tap_heat_at(p.lat_x100 / 100.0f, p.lon_x100 / 100.0f);
+}
+
+// Slot to fetch a place into: its own (expired) entry, an empty or expired
+// one, or the least recently used, sparing lists in hot cells while a
+// colder one is left. Keeps the current list unless it's the only entry.
+// A speculative load gets nullptr rather than drop a live list from a cell
+// tapped more often than its own.
+static PlaceStations* station_cache_slot(PlaceHandle place, bool speculative = false) {
+    for (int i = 0; i < _station_cache_size; i++) {
+        if (_station_cache[i].place == place && place != PLACE_NONE) return &_station_cache[i];
+    }
+
+    unsigned long now = millis();
+    PlaceStations* victim = nullptr;
+    uint16_t victim_heat = 0;
+    for (int i = 0; i < _station_cache_size; i++) {
+        PlaceStations& e = _station_cache[i];
+        if (&e == _current_list && _station_cache_size > 1) continue;
+        if (e.place == PLACE_NONE || now - e.fetched_at > STATION_CACHE_TTL_MS) return &e;
+        uint16_t heat = tap_heat_cell(e.cell);
+        bool hot = heat >= HOT_CELL_TAPS;
+        bool victim_hot = victim_heat >= HOT_CELL_TAPS;
+        if (!victim || (victim_hot && !hot) ||
+            (hot == victim_hot && e.last_used < victim->last_used)) {
+            victim = &e;
+            victim_heat = heat;
         }
-        if (line == "\r" || line.length() == 0) {
-            break;  // End of headers
+    }
+    if (speculative && victim && place_heat(place) < victim_heat) return nullptr;
+    return victim;
+}
+
+bool radio_copy_station_list(PlaceHandle place, StationRecord* out, int cap,
+                             int* count, int* total, uint32_t* age_ms) {
+    if (place == PLACE_NONE || cap <= 0) return false;
+
+    // Only the packed bytes are copied under the spinlock; the records are
+    // unpacked once it is released
+    size_t bytes = (size_t)cap * STATION_PACK_MAX;
+    uint8_t* packed = (uint8_t*)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+    if (!packed) return false;
+
+    unsigned long now = millis();
+    bool found = false;
+    size_t used = 0;
+    portENTER_CRITICAL(&_cache_mux);
+    for (int i = 0; i < _station_cache_size && !found; i++) {
+        PlaceStations& e = _station_cache[i];
+        if (e.place != place || e.from_catalog || e.partial ||
+            now - e.fetched_at > STATION_CACHE_TTL_MS) {
+            continue;
         }
+        const PackedList& list = e.stations;
+        *count = min(list.count, cap);
+        for (int r = 0; r < *count; r++) {
+            const uint8_t* rec = list.data + list.at[r];
+            size_t size = station_record_size(rec, list.used - list.at[r]);
+            memcpy(packed + used, rec, size);
+            used += size;
+        }
+        *total = list.count;
+        *age_ms = now - e.fetched_at;
+        found = true;
+    }
+    portEXIT_CRITICAL(&_cache_mux);
+
+    size_t pos = 0;
+    for (int r = 0; found && r < *count; r++) {
+        size_t size = station_unpack(packed + pos, used - pos, &out[r]);
+        if (size == 0) {   // Like packed_list_get(): a bad record reads as empty
+            out[r].id[0] = '\0';
+            out[r].title[0] = '\0';
+        }
+        pos += size;
     }
+    free(packed);
+    return found;
+}
 
-    // Read body
-    String body = "";
-    if (chunked) {
-        // Handle chunked transfer encoding
-        while (client.connected() || client.available()) {
-            // Read chunk size (hex)
-            String chunkSizeLine = client.readStringUntil('\n');
-            chunkSizeLine.trim();
-            int chunkSize = strtol(chunkSizeLine.c_str(), NULL, 16);
-            if (chunkSize == 0) break;  // End of chunks
-
-            // Read chunk data
-            while (chunkSize > 0 && (client.connected() || client.available())) {
-                if (client.available()) {
-                    body += (char)client.read();
-                    chunkSize--;
-                }
+/**
+ * Channels body as seen by the JSON parser, watching the raw bytes for the
+ * first "url":"/listen/{slug}/{id}". As soon as it has gone past, that
+ * station's redirect is pipelined on the same connection, so radio.garden
+ * answers it right after the channels body instead of one round trip later.
+ */
+class RedirectPipeliner : public Stream {
+public:
+    RedirectPipeliner(Stream& body, HttpsConn* conn, const HttpResponse& resp)
+        : _body(body), _conn(conn), _armed(resp.keep_alive) {}
+
+    int available() override { return _body.available(); }
+    int peek() override { return _body.peek(); }
+    size_t write(uint8_t) override { return 0; }
+
+    int read() override {
+        int c = _body.read();
+        if (c >= 0 && _armed) scan((char)c);
+        return c;
+    }
+
+    // Station whose redirect was sent, or nullptr
+    const char* pipelined() const { return _id[0] ? _id : nullptr; }
+
+private:
+    void scan(char c) {
+        static const char PATTERN[] = "\"url\":\"/listen/";
+        if (_match < sizeof(PATTERN) - 1) {
+            if (c == PATTERN[_match]) {
+                _match++;
+            } else {
+                _match = (c == PATTERN[0]) ? 1 : 0;
             }
-            // Skip trailing \r\n after chunk
-            client.readStringUntil('\n');
+            return;
         }
-    } else {
-        // Regular body
-        while (client.connected() || client.available()) {
-            if (client.available()) {
-                body += (char)client.read();
-            }
+        // Capturing "{slug}/{id}" up to the closing quote
+        if (c != '"' && _len < sizeof(_url) - 1) {
+            _url[_len++] = c;
+            return;
+        }
+        _url[_len] = '\0';
+        _armed = false;
+        const char* id = strchr(_url, '/');
+        if (c != '"' || !id || id == _url || !id[1] || strlen(id + 1) >= sizeof(_id)) return;
+        if (stream_url_known(id + 1)) return;   // Nothing to resolve
+        if (https_pipeline(_conn, listen_path(id + 1).c_str(), nullptr)) {
+            strcpy(_id, id + 1);
         }
     }
-    client.stop();
-    return body;
+
+    Stream& _body;
+    HttpsConn* _conn;
+    bool _armed;            // Still looking (and the connection stays open)
+    size_t _match = 0;      // PATTERN bytes matched so far
+    char _url[64];
+    size_t _len = 0;
+    char _id[16] = "";
+};
+
+// Station ID and title of one channels item; false if it is not a station
+static bool station_from_page(const char* title, const char* url, StationRecord* rec) {
+    if (!title || !url) return false;
+
+    // URL is /listen/{slug}/{id}
+    const char* listen = strstr(url, "/listen/");
+    const char* id = listen ? strchr(listen + 8, '/') : nullptr;
+    if (!id || id == listen + 8 || !id[1]) return false;
+    strncpy(rec->id, id + 1, sizeof(rec->id) - 1);
+    rec->id[sizeof(rec->id) - 1] = '\0';
+    strncpy(rec->title, title, sizeof(rec->title) - 1);
+    rec->title[sizeof(rec->title) - 1] = '\0';
+    return true;
 }
 
-// Get redirect URL for stream (follows Location header)
-static String get_redirect_url(const char* path) {
-    WiFiClientSecure client;
-    client.setInsecure();
+/**
+ * Walks a channels body one station at a time. Each entry of an "items"
+ * array is parsed on its own as it comes off the socket, so the first
+ * station can be used while the rest is still arriving, and the page never
+ * needs a document of its own.
+ */
+class StationCursor {
+public:
+    explicit StationCursor(Stream& body) : _body(body), _doc(JSON_ARENA_STATION) {
+        _filter["page"]["title"] = true;
+        _filter["page"]["url"] = true;
+    }
 
-    if (!client.connect(RADIO_GARDEN_HOST, 443, 10000)) {
-        return "";
+    // Next station; false at the end of the body or on a parse error
+    bool next(StationRecord* rec) {
+        while (!_error) {
+            if (!_in_items && !seek_items()) return false;
+            int c = skip_separators();
+            if (c == ']') {
+                _body.read();
+                _in_items = false;
+                continue;
+            }
+            if (c != '{') {
+                _error = c < 0 ? DeserializationError::IncompleteInput
+                               : DeserializationError::InvalidInput;
+                break;
+            }
+            _doc.clear();
+            _error = deserializeJson(_doc, _body, DeserializationOption::Filter(_filter));
+            if (!_error && station_from_page(_doc["page"]["title"], _doc["page"]["url"], rec)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    DeserializationError error() const { return _error; }
+
+private:
+    // Past the next "items":[ of the body; false at its end
+    bool seek_items() {
+        static const char KEY[] = "\"items\"";
+        size_t match = 0;
+        for (;;) {
+            int c = _body.read();
+            if (c < 0) return false;
+            if (match < sizeof(KEY) - 1) {
+                match = (c == KEY[match]) ? match + 1 : (c == KEY[0]) ? 1 : 0;
+            } else if (c == '[') {
+                _in_items = true;
+                return true;
+            } else if (c != ':' && c != ' ') {
+                match = (c == KEY[0]) ? 1 : 0;
+            }
+        }
+    }
+
+    int skip_separators() {
+        int c;
+        while ((c = _body.peek()) == ',' || c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            _body.read();
+        }
+        return c;
     }
 
-    client.printf("GET %s HTTP/1.0\r\n", path);
-    client.printf("Host: %s\r\n", RADIO_GARDEN_HOST);
-    client.println("User-Agent: RadioWall/1.0");
-    client.println("Connection: close");
-    client.println();
+    Stream& _body;
+    StaticJsonDocument<128> _filter;
+    JsonArenaDoc _doc;        // One filtered item at a time
+    bool _in_items = false;
+    DeserializationError _error = DeserializationError::Ok;
+};
+
+/**
+ * Store the stations of a channels body into entry as the cursor yields
+ * them. on_first (optional) gets the list as soon as its first station is
+ * in, ahead of the rest of the body. When the list is full the rest is
+ * parsed but dropped.
+ */
+static DeserializationError read_stations(Stream& body, PlaceStations* entry,
+                                          void (*on_first)(PlaceStations*)) {
+    StationCursor cursor(body);
+    StationRecord rec;
+    int dropped = 0;
+    while (cursor.next(&rec)) {
+        if (!station_append(entry, rec)) {
+            dropped++;
+            continue;
+        }
+        if (station_count(entry) == 1 && on_first) on_first(entry);
+    }
+    if (dropped) Serial.printf("[Radio] List full, %d stations dropped\n", dropped);
+    return cursor.error();
+}
+
+// A body that ended early still leaves a usable list behind: keep what
+// was parsed and let the prefetcher fetch it in full
+static bool keep_station_list(PlaceStations* entry, DeserializationError error, bool complete) {
+    if (error || !complete) {
+        if (station_count(entry) == 0) {
+            Serial.printf("[Radio] Station list failed: %s\n",
+                          error ? error.c_str() : "body cut short");
+            return false;
+        }
+        Serial.printf("[Radio] Station list cut short (%s), keeping %d\n",
+                      error ? error.c_str() : "body", station_count(entry));
+        entry->partial = true;
+    }
+    return true;
+}
 
-    unsigned long timeout = millis() + 10000;
-    while (client.connected() && !client.available()) {
-        if (millis() > timeout) {
-            client.stop();
-            return "";
+/**
+ * Fetch and parse the channels page of a place into a cache entry.
+ * With pipeline_first, the first station's stream redirect rides on the
+ * same connection and its URL is left in the prefetch slot for
+ * radio_play_next(). on_first: see read_stations(). Returns false (entry
+ * left unused) on network failure or if no station could be parsed.
+ */
+static bool fetch_station_list(PlaceHandle handle, const Place& place, PlaceStations* entry,
+                               bool pipeline_first = false,
+                               void (*on_first)(PlaceStations*) = nullptr) {
+    TraceScope span(TRACE_CHANNELS);
+    station_cache_publish(entry, PLACE_NONE);
+    station_list_reset(entry);
+    entry->from_catalog = false;
+    entry->partial = false;
+
+    String path = "/api/ara/content/page/" + String(place.id) + "/channels";
+    BINLOG_I("[Radio] GET channels of %s\n", place.id);
+    unsigned long start = millis();
+
+    String replayed;
+    if (replay_response(REPLAY_CHANNELS, path.c_str(), &replayed)) {
+        if (replayed.length() == 0) return false;
+        StreamString replay_body;
+        replay_body += replayed;
+        if (!keep_station_list(entry, read_stations(replay_body, entry, on_first), true)) {
+            station_list_reset(entry);
+            return false;
         }
-        delay(10);
+        Serial.printf("[Radio] %d stations replayed\n", station_count(entry));
+        entry->fetched_at = entry->last_used = millis();
+        station_cache_publish(entry, handle);
+        return true;
+    }
+
+    HttpResponse resp;
+    HttpsConn* conn = https_request(RADIO_GARDEN_HOST, path.c_str(), "application/json",
+                                    resp, RG_TIMEOUT_MS, inflate_accept_encoding());
+    if (!conn) {
+        Serial.println("[Radio] Failed to fetch stations");
+        replay_record_response(REPLAY_CHANNELS, path.c_str(), "", millis() - start);
+        return false;
+    }
+    if (resp.status != 200) {
+        Serial.printf("[Radio] HTTP %d\n", resp.status);
+        bool drained = https_read_body(conn, resp, nullptr);
+        https_release(conn, drained && resp.keep_alive);
+        replay_record_response(REPLAY_CHANNELS, path.c_str(), "", millis() - start);
+        return false;
     }
 
-    // Read headers, look for Location
-    String location = "";
-    while (client.available()) {
-        String line = client.readStringUntil('\n');
-        line.trim();
-        if (line.startsWith("Location: ") || line.startsWith("location: ")) {
-            location = line.substring(10);
+    // Parse straight from the socket, station by station
+    HttpBodyStream body(conn, resp);
+    InflateStream inflated(body, resp.encoding);
+    ReplayTee tee(inflated, resp.content_length > 0 ? (size_t)resp.content_length : 0);
+    RedirectPipeliner pipeliner(tee, conn, resp);
+    Stream& source = pipeline_first ? (Stream&)pipeliner : (Stream&)tee;
+    uint32_t parse_span = trace_begin(TRACE_JSON_PARSE);
+    DeserializationError error = read_stations(source, entry, on_first);
+    trace_end(parse_span);
+    bool body_complete = inflated.finish();
+    bool complete = body_complete;
+
+    // Redirect answer queued behind the channels body
+    String pipelined_url;
+    const char* pipelined_id = pipeliner.pipelined();
+    if (pipelined_id && complete && resp.keep_alive) {
+        TraceScope redirect_span(TRACE_REDIRECT);
+        HttpResponse next;
+        if (https_read_next(conn, next)) {
+            complete = https_read_body(conn, next, nullptr);
+            resp.keep_alive = next.keep_alive;
+            pipelined_url = next.location;
+        } else {
+            complete = false;
         }
-        if (line.length() == 0) break;
+    } else if (pipelined_id) {
+        complete = false;   // Request in flight on a connection that can't be read
+    }
+    https_release(conn, complete && resp.keep_alive);
+    replay_record_response(REPLAY_CHANNELS, path.c_str(), tee.captured(), millis() - start);
+    if (pipelined_id) {
+        // Replay has no pipelining: this comes back from get_redirect_url()
+        replay_record_response(REPLAY_REDIRECT, listen_path(pipelined_id).c_str(), pipelined_url, 0);
+    }
+
+    if (!keep_station_list(entry, error, body_complete)) {
+        station_list_reset(entry);
+        return false;
+    }
+
+    Serial.printf("[Radio] %d stations available (%lu ms, %lu/%lu KB)\n",
+                  station_count(entry), millis() - start, (unsigned long)inflated.wire_bytes() / 1024,
+                  (unsigned long)inflated.out_bytes() / 1024);
+
+    // Hand the redirect to resolve_stream_url() if it is for station 1
+    if (pipelined_url.length() > 0 && station_count(entry) > 0 &&
+        strcmp(station_at(entry, 0).id, pipelined_id) == 0) {
+        Serial.printf("[Radio] Pipelined redirect for %s\n", pipelined_id);
+        strcpy(_prefetch_id, pipelined_id);
+        _prefetch_url = pipelined_url;
+        _prefetch_seeded = false;
+    }
+
+    entry->fetched_at = entry->last_used = millis();
+    station_cache_publish(entry, handle);
+    return true;
+}
+
+// A place's list from another frame's cache (peer_cache.h), else from the
+// assist server (mqtt_client.h). It keeps their fetch time; a list they
+// had to cut is marked partial, so the prefetcher completes it from
+// radio.garden.
+static bool load_from_lan(PlaceHandle handle, const Place& place, PlaceStations* entry) {
+    int count, total;
+    uint32_t age_ms;
+    if (!lan_allowed()) return false;
+
+    // The LAN replies carry fixed records: read them into a scratch array
+    size_t bytes = MAX_CACHED_STATIONS * sizeof(StationRecord);
+    StationRecord* recs = (StationRecord*)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+    if (!recs) return false;
+    bool ok = peer_cache_get_stations(handle, recs, MAX_CACHED_STATIONS, &count, &total, &age_ms) ||
+              mqtt_assist_get_stations(place.id, recs, MAX_CACHED_STATIONS,
+                                       &count, &total, &age_ms);
+    for (int i = 0; ok && i < count; i++) ok = station_append(entry, recs[i]);
+    free(recs);
+    if (!ok) {
+        station_list_reset(entry);
+        return false;
     }
-    client.stop();
-    return location;
+    entry->from_catalog = false;
+    entry->partial = total > count;
+    entry->last_used = millis();
+    entry->fetched_at = entry->last_used - age_ms;
+    station_cache_publish(entry, handle);
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Ranking
+// ------------------------------------------------------------------
+
+// Stations with play history moved per list at most
+static const int RANK_MAX = 32;
+
+// Move a station to index to, shifting the ones in between by one
+static void move_station(PlaceStations* list, int from, int to) {
+    packed_list_move(list->stations, from, to);
 }
 
-// Forward declaration
-static bool fetch_and_play_place(const Place* place);
+static int find_station(PlaceStations* list, int first, int last, const char* id) {
+    for (int i = first; i <= last; i++) {
+        if (strcmp(station_at(list, i).id, id) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * Order stations [from, count) by their play history (station_stats):
+ * ones that did better than an unknown station first, best first, then the
+ * unknown ones in Radio.garden's order, then the ones that did worse,
+ * worst last. Done once per list load, so NEXT and the prefetcher just
+ * walk the list.
+ */
+static void rank_stations(PlaceStations* list, int from) {
+    struct Ranked {
+        char id[16];
+        int score;
+    };
+    Ranked ranked[RANK_MAX];
+    int n = 0;
+    for (int i = from; i < station_count(list) && n < RANK_MAX; i++) {
+        int score;
+        StationRecord s = station_at(list, i);
+        if (!station_stats_score(s.id, &score) || score == 0) continue;
+        strncpy(ranked[n].id, s.id, sizeof(ranked[n].id) - 1);
+        ranked[n].id[sizeof(ranked[n].id) - 1] = '\0';
+        ranked[n].score = score;
+        n++;
+    }
+    if (n == 0) return;
+
+    // Best first; equal scores keep their list order
+    for (int i = 1; i < n; i++) {
+        Ranked r = ranked[i];
+        int j = i;
+        for (; j > 0 && ranked[j - 1].score < r.score; j--) ranked[j] = ranked[j - 1];
+        ranked[j] = r;
+    }
+
+    int front = from;
+    int back = station_count(list) - 1;
+    int k = 0;
+    for (; k < n && ranked[k].score > 0; k++) {
+        int at = find_station(list, front, back, ranked[k].id);
+        if (at >= 0) move_station(list, at, front++);
+    }
+    for (int b = n - 1; b >= k; b--) {
+        int at = find_station(list, front, back, ranked[b].id);
+        if (at >= 0) move_station(list, at, back--);
+    }
+    Serial.printf("[Radio] Ranked %d station(s) by play history: %d up, %d down\n",
+                  n, k, n - k);
+}
+
+// live: skip the catalogue and fetch (LAN peer or radio.garden)
+static bool load_station_list(PlaceHandle handle, const Place& place, PlaceStations* entry,
+                              bool pipeline_first = false,
+                              void (*on_first)(PlaceStations*) = nullptr,
+                              bool live = false) {
+    station_cache_publish(entry, PLACE_NONE);
+    station_list_reset(entry);
+    int count = live ? -1 : station_catalog_get(handle, &entry->stations, MAX_CACHED_STATIONS);
+    if (count < 0) station_list_reset(entry);   // Whatever it appended before failing
+    if (count < 0) {
+        if (!load_from_lan(handle, place, entry) &&
+            !fetch_station_list(handle, place, entry, pipeline_first, on_first)) {
+            return false;
+        }
+    } else {
+        metrics_inc(METRIC_STATION_CATALOG_HIT);
+        Serial.printf("[Radio] %d stations from the catalogue\n", count);
+        entry->from_catalog = true;
+        entry->partial = false;
+        entry->fetched_at = entry->last_used = millis();
+        station_cache_publish(entry, handle);
+    }
+    // A station played early, ahead of the list, keeps its place
+    rank_stations(entry, _early_play > 0 && entry == _current_list ? _current_station_index : 0);
+    return true;
+}
 
 void radio_client_init() {
+    station_cache_init();
+    stream_cache_init();
     memset(&_current_station, 0, sizeof(_current_station));
-    _current_place_id = "";
     _current_station_index = 0;
     _playing_station_index = -1;
     _total_stations = 0;
-    _num_visited = 0;
+    _city_count = 0;
+    _city_pos = 0;
+    _city_budget = 0;
+}
+
+// Stations NEXT plays from the current list before hopping to the next city
+static int stations_here() {
+    return _city_budget > 0 ? min(_total_stations, _city_budget) : _total_stations;
+}
+
+/**
+ * First station of a list still arriving (read_stations' on_first): if
+ * its stream URL is known without a request, start it now and let the rest
+ * of the list download behind the audio.
+ */
+static void play_first_early(PlaceStations* list) {
+    if (!stream_url_known(station_at(list, 0).id) || cancelled()) return;
+    Serial.println("[Radio] First station parsed, playing ahead of the list");
+    _current_list = list;
+    _total_stations = station_count(list);
+    queue_clear();
+    _current_station_index = 0;
+    _list_loading = true;
+    _early_play = radio_play_next() ? 1 : -1;
 }
 
 /**
  * Fetch stations for a Place and play the first one.
  * Used by both radio_play_at_location and radio_play_next_city.
  */
-static bool fetch_and_play_place(const Place* place) {
+static bool fetch_and_play_place(PlaceHandle handle) {
+    if (cancelled()) return false;
+    Place rec;
+    if (!places_db_get(handle, &rec)) return false;
+    const Place* place = &rec;
     Serial.printf("[Radio] %s, %s\n", place->name, place->country);
 
     // Store place info
-    _current_place_id = String(place->id);
     strncpy(_current_station.place, place->name, sizeof(_current_station.place) - 1);
     strncpy(_current_station.country, place->country, sizeof(_current_station.country) - 1);
     _current_station.lat = place->lat_x100 / 100.0f;
     _current_station.lon = place->lon_x100 / 100.0f;
+    if (_preview_cb) {
+        StationInfo preview = _current_station;
+        preview.id[0] = '\0';
+        preview.title[0] = '\0';
+        _preview_cb(&preview, 0, 0);
+    }
+    progress(RADIO_STAGE_PLACE);
+
+    // Cached station list, or fetch it (cache hits skip the network)
+    PlaceStations* list = station_cache_find(handle);
+    metrics_inc(list ? METRIC_STATION_CACHE_HIT : METRIC_STATION_CACHE_MISS);
+    if (list) {
+        Serial.printf("[Radio] Station cache hit (%d stations, age %lus)\n",
+                      station_count(list), (millis() - list->fetched_at) / 1000);
+    } else {
+        list = station_cache_slot(handle);
+        _early_play = 0;
+        bool loaded = list && load_station_list(handle, *place, list, true, play_first_early);
+        _list_loading = false;
+        if (!loaded) {
+            if (list && list == _current_list) {
+                _total_stations = 0;   // Only entry was reused for the failed fetch
+            }
+            return false;
+        }
+        // The list stays cached even if this request was superseded
+        if (cancelled()) return false;
+    }
 
-    // Fetch stations for this place
-    String path = "/api/ara/content/page/" + _current_place_id + "/channels";
-    String response = https_get(path.c_str());
+    _current_list = list;
+    _total_stations = station_count(list);
+    if (_early_play != 0) {
+        // Station 1 went out while the list was parsed; if it failed, carry
+        // on down the now complete list
+        bool played = _early_play > 0;
+        _early_play = 0;
+        return played || radio_play_next();
+    }
+    if (_total_stations == 0) {
+        // Counts in places.bin can be stale; try the next city instead of
+        // making the user tap again
+        Serial.println("[Radio] 0 stations found for this place");
+        return radio_play_next_city();
+    }
 
-    if (response.length() == 0) {
-        Serial.println("[Radio] Failed to fetch stations");
+    // Play first station
+    queue_clear();
+    _current_station_index = 0;
+    return radio_play_next();
+}
+
+/**
+ * Resolve a station's stream URL, using the persisted cache when possible.
+ * from_cache (optional) reports whether the redirect round trip was skipped.
+ */
+static String resolve_stream_url(const char* station_id, bool* from_cache) {
+    // Resolved ahead of time by the prefetcher
+    if (_prefetch_url.length() > 0 && strcmp(_prefetch_id, station_id) == 0) {
+        String url = _prefetch_url;
+        _prefetch_url = "";
+        _prefetch_id[0] = '\0';
+        Serial.printf("[Radio] Stream URL (prefetched): %s\n", url.c_str());
+        stream_cache_put(station_id, url.c_str());
+        // A seeded URL may have gone stale like a cached one: retry on failure
+        if (from_cache) *from_cache = _prefetch_seeded;
+        _prefetch_seeded = false;
+        return url;
+    }
+
+    const char* cached = stream_cache_get(station_id);
+    if (from_cache) *from_cache = (cached != nullptr);
+    if (cached) {
+        Serial.printf("[Radio] Stream URL (cached): %s\n", cached);
+        return String(cached);
+    }
+
+    String redirect_url = get_redirect_url(station_id);
+
+    if (redirect_url.length() > 0) {
+        Serial.printf("[Radio] Stream URL: %s\n", redirect_url.c_str());
+        stream_cache_put(station_id, redirect_url.c_str());
+    }
+
+    return redirect_url;
+}
+
+/**
+ * Send a resolved stream to the WiiM. If a cached URL is rejected, it is
+ * invalidated and the station is resolved and played once more.
+ */
+static bool play_stream(const char* station_id, const String& stream_url, bool from_cache) {
+    if (linkplay_play(stream_url.c_str())) {
+        _playing_url = stream_url;
+        return true;
+    }
+    if (!from_cache) {
         return false;
     }
 
-    // Parse JSON response
-    DynamicJsonDocument doc(16384);
-    DeserializationError error = deserializeJson(doc, response);
+    stream_cache_invalidate(station_id);
+    String fresh_url = resolve_stream_url(station_id, nullptr);
+    if (fresh_url.length() == 0 || cancelled()) return false;
+    if (!linkplay_play(fresh_url.c_str())) return false;
+    _playing_url = fresh_url;
+    return true;
+}
+
+// ------------------------------------------------------------------
+// City cursor
+// ------------------------------------------------------------------
 
-    if (error) {
-        Serial.printf("[Radio] JSON parse error: %s\n", error.c_str());
+static void city_mark(int first) {
+    for (int i = first; i < _city_count; i++) {
+        PlaceHandle h = _city_cursor[i];
+        if (h / 32 < _city_seen_words) _city_seen[h / 32] |= 1u << (h % 32);
+    }
+}
+
+// Take the cursor as filled in for a new origin; more: refill it from
+// (lat, lon) once NEXT runs past its end
+static void city_cursor_start(float lat, float lon, bool more) {
+    uint32_t words = (places_db_count() + 31) / 32;
+    if (words != _city_seen_words) {
+        free(_city_seen);
+        _city_seen = (uint32_t*)malloc(words * sizeof(uint32_t));
+        _city_seen_words = _city_seen ? words : 0;
+    }
+    _city_pos = 0;
+    _city_more = more && _city_seen;
+    _city_lat = lat;
+    _city_lon = lon;
+    if (!_city_seen) return;
+    memset(_city_seen, 0, _city_seen_words * sizeof(uint32_t));
+    city_mark(0);
+}
+
+// The next batch of cities out from the origin, after the current one
+static bool city_cursor_refill() {
+    if (!_city_more || _city_count == 0) return false;
+    uint32_t span = trace_begin(TRACE_LOOKUP);
+    int n = places_db_find_k_nearest_except(_city_lat, _city_lon, CITY_BATCH, _city_seen,
+                                            _city_cursor + 1);
+    trace_end(span);
+    if (n == 0) {
+        _city_more = false;
         return false;
     }
+    _city_cursor[0] = _city_cursor[_city_pos];
+    _city_count = n + 1;
+    _city_pos = 0;
+    city_mark(1);
+    return true;
+}
 
-    // Extract stations
-    _total_stations = 0;
-    JsonArray content = doc["data"]["content"];
-    for (JsonObject section : content) {
-        JsonArray items = section["items"];
-        for (JsonObject item : items) {
-            if (_total_stations >= MAX_CACHED_STATIONS) break;
-
-            const char* title = item["page"]["title"];
-            const char* url = item["page"]["url"];
-
-            if (title && url) {
-                String urlStr = String(url);
-                int listenIdx = urlStr.indexOf("/listen/");
-                if (listenIdx >= 0) {
-                    int slugStart = listenIdx + 8;
-                    int idStart = urlStr.indexOf("/", slugStart);
-                    if (idStart > slugStart) {
-                        idStart++;
-                        _cached_station_ids[_total_stations] = urlStr.substring(idStart);
-                        _cached_station_titles[_total_stations] = String(title);
-                        _total_stations++;
-                    }
-                }
-            }
+// The city NEXT hops to, PLACE_NONE past the last one. Past the end of the
+// batch this runs the next search, also when only peeking (prefetch,
+// upcoming_station), so the press that follows finds the batch ready.
+static PlaceHandle city_cursor_next() {
+    if (_city_pos + 1 >= _city_count && !city_cursor_refill()) return PLACE_NONE;
+    return _city_cursor[_city_pos + 1];
+}
+
+// ------------------------------------------------------------------
+// Tap memo
+// ------------------------------------------------------------------
+
+// Home and a few favourite regions get tapped over and over. Each tapped
+// cell (a 5 character geohash, about 5 x 5 km, finer than a map pixel or
+// a USB touch unit) keeps its k-nearest cursor, so a repeat tap skips the
+// distance scan. The nearest place's station list and its first stream
+// URL are held by the station and stream caches, which keep their own
+// expiry; the entry only records which list it was served from.
+static const int TAP_MEMO_ENTRIES = 16;
+static const int TAP_MEMO_BITS = 25;   // Geohash bits, 5 per character
+
+struct TapMemo {
+    uint32_t cell;                // Geohash bits; 0 with count 0 is unused
+    uint32_t last_used;
+    PlaceHandle cursor[CITY_BATCH];
+    uint8_t count;
+};
+
+static TapMemo _tap_memo[TAP_MEMO_ENTRIES];   // Net worker task only
+
+// Interleaved geohash bits of a point, longitude first
+static uint32_t tap_cell(float lat, float lon) {
+    float lat_lo = -90, lat_hi = 90, lon_lo = -180, lon_hi = 180;
+    uint32_t cell = 0;
+    for (int bit = 0; bit < TAP_MEMO_BITS; bit++) {
+        float* lo = (bit & 1) ? &lat_lo : &lon_lo;
+        float* hi = (bit & 1) ? &lat_hi : &lon_hi;
+        float v = (bit & 1) ? lat : lon;
+        float mid = (*lo + *hi) * 0.5f;
+        cell <<= 1;
+        if (v >= mid) {
+            cell |= 1;
+            *lo = mid;
+        } else {
+            *hi = mid;
         }
     }
+    return cell;
+}
 
-    if (_total_stations == 0) {
-        Serial.println("[Radio] 0 stations found for this place");
-        return false;
+static TapMemo* tap_memo_find(uint32_t cell) {
+    for (int i = 0; i < TAP_MEMO_ENTRIES; i++) {
+        TapMemo& m = _tap_memo[i];
+        if (m.count > 0 && m.cell == cell) {
+            m.last_used = millis();
+            return &m;
+        }
     }
-    Serial.printf("[Radio] %d stations available\n", _total_stations);
+    return nullptr;
+}
 
-    // Play first station
-    _current_station_index = 0;
-    return radio_play_next();
+static void tap_memo_put(uint32_t cell, const PlaceHandle* cursor, int count) {
+    TapMemo* victim = &_tap_memo[0];
+    for (int i = 0; i < TAP_MEMO_ENTRIES; i++) {
+        TapMemo& m = _tap_memo[i];
+        if (m.count == 0 || m.cell == cell) {
+            victim = &m;
+            break;
+        }
+        if (m.last_used < victim->last_used) victim = &m;
+    }
+    victim->cell = cell;
+    victim->last_used = millis();
+    memcpy(victim->cursor, cursor, count * sizeof(PlaceHandle));
+    victim->count = count;
 }
 
 bool radio_play_at_location(float lat, float lon) {
-    // Find nearest place
-    const Place* place = places_db_find_nearest(lat, lon);
-    if (!place) {
+    if (cancelled()) return false;
+
+    // One k-nearest query per touched cell: nearest city plus the hop order
+    // for NEXT
+    uint32_t cell = tap_cell(lat, lon);
+    TapMemo* memo = tap_memo_find(cell);
+    metrics_inc(memo ? METRIC_TAP_MEMO_HIT : METRIC_TAP_MEMO_MISS);
+    if (memo) {
+        _city_count = memo->count;
+        memcpy(_city_cursor, memo->cursor, _city_count * sizeof(PlaceHandle));
+        Serial.printf("[Radio] Tap memo hit (%d cities)\n", _city_count);
+    } else {
+        uint32_t span = trace_begin(TRACE_LOOKUP);
+        _city_count = places_db_find_k_nearest(lat, lon, CITY_BATCH, _city_cursor);
+        trace_end(span);
+        if (_city_count > 0) tap_memo_put(cell, _city_cursor, _city_count);
+    }
+    city_cursor_start(lat, lon, true);
+    _city_budget = 0;
+    if (_city_count == 0) {
         return false;
     }
 
-    // Store touch origin for next-city hopping
-    _touch_origin_lat = lat;
-    _touch_origin_lon = lon;
+    return fetch_and_play_place(_city_cursor[0]);
+}
 
-    // Reset visited cities list
-    _num_visited = 0;
-    _visited_place_ids[_num_visited++] = String(place->id);
+bool radio_play_country(float lat, float lon) {
+    if (cancelled()) return false;
 
-    return fetch_and_play_place(place);
+    // The nearest city names the country; a tap out at sea or past the
+    // country's places is an ordinary location tap
+    uint32_t span = trace_begin(TRACE_LOOKUP);
+    PlaceHandle nearest;
+    int country = -1;
+    if (places_db_find_k_nearest(lat, lon, 1, &nearest) == 1) {
+        country = places_db_country_of(nearest);
+    }
+    if (country < 0 || !places_db_country_contains(country, lat, lon)) {
+        trace_end(span);
+        return radio_play_at_location(lat, lon);
+    }
+
+    // Cursor: the tapped city first, then the country's best ones
+    PlaceHandle best[CITY_BATCH];
+    int found = places_db_country_best(country, CITY_BATCH, best);
+    trace_end(span);
+    _city_cursor[0] = nearest;
+    _city_count = 1;
+    for (int i = 0; i < found && _city_count < CITY_BATCH; i++) {
+        if (best[i] != nearest) _city_cursor[_city_count++] = best[i];
+    }
+    city_cursor_start(lat, lon, false);   // The country's best cities only
+    _city_budget = COUNTRY_CITY_STATIONS;
+
+    char name[sizeof(_current_station.country)] = "?";
+    places_db_country_name(country, name, sizeof(name));
+    Serial.printf("[Radio] Country: %s, %d cities\n", name, _city_count);
+    return fetch_and_play_place(_city_cursor[0]);
 }
 
 /**
- * Hop to the next nearest city from the original touch point.
- * Excludes all previously visited cities.
+ * Hop to the next nearest city from the original touch point
+ * by advancing the distance-sorted cursor.
  */
 static bool radio_play_next_city() {
-    if (_num_visited >= MAX_VISITED_CITIES) {
-        Serial.println("[Radio] Max visited cities reached");
+    if (city_cursor_next() == PLACE_NONE) {
+        Serial.println("[Radio] No more cities");
         return false;
     }
 
-    const Place* place = places_db_find_nearest_excluding(
-        _touch_origin_lat, _touch_origin_lon,
-        _visited_place_ids, _num_visited);
+    Serial.println("[Radio] -> Next city");
+    return fetch_and_play_place(_city_cursor[++_city_pos]);
+}
+
+// ------------------------------------------------------------------
+// Station queue
+// ------------------------------------------------------------------
+
+static void queue_clear() {
+    portENTER_CRITICAL(&_queue_mux);
+    _queue_len = 0;
+    _queue_m3u[0] = '\0';
+    portEXIT_CRITICAL(&_queue_mux);
+    _queue_list = nullptr;
+}
+
+static void set_current_from_list(int index) {
+    StationRecord station = station_at(_current_list, index);
+    strncpy(_current_station.id, station.id, sizeof(_current_station.id) - 1);
+    strncpy(_current_station.title, station.title, sizeof(_current_station.title) - 1);
+    _current_station.valid = true;
+    _playing_station_index = index;
+    _current_station_index = index + 1;
+}
 
-    if (!place) {
-        Serial.println("[Radio] No cities found (DB not in memory?)");
+/**
+ * Hand the WiiM the station at _current_station_index (stream_url) plus
+ * the following ones already in the stream cache as one playlist. Returns
+ * false if fewer than two are known or the WiiM refused it; the caller
+ * then plays the single stream.
+ */
+static bool queue_play(const String& stream_url) {
+    if (QUEUE_LENGTH < 2 || !metrics_http_running()) return false;
+
+    char m3u[RADIO_QUEUE_M3U_MAX];
+    int len = snprintf(m3u, sizeof(m3u), "#EXTM3U\n%s\n", stream_url.c_str());
+    int count = 1;
+    for (int i = _current_station_index + 1; i < stations_here() && count < QUEUE_LENGTH; i++) {
+        const char* url = stream_cache_get(station_at(_current_list, i).id);
+        if (!url || len + strlen(url) + 2 >= sizeof(m3u)) break;
+        len += snprintf(m3u + len, sizeof(m3u) - len, "%s\n", url);
+        count++;
+    }
+    if (count < 2) return false;
+
+    portENTER_CRITICAL(&_queue_mux);
+    memcpy(_queue_m3u, m3u, len + 1);
+    _queue_len = count;
+    portEXIT_CRITICAL(&_queue_mux);
+    _queue_list = _current_list;
+    _queue_first = _current_station_index;
+    _queue_pos = 0;
+
+    char url[64];
+    snprintf(url, sizeof(url), "http://%s:%u/queue.m3u?q=%u",
+             WiFi.localIP().toString().c_str(), METRICS_HTTP_PORT, ++_queue_seq);
+    Serial.printf("[Radio] Queue of %d stations: %s\n", count, url);
+    if (linkplay_play_playlist(url, 0)) return true;
+    queue_clear();
+    return false;
+}
+
+// NEXT inside the queue: one LinkPlay command, nothing to resolve
+static bool queue_next() {
+    if (_queue_len == 0 || _queue_list != _current_list ||
+        _playing_station_index != _queue_first + _queue_pos ||
+        _queue_pos + 1 >= _queue_len) {
+        return false;
+    }
+    if (!linkplay_next()) {
+        queue_clear();
         return false;
     }
+    _queue_pos++;
+    set_current_from_list(_queue_first + _queue_pos);
+    Serial.printf("[Radio] Queue: %s (%d/%d)\n", _current_station.title,
+                  _playing_station_index + 1, _total_stations);
+    _last_play_ms = millis();
+    _prefetch_pending = true;
+    return true;
+}
 
-    Serial.printf("[Radio] -> Next city: %s, %s\n", place->name, place->country);
-    _visited_place_ids[_num_visited++] = String(place->id);
+bool radio_queue_m3u(char* out, size_t cap) {
+    portENTER_CRITICAL(&_queue_mux);
+    bool ok = _queue_len > 0 && strlen(_queue_m3u) < cap;
+    if (ok) strcpy(out, _queue_m3u);
+    portEXIT_CRITICAL(&_queue_mux);
+    return ok;
+}
 
-    return fetch_and_play_place(place);
+bool radio_queue_sync(int index) {
+    int pos = index - 1;
+    if (_queue_len == 0 || _queue_list != _current_list || pos == _queue_pos ||
+        pos < 0 || pos >= _queue_len) {
+        return false;
+    }
+    _queue_pos = pos;
+    set_current_from_list(_queue_first + pos);
+    Serial.printf("[Radio] WiiM moved to queue entry %d: %s\n", index, _current_station.title);
+    _prefetch_pending = true;
+    return true;
 }
 
-bool radio_play_next() {
+/**
+ * Probe the station about to play together with the next few whose stream
+ * URLs are already cached, and move the first one to answer (the live one
+ * with the lowest time to first byte) to the current slot. Only known URLs
+ * are probed: resolving more would cost radio.garden round trips.
+ * Dead candidates are dropped from the stream cache; returns false if the
+ * current one was dead and nothing else answered (it has been skipped).
+ */
+static bool pick_live_station(String& stream_url, bool& from_cache) {
+    StreamProbe probes[STREAM_PROBE_MAX];
+    int first = _current_station_index;
+    int count = 0;
+    probes[count++] = {stream_url.c_str(), PROBE_UNKNOWN, 0};
+    for (int i = first + 1; i < stations_here() && count < STREAM_PROBE_MAX; i++) {
+        const char* url = stream_cache_get(station_at(_current_list, i).id);
+        if (!url) break;
+        probes[count++] = {url, PROBE_UNKNOWN, 0};
+    }
+    if (count < 2 || strncmp(stream_url.c_str(), "http://", 7) != 0) return true;
+
+    int winner = stream_probe_run(probes, count, STREAM_PROBE_TIMEOUT_MS);
+    if (winner > 0) {
+        Serial.printf("[Radio] Probe: %s answered first (%u ms)\n",
+                      station_at(_current_list, first + winner).title, probes[winner].ttfb_ms);
+        stream_url = probes[winner].url;   // Copy before the cache changes
+        from_cache = true;
+    }
+
+    int dead = 0;
+    for (int i = 0; i < count; i++) {
+        if (probes[i].result == PROBE_DEAD) {
+            stream_cache_invalidate(station_at(_current_list, first + i).id);
+            station_stats_failed(station_at(_current_list, first + i).id);
+            dead++;
+        }
+    }
+    if (dead) Serial.printf("[Radio] Probe: %d/%d stations down\n", dead, count);
+
+    if (winner > 0) {
+        packed_list_swap(_current_list->stations, first, first + winner);
+    } else if (winner < 0) {
+        // Nothing confirmed live: skip the dead ones in front of the rest
+        int skip = 0;
+        while (skip < count && probes[skip].result == PROBE_DEAD) skip++;
+        if (skip > 0) {
+            _current_station_index += skip;
+            return false;
+        }
+    }
+    return true;
+}
+
+// round counts the dead probe batches already skipped on this press
+static bool play_next_station(int round) {
     if (_total_stations == 0) {
         Serial.println("[Radio] No stations loaded");
         return false;
     }
 
-    // If all stations at current city exhausted, hop to next city
-    if (_current_station_index >= _total_stations) {
+    if (queue_next()) return true;
+    queue_clear();
+
+    // If all stations at current city exhausted (or its share in country
+    // play), hop to next city
+    if (_current_station_index >= stations_here()) {
         return radio_play_next_city();
     }
 
     _playing_station_index = _current_station_index;
 
-    String station_id = _cached_station_ids[_current_station_index];
-    String station_title = _cached_station_titles[_current_station_index];
+    StationRecord station = station_at(_current_list, _current_station_index);
 
     Serial.printf("[Radio] Playing: %s (%d/%d)\n",
-                  station_title.c_str(), _current_station_index + 1, _total_stations);
+                  station.title, _current_station_index + 1, _total_stations);
+    if (_preview_cb) {
+        StationInfo preview = _current_station;
+        strncpy(preview.id, station.id, sizeof(preview.id) - 1);
+        strncpy(preview.title, station.title, sizeof(preview.title) - 1);
+        _preview_cb(&preview, _current_station_index + 1, _list_loading ? 0 : _total_stations);
+    }
+    progress(RADIO_STAGE_STATIONS);
 
-    String stream_url = radio_get_stream_url(station_id.c_str());
+    bool from_cache = false;
+    String stream_url = resolve_stream_url(station.id, &from_cache);
     if (stream_url.length() == 0) {
+        if (!cancelled()) station_stats_failed(station.id);
         _current_station_index++;
         return false;
     }
+    if (cancelled()) return false;
+    progress(RADIO_STAGE_URL);
+
+    if (!pick_live_station(stream_url, from_cache)) {
+        if (cancelled() || round + 1 >= STREAM_PROBE_ROUNDS) return false;
+        return play_next_station(round + 1);
+    }
+    if (cancelled()) return false;
+    // The probe may have swapped its winner into this index
+    station = station_at(_current_list, _current_station_index);
 
     // Update current station info
-    strncpy(_current_station.id, station_id.c_str(), sizeof(_current_station.id) - 1);
-    strncpy(_current_station.title, station_title.c_str(), sizeof(_current_station.title) - 1);
+    strncpy(_current_station.id, station.id, sizeof(_current_station.id) - 1);
+    strncpy(_current_station.title, station.title, sizeof(_current_station.title) - 1);
     _current_station.valid = true;
 
-    // Play via LinkPlay
-    bool success = linkplay_play(stream_url.c_str());
+    // Play via LinkPlay (as the head of a queue when the next URLs are known)
+    bool success = queue_play(stream_url);
+    if (success) {
+        _playing_url = stream_url;
+    } else {
+        success = play_stream(station.id, stream_url, from_cache);
+    }
+    if (success) progress(RADIO_STAGE_SPEAKER);
+    if (!success && !cancelled()) station_stats_failed(station.id);
+    _last_play_ms = millis();
+    _prefetch_pending = success;
 
     // Advance index for next call
     _current_station_index++;
@@ -309,7 +1353,255 @@ bool radio_play_next() {
     return success;
 }
 
+bool radio_play_next() {
+    return play_next_station(0);
+}
+
+// ------------------------------------------------------------------
+// Speculative prefetch
+// ------------------------------------------------------------------
+
+// Station the next NEXT press will play; false if not known yet
+static bool upcoming_station(StationRecord* out) {
+    if (_current_list && _current_station_index < stations_here()) {
+        *out = station_at(_current_list, _current_station_index);
+        return true;
+    }
+    PlaceHandle next_city = city_cursor_next();
+    if (next_city != PLACE_NONE) {
+        PlaceStations* next = station_cache_find(next_city);
+        if (next && station_count(next) > 0) {
+            *out = station_at(next, 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Replace the current list, read from the catalogue or cut short, with the
+ * full live one. NEXT carries on after the playing station if it is still
+ * listed.
+ */
+static void refresh_catalog_list() {
+    PlaceStations* list = _current_list;
+    list->from_catalog = false;   // One attempt, even if it fails
+    list->partial = false;
+
+    Place place;
+    if (!places_db_get(list->place, &place)) return;
+    PlaceStations* fresh = nullptr;
+    #ifdef BOARD_HAS_PSRAM
+    if (psramFound()) fresh = (PlaceStations*)ps_calloc(1, sizeof(PlaceStations));
+    #endif
+    if (!fresh) fresh = (PlaceStations*)calloc(1, sizeof(PlaceStations));
+    if (!fresh) return;
+
+    Serial.printf("[Radio] Refreshing stations: %s\n", place.name);
+    bool ok = fetch_station_list(list->place, place, fresh) && station_count(fresh) > 0;
+    if (ok) {
+        int playing = -1;
+        if (_playing_station_index >= 0 && _playing_station_index < station_count(list)) {
+            StationRecord now = station_at(list, _playing_station_index);
+            for (int i = 0; i < station_count(fresh); i++) {
+                if (strcmp(station_at(fresh, i).id, now.id) == 0) {
+                    playing = i;
+                    break;
+                }
+            }
+        }
+        // The list takes over fresh's records
+        PlaceHandle handle = list->place;
+        fresh->last_used = list->last_used;
+        fresh->partial = false;
+        fresh->place = PLACE_NONE;
+        station_cache_publish(list, PLACE_NONE);
+        station_list_reset(list);
+        memcpy(list, fresh, sizeof(PlaceStations));
+        station_cache_publish(list, handle);
+        _total_stations = station_count(list);
+        if (playing >= 0) {
+            _playing_station_index = playing;
+            _current_station_index = playing + 1;
+        } else if (_current_station_index > _total_stations) {
+            _current_station_index = _total_stations;
+        }
+        rank_stations(list, _current_station_index);
+    } else {
+        station_list_reset(fresh);
+    }
+    free(fresh);
+}
+
+static bool refill_tried(const char* id) {
+    for (int i = 0; i < QUEUE_MAX; i++) {
+        if (strcmp(_refill_ids[i], id) == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * One prefetch request: the live list if the current one came from the
+ * catalogue or was cut short, the next city's station list when the current city is nearly
+ * used up, then the upcoming station's stream URL.
+ * Returns true if it did something (call again), false when done.
+ */
+static bool prefetch_step() {
+    if (_current_list && (_current_list->from_catalog || _current_list->partial)) {
+        refresh_catalog_list();
+        return true;
+    }
+
+    int remaining = stations_here() - _current_station_index;
+    PlaceHandle next = remaining <= PREFETCH_CITY_THRESHOLD && _station_cache_size > 1
+                           ? city_cursor_next() : PLACE_NONE;
+    if (next != PLACE_NONE) {
+        Place place;
+        if (!station_cache_find(next) && places_db_get(next, &place)) {
+            PlaceStations* slot = station_cache_slot(next);
+            if (slot) {
+                Serial.printf("[Radio] Prefetching stations: %s\n", place.name);
+                load_station_list(next, place, slot);
+                return true;
+            }
+        }
+    }
+
+    // Queue mode: resolve the stations the next queue will hold
+    int ahead_end = min(stations_here(), _current_station_index + QUEUE_LENGTH);
+    for (int i = _current_station_index; _current_list && QUEUE_LENGTH > 1 && i < ahead_end; i++) {
+        StationRecord s = station_at(_current_list, i);
+        if (stream_cache_get(s.id) || refill_tried(s.id)) continue;
+        strcpy(_refill_ids[_refill_next], s.id);   // Attempted, even if it fails
+        _refill_next = (_refill_next + 1) % QUEUE_MAX;
+        String url = get_redirect_url(s.id);
+        if (url.length() > 0) {
+            stream_cache_put(s.id, url.c_str());
+            Serial.printf("[Radio] Resolved ahead: %s\n", s.title);
+        }
+        return true;
+    }
+
+    StationRecord up;
+    if (upcoming_station(&up) && strcmp(_prefetch_id, up.id) != 0 && !stream_cache_get(up.id)) {
+        // Record the attempt even if it fails, so it isn't retried every loop
+        strncpy(_prefetch_id, up.id, sizeof(_prefetch_id) - 1);
+        _prefetch_id[sizeof(_prefetch_id) - 1] = '\0';
+        _prefetch_url = get_redirect_url(up.id);
+        _prefetch_seeded = false;
+        if (_prefetch_url.length() > 0) {
+            Serial.printf("[Radio] Prefetched stream URL: %s\n", up.title);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool radio_prefetch_location(float lat, float lon) {
+    // The only cache entry may be the current list, which NEXT still needs
+    if (_station_cache_size <= 1) return false;
+
+    // A memoized cell already names its nearest place
+    PlaceHandle handle;
+    int found = 0;
+    TapMemo* memo = tap_memo_find(tap_cell(lat, lon));
+    if (memo) {
+        handle = memo->cursor[0];
+        found = 1;
+    } else {
+        uint32_t span = trace_begin(TRACE_LOOKUP);
+        found = places_db_find_k_nearest(lat, lon, 1, &handle);
+        trace_end(span);
+    }
+    if (found == 0) return false;
+
+    PlaceStations* list = station_cache_find(handle);
+    if (!list) {
+        Place place;
+        if (!places_db_get(handle, &place) || cancelled()) return false;
+        list = station_cache_slot(handle, true);
+        if (!list) return false;   // Colder than every list it would replace
+        Serial.printf("[Radio] Speculative stations: %s\n", place.name);
+        if (!load_station_list(handle, place, list)) return false;
+    }
+    if (station_count(list) == 0) return false;
+
+    StationRecord first = station_at(list, 0);
+    if (stream_cache_get(first.id)) return true;
+    if (cancelled()) return false;
+
+    String url = get_redirect_url(first.id);
+    if (url.length() == 0) return false;
+    stream_cache_put(first.id, url.c_str());
+    Serial.printf("[Radio] Speculative stream URL: %s\n", first.title);
+    return true;
+}
+
+bool radio_warm_station(const char* station_id) {
+    if (stream_cache_get(station_id)) return true;
+    if (cancelled()) return false;
+
+    String url = get_redirect_url(station_id);
+    if (url.length() == 0) return false;
+    stream_cache_put(station_id, url.c_str());
+    return true;
+}
+
+bool radio_refresh_place(float lat, float lon) {
+    if (_station_cache_size <= 1) return false;
+    PlaceHandle handle;
+    if (places_db_find_k_nearest(lat, lon, 1, &handle) == 0) return false;
+
+    // The current list is prefetch_step's to keep live
+    if (_current_list && _current_list->place == handle) return true;
+    PlaceStations* list = station_cache_find(handle);
+    if (list && !list->from_catalog && !list->partial) return true;
+
+    Place place;
+    if (!places_db_get(handle, &place) || cancelled()) return false;
+    list = station_cache_slot(handle, true);
+    if (!list) return true;   // Colder than every list it would replace
+    Serial.printf("[Radio] Idle refresh, stations: %s\n", place.name);
+    return load_station_list(handle, place, list, false, nullptr, true);
+}
+
+bool radio_refresh_station(const char* station_id) {
+    if (!stream_cache_stale(station_id, REFRESH_URL_AGE_S)) return true;
+    if (cancelled()) return false;
+
+    String url = get_redirect_url(station_id);
+    if (url.length() == 0) return false;
+    stream_cache_put(station_id, url.c_str());
+    return true;
+}
+
+void radio_client_task() {
+    if (!_prefetch_pending || !_current_station.valid) return;
+    if (millis() - _last_play_ms < PREFETCH_DELAY_MS) return;
+
+    // At most one request per loop pass
+    _prefetch_pending = prefetch_step();
+}
+
+void radio_client_network_up() {
+    dns_cache_prefetch(RADIO_GARDEN_HOST);
+}
+
+void radio_set_cancel_callback(bool (*cb)()) {
+    _cancel_cb = cb;
+}
+
+void radio_set_preview_callback(void (*cb)(const StationInfo* station, int index, int total)) {
+    _preview_cb = cb;
+}
+
+void radio_set_progress_callback(void (*cb)(RadioStage stage)) {
+    _progress_cb = cb;
+}
+
 void radio_stop() {
+    queue_clear();
     linkplay_stop();
     _current_station.valid = false;
 }
@@ -323,11 +1615,16 @@ bool radio_play_by_id(const char* station_id, const char* title,
                       float lat, float lon) {
     Serial.printf("[Radio] Playing by ID: %s (%s)\n", title, place);
 
-    String stream_url = radio_get_stream_url(station_id);
+    // Cached URL lets resume / favorites play without the redirect round trip
+    bool from_cache = false;
+    String stream_url = resolve_stream_url(station_id, &from_cache);
     if (stream_url.length() == 0) {
         Serial.println("[Radio] Failed to get stream URL");
+        if (!cancelled()) station_stats_failed(station_id);
         return false;
     }
+    if (cancelled()) return false;
+    progress(RADIO_STAGE_URL);
 
     // Update current station info
     strncpy(_current_station.id, station_id, sizeof(_current_station.id) - 1);
@@ -343,34 +1640,40 @@ bool radio_play_by_id(const char* station_id, const char* title,
     _current_station.valid = true;
 
     // Set up next-city hopping from the favorite's location
-    _touch_origin_lat = lat;
-    _touch_origin_lon = lon;
-    _num_visited = 0;
-
-    // Mark this city as visited (find nearest place for its ID)
-    const Place* nearby = places_db_find_nearest(lat, lon);
-    if (nearby) {
-        _visited_place_ids[_num_visited++] = String(nearby->id);
-        _current_place_id = String(nearby->id);
-    }
+    // (cursor entry 0 is the favorite's own city)
+    _city_count = places_db_find_k_nearest(lat, lon, CITY_BATCH, _city_cursor);
+    city_cursor_start(lat, lon, true);
+    _city_budget = 0;
 
     // We played 1 station; NEXT will hop to next city
+    queue_clear();
+    _current_list = nullptr;
     _total_stations = 1;
     _current_station_index = 1;
     _playing_station_index = 0;
 
-    return linkplay_play(stream_url.c_str());
+    bool success = play_stream(station_id, stream_url, from_cache);
+    if (success) progress(RADIO_STAGE_SPEAKER);
+    if (!success && !cancelled()) station_stats_failed(station_id);
+    _last_play_ms = millis();
+    _prefetch_pending = success;
+    return success;
 }
 
-String radio_get_stream_url(const char* station_id) {
-    String path = "/api/ara/content/listen/" + String(station_id) + "/channel.mp3";
-    String redirect_url = get_redirect_url(path.c_str());
+const char* radio_get_current_url() {
+    return _current_station.valid ? _playing_url.c_str() : "";
+}
 
-    if (redirect_url.length() > 0) {
-        Serial.printf("[Radio] Stream URL: %s\n", redirect_url.c_str());
-    }
+void radio_seed_stream_url(const char* station_id, const char* url) {
+    // Taken by the next resolve_stream_url() for this station, like a prefetch
+    strncpy(_prefetch_id, station_id, sizeof(_prefetch_id) - 1);
+    _prefetch_id[sizeof(_prefetch_id) - 1] = '\0';
+    _prefetch_url = url;
+    _prefetch_seeded = true;
+}
 
-    return redirect_url;
+String radio_get_stream_url(const char* station_id) {
+    return resolve_stream_url(station_id, nullptr);
 }
 
 int radio_get_station_index() {
@@ -9,6 +9,8 @@
 #define RADIO_CLIENT_H
 
 #include <Arduino.h>
+#include "places_db.h"
+#include "station_catalog.h"
 
 // Station info returned from lookup
 struct StationInfo {
@@ -21,6 +23,16 @@ struct StationInfo {
     bool valid;         // True if station was found
 };
 
+// Stages of a play request, in order. A NEXT starts at RADIO_STAGE_STATIONS
+// (the list is there) and a play by ID at RADIO_STAGE_URL.
+enum RadioStage : uint8_t {
+    RADIO_STAGE_PLACE,      // Place found for the tap
+    RADIO_STAGE_STATIONS,   // Its station list parsed (or cached), station picked
+    RADIO_STAGE_URL,        // Stream URL resolved
+    RADIO_STAGE_SPEAKER,    // The WiiM accepted the stream
+    RADIO_STAGE_COUNT
+};
+
 // Initialize the radio client
 void radio_client_init();
 
@@ -28,15 +40,66 @@ void radio_client_init();
 // Returns true if playback started successfully
 bool radio_play_at_location(float lat, float lon);
 
+// Play from across the country a tap falls in: the nearest city first,
+// then the country's best cities (places_db_country_best), a few stations
+// each, with the same NEXT hopping and prefetch as a location tap. Taps
+// outside every country's box play as radio_play_at_location().
+// Returns true if playback started successfully
+bool radio_play_country(float lat, float lon);
+
 // Play the next station at the current location
 // When all stations at the current city are exhausted, automatically
 // hops to the next nearest city from the original touch point.
 // Returns true if playback started successfully
 bool radio_play_next();
 
+// Warm the caches for a tap at lat/lon that may still become a double-tap:
+// the nearest city's station list and its first station's stream URL, so
+// a following radio_play_at_location() at the same point only has to talk
+// to the WiiM. Leaves playback state alone. Returns false if nothing was
+// fetched (no PSRAM cache, network error).
+bool radio_prefetch_location(float lat, float lon);
+
+// Warm the stream URL cache for a station (favorites, history at boot):
+// one redirect lookup unless a URL is already cached. Returns false if the
+// lookup failed or was cancelled.
+bool radio_warm_station(const char* station_id);
+
+// Idle refresh (net worker, maintenance class): fetch the live station list
+// of the city nearest lat/lon unless a live one is cached or every list
+// it would replace is from a cell tapped more often (tap_heat), and
+// re-resolve a station's stream URL once it is 12 h old. True if already
+// fresh, skipped or refreshed; false on failure or cancellation.
+bool radio_refresh_place(float lat, float lon);
+bool radio_refresh_station(const char* station_id);
+
 // Stop playback
 void radio_stop();
 
+// Check polled at the await points of a play request (after each
+// Radio.garden response, before handing a stream to the WiiM) and between
+// the requests of a prefetch. If it returns true the request is abandoned
+// and the call returns false.
+void radio_set_cancel_callback(bool (*cb)());
+
+// Called while a play request is still running, as soon as there is
+// something to show: once with the city (title empty, index 0) right after
+// the places lookup, then with the station's title and list position once
+// its list is parsed. The play can still fail after either one.
+void radio_set_preview_callback(void (*cb)(const StationInfo* station, int index, int total));
+
+// Called from a running play request as it reaches each stage
+void radio_set_progress_callback(void (*cb)(RadioStage stage));
+
+// Background work while a station plays: prefetches the next station's
+// stream URL and, near the end of a city's list, the next city's stations,
+// so NEXT is a single LinkPlay call. Run by the network worker while idle.
+void radio_client_task();
+
+// WiFi just connected: resolve radio.garden in the background so the first
+// tap doesn't wait for DNS (network worker)
+void radio_client_network_up();
+
 // Get current station info
 const StationInfo* radio_get_current();
 
@@ -45,10 +108,37 @@ bool radio_play_by_id(const char* station_id, const char* title,
                       const char* place, const char* country,
                       float lat, float lon);
 
+// Stream URL of the current station ("" if nothing plays)
+const char* radio_get_current_url();
+
+// Known stream URL for a station (the deep-sleep snapshot): the next play
+// of that station uses it instead of the cache or a Radio.garden lookup.
+// Call before the network worker starts.
+void radio_seed_stream_url(const char* station_id, const char* url);
+
 // Get the stream URL for a station ID
 // Returns empty string on failure
 String radio_get_stream_url(const char* station_id);
 
+// Station queue (STATION_QUEUE_LENGTH > 0 in config.h): a play hands the
+// WiiM an M3U of the next stations whose stream URLs are known, so NEXT is
+// a local setPlayerCmd:next. The prefetcher keeps resolving ahead so the
+// next queue is complete.
+static const size_t RADIO_QUEUE_M3U_MAX = 2304;
+
+// Copy the current queue as M3U text (any task). False if there is none.
+bool radio_queue_m3u(char* out, size_t cap);
+
+// Copy a place's cached station list (any task), for the peer cache
+// server: up to cap records, the list's length and its age. False unless
+// the list was fetched live and is still fresh.
+bool radio_copy_station_list(PlaceHandle place, StationRecord* out, int cap,
+                             int* count, int* total, uint32_t* age_ms);
+
+// The WiiM reports playlist entry index (1-based, from plicurr): follow it
+// if it moved on by itself. True if the current station changed.
+bool radio_queue_sync(int index);
+
 // Station count accessors (for status bar display)
 int radio_get_station_index();      // 1-based index of currently playing station
 int radio_get_total_stations();     // Total stations at current city
@@ -0,0 +1,339 @@
+/**
+ * Touch and network record/replay implementation for RadioWall.
+ *
+ * A capture is one flat buffer of records, each a ReplayHead followed by
+ * its key and its data (padded to a word), in the order they happened;
+ * the file is a magic word and the same bytes. Replay walks it twice over: the touch reader
+ * keeps its own cursor over the touch records, and each network lookup
+ * takes the first response with its kind and key not yet handed out.
+ *
+ * One mutex covers the buffer: records come from the touch reader, the
+ * loop and the net worker, and a REPLAY may reload the buffer under a
+ * reader that is still playing it.
+ */
+
+#include "replay.h"
+#include "serial_cmd.h"
+#include <LittleFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static const char* REPLAY_FILE = "/replay.bin";
+static const uint32_t REPLAY_MAGIC = 0x31505752;          // "RWP1"
+static const size_t REPLAY_BUF_PSRAM = 256 * 1024;
+static const size_t REPLAY_BUF_INTERNAL = 16 * 1024;
+static const int32_t REPLAY_POLL_MS = 50;                 // Longest touch reader sleep
+static const size_t DUMP_LINE_BYTES = 48;
+
+// 12 bytes, no padding
+struct ReplayHead {
+    uint8_t kind;          // ReplayKind
+    uint8_t used;          // Handed out during this replay
+    uint16_t key_len;
+    uint32_t ms;           // Touch: millis() of the sample; response: request time
+    uint32_t len;          // Data bytes after the key
+};
+
+enum ReplayMode : uint8_t {
+    MODE_OFF,
+    MODE_RECORD,
+    MODE_PLAY,
+    MODE_PLAY_TIMED,
+};
+
+static SemaphoreHandle_t _lock = nullptr;
+static volatile ReplayMode _mode = MODE_OFF;
+static uint8_t* _buf = nullptr;
+static size_t _cap = 0;
+static size_t _used = 0;
+static uint32_t _dropped = 0;          // Records that did not fit
+
+// Touch playback (touch reader task, under _lock)
+static size_t _touch_pos = 0;
+static uint32_t _touch_first_ms = 0;
+static uint32_t _play_start_ms = 0;
+static bool _touch_done = false;
+
+static const char* KIND_NAMES[] = {"touch", "redirect", "channels", "LinkPlay"};
+
+static bool alloc_buffer() {
+    if (_buf) return true;
+    _cap = psramFound() ? REPLAY_BUF_PSRAM : REPLAY_BUF_INTERNAL;
+    _buf = (uint8_t*)(psramFound() ? ps_malloc(_cap) : malloc(_cap));
+    if (!_buf) {
+        _cap = 0;
+        Serial.println("[Replay] No memory for the capture buffer");
+        return false;
+    }
+    return true;
+}
+
+// Records are padded to a word so every head stays aligned
+static size_t record_size(const ReplayHead& h) {
+    return sizeof(h) + ((h.key_len + h.len + 3) & ~(size_t)3);
+}
+
+// Call with _lock held
+static void append(ReplayKind kind, const char* key, size_t key_len, uint32_t ms,
+                   const void* data, size_t len) {
+    if (_mode != MODE_RECORD) return;
+    ReplayHead h = {kind, 0, (uint16_t)key_len, ms, (uint32_t)len};
+    if (key_len > 0xFFFF || _used + record_size(h) > _cap) {
+        if (_dropped++ == 0) Serial.println("[Replay] Capture buffer full, dropping records");
+        return;
+    }
+    memcpy(_buf + _used, &h, sizeof(h));
+    uint8_t* p = _buf + _used + sizeof(h);
+    memcpy(p, key, key_len);
+    memcpy(p + key_len, data, len);
+    _used += record_size(h);
+    memset(p + key_len + len, 0, _buf + _used - (p + key_len + len));
+}
+
+// Walk the records: check they fit the buffer exactly, clear the used
+// flags and count them. Call with _lock held.
+static bool scan_records(int* touches, int* responses) {
+    *touches = *responses = 0;
+    size_t pos = 0;
+    while (pos + sizeof(ReplayHead) <= _used) {
+        ReplayHead* h = (ReplayHead*)(_buf + pos);
+        if (pos + record_size(*h) > _used) break;
+        h->used = 0;
+        if (h->kind == REPLAY_TOUCH) (*touches)++;
+        else (*responses)++;
+        pos += record_size(*h);
+    }
+    return pos == _used;
+}
+
+// ------------------------------------------------------------------
+// Recording
+// ------------------------------------------------------------------
+
+bool replay_recording() {
+    return _mode == MODE_RECORD;
+}
+
+bool replay_playing() {
+    return _mode == MODE_PLAY || _mode == MODE_PLAY_TIMED;
+}
+
+void replay_record_touch(const TouchSample& sample) {
+    if (_mode != MODE_RECORD) return;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    append(REPLAY_TOUCH, "", 0, sample.ms, &sample, sizeof(sample));
+    xSemaphoreGive(_lock);
+}
+
+void replay_record_response(ReplayKind kind, const char* key, const String& body,
+                            unsigned long took_ms) {
+    if (_mode != MODE_RECORD) return;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    append(kind, key, strlen(key), took_ms, body.c_str(), body.length());
+    xSemaphoreGive(_lock);
+}
+
+// ------------------------------------------------------------------
+// Playback
+// ------------------------------------------------------------------
+
+int32_t replay_touch_take(TouchSample* sample) {
+    if (!replay_playing()) return -1;
+
+    int32_t wait = REPLAY_POLL_MS;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    ReplayHead h;
+    while (_touch_pos + sizeof(h) <= _used) {
+        memcpy(&h, _buf + _touch_pos, sizeof(h));
+        if (h.kind == REPLAY_TOUCH && h.len == sizeof(TouchSample)) break;
+        _touch_pos += record_size(h);
+    }
+    if (_touch_pos + sizeof(h) > _used) {
+        if (!_touch_done) {
+            _touch_done = true;
+            Serial.println("[Replay] Touch trace done (REPLAY:stop for the panel)");
+        }
+    } else {
+        // Same spacing as recorded, from when the replay started
+        uint32_t due = _play_start_ms + (h.ms - _touch_first_ms);
+        wait = (int32_t)(due - millis());
+        if (wait <= 0) {
+            memcpy(sample, _buf + _touch_pos + sizeof(h) + h.key_len, sizeof(*sample));
+            sample->ms = due;
+            _touch_pos += record_size(h);
+            wait = 0;
+        }
+    }
+    xSemaphoreGive(_lock);
+    return min(wait, REPLAY_POLL_MS);
+}
+
+bool replay_response(ReplayKind kind, const char* key, String* body) {
+    if (!replay_playing()) return false;
+
+    *body = "";
+    bool found = false;
+    uint32_t took_ms = 0;
+    size_t key_len = strlen(key);
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (size_t pos = 0; pos + sizeof(ReplayHead) <= _used;) {
+        ReplayHead* h = (ReplayHead*)(_buf + pos);
+        const char* rkey = (const char*)(h + 1);
+        if (h->kind == kind && !h->used && h->key_len == key_len &&
+            memcmp(rkey, key, key_len) == 0) {
+            h->used = 1;
+            body->concat(rkey + key_len, h->len);
+            took_ms = h->ms;
+            found = true;
+            break;
+        }
+        pos += record_size(*h);
+    }
+    xSemaphoreGive(_lock);
+
+    if (!found) {
+        Serial.printf("[Replay] No recorded %s response for %s\n", KIND_NAMES[kind], key);
+    } else if (_mode == MODE_PLAY_TIMED) {
+        delay(took_ms);
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// File
+// ------------------------------------------------------------------
+
+static bool save_capture() {
+    File f = LittleFS.open(REPLAY_FILE, "w");
+    if (!f) return false;
+    bool ok = f.write((const uint8_t*)&REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) == sizeof(REPLAY_MAGIC) &&
+              f.write(_buf, _used) == _used;
+    f.close();
+    return ok;
+}
+
+// Call with _lock held
+static bool load_capture() {
+    File f = LittleFS.open(REPLAY_FILE, "r");
+    if (!f) {
+        Serial.printf("[Replay] No %s (record one with REC)\n", REPLAY_FILE);
+        return false;
+    }
+    uint32_t magic = 0;
+    size_t size = f.size();
+    bool ok = size >= sizeof(magic) && size - sizeof(magic) <= _cap &&
+              f.read((uint8_t*)&magic, sizeof(magic)) == sizeof(magic) && magic == REPLAY_MAGIC;
+    if (ok) {
+        _used = size - sizeof(magic);
+        ok = f.read(_buf, _used) == _used;
+    }
+    f.close();
+    if (!ok) {
+        _used = 0;
+        Serial.printf("[Replay] %s is not a capture (or does not fit)\n", REPLAY_FILE);
+    }
+    return ok;
+}
+
+static void dump_capture() {
+    File f = LittleFS.open(REPLAY_FILE, "r");
+    if (!f) {
+        Serial.printf("[Replay] No %s\n", REPLAY_FILE);
+        return;
+    }
+    Serial.printf("[Replay] %s: %u bytes\n", REPLAY_FILE, (unsigned)f.size());
+    uint8_t chunk[DUMP_LINE_BYTES];
+    char line[2 * DUMP_LINE_BYTES + 1];
+    size_t n;
+    while ((n = f.read(chunk, sizeof(chunk))) > 0) {
+        for (size_t i = 0; i < n; i++) snprintf(line + 2 * i, 3, "%02x", chunk[i]);
+        Serial.printf("[Replay] rec %s\n", line);
+    }
+    f.close();
+}
+
+// ------------------------------------------------------------------
+// Serial commands
+// ------------------------------------------------------------------
+
+static void cmd_rec(const char* args) {
+    if (strcmp(args, "dump") == 0) {
+        dump_capture();
+        return;
+    }
+    if (strcmp(args, "stop") == 0) {
+        if (_mode != MODE_RECORD) {
+            Serial.println("[Replay] Not recording");
+            return;
+        }
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        _mode = MODE_OFF;
+        int touches, responses;
+        scan_records(&touches, &responses);
+        bool saved = save_capture();
+        xSemaphoreGive(_lock);
+        Serial.printf("[Replay] %d touch sample(s), %d response(s), %u KB, %lu dropped: %s\n",
+                      touches, responses, (unsigned)(_used / 1024), (unsigned long)_dropped,
+                      saved ? "saved" : "save FAILED");
+        return;
+    }
+
+    if (!alloc_buffer()) return;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _used = 0;
+    _dropped = 0;
+    _mode = MODE_RECORD;
+    xSemaphoreGive(_lock);
+    Serial.printf("[Replay] Recording (%u KB buffer, REC:stop to save)\n", (unsigned)(_cap / 1024));
+}
+
+static void cmd_replay(const char* args) {
+    if (strcmp(args, "stop") == 0) {
+        _mode = MODE_OFF;
+        Serial.println("[Replay] Stopped, back to the panel and the network");
+        return;
+    }
+    if (!alloc_buffer()) return;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _mode = MODE_OFF;
+    int touches = 0, responses = 0;
+    bool ok = load_capture() && scan_records(&touches, &responses);
+    if (ok) {
+        _touch_first_ms = 0;
+        for (size_t pos = 0; pos + sizeof(ReplayHead) <= _used;) {
+            const ReplayHead* h = (const ReplayHead*)(_buf + pos);
+            if (h->kind == REPLAY_TOUCH) {
+                _touch_first_ms = h->ms;
+                break;
+            }
+            pos += record_size(*h);
+        }
+        _touch_pos = 0;
+        _touch_done = false;
+        _play_start_ms = millis();
+        _mode = strcmp(args, "timed") == 0 ? MODE_PLAY_TIMED : MODE_PLAY;
+    } else if (_used > 0) {
+        Serial.println("[Replay] Capture is truncated");
+        _used = 0;
+    }
+    xSemaphoreGive(_lock);
+
+    if (ok) {
+        Serial.printf("[Replay] Playing %d touch sample(s), %d response(s)%s\n", touches,
+                      responses, _mode == MODE_PLAY_TIMED ? " at recorded latency" : "");
+    }
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void replay_serial_init() {
+    static_assert(sizeof(ReplayHead) == 12, "capture files hold 12-byte record heads");
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    serial_cmd_register("REC", cmd_rec);
+    serial_cmd_register("REC:", cmd_rec);
+    serial_cmd_register("REPLAY", cmd_replay);
+    serial_cmd_register("REPLAY:", cmd_replay);
+}
@@ -0,0 +1,101 @@
+/**
+ * Touch and network record/replay harness for RadioWall.
+ *
+ * Tap-to-audio and render timings wander with WiFi and radio.garden, so
+ * two builds are hard to compare by hand. Serial "REC" starts a capture:
+ * every touch sample the built-in reader pushes, and every response the
+ * redirect lookup, the channels fetch and the LinkPlay status requests
+ * get, go into a PSRAM buffer with their timing. "REC:stop" ends it and
+ * saves it to LittleFS (/replay.bin); "REC:dump" prints the file as hex
+ * lines ("[Replay] rec <hex>") for keeping it off the device.
+ *
+ * "REPLAY" loads the file and plays it back: the touch reader pushes the
+ * recorded samples at their recorded spacing instead of reading the
+ * panel, and each recorded request gets its recorded response, in order,
+ * with no network I/O. A request that was not recorded fails, as a
+ * dropped request would. "REPLAY:timed" also waits the recorded request
+ * time before each response. "REPLAY:stop" goes back to the hardware
+ * and the network.
+ *
+ * Bodies are recorded as the parser sees them (already inflated). Stream
+ * probes, plain LinkPlay commands and UPnP traffic are not recorded and
+ * go out as usual.
+ *
+ * Any task; the serial commands run on the loop task.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <Arduino.h>
+#include "touch_ring.h"
+
+enum ReplayKind : uint8_t {
+    REPLAY_TOUCH,       // TouchSample
+    REPLAY_REDIRECT,    // Stream redirect Location, keyed by listen path
+    REPLAY_CHANNELS,    // Channels JSON, keyed by request path
+    REPLAY_LINKPLAY,    // LinkPlay response body, keyed by "ip/path"
+};
+
+bool replay_recording();
+bool replay_playing();
+
+// Recording side: no-ops unless a capture is running. took_ms is the
+// request time, for REPLAY:timed.
+void replay_record_touch(const TouchSample& sample);
+void replay_record_response(ReplayKind kind, const char* key, const String& body,
+                            unsigned long took_ms);
+
+// Touch reader side while replaying. Returns -1 when not replaying (read
+// the panel), 0 with *sample filled in when a recorded sample is due, or
+// the ms to wait before asking again.
+int32_t replay_touch_take(TouchSample* sample);
+
+// Network side. Returns false when not replaying (make the request);
+// otherwise true with *body set to the next recorded response for this
+// key, or empty if there is none.
+bool replay_response(ReplayKind kind, const char* key, String* body);
+
+/**
+ * Stream that passes another through and keeps a copy of what was read
+ * while a capture is running, for replay_record_response(). expect (e.g.
+ * the Content-Length, 0 if unknown) sizes the copy up front; past it, the
+ * copy grows by doubling rather than a byte at a time.
+ */
+class ReplayTee : public Stream {
+public:
+    explicit ReplayTee(Stream& source, size_t expect = 0)
+        : _source(source), _keep(replay_recording()) {
+        if (_keep) grow(expect ? expect : 4096);
+    }
+
+    int available() override { return _source.available(); }
+    int peek() override { return _source.peek(); }
+    size_t write(uint8_t) override { return 0; }
+
+    int read() override {
+        int c = _source.read();
+        if (c >= 0 && _keep) {
+            if (_copy.length() >= _reserved) grow(max(_reserved * 2, (size_t)4096));
+            _copy += (char)c;
+        }
+        return c;
+    }
+
+    const String& captured() const { return _copy; }
+
+private:
+    void grow(size_t bytes) {
+        if (_copy.reserve(bytes)) _reserved = bytes;
+    }
+
+    Stream& _source;
+    bool _keep;
+    size_t _reserved = 0;
+    String _copy;
+};
+
+// Register the REC and REPLAY serial commands
+void replay_serial_init();
+
+#endif // REPLAY_H
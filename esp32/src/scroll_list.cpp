@@ -0,0 +1,320 @@
+/**
+ * Scrolling list implementation for RadioWall.
+ *
+ * Row sprites are full-width and shared by every list, keyed by list id,
+ * generation and row index, and replaced least recently used first. Rows
+ * are drawn into a scratch Arduino_Canvas, as text_sprites.cpp does for
+ * card text. Without PSRAM, rows are drawn straight to the screen and only
+ * those wholly in view are shown.
+ *
+ * The in-place scroll is a memmove in the PSRAM framebuffer: the async DMA
+ * memcpy in IDF 4.4 cannot target external RAM. The panel push of the
+ * band is already a DMA transfer.
+ */
+
+#include "scroll_list.h"
+#include "display.h"
+#include "theme.h"
+#include "loop_events.h"
+#include "Arduino_GFX_Library.h"
+
+static const int ROW_SLOTS = 12;                // Two screens of 80 px rows
+static const uint32_t FRAME_MS = 16;            // Flick step spacing
+static const float FLING_MIN_VELOCITY = 0.3f;   // px/ms; slower lifts just stop
+static const float FLING_STOP_VELOCITY = 0.05f; // px/ms
+static const float FLING_FRICTION_MS = 325.0f;  // Velocity falls by 1/e in this time
+
+// Position indicator under the rows
+static const int INDICATOR_GAP = 6;
+static const int INDICATOR_X = 20;
+static const int INDICATOR_W = TH_DISPLAY_W - 2 * INDICATOR_X;
+static const int INDICATOR_H = 3;
+
+struct RowSprite {
+    uint8_t list;
+    uint16_t generation;
+    int index;             // -1: empty
+    uint32_t last_used;
+    uint16_t* pixels;      // TH_DISPLAY_W x SCROLL_ROW_MAX_H, nullptr until first use
+};
+
+static RowSprite _rows[ROW_SLOTS];
+static uint32_t _tick = 0;
+static Arduino_Canvas* _scratch = nullptr;
+static bool _unavailable = false;        // No PSRAM / allocation failed
+static ScrollList* _shown = nullptr;
+
+// ------------------------------------------------------------------
+// Row cache
+// ------------------------------------------------------------------
+
+static bool ensure_scratch() {
+    if (_scratch) return true;
+    if (_unavailable) return false;
+
+    if (psramFound()) {
+        _scratch = new Arduino_Canvas(TH_DISPLAY_W, SCROLL_ROW_MAX_H, nullptr);
+        if (!_scratch->begin(GFX_SKIP_OUTPUT_BEGIN)) {
+            delete _scratch;
+            _scratch = nullptr;
+        }
+    }
+    if (!_scratch) {
+        Serial.println("[Scroll] No PSRAM, drawing rows directly");
+        _unavailable = true;
+        return false;
+    }
+    for (int i = 0; i < ROW_SLOTS; i++) _rows[i].index = -1;
+    return true;
+}
+
+// Normal (unpressed) pixels of a row, rendered on first use
+static const uint16_t* row_pixels(ScrollList& list, int index) {
+    if (!ensure_scratch()) return nullptr;
+
+    RowSprite* slot = &_rows[0];
+    for (int i = 0; i < ROW_SLOTS; i++) {
+        RowSprite& r = _rows[i];
+        if (r.pixels && r.index == index && r.list == list.id &&
+            r.generation == list.generation) {
+            r.last_used = ++_tick;
+            return r.pixels;
+        }
+        if (r.last_used < slot->last_used) slot = &r;
+    }
+
+    if (!slot->pixels) {
+        slot->pixels = (uint16_t*)ps_malloc(TH_DISPLAY_W * SCROLL_ROW_MAX_H * sizeof(uint16_t));
+        if (!slot->pixels) return nullptr;
+    }
+    _scratch->fillScreen(TH_BG);
+    list.draw_row(_scratch, index, 0, SCROLL_NOT_PRESSED);
+    memcpy(slot->pixels, _scratch->getFramebuffer(),
+           TH_DISPLAY_W * list.row_h * sizeof(uint16_t));
+
+    slot->list = list.id;
+    slot->generation = list.generation;
+    slot->index = index;
+    slot->last_used = ++_tick;
+    return slot->pixels;
+}
+
+// ------------------------------------------------------------------
+// Drawing
+// ------------------------------------------------------------------
+
+static int max_offset(const ScrollList& list) {
+    return max(0, list.count * list.row_h - list.height);
+}
+
+// Copy the part of a row (top at screen y) that falls in screen rows y0..y1
+static void blit_rows(Arduino_GFX* gfx, const ScrollList& list, const uint16_t* pixels,
+                      int y, int y0, int y1) {
+    int from = max(y, y0);
+    int to = min(y + (int)list.row_h, y1);
+    if (to <= from) return;
+    gfx->draw16bitRGBBitmap(0, from, (uint16_t*)pixels + (from - y) * TH_DISPLAY_W,
+                            TH_DISPLAY_W, to - from);
+}
+
+// Redraw screen rows y0..y1 of the list at offset off
+static void draw_band(Arduino_GFX* gfx, ScrollList& list, int y0, int y1, int off) {
+    gfx->fillRect(0, y0, TH_DISPLAY_W, y1 - y0, TH_BG);
+
+    int first = (y0 - list.top + off) / list.row_h;
+    int last = (y1 - 1 - list.top + off) / list.row_h;
+    for (int i = max(first, 0); i <= last && i < list.count; i++) {
+        int y = list.top + i * list.row_h - off;
+        const uint16_t* pixels = row_pixels(list, i);
+        if (pixels) {
+            blit_rows(gfx, list, pixels, y, y0, y1);
+        } else if (y >= list.top && y + list.row_h <= list.top + list.height) {
+            list.draw_row(gfx, i, y, SCROLL_NOT_PRESSED);
+        }
+    }
+}
+
+static void draw_indicator(Arduino_GFX* gfx, const ScrollList& list, int off) {
+    int y = list.top + list.height + INDICATOR_GAP;
+    gfx->fillRect(0, y, TH_DISPLAY_W, INDICATOR_H, TH_BG);
+    int content = list.count * list.row_h;
+    if (content <= list.height) return;
+
+    int thumb_w = max(12, INDICATOR_W * list.height / content);
+    int thumb_x = INDICATOR_X + (INDICATOR_W - thumb_w) * off / max_offset(list);
+    gfx->fillRect(INDICATOR_X, y + 1, INDICATOR_W, 1, TH_DIVIDER);
+    gfx->fillRect(thumb_x, y, thumb_w, INDICATOR_H, TH_TEXT_SEC);
+}
+
+// Bring the screen to the list's current offset and push the band
+static void show_offset(Arduino_GFX* gfx, ScrollList& list) {
+    int off = (int)lroundf(list.offset);
+    if (off == list.drawn_offset) return;
+
+    int top = list.top;
+    int bottom = list.top + list.height;
+    int shift = off - list.drawn_offset;   // > 0: rows move up
+    uint16_t* fb = display_framebuffer();
+
+    if (!fb || _unavailable || list.drawn_offset < 0 || abs(shift) >= list.height) {
+        draw_band(gfx, list, top, bottom, off);
+    } else {
+        uint16_t* band = fb + top * TH_DISPLAY_W;
+        size_t keep = (size_t)(list.height - abs(shift)) * TH_DISPLAY_W * sizeof(uint16_t);
+        if (shift > 0) {
+            memmove(band, band + shift * TH_DISPLAY_W, keep);
+            draw_band(gfx, list, bottom - shift, bottom, off);
+        } else {
+            memmove(band - shift * TH_DISPLAY_W, band, keep);
+            draw_band(gfx, list, top, top - shift, off);
+        }
+    }
+    draw_indicator(gfx, list, off);
+    list.drawn_offset = off;
+
+    display_damage(0, top, TH_DISPLAY_W, list.height + INDICATOR_GAP + INDICATOR_H);
+    display_flush();
+}
+
+// Keep the offset in range; an end stops a flick
+static void clamp_offset(ScrollList& list) {
+    int end = max_offset(list);
+    if (list.offset < 0 || list.offset > end) {
+        list.offset = constrain(list.offset, 0.0f, (float)end);
+        list.velocity = 0;
+    }
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void scroll_list_init(ScrollList& list, uint8_t id, int top, int height,
+                      int row_h, ScrollRowDrawFn draw_row) {
+    list.top = top;
+    list.height = height;
+    list.row_h = min(row_h, SCROLL_ROW_MAX_H);
+    list.id = id;
+    list.generation = 0;
+    list.count = 0;
+    list.offset = 0;
+    list.velocity = 0;
+    list.last_step_ms = 0;
+    list.drawn_offset = -1;
+    list.caught = false;
+    list.draw_row = draw_row;
+}
+
+void scroll_list_set_count(ScrollList& list, int count) {
+    list.count = count;
+    list.generation++;
+    list.drawn_offset = -1;
+    clamp_offset(list);
+}
+
+void scroll_list_scroll_to_top(ScrollList& list) {
+    list.offset = 0;
+    list.velocity = 0;
+}
+
+void scroll_list_page_down(ScrollList& list) {
+    int end = max_offset(list);
+    list.velocity = 0;
+    list.offset = (list.offset >= end) ? 0 : min((float)end, list.offset + list.height);
+}
+
+void scroll_list_render(Arduino_GFX* gfx, ScrollList& list) {
+    if (!gfx) return;
+    if (_shown && _shown != &list) _shown->velocity = 0;
+    _shown = &list;
+    clamp_offset(list);
+
+    int off = (int)lroundf(list.offset);
+    draw_band(gfx, list, list.top, list.top + list.height, off);
+    draw_indicator(gfx, list, off);
+    list.drawn_offset = off;
+}
+
+int scroll_list_hit(ScrollList& list, int y) {
+    if (list.caught) {
+        list.caught = false;
+        return -1;
+    }
+    if (y < list.top || y >= list.top + list.height) return -1;
+    int index = (y - list.top + list.drawn_offset) / list.row_h;
+    return (list.drawn_offset >= 0 && index < list.count) ? index : -1;
+}
+
+void scroll_list_press(Arduino_GFX* gfx, ScrollList& list, int index, int zone,
+                       uint32_t hold_ms) {
+    if (!gfx || index < 0 || index >= list.count || list.drawn_offset < 0) return;
+    int y = list.top + index * list.row_h - list.drawn_offset;
+    int y0 = list.top;
+    int y1 = list.top + list.height;
+
+    const uint16_t* normal = row_pixels(list, index);
+    if (normal) {
+        // Pressed over normal in the scratch, then clipped to the band
+        memcpy(_scratch->getFramebuffer(), normal, TH_DISPLAY_W * list.row_h * sizeof(uint16_t));
+        list.draw_row(_scratch, index, 0, zone);
+        blit_rows(gfx, list, _scratch->getFramebuffer(), y, y0, y1);
+    } else if (y >= y0 && y + list.row_h <= y1) {
+        list.draw_row(gfx, index, y, zone);
+    }
+    display_damage(0, y, TH_DISPLAY_W, list.row_h);
+    display_flush();
+    delay(hold_ms);
+
+    // The callback usually redraws the view; put the row back in case not
+    if (normal) {
+        blit_rows(gfx, list, row_pixels(list, index), y, y0, y1);
+        display_damage(0, y, TH_DISPLAY_W, list.row_h);
+    }
+}
+
+void scroll_list_grab() {
+    if (!_shown) return;
+    if (fabsf(_shown->velocity) > 0) _shown->caught = true;
+    _shown->velocity = 0;
+}
+
+void scroll_list_drag(Arduino_GFX* gfx, int dy) {
+    if (!_shown || !gfx) return;
+    _shown->caught = false;
+    _shown->velocity = 0;
+    _shown->offset -= dy;
+    clamp_offset(*_shown);
+    show_offset(gfx, *_shown);
+}
+
+void scroll_list_fling(float velocity_y) {
+    if (!_shown) return;
+    // Content follows the finger: finger up scrolls towards later rows
+    float v = -velocity_y;
+    if (fabsf(v) < FLING_MIN_VELOCITY) return;
+    _shown->velocity = v;
+    _shown->last_step_ms = millis();
+    loop_events_due_in(FRAME_MS);
+}
+
+void scroll_list_loop(Arduino_GFX* gfx) {
+    if (!_shown || !gfx || _shown->velocity == 0) return;
+    ScrollList& list = *_shown;
+
+    uint32_t now = millis();
+    uint32_t dt = now - list.last_step_ms;
+    if (dt < FRAME_MS) {
+        loop_events_due_in(FRAME_MS - dt);
+        return;
+    }
+    list.last_step_ms = now;
+
+    // A slow frame (long flush) moves further rather than slowing the glide
+    list.offset += list.velocity * dt;
+    list.velocity *= expf(-(float)dt / FLING_FRICTION_MS);
+    if (fabsf(list.velocity) < FLING_STOP_VELOCITY) list.velocity = 0;
+    clamp_offset(list);
+    show_offset(gfx, list);
+
+    if (list.velocity != 0) loop_events_due_in(FRAME_MS);
+}
@@ -0,0 +1,79 @@
+/**
+ * Scrolling list for the favorites and history screens.
+ *
+ * A list shows a window of fixed-height rows in a band of the screen and
+ * scrolls by pixels: dragging moves it with the finger, and a flick keeps
+ * it gliding with friction, one frame per loop pass, until it stops or
+ * reaches an end. Only the rows in view are drawn. Each row is rendered
+ * once into an RGB565 sprite in PSRAM; cached rows are blitted when they
+ * come back into view.
+ *
+ * With the framebuffer, a scroll step moves the rows already on screen
+ * up or down in place and rasterizes only the strip that came into view,
+ * then pushes the list band alone.
+ */
+
+#ifndef SCROLL_LIST_H
+#define SCROLL_LIST_H
+
+#include <Arduino.h>
+
+class Arduino_GFX;
+
+#define SCROLL_ROW_MAX_H 80      // Tallest row a list may use
+
+static const int SCROLL_NOT_PRESSED = -1;
+
+// Draw row index with its top-left at (0, y), on a cleared background.
+// pressed is the zone being touched, or SCROLL_NOT_PRESSED; a pressed row
+// is drawn over the normal one.
+typedef void (*ScrollRowDrawFn)(Arduino_GFX* gfx, int index, int y, int pressed);
+
+struct ScrollList {
+    int16_t top, height;       // Band of the screen the rows scroll in
+    int16_t row_h;
+    uint8_t id;                // Tells lists apart in the shared row cache
+    uint16_t generation;       // Bumped when the rows change
+    int count;
+    float offset;              // px the content is scrolled up by
+    float velocity;            // px/ms of a flick, 0 when still
+    uint32_t last_step_ms;
+    int drawn_offset;          // Offset on screen, -1 before the first render
+    bool caught;               // A touch stopped a flick: it is not a tap
+    ScrollRowDrawFn draw_row;
+};
+
+void scroll_list_init(ScrollList& list, uint8_t id, int top, int height,
+                      int row_h, ScrollRowDrawFn draw_row);
+
+// The rows changed (count, order or content): drop their cached sprites
+void scroll_list_set_count(ScrollList& list, int count);
+
+// Back to the first row, or one screen further (to the top again from the end)
+void scroll_list_scroll_to_top(ScrollList& list);
+void scroll_list_page_down(ScrollList& list);
+
+// Draw the rows in view and make list the one touches scroll. The caller
+// has cleared the band and flushes afterwards.
+void scroll_list_render(Arduino_GFX* gfx, ScrollList& list);
+
+// Row under screen y, or -1. A touch that caught a flick hits nothing.
+int scroll_list_hit(ScrollList& list, int y);
+
+// Touch feedback: draw the row with zone pressed, show it for hold_ms,
+// then put the normal row back
+void scroll_list_press(Arduino_GFX* gfx, ScrollList& list, int index, int zone,
+                       uint32_t hold_ms);
+
+// Gestures on the list last rendered. grab stops a flick under the finger,
+// drag moves the rows by dy px (finger direction), and fling hands over
+// the finger's velocity (px/ms) when it lifts.
+void scroll_list_grab();
+void scroll_list_drag(Arduino_GFX* gfx, int dy);
+void scroll_list_fling(float velocity_y);
+
+// Advance a flick by one frame. Call from loop() while the list's view
+// is shown.
+void scroll_list_loop(Arduino_GFX* gfx);
+
+#endif // SCROLL_LIST_H
@@ -0,0 +1,79 @@
+/**
+ * Serial command router implementation for RadioWall.
+ *
+ * A line longer than the buffer is dropped whole rather than dispatched
+ * truncated.
+ */
+
+#include "serial_cmd.h"
+
+static const int MAX_COMMANDS = 24;
+static const size_t LINE_MAX = 384;          // P:<url> needs the room
+
+struct SerialCommand {
+    const char* name;
+    SerialCommandFn fn;
+};
+
+static SerialCommand _commands[MAX_COMMANDS];
+static int _command_count = 0;
+
+static char _line[LINE_MAX];
+static size_t _line_len = 0;
+static bool _overflow = false;
+
+void serial_cmd_register(const char* name, SerialCommandFn fn) {
+    for (int i = 0; i < _command_count; i++) {
+        if (strcmp(_commands[i].name, name) == 0) {
+            _commands[i].fn = fn;
+            return;
+        }
+    }
+    if (_command_count >= MAX_COMMANDS) {
+        Serial.printf("[Serial] Command table full, dropping %s\n", name);
+        return;
+    }
+    _commands[_command_count++] = {name, fn};
+}
+
+static void dispatch(char* line) {
+    // Trim (monitors send \r\n; stray spaces from copy/paste)
+    while (*line == ' ') line++;
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) line[--len] = '\0';
+    if (len == 0) return;
+
+    for (int i = 0; i < _command_count; i++) {
+        const char* name = _commands[i].name;
+        size_t n = strlen(name);
+        bool prefix = n > 0 && name[n - 1] == ':';
+        if (prefix ? strncmp(line, name, n) == 0 : strcmp(line, name) == 0) {
+            _commands[i].fn(prefix ? line + n : "");
+            return;
+        }
+    }
+    Serial.printf("[Serial] Unknown command: %s\n", line);
+}
+
+void serial_cmd_task() {
+    // Only what has already arrived: never wait for the rest of a line
+    for (int avail = Serial.available(); avail > 0; avail--) {
+        int c = Serial.read();
+        if (c < 0) break;
+
+        if (c == '\n') {
+            if (_overflow) {
+                Serial.println("[Serial] Line too long, ignored");
+            } else {
+                _line[_line_len] = '\0';
+                dispatch(_line);
+            }
+            _line_len = 0;
+            _overflow = false;
+        } else if (_line_len < LINE_MAX - 1) {
+            _line[_line_len++] = (char)c;
+        } else {
+            _overflow = true;
+        }
+    }
+}
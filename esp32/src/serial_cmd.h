@@ -0,0 +1,27 @@
+/**
+ * Serial command router for RadioWall.
+ *
+ * serial_cmd_task() (loop) moves whatever bytes have arrived into one line
+ * buffer and never waits for the rest of a line, so a half-typed command
+ * costs the loop nothing. Each complete line goes to the handler whose name
+ * matches: a name ending in ':' matches as a prefix and the handler gets
+ * the text after it ("V:" gets "50" from "V:50"); any other name must match
+ * the whole line and the handler gets "".
+ *
+ * Modules register their commands once at init.
+ */
+
+#ifndef SERIAL_CMD_H
+#define SERIAL_CMD_H
+
+#include <Arduino.h>
+
+typedef void (*SerialCommandFn)(const char* args);
+
+// Add a command (registering a name again replaces its handler)
+void serial_cmd_register(const char* name, SerialCommandFn fn);
+
+// Assemble and dispatch lines (call from loop)
+void serial_cmd_task();
+
+#endif // SERIAL_CMD_H
@@ -2,24 +2,39 @@
  * Settings system implementation for RadioWall.
  *
  * Handles WiiM device discovery via mDNS, device selection,
- * and persistent settings storage in LittleFS JSON.
+ * and persistent settings storage in the state store.
  */
 
 #include "settings.h"
 #include "config.h"
 #include "theme.h"
 #include "display.h"
+#include "wifi_link.h"
+#include "group_monitor.h"
+#include "linkplay_client.h"
+#include "net_worker.h"
+#include "wiim_identity.h"
+#include "persist.h"
+#include "state_store.h"
+#include "world_map.h"
+#include "loop_events.h"
+#include "widgets.h"
+#include "page_cache.h"
+#include "json_arena.h"
 #include "Arduino_GFX_Library.h"
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <ESPmDNS.h>
+#include <mdns.h>
 #include <WiFi.h>
 #include <WiFiManager.h>
 #include "esp_sleep.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 extern WiFiManager wm;  // Defined in main.cpp
 
-static const char* SETTINGS_FILE = "/settings.json";
+static const char* SETTINGS_FILE = "/settings.json";   // Legacy, imported once
 
 // Layout constants
 static const int TITLE_HEIGHT          = 40;
@@ -29,68 +44,128 @@ static const int RESCAN_ROW_HEIGHT     = 60;
 static const int SETTINGS_AREA_BOTTOM  = 580;
 static const int MENU_ITEM_HEIGHT      = 80;  // Same as main menu
 
-// State
+// Discovery: mDNS queries run on a background task in short rounds and are
+// merged into a cached device table, so the Devices page renders instantly
+// and fills in rows as answers arrive.
+static const int SCAN_ROUNDS = 3;
+static const uint32_t SCAN_ROUND_MS = 700;                   // Per mdns_query_ptr
+static const unsigned long SCAN_FRESH_MS = 60UL * 1000;      // No auto-rescan within
+static const unsigned long DEVICE_TTL_MS = 10UL * 60 * 1000; // Drop devices not seen
+
+// State (the device table is shared with the scan task: hold _devices_mux)
 static DiscoveredDevice _devices[MAX_DISCOVERED_DEVICES];
 static int _device_count = 0;
+static portMUX_TYPE _devices_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t _devices_rev = 0;   // Bumped on every table change
+static bool _devices_reordered = false;      // Rows removed: full redraw needed
 static char _saved_ip[16] = "";
 static char _saved_name[48] = "";
-static bool _scanning = false;
-static int _saved_zoom = 1;  // 1, 2, or 3
+static volatile bool _scanning = false;
+static unsigned long _last_scan_ms = 0;
+static bool _scanned_once = false;
+
+// What the Devices page last showed (for incremental refresh)
+static uint32_t _rendered_rev = 0;
+static uint32_t _rendered_health_rev = 0;
+static int _rendered_count = 0;
+static bool _rendered_scanning = false;
+static int _saved_zoom = 1;  // 1..MAP_ZOOM_LIMIT (UIState clamps to what the map data has)
+static TouchTransform _touch_cal;
+static bool _have_touch_cal = false;
+static bool _country_mode = false;   // Map taps play across the tapped country
 
 // Callbacks
 static DeviceSelectedCallback _device_cb = nullptr;
 static GroupChangedCallback _group_cb = nullptr;
 
-// Persistent group IPs (loaded from settings.json)
+// Persistent group IPs
 static char _group_ips[MAX_GROUP_DEVICES][16];
 static int _group_count = 0;
 
 // Two-zone layout (matching favorites.cpp play/delete split)
 static const int SELECT_ZONE_W = 120;  // Left: select primary (0-119)
 
+// Widget pages: sub-menu items, WiFi page buttons, and on the Devices page
+// one row per visible device (id = slot) plus the header and RESCAN
+static WidgetPage _menu_page;
+static WidgetPage _wifi_page;
+static WidgetPage _devices_page;
+enum { WIFI_BTN_AP, WIFI_BTN_RESET };
+static const uint8_t DEVICES_HEADER = 100;
+static const uint8_t DEVICES_RESCAN = 101;
+
 // ------------------------------------------------------------------
-// LittleFS persistence
+// Persistence (state store, written behind through persist.h)
 // ------------------------------------------------------------------
 
-static bool save_to_file() {
-    File f = LittleFS.open(SETTINGS_FILE, "w");
-    if (!f) {
-        Serial.println("[Settings] Failed to open file for writing");
-        return false;
-    }
-
-    DynamicJsonDocument doc(512);
-    doc["ip"] = _saved_ip;
-    doc["n"] = _saved_name;
-    doc["zoom"] = _saved_zoom;
+struct SettingsRecord {
+    char ip[16];
+    char name[48];
+    uint8_t zoom;
+    uint8_t group_count;
+    uint8_t have_touch_cal;
+    uint8_t country_mode;   // Was reserved (0): older records load as city mode
+    char group_ips[MAX_GROUP_DEVICES][16];
+    TouchTransform touch_cal;
+};
 
-    if (_group_count > 0) {
-        JsonArray grp = doc.createNestedArray("grp");
-        for (int i = 0; i < _group_count; i++) {
-            grp.add(_group_ips[i]);
-        }
+static bool save_settings() {
+    SettingsRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    memcpy(rec.ip, _saved_ip, sizeof(rec.ip));
+    memcpy(rec.name, _saved_name, sizeof(rec.name));
+    rec.zoom = _saved_zoom;
+    rec.group_count = _group_count;
+    memcpy(rec.group_ips, _group_ips, sizeof(rec.group_ips));
+    rec.have_touch_cal = _have_touch_cal;
+    rec.touch_cal = _touch_cal;
+    rec.country_mode = _country_mode;
+
+    // Changed and changed back before the flush (zoom cycling): the store
+    // sees the same bytes and appends nothing
+    if (!state_store_put(STATE_KEY_SETTINGS, &rec, sizeof(rec))) {
+        Serial.println("[Settings] Failed to save settings");
+        return false;
     }
-
-    serializeJson(doc, f);
-    f.close();
     Serial.printf("[Settings] Saved: %s (%s) + %d grouped, zoom=%dx\n",
                   _saved_name, _saved_ip, _group_count, _saved_zoom);
     return true;
 }
 
-static bool load_from_file() {
-    if (!LittleFS.exists(SETTINGS_FILE)) {
-        Serial.println("[Settings] No settings file found");
-        return true;  // Not an error, just use defaults
+static bool load_from_store() {
+    SettingsRecord rec;
+    if (state_store_get(STATE_KEY_SETTINGS, &rec, sizeof(rec)) != (int)sizeof(rec)) {
+        return false;
+    }
+
+    memcpy(_saved_ip, rec.ip, sizeof(_saved_ip));
+    _saved_ip[sizeof(_saved_ip) - 1] = '\0';
+    memcpy(_saved_name, rec.name, sizeof(_saved_name));
+    _saved_name[sizeof(_saved_name) - 1] = '\0';
+    _saved_zoom = (rec.zoom >= 1 && rec.zoom <= MAP_ZOOM_LIMIT) ? rec.zoom : 1;
+    _group_count = min<int>(rec.group_count, MAX_GROUP_DEVICES);
+    memcpy(_group_ips, rec.group_ips, sizeof(_group_ips));
+    for (int i = 0; i < _group_count; i++) _group_ips[i][15] = '\0';
+    _have_touch_cal = rec.have_touch_cal;
+    _touch_cal = rec.touch_cal;
+    _country_mode = rec.country_mode != 0;
+
+    if (_saved_ip[0] != '\0') {
+        Serial.printf("[Settings] Loaded: %s (%s) + %d grouped\n",
+                      _saved_name, _saved_ip, _group_count);
     }
+    return true;
+}
 
+// Older firmware kept settings in /settings.json
+static bool load_legacy_json() {
     File f = LittleFS.open(SETTINGS_FILE, "r");
     if (!f) {
         Serial.println("[Settings] Failed to open settings file");
         return false;
     }
 
-    DynamicJsonDocument doc(512);
+    JsonArenaDoc doc(JSON_ARENA_FILE);
     DeserializationError error = deserializeJson(doc, f);
     f.close();
 
@@ -104,7 +179,15 @@ static bool load_from_file() {
     strncpy(_saved_name, doc["n"] | "", sizeof(_saved_name) - 1);
     _saved_name[sizeof(_saved_name) - 1] = '\0';
     _saved_zoom = doc["zoom"] | 1;
-    if (_saved_zoom < 1 || _saved_zoom > 5) _saved_zoom = 1;
+    if (_saved_zoom < 1 || _saved_zoom > MAP_ZOOM_LIMIT) _saved_zoom = 1;
+
+    // Touch calibration: Q16 affine [a, b, c, d, e, f]
+    JsonArray cal = doc["cal"].as<JsonArray>();
+    _have_touch_cal = cal.size() == 6;
+    if (_have_touch_cal) {
+        _touch_cal.a = cal[0]; _touch_cal.b = cal[1]; _touch_cal.c = cal[2];
+        _touch_cal.d = cal[3]; _touch_cal.e = cal[4]; _touch_cal.f = cal[5];
+    }
 
     // Load group IPs
     _group_count = 0;
@@ -118,13 +201,20 @@ static bool load_from_file() {
         }
     }
 
-    if (_saved_ip[0] != '\0') {
-        Serial.printf("[Settings] Loaded: %s (%s) + %d grouped\n",
-                      _saved_name, _saved_ip, _group_count);
-    }
+    Serial.printf("[Settings] Imported %s: %s (%s) + %d grouped\n",
+                  SETTINGS_FILE, _saved_name, _saved_ip, _group_count);
     return true;
 }
 
+static void load_settings() {
+    if (load_from_store()) return;
+    if (!LittleFS.exists(SETTINGS_FILE)) {
+        Serial.println("[Settings] No saved settings");
+        return;  // Not an error, just use defaults
+    }
+    if (load_legacy_json() && save_settings()) LittleFS.remove(SETTINGS_FILE);
+}
+
 // ------------------------------------------------------------------
 // Public API
 // ------------------------------------------------------------------
@@ -133,7 +223,9 @@ void settings_init() {
     _device_count = 0;
     _saved_ip[0] = '\0';
     _saved_name[0] = '\0';
-    load_from_file();
+    load_settings();
+    group_monitor_set_members(_group_ips, _group_count);
+    if (_saved_ip[0]) wiim_identity_set(_saved_ip, _saved_name);
 }
 
 const char* settings_get_wiim_ip() {
@@ -145,52 +237,162 @@ const char* settings_get_wiim_ip() {
     #endif
 }
 
-void settings_start_scan() {
-    _scanning = true;
-    _device_count = 0;
-
-    Serial.println("[Settings] Scanning for LinkPlay devices...");
-
-    int n = MDNS.queryService("linkplay", "tcp");
+// Call with _devices_mux held
+static void mark_grouped(DiscoveredDevice& dev) {
+    dev.grouped = false;
+    if (!dev.valid || strcmp(dev.ip, _saved_ip) == 0) return;
+    for (int g = 0; g < _group_count; g++) {
+        if (strcmp(dev.ip, _group_ips[g]) == 0) {
+            dev.grouped = true;
+            return;
+        }
+    }
+}
 
-    for (int i = 0; i < n && _device_count < MAX_DISCOVERED_DEVICES; i++) {
-        String ip_str = MDNS.IP(i).toString();
-        String hostname = MDNS.hostname(i);
+// Merge one mDNS answer into the table (scan task)
+static void merge_result(const mdns_result_t* r) {
+    char ip[16] = "0.0.0.0";
+    for (const mdns_ip_addr_t* a = r->addr; a; a = a->next) {
+        if (a->addr.type == ESP_IPADDR_TYPE_V4) {
+            uint32_t v = a->addr.u_addr.ip4.addr;   // Network byte order
+            snprintf(ip, sizeof(ip), "%u.%u.%u.%u", (unsigned)(v & 0xFF),
+                     (unsigned)((v >> 8) & 0xFF), (unsigned)((v >> 16) & 0xFF),
+                     (unsigned)(v >> 24));
+            break;
+        }
+    }
+    bool has_ip = strcmp(ip, "0.0.0.0") != 0;
+    const char* name = (r->hostname && r->hostname[0]) ? r->hostname
+                     : (r->instance_name && r->instance_name[0]) ? r->instance_name : ip;
+
+    bool added = false;
+    portENTER_CRITICAL(&_devices_mux);
+    int idx = -1;
+    for (int i = 0; i < _device_count; i++) {
+        if (strcmp(_devices[i].name, name) == 0) { idx = i; break; }
+    }
+    if (idx < 0 && _device_count < MAX_DISCOVERED_DEVICES) {
+        idx = _device_count++;
+        memset(&_devices[idx], 0, sizeof(_devices[idx]));
+        strncpy(_devices[idx].name, name, sizeof(_devices[idx].name) - 1);
+        _devices[idx].dirty = true;
+        added = true;
+    }
+    if (idx >= 0) {
+        DiscoveredDevice& dev = _devices[idx];
+        // Keep a resolved IP if this answer came without one
+        if (has_ip && strcmp(dev.ip, ip) != 0) {
+            strncpy(dev.ip, ip, sizeof(dev.ip) - 1);
+            dev.valid = true;
+            mark_grouped(dev);
+            dev.dirty = true;
+        } else if (added) {
+            strncpy(dev.ip, ip, sizeof(dev.ip) - 1);
+        }
+        dev.last_seen = millis();
+        if (dev.dirty) _devices_rev = _devices_rev + 1;
+    }
+    portEXIT_CRITICAL(&_devices_mux);
 
-        // Flag devices with unresolved IP (mDNS resolution failure)
-        bool has_ip = (ip_str != "0.0.0.0" && ip_str.length() > 0);
-        _devices[_device_count].valid = has_ip;
+    if (added) Serial.printf("[Settings]   %s (%s)\n", name, ip);
+}
 
-        strncpy(_devices[_device_count].ip, ip_str.c_str(), sizeof(_devices[0].ip) - 1);
-        _devices[_device_count].ip[sizeof(_devices[0].ip) - 1] = '\0';
+// Drop devices not seen for DEVICE_TTL_MS (scan task, after all rounds)
+static void expire_devices() {
+    unsigned long now = millis();
+    portENTER_CRITICAL(&_devices_mux);
+    int kept = 0;
+    for (int i = 0; i < _device_count; i++) {
+        if (now - _devices[i].last_seen < DEVICE_TTL_MS) {
+            if (kept != i) _devices[kept] = _devices[i];
+            kept++;
+        }
+    }
+    if (kept != _device_count) {
+        _device_count = kept;
+        _devices_reordered = true;
+    }
+    _devices_rev = _devices_rev + 1;   // Scan finished
+    portEXIT_CRITICAL(&_devices_mux);
+}
 
-        if (hostname.length() > 0) {
-            strncpy(_devices[_device_count].name, hostname.c_str(), sizeof(_devices[0].name) - 1);
-        } else {
-            strncpy(_devices[_device_count].name, ip_str.c_str(), sizeof(_devices[0].name) - 1);
+// Probe results, one record per ip (net worker task)
+static void apply_probe(const char (*ips)[16], const LinkPlayDeviceInfo* info, int count) {
+    portENTER_CRITICAL(&_devices_mux);
+    for (int i = 0; i < _device_count; i++) {
+        DiscoveredDevice& dev = _devices[i];
+        for (int p = 0; p < count; p++) {
+            if (!info[p].ok || strcmp(dev.ip, ips[p]) != 0) continue;
+            dev.probed = true;
+            dev.plain_http = info[p].plain_http;
+            dev.slave = info[p].slave;
+            dev.rtt_ms = info[p].rtt_ms;
+            memcpy(dev.label, info[p].name, sizeof(dev.label));
+            memcpy(dev.firmware, info[p].firmware, sizeof(dev.firmware));
+            dev.dirty = true;
         }
-        _devices[_device_count].name[sizeof(_devices[0].name) - 1] = '\0';
+    }
+    _devices_rev = _devices_rev + 1;
+    portEXIT_CRITICAL(&_devices_mux);
+    loop_events_notify();   // Devices page redraws the probed rows
+}
 
-        Serial.printf("[Settings]   %s (%s)\n",
-                      _devices[_device_count].name, _devices[_device_count].ip);
-        _device_count++;
+// getStatusEx on every device with an address, at once. The net worker
+// owns LinkPlay, so the scan task only hands it the list.
+static void probe_devices() {
+    char ips[MAX_DISCOVERED_DEVICES][16];
+    int count = 0;
+    portENTER_CRITICAL(&_devices_mux);
+    for (int i = 0; i < _device_count; i++) {
+        if (_devices[i].valid) memcpy(ips[count++], _devices[i].ip, sizeof(ips[0]));
     }
+    portEXIT_CRITICAL(&_devices_mux);
+    if (count == 0) return;
 
-    _scanning = false;
-    Serial.printf("[Settings] Found %d LinkPlay device(s)\n", _device_count);
+    if (!net_worker_probe_devices(ips, count, apply_probe)) {
+        Serial.println("[Settings] Device probe not queued");
+    }
+}
 
-    // Sync grouped flags with persisted group IPs
-    for (int d = 0; d < _device_count; d++) {
-        _devices[d].grouped = false;
-        if (!_devices[d].valid) continue;
-        if (strcmp(_devices[d].ip, _saved_ip) == 0) continue;
-        for (int g = 0; g < _group_count; g++) {
-            if (strcmp(_devices[d].ip, _group_ips[g]) == 0) {
-                _devices[d].grouped = true;
-                break;
+static void scan_task(void*) {
+    Serial.println("[Settings] Scanning for LinkPlay devices...");
+    unsigned long start = millis();
+
+    for (int round = 0; round < SCAN_ROUNDS; round++) {
+        mdns_result_t* results = nullptr;
+        if (mdns_query_ptr("_linkplay", "_tcp", SCAN_ROUND_MS, MAX_DISCOVERED_DEVICES,
+                           &results) == ESP_OK) {
+            for (const mdns_result_t* r = results; r; r = r->next) {
+                merge_result(r);
             }
+            mdns_query_results_free(results);
+            loop_events_notify();   // Devices page redraws new rows
         }
     }
+
+    expire_devices();
+    loop_events_notify();
+    Serial.printf("[Settings] Found %d LinkPlay device(s) in %lu ms\n",
+                  _device_count, millis() - start);
+
+    probe_devices();
+    _last_scan_ms = millis();
+    _scanned_once = true;
+    _scanning = false;
+    loop_events_notify();
+    vTaskDelete(nullptr);
+}
+
+void settings_start_scan(bool force) {
+    if (_scanning) return;
+    if (!force && _scanned_once && millis() - _last_scan_ms < SCAN_FRESH_MS) return;
+
+    _scanning = true;
+    _devices_rev = _devices_rev + 1;
+    if (xTaskCreate(scan_task, "mdns_scan", 4096, nullptr, 1, nullptr) != pdPASS) {
+        Serial.println("[Settings] Failed to start scan task");
+        _scanning = false;
+    }
 }
 
 // ------------------------------------------------------------------
@@ -205,6 +407,7 @@ static bool add_group_ip(const char* ip) {
     strncpy(_group_ips[_group_count], ip, 15);
     _group_ips[_group_count][15] = '\0';
     _group_count++;
+    group_monitor_set_members(_group_ips, _group_count);
     return true;
 }
 
@@ -215,6 +418,7 @@ static bool remove_group_ip(const char* ip) {
                 strcpy(_group_ips[j], _group_ips[j + 1]);
             }
             _group_count--;
+            group_monitor_set_members(_group_ips, _group_count);
             return true;
         }
     }
@@ -222,17 +426,11 @@ static bool remove_group_ip(const char* ip) {
 }
 
 static void sync_grouped_flags() {
+    portENTER_CRITICAL(&_devices_mux);
     for (int d = 0; d < _device_count; d++) {
-        _devices[d].grouped = false;
-        if (!_devices[d].valid) continue;
-        if (strcmp(_devices[d].ip, _saved_ip) == 0) continue;
-        for (int g = 0; g < _group_count; g++) {
-            if (strcmp(_devices[d].ip, _group_ips[g]) == 0) {
-                _devices[d].grouped = true;
-                break;
-            }
-        }
+        mark_grouped(_devices[d]);
     }
+    portEXIT_CRITICAL(&_devices_mux);
 }
 
 void settings_set_device_callback(DeviceSelectedCallback cb) {
@@ -252,33 +450,72 @@ int settings_get_group_ips(char ips[][16], int max_count) {
     return count;
 }
 
+void settings_device_moved(const char* old_ip, const char* new_ip) {
+    if (strcmp(_saved_ip, old_ip) != 0) return;
+    strncpy(_saved_ip, new_ip, sizeof(_saved_ip) - 1);
+    _saved_ip[sizeof(_saved_ip) - 1] = '\0';
+    remove_group_ip(new_ip);   // Can't be its own member
+    persist_mark_dirty(save_settings);
+    sync_grouped_flags();
+    Serial.printf("[Settings] %s moved to %s\n", _saved_name, _saved_ip);
+
+    // The header and every row's star may change
+    _devices_reordered = true;
+    _devices_rev = _devices_rev + 1;
+}
+
 // ------------------------------------------------------------------
-// Rendering: Settings sub-menu (2 items: WiFi, Devices)
+// Rendering: Settings sub-menu (3 items: WiFi, Devices, tap mode)
 // ------------------------------------------------------------------
 
-static void draw_settings_item(Arduino_GFX* gfx, int index, const char* label,
-                                const uint8_t* icon, uint16_t icon_color) {
-    int y_top = TITLE_HEIGHT + index * MENU_ITEM_HEIGHT;
-    int card_y = y_top + 4;
+// Tap mode icon (16x16): map pin
+static const uint8_t ICON_PIN[] PROGMEM = {
+    0x00, 0x00, 0x07, 0xE0, 0x0F, 0xF0, 0x1C, 0x38,
+    0x18, 0x18, 0x19, 0x98, 0x19, 0x98, 0x18, 0x18,
+    0x1C, 0x38, 0x0F, 0xF0, 0x07, 0xE0, 0x03, 0xC0,
+    0x01, 0x80, 0x01, 0x80, 0x00, 0x00, 0x00, 0x00
+};
+
+static void draw_settings_item(Arduino_GFX* gfx, const Widget& w, int pressed) {
+    static const char* const labels[] = { "WiFi", "Devices", nullptr };
+    static const uint8_t* const icons[] = { ICON_GEAR, ICON_VOLUME, ICON_PIN };
+    int card_y = w.y + 4;
     int card_h = MENU_ITEM_HEIGHT - 8;
 
-    gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
-                        TH_CORNER_R, TH_CARD);
+    gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h, TH_CORNER_R,
+                        pressed == WIDGET_NOT_PRESSED ? TH_CARD : TH_CARD_HI);
 
     int icon_y = card_y + (card_h - 16) / 2;
-    gfx->drawBitmap(14, icon_y, icon, 16, 16, icon_color);
+    gfx->drawBitmap(14, icon_y, icons[w.id], 16, 16, TH_ACCENT);
 
     gfx->setFont(&FreeSansBold10pt7b);
     gfx->setTextSize(1);
     gfx->setTextColor(TH_TEXT);
     gfx->setCursor(38, card_y + card_h / 2 + FONT_SANS_ASCENT / 2 - 1);
-    gfx->print(label);
+    gfx->print(labels[w.id] ? labels[w.id] : (_country_mode ? "Tap: Country" : "Tap: City"));
     gfx->setFont((const GFXfont*)nullptr);
 }
 
 void settings_render(Arduino_GFX* gfx) {
     if (!gfx) return;
 
+    if (_menu_page.count == 0) {
+        widget_add(_menu_page, SETTINGS_ITEM_WIFI, 0, TITLE_HEIGHT,
+                   TH_DISPLAY_W, MENU_ITEM_HEIGHT, draw_settings_item);
+        widget_add(_menu_page, SETTINGS_ITEM_DEVICES, 0, TITLE_HEIGHT + MENU_ITEM_HEIGHT,
+                   TH_DISPLAY_W, MENU_ITEM_HEIGHT, draw_settings_item);
+        widget_add(_menu_page, SETTINGS_ITEM_TAP_MODE, 0, TITLE_HEIGHT + 2 * MENU_ITEM_HEIGHT,
+                   TH_DISPLAY_W, MENU_ITEM_HEIGHT, draw_settings_item);
+    }
+    widget_page_show(_menu_page);
+
+    // Only the tap mode card's label changes
+    uint32_t key = page_cache_key(PAGE_CACHE_KEY_SEED, &_country_mode, sizeof(_country_mode));
+    if (page_cache_draw(PAGE_CACHE_SETTINGS, key)) {
+        widget_page_mark_drawn(_menu_page);
+        return;
+    }
+
     gfx->fillRect(0, 0, TH_DISPLAY_W, SETTINGS_AREA_BOTTOM, TH_BG);
 
     // Title
@@ -291,33 +528,25 @@ void settings_render(Arduino_GFX* gfx) {
 
     gfx->drawFastHLine(5, TITLE_HEIGHT - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
 
-    // Item 0: WiFi
-    // Use a simple "W" indicator for WiFi status
-    draw_settings_item(gfx, 0, "WiFi", ICON_GEAR, TH_ACCENT);
-
-    // Item 1: Devices
-    draw_settings_item(gfx, 1, "Devices", ICON_VOLUME, TH_ACCENT);
+    widget_page_render(gfx, _menu_page);
+    page_cache_store(PAGE_CACHE_SETTINGS, key, 0, SETTINGS_AREA_BOTTOM);
 }
 
-bool settings_handle_touch(int x, int y, Arduino_GFX* gfx) {
-    if (y < TITLE_HEIGHT) return false;
+int settings_handle_touch(int x, int y, Arduino_GFX* gfx) {
+    Widget* w = widget_hit(_menu_page, x, y);
+    if (!w) return SETTINGS_ITEM_NONE;
 
-    int idx = (y - TITLE_HEIGHT) / MENU_ITEM_HEIGHT;
-    if (idx < 0 || idx > 1) return false;
+    // Highlight feedback; the caller opens the page
+    widget_press(gfx, w, 0, 80);
 
-    // Highlight feedback
-    if (gfx) {
-        int card_y = TITLE_HEIGHT + idx * MENU_ITEM_HEIGHT + 4;
-        int card_h = MENU_ITEM_HEIGHT - 8;
-        gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
-                            TH_CORNER_R, TH_CARD_HI);
-        delay(80);
+    if (w->id == SETTINGS_ITEM_TAP_MODE) {
+        // Toggled in place: the card redraws with the new label
+        settings_set_country_mode(!_country_mode);
+        if (gfx) widget_page_render_dirty(gfx, _menu_page);
+        return w->id;
     }
-
-    // Return the index: 0=WiFi, 1=Devices
-    // The callback routing happens in main.cpp via the touch handler
-    Serial.printf("[Settings] Tapped: %s\n", idx == 0 ? "WiFi" : "Devices");
-    return true;  // Caller checks which item via coordinates
+    Serial.printf("[Settings] Tapped: %s\n", w->id == SETTINGS_ITEM_WIFI ? "WiFi" : "Devices");
+    return w->id;
 }
 
 // ------------------------------------------------------------------
@@ -332,9 +561,77 @@ static const uint8_t ICON_WIFI[] PROGMEM = {
     0x03, 0xC0, 0x01, 0x80, 0x00, 0x00, 0x00, 0x00
 };
 
+static const int WIFI_BUTTON_H = 44;
+
+static void draw_wifi_button(Arduino_GFX* gfx, const Widget& w, int pressed) {
+    bool ap = (w.id == WIFI_BTN_AP);
+    uint16_t accent = ap ? TH_WARNING : TH_DANGER;
+    if (pressed == WIDGET_NOT_PRESSED) {
+        gfx->fillRoundRect(TH_CARD_MARGIN, w.y, TH_CARD_W, w.h, TH_CORNER_R, TH_CARD);
+        gfx->drawRoundRect(TH_CARD_MARGIN, w.y, TH_CARD_W, w.h, TH_CORNER_R, accent);
+    } else {
+        gfx->fillRoundRect(TH_CARD_MARGIN, w.y, TH_CARD_W, w.h, TH_CORNER_R, TH_CARD_HI);
+    }
+    gfx->setFont(&FreeSansBold10pt7b);
+    gfx->setTextSize(1);
+    gfx->setTextColor(pressed == WIDGET_NOT_PRESSED ? accent : (ap ? TH_TEXT : TH_DANGER));
+    gfx->setCursor(18, w.y + w.h / 2 + FONT_SANS_ASCENT / 2 - 1);
+    bool portal = wifi_link_portal_active();
+    if (pressed == WIDGET_NOT_PRESSED) {
+        gfx->print(ap ? (portal ? "Stop Setup" : "AP Setup") : "Reset WiFi");
+    } else {
+        gfx->print(ap ? (portal ? "Stopping..." : "Starting...") : "Resetting...");
+    }
+    gfx->setFont((const GFXfont*)nullptr);
+}
+
+// Where the last full draw put the signal value (-1: not shown) and the
+// buttons; a cached copy has the same layout
+static int _wifi_signal_y = -1;
+static int _wifi_buttons_y = 0;
+
+// The signal value line, cleared first: it changes under a cached copy
+static void draw_wifi_signal(Arduino_GFX* gfx, int y) {
+    gfx->fillRect(10, y, TH_DISPLAY_W - 20, 8, TH_BG);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TH_TEXT);
+    gfx->setCursor(10, y);
+    gfx->printf("%d dBm", WiFi.RSSI());
+    display_damage(10, y, TH_DISPLAY_W - 20, 8);
+}
+
+static void wifi_buttons_layout(int y) {
+    widget_page_clear(_wifi_page);
+    widget_add(_wifi_page, WIFI_BTN_AP, 0, y, TH_DISPLAY_W, WIFI_BUTTON_H, draw_wifi_button);
+    y += WIFI_BUTTON_H + 10;
+    widget_add(_wifi_page, WIFI_BTN_RESET, 0, y, TH_DISPLAY_W, WIFI_BUTTON_H, draw_wifi_button);
+    widget_page_show(_wifi_page);
+}
+
 void settings_wifi_render(Arduino_GFX* gfx) {
     if (!gfx) return;
 
+    // Everything shown but the signal, which is drawn over the copy
+    bool portal = wifi_link_portal_active();
+    bool connected = wifi_link_up();
+    unsigned long left_min = (wifi_link_portal_remaining_ms() + 59999) / 60000;
+    uint32_t key = PAGE_CACHE_KEY_SEED;
+    key = page_cache_key(key, &portal, sizeof(portal));
+    key = page_cache_key(key, &left_min, sizeof(left_min));
+    key = page_cache_key(key, &connected, sizeof(connected));
+    if (connected && !portal) {
+        key = page_cache_key(key, WiFi.SSID().c_str());
+        key = page_cache_key(key, WiFi.localIP().toString().c_str());
+        key = page_cache_key(key, WiFi.gatewayIP().toString().c_str());
+        key = page_cache_key(key, WiFi.macAddress().c_str());
+    }
+    if (page_cache_draw(PAGE_CACHE_WIFI, key)) {
+        if (_wifi_signal_y >= 0) draw_wifi_signal(gfx, _wifi_signal_y);
+        wifi_buttons_layout(_wifi_buttons_y);
+        widget_page_mark_drawn(_wifi_page);
+        return;
+    }
+
     gfx->fillRect(0, 0, TH_DISPLAY_W, SETTINGS_AREA_BOTTOM, TH_BG);
 
     // Title
@@ -347,15 +644,56 @@ void settings_wifi_render(Arduino_GFX* gfx) {
 
     gfx->drawFastHLine(5, TITLE_HEIGHT - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
 
-    bool connected = (WiFi.status() == WL_CONNECTED);
     int row_y = TITLE_HEIGHT + 10;
+    _wifi_signal_y = -1;
 
-    // Status indicator
-    gfx->setTextSize(1);
-    gfx->setTextColor(connected ? TH_PLAYING : TH_DANGER);
-    gfx->setCursor(10, row_y);
-    gfx->print(connected ? "Connected" : "Disconnected");
-    row_y += 24;
+    // Portal open: how to reach it, in place of the link details
+    if (portal) {
+        gfx->setTextSize(1);
+        gfx->setTextColor(TH_WARNING);
+        gfx->setCursor(10, row_y);
+        gfx->print("Setup portal open");
+        row_y += 24;
+        gfx->setTextColor(TH_TEXT);
+        gfx->setCursor(10, row_y);
+        gfx->print("1. Connect to");
+        row_y += 18;
+        gfx->setTextColor(TH_WARNING);
+        gfx->setCursor(10, row_y);
+        gfx->print("  \"" WIFI_LINK_PORTAL_SSID "\"");
+        row_y += 18;
+        gfx->setTextColor(TH_TEXT);
+        gfx->setCursor(10, row_y);
+        gfx->print("  WiFi network");
+        row_y += 28;
+        gfx->setCursor(10, row_y);
+        gfx->print("2. Open browser");
+        row_y += 18;
+        gfx->setTextColor(TH_ACCENT);
+        gfx->setFont(&FreeSansBold10pt7b);
+        gfx->setCursor(10, row_y + FONT_SANS_ASCENT);
+        gfx->print("192.168.4.1");
+        gfx->setFont((const GFXfont*)nullptr);
+        row_y += 34;
+        if (left_min) {
+            gfx->setTextColor(TH_TEXT_SEC);
+            gfx->setCursor(10, row_y);
+            gfx->printf("Closes in %lu min", left_min);
+            row_y += 18;
+        }
+        gfx->setTextColor(TH_TEXT_SEC);
+        gfx->setCursor(10, row_y);
+        gfx->print("Press button to cancel");
+        row_y += 22;
+        connected = false;   // No link details below
+    } else {
+        // Status indicator
+        gfx->setTextSize(1);
+        gfx->setTextColor(connected ? TH_PLAYING : TH_DANGER);
+        gfx->setCursor(10, row_y);
+        gfx->print(connected ? "Connected" : "Disconnected");
+        row_y += 24;
+    }
 
     if (connected) {
         // SSID
@@ -396,10 +734,8 @@ void settings_wifi_render(Arduino_GFX* gfx) {
         gfx->setCursor(10, row_y);
         gfx->print("Signal:");
         row_y += 14;
-        gfx->setTextColor(TH_TEXT);
-        gfx->setCursor(10, row_y);
-        int rssi = WiFi.RSSI();
-        gfx->printf("%d dBm", rssi);
+        _wifi_signal_y = row_y;
+        draw_wifi_signal(gfx, row_y);
         row_y += 22;
 
         // MAC
@@ -417,111 +753,91 @@ void settings_wifi_render(Arduino_GFX* gfx) {
     gfx->drawFastHLine(5, row_y, TH_DISPLAY_W - 10, TH_DIVIDER);
     row_y += 10;
 
-    // "Start AP Setup" button
-    int btn_h = 44;
-    gfx->fillRoundRect(TH_CARD_MARGIN, row_y, TH_CARD_W, btn_h,
-                        TH_CORNER_R, TH_CARD);
-    gfx->drawRoundRect(TH_CARD_MARGIN, row_y, TH_CARD_W, btn_h,
-                        TH_CORNER_R, TH_WARNING);
-    gfx->setFont(&FreeSansBold10pt7b);
-    gfx->setTextSize(1);
-    gfx->setTextColor(TH_WARNING);
-    gfx->setCursor(18, row_y + btn_h / 2 + FONT_SANS_ASCENT / 2 - 1);
-    gfx->print("AP Setup");
-    gfx->setFont((const GFXfont*)nullptr);
-
-    row_y += btn_h + 10;
-
-    // "Reset WiFi" button
-    gfx->fillRoundRect(TH_CARD_MARGIN, row_y, TH_CARD_W, btn_h,
-                        TH_CORNER_R, TH_CARD);
-    gfx->drawRoundRect(TH_CARD_MARGIN, row_y, TH_CARD_W, btn_h,
-                        TH_CORNER_R, TH_DANGER);
-    gfx->setFont(&FreeSansBold10pt7b);
-    gfx->setTextSize(1);
-    gfx->setTextColor(TH_DANGER);
-    gfx->setCursor(18, row_y + btn_h / 2 + FONT_SANS_ASCENT / 2 - 1);
-    gfx->print("Reset WiFi");
-    gfx->setFont((const GFXfont*)nullptr);
-}
-
-// Compute button Y positions (must match render)
-static int wifi_buttons_y() {
-    bool connected = (WiFi.status() == WL_CONNECTED);
-    int row_y = TITLE_HEIGHT + 10;
-    row_y += 24;  // status line
-    if (connected) {
-        row_y += 14 + 22;  // SSID
-        row_y += 14 + 22;  // IP
-        row_y += 14 + 22;  // Gateway
-        row_y += 14 + 22;  // Signal
-        row_y += 14 + 30;  // MAC
-    }
-    row_y += 10;  // divider gap
-    return row_y;
+    // The buttons sit below however many info lines there were
+    _wifi_buttons_y = row_y;
+    wifi_buttons_layout(row_y);
+    widget_page_render(gfx, _wifi_page);
+    page_cache_store(PAGE_CACHE_WIFI, key, 0, SETTINGS_AREA_BOTTOM);
 }
 
 bool settings_wifi_handle_touch(int x, int y, Arduino_GFX* gfx) {
-    int btn_start = wifi_buttons_y();
-    int btn_h = 44;
+    Widget* w = widget_hit(_wifi_page, x, y);
+    if (!w) return false;
 
-    // AP Setup button
-    if (y >= btn_start && y < btn_start + btn_h) {
+    if (w->id == WIFI_BTN_AP) {
         Serial.println("[Settings/WiFi] AP Setup tapped");
-        if (gfx) {
-            gfx->fillRoundRect(TH_CARD_MARGIN, btn_start, TH_CARD_W, btn_h,
-                                TH_CORNER_R, TH_CARD_HI);
-            gfx->setFont(&FreeSansBold10pt7b);
-            gfx->setTextColor(TH_TEXT);
-            gfx->setCursor(18, btn_start + btn_h / 2 + FONT_SANS_ASCENT / 2 - 1);
-            gfx->print("Starting...");
-            gfx->setFont((const GFXfont*)nullptr);
+        widget_press(gfx, w, 0, 300);
+        if (wifi_link_portal_active()) {
+            wifi_link_portal_cancel();
+        } else {
+            wifi_link_portal_start(WIFI_LINK_PORTAL_TIMEOUT_MS);
         }
-        delay(300);
-        settings_wifi_start_portal();
         settings_wifi_render(gfx);
-        return true;
-    }
-
-    // Reset WiFi button
-    int reset_y = btn_start + btn_h + 10;
-    if (y >= reset_y && y < reset_y + btn_h) {
+    } else {
         Serial.println("[Settings/WiFi] Reset tapped");
-        if (gfx) {
-            gfx->fillRoundRect(TH_CARD_MARGIN, reset_y, TH_CARD_W, btn_h,
-                                TH_CORNER_R, TH_CARD_HI);
-            gfx->setFont(&FreeSansBold10pt7b);
-            gfx->setTextColor(TH_DANGER);
-            gfx->setCursor(18, reset_y + btn_h / 2 + FONT_SANS_ASCENT / 2 - 1);
-            gfx->print("Resetting...");
-            gfx->setFont((const GFXfont*)nullptr);
-        }
-        delay(500);
+        widget_press(gfx, w, 0, 500);
         settings_wifi_reset();
-        return true;
     }
-
-    return false;
+    return true;
 }
 
 // ------------------------------------------------------------------
 // Rendering: Devices page
 // ------------------------------------------------------------------
 
-static void draw_device_row(Arduino_GFX* gfx, int index, int y_top) {
-    bool is_primary = _devices[index].valid &&
-                      (strcmp(_devices[index].ip, _saved_ip) == 0);
-    bool is_grouped = _devices[index].grouped;
+// Copy a table entry (false past the end); rendering clears its dirty flag
+static bool snapshot_device(int index, DiscoveredDevice* out, bool rendered = true) {
+    portENTER_CRITICAL(&_devices_mux);
+    bool ok = index < _device_count;
+    if (ok) {
+        *out = _devices[index];
+        if (rendered) _devices[index].dirty = false;
+    }
+    portEXIT_CRITICAL(&_devices_mux);
+    return ok;
+}
+
+// One device card; pressed 0 = select zone, 1 = group zone
+static void draw_device_row(Arduino_GFX* gfx, const Widget& w, int pressed) {
+    DiscoveredDevice dev;
+    if (!snapshot_device(w.id, &dev)) return;
 
-    int card_y = y_top + 2;
+    bool is_primary = dev.valid &&
+                      (strcmp(dev.ip, _saved_ip) == 0);
+    bool is_grouped = dev.grouped;
+
+    int card_y = w.y + 2;
     int card_h = DEVICE_ROW_HEIGHT - 4;
 
+    if (pressed == 0) {
+        gfx->fillRoundRect(TH_CARD_MARGIN, card_y, SELECT_ZONE_W - TH_CARD_MARGIN,
+                           card_h, TH_CORNER_R, TH_CARD_HI);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TH_TEXT);
+        gfx->setCursor(10, card_y + 10);
+        char trunc[19];
+        strncpy(trunc, dev.label[0] ? dev.label : dev.name, 18);
+        trunc[18] = '\0';
+        gfx->print(trunc);
+        return;
+    }
+    if (pressed == 1) {
+        gfx->fillRoundRect(SELECT_ZONE_W + 1, card_y,
+                           TH_CARD_W - SELECT_ZONE_W + TH_CARD_MARGIN,
+                           card_h, TH_CORNER_R, TH_CARD_HI);
+        gfx->setTextSize(1);
+        gfx->setTextColor(TH_TEXT);
+        gfx->setCursor(SELECT_ZONE_W + 8, card_y + 25);
+        gfx->print(is_grouped ? "Leave" : "Join");
+        return;
+    }
+
     gfx->fillRoundRect(TH_CARD_MARGIN, card_y, TH_CARD_W, card_h,
                         TH_CORNER_R, TH_CARD);
 
     // Left zone: device name + primary indicator
     gfx->setTextSize(1);
-    if (!_devices[index].valid) {
+    if (!dev.valid) {
         gfx->setTextColor(TH_DIVIDER);
     } else if (is_primary) {
         gfx->setTextColor(TH_PLAYING);
@@ -530,23 +846,43 @@ static void draw_device_row(Arduino_GFX* gfx, int index, int y_top) {
     }
     gfx->setCursor(10, card_y + 10);
 
+    const char* name = dev.label[0] ? dev.label : dev.name;
     char trunc_name[19];
     if (is_primary) {
         trunc_name[0] = '*';
-        strncpy(trunc_name + 1, _devices[index].name, 17);
+        strncpy(trunc_name + 1, name, 17);
         trunc_name[18] = '\0';
     } else {
-        strncpy(trunc_name, _devices[index].name, 18);
+        strncpy(trunc_name, name, 18);
         trunc_name[18] = '\0';
     }
     gfx->print(trunc_name);
 
-    gfx->setTextColor(_devices[index].valid ? TH_TEXT_SEC : TH_DIVIDER);
+    // Probe result: firmware, transport, group role, round trip
+    if (dev.probed) {
+        const char* fw = strchr(dev.firmware, '.');   // "Linkplay.4.8.6": from "4."
+        fw = fw && isalpha((unsigned char)dev.firmware[0]) ? fw + 1 : dev.firmware;
+        char detail[21];
+        snprintf(detail, sizeof(detail), "%.7s %s%s %ums", fw, dev.plain_http ? "http" : "tls",
+                 dev.slave ? "+grp" : "", dev.rtt_ms);
+        gfx->setTextColor(TH_TEXT_SEC);
+        gfx->setCursor(10, card_y + 24);
+        gfx->print(detail);
+    }
+
+    gfx->setTextColor(dev.valid ? TH_TEXT_SEC : TH_DIVIDER);
     gfx->setCursor(10, card_y + 38);
-    gfx->print(_devices[index].valid ? _devices[index].ip : "(no IP)");
+    gfx->print(dev.valid ? dev.ip : "(no IP)");
+
+    // Reachability from the group monitor (primary and members only)
+    GroupHealth health = dev.valid ? group_monitor_health(dev.ip) : GROUP_HEALTH_UNKNOWN;
+    if (health != GROUP_HEALTH_UNKNOWN) {
+        gfx->fillCircle(SELECT_ZONE_W - 10, card_y + 41, 3,
+                        health == GROUP_HEALTH_UP ? TH_PLAYING : TH_DANGER);
+    }
 
     // Right zone: group toggle
-    if (_devices[index].valid && !is_primary) {
+    if (dev.valid && !is_primary) {
         gfx->setFont(&FreeSansBold10pt7b);
         gfx->setTextSize(1);
         gfx->setTextColor(is_grouped ? TH_ACCENT : TH_DIVIDER);
@@ -558,23 +894,25 @@ static void draw_device_row(Arduino_GFX* gfx, int index, int y_top) {
     }
 }
 
-void settings_devices_render(Arduino_GFX* gfx) {
-    if (!gfx) return;
-
-    gfx->fillRect(0, 0, TH_DISPLAY_W, SETTINGS_AREA_BOTTOM, TH_BG);
-
-    // Title
+static void draw_rescan_button(Arduino_GFX* gfx, const Widget& w, int pressed) {
+    bool down = (pressed != WIDGET_NOT_PRESSED);
+    gfx->fillRoundRect(TH_CARD_MARGIN, w.y + 4, TH_CARD_W,
+                        RESCAN_ROW_HEIGHT - 8, TH_CORNER_R, down ? TH_CARD_HI : TH_CARD);
+    if (!down) {
+        gfx->drawRoundRect(TH_CARD_MARGIN, w.y + 4, TH_CARD_W,
+                            RESCAN_ROW_HEIGHT - 8, TH_CORNER_R, TH_ACCENT);
+    }
     gfx->setFont(&FreeSansBold10pt7b);
     gfx->setTextSize(1);
-    gfx->setTextColor(TH_ACCENT);
-    gfx->setCursor(36, FONT_SANS_ASCENT + 8);
-    gfx->print("DEVICES");
+    gfx->setTextColor(down ? TH_TEXT : (_scanning ? TH_TEXT_DIM : TH_ACCENT));
+    gfx->setCursor(_scanning ? 30 : 48, w.y + RESCAN_ROW_HEIGHT / 2 + 3);
+    gfx->print(_scanning ? "SCANNING" : "RESCAN");
     gfx->setFont((const GFXfont*)nullptr);
+}
 
-    gfx->drawFastHLine(5, TITLE_HEIGHT - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
-
-    // Current device info
-    int info_y = TITLE_HEIGHT + 5;
+// Current device info, between the title and the device list
+static void draw_devices_header(Arduino_GFX* gfx, const Widget& w, int) {
+    int info_y = w.y + 5;
     gfx->setTextSize(1);
     gfx->setTextColor(TH_TEXT_SEC);
     gfx->setCursor(10, info_y);
@@ -607,161 +945,175 @@ void settings_devices_render(Arduino_GFX* gfx) {
         gfx->setCursor(10, info_y);
         gfx->printf("+ %d grouped", _group_count);
     }
+}
 
-    // Divider
-    int devices_start_y = TITLE_HEIGHT + CURRENT_SECTION_HEIGHT + 20;
-    gfx->drawFastHLine(5, devices_start_y - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
+static const int DEVICES_START_Y = TITLE_HEIGHT + CURRENT_SECTION_HEIGHT + 20;
+static const int RESCAN_Y = SETTINGS_AREA_BOTTOM - RESCAN_ROW_HEIGHT;
+static const int MAX_VISIBLE_DEVICES = (RESCAN_Y - DEVICES_START_Y) / DEVICE_ROW_HEIGHT;
 
-    // Scanning state
-    if (_scanning) {
-        gfx->setTextColor(TH_WARNING);
-        gfx->setCursor(50, 250);
-        gfx->print("Scanning...");
-        return;
-    }
+static void add_device_row(int slot) {
+    widget_add(_devices_page, slot, 0, DEVICES_START_Y + slot * DEVICE_ROW_HEIGHT,
+               TH_DISPLAY_W, DEVICE_ROW_HEIGHT, draw_device_row, SELECT_ZONE_W);
+}
 
-    // Rescan button position
-    int rescan_y = SETTINGS_AREA_BOTTOM - RESCAN_ROW_HEIGHT;
-    int max_visible = (rescan_y - devices_start_y) / DEVICE_ROW_HEIGHT;
+void settings_devices_render(Arduino_GFX* gfx) {
+    if (!gfx) return;
 
-    if (_device_count == 0) {
-        gfx->setTextColor(TH_TEXT_DIM);
-        gfx->setCursor(15, devices_start_y + 40);
-        gfx->print("No devices found");
-        gfx->setCursor(15, devices_start_y + 65);
-        gfx->print("Serial cmd: W:<ip>");
-    } else {
-        int visible = min(_device_count, max_visible);
-        for (int i = 0; i < visible; i++) {
-            draw_device_row(gfx, i, devices_start_y + i * DEVICE_ROW_HEIGHT);
-        }
-    }
+    gfx->fillRect(0, 0, TH_DISPLAY_W, SETTINGS_AREA_BOTTOM, TH_BG);
 
-    // Rescan button
-    gfx->fillRoundRect(TH_CARD_MARGIN, rescan_y + 4, TH_CARD_W,
-                        RESCAN_ROW_HEIGHT - 8, TH_CORNER_R, TH_CARD);
-    gfx->drawRoundRect(TH_CARD_MARGIN, rescan_y + 4, TH_CARD_W,
-                        RESCAN_ROW_HEIGHT - 8, TH_CORNER_R, TH_ACCENT);
+    // Title
     gfx->setFont(&FreeSansBold10pt7b);
     gfx->setTextSize(1);
     gfx->setTextColor(TH_ACCENT);
-    gfx->setCursor(48, rescan_y + RESCAN_ROW_HEIGHT / 2 + 3);
-    gfx->print("RESCAN");
+    gfx->setCursor(36, FONT_SANS_ASCENT + 8);
+    gfx->print("DEVICES");
     gfx->setFont((const GFXfont*)nullptr);
+
+    gfx->drawFastHLine(5, TITLE_HEIGHT - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
+
+    // Divider
+    gfx->drawFastHLine(5, DEVICES_START_Y - 1, TH_DISPLAY_W - 10, TH_DIVIDER);
+
+    // Cached devices (the scan fills in rows via settings_devices_refresh)
+    _devices_reordered = false;
+    _rendered_rev = _devices_rev;
+    _rendered_health_rev = group_monitor_revision();
+    _rendered_scanning = _scanning;
+    _rendered_count = min(_device_count, MAX_VISIBLE_DEVICES);
+
+    widget_page_clear(_devices_page);
+    widget_add(_devices_page, DEVICES_HEADER, 0, TITLE_HEIGHT, TH_DISPLAY_W,
+               DEVICES_START_Y - 1 - TITLE_HEIGHT, draw_devices_header);
+    for (int i = 0; i < _rendered_count; i++) add_device_row(i);
+    widget_add(_devices_page, DEVICES_RESCAN, 0, RESCAN_Y, TH_DISPLAY_W,
+               RESCAN_ROW_HEIGHT, draw_rescan_button);
+    widget_page_show(_devices_page);
+    widget_page_render(gfx, _devices_page);
+
+    if (_rendered_count == 0) {
+        gfx->setTextColor(_scanning ? TH_WARNING : TH_TEXT_DIM);
+        gfx->setCursor(15, DEVICES_START_Y + 40);
+        gfx->print(_scanning ? "Scanning..." : "No devices found");
+        if (!_scanning) {
+            gfx->setCursor(15, DEVICES_START_Y + 65);
+            gfx->print("Serial cmd: W:<ip>");
+        }
+    }
 }
 
-bool settings_devices_handle_touch(int x, int y, Arduino_GFX* gfx) {
-    if (_scanning) return false;
+bool settings_devices_refresh(Arduino_GFX* gfx) {
+    if (!gfx) return false;
+
+    // A device went up or down: redraw the rows (their dots)
+    uint32_t health_rev = group_monitor_revision();
+    if (health_rev != _rendered_health_rev) {
+        _rendered_health_rev = health_rev;
+        for (int i = 0; i < _rendered_count; i++) widget_invalidate(_devices_page, i);
+        if (_rendered_rev == _devices_rev) return widget_page_render_dirty(gfx, _devices_page);
+    }
+    if (_rendered_rev == _devices_rev) return false;
+
+    // Rows removed, or the first row replaces the placeholder text
+    if (_devices_reordered || _rendered_count == 0 || _device_count < _rendered_count) {
+        settings_devices_render(gfx);
+        return true;
+    }
+    _rendered_rev = _devices_rev;
+
+    // Only new or changed rows
+    for (int i = 0; i < MAX_VISIBLE_DEVICES; i++) {
+        DiscoveredDevice dev;
+        if (!snapshot_device(i, &dev, false)) break;
+        if (i >= _rendered_count) {
+            add_device_row(i);
+            _rendered_count = i + 1;
+        } else if (!dev.dirty) {
+            continue;
+        }
+        widget_invalidate(_devices_page, i);
+    }
+
+    if (_rendered_scanning != _scanning) {
+        _rendered_scanning = _scanning;
+        widget_invalidate(_devices_page, DEVICES_RESCAN);
+    }
+    return widget_page_render_dirty(gfx, _devices_page);
+}
 
-    int devices_start_y = TITLE_HEIGHT + CURRENT_SECTION_HEIGHT + 20;
-    int rescan_y = SETTINGS_AREA_BOTTOM - RESCAN_ROW_HEIGHT;
+bool settings_devices_handle_touch(int x, int y, Arduino_GFX* gfx) {
+    int zone = 0;
+    Widget* w = widget_hit(_devices_page, x, y, &zone);
+    if (!w || w->id == DEVICES_HEADER) return false;
 
     // Rescan button
-    if (y >= rescan_y && y < SETTINGS_AREA_BOTTOM) {
+    if (w->id == DEVICES_RESCAN) {
+        if (_scanning) return false;
         Serial.println("[Settings/Devices] Rescan tapped");
-        if (gfx) {
-            gfx->fillRoundRect(TH_CARD_MARGIN, rescan_y + 4, TH_CARD_W,
-                                RESCAN_ROW_HEIGHT - 8, TH_CORNER_R, TH_CARD_HI);
-            gfx->setFont(&FreeSansBold10pt7b);
-            gfx->setTextColor(TH_TEXT);
-            gfx->setCursor(48, rescan_y + RESCAN_ROW_HEIGHT / 2 + 3);
-            gfx->print("RESCAN");
-            gfx->setFont((const GFXfont*)nullptr);
-            delay(80);
-        }
-        _scanning = true;
-        settings_devices_render(gfx);
-        settings_start_scan();
-        settings_devices_render(gfx);
+        widget_press(gfx, w, 0, 80);
+        settings_start_scan(true);
+        _rendered_scanning = _scanning;
+        widget_page_render_dirty(gfx, _devices_page);
         return true;
     }
 
     // Device rows
-    if (y >= devices_start_y && y < rescan_y && _device_count > 0) {
-        int idx = (y - devices_start_y) / DEVICE_ROW_HEIGHT;
-        int max_visible = (rescan_y - devices_start_y) / DEVICE_ROW_HEIGHT;
-        if (idx >= 0 && idx < _device_count && idx < max_visible) {
-            if (!_devices[idx].valid) {
-                Serial.printf("[Settings/Devices] %s has no IP\n", _devices[idx].name);
-                return false;
-            }
+    int idx = w->id;
+    DiscoveredDevice dev;
+    if (!snapshot_device(idx, &dev, false)) return false;
+    if (!dev.valid) {
+        Serial.printf("[Settings/Devices] %s has no IP\n", dev.name);
+        return false;
+    }
 
-            bool is_primary = (strcmp(_devices[idx].ip, _saved_ip) == 0);
-            bool is_group_zone = (x >= SELECT_ZONE_W);
-            int y_top = devices_start_y + idx * DEVICE_ROW_HEIGHT;
-            int card_y = y_top + 2;
-            int card_h = DEVICE_ROW_HEIGHT - 4;
-
-            if (is_group_zone && !is_primary) {
-                // Group toggle
-                bool currently_grouped = _devices[idx].grouped;
-
-                if (gfx) {
-                    gfx->fillRoundRect(SELECT_ZONE_W + 1, card_y,
-                                       TH_CARD_W - SELECT_ZONE_W + TH_CARD_MARGIN,
-                                       card_h, TH_CORNER_R, TH_CARD_HI);
-                    gfx->setTextSize(1);
-                    gfx->setTextColor(TH_TEXT);
-                    gfx->setCursor(SELECT_ZONE_W + 8, card_y + 25);
-                    gfx->print(currently_grouped ? "Leave" : "Join");
-                    delay(80);
-                }
-
-                _devices[idx].grouped = !currently_grouped;
-                if (currently_grouped) {
-                    remove_group_ip(_devices[idx].ip);
-                } else {
-                    add_group_ip(_devices[idx].ip);
-                }
-
-                save_to_file();
-                if (_group_cb) {
-                    _group_cb(_devices[idx].ip, !currently_grouped);
-                }
-                settings_devices_render(gfx);
-                return true;
-
-            } else {
-                // Select primary
-                Serial.printf("[Settings/Devices] Selected: %s (%s)\n",
-                             _devices[idx].name, _devices[idx].ip);
-
-                if (gfx) {
-                    gfx->fillRoundRect(TH_CARD_MARGIN, card_y,
-                                       SELECT_ZONE_W - TH_CARD_MARGIN,
-                                       card_h, TH_CORNER_R, TH_CARD_HI);
-                    gfx->setTextSize(1);
-                    gfx->setTextColor(TH_TEXT);
-                    gfx->setCursor(10, card_y + 10);
-                    char trunc[19];
-                    strncpy(trunc, _devices[idx].name, 18);
-                    trunc[18] = '\0';
-                    gfx->print(trunc);
-                    delay(80);
-                }
-
-                if (strcmp(_saved_ip, _devices[idx].ip) != 0) {
-                    remove_group_ip(_devices[idx].ip);
-                }
-
-                strncpy(_saved_ip, _devices[idx].ip, sizeof(_saved_ip) - 1);
-                _saved_ip[sizeof(_saved_ip) - 1] = '\0';
-                strncpy(_saved_name, _devices[idx].name, sizeof(_saved_name) - 1);
-                _saved_name[sizeof(_saved_name) - 1] = '\0';
-                save_to_file();
-                sync_grouped_flags();
-
-                if (_device_cb) {
-                    _device_cb(_saved_ip, _saved_name);
-                }
-
-                settings_devices_render(gfx);
-                return true;
-            }
+    bool is_primary = (strcmp(dev.ip, _saved_ip) == 0);
+
+    if (zone == 1 && !is_primary) {
+        // Group toggle: this row and the header's group count change
+        bool currently_grouped = dev.grouped;
+        widget_press(gfx, w, 1, 80);
+
+        portENTER_CRITICAL(&_devices_mux);
+        if (idx < _device_count) _devices[idx].grouped = !currently_grouped;
+        portEXIT_CRITICAL(&_devices_mux);
+        if (currently_grouped) {
+            remove_group_ip(dev.ip);
+        } else {
+            add_group_ip(dev.ip);
+        }
+
+        persist_mark_dirty(save_settings);
+        if (_group_cb) {
+            _group_cb(dev.ip, !currently_grouped);
         }
+        widget_invalidate(_devices_page, DEVICES_HEADER);
+        widget_page_render_dirty(gfx, _devices_page);
+        return true;
     }
 
-    return false;
+    // Select primary: every row's star and group mark may change
+    Serial.printf("[Settings/Devices] Selected: %s (%s)\n",
+                 dev.name, dev.ip);
+    widget_press(gfx, w, 0, 80);
+
+    if (strcmp(_saved_ip, dev.ip) != 0) {
+        remove_group_ip(dev.ip);
+    }
+
+    strncpy(_saved_ip, dev.ip, sizeof(_saved_ip) - 1);
+    _saved_ip[sizeof(_saved_ip) - 1] = '\0';
+    strncpy(_saved_name, dev.name, sizeof(_saved_name) - 1);
+    _saved_name[sizeof(_saved_name) - 1] = '\0';
+    persist_mark_dirty(save_settings);
+    sync_grouped_flags();
+    wiim_identity_set(_saved_ip, _saved_name);
+
+    if (_device_cb) {
+        _device_cb(_saved_ip, _saved_name);
+    }
+
+    widget_invalidate_all(_devices_page);
+    widget_page_render_dirty(gfx, _devices_page);
+    return true;
 }
 
 // ------------------------------------------------------------------
@@ -770,44 +1122,19 @@ bool settings_devices_handle_touch(int x, int y, Arduino_GFX* gfx) {
 
 void settings_wifi_reset() {
     Serial.println("[Settings] Clearing WiFi credentials and restarting...");
+    persist_flush_all();
     wm.resetSettings();
     delay(500);
     ESP.restart();
 }
 
-void settings_wifi_start_portal() {
-    Serial.println("[Settings] Starting captive portal (button to cancel)...");
-    display_show_wifi_portal(true);  // Show cancel instructions
-
-    wm.setConfigPortalBlocking(false);
-    wm.startConfigPortal("RadioWall");
-
-    // Non-blocking loop: check portal + button cancel
-    while (true) {
-        wm.process();
-        if (WiFi.status() == WL_CONNECTED) {
-            Serial.printf("[WiFi] Connected via portal: %s\n",
-                          WiFi.localIP().toString().c_str());
-            break;
-        }
-        if (digitalRead(0) == LOW) {
-            delay(300);  // Debounce
-            Serial.println("[WiFi] Portal cancelled by button press");
-            break;
-        }
-        delay(10);
-    }
-
-    wm.stopConfigPortal();
-    // Caller re-renders settings screen
-}
-
 // ------------------------------------------------------------------
 // Power Off (deep sleep)
 // ------------------------------------------------------------------
 
 void settings_power_off() {
     Serial.println("[Settings] Entering deep sleep (press button to wake)...");
+    persist_flush_all();
     Serial.flush();
 
     // Turn off display backlight
@@ -832,15 +1159,49 @@ int settings_get_zoom() {
 
 void settings_set_zoom(int level, Arduino_GFX* gfx) {
     if (level < 1) level = 1;
-    if (level > 5) level = 5;
-    _saved_zoom = level;
-    save_to_file();
+    if (level > MAP_ZOOM_LIMIT) level = MAP_ZOOM_LIMIT;
+    if (level != _saved_zoom) {
+        _saved_zoom = level;
+        persist_mark_dirty(save_settings);
+    }
     if (gfx) settings_render(gfx);
 }
 
 void settings_set_zoom_no_render(int level) {
     if (level < 1) level = 1;
-    if (level > 5) level = 5;
+    if (level > MAP_ZOOM_LIMIT) level = MAP_ZOOM_LIMIT;
+    if (level == _saved_zoom) return;
     _saved_zoom = level;
-    save_to_file();
+    persist_mark_dirty(save_settings);
+}
+
+// ------------------------------------------------------------------
+// Tap mode API
+// ------------------------------------------------------------------
+
+bool settings_get_country_mode() {
+    return _country_mode;
+}
+
+void settings_set_country_mode(bool on) {
+    if (_country_mode == on) return;
+    _country_mode = on;
+    Serial.printf("[Settings] Map taps play: %s\n", on ? "across the country" : "the nearest city");
+    persist_mark_dirty(save_settings);
+}
+
+// ------------------------------------------------------------------
+// Touch calibration API
+// ------------------------------------------------------------------
+
+bool settings_get_touch_calibration(TouchTransform* out) {
+    if (!_have_touch_cal) return false;
+    *out = _touch_cal;
+    return true;
+}
+
+void settings_set_touch_calibration(const TouchTransform& xform) {
+    _touch_cal = xform;
+    _have_touch_cal = true;
+    persist_mark_dirty(save_settings);
 }
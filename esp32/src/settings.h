@@ -2,13 +2,14 @@
  * Settings system for RadioWall.
  *
  * Manages device discovery (mDNS), device selection, and persistent
- * settings storage in LittleFS JSON.
+ * settings storage in the state store (state_store.h).
  */
 
 #ifndef SETTINGS_H
 #define SETTINGS_H
 
 #include <Arduino.h>
+#include "touch_calib.h"
 
 // Forward declaration
 class Arduino_GFX;
@@ -21,6 +22,15 @@ struct DiscoveredDevice {
     char ip[16];     // IP address string
     bool valid;      // false if IP couldn't be resolved (0.0.0.0)
     bool grouped;    // true if in multiroom group
+    bool dirty;      // Changed since the Devices page last drew it
+    unsigned long last_seen;  // millis() of the last mDNS answer
+    // From the getStatusEx probe after each scan (probed: it answered)
+    bool probed;
+    bool plain_http; // Commands skip TLS
+    bool slave;      // In another device's group
+    uint16_t rtt_ms;
+    char label[32];  // DeviceName as set in the WiiM app
+    char firmware[24];
 };
 
 // Callback when a device is selected as primary
@@ -35,12 +45,23 @@ void settings_init();
 // Get the saved WiiM IP (returns WIIM_IP from config.h if no saved setting)
 const char* settings_get_wiim_ip();
 
-// Start mDNS scan for LinkPlay devices (blocking, ~2s)
-void settings_start_scan();
+// The primary got a new address (wiim_identity): save it
+void settings_device_moved(const char* old_ip, const char* new_ip);
 
-// Settings sub-menu (WiFi / Devices)
+// Start a background mDNS scan for LinkPlay devices (returns immediately),
+// then have the net worker probe every device found at once
+// (net_worker_probe_devices). Skipped while one runs, or if the cached
+// table is fresh unless force is set.
+void settings_start_scan(bool force = false);
+
+// Settings sub-menu (WiFi / Devices / tap mode). The touch handler returns
+// the item tapped, for the caller to open; the tap mode card toggles in
+// place.
+enum SettingsItem {
+    SETTINGS_ITEM_NONE = -1, SETTINGS_ITEM_WIFI, SETTINGS_ITEM_DEVICES, SETTINGS_ITEM_TAP_MODE
+};
 void settings_render(Arduino_GFX* gfx);
-bool settings_handle_touch(int x, int y, Arduino_GFX* gfx);
+int settings_handle_touch(int x, int y, Arduino_GFX* gfx);
 
 // WiFi info page
 void settings_wifi_render(Arduino_GFX* gfx);
@@ -48,6 +69,7 @@ bool settings_wifi_handle_touch(int x, int y, Arduino_GFX* gfx);
 
 // Devices page
 void settings_devices_render(Arduino_GFX* gfx);
+bool settings_devices_refresh(Arduino_GFX* gfx);   // Redraw rows the scan changed (true if drawn)
 bool settings_devices_handle_touch(int x, int y, Arduino_GFX* gfx);
 
 // Callbacks
@@ -62,12 +84,18 @@ int settings_get_zoom();
 void settings_set_zoom(int level, Arduino_GFX* gfx);
 void settings_set_zoom_no_render(int level);
 
+// Map tap mode: false plays the nearest city (and hops to the next
+// nearest), true rotates through the tapped country's best cities
+bool settings_get_country_mode();
+void settings_set_country_mode(bool on);
+
+// External touch panel calibration (false if never calibrated)
+bool settings_get_touch_calibration(TouchTransform* out);
+void settings_set_touch_calibration(const TouchTransform& xform);
+
 // WiFi reset (clear saved credentials and restart into captive portal)
 void settings_wifi_reset();
 
-// Start WiFi captive portal (for setup when disconnected)
-void settings_wifi_start_portal();
-
 // Power off (deep sleep, wakes on button press)
 void settings_power_off();
 
@@ -0,0 +1,233 @@
+/**
+ * Loop and task stall monitor implementation for RadioWall.
+ *
+ * Each slot is written by its own task and read by the others (the
+ * watchdog check, the report), so all of it sits behind one spinlock.
+ * The trace ring is only searched for iterations that make the worst
+ * list, outside the spinlock; a plain loop pass costs a few words of
+ * bookkeeping.
+ */
+
+#include "stall_mon.h"
+#include "serial_cmd.h"
+#include <freertos/FreeRTOS.h>
+
+struct StallSlot {
+    bool open;
+    bool watch_logged;        // Stuck report already printed this iteration
+    uint32_t start_us;
+    uint32_t segment_us;      // When the current activity started
+    const char* activity;
+    const char* longest;      // Longest activity so far this iteration
+    uint32_t longest_us;
+    StallTaskStats stats;
+};
+
+static const char* const TASK_NAMES[STALL_TASK_COUNT] = { "loop", "net_worker" };
+
+static portMUX_TYPE _stall_mux = portMUX_INITIALIZER_UNLOCKED;
+static StallSlot _slots[STALL_TASK_COUNT];
+static StallRecord _worst[STALL_WORST_KEPT];
+static int _worst_count = 0;
+
+// ------------------------------------------------------------------
+// Bookkeeping (under _stall_mux)
+// ------------------------------------------------------------------
+
+static int bucket_for(uint32_t ms) {
+    if (ms == 0) return 0;
+    int b = 32 - __builtin_clz(ms);
+    return b < STALL_BUCKETS ? b : STALL_BUCKETS - 1;
+}
+
+static void close_segment(StallSlot& s, uint32_t now) {
+    uint32_t dur = now - s.segment_us;
+    if (!s.longest || dur > s.longest_us) {
+        s.longest_us = dur;
+        s.longest = s.activity;
+    }
+    s.segment_us = now;
+}
+
+// Slot the record would take in the worst list, or -1
+static int worst_slot(uint32_t ms) {
+    if (_worst_count < STALL_WORST_KEPT) return _worst_count;
+    int min = 0;
+    for (int i = 1; i < STALL_WORST_KEPT; i++) {
+        if (_worst[i].ms < _worst[min].ms) min = i;
+    }
+    return ms > _worst[min].ms ? min : -1;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void stall_mon_begin(StallTask task) {
+    if (task >= STALL_TASK_COUNT) return;
+    uint32_t now = micros();
+    portENTER_CRITICAL(&_stall_mux);
+    StallSlot& s = _slots[task];
+    s.open = true;
+    s.watch_logged = false;
+    s.start_us = s.segment_us = now;
+    s.activity = "-";
+    s.longest = nullptr;
+    s.longest_us = 0;
+    portEXIT_CRITICAL(&_stall_mux);
+}
+
+void stall_mon_activity(StallTask task, const char* activity) {
+    if (task >= STALL_TASK_COUNT) return;
+    uint32_t now = micros();
+    portENTER_CRITICAL(&_stall_mux);
+    StallSlot& s = _slots[task];
+    if (s.open) {
+        close_segment(s, now);
+        s.activity = activity;
+    }
+    portEXIT_CRITICAL(&_stall_mux);
+}
+
+void stall_mon_end(StallTask task) {
+    if (task >= STALL_TASK_COUNT) return;
+    uint32_t now = micros();
+
+    portENTER_CRITICAL(&_stall_mux);
+    StallSlot& s = _slots[task];
+    if (!s.open) {
+        portEXIT_CRITICAL(&_stall_mux);
+        return;
+    }
+    close_segment(s, now);
+    s.open = false;
+    uint32_t start = s.start_us;
+    uint32_t ms = (now - start) / 1000;
+    const char* activity = s.longest;
+    s.stats.buckets[bucket_for(ms)]++;
+    s.stats.count++;
+    if (ms > s.stats.max_ms) s.stats.max_ms = ms;
+    bool worst = worst_slot(ms) >= 0;
+    portEXIT_CRITICAL(&_stall_mux);
+
+    if (!worst && ms < STALL_LOG_MS) return;
+
+    StallRecord rec;
+    rec.task = task;
+    rec.activity = activity;
+    rec.has_span = trace_longest_within(start, now, &rec.span);
+    rec.ms = ms;
+    rec.at_s = millis() / 1000;
+
+    if (worst) {
+        portENTER_CRITICAL(&_stall_mux);
+        int slot = worst_slot(ms);
+        if (slot >= 0) {
+            _worst[slot] = rec;
+            if (slot == _worst_count) _worst_count++;
+        }
+        portEXIT_CRITICAL(&_stall_mux);
+    }
+    if (ms >= STALL_LOG_MS) {
+        Serial.printf("[Stall] %s: %lu ms in %s%s%s\n", TASK_NAMES[task],
+                      (unsigned long)ms, activity,
+                      rec.has_span ? ", span " : "",
+                      rec.has_span ? trace_phase_name(rec.span) : "");
+    }
+}
+
+void stall_mon_check() {
+    uint32_t now = micros();
+    for (int t = 0; t < STALL_TASK_COUNT; t++) {
+        portENTER_CRITICAL(&_stall_mux);
+        StallSlot& s = _slots[t];
+        uint32_t ms = (now - s.start_us) / 1000;
+        bool report = s.open && !s.watch_logged && (int32_t)(now - s.start_us) > 0 &&
+                      ms >= STALL_WATCH_MS;
+        const char* activity = s.activity;
+        if (report) s.watch_logged = true;
+        portEXIT_CRITICAL(&_stall_mux);
+
+        if (report) {
+            Serial.printf("[Stall] %s stuck for %lu ms in %s\n", TASK_NAMES[t],
+                          (unsigned long)ms, activity);
+        }
+    }
+}
+
+const char* stall_mon_task_name(StallTask task) {
+    return task < STALL_TASK_COUNT ? TASK_NAMES[task] : "?";
+}
+
+void stall_mon_get_task_stats(StallTask task, StallTaskStats* out) {
+    if (task >= STALL_TASK_COUNT) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    portENTER_CRITICAL(&_stall_mux);
+    *out = _slots[task].stats;
+    portEXIT_CRITICAL(&_stall_mux);
+}
+
+int stall_mon_get_worst(StallRecord* out, int max) {
+    portENTER_CRITICAL(&_stall_mux);
+    int n = _worst_count < max ? _worst_count : max;
+    StallRecord all[STALL_WORST_KEPT];
+    memcpy(all, _worst, sizeof(all));
+    int count = _worst_count;
+    portEXIT_CRITICAL(&_stall_mux);
+
+    // Longest first (selection sort on at most STALL_WORST_KEPT)
+    for (int i = 0; i < count; i++) {
+        int best = i;
+        for (int j = i + 1; j < count; j++) {
+            if (all[j].ms > all[best].ms) best = j;
+        }
+        StallRecord tmp = all[i];
+        all[i] = all[best];
+        all[best] = tmp;
+    }
+    memcpy(out, all, n * sizeof(StallRecord));
+    return n;
+}
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+static void print_histogram(StallTask task) {
+    StallTaskStats st;
+    stall_mon_get_task_stats(task, &st);
+    Serial.printf("[Stall] %s: %lu iterations, max %lu ms\n", TASK_NAMES[task],
+                  (unsigned long)st.count, (unsigned long)st.max_ms);
+    for (int b = 0; b < STALL_BUCKETS; b++) {
+        if (!st.buckets[b]) continue;
+        uint32_t lo = b == 0 ? 0 : 1UL << (b - 1);
+        if (b == STALL_BUCKETS - 1) {
+            Serial.printf("[Stall]   %6lu+      ms  %lu\n", (unsigned long)lo,
+                          (unsigned long)st.buckets[b]);
+        } else {
+            Serial.printf("[Stall]   %6lu-%-6lu ms  %lu\n", (unsigned long)lo,
+                          (unsigned long)(1UL << b), (unsigned long)st.buckets[b]);
+        }
+    }
+}
+
+static void cmd_stalls(const char*) {
+    for (int t = 0; t < STALL_TASK_COUNT; t++) print_histogram((StallTask)t);
+
+    StallRecord worst[STALL_WORST_KEPT];
+    int n = stall_mon_get_worst(worst, STALL_WORST_KEPT);
+    Serial.printf("[Stall] Worst %d:\n", n);
+    for (int i = 0; i < n; i++) {
+        const StallRecord& r = worst[i];
+        Serial.printf("[Stall]   %6lu ms  %-10s %-16s %-16s at %lus\n",
+                      (unsigned long)r.ms, TASK_NAMES[r.task], r.activity,
+                      r.has_span ? trace_phase_name(r.span) : "-",
+                      (unsigned long)r.at_s);
+    }
+}
+
+void stall_mon_serial_init() {
+    serial_cmd_register("STALLS", cmd_stalls);
+}
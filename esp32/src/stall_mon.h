@@ -0,0 +1,69 @@
+/**
+ * Loop and task stall monitor for RadioWall.
+ *
+ * A monitored task brackets each iteration (one loop() pass, one worker
+ * command or idle step) with stall_mon_begin() / stall_mon_end() and names
+ * what it is doing with stall_mon_activity(). Iteration times go into a
+ * log2-bucketed histogram per task; the STALL_WORST_KEPT longest ones are
+ * kept with the activity that ran longest in them and the longest trace
+ * span (trace.h) that ran inside, so a frozen UI can be pinned on a
+ * subsystem after the fact.
+ *
+ * stall_mon_check() (from each monitored task) logs another task that has
+ * been inside one iteration for STALL_WATCH_MS, while it is still stuck.
+ * Serial "STALLS" prints the histograms and the worst stalls.
+ */
+
+#ifndef STALL_MON_H
+#define STALL_MON_H
+
+#include <Arduino.h>
+#include "trace.h"
+
+enum StallTask : uint8_t {
+    STALL_LOOP,          // Arduino loop(): UI, touch gestures, persistence
+    STALL_NET_WORKER,    // Network worker: one command or idle step
+    STALL_TASK_COUNT
+};
+
+// Buckets: [0,1) ms, then [2^(i-1), 2^i) ms, the last one open-ended
+static const int STALL_BUCKETS = 16;
+static const int STALL_WORST_KEPT = 8;
+static const uint32_t STALL_LOG_MS = 250;      // Log iterations at least this long
+static const uint32_t STALL_WATCH_MS = 5000;   // Report a task stuck this long
+
+// Iteration bounds (on the monitored task itself)
+void stall_mon_begin(StallTask task);
+void stall_mon_end(StallTask task);
+
+// What the task is doing from now on (string literal)
+void stall_mon_activity(StallTask task, const char* activity);
+
+// Log other tasks stuck past STALL_WATCH_MS (call from each monitored task)
+void stall_mon_check();
+
+struct StallRecord {
+    StallTask task;
+    const char* activity;   // Longest activity in the iteration
+    bool has_span;
+    TracePhase span;         // Longest trace span inside it
+    uint32_t ms;
+    uint32_t at_s;           // Uptime when it ended
+};
+
+struct StallTaskStats {
+    uint32_t buckets[STALL_BUCKETS];
+    uint32_t count;
+    uint32_t max_ms;
+};
+
+const char* stall_mon_task_name(StallTask task);
+void stall_mon_get_task_stats(StallTask task, StallTaskStats* out);
+
+// Worst stalls, longest first; returns how many were copied
+int stall_mon_get_worst(StallRecord* out, int max);
+
+// Register the STALLS serial command
+void stall_mon_serial_init();
+
+#endif // STALL_MON_H
@@ -0,0 +1,223 @@
+/**
+ * Journaled state store implementation for RadioWall.
+ *
+ * Log layout: 8-byte file header (magic, version), then entries of
+ * [key u8][op u8][len u16][crc32 u32][len bytes]. The CRC covers key, op,
+ * len and the value. The latest value of every key is also kept in RAM
+ * (a few KB), which serves reads and is what compaction writes out.
+ */
+
+#include "state_store.h"
+#include <LittleFS.h>
+
+static const char* STATE_LOG = "/state.log";
+static const char* STATE_TMP = "/state.tmp";
+static const char STATE_MAGIC[4] = {'R', 'W', 'S', 'T'};
+static const uint16_t STATE_VERSION = 1;
+static const size_t STATE_COMPACT_BYTES = 32 * 1024;
+static const size_t STATE_MAX_VALUE = 4096;
+
+enum : uint8_t { OP_PUT = 0, OP_REMOVE = 1 };
+
+struct EntryHeader {
+    uint8_t key;
+    uint8_t op;
+    uint16_t len;
+    uint32_t crc;
+};
+
+struct Value {
+    uint8_t* data;           // nullptr = no value
+    uint16_t len;
+};
+
+static Value _values[STATE_KEY_COUNT];
+static size_t _log_size = 0;
+static bool _ready = false;
+
+// ------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static uint32_t entry_crc(const EntryHeader& h, const uint8_t* data) {
+    uint8_t head[4] = {h.key, h.op, (uint8_t)(h.len & 0xFF), (uint8_t)(h.len >> 8)};
+    return crc32_update(crc32_update(0, head, sizeof(head)), data, h.len);
+}
+
+static bool set_value(uint8_t key, const uint8_t* data, size_t len) {
+    Value& v = _values[key];
+    free(v.data);
+    v.data = nullptr;
+    v.len = 0;
+    if (!data) return true;
+    v.data = (uint8_t*)malloc(len ? len : 1);
+    if (!v.data) return false;
+    memcpy(v.data, data, len);
+    v.len = len;
+    return true;
+}
+
+static bool write_entry(File& f, uint8_t key, uint8_t op, const uint8_t* data, size_t len) {
+    EntryHeader h;
+    h.key = key;
+    h.op = op;
+    h.len = len;
+    h.crc = entry_crc(h, data);
+    if (f.write((const uint8_t*)&h, sizeof(h)) != sizeof(h)) return false;
+    return len == 0 || f.write(data, len) == len;
+}
+
+static bool write_file_header(File& f) {
+    uint8_t header[8] = {0};
+    memcpy(header, STATE_MAGIC, 4);
+    header[4] = STATE_VERSION & 0xFF;
+    header[5] = STATE_VERSION >> 8;
+    return f.write(header, sizeof(header)) == sizeof(header);
+}
+
+// Live values into a fresh log, then rename it over the old one
+static bool compact() {
+    File f = LittleFS.open(STATE_TMP, "w");
+    if (!f) return false;
+    bool ok = write_file_header(f);
+    size_t size = 8;
+    for (int key = 0; key < STATE_KEY_COUNT && ok; key++) {
+        const Value& v = _values[key];
+        if (!v.data) continue;
+        ok = write_entry(f, key, OP_PUT, v.data, v.len);
+        size += sizeof(EntryHeader) + v.len;
+    }
+    f.close();
+
+    // Rename replaces the target atomically; if this build's VFS refuses
+    // to overwrite, remove first (init recovers a lone state.tmp)
+    if (ok && !LittleFS.rename(STATE_TMP, STATE_LOG)) {
+        ok = LittleFS.remove(STATE_LOG) && LittleFS.rename(STATE_TMP, STATE_LOG);
+    }
+    if (!ok) {
+        Serial.println("[State] Compaction failed, keeping old log");
+        LittleFS.remove(STATE_TMP);
+        return false;
+    }
+    Serial.printf("[State] Compacted log: %u -> %u bytes\n", _log_size, size);
+    _log_size = size;
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Replay
+// ------------------------------------------------------------------
+
+// Apply entries up to the first bad one; returns the valid length
+static size_t replay(File& f) {
+    uint8_t header[8];
+    if (f.read(header, sizeof(header)) != sizeof(header) ||
+        memcmp(header, STATE_MAGIC, 4) != 0 ||
+        (header[4] | (header[5] << 8)) != STATE_VERSION) {
+        Serial.println("[State] Log header invalid, starting empty");
+        return 0;
+    }
+
+    uint8_t* buf = (uint8_t*)malloc(STATE_MAX_VALUE);
+    if (!buf) return 0;
+
+    size_t good = sizeof(header);
+    int entries = 0;
+    EntryHeader h;
+    while (f.read((uint8_t*)&h, sizeof(h)) == sizeof(h)) {
+        if (h.key >= STATE_KEY_COUNT || h.op > OP_REMOVE || h.len > STATE_MAX_VALUE) break;
+        if (f.read(buf, h.len) != h.len) break;
+        if (entry_crc(h, buf) != h.crc) break;
+        set_value(h.key, h.op == OP_PUT ? buf : nullptr, h.len);
+        good += sizeof(h) + h.len;
+        entries++;
+    }
+    free(buf);
+    Serial.printf("[State] Replayed %d entries (%u bytes)\n", entries, good);
+    return good;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+bool state_store_init() {
+    if (_ready) return true;
+    memset(_values, 0, sizeof(_values));
+
+    if (!LittleFS.exists(STATE_LOG) && LittleFS.exists(STATE_TMP)) {
+        LittleFS.rename(STATE_TMP, STATE_LOG);   // Cut off between remove and rename
+    }
+
+    bool rewrite = true;
+    if (LittleFS.exists(STATE_LOG)) {
+        File f = LittleFS.open(STATE_LOG, "r");
+        if (f) {
+            size_t total = f.size();
+            _log_size = replay(f);
+            f.close();
+            // A torn tail must go before anything is appended after it
+            rewrite = _log_size != total;
+            if (rewrite && _log_size > 0) {
+                Serial.printf("[State] Dropping %u bytes of torn log tail\n",
+                              total - _log_size);
+            }
+        }
+    }
+
+    _ready = true;
+    if (rewrite && !compact()) {
+        _ready = false;
+        return false;
+    }
+    return true;
+}
+
+int state_store_get(uint8_t key, void* buf, size_t cap) {
+    if (key >= STATE_KEY_COUNT || !_values[key].data) return -1;
+    const Value& v = _values[key];
+    if (v.len <= cap) memcpy(buf, v.data, v.len);
+    return v.len;
+}
+
+static bool append(uint8_t key, uint8_t op, const void* data, size_t len) {
+    if (!_ready || key >= STATE_KEY_COUNT || len > STATE_MAX_VALUE) return false;
+
+    File f = LittleFS.open(STATE_LOG, "a");
+    if (!f) return false;
+    bool ok = write_entry(f, key, op, (const uint8_t*)data, len);
+    f.close();
+    if (!ok) {
+        // Whatever landed is a torn entry: rewrite the log without it
+        Serial.println("[State] Append failed");
+        compact();
+        return false;
+    }
+
+    _log_size += sizeof(EntryHeader) + len;
+    set_value(key, op == OP_PUT ? (const uint8_t*)data : nullptr, len);
+    if (_log_size > STATE_COMPACT_BYTES) compact();
+    return true;
+}
+
+bool state_store_put(uint8_t key, const void* data, size_t len) {
+    if (key < STATE_KEY_COUNT && _values[key].data && _values[key].len == len &&
+        memcmp(_values[key].data, data, len) == 0) {
+        return true;   // Same as the latest value: nothing to append
+    }
+    return append(key, OP_PUT, data, len);
+}
+
+bool state_store_remove(uint8_t key) {
+    if (key < STATE_KEY_COUNT && !_values[key].data) return true;
+    return append(key, OP_REMOVE, nullptr, 0);
+}
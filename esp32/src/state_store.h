@@ -0,0 +1,48 @@
+/**
+ * Journaled state store for RadioWall.
+ *
+ * One append-only log on LittleFS (/state.log) holds every small piece of
+ * persistent state as a key/value record. A put or remove appends one
+ * CRC-checked entry, so a power cut mid-write can only lose that entry:
+ * replay at boot stops at the first torn or corrupt entry and keeps the
+ * last good value for each key. When the log outgrows STATE_COMPACT_BYTES
+ * the live values are written to a new log and renamed over the old one.
+ *
+ * Values are raw structs; callers check the length they get back, so a
+ * struct layout change reads as "no value" instead of garbage.
+ */
+
+#ifndef STATE_STORE_H
+#define STATE_STORE_H
+
+#include <Arduino.h>
+
+enum StateKey : uint8_t {
+    STATE_KEY_SETTINGS = 1,
+    STATE_KEY_PLAYBACK = 2,
+    STATE_KEY_FAVORITES = 3,
+    STATE_KEY_WIFI = 4,
+    STATE_KEY_LINKPLAY = 5,      // Per-device transport (linkplay_client)
+    STATE_KEY_WIIM_IDENTITY = 6, // Primary's IP, hostname, UUID (wiim_identity)
+    STATE_KEY_STATION_STATS = 7, // Per-station play outcomes (station_stats)
+    STATE_KEY_BENCH = 8,         // Benchmark medians per firmware build (bench)
+    STATE_KEY_TOUCH_PANELS = 9,  // USB panels: tile and calibration each (usb_touch)
+    STATE_KEY_TAP_HEAT = 10,     // Taps per places grid cell (tap_heat)
+    STATE_KEY_HISTORY = 16,      // + slot (20 slots, imported into history.cpp's ring)
+    STATE_KEY_COUNT = 64
+};
+
+// Replay the log into RAM (call once, after LittleFS is mounted)
+bool state_store_init();
+
+// Copy a value into buf. Returns its length (may exceed cap: nothing is
+// copied then), or -1 if the key has no value.
+int state_store_get(uint8_t key, void* buf, size_t cap);
+
+// Append a new value / a removal. Putting the latest value again, or
+// removing a key that has none, appends nothing. Returns false if the
+// append failed.
+bool state_store_put(uint8_t key, const void* data, size_t len);
+bool state_store_remove(uint8_t key);
+
+#endif // STATE_STORE_H
@@ -0,0 +1,176 @@
+/**
+ * Offline station catalogue implementation for RadioWall.
+ *
+ * stations.bin (little-endian):
+ *   header  "RGST", u16 version, u16 reserved, u32 place_count,
+ *           u32 places_fingerprint, u32 built_at (Unix time), u32 station_count
+ *   index   per place handle a u32 offset and a u16 block length
+ *           (0 = not covered); blocks need not be in place order
+ *   block   u8 count, then per station a packed record (station_pack.h).
+ *           Version 2 files had a 6-byte packed ID, a u8 title length and
+ *           the title instead, and are still read.
+ *
+ * Only the file handle is held; a lookup reads one index entry and one
+ * block (7 KB at most). Used from the net worker only.
+ */
+
+#include "station_catalog.h"
+#include "asset_fs.h"
+#include <LittleFS.h>
+#include <time.h>
+
+static const char* CATALOG_PATH = "/stations.bin";
+static const uint16_t CATALOG_VERSION = 3;
+static const uint16_t CATALOG_VERSION_V2 = 2;   // Fixed ID + length records
+static const uint32_t HEADER_SIZE = 24;
+static const uint32_t INDEX_ENTRY_SIZE = 6;
+static const int ID_BYTES = 6;
+static const uint32_t MAX_BLOCK = 1 + 255 * STATION_PACK_MAX;
+static const time_t CLOCK_VALID_AFTER = 1700000000;   // Nov 2023
+
+struct CatalogHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t place_count;
+    uint32_t fingerprint;
+    uint32_t built_at;
+    uint32_t station_count;
+};
+static_assert(sizeof(CatalogHeader) == HEADER_SIZE, "stations.bin header is 24 bytes");
+
+static File _file;
+static bool _loaded = false;
+static uint32_t _place_count = 0;
+static uint32_t _file_size = 0;
+static uint32_t _built_at = 0;
+static uint16_t _version = 0;
+static bool _expired_logged = false;
+
+static const char BASE64URL[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static void decode_id(const uint8_t* packed, char* out) {
+    uint64_t v = 0;
+    for (int i = 0; i < ID_BYTES; i++) v = (v << 8) | packed[i];
+    for (int i = 7; i >= 0; i--) {
+        out[i] = BASE64URL[v & 0x3F];
+        v >>= 6;
+    }
+    out[8] = '\0';
+}
+
+// Past the maximum age by the wall clock (unknown clock = still fresh)
+static bool expired() {
+    time_t now = time(nullptr);
+    if (now <= CLOCK_VALID_AFTER || (uint32_t)now < _built_at) return false;
+    if ((uint32_t)now - _built_at <= STATION_CATALOG_MAX_AGE_S) return false;
+    if (!_expired_logged) {
+        Serial.printf("[Catalog] stations.bin is %lu days old, using the network\n",
+                      (unsigned long)(((uint32_t)now - _built_at) / 86400));
+        _expired_logged = true;
+    }
+    return true;
+}
+
+static bool read_at(uint32_t offset, void* dst, size_t bytes) {
+    if (!_file.seek(offset)) return false;
+    return _file.read((uint8_t*)dst, bytes) == bytes;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+bool station_catalog_init() {
+    _loaded = false;
+    if (!places_db_loaded() || !LittleFS.exists(CATALOG_PATH)) return false;
+
+    _file = asset_fs_open(CATALOG_PATH, ASSET_RANDOM_READ_AHEAD);
+    if (!_file) return false;
+
+    CatalogHeader h;
+    uint32_t size = _file.size();
+    if (!read_at(0, &h, sizeof(h)) || memcmp(h.magic, "RGST", 4) != 0 ||
+        (h.version != CATALOG_VERSION && h.version != CATALOG_VERSION_V2)) {
+        Serial.println("[Catalog] ERROR: stations.bin has the wrong format");
+        _file.close();
+        return false;
+    }
+    if (h.place_count != places_db_count() || h.fingerprint != places_db_fingerprint()) {
+        Serial.println("[Catalog] stations.bin was built for another places.bin, ignoring it");
+        _file.close();
+        return false;
+    }
+    if (size < HEADER_SIZE + h.place_count * INDEX_ENTRY_SIZE) {
+        Serial.println("[Catalog] ERROR: stations.bin is truncated");
+        _file.close();
+        return false;
+    }
+
+    _place_count = h.place_count;
+    _file_size = size;
+    _built_at = h.built_at;
+    _version = h.version;
+    _expired_logged = false;
+    _loaded = true;
+    Serial.printf("[Catalog] %lu stations for %lu places (%lu KB)\n",
+                  (unsigned long)h.station_count, (unsigned long)h.place_count,
+                  (unsigned long)(size / 1024));
+    expired();
+    return true;
+}
+
+// A version 2 record as a packed one; its size, 0 if it runs past len
+static size_t convert_v2(const uint8_t* in, size_t len, uint8_t* out, size_t* out_len) {
+    if (len < ID_BYTES + 1 || len < ID_BYTES + 1 + (size_t)in[ID_BYTES]) return 0;
+    char id[ID_BYTES * 8 / 6 + 1];
+    char title[64];
+    decode_id(in, id);
+    size_t n = min((size_t)in[ID_BYTES], sizeof(title) - 1);
+    memcpy(title, in + ID_BYTES + 1, n);
+    title[n] = '\0';
+    *out_len = station_pack(id, title, out);
+    return ID_BYTES + 1 + in[ID_BYTES];
+}
+
+int station_catalog_get(PlaceHandle place, PackedList* out, int max) {
+    if (!_loaded || place >= _place_count || expired()) return -1;
+
+    uint8_t entry[INDEX_ENTRY_SIZE];
+    if (!read_at(HEADER_SIZE + place * INDEX_ENTRY_SIZE, entry, sizeof(entry))) return -1;
+    uint32_t offset;
+    uint16_t len;
+    memcpy(&offset, entry, 4);
+    memcpy(&len, entry + 4, 2);
+    if (len == 0 || len > MAX_BLOCK || offset + len > _file_size) return -1;
+
+    uint8_t* block = (uint8_t*)malloc(len);
+    if (!block) return -1;
+    if (!read_at(offset, block, len)) {
+        free(block);
+        return -1;
+    }
+
+    // Version 3 records go into the list as they are
+    int count = 0;
+    uint32_t pos = 1;
+    bool ok = true;
+    for (int i = 0; i < block[0] && count < max && ok; i++) {
+        size_t used;
+        if (_version == CATALOG_VERSION_V2) {
+            uint8_t rec[STATION_PACK_MAX];
+            size_t rec_len;
+            used = convert_v2(block + pos, len - pos, rec, &rec_len);
+            if (used) ok = packed_list_add_record(*out, rec, rec_len);
+        } else {
+            used = station_record_size(block + pos, len - pos);
+            if (used) ok = packed_list_add_record(*out, block + pos, used);
+        }
+        if (used == 0) break;
+        count++;
+        pos += used;
+    }
+    free(block);
+    return ok ? count : -1;
+}
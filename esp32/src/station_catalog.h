@@ -0,0 +1,33 @@
+/**
+ * Offline station catalogue for RadioWall.
+ *
+ * Optional /stations.bin on LittleFS, built by tools/compile_stations.py:
+ * the station IDs and titles of every place, indexed by place handle, so a
+ * tap can skip the channels request and go straight to the stream redirect.
+ * The file belongs to one places.bin (checked by place count and ID hash)
+ * and is ignored once it is older than STATION_CATALOG_MAX_AGE_S by the
+ * SNTP clock. Lists read from it are refetched in the background by the
+ * radio client.
+ */
+
+#ifndef STATION_CATALOG_H
+#define STATION_CATALOG_H
+
+#include <Arduino.h>
+#include "places_db.h"
+#include "station_pack.h"
+
+// Stop using the catalogue this long after it was built
+#define STATION_CATALOG_MAX_AGE_S (60UL * 24 * 3600)   // 60 days
+
+// Open /stations.bin and check it against the loaded places database.
+// Call after places_db_init(). Returns false if there is no usable file.
+bool station_catalog_init();
+
+// Append up to max stations of a place to out, as the packed records the
+// file holds, and return the count (0 = the place has no stations).
+// Returns -1 if the catalogue does not cover the place, is not loaded or
+// has expired, or out ran out of memory.
+int station_catalog_get(PlaceHandle place, PackedList* out, int max);
+
+#endif // STATION_CATALOG_H
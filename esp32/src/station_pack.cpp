@@ -0,0 +1,295 @@
+/**
+ * Packed station record implementation for RadioWall.
+ */
+
+#include "station_pack.h"
+#include "places_db.h"
+
+static const int ID_CHARS = 8;        // Radio.garden IDs
+static const int ID_BYTES = 6;        // 8 x 6 bits
+static const size_t ID_RAW_MAX = 15;
+static const size_t TITLE_MAX = 63;
+static const size_t PLACE_MAX = 31;
+static const size_t COUNTRY_MAX = 3;
+static const uint32_t DATA_CHUNK = 1024;   // A list's buffer grows by this much
+static const int SLOT_CHUNK = 32;          // Offsets at a time
+
+static const char BASE64URL[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static int base64url_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '-') return 62;
+    if (c == '_') return 63;
+    return -1;
+}
+
+// 8 base64url characters into 6 bytes; false for any other ID
+static bool pack_id(const char* id, uint8_t* out) {
+    uint64_t v = 0;
+    for (int i = 0; i < ID_CHARS; i++) {
+        int d = base64url_value(id[i]);
+        if (d < 0) return false;
+        v = (v << 6) | d;
+    }
+    if (id[ID_CHARS] != '\0') return false;
+    for (int i = ID_BYTES - 1; i >= 0; i--) {
+        out[i] = v & 0xFF;
+        v >>= 8;
+    }
+    return true;
+}
+
+static void unpack_id(const uint8_t* packed, char* out) {
+    uint64_t v = 0;
+    for (int i = 0; i < ID_BYTES; i++) v = (v << 8) | packed[i];
+    for (int i = ID_CHARS - 1; i >= 0; i--) {
+        out[i] = BASE64URL[v & 0x3F];
+        v >>= 6;
+    }
+    out[ID_CHARS] = '\0';
+}
+
+static size_t put_varint(uint8_t* out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    out[n++] = v;
+    return n;
+}
+
+// Bytes read, 0 if it runs past len
+static size_t get_varint(const uint8_t* in, size_t len, uint32_t* v) {
+    *v = 0;
+    for (size_t n = 0; n < len && n < 5; n++) {
+        *v |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+        if (!(in[n] & 0x80)) return n + 1;
+    }
+    return 0;
+}
+
+// Length of s cut to max bytes, not inside a UTF-8 sequence
+static size_t utf8_cut(const char* s, size_t max) {
+    size_t n = strnlen(s, max + 1);
+    if (n <= max) return n;
+    n = max;
+    while (n > 0 && ((uint8_t)s[n] & 0xC0) == 0x80) n--;
+    return n;
+}
+
+// u8 length + bytes
+static size_t put_string(uint8_t* out, const char* s, size_t max) {
+    size_t n = utf8_cut(s, max);
+    out[0] = n;
+    memcpy(out + 1, s, n);
+    return 1 + n;
+}
+
+static size_t get_string(const uint8_t* in, size_t len, char* out, size_t cap) {
+    if (len < 1 || len < 1 + (size_t)in[0]) return 0;
+    size_t n = min((size_t)in[0], cap - 1);
+    memcpy(out, in + 1, n);
+    out[n] = '\0';
+    return 1 + in[0];
+}
+
+// ------------------------------------------------------------------
+// Records
+// ------------------------------------------------------------------
+
+size_t station_pack(const char* id, const char* title, uint8_t* out) {
+    uint8_t packed_id[ID_BYTES];
+    bool raw = !pack_id(id, packed_id);
+    size_t title_len = utf8_cut(title, TITLE_MAX);
+
+    size_t n = put_varint(out, (uint32_t)title_len << 1 | (raw ? 1 : 0));
+    if (raw) {
+        size_t id_len = strnlen(id, ID_RAW_MAX);
+        out[n++] = id_len;
+        memcpy(out + n, id, id_len);
+        n += id_len;
+    } else {
+        memcpy(out + n, packed_id, ID_BYTES);
+        n += ID_BYTES;
+    }
+    memcpy(out + n, title, title_len);
+    return n + title_len;
+}
+
+size_t station_record_size(const uint8_t* in, size_t len) {
+    uint32_t head;
+    size_t n = get_varint(in, len, &head);
+    if (n == 0 || (head >> 1) > TITLE_MAX) return 0;
+    if (head & 1) {
+        if (n >= len || in[n] > ID_RAW_MAX) return 0;
+        n += 1 + in[n];
+    } else {
+        n += ID_BYTES;
+    }
+    n += head >> 1;
+    return n <= len ? n : 0;
+}
+
+size_t station_unpack(const uint8_t* in, size_t len, StationRecord* out) {
+    size_t size = station_record_size(in, len);
+    if (size == 0) return 0;
+    uint32_t head;
+    size_t n = get_varint(in, len, &head);
+    if (head & 1) {
+        size_t id_len = in[n];
+        memcpy(out->id, in + n + 1, id_len);
+        out->id[id_len] = '\0';
+        n += 1 + id_len;
+    } else {
+        unpack_id(in + n, out->id);
+        n += ID_BYTES;
+    }
+    size_t title_len = head >> 1;
+    memcpy(out->title, in + n, title_len);
+    out->title[title_len] = '\0';
+    return size;
+}
+
+// Handle of the places.bin place meta was played from, or PLACE_NONE
+static PlaceHandle meta_place(const StationMeta& meta) {
+    PlaceHandle h;
+    Place p;
+    if (!places_db_loaded() || !meta.place[0] ||
+        places_db_find_k_nearest(meta.lat, meta.lon, 1, &h) != 1 || !places_db_get(h, &p)) {
+        return PLACE_NONE;
+    }
+    bool same = strcmp(p.name, meta.place) == 0 && strcmp(p.country, meta.country) == 0 &&
+                p.lat_x100 == (int16_t)lroundf(meta.lat * 100) &&
+                p.lon_x100 == (int16_t)lroundf(meta.lon * 100);
+    return same ? h : PLACE_NONE;
+}
+
+size_t station_pack_meta(const StationMeta& meta, uint8_t* out) {
+    size_t n = station_pack(meta.station_id, meta.title, out);
+    PlaceHandle place = meta_place(meta);
+    if (place != PLACE_NONE) return n + put_varint(out + n, (uint32_t)place + 1);
+
+    out[n++] = 0;
+    n += put_string(out + n, meta.place, PLACE_MAX);
+    n += put_string(out + n, meta.country, COUNTRY_MAX);
+    int16_t pos[2] = {(int16_t)lroundf(meta.lat * 100), (int16_t)lroundf(meta.lon * 100)};
+    memcpy(out + n, pos, sizeof(pos));
+    return n + sizeof(pos);
+}
+
+size_t station_unpack_meta(const uint8_t* in, size_t len, StationMeta* out,
+                           bool resolve_places) {
+    StationRecord rec;
+    size_t n = station_unpack(in, len, &rec);
+    if (n == 0) return 0;
+    memset(out, 0, sizeof(*out));
+    memcpy(out->station_id, rec.id, sizeof(out->station_id));
+    memcpy(out->title, rec.title, sizeof(out->title));
+
+    uint32_t place;
+    size_t m = get_varint(in + n, len - n, &place);
+    if (m == 0) return 0;
+    n += m;
+    if (place > 0) {
+        Place p;
+        if (resolve_places && places_db_get(place - 1, &p)) {
+            strncpy(out->place, p.name, sizeof(out->place) - 1);
+            strncpy(out->country, p.country, sizeof(out->country) - 1);
+            out->lat = p.lat_x100 / 100.0f;
+            out->lon = p.lon_x100 / 100.0f;
+        }
+        return n;
+    }
+
+    m = get_string(in + n, len - n, out->place, sizeof(out->place));
+    if (m == 0) return 0;
+    n += m;
+    m = get_string(in + n, len - n, out->country, sizeof(out->country));
+    if (m == 0 || n + m + 4 > len) return 0;
+    n += m;
+    int16_t pos[2];
+    memcpy(pos, in + n, sizeof(pos));
+    out->lat = pos[0] / 100.0f;
+    out->lon = pos[1] / 100.0f;
+    return n + sizeof(pos);
+}
+
+// ------------------------------------------------------------------
+// Lists
+// ------------------------------------------------------------------
+
+static void* grow(void* p, size_t bytes) {
+    return psramFound() ? ps_realloc(p, bytes) : realloc(p, bytes);
+}
+
+// Room for one more record of len bytes
+static bool reserve(PackedList& list, size_t len) {
+    if (list.count >= list.slots) {
+        uint32_t* at = (uint32_t*)grow(list.at, (list.slots + SLOT_CHUNK) * sizeof(uint32_t));
+        if (!at) return false;
+        list.at = at;
+        list.slots += SLOT_CHUNK;
+    }
+    if (list.used + len > list.cap) {
+        uint32_t cap = list.cap + max(DATA_CHUNK, (uint32_t)len);
+        uint8_t* data = (uint8_t*)grow(list.data, cap);
+        if (!data) return false;
+        list.data = data;
+        list.cap = cap;
+    }
+    return true;
+}
+
+bool packed_list_add_record(PackedList& list, const uint8_t* rec, size_t len) {
+    if (!reserve(list, len)) return false;
+    memcpy(list.data + list.used, rec, len);
+    list.at[list.count++] = list.used;
+    list.used += len;
+    return true;
+}
+
+bool packed_list_add(PackedList& list, const char* id, const char* title) {
+    uint8_t rec[STATION_PACK_MAX];
+    return packed_list_add_record(list, rec, station_pack(id, title, rec));
+}
+
+StationRecord packed_list_get(const PackedList& list, int i) {
+    StationRecord rec;
+    uint32_t off = list.at[i];
+    if (!station_unpack(list.data + off, list.used - off, &rec)) {
+        rec.id[0] = '\0';
+        rec.title[0] = '\0';
+    }
+    return rec;
+}
+
+void packed_list_move(PackedList& list, int from, int to) {
+    if (from == to) return;
+    uint32_t off = list.at[from];
+    if (from < to) {
+        memmove(&list.at[from], &list.at[from + 1], (to - from) * sizeof(uint32_t));
+    } else {
+        memmove(&list.at[to + 1], &list.at[to], (from - to) * sizeof(uint32_t));
+    }
+    list.at[to] = off;
+}
+
+void packed_list_swap(PackedList& list, int a, int b) {
+    uint32_t off = list.at[a];
+    list.at[a] = list.at[b];
+    list.at[b] = off;
+}
+
+void packed_list_clear(PackedList& list) {
+    free(list.data);
+    free(list.at);
+    list = {};
+}
+
+size_t packed_list_bytes(const PackedList& list) {
+    return list.cap + list.slots * sizeof(uint32_t);
+}
@@ -0,0 +1,88 @@
+/**
+ * Packed station records for RadioWall.
+ *
+ * A station held in a list cache, the offline catalogue or the history is
+ * stored as a variable-length record instead of fixed char arrays:
+ *
+ *   varint  title length << 1 | raw ID flag
+ *   ID      6 bytes: the 8 base64url characters Radio.garden IDs are
+ *           made of, 6 bits each (as in places.bin); with the raw flag,
+ *           a u8 length and the ID's bytes (at most 15)
+ *   title   UTF-8, at most 63 bytes
+ *
+ * A history record adds the place: a varint of its places.bin handle + 1,
+ * or 0 followed by the name (u8 length + bytes), the country code (the
+ * same) and lat, lon (int16 degrees x 100) for a place places.bin
+ * doesn't have. Its name, country and position are read back from
+ * places.bin. A typical station is 25-30 bytes instead of 80 (list
+ * record) or 136 (full metadata).
+ *
+ * PackedList keeps a list's records back to back in one growing buffer,
+ * with an offset per station so a list can be reordered without moving
+ * records. Buffers go to PSRAM when there is some.
+ */
+
+#ifndef STATION_PACK_H
+#define STATION_PACK_H
+
+#include <Arduino.h>
+#include "station_table.h"
+
+// One station of a place's list
+struct StationRecord {
+    char id[16];
+    char title[64];
+};
+
+// Longest records: head, raw ID, title; then the place spelt out
+#define STATION_PACK_MAX (1 + 1 + 15 + 63)
+#define STATION_PACK_META_MAX (STATION_PACK_MAX + 1 + (1 + 31) + (1 + 3) + 4)
+
+// Pack a station into out (STATION_PACK_MAX bytes); returns the bytes
+// written. Over-long IDs and titles are cut.
+size_t station_pack(const char* id, const char* title, uint8_t* out);
+
+// Unpack the record at in (len bytes available); returns its size, 0 if
+// it is malformed or runs past len
+size_t station_unpack(const uint8_t* in, size_t len, StationRecord* out);
+
+// Size of the record at in without unpacking it, 0 as above
+size_t station_record_size(const uint8_t* in, size_t len);
+
+// Pack full metadata into out (STATION_PACK_META_MAX bytes), the place by
+// handle when places.bin has a place of that name at that position
+size_t station_pack_meta(const StationMeta& meta, uint8_t* out);
+
+// Unpack a history record. Without resolve_places (records written for
+// another places.bin) a place given by handle comes back empty.
+size_t station_unpack_meta(const uint8_t* in, size_t len, StationMeta* out,
+                           bool resolve_places = true);
+
+struct PackedList {
+    uint8_t* data;     // Records back to back
+    uint32_t* at;      // Offset of station i's record in data
+    uint32_t used;     // Bytes of data in use
+    uint32_t cap;      // Bytes allocated
+    int count;
+    int slots;         // Offsets allocated
+};
+
+// Append a station, or a record already packed. False without memory
+// (the list is left as it was).
+bool packed_list_add(PackedList& list, const char* id, const char* title);
+bool packed_list_add_record(PackedList& list, const uint8_t* rec, size_t len);
+
+// Station i, unpacked
+StationRecord packed_list_get(const PackedList& list, int i);
+
+// Move station from to index to, shifting the ones in between; swap two
+void packed_list_move(PackedList& list, int from, int to);
+void packed_list_swap(PackedList& list, int a, int b);
+
+// Empty the list and give back its buffers
+void packed_list_clear(PackedList& list);
+
+// Bytes the list holds (records and offsets)
+size_t packed_list_bytes(const PackedList& list);
+
+#endif // STATION_PACK_H
@@ -0,0 +1,219 @@
+/**
+ * Per-station play outcomes implementation for RadioWall.
+ *
+ * The table is kept most recently used first, like the stream cache. The
+ * network worker changes it and the loop task copies it out to save, so
+ * both go through _mux. Listening time is added at most once a minute and
+ * only forces a save once ten minutes of it are waiting; starts and
+ * failures are saved on the next persist pass.
+ */
+
+#include "station_stats.h"
+#include "state_store.h"
+#include "persist.h"
+#include "loop_events.h"
+#include "serial_cmd.h"
+#include <freertos/FreeRTOS.h>
+
+static const int ID_LEN = 8;                        // Radio.garden IDs, no NUL
+static const unsigned long LISTEN_STEP_MS = 60000;  // Listening added per minute
+static const uint32_t LISTEN_SAVE_S = 600;          // Unsaved listening that forces a save
+
+struct StatEntry {
+    char id[ID_LEN];
+    uint16_t plays;        // Starts the WiiM confirmed
+    uint16_t fails;
+    uint16_t start_ms;     // Smoothed time to audio, 0 if never timed
+    uint16_t reserved;
+    uint32_t listen_s;
+};
+
+struct StatsRecord {
+    uint16_t count;
+    uint16_t reserved;
+    StatEntry entries[STATION_STATS_MAX];
+};
+
+static StatsRecord _stats;
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool _dirty = false;
+static uint32_t _unsaved_listen_s = 0;
+
+// Station being listened to (network worker only)
+static char _listen_id[ID_LEN + 1] = "";
+static unsigned long _listen_since = 0;
+
+static bool valid_id(const char* id) {
+    return id && id[0] && strlen(id) <= (size_t)ID_LEN;
+}
+
+static int find_entry(const char* id) {
+    for (int i = 0; i < _stats.count; i++) {
+        if (strncmp(_stats.entries[i].id, id, ID_LEN) == 0) return i;
+    }
+    return -1;
+}
+
+// Entry for id moved (or added) to the front, the oldest dropped when
+// full. Under _mux.
+static StatEntry& touch_entry(const char* id) {
+    int idx = find_entry(id);
+    StatEntry e;
+    if (idx >= 0) {
+        e = _stats.entries[idx];
+    } else {
+        memset(&e, 0, sizeof(e));
+        strncpy(e.id, id, ID_LEN);
+        idx = _stats.count < STATION_STATS_MAX ? _stats.count++ : STATION_STATS_MAX - 1;
+    }
+    memmove(&_stats.entries[1], &_stats.entries[0], idx * sizeof(StatEntry));
+    _stats.entries[0] = e;
+    return _stats.entries[0];
+}
+
+// Halve a well-tried station's figures so recent outcomes count more
+static void decay(StatEntry& e) {
+    if (e.plays + e.fails < STATION_STATS_DECAY) return;
+    e.plays /= 2;
+    e.fails /= 2;
+    e.listen_s /= 2;
+}
+
+static int score_of(const StatEntry& e) {
+    // Start rate with one start and one failure assumed: -50..50, 0 untried
+    int score = 100 * (e.plays + 1) / (e.plays + e.fails + 2) - 50;
+    if (e.start_ms) score -= e.start_ms / 250;         // 2 s to audio: -8
+    score += (int)min(e.listen_s / 120, (uint32_t)10); // 20 min listened: +10
+    return score;
+}
+
+static void mark_dirty() {
+    _dirty = true;
+    loop_events_notify();
+}
+
+// ------------------------------------------------------------------
+// Persistence
+// ------------------------------------------------------------------
+
+static bool save_stats() {
+    StatsRecord* rec = (StatsRecord*)malloc(sizeof(StatsRecord));
+    if (!rec) return false;
+    portENTER_CRITICAL(&_mux);
+    *rec = _stats;
+    portEXIT_CRITICAL(&_mux);
+    bool ok = state_store_put(STATE_KEY_STATION_STATS, rec, sizeof(*rec));
+    free(rec);
+    return ok;
+}
+
+void station_stats_init() {
+    if (state_store_get(STATE_KEY_STATION_STATS, &_stats, sizeof(_stats)) != (int)sizeof(_stats)) {
+        memset(&_stats, 0, sizeof(_stats));
+        return;
+    }
+    _stats.count = min<int>(_stats.count, STATION_STATS_MAX);
+    Serial.printf("[Stats] %d station(s) with play history\n", _stats.count);
+}
+
+void station_stats_task() {
+    if (!_dirty) return;
+    _dirty = false;
+    persist_mark_dirty(save_stats);
+}
+
+// ------------------------------------------------------------------
+// Outcomes
+// ------------------------------------------------------------------
+
+void station_stats_started(const char* station_id, uint32_t start_ms) {
+    if (!valid_id(station_id)) return;
+    uint16_t ms = (uint16_t)min(start_ms, (uint32_t)UINT16_MAX);
+    portENTER_CRITICAL(&_mux);
+    StatEntry& e = touch_entry(station_id);
+    if (e.plays < UINT16_MAX) e.plays++;
+    if (ms) e.start_ms = e.start_ms ? (uint16_t)((3UL * e.start_ms + ms) / 4) : ms;
+    decay(e);
+    portEXIT_CRITICAL(&_mux);
+    mark_dirty();
+}
+
+void station_stats_failed(const char* station_id) {
+    if (!valid_id(station_id)) return;
+    portENTER_CRITICAL(&_mux);
+    StatEntry& e = touch_entry(station_id);
+    if (e.fails < UINT16_MAX) e.fails++;
+    decay(e);
+    portEXIT_CRITICAL(&_mux);
+    mark_dirty();
+}
+
+// Credit the current listen up to now and restart its clock
+static void add_listen(unsigned long now) {
+    uint32_t secs = (now - _listen_since) / 1000;
+    _listen_since = now;
+    if (secs == 0) return;
+    portENTER_CRITICAL(&_mux);
+    StatEntry& e = touch_entry(_listen_id);
+    e.listen_s += secs;
+    portEXIT_CRITICAL(&_mux);
+    _unsaved_listen_s += secs;
+    if (_unsaved_listen_s >= LISTEN_SAVE_S) {
+        _unsaved_listen_s = 0;
+        mark_dirty();
+    }
+}
+
+void station_stats_playing(const char* station_id) {
+    unsigned long now = millis();
+    bool same = _listen_id[0] && valid_id(station_id) &&
+                strncmp(_listen_id, station_id, ID_LEN) == 0;
+    if (same) {
+        if (now - _listen_since >= LISTEN_STEP_MS) add_listen(now);
+        return;
+    }
+    if (_listen_id[0]) {
+        add_listen(now);
+        _listen_id[0] = '\0';
+    }
+    if (valid_id(station_id)) {
+        strcpy(_listen_id, station_id);
+        _listen_since = now;
+    }
+}
+
+bool station_stats_score(const char* station_id, int* score) {
+    if (!valid_id(station_id)) return false;
+    portENTER_CRITICAL(&_mux);
+    int idx = find_entry(station_id);
+    if (idx >= 0) *score = score_of(_stats.entries[idx]);
+    portEXIT_CRITICAL(&_mux);
+    return idx >= 0;
+}
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+// RANK - Stations with play history, most recent first
+static void cmd_rank(const char*) {
+    static const int SHOWN = 24;
+    StatEntry shown[SHOWN];
+    portENTER_CRITICAL(&_mux);
+    int total = _stats.count;
+    int n = min(total, SHOWN);
+    memcpy(shown, _stats.entries, n * sizeof(StatEntry));
+    portEXIT_CRITICAL(&_mux);
+
+    Serial.printf("[Stats] %d station(s), newest first\n", total);
+    for (int i = 0; i < n; i++) {
+        const StatEntry& e = shown[i];
+        Serial.printf("  %.8s  %3u start(s) %3u fail(s)  %5u ms  %5lu min  score %+d\n",
+                      e.id, e.plays, e.fails, e.start_ms,
+                      (unsigned long)(e.listen_s / 60), score_of(e));
+    }
+}
+
+void station_stats_serial_init() {
+    serial_cmd_register("RANK", cmd_rank);
+}
@@ -0,0 +1,52 @@
+/**
+ * Per-station play outcomes for RadioWall.
+ *
+ * The channels list of a place comes in Radio.garden's order, which says
+ * nothing about which streams actually work, so NEXT kept landing on dead
+ * or slow ones. Every play now leaves a trace here: starts the WiiM
+ * confirmed (with how long the audio took), failures (no stream URL, a
+ * dead probe, the WiiM refusing it or never starting), and time spent
+ * listening. The radio client ranks each place's station list by these
+ * figures when it loads it, so the cursor and the prefetcher reach the
+ * stations that started fast and stayed up first.
+ *
+ * The most recently seen STATION_STATS_MAX stations are kept, as one
+ * record in the state store. Counts are halved once a station has been
+ * tried STATION_STATS_DECAY times, so old outcomes fade.
+ *
+ * Updated by the network worker; saved from the loop task (station_stats_task).
+ */
+
+#ifndef STATION_STATS_H
+#define STATION_STATS_H
+
+#include <Arduino.h>
+
+#define STATION_STATS_MAX 128
+#define STATION_STATS_DECAY 64
+
+// Load the saved figures (after state_store_init)
+void station_stats_init();
+
+// The WiiM confirmed the station's audio start_ms after the play call
+// (0: started, but the time is unknown)
+void station_stats_started(const char* station_id, uint32_t start_ms);
+
+// The station could not be played
+void station_stats_failed(const char* station_id);
+
+// The station audible now, nullptr if none (call per player status). Time
+// between calls for the same station counts as listening.
+void station_stats_playing(const char* station_id);
+
+// Rank of a station: above 0 it beat an unknown station, below 0 it did
+// worse. False if there are no figures for it.
+bool station_stats_score(const char* station_id, int* score);
+
+// Mark the figures for saving when they changed (call from loop)
+void station_stats_task();
+
+// Register the RANK serial command
+void station_stats_serial_init();
+
+#endif // STATION_STATS_H
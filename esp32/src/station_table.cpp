@@ -0,0 +1,139 @@
+/**
+ * Interned station metadata implementation for RadioWall.
+ *
+ * Slots are chained per hash bucket (FNV-1a of the station ID). A slot
+ * leaving the table is unlinked from its chain, so lookups never walk
+ * dead entries.
+ */
+
+#include "station_table.h"
+#include "fnv1a.h"
+
+static const int TABLE_BUCKETS = 256;
+static const uint16_t NO_SLOT = 0xFFFF;
+
+struct StationSlot {
+    StationMeta meta;
+    uint32_t hash;
+    uint32_t last_used;
+    uint16_t next;         // Next slot in the same bucket
+    uint16_t pins;
+    uint8_t flags;
+    bool used;
+};
+
+static StationSlot* _slots = nullptr;
+static uint16_t _buckets[TABLE_BUCKETS];
+static uint32_t _tick = 0;
+
+static uint32_t station_hash(const char* id) {
+    return fnv1a_str(id);
+}
+
+static void unlink_slot(uint16_t slot) {
+    uint16_t* link = &_buckets[_slots[slot].hash % TABLE_BUCKETS];
+    while (*link != NO_SLOT) {
+        if (*link == slot) {
+            *link = _slots[slot].next;
+            return;
+        }
+        link = &_slots[*link].next;
+    }
+}
+
+static bool valid(StationHandle h) {
+    return _slots && h < STATION_TABLE_MAX && _slots[h].used;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void station_table_init() {
+    if (_slots) return;
+    size_t bytes = STATION_TABLE_MAX * sizeof(StationSlot);
+    _slots = (StationSlot*)(psramFound() ? ps_calloc(1, bytes) : calloc(1, bytes));
+    if (!_slots) {
+        Serial.println("[Stations] No memory for the station table");
+        return;
+    }
+    for (int i = 0; i < TABLE_BUCKETS; i++) _buckets[i] = NO_SLOT;
+    Serial.printf("[Stations] Table: %d stations (%u KB)\n", STATION_TABLE_MAX,
+                  (unsigned)(bytes / 1024));
+}
+
+StationHandle station_table_find(const char* station_id) {
+    if (!_slots || !station_id || !station_id[0]) return STATION_NONE;
+    uint32_t hash = station_hash(station_id);
+    for (uint16_t s = _buckets[hash % TABLE_BUCKETS]; s != NO_SLOT; s = _slots[s].next) {
+        if (_slots[s].hash == hash && strcmp(_slots[s].meta.station_id, station_id) == 0) {
+            return s;
+        }
+    }
+    return STATION_NONE;
+}
+
+StationHandle station_table_acquire(const StationMeta& meta) {
+    if (!_slots || !meta.station_id[0]) return STATION_NONE;
+
+    StationHandle h = station_table_find(meta.station_id);
+    if (h == STATION_NONE) {
+        // A free slot, else the least recently used unpinned one
+        for (int i = 0; i < STATION_TABLE_MAX; i++) {
+            StationSlot& s = _slots[i];
+            if (!s.used) {
+                h = i;
+                break;
+            }
+            if (s.pins == 0 && (h == STATION_NONE || s.last_used < _slots[h].last_used)) h = i;
+        }
+        if (h == STATION_NONE) {
+            Serial.println("[Stations] Table full of pinned stations");
+            return STATION_NONE;
+        }
+
+        StationSlot& s = _slots[h];
+        if (s.used) unlink_slot(h);
+        s.hash = station_hash(meta.station_id);
+        s.pins = 0;
+        s.flags = 0;
+        s.used = true;
+        uint16_t& head = _buckets[s.hash % TABLE_BUCKETS];
+        s.next = head;
+        head = h;
+    }
+
+    StationSlot& s = _slots[h];
+    s.meta = meta;
+    s.meta.station_id[sizeof(s.meta.station_id) - 1] = '\0';
+    s.meta.title[sizeof(s.meta.title) - 1] = '\0';
+    s.meta.place[sizeof(s.meta.place) - 1] = '\0';
+    s.meta.country[sizeof(s.meta.country) - 1] = '\0';
+    s.pins++;
+    s.last_used = ++_tick;
+    return h;
+}
+
+void station_table_retain(StationHandle h) {
+    if (valid(h)) _slots[h].pins++;
+}
+
+void station_table_release(StationHandle h) {
+    if (valid(h) && _slots[h].pins > 0) _slots[h].pins--;
+}
+
+const StationMeta* station_table_get(StationHandle h) {
+    if (!valid(h)) return nullptr;
+    _slots[h].last_used = ++_tick;
+    return &_slots[h].meta;
+}
+
+void station_table_set_flag(StationHandle h, uint8_t flag, bool on) {
+    if (!valid(h)) return;
+    if (on) _slots[h].flags |= flag;
+    else _slots[h].flags &= ~flag;
+}
+
+bool station_table_has_flag(StationHandle h, uint8_t flag) {
+    return valid(h) && (_slots[h].flags & flag);
+}
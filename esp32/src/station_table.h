@@ -0,0 +1,62 @@
+/**
+ * Interned station metadata for RadioWall.
+ *
+ * Favorites and history used to keep their own copies of each station's
+ * ID, title, place, country and position. Now one table in PSRAM holds
+ * every station in use, keyed by a hash of its Radio.garden ID, and
+ * modules hold a StationHandle into it instead of a copy. Looking a
+ * station up by ID is one hash probe. Per-station flags (e.g. "is a
+ * favorite") answer questions that used to scan a list.
+ *
+ * Holders pin the stations they keep (station_table_acquire), and pinned
+ * stations stay put. Unpinned ones linger as a cache until the table
+ * needs their slot, least recently used first.
+ *
+ * Loop task only.
+ */
+
+#ifndef STATION_TABLE_H
+#define STATION_TABLE_H
+
+#include <Arduino.h>
+
+#define STATION_TABLE_MAX 128
+
+typedef uint16_t StationHandle;
+static const StationHandle STATION_NONE = 0xFFFF;
+
+// The metadata every feature shows and plays a station from. Also the
+// record layout favorites and history store on flash.
+struct StationMeta {
+    char station_id[16];
+    char title[64];
+    char place[32];
+    char country[4];
+    float lat;
+    float lon;
+};
+
+enum StationFlag : uint8_t {
+    STATION_FLAG_FAVORITE = 0x01,
+};
+
+void station_table_init();
+
+// Handle of a station already in the table, or STATION_NONE
+StationHandle station_table_find(const char* station_id);
+
+// Intern a station (its metadata replaces what the table had) and pin it.
+// STATION_NONE if every slot is pinned.
+StationHandle station_table_acquire(const StationMeta& meta);
+
+// Pin or unpin a station already held by handle
+void station_table_retain(StationHandle h);
+void station_table_release(StationHandle h);
+
+// Metadata of a station, or nullptr for a stale handle. Valid while pinned.
+const StationMeta* station_table_get(StationHandle h);
+
+void station_table_set_flag(StationHandle h, uint8_t flag, bool on);
+bool station_table_has_flag(StationHandle h, uint8_t flag);
+
+#endif // STATION_TABLE_H
@@ -0,0 +1,213 @@
+/**
+ * Resolved stream URL cache implementation for RadioWall.
+ *
+ * Entries expire STREAM_TTL_S after they were resolved (wall clock from
+ * SNTP). Before the clock is set, loaded entries are trusted; a URL that
+ * then fails to play is invalidated by the caller.
+ *
+ * The network worker owns the table; the peer cache server reads it from
+ * its own task (stream_cache_copy()), so changes to the entries happen
+ * under _mux.
+ */
+
+#include "stream_cache.h"
+#include "metrics.h"
+#include "json_arena.h"
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <time.h>
+#include <freertos/FreeRTOS.h>
+
+static const char* STREAM_CACHE_FILE = "/stream_urls.json";
+static const uint32_t STREAM_TTL_S = 24UL * 60 * 60;      // 24 hours
+static const time_t CLOCK_VALID_AFTER = 1700000000;       // Nov 2023
+
+struct StreamEntry {
+    char station_id[16];
+    char url[STREAM_URL_MAX];
+    uint32_t resolved_at;   // Unix time, 0 if the clock wasn't set yet
+};
+
+// In-memory storage (newest at index 0)
+static StreamEntry _entries[STREAM_CACHE_MAX];
+static int _count = 0;
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t wall_now() {
+    time_t now = time(nullptr);
+    return now > CLOCK_VALID_AFTER ? (uint32_t)now : 0;
+}
+
+static int find_entry(const char* station_id) {
+    for (int i = 0; i < _count; i++) {
+        if (strcmp(_entries[i].station_id, station_id) == 0) return i;
+    }
+    return -1;
+}
+
+static void remove_entry(int idx) {
+    portENTER_CRITICAL(&_mux);
+    for (int i = idx; i < _count - 1; i++) {
+        _entries[i] = _entries[i + 1];
+    }
+    _count--;
+    portEXIT_CRITICAL(&_mux);
+}
+
+static bool expired(const StreamEntry& e, uint32_t now) {
+    return now && e.resolved_at && now - e.resolved_at > STREAM_TTL_S;
+}
+
+// ------------------------------------------------------------------
+// LittleFS persistence
+// ------------------------------------------------------------------
+
+static bool save_to_file() {
+    File f = LittleFS.open(STREAM_CACHE_FILE, "w");
+    if (!f) {
+        Serial.println("[StreamCache] Failed to open file for writing");
+        return false;
+    }
+
+    JsonArenaDoc doc(JSON_ARENA_FILE);
+    JsonArray arr = doc.to<JsonArray>();
+
+    for (int i = 0; i < _count; i++) {
+        JsonObject obj = arr.createNestedObject();
+        obj["i"] = _entries[i].station_id;
+        obj["u"] = _entries[i].url;
+        obj["r"] = _entries[i].resolved_at;
+    }
+
+    serializeJson(doc, f);
+    f.close();
+    return true;
+}
+
+static bool load_from_file() {
+    if (!LittleFS.exists(STREAM_CACHE_FILE)) {
+        return true;
+    }
+
+    File f = LittleFS.open(STREAM_CACHE_FILE, "r");
+    if (!f) {
+        Serial.println("[StreamCache] Failed to open cache file");
+        return false;
+    }
+
+    JsonArenaDoc doc(JSON_ARENA_FILE);
+    DeserializationError error = deserializeJson(doc, f);
+    f.close();
+
+    if (error) {
+        Serial.printf("[StreamCache] JSON parse error: %s\n", error.c_str());
+        return false;
+    }
+
+    _count = 0;
+    JsonArray arr = doc.as<JsonArray>();
+    for (JsonObject obj : arr) {
+        if (_count >= STREAM_CACHE_MAX) break;
+
+        StreamEntry& e = _entries[_count];
+        strncpy(e.station_id, obj["i"] | "", sizeof(e.station_id) - 1);
+        e.station_id[sizeof(e.station_id) - 1] = '\0';
+        strncpy(e.url, obj["u"] | "", sizeof(e.url) - 1);
+        e.url[sizeof(e.url) - 1] = '\0';
+        e.resolved_at = obj["r"] | 0;
+
+        if (e.station_id[0] && e.url[0]) _count++;
+    }
+
+    Serial.printf("[StreamCache] Loaded %d stream URLs\n", _count);
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void stream_cache_init() {
+    _count = 0;
+    load_from_file();
+}
+
+const char* stream_cache_get(const char* station_id) {
+    int idx = find_entry(station_id);
+    if (idx < 0) {
+        metrics_inc(METRIC_STREAM_CACHE_MISS);
+        return nullptr;
+    }
+
+    if (expired(_entries[idx], wall_now())) {
+        Serial.printf("[StreamCache] Expired: %s\n", station_id);
+        remove_entry(idx);
+        save_to_file();
+        metrics_inc(METRIC_STREAM_CACHE_MISS);
+        return nullptr;
+    }
+    metrics_inc(METRIC_STREAM_CACHE_HIT);
+    return _entries[idx].url;
+}
+
+void stream_cache_put(const char* station_id, const char* url) {
+    if (!station_id[0] || strlen(url) >= STREAM_URL_MAX) return;
+
+    int idx = find_entry(station_id);
+    if (idx >= 0) remove_entry(idx);
+
+    uint32_t now = wall_now();
+    portENTER_CRITICAL(&_mux);
+    if (_count >= STREAM_CACHE_MAX) {
+        _count = STREAM_CACHE_MAX - 1;  // Drop oldest
+    }
+    // Insert at front
+    for (int i = _count; i > 0; i--) {
+        _entries[i] = _entries[i - 1];
+    }
+    StreamEntry& e = _entries[0];
+    strncpy(e.station_id, station_id, sizeof(e.station_id) - 1);
+    e.station_id[sizeof(e.station_id) - 1] = '\0';
+    strncpy(e.url, url, sizeof(e.url) - 1);
+    e.url[sizeof(e.url) - 1] = '\0';
+    e.resolved_at = now;
+    _count++;
+    portEXIT_CRITICAL(&_mux);
+
+    save_to_file();
+}
+
+bool stream_cache_copy(const char* station_id, char* out, size_t cap) {
+    uint32_t now = wall_now();
+    bool found = false;
+    portENTER_CRITICAL(&_mux);
+    int idx = find_entry(station_id);
+    if (idx >= 0 && !expired(_entries[idx], now) && strlen(_entries[idx].url) < cap) {
+        strcpy(out, _entries[idx].url);
+        found = true;
+    }
+    portEXIT_CRITICAL(&_mux);
+    return found;
+}
+
+bool stream_cache_stale(const char* station_id, uint32_t age_s) {
+    uint32_t now = wall_now();
+    bool stale = true;
+    portENTER_CRITICAL(&_mux);
+    int idx = find_entry(station_id);
+    if (idx >= 0 && !expired(_entries[idx], now)) {
+        const StreamEntry& e = _entries[idx];
+        stale = now && e.resolved_at && now - e.resolved_at > age_s;
+    }
+    portEXIT_CRITICAL(&_mux);
+    return stale;
+}
+
+void stream_cache_invalidate(const char* station_id) {
+    int idx = find_entry(station_id);
+    if (idx < 0) return;
+
+    Serial.printf("[StreamCache] Invalidated: %s\n", station_id);
+    remove_entry(idx);
+    save_to_file();
+}
@@ -0,0 +1,37 @@
+/**
+ * Resolved stream URL cache for RadioWall.
+ *
+ * Maps Radio.garden station IDs to the URL their channel.mp3 redirect
+ * resolved to, so favorites, history and resume can play without the
+ * redirect round trip. Stored as JSON on LittleFS, loaded into RAM.
+ */
+
+#ifndef STREAM_CACHE_H
+#define STREAM_CACHE_H
+
+#include <Arduino.h>
+
+#define STREAM_CACHE_MAX 24
+#define STREAM_URL_MAX 256
+
+// Initialize (load from LittleFS)
+void stream_cache_init();
+
+// Cached URL for a station, or nullptr if unknown or expired
+const char* stream_cache_get(const char* station_id);
+
+// Remember a resolved URL (replaces the oldest entry when full, auto-saves)
+void stream_cache_put(const char* station_id, const char* url);
+
+// Copy a station's URL into out (any task; leaves the table and expiry to
+// the owner). False if unknown, expired or longer than cap.
+bool stream_cache_copy(const char* station_id, char* out, size_t cap);
+
+// True if a station's URL is unknown, expired or was resolved more than
+// age_s ago (an entry resolved before the clock was set counts as fresh)
+bool stream_cache_stale(const char* station_id, uint32_t age_s);
+
+// Drop a station's URL (e.g. after playback failed with it)
+void stream_cache_invalidate(const char* station_id);
+
+#endif // STREAM_CACHE_H
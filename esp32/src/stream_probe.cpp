@@ -0,0 +1,175 @@
+/**
+ * Stream liveness probe implementation for RadioWall.
+ *
+ * One lwIP socket per URL, all non-blocking, driven by a single select()
+ * loop on the calling task: connect, send a short HTTP/1.0 GET once the
+ * socket turns writable, then classify the first bytes of the answer.
+ * Host names go through dns_cache, so a repeat probe of the same stream
+ * host costs no lookup. Every socket is closed before returning; the
+ * WiiM opens its own connection to the winner.
+ */
+
+#include "stream_probe.h"
+#include "dns_cache.h"
+#include "trace.h"
+#include <WiFi.h>
+#include <lwip/sockets.h>
+
+static const size_t PROBE_HOST_MAX = 64;
+static const size_t PROBE_HEAD_MAX = 32;   // Enough for "HTTP/1.1 200" / "ICY 200"
+
+enum ProbeStage : uint8_t {
+    STAGE_CONNECTING,
+    STAGE_SENT,
+    STAGE_DONE,
+};
+
+struct ProbeConn {
+    int fd;
+    ProbeStage stage;
+    char host[PROBE_HOST_MAX];
+    const char* path;
+    uint16_t port;
+    unsigned long start_ms;
+};
+
+// "http://host[:port]/path" -> host, port, path. False for anything else
+// (HTTPS needs a TLS session per probe: not worth the heap).
+static bool parse_http_url(const char* url, ProbeConn& c) {
+    if (strncmp(url, "http://", 7) != 0) return false;
+    const char* host = url + 7;
+    const char* end = host + strcspn(host, ":/?");
+    size_t len = end - host;
+    if (len == 0 || len >= sizeof(c.host)) return false;
+    memcpy(c.host, host, len);
+    c.host[len] = '\0';
+
+    c.port = 80;
+    if (*end == ':') {
+        c.port = (uint16_t)atoi(end + 1);
+        end += 1 + strspn(end + 1, "0123456789");
+    }
+    c.path = *end == '/' ? end : "/";
+    return c.port != 0;
+}
+
+static bool start_connect(ProbeConn& c) {
+    IPAddress ip;
+    if (!dns_cache_resolve(c.host, &ip)) return false;
+
+    c.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (c.fd < 0) return false;
+    fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(c.port);
+    addr.sin_addr.s_addr = (uint32_t)ip;
+    c.start_ms = millis();
+    if (connect(c.fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        return false;
+    }
+    c.stage = STAGE_CONNECTING;
+    return true;
+}
+
+// Socket turned writable: connected (send the GET) or failed
+static bool send_get(ProbeConn& c) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) return false;
+
+    char req[384];
+    int n = snprintf(req, sizeof(req),
+                     "GET %s HTTP/1.0\r\n"
+                     "Host: %s\r\n"
+                     "User-Agent: RadioWall/1.0\r\n"
+                     "Icy-MetaData: 1\r\n\r\n",
+                     c.path, c.host);
+    if (n <= 0 || n >= (int)sizeof(req)) return false;
+    if (send(c.fd, req, n, 0) != n) return false;
+    c.stage = STAGE_SENT;
+    return true;
+}
+
+// First response bytes: ICY/HTTP 200 is live, 3xx the WiiM will have to
+// follow (unknown), anything else dead
+static StreamProbeResult classify(ProbeConn& c) {
+    char head[PROBE_HEAD_MAX + 1];
+    int n = recv(c.fd, head, PROBE_HEAD_MAX, 0);
+    if (n <= 0) return PROBE_DEAD;
+    head[n] = '\0';
+
+    int status = 0;
+    if (strncmp(head, "ICY ", 4) == 0) {
+        status = atoi(head + 4);
+    } else if (strncmp(head, "HTTP/1.", 7) == 0 && n > 9) {
+        status = atoi(head + 9);
+    }
+    if (status == 200) return PROBE_LIVE;
+    if (status >= 300 && status < 400) return PROBE_UNKNOWN;
+    return PROBE_DEAD;
+}
+
+int stream_probe_run(StreamProbe* probes, int count, unsigned long timeout_ms) {
+    count = min(count, STREAM_PROBE_MAX);
+    TraceScope span(TRACE_STREAM_PROBE);
+    ProbeConn conns[STREAM_PROBE_MAX];
+    int winner = -1;
+    int open = 0;
+
+    for (int i = 0; i < count; i++) {
+        ProbeConn& c = conns[i];
+        c.fd = -1;
+        c.stage = STAGE_DONE;
+        probes[i].result = PROBE_UNKNOWN;
+        probes[i].ttfb_ms = 0;
+        if (!probes[i].url || !parse_http_url(probes[i].url, c)) continue;
+        if (WiFi.status() != WL_CONNECTED) break;
+        if (start_connect(c)) {
+            open++;
+        } else {
+            probes[i].result = PROBE_DEAD;
+            c.stage = STAGE_DONE;
+        }
+    }
+
+    unsigned long start = millis();
+    while (open > 0 && winner < 0 && millis() - start < timeout_ms) {
+        fd_set rd, wr;
+        FD_ZERO(&rd);
+        FD_ZERO(&wr);
+        int max_fd = -1;
+        for (int i = 0; i < count; i++) {
+            ProbeConn& c = conns[i];
+            if (c.stage == STAGE_DONE) continue;
+            FD_SET(c.fd, c.stage == STAGE_CONNECTING ? &wr : &rd);
+            max_fd = max(max_fd, c.fd);
+        }
+        unsigned long left = timeout_ms - (millis() - start);
+        struct timeval tv = {(time_t)(left / 1000), (suseconds_t)(left % 1000) * 1000};
+        if (select(max_fd + 1, &rd, &wr, nullptr, &tv) <= 0) break;
+
+        for (int i = 0; i < count && winner < 0; i++) {
+            ProbeConn& c = conns[i];
+            StreamProbe& p = probes[i];
+            if (c.stage == STAGE_CONNECTING && FD_ISSET(c.fd, &wr)) {
+                if (send_get(c)) continue;
+                p.result = PROBE_DEAD;
+            } else if (c.stage == STAGE_SENT && FD_ISSET(c.fd, &rd)) {
+                p.ttfb_ms = (uint16_t)min(millis() - c.start_ms, 65535UL);
+                p.result = classify(c);
+                if (p.result == PROBE_LIVE) winner = i;
+            } else {
+                continue;
+            }
+            c.stage = STAGE_DONE;
+            open--;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (conns[i].fd >= 0) close(conns[i].fd);
+    }
+    return winner;
+}
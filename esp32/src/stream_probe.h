@@ -0,0 +1,35 @@
+/**
+ * Stream liveness probe for RadioWall.
+ *
+ * Before a stream URL goes to the WiiM, the stations about to play can be
+ * checked in parallel: each plain-HTTP URL gets a non-blocking connection
+ * and a GET, and the first one to answer with a playable status line (ICY
+ * or HTTP 200) wins. Being first to answer also makes it the one with the
+ * lowest time to first byte. A dead station costs a refused connection or
+ * an error status here instead of several seconds of the WiiM failing.
+ */
+
+#ifndef STREAM_PROBE_H
+#define STREAM_PROBE_H
+
+#include <Arduino.h>
+
+static const int STREAM_PROBE_MAX = 4;   // URLs per stream_probe_run()
+
+enum StreamProbeResult : uint8_t {
+    PROBE_UNKNOWN,   // Not probed (HTTPS, redirect, no answer in time)
+    PROBE_LIVE,      // Answered 200 first
+    PROBE_DEAD,      // Refused, unresolvable, error status or closed
+};
+
+struct StreamProbe {
+    const char* url;          // Set by the caller
+    StreamProbeResult result;
+    uint16_t ttfb_ms;         // LIVE: connect start -> first response bytes
+};
+
+// Probe count URLs at once until one answers live or timeout_ms passes.
+// Returns the index of the live one, or -1. Network worker only.
+int stream_probe_run(StreamProbe* probes, int count, unsigned long timeout_ms);
+
+#endif // STREAM_PROBE_H
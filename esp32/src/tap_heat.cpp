@@ -0,0 +1,176 @@
+/**
+ * Tap heatmap implementation for RadioWall.
+ *
+ * The table is unordered; lookups scan it (128 entries) under _mux, since
+ * the network worker reads it while the loop task records. The record
+ * keeps the grid's cell shift: a places.bin with another cell size gives
+ * other cell IDs, and the saved counts are dropped.
+ */
+
+#include "tap_heat.h"
+#include "places_db.h"
+#include "state_store.h"
+#include "persist.h"
+#include "serial_cmd.h"
+#include <freertos/FreeRTOS.h>
+
+struct HeatCell {
+    uint16_t cell;        // places_db_cell()
+    uint16_t taps;
+    int16_t lat_x100;     // Latest tap in the cell
+    int16_t lon_x100;
+};
+
+struct HeatRecord {
+    uint8_t cell_shift;
+    uint8_t reserved;
+    uint16_t count;
+    HeatCell cells[TAP_HEAT_CELLS];
+};
+
+static HeatRecord _heat;
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static bool _dirty = false;
+
+static int find_cell(uint16_t cell) {
+    for (int i = 0; i < _heat.count; i++) {
+        if (_heat.cells[i].cell == cell) return i;
+    }
+    return -1;
+}
+
+// Halve every count, dropping the cells that reach 0. Under _mux.
+static void decay() {
+    int kept = 0;
+    for (int i = 0; i < _heat.count; i++) {
+        HeatCell c = _heat.cells[i];
+        c.taps /= 2;
+        if (c.taps > 0) _heat.cells[kept++] = c;
+    }
+    _heat.count = kept;
+}
+
+// ------------------------------------------------------------------
+// Persistence
+// ------------------------------------------------------------------
+
+static bool save_heat() {
+    HeatRecord* rec = (HeatRecord*)malloc(sizeof(HeatRecord));
+    if (!rec) return false;
+    portENTER_CRITICAL(&_mux);
+    *rec = _heat;
+    portEXIT_CRITICAL(&_mux);
+    bool ok = state_store_put(STATE_KEY_TAP_HEAT, rec, sizeof(*rec));
+    free(rec);
+    return ok;
+}
+
+void tap_heat_init() {
+    memset(&_heat, 0, sizeof(_heat));
+    int shift = places_db_cell_shift();
+    if (state_store_get(STATE_KEY_TAP_HEAT, &_heat, sizeof(_heat)) != (int)sizeof(_heat) ||
+        _heat.cell_shift != shift) {
+        memset(&_heat, 0, sizeof(_heat));
+        _heat.cell_shift = shift;
+        return;
+    }
+    _heat.count = min<int>(_heat.count, TAP_HEAT_CELLS);
+    Serial.printf("[Heat] %d tapped cell(s)\n", _heat.count);
+}
+
+void tap_heat_task() {
+    if (!_dirty) return;
+    _dirty = false;
+    persist_mark_dirty(save_heat);
+}
+
+// ------------------------------------------------------------------
+// Counts
+// ------------------------------------------------------------------
+
+void tap_heat_record(float lat, float lon) {
+    uint16_t cell = places_db_cell(lat, lon);
+    if (cell == PLACES_CELL_NONE) return;
+
+    portENTER_CRITICAL(&_mux);
+    int idx = find_cell(cell);
+    if (idx < 0) {
+        if (_heat.count < TAP_HEAT_CELLS) {
+            idx = _heat.count++;
+        } else {
+            idx = 0;
+            for (int i = 1; i < _heat.count; i++) {
+                if (_heat.cells[i].taps < _heat.cells[idx].taps) idx = i;
+            }
+        }
+        _heat.cells[idx].cell = cell;
+        _heat.cells[idx].taps = 0;
+    }
+    HeatCell& c = _heat.cells[idx];
+    c.taps++;
+    c.lat_x100 = (int16_t)(lat * 100);
+    c.lon_x100 = (int16_t)(lon * 100);
+    if (c.taps >= TAP_HEAT_DECAY) decay();
+    portEXIT_CRITICAL(&_mux);
+    _dirty = true;
+}
+
+uint16_t tap_heat_at(float lat, float lon) {
+    return tap_heat_cell(places_db_cell(lat, lon));
+}
+
+uint16_t tap_heat_cell(uint16_t cell) {
+    if (cell == PLACES_CELL_NONE) return 0;
+    portENTER_CRITICAL(&_mux);
+    int idx = find_cell(cell);
+    uint16_t taps = idx >= 0 ? _heat.cells[idx].taps : 0;
+    portEXIT_CRITICAL(&_mux);
+    return taps;
+}
+
+int tap_heat_hottest(int max, float* lat, float* lon, uint16_t* taps) {
+    if (max <= 0) return 0;
+    HeatCell* cells = (HeatCell*)malloc(sizeof(_heat.cells));
+    if (!cells) return 0;
+    portENTER_CRITICAL(&_mux);
+    int n = _heat.count;
+    memcpy(cells, _heat.cells, n * sizeof(HeatCell));
+    portEXIT_CRITICAL(&_mux);
+
+    // Selection of the max hottest
+    int out = min(n, max);
+    for (int i = 0; i < out; i++) {
+        int best = i;
+        for (int j = i + 1; j < n; j++) {
+            if (cells[j].taps > cells[best].taps) best = j;
+        }
+        HeatCell c = cells[best];
+        cells[best] = cells[i];
+        cells[i] = c;
+        lat[i] = c.lat_x100 / 100.0f;
+        lon[i] = c.lon_x100 / 100.0f;
+        if (taps) taps[i] = c.taps;
+    }
+    free(cells);
+    return out;
+}
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+// HEAT - The most tapped cells
+static void cmd_heat(const char*) {
+    static const int SHOWN = 16;
+    float lat[SHOWN], lon[SHOWN];
+    uint16_t taps[SHOWN];
+    int n = tap_heat_hottest(SHOWN, lat, lon, taps);
+    Serial.printf("[Heat] %d hottest cell(s)\n", n);
+    for (int i = 0; i < n; i++) {
+        Serial.printf("  %4u tap(s)  %7.2f, %7.2f\n", taps[i], lat[i], lon[i]);
+    }
+}
+
+void tap_heat_serial_init() {
+    serial_cmd_register("HEAT", cmd_heat);
+}
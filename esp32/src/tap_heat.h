@@ -0,0 +1,49 @@
+/**
+ * Tap heatmap for RadioWall.
+ *
+ * Counts the map taps that start a play, one counter per cell of the
+ * places index grid (places_db_cell), so the caches can tell the regions
+ * this wall is tapped in from the ones it never is. Only the
+ * TAP_HEAT_CELLS hottest cells are kept, each with the point of its latest
+ * tap; a cell new to a full table replaces the coldest one. Once a cell
+ * reaches TAP_HEAT_DECAY taps every count is halved, so old habits fade.
+ *
+ * The table is one state store record, saved by the write-behind pass.
+ * It is read by the radio client's station cache (which lists to keep and
+ * which speculative loads to admit), the boot warm list and the idle
+ * refresh.
+ *
+ * Recorded from the loop task; read from any task.
+ */
+
+#ifndef TAP_HEAT_H
+#define TAP_HEAT_H
+
+#include <Arduino.h>
+
+#define TAP_HEAT_CELLS 128
+#define TAP_HEAT_DECAY 1024
+
+// Load the saved table (after places_db_init and state_store_init)
+void tap_heat_init();
+
+// A tap on the map at lat/lon started a play
+void tap_heat_record(float lat, float lon);
+
+// Taps counted in the grid cell under lat/lon (0: none, or unknown cell)
+uint16_t tap_heat_at(float lat, float lon);
+
+// The same for a cell already known (places_db_cell)
+uint16_t tap_heat_cell(uint16_t cell);
+
+// The hottest cells, hottest first: up to max points (their latest tap)
+// into lat[]/lon[] and, if taps is set, their counts. Returns the count.
+int tap_heat_hottest(int max, float* lat, float* lon, uint16_t* taps = nullptr);
+
+// Mark the table for saving when it changed (call from loop)
+void tap_heat_task();
+
+// Register the HEAT serial command
+void tap_heat_serial_init();
+
+#endif // TAP_HEAT_H
@@ -0,0 +1,174 @@
+/**
+ * Pixel-width text layout implementation for RadioWall.
+ *
+ * Advances are read from the font through a private Arduino_Canvas that
+ * is never drawn to, so measuring does not touch the font state of the
+ * display or a sprite canvas mid-render. ASCII advances are kept in a
+ * table once read; other codepoints go through the font's direct index.
+ *
+ * Fits are cached by FNV-1a hash, length and width of the source string
+ * and hold only the cut point, so a hit is a copy of the prefix.
+ */
+
+#include "text_layout.h"
+#include "fnv1a.h"
+#include "theme.h"
+#include "Arduino_GFX_Library.h"
+
+static const int LAYOUT_SLOTS = 48;     // Status bar + two pages of cards
+static const char ELLIPSIS[] = "...";
+
+struct Layout {
+    uint32_t hash;
+    uint16_t len;
+    int16_t max_w;
+    uint16_t cut;          // Bytes kept; == len when the text fits
+    int16_t width;         // Drawn width, ellipsis included
+    uint32_t last_used;    // 0 = empty slot
+};
+
+static Layout _layouts[LAYOUT_SLOTS];
+static uint32_t _tick = 0;
+static Arduino_Canvas* _measure = nullptr;
+static int8_t _ascii[128];              // -1 = not read yet
+static int _ellipsis_w = -1;
+
+// ------------------------------------------------------------------
+// Measuring
+// ------------------------------------------------------------------
+
+static void ensure_font() {
+    if (_measure) return;
+    _measure = new Arduino_Canvas(1, 1, nullptr);
+    _measure->setFont(TH_FONT_UNICODE);
+    _measure->setFontIndex(TH_FONT_UNICODE_INDEX);
+    memset(_ascii, -1, sizeof(_ascii));
+}
+
+// Decode one UTF-8 codepoint at s; returns its length in bytes (1 for a
+// stray byte, which the font will not have either)
+static int utf8_next(const char* s, uint16_t* cp) {
+    uint8_t c = (uint8_t)s[0];
+    int n = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 1;
+    for (int i = 1; i < n; i++) {
+        if (((uint8_t)s[i] & 0xC0) != 0x80) n = 1;   // Truncated sequence
+    }
+    if (n == 1) {
+        *cp = c;
+    } else if (n == 2) {
+        *cp = ((c & 0x1F) << 6) | (s[1] & 0x3F);
+    } else if (n == 3) {
+        *cp = ((c & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+    } else {
+        *cp = 0xFFFF;   // Beyond the BMP: not in a u8g2 font
+    }
+    return n;
+}
+
+static int advance(uint16_t cp) {
+    if (cp < 128 && _ascii[cp] >= 0) return _ascii[cp];
+    int16_t a = _measure->u8g2_font_glyph_advance(cp);
+    if (a < 0) a = 0;   // Missing glyphs are not drawn
+    if (cp < 128) _ascii[cp] = (int8_t)a;
+    return a;
+}
+
+// Measure text and find where to cut it for max_w (arguments of a miss)
+static void layout(const char* text, size_t len, int max_w, Layout& l) {
+    if (_ellipsis_w < 0) _ellipsis_w = 3 * advance('.');
+
+    int width = 0;
+    size_t cut = 0;          // Last boundary that still fits with the ellipsis
+    int cut_width = 0;
+    size_t i = 0;
+    while (i < len) {
+        uint16_t cp;
+        int n = utf8_next(text + i, &cp);
+        int next = width + advance(cp);
+        if (next > max_w) break;
+        width = next;
+        i += n;
+        if (width + _ellipsis_w <= max_w) {
+            cut = i;
+            cut_width = width;
+        }
+    }
+
+    if (i >= len) {
+        l.cut = len;
+        l.width = width;
+        return;
+    }
+    // Don't leave the ellipsis hanging after a space ("Radio ...")
+    while (cut > 0 && text[cut - 1] == ' ') {
+        cut--;
+        cut_width -= advance(' ');
+    }
+    l.cut = cut;
+    l.width = cut_width + _ellipsis_w;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+int text_layout_width(const char* text) {
+    if (!text) return 0;
+    ensure_font();
+    int width = 0;
+    while (*text) {
+        uint16_t cp;
+        text += utf8_next(text, &cp);
+        width += advance(cp);
+    }
+    return width;
+}
+
+int text_layout_fit(const char* text, int max_w, char* out, size_t cap) {
+    if (!out || cap == 0) return 0;
+    out[0] = '\0';
+    if (!text || max_w <= 0) return 0;
+    ensure_font();
+
+    size_t len = strlen(text);
+    if (len > UINT16_MAX) len = UINT16_MAX;
+    uint32_t hash = fnv1a_bytes(text, len);
+    Layout* l = nullptr;
+    for (int i = 0; i < LAYOUT_SLOTS; i++) {
+        Layout& s = _layouts[i];
+        if (s.last_used && s.hash == hash && s.len == len && s.max_w == max_w) {
+            l = &s;
+            break;
+        }
+    }
+    if (!l) {
+        l = &_layouts[0];
+        for (int i = 1; i < LAYOUT_SLOTS; i++) {
+            if (_layouts[i].last_used < l->last_used) l = &_layouts[i];
+        }
+        l->hash = hash;
+        l->len = len;
+        l->max_w = max_w;
+        layout(text, len, max_w, *l);
+    }
+    l->last_used = ++_tick;
+
+    if (l->cut >= len) {
+        // Whole text; a short buffer still cuts at a codepoint boundary
+        size_t n = len < cap ? len : cap - 1;
+        while (n > 0 && n < len && ((uint8_t)text[n] & 0xC0) == 0x80) n--;
+        memcpy(out, text, n);
+        out[n] = '\0';
+        return l->width;
+    }
+
+    size_t n = l->cut;
+    if (n + sizeof(ELLIPSIS) > cap) {
+        n = cap > sizeof(ELLIPSIS) ? cap - sizeof(ELLIPSIS) : 0;
+        while (n > 0 && ((uint8_t)text[n] & 0xC0) == 0x80) n--;
+    }
+    memcpy(out, text, n);
+    memcpy(out + n, ELLIPSIS, sizeof(ELLIPSIS) <= cap - n ? sizeof(ELLIPSIS) : cap - n);
+    out[cap - 1] = '\0';
+    return l->width;
+}
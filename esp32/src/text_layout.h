@@ -0,0 +1,26 @@
+/**
+ * Pixel-width text layout for RadioWall.
+ *
+ * Single-line text in the u8g2 Unicode font (status bar, list cards) is
+ * fitted to a width in pixels, not a byte count: glyph advances come from
+ * the font, and a string that does not fit is cut at a codepoint boundary
+ * and ellipsized. A CJK title then uses the whole line instead of a third
+ * of it, and a Latin one no longer runs past the edge.
+ *
+ * The result of each fit (string, width -> cut point) is cached, so a
+ * redraw of the same text does not measure it again.
+ */
+
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <Arduino.h>
+
+// Width in pixels of text drawn in TH_FONT_UNICODE
+int text_layout_width(const char* text);
+
+// Copy text into out, cut and ended with "..." if it is wider than max_w
+// pixels; returns the drawn width
+int text_layout_fit(const char* text, int max_w, char* out, size_t cap);
+
+#endif // TEXT_LAYOUT_H
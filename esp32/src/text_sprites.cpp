@@ -0,0 +1,144 @@
+/**
+ * Pre-rendered list card text implementation for RadioWall.
+ *
+ * Text is drawn into a scratch Arduino_Canvas the size of the widest
+ * sprite, then its rows are copied into the slot. Sprites are opaque (card
+ * background included), so blitting one fully replaces what the text
+ * would have drawn.
+ */
+
+#include "text_sprites.h"
+#include "theme.h"
+#include "text_layout.h"
+#include "Arduino_GFX_Library.h"
+
+static const int SPRITE_SLOTS = 12;            // Two full pages of cards
+static const int TITLE_BASELINE = 14;
+static const int SUBTITLE_BASELINE = 34;
+static const size_t TEXT_KEY_MAX = 64;
+
+struct TextSprite {
+    char title[TEXT_KEY_MAX];
+    char subtitle[TEXT_KEY_MAX];
+    int16_t w;
+    uint32_t last_used;
+    uint16_t* pixels;      // w x TEXT_SPRITE_H, nullptr until first use
+};
+
+static TextSprite _sprites[SPRITE_SLOTS];
+static uint32_t _tick = 0;
+static Arduino_Canvas* _scratch = nullptr;
+static bool _unavailable = false;        // No PSRAM / allocation failed
+
+// ------------------------------------------------------------------
+// Rendering
+// ------------------------------------------------------------------
+
+static void draw_text(Arduino_GFX* gfx, int x, int y,
+                      const char* title, const char* subtitle) {
+    gfx->setFont(TH_FONT_UNICODE);
+    gfx->setFontIndex(TH_FONT_UNICODE_INDEX);
+    gfx->setUTF8Print(true);
+    gfx->setTextSize(1);
+    gfx->setTextColor(TH_TEXT);
+    gfx->setCursor(x, y + TITLE_BASELINE);
+    gfx->print(title);
+
+    gfx->setTextColor(TH_TEXT_SEC);
+    gfx->setCursor(x, y + SUBTITLE_BASELINE);
+    gfx->print(subtitle);
+
+    gfx->setFont((const uint8_t*)nullptr);
+    gfx->setUTF8Print(false);
+}
+
+static bool ensure_scratch() {
+    if (_scratch) return true;
+    if (_unavailable) return false;
+
+    if (psramFound()) {
+        _scratch = new Arduino_Canvas(TEXT_SPRITE_MAX_W, TEXT_SPRITE_H, nullptr);
+        if (!_scratch->begin(GFX_SKIP_OUTPUT_BEGIN)) {
+            delete _scratch;
+            _scratch = nullptr;
+        }
+    }
+    if (!_scratch) {
+        Serial.println("[Sprites] No PSRAM, drawing card text directly");
+        _unavailable = true;
+        return false;
+    }
+    return true;
+}
+
+static TextSprite* find_sprite(int w, const char* title, const char* subtitle) {
+    for (int i = 0; i < SPRITE_SLOTS; i++) {
+        TextSprite& s = _sprites[i];
+        if (s.pixels && s.w == w && strcmp(s.title, title) == 0 &&
+            strcmp(s.subtitle, subtitle) == 0) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+// Render into the least recently used slot
+static TextSprite* render_sprite(int w, const char* title, const char* subtitle) {
+    TextSprite* slot = &_sprites[0];
+    for (int i = 1; i < SPRITE_SLOTS; i++) {
+        if (_sprites[i].last_used < slot->last_used) slot = &_sprites[i];
+    }
+    if (!slot->pixels) {
+        slot->pixels = (uint16_t*)ps_malloc(TEXT_SPRITE_MAX_W * TEXT_SPRITE_H * sizeof(uint16_t));
+        if (!slot->pixels) return nullptr;
+    }
+
+    _scratch->fillScreen(TH_CARD);
+    draw_text(_scratch, 0, 0, title, subtitle);
+
+    const uint16_t* src = _scratch->getFramebuffer();
+    for (int row = 0; row < TEXT_SPRITE_H; row++) {
+        memcpy(slot->pixels + row * w, src + row * TEXT_SPRITE_MAX_W, w * sizeof(uint16_t));
+    }
+
+    strncpy(slot->title, title, TEXT_KEY_MAX - 1);
+    slot->title[TEXT_KEY_MAX - 1] = '\0';
+    strncpy(slot->subtitle, subtitle, TEXT_KEY_MAX - 1);
+    slot->subtitle[TEXT_KEY_MAX - 1] = '\0';
+    slot->w = w;
+    return slot;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void text_sprite_draw_card(Arduino_GFX* gfx, int x, int y, int w,
+                           const char* title, const char* subtitle) {
+    if (!gfx) return;
+    w = constrain(w, 1, TEXT_SPRITE_MAX_W);
+
+    // Sprites are keyed by the fitted lines, which is what they show
+    char title_fit[96], subtitle_fit[96];
+    text_layout_fit(title ? title : "", w, title_fit, sizeof(title_fit));
+    text_layout_fit(subtitle ? subtitle : "", w, subtitle_fit, sizeof(subtitle_fit));
+    title = title_fit;
+    subtitle = subtitle_fit;
+
+    // Keys longer than a slot can hold would never match again
+    bool cacheable = strlen(title) < TEXT_KEY_MAX && strlen(subtitle) < TEXT_KEY_MAX;
+    if (!cacheable || !ensure_scratch()) {
+        draw_text(gfx, x, y, title, subtitle);
+        return;
+    }
+
+    TextSprite* s = find_sprite(w, title, subtitle);
+    if (!s) s = render_sprite(w, title, subtitle);
+    if (!s) {
+        draw_text(gfx, x, y, title, subtitle);
+        return;
+    }
+
+    s->last_used = ++_tick;
+    gfx->draw16bitRGBBitmap(x, y, s->pixels, w, TEXT_SPRITE_H);
+}
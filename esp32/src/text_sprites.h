@@ -0,0 +1,28 @@
+/**
+ * Pre-rendered list card text for RadioWall.
+ *
+ * Favorites and history cards show a title and a "place, country" line in
+ * the u8g2 CJK font. Each card's two lines are rendered once into a small
+ * RGB565 sprite in PSRAM and kept, keyed by the text, so repainting a page
+ * is one bitmap copy per card. An edited entry has different text and gets
+ * a new sprite; unused ones are replaced least recently used first.
+ */
+
+#ifndef TEXT_SPRITES_H
+#define TEXT_SPRITES_H
+
+#include <Arduino.h>
+
+class Arduino_GFX;
+
+#define TEXT_SPRITE_H 40        // Two text lines
+#define TEXT_SPRITE_MAX_W 180   // Widest sprite (full display width)
+
+// Draw a card's title (TH_TEXT) and subtitle (TH_TEXT_SEC) on the card
+// background, with the sprite's top-left at (x, y). Baselines are 14 and
+// 34 px below y. Lines wider than w are ellipsized (text_layout). Falls
+// back to drawing the text directly without PSRAM.
+void text_sprite_draw_card(Arduino_GFX* gfx, int x, int y, int w,
+                           const char* title, const char* subtitle);
+
+#endif // TEXT_SPRITES_H
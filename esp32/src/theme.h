@@ -31,6 +31,18 @@
 #define FONT_SERIF_ASCENT  17
 #define FONT_SERIF_HEIGHT  28
 
+// u8g2 Unicode font for station names (set with setUTF8Print(true)).
+// FONT_SUBSET swaps the full CJK font for the glyphs tools/subset_font.py
+// found in use, looked up through a direct index instead of a linear scan.
+#if defined(FONT_SUBSET)
+#include "font_subset.h"
+#define TH_FONT_UNICODE        u8g2_font_radiowall_subset
+#define TH_FONT_UNICODE_INDEX  (&u8g2_font_radiowall_subset_index)
+#else
+#define TH_FONT_UNICODE        u8g2_font_cubic11_h_cjk
+#define TH_FONT_UNICODE_INDEX  nullptr
+#endif
+
 // =====================================================================
 // Color Palette (RGB565)
 // =====================================================================
@@ -65,6 +77,7 @@
 #define TH_CARD_MARGIN  4       // Horizontal margin for cards
 #define TH_CARD_W       172     // Card width (180 - 2*margin)
 #define TH_DISPLAY_W    180     // Display width
+#define TH_DISPLAY_H    640     // Display height
 
 // =====================================================================
 // Menu Icons (16x16 monochrome bitmaps, PROGMEM)
@@ -0,0 +1,250 @@
+/**
+ * TLS certificate trust implementation for RadioWall.
+ *
+ * The chain check is mbedTLS's own, fed by esp_crt_bundle through
+ * WiFiClientSecure::setCACertBundle(); a pinned session runs unverified
+ * and then compares the peer certificate's SHA-256, which costs one hash
+ * instead of the chain's signature checks. The cache is a short array
+ * under a spinlock: callers copy in and out, never hold an entry.
+ */
+
+#include "tls_trust.h"
+#include "serial_cmd.h"
+#include "dns_cache.h"
+#include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+
+#ifdef TLS_VERIFY
+// platformio.ini: board_build.embed_files = cert/x509_crt_bundle.bin
+extern const uint8_t CERT_BUNDLE[] asm("_binary_cert_x509_crt_bundle_bin_start");
+#endif
+
+static const int TRUST_MAX = 10;           // radio.garden + WiiM master and group
+static const int BENCH_ROUNDS = 5;
+
+struct TrustedHost {
+    char host[40];
+    uint8_t sha256[32];
+    bool chain;            // Pinned after a chain check (else first use)
+    uint32_t pinned;       // Handshakes accepted by fingerprint since
+};
+
+static TrustedHost _trusted[TRUST_MAX];
+static int _trusted_count = 0;
+static portMUX_TYPE _trust_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t _chain_checks = 0;
+static uint32_t _mismatches = 0;
+
+// Call with _trust_mux held
+static TrustedHost* find_host(const char* host) {
+    for (int i = 0; i < _trusted_count; i++) {
+        if (strcmp(_trusted[i].host, host) == 0) return &_trusted[i];
+    }
+    return nullptr;
+}
+
+static bool lookup_pin(const char* host, uint8_t* sha256) {
+    portENTER_CRITICAL(&_trust_mux);
+    TrustedHost* t = find_host(host);
+    if (t) memcpy(sha256, t->sha256, sizeof(t->sha256));
+    portEXIT_CRITICAL(&_trust_mux);
+    return t != nullptr;
+}
+
+static void store_pin(const char* host, const uint8_t* sha256, bool chain) {
+    portENTER_CRITICAL(&_trust_mux);
+    TrustedHost* t = find_host(host);
+    if (!t) {
+        if (_trusted_count == TRUST_MAX) {
+            // Full: drop the oldest host
+            memmove(&_trusted[0], &_trusted[1], sizeof(TrustedHost) * (TRUST_MAX - 1));
+            _trusted_count--;
+        }
+        t = &_trusted[_trusted_count++];
+        strncpy(t->host, host, sizeof(t->host) - 1);
+        t->host[sizeof(t->host) - 1] = '\0';
+    }
+    memcpy(t->sha256, sha256, sizeof(t->sha256));
+    t->chain = chain;
+    t->pinned = 0;
+    portEXIT_CRITICAL(&_trust_mux);
+}
+
+static void drop_pin(const char* host) {
+    portENTER_CRITICAL(&_trust_mux);
+    TrustedHost* t = find_host(host);
+    if (t) {
+        *t = _trusted[--_trusted_count];
+    }
+    portEXIT_CRITICAL(&_trust_mux);
+}
+
+static bool is_ip(const char* host) {
+    IPAddress ip;
+    return ip.fromString(host);
+}
+
+// Chain check on a client that may have been set up insecure before
+static void require_chain(WiFiClientSecure& client) {
+#ifdef TLS_VERIFY
+    client.setCACert(nullptr);   // Clears the insecure flag
+    client.setCACertBundle(CERT_BUNDLE);
+#else
+    client.setInsecure();
+#endif
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+TlsCheck tls_trust_prepare(WiFiClientSecure& client, const char* host) {
+#ifdef TLS_VERIFY
+    uint8_t pin[32];
+    bool pinned = lookup_pin(host, pin);
+    if (is_ip(host)) {
+        client.setInsecure();   // Self-signed: nothing to chain to
+        return pinned ? TLS_CHECK_PIN : TLS_CHECK_FIRST_USE;
+    }
+    if (pinned) {
+        client.setInsecure();
+        return TLS_CHECK_PIN;
+    }
+    require_chain(client);
+    return TLS_CHECK_CHAIN;
+#else
+    (void)host;
+    client.setInsecure();
+    return TLS_CHECK_NONE;
+#endif
+}
+
+bool tls_trust_accept(WiFiClientSecure& client, const char* host, TlsCheck check) {
+    if (check == TLS_CHECK_NONE) return true;
+
+    uint8_t sha256[32];
+    if (!client.getFingerprintSHA256(sha256)) {
+        Serial.printf("[TLS] %s: no peer certificate\n", host);
+        return false;
+    }
+
+    if (check == TLS_CHECK_PIN) {
+        uint8_t pin[32];
+        bool match = lookup_pin(host, pin) && memcmp(pin, sha256, sizeof(pin)) == 0;
+        portENTER_CRITICAL(&_trust_mux);
+        TrustedHost* t = find_host(host);
+        if (match && t) t->pinned++;
+        if (!match) _mismatches++;
+        portEXIT_CRITICAL(&_trust_mux);
+        if (match) return true;
+
+        Serial.printf("[TLS] %s: certificate changed%s\n", host,
+                      is_ip(host) ? ", refusing it until a restart" : ", checking the chain again");
+        if (!is_ip(host)) drop_pin(host);
+        return false;
+    }
+
+    // Chain checked by mbedTLS during connect(), or a device's first use
+    bool chain = check == TLS_CHECK_CHAIN;
+    if (chain) {
+        portENTER_CRITICAL(&_trust_mux);
+        _chain_checks++;
+        portEXIT_CRITICAL(&_trust_mux);
+    }
+    store_pin(host, sha256, chain);
+    Serial.printf("[TLS] %s: %s, pinned %02x%02x%02x%02x...\n", host,
+                  chain ? "chain verified" : "self-signed, trusted on first use",
+                  sha256[0], sha256[1], sha256[2], sha256[3]);
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Serial commands
+// ------------------------------------------------------------------
+
+// Handshake times for one set-up; pin (if given) is checked like a pooled
+// session would be
+static void bench_mode(const char* label, const char* host, IPAddress ip, TlsCheck mode,
+                       uint8_t* pin) {
+    unsigned long ms[BENCH_ROUNDS];
+    int ok_count = 0;
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        WiFiClientSecure client;
+        if (mode == TLS_CHECK_CHAIN) require_chain(client);
+        else client.setInsecure();
+
+        unsigned long start = millis();
+        bool ok = client.connect(ip, 443, host, nullptr, nullptr, nullptr);
+        uint8_t sha256[32];
+        if (ok && mode == TLS_CHECK_PIN) {
+            ok = client.getFingerprintSHA256(sha256) && memcmp(sha256, pin, sizeof(sha256)) == 0;
+        } else if (ok && mode == TLS_CHECK_CHAIN && i == 0) {
+            client.getFingerprintSHA256(pin);
+        }
+        ms[i] = millis() - start;
+        client.stop();
+        if (ok) ok_count++;
+    }
+
+    // Insertion sort: five samples
+    for (int i = 1; i < BENCH_ROUNDS; i++) {
+        for (int j = i; j > 0 && ms[j] < ms[j - 1]; j--) {
+            unsigned long t = ms[j];
+            ms[j] = ms[j - 1];
+            ms[j - 1] = t;
+        }
+    }
+    Serial.printf("[TLS] %-10s median %4lu ms (min %lu, max %lu), %d/%d ok\n", label,
+                  ms[BENCH_ROUNDS / 2], ms[0], ms[BENCH_ROUNDS - 1], ok_count, BENCH_ROUNDS);
+}
+
+static void cmd_bench(const char* host) {
+    IPAddress ip;
+    if (!WiFi.isConnected() || !(ip.fromString(host) || dns_cache_resolve(host, &ip))) {
+        Serial.printf("[TLS] Cannot reach %s\n", host);
+        return;
+    }
+    Serial.printf("[TLS] %d handshakes per mode to %s (blocks the loop)\n", BENCH_ROUNDS, host);
+
+    uint8_t pin[32] = {0};
+    bench_mode("insecure", host, ip, TLS_CHECK_NONE, pin);
+#ifdef TLS_VERIFY
+    bench_mode("chain", host, ip, TLS_CHECK_CHAIN, pin);
+#else
+    Serial.println("[TLS] chain      skipped: built without TLS_VERIFY");
+    WiFiClientSecure probe;
+    probe.setInsecure();
+    if (probe.connect(ip, 443, host, nullptr, nullptr, nullptr)) probe.getFingerprintSHA256(pin);
+    probe.stop();
+#endif
+    bench_mode("pinned", host, ip, TLS_CHECK_PIN, pin);
+}
+
+static void cmd_tls(const char* args) {
+    if (args[0]) {
+        cmd_bench(args);
+        return;
+    }
+#ifdef TLS_VERIFY
+    Serial.printf("[TLS] Verification on: %lu chain check(s), %lu mismatch(es)\n",
+                  (unsigned long)_chain_checks, (unsigned long)_mismatches);
+#else
+    Serial.println("[TLS] Verification off (build with -DTLS_VERIFY)");
+#endif
+    TrustedHost hosts[TRUST_MAX];
+    portENTER_CRITICAL(&_trust_mux);
+    int count = _trusted_count;
+    memcpy(hosts, _trusted, sizeof(TrustedHost) * count);
+    portEXIT_CRITICAL(&_trust_mux);
+    for (int i = 0; i < count; i++) {
+        const TrustedHost& t = hosts[i];
+        Serial.printf("[TLS]   %s: %s, %02x%02x%02x%02x..., %lu pinned handshake(s)\n", t.host,
+                      t.chain ? "chain" : "first use", t.sha256[0], t.sha256[1], t.sha256[2],
+                      t.sha256[3], (unsigned long)t.pinned);
+    }
+}
+
+void tls_trust_serial_init() {
+    serial_cmd_register("TLS", cmd_tls);
+    serial_cmd_register("TLS:", cmd_tls);
+}
@@ -0,0 +1,49 @@
+/**
+ * TLS certificate trust for RadioWall's HTTPS pool.
+ *
+ * Built with -DTLS_VERIFY (and a CA bundle from tools/gen_cert_bundle.py,
+ * see platformio.ini), sessions are no longer unchecked:
+ *
+ * - Named hosts (radio.garden): the first handshake after boot checks the
+ *   chain against the embedded ESP x509 certificate bundle and the host
+ *   name. The leaf certificate's SHA-256 is then kept for the host, and
+ *   later handshakes skip the chain check and compare fingerprints. A
+ *   mismatch (the certificate was renewed) drops the entry, and the retry
+ *   checks the new chain in full.
+ * - IP hosts (WiiM devices, self-signed): pinned on first use, per boot.
+ *
+ * Keep-alive already spreads one handshake over many requests; the cache
+ * keeps the chain check to one per host per boot. Without TLS_VERIFY every
+ * session is unverified, as before.
+ *
+ * Serial "TLS" prints the cache; "TLS:<host>" times handshakes to host
+ * unverified, with the chain check and pinned.
+ *
+ * Any task.
+ */
+
+#ifndef TLS_TRUST_H
+#define TLS_TRUST_H
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+enum TlsCheck : uint8_t {
+    TLS_CHECK_NONE,        // Unverified (built without TLS_VERIFY)
+    TLS_CHECK_CHAIN,       // Full chain and host name check
+    TLS_CHECK_PIN,         // Fingerprint of an earlier checked session
+    TLS_CHECK_FIRST_USE,   // Self-signed device: pin what it presents
+};
+
+// Set up client for a handshake with host; pass the result to
+// tls_trust_accept() once connect() succeeded
+TlsCheck tls_trust_prepare(WiFiClientSecure& client, const char* host);
+
+// Check or record the session's certificate. False: close the connection
+// (for TLS_CHECK_PIN, retrying gets a full chain check).
+bool tls_trust_accept(WiFiClientSecure& client, const char* host, TlsCheck check);
+
+// Register the TLS serial commands
+void tls_trust_serial_init();
+
+#endif // TLS_TRUST_H
@@ -0,0 +1,78 @@
+/**
+ * Fixed-point touch coordinate transforms implementation for RadioWall.
+ */
+
+#include "touch_calib.h"
+
+static int32_t to_q16(double v) {
+    return (int32_t)lround(v * (1 << TOUCH_XFORM_SHIFT));
+}
+
+TouchTransform touch_transform_scale(float sx, float ox, float sy, float oy) {
+    TouchTransform t;
+    t.a = to_q16(sx); t.b = 0;          t.c = to_q16(ox);
+    t.d = 0;          t.e = to_q16(sy); t.f = to_q16(oy);
+    return t;
+}
+
+TouchTransform touch_transform_identity() {
+    return touch_transform_scale(1.0f, 0.0f, 1.0f, 0.0f);
+}
+
+TouchTransform touch_transform_compose(const TouchTransform& o, const TouchTransform& i) {
+    // Products of two Q16 values are Q32: shift one factor back out
+    TouchTransform t;
+    t.a = (int32_t)(((int64_t)o.a * i.a + (int64_t)o.b * i.d) >> TOUCH_XFORM_SHIFT);
+    t.b = (int32_t)(((int64_t)o.a * i.b + (int64_t)o.b * i.e) >> TOUCH_XFORM_SHIFT);
+    t.c = (int32_t)((((int64_t)o.a * i.c + (int64_t)o.b * i.f) >> TOUCH_XFORM_SHIFT) + o.c);
+    t.d = (int32_t)(((int64_t)o.d * i.a + (int64_t)o.e * i.d) >> TOUCH_XFORM_SHIFT);
+    t.e = (int32_t)(((int64_t)o.d * i.b + (int64_t)o.e * i.e) >> TOUCH_XFORM_SHIFT);
+    t.f = (int32_t)((((int64_t)o.d * i.c + (int64_t)o.e * i.f) >> TOUCH_XFORM_SHIFT) + o.f);
+    return t;
+}
+
+static double det3(const double m[3][3]) {
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+           m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+           m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+// Solve m * out = rhs by Cramer's rule (det already checked non-zero)
+static void solve3(const double m[3][3], const double rhs[3], double det, double out[3]) {
+    for (int col = 0; col < 3; col++) {
+        double mc[3][3];
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) mc[r][c] = (c == col) ? rhs[r] : m[r][c];
+        }
+        out[col] = det3(mc) / det;
+    }
+}
+
+bool touch_transform_fit(const int touched[][2], const int target[][2], int count,
+                         TouchTransform* out) {
+    if (count < 3) return false;
+
+    // Normal equations: (A^T A) p = A^T b with rows A = [x y 1]
+    double ata[3][3] = {{0}};
+    double atx[3] = {0};
+    double aty[3] = {0};
+    for (int i = 0; i < count; i++) {
+        double row[3] = {(double)touched[i][0], (double)touched[i][1], 1.0};
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) ata[r][c] += row[r] * row[c];
+            atx[r] += row[r] * target[i][0];
+            aty[r] += row[r] * target[i][1];
+        }
+    }
+
+    double det = det3(ata);
+    if (fabs(det) < 1e-6) return false;
+
+    double px[3], py[3];
+    solve3(ata, atx, det, px);
+    solve3(ata, aty, det, py);
+
+    out->a = to_q16(px[0]); out->b = to_q16(px[1]); out->c = to_q16(px[2]);
+    out->d = to_q16(py[0]); out->e = to_q16(py[1]); out->f = to_q16(py[2]);
+    return true;
+}
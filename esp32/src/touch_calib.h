@@ -0,0 +1,49 @@
+/**
+ * Fixed-point touch coordinate transforms for RadioWall.
+ *
+ * A TouchTransform is a 2D affine map in Q16 fixed point:
+ *
+ *   x' = (a*x + b*y + c) >> 16
+ *   y' = (d*x + e*y + f) >> 16
+ *
+ * Transforms are built in floating point when something changes (the
+ * calibration, the map view) and applied per sample with two integer
+ * multiply-adds per axis. Four-corner calibration fits the affine part by
+ * least squares; a flat panel over a flat print needs no perspective term.
+ */
+
+#ifndef TOUCH_CALIB_H
+#define TOUCH_CALIB_H
+
+#include <Arduino.h>
+
+static const int TOUCH_XFORM_SHIFT = 16;
+static const int TOUCH_CALIB_POINTS = 4;
+
+struct TouchTransform {
+    int32_t a, b, c;
+    int32_t d, e, f;
+};
+
+static inline void touch_transform_apply(const TouchTransform& t, int x, int y,
+                                         int* out_x, int* out_y) {
+    *out_x = (int)(((int64_t)t.a * x + (int64_t)t.b * y + t.c) >> TOUCH_XFORM_SHIFT);
+    *out_y = (int)(((int64_t)t.d * x + (int64_t)t.e * y + t.f) >> TOUCH_XFORM_SHIFT);
+}
+
+// x' = sx*x + ox, y' = sy*y + oy (no rotation or shear)
+TouchTransform touch_transform_scale(float sx, float ox, float sy, float oy);
+
+TouchTransform touch_transform_identity();
+
+// outer(inner(p)) as one transform
+TouchTransform touch_transform_compose(const TouchTransform& outer, const TouchTransform& inner);
+
+/**
+ * Least-squares affine fit taking each touched[i] to target[i] (x, y pairs).
+ * Returns false if the points are degenerate (collinear, repeated).
+ */
+bool touch_transform_fit(const int touched[][2], const int target[][2], int count,
+                         TouchTransform* out);
+
+#endif // TOUCH_CALIB_H
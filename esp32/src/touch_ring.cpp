@@ -0,0 +1,62 @@
+/**
+ * Touch sample ring implementation for RadioWall.
+ *
+ * head is only written by the producer and tail only by the consumer; the
+ * release store of each publishes the slot it covers to the other side.
+ */
+
+#include "touch_ring.h"
+#include "loop_events.h"
+#include "metrics.h"
+#include <atomic>
+
+static TouchRing _ring;
+
+bool touch_ring_push_to(TouchRing& ring, const TouchSample& sample, bool is_move) {
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+    uint32_t used = head - ring.tail.load(std::memory_order_acquire);
+    uint32_t limit = is_move ? TOUCH_RING_LEN - TOUCH_RING_MOVE_HEADROOM : TOUCH_RING_LEN;
+    if (used >= limit) {
+        metrics_inc(METRIC_TOUCH_DROPPED);
+        return false;
+    }
+    ring.slots[head % TOUCH_RING_LEN] = sample;
+    ring.head.store(head + 1, std::memory_order_release);
+    loop_events_notify();
+    return true;
+}
+
+bool touch_ring_pop_from(TouchRing& ring, TouchSample* sample) {
+    uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    if (tail == ring.head.load(std::memory_order_acquire)) return false;
+    *sample = ring.slots[tail % TOUCH_RING_LEN];
+    ring.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool touch_ring_push(const TouchSample& sample, bool is_move) {
+    return touch_ring_push_to(_ring, sample, is_move);
+}
+
+bool touch_ring_pop(TouchSample* sample) {
+    return touch_ring_pop_from(_ring, sample);
+}
+
+bool touch_ring_pop_oldest(TouchRing* rings, int count, TouchSample* sample) {
+    int oldest = -1;
+    uint32_t oldest_ms = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t tail = rings[i].tail.load(std::memory_order_relaxed);
+        if (tail == rings[i].head.load(std::memory_order_acquire)) continue;
+        uint32_t ms = rings[i].slots[tail % TOUCH_RING_LEN].ms;
+        if (oldest < 0 || (int32_t)(ms - oldest_ms) < 0) {
+            oldest = i;
+            oldest_ms = ms;
+        }
+    }
+    return oldest >= 0 && touch_ring_pop_from(rings[oldest], sample);
+}
+
+bool touch_sample_is_lift(const TouchSample& sample) {
+    return sample.fingers == 0 || (sample.fingers == 1 && sample.event == 1);
+}
@@ -0,0 +1,59 @@
+/**
+ * Touch sample ring for RadioWall.
+ *
+ * Lock-free single-producer / single-consumer queue between the task that
+ * reads the touch hardware (built-in I2C reader or USB host client) and
+ * the loop task that runs the gesture logic. The built-in reader uses the
+ * default ring. Each USB panel's client task pushes into a TouchRing of
+ * its own, so every ring keeps a single producer, and the loop task
+ * merges them in timestamp order (touch_ring_pop_oldest).
+ *
+ * A push wakes the loop task (loop_events.h).
+ *
+ * Moves may not fill the last TOUCH_RING_MOVE_HEADROOM slots, so a long
+ * stall on the consumer side costs intermediate positions but never a
+ * press or a lift.
+ */
+
+#ifndef TOUCH_RING_H
+#define TOUCH_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+
+struct TouchSample {
+    uint32_t ms;         // millis() when the report was read
+    uint16_t x;
+    uint16_t y;
+    uint16_t x2;         // Second point, if fingers >= 2
+    uint16_t y2;
+    uint8_t fingers;
+    uint8_t event;       // 0=DOWN, 1=UP, 2=CONTACT
+    uint8_t source;      // Ring it came from (USB panel), 0 for the built-in reader
+};
+
+static const uint32_t TOUCH_RING_LEN = 64;           // Power of two
+static const uint32_t TOUCH_RING_MOVE_HEADROOM = 8;  // Slots only presses/lifts may use
+
+struct TouchRing {
+    TouchSample slots[TOUCH_RING_LEN];
+    std::atomic<uint32_t> head;   // Written by the producer only
+    std::atomic<uint32_t> tail;   // Written by the consumer only
+};
+
+// Producer side. Returns false if the sample did not fit.
+bool touch_ring_push(const TouchSample& sample, bool is_move);
+bool touch_ring_push_to(TouchRing& ring, const TouchSample& sample, bool is_move);
+
+// Consumer side. Returns false if the ring is empty.
+bool touch_ring_pop(TouchSample* sample);
+bool touch_ring_pop_from(TouchRing& ring, TouchSample* sample);
+
+// Consumer side of several rings: the sample read the earliest among
+// their heads. Samples still on their way to a ring are not waited for.
+bool touch_ring_pop_oldest(TouchRing* rings, int count, TouchSample* sample);
+
+// True for a sample that ends a touch (no fingers, or the last one's UP)
+bool touch_sample_is_lift(const TouchSample& sample);
+
+#endif // TOUCH_RING_H
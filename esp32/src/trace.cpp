@@ -0,0 +1,185 @@
+/**
+ * Tap-to-audio span tracer implementation for RadioWall.
+ *
+ * Spans come from the loop task and the net worker, so the ring is
+ * guarded by a spinlock; nothing in the critical sections does more than
+ * copy a few words. A token is the span's sequence number: the ring slot
+ * is token % TRACE_RING, and trace_end() ignores a token whose slot has
+ * been reused since.
+ */
+
+#include "trace.h"
+#include "serial_cmd.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const int TRACE_RING = 64;
+
+struct TraceEntry {
+    uint32_t seq;          // Token; 0 = empty
+    uint16_t tap;
+    TracePhase phase;
+    TaskHandle_t task;     // Task that recorded it
+    uint32_t start_us;
+    uint32_t end_us;       // 0 = still open
+};
+
+static const char* const PHASE_NAMES[TRACE_PHASE_COUNT] = {
+    "tap.defer", "places.lookup", "https.connect", "radio.channels",
+    "radio.json", "radio.redirect", "stream.probe", "linkplay.play", "wiim.first_play",
+};
+
+static portMUX_TYPE _trace_mux = portMUX_INITIALIZER_UNLOCKED;
+static TraceEntry _ring[TRACE_RING];
+static uint32_t _seq = 0;
+static uint16_t _tap = 0;
+static uint32_t _tap_start_us = 0;
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void trace_tap_start(unsigned long touch_ms) {
+    portENTER_CRITICAL(&_trace_mux);
+    _tap++;
+    _tap_start_us = (uint32_t)(touch_ms * 1000UL);
+    portEXIT_CRITICAL(&_trace_mux);
+}
+
+static uint32_t record(TracePhase phase, uint32_t start_us, uint32_t end_us) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL(&_trace_mux);
+    uint32_t token = ++_seq;
+    if (token == 0) token = ++_seq;    // 0 marks an empty slot
+    TraceEntry& e = _ring[token % TRACE_RING];
+    e.seq = token;
+    e.tap = _tap;
+    e.phase = phase;
+    e.task = task;
+    e.start_us = start_us;
+    e.end_us = end_us;
+    portEXIT_CRITICAL(&_trace_mux);
+    return token;
+}
+
+uint32_t trace_begin(TracePhase phase) {
+    return record(phase, micros(), 0);
+}
+
+void trace_end(uint32_t token) {
+    uint32_t now = micros();
+    portENTER_CRITICAL(&_trace_mux);
+    TraceEntry& e = _ring[token % TRACE_RING];
+    if (e.seq == token) e.end_us = now ? now : 1;
+    portEXIT_CRITICAL(&_trace_mux);
+}
+
+void trace_span(TracePhase phase, uint32_t start_us, uint32_t end_us) {
+    record(phase, start_us, end_us);
+}
+
+bool trace_longest_within(uint32_t from_us, uint32_t to_us, TracePhase* phase) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    uint32_t window = to_us - from_us;
+    uint32_t best = 0;
+    bool found = false;
+    portENTER_CRITICAL(&_trace_mux);
+    for (int i = 0; i < TRACE_RING; i++) {
+        const TraceEntry& e = _ring[i];
+        if (e.seq == 0 || e.task != task || e.start_us - from_us > window) continue;
+        uint32_t end = e.end_us ? e.end_us : to_us;
+        if (end - from_us > window) end = to_us;   // Ended after the window
+        uint32_t dur = end - e.start_us;
+        if (!found || dur > best) {
+            best = dur;
+            *phase = e.phase;
+            found = true;
+        }
+    }
+    portEXIT_CRITICAL(&_trace_mux);
+    return found;
+}
+
+// Span recorded for the given tap, at or after its touch. Under _trace_mux.
+static bool in_tap(const TraceEntry& e, uint16_t tap, uint32_t t0) {
+    return e.seq != 0 && e.tap == tap && (int32_t)(e.start_us - t0) >= 0;
+}
+
+uint16_t trace_last_tap(uint32_t totals_us[TRACE_PHASE_COUNT], uint32_t* audio_us) {
+    memset(totals_us, 0, TRACE_PHASE_COUNT * sizeof(uint32_t));
+    *audio_us = 0;
+    portENTER_CRITICAL(&_trace_mux);
+    uint16_t tap = _tap;
+    uint32_t t0 = _tap_start_us;
+    for (int i = 0; i < TRACE_RING; i++) {
+        const TraceEntry& e = _ring[i];
+        if (!in_tap(e, tap, t0) || e.end_us == 0) continue;
+        totals_us[e.phase] += e.end_us - e.start_us;
+        if (e.phase == TRACE_FIRST_PLAY) *audio_us = e.end_us - t0;
+    }
+    portEXIT_CRITICAL(&_trace_mux);
+    return tap;
+}
+
+const char* trace_phase_name(TracePhase phase) {
+    return phase < TRACE_PHASE_COUNT ? PHASE_NAMES[phase] : "?";
+}
+
+// ------------------------------------------------------------------
+// Report
+// ------------------------------------------------------------------
+
+static void print_last_tap() {
+    TraceEntry spans[TRACE_RING];
+    int count = 0;
+    portENTER_CRITICAL(&_trace_mux);
+    uint16_t tap = _tap;
+    uint32_t t0 = _tap_start_us;
+    // Oldest first: walk the ring from the slot after the newest
+    for (int i = 1; i <= TRACE_RING; i++) {
+        const TraceEntry& e = _ring[(_seq + i) % TRACE_RING];
+        if (in_tap(e, tap, t0)) spans[count++] = e;
+    }
+    portEXIT_CRITICAL(&_trace_mux);
+
+    if (tap == 0) {
+        Serial.println("[Trace] No tap traced yet");
+        return;
+    }
+    Serial.printf("[Trace] Tap #%u, %d span(s), offsets from finger touch:\n", tap, count);
+
+    uint32_t totals[TRACE_PHASE_COUNT] = {0};
+    uint32_t audio_us = 0;
+    for (int i = 0; i < count; i++) {
+        const TraceEntry& e = spans[i];
+        if (e.end_us == 0) {
+            Serial.printf("[Trace]   +%6lu ms  %-16s (open)\n",
+                          (unsigned long)((e.start_us - t0) / 1000), PHASE_NAMES[e.phase]);
+            continue;
+        }
+        uint32_t dur = e.end_us - e.start_us;
+        totals[e.phase] += dur;
+        if (e.phase == TRACE_FIRST_PLAY) audio_us = e.end_us - t0;
+        Serial.printf("[Trace]   +%6lu ms  %-16s %8.1f ms\n",
+                      (unsigned long)((e.start_us - t0) / 1000), PHASE_NAMES[e.phase],
+                      dur / 1000.0f);
+    }
+
+    Serial.println("[Trace] Per phase:");
+    for (int p = 0; p < TRACE_PHASE_COUNT; p++) {
+        if (totals[p]) Serial.printf("[Trace]   %-16s %8.1f ms\n", PHASE_NAMES[p], totals[p] / 1000.0f);
+    }
+    if (audio_us) {
+        Serial.printf("[Trace] Touch to audio: %lu ms\n", (unsigned long)(audio_us / 1000));
+    } else {
+        Serial.println("[Trace] Audio not confirmed yet");
+    }
+}
+
+static void cmd_trace(const char*) {
+    print_last_tap();
+}
+
+void trace_serial_init() {
+    serial_cmd_register("TRACE", cmd_trace);
+}
@@ -0,0 +1,64 @@
+/**
+ * Tap-to-audio span tracer for RadioWall.
+ *
+ * A fixed ring of spans (phase, start, end in microseconds), each tagged
+ * with the tap that was current when it started. trace_tap_start() opens
+ * a new tap at the finger-down time; the lookup, HTTPS and LinkPlay code
+ * record spans as they run, on whichever task runs them. The net worker
+ * closes the tap with TRACE_FIRST_PLAY once getPlayerStatus reports
+ * "play". Serial "TRACE" prints the last tap's per-phase breakdown.
+ *
+ * Spans are kept even with no tap open (NEXT, favorites); they show up
+ * under the last tap only if they started after it.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+
+enum TracePhase : uint8_t {
+    TRACE_TAP_DEFER,       // Finger up -> deferred single tap fires
+    TRACE_LOOKUP,          // Nearest-place (k-NN cursor) query
+    TRACE_TLS_CONNECT,     // New HTTPS connection (TCP + handshake)
+    TRACE_CHANNELS,        // Station list fetch, including the parse
+    TRACE_JSON_PARSE,      // Channels JSON parse from the socket
+    TRACE_REDIRECT,        // Stream URL redirect lookup
+    TRACE_STREAM_PROBE,    // Parallel liveness probe of candidate streams
+    TRACE_LINKPLAY_PLAY,   // setPlayerCmd:play round trip
+    TRACE_FIRST_PLAY,      // Play accepted -> status first reports "play"
+    TRACE_PHASE_COUNT
+};
+
+// Open a new tap; touch_ms is the millis() of the finger touch
+void trace_tap_start(unsigned long touch_ms);
+
+// Open a span now; pass the token to trace_end() (any task)
+uint32_t trace_begin(TracePhase phase);
+void trace_end(uint32_t token);
+
+// Record a span whose times are already known (micros())
+void trace_span(TracePhase phase, uint32_t start_us, uint32_t end_us);
+
+// Span for the enclosing scope
+struct TraceScope {
+    explicit TraceScope(TracePhase phase) : _token(trace_begin(phase)) {}
+    ~TraceScope() { trace_end(_token); }
+    uint32_t _token;
+};
+
+// Phase that ran longest on the calling task in [from_us, to_us], among
+// spans that started in that window (open ones count up to to_us).
+// Used to attribute stalls; false if none started.
+bool trace_longest_within(uint32_t from_us, uint32_t to_us, TracePhase* phase);
+
+// Last tap: time per phase over its closed spans, and touch to audio
+// (0 until confirmed). Returns the tap number, 0 before the first tap.
+uint16_t trace_last_tap(uint32_t totals_us[TRACE_PHASE_COUNT], uint32_t* audio_us);
+
+const char* trace_phase_name(TracePhase phase);
+
+// Register the TRACE serial command
+void trace_serial_init();
+
+#endif // TRACE_H
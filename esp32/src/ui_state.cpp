@@ -4,48 +4,26 @@
 
 #include "ui_state.h"
 #include "world_map.h"  // For bitmap data pointers
+#include "binlog.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 UIState::UIState() {
-    // Initialize 4 vertical longitude slices
-    // Slice 0: Americas
-    slices[0] = {
-        "Americas",
-        "-150° to -30°",
-        -150.0f,  // lon_min
-        -30.0f,   // lon_max
-        map_slice_americas,
-        map_slice_americas_size
+    // Longitude slices from the generated layout (map_layout.h), with
+    // their 1x bitmaps in the same order
+    const uint8_t* const bitmaps[MAP_SLICE_COUNT] = {
+        map_slice_americas, map_slice_europe_africa, map_slice_asia, map_slice_pacific,
     };
-
-    // Slice 1: Europe/Africa (DEFAULT - most stations)
-    slices[1] = {
-        "Europe/Africa",
-        "-30° to 60°",
-        -30.0f,
-        60.0f,
-        map_slice_europe_africa,
-        map_slice_europe_africa_size
-    };
-
-    // Slice 2: Asia
-    slices[2] = {
-        "Asia",
-        "60° to 150°",
-        60.0f,
-        150.0f,
-        map_slice_asia,
-        map_slice_asia_size
-    };
-
-    // Slice 3: Pacific
-    slices[3] = {
-        "Pacific",
-        "150° to -150°",
-        150.0f,
-        -150.0f,  // Wraps around
-        map_slice_pacific,
-        map_slice_pacific_size
+    const size_t bitmap_sizes[MAP_SLICE_COUNT] = {
+        map_slice_americas_size, map_slice_europe_africa_size,
+        map_slice_asia_size, map_slice_pacific_size,
     };
+    for (int i = 0; i < MAP_SLICE_COUNT; i++) {
+        const MapSliceLayout& l = MAP_SLICE_LAYOUT[i];
+        float lon_max = l.lon_min + l.lon_span;
+        if (lon_max > 180.0f) lon_max -= 360.0f;  // Pacific wraps around
+        slices[i] = {l.name, l.label, (float)l.lon_min, lon_max, bitmaps[i], bitmap_sizes[i]};
+    }
 
     // Start with Europe/Africa slice (index 1)
     current_slice_index = 1;
@@ -54,6 +32,9 @@ UIState::UIState() {
     is_playing = false;
     station_name[0] = '\0';
     location[0] = '\0';
+    country[0] = '\0';
+    station_index = 0;
+    station_total = 0;
     status_text[0] = '\0';
     wiim_title[0] = '\0';
     wiim_artist[0] = '\0';
@@ -61,27 +42,34 @@ UIState::UIState() {
     _volume = 50;
     _paused = false;
     _sleep_timer_minutes = 0;
+    _play_progress = 0;
+    _play_running = false;
+    memset(_play_stage_ms, 0, sizeof(_play_stage_ms));
     _marker_lat = 0;
     _marker_lon = 0;
     _has_marker = false;
     _zoom_level = 1;
-    _zoom_col = 0;
-    _zoom_row = 0;
+    _view_x = 0;
+    _view_y = 0;
+    _projection.valid = false;
+
+    _snapshot_seq = 0;
+    fill_snapshot(&_snapshot);
 }
 
 void UIState::cycle_slice() {
-    current_slice_index = (current_slice_index + 1) % 4;
-    _zoom_col = 0;
-    _zoom_row = 0;
+    current_slice_index = (current_slice_index + 1) % MAP_SLICE_COUNT;
+    _view_x = 0;
+    _view_y = 0;
     Serial.printf("[UIState] Cycled to slice %d: %s\n",
                   current_slice_index,
                   slices[current_slice_index].name);
 }
 
 void UIState::cycle_slice_reverse() {
-    current_slice_index = (current_slice_index + 3) % 4;  // +3 mod 4 = -1
-    _zoom_col = 0;
-    _zoom_row = 0;
+    current_slice_index = (current_slice_index + MAP_SLICE_COUNT - 1) % MAP_SLICE_COUNT;
+    _view_x = 0;
+    _view_y = 0;
     Serial.printf("[UIState] Cycled to slice %d: %s\n",
                   current_slice_index,
                   slices[current_slice_index].name);
@@ -113,6 +101,7 @@ void UIState::set_playing(const char* station, const char* loc) {
 void UIState::set_stopped() {
     is_playing = false;
     _paused = false;
+    station_total = 0;
     status_text[0] = '\0';
     wiim_title[0] = '\0';
     wiim_artist[0] = '\0';
@@ -131,6 +120,25 @@ const char* UIState::get_location() const {
     return location;
 }
 
+void UIState::set_station_position(const char* cc, int index, int total) {
+    strncpy(country, cc, sizeof(country) - 1);
+    country[sizeof(country) - 1] = '\0';
+    station_index = index;
+    station_total = total;
+}
+
+const char* UIState::get_country() const {
+    return country;
+}
+
+int UIState::get_station_index() const {
+    return station_index;
+}
+
+int UIState::get_station_total() const {
+    return station_total;
+}
+
 void UIState::set_status_text(const char* text) {
     strncpy(status_text, text, sizeof(status_text) - 1);
     status_text[sizeof(status_text) - 1] = '\0';
@@ -188,6 +196,31 @@ int UIState::get_sleep_timer() const {
     return _sleep_timer_minutes;
 }
 
+void UIState::set_play_progress(int stages) {
+    _play_progress = stages;
+}
+
+int UIState::get_play_progress() const {
+    return _play_progress;
+}
+
+void UIState::set_play_running(bool running) {
+    if (running) memset(_play_stage_ms, 0, sizeof(_play_stage_ms));
+    _play_running = running;
+}
+
+bool UIState::is_play_running() const {
+    return _play_running;
+}
+
+void UIState::set_play_stage_ms(int stage, uint32_t ms) {
+    if (stage >= 0 && stage < UI_PLAY_STAGES) _play_stage_ms[stage] = ms ? ms : 1;
+}
+
+uint32_t UIState::get_play_stage_ms(int stage) const {
+    return stage >= 0 && stage < UI_PLAY_STAGES ? _play_stage_ms[stage] : 0;
+}
+
 void UIState::set_marker(float lat, float lon) {
     _marker_lat = lat;
     _marker_lon = lon;
@@ -233,10 +266,10 @@ int UIState::slice_index_for_lon(float lon) const {
 }
 
 void UIState::set_slice_index(int idx) {
-    if (idx >= 0 && idx < 4) {
+    if (idx >= 0 && idx < MAP_SLICE_COUNT) {
         current_slice_index = idx;
-        _zoom_col = 0;
-        _zoom_row = 0;
+        _view_x = 0;
+        _view_y = 0;
         Serial.printf("[UIState] Slice set to %d: %s\n",
                       current_slice_index, slices[current_slice_index].name);
     }
@@ -246,97 +279,81 @@ void UIState::set_slice_index(int idx) {
 // Zoom
 // ------------------------------------------------------------------
 
+void UIState::center_view(float fx, float fy) {
+    int max_x = MAP_WIDTH * (_zoom_level - 1);
+    int max_y = MAP_HEIGHT * (_zoom_level - 1);
+    _view_x = constrain((int)lroundf(fx * MAP_WIDTH * _zoom_level) - MAP_WIDTH / 2, 0, max_x);
+    _view_y = constrain((int)lroundf(fy * MAP_HEIGHT * _zoom_level) - MAP_HEIGHT / 2, 0, max_y);
+}
+
 void UIState::set_zoom_level(int level) {
     if (level < 1) level = 1;
-    if (level > 5) level = 5;
+    if (level > world_map_zoom_max()) level = world_map_zoom_max();
+    if (level == _zoom_level) return;
+
+    // Keep the middle of the view where it is
+    float fx = (_view_x + MAP_WIDTH / 2.0f) / (MAP_WIDTH * _zoom_level);
+    float fy = (_view_y + MAP_HEIGHT / 2.0f) / (MAP_HEIGHT * _zoom_level);
     _zoom_level = level;
-    _zoom_col = 0;
-    _zoom_row = 0;
-    Serial.printf("[UIState] Zoom: %dx\n", _zoom_level);
+    center_view(fx, fy);
+    BINLOG_I("[UIState] Zoom: %dx\n", _zoom_level);
 }
 
 void UIState::set_zoom_centered(int new_level, float lat, float lon) {
     if (new_level < 1) new_level = 1;
-    if (new_level > 5) new_level = 5;
+    if (new_level > world_map_zoom_max()) new_level = world_map_zoom_max();
 
     // Pick the slice containing this longitude
     current_slice_index = slice_index_for_lon(lon);
 
     if (new_level == 1) {
         _zoom_level = 1;
-        _zoom_col = 0;
-        _zoom_row = 0;
-        Serial.printf("[UIState] Zoom 1x, slice=%d\n", current_slice_index);
+        _view_x = 0;
+        _view_y = 0;
+        BINLOG_I("[UIState] Zoom 1x, slice=%d\n", current_slice_index);
         return;
     }
 
     _zoom_level = new_level;
 
-    // Find column: where does lon fall within the slice's longitude range?
+    // Where lon falls within the slice's longitude range
     const MapSlice& s = slices[current_slice_index];
     float range = s.lon_max - s.lon_min;
     if (range < 0) range += 360.0f;  // Pacific wrapping
     float lon_offset = lon - s.lon_min;
     if (lon_offset < 0) lon_offset += 360.0f;
-    _zoom_col = constrain((int)(lon_offset / range * new_level), 0, new_level - 1);
 
-    // Find row: lat mapped to rows (90° at top, -90° at bottom)
-    float norm_lat = (90.0f - lat) / 180.0f;  // 0.0 = north pole, 1.0 = south pole
-    _zoom_row = constrain((int)(norm_lat * new_level), 0, new_level - 1);
+    // Centre on it, clamped at the slice edges (90° at top, -90° at bottom)
+    center_view(lon_offset / range, (90.0f - lat) / 180.0f);
 
-    Serial.printf("[UIState] Zoom %dx centered on (%.1f, %.1f) -> slice=%d col=%d row=%d\n",
-                  _zoom_level, lat, lon, current_slice_index, _zoom_col, _zoom_row);
+    BINLOG_I("[UIState] Zoom %dx centered on (%.1f, %.1f) -> slice=%d\n",
+             _zoom_level, lat, lon, current_slice_index);
 }
 
 int UIState::get_zoom_level() const { return _zoom_level; }
-int UIState::get_zoom_col() const { return _zoom_col; }
-int UIState::get_zoom_row() const { return _zoom_row; }
+int UIState::get_view_x() const { return _view_x; }
+int UIState::get_view_y() const { return _view_y; }
 
-bool UIState::zoom_move_left() {
-    if (_zoom_level <= 1) return false;
-    if (_zoom_col > 0) {
-        _zoom_col--;
-    } else {
-        // At left edge: move to previous slice, rightmost column
-        current_slice_index = (current_slice_index + 3) % 4;
-        _zoom_col = _zoom_level - 1;
-        _zoom_row = 0;
-    }
-    Serial.printf("[UIState] Zoom pos: slice=%d col=%d row=%d\n",
-                  current_slice_index, _zoom_col, _zoom_row);
-    return true;
+MapView UIState::get_map_view() const {
+    return {(int8_t)_zoom_level, (int8_t)current_slice_index, (int16_t)_view_x, (int16_t)_view_y};
 }
 
-bool UIState::zoom_move_right() {
+bool UIState::pan_view(int dx, int dy) {
     if (_zoom_level <= 1) return false;
-    if (_zoom_col < _zoom_level - 1) {
-        _zoom_col++;
-    } else {
-        // At right edge: move to next slice, leftmost column
-        current_slice_index = (current_slice_index + 1) % 4;
-        _zoom_col = 0;
-        _zoom_row = 0;
-    }
-    Serial.printf("[UIState] Zoom pos: slice=%d col=%d row=%d\n",
-                  current_slice_index, _zoom_col, _zoom_row);
+    MapView v = get_map_view();
+    if (!world_map_pan_view(&v, dx, dy)) return false;
+    current_slice_index = v.slice;
+    _view_x = v.x;
+    _view_y = v.y;
+    BINLOG_D("[UIState] Zoom pos: slice=%d view=(%d,%d)\n",
+             current_slice_index, _view_x, _view_y);
     return true;
 }
 
-bool UIState::zoom_move_up() {
-    if (_zoom_level <= 1 || _zoom_row <= 0) return false;
-    _zoom_row--;
-    Serial.printf("[UIState] Zoom pos: slice=%d col=%d row=%d\n",
-                  current_slice_index, _zoom_col, _zoom_row);
-    return true;
-}
-
-bool UIState::zoom_move_down() {
-    if (_zoom_level <= 1 || _zoom_row >= _zoom_level - 1) return false;
-    _zoom_row++;
-    Serial.printf("[UIState] Zoom pos: slice=%d col=%d row=%d\n",
-                  current_slice_index, _zoom_col, _zoom_row);
-    return true;
-}
+bool UIState::zoom_move_left() { return pan_view(-MAP_WIDTH, 0); }
+bool UIState::zoom_move_right() { return pan_view(MAP_WIDTH, 0); }
+bool UIState::zoom_move_up() { return pan_view(0, -MAP_HEIGHT); }
+bool UIState::zoom_move_down() { return pan_view(0, MAP_HEIGHT); }
 
 float UIState::get_view_lon_min() const {
     const MapSlice& s = slices[current_slice_index];
@@ -345,8 +362,7 @@ float UIState::get_view_lon_min() const {
     float range = s.lon_max - s.lon_min;
     if (range < 0) range += 360.0f;
 
-    float sub_range = range / _zoom_level;
-    float result = s.lon_min + _zoom_col * sub_range;
+    float result = s.lon_min + range * _view_x / (MAP_WIDTH * _zoom_level);
     if (result > 180.0f) result -= 360.0f;
     return result;
 }
@@ -358,20 +374,119 @@ float UIState::get_view_lon_max() const {
     float range = s.lon_max - s.lon_min;
     if (range < 0) range += 360.0f;
 
-    float sub_range = range / _zoom_level;
-    float result = s.lon_min + (_zoom_col + 1) * sub_range;
+    float result = s.lon_min + range * (_view_x + MAP_WIDTH) / (MAP_WIDTH * _zoom_level);
     if (result > 180.0f) result -= 360.0f;
     return result;
 }
 
 float UIState::get_view_lat_max() const {
     if (_zoom_level <= 1) return 90.0f;
-    float lat_range = 180.0f / _zoom_level;
-    return 90.0f - _zoom_row * lat_range;
+    return 90.0f - 180.0f * _view_y / (MAP_HEIGHT * _zoom_level);
 }
 
 float UIState::get_view_lat_min() const {
     if (_zoom_level <= 1) return -90.0f;
-    float lat_range = 180.0f / _zoom_level;
-    return 90.0f - (_zoom_row + 1) * lat_range;
+    return 90.0f - 180.0f * (_view_y + MAP_HEIGHT) / (MAP_HEIGHT * _zoom_level);
+}
+
+// ------------------------------------------------------------------
+// View projection
+// ------------------------------------------------------------------
+
+const UIState::MapProjection& UIState::projection() const {
+    MapView v = get_map_view();
+    MapProjection& p = _projection;
+    if (p.valid && p.view.zoom == v.zoom && p.view.slice == v.slice &&
+        p.view.x == v.x && p.view.y == v.y) {
+        return p;
+    }
+
+    float lon_min = get_view_lon_min();
+    float lon_range = get_view_lon_max() - lon_min;
+    if (lon_range < 0) lon_range += 360.0f;
+    float lat_max = get_view_lat_max();
+    float lat_span = lat_max - get_view_lat_min();
+
+    // Pixel (W-1, H-1) is the view's east and south edge
+    const float px_x = MAP_WIDTH - 1, px_y = MAP_HEIGHT - 1;
+    p.lon_min_x100 = lroundf(lon_min * 100.0f);
+    p.to_geo = touch_transform_scale(lon_range * 100.0f / px_x, 0.0f,
+                                     -lat_span * 100.0f / px_y, lat_max * 100.0f);
+    p.to_map = touch_transform_scale(px_x / (lon_range * 100.0f), 0.0f,
+                                     -px_y / (lat_span * 100.0f), lat_max * px_y / lat_span);
+    p.view = v;
+    p.valid = true;
+    return p;
+}
+
+bool UIState::project(int lat_x100, int lon_x100, int* portrait_x, int* portrait_y) const {
+    const MapProjection& p = projection();
+    int dlon = lon_x100 - p.lon_min_x100;
+    if (dlon < 0) dlon += 36000;   // View crossing the antimeridian
+    int x, y;
+    touch_transform_apply(p.to_map, dlon, lat_x100, &x, &y);
+    if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT) return false;
+    *portrait_x = x;
+    *portrait_y = y;
+    return true;
+}
+
+void UIState::unproject(int portrait_x, int portrait_y, int* lat_x100, int* lon_x100) const {
+    const MapProjection& p = projection();
+    int dlon, lat;
+    touch_transform_apply(p.to_geo, portrait_x, portrait_y, &dlon, &lat);
+    int lon = p.lon_min_x100 + dlon;
+    if (lon > 18000) lon -= 36000;
+    if (lon < -18000) lon += 36000;
+    *lat_x100 = constrain(lat, -9000, 9000);
+    *lon_x100 = lon;
+}
+
+// ------------------------------------------------------------------
+// Cross-task snapshot
+// ------------------------------------------------------------------
+
+void UIState::fill_snapshot(UISnapshot* out) const {
+    memset(out, 0, sizeof(*out));   // Padding and string tails too, so snapshots compare
+    out->view_mode = _view_mode;
+    out->slice_index = current_slice_index;
+    out->zoom_level = _zoom_level;
+    out->view_x = _view_x;
+    out->view_y = _view_y;
+    out->has_marker = _has_marker;
+    out->marker_lat = _marker_lat;
+    out->marker_lon = _marker_lon;
+    out->is_playing = is_playing;
+    out->paused = _paused;
+    out->volume = _volume;
+    out->station_index = station_index;
+    out->station_total = station_total;
+    strncpy(out->station_name, station_name, sizeof(out->station_name) - 1);
+    strncpy(out->location, location, sizeof(out->location) - 1);
+    strncpy(out->country, country, sizeof(out->country) - 1);
+    strncpy(out->status_text, status_text, sizeof(out->status_text) - 1);
+    strncpy(out->wiim_title, wiim_title, sizeof(out->wiim_title) - 1);
+    strncpy(out->wiim_artist, wiim_artist, sizeof(out->wiim_artist) - 1);
+}
+
+void UIState::publish_snapshot() {
+    UISnapshot next;
+    fill_snapshot(&next);
+    if (memcmp(&next, &_snapshot, sizeof(next)) == 0) return;
+
+    _snapshot_seq = _snapshot_seq + 1;   // Odd: readers retry
+    __sync_synchronize();
+    _snapshot = next;
+    __sync_synchronize();
+    _snapshot_seq = _snapshot_seq + 1;
+}
+
+void UIState::read_snapshot(UISnapshot* out) const {
+    uint32_t seq;
+    do {
+        while ((seq = _snapshot_seq) & 1) taskYIELD();
+        __sync_synchronize();
+        memcpy(out, &_snapshot, sizeof(*out));
+        __sync_synchronize();
+    } while (_snapshot_seq != seq);
 }
@@ -2,12 +2,23 @@
  * UI State Management for RadioWall
  *
  * Manages vertical map slices, current slice selection, and playback state.
+ *
+ * UIState is written and read on the loop task. Other tasks read it
+ * through a snapshot of the fields a renderer needs (UISnapshot; slice,
+ * zoom, marker, station strings, volume). The loop publishes it once per
+ * pass under a sequence lock. A reader copies it without taking a lock,
+ * and retries if a publish ran meanwhile, so it always gets one pass's
+ * consistent state.
  */
 
 #ifndef UI_STATE_H
 #define UI_STATE_H
 
 #include <Arduino.h>
+#include "world_map.h"  // MapView
+#include "touch_calib.h"  // TouchTransform
+
+#define UI_PLAY_STAGES 4   // RADIO_STAGE_COUNT (radio_client.h)
 
 // View mode (which screen is displayed)
 enum ViewMode {
@@ -31,14 +42,38 @@ struct MapSlice {
     size_t bitmap_size;     // Size of compressed bitmap
 };
 
+// What another task may see of the UI, as of the last publish
+struct UISnapshot {
+    ViewMode view_mode;
+    int slice_index;
+    int zoom_level;
+    int view_x, view_y;
+    bool has_marker;
+    float marker_lat, marker_lon;
+    bool is_playing;
+    bool paused;
+    int volume;
+    int station_index;
+    int station_total;
+    char station_name[64];
+    char location[64];
+    char country[32];
+    char status_text[32];
+    char wiim_title[64];
+    char wiim_artist[64];
+};
+
 // UI state manager
 class UIState {
 private:
-    MapSlice slices[4];
+    MapSlice slices[MAP_SLICE_COUNT];
     int current_slice_index;
     bool is_playing;
     char station_name[64];
     char location[64];
+    char country[32];
+    int station_index;         // 1-based position in the city's list
+    int station_total;         // 0 = unknown
     char status_text[32];
     char wiim_title[64];       // Track title from WiiM getPlayerStatus
     char wiim_artist[64];      // Artist from WiiM getPlayerStatus
@@ -46,11 +81,32 @@ private:
     int _volume;
     bool _paused;
     int _sleep_timer_minutes;  // 0 = off
+    int _play_progress;        // Stages the running play reached, 0 = none running
+    bool _play_running;
+    uint32_t _play_stage_ms[UI_PLAY_STAGES];
     float _marker_lat, _marker_lon;
     bool _has_marker;
     int _zoom_level;   // 1..5
-    int _zoom_col;     // 0..(zoom-1), column within zoom grid
-    int _zoom_row;     // 0..(zoom-1), row within zoom grid
+    int _view_x;       // Zoomed view's top-left pixel in the slice (MapView)
+    int _view_y;
+
+    // Portrait <-> geographic mapping of the view it was built for
+    struct MapProjection {
+        bool valid;
+        MapView view;
+        int32_t lon_min_x100;      // View's west edge
+        TouchTransform to_geo;     // Portrait -> (lon east of lon_min, lat) x100
+        TouchTransform to_map;     // The inverse
+    };
+    mutable MapProjection _projection;
+
+    // Sequence lock: odd while a publish is copying
+    UISnapshot _snapshot;
+    volatile uint32_t _snapshot_seq;
+
+    void center_view(float fx, float fy);   // Fractions of the slice's width/height
+    void fill_snapshot(UISnapshot* out) const;
+    const MapProjection& projection() const;   // Rebuilt after a view change
 
 public:
     UIState();
@@ -68,6 +124,12 @@ public:
     const char* get_station_name() const;
     const char* get_location() const;
 
+    // Position in the city's station list, as reported by the network worker
+    void set_station_position(const char* country, int index, int total);
+    const char* get_country() const;
+    int get_station_index() const;
+    int get_station_total() const;
+
     // Temporary status text (shown on status bar line 2, cleared by set_playing/set_stopped)
     void set_status_text(const char* text);
     const char* get_status_text() const;
@@ -89,6 +151,21 @@ public:
     void set_sleep_timer(int minutes);
     int get_sleep_timer() const;
 
+    // Progress of the play being waited for: stages reached (of
+    // RADIO_STAGE_COUNT), 0 when none is running
+    void set_play_progress(int stages);
+    int get_play_progress() const;
+
+    // A play request is being waited for, from before its first stage
+    // until it is done; starting one clears the stage times
+    void set_play_running(bool running);
+    bool is_play_running() const;
+
+    // When the running play reached each stage, in ms after its request
+    // (0: not yet, or skipped)
+    void set_play_stage_ms(int stage, uint32_t ms);
+    uint32_t get_play_stage_ms(int stage) const;
+
     // Map marker (for favorites and play-from-map)
     void set_marker(float lat, float lon);
     void clear_marker();
@@ -109,10 +186,13 @@ public:
     void set_zoom_level(int level);
     void set_zoom_centered(int new_level, float lat, float lon);
     int get_zoom_level() const;
-    int get_zoom_col() const;
-    int get_zoom_row() const;
+    int get_view_x() const;
+    int get_view_y() const;
+    MapView get_map_view() const;
 
-    // Zoom navigation (returns true if position changed)
+    // Zoom navigation (returns true if position changed). pan_view moves by
+    // pixels, the zoom_move_* by one whole view.
+    bool pan_view(int dx, int dy);
     bool zoom_move_left();
     bool zoom_move_right();
     bool zoom_move_up();
@@ -123,6 +203,20 @@ public:
     float get_view_lon_max() const;
     float get_view_lat_min() const;
     float get_view_lat_max() const;
+
+    // Portrait map pixel <-> position (hundredths of a degree) in the
+    // current view. The affine map is built in Q16 fixed point the first
+    // time it's needed after the view changes, so a touch sample or a
+    // marker costs two integer multiply-adds per axis. project() returns
+    // false for a position outside the view.
+    bool project(int lat_x100, int lon_x100, int* portrait_x, int* portrait_y) const;
+    void unproject(int portrait_x, int portrait_y, int* lat_x100, int* lon_x100) const;
+
+    // Cross-task snapshot. publish_snapshot() runs on the loop task, once a
+    // pass, and writes only if something changed. read_snapshot() may be
+    // called from any task.
+    void publish_snapshot();
+    void read_snapshot(UISnapshot* out) const;
 };
 
 #endif // UI_STATE_H
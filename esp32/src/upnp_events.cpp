@@ -0,0 +1,526 @@
+/**
+ * UPnP event subscription implementation for RadioWall.
+ *
+ * One task on core 0 (next to the network worker) owns everything: the
+ * device description fetch, SUBSCRIBE / renew / UNSUBSCRIBE, and the
+ * listener that answers NOTIFY. GENA traffic is plain HTTP on the LAN and
+ * short, so it uses one-shot WiFiClient connections rather than the pool.
+ * LastChange carries an escaped XML event whose CurrentTrackMetaData is a
+ * DIDL-Lite document escaped once more; both are unescaped in place in one
+ * body buffer.
+ */
+
+#include "upnp_events.h"
+#include "config.h"
+#include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#ifndef UPNP_EVENT_PORT
+#define UPNP_EVENT_PORT 49494            // Our NOTIFY listener
+#endif
+#ifndef UPNP_DESCRIPTION_PORT
+#define UPNP_DESCRIPTION_PORT 49152      // WiiM / LinkPlay UPnP server
+#endif
+
+static const char* DESCRIPTION_PATH = "/description.xml";
+static const uint32_t TASK_STACK = 6144;
+static const UBaseType_t TASK_PRIORITY = 1;
+static const BaseType_t TASK_CORE = 0;
+static const unsigned long TASK_POLL_MS = 20;
+static const unsigned long HTTP_TIMEOUT_MS = 3000;
+static const unsigned long SUBSCRIBE_SECONDS = 1800;
+static const unsigned long RETRY_MS = 60000;       // After a failed subscribe
+static const size_t BODY_MAX = 8192;               // Description / NOTIFY body kept
+static const size_t SID_MAX = 64;
+
+struct Service {
+    const char* name;         // serviceType fragment
+    char path[96];            // eventSubURL, empty until described
+    char sid[SID_MAX];        // Empty: not subscribed
+    unsigned long renew_at;   // millis()
+};
+
+static Service _services[] = {
+    {"AVTransport", "", "", 0},
+    {"RenderingControl", "", "", 0},
+};
+
+static TaskHandle_t _task = nullptr;
+static WiFiServer* _server = nullptr;
+static char* _buf = nullptr;              // BODY_MAX + 1
+static char _device_ip[16] = "";          // Task copy of the current device
+static bool _described = false;
+static unsigned long _retry_at = 0;
+
+// Handed over from the network worker (guarded by _mux)
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static char _requested_ip[16] = "";
+static bool _device_changed = false;
+static volatile bool _active = false;
+
+// Fields pushed since upnp_events_apply() last ran (guarded by _mux)
+enum : uint8_t {
+    PUSHED_STATE = 1 << 0,
+    PUSHED_TRACK = 1 << 1,
+    PUSHED_VOLUME = 1 << 2,
+    PUSHED_MUTE = 1 << 3,
+};
+static uint8_t _pushed = 0;
+static LinkPlayStatus _pushed_status;
+
+// Latest track artwork (upnp:albumArtURI) and a count of changes to it
+static char _art_url[UPNP_ART_URL_MAX];
+static uint32_t _art_seq = 0;
+
+// ------------------------------------------------------------------
+// Text helpers
+// ------------------------------------------------------------------
+
+// Decode the five XML entities and numeric references in place
+static void xml_unescape(char* s) {
+    static const struct { const char* name; char c; } ENTITIES[] = {
+        {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}, {"&amp;", '&'},
+    };
+    char* out = s;
+    for (char* p = s; *p;) {
+        if (*p != '&') {
+            *out++ = *p++;
+            continue;
+        }
+        bool done = false;
+        for (const auto& e : ENTITIES) {
+            size_t n = strlen(e.name);
+            if (strncmp(p, e.name, n) == 0) {
+                *out++ = e.c;
+                p += n;
+                done = true;
+                break;
+            }
+        }
+        if (!done && p[1] == '#') {
+            char* end;
+            long code = (p[2] == 'x') ? strtol(p + 3, &end, 16) : strtol(p + 2, &end, 10);
+            if (*end == ';' && code > 0 && code < 0x80) {
+                *out++ = (char)code;
+                p = end + 1;
+                done = true;
+            }
+        }
+        if (!done) *out++ = *p++;
+    }
+    *out = '\0';
+}
+
+// Copy at most cap-1 bytes without cutting a UTF-8 sequence
+static void copy_text(char* out, size_t cap, const char* src, size_t len) {
+    if (len >= cap) {
+        len = cap - 1;
+        while (len > 0 && ((uint8_t)src[len] & 0xC0) == 0x80) len--;
+    }
+    memcpy(out, src, len);
+    out[len] = '\0';
+}
+
+// Value of <name ... val="..."/> in s, copied into out (false if absent)
+static bool event_value(const char* s, const char* name, char* out, size_t cap) {
+    char open[32];
+    snprintf(open, sizeof(open), "<%s ", name);
+    const char* p = strstr(s, open);
+    if (!p) return false;
+    const char* end = strchr(p, '>');
+    const char* val = strstr(p, "val=\"");
+    if (!val || (end && val > end)) return false;
+    val += 5;
+    const char* close = strchr(val, '"');
+    if (!close) return false;
+    copy_text(out, cap, val, close - val);
+    return true;
+}
+
+// Text of <tag>...</tag> in s (false if absent)
+static bool element_text(const char* s, const char* tag, char* out, size_t cap) {
+    char open[32], close[32];
+    snprintf(open, sizeof(open), "<%s", tag);
+    snprintf(close, sizeof(close), "</%s>", tag);
+    const char* p = strstr(s, open);
+    if (!p || !(p = strchr(p, '>'))) return false;
+    p++;
+    const char* end = strstr(p, close);
+    if (!end) return false;
+    copy_text(out, cap, p, end - p);
+    return true;
+}
+
+// Value of a response header ("SID: uuid:..." -> "uuid:..."), false if absent
+static bool header_value(const char* head, const char* name, char* out, size_t cap) {
+    size_t n = strlen(name);
+    for (const char* line = head; line && *line; line = strchr(line, '\n')) {
+        if (*line == '\n') line++;
+        if (strncasecmp(line, name, n) == 0 && line[n] == ':') {
+            const char* v = line + n + 1;
+            while (*v == ' ') v++;
+            size_t len = strcspn(v, "\r\n");
+            copy_text(out, cap, v, len);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------
+// Outgoing requests (description, SUBSCRIBE, UNSUBSCRIBE)
+// ------------------------------------------------------------------
+
+// Send request and read the whole response (Connection: close) into _buf.
+// Returns the status code, 0 if nothing came back.
+static int exchange(const char* request) {
+    WiFiClient client;
+    if (!client.connect(_device_ip, UPNP_DESCRIPTION_PORT, HTTP_TIMEOUT_MS)) return 0;
+    client.print(request);
+
+    size_t len = 0;
+    unsigned long deadline = millis() + HTTP_TIMEOUT_MS;
+    while (millis() < deadline && len < BODY_MAX) {
+        int avail = client.available();
+        if (avail > 0) {
+            len += client.read((uint8_t*)_buf + len, min((size_t)avail, BODY_MAX - len));
+        } else if (!client.connected()) {
+            break;
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+    }
+    client.stop();
+    _buf[len] = '\0';
+    return strncmp(_buf, "HTTP/1.", 7) == 0 ? atoi(_buf + 9) : 0;
+}
+
+// Find each service's eventSubURL in the device description
+static bool describe() {
+    char req[160];
+    snprintf(req, sizeof(req),
+             "GET %s HTTP/1.1\r\nHost: %s:%d\r\nConnection: close\r\n\r\n",
+             DESCRIPTION_PATH, _device_ip, UPNP_DESCRIPTION_PORT);
+    if (exchange(req) != 200) return false;
+
+    int found = 0;
+    for (Service& s : _services) {
+        s.path[0] = '\0';
+        char type[64];
+        snprintf(type, sizeof(type), "service:%s:", s.name);
+        const char* p = strstr(_buf, type);
+        const char* end = p ? strstr(p, "</service>") : nullptr;
+        const char* url = p ? strstr(p, "<eventSubURL>") : nullptr;
+        if (!url || (end && url > end)) continue;
+        url += 13;
+        size_t len = strcspn(url, "<");
+        if (len == 0 || len + 2 > sizeof(s.path)) continue;
+        snprintf(s.path, sizeof(s.path), "%s%.*s", url[0] == '/' ? "" : "/", (int)len, url);
+        found++;
+    }
+    return found > 0;
+}
+
+// SUBSCRIBE (or renew, if the service has a SID)
+static bool subscribe(Service& s) {
+    char req[384];
+    if (s.sid[0]) {
+        snprintf(req, sizeof(req),
+                 "SUBSCRIBE %s HTTP/1.1\r\nHOST: %s:%d\r\nSID: %s\r\n"
+                 "TIMEOUT: Second-%lu\r\nConnection: close\r\n\r\n",
+                 s.path, _device_ip, UPNP_DESCRIPTION_PORT, s.sid, SUBSCRIBE_SECONDS);
+    } else {
+        snprintf(req, sizeof(req),
+                 "SUBSCRIBE %s HTTP/1.1\r\nHOST: %s:%d\r\n"
+                 "CALLBACK: <http://%s:%d/evt>\r\nNT: upnp:event\r\n"
+                 "TIMEOUT: Second-%lu\r\nConnection: close\r\n\r\n",
+                 s.path, _device_ip, UPNP_DESCRIPTION_PORT,
+                 WiFi.localIP().toString().c_str(), UPNP_EVENT_PORT, SUBSCRIBE_SECONDS);
+    }
+    int status = exchange(req);
+    char value[SID_MAX];
+    if (status != 200 || !header_value(_buf, "SID", value, sizeof(value))) {
+        Serial.printf("[UPnP] %s: subscribe failed (%d)\n", s.name, status);
+        s.sid[0] = '\0';
+        return false;
+    }
+    strcpy(s.sid, value);
+
+    // Renew at 80% of what the device granted
+    unsigned long seconds = SUBSCRIBE_SECONDS;
+    if (header_value(_buf, "TIMEOUT", value, sizeof(value)) &&
+        strncasecmp(value, "Second-", 7) == 0 && atol(value + 7) > 0) {
+        seconds = atol(value + 7);
+    }
+    s.renew_at = millis() + seconds * 800;
+    return true;
+}
+
+static void unsubscribe_all() {
+    for (Service& s : _services) {
+        if (s.sid[0] && WiFi.isConnected()) {
+            char req[256];
+            snprintf(req, sizeof(req),
+                     "UNSUBSCRIBE %s HTTP/1.1\r\nHOST: %s:%d\r\nSID: %s\r\nConnection: close\r\n\r\n",
+                     s.path, _device_ip, UPNP_DESCRIPTION_PORT, s.sid);
+            exchange(req);
+        }
+        s.sid[0] = '\0';
+    }
+    _active = false;
+}
+
+static void manage_subscriptions() {
+    if (!_device_ip[0]) return;
+    if (!WiFi.isConnected()) {
+        for (Service& s : _services) s.sid[0] = '\0';
+        _active = false;
+        return;
+    }
+    if ((long)(millis() - _retry_at) < 0) return;
+
+    if (!_described && !(_described = describe())) {
+        Serial.printf("[UPnP] %s: no event services, polling only\n", _device_ip);
+        _retry_at = millis() + RETRY_MS;
+        return;
+    }
+
+    bool any = false;
+    bool failed = false;
+    for (Service& s : _services) {
+        if (!s.path[0]) continue;
+        if (!s.sid[0] || (long)(millis() - s.renew_at) >= 0) {
+            bool renew = s.sid[0] != '\0';
+            // A rejected renew (device rebooted) gets a fresh subscription
+            if (!subscribe(s) && renew) subscribe(s);
+            if (s.sid[0] && !renew) Serial.printf("[UPnP] Subscribed to %s\n", s.name);
+        }
+        any |= s.sid[0] != '\0';
+        failed |= s.sid[0] == '\0';
+    }
+    _active = any;
+    if (failed) {
+        _described = false;   // eventSubURLs may have moved
+        _retry_at = millis() + RETRY_MS;
+    }
+}
+
+// ------------------------------------------------------------------
+// NOTIFY listener
+// ------------------------------------------------------------------
+
+// Fold one LastChange event (already unescaped once) into _pushed_status
+static void apply_event(char* event) {
+    LinkPlayStatus st;
+    memset(&st, 0, sizeof(st));
+    uint8_t fields = 0;
+    char val[24];
+
+    if (event_value(event, "TransportState", val, sizeof(val))) {
+        const char* state = strcmp(val, "PLAYING") == 0          ? "play"
+                          : strcmp(val, "PAUSED_PLAYBACK") == 0  ? "pause"
+                          : strcmp(val, "TRANSITIONING") == 0    ? "load"
+                                                                 : "stop";
+        strncpy(st.state, state, sizeof(st.state) - 1);
+        fields |= PUSHED_STATE;
+    }
+    if (event_value(event, "Volume", val, sizeof(val))) {
+        st.volume = constrain(atoi(val), 0, 100);
+        fields |= PUSHED_VOLUME;
+    }
+    if (event_value(event, "Mute", val, sizeof(val))) {
+        st.mute = atoi(val) != 0;
+        fields |= PUSHED_MUTE;
+    }
+
+    // DIDL-Lite, escaped a second time inside the val attribute
+    char* meta = strstr(event, "<CurrentTrackMetaData ");
+    meta = meta ? strstr(meta, "val=\"") : nullptr;
+    char* meta_end = meta ? strchr(meta + 5, '"') : nullptr;
+    if (meta_end) {
+        meta += 5;
+        *meta_end = '\0';
+        xml_unescape(meta);
+        if (strncmp(meta, "<DIDL", 5) == 0) {
+            element_text(meta, "dc:title", st.title, sizeof(st.title));
+            char art[UPNP_ART_URL_MAX];
+            if (element_text(meta, "upnp:albumArtURI", art, sizeof(art))) {
+                xml_unescape(art);
+                portENTER_CRITICAL(&_mux);
+                if (strcmp(art, _art_url) != 0) {
+                    memcpy(_art_url, art, sizeof(art));
+                    _art_seq++;
+                }
+                portEXIT_CRITICAL(&_mux);
+            }
+            if (!element_text(meta, "upnp:artist", st.artist, sizeof(st.artist))) {
+                element_text(meta, "dc:creator", st.artist, sizeof(st.artist));
+            }
+            xml_unescape(st.title);
+            xml_unescape(st.artist);
+            fields |= PUSHED_TRACK;
+        }
+    }
+    if (!fields) return;
+
+    portENTER_CRITICAL(&_mux);
+    if (fields & PUSHED_STATE) memcpy(_pushed_status.state, st.state, sizeof(st.state));
+    if (fields & PUSHED_TRACK) {
+        memcpy(_pushed_status.title, st.title, sizeof(st.title));
+        memcpy(_pushed_status.artist, st.artist, sizeof(st.artist));
+    }
+    if (fields & PUSHED_VOLUME) _pushed_status.volume = st.volume;
+    if (fields & PUSHED_MUTE) _pushed_status.mute = st.mute;
+    _pushed |= fields;
+    portEXIT_CRITICAL(&_mux);
+}
+
+static bool own_sid(const char* sid) {
+    for (const Service& s : _services) {
+        if (s.sid[0] && strcmp(s.sid, sid) == 0) return true;
+    }
+    return false;
+}
+
+static void handle_notify(WiFiClient& client) {
+    // Head: request line and headers up to the blank line
+    char line[160];
+    char sid[SID_MAX] = "";
+    long content_length = -1;
+    bool is_notify = false;
+    bool first = true;
+    client.setTimeout(HTTP_TIMEOUT_MS / 1000);
+    for (;;) {
+        size_t n = client.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[n] = '\0';
+        if (n > 0 && line[n - 1] == '\r') line[--n] = '\0';
+        if (n == 0) break;
+        if (first) {
+            is_notify = strncmp(line, "NOTIFY ", 7) == 0;
+            first = false;
+        } else if (strncasecmp(line, "SID:", 4) == 0) {
+            header_value(line, "SID", sid, sizeof(sid));
+        } else if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_length = atol(line + 15);
+        }
+    }
+
+    size_t len = 0;
+    if (content_length > 0) {
+        size_t want = min((size_t)content_length, BODY_MAX);
+        len = client.readBytes(_buf, want);
+        // Skip what doesn't fit; the events we use come early
+        for (long rest = content_length - (long)len; rest > 0 && client.read() >= 0; rest--) {}
+    }
+    _buf[len] = '\0';
+
+    bool ours = is_notify && own_sid(sid);
+    client.print(ours ? "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+                      : "HTTP/1.1 412 Precondition Failed\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    client.stop();
+    if (!ours) return;
+
+    // Each <LastChange> holds one escaped event document
+    for (char* p = _buf; (p = strstr(p, "<LastChange>")) != nullptr;) {
+        p += 12;
+        char* end = strstr(p, "</LastChange>");
+        if (!end) break;
+        *end = '\0';
+        xml_unescape(p);
+        apply_event(p);
+        p = end + 1;
+    }
+}
+
+static void events_task(void*) {
+    for (;;) {
+        char ip[16];
+        bool changed = false;
+        portENTER_CRITICAL(&_mux);
+        if (_device_changed) {
+            memcpy(ip, _requested_ip, sizeof(ip));
+            _device_changed = false;
+            changed = true;
+        }
+        portEXIT_CRITICAL(&_mux);
+
+        if (changed) {
+            unsubscribe_all();
+            strcpy(_device_ip, ip);
+            _described = false;
+            _retry_at = millis();
+        }
+
+        WiFiClient client = _server->available();
+        if (client) handle_notify(client);
+
+        manage_subscriptions();
+        vTaskDelay(pdMS_TO_TICKS(TASK_POLL_MS));
+    }
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void upnp_events_start() {
+    if (_task) return;
+
+    _buf = (char*)(psramFound() ? ps_malloc(BODY_MAX + 1) : malloc(BODY_MAX + 1));
+    if (!_buf) {
+        Serial.println("[UPnP] No memory for the event buffer");
+        return;
+    }
+    _server = new WiFiServer(UPNP_EVENT_PORT);
+    _server->begin();
+
+    if (xTaskCreatePinnedToCore(events_task, "upnp_events", TASK_STACK, nullptr,
+                                TASK_PRIORITY, &_task, TASK_CORE) != pdPASS) {
+        Serial.println("[UPnP] Failed to start event task");
+        delete _server;
+        _server = nullptr;
+        free(_buf);
+        _buf = nullptr;
+        _task = nullptr;
+        return;
+    }
+    Serial.printf("[UPnP] Event listener on port %d\n", UPNP_EVENT_PORT);
+}
+
+void upnp_events_set_device(const char* ip) {
+    portENTER_CRITICAL(&_mux);
+    strncpy(_requested_ip, ip ? ip : "", sizeof(_requested_ip) - 1);
+    _requested_ip[sizeof(_requested_ip) - 1] = '\0';
+    _device_changed = true;
+    _pushed = 0;
+    portEXIT_CRITICAL(&_mux);
+}
+
+bool upnp_events_active() {
+    return _active;
+}
+
+uint32_t upnp_events_art_url(char* out, size_t cap) {
+    portENTER_CRITICAL(&_mux);
+    strncpy(out, _art_url, cap - 1);
+    out[cap - 1] = '\0';
+    uint32_t seq = _art_seq;
+    portEXIT_CRITICAL(&_mux);
+    return seq;
+}
+
+bool upnp_events_apply(LinkPlayStatus* st) {
+    portENTER_CRITICAL(&_mux);
+    uint8_t fields = _pushed;
+    if (fields & PUSHED_STATE) memcpy(st->state, _pushed_status.state, sizeof(st->state));
+    if (fields & PUSHED_TRACK) {
+        memcpy(st->title, _pushed_status.title, sizeof(st->title));
+        memcpy(st->artist, _pushed_status.artist, sizeof(st->artist));
+    }
+    if (fields & PUSHED_VOLUME) st->volume = _pushed_status.volume;
+    if (fields & PUSHED_MUTE) st->mute = _pushed_status.mute;
+    _pushed = 0;
+    portEXIT_CRITICAL(&_mux);
+    return fields != 0;
+}
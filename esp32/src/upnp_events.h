@@ -0,0 +1,38 @@
+/**
+ * UPnP event subscriptions for RadioWall.
+ *
+ * WiiM / LinkPlay renderers publish AVTransport and RenderingControl state
+ * over GENA: a SUBSCRIBE names a callback URL, and from then on the device
+ * sends NOTIFY requests with LastChange whenever the transport state,
+ * track metadata, volume or mute changes. A small listener task receives
+ * them and keeps what changed, and the network worker folds that into its
+ * player status. Polling continues at a slow rate as a fallback (and at
+ * the normal rate whenever no subscription is active).
+ */
+
+#ifndef UPNP_EVENTS_H
+#define UPNP_EVENTS_H
+
+#include <Arduino.h>
+#include "linkplay_client.h"
+
+// Start the listener task (once WiFi is up; later calls do nothing)
+void upnp_events_start();
+
+// Subscribe to this renderer, dropping any previous subscription.
+// ip may be empty (no device).
+void upnp_events_set_device(const char* ip);
+
+// True while at least one service subscription is live
+bool upnp_events_active();
+
+// Overlay the fields pushed since the last call onto st. Returns true if
+// anything arrived.
+bool upnp_events_apply(LinkPlayStatus* st);
+
+// Artwork URL of the current track, if its metadata names one (any task).
+// Returns a count that goes up each time the URL changes.
+static const size_t UPNP_ART_URL_MAX = 192;
+uint32_t upnp_events_art_url(char* out, size_t cap);
+
+#endif // UPNP_EVENTS_H
@@ -1,87 +1,1078 @@
 /**
  * USB Host HID touch panel reading for RadioWall.
  *
- * Reads touch coordinates from a USB capacitive touch panel connected
- * via USB-C OTG. The touch panel appears as a standard HID device.
+ * The USB Host library's events run in one task; each panel slot is a
+ * host client with a task of its own. Everything device-related (open,
+ * descriptor fetch, interrupt transfers, teardown) happens in the slot's
+ * client task, inside usb_host_client_handle_events(), so a slot's device
+ * state needs no locking, and a busy panel never delays another's reports.
  *
- * NOTE: ESP32-S3 USB Host support is still maturing. This uses the
- * esp_tinyusb library. You may need to adjust the HID report parsing
- * based on your specific touch controller (GT911, Goodix, etc.).
+ * Every client hears of every new device. A free slot opens it and tries
+ * to claim its HID interface; the claim is exclusive, so when two free
+ * slots race for one device the loser closes it and waits for the next.
+ *
+ * On connect the first HID interface with an interrupt-IN endpoint is
+ * claimed and its report descriptor parsed for a Touch Screen application
+ * collection: per-finger Tip Switch / X / Y fields and the optional
+ * Contact Count. If the panel has an Input Mode feature it is switched
+ * to multi-touch (some panels start out as a mouse). Every completed
+ * interrupt transfer is decoded into a TouchSample and pushed into the
+ * slot's ring before the transfer is resubmitted, so a report reaches the
+ * loop as soon as it arrives; usb_touch_task() merges the rings.
+ *
+ * Panel units go to map coordinates through one fixed-point transform:
+ * the descriptor's logical range scaled to TOUCH_MIN/MAX, followed by the
+ * panel's calibration, which takes it onto its tile. A panel without one
+ * is scaled onto its tile as it is. The loop task hands a new calibration
+ * to the client task through _cal_mux; it is composed in on the next report.
+ *
+ * Parallel reports (all contacts in each report) are decoded fully. For a
+ * hybrid panel (one contact per report) the follow-up reports of a frame
+ * are skipped, which keeps the first contact.
  */
 
 #include "usb_touch.h"
-#include "config.h"
+#include "fnv1a.h"
+#include "touch_ring.h"
+#include "touch_calib.h"
+#include "event_bus.h"
+#include "serial_cmd.h"
+#include "settings.h"
+#include "state_store.h"
+#include "persist.h"
+#include <Wire.h>
+#include <usb/usb_host.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// SY6970 PMU (I2C) supplies VBUS to the panel in OTG mode
+#define PMU_SDA 15
+#define PMU_SCL 10
+#define PMU_I2C_ADDR 0x6A
+#define PMU_REG_CONFIG 0x03
+#define PMU_OTG_CONFIG 0x20       // REG03 bit 5: boost (OTG) enable
+
+static const uint32_t USB_TASK_STACK = 4096;
+static const UBaseType_t USB_TASK_PRIORITY = 3;   // Above the loop task (1)
+static const BaseType_t USB_TASK_CORE = 1;        // As the built-in touch reader
+static const int USB_TOUCH_MAX_CONTACTS = 2;      // Points a TouchSample carries
+static const int TAP_SLOP = 20;                   // Map units a tap may move
+static const int CAL_INSET = 40;                  // Calibration targets, from the tile edges
+static const int PENDING_MAX = 4;                 // New devices a slot has yet to try
+static const int PANELS = USB_TOUCH_TILES_X * USB_TOUCH_TILES_Y;   // One slot per tile
+static_assert(PANELS >= 1 && PANELS <= USB_TOUCH_MAX_PANELS, "USB_TOUCH_TILES_X * _Y out of range");
+
+// HID class
+#define USB_CLASS_HID_CODE   0x03
+#define HID_DESC_TYPE_HID    0x21
+#define HID_DESC_TYPE_REPORT 0x22
+#define HID_REQ_SET_REPORT   0x09
+#define HID_REPORT_FEATURE   0x03
+
+// Usages (page << 16 | id)
+#define USAGE_GD_X             0x00010030
+#define USAGE_GD_Y             0x00010031
+#define USAGE_DIG_TOUCH_SCREEN 0x000D0004
+#define USAGE_DIG_DEVICE_CONF  0x000D000E
+#define USAGE_DIG_FINGER       0x000D0022
+#define USAGE_DIG_TIP_SWITCH   0x000D0042
+#define USAGE_DIG_INPUT_MODE   0x000D0052
+#define USAGE_DIG_CONTACT_CNT  0x000D0054
+#define INPUT_MODE_MULTI_TOUCH 0x02
+
+// One report field as described by the report descriptor
+struct HidField {
+    bool valid;
+    uint8_t report_id;
+    uint16_t bit_offset;     // After the report ID byte, if any
+    uint8_t bit_size;
+    int32_t logical_min;
+    int32_t logical_max;
+};
+
+struct HidContact {
+    HidField tip;
+    HidField x;
+    HidField y;
+};
+
+struct HidTouchLayout {
+    bool has_report_ids;
+    uint8_t report_id;       // Report carrying the contacts
+    int contacts;            // Finger collections found (<= USB_TOUCH_MAX_CONTACTS)
+    HidContact contact[USB_TOUCH_MAX_CONTACTS];
+    HidField contact_count;
+    HidField input_mode;
+    uint16_t input_mode_report_bits;
+};
+
+// One panel slot
+struct UsbPanel {
+    uint8_t index;
+
+    // Device (client task)
+    usb_host_client_handle_t client;
+    usb_device_handle_t device;
+    volatile uint8_t address;         // Device held, 0 = none (read by other slots)
+    int interface;
+    uint8_t in_ep;
+    uint16_t in_mps;
+    usb_transfer_t* ctrl_xfer;
+    usb_transfer_t* in_xfer;
+    bool closing;                     // Device gone, waiting for transfers
+    uint8_t pending[PENDING_MAX];     // NEW_DEV seen, tried in the task loop
+    int pending_count;
+    HidTouchLayout layout;
+
+    // Producer (client task)
+    bool finger_down;
+    TouchTransform panel_xform;       // Logical units -> map coordinates
+    TouchTransform xform;             // calibration after panel_xform
+    volatile uint32_t reports;
+    volatile uint32_t dropped;
+
+    // Under _cal_mux (client task binds, loop task calibrates)
+    bool ready;                       // Reporting: panel_id and tile are set
+    uint32_t panel_id;
+    int tile;
+    TouchTransform calibration;       // Map coordinates -> map coordinates
+    volatile bool cal_changed;
 
-#include <USB.h>
-#include <USBHIDMouse.h>
+    // Consumer (loop task)
+    bool tap_active;
+    int tap_start_x, tap_start_y;
+    int tap_x, tap_y;
+};
 
-static TouchCallback _touch_callback = nullptr;
 static unsigned long _last_touch_ms = 0;
 static bool _initialized = false;
 
-// HID report buffer
-static uint8_t _report_buf[64];
+static UsbPanel _panels[PANELS];
+static TouchRing _rings[PANELS];              // Ring i is panel i's
+static portMUX_TYPE _cal_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Saved tile and calibration per panel. Loaded before the client tasks
+// start, then changed by the loop task under _cal_mux.
+struct PanelCal {
+    uint32_t panel_id;                // 0: any panel (calibration from older firmware)
+    uint8_t tile;
+    uint8_t reserved[3];
+    TouchTransform cal;
+};
+
+struct PanelRecord {
+    uint16_t count;
+    uint16_t reserved;
+    PanelCal entries[USB_TOUCH_MAX_PANELS];
+};
+static PanelRecord _record;
+
+// Calibration (loop task)
+static int _cal_tile = -1;                    // Tile being calibrated, -1 when not
+static int _cal_step = 0;                     // Corner being touched
+static int _cal_panel = -1;                   // Panel giving this tile's taps
+static uint8_t _cal_done = 0;                 // Panels bound in this run (bit per slot)
+static int _cal_touched[TOUCH_CALIB_POINTS][2];
+
+// ------------------------------------------------------------------
+// Report descriptor parser
+// ------------------------------------------------------------------
+
+struct HidGlobals {
+    uint16_t usage_page;
+    int32_t logical_min;
+    int32_t logical_max;
+    uint32_t report_size;
+    uint32_t report_count;
+    uint8_t report_id;
+};
+
+static HidField make_field(const HidGlobals& g, uint16_t bit_offset) {
+    HidField f;
+    f.valid = true;
+    f.report_id = g.report_id;
+    f.bit_offset = bit_offset;
+    f.bit_size = (uint8_t)min<uint32_t>(g.report_size, 32);
+    f.logical_min = g.logical_min;
+    f.logical_max = g.logical_max;
+    return f;
+}
+
+/**
+ * Walk the report descriptor items and record where the touch fields
+ * live. Returns false if there is no usable finger (Tip Switch, X, Y).
+ */
+static bool parse_report_descriptor(const uint8_t* desc, size_t len, HidTouchLayout* out) {
+    static const int MAX_USAGES = 16;
+    static const int MAX_DEPTH = 8;
+    static const int MAX_PUSH = 4;
+
+    memset(out, 0, sizeof(*out));
+    static uint16_t input_bits[256];
+    static uint16_t feature_bits[256];
+    memset(input_bits, 0, sizeof(input_bits));
+    memset(feature_bits, 0, sizeof(feature_bits));
+
+    HidGlobals g;
+    memset(&g, 0, sizeof(g));
+    HidGlobals stack[MAX_PUSH];
+    int stack_depth = 0;
+
+    uint32_t usages[MAX_USAGES];
+    int n_usages = 0;
+    uint32_t usage_min = 0, usage_max = 0;
+    bool has_range = false;
+
+    // Collection nesting: depth at which each interesting collection opened
+    int depth = 0;
+    int touch_depth = -1, finger_depth = -1, config_depth = -1;
+    int finger = -1;
+
+    size_t i = 0;
+    while (i < len) {
+        uint8_t prefix = desc[i++];
+        if (prefix == 0xFE) {                     // Long item: skip
+            if (i + 1 >= len) break;
+            i += 2 + desc[i];
+            continue;
+        }
+        int size = prefix & 0x03;
+        if (size == 3) size = 4;
+        int type = (prefix >> 2) & 0x03;
+        int tag = prefix >> 4;
+        if (i + size > len) break;
+
+        uint32_t value = 0;
+        for (int b = 0; b < size; b++) value |= (uint32_t)desc[i + b] << (8 * b);
+        int32_t svalue = (int32_t)value;
+        if (size == 1) svalue = (int8_t)value;
+        else if (size == 2) svalue = (int16_t)value;
+        i += size;
+
+        // Usages without a page of their own take the current Usage Page
+        uint32_t full_usage = (size == 4) ? value : ((uint32_t)g.usage_page << 16) | value;
+
+        if (type == 1) {                          // Global
+            switch (tag) {
+                case 0x0: g.usage_page = value; break;
+                case 0x1: g.logical_min = svalue; break;
+                case 0x2: g.logical_max = (g.logical_min < 0) ? svalue : (int32_t)value; break;
+                case 0x7: g.report_size = value; break;
+                case 0x8: g.report_id = value; out->has_report_ids = true; break;
+                case 0x9: g.report_count = value; break;
+                case 0xA: if (stack_depth < MAX_PUSH) stack[stack_depth++] = g; break;
+                case 0xB: if (stack_depth > 0) g = stack[--stack_depth]; break;
+            }
+            continue;
+        }
+
+        if (type == 2) {                          // Local
+            switch (tag) {
+                case 0x0: if (n_usages < MAX_USAGES) usages[n_usages++] = full_usage; break;
+                case 0x1: usage_min = full_usage; has_range = true; break;
+                case 0x2: usage_max = full_usage; has_range = true; break;
+            }
+            continue;
+        }
+
+        if (type != 0) continue;                  // Reserved
+
+        uint32_t first_usage = n_usages ? usages[0] : (has_range ? usage_min : 0);
+        switch (tag) {
+            case 0xA:                             // Collection
+                depth++;
+                if (first_usage == USAGE_DIG_TOUCH_SCREEN && touch_depth < 0) {
+                    touch_depth = depth;
+                } else if (first_usage == USAGE_DIG_FINGER && touch_depth >= 0 && finger_depth < 0) {
+                    finger_depth = depth;
+                    finger = (out->contacts < USB_TOUCH_MAX_CONTACTS) ? out->contacts++ : -1;
+                } else if (first_usage == USAGE_DIG_DEVICE_CONF && config_depth < 0) {
+                    config_depth = depth;
+                }
+                break;
+
+            case 0xC:                             // End Collection
+                if (depth == finger_depth) { finger_depth = -1; finger = -1; }
+                if (depth == touch_depth) touch_depth = -1;
+                if (depth == config_depth) config_depth = -1;
+                if (depth > 0) depth--;
+                break;
+
+            case 0x8:                             // Input
+            case 0xB: {                           // Feature
+                uint16_t* bits = (tag == 0x8) ? &input_bits[g.report_id] : &feature_bits[g.report_id];
+                bool constant = value & 0x01;
+                for (uint32_t k = 0; k < g.report_count && !constant; k++) {
+                    uint32_t usage;
+                    if (k < (uint32_t)n_usages) usage = usages[k];
+                    else if (has_range) usage = min(usage_min + k, usage_max);
+                    else usage = n_usages ? usages[n_usages - 1] : 0;
+                    HidField f = make_field(g, *bits + k * g.report_size);
+
+                    if (tag == 0xB) {
+                        if (usage == USAGE_DIG_INPUT_MODE && config_depth >= 0) out->input_mode = f;
+                        continue;
+                    }
+                    if (touch_depth < 0) continue;
+                    if (usage == USAGE_DIG_CONTACT_CNT) {
+                        out->contact_count = f;
+                    } else if (finger >= 0) {
+                        HidContact& c = out->contact[finger];
+                        if (usage == USAGE_DIG_TIP_SWITCH) c.tip = f;
+                        else if (usage == USAGE_GD_X) c.x = f;
+                        else if (usage == USAGE_GD_Y) c.y = f;
+                    }
+                }
+                *bits += g.report_size * g.report_count;
+                break;
+            }
+        }
+
+        // Locals only apply to the next main item
+        n_usages = 0;
+        has_range = false;
+    }
+
+    if (out->input_mode.valid) {
+        out->input_mode_report_bits = feature_bits[out->input_mode.report_id];
+    }
+    const HidContact& first = out->contact[0];
+    if (out->contacts == 0 || !first.tip.valid || !first.x.valid || !first.y.valid) {
+        return false;
+    }
+    out->report_id = first.tip.report_id;
+    return true;
+}
+
+static uint32_t field_value(const HidField& f, const uint8_t* data, size_t len) {
+    uint32_t v = 0;
+    for (int b = 0; b < f.bit_size; b++) {
+        uint32_t bit = f.bit_offset + b;
+        if (bit / 8 >= len) break;
+        v |= (uint32_t)((data[bit / 8] >> (bit % 8)) & 1) << b;
+    }
+    return v;
+}
+
+// ------------------------------------------------------------------
+// Tiles and calibration handoff
+// ------------------------------------------------------------------
+
+static void tile_rect(int tile, int* x0, int* y0, int* x1, int* y1) {
+    int col = tile % USB_TOUCH_TILES_X;
+    int row = tile / USB_TOUCH_TILES_X;
+    *x0 = TOUCH_MIN_X + (TOUCH_MAX_X - TOUCH_MIN_X) * col / USB_TOUCH_TILES_X;
+    *x1 = TOUCH_MIN_X + (TOUCH_MAX_X - TOUCH_MIN_X) * (col + 1) / USB_TOUCH_TILES_X;
+    *y0 = TOUCH_MIN_Y + (TOUCH_MAX_Y - TOUCH_MIN_Y) * row / USB_TOUCH_TILES_Y;
+    *y1 = TOUCH_MIN_Y + (TOUCH_MAX_Y - TOUCH_MIN_Y) * (row + 1) / USB_TOUCH_TILES_Y;
+}
+
+// An uncalibrated panel: the whole map scaled onto its tile
+static TouchTransform tile_default(int tile) {
+    int x0, y0, x1, y1;
+    tile_rect(tile, &x0, &y0, &x1, &y1);
+    float sx = (float)(x1 - x0) / (TOUCH_MAX_X - TOUCH_MIN_X);
+    float sy = (float)(y1 - y0) / (TOUCH_MAX_Y - TOUCH_MIN_Y);
+    return touch_transform_scale(sx, x0 - TOUCH_MIN_X * sx, sy, y0 - TOUCH_MIN_Y * sy);
+}
+
+static void set_calibration(UsbPanel& p, const TouchTransform& cal) {
+    portENTER_CRITICAL(&_cal_mux);
+    p.calibration = cal;
+    p.cal_changed = true;
+    portEXIT_CRITICAL(&_cal_mux);
+}
+
+// Saved entry for a panel, nullptr if none. Under _cal_mux.
+static PanelCal* find_entry(uint32_t panel_id) {
+    for (int i = 0; i < _record.count; i++) {
+        if (_record.entries[i].panel_id == panel_id) return &_record.entries[i];
+    }
+    return nullptr;
+}
+
+static bool tile_taken(int tile, const UsbPanel* except) {
+    for (const UsbPanel& p : _panels) {
+        if (&p != except && p.ready && p.tile == tile) return true;
+    }
+    return false;
+}
+
+// A panel started reporting: its saved tile and calibration, else the
+// first free tile as it is (client task)
+static void bind_panel(UsbPanel& p) {
+    portENTER_CRITICAL(&_cal_mux);
+    PanelCal* e = find_entry(p.panel_id);
+    if (!e || e->tile >= PANELS || tile_taken(e->tile, &p)) e = find_entry(0);
+    if (e && (e->tile >= PANELS || tile_taken(e->tile, &p))) e = nullptr;
+    if (e) {
+        p.tile = e->tile;
+        p.calibration = e->cal;
+    } else {
+        p.tile = 0;
+        while (p.tile < PANELS - 1 && tile_taken(p.tile, &p)) p.tile++;
+        p.calibration = tile_default(p.tile);
+    }
+    p.cal_changed = true;
+    p.ready = true;
+    portEXIT_CRITICAL(&_cal_mux);
+    Serial.printf("[Touch] Panel %d (%08lx): tile %d, %s\n", p.index,
+                  (unsigned long)p.panel_id, p.tile, e ? "calibrated" : "not calibrated");
+}
+
+static bool save_panels() {
+    PanelRecord rec;
+    portENTER_CRITICAL(&_cal_mux);
+    rec = _record;
+    portEXIT_CRITICAL(&_cal_mux);
+    return state_store_put(STATE_KEY_TOUCH_PANELS, &rec, sizeof(rec));
+}
+
+static void load_panels() {
+    if (state_store_get(STATE_KEY_TOUCH_PANELS, &_record, sizeof(_record)) == (int)sizeof(_record)) {
+        _record.count = min<int>(_record.count, USB_TOUCH_MAX_PANELS);
+        Serial.printf("[Touch] %d calibrated panel(s)\n", _record.count);
+        return;
+    }
+    // Older firmware kept a single panel's fit with the settings
+    memset(&_record, 0, sizeof(_record));
+    TouchTransform cal;
+    if (settings_get_touch_calibration(&cal)) {
+        _record.count = 1;
+        _record.entries[0].cal = cal;
+        Serial.println("[Touch] Using saved calibration");
+    }
+}
+
+// ------------------------------------------------------------------
+// Report decoding (client task)
+// ------------------------------------------------------------------
+
+// Logical range of the first contact's X/Y onto TOUCH_MIN..TOUCH_MAX
+static void build_panel_transform(UsbPanel& p) {
+    const HidField& fx = p.layout.contact[0].x;
+    const HidField& fy = p.layout.contact[0].y;
+    float span_x = max<int32_t>(fx.logical_max - fx.logical_min, 1);
+    float span_y = max<int32_t>(fy.logical_max - fy.logical_min, 1);
+    float sx = (TOUCH_MAX_X - TOUCH_MIN_X) / span_x;
+    float sy = (TOUCH_MAX_Y - TOUCH_MIN_Y) / span_y;
+    p.panel_xform = touch_transform_scale(sx, TOUCH_MIN_X - fx.logical_min * sx,
+                                          sy, TOUCH_MIN_Y - fy.logical_min * sy);
+    p.cal_changed = true;
+}
+
+static void update_transform(UsbPanel& p) {
+    portENTER_CRITICAL(&_cal_mux);
+    TouchTransform cal = p.calibration;
+    p.cal_changed = false;
+    portEXIT_CRITICAL(&_cal_mux);
+    p.xform = touch_transform_compose(cal, p.panel_xform);
+}
+
+static void to_map(const UsbPanel& p, const HidContact& c, const uint8_t* data, size_t len,
+                   uint16_t* out_x, uint16_t* out_y) {
+    int x, y;
+    touch_transform_apply(p.xform, field_value(c.x, data, len), field_value(c.y, data, len),
+                          &x, &y);
+    *out_x = constrain(x, TOUCH_MIN_X, TOUCH_MAX_X - 1);
+    *out_y = constrain(y, TOUCH_MIN_Y, TOUCH_MAX_Y - 1);
+}
+
+static void handle_report(UsbPanel& p, const uint8_t* data, size_t len) {
+    if (p.cal_changed) update_transform(p);
+    const HidTouchLayout& layout = p.layout;
+
+    if (layout.has_report_ids) {
+        if (len < 1 || data[0] != layout.report_id) return;
+        data++;
+        len--;
+    }
+    p.reports++;
+
+    // Hybrid mode: only the first report of a frame has the contact count
+    if (layout.contact_count.valid &&
+        field_value(layout.contact_count, data, len) == 0 && p.finger_down) {
+        bool any_tip = false;
+        for (int i = 0; i < layout.contacts; i++) {
+            if (layout.contact[i].tip.valid && field_value(layout.contact[i].tip, data, len)) {
+                any_tip = true;
+            }
+        }
+        if (any_tip) return;
+    }
+
+    TouchSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.ms = millis();
+    sample.source = p.index;
+    for (int i = 0; i < layout.contacts; i++) {
+        const HidContact& c = layout.contact[i];
+        if (!c.tip.valid || !c.x.valid || !c.y.valid) continue;
+        if (!field_value(c.tip, data, len)) continue;
+        uint16_t x, y;
+        to_map(p, c, data, len, &x, &y);
+        if (sample.fingers == 0) {
+            sample.x = x;
+            sample.y = y;
+        } else {
+            sample.x2 = x;
+            sample.y2 = y;
+        }
+        sample.fingers++;
+    }
+
+    bool lift = sample.fingers == 0;
+    if (lift && !p.finger_down) return;     // Idle report
+    sample.event = lift ? 1 : (p.finger_down ? 2 : 0);
+
+    bool is_move = p.finger_down && !lift;
+    if (touch_ring_push_to(_rings[p.index], sample, is_move)) {
+        p.finger_down = !lift;
+    } else if (is_move) {
+        p.dropped++;
+    } else {
+        Serial.printf("[Touch] Panel %d: sample ring full, %s lost\n", p.index,
+                      lift ? "lift" : "press");
+    }
+}
+
+// ------------------------------------------------------------------
+// Device lifecycle (client task)
+// ------------------------------------------------------------------
+
+static void close_device(UsbPanel& p) {
+    if (p.ctrl_xfer || p.in_xfer) return;   // Freed from their callbacks first
+    if (p.interface >= 0) usb_host_interface_release(p.client, p.device, p.interface);
+    if (p.device) usb_host_device_close(p.client, p.device);
+    bool was_ready = p.ready;
+    portENTER_CRITICAL(&_cal_mux);
+    p.ready = false;
+    portEXIT_CRITICAL(&_cal_mux);
+    p.device = nullptr;
+    p.address = 0;
+    p.interface = -1;
+    p.closing = false;
+    p.finger_down = false;
+    if (was_ready) Serial.printf("[Touch] USB panel %d closed\n", p.index);
+}
+
+static void in_transfer_cb(usb_transfer_t* xfer) {
+    UsbPanel& p = *(UsbPanel*)xfer->context;
+    if (xfer->status == USB_TRANSFER_STATUS_COMPLETED) {
+        handle_report(p, xfer->data_buffer, xfer->actual_num_bytes);
+    }
+    if (!p.closing && (xfer->status == USB_TRANSFER_STATUS_COMPLETED ||
+                       xfer->status == USB_TRANSFER_STATUS_TIMED_OUT)) {
+        if (usb_host_transfer_submit(xfer) == ESP_OK) return;
+        Serial.println("[Touch] Interrupt transfer resubmit failed");
+    }
+    usb_host_transfer_free(xfer);
+    p.in_xfer = nullptr;
+    if (p.closing) close_device(p);
+}
+
+static void start_reports(UsbPanel& p) {
+    if (usb_host_transfer_alloc(p.in_mps, 0, &p.in_xfer) != ESP_OK) {
+        Serial.println("[Touch] Failed to allocate interrupt transfer");
+        p.in_xfer = nullptr;
+        return;
+    }
+    p.in_xfer->device_handle = p.device;
+    p.in_xfer->bEndpointAddress = p.in_ep;
+    p.in_xfer->num_bytes = p.in_mps;
+    p.in_xfer->callback = in_transfer_cb;
+    p.in_xfer->context = &p;
+    if (usb_host_transfer_submit(p.in_xfer) != ESP_OK) {
+        Serial.println("[Touch] Failed to submit interrupt transfer");
+        usb_host_transfer_free(p.in_xfer);
+        p.in_xfer = nullptr;
+        return;
+    }
+    Serial.printf("[Touch] USB panel %d ready: %d contact(s), EP 0x%02X, %u-byte reports\n",
+                  p.index, p.layout.contacts, p.in_ep, p.in_mps);
+    bind_panel(p);
+}
+
+static bool submit_control(UsbPanel& p, uint8_t request_type, uint8_t request, uint16_t value,
+                           const uint8_t* out_data, uint16_t length,
+                           void (*cb)(usb_transfer_t*)) {
+    usb_setup_packet_t* setup = (usb_setup_packet_t*)p.ctrl_xfer->data_buffer;
+    setup->bmRequestType = request_type;
+    setup->bRequest = request;
+    setup->wValue = value;
+    setup->wIndex = p.interface;
+    setup->wLength = length;
+    if (out_data) memcpy(p.ctrl_xfer->data_buffer + sizeof(usb_setup_packet_t), out_data, length);
+    p.ctrl_xfer->device_handle = p.device;
+    p.ctrl_xfer->bEndpointAddress = 0;
+    p.ctrl_xfer->num_bytes = sizeof(usb_setup_packet_t) + length;
+    p.ctrl_xfer->callback = cb;
+    p.ctrl_xfer->context = &p;
+    return usb_host_transfer_submit_control(p.client, p.ctrl_xfer) == ESP_OK;
+}
+
+// Control transfer done with (or failed): free it, then go on or tear down
+static void finish_control(UsbPanel& p, bool start) {
+    usb_host_transfer_free(p.ctrl_xfer);
+    p.ctrl_xfer = nullptr;
+    if (p.closing) close_device(p);
+    else if (start) start_reports(p);
+}
+
+static void set_input_mode_cb(usb_transfer_t* xfer) {
+    if (xfer->status != USB_TRANSFER_STATUS_COMPLETED) {
+        Serial.println("[Touch] SET_REPORT (Input Mode) failed, using default mode");
+    }
+    finish_control(*(UsbPanel*)xfer->context, true);
+}
+
+static void report_descriptor_cb(usb_transfer_t* xfer) {
+    UsbPanel& p = *(UsbPanel*)xfer->context;
+    if (xfer->status != USB_TRANSFER_STATUS_COMPLETED ||
+        xfer->actual_num_bytes <= (int)sizeof(usb_setup_packet_t)) {
+        Serial.println("[Touch] Report descriptor request failed");
+        finish_control(p, false);
+        return;
+    }
+
+    const uint8_t* desc = xfer->data_buffer + sizeof(usb_setup_packet_t);
+    size_t len = xfer->actual_num_bytes - sizeof(usb_setup_packet_t);
+    if (!parse_report_descriptor(desc, len, &p.layout)) {
+        Serial.println("[Touch] No multi-touch digitizer in report descriptor");
+        finish_control(p, false);
+        return;
+    }
+    build_panel_transform(p);
+
+    // Feature report: [ID] + Input Mode = multi-touch, other fields zero
+    const HidTouchLayout& layout = p.layout;
+    if (layout.input_mode.valid) {
+        uint8_t report[16];
+        memset(report, 0, sizeof(report));
+        const HidField& f = layout.input_mode;
+        size_t offset = layout.has_report_ids ? 1 : 0;
+        size_t length = offset + (layout.input_mode_report_bits + 7) / 8;
+        if (length <= sizeof(report) && f.bit_offset % 8 == 0) {
+            if (offset) report[0] = f.report_id;
+            report[offset + f.bit_offset / 8] = INPUT_MODE_MULTI_TOUCH;
+            if (submit_control(p, 0x21, HID_REQ_SET_REPORT, (HID_REPORT_FEATURE << 8) | f.report_id,
+                               report, length, set_input_mode_cb)) {
+                return;
+            }
+        }
+    }
+    finish_control(p, true);
+}
+
+/**
+ * Find the first HID interface with an interrupt-IN endpoint and the
+ * length of its report descriptor.
+ */
+static bool find_hid_interface(UsbPanel& p, const usb_config_desc_t* config, uint16_t* report_len) {
+    const uint8_t* d0 = (const uint8_t*)config;
+    size_t total = config->wTotalLength;
+    int current = -1;          // Interface being walked, if HID
+    uint16_t desc_len = 0;
+
+    for (size_t i = 0; i + 2 <= total && d0[i] >= 2; i += d0[i]) {
+        const uint8_t* d = d0 + i;
+        if (d[1] == USB_B_DESCRIPTOR_TYPE_INTERFACE && d[0] >= 9) {
+            if (p.interface >= 0) break;               // Found already
+            current = (d[5] == USB_CLASS_HID_CODE && d[3] == 0) ? d[2] : -1;
+            desc_len = 0;
+        } else if (d[1] == HID_DESC_TYPE_HID && current >= 0 && d[0] >= 9) {
+            desc_len = d[7] | (d[8] << 8);
+        } else if (d[1] == USB_B_DESCRIPTOR_TYPE_ENDPOINT && current >= 0 && d[0] >= 7) {
+            bool in = d[2] & 0x80;
+            bool interrupt = (d[3] & 0x03) == USB_BM_ATTRIBUTES_XFER_INT;
+            if (in && interrupt && desc_len > 0) {
+                p.interface = current;
+                p.in_ep = d[2];
+                p.in_mps = (d[4] | (d[5] << 8)) & 0x7FF;
+                *report_len = desc_len;
+            }
+        }
+    }
+    return p.interface >= 0;
+}
+
+// Which panel this is, across reconnects and reboots: VID, PID and the
+// serial number string, if it has one (FNV-1a). Never 0.
+static uint32_t panel_id_of(usb_device_handle_t device) {
+    uint32_t h = FNV1A_SEED;
+    auto mix = [&h](uint8_t b) { h = fnv1a_byte(h, b); };
+    const usb_device_desc_t* dd = nullptr;
+    if (usb_host_get_device_descriptor(device, &dd) == ESP_OK && dd) {
+        mix(dd->idVendor & 0xFF);
+        mix(dd->idVendor >> 8);
+        mix(dd->idProduct & 0xFF);
+        mix(dd->idProduct >> 8);
+    }
+    usb_device_info_t info;
+    if (usb_host_device_info(device, &info) == ESP_OK && info.str_desc_serial_num) {
+        const usb_str_desc_t* sn = info.str_desc_serial_num;
+        int chars = (sn->bLength - 2) / 2;
+        for (int i = 0; i < chars; i++) {
+            mix(sn->wData[i] & 0xFF);
+            mix(sn->wData[i] >> 8);
+        }
+    }
+    return h ? h : 1;
+}
+
+static bool address_held(uint8_t address) {
+    for (const UsbPanel& p : _panels) {
+        if (p.address == address) return true;
+    }
+    return false;
+}
+
+static void open_device(UsbPanel& p, uint8_t address) {
+    if (p.device || address_held(address)) return;   // One panel per slot
+    if (usb_host_device_open(p.client, address, &p.device) != ESP_OK) {
+        Serial.println("[Touch] Failed to open USB device");
+        p.device = nullptr;
+        return;
+    }
+
+    const usb_config_desc_t* config = nullptr;
+    uint16_t report_len = 0;
+    if (usb_host_get_active_config_descriptor(p.device, &config) != ESP_OK ||
+        !find_hid_interface(p, config, &report_len)) {
+        Serial.println("[Touch] USB device has no HID interrupt interface");
+        close_device(p);
+        return;
+    }
+    if (usb_host_interface_claim(p.client, p.device, p.interface, 0) != ESP_OK) {
+        // Another slot got there first (or the interface is not claimable)
+        p.interface = -1;
+        close_device(p);
+        return;
+    }
+    p.address = address;
+    p.panel_id = panel_id_of(p.device);
+    Serial.printf("[Touch] Panel %d: HID interface %d, report descriptor %u bytes\n",
+                  p.index, p.interface, report_len);
+
+    if (usb_host_transfer_alloc(sizeof(usb_setup_packet_t) + report_len, 0, &p.ctrl_xfer) != ESP_OK) {
+        p.ctrl_xfer = nullptr;
+        close_device(p);
+        return;
+    }
+    if (!submit_control(p, 0x81, USB_B_REQUEST_GET_DESCRIPTOR, HID_DESC_TYPE_REPORT << 8,
+                        nullptr, report_len, report_descriptor_cb)) {
+        Serial.println("[Touch] Failed to request report descriptor");
+        finish_control(p, false);
+        close_device(p);
+    }
+}
+
+static void client_event_cb(const usb_host_client_event_msg_t* msg, void* arg) {
+    UsbPanel& p = *(UsbPanel*)arg;
+    if (msg->event == USB_HOST_CLIENT_EVENT_NEW_DEV) {
+        // Opening here is allowed, but keep the callback short
+        if (p.pending_count < PENDING_MAX) p.pending[p.pending_count++] = msg->new_dev.address;
+    } else if (msg->event == USB_HOST_CLIENT_EVENT_DEV_GONE) {
+        if (msg->dev_gone.dev_hdl != p.device) return;
+        Serial.printf("[Touch] USB panel %d disconnected\n", p.index);
+        p.closing = true;
+        if (p.in_xfer) {
+            usb_host_endpoint_halt(p.device, p.in_ep);
+            usb_host_endpoint_flush(p.device, p.in_ep);
+        }
+        close_device(p);
+    }
+}
+
+static void usb_host_lib_task(void*) {
+    for (;;) {
+        uint32_t flags = 0;
+        usb_host_lib_handle_events(portMAX_DELAY, &flags);
+        if (flags & USB_HOST_LIB_EVENT_FLAGS_NO_CLIENTS) {
+            usb_host_device_free_all();
+        }
+    }
+}
+
+static void usb_client_task(void* arg) {
+    UsbPanel& p = *(UsbPanel*)arg;
+    for (;;) {
+        usb_host_client_handle_events(p.client, portMAX_DELAY);
+        for (int i = 0; i < p.pending_count; i++) open_device(p, p.pending[i]);
+        p.pending_count = 0;
+    }
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+// Turn on the PMU's boost so the panel gets VBUS from the OTG port
+static void enable_otg_power() {
+    Wire.begin(PMU_SDA, PMU_SCL);
+    Wire.beginTransmission(PMU_I2C_ADDR);
+    Wire.write(PMU_REG_CONFIG);
+    if (Wire.endTransmission(false) != 0 || Wire.requestFrom(PMU_I2C_ADDR, 1) != 1) {
+        Serial.println("[Touch] PMU not responding, OTG power unchanged");
+        return;
+    }
+    uint8_t reg = Wire.read();
+    Wire.beginTransmission(PMU_I2C_ADDR);
+    Wire.write(PMU_REG_CONFIG);
+    Wire.write(reg | PMU_OTG_CONFIG);
+    Wire.endTransmission();
+}
+
+// To test without hardware, use Serial commands:
+//   Send "T:512,300" over serial to simulate a touch at (512, 300)
+//   Send "CAL" to run the four-corner calibration
+//   Send "PANELS" to list the panel slots
+static void fire_tap(int panel, int x, int y);
+
+static void cmd_simulate_tap(const char* args) {
+    const char* comma = strchr(args, ',');
+    if (comma) fire_tap(0, atoi(args), atoi(comma + 1));
+}
+
+static void cmd_calibrate(const char*) {
+    usb_touch_start_calibration();
+}
+
+static void cmd_panels(const char*) {
+    Serial.printf("[Touch] %d panel slot(s), %dx%d tiles\n", PANELS,
+                  USB_TOUCH_TILES_X, USB_TOUCH_TILES_Y);
+    for (const UsbPanel& p : _panels) {
+        portENTER_CRITICAL(&_cal_mux);
+        bool ready = p.ready;
+        uint32_t id = p.panel_id;
+        int tile = p.tile;
+        bool saved = find_entry(id) != nullptr;
+        portEXIT_CRITICAL(&_cal_mux);
+        if (!ready) {
+            Serial.printf("  %d  empty\n", p.index);
+            continue;
+        }
+        Serial.printf("  %d  %08lx  tile %d  %s  %lu report(s)  %lu dropped\n", p.index,
+                      (unsigned long)id, tile, saved ? "calibrated" : "default",
+                      (unsigned long)p.reports, (unsigned long)p.dropped);
+    }
+}
 
 void usb_touch_init() {
     Serial.println("[Touch] Initializing USB Host for touch panel...");
+    serial_cmd_register("T:", cmd_simulate_tap);
+    serial_cmd_register("CAL", cmd_calibrate);
+    serial_cmd_register("PANELS", cmd_panels);
 
-    // Enable OTG mode on T-Display-S3-Long
-    // The SY6970 PMU needs OTG enabled for USB Host
-    // Note: actual OTG init depends on board variant and PMU library
-    USB.begin();
+    load_panels();
+    for (int i = 0; i < PANELS; i++) {
+        UsbPanel& p = _panels[i];
+        p.index = i;
+        p.interface = -1;
+        p.calibration = tile_default(0);
+    }
+    // Last line on the USB-Serial-JTAG console: the host takes the PHY
+
+    enable_otg_power();
+
+    usb_host_config_t host_config;
+    memset(&host_config, 0, sizeof(host_config));
+    host_config.skip_phy_setup = false;
+    host_config.intr_flags = ESP_INTR_FLAG_LEVEL1;
+    if (usb_host_install(&host_config) != ESP_OK) {
+        Serial.println("[Touch] USB Host install failed");
+        return;
+    }
+    if (xTaskCreatePinnedToCore(usb_host_lib_task, "usb_host", USB_TASK_STACK, nullptr,
+                                USB_TASK_PRIORITY, nullptr, USB_TASK_CORE) != pdPASS) {
+        Serial.println("[Touch] Failed to start USB tasks");
+        return;
+    }
+
+    // A client and reader task per panel slot
+    for (UsbPanel& p : _panels) {
+        usb_host_client_config_t client_config;
+        memset(&client_config, 0, sizeof(client_config));
+        client_config.is_synchronous = false;
+        client_config.max_num_event_msg = 5;
+        client_config.async.client_event_callback = client_event_cb;
+        client_config.async.callback_arg = &p;
+        if (usb_host_client_register(&client_config, &p.client) != ESP_OK) {
+            Serial.println("[Touch] USB Host client register failed");
+            return;
+        }
+        char name[12];
+        snprintf(name, sizeof(name), "usb_touch%d", p.index);
+        if (xTaskCreatePinnedToCore(usb_client_task, name, USB_TASK_STACK, &p,
+                                    USB_TASK_PRIORITY, nullptr, USB_TASK_CORE) != pdPASS) {
+            Serial.println("[Touch] Failed to start USB tasks");
+            return;
+        }
+    }
 
     _initialized = true;
-    Serial.println("[Touch] USB Host initialized");
+    Serial.printf("[Touch] USB Host initialized, %d panel slot(s)\n", PANELS);
+}
+
+// Corners of a tile in touch order: top-left, top-right, bottom-right, bottom-left
+static void cal_target(int tile, int step, int* x, int* y) {
+    int x0, y0, x1, y1;
+    tile_rect(tile, &x0, &y0, &x1, &y1);
+    *x = (step == 1 || step == 2) ? x1 - 1 - CAL_INSET : x0 + CAL_INSET;
+    *y = (step >= 2) ? y1 - 1 - CAL_INSET : y0 + CAL_INSET;
 }
 
-void usb_touch_set_callback(TouchCallback cb) {
-    _touch_callback = cb;
+static void prompt_calibration() {
+    static const char* CORNERS[TOUCH_CALIB_POINTS] = {
+        "top-left", "top-right", "bottom-right", "bottom-left"};
+    int x, y;
+    cal_target(_cal_tile, _cal_step, &x, &y);
+    if (PANELS > 1) {
+        Serial.printf("[Touch] Calibration, tile %d of %d: touch the %s mark (map %d,%d)\n",
+                      _cal_tile + 1, PANELS, CORNERS[_cal_step], x, y);
+    } else {
+        Serial.printf("[Touch] Calibration: touch the %s mark (map %d,%d)\n",
+                      CORNERS[_cal_step], x, y);
+    }
+}
+
+void usb_touch_start_calibration() {
+    // Taps are collected in uncalibrated map coordinates
+    for (UsbPanel& p : _panels) set_calibration(p, touch_transform_identity());
+    _cal_tile = 0;
+    _cal_step = 0;
+    _cal_panel = -1;
+    _cal_done = 0;
+    prompt_calibration();
+}
+
+// Bind panel to the tile just fitted, in the record and live (loop task)
+static void store_fit(UsbPanel& p, int tile, const TouchTransform& cal) {
+    portENTER_CRITICAL(&_cal_mux);
+    // The panel and the tile each lose their old entry
+    int n = 0;
+    for (int i = 0; i < _record.count; i++) {
+        const PanelCal& e = _record.entries[i];
+        if (e.panel_id != p.panel_id && e.panel_id != 0 && e.tile != tile) {
+            _record.entries[n++] = e;
+        }
+    }
+    PanelCal& e = _record.entries[min(n, USB_TOUCH_MAX_PANELS - 1)];
+    memset(&e, 0, sizeof(e));
+    e.panel_id = p.panel_id;
+    e.tile = tile;
+    e.cal = cal;
+    _record.count = min(n + 1, USB_TOUCH_MAX_PANELS);
+    // A panel that had the tile moves to this panel's old one
+    for (UsbPanel& other : _panels) {
+        if (&other != &p && other.ready && other.tile == tile) other.tile = p.tile;
+    }
+    p.tile = tile;
+    p.calibration = cal;
+    p.cal_changed = true;
+    portEXIT_CRITICAL(&_cal_mux);
+}
+
+// Put back what the panels had before a calibration run ended early or failed
+static void restore_calibrations() {
+    for (UsbPanel& p : _panels) {
+        portENTER_CRITICAL(&_cal_mux);
+        PanelCal* e = find_entry(p.panel_id);
+        if (!e) e = find_entry(0);
+        p.calibration = e && e->tile == p.tile ? e->cal : tile_default(p.tile);
+        p.cal_changed = true;
+        portEXIT_CRITICAL(&_cal_mux);
+    }
+}
+
+static void calibration_tap(int panel, int x, int y) {
+    if (_cal_panel < 0) {
+        if (_cal_done & (1 << panel)) {
+            Serial.printf("[Touch] That was panel %d, calibrated already: touch tile %d\n",
+                          panel, _cal_tile + 1);
+            return;
+        }
+        _cal_panel = panel;
+    } else if (panel != _cal_panel) {
+        Serial.printf("[Touch] That was panel %d, tile %d is on panel %d\n",
+                      panel, _cal_tile + 1, _cal_panel);
+        return;
+    }
+    _cal_touched[_cal_step][0] = x;
+    _cal_touched[_cal_step][1] = y;
+    if (++_cal_step < TOUCH_CALIB_POINTS) {
+        prompt_calibration();
+        return;
+    }
+
+    int target[TOUCH_CALIB_POINTS][2];
+    for (int i = 0; i < TOUCH_CALIB_POINTS; i++) {
+        cal_target(_cal_tile, i, &target[i][0], &target[i][1]);
+    }
+    TouchTransform cal;
+    if (!touch_transform_fit(_cal_touched, target, TOUCH_CALIB_POINTS, &cal)) {
+        Serial.println("[Touch] Calibration failed (points too close)");
+        _cal_tile = -1;
+        restore_calibrations();
+        return;
+    }
+    store_fit(_panels[_cal_panel], _cal_tile, cal);
+    _cal_done |= 1 << _cal_panel;
+
+    if (++_cal_tile < PANELS) {
+        _cal_step = 0;
+        _cal_panel = -1;
+        prompt_calibration();
+        return;
+    }
+    _cal_tile = -1;
+    persist_mark_dirty(save_panels);
+    Serial.println("[Touch] Calibration saved");
+}
+
+static void fire_tap(int panel, int x, int y) {
+    if (_cal_tile >= 0) {
+        calibration_tap(panel, x, y);
+        return;
+    }
+
+    // Debounce
+    unsigned long now = millis();
+    if (now - _last_touch_ms < TOUCH_DEBOUNCE_MS) return;
+    _last_touch_ms = now;
+
+    Serial.printf("[Touch] Touch at (%d, %d)\n", x, y);
+    event_bus_post_point(BUS_MAP_TOUCH, x, y);
 }
 
 void usb_touch_task() {
     if (!_initialized) return;
 
-    // TODO: Full USB Host HID implementation
-    //
-    // The complete implementation requires:
-    // 1. USB Host stack initialization (tinyusb host mode)
-    // 2. HID device enumeration and connection
-    // 3. Parsing HID touch reports (format depends on controller)
-    //
-    // Typical HID touch report structure:
-    //   Byte 0: Report ID
-    //   Byte 1: Contact count / touch status
-    //   Byte 2-3: X coordinate (little-endian)
-    //   Byte 4-5: Y coordinate (little-endian)
-    //
-    // For now, this is a skeleton that will be completed once
-    // the USB-C OTG adapter arrives and the actual HID descriptor
-    // can be inspected.
-    //
-    // To test without hardware, use Serial commands:
-    //   Send "T:512,300" over serial to simulate a touch at (512, 300)
-
-    // Serial simulation for development
-    if (Serial.available()) {
-        String line = Serial.readStringUntil('\n');
-        line.trim();
-
-        if (line.startsWith("T:")) {
-            int comma = line.indexOf(',', 2);
-            if (comma > 0) {
-                int x = line.substring(2, comma).toInt();
-                int y = line.substring(comma + 1).toInt();
-
-                // Debounce
-                unsigned long now = millis();
-                if (now - _last_touch_ms < TOUCH_DEBOUNCE_MS) return;
-                _last_touch_ms = now;
-
-                Serial.printf("[Touch] Touch at (%d, %d)\n", x, y);
-                if (_touch_callback) {
-                    _touch_callback(x, y);
-                }
+    // All panels' samples, oldest first; a tap is a press and lift on one panel
+    TouchSample sample;
+    while (touch_ring_pop_oldest(_rings, PANELS, &sample)) {
+        UsbPanel& p = _panels[sample.source];
+        if (touch_sample_is_lift(sample)) {
+            if (p.tap_active && abs(p.tap_x - p.tap_start_x) < TAP_SLOP &&
+                abs(p.tap_y - p.tap_start_y) < TAP_SLOP) {
+                fire_tap(p.index, p.tap_start_x, p.tap_start_y);
             }
+            p.tap_active = false;
+        } else if (sample.fingers > 1) {
+            p.tap_active = false;             // Not a tap
+        } else if (sample.event == 0) {
+            p.tap_active = true;
+            p.tap_start_x = p.tap_x = sample.x;
+            p.tap_start_y = p.tap_y = sample.y;
+        } else {
+            p.tap_x = sample.x;
+            p.tap_y = sample.y;
         }
     }
+    for (UsbPanel& p : _panels) {
+        if (!p.dropped) continue;
+        Serial.printf("[Touch] Panel %d dropped %lu move samples during a stall\n",
+                      p.index, (unsigned long)p.dropped);
+        p.dropped = 0;
+    }
 }
@@ -1,13 +1,50 @@
+/**
+ * USB touch panel input for RadioWall (Prototype 2).
+ *
+ * The large PCAP panel enumerates as a HID multi-touch digitizer on the
+ * ESP32-S3's USB-OTG port. usb_touch_init() installs the ESP-IDF USB Host
+ * library; the HID report descriptor is parsed on connect and interrupt-IN
+ * reports are decoded straight into the shared touch ring (touch_ring.h).
+ * usb_touch_task() turns ring samples into taps in map coordinates
+ * (TOUCH_MIN_X..TOUCH_MAX_X, TOUCH_MIN_Y..TOUCH_MAX_Y from config.h).
+ *
+ * A very large overlay may be several controllers side by side, each
+ * covering one tile of a USB_TOUCH_TILES_X x USB_TOUCH_TILES_Y grid over
+ * the map. Every panel gets a USB host client and reader task of its own,
+ * its own ring and its own calibration; usb_touch_task() merges the rings
+ * in timestamp order into one stream of map coordinates. Panels are told
+ * apart by VID, PID and serial number, and CAL binds each one to its
+ * tile. Several panels need a hub, which the USB host stack of the IDF
+ * the Arduino core is built on (4.4) does not enumerate through: there,
+ * only the panel on the root port comes up.
+ *
+ * The OTG port takes over the S3's only USB PHY, so the USB-Serial-JTAG
+ * console stops once the host is installed. Use UART0 for logs in this mode.
+ */
+
 #ifndef USB_TOUCH_H
 #define USB_TOUCH_H
 
 #include <Arduino.h>
+#include "config.h"
 
-// Callback type for touch events
-typedef void (*TouchCallback)(int x, int y);
+// Tiles of the map covered by separate panels (config.h may override)
+#ifndef USB_TOUCH_TILES_X
+#define USB_TOUCH_TILES_X 1
+#endif
+#ifndef USB_TOUCH_TILES_Y
+#define USB_TOUCH_TILES_Y 1
+#endif
+#define USB_TOUCH_MAX_PANELS 4
 
+// A tap is posted to the event bus (event_bus.h) as BUS_MAP_TOUCH, on the
+// 1024x600 map grid
 void usb_touch_init();
-void usb_touch_set_callback(TouchCallback cb);
 void usb_touch_task();
 
+// Four-corner calibration, tile by tile: the next four taps on one panel
+// are the tile's printed corner marks (prompted on Serial), which binds
+// that panel to the tile. The fits are applied and saved.
+void usb_touch_start_calibration();
+
 #endif // USB_TOUCH_H
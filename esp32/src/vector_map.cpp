@@ -0,0 +1,465 @@
+/**
+ * Vector map implementation for RadioWall.
+ *
+ * vector.bin (little-endian, format in tools/pack_map_vectors.py):
+ *   header  "RGVM", u8 version, u8 LOD count, u16 reserved,
+ *           u32 shape count, u32 reserved
+ *   LODs    u8 min zoom, 3 reserved, u32 first shape, u32 shape count
+ *   shapes  u16 x_min, y_min, x_max, y_max, u32 offset, u16 points,
+ *           u8 kind (0 land ring, 1 border line), u8 reserved
+ *   points  u16 x, u16 y, then zigzag varint deltas; x spans -180..180°
+ *           and y 90..-90° in 0..65535
+ *
+ * The whole file is kept in PSRAM. A render picks the finest LOD for the
+ * zoom, culls shapes by their boxes, fills land rings with the even-odd
+ * rule at pixel centres (edges bucketed by their first row, one active
+ * list down the view) and then draws borders over it as 1 px lines.
+ */
+
+#include "vector_map.h"
+#include "asset_fs.h"
+#include <LittleFS.h>
+
+static const uint8_t VECTOR_VERSION = 1;
+static const uint8_t SHAPE_LAND = 0;     // Closed ring, filled even-odd
+static const uint8_t SHAPE_BORDER = 1;   // Open polyline
+static const int MAX_LODS = 8;
+static const int32_t MAX_EDGES = 16384;  // Per render, 256 KB of PSRAM
+static const int MAX_ACTIVE = 256;       // Edges crossing one row
+static const int32_t WRAP = 65535;       // x of 180° (== -180° + WRAP)
+static const uint8_t LAND = 1;           // Packed palette indices
+static const uint8_t BORDER = 2;
+
+struct VectorHeader {
+    char magic[4];         // "RGVM"
+    uint8_t version;
+    uint8_t lod_count;
+    uint16_t reserved;
+    uint32_t shape_count;
+    uint32_t reserved2;
+};
+static_assert(sizeof(VectorHeader) == 16, "vector.bin header is 16 bytes");
+
+struct VectorLod {
+    uint8_t min_zoom;
+    uint8_t reserved[3];
+    uint32_t first_shape;
+    uint32_t shape_count;
+};
+static_assert(sizeof(VectorLod) == 12, "vector.bin LOD entries are 12 bytes");
+
+struct VectorShape {
+    uint16_t x_min, y_min, x_max, y_max;
+    uint32_t offset;       // First point, from the start of the file
+    uint16_t points;
+    uint8_t kind;
+    uint8_t reserved;
+};
+static_assert(sizeof(VectorShape) == 16, "vector.bin shape entries are 16 bytes");
+
+static uint8_t* _data = nullptr;   // Whole file
+static size_t _size = 0;
+static const VectorLod* _lods = nullptr;
+static const VectorShape* _shapes = nullptr;
+static int _lod_count = 0;
+static bool _loaded = false;
+static bool _failed = false;
+
+struct Edge {
+    float x;               // At the centre of the current row
+    float dxdy;
+    int16_t last_row;
+    int32_t next;          // Next edge starting on the same row, -1 = none
+};
+static Edge* _edges = nullptr;   // MAX_EDGES, allocated on the first render
+static int32_t _edge_count = 0;
+static int32_t _row_head[MAP_HEIGHT];
+
+// View pixel = (unit + shift - x0) * sx - vx, likewise for y without a shift
+struct ViewTransform {
+    float x0, sx, vx;
+    float sy, vy;
+    float ux0, ux1, uy0, uy1;   // The view in units
+};
+
+// ------------------------------------------------------------------
+// Points
+// ------------------------------------------------------------------
+
+struct PointReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    int32_t x, y;
+    uint16_t left;         // Points not yet read
+};
+
+static void reader_begin(PointReader& r, const VectorShape& s) {
+    const uint8_t* p = _data + s.offset;
+    r.x = p[0] | (p[1] << 8);
+    r.y = p[2] | (p[3] << 8);
+    r.p = p + 4;
+    r.end = _data + _size;
+    r.left = s.points - 1;
+}
+
+static bool read_delta(PointReader& r, int32_t& v) {
+    uint32_t u = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        if (r.p >= r.end) return false;
+        uint8_t b = *r.p++;
+        u |= (uint32_t)(b & 0x7F) << shift;
+        if (b < 0x80) {
+            v = (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Advance to the next point. False at the end (or, while loading, on a
+// corrupt shape: left stays non-zero).
+static bool reader_next(PointReader& r) {
+    if (r.left == 0) return false;
+    int32_t dx, dy;
+    if (!read_delta(r, dx) || !read_delta(r, dy)) return false;
+    r.x = (int32_t)((uint32_t)r.x + (uint32_t)dx);   // Wraps on corrupt data, caught at load
+    r.y = (int32_t)((uint32_t)r.y + (uint32_t)dy);
+    r.left--;
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Loading
+// ------------------------------------------------------------------
+
+static bool load_fail(const char* why) {
+    Serial.printf("[VectorMap] %s: %s\n", MAP_VECTOR_PATH, why);
+    free(_data);
+    _data = nullptr;
+    _failed = true;
+    return false;
+}
+
+static bool load() {
+    if (!psramFound()) {
+        _failed = true;
+        return false;
+    }
+    File f = LittleFS.open(MAP_VECTOR_PATH, "r");
+    if (!f) {
+        _failed = true;   // Optional: no message
+        return false;
+    }
+    _size = f.size();
+    f.close();
+
+    _data = (uint8_t*)ps_malloc(_size ? _size : 1);
+    if (!_data) return load_fail("no PSRAM for the vector map");
+    if (!asset_fs_load(MAP_VECTOR_PATH, _data, _size)) return load_fail("failed to read");
+
+    VectorHeader h;
+    if (_size < sizeof(h)) return load_fail("invalid header");
+    memcpy(&h, _data, sizeof(h));
+    if (memcmp(h.magic, "RGVM", 4) != 0 || h.version != VECTOR_VERSION ||
+        h.lod_count == 0 || h.lod_count > MAX_LODS) {
+        return load_fail("invalid header");
+    }
+    size_t shapes_at = sizeof(h) + (size_t)h.lod_count * sizeof(VectorLod);
+    if (shapes_at > _size || (_size - shapes_at) / sizeof(VectorShape) < h.shape_count) {
+        return load_fail("truncated");
+    }
+
+    _lods = (const VectorLod*)(_data + sizeof(h));
+    _shapes = (const VectorShape*)(_data + shapes_at);
+    for (int i = 0; i < h.lod_count; i++) {
+        const VectorLod& l = _lods[i];
+        if (l.first_shape > h.shape_count || l.shape_count > h.shape_count - l.first_shape ||
+            (i > 0 && l.min_zoom <= _lods[i - 1].min_zoom)) {
+            return load_fail("invalid LOD table");
+        }
+    }
+    // Read every shape once, so renders can trust the points
+    for (uint32_t i = 0; i < h.shape_count; i++) {
+        const VectorShape& s = _shapes[i];
+        if (s.offset > _size || _size - s.offset < 4 || s.points < 2 || s.kind > SHAPE_BORDER) {
+            return load_fail("invalid shape entry");
+        }
+        PointReader r;
+        reader_begin(r, s);
+        bool in_range = true;
+        while (reader_next(r)) {
+            if (r.x < 0 || r.x > WRAP || r.y < 0 || r.y > WRAP) in_range = false;
+        }
+        if (r.left != 0 || !in_range) return load_fail("corrupt shape points");
+    }
+
+    _lod_count = h.lod_count;
+    _loaded = true;
+    Serial.printf("[VectorMap] %d LODs, %lu shapes (%lu KB)\n", _lod_count,
+                  (unsigned long)h.shape_count, (unsigned long)(_size / 1024));
+    return true;
+}
+
+bool vector_map_ready() {
+    if (_loaded) return true;
+    if (_failed) return false;
+    return load();
+}
+
+// ------------------------------------------------------------------
+// Land fill
+// ------------------------------------------------------------------
+
+// Add one ring edge in view pixels. False when the edge pool is full.
+static bool add_edge(float xa, float ya, float xb, float yb) {
+    if (ya == yb) return true;
+    if (ya > yb) {
+        float t = xa; xa = xb; xb = t;
+        t = ya; ya = yb; yb = t;
+    }
+    // Rows whose centre the edge crosses
+    int r0 = max(0, (int)ceilf(ya - 0.5f));
+    int r1 = min(MAP_HEIGHT, (int)ceilf(yb - 0.5f));
+    if (r0 >= r1) return true;
+    // Right of the view it only ever closes a span at the row end, which an
+    // odd crossing count does anyway
+    if (xa >= MAP_WIDTH && xb >= MAP_WIDTH) return true;
+    if (_edge_count >= MAX_EDGES) return false;
+
+    Edge& e = _edges[_edge_count];
+    if (xa < 0 && xb < 0) {
+        e.x = -1.0f;   // Left of the view: only its parity matters
+        e.dxdy = 0;
+    } else {
+        e.dxdy = (xb - xa) / (yb - ya);
+        e.x = xa + (r0 + 0.5f - ya) * e.dxdy;
+    }
+    e.last_row = r1 - 1;
+    e.next = _row_head[r0];
+    _row_head[r0] = _edge_count++;
+    return true;
+}
+
+static bool add_ring(const VectorShape& s, const ViewTransform& t, int32_t shift) {
+    PointReader r;
+    reader_begin(r, s);
+    float fx = (r.x + shift - t.x0) * t.sx - t.vx;
+    float fy = r.y * t.sy - t.vy;
+    float px = fx, py = fy;
+    while (reader_next(r)) {
+        float x = (r.x + shift - t.x0) * t.sx - t.vx;
+        float y = r.y * t.sy - t.vy;
+        if (!add_edge(px, py, x, y)) return false;
+        px = x;
+        py = y;
+    }
+    return add_edge(px, py, fx, fy);
+}
+
+// Set pixels [pos, end) of a row of a zeroed packed bitmap to LAND
+static void fill_span(uint8_t* out, size_t pos, size_t end) {
+    for (; pos < end && (pos & 3); pos++) out[pos >> 2] |= LAND << ((pos & 3) * 2);
+    if (end - pos >= 4) {
+        size_t bytes = (end - pos) >> 2;
+        memset(out + (pos >> 2), LAND * 0x55, bytes);
+        pos += bytes * 4;
+    }
+    for (; pos < end; pos++) out[pos >> 2] |= LAND << ((pos & 3) * 2);
+}
+
+static inline int span_col(float x) {
+    return constrain((int)ceilf(x - 0.5f), 0, MAP_WIDTH);
+}
+
+// Walk the bucketed edges down the view and fill between crossing pairs
+static bool fill_edges(uint8_t* out) {
+    int32_t active[MAX_ACTIVE];
+    float xs[MAX_ACTIVE];
+    int count = 0;
+
+    for (int row = 0; row < MAP_HEIGHT; row++) {
+        for (int32_t e = _row_head[row]; e >= 0; e = _edges[e].next) {
+            if (count >= MAX_ACTIVE) return false;
+            active[count++] = e;
+        }
+
+        // Crossings in order (insertion sort: mostly sorted from the last row)
+        for (int i = 0; i < count; i++) {
+            float x = _edges[active[i]].x;
+            int j = i;
+            for (; j > 0 && xs[j - 1] > x; j--) xs[j] = xs[j - 1];
+            xs[j] = x;
+        }
+        size_t base = (size_t)row * MAP_WIDTH;
+        for (int i = 0; i < count; i += 2) {
+            int c0 = span_col(xs[i]);
+            int c1 = i + 1 < count ? span_col(xs[i + 1]) : MAP_WIDTH;
+            if (c0 < c1) fill_span(out, base + c0, base + c1);
+        }
+
+        // Step to the next row, dropping edges that end here
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            Edge& e = _edges[active[i]];
+            if (e.last_row == row) continue;
+            e.x += e.dxdy;
+            active[kept++] = active[i];
+        }
+        count = kept;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Borders
+// ------------------------------------------------------------------
+
+static inline void set_border(uint8_t* out, int x, int y) {
+    size_t p = (size_t)y * MAP_WIDTH + x;
+    int shift = (p & 3) * 2;
+    out[p >> 2] = (out[p >> 2] & ~(3 << shift)) | (BORDER << shift);
+}
+
+// Liang-Barsky: clip a segment to the view. False if nothing is left.
+static bool clip_segment(float& x0, float& y0, float& x1, float& y1) {
+    const float xmax = MAP_WIDTH - 0.001f;
+    const float ymax = MAP_HEIGHT - 0.001f;
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    const float p[4] = {-dx, dx, -dy, dy};
+    const float q[4] = {x0, xmax - x0, y0, ymax - y0};
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0) {
+            if (q[i] < 0) return false;
+            continue;
+        }
+        float r = q[i] / p[i];
+        if (p[i] < 0) {
+            if (r > t1) return false;
+            if (r > t0) t0 = r;
+        } else {
+            if (r < t0) return false;
+            if (r < t1) t1 = r;
+        }
+    }
+    float sx = x0;
+    float sy = y0;
+    x0 = sx + t0 * dx;
+    y0 = sy + t0 * dy;
+    x1 = sx + t1 * dx;
+    y1 = sy + t1 * dy;
+    return true;
+}
+
+// Bresenham between the pixels holding both (clipped) ends
+static void draw_segment(uint8_t* out, float xa, float ya, float xb, float yb) {
+    if (!clip_segment(xa, ya, xb, yb)) return;
+    int x0 = constrain((int)xa, 0, MAP_WIDTH - 1);
+    int y0 = constrain((int)ya, 0, MAP_HEIGHT - 1);
+    int x1 = constrain((int)xb, 0, MAP_WIDTH - 1);
+    int y1 = constrain((int)yb, 0, MAP_HEIGHT - 1);
+    int dx = abs(x1 - x0);
+    int dy = -abs(y1 - y0);
+    int step_x = x0 < x1 ? 1 : -1;
+    int step_y = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+        set_border(out, x0, y0);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += step_x;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += step_y;
+        }
+    }
+}
+
+static void draw_line(const VectorShape& s, const ViewTransform& t, int32_t shift,
+                      uint8_t* out) {
+    PointReader r;
+    reader_begin(r, s);
+    float px = (r.x + shift - t.x0) * t.sx - t.vx;
+    float py = r.y * t.sy - t.vy;
+    while (reader_next(r)) {
+        float x = (r.x + shift - t.x0) * t.sx - t.vx;
+        float y = r.y * t.sy - t.vy;
+        draw_segment(out, px, py, x, y);
+        px = x;
+        py = y;
+    }
+}
+
+// ------------------------------------------------------------------
+// Render
+// ------------------------------------------------------------------
+
+// Does the shape's box, moved east by shift, overlap the view? A view
+// across the antimeridian can show one shape at both shifts.
+static bool shape_in_view(const VectorShape& s, const ViewTransform& t, int32_t shift) {
+    return s.y_max >= t.uy0 && s.y_min <= t.uy1 &&
+           s.x_max + shift >= t.ux0 && s.x_min + shift <= t.ux1;
+}
+
+bool vector_map_render(const MapView& view, uint8_t* out) {
+    if (!vector_map_ready()) return false;
+    if (view.zoom < 2 || view.zoom > MAP_ZOOM_LIMIT || view.slice < 0 || view.slice > 3 ||
+        view.x < 0 || view.x > MAP_WIDTH * (view.zoom - 1) || view.y < 0 ||
+        view.y > MAP_HEIGHT * (view.zoom - 1)) {
+        return false;
+    }
+    if (!_edges) {
+        _edges = (Edge*)ps_malloc(MAX_EDGES * sizeof(Edge));
+        if (!_edges) return false;
+    }
+
+    // Finest level of detail meant for this zoom
+    int lod = 0;
+    while (lod + 1 < _lod_count && _lods[lod + 1].min_zoom <= view.zoom) lod++;
+    const VectorLod& l = _lods[lod];
+
+    ViewTransform t;
+    t.x0 = (MAP_SLICE_LAYOUT[view.slice].lon_min + 180.0f) * WRAP / 360.0f;
+    t.sx = MAP_WIDTH * view.zoom / (MAP_SLICE_LAYOUT[view.slice].lon_span * WRAP / 360.0f);
+    t.vx = view.x;
+    t.sy = MAP_HEIGHT * view.zoom / (float)WRAP;
+    t.vy = view.y;
+    t.ux0 = t.x0 + view.x / t.sx;
+    t.ux1 = t.x0 + (view.x + MAP_WIDTH) / t.sx;
+    t.uy0 = view.y / t.sy;
+    t.uy1 = (view.y + MAP_HEIGHT) / t.sy;
+
+    memset(out, 0, MAP_PACKED_BYTES);
+    for (int i = 0; i < MAP_HEIGHT; i++) _row_head[i] = -1;
+    _edge_count = 0;
+
+    for (uint32_t i = l.first_shape; i < l.first_shape + l.shape_count; i++) {
+        const VectorShape& s = _shapes[i];
+        if (s.kind != SHAPE_LAND) continue;
+        for (int32_t shift = 0; shift <= WRAP; shift += WRAP) {
+            if (shape_in_view(s, t, shift) && !add_ring(s, t, shift)) {
+                Serial.printf("[VectorMap] View %dx (%d,%d) has over %ld edges\n",
+                              view.zoom, view.x, view.y, (long)MAX_EDGES);
+                return false;
+            }
+        }
+    }
+    if (!fill_edges(out)) {
+        Serial.println("[VectorMap] Too many edges on one row");
+        return false;
+    }
+
+    for (uint32_t i = l.first_shape; i < l.first_shape + l.shape_count; i++) {
+        const VectorShape& s = _shapes[i];
+        if (s.kind != SHAPE_BORDER) continue;
+        for (int32_t shift = 0; shift <= WRAP; shift += WRAP) {
+            if (shape_in_view(s, t, shift)) draw_line(s, t, shift, out);
+        }
+    }
+    return true;
+}
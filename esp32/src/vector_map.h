@@ -0,0 +1,29 @@
+/**
+ * Vector map for RadioWall
+ *
+ * Optional alternative to the zoom tile pyramid: simplified land polygons
+ * and border polylines at a few levels of detail in one LittleFS file
+ * (format in tools/pack_map_vectors.py), rasterized per view by a scanline
+ * filler. The file has a fixed size whatever the zoom, so with it present
+ * zoomed views go up to MAP_ZOOM_LIMIT instead of stopping at the last
+ * tile level.
+ */
+
+#ifndef VECTOR_MAP_H
+#define VECTOR_MAP_H
+
+#include <Arduino.h>
+#include "world_map.h"
+
+#define MAP_VECTOR_PATH "/maps/vector.bin"
+
+// True once the vector map is loaded into PSRAM; the first call reads the
+// file (missing, invalid or no PSRAM: false from then on). Loop task only.
+bool vector_map_ready();
+
+// Rasterize a zoomed view (2x..MAP_ZOOM_LIMIT) into out (MAP_PACKED_BYTES,
+// 2 bits per pixel). False if the vector map isn't ready, the view is out
+// of range or it has more edges than one render handles.
+bool vector_map_render(const MapView& view, uint8_t* out);
+
+#endif // VECTOR_MAP_H
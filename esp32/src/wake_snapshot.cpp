@@ -0,0 +1,89 @@
+/**
+ * Deep-sleep wake snapshot implementation for RadioWall.
+ *
+ * The worker updates the station half in normal RAM under a spinlock as
+ * stations change; only wake_snapshot_save() touches RTC memory, so the
+ * RTC copy is written once and CRC-sealed right before sleeping.
+ */
+
+#include "wake_snapshot.h"
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <esp_rom_crc.h>
+#include <freertos/FreeRTOS.h>
+
+static const uint32_t SNAPSHOT_MAGIC = 0x52574B31;   // "RWK1"
+
+RTC_DATA_ATTR static WakeSnapshot _rtc_snapshot;
+RTC_DATA_ATTR static uint32_t _rtc_magic = 0;
+RTC_DATA_ATTR static uint32_t _rtc_crc = 0;
+
+static portMUX_TYPE _station_mux = portMUX_INITIALIZER_UNLOCKED;
+static StationInfo _station = {};
+static char _stream_url[sizeof(_rtc_snapshot.stream_url)] = "";
+
+static uint32_t snapshot_crc(const WakeSnapshot& snap) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&snap, sizeof(snap));
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void wake_snapshot_set_station(const StationInfo* station, const char* url) {
+    bool fits = url && strlen(url) < sizeof(_stream_url);
+    portENTER_CRITICAL(&_station_mux);
+    if (station && station->valid) {
+        _station = *station;
+        strcpy(_stream_url, fits ? url : "");
+    } else {
+        _station.valid = false;
+        _stream_url[0] = '\0';
+    }
+    portEXIT_CRITICAL(&_station_mux);
+}
+
+void wake_snapshot_get_station(StationInfo* station, char* url, size_t cap) {
+    portENTER_CRITICAL(&_station_mux);
+    *station = _station;
+    bool fits = _station.valid && strlen(_stream_url) < cap;
+    if (cap > 0) strcpy(url, fits ? _stream_url : "");
+    portEXIT_CRITICAL(&_station_mux);
+}
+
+void wake_snapshot_save(const char* wiim_ip, int zoom, int slice) {
+    WakeSnapshot snap;
+    memset(&snap, 0, sizeof(snap));
+
+    portENTER_CRITICAL(&_station_mux);
+    snap.station = _station;
+    memcpy(snap.stream_url, _stream_url, sizeof(snap.stream_url));
+    portEXIT_CRITICAL(&_station_mux);
+
+    strncpy(snap.wiim_ip, wiim_ip ? wiim_ip : "", sizeof(snap.wiim_ip) - 1);
+    const uint8_t* bssid = WiFi.isConnected() ? WiFi.BSSID() : nullptr;
+    if (bssid) {
+        memcpy(snap.bssid, bssid, sizeof(snap.bssid));
+        snap.channel = WiFi.channel();
+    }
+    snap.zoom = zoom;
+    snap.slice = slice;
+
+    _rtc_snapshot = snap;
+    _rtc_crc = snapshot_crc(snap);
+    _rtc_magic = SNAPSHOT_MAGIC;
+    Serial.printf("[Wake] Snapshot saved: %s\n",
+                  snap.station.valid ? snap.station.title : "(nothing playing)");
+}
+
+bool wake_snapshot_take(WakeSnapshot* out) {
+    bool woke = esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED;
+    bool intact = _rtc_magic == SNAPSHOT_MAGIC && _rtc_crc == snapshot_crc(_rtc_snapshot);
+    _rtc_magic = 0;   // One wake per snapshot
+
+    if (!woke || !intact) return false;
+    *out = _rtc_snapshot;
+    Serial.printf("[Wake] Snapshot: %s\n",
+                  out->station.valid ? out->station.title : "(nothing playing)");
+    return true;
+}
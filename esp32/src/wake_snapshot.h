@@ -0,0 +1,40 @@
+/**
+ * Deep-sleep wake snapshot for RadioWall.
+ *
+ * settings_power_off() wakes as a reset, so everything in RAM is gone.
+ * Before sleeping, wake_snapshot_save() copies what is needed to get audio
+ * going again into RTC slow memory, which survives deep sleep: the current
+ * station and its resolved stream URL, the WiiM IP, the AP to rejoin, zoom
+ * and slice. On the next boot wake_snapshot_take() hands it back (once)
+ * if the reset was a deep-sleep wake and the snapshot's CRC checks out.
+ */
+
+#ifndef WAKE_SNAPSHOT_H
+#define WAKE_SNAPSHOT_H
+
+#include <Arduino.h>
+#include "radio_client.h"
+
+struct WakeSnapshot {
+    StationInfo station;   // valid = false: nothing was playing
+    char stream_url[256];  // "" if unknown (or too long to keep)
+    char wiim_ip[16];
+    uint8_t bssid[6];
+    uint8_t channel;       // 0 = not connected when it slept
+    uint8_t zoom;
+    uint8_t slice;
+};
+
+// What is playing now (network worker, after each play / stop)
+void wake_snapshot_set_station(const StationInfo* station, const char* url);
+
+// The station and URL last set (any task); url gets "" if there is none
+void wake_snapshot_get_station(StationInfo* station, char* url, size_t cap);
+
+// Write the snapshot to RTC memory (just before deep sleep)
+void wake_snapshot_save(const char* wiim_ip, int zoom, int slice);
+
+// The snapshot left by the last deep sleep, if this boot is its wake
+bool wake_snapshot_take(WakeSnapshot* out);
+
+#endif // WAKE_SNAPSHOT_H
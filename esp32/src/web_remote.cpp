@@ -0,0 +1,369 @@
+/**
+ * Web remote implementation for RadioWall.
+ *
+ * ESPAsyncWebServer runs its handlers on the AsyncTCP task, which must not
+ * touch loop-owned state (UIState, favorites, history, an on-demand
+ * places.bin). So a handler only parses and queues; everything that reads
+ * or changes the UI happens in web_remote_task() on the loop. Pushes are
+ * built from the published UI snapshot, at most every PUSH_MIN_MS, and
+ * only when it differs from the last one sent.
+ */
+
+#include "web_remote.h"
+#include "ui_state.h"
+#include "favorites.h"
+#include "history.h"
+#include "places_db.h"
+#include "loop_events.h"
+#include "event_bus.h"
+#include "serial_cmd.h"
+#include <ESPAsyncWebServer.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+static const char* WEB_ROOT = "/www/";            // index.html.gz on LittleFS
+static const int QUEUE_DEPTH = 8;
+static const int MAX_CLIENTS = 4;                 // Further pages are refused
+static const size_t MAX_MESSAGE = 200;            // Longest command accepted
+static const unsigned long PUSH_MIN_MS = 100;     // Volume drags: ~10 pushes/s at most
+static const unsigned long CLEANUP_MS = 1000;
+static const int HISTORY_SHOWN = 10;
+static const int SEARCH_RESULTS = 8;
+static const size_t STATE_JSON_SIZE = 1024;
+static const size_t LISTS_JSON_SIZE = 6144;       // 20 favorites + 10 history entries
+static const size_t RESULTS_JSON_SIZE = 1536;
+
+static AsyncWebServer* _server = nullptr;
+static AsyncWebSocket* _ws = nullptr;
+static QueueHandle_t _queue = nullptr;
+static const UIState* _ui_state = nullptr;
+static bool _suspended = false;
+
+// Loop task: what the pages were last sent
+static UISnapshot _pushed;
+static bool _pushed_valid = false;
+static unsigned long _last_push = 0;
+static unsigned long _last_cleanup = 0;
+static int _pushed_favorites = -1;
+static int _pushed_history = -1;
+
+// Counters for WEB (each written by one task)
+static uint32_t _commands = 0;     // AsyncTCP task
+static uint32_t _dropped = 0;      // AsyncTCP task: queue full or bad message
+static uint32_t _pushes = 0;       // Loop task
+
+// ------------------------------------------------------------------
+// AsyncTCP task: parse and queue
+// ------------------------------------------------------------------
+
+struct CommandName {
+    const char* name;
+    WebCommandType type;
+};
+
+static const CommandName COMMANDS[] = {
+    { "hello", WEB_CMD_HELLO },       { "search", WEB_CMD_SEARCH },
+    { "play", WEB_CMD_PLAY_AT },      { "next", WEB_CMD_NEXT },
+    { "pause", WEB_CMD_PAUSE },       { "stop", WEB_CMD_STOP },
+    { "volume", WEB_CMD_VOLUME },     { "favorite", WEB_CMD_FAVORITE },
+    { "history", WEB_CMD_HISTORY },
+};
+
+static void queue_command(const WebCommand& cmd) {
+    bool ok;
+    if (cmd.type == WEB_CMD_HELLO || cmd.type == WEB_CMD_SEARCH) {
+        ok = _queue && xQueueSend(_queue, &cmd, 0) == pdTRUE;
+        if (ok) loop_events_notify();
+    } else {
+        BusEvent e = {};
+        e.type = BUS_WEB_COMMAND;
+        e.phase = cmd.type;
+        e.value = cmd.value;
+        e.lat = cmd.lat;
+        e.lon = cmd.lon;
+        ok = event_bus_post(e);
+    }
+    if (ok) _commands++;
+    else _dropped++;
+}
+
+// {"cmd":"volume","value":40}, {"cmd":"play","lat":48.2,"lon":16.4},
+// {"cmd":"search","q":"vien"}, ...
+static void on_message(uint32_t client, const uint8_t* data, size_t len) {
+    StaticJsonDocument<256> doc;
+    if (len > MAX_MESSAGE || deserializeJson(doc, data, len)) {
+        _dropped++;
+        return;
+    }
+    const char* name = doc["cmd"] | "";
+    WebCommand cmd = {};
+    cmd.client = client;
+    bool known = false;
+    for (const CommandName& c : COMMANDS) {
+        if (strcmp(name, c.name) == 0) {
+            cmd.type = c.type;
+            known = true;
+            break;
+        }
+    }
+    if (!known) {
+        _dropped++;
+        return;
+    }
+    cmd.value = doc["value"] | 0;
+    cmd.lat = doc["lat"] | 0.0f;
+    cmd.lon = doc["lon"] | 0.0f;
+    strncpy(cmd.text, doc["q"] | "", sizeof(cmd.text) - 1);
+    queue_command(cmd);
+}
+
+static void on_ws_event(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type,
+                        void* arg, uint8_t* data, size_t len) {
+    switch (type) {
+        case WS_EVT_CONNECT: {
+            if (server->count() > MAX_CLIENTS) {
+                client->close(1013, "Too many remotes");
+                return;
+            }
+            WebCommand hello = {};
+            hello.type = WEB_CMD_HELLO;
+            hello.client = client->id();
+            queue_command(hello);
+            break;
+        }
+        case WS_EVT_DATA: {
+            // Commands are small: one unfragmented text frame each
+            AwsFrameInfo* info = (AwsFrameInfo*)arg;
+            if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+                on_message(client->id(), data, len);
+            } else {
+                _dropped++;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void handle_not_found(AsyncWebServerRequest* request) {
+    request->send(404, "text/plain",
+                  LittleFS.exists("/www/index.html.gz")
+                      ? "Not found\n"
+                      : "Web remote not on LittleFS: run tools/build_web.py, then 'pio run -t uploadfs'\n");
+}
+
+// ------------------------------------------------------------------
+// Loop task: messages
+// ------------------------------------------------------------------
+
+static void send_json(uint32_t client, const JsonDocument& doc) {
+    if (doc.overflowed()) Serial.println("[Web] JSON document overflowed");
+    String out;
+    serializeJson(doc, out);
+    if (client) _ws->text(client, out);
+    else _ws->textAll(out);
+    _pushes++;
+}
+
+static void send_state(uint32_t client, const UISnapshot& s) {
+    DynamicJsonDocument doc(STATE_JSON_SIZE);
+    doc["type"] = "state";
+    doc["view"] = (int)s.view_mode;
+    doc["playing"] = s.is_playing;
+    doc["paused"] = s.paused;
+    doc["volume"] = s.volume;
+    doc["status"] = s.status_text;     // char[]: copied into the document
+    if (s.is_playing) {
+        doc["station"] = s.station_name;
+        doc["location"] = s.location;
+        doc["country"] = s.country;
+        doc["index"] = s.station_index;
+        doc["total"] = s.station_total;
+        if (s.wiim_title[0]) doc["track"] = s.wiim_title;
+        if (s.wiim_artist[0]) doc["artist"] = s.wiim_artist;
+    }
+    if (s.has_marker) {
+        doc["lat"] = s.marker_lat;
+        doc["lon"] = s.marker_lon;
+    }
+    send_json(client, doc);
+}
+
+static void add_station(JsonArray list, const StationMeta* m) {
+    JsonObject o = list.createNestedObject();
+    o["title"] = m->title;
+    o["place"] = m->place;
+    o["country"] = m->country;
+}
+
+// Favorites, and the newest history entries (history_get() reads them
+// from the ring file)
+static void send_lists(uint32_t client) {
+    DynamicJsonDocument doc(LISTS_JSON_SIZE);
+    doc["type"] = "lists";
+    JsonArray favs = doc.createNestedArray("favorites");
+    for (int i = 0; i < favorites_count(); i++) {
+        const FavoriteStation* f = favorites_get(i);
+        if (f) add_station(favs, f);
+    }
+    JsonArray hist = doc.createNestedArray("history");
+    int shown = min(history_count(), HISTORY_SHOWN);
+    for (int i = 0; i < shown; i++) {
+        const HistoryEntry* h = history_get(i);
+        if (h) add_station(hist, h);
+    }
+    _pushed_favorites = favorites_count();
+    _pushed_history = history_count();
+    send_json(client, doc);
+}
+
+static void send_results(uint32_t client, const char* query) {
+    PlaceHandle found[SEARCH_RESULTS];
+    int count = places_db_search(query, SEARCH_RESULTS, found);
+
+    DynamicJsonDocument doc(RESULTS_JSON_SIZE);
+    doc["type"] = "results";
+    doc["q"] = query;
+    JsonArray list = doc.createNestedArray("places");
+    Place p;
+    for (int i = 0; i < count; i++) {
+        if (!places_db_get(found[i], &p)) continue;
+        JsonObject o = list.createNestedObject();
+        o["name"] = p.name;
+        o["country"] = p.country;
+        o["lat"] = p.lat_x100 / 100.0f;
+        o["lon"] = p.lon_x100 / 100.0f;
+    }
+    send_json(client, doc);
+}
+
+// State (and lists, when they may have changed) to every page
+static void push_changes(unsigned long now) {
+    if (!_ui_state) return;
+    UISnapshot snap;
+    _ui_state->read_snapshot(&snap);
+    bool changed = !_pushed_valid || memcmp(&snap, &_pushed, sizeof(snap)) != 0;
+    bool lists = favorites_count() != _pushed_favorites || history_count() != _pushed_history;
+    if (!changed && !lists) return;
+
+    // Hold back a burst; the loop wakes for the rest
+    if (now - _last_push < PUSH_MIN_MS) {
+        loop_events_due_in(PUSH_MIN_MS - (now - _last_push));
+        return;
+    }
+    // A new station is a new history entry once it plays
+    lists = lists || (_pushed_valid && strcmp(snap.station_name, _pushed.station_name) != 0);
+    if (changed) send_state(0, snap);
+    if (lists) send_lists(0);
+    _pushed = snap;
+    _pushed_valid = true;
+    _last_push = now;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void web_remote_set_ui_state(const UIState* state) {
+    _ui_state = state;
+}
+
+bool web_remote_running() {
+    return _server != nullptr && !_suspended;
+}
+
+void web_remote_start() {
+    if (_server) return;
+
+    _queue = xQueueCreate(QUEUE_DEPTH, sizeof(WebCommand));
+    if (!_queue) {
+        Serial.println("[Web] No memory for the command queue");
+        return;
+    }
+    // Runs on the network worker; _server is set last, for the loop task
+    AsyncWebServer* server = new AsyncWebServer(WEB_REMOTE_PORT);
+    _ws = new AsyncWebSocket("/ws");
+    _ws->onEvent(on_ws_event);
+    server->addHandler(_ws);
+
+    // index.html is stored gzipped; the handler serves the .gz with
+    // Content-Encoding: gzip
+    server->serveStatic("/", LittleFS, WEB_ROOT)
+        .setDefaultFile("index.html")
+        .setCacheControl("max-age=600");
+    server->onNotFound(handle_not_found);
+    server->begin();
+    _server = server;
+    Serial.println("[Web] Remote on http://radiowall.local/");
+}
+
+void web_remote_task() {
+    if (!_server || _suspended) return;
+
+    WebCommand cmd;
+    while (xQueueReceive(_queue, &cmd, 0) == pdTRUE) {
+        switch (cmd.type) {
+            case WEB_CMD_HELLO:
+                if (_ui_state) {
+                    UISnapshot snap;
+                    _ui_state->read_snapshot(&snap);
+                    send_state(cmd.client, snap);
+                }
+                send_lists(cmd.client);
+                break;
+            case WEB_CMD_SEARCH:
+                send_results(cmd.client, cmd.text);
+                break;
+            default: break;   // The rest go out on the event bus
+        }
+    }
+
+    unsigned long now = millis();
+    if (_ws->count() > 0) {
+        push_changes(now);
+    } else {
+        _pushed_valid = false;   // The next page gets a fresh push
+    }
+    if (now - _last_cleanup >= CLEANUP_MS) {
+        _ws->cleanupClients(MAX_CLIENTS);
+        _last_cleanup = now;
+    }
+}
+
+void web_remote_suspend(bool suspend) {
+    if (!_server || suspend == _suspended) return;
+    _suspended = suspend;
+    if (suspend) {
+        _ws->closeAll(1001, "Portal open");
+        _server->end();
+        Serial.println("[Web] Remote closed while the portal has port 80");
+    } else {
+        _server->begin();
+        _pushed_valid = false;
+        Serial.println("[Web] Remote reopened");
+    }
+}
+
+// ------------------------------------------------------------------
+// Serial commands
+// ------------------------------------------------------------------
+
+// WEB - Remote status
+static void cmd_web(const char*) {
+    if (!_server) {
+        Serial.println("[Web] Remote not started (no WiFi yet)");
+        return;
+    }
+    Serial.printf("[Web] %s, %u page(s), %lu command(s), %lu dropped, %lu message(s) sent\n",
+                  _suspended ? "suspended" : "listening", (unsigned)_ws->count(),
+                  (unsigned long)_commands, (unsigned long)_dropped, (unsigned long)_pushes);
+    Serial.printf("[Web] UI %s on LittleFS\n",
+                  LittleFS.exists("/www/index.html.gz") ? "found" : "missing (tools/build_web.py)");
+}
+
+void web_remote_serial_init() {
+    serial_cmd_register("WEB", cmd_web);
+}
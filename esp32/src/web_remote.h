@@ -0,0 +1,72 @@
+/**
+ * Web remote for RadioWall.
+ *
+ * http://radiowall.local/ serves a one-page remote (esp32/web/index.html,
+ * gzipped onto LittleFS as /www/index.html.gz by tools/build_web.py) from
+ * an async web server on port 80. The page keeps a WebSocket open at /ws:
+ * the frame pushes what it shows (UIState's snapshot: station, city,
+ * track, volume, pause, view) whenever it changes, and the favorites and
+ * recent history when they change, so the page never polls.
+ *
+ * Commands from the page (play at a point or a searched city, next,
+ * pause, stop, volume, a favorite or history entry) are parsed on the
+ * async TCP task and posted straight to the event bus (event_bus.h) as
+ * BUS_WEB_COMMAND, so main.cpp runs the same handlers a touch does. A new
+ * page and a city search need an answer for that page only: they go
+ * through a small queue of their own that web_remote_task() drains on the
+ * loop task (places_db_search() runs there).
+ *
+ * Port 80 is the WiFiManager portal's while settings has it open:
+ * web_remote_suspend() frees it for that long.
+ */
+
+#ifndef WEB_REMOTE_H
+#define WEB_REMOTE_H
+
+#include <Arduino.h>
+
+class UIState;
+
+static const uint16_t WEB_REMOTE_PORT = 80;
+
+enum WebCommandType : uint8_t {
+    WEB_CMD_HELLO,        // Page connected: send it everything (handled here)
+    WEB_CMD_SEARCH,       // City search (handled here)
+    WEB_CMD_PLAY_AT,      // lat, lon (a searched city arrives as its coordinates)
+    WEB_CMD_NEXT,
+    WEB_CMD_PAUSE,        // Toggle, like the menu item
+    WEB_CMD_STOP,
+    WEB_CMD_VOLUME,       // value 0..100
+    WEB_CMD_FAVORITE,     // value = favorites index
+    WEB_CMD_HISTORY,      // value = history index
+};
+
+struct WebCommand {
+    WebCommandType type;
+    uint32_t client;      // WebSocket client ID
+    int value;
+    float lat, lon;
+    char text[32];        // Search query
+};
+
+// Start the server (once WiFi and mDNS are up; later calls do nothing)
+void web_remote_start();
+
+// True once the server listens
+bool web_remote_running();
+
+// UI state to push (read through its snapshot)
+void web_remote_set_ui_state(const UIState* state);
+
+// Loop task, once per pass: greet new pages, answer searches, push
+// changed state
+void web_remote_task();
+
+// Close the server while the WiFiManager portal needs port 80 (true),
+// reopen it afterwards (false). Loop task.
+void web_remote_suspend(bool suspend);
+
+// Register the WEB serial command (clients, queue, pushes)
+void web_remote_serial_init();
+
+#endif // WEB_REMOTE_H
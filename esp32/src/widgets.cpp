@@ -0,0 +1,128 @@
+/**
+ * Retained widgets for RadioWall's full-screen pages.
+ */
+
+#include "widgets.h"
+#include "display.h"
+#include "theme.h"
+#include "Arduino_GFX_Library.h"
+
+static const uint8_t NO_WIDGET = 0xFF;
+
+// Region table over the page area (y 0-579): widget index per cell
+static const int CELL_W = 20;
+static const int CELL_H = 10;
+static const int PAGE_AREA_BOTTOM = 580;
+static const int CELL_COLS = (TH_DISPLAY_W + CELL_W - 1) / CELL_W;   // 9
+static const int CELL_ROWS = PAGE_AREA_BOTTOM / CELL_H;             // 58
+
+static uint8_t _cells[CELL_ROWS][CELL_COLS];
+static WidgetPage* _shown = nullptr;
+
+// A cell belongs to the widget that covers its centre
+static void enter_cells(const Widget& w, uint8_t index) {
+    int col0 = max(0, (w.x + CELL_W / 2) / CELL_W);
+    int col1 = min(CELL_COLS, (w.x + w.w + CELL_W / 2) / CELL_W);
+    int row0 = max(0, (w.y + CELL_H / 2) / CELL_H);
+    int row1 = min(CELL_ROWS, (w.y + w.h + CELL_H / 2) / CELL_H);
+    for (int r = row0; r < row1; r++) {
+        for (int c = col0; c < col1; c++) _cells[r][c] = index;
+    }
+}
+
+void widget_page_clear(WidgetPage& page) {
+    page.count = 0;
+    if (_shown == &page) memset(_cells, NO_WIDGET, sizeof(_cells));
+}
+
+Widget* widget_add(WidgetPage& page, uint8_t id, int x, int y, int w, int h,
+                   WidgetDrawFn draw, int split1, int split2) {
+    if (page.count >= WIDGET_PAGE_MAX) return nullptr;
+    Widget& wd = page.widgets[page.count];
+    wd.x = x;
+    wd.y = y;
+    wd.w = w;
+    wd.h = h;
+    wd.split[0] = split1;
+    wd.split[1] = split2;
+    wd.id = id;
+    wd.dirty = false;
+    wd.draw = draw;
+    if (_shown == &page) enter_cells(wd, page.count);
+    page.count++;
+    return &wd;
+}
+
+Widget* widget_find(WidgetPage& page, uint8_t id) {
+    for (int i = 0; i < page.count; i++) {
+        if (page.widgets[i].id == id) return &page.widgets[i];
+    }
+    return nullptr;
+}
+
+void widget_page_show(WidgetPage& page) {
+    _shown = &page;
+    memset(_cells, NO_WIDGET, sizeof(_cells));
+    for (int i = 0; i < page.count; i++) enter_cells(page.widgets[i], i);
+}
+
+Widget* widget_hit(WidgetPage& page, int x, int y, int* zone) {
+    if (_shown != &page || x < 0 || y < 0 || x >= TH_DISPLAY_W || y >= PAGE_AREA_BOTTOM) {
+        return nullptr;
+    }
+    uint8_t index = _cells[y / CELL_H][x / CELL_W];
+    if (index == NO_WIDGET) return nullptr;
+
+    Widget* w = &page.widgets[index];
+    if (zone) {
+        *zone = 0;
+        if (w->split[0] && x >= w->split[0]) *zone = 1;
+        if (w->split[1] && x >= w->split[1]) *zone = 2;
+    }
+    return w;
+}
+
+void widget_invalidate(WidgetPage& page, uint8_t id) {
+    Widget* w = widget_find(page, id);
+    if (w) w->dirty = true;
+}
+
+void widget_invalidate_all(WidgetPage& page) {
+    for (int i = 0; i < page.count; i++) page.widgets[i].dirty = true;
+}
+
+void widget_page_render(Arduino_GFX* gfx, WidgetPage& page) {
+    if (!gfx) return;
+    for (int i = 0; i < page.count; i++) {
+        Widget& w = page.widgets[i];
+        w.dirty = false;
+        if (w.draw) w.draw(gfx, w, WIDGET_NOT_PRESSED);
+    }
+}
+
+void widget_page_mark_drawn(WidgetPage& page) {
+    for (int i = 0; i < page.count; i++) page.widgets[i].dirty = false;
+}
+
+bool widget_page_render_dirty(Arduino_GFX* gfx, WidgetPage& page) {
+    if (!gfx) return false;
+    bool drawn = false;
+    for (int i = 0; i < page.count; i++) {
+        Widget& w = page.widgets[i];
+        if (!w.dirty) continue;
+        w.dirty = false;
+        gfx->fillRect(w.x, w.y, w.w, w.h, TH_BG);
+        if (w.draw) w.draw(gfx, w, WIDGET_NOT_PRESSED);
+        display_damage(w.x, w.y, w.w, w.h);
+        drawn = true;
+    }
+    return drawn;
+}
+
+void widget_press(Arduino_GFX* gfx, Widget* w, int zone, uint32_t hold_ms) {
+    if (!gfx || !w) return;
+    if (w->draw) w->draw(gfx, *w, zone);
+    gfx->flush();
+    delay(hold_ms);
+    w->dirty = true;
+}
@@ -0,0 +1,76 @@
+/**
+ * Retained widgets for the menu and settings pages.
+ *
+ * A page lays out its cards, list rows and buttons once, into a
+ * WidgetPage that keeps their rectangles. Showing the page builds a region
+ * table over the page area (20x10 px cells), so a touch finds its widget
+ * with one lookup instead of each page redoing its layout math. A widget
+ * may be split into up to three hit zones along x (e.g. play | delete).
+ *
+ * When a widget's state changes the page marks it dirty, and
+ * widget_page_render_dirty() repaints only those widgets and declares
+ * their rows to the display, so the flush pushes just them.
+ */
+
+#ifndef WIDGETS_H
+#define WIDGETS_H
+
+#include <Arduino.h>
+
+class Arduino_GFX;
+struct Widget;
+
+static const int WIDGET_PAGE_MAX = 16;
+static const int WIDGET_NOT_PRESSED = -1;
+
+// Draw a widget in its rectangle. pressed is the zone being touched, or
+// WIDGET_NOT_PRESSED. The page looks up whatever the widget shows by its id.
+typedef void (*WidgetDrawFn)(Arduino_GFX* gfx, const Widget& w, int pressed);
+
+struct Widget {
+    int16_t x, y, w, h;
+    int16_t split[2];      // Zone boundaries along x (0: unused)
+    uint8_t id;            // Page's own meaning: item, list slot, button
+    bool dirty;
+    WidgetDrawFn draw;
+};
+
+struct WidgetPage {
+    Widget widgets[WIDGET_PAGE_MAX];
+    uint8_t count;
+};
+
+// Start a new layout. Returns nullptr from widget_add() once the page is full.
+void widget_page_clear(WidgetPage& page);
+Widget* widget_add(WidgetPage& page, uint8_t id, int x, int y, int w, int h,
+                   WidgetDrawFn draw, int split1 = 0, int split2 = 0);
+Widget* widget_find(WidgetPage& page, uint8_t id);
+
+// Make page the one touches go to and build its region table. Widgets
+// added afterwards are entered into the table as they are added.
+void widget_page_show(WidgetPage& page);
+
+// Widget under (x, y) and its zone (0..2), or nullptr if there is none or
+// page is not the one shown
+Widget* widget_hit(WidgetPage& page, int x, int y, int* zone = nullptr);
+
+// Mark a widget for the next widget_page_render_dirty()
+void widget_invalidate(WidgetPage& page, uint8_t id);
+void widget_invalidate_all(WidgetPage& page);
+
+// Draw every widget (the caller has cleared the page area)
+void widget_page_render(Arduino_GFX* gfx, WidgetPage& page);
+
+// Every widget is on screen as widget_page_render() draws it (its pixels
+// were put back from page_cache): clear the dirty marks
+void widget_page_mark_drawn(WidgetPage& page);
+
+// Clear and redraw the dirty widgets only. Returns true if any was drawn;
+// the caller then calls display_flush().
+bool widget_page_render_dirty(Arduino_GFX* gfx, WidgetPage& page);
+
+// Touch feedback: draw w with zone pressed, show it for hold_ms, and mark
+// w dirty so the next render puts its normal (or changed) state back
+void widget_press(Arduino_GFX* gfx, Widget* w, int zone, uint32_t hold_ms);
+
+#endif // WIDGETS_H
@@ -0,0 +1,110 @@
+/**
+ * Fast WiFi reconnect implementation for RadioWall.
+ *
+ * The record is only used while its SSID still matches the one WiFiManager
+ * has saved, so reconfiguring through the portal never joins a stale AP.
+ */
+
+#include "wifi_fast.h"
+#include "config.h"
+#include "state_store.h"
+#include "persist.h"
+#include <WiFi.h>
+#include <WiFiManager.h>
+
+extern WiFiManager wm;  // Defined in main.cpp
+
+struct WifiRecord {
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;           // Last DHCP lease (used with WIFI_REUSE_LEASE)
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+};
+
+static WifiRecord _record;             // Last saved, or pending flush
+static bool _have_record = false;
+static volatile bool _fast = false;
+
+static bool flush_record() {
+    if (!state_store_put(STATE_KEY_WIFI, &_record, sizeof(_record))) {
+        Serial.println("[WiFi] Failed to save AP record");
+        return false;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+static void begin_pinned(const uint8_t* bssid, uint8_t channel) {
+    Serial.printf("[WiFi] Fast connect: channel %d (%02X:%02X:%02X:%02X:%02X:%02X)\n",
+                  channel, bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+    WiFi.begin(wm.getWiFiSSID(true).c_str(), wm.getWiFiPass(true).c_str(), channel, bssid);
+    _fast = true;
+}
+
+bool wifi_fast_begin() {
+    _have_record = state_store_get(STATE_KEY_WIFI, &_record, sizeof(_record)) ==
+                   (int)sizeof(_record);
+    if (_have_record) _record.ssid[sizeof(_record.ssid) - 1] = '\0';
+
+    if (!_have_record || _record.channel == 0 || wm.getWiFiSSID(true) != _record.ssid) {
+        Serial.println("[WiFi] Connecting with saved credentials...");
+        WiFi.begin();
+        return false;
+    }
+
+#ifdef WIFI_REUSE_LEASE
+    if (_record.ip != 0) {
+        WiFi.config(IPAddress(_record.ip), IPAddress(_record.gateway),
+                    IPAddress(_record.subnet), IPAddress(_record.dns));
+    }
+#endif
+    begin_pinned(_record.bssid, _record.channel);
+    return true;
+}
+
+bool wifi_fast_begin_ap(const uint8_t* bssid, uint8_t channel) {
+    if (!bssid || channel == 0) return false;
+    begin_pinned(bssid, channel);
+    return true;
+}
+
+bool wifi_fast_attempted() {
+    return _fast;
+}
+
+void wifi_fast_fallback() {
+    Serial.println("[WiFi] Fast connect failed - scanning");
+    _fast = false;
+    WiFi.disconnect();
+#ifdef WIFI_REUSE_LEASE
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);   // Back to DHCP
+#endif
+    // Credentials again, without the BSSID/channel pin
+    WiFi.begin(wm.getWiFiSSID(true).c_str(), wm.getWiFiPass(true).c_str());
+}
+
+void wifi_fast_save() {
+    const uint8_t* bssid = WiFi.BSSID();
+    if (!bssid) return;
+
+    WifiRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    strncpy(rec.ssid, WiFi.SSID().c_str(), sizeof(rec.ssid) - 1);
+    memcpy(rec.bssid, bssid, sizeof(rec.bssid));
+    rec.channel = WiFi.channel();
+    rec.ip = (uint32_t)WiFi.localIP();
+    rec.gateway = (uint32_t)WiFi.gatewayIP();
+    rec.subnet = (uint32_t)WiFi.subnetMask();
+    rec.dns = (uint32_t)WiFi.dnsIP();
+
+    if (_have_record && memcmp(&rec, &_record, sizeof(rec)) == 0) return;
+    _record = rec;
+    _have_record = true;
+    persist_mark_dirty(flush_record);
+}
@@ -0,0 +1,38 @@
+/**
+ * Fast WiFi reconnect for RadioWall.
+ *
+ * After every successful connect the AP's BSSID and channel (and the DHCP
+ * lease) are kept in the state store. At boot wifi_fast_begin() joins that
+ * AP directly on that channel, skipping the scan; with WIFI_REUSE_LEASE
+ * defined in config.h it also reuses the lease as a static config, skipping
+ * DHCP. If the fast attempt hasn't associated within WIFI_FAST_CONNECT_MS,
+ * the network worker calls wifi_fast_fallback() for a normal scan + DHCP
+ * connect with the same credentials.
+ *
+ * Credentials themselves stay where WiFiManager saved them.
+ */
+
+#ifndef WIFI_FAST_H
+#define WIFI_FAST_H
+
+#include <Arduino.h>
+
+static const unsigned long WIFI_FAST_CONNECT_MS = 4000;
+
+// Start associating with the saved credentials (setup, state store ready).
+// Returns true if the fast path was taken.
+bool wifi_fast_begin();
+
+// Same, for an AP known without the state store (the wake snapshot)
+bool wifi_fast_begin_ap(const uint8_t* bssid, uint8_t channel);
+
+// Whether the current attempt is the fast one
+bool wifi_fast_attempted();
+
+// Fast attempt failed: drop the BSSID/static config and connect normally
+void wifi_fast_fallback();
+
+// Connected: remember the AP and lease for the next boot (loop task)
+void wifi_fast_save();
+
+#endif // WIFI_FAST_H
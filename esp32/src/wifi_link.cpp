@@ -0,0 +1,173 @@
+/**
+ * WiFi link manager implementation for RadioWall.
+ */
+
+#include "wifi_link.h"
+#include "https_pool.h"
+#include "web_remote.h"
+#include "loop_events.h"
+#include <WiFi.h>
+#include <WiFiManager.h>
+
+extern WiFiManager wm;  // Defined in main.cpp
+
+static const unsigned long RETRY_FIRST_MS = 500;
+static const unsigned long RETRY_MAX_MS = 8000;
+static const uint32_t PORTAL_POLL_MS = 20;        // wm.process() interval while open
+static const unsigned long PORTAL_CONNECT_S = 10; // Join with the entered credentials
+
+static volatile bool _link_up = false;   // Written by the WiFi event task
+static bool _reported_up = false;        // Last state the change callback saw
+static bool _was_up = false;             // Up once: drops are ours to rejoin
+static unsigned long _retry_ms = RETRY_FIRST_MS;
+static unsigned long _retry_at = 0;
+
+static bool _portal = false;
+static unsigned long _portal_start = 0;
+static unsigned long _portal_timeout = 0;   // 0: no timeout
+
+static void (*_change_cb)(bool) = nullptr;
+static void (*_portal_cb)(bool) = nullptr;
+
+// Arduino event task
+static void on_wifi_event(arduino_event_id_t event) {
+    switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+        _link_up = true;
+        break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+        _link_up = false;
+        break;
+    default:
+        return;
+    }
+    loop_events_notify();
+}
+
+void wifi_link_init() {
+    WiFi.onEvent(on_wifi_event, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent(on_wifi_event, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    WiFi.onEvent(on_wifi_event, ARDUINO_EVENT_WIFI_STA_LOST_IP);
+}
+
+bool wifi_link_up() {
+    return _link_up;
+}
+
+void wifi_link_set_change_callback(void (*cb)(bool up)) {
+    _change_cb = cb;
+}
+
+void wifi_link_set_portal_callback(void (*cb)(bool connected)) {
+    _portal_cb = cb;
+}
+
+// ------------------------------------------------------------------
+// Portal
+// ------------------------------------------------------------------
+
+void wifi_link_portal_start(unsigned long timeout_ms) {
+    if (_portal) return;
+    Serial.printf("[WiFi] Portal \"%s\" open", WIFI_LINK_PORTAL_SSID);
+    if (timeout_ms) Serial.printf(" for %lu s", timeout_ms / 1000);
+    Serial.println();
+
+    // Pooled TLS connections won't survive the WiFi mode switch, and the
+    // portal's web server needs port 80
+    https_pool_close_all();
+    web_remote_suspend(true);
+
+    wm.setConfigPortalBlocking(false);
+    wm.setConnectTimeout(PORTAL_CONNECT_S);
+    wm.startConfigPortal(WIFI_LINK_PORTAL_SSID);
+    _portal = true;
+    _portal_start = millis();
+    _portal_timeout = timeout_ms;
+    loop_events_notify();
+}
+
+static void portal_close(bool connected) {
+    wm.stopConfigPortal();
+    web_remote_suspend(false);
+    _portal = false;
+    _retry_ms = RETRY_FIRST_MS;
+    _retry_at = millis() + _retry_ms;
+    if (_portal_cb) _portal_cb(connected);
+}
+
+void wifi_link_portal_cancel() {
+    if (!_portal) return;
+    Serial.println("[WiFi] Portal cancelled");
+    portal_close(false);
+}
+
+bool wifi_link_portal_active() {
+    return _portal;
+}
+
+unsigned long wifi_link_portal_remaining_ms() {
+    if (!_portal || !_portal_timeout) return 0;
+    unsigned long open = millis() - _portal_start;
+    return open < _portal_timeout ? _portal_timeout - open : 1;
+}
+
+static void portal_task() {
+    if (wm.process()) {   // Credentials entered and joined
+        Serial.printf("[WiFi] Connected via portal: %s\n",
+                      WiFi.localIP().toString().c_str());
+        portal_close(true);
+        return;
+    }
+    if (_portal_timeout && millis() - _portal_start >= _portal_timeout) {
+        Serial.println("[WiFi] Portal timed out");
+        portal_close(false);
+        return;
+    }
+    loop_events_due_in(PORTAL_POLL_MS);
+}
+
+// ------------------------------------------------------------------
+// Loop
+// ------------------------------------------------------------------
+
+void wifi_link_task() {
+    bool up = _link_up;
+    if (up != _reported_up) {
+        _reported_up = up;
+        if (up) {
+            // The first time is the worker's connect, which reports it itself
+            bool back = _was_up;
+            _was_up = true;
+            if (back) {
+                Serial.printf("[WiFi] Link back: %s\n", WiFi.localIP().toString().c_str());
+                if (_change_cb) _change_cb(true);
+            }
+        } else if (_was_up) {
+            _retry_ms = RETRY_FIRST_MS;
+            _retry_at = millis() + _retry_ms;
+            Serial.println("[WiFi] Link lost, reconnecting");
+            if (_change_cb) _change_cb(false);
+        }
+    }
+
+    if (_portal) {
+        portal_task();
+        return;
+    }
+
+    // The worker makes the first connect; after that, drops are rejoined here
+    if (up || !_was_up) return;
+    long wait = (long)(_retry_at - millis());
+    if (wait > 0) {
+        loop_events_due_in(wait);
+        return;
+    }
+    _retry_ms = min(_retry_ms * 2, RETRY_MAX_MS);
+    if (WiFi.status() != WL_CONNECTED) {
+        Serial.printf("[WiFi] Reconnect (next in %lu ms)\n", _retry_ms);
+        WiFi.reconnect();
+    }
+    _retry_at = millis() + _retry_ms;
+    loop_events_due_in(_retry_ms);
+}
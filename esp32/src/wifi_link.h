@@ -0,0 +1,58 @@
+/**
+ * WiFi link manager for RadioWall.
+ *
+ * Keeps the station link and the captive portal off the loop's critical
+ * path. WiFi events mark the link up (an IP) or down; wifi_link_up() is
+ * what network code checks before a request, so while the link is down
+ * requests fail at once instead of running into their timeouts. A link
+ * that was up and drops is rejoined from wifi_link_task() with
+ * WiFi.reconnect() after 0.5, 1, 2 and 4 s, then every 8 s.
+ *
+ * The WiFiManager portal is non-blocking: wifi_link_task() serves it one
+ * wm.process() per loop pass, so the display, touch and the button keep
+ * working while it is open. It closes when the credentials entered in it
+ * connect, on wifi_link_portal_cancel(), or after its timeout, and the
+ * closed callback gets the outcome. The first connect at boot and the
+ * one after the portal stay with the network worker (net_worker_connect).
+ *
+ * Loop task, except wifi_link_up() (any task).
+ */
+
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+#include <Arduino.h>
+
+// Portal SSID (open network, pages at 192.168.4.1)
+#define WIFI_LINK_PORTAL_SSID "RadioWall"
+
+// Portal opened from settings or after a failed connect
+static const unsigned long WIFI_LINK_PORTAL_TIMEOUT_MS = 3UL * 60 * 1000;
+
+// Register the WiFi event handlers (setup, before association starts)
+void wifi_link_init();
+
+// Associated and holding an IP address (any task)
+bool wifi_link_up();
+
+// Reconnect retries, the portal and the callbacks (call from loop)
+void wifi_link_task();
+
+// Called from wifi_link_task() when a link that was up drops (false) and
+// when it is back (true)
+void wifi_link_set_change_callback(void (*cb)(bool up));
+
+// Open the portal; timeout_ms 0 keeps it open until it is used or
+// cancelled. Pooled connections are closed and the web remote gives up
+// port 80 while it is open.
+void wifi_link_portal_start(unsigned long timeout_ms);
+void wifi_link_portal_cancel();
+bool wifi_link_portal_active();
+
+// Milliseconds until the portal closes by itself (0: open, no timeout)
+unsigned long wifi_link_portal_remaining_ms();
+
+// The portal closed; connected: it joined the network entered in it
+void wifi_link_set_portal_callback(void (*cb)(bool connected));
+
+#endif // WIFI_LINK_H
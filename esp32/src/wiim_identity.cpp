@@ -0,0 +1,360 @@
+/**
+ * Primary WiiM identity implementation for RadioWall.
+ *
+ * One task on core 0 (next to the network worker) learns the UUID and
+ * does the re-resolves; the identity is shared with the loop and worker
+ * under _mux. A resolve tries, in order:
+ *
+ *   1. the cached hostname (MDNS.queryHost, one round trip on the LAN)
+ *   2. a _linkplay._tcp browse, matching the hostname
+ *   3. the browsed devices' UUIDs, if the hostname is unknown or changed
+ *
+ * and accepts an address only if getStatusEx there reports the cached
+ * UUID (when one is known). At most one resolve per RESOLVE_MIN_MS, so a
+ * speaker that is simply off costs one wait, not one per command.
+ */
+
+#include "wiim_identity.h"
+#include "linkplay_client.h"
+#include "state_store.h"
+#include "persist.h"
+#include "loop_events.h"
+#include "serial_cmd.h"
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const uint32_t TASK_STACK = 6144;                 // linkplay requests (TLS)
+static const UBaseType_t TASK_PRIORITY = 1;
+static const BaseType_t TASK_CORE = 0;
+static const unsigned long LEARN_RETRY_MS = 60UL * 1000; // UUID not learned yet
+static const unsigned long RESOLVE_MIN_MS = 30UL * 1000;
+static const uint32_t QUERY_HOST_MS = 1000;
+static const int MAX_UUID_CHECKS = 4;                    // Browsed devices asked for their UUID
+
+struct IdentityRecord {
+    char ip[16];
+    char hostname[48];
+    char uuid[40];
+};
+
+enum ResolveState : uint8_t {
+    RESOLVE_IDLE,
+    RESOLVE_PENDING,
+    RESOLVE_RUNNING,
+};
+
+// Guarded by _mux
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static IdentityRecord _id;
+static char _moved_from[16] = "";        // Last address the primary left
+static bool _dirty = false;              // Persist on the next loop pass
+static bool _moved_pending = false;      // Callback on the next loop pass
+static ResolveState _resolve = RESOLVE_IDLE;
+static uint32_t _resolve_gen = 0;        // Bumped when a resolve finishes
+static unsigned long _resolved_at = 0;   // millis(); 0 = never
+
+static TaskHandle_t _task = nullptr;
+static DeviceMovedCallback _moved_cb = nullptr;
+static uint32_t _resolves = 0;
+static uint32_t _moves = 0;
+
+static void copy_str(char* dst, size_t size, const char* src) {
+    strncpy(dst, src ? src : "", size - 1);
+    dst[size - 1] = '\0';
+}
+
+// An IP-looking name is not a hostname (settings falls back to the IP)
+static bool is_hostname(const char* name) {
+    IPAddress ip;
+    return name[0] && !ip.fromString(name);
+}
+
+// ------------------------------------------------------------------
+// Resolver task
+// ------------------------------------------------------------------
+
+// UUID reported by the device at ip ("" if none)
+static void fetch_uuid(const char* ip, char* uuid, size_t cap) {
+    uuid[0] = '\0';
+    String status = linkplay_request_to(ip, "getStatusEx", 0);
+    int key = status.indexOf("\"uuid\"");
+    if (key < 0) return;
+    int start = status.indexOf('"', status.indexOf(':', key) + 1);
+    int end = start < 0 ? -1 : status.indexOf('"', start + 1);
+    if (end <= start + 1 || end - start - 1 >= (int)cap) return;
+    memcpy(uuid, status.c_str() + start + 1, end - start - 1);
+    uuid[end - start - 1] = '\0';
+}
+
+static void learn_uuid() {
+    IdentityRecord id;
+    portENTER_CRITICAL(&_mux);
+    id = _id;
+    portEXIT_CRITICAL(&_mux);
+    if (!id.ip[0] || id.uuid[0]) return;
+
+    char uuid[sizeof(id.uuid)];
+    fetch_uuid(id.ip, uuid, sizeof(uuid));
+    if (!uuid[0]) return;
+
+    portENTER_CRITICAL(&_mux);
+    bool same = strcmp(_id.ip, id.ip) == 0;
+    if (same) {
+        copy_str(_id.uuid, sizeof(_id.uuid), uuid);
+        _dirty = true;
+    }
+    portEXIT_CRITICAL(&_mux);
+    if (!same) return;
+    Serial.printf("[WiiM] %s is %s\n", id.ip, uuid);
+    loop_events_notify();
+}
+
+// Is the device at ip the one we know? Without a cached UUID, a hostname
+// match is all there is to go on.
+static bool verify(const char* ip, const IdentityRecord& id, bool hostname_match) {
+    if (!id.uuid[0]) return hostname_match;
+    char uuid[sizeof(id.uuid)];
+    fetch_uuid(ip, uuid, sizeof(uuid));
+    return strcmp(uuid, id.uuid) == 0;
+}
+
+// Find the primary's current address; false if it is still (or only) at id.ip
+static bool find_primary(const IdentityRecord& id, char* found, size_t cap) {
+    bool named = is_hostname(id.hostname);
+
+    if (named) {
+        IPAddress ip = MDNS.queryHost(id.hostname, QUERY_HOST_MS);
+        String s = ip.toString();
+        if ((uint32_t)ip != 0 && s != id.ip && verify(s.c_str(), id, true)) {
+            copy_str(found, cap, s.c_str());
+            return true;
+        }
+    }
+
+    int n = MDNS.queryService("linkplay", "tcp");
+    char others[MAX_UUID_CHECKS][16];
+    int other_count = 0;
+    for (int i = 0; i < n; i++) {
+        String s = MDNS.IP(i).toString();
+        if (s == id.ip || (uint32_t)MDNS.IP(i) == 0) continue;
+        if (named && MDNS.hostname(i) == id.hostname) {
+            if (verify(s.c_str(), id, true)) {
+                copy_str(found, cap, s.c_str());
+                return true;
+            }
+        } else if (other_count < MAX_UUID_CHECKS) {
+            copy_str(others[other_count++], sizeof(others[0]), s.c_str());
+        }
+    }
+
+    // Renamed, or never had a hostname: only a UUID match will do
+    if (!id.uuid[0]) return false;
+    for (int i = 0; i < other_count; i++) {
+        if (verify(others[i], id, false)) {
+            copy_str(found, cap, others[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void run_resolve() {
+    IdentityRecord id;
+    portENTER_CRITICAL(&_mux);
+    id = _id;
+    _resolve = RESOLVE_RUNNING;
+    portEXIT_CRITICAL(&_mux);
+
+    unsigned long start = millis();
+    char found[16] = "";
+    bool moved = id.ip[0] && find_primary(id, found, sizeof(found));
+    _resolves++;
+
+    portENTER_CRITICAL(&_mux);
+    moved = moved && strcmp(_id.ip, id.ip) == 0;   // Not replaced meanwhile
+    if (moved) {
+        copy_str(_moved_from, sizeof(_moved_from), _id.ip);
+        copy_str(_id.ip, sizeof(_id.ip), found);
+        _dirty = true;
+        _moved_pending = true;
+    }
+    _resolve = RESOLVE_IDLE;
+    _resolved_at = millis() | 1;
+    _resolve_gen++;
+    portEXIT_CRITICAL(&_mux);
+
+    if (moved) {
+        _moves++;
+        Serial.printf("[WiiM] Moved %s -> %s (%lu ms)\n", id.ip, found, millis() - start);
+        loop_events_notify();
+    } else {
+        Serial.printf("[WiiM] %s not found elsewhere (%lu ms)\n", id.ip, millis() - start);
+    }
+}
+
+static void identity_task(void*) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LEARN_RETRY_MS));
+        if (WiFi.status() != WL_CONNECTED) continue;
+
+        portENTER_CRITICAL(&_mux);
+        bool pending = _resolve == RESOLVE_PENDING;
+        portEXIT_CRITICAL(&_mux);
+        if (pending) {
+            run_resolve();
+        } else {
+            learn_uuid();
+        }
+    }
+}
+
+// ------------------------------------------------------------------
+// Persistence (loop task)
+// ------------------------------------------------------------------
+
+static bool save_identity() {
+    IdentityRecord rec;
+    portENTER_CRITICAL(&_mux);
+    rec = _id;
+    portEXIT_CRITICAL(&_mux);
+    return state_store_put(STATE_KEY_WIIM_IDENTITY, &rec, sizeof(rec));
+}
+
+void wiim_identity_init() {
+    IdentityRecord rec;
+    if (state_store_get(STATE_KEY_WIIM_IDENTITY, &rec, sizeof(rec)) != (int)sizeof(rec)) return;
+    rec.ip[sizeof(rec.ip) - 1] = '\0';
+    rec.hostname[sizeof(rec.hostname) - 1] = '\0';
+    rec.uuid[sizeof(rec.uuid) - 1] = '\0';
+    portENTER_CRITICAL(&_mux);
+    _id = rec;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void wiim_identity_task() {
+    portENTER_CRITICAL(&_mux);
+    bool dirty = _dirty;
+    bool moved = _moved_pending;
+    char from[16], to[16];
+    copy_str(from, sizeof(from), _moved_from);
+    copy_str(to, sizeof(to), _id.ip);
+    _dirty = false;
+    _moved_pending = false;
+    portEXIT_CRITICAL(&_mux);
+
+    if (dirty) persist_mark_dirty(save_identity);
+    if (moved && _moved_cb) _moved_cb(from, to);
+}
+
+void wiim_identity_set_moved_callback(DeviceMovedCallback cb) {
+    _moved_cb = cb;
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+void wiim_identity_set(const char* ip, const char* hostname) {
+    if (!ip || !ip[0]) return;
+    portENTER_CRITICAL(&_mux);
+    bool same_ip = strcmp(_id.ip, ip) == 0;
+    bool same_host = strcmp(_id.hostname, hostname ? hostname : "") == 0;
+    if (!same_ip || !same_host) {
+        // Another device (or one re-picked under a new name): learn again
+        if (!(same_host && is_hostname(_id.hostname))) _id.uuid[0] = '\0';
+        copy_str(_id.ip, sizeof(_id.ip), ip);
+        copy_str(_id.hostname, sizeof(_id.hostname), hostname);
+        _moved_from[0] = '\0';
+        _dirty = true;
+    }
+    portEXIT_CRITICAL(&_mux);
+    if (_task) xTaskNotifyGive(_task);
+}
+
+void wiim_identity_start() {
+    if (_task) return;
+    if (xTaskCreatePinnedToCore(identity_task, "wiim_identity", TASK_STACK, nullptr,
+                                TASK_PRIORITY, &_task, TASK_CORE) != pdPASS) {
+        Serial.println("[WiiM] Failed to start identity task");
+        _task = nullptr;
+    }
+}
+
+// Queue a resolve; true if one is queued or running
+static bool start_resolve(const char* ip) {
+    if (!_task || !ip) return false;
+    unsigned long now = millis();
+    portENTER_CRITICAL(&_mux);
+    bool ours = strcmp(ip, _id.ip) == 0;
+    bool busy = _resolve != RESOLVE_IDLE;
+    bool recent = _resolved_at && now - _resolved_at < RESOLVE_MIN_MS;
+    bool start = ours && !busy && !recent;
+    if (start) _resolve = RESOLVE_PENDING;
+    portEXIT_CRITICAL(&_mux);
+    if (start) xTaskNotifyGive(_task);
+    return ours && (busy || start);
+}
+
+void wiim_identity_suspect(const char* ip) {
+    if (start_resolve(ip)) Serial.printf("[WiiM] %s not answering, resolving\n", ip);
+}
+
+// Already moved away from ip: the new address
+static bool moved_from(const char* ip, char* new_ip, size_t cap) {
+    portENTER_CRITICAL(&_mux);
+    bool moved = _moved_from[0] && strcmp(_moved_from, ip) == 0;
+    if (moved) copy_str(new_ip, cap, _id.ip);
+    portEXIT_CRITICAL(&_mux);
+    return moved;
+}
+
+bool wiim_identity_relocate(const char* ip, char* new_ip, size_t cap, unsigned long wait_ms) {
+    // The resolver's own requests to the old address must not wait on it
+    if (!_task || xTaskGetCurrentTaskHandle() == _task) return false;
+    if (moved_from(ip, new_ip, cap)) return true;
+
+    portENTER_CRITICAL(&_mux);
+    uint32_t gen = _resolve_gen;
+    portEXIT_CRITICAL(&_mux);
+    if (!start_resolve(ip)) return false;
+
+    unsigned long start = millis();
+    while (millis() - start < wait_ms) {
+        vTaskDelay(pdMS_TO_TICKS(20));
+        portENTER_CRITICAL(&_mux);
+        bool done = _resolve_gen != gen;
+        portEXIT_CRITICAL(&_mux);
+        if (done) break;
+    }
+    return moved_from(ip, new_ip, cap);
+}
+
+// ------------------------------------------------------------------
+// Serial command
+// ------------------------------------------------------------------
+
+// WIIM - Cached identity of the primary, resolves and moves (WIIM:resolve
+// looks it up again now)
+static void cmd_wiim(const char* args) {
+    IdentityRecord id;
+    portENTER_CRITICAL(&_mux);
+    id = _id;
+    if (args && strcmp(args, "resolve") == 0 && _resolve == RESOLVE_IDLE && _id.ip[0]) {
+        _resolve = RESOLVE_PENDING;
+        _resolved_at = 0;
+    }
+    portEXIT_CRITICAL(&_mux);
+
+    Serial.printf("[WiiM] %s  host %s  uuid %s\n", id.ip[0] ? id.ip : "(none)",
+                  id.hostname[0] ? id.hostname : "(unknown)", id.uuid[0] ? id.uuid : "(not learned)");
+    Serial.printf("[WiiM] %lu resolve(s), %lu move(s)%s\n", (unsigned long)_resolves,
+                  (unsigned long)_moves, _task ? "" : ", resolver not started (no WiFi yet)");
+    if (_task && args && strcmp(args, "resolve") == 0) xTaskNotifyGive(_task);
+}
+
+void wiim_identity_serial_init() {
+    serial_cmd_register("WIIM", cmd_wiim);
+    serial_cmd_register("WIIM:", cmd_wiim);
+}
@@ -0,0 +1,50 @@
+/**
+ * Primary WiiM identity for RadioWall.
+ *
+ * The primary speaker is addressed by IP, but identified by its mDNS
+ * hostname and its LinkPlay UUID (getStatusEx), cached with the IP in the
+ * state store. When the saved IP stops answering (DHCP gave the speaker a
+ * new lease), a background task resolves the hostname again, falls back to
+ * browsing _linkplay._tcp, and checks the UUID of what it finds, so an
+ * unrelated device that took over the old address is never adopted.
+ *
+ * linkplay_client asks for the new address after the first failed attempt
+ * to the master and retargets the same command, instead of spending its
+ * remaining retries on the dead address. A move found by a background
+ * resolve reaches linkplay through the moved callback instead.
+ */
+
+#ifndef WIIM_IDENTITY_H
+#define WIIM_IDENTITY_H
+
+#include <Arduino.h>
+
+// Called on the loop task after the primary was found at a new address
+typedef void (*DeviceMovedCallback)(const char* old_ip, const char* new_ip);
+
+// Load the cached identity (call after state_store_init())
+void wiim_identity_init();
+
+// The primary changed (loop). hostname is the mDNS name it was found
+// under ("" if unknown); the UUID is learned in the background.
+void wiim_identity_set(const char* ip, const char* hostname);
+
+// Start the resolver task (once WiFi and mDNS are up; later calls do nothing)
+void wiim_identity_start();
+
+// ip stopped answering: re-resolve in the background (any task, returns
+// at once; ignored for other devices or if resolved recently)
+void wiim_identity_suspect(const char* ip);
+
+// Same, then wait up to wait_ms for the answer (network worker). True if
+// the primary now answers at another address, copied into new_ip.
+bool wiim_identity_relocate(const char* ip, char* new_ip, size_t cap, unsigned long wait_ms);
+
+// Persist changes and report a move (call from loop)
+void wiim_identity_task();
+void wiim_identity_set_moved_callback(DeviceMovedCallback cb);
+
+// Register the WIIM serial command (cached identity, resolves, moves)
+void wiim_identity_serial_init();
+
+#endif // WIIM_IDENTITY_H
@@ -1,16 +1,42 @@
 /**
  * World Map Rendering Implementation
  *
- * RLE Format: Byte pairs [count, color]
+ * 1x maps: stored in PROGMEM (world_map_data.h) as byte pairs [count, color]
  * - count: Number of pixels
  * - color: 0 = black (ocean), 1 = white (land), 2 = gray (border)
  *
- * 1x maps: stored in PROGMEM (world_map_data.h)
- * 2x/3x maps: stored in LittleFS (/maps/zoom2.bin, /maps/zoom3.bin)
+ * 2x-5x maps: fixed-size tiles in one LittleFS tile pyramid (/maps/tiles.bin,
+ * format in tools/pack_map_tiles.py) as varint runs with the colour in the
+ * low two bits, optionally LZ4-compressed per tile. A zoomed view is any
+ * 180x580 window of the zoomed slice, composed from the tiles it overlaps.
+ * A copy of tiles.bin flashed to the raw "maps" partition takes precedence:
+ * it is memory-mapped, and tiles decode straight from flash.
+ *
+ * With PSRAM, each 1x slice is decoded the first time it is shown and kept
+ * as a 2-bit indexed bitmap (26 KB), expanded to RGB565 band by band as it
+ * streams out, so switching slices costs no RLE decoding. Zoom tiles go
+ * through a decoded-tile cache of the same format; after each zoomed draw
+ * a background task decodes the tiles of the four views a swipe reaches,
+ * and the tiles a cold view is missing are decoded on both cores.
+ * With a vector map (vector_map.cpp) zoomed views are rasterized from it
+ * instead, and zoom goes past the last tile level. Packed views get the
+ * city dots (city_dots.cpp) stamped in before they are drawn.
  */
 
 #include "world_map.h"
+#include "vector_map.h"
+#include "city_dots.h"
+#include "display.h"
+#include "theme.h"
+#include "binlog.h"
+#include "asset_fs.h"
+#include "hot_path.h"
 #include <LittleFS.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 
 // Real map data generated from Natural Earth
 #include "world_map_data.h"
@@ -22,142 +48,1344 @@ static inline uint16_t rle_color(uint8_t c) {
     return WHITE;               // Land
 }
 
-/**
- * Draw RLE-compressed map bitmap from PROGMEM at specified position
- */
-void draw_map_slice(Arduino_GFX* gfx, const uint8_t* rle_data, size_t size, int offset_x, int offset_y) {
-    unsigned long start = millis();
+// Palette index for the packed format (same mapping as rle_color)
+static inline uint8_t rle_index(uint8_t c) {
+    return c == 0 ? 0 : (c == 2 ? 2 : 1);
+}
+
+// Index 3 is only ever set by the city dot overlay
+static const uint16_t MAP_PALETTE[4] = {BLACK, WHITE, 0x8410, 0xFD20};
+
+// ------------------------------------------------------------------
+// Band writer: RLE runs are expanded into a buffer of whole rows, and each
+// full band goes out as one draw16bitRGBBitmap (one address window, one
+// writePixels) instead of a drawFastHLine per run.
+//
+// Drawing into the display framebuffer skips the band: the map is as wide
+// as the screen, so its rows are one contiguous span of it, and runs and
+// packed pixels are expanded straight into place, wrapping rows for free.
+// ------------------------------------------------------------------
 
-    int x = 0, y = 0;
+static const int BAND_ROWS = 16;
+static const size_t BAND_PIXELS = (size_t)BAND_ROWS * MAP_WIDTH;
+static const size_t MAP_PIXELS = (size_t)MAP_WIDTH * MAP_HEIGHT;
+alignas(4) static uint16_t _band[BAND_PIXELS];   // 5.6 KB
+
+// Fill n pixels with one colour, two per 32-bit store once aligned
+static HOT_PATH void fill_pixels(uint16_t* dst, uint16_t color, size_t n) {
+    if (n > 0 && ((uintptr_t)dst & 2)) {
+        *dst++ = color;
+        n--;
+    }
+    uint32_t pair = ((uint32_t)color << 16) | color;
+    uint32_t* d = (uint32_t*)dst;
+    size_t words = n >> 1;
+    for (; words >= 4; words -= 4, d += 4) {
+        d[0] = pair;
+        d[1] = pair;
+        d[2] = pair;
+        d[3] = pair;
+    }
+    while (words-- > 0) *d++ = pair;
+    if (n & 1) *(uint16_t*)d = color;
+}
+
+// The map's rows in the display framebuffer when gfx draws into it at
+// (offset_x, offset_y), else nullptr
+static uint16_t* framebuffer_target(Arduino_GFX* gfx, int offset_x, int offset_y) {
+    uint16_t* fb = display_framebuffer();
+    if (!fb || gfx != display_get_gfx() || offset_x != 0 || MAP_WIDTH != TH_DISPLAY_W ||
+        offset_y < 0 || offset_y + MAP_HEIGHT > gfx->height()) {
+        return nullptr;
+    }
+    return fb + (size_t)offset_y * TH_DISPLAY_W;
+}
+
+struct BandWriter {
+    Arduino_GFX* gfx;
+    int offset_x;
+    int offset_y;
+    int band_y;        // Map row of _band[0]
+    size_t fill;       // Pixels in _band
+    size_t emitted;    // Pixels written so far (whole map)
+};
+
+static void band_begin(BandWriter& w, Arduino_GFX* gfx, int offset_x, int offset_y) {
+    w.gfx = gfx;
+    w.offset_x = offset_x;
+    w.offset_y = offset_y;
+    w.band_y = 0;
+    w.fill = 0;
+    w.emitted = 0;
+}
+
+static void band_flush(BandWriter& w) {
+    int rows = w.fill / MAP_WIDTH;
+    if (rows == 0) return;
+    w.gfx->draw16bitRGBBitmap(w.offset_x, w.offset_y + w.band_y, _band, MAP_WIDTH, rows);
+    w.band_y += rows;
+    w.fill = 0;
+}
+
+static void band_put(BandWriter& w, uint16_t color, size_t count) {
+    count = min(count, MAP_PIXELS - w.emitted);
+    w.emitted += count;
+    while (count > 0) {
+        size_t n = min(count, BAND_PIXELS - w.fill);
+        fill_pixels(_band + w.fill, color, n);
+        w.fill += n;
+        count -= n;
+        if (w.fill == BAND_PIXELS) band_flush(w);
+    }
+}
+
+// Fill whatever the RLE didn't cover with black and send the last band
+static void band_end(BandWriter& w) {
+    band_put(w, BLACK, MAP_PIXELS - w.emitted);
+    band_flush(w);
+}
+
+static bool band_done(const BandWriter& w) {
+    return w.emitted >= MAP_PIXELS;
+}
+
+// Draw a whole RLE bitmap (PROGMEM or RAM) through the band writer
+static void draw_rle_bands(Arduino_GFX* gfx, const uint8_t* rle_data, size_t size,
+                           int offset_x, int offset_y) {
+    uint16_t* fb = framebuffer_target(gfx, offset_x, offset_y);
+    if (fb) {
+        size_t pos = 0;
+        for (size_t idx = 0; idx + 1 < size && pos < MAP_PIXELS; idx += 2) {
+            uint8_t count = pgm_read_byte(&rle_data[idx]);
+            uint8_t color = pgm_read_byte(&rle_data[idx + 1]);
+            if (count == 0 && color == 0) break;
+            size_t n = min((size_t)count, MAP_PIXELS - pos);
+            fill_pixels(fb + pos, rle_color(color), n);
+            pos += n;
+        }
+        fill_pixels(fb + pos, BLACK, MAP_PIXELS - pos);
+        return;
+    }
+
+    BandWriter w;
+    band_begin(w, gfx, offset_x, offset_y);
     size_t idx = 0;
 
-    while (idx < size - 1) {
+    while (idx + 1 < size && !band_done(w)) {
         uint8_t count = pgm_read_byte(&rle_data[idx++]);
         uint8_t color = pgm_read_byte(&rle_data[idx++]);
 
         if (count == 0 && color == 0) break;
+        band_put(w, rle_color(color), count);
+    }
+    band_end(w);
+}
 
-        uint16_t display_color = rle_color(color);
-        int remaining = count;
+// Four packed pixels (one byte) as two RGB565 pixel pairs
+static uint32_t (*_quad_lut)[2] = nullptr;   // 256 entries, 2 KB
 
-        while (remaining > 0 && y < MAP_HEIGHT) {
-            int pixels_this_row = min(remaining, MAP_WIDTH - x);
-            gfx->drawFastHLine(offset_x + x, offset_y + y, pixels_this_row, display_color);
-            remaining -= pixels_this_row;
-            x += pixels_this_row;
-            if (x >= MAP_WIDTH) { x = 0; y++; }
+static bool build_quad_lut() {
+    if (_quad_lut) return true;
+    _quad_lut = (uint32_t(*)[2])malloc(256 * sizeof(*_quad_lut));
+    if (!_quad_lut) return false;
+    for (int b = 0; b < 256; b++) {
+        for (int half = 0; half < 2; half++) {
+            uint16_t lo = MAP_PALETTE[(b >> (half * 4)) & 3];
+            uint16_t hi = MAP_PALETTE[(b >> (half * 4 + 2)) & 3];
+            _quad_lut[b][half] = ((uint32_t)hi << 16) | lo;   // Little-endian: lo first
         }
+    }
+    return true;
+}
 
-        if (y >= MAP_HEIGHT) break;
+// Expand packed bytes [first, first + bytes) into dst, four pixels per byte.
+// dst must be 32-bit aligned.
+static HOT_PATH void expand_packed(uint16_t* dst, const uint8_t* packed, size_t first,
+                                   size_t bytes) {
+    uint32_t* d = (uint32_t*)dst;
+    for (size_t i = 0; i < bytes; i++) {
+        const uint32_t* q = _quad_lut[packed[first + i]];
+        d[0] = q[0];
+        d[1] = q[1];
+        d += 2;
     }
+}
 
-    // Fill remainder with black
-    while (y < MAP_HEIGHT) {
-        if (x < MAP_WIDTH) {
-            gfx->drawFastHLine(offset_x + x, offset_y + y, MAP_WIDTH - x, BLACK);
+// Stream a packed 2-bit bitmap, expanding one band at a time
+static void draw_packed_bands(Arduino_GFX* gfx, const uint8_t* packed,
+                              int offset_x, int offset_y) {
+    bool lut = build_quad_lut();
+    uint16_t* fb = framebuffer_target(gfx, offset_x, offset_y);
+    if (fb && lut && ((uintptr_t)fb & 3) == 0) {
+        expand_packed(fb, packed, 0, MAP_PACKED_BYTES);
+        return;
+    }
+
+    for (int y = 0; y < MAP_HEIGHT; y += BAND_ROWS) {
+        int rows = min(BAND_ROWS, MAP_HEIGHT - y);
+        size_t first = (size_t)y * MAP_WIDTH;
+        size_t count = (size_t)rows * MAP_WIDTH;
+        if (lut) {
+            expand_packed(_band, packed, first >> 2, count >> 2);   // Bands are whole bytes
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                size_t p = first + i;
+                _band[i] = MAP_PALETTE[(packed[p >> 2] >> ((p & 3) * 2)) & 3];
+            }
         }
-        x = 0;
-        y++;
+        gfx->draw16bitRGBBitmap(offset_x, offset_y + y, _band, MAP_WIDTH, rows);
     }
+}
 
-    Serial.printf("[WorldMap] Map drawn in %lu ms\n", millis() - start);
+// ------------------------------------------------------------------
+// Base layer: a copy of the map view on screen. Overlays (marker, touch
+// feedback) are drawn on top and erased by restoring the pixels they
+// covered from here, so land under a marker survives it moving.
+// ------------------------------------------------------------------
+
+static uint8_t* _base_layer = nullptr;   // Packed, MAP_PACKED_BYTES
+static bool _base_valid = false;         // False if the view was drawn straight from RLE
+static int _base_x = 0;
+static int _base_y = 0;
+static MapView _base_view = {0, -1, 0, 0};   // What it shows (1x: zoom 1 at 0,0)
+
+static void set_base_layer(const uint8_t* packed, const MapView& view,
+                           int offset_x, int offset_y) {
+    if (!_base_layer) _base_layer = (uint8_t*)ps_malloc(MAP_PACKED_BYTES);
+    _base_valid = _base_layer != nullptr;
+    if (!_base_valid) return;
+    memcpy(_base_layer, packed, MAP_PACKED_BYTES);
+    _base_view = view;
+    _base_x = offset_x;
+    _base_y = offset_y;
+}
+
+bool world_map_restore(Arduino_GFX* gfx, int x, int y, int w, int h) {
+    if (!_base_valid) return false;
+
+    // Clip to the map
+    int x0 = max(x, _base_x);
+    int y0 = max(y, _base_y);
+    int x1 = min(x + w, _base_x + MAP_WIDTH);
+    int y1 = min(y + h, _base_y + MAP_HEIGHT);
+    if (x0 >= x1 || y0 >= y1) return true;
+
+    uint16_t row_buf[MAP_WIDTH];
+    for (int py = y0; py < y1; py++) {
+        size_t p = (size_t)(py - _base_y) * MAP_WIDTH + (x0 - _base_x);
+        for (int i = 0; i < x1 - x0; i++, p++) {
+            row_buf[i] = MAP_PALETTE[(_base_layer[p >> 2] >> ((p & 3) * 2)) & 3];
+        }
+        gfx->draw16bitRGBBitmap(x0, py, row_buf, x1 - x0, 1);
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Work buffers: PSRAM if there is some, internal RAM otherwise
+// ------------------------------------------------------------------
+
+static void* map_alloc(size_t bytes) {
+    void* p = nullptr;
+    if (psramFound()) p = ps_malloc(bytes);
+    if (!p) p = malloc(bytes);
+    return p;
+}
+
+static bool reserve_buf(uint8_t*& buf, size_t& cap, size_t bytes) {
+    if (bytes <= cap) return true;
+    free(buf);
+    buf = (uint8_t*)map_alloc(bytes);
+    cap = buf ? bytes : 0;
+    return buf != nullptr;
+}
+
+static uint8_t* _view_buf = nullptr;   // Packed, MAP_PACKED_BYTES: the view being drawn
+static size_t _view_buf_cap = 0;
+
+// ------------------------------------------------------------------
+// Decoded 1x slice cache (PSRAM)
+// ------------------------------------------------------------------
+
+static const int SLICE_CACHE_MAX = 4;   // One per 1x slice
+
+struct DecodedSlice {
+    const uint8_t* rle;    // Source RLE (key)
+    uint8_t* packed;       // MAP_WIDTH x MAP_HEIGHT, 2 bits per pixel
+};
+static DecodedSlice _slice_cache[SLICE_CACHE_MAX];
+static int _slice_cache_count = 0;
+static bool _slice_cache_failed = false;   // Stop trying once PSRAM ran out
+
+// Set pixels [pos, end) of a zeroed packed bitmap to index, whole bytes at a time
+static HOT_PATH void pack_run(uint8_t* out, size_t pos, size_t end, uint8_t index) {
+    if (index == 0) return;   // Already zero
+    for (; pos < end && (pos & 3); pos++) out[pos >> 2] |= index << ((pos & 3) * 2);
+    if (end - pos >= 4) {
+        size_t bytes = (end - pos) >> 2;
+        memset(out + (pos >> 2), index * 0x55, bytes);
+        pos += bytes * 4;
+    }
+    for (; pos < end; pos++) out[pos >> 2] |= index << ((pos & 3) * 2);
+}
+
+// Expand RLE into a packed 2-bit bitmap (remainder black = index 0)
+static HOT_PATH void rle_decode_packed(const uint8_t* rle_data, size_t size, uint8_t* out) {
+    memset(out, 0, MAP_PACKED_BYTES);
+    size_t pos = 0;
+    size_t idx = 0;
+
+    while (idx + 1 < size && pos < MAP_PIXELS) {
+        uint8_t count = pgm_read_byte(&rle_data[idx++]);
+        uint8_t color = pgm_read_byte(&rle_data[idx++]);
+
+        if (count == 0 && color == 0) break;
+
+        size_t end = min(pos + count, MAP_PIXELS);
+        pack_run(out, pos, end, rle_index(color));
+        pos = end;
+    }
+}
+
+// Decoded copy of a 1x slice, decoding it on first use. nullptr without PSRAM.
+static uint8_t* decoded_slice(const uint8_t* rle_data, size_t size) {
+    for (int i = 0; i < _slice_cache_count; i++) {
+        if (_slice_cache[i].rle == rle_data) return _slice_cache[i].packed;
+    }
+    if (_slice_cache_failed || _slice_cache_count >= SLICE_CACHE_MAX || !psramFound()) {
+        return nullptr;
+    }
+
+    uint8_t* packed = (uint8_t*)ps_malloc(MAP_PACKED_BYTES);
+    if (!packed) {
+        Serial.println("[WorldMap] No PSRAM for slice cache, drawing from RLE");
+        _slice_cache_failed = true;
+        return nullptr;
+    }
+
+    unsigned long start = millis();
+    rle_decode_packed(rle_data, size, packed);
+    _slice_cache[_slice_cache_count].rle = rle_data;
+    _slice_cache[_slice_cache_count].packed = packed;
+    _slice_cache_count++;
+    Serial.printf("[WorldMap] Slice decoded in %lu ms (%d cached)\n",
+                  millis() - start, _slice_cache_count);
+    return packed;
+}
+
+// Slice index of a 1x bitmap, -1 if it is none of the four
+static int slice_of(const uint8_t* rle_data) {
+    const uint8_t* const slices[MAP_SLICE_COUNT] = {
+        map_slice_americas, map_slice_europe_africa, map_slice_asia, map_slice_pacific,
+    };
+    for (int i = 0; i < MAP_SLICE_COUNT; i++) {
+        if (slices[i] == rle_data) return i;
+    }
+    return -1;
 }
 
 /**
- * Draw RLE-compressed map bitmap from a LittleFS zoom binary file.
- *
- * File format:
- *   Header (8 bytes): 'Z','M', version, zoom, slices, cols, rows, reserved
- *   Index (6 bytes per bitmap): offset(uint32_le), size(uint16_le)
- *   Data: RLE bytes
- *
- * Bitmap index = slice * cols * rows + col * rows + row
+ * Draw RLE-compressed map bitmap from PROGMEM at specified position
  */
-bool draw_map_from_file(Arduino_GFX* gfx, const char* path,
-                        int zoom_level, int slice_idx, int col, int row,
-                        int offset_x, int offset_y) {
+void draw_map_slice(Arduino_GFX* gfx, const uint8_t* rle_data, size_t size, int offset_x, int offset_y) {
     unsigned long start = millis();
 
-    File f = LittleFS.open(path, "r");
-    if (!f) {
-        Serial.printf("[WorldMap] Failed to open %s\n", path);
-        return false;
+    uint8_t* packed = decoded_slice(rle_data, size);
+    if (packed) {
+        // The cached slice stays clean; the dots go onto a copy
+        int slice = slice_of(rle_data);
+        if (slice >= 0 && reserve_buf(_view_buf, _view_buf_cap, MAP_PACKED_BYTES)) {
+            memcpy(_view_buf, packed, MAP_PACKED_BYTES);
+            city_dots_draw({1, (int8_t)slice, 0, 0}, _view_buf);
+            packed = _view_buf;
+        }
+        draw_packed_bands(gfx, packed, offset_x, offset_y);
+        set_base_layer(packed, {1, (int8_t)slice, 0, 0}, offset_x, offset_y);
+        BINLOG_I("[WorldMap] Map drawn in %lu ms (cached)\n", millis() - start);
+        return;
+    }
+
+    draw_rle_bands(gfx, rle_data, size, offset_x, offset_y);
+    _base_valid = false;
+    BINLOG_I("[WorldMap] Map drawn in %lu ms\n", millis() - start);
+}
+
+// ------------------------------------------------------------------
+// Tile pyramid: at zoom z a slice is a (MAP_WIDTH*z) x (MAP_HEIGHT*z)
+// image cut into fixed tiles, all of them in /maps/tiles.bin behind one
+// flat index that is read on first use and kept in RAM. The file stays
+// open, so a tile costs one seek and one read, plus an LZ4 pass if it was
+// stored compressed. From the "maps" partition there is no read at all:
+// the index and tile data are used in place through the flash cache.
+// ------------------------------------------------------------------
+
+static const uint8_t TILES_VERSION = 2;
+static const uint8_t CODEC_RUNS = 0;   // Run tokens as they are
+static const uint8_t CODEC_LZ4 = 1;    // Tiles may be one LZ4 block of run tokens
+static const int MAX_VIEW_TILES = 24;  // Tiles one view may overlap (15 at 90x145)
+static const int MAX_GRID = 127;       // Columns/rows per zoom level (int8_t keys)
+
+// The grid is compiled in from map_layout.h; tiles.bin must match it
+static const size_t TILE_BYTES = ((size_t)MAP_TILE_W * MAP_TILE_H + 3) / 4;  // 2 bits per pixel
+static_assert(MAP_WIDTH % MAP_TILE_W == 0 && MAP_HEIGHT % MAP_TILE_H == 0,
+              "tiles divide the map");
+static_assert((MAP_WIDTH / MAP_TILE_W + 1) * (MAP_HEIGHT / MAP_TILE_H + 1) <= MAX_VIEW_TILES,
+              "a view overlaps at most MAX_VIEW_TILES tiles");
+static_assert(MAP_TILE_ROWS[MAP_TILE_ZOOM_MAX] <= MAX_GRID, "tile keys fit in int8_t");
+
+struct TilesHeader {
+    char magic[4];         // "RGTP"
+    uint8_t version;
+    uint8_t codec;
+    uint8_t zoom_min, zoom_max;
+    uint8_t slices;
+    uint8_t reserved;
+    uint16_t tile_w, tile_h;   // Divide MAP_WIDTH and MAP_HEIGHT
+    uint16_t reserved2;
+    uint32_t tile_count;
+};
+static_assert(sizeof(TilesHeader) == 20, "tiles.bin header is 20 bytes");
+
+struct TileEntry {
+    uint32_t offset;
+    uint16_t stored;       // Bytes in the file
+    uint16_t raw;          // Bytes of run tokens (== stored: not compressed)
+};
+static_assert(sizeof(TileEntry) == 8, "tiles.bin index entries are 8 bytes");
+
+struct TilePyramid {
+    bool loaded;
+    bool failed;           // Missing or invalid file: don't retry every draw
+    const TileEntry* tiles;    // As stored (little-endian), in RAM or mapped flash
+    uint32_t tile_count;
+};
+static TilePyramid _pyramid;
+static File _tiles_file;
+
+static const uint8_t* _tiles_map = nullptr;   // Mapped "maps" partition, or nullptr
+static uint32_t _tiles_map_size = 0;           // Bytes of it the pyramid uses
+static spi_flash_mmap_handle_t _tiles_map_handle;
+
+// Working buffers of one decoder: the loop/prefetch side, or the helper
+// that takes half a cold view (parallel decode, below)
+struct TileBuffers {
+    uint8_t* tile;         // Stored bytes of the tile being decoded (LittleFS only)
+    size_t tile_cap;
+    uint8_t* tokens;       // Its run tokens after the LZ4 stage
+    size_t tokens_cap;
+};
+static TileBuffers _bufs;
+
+static File* tiles_file() {
+    if (_tiles_file) return &_tiles_file;
+    _tiles_file = asset_fs_open(MAP_TILES_PATH, ASSET_RANDOM_READ_AHEAD);   // ~200 B a tile
+    if (!_tiles_file) {
+        Serial.printf("[WorldMap] Failed to open %s\n", MAP_TILES_PATH);
+        return nullptr;
     }
+    return &_tiles_file;
+}
+
+static inline int zoom_tiles(int zoom_level) {
+    return MAP_SLICE_COUNT * MAP_TILE_COLS[zoom_level] * MAP_TILE_ROWS[zoom_level];
+}
+
+static void pyramid_fail(const char* why) {
+    Serial.printf("[WorldMap] %s: %s\n", _tiles_map ? "'maps' partition" : MAP_TILES_PATH, why);
+    _pyramid.failed = true;
+    if (_tiles_file) _tiles_file.close();
+    if (_tiles_map) {
+        spi_flash_munmap(_tiles_map_handle);
+        _tiles_map = nullptr;
+    }
+}
+
+// Map tiles.bin in place from the raw "maps" partition, if it was flashed
+// there: the header and index first, to find where the tile data ends,
+// then exactly that much. False: use LittleFS.
+static bool map_tiles_partition() {
+    const esp_partition_t* part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, MAP_TILES_PARTITION_LABEL);
+    if (!part) return false;
 
-    // Read and validate header
-    uint8_t header[8];
-    if (f.read(header, 8) != 8 || header[0] != 'Z' || header[1] != 'M') {
-        Serial.println("[WorldMap] Invalid zoom file header");
-        f.close();
+    TilesHeader h;
+    if (esp_partition_read(part, 0, &h, sizeof(h)) != ESP_OK || memcmp(h.magic, "RGTP", 4) != 0) {
+        Serial.println("[WorldMap] 'maps' partition not flashed, using LittleFS");
         return false;
     }
+    if (h.tile_count > (part->size - sizeof(TilesHeader)) / sizeof(TileEntry)) {
+        Serial.println("[WorldMap] 'maps' partition index out of range, using LittleFS");
+        return false;
+    }
+    size_t index_end = sizeof(TilesHeader) + (size_t)h.tile_count * sizeof(TileEntry);
 
-    int file_zoom = header[3];
-    int file_cols = header[5];
-    int file_rows = header[6];
+    const void* mapped = nullptr;
+    spi_flash_mmap_handle_t handle;
+    if (esp_partition_mmap(part, 0, index_end, SPI_FLASH_MMAP_DATA, &mapped, &handle) != ESP_OK) {
+        Serial.println("[WorldMap] mmap of the 'maps' index failed, using LittleFS");
+        return false;
+    }
+    uint32_t end = index_end;
+    const TileEntry* tiles = (const TileEntry*)((const uint8_t*)mapped + sizeof(TilesHeader));
+    for (uint32_t i = 0; i < h.tile_count; i++) {
+        uint32_t tile_end = tiles[i].offset + tiles[i].stored;
+        if (tile_end > end && tile_end <= part->size) end = tile_end;
+    }
+    spi_flash_munmap(handle);
 
-    if (file_zoom != zoom_level) {
-        Serial.printf("[WorldMap] Zoom mismatch: file=%d, expected=%d\n", file_zoom, zoom_level);
-        f.close();
+    if (esp_partition_mmap(part, 0, end, SPI_FLASH_MMAP_DATA, &mapped, &_tiles_map_handle) != ESP_OK) {
+        Serial.println("[WorldMap] mmap of the 'maps' partition failed, using LittleFS");
         return false;
     }
+    _tiles_map = (const uint8_t*)mapped;
+    _tiles_map_size = end;
+    Serial.printf("[WorldMap] Mapped %.1f KB of tiles from flash at 0x%x (no copy)\n",
+                  end / 1024.0f, part->address);
+    return true;
+}
+
+static TilePyramid* tile_pyramid() {
+    if (_pyramid.loaded) return &_pyramid;
+    if (_pyramid.failed) return nullptr;
+
+    TilesHeader h;
+    File* f = nullptr;
+    uint32_t data_size;
+    bool header_read;
+    if (map_tiles_partition()) {
+        memcpy(&h, _tiles_map, sizeof(h));
+        data_size = _tiles_map_size;
+        header_read = true;
+    } else {
+        f = tiles_file();
+        if (!f) {
+            _pyramid.failed = true;
+            return nullptr;
+        }
+        f->seek(0);
+        header_read = f->read((uint8_t*)&h, sizeof(h)) == sizeof(h);
+        data_size = f->size();
+    }
+    if (!header_read || memcmp(h.magic, "RGTP", 4) != 0 ||
+        h.version != TILES_VERSION || h.codec > CODEC_LZ4) {
+        pyramid_fail("invalid header");
+        return nullptr;
+    }
+    if (h.zoom_min != MAP_TILE_ZOOM_MIN || h.zoom_max != MAP_TILE_ZOOM_MAX ||
+        h.slices != MAP_SLICE_COUNT || h.tile_w != MAP_TILE_W || h.tile_h != MAP_TILE_H ||
+        h.tile_count != MAP_TILE_COUNT) {
+        Serial.printf("[WorldMap] Pyramid is zoom %d-%dx, %d slices, %lu tiles of %dx%d; "
+                      "firmware expects %d-%dx, %d, %d of %dx%d\n",
+                      h.zoom_min, h.zoom_max, h.slices, (unsigned long)h.tile_count,
+                      h.tile_w, h.tile_h, MAP_TILE_ZOOM_MIN, MAP_TILE_ZOOM_MAX,
+                      MAP_SLICE_COUNT, MAP_TILE_COUNT, MAP_TILE_W, MAP_TILE_H);
+        pyramid_fail("layout does not match map_layout.h");
+        return nullptr;
+    }
 
-    // Calculate bitmap index
-    int bitmap_idx = slice_idx * file_cols * file_rows + col * file_rows + row;
-    int index_offset = 8 + bitmap_idx * 6;
+    // Whole index in one read (or in place), then check every entry once
+    const TileEntry* tiles;
+    TileEntry* read_tiles = nullptr;
+    if (_tiles_map) {
+        tiles = (const TileEntry*)(_tiles_map + sizeof(TilesHeader));
+    } else {
+        size_t index_bytes = (size_t)h.tile_count * sizeof(TileEntry);
+        read_tiles = (TileEntry*)map_alloc(index_bytes);
+        if (!read_tiles || f->read((uint8_t*)read_tiles, index_bytes) != index_bytes) {
+            free(read_tiles);
+            pyramid_fail("failed to read the index");
+            return nullptr;
+        }
+        tiles = read_tiles;
+    }
+    for (uint32_t i = 0; i < h.tile_count; i++) {
+        const TileEntry& t = tiles[i];
+        if (t.offset > data_size || t.stored > data_size - t.offset ||
+            (t.stored != t.raw && h.codec != CODEC_LZ4)) {
+            free(read_tiles);
+            pyramid_fail("index entry out of range");
+            return nullptr;
+        }
+    }
+
+    _pyramid.tiles = tiles;
+    _pyramid.tile_count = h.tile_count;
+    _pyramid.loaded = true;
+    Serial.printf("[WorldMap] Tile pyramid: zoom %d-%dx, %lu tiles of %dx%d%s\n",
+                  h.zoom_min, h.zoom_max, (unsigned long)h.tile_count, h.tile_w, h.tile_h,
+                  h.codec == CODEC_LZ4 ? " (LZ4)" : "");
+    return &_pyramid;
+}
+
+/**
+ * Decode one LZ4 block (no frame) into exactly dst_size bytes. Every read
+ * and copy is bounds-checked, so a corrupt tile fails instead of
+ * scribbling. Matches are copied byte by byte: they may overlap their own
+ * output.
+ */
+static HOT_PATH bool lz4_decode(const uint8_t* src, size_t src_size, uint8_t* dst,
+                                size_t dst_size) {
+    size_t si = 0;
+    size_t di = 0;
+    while (si < src_size) {
+        uint8_t token = src[si++];
+
+        size_t len = token >> 4;
+        if (len == 15) {
+            uint8_t b;
+            do {
+                if (si >= src_size) return false;
+                b = src[si++];
+                len += b;
+            } while (b == 255);
+        }
+        if (len > src_size - si || len > dst_size - di) return false;
+        memcpy(dst + di, src + si, len);
+        si += len;
+        di += len;
+        if (si == src_size) break;   // Last sequence: literals only
+
+        if (src_size - si < 2) return false;
+        size_t offset = src[si] | (src[si + 1] << 8);
+        si += 2;
+        if (offset == 0 || offset > di) return false;
+
+        len = (token & 15) + 4;
+        if ((token & 15) == 15) {
+            uint8_t b;
+            do {
+                if (si >= src_size) return false;
+                b = src[si++];
+                len += b;
+            } while (b == 255);
+        }
+        if (len > dst_size - di) return false;
+        const uint8_t* match = dst + di - offset;
+        for (size_t i = 0; i < len; i++) dst[di + i] = match[i];
+        di += len;
+    }
+    return di == dst_size;
+}
+
+/**
+ * Read tile number n and undo its LZ4 stage. Returns the size of its run
+ * tokens (at *tokens, valid until the next load), 0 on failure. A mapped
+ * tile is not read: its bytes are used where they are in flash.
+ */
+static size_t load_tile(const TilePyramid& p, uint32_t n, const uint8_t** tokens,
+                        TileBuffers& b) {
+    const TileEntry& t = p.tiles[n];
+    if (t.stored == 0) return 0;
+
+    const uint8_t* stored;
+    if (_tiles_map) {
+        stored = _tiles_map + t.offset;
+    } else {
+        if (!reserve_buf(b.tile, b.tile_cap, t.stored)) return 0;
+        File* f = tiles_file();
+        if (!f || !f->seek(t.offset) || f->read(b.tile, t.stored) != t.stored) {
+            Serial.println("[WorldMap] Failed to read tile data");
+            if (_tiles_file) _tiles_file.close();   // Reopen next time
+            return 0;
+        }
+        stored = b.tile;
+    }
+    if (t.stored == t.raw) {
+        *tokens = stored;
+        return t.raw;
+    }
+
+    if (!reserve_buf(b.tokens, b.tokens_cap, t.raw)) return 0;
+    if (!lz4_decode(stored, t.stored, b.tokens, t.raw)) {
+        Serial.printf("[WorldMap] Tile %lu is corrupt\n", (unsigned long)n);
+        return 0;
+    }
+    *tokens = b.tokens;
+    return t.raw;
+}
+
+// Next run of a tile: a varint with the colour in its low two bits and the
+// length - 1 above. False at the end of the tokens.
+static inline bool next_run(const uint8_t* tokens, size_t size, size_t& idx,
+                            uint32_t& count, uint8_t& color) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 32 && idx < size; shift += 7) {
+        uint8_t b = tokens[idx++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (b < 0x80) {
+            color = v & 3;
+            count = (v >> 2) + 1;
+            return true;
+        }
+    }
+    return false;
+}
 
-    // Read index entry
-    f.seek(index_offset);
-    uint8_t idx_buf[6];
-    if (f.read(idx_buf, 6) != 6) {
-        Serial.println("[WorldMap] Failed to read index entry");
-        f.close();
+// Load tile number n and expand its runs into a packed 2-bit bitmap of
+// TILE_BYTES (remainder black)
+static HOT_PATH bool decode_tile_into(const TilePyramid& p, uint32_t n, uint8_t* out,
+                                      TileBuffers& b = _bufs) {
+    const uint8_t* tokens;
+    size_t size = load_tile(p, n, &tokens, b);
+    if (size == 0) return false;
+
+    size_t pixels = (size_t)MAP_TILE_W * MAP_TILE_H;
+    memset(out, 0, TILE_BYTES);
+    size_t pos = 0;
+    size_t idx = 0;
+    uint32_t count;
+    uint8_t color;
+    while (pos < pixels && next_run(tokens, size, idx, count, color)) {
+        size_t end = min(pos + count, pixels);
+        pack_run(out, pos, end, rle_index(color));
+        pos = end;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Views: a MAP_WIDTH x MAP_HEIGHT window anywhere in a zoomed slice,
+// composed from the tiles it overlaps into one packed bitmap that then
+// goes out through the band writer like a 1x slice.
+// ------------------------------------------------------------------
+
+struct TileKey {
+    int8_t zoom, slice, col, row;
+};
+
+static uint8_t* _scratch_tile = nullptr;  // One decoded tile when it can't be cached
+static size_t _scratch_tile_cap = 0;
+
+static inline uint32_t tile_number(const TilePyramid& p, const TileKey& k) {
+    return MAP_TILE_FIRST[k.zoom] +
+           ((uint32_t)k.slice * MAP_TILE_COLS[k.zoom] + k.col) * MAP_TILE_ROWS[k.zoom] + k.row;
+}
+
+static bool view_valid(const TilePyramid& p, const MapView& v) {
+    return v.zoom >= MAP_TILE_ZOOM_MIN && v.zoom <= MAP_TILE_ZOOM_MAX && v.slice >= 0 &&
+           v.slice < MAP_SLICE_COUNT && v.x >= 0 && v.x <= MAP_WIDTH * (v.zoom - 1) &&
+           v.y >= 0 && v.y <= MAP_HEIGHT * (v.zoom - 1);
+}
+
+// Tiles a valid view overlaps, row by row. Returns the count.
+static int view_tiles(const TilePyramid& p, const MapView& v, TileKey* out) {
+    int c0 = v.x / MAP_TILE_W;
+    int c1 = (v.x + MAP_WIDTH - 1) / MAP_TILE_W;
+    int r0 = v.y / MAP_TILE_H;
+    int r1 = (v.y + MAP_HEIGHT - 1) / MAP_TILE_H;
+    int n = 0;
+    for (int r = r0; r <= r1; r++) {
+        for (int c = c0; c <= c1; c++) {
+            out[n++] = {v.zoom, v.slice, (int8_t)c, (int8_t)r};
+        }
+    }
+    return n;
+}
+
+static inline uint8_t get_pixel(const uint8_t* packed, size_t p) {
+    return (packed[p >> 2] >> ((p & 3) * 2)) & 3;
+}
+
+// Copy n pixels from src at pixel src_pos into a zeroed dst at dst_pos.
+// Once dst is byte-aligned, four pixels go per byte, shifted across two
+// source bytes when the two positions don't line up.
+static HOT_PATH void copy_pixels(uint8_t* dst, size_t dst_pos, const uint8_t* src,
+                                 size_t src_pos, size_t n) {
+    for (; n > 0 && (dst_pos & 3); n--, dst_pos++, src_pos++) {
+        dst[dst_pos >> 2] |= get_pixel(src, src_pos) << ((dst_pos & 3) * 2);
+    }
+    size_t bytes = n >> 2;
+    uint8_t* d = dst + (dst_pos >> 2);
+    const uint8_t* s = src + (src_pos >> 2);
+    int shift = (src_pos & 3) * 2;
+    if (shift == 0) {
+        memcpy(d, s, bytes);
+    } else {
+        for (size_t i = 0; i < bytes; i++) {
+            d[i] = (s[i] >> shift) | (s[i + 1] << (8 - shift));
+        }
+    }
+    dst_pos += bytes * 4;
+    src_pos += bytes * 4;
+    n -= bytes * 4;
+    for (; n > 0; n--, dst_pos++, src_pos++) {
+        dst[dst_pos >> 2] |= get_pixel(src, src_pos) << ((dst_pos & 3) * 2);
+    }
+}
+
+// Copy the part of a decoded tile that falls inside the view
+static void blit_tile(const TilePyramid& p, const MapView& v, const TileKey& k,
+                      const uint8_t* tile, uint8_t* out) {
+    int tx = k.col * MAP_TILE_W;
+    int ty = k.row * MAP_TILE_H;
+    int x0 = max(tx, (int)v.x);
+    int x1 = min(tx + MAP_TILE_W, v.x + MAP_WIDTH);
+    int y0 = max(ty, (int)v.y);
+    int y1 = min(ty + MAP_TILE_H, v.y + MAP_HEIGHT);
+    for (int y = y0; y < y1; y++) {
+        copy_pixels(out, (size_t)(y - v.y) * MAP_WIDTH + (x0 - v.x),
+                    tile, (size_t)(y - ty) * MAP_TILE_W + (x0 - tx), x1 - x0);
+    }
+}
+
+// ------------------------------------------------------------------
+// Decoded tile cache and neighbour prefetch (PSRAM)
+// ------------------------------------------------------------------
+
+static const int TILE_CACHE_MAX = 800;        // All of zoom 5 at 90x145 (4 x 10 x 20), 3.2 KB each
+static const uint32_t PREFETCH_STACK = 6144;   // LittleFS reads
+static const UBaseType_t PREFETCH_PRIORITY = 1;
+static const BaseType_t PREFETCH_CORE = 0;    // Off the loop task's core
+
+// A draw and the prefetch touch at most five views' tiles before decoding
+// more, so LRU eviction never takes a tile they are still using
+static_assert(TILE_CACHE_MAX > 5 * MAX_VIEW_TILES, "tile cache holds a view and its neighbours");
+
+struct DecodedTile {
+    TileKey key;
+    uint8_t* packed;       // tile_bytes, nullptr = empty slot
+    uint32_t last_used;
+};
+static DecodedTile* _tile_cache = nullptr;    // TILE_CACHE_MAX slots, allocated on first use
+static uint32_t _tile_clock = 0;
+static uint32_t _tile_hits = 0;        // Tiles of zoomed draws, under _map_lock
+static uint32_t _tile_misses = 0;
+
+// The tile pyramid, its buffers and the tile cache are shared with the prefetch task
+static SemaphoreHandle_t _map_lock = xSemaphoreCreateMutex();
+
+static QueueHandle_t _prefetch_queue = nullptr;   // MapView, length 1, latest wins
+
+static bool key_eq(const TileKey& a, const TileKey& b) {
+    return a.zoom == b.zoom && a.slice == b.slice && a.col == b.col && a.row == b.row;
+}
+
+// Call with _map_lock held
+static DecodedTile* find_tile(const TileKey& key) {
+    if (!_tile_cache) return nullptr;
+    for (int i = 0; i < TILE_CACHE_MAX; i++) {
+        if (_tile_cache[i].packed && key_eq(_tile_cache[i].key, key)) return &_tile_cache[i];
+    }
+    return nullptr;
+}
+
+/**
+ * Take a cache slot for key, evicting the least recently used tile, with
+ * its buffer allocated but not yet decoded. Call with _map_lock held.
+ * nullptr without PSRAM or memory.
+ */
+static DecodedTile* claim_slot(const TilePyramid& p, const TileKey& key) {
+    if (!_tile_cache && psramFound()) {
+        _tile_cache = (DecodedTile*)ps_calloc(TILE_CACHE_MAX, sizeof(DecodedTile));
+    }
+    if (!_tile_cache) return nullptr;
+
+    DecodedTile* slot = nullptr;
+    for (int i = 0; i < TILE_CACHE_MAX; i++) {
+        DecodedTile& t = _tile_cache[i];
+        if (!t.packed) {
+            slot = &t;
+            break;
+        }
+        if (!slot || t.last_used < slot->last_used) slot = &t;
+    }
+
+    if (!slot->packed) {
+        slot->packed = (uint8_t*)ps_malloc(TILE_BYTES);
+        if (!slot->packed) return nullptr;
+    }
+    slot->key = key;
+    slot->last_used = ++_tile_clock;
+    return slot;
+}
+
+// A claimed slot whose decode failed goes back empty
+static void drop_slot(DecodedTile* slot) {
+    free(slot->packed);
+    slot->packed = nullptr;
+}
+
+/**
+ * Load and decode a tile into the cache. Call with _map_lock held.
+ * nullptr without PSRAM or on failure.
+ */
+static DecodedTile* decode_tile(const TilePyramid& p, const TileKey& key) {
+    DecodedTile* slot = claim_slot(p, key);
+    if (!slot) return nullptr;
+    if (!decode_tile_into(p, tile_number(p, key), slot->packed)) {
+        drop_slot(slot);
+        return nullptr;
+    }
+    return slot;
+}
+
+// ------------------------------------------------------------------
+// Parallel decode: when a view needs several tiles that are not cached,
+// a helper task on core 0 decodes part of them while the calling task
+// decodes the rest, each into its own claimed cache slots and with its
+// own buffers. Tiles are independent run streams, so nothing is shared
+// but the read-only pyramid. Only from the mapped partition: LittleFS
+// reads of one open file would serialize anyway.
+// ------------------------------------------------------------------
+
+static const uint32_t HELPER_STACK = 3072;
+static const UBaseType_t HELPER_PRIORITY = 2;   // Above the net worker: the loop waits on it
+static const BaseType_t HELPER_CORE = 0;
+
+struct DecodeJob {
+    const TilePyramid* pyramid;
+    int count;
+    uint32_t tile[MAX_VIEW_TILES];
+    uint8_t* out[MAX_VIEW_TILES];
+    bool ok[MAX_VIEW_TILES];
+    TaskHandle_t waiter;
+};
+static DecodeJob _job;               // Handed over by task notification
+static TileBuffers _helper_bufs;
+static TaskHandle_t _helper_task = nullptr;
+static bool _helper_failed = false;
+
+static void decode_helper_task(void*) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (int i = 0; i < _job.count; i++) {
+            _job.ok[i] = decode_tile_into(*_job.pyramid, _job.tile[i], _job.out[i], _helper_bufs);
+        }
+        xTaskNotifyGive(_job.waiter);
+    }
+}
+
+static bool start_helper() {
+    if (_helper_task) return true;
+    if (_helper_failed) return false;
+    if (xTaskCreatePinnedToCore(decode_helper_task, "map_decode", HELPER_STACK, nullptr,
+                                HELPER_PRIORITY, &_helper_task, HELPER_CORE) != pdPASS) {
+        Serial.println("[WorldMap] Failed to start decode helper, decoding on one core");
+        _helper_task = nullptr;
+        _helper_failed = true;
         return false;
     }
+    return true;
+}
+
+// Wait for the helper's part of a job (if it has one), empty the slots
+// it failed to decode and leave those tiles to the caller
+static void helper_collect(DecodedTile** theirs, DecodedTile** found, int count) {
+    if (_job.count > 0) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (int i = 0; i < _job.count; i++) {
+            if (!_job.ok[i]) drop_slot(theirs[i]);
+        }
+        _job.count = 0;
+    }
+    for (int i = 0; i < count; i++) {
+        if (found[i] && !found[i]->packed) found[i] = nullptr;
+    }
+}
+
+/**
+ * Decode the view tiles that found[] has no cache entry for, split over
+ * both cores by stored size, and fill in their entries. Tiles it does not
+ * get to stay nullptr for the caller's sequential path. Call with
+ * _map_lock held, from a task other than the helper's.
+ */
+static void decode_parallel(const TilePyramid& p, const TileKey* keys, DecodedTile** found,
+                            int count) {
+    int missing = 0;
+    for (int i = 0; i < count; i++) missing += found[i] ? 0 : 1;
+    if (missing < 2 || !_tiles_map || !psramFound() || !start_helper()) return;
+
+    DecodedTile* mine[MAX_VIEW_TILES];
+    int mine_count = 0;
+    DecodedTile* theirs[MAX_VIEW_TILES];
+    uint32_t mine_bytes = 0, their_bytes = 0;
+    _job.pyramid = &p;
+    _job.count = 0;
+    _job.waiter = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < count; i++) {
+        if (found[i]) continue;
+        DecodedTile* slot = claim_slot(p, keys[i]);
+        if (!slot) break;
+        found[i] = slot;
+        uint32_t n = tile_number(p, keys[i]);
+        if (their_bytes < mine_bytes) {
+            theirs[_job.count] = slot;
+            _job.tile[_job.count] = n;
+            _job.out[_job.count] = slot->packed;
+            _job.count++;
+            their_bytes += p.tiles[n].raw;
+        } else {
+            mine[mine_count++] = slot;
+            mine_bytes += p.tiles[n].raw;
+        }
+    }
 
-    uint32_t data_offset = idx_buf[0] | (idx_buf[1] << 8) | (idx_buf[2] << 16) | (idx_buf[3] << 24);
-    uint16_t data_size = idx_buf[4] | (idx_buf[5] << 8);
+    if (_job.count > 0) xTaskNotifyGive(_helper_task);
+    for (int i = 0; i < mine_count; i++) {
+        if (!decode_tile_into(p, tile_number(p, mine[i]->key), mine[i]->packed)) {
+            drop_slot(mine[i]);
+        }
+    }
+    helper_collect(theirs, found, count);
+}
 
-    // Seek to bitmap data and draw
-    f.seek(data_offset);
+/**
+ * Hand every missing tile of keys to the helper and return at once, so
+ * the caller can work on something else (push the band above) while they
+ * decode. helper_collect() waits for them. False if nothing was handed
+ * over: all cached, or no helper.
+ */
+static bool decode_ahead(const TilePyramid& p, const TileKey* keys, DecodedTile** found,
+                         int count, DecodedTile** theirs) {
+    _job.count = 0;
+    if (!_tiles_map || !psramFound() || !start_helper()) return false;
+    _job.pyramid = &p;
+    _job.waiter = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < count; i++) {
+        if (found[i]) continue;
+        DecodedTile* slot = claim_slot(p, keys[i]);
+        if (!slot) break;
+        found[i] = slot;
+        theirs[_job.count] = slot;
+        _job.tile[_job.count] = tile_number(p, keys[i]);
+        _job.out[_job.count] = slot->packed;
+        _job.count++;
+    }
+    if (_job.count == 0) return false;
+    xTaskNotifyGive(_helper_task);
+    return true;
+}
 
-    int x = 0, y = 0;
-    uint16_t bytes_read = 0;
+// Blit one view tile into out: from its cache entry t, else decoded into
+// the cache now, else through the scratch tile. False if it failed.
+static bool place_tile(const TilePyramid& p, const MapView& v, const TileKey& key,
+                       DecodedTile* t, uint8_t* out) {
+    const uint8_t* packed;
+    if (!t) t = decode_tile(p, key);
 
-    while (bytes_read < data_size - 1 && y < MAP_HEIGHT) {
-        uint8_t count = f.read();
-        uint8_t color = f.read();
-        bytes_read += 2;
+    if (t) {
+        t->last_used = ++_tile_clock;
+        packed = t->packed;
+    } else {
+        if (!reserve_buf(_scratch_tile, _scratch_tile_cap, TILE_BYTES) ||
+            !decode_tile_into(p, tile_number(p, key), _scratch_tile)) {
+            return false;
+        }
+        packed = _scratch_tile;
+    }
+    blit_tile(p, v, key, packed, out);
+    return true;
+}
 
-        if (count == 0 && color == 0) break;
+/**
+ * Compose a valid view into out (MAP_PACKED_BYTES): cached tiles from the
+ * tile cache, the others decoded into it, or through the scratch tile
+ * without PSRAM. Call with _map_lock held. False if a tile failed.
+ */
+static bool compose_view(const TilePyramid& p, const MapView& v, uint8_t* out,
+                         int* tiles, int* hits) {
+    TileKey keys[MAX_VIEW_TILES];
+    DecodedTile* found[MAX_VIEW_TILES];
+    *tiles = view_tiles(p, v, keys);
+    *hits = 0;
+    for (int i = 0; i < *tiles; i++) {
+        found[i] = find_tile(keys[i]);
+        if (!found[i]) continue;
+        found[i]->last_used = ++_tile_clock;   // Not evicted for the misses
+        (*hits)++;
+    }
+    decode_parallel(p, keys, found, *tiles);
+
+    memset(out, 0, MAP_PACKED_BYTES);
+    for (int i = 0; i < *tiles; i++) {
+        if (!place_tile(p, v, keys[i], found[i], out)) return false;
+    }
+    _tile_hits += *hits;
+    _tile_misses += *tiles - *hits;
+    return true;
+}
+
+// Swipe directions, mirroring UIState::zoom_move_*
+static const int PAGE_DX[4] = {-MAP_WIDTH, MAP_WIDTH, 0, 0};
+static const int PAGE_DY[4] = {0, 0, -MAP_HEIGHT, MAP_HEIGHT};
+
+static void prefetch_task(void*) {
+    MapView center;
+    for (;;) {
+        if (xQueueReceive(_prefetch_queue, &center, portMAX_DELAY) != pdTRUE) continue;
+
+        // The view itself, then the four a swipe reaches (one view away)
+        MapView views[5];
+        views[0] = center;
+        int view_count = 1;
+        for (int d = 0; d < 4; d++) {
+            views[view_count] = center;
+            if (world_map_pan_view(&views[view_count], PAGE_DX[d], PAGE_DY[d])) view_count++;
+        }
+
+        unsigned long start = millis();
+        int decoded = 0;
+        for (int v = 0; v < view_count && uxQueueMessagesWaiting(_prefetch_queue) == 0; v++) {
+            xSemaphoreTake(_map_lock, portMAX_DELAY);
+            TilePyramid* p = tile_pyramid();
+            TileKey keys[MAX_VIEW_TILES];
+            int count = p && view_valid(*p, views[v]) ? view_tiles(*p, views[v], keys) : 0;
+            xSemaphoreGive(_map_lock);
+
+            for (int i = 0; i < count; i++) {
+                // The user moved on: start over around the new view
+                if (uxQueueMessagesWaiting(_prefetch_queue) > 0) break;
+
+                xSemaphoreTake(_map_lock, portMAX_DELAY);
+                DecodedTile* t = find_tile(keys[i]);
+                if (t) {
+                    t->last_used = ++_tile_clock;   // Still needed: keep it
+                    xSemaphoreGive(_map_lock);
+                    continue;
+                }
+                if (decode_tile(*p, keys[i])) decoded++;
+                xSemaphoreGive(_map_lock);
+                vTaskDelay(1);   // Let a waiting draw take the lock
+            }
+        }
+        if (decoded > 0) {
+            Serial.printf("[WorldMap] Prefetched %d tiles around (%d,%d) in %lu ms\n",
+                          decoded, center.x, center.y, millis() - start);
+        }
+    }
+}
+
+static void request_prefetch(const MapView& center) {
+    if (!psramFound()) return;
+
+    if (!_prefetch_queue) {
+        _prefetch_queue = xQueueCreate(1, sizeof(MapView));
+        if (!_prefetch_queue) return;
+        if (xTaskCreatePinnedToCore(prefetch_task, "map_prefetch", PREFETCH_STACK, nullptr,
+                                    PREFETCH_PRIORITY, nullptr, PREFETCH_CORE) != pdPASS) {
+            Serial.println("[WorldMap] Failed to start prefetch task");
+            vQueueDelete(_prefetch_queue);
+            _prefetch_queue = nullptr;
+            return;
+        }
+    }
+
+    xQueueOverwrite(_prefetch_queue, &center);
+}
+
+// ------------------------------------------------------------------
+// Streamed draw (framebuffer builds): a view with tiles to decode goes
+// out one row of tiles at a time. Each band is composed, dotted and
+// expanded into the framebuffer, then handed to the display to push,
+// and while the loop is busy writing it to the panel the helper decodes
+// the next band's tiles on core 0. A cold view is then on the panel in
+// about the time of whichever is slower, decoding or the transfer,
+// rather than both one after the other. With QSPI_ASYNC_DMA the tail of
+// each band is still on the bus while the next one is put together.
+// ------------------------------------------------------------------
+
+// Where the bands go: the framebuffer rows of the view, and the display
+struct BandStream {
+    uint16_t* fb;      // Framebuffer at the view's first row
+    int offset_y;      // Screen row of the view's first row
+    MapBandFn push;
+    int bands;         // Pushed so far
+};
+
+// Tiles of a view already in the cache. Call with _map_lock held.
+static bool view_cached(const TilePyramid& p, const MapView& v) {
+    TileKey keys[MAX_VIEW_TILES];
+    int n = view_tiles(p, v, keys);
+    for (int i = 0; i < n; i++) {
+        if (!find_tile(keys[i])) return false;
+    }
+    return true;
+}
+
+/**
+ * Compose a valid view into out and push it band by band through s, the
+ * dots included. Call with _map_lock held. False if a tile failed; the
+ * bands above it are on the panel by then.
+ */
+static bool compose_streamed(const TilePyramid& p, const MapView& v, uint8_t* out,
+                             BandStream& s, int* tiles, int* hits) {
+    TileKey keys[MAX_VIEW_TILES];
+    DecodedTile* found[MAX_VIEW_TILES];
+    DecodedTile* theirs[MAX_VIEW_TILES];
+    *tiles = view_tiles(p, v, keys);
+    *hits = 0;
+    for (int i = 0; i < *tiles; i++) {
+        found[i] = find_tile(keys[i]);
+        if (!found[i]) continue;
+        found[i]->last_used = ++_tile_clock;   // Not evicted for the misses
+        (*hits)++;
+    }
+    int cols = (v.x + MAP_WIDTH - 1) / MAP_TILE_W - v.x / MAP_TILE_W + 1;
+    int band_count = *tiles / cols;   // view_tiles() goes row by row
+
+    // Nothing to overlap the first band with: both cores decode it
+    decode_parallel(p, keys, found, cols);
+
+    memset(out, 0, MAP_PACKED_BYTES);
+    for (int b = 0; b < band_count; b++) {
+        const TileKey* band_keys = keys + b * cols;
+        DecodedTile** band_found = found + b * cols;
+        helper_collect(theirs, band_found, cols);   // Decoded while the band above went out
+        for (int i = 0; i < cols; i++) {
+            if (!place_tile(p, v, band_keys[i], band_found[i], out)) return false;
+        }
 
-        uint16_t display_color = rle_color(color);
-        int remaining = count;
+        int y0 = max(band_keys[0].row * MAP_TILE_H, (int)v.y) - v.y;
+        int y1 = min((band_keys[0].row + 1) * MAP_TILE_H, v.y + MAP_HEIGHT) - v.y;
+        city_dots_draw_rows(v, out, y0, y1);
+        expand_packed(s.fb + (size_t)y0 * MAP_WIDTH, out, (size_t)y0 * MAP_WIDTH / 4,
+                      (size_t)(y1 - y0) * MAP_WIDTH / 4);   // Rows are whole bytes
 
-        while (remaining > 0 && y < MAP_HEIGHT) {
-            int pixels_this_row = min(remaining, MAP_WIDTH - x);
-            gfx->drawFastHLine(offset_x + x, offset_y + y, pixels_this_row, display_color);
-            remaining -= pixels_this_row;
-            x += pixels_this_row;
-            if (x >= MAP_WIDTH) { x = 0; y++; }
+        if (b + 1 < band_count) {
+            decode_ahead(p, band_keys + cols, band_found + cols, cols, theirs);
         }
+        s.push(s.offset_y + y0, y1 - y0);
+        s.bands++;
+    }
+    _tile_hits += *hits;
+    _tile_misses += *tiles - *hits;
+    return true;
+}
+
+// Compose a view into out under _map_lock, or stream it if it has tiles to
+// decode and stream is given. False if it is out of range or a tile failed.
+static bool compose_locked(const MapView& view, uint8_t* out, int* tiles, int* hits,
+                           BandStream* stream = nullptr) {
+    xSemaphoreTake(_map_lock, portMAX_DELAY);
+    TilePyramid* p = tile_pyramid();
+    bool ok = p && view_valid(*p, view);
+    if (p && !ok) {
+        Serial.printf("[WorldMap] View %dx (%d,%d) of slice %d out of range\n",
+                      view.zoom, view.x, view.y, view.slice);
     }
+    if (ok && stream && !view_cached(*p, view)) {
+        ok = compose_streamed(*p, view, out, *stream, tiles, hits);
+    } else if (ok) {
+        ok = compose_view(*p, view, out, tiles, hits);
+    }
+    xSemaphoreGive(_map_lock);
+    return ok;
+}
+
+/**
+ * Draw a zoomed view from the tile pyramid.
+ * Tiles are served from the decoded tile cache when possible.
+ */
+bool draw_map_view(Arduino_GFX* gfx, const MapView& view, int offset_x, int offset_y,
+                   MapBandFn push) {
+    unsigned long start = millis();
+    if (!reserve_buf(_view_buf, _view_buf_cap, MAP_PACKED_BYTES)) return false;
+
+    if (vector_map_render(view, _view_buf)) {
+        city_dots_draw(view, _view_buf);
+        draw_packed_bands(gfx, _view_buf, offset_x, offset_y);
+        set_base_layer(_view_buf, view, offset_x, offset_y);
+        BINLOG_I("[WorldMap] Zoom %dx (%d,%d) drawn in %lu ms (vector)\n",
+                 view.zoom, view.x, view.y, millis() - start);
+        return true;
+    }
+
+    int tiles, hits;
+    BandStream stream = { framebuffer_target(gfx, offset_x, offset_y), offset_y, push, 0 };
+    bool streams = push && stream.fb && ((uintptr_t)stream.fb & 3) == 0 && build_quad_lut();
+    if (!compose_locked(view, _view_buf, &tiles, &hits, streams ? &stream : nullptr)) return false;
+    if (stream.bands == 0) {
+        city_dots_draw(view, _view_buf);
+        draw_packed_bands(gfx, _view_buf, offset_x, offset_y);
+    }
+    set_base_layer(_view_buf, view, offset_x, offset_y);
 
-    // Fill remainder with black
-    while (y < MAP_HEIGHT) {
-        if (x < MAP_WIDTH) {
-            gfx->drawFastHLine(offset_x + x, offset_y + y, MAP_WIDTH - x, BLACK);
+    if (stream.bands > 0) {
+        BINLOG_I("[WorldMap] Zoom %dx streamed in %lu ms (%d tiles decoded, %d bands)\n",
+                 view.zoom, millis() - start, tiles - hits, stream.bands);
+    } else {
+        BINLOG_I("[WorldMap] Zoom %dx drawn in %lu ms (%d/%d tiles cached)\n",
+                 view.zoom, millis() - start, hits, tiles);
+    }
+    request_prefetch(view);
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Zoom preview: a zoom-in whose tiles aren't all decoded yet first shows
+// the view on screen (the base layer) scaled up to the new view, nearest
+// neighbour, so the zoom lands at once and the crisp view replaces it
+// when its tiles are done.
+// ------------------------------------------------------------------
+
+// Scale the base layer's part of view up into out (outside it: ocean)
+static HOT_PATH void upscale_base(const MapView& view, uint8_t* out) {
+    const MapView& b = _base_view;
+    int16_t src_x[MAP_WIDTH];   // Base column of each view column, -1 outside
+    for (int x = 0; x < MAP_WIDTH; x++) {
+        int bx = (2 * (view.x + x) + 1) * b.zoom / (2 * view.zoom) - b.x;
+        src_x[x] = (bx >= 0 && bx < MAP_WIDTH) ? bx : -1;
+    }
+    memset(out, 0, MAP_PACKED_BYTES);
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        int by = (2 * (view.y + y) + 1) * b.zoom / (2 * view.zoom) - b.y;
+        if (by < 0 || by >= MAP_HEIGHT) continue;
+        size_t src_row = (size_t)by * MAP_WIDTH;
+        size_t dst = (size_t)y * MAP_WIDTH;
+        for (int x = 0; x < MAP_WIDTH; x++, dst++) {
+            if (src_x[x] < 0) continue;
+            size_t sp = src_row + src_x[x];
+            uint8_t px = (_base_layer[sp >> 2] >> ((sp & 3) * 2)) & 3;
+            out[dst >> 2] |= px << ((dst & 3) * 2);
         }
-        x = 0;
-        y++;
+    }
+}
+
+bool world_map_draw_preview(Arduino_GFX* gfx, const MapView& view, int offset_x, int offset_y) {
+    const MapView& b = _base_view;
+    if (!_base_valid || _base_x != offset_x || _base_y != offset_y ||
+        b.slice != view.slice || view.zoom <= b.zoom || vector_map_ready()) {
+        return false;
     }
 
-    f.close();
-    Serial.printf("[WorldMap] Zoom %dx [%d,%d] drawn in %lu ms\n",
-                  zoom_level, col, row, millis() - start);
+    xSemaphoreTake(_map_lock, portMAX_DELAY);
+    TilePyramid* p = tile_pyramid();
+    bool cold = p && view_valid(*p, view) && !view_cached(*p, view);
+    xSemaphoreGive(_map_lock);
+    if (!cold || !reserve_buf(_view_buf, _view_buf_cap, MAP_PACKED_BYTES)) return false;
+
+    unsigned long start = millis();
+    upscale_base(view, _view_buf);
+    draw_packed_bands(gfx, _view_buf, offset_x, offset_y);
+    BINLOG_I("[WorldMap] Zoom %dx -> %dx preview in %lu ms\n",
+             b.zoom, view.zoom, millis() - start);
     return true;
 }
 
+int world_map_zoom_max() {
+    return vector_map_ready() ? MAP_ZOOM_LIMIT : MAP_TILE_ZOOM_MAX;
+}
+
+bool world_map_pan_view(MapView* view, int dx, int dy) {
+    int max_x = MAP_WIDTH * (view->zoom - 1);
+    int max_y = MAP_HEIGHT * (view->zoom - 1);
+    MapView before = *view;
+
+    // Past a slice edge: the far edge of the next slice, same latitude
+    if (dx < 0 && view->x == 0) {
+        view->slice = (view->slice + 3) % 4;
+        view->x = max_x;
+    } else if (dx > 0 && view->x == max_x) {
+        view->slice = (view->slice + 1) % 4;
+        view->x = 0;
+    } else {
+        view->x = constrain(view->x + dx, 0, max_x);
+    }
+    view->y = constrain(view->y + dy, 0, max_y);
+
+    return view->slice != before.slice || view->x != before.x || view->y != before.y;
+}
+
 /**
  * Draw slice label in corner
  */
@@ -169,3 +1397,38 @@ void draw_slice_label(Arduino_GFX* gfx, const char* name, const char* label) {
     gfx->setCursor(5, 15);
     gfx->print(label);
 }
+
+void world_map_tile_cache_stats(uint32_t* hits, uint32_t* misses) {
+    *hits = _tile_hits;
+    *misses = _tile_misses;
+}
+
+void world_map_decode_slice(const uint8_t* rle_data, size_t size, uint8_t* out) {
+    rle_decode_packed(rle_data, size, out);
+}
+
+int world_map_tile_count(int zoom_level) {
+    xSemaphoreTake(_map_lock, portMAX_DELAY);
+    TilePyramid* p = tile_pyramid();
+    int n = 0;
+    if (p && zoom_level >= MAP_TILE_ZOOM_MIN && zoom_level <= MAP_TILE_ZOOM_MAX) {
+        n = zoom_tiles(zoom_level);
+    }
+    xSemaphoreGive(_map_lock);
+    return n;
+}
+
+bool world_map_decode_tile(int zoom_level, int index, uint8_t* out) {
+    xSemaphoreTake(_map_lock, portMAX_DELAY);
+    TilePyramid* p = tile_pyramid();
+    bool ok = p && zoom_level >= MAP_TILE_ZOOM_MIN && zoom_level <= MAP_TILE_ZOOM_MAX &&
+              index >= 0 && index < zoom_tiles(zoom_level);
+    if (ok) ok = decode_tile_into(*p, MAP_TILE_FIRST[zoom_level] + index, out);
+    xSemaphoreGive(_map_lock);
+    return ok;
+}
+
+bool world_map_compose_view(const MapView& view, uint8_t* out) {
+    int tiles, hits;
+    return compose_locked(view, out, &tiles, &hits);
+}
@@ -3,7 +3,10 @@
  *
  * Stores longitude slice bitmaps and provides drawing functions.
  * 1x bitmaps are RLE-compressed in PROGMEM (flash).
- * 2x/3x zoom bitmaps are stored in LittleFS binary files.
+ * 2x-5x zoom tiles are stored in one tile pyramid file (LittleFS, or
+ * mapped from a raw partition) and composed into views at any pixel
+ * offset; an optional vector map can draw the same views instead, at any
+ * zoom.
  *
  * 3-Color RLE: 0=ocean (black), 1=land (white), 2=border (gray)
  */
@@ -13,10 +16,17 @@
 
 #include <Arduino.h>
 #include "Arduino_GFX_Library.h"
+#include "map_layout.h"
 
 // Map dimensions (portrait: 180×580, fills display above status bar)
-#define MAP_WIDTH 180
-#define MAP_HEIGHT 580
+#define MAP_WIDTH MAP_LAYOUT_WIDTH
+#define MAP_HEIGHT MAP_LAYOUT_HEIGHT
+
+// Tile pyramid with every zoomed tile (tools/pack_map_tiles.py)
+#define MAP_TILES_PATH "/maps/tiles.bin"
+
+// Raw flash partition tiles.bin may be written to instead (see partitions.csv)
+#define MAP_TILES_PARTITION_LABEL "maps"
 
 // Bitmap data (PROGMEM arrays, defined in world_map.cpp)
 extern const uint8_t map_slice_americas[];
@@ -31,15 +41,70 @@ extern const size_t map_slice_asia_size;
 extern const uint8_t map_slice_pacific[];
 extern const size_t map_slice_pacific_size;
 
-// Draw RLE bitmap from PROGMEM (1x maps)
+// Draw RLE bitmap from PROGMEM (1x maps); with PSRAM the city dots go on top
 void draw_map_slice(Arduino_GFX* gfx, const uint8_t* rle_data, size_t size, int offset_x, int offset_y);
 
-// Draw RLE bitmap from LittleFS zoom file (2x/3x maps)
-// Returns true on success
-bool draw_map_from_file(Arduino_GFX* gfx, const char* path,
-                        int zoom_level, int slice_idx, int col, int row,
-                        int offset_x, int offset_y);
+// Zoom levels: 1x slices, then the tile pyramid up to MAP_TILE_ZOOM_MAX
+// (map_layout.h); an optional vector map (vector_map.h) goes on up to
+// MAP_ZOOM_LIMIT
+#define MAP_ZOOM_LIMIT 8
+
+// Highest zoom level the map data on the device can draw
+int world_map_zoom_max();
+
+// A zoomed view (2x and up): at zoom z a slice is a (MAP_WIDTH*z) x (MAP_HEIGHT*z)
+// image, and the view is the MAP_WIDTH x MAP_HEIGHT window whose top-left
+// pixel is (x, y), with 0 <= x <= MAP_WIDTH*(z-1) and 0 <= y <= MAP_HEIGHT*(z-1)
+struct MapView {
+    int8_t zoom;
+    int8_t slice;
+    int16_t x;
+    int16_t y;
+};
+
+// Takes rows y..y+rows-1 of the screen, final in the framebuffer, to the panel
+typedef void (*MapBandFn)(int y, int rows);
+
+// Draw a zoomed view from the vector map if there is one, else from the
+// tile pyramid, with the city dots on top. Returns true on success.
+// With push, a view drawn into the framebuffer that has tiles to decode
+// is handed to it a row of tiles at a time, top to bottom, each band as
+// soon as it is done, while the next one decodes; all of the map area
+// has been pushed when it returns true that way.
+bool draw_map_view(Arduino_GFX* gfx, const MapView& view, int offset_x, int offset_y,
+                   MapBandFn push = nullptr);
+
+// Zooming in to a view whose tiles aren't all decoded: draw the map on
+// screen scaled up to it (nearest neighbour) as a stand-in until
+// draw_map_view() replaces it. False, having drawn nothing, if the view is
+// ready, isn't a zoom-in of the map on screen, or comes from the vector map.
+bool world_map_draw_preview(Arduino_GFX* gfx, const MapView& view, int offset_x, int offset_y);
+
+// Move a view by dx, dy pixels, clamped to its slice. A horizontal move from
+// the slice edge goes to the far edge of the neighbouring slice instead.
+// Returns true if the view changed.
+bool world_map_pan_view(MapView* view, int dx, int dy);
+
+// Tiles the pyramid has for zoom_level (all slices), 0 if none or no pyramid
+int world_map_tile_count(int zoom_level);
+
+// Erase an overlay by restoring the given rectangle of the last drawn map
+// from its base layer. Returns false if there is no base layer (no PSRAM,
+// or the view was drawn straight from RLE); the caller erases some other way.
+bool world_map_restore(Arduino_GFX* gfx, int x, int y, int w, int h);
 
 void draw_slice_label(Arduino_GFX* gfx, const char* name, const char* label);
 
+// Tiles of zoomed draws served from the decoded tile cache vs. read from flash
+void world_map_tile_cache_stats(uint32_t* hits, uint32_t* misses);
+
+// Benchmark hooks, into out (MAP_PACKED_BYTES, 2 bits per pixel). Slices
+// and tiles (index 0..world_map_tile_count - 1) decode straight from their
+// data, bypassing the caches; a view is composed as a draw would compose
+// it, through the tile cache.
+#define MAP_PACKED_BYTES ((size_t)MAP_WIDTH * MAP_HEIGHT / 4)
+void world_map_decode_slice(const uint8_t* rle_data, size_t size, uint8_t* out);
+bool world_map_decode_tile(int zoom_level, int index, uint8_t* out);
+bool world_map_compose_view(const MapView& view, uint8_t* out);
+
 #endif // WORLD_MAP_H
@@ -0,0 +1,177 @@
+"""Server-assisted mode: station lists and stream redirects for standalone frames.
+
+Frames built with SERVER_ASSIST (esp32/src/config.h) play on their own but
+ask this server before Radio.garden. It keeps an LRU of channel lists and
+resolved redirects (shared by every frame on the broker) and answers each
+request with one packed binary reply. The wire format is defined in
+esp32/src/mqtt_client.h:
+
+  request  radiowall/assist/<client>/req    <4sBBH16s  magic, type, seq, -, key
+  reply    radiowall/assist/<client>/reply  <4sBBBBHHI magic, type, seq, status,
+                                                      -, count, total, age_s
+    stations: count x (u8 id_len, id, u8 title_len, title)
+    url:      count bytes
+
+A miss (status 0) tells the frame to fetch from Radio.garden itself; so
+does no reply at all, which is why a stopped server never breaks a frame.
+Requests are answered on a small thread pool so one slow upstream fetch
+does not hold up the others.
+"""
+
+import logging
+import struct
+import threading
+import time
+from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
+from typing import Callable
+
+from radio_garden import RadioGardenClient
+
+logger = logging.getLogger(__name__)
+
+MAGIC = b"RWA1"
+REQUEST = struct.Struct("<4sBBH16s")
+REPLY = struct.Struct("<4sBBBBHHI")
+TYPE_STATIONS = 1
+TYPE_URL = 2
+STATUS_MISS = 0
+STATUS_HIT = 1
+
+MAX_PAYLOAD = 3584   # ASSIST_MAX_PAYLOAD: the frame's MQTT buffer
+ID_MAX = 15          # StationRecord.id without the terminator
+TITLE_MAX = 63       # StationRecord.title without the terminator
+URL_MAX = 255        # STREAM_URL_MAX without the terminator
+
+
+def truncate_utf8(text: str, limit: int) -> bytes:
+    """UTF-8 bytes of text, cut to at most limit bytes on a character boundary."""
+    data = text.encode("utf-8")
+    if len(data) <= limit:
+        return data
+    return data[:limit].decode("utf-8", errors="ignore").encode("utf-8")
+
+
+def pack_stations(stations: list[tuple[str, str]]) -> tuple[bytes, int]:
+    """Pack (id, title) records up to MAX_PAYLOAD. Returns (payload, count)."""
+    out = bytearray()
+    count = 0
+    for station_id, title in stations:
+        sid = station_id.encode("ascii", errors="ignore")
+        if not sid or len(sid) > ID_MAX:
+            continue
+        name = truncate_utf8(title, TITLE_MAX)
+        record = bytes([len(sid)]) + sid + bytes([len(name)]) + name
+        if len(out) + len(record) > MAX_PAYLOAD:
+            break
+        out += record
+        count += 1
+    return bytes(out), count
+
+
+class LruCache:
+    """Thread-safe LRU of (fetched_at, value) with a TTL."""
+
+    def __init__(self, max_entries: int, ttl: float):
+        self.max_entries = max_entries
+        self.ttl = ttl
+        self._entries: OrderedDict[str, tuple[float, object]] = OrderedDict()
+        self._lock = threading.Lock()
+
+    def get(self, key: str) -> tuple[float, object] | None:
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is None:
+                return None
+            if time.time() - entry[0] > self.ttl:
+                del self._entries[key]
+                return None
+            self._entries.move_to_end(key)
+            return entry
+
+    def put(self, key: str, value: object):
+        with self._lock:
+            self._entries[key] = (time.time(), value)
+            self._entries.move_to_end(key)
+            while len(self._entries) > self.max_entries:
+                self._entries.popitem(last=False)
+
+    def __len__(self) -> int:
+        return len(self._entries)
+
+
+class StationAssist:
+    def __init__(self, config: dict, radio: RadioGardenClient,
+                 publish: Callable[[str, bytes], None]):
+        self.radio = radio
+        self._publish = publish
+        self._channels = LruCache(config.get("max_places", 2000),
+                                  config.get("cache_channels_seconds", 1800))
+        self._urls = LruCache(config.get("max_urls", 20000),
+                              config.get("cache_urls_seconds", 86400))
+        self._pool = ThreadPoolExecutor(max_workers=config.get("workers", 4),
+                                        thread_name_prefix="assist")
+
+    def handle_request(self, topic: str, payload: bytes):
+        """MQTT callback for radiowall/assist/+/req: answer on the pool."""
+        if len(payload) != REQUEST.size or not topic.endswith("/req"):
+            logger.warning("Bad assist request on %s (%d bytes)", topic, len(payload))
+            return
+        magic, req_type, seq, _, key = REQUEST.unpack(payload)
+        if magic != MAGIC or req_type not in (TYPE_STATIONS, TYPE_URL):
+            logger.warning("Bad assist request on %s", topic)
+            return
+        key = key.split(b"\0", 1)[0].decode("ascii", errors="ignore")
+        reply_topic = topic[:-len("/req")] + "/reply"
+        self._pool.submit(self._answer, reply_topic, req_type, seq, key)
+
+    def stop(self):
+        self._pool.shutdown(wait=False)
+
+    # ------------------------------------------------------------------
+    # Internal
+    # ------------------------------------------------------------------
+
+    def _answer(self, reply_topic: str, req_type: int, seq: int, key: str):
+        start = time.time()
+        try:
+            if req_type == TYPE_STATIONS:
+                reply = self._stations_reply(req_type, seq, key)
+            else:
+                reply = self._url_reply(req_type, seq, key)
+        except Exception:
+            logger.exception("Assist request %d for %s failed", req_type, key)
+            reply = REPLY.pack(MAGIC, req_type, seq, STATUS_MISS, 0, 0, 0, 0)
+        self._publish(reply_topic, reply)
+        logger.debug("Assist %s %s: %d bytes in %.0f ms", "stations" if req_type == TYPE_STATIONS
+                     else "url", key, len(reply), (time.time() - start) * 1000)
+
+    def _stations_reply(self, req_type: int, seq: int, place_id: str) -> bytes:
+        entry = self._channels.get(place_id)
+        if entry is None:
+            stations = self.radio.get_stations(place_id)
+            if not stations:
+                # The frame would cache an empty list: let it fetch instead
+                return REPLY.pack(MAGIC, req_type, seq, STATUS_MISS, 0, 0, 0, 0)
+            self._channels.put(place_id, stations)
+            entry = (time.time(), stations)
+        fetched_at, stations = entry
+        payload, count = pack_stations(stations)
+        age_s = int(time.time() - fetched_at)
+        return REPLY.pack(MAGIC, req_type, seq, STATUS_HIT, 0, count,
+                          min(len(stations), 0xFFFF), age_s) + payload
+
+    def _url_reply(self, req_type: int, seq: int, station_id: str) -> bytes:
+        entry = self._urls.get(station_id)
+        if entry is None:
+            url = self.radio.resolve_redirect(station_id)
+            if url is None:
+                return REPLY.pack(MAGIC, req_type, seq, STATUS_MISS, 0, 0, 0, 0)
+            self._urls.put(station_id, url)
+            entry = (time.time(), url)
+        fetched_at, url = entry
+        data = url.encode("utf-8")
+        if not data or len(data) > URL_MAX:
+            return REPLY.pack(MAGIC, req_type, seq, STATUS_MISS, 0, 0, 0, 0)
+        return REPLY.pack(MAGIC, req_type, seq, STATUS_HIT, 0, len(data), 0,
+                          int(time.time() - fetched_at)) + data
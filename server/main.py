@@ -11,6 +11,7 @@ from pathlib import Path
 
 import yaml
 
+from assist import StationAssist
 from coordinates import CoordinateConverter
 from mqtt_handler import MqttHandler
 from radio_garden import RadioGardenClient
@@ -51,6 +52,10 @@ class RadioWallServer:
         self.radio = RadioGardenClient(config.get("radio_garden", {}))
         self.upnp = UpnpStreamer(config.get("upnp", {}))
         self.mqtt = MqttHandler(config.get("mqtt", {}))
+        self.assist: StationAssist | None = None
+        assist_cfg = config.get("assist", {})
+        if assist_cfg.get("enabled", False):
+            self.assist = StationAssist(assist_cfg, self.radio, self.mqtt.publish_raw)
         self._loop = asyncio.new_event_loop()
 
         # State for next/replay commands
@@ -70,6 +75,8 @@ class RadioWallServer:
         # Wire up MQTT callbacks
         self.mqtt.set_touch_callback(self._handle_touch)
         self.mqtt.set_command_callback(self._handle_command)
+        if self.assist:
+            self.mqtt.set_assist_callback(self.assist.handle_request)
 
         # Start MQTT (blocks)
         logger.info("Listening for touch events...")
@@ -163,6 +170,8 @@ def main():
     except KeyboardInterrupt:
         logger.info("Shutting down")
         server.mqtt.stop()
+        if server.assist:
+            server.assist.stop()
 
 
 if __name__ == "__main__":
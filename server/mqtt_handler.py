@@ -1,7 +1,8 @@
 """MQTT handler for RadioWall.
 
 Subscribes to touch events from the ESP32 and publishes now-playing/status updates.
-Uses paho-mqtt for the MQTT client.
+With an assist callback set, also takes the binary server-assisted requests
+(radiowall/assist/<client>/req, see assist.py). Uses paho-mqtt for the MQTT client.
 """
 
 import json
@@ -25,6 +26,7 @@ class MqttHandler:
         self.topic_nowplaying = topics.get("nowplaying", "radiowall/nowplaying")
         self.topic_status = topics.get("status", "radiowall/status")
         self.topic_command = topics.get("command", "radiowall/command")
+        self.topic_assist = topics.get("assist", "radiowall/assist")
 
         self._client = mqtt.Client(
             mqtt.CallbackAPIVersion.VERSION1,
@@ -35,6 +37,7 @@ class MqttHandler:
 
         self._on_touch: Callable[[int, int], None] | None = None
         self._on_command: Callable[[str], None] | None = None
+        self._on_assist: Callable[[str, bytes], None] | None = None
 
     def set_touch_callback(self, callback: Callable[[int, int], None]):
         """Set callback for touch events. Called with (x, y)."""
@@ -44,6 +47,10 @@ class MqttHandler:
         """Set callback for command events. Called with command string."""
         self._on_command = callback
 
+    def set_assist_callback(self, callback: Callable[[str, bytes], None]):
+        """Set callback for assist requests. Called with (topic, raw payload)."""
+        self._on_assist = callback
+
     def connect(self):
         """Connect to the MQTT broker."""
         if self.username:
@@ -84,6 +91,11 @@ class MqttHandler:
             payload["msg"] = msg
         self._client.publish(self.topic_status, json.dumps(payload), qos=1)
 
+    def publish_raw(self, topic: str, payload: bytes):
+        """Publish a binary payload (assist replies). QoS 0: a lost reply
+        only makes the frame fetch for itself."""
+        self._client.publish(topic, payload, qos=0)
+
     # ------------------------------------------------------------------
     # Internal callbacks
     # ------------------------------------------------------------------
@@ -94,10 +106,17 @@ class MqttHandler:
             client.subscribe(self.topic_touch, qos=1)
             client.subscribe(self.topic_command, qos=1)
             logger.info("Subscribed to %s, %s", self.topic_touch, self.topic_command)
+            if self._on_assist:
+                client.subscribe(f"{self.topic_assist}/+/req", qos=0)
+                logger.info("Answering assist requests on %s/+/req", self.topic_assist)
         else:
             logger.error("MQTT connection failed with code %d", rc)
 
     def _on_message(self, client, userdata, msg):
+        if self._on_assist and mqtt.topic_matches_sub(f"{self.topic_assist}/+/req", msg.topic):
+            self._on_assist(msg.topic, msg.payload)
+            return
+
         try:
             payload = json.loads(msg.payload.decode())
         except (json.JSONDecodeError, UnicodeDecodeError):
@@ -5,6 +5,7 @@ Fetches places, finds nearest stations to coordinates, and resolves stream URLs.
 
 import logging
 import random
+import threading
 import time
 from datetime import datetime
 
@@ -29,8 +30,18 @@ class RadioGardenClient:
 
         self._places: list[dict] = []
         self._places_fetched_at: float = 0
-        self._session = requests.Session()
-        self._session.headers.update({"Accept": "application/json"})
+        self._local = threading.local()
+
+    @property
+    def _session(self) -> requests.Session:
+        """This thread's Session (assist answers on a thread pool, and a
+        requests.Session is not safe to share between threads)."""
+        session = getattr(self._local, "session", None)
+        if session is None:
+            session = requests.Session()
+            session.headers.update({"Accept": "application/json"})
+            self._local.session = session
+        return session
 
     # ------------------------------------------------------------------
     # Places cache
@@ -126,6 +137,30 @@ class RadioGardenClient:
             })
         return results
 
+    # ------------------------------------------------------------------
+    # Station lists (server-assisted mode)
+    # ------------------------------------------------------------------
+
+    def get_stations(self, place_id: str) -> list[tuple[str, str]]:
+        """(station_id, title) of every channel of a place, in API order.
+
+        Matches what the ESP32 keeps from a channels page: items of every
+        content section whose page URL is /listen/{slug}/{id}.
+        """
+        resp = self._session.get(f"{self.base_url}/page/{place_id}/channels", timeout=10)
+        resp.raise_for_status()
+        stations = []
+        for section in resp.json()["data"]["content"]:
+            for item in section.get("items", []):
+                page = item.get("page", {})
+                title = page.get("title")
+                url = page.get("url", "")
+                _, sep, rest = url.partition("/listen/")
+                slug, _, station_id = rest.partition("/")
+                if title and sep and slug and station_id:
+                    stations.append((station_id, title))
+        return stations
+
     # ------------------------------------------------------------------
     # Stream URL resolution & validation
     # ------------------------------------------------------------------
@@ -148,6 +183,22 @@ class RadioGardenClient:
             logger.warning("Could not resolve stream URL for %s, using direct URL", station_id)
             return url
 
+    def resolve_redirect(self, station_id: str) -> str | None:
+        """Location of a station's channel.mp3 redirect, or None.
+
+        Unlike get_stream_url() there is no fallback: a frame given None
+        resolves the station itself.
+        """
+        url = f"{self.base_url}/listen/{station_id}/channel.mp3"
+        try:
+            resp = self._session.head(url, allow_redirects=False, timeout=10)
+        except Exception:
+            logger.warning("Could not resolve stream URL for %s", station_id)
+            return None
+        if resp.status_code in (301, 302, 307, 308):
+            return resp.headers.get("Location")
+        return None
+
     def check_stream(self, stream_url: str) -> bool:
         """Check if a stream URL is alive by reading the first chunk.
 
@@ -0,0 +1,452 @@
+#!/usr/bin/env python3
+"""
+Bake RadioWall's static UI chrome into indexed sprites for flash.
+
+The status bar icon buttons, the menu title and the menu cards are drawn
+from the same primitives every time a view opens. This tool renders them
+once, with ports of the Arduino_GFX routines the firmware uses
+(fillRoundRect, fillTriangle, drawLine, drawBitmap and GFXfont text), so a
+baked sprite is pixel for pixel what the primitives would draw. Colours
+come from theme.h, menu labels and icons from menu.cpp, the 16x16 icons
+from theme.h and the label font from FreeSansBold10pt7b.h. Re-run it after
+changing any of them or the layout constants below.
+
+Sprite format (ChromeSprite in chrome.h):
+  - w, h: uint16
+  - palette: up to 16 RGB565 colours
+  - pixels: 4 bits per pixel, rows padded to whole bytes, the left pixel
+    of each pair in the low nibble
+
+Output files:
+  - chrome_sprites.cpp: sprite data (built with -DCHROME_SPRITES)
+  - chrome_sprites.h: declarations
+
+Usage:
+    python bake_chrome.py [--output-dir ../esp32/src]
+"""
+
+import argparse
+import re
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).parent.parent
+SRC = ROOT / "esp32" / "src"
+
+# Layout, as in display.cpp and menu.cpp
+STATUS_BUTTONS = [
+    # (name, w, h, icon, colour)
+    ("BTN_MENU", 88, 25, "hamburger", "TH_ACCENT"),
+    ("BTN_NEXT", 90, 25, "next_arrow", "TH_ACCENT"),
+    ("BTN_BACK", 88, 28, "back_arrow", "TH_ACCENT"),
+    ("BTN_BACK_WIDE", 180, 28, "back_arrow", "TH_ACCENT"),
+    ("BTN_MUTE", 90, 28, "mute", "TH_ACCENT"),
+    ("BTN_PLUS", 90, 28, "plus", "TH_ACCENT"),
+    ("BTN_CLEAR", 90, 28, "x_mark", "TH_DANGER"),
+]
+MENU_TITLE_HEIGHT = 40
+MENU_ITEM_HEIGHT = 80
+MENU_ICON_SIZE = 16
+MENU_SPLIT_X1 = 62
+MENU_SPLIT_X2 = 120
+MENU_SPLIT_ICONS = ["ICON_PLAY_PAUSE", "ICON_STOP", "ICON_POWER"]
+
+
+def cdiv(a: int, b: int) -> int:
+    """C integer division (truncates toward zero)."""
+    q = abs(a) // abs(b)
+    return q if (a >= 0) == (b >= 0) else -q
+
+
+# ------------------------------------------------------------------
+# Sources
+# ------------------------------------------------------------------
+
+def read_theme(path: Path) -> tuple[dict, dict]:
+    """(#define integer values, 16x16 icon bitmaps) from theme.h."""
+    text = path.read_text()
+    defines = {m.group(1): int(m.group(2), 0) for m in
+               re.finditer(r"#define\s+(TH_\w+|FONT_\w+)\s+(0x[0-9A-Fa-f]+|\d+)\b", text)}
+    icons = {}
+    for m in re.finditer(r"static const uint8_t (ICON_\w+)\[\] PROGMEM = \{([^}]*)\}", text):
+        icons[m.group(1)] = [int(v, 16) for v in re.findall(r"0x[0-9A-Fa-f]{2}", m.group(2))]
+    return defines, icons
+
+
+def read_menu(path: Path) -> tuple[list, list]:
+    """(labels of the menu items in display order, icon names of the full rows)."""
+    text = path.read_text()
+    items = re.search(r"_items\[MENU_ITEM_COUNT\] = \{(.*?)\n\};", text, re.S).group(1)
+    labels = re.findall(r'\{\s*MENU_\w+,\s*"([^"]*)",', items)
+    icons = re.search(r"_icons\[\] = \{([^}]*)\}", text).group(1)
+    return labels, re.findall(r"ICON_\w+", icons)
+
+
+def read_gfx_font(path: Path) -> dict:
+    """A GFXfont header: bitmap bytes, glyph tuples and the first code."""
+    text = path.read_text()
+    bitmap = [int(v, 16) for v in
+              re.findall(r"0x[0-9A-Fa-f]{2}", re.search(r"Bitmaps\[\] PROGMEM = \{(.*?)\};", text, re.S).group(1))]
+    glyph_src = re.search(r"Glyphs\[\] PROGMEM = \{(.*?)\};", text, re.S).group(1)
+    glyphs = [tuple(int(v) for v in g.split(",")) for g in re.findall(r"\{([^{}]*)\}", glyph_src)]
+    first = int(re.search(r"\(GFXglyph \*\)\w+,\s*(0x[0-9A-Fa-f]+)", text).group(1), 16)
+    return {"bitmap": bitmap, "glyphs": glyphs, "first": first}
+
+
+# ------------------------------------------------------------------
+# Arduino_GFX primitives (Arduino_GFX.cpp, same integer arithmetic)
+# ------------------------------------------------------------------
+
+class Canvas:
+    def __init__(self, w: int, h: int, color: int):
+        self.w = w
+        self.h = h
+        self.px = [color] * (w * h)
+
+    def pixel(self, x: int, y: int, c: int):
+        if 0 <= x < self.w and 0 <= y < self.h:
+            self.px[y * self.w + x] = c
+
+    def fill_rect(self, x: int, y: int, w: int, h: int, c: int):
+        for yy in range(max(y, 0), min(y + h, self.h)):
+            for xx in range(max(x, 0), min(x + w, self.w)):
+                self.px[yy * self.w + xx] = c
+
+    def hline(self, x: int, y: int, w: int, c: int):
+        self.fill_rect(x, y, w, 1, c)
+
+    def vline(self, x: int, y: int, h: int, c: int):
+        self.fill_rect(x, y, 1, h, c)
+
+    def fill_ellipse_helper(self, x, y, rx, ry, corners, delta, c):
+        if rx < 0 or ry < 0 or (rx == 0 and ry == 0):
+            return
+        if ry == 0:
+            self.hline(x - rx, y, (ry << 2) + 1, c)
+            return
+        if rx == 0:
+            self.vline(x, y - ry, (rx << 2) + 1, c)
+            return
+        rx2 = rx * rx
+        ry2 = ry * ry
+        self.hline(x - rx, y, (rx << 1) + 1, c)
+        i = 0
+        yt = 0
+        xt = rx
+        s = (rx2 << 1) + ry2 * (1 - (rx << 1))
+        while True:
+            while s < 0:
+                yt += 1
+                s += rx2 * ((yt << 2) + 2)
+            if corners & 1:
+                self.fill_rect(x - xt, y - yt, (xt << 1) + 1 + delta, yt - i, c)
+            if corners & 2:
+                self.fill_rect(x - xt, y + i + 1, (xt << 1) + 1 + delta, yt - i, c)
+            i = yt
+            xt -= 1
+            s -= xt * ry2 << 2
+            if not rx2 * yt <= ry2 * xt:
+                break
+        xt = 0
+        yt = ry
+        s = (ry2 << 1) + rx2 * (1 - (ry << 1))
+        while True:
+            while s < 0:
+                xt += 1
+                s += ry2 * ((xt << 2) + 2)
+            if corners & 1:
+                self.hline(x - xt, y - yt, (xt << 1) + 1 + delta, c)
+            if corners & 2:
+                self.hline(x - xt, y + yt, (xt << 1) + 1 + delta, c)
+            yt -= 1
+            s -= yt * rx2 << 2
+            if not ry2 * xt <= rx2 * yt:
+                break
+
+    def fill_round_rect(self, x, y, w, h, r, c):
+        r = min(r, min(w, h) // 2)
+        self.fill_rect(x, y + r, w, h - (r << 1), c)
+        self.fill_ellipse_helper(x + r, y + r, r, r, 1, w - 2 * r - 1, c)
+        self.fill_ellipse_helper(x + r, y + h - r - 1, r, r, 2, w - 2 * r - 1, c)
+
+    def fill_triangle(self, x0, y0, x1, y1, x2, y2, c):
+        if y0 > y1:
+            y0, y1, x0, x1 = y1, y0, x1, x0
+        if y1 > y2:
+            y2, y1, x2, x1 = y1, y2, x1, x2
+        if y0 > y1:
+            y0, y1, x0, x1 = y1, y0, x1, x0
+        if y0 == y2:
+            a = min(x0, x1, x2)
+            b = max(x0, x1, x2)
+            self.hline(a, y0, b - a + 1, c)
+            return
+        dx01, dy01 = x1 - x0, y1 - y0
+        dx02, dy02 = x2 - x0, y2 - y0
+        dx12, dy12 = x2 - x1, y2 - y1
+        sa = sb = 0
+        last = y1 if y1 == y2 else y1 - 1
+        y = y0
+        while y <= last:
+            a = x0 + cdiv(sa, dy01)
+            b = x0 + cdiv(sb, dy02)
+            sa += dx01
+            sb += dx02
+            if a > b:
+                a, b = b, a
+            self.hline(a, y, b - a + 1, c)
+            y += 1
+        sa = dx12 * (y - y1)
+        sb = dx02 * (y - y0)
+        while y <= y2:
+            a = x1 + cdiv(sa, dy12)
+            b = x0 + cdiv(sb, dy02)
+            sa += dx12
+            sb += dx02
+            if a > b:
+                a, b = b, a
+            self.hline(a, y, b - a + 1, c)
+            y += 1
+
+    def line(self, x0, y0, x1, y1, c):
+        if x0 == x1:
+            self.vline(x0, min(y0, y1), abs(y1 - y0) + 1, c)
+            return
+        if y0 == y1:
+            self.hline(min(x0, x1), y0, abs(x1 - x0) + 1, c)
+            return
+        steep = abs(y1 - y0) > abs(x1 - x0)
+        if steep:
+            x0, y0, x1, y1 = y0, x0, y1, x1
+        if x0 > x1:
+            x0, x1, y0, y1 = x1, x0, y1, y0
+        dx = x1 - x0
+        dy = abs(y1 - y0)
+        err = dx >> 1
+        step = 1 if y0 < y1 else -1
+        while x0 <= x1:
+            if steep:
+                self.pixel(y0, x0, c)
+            else:
+                self.pixel(x0, y0, c)
+            err -= dy
+            if err < 0:
+                err += dx
+                y0 += step
+            x0 += 1
+
+    def bitmap(self, x, y, data, w, h, c):
+        byte_width = (w + 7) // 8
+        for j in range(h):
+            for i in range(w):
+                if data[j * byte_width + i // 8] & (0x80 >> (i & 7)):
+                    self.pixel(x + i, y + j, c)
+
+    def text(self, font, x, y, s, c):
+        """print() with a GFXfont at baseline y (no background)."""
+        for ch in s.encode("ascii"):
+            offset, w, h, x_advance, xo, yo = font["glyphs"][ch - font["first"]]
+            bit = 0
+            bits = 0
+            for yy in range(h):
+                for xx in range(w):
+                    if not bit & 7:
+                        bits = font["bitmap"][offset]
+                        offset += 1
+                    bit += 1
+                    if bits & 0x80:
+                        self.pixel(x + xo + xx, y + yo + yy, c)
+                    bits = (bits << 1) & 0xFF
+            x += x_advance
+
+
+# ------------------------------------------------------------------
+# Chrome (mirrors display.cpp and menu.cpp)
+# ------------------------------------------------------------------
+
+def draw_icon(cv: Canvas, icon: str, cx: int, cy: int, c: int):
+    """The status bar icon_* primitives of display.cpp."""
+    if icon == "hamburger":
+        for dy in (-4, -1, 2):
+            cv.fill_rect(cx - 6, cy + dy, 12, 2, c)
+    elif icon == "back_arrow":
+        cv.fill_triangle(cx + 5, cy - 6, cx + 5, cy + 6, cx - 5, cy, c)
+    elif icon == "next_arrow":
+        cv.fill_triangle(cx - 5, cy - 6, cx - 5, cy + 6, cx + 5, cy, c)
+    elif icon == "plus":
+        cv.fill_rect(cx - 1, cy - 5, 3, 11, c)
+        cv.fill_rect(cx - 5, cy - 1, 11, 3, c)
+    elif icon == "x_mark":
+        for d in (-1, 0, 1):
+            cv.line(cx - 4 + d, cy - 4, cx + 4 + d, cy + 4, c)
+            cv.line(cx + 4 + d, cy - 4, cx - 4 + d, cy + 4, c)
+    elif icon == "mute":
+        cv.fill_rect(cx - 5, cy - 2, 4, 5, c)
+        cv.fill_triangle(cx - 1, cy - 5, cx - 1, cy + 5, cx + 3, cy, c)
+        cv.line(cx + 4, cy - 3, cx + 7, cy + 3, c)
+        cv.line(cx + 7, cy - 3, cx + 4, cy + 3, c)
+    else:
+        raise ValueError(f"unknown icon {icon}")
+
+
+def status_button(th: dict, w: int, h: int, icon: str, color: str) -> Canvas:
+    cv = Canvas(w, h, th["TH_BG"])
+    cv.fill_round_rect(0, 0, w, h, th["TH_CORNER_R"], th["TH_BTN"])
+    draw_icon(cv, icon, w // 2, h // 2, th[color])
+    return cv
+
+
+def menu_title(th: dict, font: dict) -> Canvas:
+    cv = Canvas(th["TH_DISPLAY_W"], MENU_TITLE_HEIGHT, th["TH_BG"])
+    cv.text(font, 56, th["FONT_SANS_ASCENT"] + 8, "MENU", th["TH_ACCENT"])
+    cv.hline(5, MENU_TITLE_HEIGHT - 1, th["TH_DISPLAY_W"] - 10, th["TH_DIVIDER"])
+    return cv
+
+
+def menu_card(th: dict, icons: dict, font: dict, label: str, icon: str | None) -> Canvas:
+    """An enabled card, with (0, 0) at the card's top-left (TH_CARD_MARGIN, card_y)."""
+    margin = th["TH_CARD_MARGIN"]
+    w = th["TH_CARD_W"]
+    h = MENU_ITEM_HEIGHT - 8
+    cv = Canvas(w, h, th["TH_BG"])
+    cv.fill_round_rect(0, 0, w, h, th["TH_CORNER_R"], th["TH_CARD"])
+    icon_y = (h - MENU_ICON_SIZE) // 2
+    if icon is None:
+        # Split row: Play/Pause | Stop | Power Off
+        centers = [(margin + MENU_SPLIT_X1) // 2, (MENU_SPLIT_X1 + MENU_SPLIT_X2) // 2,
+                   (MENU_SPLIT_X2 + margin + w) // 2]
+        colors = [th["TH_ACCENT"], th["TH_ACCENT"], th["TH_DANGER"]]
+        for name, cx, c in zip(MENU_SPLIT_ICONS, centers, colors):
+            cv.bitmap(cx - MENU_ICON_SIZE // 2 - margin, icon_y, icons[name],
+                      MENU_ICON_SIZE, MENU_ICON_SIZE, c)
+        for x in (MENU_SPLIT_X1, MENU_SPLIT_X2):
+            cv.vline(x - margin, 6, h - 12, th["TH_DIVIDER"])
+    else:
+        cv.bitmap(14 - margin, icon_y, icons[icon], MENU_ICON_SIZE, MENU_ICON_SIZE, th["TH_ACCENT"])
+        baseline = h // 2 + th["FONT_SANS_ASCENT"] // 2 - 1
+        cv.text(font, 38 - margin, baseline, label, th["TH_TEXT"])
+    return cv
+
+
+# ------------------------------------------------------------------
+# Output
+# ------------------------------------------------------------------
+
+def pack(cv: Canvas) -> tuple[list, bytes]:
+    """(palette, 4-bit pixels) of a canvas."""
+    palette = []
+    for c in cv.px:
+        if c not in palette:
+            palette.append(c)
+    if len(palette) > 16:
+        raise ValueError(f"{len(palette)} colours in one sprite, at most 16")
+    index = {c: i for i, c in enumerate(palette)}
+    out = bytearray()
+    for y in range(cv.h):
+        row = cv.px[y * cv.w:(y + 1) * cv.w]
+        for x in range(0, cv.w, 2):
+            lo = index[row[x]]
+            hi = index[row[x + 1]] if x + 1 < cv.w else 0
+            out.append(lo | hi << 4)
+    return palette, bytes(out)
+
+
+def c_array(values, per_line: int, fmt: str) -> str:
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(fmt.format(v) for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def write_source(sprites: list, output_dir: Path):
+    cpp = output_dir / "chrome_sprites.cpp"
+    header = output_dir / "chrome_sprites.h"
+    body = []
+    decls = []
+    total = 0
+    for name, cv in sprites:
+        palette, pixels = pack(cv)
+        total += len(pixels) + len(palette) * 2
+        key = name.lower()
+        body.append(f"""\
+static const uint16_t {key}_palette[{len(palette)}] PROGMEM = {{
+{c_array(palette, 8, "0x{:04X}")}
+}};
+
+static const uint8_t {key}_pixels[{len(pixels)}] PROGMEM = {{
+{c_array(list(pixels), 16, "0x{:02X}")}
+}};
+
+const ChromeSprite CHROME_{name} = {{ {cv.w}, {cv.h}, {key}_palette, {key}_pixels }};
+""")
+        decls.append(f"extern const ChromeSprite CHROME_{name};   // {cv.w}x{cv.h}")
+
+    print(f"Writing {cpp}...")
+    cpp.write_text(f'''\
+/**
+ * Baked UI chrome for RadioWall ({len(sprites)} sprites)
+ *
+ * Auto-generated by bake_chrome.py
+ * Do not edit manually!
+ */
+
+#include "chrome_sprites.h"
+
+#if defined(CHROME_SPRITES)
+
+{chr(10).join(body)}
+#endif // CHROME_SPRITES
+''')
+
+    print(f"Writing {header}...")
+    header.write_text(f'''\
+/**
+ * Baked UI chrome for RadioWall
+ *
+ * Auto-generated by bake_chrome.py
+ * Do not edit manually!
+ */
+
+#ifndef CHROME_SPRITES_H
+#define CHROME_SPRITES_H
+
+#include "chrome.h"
+
+{chr(10).join(decls)}
+
+#endif // CHROME_SPRITES_H
+''')
+    print(f"  {len(sprites)} sprites, {total / 1024:.1f} KB of flash")
+
+
+def build_sprites(th: dict, icons: dict, font: dict, labels: list, row_icons: list) -> list:
+    sprites = [(name, status_button(th, w, h, icon, color))
+               for name, w, h, icon, color in STATUS_BUTTONS]
+    sprites.append(("MENU_TITLE", menu_title(th, font)))
+    for i, label in enumerate(labels):
+        icon = row_icons[i] if i < len(row_icons) else None
+        sprites.append((f"MENU_CARD_{i}", menu_card(th, icons, font, label, icon)))
+    return sprites
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Bake the static UI chrome into flash sprites")
+    parser.add_argument("--output-dir", "-o", type=Path, default=SRC,
+                        help="Output directory (default: ../esp32/src)")
+    args = parser.parse_args()
+
+    th, icons = read_theme(SRC / "theme.h")
+    labels, row_icons = read_menu(SRC / "menu.cpp")
+    font = read_gfx_font(SRC / "FreeSansBold10pt7b.h")
+    print(f"Theme: {len(th)} values, {len(icons)} icons; menu: {len(labels)} items")
+
+    sprites = build_sprites(th, icons, font, labels, row_icons)
+    args.output_dir.mkdir(parents=True, exist_ok=True)
+    write_source(sprites, args.output_dir)
+
+    print("\nDone! Build with -DCHROME_SPRITES (see platformio.ini)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""
+Format RadioWall's deferred binary log on the host.
+
+The firmware's BINLOG_* calls keep a record per call (see
+esp32/src/binlog.h) with the flash address of the format string instead
+of the formatted text. Serial "LOG:bin" dumps the ring as lines of hex:
+
+    [Log] bin <52 bytes as hex>
+
+This tool reads those lines (from a file or stdin, other lines are
+skipped), looks each format string up in the firmware ELF and formats the
+record with its arguments, as the device's "LOG" command would.
+
+Record layout (little-endian, 52 bytes):
+  time_us   uint32   micros() when recorded
+  fmt       uint32   address of the printf format string
+  level     uint8    0 debug, 1 info, 2 warn
+  nargs     uint8    arguments used (up to 4)
+  kinds     uint8    2 bits per argument: 0 word, 1 float, 2 string
+  core      uint8    CPU core that recorded it
+  args[4]   uint32   word, float bits, or offset into text
+  text[24]  char     the string arguments, NUL-terminated
+
+Requires pyelftools (pip install pyelftools).
+
+Usage:
+    python binlog_decode.py ../esp32/.pio/build/t-display-s3-long/firmware.elf [capture.txt]
+"""
+
+import argparse
+import re
+import struct
+import sys
+from pathlib import Path
+
+from elftools.elf.constants import SH_FLAGS
+from elftools.elf.elffile import ELFFile
+
+RECORD = struct.Struct("<IIBBBB4I24s")
+LEVELS = "DIW"
+KIND_WORD, KIND_FLOAT, KIND_STRING = 0, 1, 2
+
+# A printf conversion, as the device's format_record() splits them
+CONVERSION = re.compile(r"%(?:%|[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z|j|t)?([diouxXcsfFeEgGaAp]))")
+
+
+class FormatStrings:
+    """Format strings read from the ELF's loaded sections, by address."""
+
+    def __init__(self, path):
+        self._sections = []
+        with open(path, "rb") as f:
+            elf = ELFFile(f)
+            for s in elf.iter_sections():
+                if s["sh_flags"] & SH_FLAGS.SHF_ALLOC and s["sh_type"] == "SHT_PROGBITS":
+                    self._sections.append((s["sh_addr"], s.data()))
+        self._cache = {}
+
+    def get(self, addr):
+        if addr not in self._cache:
+            self._cache[addr] = None
+            for base, data in self._sections:
+                if base <= addr < base + len(data):
+                    end = data.index(b"\0", addr - base)
+                    self._cache[addr] = data[addr - base:end].decode("utf-8", "replace")
+                    break
+        return self._cache[addr]
+
+
+def argument(kind, word, text, conv):
+    if kind == KIND_FLOAT:
+        return struct.unpack("<f", struct.pack("<I", word))[0]
+    if kind == KIND_STRING:
+        raw = text[min(word, len(text) - 1):]
+        return raw.split(b"\0", 1)[0].decode("utf-8", "replace")
+    if conv in "di":
+        return word - (1 << 32) if word & 0x80000000 else word
+    return word
+
+
+def format_record(fmt, nargs, kinds, args, text):
+    out = []
+    pos = 0
+    n = 0
+    for m in CONVERSION.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        conv = m.group(1)
+        if conv is None:
+            out.append("%")
+            continue
+        if n >= nargs:
+            continue
+        value = argument((kinds >> (2 * n)) & 3, args[n], text, conv)
+        n += 1
+        spec = re.sub(r"(hh|h|ll|l|z|j|t)(?=.$)", "", m.group(0))
+        if conv == "p":
+            out.append(f"0x{value:x}")
+        elif conv in "iu":
+            out.append((spec[:-1] + "d") % value)
+        else:
+            out.append(spec % value)
+    out.append(fmt[pos:])
+    return "".join(out).rstrip("\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Format a LOG:bin dump from RadioWall")
+    parser.add_argument("elf", type=Path, help="firmware.elf of the build that logged")
+    parser.add_argument("capture", type=Path, nargs="?", help="serial capture (default: stdin)")
+    args = parser.parse_args()
+
+    strings = FormatStrings(args.elf)
+    lines = args.capture.read_text(errors="replace").splitlines() if args.capture else sys.stdin
+
+    for line in lines:
+        m = re.search(r"\[Log\] bin ([0-9a-f]+)", line)
+        if not m or len(m.group(1)) != 2 * RECORD.size:
+            continue
+        time_us, fmt_addr, level, nargs, kinds, core, *rest = RECORD.unpack(bytes.fromhex(m.group(1)))
+        words, text = rest[:4], rest[4]
+        fmt = strings.get(fmt_addr)
+        if fmt is None:
+            msg = f"<no format string at 0x{fmt_addr:08x}: wrong ELF?>"
+        else:
+            msg = format_record(fmt, nargs, kinds, words, text)
+        print(f"{time_us // 1000000:10d}.{time_us % 1000000:06d} "
+              f"{LEVELS[min(level, 2)]}{core} {msg}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
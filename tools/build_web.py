@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+"""
+Gzip the web remote for LittleFS.
+
+The firmware's web remote (esp32/src/web_remote.h) serves esp32/web/ from
+LittleFS under /www/, and only keeps the gzipped copies: the async
+server sends file.gz with Content-Encoding: gzip when file is asked for.
+Every file in esp32/web/ is compressed into esp32/data/www/<name>.gz
+(mtime 0, so unchanged sources give identical output).
+
+Usage:
+    python build_web.py [--src ../esp32/web] [--out ../esp32/data/www]
+"""
+
+import argparse
+import gzip
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).parent.parent
+DEFAULT_SRC = ROOT / "esp32" / "web"
+DEFAULT_OUT = ROOT / "esp32" / "data" / "www"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gzip the web remote for LittleFS")
+    parser.add_argument("--src", type=Path, default=DEFAULT_SRC, help=f"sources (default {DEFAULT_SRC})")
+    parser.add_argument("--out", type=Path, default=DEFAULT_OUT, help=f"output (default {DEFAULT_OUT})")
+    args = parser.parse_args()
+
+    files = sorted(p for p in args.src.iterdir() if p.is_file())
+    if not files:
+        print(f"No files in {args.src}", file=sys.stderr)
+        return 1
+
+    args.out.mkdir(parents=True, exist_ok=True)
+    for path in files:
+        data = path.read_bytes()
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+        (args.out / (path.name + ".gz")).write_bytes(packed)
+        print(f"  {path.name}: {len(data)} -> {len(packed)} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -9,43 +9,165 @@ Output files:
   - places.bin: Binary database for LittleFS (upload to ESP32 data partition)
   - places_info.h: C header with metadata (place count, struct definition)
 
-Binary format:
+Binary format (v3, little-endian):
   Header (16 bytes):
     - Magic: "RGPL" (4 bytes)
-    - Version: uint16 (2 bytes)
-    - Place count: uint32 (4 bytes)
-    - Reserved: 6 bytes
-
-  Each place (52 bytes):
-    - id: char[16] (null-padded Radio.garden place ID)
-    - lat_x100: int16 (latitude * 100, e.g. 48.21° → 4821)
-    - lon_x100: int16 (longitude * 100)
-    - name: char[28] (null-padded city name, UTF-8 truncated)
-    - country: char[4] (ISO country code, null-padded)
+    - Version: uint16 (3)
+    - Section count: uint16
+    - Place count: uint32
+    - Cell shift: uint8 (index cell = 2^shift hundredths of a degree)
+    - Reserved: 3 bytes
+
+  Section table, one 12-byte entry per section:
+    - Tag: char[4]
+    - Offset: uint32 (from the start of the file, 16-byte aligned)
+    - Size: uint32 (bytes)
+
+  Sections (readers skip tags they do not know):
+    LAT   int16 latitude * 100 per place
+    LON   int16 longitude * 100 per place
+    PID   6 bytes per place: the 8-character base64url place ID, decoded
+    REF   uint32 per place: name offset into STR << 8 | country index
+    CTRY  uint32 offset into STR per country (up to 256)
+    STR   NUL-terminated UTF-8 strings, each distinct string stored once
+    CELL  {uint16 cell, uint16 first place} per non-empty index cell,
+          ascending, then a {0xFFFF, place count} sentinel
+    SCNT  uint8 station count per place, 255 meaning 255 or more
+          (optional: written when the source has counts; the API's
+          "size" field)
+    FOLD  uint8 per code point U+00C0..U+024F: the lowercase ASCII
+          letter it folds to (NFKD base, plus ß, ø, ł, ...), 0 to keep it
+    NAME  uint16 place per place, ascending by folded name
+    TRIX  {uint32 trigram, uint32 first posting} per distinct trigram of
+          the folded names, ascending, then a {0xFFFFFFFF, posting
+          count} sentinel
+    TRIP  uint16 places per trigram, ascending within each trigram
+    CPLC  uint16 place per place, grouped by country in CTRY order; within
+          a country by station count (SCNT), most first, then file order
+    CBOX  per CTRY entry {uint16 first, uint16 count} into CPLC, then its
+          bounding box {int16 lat_min, lat_max, lon_min, lon_max} * 100;
+          lon_min > lon_max when the box crosses the antimeridian
+    VIEW  {uint8 cols, uint8 rows, uint8 slices, uint8 0}, then uint16
+          first entry per tile (slice, row, col order) and a sentinel,
+          then uint16 places in tile order, ascending within a tile
+
+  Name search (FOLD, NAME, TRIX, TRIP) works on folded names: ASCII
+  letters and digits lowercased, FOLD applied to accented Latin letters,
+  other characters kept as UTF-8, and every run of ASCII punctuation or
+  spaces turned into one space (none at either end). A folded name is
+  cut before the unit that would take it past 47 bytes. The device folds
+  names and queries the same way with the FOLD table, so a prefix
+  search is a binary search over NAME, comparing names from STR. A
+  trigram is 3 bytes of " " + folded name + " " (b0 << 16 | b1 << 8 |
+  b2); each name is listed once per distinct trigram, so fuzzy search
+  counts the trigrams a query shares with each name by merging the
+  query's posting lists.
+
+  Country queries (CPLC, CBOX) enumerate a country's places without a
+  full scan: its K best are the first K of its CPLC run. They need whole
+  country names: v1 kept 3 bytes of each, which merges countries ("Uni"
+  is the United States, the United Kingdom and the Emirates), so a source
+  whose names are all that short gets no CPLC or CBOX and the device
+  plays country taps as location taps. Download again to get them back.
+
+  The view partition (VIEW) cuts each map slice of map_layout.h into
+  cols x rows equal tiles. A place belongs to the first slice whose
+  longitudes hold it (else the last, which runs past 180), column
+  lon offset * cols // (span * 100) and row (9000 - lat) * rows // 18000,
+  so a map view lists its places from the few tiles it overlaps. Rebuild
+  after changing the slices.
+
+  Places are sorted along a Hilbert curve over (lon + 180, lat + 90) in
+  hundredths of a degree (65536 x 65536 grid). The curve fills every
+  aligned 2^shift square before leaving it, so a cell is one contiguous
+  run of places and its number is the Hilbert index of (x >> shift,
+  y >> shift) on the coarser grid: CELL is the spatial index. Unlike
+  Morton order, consecutive cells are always neighbours, so a search
+  spanning several cells reads few separate runs. The place index is
+  stable for a given version; v2 used Morton order.
+
+Migrating without network access:
+    python compile_places.py --from-bin ../esp32/data/places.bin
+  re-encodes an existing file (any version, including v1's fixed
+  52-byte records).
+
+Scalability test databases:
+    python compile_places.py --from-bin ../esp32/data/places.bin \
+        --synthetic 60000 -o /tmp/places60k --header-dir /tmp/places60k
+  pads the places read to 60,000 with made-up ones, each near a real
+  place picked at random, in its country and with a station count drawn
+  from the real ones, so density follows the real map and every section
+  grows as it would. Names are random syllables and IDs random, from
+  --seed (the same file on every run). Handles are 16 bits, so the
+  format holds at most MAX_PLACES (65,534) places. Upload the result to
+  LittleFS and erase the "places" partition first:
+      esptool.py --chip esp32s3 erase_region 0x710000 0x100000
+  The device maps any valid image it finds there before it looks at
+  LittleFS, so with the real database still flashed the synthetic file
+  is ignored (BENCH:places prints the place count it ran on). Then run
+  BENCH:places: it prints the load time and heap of the database, then
+  the lookup cases by each strategy. Flash the real places.bin back
+  into the partition afterwards.
 
 Usage:
-    python compile_places.py [--output-dir ../esp32/data]
+    python compile_places.py [--output-dir ../esp32/data] [--from-bin FILE]
+                             [--synthetic COUNT [--seed N]]
 """
 
 import argparse
+import random
+import re
 import struct
 import sys
+import unicodedata
 from pathlib import Path
 
-import requests
-
 # Radio.garden API
 PLACES_URL = "http://radio.garden/api/ara/content/places"
 
 # Binary format constants
 MAGIC = b"RGPL"
-VERSION = 1
-PLACE_STRUCT_SIZE = 52  # bytes per place
+VERSION = 3
 HEADER_SIZE = 16
+SECTION_ENTRY_SIZE = 12
+SECTION_ALIGN = 16
+CELL_SHIFT = 8           # 2.56 degree index cells
+CURVE_BITS = 16          # Hilbert grid is 2^16 hundredths of a degree per side
+PLACE_STRUCT_SIZE = 52   # Decoded on-device record (places_info.h)
+ID_LEN = 8
+ID_BYTES = 6
+NAME_MAX = 27            # Place.name holds 27 bytes + NUL
+FOLD_FIRST = 0x00C0      # FOLD covers Latin-1 letters and Latin Extended-A/B
+FOLD_LAST = 0x024F
+KEY_MAX = 47             # Folded name bytes (search key buffer holds 47 + NUL)
+VIEW_COLS = 10           # View partition tiles per slice (the tile pyramid's
+VIEW_ROWS = 20           # 5x grid: a zoomed view overlaps 3 x 5 or so)
+COUNTRY_CUT_LEN = 3      # v1's country field: names this short are prefixes
+MAX_PLACES = 0xFFFE      # 16-bit handles, 0xFFFF is PLACE_NONE
+PLACES_PARTITION_SIZE = 0x100000   # "places" in partitions.csv
+SYNTH_SPREAD = 0.6       # Degrees (standard deviation) round the real place
+SYNTH_SYLLABLES = ["ka", "lo", "ver", "mi", "sta", "dun", "ri", "bel", "tor", "na",
+                   "zan", "ho", "au", "len", "gar", "chi", "po", "wes", "do", "ny"]
+MAP_LAYOUT = Path(__file__).resolve().parent.parent / "esp32" / "src" / "map_layout.h"
+
+# Letters NFKD does not decompose to an ASCII base
+FOLD_EXTRA = {
+    "Æ": "a", "æ": "a", "Ð": "d", "ð": "d", "Ø": "o", "ø": "o", "Þ": "t", "þ": "t",
+    "ß": "s", "Đ": "d", "đ": "d", "Ħ": "h", "ħ": "h", "ı": "i", "Ł": "l", "ł": "l",
+    "Œ": "o", "œ": "o", "Ŧ": "t", "ŧ": "t", "ƒ": "f",
+}
+
+# v1 input (--from-bin)
+V1_HEADER_SIZE = 16
+V1_RECORD_SIZE = 52
+
+BASE64URL = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
 
 
 def fetch_places() -> list[dict]:
     """Fetch all places from Radio.garden API."""
+    import requests  # Only needed when downloading
+
     print("Fetching places from Radio.garden...")
 
     session = requests.Session()
@@ -62,10 +184,8 @@ def fetch_places() -> list[dict]:
     return places
 
 
-def encode_place(place: dict) -> bytes:
-    """Encode a single place to binary format (52 bytes)."""
-    place_id = place["id"][:15].encode("utf-8")  # Max 15 chars + null
-
+def place_coords_x100(place: dict) -> tuple[int, int]:
+    """Return (lat_x100, lon_x100) as stored in the binary."""
     # Radio.garden geo is [longitude, latitude] - careful!
     lon = place["geo"][0]
     lat = place["geo"][1]
@@ -77,45 +197,390 @@ def encode_place(place: dict) -> bytes:
     # Clamp to int16 range (shouldn't happen for valid coords)
     lat_x100 = max(-32767, min(32767, lat_x100))
     lon_x100 = max(-32767, min(32767, lon_x100))
+    return lat_x100, lon_x100
+
+
+def hilbert_index(bits: int, x: int, y: int) -> int:
+    """Position of (x, y) along the Hilbert curve of a 2^bits grid."""
+    n = 1 << bits
+    d = 0
+    s = n >> 1
+    while s:
+        rx = 1 if x & s else 0
+        ry = 1 if y & s else 0
+        d += s * s * ((3 * rx) ^ ry)
+        if ry == 0:
+            if rx == 1:
+                x, y = n - 1 - x, n - 1 - y
+            x, y = y, x
+        s >>= 1
+    return d
+
+
+def curve_key(lat_x100: int, lon_x100: int) -> int:
+    """Hilbert index of (lon + 180, lat + 90) in hundredths of a degree."""
+    x = (lon_x100 + 18000) % 36000
+    y = max(0, min(18000, lat_x100 + 9000))
+    return hilbert_index(CURVE_BITS, x, y)
+
+
+def pack_id(place_id: str) -> bytes:
+    """Decode an 8-character base64url place ID into 6 bytes."""
+    if len(place_id) != ID_LEN or any(c not in BASE64URL for c in place_id):
+        raise ValueError(f"place ID {place_id!r} is not {ID_LEN} base64url characters")
+    value = 0
+    for c in place_id:
+        value = (value << 6) | BASE64URL.index(c)
+    return value.to_bytes(ID_BYTES, "big")
+
+
+class StringTable:
+    """NUL-terminated strings, each stored once."""
+
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets: dict[bytes, int] = {}
+
+    def add(self, s: bytes) -> int:
+        if s not in self.offsets:
+            self.offsets[s] = len(self.data)
+            self.data += s + b"\x00"
+        return self.offsets[s]
+
+
+def build_fold_table() -> bytes:
+    """FOLD section: ASCII letter per code point FOLD_FIRST..FOLD_LAST, or 0."""
+    table = bytearray()
+    for cp in range(FOLD_FIRST, FOLD_LAST + 1):
+        ch = chr(cp)
+        base = FOLD_EXTRA.get(ch) or unicodedata.normalize("NFKD", ch)[0]
+        table.append(ord(base.lower()) if base.isascii() and base.isalnum() else 0)
+    return bytes(table)
+
+
+def fold_name(name: str, fold: bytes) -> bytes:
+    """Search key of a name, as places_db.cpp's fold_text() makes it."""
+    out = bytearray()
+    space = False
+    for ch in name:
+        cp = ord(ch)
+        if cp < 0x80:
+            if not ch.isalnum():
+                space = bool(out)
+                continue
+            unit = ch.lower().encode()
+        elif FOLD_FIRST <= cp <= FOLD_LAST and fold[cp - FOLD_FIRST]:
+            unit = bytes([fold[cp - FOLD_FIRST]])
+        else:
+            unit = ch.encode("utf-8", errors="replace")
+        if space:
+            unit = b" " + unit
+            space = False
+        if len(out) + len(unit) > KEY_MAX:
+            break
+        out += unit
+    return bytes(out)
+
+
+def build_search_sections(places: list[dict]) -> list[tuple[bytes, bytes]]:
+    """FOLD, NAME, TRIX and TRIP for places in file order."""
+    fold = build_fold_table()
+    keys = [fold_name(p.get("title", "Unknown"), fold) for p in places]
+    by_name = sorted(range(len(places)), key=lambda i: (keys[i], i))
+
+    postings: dict[int, list[int]] = {}
+    for i, key in enumerate(keys):
+        padded = b" " + key + b" "
+        grams = {padded[j] << 16 | padded[j + 1] << 8 | padded[j + 2]
+                 for j in range(len(padded) - 2)}
+        for gram in grams:
+            postings.setdefault(gram, []).append(i)
+
+    index, lists = bytearray(), bytearray()
+    for gram in sorted(postings):
+        index += struct.pack("<II", gram, len(lists) // 2)
+        lists += struct.pack(f"<{len(postings[gram])}H", *postings[gram])
+    index += struct.pack("<II", 0xFFFFFFFF, len(lists) // 2)
+    print(f"  Search index: {len(postings)} trigrams, {len(lists) // 2} postings")
+    return [
+        (b"FOLD", fold),
+        (b"NAME", struct.pack(f"<{len(by_name)}H", *by_name)),
+        (b"TRIX", bytes(index)),
+        (b"TRIP", bytes(lists)),
+    ]
+
+
+def lon_span(lons: list[int]) -> tuple[int, int]:
+    """Smallest longitude interval (west, east) covering lons, x100. It
+    leaves out the widest gap between neighbours, which may be the one
+    across the antimeridian (then west > east)."""
+    lons = sorted(set(lons))
+    gap, west = 36000 - lons[-1] + lons[0], lons[0]
+    for a, b in zip(lons, lons[1:]):
+        if b - a > gap:
+            gap, west = b - a, b
+    east = lons[lons.index(west) - 1] if west != lons[0] else lons[-1]
+    return west, east
+
+
+def build_country_sections(places: list[dict], country_of: list[int],
+                           country_count: int) -> list[tuple[bytes, bytes]]:
+    """CPLC and CBOX for places in file order."""
+    members: list[list[int]] = [[] for _ in range(country_count)]
+    for i, c in enumerate(country_of):
+        members[c].append(i)
+
+    order, boxes = [], bytearray()
+    for group in members:
+        group.sort(key=lambda i: (-max(0, places[i].get("size") or 0), i))
+        coords = [place_coords_x100(places[i]) for i in group]
+        lats = [lat for lat, _ in coords]
+        west, east = lon_span([lon for _, lon in coords])
+        boxes += struct.pack("<HHhhhh", len(order), len(group), min(lats), max(lats), west, east)
+        order += group
+    print(f"  Country index: {country_count} countries")
+    return [
+        (b"CPLC", struct.pack(f"<{len(order)}H", *order)),
+        (b"CBOX", bytes(boxes)),
+    ]
+
+
+def read_slices(path: Path) -> list[tuple[int, int]]:
+    """(lon_min, lon_span) in degrees per map slice, from map_layout.h."""
+    text = path.read_text(encoding="utf-8")
+    slices = [(int(lo), int(span)) for lo, span in
+              re.findall(r'\{"[^"]*", "[^"]*", (-?\d+), (\d+)\}', text)]
+    if not slices:
+        raise ValueError(f"no MAP_SLICE_LAYOUT in {path}")
+    return slices
+
+
+def view_tile(lat_x100: int, lon_x100: int, slices: list[tuple[int, int]]) -> int:
+    """Index of a place's VIEW tile (city_dots.cpp picks slices the same way)."""
+    s = len(slices) - 1
+    for i, (lo, span) in enumerate(slices[:-1]):
+        if lo * 100 <= lon_x100 < (lo + span) * 100:
+            s = i
+            break
+    lo, span = slices[s]
+    dx = lon_x100 - lo * 100
+    if dx < 0:
+        dx += 36000
+    col = min(VIEW_COLS - 1, dx * VIEW_COLS // (span * 100))
+    row = min(VIEW_ROWS - 1, (9000 - lat_x100) * VIEW_ROWS // 18000)
+    return (s * VIEW_ROWS + row) * VIEW_COLS + col
+
+
+def build_view_section(places: list[dict]) -> list[tuple[bytes, bytes]]:
+    """VIEW for places in file order."""
+    slices = read_slices(MAP_LAYOUT)
+    tiles: list[list[int]] = [[] for _ in range(len(slices) * VIEW_ROWS * VIEW_COLS)]
+    for i, place in enumerate(places):
+        tiles[view_tile(*place_coords_x100(place), slices)].append(i)
+
+    firsts, order = [], []
+    for members in tiles:
+        firsts.append(len(order))
+        order += members
+    firsts.append(len(order))
+    print(f"  View partition: {len(slices)} slices of {VIEW_COLS} x {VIEW_ROWS} tiles, "
+          f"up to {max(len(t) for t in tiles)} places a tile")
+    data = struct.pack("<BBBB", VIEW_COLS, VIEW_ROWS, len(slices), 0)
+    data += struct.pack(f"<{len(firsts)}H", *firsts)
+    data += struct.pack(f"<{len(order)}H", *order)
+    return [(b"VIEW", data)]
+
+
+def build_sections(places: list[dict]) -> tuple[list[tuple[bytes, bytes]], list[dict]]:
+    """Sort places and encode the sections. Returns (sections, sorted places)."""
+    places = sorted(places, key=lambda p: curve_key(*place_coords_x100(p)))
+    if len(places) > MAX_PLACES:
+        raise ValueError(f"{len(places)} places do not fit 16-bit handles")
+    has_counts = all(isinstance(p.get("size"), int) for p in places)
+
+    strings = StringTable()
+    countries: dict[bytes, int] = {}
+    lat, lon, ids, refs = bytearray(), bytearray(), bytearray(), bytearray()
+    cells = bytearray()
+    country_of = []
+    prev_cell = None
+
+    for i, place in enumerate(places):
+        lat_x100, lon_x100 = place_coords_x100(place)
+        lat += struct.pack("<h", lat_x100)
+        lon += struct.pack("<h", lon_x100)
+        ids += pack_id(place["id"])
+
+        # Names and countries are stored whole and cut on the device; whole
+        # country names keep "United States" and "United Kingdom" apart in
+        # the country runs
+        name = place.get("title", "Unknown").encode("utf-8", errors="replace")
+        country = place.get("country", "??").encode("utf-8", errors="replace")
+        if country not in countries:
+            if len(countries) == 256:
+                raise ValueError("more than 256 distinct countries")
+            countries[country] = len(countries)
+        name_off = strings.add(name)
+        if name_off >= 1 << 24:
+            raise ValueError("string table larger than 16 MB")
+        refs += struct.pack("<I", name_off << 8 | countries[country])
+        country_of.append(countries[country])
+
+        cell = curve_key(lat_x100, lon_x100) >> (2 * CELL_SHIFT)
+        if cell != prev_cell:
+            cells += struct.pack("<HH", cell, i)
+            prev_cell = cell
+    cells += struct.pack("<HH", 0xFFFF, len(places))
+
+    ctry = b"".join(struct.pack("<I", strings.add(c)) for c in countries)
+    sections = [
+        (b"LAT ", bytes(lat)),
+        (b"LON ", bytes(lon)),
+        (b"PID ", bytes(ids)),
+        (b"REF ", bytes(refs)),
+        (b"CTRY", ctry),
+        (b"STR ", bytes(strings.data)),
+        (b"CELL", bytes(cells)),
+    ]
+    if has_counts:
+        counts = bytes(max(0, min(255, p["size"])) for p in places)
+        sections.append((b"SCNT", counts))
+        print(f"  Station counts: {counts.count(0)} places without stations")
+    else:
+        print("  No station counts in the source, SCNT omitted")
+    sections += build_search_sections(places)
+    if max(len(c) for c in countries) > COUNTRY_CUT_LEN:
+        sections += build_country_sections(places, country_of, len(countries))
+    else:
+        print(f"  Country names cut to {COUNTRY_CUT_LEN} bytes in the source, CPLC and CBOX omitted")
+    sections += build_view_section(places)
+    return sections, places
+
+
+def write_binary(places: list[dict], output_path: Path) -> list[dict]:
+    """Write places to binary file. Returns the places in file order."""
+    print(f"Writing {output_path}...")
+    sections, places = build_sections(places)
 
-    # City name - truncate to 27 chars + null
-    name = place.get("title", "Unknown")[:27].encode("utf-8", errors="replace")
+    table_size = len(sections) * SECTION_ENTRY_SIZE
+    offset = HEADER_SIZE + table_size
+    layout = []
+    for tag, data in sections:
+        offset = (offset + SECTION_ALIGN - 1) // SECTION_ALIGN * SECTION_ALIGN
+        layout.append((tag, offset, data))
+        offset += len(data)
 
-    # Country code
-    country = place.get("country", "??")[:3].encode("utf-8", errors="replace")
+    with open(output_path, "wb") as f:
+        f.write(struct.pack("<4sHHIB3s", MAGIC, VERSION, len(sections), len(places),
+                            CELL_SHIFT, b"\x00" * 3))
+        for tag, off, data in layout:
+            f.write(struct.pack("<4sII", tag, off, len(data)))
+        for tag, off, data in layout:
+            f.write(b"\x00" * (off - f.tell()))
+            f.write(data)
 
-    # Pack: 16s = char[16], h = int16, 28s = char[28], 4s = char[4]
-    return struct.pack(
-        "<16shh28s4s",
-        place_id.ljust(16, b"\x00"),
-        lat_x100,
-        lon_x100,
-        name.ljust(28, b"\x00"),
-        country.ljust(4, b"\x00"),
-    )
+    size_kb = output_path.stat().st_size / 1024
+    print(f"  Written {size_kb:.1f} KB ({len(places)} places, "
+          f"{len(dict(sections)[b'CELL']) // 4 - 1} index cells)")
+    for tag, off, data in layout:
+        print(f"    {tag.decode()}  {len(data) / 1024:7.1f} KB")
+    if offset > PLACES_PARTITION_SIZE:
+        print(f"  Larger than the {PLACES_PARTITION_SIZE // 1024} KB places partition: "
+              "upload it to LittleFS and erase the partition (a valid image there "
+              "is used first)")
+    return places
 
 
-def write_binary(places: list[dict], output_path: Path):
-    """Write places to binary file."""
-    print(f"Writing {output_path}...")
+def read_binary(path: Path) -> list[dict]:
+    """Places from an existing places.bin, in the shape the API returns."""
+    data = path.read_bytes()
+    version = struct.unpack_from("<H", data, 4)[0] if data[:4] == MAGIC else 0
+    if version == 1:
+        places = read_v1_places(data)
+    elif 2 <= version <= VERSION:
+        places = read_sectioned_places(data)
+    else:
+        raise ValueError(f"{path} is not a places.bin this script can read")
+    print(f"  Read {len(places)} places from {path} (v{version})")
+    return places
 
-    with open(output_path, "wb") as f:
-        # Header
-        header = struct.pack(
-            "<4sHI6s",
-            MAGIC,
-            VERSION,
-            len(places),
-            b"\x00" * 6,  # Reserved
-        )
-        f.write(header)
-
-        # Places
-        for place in places:
-            f.write(encode_place(place))
 
-    size_kb = output_path.stat().st_size / 1024
-    print(f"  Written {size_kb:.1f} KB ({len(places)} places)")
+def read_v1_places(data: bytes) -> list[dict]:
+    count = struct.unpack_from("<I", data, 6)[0]
+    places = []
+    for i in range(count):
+        rec = data[V1_HEADER_SIZE + i * V1_RECORD_SIZE:V1_HEADER_SIZE + (i + 1) * V1_RECORD_SIZE]
+        pid, lat_x100, lon_x100, name, country = struct.unpack("<16shh28s4s", rec)
+        places.append({
+            "id": pid.split(b"\x00")[0].decode(),
+            "geo": [lon_x100 / 100, lat_x100 / 100],
+            "title": name.split(b"\x00")[0].decode("utf-8", errors="replace"),
+            "country": country.split(b"\x00")[0].decode("utf-8", errors="replace"),
+        })
+    return places
+
+
+def read_sectioned_places(data: bytes) -> list[dict]:
+    """v2 and later: same sections, only the place order differs."""
+    _, _, section_count, count = struct.unpack_from("<4sHHI", data, 0)
+    sections = {}
+    for i in range(section_count):
+        tag, off, size = struct.unpack_from("<4sII", data, HEADER_SIZE + i * SECTION_ENTRY_SIZE)
+        sections[tag] = data[off:off + size]
+    strs = sections[b"STR "]
+
+    def string_at(off: int) -> str:
+        return strs[off:strs.index(b"\x00", off)].decode("utf-8", errors="replace")
+
+    ctry = struct.unpack(f"<{len(sections[b'CTRY']) // 4}I", sections[b"CTRY"])
+    counts = sections.get(b"SCNT")
+    places = []
+    for i in range(count):
+        lat_x100 = struct.unpack_from("<h", sections[b"LAT "], i * 2)[0]
+        lon_x100 = struct.unpack_from("<h", sections[b"LON "], i * 2)[0]
+        value = int.from_bytes(sections[b"PID "][i * ID_BYTES:(i + 1) * ID_BYTES], "big")
+        pid = "".join(BASE64URL[(value >> (6 * k)) & 0x3F] for k in reversed(range(ID_LEN)))
+        ref = struct.unpack_from("<I", sections[b"REF "], i * 4)[0]
+        places.append({
+            "id": pid,
+            "geo": [lon_x100 / 100, lat_x100 / 100],
+            "title": string_at(ref >> 8),
+            "country": string_at(ctry[ref & 0xFF]),
+        })
+        if counts:
+            places[-1]["size"] = counts[i]
+    return places
+
+
+def synthesize_places(places: list[dict], total: int, seed: int) -> list[dict]:
+    """places plus generated ones up to total, each near one of places."""
+    rng = random.Random(seed)
+    ids = {p["id"] for p in places}
+    counts = [p["size"] for p in places if isinstance(p.get("size"), int)]
+    out = list(places)
+    while len(out) < total:
+        near = rng.choice(places)
+        lon = near["geo"][0] + rng.gauss(0, SYNTH_SPREAD)
+        lat = max(-89.0, min(89.0, near["geo"][1] + rng.gauss(0, SYNTH_SPREAD)))
+        lon = (lon + 180) % 360 - 180
+        pid = "".join(rng.choice(BASE64URL) for _ in range(ID_LEN))
+        if pid in ids:
+            continue
+        ids.add(pid)
+        name = "".join(rng.choice(SYNTH_SYLLABLES) for _ in range(rng.randint(2, 4))).capitalize()
+        if rng.random() < 0.2:
+            name += " " + near["title"]
+        place = {
+            "id": pid,
+            "geo": [round(lon, 2), round(lat, 2)],
+            "title": name,
+            "country": near["country"],
+        }
+        if counts:
+            place["size"] = rng.choice(counts)
+        out.append(place)
+    print(f"  Synthetic: {total - len(places)} places added to {len(places)} (seed {seed})")
+    return out
 
 
 def write_header(places: list[dict], output_path: Path):
@@ -141,8 +606,65 @@ def write_header(places: list[dict], output_path: Path):
 #define PLACES_COUNT        {len(places)}
 #define PLACES_STRUCT_SIZE  {PLACE_STRUCT_SIZE}
 #define PLACES_HEADER_SIZE  {HEADER_SIZE}
+#define PLACES_SECTION_SIZE {SECTION_ENTRY_SIZE}
+#define PLACES_ID_BYTES     {ID_BYTES}
+#define PLACES_FOLD_FIRST   0x{FOLD_FIRST:04X}   // FOLD table range (name search)
+#define PLACES_FOLD_LAST    0x{FOLD_LAST:04X}
+#define PLACES_KEY_MAX      {KEY_MAX}       // Folded name bytes
+
+// File header (packed, {HEADER_SIZE} bytes), followed by section_count
+// PlacesSection entries
+typedef struct __attribute__((packed)) {{
+    char magic[4];          // "RGPL"
+    uint16_t version;
+    uint16_t section_count;
+    uint32_t count;         // Places
+    uint8_t cell_shift;     // CELL index cell = 2^cell_shift hundredths of a degree
+    uint8_t reserved[3];
+}} PlacesHeader;
+
+typedef struct __attribute__((packed)) {{
+    char tag[4];            // "LAT ", "LON ", "PID ", "REF ", "CTRY", "STR ", "CELL", "SCNT",
+                            // "FOLD", "NAME", "TRIX", "TRIP", "CPLC", "CBOX", "VIEW"
+    uint32_t offset;        // From the start of the file, 16-byte aligned
+    uint32_t size;
+}} PlacesSection;
+
+// CELL entry: first place of a non-empty index cell (Hilbert order)
+typedef struct __attribute__((packed)) {{
+    uint16_t cell;
+    uint16_t first;
+}} PlacesCell;
 
-// Place structure (packed, {PLACE_STRUCT_SIZE} bytes)
+// TRIX entry: postings of one trigram start at TRIP[first]
+typedef struct __attribute__((packed)) {{
+    uint32_t gram;          // b0 << 16 | b1 << 8 | b2
+    uint32_t first;
+}} PlacesGram;
+
+// CBOX entry: a country's run of CPLC and its bounding box (x100;
+// lon_min > lon_max when it crosses the antimeridian)
+typedef struct __attribute__((packed)) {{
+    uint16_t first;
+    uint16_t count;
+    int16_t lat_min;
+    int16_t lat_max;
+    int16_t lon_min;
+    int16_t lon_max;
+}} PlacesCountry;
+
+// VIEW header: each map slice cut into cols x rows equal tiles (tile of a
+// place: col = lon offset into the slice * cols / its span, row = (90 -
+// lat) * rows / 180), then a uint16 first entry per tile (slice, row,
+// col order) and a sentinel, then a uint16 place list in tile order
+typedef struct __attribute__((packed)) {{
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t slices;         // MAP_SLICE_COUNT of the map it was built for
+    uint8_t reserved;
+}} PlacesView;
+
+// Decoded place record (packed, {PLACE_STRUCT_SIZE} bytes)
 typedef struct __attribute__((packed)) {{
     char id[16];        // Radio.garden place ID
     int16_t lat_x100;   // Latitude * 100
@@ -152,6 +674,8 @@ typedef struct __attribute__((packed)) {{
 }} Place;
 
 // Verify struct packing
+static_assert(sizeof(PlacesHeader) == PLACES_HEADER_SIZE, "PlacesHeader size mismatch");
+static_assert(sizeof(PlacesSection) == PLACES_SECTION_SIZE, "PlacesSection size mismatch");
 static_assert(sizeof(Place) == PLACES_STRUCT_SIZE, "Place struct size mismatch");
 
 #endif // PLACES_INFO_H
@@ -186,6 +710,25 @@ def main():
         default=None,
         help="Directory for C header file (default: ../esp32/src)"
     )
+    parser.add_argument(
+        "--from-bin",
+        type=Path,
+        default=None,
+        help="Re-encode an existing places.bin instead of downloading"
+    )
+    parser.add_argument(
+        "--synthetic",
+        type=int,
+        default=None,
+        metavar="COUNT",
+        help=f"Pad the places to COUNT with generated ones (at most {MAX_PLACES})"
+    )
+    parser.add_argument(
+        "--seed",
+        type=int,
+        default=1,
+        help="Random seed for --synthetic (default: 1)"
+    )
     parser.add_argument(
         "--sample", "-s",
         type=int,
@@ -193,6 +736,8 @@ def main():
         help="Number of sample places to print (default: 5)"
     )
     args = parser.parse_args()
+    if args.synthetic is not None and not 0 < args.synthetic <= MAX_PLACES:
+        parser.error(f"--synthetic takes 1..{MAX_PLACES} places (16-bit handles)")
 
     # Set header dir default
     if args.header_dir is None:
@@ -202,12 +747,14 @@ def main():
     args.output_dir.mkdir(parents=True, exist_ok=True)
     args.header_dir.mkdir(parents=True, exist_ok=True)
 
-    # Fetch and process
-    places = fetch_places()
-    print_sample(places, args.sample)
+    # Fetch and process (read the old file first: it may be the output path)
+    places = read_binary(args.from_bin) if args.from_bin else fetch_places()
+    if args.synthetic is not None and args.synthetic > len(places):
+        places = synthesize_places(places, args.synthetic, args.seed)
 
     # Write outputs
-    write_binary(places, args.output_dir / "places.bin")
+    places = write_binary(places, args.output_dir / "places.bin")
+    print_sample(places, args.sample)
     write_header(places, args.header_dir / "places_info.h")
 
     print("\nDone! Next steps:")
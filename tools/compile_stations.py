@@ -0,0 +1,291 @@
+#!/usr/bin/env python3
+"""
+Compile an offline station catalogue for the ESP32 (stations.bin).
+
+Downloads the channels page of every place in places.bin and stores the
+station IDs and titles by place handle, so a tap on the device only needs
+the stream redirect and the LinkPlay call. The catalogue is optional: the
+device fetches any place it does not cover, and refetches lists it read
+from the catalogue in the background.
+
+Binary format (v3, little-endian):
+  Header (24 bytes):
+    - Magic: "RGST" (4 bytes)
+    - Version: uint16 (2)
+    - Reserved: uint16
+    - Place count: uint32 (must match places.bin)
+    - Places fingerprint: uint32, FNV-1a over the PID section of the
+      places.bin it was built for (the device ignores the file otherwise)
+    - Built at: uint32 Unix time of the oldest channels fetch it contains
+    - Station count: uint32
+
+  Index, one 6-byte entry per place handle:
+    - Offset: uint32 (from the start of the file)
+    - Length: uint16 (0 = not covered, e.g. its fetch failed)
+
+  Per place:
+    - Count: uint8 (at most 100, the device's list size)
+    - Per station, a packed record (station_pack.h on the device): uint8
+      title length << 1 (a one-byte varint; bit 0 clear, a base64url ID),
+      6-byte packed base64url ID (as in places.bin), UTF-8 title (at most
+      63 bytes, cut on a character)
+
+Blocks are not necessarily in place order. A rebuild over an existing
+stations.bin for the same places.bin keeps every block that still fits
+at its old offset and appends the others, so unchanged places keep their
+bytes and a delta update (make_update.py) carries only the places that
+changed. The file is laid out afresh with --compact, or once more than a
+quarter of it is unused.
+
+Fetching all ~12,500 places takes a while. Responses are kept in a JSON
+cache (--cache), so an interrupted run resumes where it stopped and
+--max-age decides which places are downloaded again.
+
+Usage:
+    python compile_stations.py [--places ../esp32/data/places.bin]
+                               [--output ../esp32/data/stations.bin]
+                               [--delay 0.2] [--limit N] [--offline] [--compact]
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+from pathlib import Path
+
+from compile_places import ID_LEN, MAGIC as PLACES_MAGIC, VERSION as PLACES_VERSION
+from compile_places import BASE64URL, pack_id, read_binary, utf8_prefix
+
+CHANNELS_URL = "https://radio.garden/api/ara/content/page/{}/channels"
+
+# Binary format constants
+MAGIC = b"RGST"
+VERSION = 3
+HEADER_SIZE = 24
+INDEX_ENTRY_SIZE = 6
+COMPACT_WASTE = 0.25     # Unused fraction that triggers a fresh layout
+MAX_STATIONS = 100       # MAX_CACHED_STATIONS in radio_client.cpp
+TITLE_MAX = 63           # StationRecord.title holds 63 bytes + NUL
+
+DATA_DIR = Path(__file__).parent.parent / "esp32" / "data"
+SAVE_EVERY = 100         # Places fetched between cache writes
+
+
+def fnv1a(data: bytes) -> int:
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def parse_channels(page: dict) -> list[list[str]]:
+    """[id, title] pairs from a channels page, as the device parses them."""
+    stations = []
+    for section in page.get("data", {}).get("content", []):
+        for item in section.get("items", []):
+            info = item.get("page", {})
+            title, url = info.get("title"), info.get("url")
+            if not title or not url or "/listen/" not in url:
+                continue
+            # URL is /listen/{slug}/{id}
+            parts = url.split("/listen/", 1)[1].split("/")
+            if len(parts) >= 2 and parts[0] and parts[1]:
+                stations.append([parts[1], title])
+    return stations
+
+
+def fetch_all(places: list[dict], cache: dict, cache_path: Path,
+              delay: float, max_age_s: float):
+    """Fill the cache with every place's stations (missing or stale only)."""
+    import requests  # Only needed when downloading
+
+    session = requests.Session()
+    session.headers.update({
+        "Accept": "application/json",
+        "User-Agent": "RadioWall/1.0"
+    })
+
+    now = time.time()
+    todo = [p for p in places
+            if p["id"] not in cache or now - cache[p["id"]]["fetched_at"] > max_age_s]
+    print(f"Fetching stations for {len(todo)} of {len(places)} places...")
+    failed = 0
+    for n, place in enumerate(todo, 1):
+        try:
+            resp = session.get(CHANNELS_URL.format(place["id"]), timeout=30)
+            resp.raise_for_status()
+            cache[place["id"]] = {
+                "fetched_at": int(time.time()),
+                "stations": parse_channels(resp.json()),
+            }
+        except (requests.RequestException, ValueError) as e:
+            failed += 1
+            print(f"  {place['title']}: {e}")
+        if n % SAVE_EVERY == 0 or n == len(todo):
+            cache_path.write_text(json.dumps(cache))
+            print(f"  {n}/{len(todo)} places ({failed} failed)")
+        time.sleep(delay)
+
+
+def valid_station_id(station_id: str) -> bool:
+    return len(station_id) == ID_LEN and all(c in BASE64URL for c in station_id)
+
+
+def encode_block(stations: list[list[str]]) -> bytes:
+    block = bytearray([len(stations)])
+    for station_id, title in stations:
+        name = utf8_prefix(title, TITLE_MAX)
+        block += bytes([len(name) << 1]) + pack_id(station_id) + name
+    return bytes(block)
+
+
+def read_layout(path: Path, place_count: int, fingerprint: int) -> list[tuple[int, int]] | None:
+    """(offset, length) per place of an existing stations.bin for the same places."""
+    if not path.exists():
+        return None
+    data = path.read_bytes()
+    if len(data) < HEADER_SIZE + place_count * INDEX_ENTRY_SIZE:
+        return None
+    magic, version, _, count, fp = struct.unpack_from("<4sHHII", data, 0)
+    if magic != MAGIC or version != VERSION or count != place_count or fp != fingerprint:
+        return None
+    return [struct.unpack_from("<IH", data, HEADER_SIZE + i * INDEX_ENTRY_SIZE)
+            for i in range(count)]
+
+
+def lay_out(blocks: list[bytes], base: list[tuple[int, int]] | None) -> list[int]:
+    """Offset per block: its old one if it still fits, else appended."""
+    offset = HEADER_SIZE + len(blocks) * INDEX_ENTRY_SIZE
+    if base is not None:
+        offset = max([offset] + [off + length for off, length in base if length])
+    offsets = []
+    for i, block in enumerate(blocks):
+        if base is not None and base[i][1] >= len(block) > 0:
+            offsets.append(base[i][0])
+        else:
+            offsets.append(offset)
+            offset += len(block)
+    return offsets
+
+
+def write_catalog(places: list[dict], fingerprint: int, cache: dict, output_path: Path,
+                  compact: bool):
+    """Write stations.bin for places (in handle order) from the cache."""
+    blocks = []
+    covered = skipped = total = 0
+    oldest = None
+    for place in places:
+        entry = cache.get(place["id"])
+        if entry is None:
+            blocks.append(b"")
+            continue
+        stations = [s for s in entry["stations"] if valid_station_id(s[0])]
+        skipped += len(entry["stations"]) - len(stations)
+        blocks.append(encode_block(stations[:MAX_STATIONS]))
+        covered += 1
+        total += min(len(stations), MAX_STATIONS)
+        oldest = entry["fetched_at"] if oldest is None else min(oldest, entry["fetched_at"])
+
+    base = None if compact else read_layout(output_path, len(places), fingerprint)
+    offsets = lay_out(blocks, base)
+    size = max([HEADER_SIZE + len(places) * INDEX_ENTRY_SIZE] +
+               [off + len(block) for off, block in zip(offsets, blocks)])
+    used = HEADER_SIZE + len(places) * INDEX_ENTRY_SIZE + sum(len(b) for b in blocks)
+    if base is not None and size - used > size * COMPACT_WASTE:
+        print(f"  {(size - used) / 1024:.1f} KB unused, laying the file out afresh")
+        offsets = lay_out(blocks, None)
+        size = used
+    kept = 0 if base is None else sum(
+        1 for i, off in enumerate(offsets) if blocks[i] and off == base[i][0])
+
+    image = bytearray(size)
+    struct.pack_into("<4sHHIIII", image, 0, MAGIC, VERSION, 0, len(places), fingerprint,
+                     oldest or int(time.time()), total)
+    for i, (off, block) in enumerate(zip(offsets, blocks)):
+        struct.pack_into("<IH", image, HEADER_SIZE + i * INDEX_ENTRY_SIZE,
+                         off if block else 0, len(block))
+        image[off:off + len(block)] = block
+    output_path.write_bytes(image)
+
+    print(f"  Written {size / 1024:.1f} KB ({total} stations, {covered} of "
+          f"{len(places)} places covered)")
+    if base is not None:
+        print(f"  {kept} places kept their offsets, {(size - used) / 1024:.1f} KB unused")
+    if skipped:
+        print(f"  Skipped {skipped} stations with IDs that are not {ID_LEN} base64url characters")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compile the offline station catalogue for ESP32"
+    )
+    parser.add_argument(
+        "--places",
+        type=Path,
+        default=DATA_DIR / "places.bin",
+        help="places.bin the catalogue is built for (default: ../esp32/data/places.bin)"
+    )
+    parser.add_argument(
+        "--output", "-o",
+        type=Path,
+        default=DATA_DIR / "stations.bin",
+        help="Output file (default: ../esp32/data/stations.bin)"
+    )
+    parser.add_argument(
+        "--cache",
+        type=Path,
+        default=Path(__file__).parent / "stations_cache.json",
+        help="Downloaded station lists, for resuming (default: tools/stations_cache.json)"
+    )
+    parser.add_argument(
+        "--delay",
+        type=float,
+        default=0.2,
+        help="Seconds between requests (default: 0.2)"
+    )
+    parser.add_argument(
+        "--max-age",
+        type=float,
+        default=7,
+        help="Download places cached longer ago than this many days (default: 7)"
+    )
+    parser.add_argument(
+        "--limit",
+        type=int,
+        default=None,
+        help="Only fetch the first N places (the rest stay uncovered unless cached)"
+    )
+    parser.add_argument(
+        "--offline",
+        action="store_true",
+        help="Build from the cache only, without downloading"
+    )
+    parser.add_argument(
+        "--compact",
+        action="store_true",
+        help="Lay the file out afresh instead of keeping blocks of the existing one"
+    )
+    args = parser.parse_args()
+
+    data = args.places.read_bytes()
+    if data[:4] != PLACES_MAGIC or struct.unpack_from("<H", data, 4)[0] != PLACES_VERSION:
+        print(f"{args.places} is not a v{PLACES_VERSION} places.bin; "
+              "run compile_places.py first", file=sys.stderr)
+        return 1
+    places = read_binary(args.places)
+    fingerprint = fnv1a(b"".join(pack_id(p["id"]) for p in places))
+
+    cache = json.loads(args.cache.read_text()) if args.cache.exists() else {}
+    if not args.offline:
+        fetch_all(places[:args.limit], cache, args.cache, args.delay, args.max_age * 86400)
+
+    write_catalog(places, fingerprint, cache, args.output, args.compact)
+
+    print("\nDone! Next step:")
+    print("  Upload stations.bin with places.bin to ESP32 LittleFS: pio run -t uploadfs")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""
+Build the ESP x509 certificate bundle RadioWall verifies TLS against.
+
+With -DTLS_VERIFY the firmware checks the first radio.garden session of
+each boot against this bundle (esp32/src/tls_trust.h) and embeds it with
+board_build.embed_files. The format is what ESP-IDF's esp_crt_bundle
+reads (gen_crt_bundle.py in IDF 4.4):
+
+  count          uint16 BE   number of certificates
+  per certificate, sorted by subject name DER:
+    name_len     uint16 BE
+    key_len      uint16 BE
+    name         subject name, DER
+    key          SubjectPublicKeyInfo, DER
+
+Only the subject and public key of each CA are kept, so a bundle of the
+whole Mozilla store is about 65 KB; --match keeps just the CAs whose
+subject contains one of the given strings (e.g. the few radio.garden's
+certificate chains up to), which is enough and much smaller.
+
+Requires cryptography (pip install cryptography). A CA file to start from:
+https://curl.se/ca/cacert.pem (Mozilla's store, in PEM).
+
+Usage:
+    python gen_cert_bundle.py cacert.pem [--match "ISRG Root" --match "GTS Root"]
+"""
+
+import argparse
+import struct
+import sys
+from pathlib import Path
+
+from cryptography import x509
+from cryptography.hazmat.primitives import serialization
+
+ROOT = Path(__file__).parent.parent
+DEFAULT_OUT = ROOT / "esp32" / "cert" / "x509_crt_bundle.bin"
+
+
+def load_certificates(paths):
+    certs = []
+    for path in paths:
+        data = path.read_bytes()
+        if b"-----BEGIN CERTIFICATE-----" in data:
+            certs.extend(x509.load_pem_x509_certificates(data))
+        else:
+            certs.append(x509.load_der_x509_certificate(data))
+    return certs
+
+
+def build_bundle(certs):
+    entries = []
+    for cert in certs:
+        name = cert.subject.public_bytes()
+        key = cert.public_key().public_bytes(serialization.Encoding.DER,
+                                             serialization.PublicFormat.SubjectPublicKeyInfo)
+        entries.append((name, key))
+    # esp_crt_bundle binary-searches by subject name
+    entries.sort(key=lambda e: e[0])
+
+    out = bytearray(struct.pack(">H", len(entries)))
+    for name, key in entries:
+        out += struct.pack(">HH", len(name), len(key)) + name + key
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the ESP x509 certificate bundle")
+    parser.add_argument("certs", type=Path, nargs="+", help="CA certificates (PEM or DER)")
+    parser.add_argument("--match", action="append", default=[],
+                        help="keep only CAs whose subject contains this (repeatable)")
+    parser.add_argument("--out", type=Path, default=DEFAULT_OUT, help=f"output (default {DEFAULT_OUT})")
+    args = parser.parse_args()
+
+    certs = load_certificates(args.certs)
+    if args.match:
+        certs = [c for c in certs if any(m in c.subject.rfc4514_string() for m in args.match)]
+    if not certs:
+        print("No certificates selected", file=sys.stderr)
+        return 1
+
+    # The same CA can appear twice in a store (cross-signed copies)
+    unique = {c.subject.public_bytes() + c.public_key().public_bytes(
+        serialization.Encoding.DER, serialization.PublicFormat.SubjectPublicKeyInfo): c for c in certs}
+    bundle = build_bundle(unique.values())
+
+    args.out.parent.mkdir(parents=True, exist_ok=True)
+    args.out.write_bytes(bundle)
+    for c in sorted(unique.values(), key=lambda c: c.subject.rfc4514_string()):
+        print(f"  {c.subject.rfc4514_string()}")
+    print(f"{len(unique)} CA(s), {len(bundle)} bytes -> {args.out}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
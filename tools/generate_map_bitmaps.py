@@ -4,30 +4,33 @@ Generate RLE-compressed world map bitmaps for RadioWall ESP32.
 
 Downloads Natural Earth data and renders:
   - 4 base (1x) map slices with country borders -> PROGMEM C header
-  - 16 zoomed (2x) sub-maps -> LittleFS binary file (110m data)
-  - 36 zoomed (3x) sub-maps -> LittleFS binary file (110m data)
-  - 64 zoomed (4x) sub-maps -> LittleFS binary file (50m data)
-  - 100 zoomed (5x) sub-maps -> LittleFS binary file (50m data)
+  - 16 zoomed (2x) sub-maps (110m data)
+  - 36 zoomed (3x) sub-maps (110m data)
+  - 64 zoomed (4x) sub-maps (50m data)
+  - 100 zoomed (5x) sub-maps (50m data)
+  The zoomed sub-maps go into one tile pyramid file (see pack_map_tiles.py).
+  With --vector, also simplified land polygons and border lines at three
+  levels of detail for the optional vector map (see pack_map_vectors.py).
 
-3-Color RLE format: 0=ocean (black), 1=land (white), 2=border (gray)
+3 colors: 0=ocean (black), 1=land (white), 2=border (gray)
 
 Output:
-  ../esp32/src/world_map_data.h   (1x PROGMEM arrays)
-  ../esp32/data/maps/zoom2.bin    (2x LittleFS binary)
-  ../esp32/data/maps/zoom3.bin    (3x LittleFS binary)
-  ../esp32/data/maps/zoom4.bin    (4x LittleFS binary)
-  ../esp32/data/maps/zoom5.bin    (5x LittleFS binary)
+  ../esp32/src/world_map_data.h   (1x PROGMEM arrays, byte-pair RLE)
+  ../esp32/src/map_layout.h       (slice bounds and tile grid, constexpr)
+  ../esp32/data/maps/tiles.bin    (2x-5x LittleFS tile pyramid)
+  ../esp32/data/maps/vector.bin   (vector map, --vector only)
 
 Usage:
-    python generate_map_bitmaps.py
+    python generate_map_bitmaps.py [--vector]
+    python generate_map_bitmaps.py --layout-only   (map_layout.h, no download)
 
 Requirements:
     pip install geopandas matplotlib numpy Pillow requests
 """
 
+import argparse
 import io
 import os
-import struct
 import sys
 import zipfile
 from pathlib import Path
@@ -39,6 +42,10 @@ import numpy as np
 import requests
 from PIL import Image
 
+from pack_map_tiles import (NUM_SLICES, TILE_H, TILE_W, ZOOM_MAX, ZOOM_MIN,
+                            build_pyramid, encode_runs)
+from pack_map_vectors import build_vector_map
+
 
 # Map dimensions (portrait: 180 wide x 580 tall - fills display above status bar)
 MAP_WIDTH = 180
@@ -53,7 +60,7 @@ LONGITUDE_SLICES = [
 ]
 
 # Zoom levels to generate (1x is always generated as PROGMEM)
-ZOOM_LEVELS = [2, 3, 4, 5]
+ZOOM_LEVELS = list(range(ZOOM_MIN, ZOOM_MAX + 1))
 
 # Natural Earth data URLs (public domain)
 # 1:110m for base maps and zoom 2-3 (coarse, small download)
@@ -66,10 +73,20 @@ NE_BORDERS_50M_URL = "https://naciscdn.org/naturalearth/50m/cultural/ne_50m_admi
 # Zoom levels that use 50m data (higher detail)
 HIGH_RES_ZOOM_THRESHOLD = 4
 
+# Vector map levels of detail: (min zoom, Natural Earth scale, simplify
+# tolerance in degrees). About half a pixel of the Pacific slice (60° wide,
+# the densest) at each LOD's highest zoom; 1:50m itself is ~0.02°.
+VECTOR_LODS = [
+    (2, "110m", 0.08),
+    (4, "50m", 0.04),
+    (6, "50m", 0.015),
+]
+
 # Output paths
 SCRIPT_DIR = Path(__file__).parent
 DATA_DIR = SCRIPT_DIR / "data"
 OUTPUT_HEADER = SCRIPT_DIR.parent / "esp32" / "src" / "world_map_data.h"
+OUTPUT_LAYOUT = SCRIPT_DIR.parent / "esp32" / "src" / "map_layout.h"
 OUTPUT_MAPS_DIR = SCRIPT_DIR.parent / "esp32" / "data" / "maps"
 
 
@@ -255,54 +272,95 @@ def generate_c_header(slice_data: List[dict]) -> str:
     return "\n".join(lines)
 
 
-def generate_zoom_binary(zoom_level: int, all_slice_bitmaps: List[List[List[bytes]]]) -> bytes:
-    """
-    Pack zoom sub-map bitmaps into a LittleFS binary file.
+def slice_span(slice_def: dict) -> float:
+    """Width of a slice in degrees (the Pacific one runs on past 180)."""
+    span = slice_def["lon_max"] - slice_def["lon_min"]
+    return span + 360.0 if span < 0 else span
 
-    File format:
-      Header (8 bytes): magic('Z','M'), version(1), zoom, slices(4), cols, rows, reserved(0)
-      Index (6 bytes per bitmap): offset(uint32), size(uint16) -- ordered slice->col->row
-      Data: concatenated RLE bytes
 
-    Args:
-        zoom_level: 2 or 3
-        all_slice_bitmaps: [slice_idx][col][row] -> RLE bytes
+def generate_layout_header() -> str:
+    """
+    Generate the map layout header: slice bounds and tile pyramid geometry.
 
-    Returns:
-        Complete binary file content
+    Both the firmware and tiles.bin come from these constants, so the
+    firmware takes them as compile-time values and checks the pyramid's
+    header against them at load. Tile offsets stay in the tiles.bin
+    index, which a data update replaces without a firmware build.
     """
-    num_slices = 4
-    cols = zoom_level
-    rows = zoom_level
-    num_bitmaps = num_slices * cols * rows
-
-    # Header
-    header = struct.pack("BBBBBBBB",
-                         ord('Z'), ord('M'),  # magic
-                         1,                     # version
-                         zoom_level,            # zoom
-                         num_slices,            # slices
-                         cols,                  # cols per slice
-                         rows,                  # rows per slice
-                         0)                     # reserved
-
-    index_size = num_bitmaps * 6  # 4 bytes offset + 2 bytes size per entry
-    data_start = len(header) + index_size
-
-    # Build data section and index
-    index_entries = []
-    data_chunks = []
-    current_offset = data_start
-
-    for slice_idx in range(num_slices):
-        for col in range(cols):
-            for row in range(rows):
-                rle_bytes = all_slice_bitmaps[slice_idx][col][row]
-                index_entries.append(struct.pack("<IH", current_offset, len(rle_bytes)))
-                data_chunks.append(rle_bytes)
-                current_offset += len(rle_bytes)
-
-    return header + b"".join(index_entries) + b"".join(data_chunks)
+    assert len(LONGITUDE_SLICES) == NUM_SLICES
+    assert MAP_WIDTH % TILE_W == 0 and MAP_HEIGHT % TILE_H == 0
+
+    def row(values):
+        return ", ".join(str(v) for v in values)
+
+    zooms = range(ZOOM_MAX + 1)
+    cols = [z * MAP_WIDTH // TILE_W if z >= ZOOM_MIN else 0 for z in zooms]
+    rows = [z * MAP_HEIGHT // TILE_H if z >= ZOOM_MIN else 0 for z in zooms]
+    first = []
+    n = 0
+    for z in zooms:
+        first.append(n)
+        n += NUM_SLICES * cols[z] * rows[z]
+
+    lines = [
+        "/**",
+        " * Map layout for RadioWall: longitude slices and tile pyramid geometry",
+        " *",
+        " * Auto-generated by generate_map_bitmaps.py",
+        " * Do not edit manually!",
+        " */",
+        "",
+        "#ifndef MAP_LAYOUT_H",
+        "#define MAP_LAYOUT_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        f"#define MAP_LAYOUT_WIDTH  {MAP_WIDTH}",
+        f"#define MAP_LAYOUT_HEIGHT {MAP_HEIGHT}",
+        "",
+        "// Longitude slices, west to east. At zoom z a slice is a",
+        "// (MAP_LAYOUT_WIDTH*z) x (MAP_LAYOUT_HEIGHT*z) equirectangular image",
+        "// from lon_min to lon_min + lon_span and from 90 to -90 latitude.",
+        f"#define MAP_SLICE_COUNT {NUM_SLICES}",
+        "",
+        "struct MapSliceLayout {",
+        "    const char* name;   // \"Americas\"",
+        "    const char* label;  // \"-150° to -30°\"",
+        "    int16_t lon_min;    // Western edge (degrees)",
+        "    int16_t lon_span;   // Width (degrees; the last slice runs on past 180)",
+        "};",
+        "",
+        "static constexpr MapSliceLayout MAP_SLICE_LAYOUT[MAP_SLICE_COUNT] = {",
+    ]
+    for s in LONGITUDE_SLICES:
+        label = f"{s['lon_min']:g}° to {s['lon_max']:g}°"
+        lines.append(f'    {{"{s["label"]}", "{label}", {s["lon_min"]:g}, {slice_span(s):g}}},')
+    lines += [
+        "};",
+        "",
+        "// Tile pyramid (tiles.bin, tools/pack_map_tiles.py)",
+        f"#define MAP_TILE_ZOOM_MIN {ZOOM_MIN}",
+        f"#define MAP_TILE_ZOOM_MAX {ZOOM_MAX}",
+        f"#define MAP_TILE_W {TILE_W}",
+        f"#define MAP_TILE_H {TILE_H}",
+        f"#define MAP_TILE_COUNT {n}",
+        "",
+        "// Grid columns and rows of a slice, and the number of its zoom level's",
+        "// first tile, by zoom level (0 below MAP_TILE_ZOOM_MIN)",
+        f"static constexpr uint8_t MAP_TILE_COLS[MAP_TILE_ZOOM_MAX + 1] = {{{row(cols)}}};",
+        f"static constexpr uint8_t MAP_TILE_ROWS[MAP_TILE_ZOOM_MAX + 1] = {{{row(rows)}}};",
+        f"static constexpr uint32_t MAP_TILE_FIRST[MAP_TILE_ZOOM_MAX + 1] = {{{row(first)}}};",
+        "",
+        "#endif // MAP_LAYOUT_H",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def write_layout_header():
+    with open(OUTPUT_LAYOUT, "w", encoding="utf-8") as f:
+        f.write(generate_layout_header())
+    print(f"[OK] Map layout: {OUTPUT_LAYOUT}")
 
 
 def get_sub_bounds(slice_def: dict, zoom: int, col: int, row: int):
@@ -331,7 +389,43 @@ def get_sub_bounds(slice_def: dict, zoom: int, col: int, row: int):
     return sub_lon_min, sub_lon_max, sub_lat_min, sub_lat_max
 
 
+def vector_shapes(countries: gpd.GeoDataFrame, borders: gpd.GeoDataFrame,
+                  tolerance: float) -> Tuple[list, list]:
+    """
+    Land rings and border lines for one vector LOD, as (lon, lat) sequences.
+
+    Countries are dissolved into one land union before simplifying, so
+    shared borders can't open slivers and every ring fills even-odd.
+    """
+    land = countries.unary_union.simplify(tolerance)
+    rings = []
+    for poly in getattr(land, "geoms", [land]):
+        rings.append(list(poly.exterior.coords))
+        rings.extend(list(hole.coords) for hole in poly.interiors)
+    lines = []
+    for geom in borders.geometry.simplify(tolerance):
+        lines.extend(list(line.coords) for line in getattr(geom, "geoms", [geom]))
+    return rings, lines
+
+
 def main():
+    parser = argparse.ArgumentParser(description="Generate RadioWall map bitmaps")
+    parser.add_argument(
+        "--vector",
+        action="store_true",
+        help="Also write the vector map (data/maps/vector.bin)"
+    )
+    parser.add_argument(
+        "--layout-only",
+        action="store_true",
+        help="Only write map_layout.h (after changing the slices or tile size)"
+    )
+    args = parser.parse_args()
+
+    if args.layout_only:
+        write_layout_header()
+        return
+
     print("=" * 62)
     print("   RadioWall Map Bitmap Generator")
     print("   (with country borders + zoom levels)")
@@ -398,11 +492,14 @@ def main():
     with open(OUTPUT_HEADER, "w") as f:
         f.write(header_content)
 
+    write_layout_header()
+
     total_1x = sum(s["compressed_size"] for s in slice_data)
     print(f"[OK] 1x total: {total_1x} bytes ({total_1x / 1024:.1f} KB)")
 
     # -- Zoom bitmaps (LittleFS) -----------------------------------
     OUTPUT_MAPS_DIR.mkdir(parents=True, exist_ok=True)
+    pyramid_tiles = {}  # (zoom, slice, col, row) -> pixel bytes
 
     for zoom in ZOOM_LEVELS:
         print()
@@ -416,13 +513,10 @@ def main():
         print(f"  {4 * zoom * zoom} sub-maps ({zoom}x{zoom} grid per slice)")
         print("-" * 50)
 
-        all_slice_bitmaps = []  # [slice][col][row] -> rle bytes
         total_bytes = 0
 
         for s_idx, slice_def in enumerate(LONGITUDE_SLICES):
-            slice_bitmaps = []
             for col in range(zoom):
-                col_bitmaps = []
                 for row in range(zoom):
                     sub_lon_min, sub_lon_max, sub_lat_min, sub_lat_max = \
                         get_sub_bounds(slice_def, zoom, col, row)
@@ -434,27 +528,41 @@ def main():
                     bitmap = render_region(z_countries, z_borders,
                                            sub_lon_min, sub_lon_max,
                                            sub_lat_min, sub_lat_max)
-                    rle = rle_compress(bitmap)
+                    pixels = bitmap.astype(np.uint8).tobytes()
+                    runs = encode_runs(pixels)
 
-                    # Convert RLE tuples to raw bytes
-                    rle_bytes = bytes()
-                    for count, color in rle:
-                        rle_bytes += bytes([count, color])
+                    total_bytes += len(runs)
+                    print(f" -> {len(runs)} bytes of runs")
 
-                    total_bytes += len(rle_bytes)
-                    print(f" -> {len(rle_bytes)} bytes")
+                    pyramid_tiles[(zoom, s_idx, col, row)] = pixels
 
-                    col_bitmaps.append(rle_bytes)
-                slice_bitmaps.append(col_bitmaps)
-            all_slice_bitmaps.append(slice_bitmaps)
+        print(f"\n[OK] {zoom}x: {total_bytes} bytes of runs ({total_bytes / 1024:.1f} KB)")
 
-        # Write binary file
-        bin_data = generate_zoom_binary(zoom, all_slice_bitmaps)
-        out_path = OUTPUT_MAPS_DIR / f"zoom{zoom}.bin"
-        with open(out_path, "wb") as f:
-            f.write(bin_data)
+    # Write the tile pyramid (runs + LZ4 stage)
+    bin_data = build_pyramid(pyramid_tiles)
+    out_path = OUTPUT_MAPS_DIR / "tiles.bin"
+    with open(out_path, "wb") as f:
+        f.write(bin_data)
+    print(f"\n[OK] Tile pyramid: {len(bin_data) / 1024:.1f} KB -> {out_path}")
 
-        print(f"\n[OK] {zoom}x: {len(bin_data)} bytes ({len(bin_data) / 1024:.1f} KB) -> {out_path}")
+    # -- Vector map (LittleFS, optional) ---------------------------
+    vector_data = None
+    if args.vector:
+        print()
+        print("-" * 50)
+        print("  Generating vector map")
+        print("-" * 50)
+        data = {"110m": (countries, borders), "50m": (countries_50m, borders_50m)}
+        lods = []
+        for min_zoom, scale, tolerance in VECTOR_LODS:
+            rings, lines = vector_shapes(*data[scale], tolerance)
+            print(f"  From {min_zoom}x ({scale}, {tolerance}°): {len(rings)} land rings "
+                  f"({sum(map(len, rings))} points), {len(lines)} border lines")
+            lods.append((min_zoom, rings, lines))
+        vector_data = build_vector_map(lods)
+        vector_path = OUTPUT_MAPS_DIR / "vector.bin"
+        vector_path.write_bytes(vector_data)
+        print(f"\n[OK] Vector map: {len(vector_data) / 1024:.1f} KB -> {vector_path}")
 
     # -- Summary ---------------------------------------------------
     print()
@@ -462,11 +570,9 @@ def main():
     print("  SUCCESS! All map bitmaps generated.")
     print()
     print(f"  1x PROGMEM: {total_1x / 1024:6.1f} KB  (world_map_data.h)")
-    for zoom in ZOOM_LEVELS:
-        p = OUTPUT_MAPS_DIR / f"zoom{zoom}.bin"
-        if p.exists():
-            sz = p.stat().st_size
-            print(f"  {zoom}x LittleFS: {sz / 1024:5.1f} KB  (data/maps/zoom{zoom}.bin)")
+    print(f"  2x-5x LittleFS: {len(bin_data) / 1024:5.1f} KB  (data/maps/tiles.bin)")
+    if vector_data is not None:
+        print(f"  Vector map:     {len(vector_data) / 1024:5.1f} KB  (data/maps/vector.bin)")
     print()
     print("  Next steps:")
     print("    pio run                  (rebuild firmware)")
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Publish places.bin, stations.bin, the map tiles and the firmware as a
+delta update channel.
+
+Splits each file into fixed 4 KB chunks (one flash sector) named by their
+content hash and writes a manifest listing the hashes in order. Devices
+hash their own copies the same way and download only the chunks that
+differ, so a refreshed catalogue costs a few requests instead of an
+uploadfs. Host the output directory on any HTTPS server and set
+DATA_UPDATE_HOST / DATA_UPDATE_PATH in config.h.
+
+Output layout:
+  manifest.json
+    {"version": 1760000000, "chunk_size": 4096,
+     "files": [{"name": "places.bin", "size": 322052,
+                "sha256": "<64 hex>", "chunks": "<16 hex per chunk>"}]}
+  chunks/<16 hex>     chunk contents (the last chunk of a file may be short)
+
+A chunk's name is the first 8 bytes of its SHA-256. Chunks are never
+rewritten, so a device halfway through an older manifest still finds what
+it needs; --prune drops chunks no current file uses.
+
+tiles.bin updates only devices that have it in their "maps" partition.
+firmware.bin (the PlatformIO build output) is streamed into the device's
+idle app slot; chunks the running image has at the same offset are copied
+from its flash instead of downloaded.
+
+Usage:
+    python make_update.py [--output-dir update] [--prune] [FILE ...]
+"""
+
+import argparse
+import hashlib
+import json
+import sys
+import time
+from pathlib import Path
+
+CHUNK_SIZE = 4096        # Flash sector; the device patches whole chunks
+MAX_CHUNKS = 1024        # Per file on the device (4 MB)
+DATA_DIR = Path(__file__).parent.parent / "esp32" / "data"
+BUILD_DIR = Path(__file__).parent.parent / "esp32" / ".pio" / "build" / "t-display-s3-long"
+DEFAULT_FILES = [DATA_DIR / "places.bin", DATA_DIR / "stations.bin",
+                 DATA_DIR / "maps" / "tiles.bin", BUILD_DIR / "firmware.bin"]
+# The device ignores other names; sizes are where each one goes
+KNOWN_FILES = {
+    "places.bin": MAX_CHUNKS * CHUNK_SIZE,
+    "stations.bin": MAX_CHUNKS * CHUNK_SIZE,
+    "tiles.bin": 0x200000,       # "maps" partition
+    "firmware.bin": 0x300000,    # One app slot
+}
+
+
+def chunk_name(data: bytes) -> str:
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def publish_file(path: Path, chunk_dir: Path) -> tuple[dict, int]:
+    """Manifest entry for a file; writes its chunks. Returns (entry, new chunks)."""
+    data = path.read_bytes()
+    names = []
+    written = 0
+    for off in range(0, len(data), CHUNK_SIZE):
+        chunk = data[off:off + CHUNK_SIZE]
+        name = chunk_name(chunk)
+        names.append(name)
+        target = chunk_dir / name
+        if not target.exists():
+            target.write_bytes(chunk)
+            written += 1
+    entry = {
+        "name": path.name,
+        "size": len(data),
+        "sha256": hashlib.sha256(data).hexdigest(),
+        "chunks": "".join(names),
+    }
+    return entry, written
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Publish data files, map tiles and firmware as delta update chunks"
+    )
+    parser.add_argument(
+        "files",
+        nargs="*",
+        type=Path,
+        help="Files to publish (default: places.bin, stations.bin, maps/tiles.bin and the "
+             "firmware build, those present)"
+    )
+    parser.add_argument(
+        "--output-dir", "-o",
+        type=Path,
+        default=Path(__file__).parent / "update",
+        help="Output directory (default: tools/update)"
+    )
+    parser.add_argument(
+        "--version",
+        type=int,
+        default=None,
+        help="Manifest version (default: current Unix time)"
+    )
+    parser.add_argument(
+        "--prune",
+        action="store_true",
+        help="Delete chunks the new manifest does not reference"
+    )
+    args = parser.parse_args()
+
+    files = args.files or [p for p in DEFAULT_FILES if p.exists()]
+    for path in files:
+        if path.name not in KNOWN_FILES:
+            print(f"{path.name}: devices only update {', '.join(sorted(KNOWN_FILES))}",
+                  file=sys.stderr)
+            return 1
+        limit = KNOWN_FILES[path.name]
+        if path.stat().st_size > limit:
+            print(f"{path.name}: larger than the {limit >> 20} MB a device accepts",
+                  file=sys.stderr)
+            return 1
+
+    chunk_dir = args.output_dir / "chunks"
+    chunk_dir.mkdir(parents=True, exist_ok=True)
+
+    manifest = {
+        "version": args.version if args.version is not None else int(time.time()),
+        "chunk_size": CHUNK_SIZE,
+        "files": [],
+    }
+    used = set()
+    for path in files:
+        entry, written = publish_file(path, chunk_dir)
+        manifest["files"].append(entry)
+        chunks = entry["chunks"]
+        used.update(chunks[i:i + 16] for i in range(0, len(chunks), 16))
+        print(f"  {entry['name']}: {entry['size'] / 1024:.1f} KB, {len(chunks) // 16} chunks "
+              f"({written} new)")
+
+    # Manifest last: chunks it names must already be reachable
+    (args.output_dir / "manifest.json").write_text(json.dumps(manifest, indent=1))
+    print(f"  Manifest version {manifest['version']} -> {args.output_dir / 'manifest.json'}")
+
+    if args.prune:
+        stale = [p for p in chunk_dir.iterdir() if p.name not in used]
+        for p in stale:
+            p.unlink()
+        print(f"  Pruned {len(stale)} unused chunks")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,362 @@
+#!/usr/bin/env python3
+"""
+Pack zoom map tiles into the tile pyramid container (tiles.bin).
+
+At zoom z a slice is a (180*z) x (580*z) pixel image. The pyramid cuts
+every such image (2x-5x) into fixed 90x145 tiles and stores them in one
+file behind one flat index, so the device keeps one index and one open
+handle for all zoom levels and composes any 180x580 viewport from the at
+most 3 x 5 tiles it overlaps. generate_map_bitmaps.py writes it after
+rendering; run this script on its own to repack an existing tiles.bin
+(v1 or v2) after a format change, without rendering again.
+
+Binary format (v2, little-endian):
+  Header (20 bytes):
+    - Magic: "RGTP" (4 bytes)
+    - Version: uint8 (2)
+    - Codec: uint8 (0 = runs only, 1 = runs + LZ4 block stage)
+    - Zoom min, zoom max: uint8 each (2, 5)
+    - Slices: uint8 (4)
+    - Reserved: uint8
+    - Tile width, tile height: uint16 each (90, 145; divide 180 and 580)
+    - Reserved: uint16
+    - Tile count: uint32
+
+  Index, one 8-byte entry per tile:
+    - Offset: uint32 (from the start of the file)
+    - Stored size: uint16 (bytes in the file)
+    - Run size: uint16 (bytes of run tokens; equal to the stored size if
+      the tile is stored without the LZ4 stage, e.g. it would not shrink)
+
+    With cols(z) = z * 180 / tile width and rows(z) = z * 580 / tile height:
+    Tile number = slices * sum(cols(k) * rows(k) for k in zoom min..zoom-1)
+                  + (slice * cols(zoom) + col) * rows(zoom) + row
+
+  Run tokens (each tile row-major, rows top to bottom):
+    - LEB128 varint v: colour = v & 3 (0 ocean, 1 land, 2 border),
+      run length = (v >> 2) + 1
+    - Runs are maximal, so an all-ocean tile costs 3 bytes; pixels past
+      the last run are ocean
+
+  LZ4 stage: the token bytes as one LZ4 block (no frame), which the row
+  to row repetition of coastlines and borders compresses well.
+
+Usage:
+    python pack_map_tiles.py [--maps-dir ../esp32/data/maps] [--no-lz4]
+
+v1 (16-byte header, one 180x580 tile per zoom grid cell) is read for
+repacking only.
+"""
+
+import argparse
+import re
+import struct
+import sys
+from pathlib import Path
+
+MAP_WIDTH = 180
+MAP_HEIGHT = 580
+
+MAGIC = b"RGTP"
+VERSION = 2
+HEADER_SIZE = 20
+INDEX_ENTRY_SIZE = 8
+CODEC_RUNS = 0
+CODEC_LZ4 = 1
+NUM_SLICES = 4
+ZOOM_MIN = 2
+ZOOM_MAX = 5
+TILE_W = 90
+TILE_H = 145
+MAX_TILE_BYTES = 0xFFFF   # uint16 sizes in the index
+
+LZ4_MIN_MATCH = 4
+LZ4_LAST_LITERALS = 5     # LZ4 block rules: the last 5 bytes are literals,
+LZ4_MATCH_LIMIT = 12      # and no match starts in the last 12
+LZ4_MAX_OFFSET = 0xFFFF
+LZ4_CHAIN_DEPTH = 64
+
+MAPS_DIR = Path(__file__).parent.parent / "esp32" / "data" / "maps"
+
+RUN_RE = re.compile(rb"(.)\1*", re.S)
+
+
+def grid(zoom: int, tile_w: int = TILE_W, tile_h: int = TILE_H) -> tuple[int, int]:
+    """Tile columns and rows per slice at a zoom level."""
+    return zoom * MAP_WIDTH // tile_w, zoom * MAP_HEIGHT // tile_h
+
+
+def tile_number(zoom: int, slice_idx: int, col: int, row: int,
+                tile_w: int = TILE_W, tile_h: int = TILE_H) -> int:
+    base = NUM_SLICES * sum(c * r for c, r in
+                            (grid(k, tile_w, tile_h) for k in range(ZOOM_MIN, zoom)))
+    cols, rows = grid(zoom, tile_w, tile_h)
+    return base + (slice_idx * cols + col) * rows + row
+
+
+def cut_tile(submaps: dict, zoom: int, slice_idx: int, col: int, row: int) -> bytes:
+    """Pixels of one pyramid tile, cut from the 180x580 sub-maps covering it."""
+    x0, y0 = col * TILE_W, row * TILE_H
+    out = bytearray()
+    for y in range(y0, y0 + TILE_H):
+        sub_row, sy = divmod(y, MAP_HEIGHT)
+        sub_col, sx = divmod(x0, MAP_WIDTH)   # TILE_W divides MAP_WIDTH
+        start = sy * MAP_WIDTH + sx
+        out += submaps[(zoom, slice_idx, sub_col, sub_row)][start:start + TILE_W]
+    return bytes(out)
+
+
+def encode_runs(pixels: bytes) -> bytes:
+    """Varint run tokens for a bitmap's pixels (colours 0-2, row-major)."""
+    out = bytearray()
+    for run in RUN_RE.finditer(pixels):
+        v = (run.end() - run.start() - 1) << 2 | pixels[run.start()]
+        while v >= 0x80:
+            out.append(v & 0x7F | 0x80)
+            v >>= 7
+        out.append(v)
+    return bytes(out)
+
+
+def decode_runs(tokens: bytes) -> bytes:
+    """Inverse of encode_runs for a 180x580 bitmap (for verification)."""
+    return decode_runs_sized(tokens, MAP_WIDTH * MAP_HEIGHT)
+
+
+def decode_runs_sized(tokens: bytes, pixels: int) -> bytes:
+    """Inverse of encode_runs for a tile of the given pixel count."""
+    flat = bytearray(pixels)
+    pos = 0
+    i = 0
+    while i < len(tokens) and pos < len(flat):
+        v = shift = 0
+        while True:
+            b = tokens[i]
+            i += 1
+            v |= (b & 0x7F) << shift
+            shift += 7
+            if b < 0x80:
+                break
+        length = (v >> 2) + 1
+        flat[pos:pos + length] = bytes([v & 3]) * length
+        pos += length
+    return bytes(flat[:pixels])
+
+
+def _lz4_length(n: int) -> bytes:
+    """Extra length bytes after a nibble of 15."""
+    out = bytearray()
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+    return bytes(out)
+
+
+def lz4_compress(data: bytes) -> bytes:
+    """One LZ4 block (hash chains, greedy). Readable by any LZ4 block decoder."""
+    n = len(data)
+    out = bytearray()
+    head = {}
+    prev = [-1] * n
+    anchor = 0
+    pos = 0
+    limit = n - LZ4_MATCH_LIMIT
+
+    def insert(p):
+        key = data[p:p + LZ4_MIN_MATCH]
+        prev[p] = head.get(key, -1)
+        head[key] = p
+
+    while pos < limit:
+        best_len = best_off = 0
+        cand = head.get(data[pos:pos + LZ4_MIN_MATCH], -1)
+        depth = 0
+        max_len = n - LZ4_LAST_LITERALS - pos
+        while cand >= 0 and pos - cand <= LZ4_MAX_OFFSET and depth < LZ4_CHAIN_DEPTH:
+            length = 0
+            while length < max_len and data[cand + length] == data[pos + length]:
+                length += 1
+            if length > best_len:
+                best_len, best_off = length, pos - cand
+            cand = prev[cand]
+            depth += 1
+
+        if best_len < LZ4_MIN_MATCH:
+            insert(pos)
+            pos += 1
+            continue
+
+        literals = data[anchor:pos]
+        lit_nib = min(len(literals), 15)
+        match_extra = best_len - LZ4_MIN_MATCH
+        out.append(lit_nib << 4 | min(match_extra, 15))
+        if lit_nib == 15:
+            out += _lz4_length(len(literals) - 15)
+        out += literals
+        out += struct.pack("<H", best_off)
+        if match_extra >= 15:
+            out += _lz4_length(match_extra - 15)
+
+        for p in range(pos, min(pos + best_len, limit)):
+            insert(p)
+        pos += best_len
+        anchor = pos
+
+    literals = data[anchor:]
+    lit_nib = min(len(literals), 15)
+    out.append(lit_nib << 4)
+    if lit_nib == 15:
+        out += _lz4_length(len(literals) - 15)
+    out += literals
+    return bytes(out)
+
+
+def lz4_decompress(block: bytes, size: int) -> bytes:
+    """Inverse of lz4_compress (for verification)."""
+    out = bytearray()
+    i = 0
+    while i < len(block):
+        token = block[i]
+        i += 1
+        length = token >> 4
+        if length == 15:
+            while True:
+                b = block[i]
+                i += 1
+                length += b
+                if b != 255:
+                    break
+        out += block[i:i + length]
+        i += length
+        if i >= len(block):
+            break
+        offset = block[i] | block[i + 1] << 8
+        i += 2
+        length = (token & 15) + LZ4_MIN_MATCH
+        if token & 15 == 15:
+            while True:
+                b = block[i]
+                i += 1
+                length += b
+                if b != 255:
+                    break
+        for _ in range(length):
+            out.append(out[-offset])
+    assert len(out) == size
+    return bytes(out)
+
+
+def build_pyramid(submaps: dict, use_lz4: bool = True) -> bytes:
+    """
+    tiles.bin contents from {(zoom, slice, col, row): pixels}, the 180x580
+    sub-maps of zoom levels ZOOM_MIN..ZOOM_MAX on their zoom x zoom grid
+    (pixels as for encode_runs).
+    """
+    count = tile_number(ZOOM_MAX + 1, 0, 0, 0)
+    entries = []
+    payloads = []
+    for zoom in range(ZOOM_MIN, ZOOM_MAX + 1):
+        cols, rows = grid(zoom)
+        for s in range(NUM_SLICES):
+            for col in range(cols):
+                for row in range(rows):
+                    tokens = encode_runs(cut_tile(submaps, zoom, s, col, row))
+                    if len(tokens) > MAX_TILE_BYTES:
+                        raise ValueError(f"zoom {zoom} tile {s}/{col}/{row}: "
+                                         f"{len(tokens)} bytes of runs")
+                    stored = tokens
+                    if use_lz4:
+                        packed = lz4_compress(tokens)
+                        assert lz4_decompress(packed, len(tokens)) == tokens
+                        if len(packed) < len(tokens):
+                            stored = packed
+                    payloads.append(stored)
+                    entries.append((len(stored), len(tokens)))
+    assert len(entries) == count
+
+    header = struct.pack("<4sBBBBBxHHxxI", MAGIC, VERSION,
+                         CODEC_LZ4 if use_lz4 else CODEC_RUNS,
+                         ZOOM_MIN, ZOOM_MAX, NUM_SLICES, TILE_W, TILE_H, count)
+    offset = HEADER_SIZE + count * INDEX_ENTRY_SIZE
+    index = bytearray()
+    for (stored, raw), payload in zip(entries, payloads):
+        index += struct.pack("<IHH", offset, stored, raw)
+        offset += len(payload)
+    return header + bytes(index) + b"".join(payloads)
+
+
+def read_pyramid(path: Path) -> dict:
+    """The 180x580 sub-maps of an existing tiles.bin (v1 or v2), for repacking."""
+    data = path.read_bytes()
+    if data[:4] != MAGIC or data[4] not in (1, VERSION):
+        raise ValueError(f"{path}: not a v1/v2 tiles.bin")
+    if data[4] == 1:
+        zoom_min, zoom_max, slices = data[6], data[7], data[8]
+        tile_w, tile_h, header_size = MAP_WIDTH, MAP_HEIGHT, 16
+    else:
+        zoom_min, zoom_max, slices = data[6], data[7], data[8]
+        tile_w, tile_h = struct.unpack_from("<HH", data, 10)
+        header_size = HEADER_SIZE
+    if (zoom_min, zoom_max, slices) != (ZOOM_MIN, ZOOM_MAX, NUM_SLICES):
+        raise ValueError(f"{path}: zoom {zoom_min}-{zoom_max} x {slices} slices")
+
+    submaps = {}
+    n = 0
+    for zoom in range(zoom_min, zoom_max + 1):
+        cols, rows = grid(zoom, tile_w, tile_h)
+        images = [[bytearray(MAP_WIDTH * MAP_HEIGHT) for _ in range(zoom * zoom)]
+                  for _ in range(slices)]
+        for s in range(slices):
+            for col in range(cols):
+                for row in range(rows):
+                    offset, stored, raw = struct.unpack_from(
+                        "<IHH", data, header_size + n * INDEX_ENTRY_SIZE)
+                    n += 1
+                    tokens = data[offset:offset + stored]
+                    if stored != raw:
+                        tokens = lz4_decompress(tokens, raw)
+                    pixels = decode_runs_sized(tokens, tile_w * tile_h)
+                    for y in range(tile_h):
+                        gy, gx = row * tile_h + y, col * tile_w
+                        sub = images[s][(gx // MAP_WIDTH) * zoom + gy // MAP_HEIGHT]
+                        start = (gy % MAP_HEIGHT) * MAP_WIDTH + gx % MAP_WIDTH
+                        sub[start:start + tile_w] = pixels[y * tile_w:(y + 1) * tile_w]
+        for s in range(slices):
+            for i, sub in enumerate(images[s]):
+                submaps[(zoom, s, i // zoom, i % zoom)] = bytes(sub)
+    return submaps
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Repack tiles.bin into the current tile pyramid format"
+    )
+    parser.add_argument(
+        "--maps-dir",
+        type=Path,
+        default=MAPS_DIR,
+        help="Directory with tiles.bin, rewritten in place (default: ../esp32/data/maps)"
+    )
+    parser.add_argument(
+        "--no-lz4",
+        action="store_true",
+        help="Store run tokens only (codec 0)"
+    )
+    args = parser.parse_args()
+
+    path = args.maps_dir / "tiles.bin"
+    if not path.exists():
+        print(f"{path} not found; run generate_map_bitmaps.py", file=sys.stderr)
+        return 1
+    before = path.stat().st_size
+    data = build_pyramid(read_pyramid(path), not args.no_lz4)
+    path.write_bytes(data)
+    count = struct.unpack_from("<I", data, 16)[0]
+    print(f"  {count} tiles of {TILE_W}x{TILE_H}: {before / 1024:.1f} KB -> "
+          f"{len(data) / 1024:.1f} KB ({path})")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+Pack simplified land polygons and border lines into the vector map (vector.bin).
+
+The optional vector map replaces the zoom tile pyramid for zoomed views: the
+device rasterizes each view from it with a scanline filler, so one file of
+fixed size serves every zoom level. It holds a few levels of detail (LODs),
+each simplified for the zoom levels from its min zoom up to the next LOD's.
+generate_map_bitmaps.py --vector writes it; run this script on its own to
+print what an existing vector.bin holds.
+
+Binary format (v1, little-endian):
+  Header (16 bytes):
+    - Magic: "RGVM" (4 bytes)
+    - Version: uint8 (1)
+    - LOD count: uint8 (at most 8)
+    - Reserved: uint16
+    - Shape count: uint32 (all LODs)
+    - Reserved: uint32
+
+  LODs, one 12-byte entry each, by ascending min zoom:
+    - Min zoom: uint8 (the device uses the last LOD whose min zoom <= zoom)
+    - Reserved: 3 bytes
+    - First shape: uint32
+    - Shape count: uint32
+
+  Shapes, one 16-byte entry each (land rings of a LOD before its lines):
+    - Box: uint16 x_min, y_min, x_max, y_max
+    - Offset: uint32 (first point, from the start of the file)
+    - Point count: uint16 (at least 2)
+    - Kind: uint8 (0 = land ring, closed implicitly, filled even-odd;
+      1 = border line)
+    - Reserved: uint8
+
+  Points: uint16 x, uint16 y of the first point, then per point a zigzag
+  LEB128 varint dx and dy. x = (lon + 180) / 360 * 65535 and
+  y = (90 - lat) / 180 * 65535, rounded; consecutive duplicates are dropped.
+
+Land rings are the exteriors and holes of the dissolved land polygons (one
+union of all countries), so even-odd filling across every ring of a LOD is
+exact and neighbouring countries leave no slivers.
+
+Usage:
+    python pack_map_vectors.py [--maps-dir ../esp32/data/maps]
+"""
+
+import argparse
+import struct
+import sys
+from pathlib import Path
+
+MAGIC = b"RGVM"
+VERSION = 1
+HEADER_SIZE = 16
+LOD_ENTRY_SIZE = 12
+SHAPE_ENTRY_SIZE = 16
+MAX_LODS = 8
+MAX_POINTS = 0xFFFF      # uint16 point counts
+UNITS = 65535
+KIND_LAND = 0
+KIND_BORDER = 1
+
+MAPS_DIR = Path(__file__).parent.parent / "esp32" / "data" / "maps"
+
+
+def quantize(lon: float, lat: float) -> tuple[int, int]:
+    x = round((lon + 180.0) / 360.0 * UNITS)
+    y = round((90.0 - lat) / 180.0 * UNITS)
+    return min(max(x, 0), UNITS), min(max(y, 0), UNITS)
+
+
+def _varint(v: int) -> bytes:
+    u = (v << 1) ^ (v >> 31)   # Zigzag (32-bit)
+    u &= 0xFFFFFFFF
+    out = bytearray()
+    while u >= 0x80:
+        out.append((u & 0x7F) | 0x80)
+        u >>= 7
+    out.append(u)
+    return bytes(out)
+
+
+def quantize_shape(coords, closed: bool) -> list[tuple[int, int]] | None:
+    """Quantized points without consecutive duplicates, None if degenerate."""
+    points = []
+    for lon, lat in coords:
+        p = quantize(lon, lat)
+        if not points or points[-1] != p:
+            points.append(p)
+    if closed and len(points) > 1 and points[0] == points[-1]:
+        points.pop()   # Rings close implicitly
+    if len(points) < (3 if closed else 2):
+        return None
+    if len(points) > MAX_POINTS:
+        raise ValueError(f"shape has {len(points)} points, more than {MAX_POINTS}; "
+                         "simplify it further")
+    return points
+
+
+def encode_points(points: list[tuple[int, int]]) -> bytes:
+    out = bytearray(struct.pack("<HH", *points[0]))
+    for (x0, y0), (x1, y1) in zip(points, points[1:]):
+        out += _varint(x1 - x0) + _varint(y1 - y0)
+    return bytes(out)
+
+
+def build_vector_map(lods: list[tuple[int, list, list]]) -> bytes:
+    """
+    vector.bin contents from [(min zoom, rings, lines)] in ascending min
+    zoom, with rings and lines as lists of (lon, lat) sequences.
+    """
+    if not 0 < len(lods) <= MAX_LODS:
+        raise ValueError(f"1 to {MAX_LODS} LODs")
+    shapes = []        # (kind, points) in file order
+    lod_entries = []
+    for min_zoom, rings, lines in lods:
+        first = len(shapes)
+        for kind, group, closed in ((KIND_LAND, rings, True), (KIND_BORDER, lines, False)):
+            for coords in group:
+                points = quantize_shape(coords, closed)
+                if points:
+                    shapes.append((kind, points))
+        lod_entries.append((min_zoom, first, len(shapes) - first))
+
+    offset = HEADER_SIZE + len(lods) * LOD_ENTRY_SIZE + len(shapes) * SHAPE_ENTRY_SIZE
+    table = bytearray()
+    payload = bytearray()
+    for kind, points in shapes:
+        xs = [p[0] for p in points]
+        ys = [p[1] for p in points]
+        table += struct.pack("<HHHHIHBx", min(xs), min(ys), max(xs), max(ys),
+                             offset + len(payload), len(points), kind)
+        payload += encode_points(points)
+
+    header = struct.pack("<4sBBHII", MAGIC, VERSION, len(lods), 0, len(shapes), 0)
+    lod_table = b"".join(struct.pack("<B3xII", *entry) for entry in lod_entries)
+    return header + lod_table + bytes(table) + bytes(payload)
+
+
+def read_vector_map(path: Path) -> list[dict]:
+    """Per LOD: min zoom and its shapes as (kind, quantized points)."""
+    data = path.read_bytes()
+    magic, version, lod_count, _, shape_count, _ = struct.unpack_from("<4sBBHII", data, 0)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(f"{path} is not a v{VERSION} vector map")
+    shapes_at = HEADER_SIZE + lod_count * LOD_ENTRY_SIZE
+    lods = []
+    for i in range(lod_count):
+        min_zoom, first, count = struct.unpack_from("<B3xII", data, HEADER_SIZE + i * LOD_ENTRY_SIZE)
+        shapes = []
+        for n in range(first, first + count):
+            *_, offset, npoints, kind = struct.unpack_from(
+                "<HHHHIHBx", data, shapes_at + n * SHAPE_ENTRY_SIZE)
+            x, y = struct.unpack_from("<HH", data, offset)
+            pos = offset + 4
+            points = [(x, y)]
+            for _ in range(npoints - 1):
+                deltas = []
+                for _ in range(2):
+                    u = shift = 0
+                    while True:
+                        b = data[pos]
+                        pos += 1
+                        u |= (b & 0x7F) << shift
+                        shift += 7
+                        if b < 0x80:
+                            break
+                    deltas.append((u >> 1) ^ -(u & 1))
+                x += deltas[0]
+                y += deltas[1]
+                points.append((x, y))
+            shapes.append((kind, points))
+        lods.append({"min_zoom": min_zoom, "shapes": shapes})
+    if sum(len(l["shapes"]) for l in lods) != shape_count:
+        raise ValueError(f"{path}: LODs do not cover the {shape_count} shapes")
+    return lods
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Show the contents of vector.bin")
+    parser.add_argument(
+        "--maps-dir",
+        type=Path,
+        default=MAPS_DIR,
+        help="Directory holding vector.bin (default: ../esp32/data/maps)"
+    )
+    args = parser.parse_args()
+
+    path = args.maps_dir / "vector.bin"
+    if not path.exists():
+        print(f"No {path}; run generate_map_bitmaps.py --vector first", file=sys.stderr)
+        return 1
+    lods = read_vector_map(path)
+    print(f"{path}: {path.stat().st_size / 1024:.1f} KB, {len(lods)} LODs")
+    for lod in lods:
+        rings = [p for kind, p in lod["shapes"] if kind == KIND_LAND]
+        lines = [p for kind, p in lod["shapes"] if kind == KIND_BORDER]
+        print(f"  from {lod['min_zoom']}x: {len(rings)} land rings "
+              f"({sum(map(len, rings))} points), {len(lines)} border lines "
+              f"({sum(map(len, lines))} points)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,358 @@
+#!/usr/bin/env python3
+"""
+Build a subset of the u8g2 CJK font with only the glyphs RadioWall shows.
+
+The firmware prints station titles and place names with
+u8g2_font_cubic11_h_cjk (10,167 glyphs, 330 KB). This tool keeps the
+codepoints that can actually appear:
+  - every character of the place names in places.bin
+  - a built-in set of scripts seen in station titles (Latin, Greek,
+    Cyrillic, punctuation, kana, fullwidth forms)
+  - every character of the given title files (default:
+    station_title_chars.txt; favorites/history JSON dumps work too)
+
+and writes them as a normal u8g2 font plus a direct glyph index, so the
+firmware finds a glyph in O(1) instead of walking the font's Unicode jump
+table and scanning a group.
+
+Index format (u8g2_font_index_t in Arduino_GFX.h):
+  pages[256]   uint8, page number for codepoint >> 8, 0xFF = no glyphs
+  bits[8*n]    uint32, per page: one bit per codepoint (cp & 0xFF)
+  rank[8*n]    uint16, per page word: glyphs before that word
+  offsets[g]   uint32, offset of each glyph's data in the font array
+
+  glyph = rank[p*8 + w] + popcount(bits[p*8 + w] & ((1 << b) - 1))
+  with p = pages[cp >> 8], w = (cp & 0xFF) >> 5, b = cp & 31
+
+Output files:
+  - font_subset.cpp: font data and index (built with -DFONT_SUBSET)
+  - font_subset.h: declarations
+
+Usage:
+    python subset_font.py [--places ../esp32/data/places.bin] [--titles FILE ...]
+"""
+
+import argparse
+import re
+import struct
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).parent.parent
+DEFAULT_FONT = ROOT / "esp32" / "lib" / "Arduino_GFX-1.3.7" / "src" / "font" / "u8g2_font_cubic11_h_cjk.h"
+DEFAULT_PLACES = ROOT / "esp32" / "data" / "places.bin"
+DEFAULT_TITLES = Path(__file__).parent / "station_title_chars.txt"
+
+FONT_NAME = "u8g2_font_radiowall_subset"
+HEADER_SIZE = 23            # U8G2_FONT_DATA_STRUCT_SIZE
+UNICODE_GROUP = 32          # Glyphs per jump table entry in the subset font
+
+# places.bin v2+ layout (see compile_places.py)
+PLACES_HEADER_SIZE = 16
+PLACES_SECTION_SIZE = 12
+
+# Scripts that turn up in station titles, kept whenever the font has them
+TITLE_RANGES = [
+    (0x0020, 0x007E),   # ASCII
+    (0x00A0, 0x024F),   # Latin-1, Latin Extended-A/B
+    (0x0370, 0x03FF),   # Greek
+    (0x0400, 0x04FF),   # Cyrillic
+    (0x1E00, 0x1EFF),   # Latin Extended Additional (Vietnamese)
+    (0x2000, 0x206F),   # General punctuation
+    (0x20A0, 0x20CF),   # Currency symbols
+    (0x2100, 0x214F),   # Letterlike symbols (№, ™)
+    (0x2190, 0x21FF),   # Arrows
+    (0x2600, 0x266F),   # Misc symbols (♪, ★)
+    (0x3000, 0x303F),   # CJK symbols and punctuation
+    (0x3040, 0x30FF),   # Hiragana, Katakana
+    (0xFF00, 0xFFEF),   # Fullwidth forms
+]
+
+
+# ------------------------------------------------------------------
+# Reading the u8g2 font
+# ------------------------------------------------------------------
+
+def read_font_array(path: Path) -> bytes:
+    """Decode the C string literal(s) of a u8g2 font header to bytes."""
+    text = path.read_text(encoding="latin-1")
+    pos = text.index("=", text.index("const uint8_t")) + 1
+    literal_re = re.compile(r'\s*"((?:[^"\\]|\\.)*)"', re.S)
+
+    data = bytearray()
+    while (m := literal_re.match(text, pos)):
+        literal = m.group(1)
+        pos = m.end()
+        i = 0
+        while i < len(literal):
+            ch = literal[i]
+            if ch != "\\":
+                data.append(ord(ch))
+                i += 1
+                continue
+            i += 1
+            esc = literal[i]
+            if esc in "01234567":
+                j = i
+                while j < len(literal) and j < i + 3 and literal[j] in "01234567":
+                    j += 1
+                data.append(int(literal[i:j], 8))
+                i = j
+            else:
+                data.append({"n": 10, "t": 9, "r": 13, "a": 7, "b": 8, "f": 12,
+                             "v": 11}.get(esc, ord(esc)))
+                i += 1
+    return bytes(data) + b"\x00"   # The literal's implicit terminator
+
+
+def parse_glyphs(font: bytes) -> dict[int, bytes]:
+    """Return {codepoint: glyph bitstream} for all glyphs in a u8g2 font."""
+    glyphs = {}
+    unicode_start = HEADER_SIZE + struct.unpack_from(">H", font, 21)[0]
+
+    # 8-bit glyphs: [encoding, size, data...], ends with size 0
+    pos = HEADER_SIZE
+    while font[pos + 1] != 0:
+        size = font[pos + 1]
+        glyphs[font[pos]] = font[pos + 2:pos + size]
+        pos += size
+
+    # Unicode glyphs: skip the jump table (last entry has encoding 0xFFFF),
+    # then [encoding(2), size, data...] until encoding 0
+    pos = unicode_start
+    while True:
+        encoding = struct.unpack_from(">H", font, pos + 2)[0]
+        pos += 4
+        if encoding == 0xFFFF:
+            break
+    while True:
+        encoding = struct.unpack_from(">H", font, pos)[0]
+        if encoding == 0:
+            break
+        size = font[pos + 2]
+        glyphs[encoding] = font[pos + 3:pos + size]
+        pos += size
+    return glyphs
+
+
+# ------------------------------------------------------------------
+# Harvesting codepoints
+# ------------------------------------------------------------------
+
+def place_codepoints(path: Path) -> set[int]:
+    """Codepoints used by the place and country names in places.bin."""
+    data = path.read_bytes()
+    sections = struct.unpack_from("<H", data, 6)[0]
+    count = struct.unpack_from("<I", data, 8)[0]
+    strings = b""
+    for i in range(sections):
+        tag, offset, size = struct.unpack_from("<4sII", data, PLACES_HEADER_SIZE + i * PLACES_SECTION_SIZE)
+        if tag == b"STR ":
+            strings = data[offset:offset + size]
+    cps = set()
+    for s in strings.split(b"\x00"):
+        cps |= {ord(c) for c in s.decode("utf-8", errors="ignore")}
+    print(f"  {len(cps)} codepoints from {count} places")
+    return cps
+
+
+def title_codepoints(paths: list[Path]) -> set[int]:
+    """Built-in title scripts plus every character of the title files."""
+    cps = set()
+    for lo, hi in TITLE_RANGES:
+        cps |= set(range(lo, hi + 1))
+    for path in paths:
+        text = path.read_text(encoding="utf-8")
+        chars = {ord(c) for c in text if not c.isspace()}
+        print(f"  {len(chars)} codepoints from {path.name}")
+        cps |= chars
+    return cps
+
+
+# ------------------------------------------------------------------
+# Writing the subset
+# ------------------------------------------------------------------
+
+def build_font(font: bytes, glyphs: dict[int, bytes]) -> tuple[bytes, dict[int, int]]:
+    """Serialize glyphs as a u8g2 font. Returns (font, {codepoint: data offset})."""
+    header = bytearray(font[:HEADER_SIZE])
+    offsets = {}
+
+    # 8-bit section
+    small = bytearray()
+    upper_a = lower_a = None
+    for cp in sorted(c for c in glyphs if c <= 0xFF):
+        if upper_a is None and cp >= ord("A"):
+            upper_a = len(small)
+        if lower_a is None and cp >= ord("a"):
+            lower_a = len(small)
+        offsets[cp] = HEADER_SIZE + len(small) + 2
+        small += bytes([cp, len(glyphs[cp]) + 2]) + glyphs[cp]
+    small += b"\x00\x00"
+    upper_a = len(small) - 2 if upper_a is None else upper_a
+    lower_a = len(small) - 2 if lower_a is None else lower_a
+
+    # Unicode section: jump table, then glyph records
+    wide = [cp for cp in sorted(glyphs) if cp > 0xFF]
+    groups = [wide[i:i + UNICODE_GROUP] for i in range(0, len(wide), UNICODE_GROUP)]
+    table_size = (len(groups) + 1) * 4
+    table = bytearray()
+    records = bytearray()
+    prev = 0                      # Group start, relative to the table start
+    for group in groups:
+        start = table_size + len(records)
+        table += struct.pack(">HH", start - prev, group[-1])
+        prev = start
+        for cp in group:
+            offsets[cp] = HEADER_SIZE + len(small) + table_size + len(records) + 3
+            records += struct.pack(">HB", cp, len(glyphs[cp]) + 3) + glyphs[cp]
+    table += struct.pack(">HH", table_size + len(records) - prev, 0xFFFF)
+    records += b"\x00\x00"
+
+    header[0] = min(len(glyphs), 0xFF)
+    struct.pack_into(">HHH", header, 17, upper_a, lower_a, len(small))
+    return bytes(header + small + table + records), offsets
+
+
+def build_index(offsets: dict[int, int]) -> tuple[list[int], list[int], list[int], list[int]]:
+    """Page table, presence bits, ranks and glyph offsets (see module doc)."""
+    page_numbers = sorted({cp >> 8 for cp in offsets})
+    if len(page_numbers) > 0xFF:
+        sys.exit("Too many 256-codepoint pages for an 8-bit page table")
+
+    pages = [0xFF] * 256
+    bits = []
+    rank = []
+    glyph_offsets = []
+    for n, page in enumerate(page_numbers):
+        pages[page] = n
+        for word in range(8):
+            rank.append(len(glyph_offsets))
+            value = 0
+            for b in range(32):
+                cp = (page << 8) | (word << 5) | b
+                if cp in offsets:
+                    value |= 1 << b
+                    glyph_offsets.append(offsets[cp])
+            bits.append(value)
+    return pages, bits, rank, glyph_offsets
+
+
+def c_array(values, per_line: int, fmt: str) -> str:
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(fmt.format(v) for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def write_source(font: bytes, index, cps: set[int], output_dir: Path):
+    pages, bits, rank, glyph_offsets = index
+    cpp = output_dir / "font_subset.cpp"
+    header = output_dir / "font_subset.h"
+    print(f"Writing {cpp}...")
+
+    cpp.write_text(f'''\
+/**
+ * Subset of u8g2_font_cubic11_h_cjk for RadioWall ({len(glyph_offsets)} glyphs)
+ *
+ * Auto-generated by subset_font.py
+ * Do not edit manually!
+ */
+
+#include "font_subset.h"
+
+#if defined(FONT_SUBSET)
+
+const uint8_t {FONT_NAME}[{len(font)}] PROGMEM = {{
+{c_array(list(font), 16, "0x{:02X}")}
+}};
+
+static const uint8_t _pages[256] PROGMEM = {{
+{c_array(pages, 16, "0x{:02X}")}
+}};
+
+static const uint32_t _bits[{len(bits)}] PROGMEM = {{
+{c_array(bits, 8, "0x{:08X}")}
+}};
+
+static const uint16_t _rank[{len(rank)}] PROGMEM = {{
+{c_array(rank, 8, "{}")}
+}};
+
+static const uint32_t _offsets[{len(glyph_offsets)}] PROGMEM = {{
+{c_array(glyph_offsets, 8, "{}")}
+}};
+
+const u8g2_font_index_t {FONT_NAME}_index = {{
+    {FONT_NAME}, _pages, _bits, _rank, _offsets
+}};
+
+#endif // FONT_SUBSET
+''')
+
+    print(f"Writing {header}...")
+    header.write_text(f'''\
+/**
+ * Subset of u8g2_font_cubic11_h_cjk for RadioWall
+ *
+ * Auto-generated by subset_font.py
+ * Do not edit manually!
+ */
+
+#ifndef FONT_SUBSET_H
+#define FONT_SUBSET_H
+
+#include "Arduino_GFX.h"
+
+#define FONT_SUBSET_GLYPHS {len(glyph_offsets)}
+
+extern const uint8_t {FONT_NAME}[{len(font)}];
+extern const u8g2_font_index_t {FONT_NAME}_index;
+
+#endif // FONT_SUBSET_H
+''')
+    index_kb = (len(pages) + len(bits) * 4 + len(rank) * 2 + len(glyph_offsets) * 4) / 1024
+    print(f"  Font {len(font) / 1024:.1f} KB + index {index_kb:.1f} KB")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Subset the u8g2 CJK font to the glyphs RadioWall shows"
+    )
+    parser.add_argument("--font", type=Path, default=DEFAULT_FONT,
+                        help="u8g2 font header (default: Arduino_GFX cubic11)")
+    parser.add_argument("--places", type=Path, default=DEFAULT_PLACES,
+                        help="places.bin (default: ../esp32/data/places.bin)")
+    parser.add_argument("--titles", type=Path, nargs="*", default=[DEFAULT_TITLES],
+                        help="Text files whose characters are kept (default: station_title_chars.txt)")
+    parser.add_argument("--output-dir", "-o", type=Path, default=ROOT / "esp32" / "src",
+                        help="Output directory (default: ../esp32/src)")
+    args = parser.parse_args()
+
+    print(f"Reading {args.font.name}...")
+    font = read_font_array(args.font)
+    glyphs = parse_glyphs(font)
+    print(f"  {len(glyphs)} glyphs, {len(font) / 1024:.1f} KB")
+
+    print("Harvesting codepoints...")
+    wanted = place_codepoints(args.places) | title_codepoints(args.titles)
+    kept = {cp: glyphs[cp] for cp in sorted(wanted) if cp in glyphs}
+    missing = sorted(cp for cp in wanted if cp not in glyphs and cp > 0x7E and not
+                     any(lo <= cp <= hi for lo, hi in TITLE_RANGES))
+    print(f"  Keeping {len(kept)} glyphs")
+    if missing:
+        print(f"  Not in font: {''.join(chr(cp) for cp in missing[:40])}")
+
+    subset, offsets = build_font(font, kept)
+    if parse_glyphs(subset) != kept:
+        sys.exit("Subset font does not round-trip")
+
+    args.output_dir.mkdir(parents=True, exist_ok=True)
+    write_source(subset, build_index(offsets), set(kept), args.output_dir)
+
+    print("\nDone! Build with -DFONT_SUBSET (see platformio.ini)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())